@@ -0,0 +1,655 @@
+#include <benchmark/benchmark.h>
+
+#include "booking_service.hpp"
+#include "epoch.hpp"
+#include "perf_counters.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Public API hot paths: single thread, N threads on one show (one contended word),
+// N threads on disjoint shows, and lookups in a large catalog.
+
+namespace {
+
+using booking::BookingService;
+using booking::HallLayout;
+
+constexpr int kHallRows = 16;
+constexpr int kHallSeats = 32;
+
+/** @brief Service with @p shows 16x32 shows spread over 100 movies and 50 theaters. */
+std::unique_ptr<BookingService> make_service(int shows) {
+    auto svc = std::make_unique<BookingService>(BookingService::EmptyCatalog{});
+    booking::Schedule schedule;
+    for (int m = 0; m < 100; ++m) schedule.movies.push_back(booking::ScheduleMovie{m, "Movie " + std::to_string(m)});
+    for (int t = 0; t < 50; ++t) schedule.theaters.push_back(booking::ScheduleTheater{t, "Theater " + std::to_string(t)});
+    schedule.layouts.push_back(booking::ScheduleLayout{0, HallLayout::uniform(kHallRows, kHallSeats)});
+    for (int s = 0; s < shows; ++s) {
+        schedule.shows.push_back(booking::ScheduleShow{s, s % 100, s % 50, 0, (s / 7 % 96) * 900});
+    }
+    svc->load_schedule(std::move(schedule));
+    return svc;
+}
+
+// Shared by the threads of one multi-threaded run; built by thread 0 before the loop starts
+std::unique_ptr<BookingService> g_service;
+
+void setup_shared(const benchmark::State& state, int shows) {
+    if (state.thread_index() == 0) g_service = make_service(shows);
+}
+
+void teardown_shared(const benchmark::State& state) {
+    if (state.thread_index() == 0) g_service.reset();
+}
+
+/** @brief Label of the seat a thread books: its own seat, in row thread / 32 of the hall. */
+std::string own_label(int thread) {
+    return HallLayout::row_label_for(thread / kHallSeats) + std::to_string(thread % kHallSeats + 1);
+}
+
+void BM_BookCancel(benchmark::State& state) {
+    const auto svc = make_service(1);
+    const std::vector<std::string> seats = {"h15", "h16"};
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const booking::BookingResult r = svc->book_seats(0, seats);
+        svc->cancel_seats(0, seats, static_cast<booking::BookingId>(r.id));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+    perf.report(state);
+}
+BENCHMARK(BM_BookCancel);
+
+// BM_BookCancel with metrics switched off at run time: the floor a BOOKING_MINIMAL build
+// (instrumentation compiled out) is compared against
+void BM_BookCancelMetricsOff(benchmark::State& state) {
+    const auto svc = make_service(1);
+    svc->set_metrics_enabled(false);
+    const std::vector<std::string> seats = {"h15", "h16"};
+    for (auto _ : state) {
+        const booking::BookingResult r = svc->book_seats(0, seats);
+        svc->cancel_seats(0, seats, static_cast<booking::BookingId>(r.id));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_BookCancelMetricsOff);
+
+// Book-and-cancel round robin over every show of a catalog (arg 0), booking by id or
+// through per-show handles (arg 1 = 1); the cancel looks the id up either way.
+void BM_BookCancelShowHandle(benchmark::State& state) {
+    const int shows = static_cast<int>(state.range(0));
+    const bool handles = state.range(1) != 0;
+    const auto svc = make_service(shows);
+    std::vector<BookingService::ShowHandle> by_show;
+    by_show.reserve(static_cast<std::size_t>(shows));
+    for (int s = 0; s < shows; ++s) by_show.push_back(svc->show_handle(s));
+    const std::vector<std::string> seats = {"h15"};
+    int show = 0;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const booking::BookingResult r = handles ? svc->book_seats(by_show[static_cast<std::size_t>(show)], seats)
+                                                 : svc->book_seats(show, seats);
+        svc->cancel_seats(show, seats, static_cast<booking::BookingId>(r.id));
+        if (++show == shows) show = 0;
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+    perf.report(state);
+}
+BENCHMARK(BM_BookCancelShowHandle)->ArgNames({"shows", "handle"})->ArgsProduct({{1, 100000}, {0, 1}});
+
+// Every thread books and cancels its own seat in the same row word
+void BM_BookCancelSameShow(benchmark::State& state) {
+    setup_shared(state, 1);
+    const std::vector<std::string> seats = {own_label(state.thread_index() % kHallSeats)};
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const booking::BookingResult r = g_service->book_seats(0, seats);
+        g_service->cancel_seats(0, seats, static_cast<booking::BookingId>(r.id));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+    perf.report(state);
+    teardown_shared(state);
+}
+BENCHMARK(BM_BookCancelSameShow)->ThreadRange(1, 8)->UseRealTime();
+
+// BM_BookCancelSameShow with the show promoted by hand (arg: -1 = not promoted, else
+// HotShowStrategy), comparing plain CAS, owner-thread queueing and flat combining
+void BM_BookCancelHotShow(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_service = make_service(1);
+        if (state.range(0) >= 0) {
+            booking::HotShowPolicy policy;
+            policy.strategy = static_cast<booking::HotShowStrategy>(state.range(0));
+            g_service->set_hot_show_policy(policy);
+            g_service->set_show_hot(0, true);
+        }
+    }
+    state.SetLabel(state.range(0) < 0 ? "shared"
+                                      : booking::to_string(static_cast<booking::HotShowStrategy>(state.range(0))));
+    const std::vector<std::string> seats = {own_label(state.thread_index() % kHallSeats)};
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const booking::BookingResult r = g_service->book_seats(0, seats);
+        g_service->cancel_seats(0, seats, static_cast<booking::BookingId>(r.id));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+    perf.report(state);
+    teardown_shared(state);
+}
+BENCHMARK(BM_BookCancelHotShow)
+    ->Arg(-1)
+    ->Arg(static_cast<int>(booking::HotShowStrategy::OwnerThreads))
+    ->Arg(static_cast<int>(booking::HotShowStrategy::Combining))
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+// Premiere-style group bookings: every thread books and cancels a two-row block (its own
+// column of rows a and b) of one show, so all threads contend on the same two words.
+// Arg: 0 = lock-free per-row CASes, 1 = hardware transactions first (same as 0 without RTM).
+void BM_BookCancelTwoRowsHtm(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_service = make_service(1);
+        g_service->enable_hardware_transactions(state.range(0) != 0);
+    }
+    state.SetLabel(state.range(0) == 0 ? "cas" : booking::htm::supported() ? "htm" : "cas (no rtm)");
+    const std::string col = std::to_string(state.thread_index() % kHallSeats + 1);
+    const std::vector<std::string> seats = {"a" + col, "b" + col};
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const booking::BookingResult r = g_service->book_seats(0, seats);
+        g_service->cancel_seats(0, seats, static_cast<booking::BookingId>(r.id));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+    if (state.thread_index() == 0) {
+        const booking::BookingService::HtmStats htm = g_service->htm_stats();
+        state.counters["htm_commits"] = static_cast<double>(htm.commits);
+        state.counters["htm_aborts"] = static_cast<double>(htm.aborts);
+    }
+    perf.report(state);
+    teardown_shared(state);
+}
+BENCHMARK(BM_BookCancelTwoRowsHtm)->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+
+// Every thread books and cancels in a show of its own
+void BM_BookCancelDisjointShows(benchmark::State& state) {
+    setup_shared(state, 64);
+    const booking::ShowId show = state.thread_index();
+    const std::vector<std::string> seats = {"a1"};
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const booking::BookingResult r = g_service->book_seats(show, seats);
+        g_service->cancel_seats(show, seats, static_cast<booking::BookingId>(r.id));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+    perf.report(state);
+    teardown_shared(state);
+}
+BENCHMARK(BM_BookCancelDisjointShows)->ThreadRange(1, 8)->UseRealTime();
+
+// Owner-thread bookings over many shows with the state and owners placed per NUMA policy
+// (arg: NumaPlacement; on a single-node host all three runs place the same way)
+void BM_BookCancelNumaPlacement(benchmark::State& state) {
+    constexpr int kShows = 65536;
+    if (state.thread_index() == 0) {
+        booking::set_numa_placement(static_cast<booking::NumaPlacement>(state.range(0)));
+        g_service = make_service(kShows);
+        g_service->set_execution_mode(booking::ExecutionMode::OwnerThreads);
+        booking::set_numa_placement(booking::NumaPlacement::Off);
+    }
+    state.SetLabel(booking::to_string(static_cast<booking::NumaPlacement>(state.range(0))));
+    const std::vector<std::string> seats = {own_label(state.thread_index())};
+    std::uint32_t x = 7u + static_cast<std::uint32_t>(state.thread_index());
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        x = x * 1664525u + 1013904223u;
+        const auto show = static_cast<booking::ShowId>(x % kShows);
+        const booking::BookingResult r = g_service->book_seats(show, seats);
+        g_service->cancel_seats(show, seats, static_cast<booking::BookingId>(r.id));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+    perf.report(state);
+    teardown_shared(state);
+}
+BENCHMARK(BM_BookCancelNumaPlacement)
+    ->Arg(static_cast<int>(booking::NumaPlacement::Off))
+    ->Arg(static_cast<int>(booking::NumaPlacement::Interleaved))
+    ->Arg(static_cast<int>(booking::NumaPlacement::Local))
+    ->Threads(4)
+    ->UseRealTime();
+
+// Threads race for the same seats: one wins each round, the others take the conflict path
+void BM_ConflictingBookings(benchmark::State& state) {
+    setup_shared(state, 1);
+    const std::vector<std::string> seats = {"c1", "c2"};
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const booking::BookingResult r = g_service->book_seats(0, seats);
+        if (r.success) g_service->cancel_seats(0, seats, static_cast<booking::BookingId>(r.id));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+    teardown_shared(state);
+}
+BENCHMARK(BM_ConflictingBookings)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_BookBestAvailable(benchmark::State& state) {
+    const auto svc = make_service(1);
+    booking::SeatMask seats;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const booking::BookingResult r = svc->book_best_available(0, 4, seats);
+        svc->cancel_seat_mask(0, seats, static_cast<booking::BookingId>(r.id));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_BookBestAvailable);
+
+// Same with the single-seat rule: candidates filtered word-parallel, the CAS checks the word
+void BM_BookBestAvailableNoSingleGaps(benchmark::State& state) {
+    HallLayout layout = HallLayout::uniform(kHallRows, kHallSeats);
+    layout.set_forbid_single_gaps(true);
+    BookingService svc(std::move(layout));
+    const booking::ShowId show = svc.find_show(1, 1);
+    booking::SeatMask seats;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const booking::BookingResult r = svc.book_best_available(show, 4, seats);
+        svc.cancel_seat_mask(show, seats, static_cast<booking::BookingId>(r.id));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_BookBestAvailableNoSingleGaps);
+
+// Same with two aisles in every row: candidates ANDed with the layout's precomputed block starts
+void BM_BookBestAvailableAisles(benchmark::State& state) {
+    HallLayout layout = HallLayout::uniform(kHallRows, kHallSeats);
+    std::array<std::uint64_t, HallLayout::kMaxRows> aisles{};
+    for (int r = 0; r < kHallRows; ++r) {
+        aisles[static_cast<std::size_t>(r)] =
+            (std::uint64_t{1} << (kHallSeats / 4 - 1)) | (std::uint64_t{1} << (kHallSeats * 3 / 4 - 1));
+    }
+    layout.set_aisles(aisles);
+    BookingService svc(std::move(layout));
+    const booking::ShowId show = svc.find_show(1, 1);
+    booking::SeatMask seats;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const booking::BookingResult r = svc.book_best_available(show, 4, seats);
+        svc.cancel_seat_mask(show, seats, static_cast<booking::BookingId>(r.id));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_BookBestAvailableAisles);
+
+// Groups too wide for one row of a 600-seat hall (24 x 25): 30 seats split over a row pair
+// by the branch-and-bound search, then cancelled; arg: rows already sold around the middle
+void BM_BookGroupTwoRows(benchmark::State& state) {
+    BookingService svc(HallLayout::uniform(24, 25));
+    const booking::ShowId show = svc.find_show(1, 1);
+    const int sold = static_cast<int>(state.range(0));
+    for (int r = 12 - sold / 2; r < 12 - sold / 2 + sold; ++r) {
+        booking::SeatMask row;
+        row.or_word(r, (std::uint64_t{1} << 25) - 1u);
+        svc.book_seat_mask(show, row);
+    }
+    booking::SeatMask seats;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const booking::BookingResult r = svc.book_group(show, 30, seats);
+        svc.cancel_seat_mask(show, seats, static_cast<booking::BookingId>(r.id));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_BookGroupTwoRows)->Arg(0)->Arg(8)->Arg(20);
+
+// Price tiers: four bands of four rows, the three cheaper ones sold out, so every search
+// masks and scans all four levels before finding the run
+void BM_BookCheapestAvailable(benchmark::State& state) {
+    HallLayout layout = HallLayout::uniform(kHallRows, kHallSeats);
+    std::vector<booking::PriceTier> tiers(4);
+    for (int r = 0; r < kHallRows; ++r) {
+        tiers[static_cast<std::size_t>(r / 4)].seats[static_cast<std::size_t>(r)] = layout.row_mask(r);
+    }
+    for (std::size_t t = 0; t < tiers.size(); ++t) tiers[t].price = static_cast<std::uint32_t>(1000 * (4 - t));
+    layout.set_price_tiers(std::move(tiers));
+    BookingService svc(std::move(layout));
+    const booking::ShowId show = svc.find_show(1, 1);
+    booking::SeatMask seats;
+    while (svc.book_best_under(show, kHallSeats, 3000, seats).success) {
+    }
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const booking::BookingResult r = svc.book_cheapest_available(show, 4, seats);
+        svc.cancel_seat_mask(show, seats, static_cast<booking::BookingId>(r.id));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_BookCheapestAvailable);
+
+// A movie-plus-concert style bundle: two seats in each of two shows, then both parts cancelled
+void BM_BookBundle(benchmark::State& state) {
+    const auto svc = make_service(2);
+    booking::SeatMask pair;
+    pair.or_word(0, 0x3u);
+    const booking::BundleItem items[] = {{0, pair}, {1, pair}};
+    booking::BookingId ids[2] = {};
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(svc->book_bundle(items, ids));
+        svc->cancel_seat_mask(0, pair, ids[0]);
+        svc->cancel_seat_mask(1, pair, ids[1]);
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_BookBundle);
+
+void BM_ListAvailableSeats(benchmark::State& state) {
+    const auto svc = make_service(1);
+    for (int r = 0; r < kHallRows; r += 2) svc->book_seats(0, {HallLayout::row_label_for(r) + "7"});
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(svc->list_available_seats(0));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_ListAvailableSeats);
+
+// Seat map snapshots while the other threads book and cancel groups spanning 4 rows
+// (seqlock retries): thread 0 reads, the rest write; items = consistent maps read
+void BM_SnapshotUnderGroupWrites(benchmark::State& state) {
+    setup_shared(state, 1);
+    const booking::bench::PerfCounters perf;
+    if (state.thread_index() == 0) {
+        booking::SeatMask free_seats;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(g_service->available_seats_mask(0, free_seats));
+        }
+        state.SetItemsProcessed(state.iterations());
+    } else {
+        // One column per writer, rows 0-3: the groups never conflict
+        booking::SeatMask group;
+        for (int r = 0; r < 4; ++r) group.set(HallLayout::seat_index(r, state.thread_index()));
+        for (auto _ : state) {
+            const booking::BookingResult res = g_service->book_seat_mask(0, group);
+            g_service->cancel_seat_mask(0, group, static_cast<booking::BookingId>(res.id));
+        }
+    }
+    perf.report(state);
+    teardown_shared(state);
+}
+BENCHMARK(BM_SnapshotUnderGroupWrites)->ThreadRange(1, 8)->UseRealTime();
+
+// Encoded availability payload of a hot show: rendered per read vs the shared cached rendering
+void BM_AppendAvailableSeats(benchmark::State& state) {
+    const auto svc = make_service(1);
+    for (int r = 0; r < kHallRows; r += 2) svc->book_seats(0, {HallLayout::row_label_for(r) + "7"});
+    std::string out;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        out.clear();
+        benchmark::DoNotOptimize(svc->append_available_seats(0, out));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_AppendAvailableSeats);
+
+void BM_AppendCachedAvailableSeats(benchmark::State& state) {
+    const auto svc = make_service(1);
+    for (int r = 0; r < kHallRows; r += 2) svc->book_seats(0, {HallLayout::row_label_for(r) + "7"});
+    std::string out;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        out.clear();
+        benchmark::DoNotOptimize(svc->append_cached_available_seats(0, out));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_AppendCachedAvailableSeats);
+
+// A booker of a show whose admission gate is closed is turned away with a couple of loads
+void BM_ShedThrottledBooking(benchmark::State& state) {
+    const auto svc = make_service(1);
+    svc->set_admission_policy(0, booking::AdmissionPolicy{0.001, 1});
+    svc->book_seats(0, {"a1"});
+    const std::vector<std::string> labels{"a2"};
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(svc->book_seats(0, labels));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_ShedThrottledBooking);
+
+void BM_AvailableCount(benchmark::State& state) {
+    setup_shared(state, 1);
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(g_service->available_count(0));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+    teardown_shared(state);
+}
+BENCHMARK(BM_AvailableCount)->ThreadRange(1, 8)->UseRealTime();
+
+// Thread 0 books and cancels while the others poll the show's free count, reading the
+// booking words live or (arg 1) from the read mirror refreshed every 100 us
+void BM_BookCancelWithReaders(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_service = make_service(1);
+        if (state.range(0) != 0) g_service->set_read_mirror(std::chrono::microseconds(100));
+    }
+    state.SetLabel(state.range(0) != 0 ? "mirror" : "live");
+    const std::vector<std::string> seats = {"a1"};
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        if (state.thread_index() == 0) {
+            const booking::BookingResult r = g_service->book_seats(0, seats);
+            g_service->cancel_seats(0, seats, static_cast<booking::BookingId>(r.id));
+        } else {
+            benchmark::DoNotOptimize(g_service->available_count(0));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+    teardown_shared(state);
+}
+BENCHMARK(BM_BookCancelWithReaders)->Arg(0)->Arg(1)->Threads(4)->UseRealTime();
+
+// "What's on tonight": free counts of a whole city's shows into one caller buffer
+void BM_AvailableCounts(benchmark::State& state) {
+    const int shows = static_cast<int>(state.range(0));
+    const auto svc = make_service(shows);
+    std::vector<booking::ShowId> ids(static_cast<std::size_t>(shows));
+    for (int s = 0; s < shows; ++s) ids[static_cast<std::size_t>(s)] = s;
+    std::vector<int> counts(ids.size());
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(svc->available_counts(ids, counts));
+    }
+    state.SetItemsProcessed(state.iterations() * shows);
+    perf.report(state);
+}
+BENCHMARK(BM_AvailableCounts)->Arg(1000)->Arg(10000)->Arg(100000)->UseRealTime();
+
+// Catalog lookups scale with the catalog size only through hashing
+void BM_FindShow(benchmark::State& state) {
+    const int shows = static_cast<int>(state.range(0));
+    const auto svc = make_service(shows);
+    int i = 0;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(svc->find_show(i % 100, i % 50));
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_FindShow)->Arg(100)->Arg(10000)->Arg(1000000);
+
+void BM_ListTheatersForMovie(benchmark::State& state) {
+    const auto svc = make_service(static_cast<int>(state.range(0)));
+    int i = 0;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(svc->list_theaters_for_movie(i++ % 100));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_ListTheatersForMovie)->Arg(100)->Arg(1000000);
+
+// Same lookup through a pinned snapshot: no vector copy
+void BM_CatalogViewTheatersForMovie(benchmark::State& state) {
+    const auto svc = make_service(static_cast<int>(state.range(0)));
+    int i = 0;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const booking::BookingService::CatalogView view = svc->catalog_view();
+        benchmark::DoNotOptimize(view.theaters_for_movie(i++ % 100).data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_CatalogViewTheatersForMovie)->Arg(100)->Arg(1000000);
+
+// Evening shows of a movie in any theater: scans the movie and start time columns
+void BM_FindMovieShowsBetween(benchmark::State& state) {
+    const auto svc = make_service(static_cast<int>(state.range(0)));
+    int i = 0;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(svc->find_movie_shows_between(i++ % 100, 72 * 900, 88 * 900));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    perf.report(state);
+}
+BENCHMARK(BM_FindMovieShowsBetween)->Arg(10000)->Arg(1000000);
+
+// Evening shows of a theater, any movie: one skip list descent, then a walk along the theater's run
+void BM_FindTheaterShowsBetween(benchmark::State& state) {
+    const auto svc = make_service(static_cast<int>(state.range(0)));
+    int i = 0;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(svc->find_theater_shows_between(i++ % 50, 72 * 900, 88 * 900));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_FindTheaterShowsBetween)->Arg(10000)->Arg(1000000);
+
+// Readers of a large catalog in parallel: the epoch guard is the only shared step
+void BM_FindShowThreads(benchmark::State& state) {
+    setup_shared(state, 100000);
+    int i = state.thread_index();
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(g_service->find_show(i % 100, i % 50));
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+    teardown_shared(state);
+}
+BENCHMARK(BM_FindShowThreads)->ThreadRange(1, 8)->UseRealTime();
+
+// Whole movie list: one guard around a copy of the snapshot's movies
+void BM_ListMovies(benchmark::State& state) {
+    const auto svc = make_service(static_cast<int>(state.range(0)));
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(svc->list_movies().data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_ListMovies)->Arg(10000);
+
+// Catalog reads at up to 128 reader threads while a writer publishes a new snapshot every
+// few microseconds (a show added, then removed): arg 0 lists the movies, arg 1 the theaters
+// of a movie. Reads only announce an epoch in their own slot, so they neither wait for the
+// writer nor slow each other down.
+std::thread g_writer;
+std::atomic<bool> g_writer_stop{false};
+
+void BM_CatalogReadsUnderWrites(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_service = make_service(1000);
+        g_writer_stop.store(false);
+        g_writer = std::thread([] {
+            for (std::int64_t id = 1000000; !g_writer_stop.load(std::memory_order_relaxed); ++id) {
+                g_service->add_show(booking::Show{id, id % 100, id % 50, 0, 0});
+                g_service->remove_show(id);
+            }
+        });
+    }
+    const booking::MovieId movie = state.thread_index() % 100;
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            benchmark::DoNotOptimize(g_service->list_movies().data());
+        } else {
+            benchmark::DoNotOptimize(g_service->list_theaters_for_movie(movie).data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        g_writer_stop.store(true);
+        g_writer.join();
+    }
+    teardown_shared(state);
+}
+BENCHMARK(BM_CatalogReadsUnderWrites)->Arg(0)->Arg(1)->Threads(1)->Threads(8)->Threads(64)->Threads(128)->UseRealTime();
+
+// The read side's share of a catalog lookup: entering and leaving an epoch guard
+void BM_EpochGuard(benchmark::State& state) {
+    static booking::EpochManager epochs;
+    for (auto _ : state) {
+        booking::EpochManager::Guard guard(epochs);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EpochGuard)->ThreadRange(1, 8)->UseRealTime();
+
+// Writers replacing a published object: at once (arg 1) or in per-thread batches
+void BM_EpochRetire(benchmark::State& state) {
+    booking::EpochManager epochs(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        epochs.retire(new int(0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EpochRetire)->Arg(1)->Arg(64);
+
+void BM_TryParseSeatLabel(benchmark::State& state) {
+    const std::string_view labels[] = {"a1", "a20", "A7", "a21", "b3", "a12x"};
+    std::size_t i = 0;
+    int seat = 0;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BookingService::try_parse_seat_label(labels[i++ % 6], seat));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_TryParseSeatLabel);
+
+} // namespace
@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+
+#include "concurrency_policy.hpp"
+#include "perf_counters.hpp"
+
+#include <cstdint>
+#include <memory>
+
+// A/B of the synchronisation strategies of concurrency_policy.hpp on the booking core:
+// threads book and cancel their own seat. Arguments: shows the threads spread over
+// (1 = every thread on one show, the premiere case; 16 = little contention) and the
+// percentage of operations that only read a show's booked count.
+
+namespace {
+
+constexpr int kRows = 16;
+
+template <typename Policy>
+std::unique_ptr<booking::PolicyShows<Policy>> g_shows; // built by thread 0 before the loop starts
+
+template <typename Policy>
+void BM_PolicyBookCancel(benchmark::State& state) {
+    const int show_count = static_cast<int>(state.range(0));
+    const int read_percent = static_cast<int>(state.range(1));
+    if (state.thread_index() == 0) g_shows<Policy> = std::make_unique<booking::PolicyShows<Policy>>(show_count, kRows);
+
+    const int thread = state.thread_index();
+    const int show = thread % show_count;
+    booking::SeatMask seat;
+    seat.set(booking::HallLayout::seat_index(0, thread)); // row 0 of every show: threads of a show share its word
+    std::uint32_t x = 2463534242u + static_cast<std::uint32_t>(thread);
+    std::int64_t reads = 0;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        if (static_cast<int>(x % 100u) < read_percent) {
+            benchmark::DoNotOptimize(g_shows<Policy>->booked(show));
+            ++reads;
+        } else {
+            g_shows<Policy>->book(show, seat);
+            g_shows<Policy>->cancel(show, seat);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["reads"] = benchmark::Counter(static_cast<double>(reads), benchmark::Counter::kAvgThreads);
+    perf.report(state);
+    if (thread == 0) g_shows<Policy>.reset();
+}
+
+#define POLICY_BENCHMARK(Policy)                                                                                   \
+    BENCHMARK_TEMPLATE(BM_PolicyBookCancel, booking::Policy)                                                        \
+        ->ArgNames({"shows", "read_pct"})                                                                           \
+        ->ArgsProduct({{1, 16}, {0, 90}})                                                                           \
+        ->ThreadRange(1, 8)                                                                                         \
+        ->UseRealTime()
+
+POLICY_BENCHMARK(AtomicCasPolicy);
+POLICY_BENCHMARK(ShowMutexPolicy);
+POLICY_BENCHMARK(ShowSpinlockPolicy);
+POLICY_BENCHMARK(ShowRwLockPolicy);
+POLICY_BENCHMARK(FlatCombiningPolicy);
+
+} // namespace
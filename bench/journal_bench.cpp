@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+
+#include "journal.hpp"
+#include "perf_counters.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Latency of a durable (JournalMode::Sync) append per write path: every iteration appends
+// one record and waits for its group commit. Next to the mean, the p50 / p99 / p99.9 of the
+// wait are reported in microseconds (per thread, averaged over the threads), since page-cache
+// writeback shows up in the tail rather than the mean. The journal lives in /var/tmp: /tmp is
+// often tmpfs, which has no O_DIRECT (the direct backend runs as write there; the label names
+// the backend actually used).
+
+namespace {
+
+using booking::Journal;
+using booking::JournalBackend;
+
+std::unique_ptr<Journal> g_journal;
+
+std::string bench_path(JournalBackend backend) {
+    return std::string("/var/tmp/journal_bench_") + booking::to_string(backend) + ".log";
+}
+
+benchmark::Counter percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return benchmark::Counter(0.0, benchmark::Counter::kAvgThreads);
+    const std::size_t at = std::min(sorted.size() - 1u, static_cast<std::size_t>(p * static_cast<double>(sorted.size())));
+    return benchmark::Counter(sorted[at], benchmark::Counter::kAvgThreads);
+}
+
+void BM_JournalSyncAppend(benchmark::State& state) {
+    const auto backend = static_cast<JournalBackend>(state.range(0));
+    if (state.thread_index() == 0) {
+        std::remove(bench_path(backend).c_str());
+        g_journal = std::make_unique<Journal>();
+        g_journal->open(bench_path(backend), booking::JournalMode::Sync, Journal::kDefaultRingSlots, backend);
+    }
+    booking::SeatMask seats;
+    seats.set(state.thread_index() % 64);
+    std::vector<double> latencies;
+    latencies.reserve(1u << 16);
+    std::uint32_t booking_id = static_cast<std::uint32_t>(state.thread_index()) << 24;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(
+            g_journal->wait_durable(g_journal->append(booking::JournalOp::Book, 1, ++booking_id, seats)));
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+    std::sort(latencies.begin(), latencies.end());
+    state.counters["p50_us"] = percentile(latencies, 0.50);
+    state.counters["p99_us"] = percentile(latencies, 0.99);
+    state.counters["p999_us"] = percentile(latencies, 0.999);
+    if (state.thread_index() == 0) {
+        state.SetLabel(booking::to_string(g_journal->backend()));
+        g_journal.reset(); // every thread has left the loop
+        std::remove(bench_path(backend).c_str());
+    }
+}
+BENCHMARK(BM_JournalSyncAppend)
+    ->ArgName("backend")
+    ->DenseRange(static_cast<int>(JournalBackend::Write), static_cast<int>(JournalBackend::Direct))
+    ->ThreadRange(1, 8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
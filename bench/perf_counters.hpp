@@ -0,0 +1,118 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Hardware counters of the calling thread around a benchmark loop (perf_event_open), reported
+// per operation next to the time:
+//
+//   const PerfCounters perf;
+//   for (auto _ : state) { ... }
+//   state.SetItemsProcessed(...);
+//   perf.report(state); // cycles/op, instructions/op, ipc, cache, branch, LLC and dTLB misses/op
+//
+// An operation is an item when the benchmark sets items processed, else an iteration. Events
+// the machine or its perf_event_paranoid setting does not offer (virtual machines often have
+// no PMU at all) are left out of the report instead of reading 0. Counters run in user space
+// only and are scaled when the kernel multiplexes them; work between PauseTiming and
+// ResumeTiming is counted too.
+
+namespace booking::bench {
+
+class PerfCounters {
+public:
+    PerfCounters() {
+        for (std::size_t i = 0; i < kEvents; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = kSpecs[i].type;
+            attr.config = kSpecs[i].config;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds_[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+        for (std::size_t i = 0; i < kEvents; ++i) start_[i] = read(i);
+    }
+
+    ~PerfCounters() {
+        for (const int fd : fds_) {
+            if (fd >= 0) ::close(fd);
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /** @brief True if at least one hardware counter could be opened. */
+    bool available() const {
+        for (const int fd : fds_) {
+            if (fd >= 0) return true;
+        }
+        return false;
+    }
+
+    /** @brief Adds the per-operation counts since construction to @p state's counters. */
+    void report(benchmark::State& state) const {
+        const std::int64_t items = state.items_processed();
+        const double ops = static_cast<double>(items > 0 ? items : state.iterations());
+        if (ops <= 0.0) return;
+        std::array<double, kEvents> delta{};
+        for (std::size_t i = 0; i < kEvents; ++i) {
+            if (fds_[i] < 0) continue;
+            delta[i] = read(i) - start_[i];
+            state.counters[kSpecs[i].name] = benchmark::Counter(delta[i] / ops, benchmark::Counter::kAvgThreads);
+        }
+        if (fds_[kCycles] >= 0 && fds_[kInstructions] >= 0 && delta[kCycles] > 0.0) {
+            state.counters["ipc"] = benchmark::Counter(delta[kInstructions] / delta[kCycles],
+                                                       benchmark::Counter::kAvgThreads);
+        }
+    }
+
+private:
+    struct Spec {
+        const char* name;
+        std::uint32_t type;
+        std::uint64_t config;
+    };
+
+    static constexpr std::size_t kEvents = 6;
+    static constexpr std::size_t kCycles = 0;
+    static constexpr std::size_t kInstructions = 1;
+    static constexpr std::uint64_t kReadMiss =
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    static constexpr std::array<Spec, kEvents> kSpecs = {{
+        {"cycles/op", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {"instructions/op", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {"cache_misses/op", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {"branch_misses/op", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {"llc_misses/op", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | kReadMiss},
+        {"dtlb_misses/op", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | kReadMiss},
+    }};
+
+    /** @brief Count of event @p i so far, scaled up for the time it was multiplexed out. */
+    double read(std::size_t i) const {
+        struct {
+            std::uint64_t value;
+            std::uint64_t enabled;
+            std::uint64_t running;
+        } data{};
+        if (fds_[i] < 0 || ::read(fds_[i], &data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) return 0.0;
+        if (data.running == 0u) return 0.0;
+        return static_cast<double>(data.value) * static_cast<double>(data.enabled) / static_cast<double>(data.running);
+    }
+
+    std::array<int, kEvents> fds_{};
+    std::array<double, kEvents> start_{};
+};
+
+} // namespace booking::bench
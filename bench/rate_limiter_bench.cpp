@@ -0,0 +1,45 @@
+#include <benchmark/benchmark.h>
+
+#include "perf_counters.hpp"
+#include "rate_limiter.hpp"
+
+#include <cstdint>
+#include <memory>
+
+// Cost of the per-request rate check: admitted requests of many clients, and a single
+// client flooding past its limit.
+
+namespace {
+
+using booking::ClientRateLimiter;
+using booking::RateLimit;
+
+std::unique_ptr<ClientRateLimiter> g_limiter;
+
+void BM_RateLimiterAllow(benchmark::State& state) {
+    if (state.thread_index() == 0) g_limiter = std::make_unique<ClientRateLimiter>(RateLimit{1e9, 1000}, 4096);
+    std::uint64_t client = static_cast<std::uint64_t>(state.thread_index()) * 1000u;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(g_limiter->allow(client));
+        client = client % 1000u == 999u ? client - 999u : client + 1u; // 1000 clients per thread
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+    if (state.thread_index() == 0) g_limiter.reset();
+}
+BENCHMARK(BM_RateLimiterAllow)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_RateLimiterRejectFlood(benchmark::State& state) {
+    if (state.thread_index() == 0) g_limiter = std::make_unique<ClientRateLimiter>(RateLimit{1.0, 1}, 4096);
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(g_limiter->allow(42));
+    }
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+    if (state.thread_index() == 0) g_limiter.reset();
+}
+BENCHMARK(BM_RateLimiterRejectFlood)->ThreadRange(1, 8)->UseRealTime();
+
+} // namespace
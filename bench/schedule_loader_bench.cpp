@@ -0,0 +1,52 @@
+#include <benchmark/benchmark.h>
+
+#include "booking_service.hpp"
+#include "perf_counters.hpp"
+#include "schedule_loader.hpp"
+
+#include <string>
+
+namespace {
+
+// A nightly export: 1000 movies, 500 theaters, 4 hall layouts and `shows` shows
+std::string make_schedule(int shows) {
+    std::string text;
+    text.reserve(static_cast<std::size_t>(shows) * 24u);
+    for (int m = 0; m < 1000; ++m) text += "movie," + std::to_string(m) + ",\"Movie " + std::to_string(m) + "\"\n";
+    for (int t = 0; t < 500; ++t) text += "theater," + std::to_string(t) + ",Theater " + std::to_string(t) + "\n";
+    text += "layout,0,10x24\nlayout,1,12x20\nlayout,2,a:10|b:12|c:14|d:16\nlayout,3,20x30\n";
+    for (int s = 0; s < shows; ++s) {
+        text += "show," + std::to_string(s) + ',' + std::to_string(s % 1000) + ',' + std::to_string(s % 500) + ','
+                + std::to_string(s % 4) + '\n';
+    }
+    return text;
+}
+
+void BM_ParseSchedule(benchmark::State& state) {
+    const std::string text = make_schedule(200000);
+    const unsigned threads = static_cast<unsigned>(state.range(0));
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        booking::Schedule schedule;
+        benchmark::DoNotOptimize(booking::parse_schedule(text, threads, schedule));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(text.size()));
+    perf.report(state);
+}
+BENCHMARK(BM_ParseSchedule)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond);
+
+void BM_LoadSchedule(benchmark::State& state) {
+    const std::string text = make_schedule(static_cast<int>(state.range(0)));
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        booking::BookingService svc{booking::BookingService::EmptyCatalog{}};
+        booking::Schedule schedule;
+        booking::parse_schedule(text, 0, schedule);
+        benchmark::DoNotOptimize(svc.load_schedule(std::move(schedule)));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    perf.report(state);
+}
+BENCHMARK(BM_LoadSchedule)->Arg(20000)->Arg(200000)->Unit(benchmark::kMillisecond);
+
+} // namespace
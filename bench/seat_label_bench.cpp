@@ -0,0 +1,232 @@
+#include <benchmark/benchmark.h>
+
+#include "booking_service.hpp"
+#include "hall_layout.hpp"
+#include "perf_counters.hpp"
+#include "seat_label.hpp"
+#include "seat_mask.hpp"
+#include "text_protocol.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// The original std::stoi based parser, kept as the baseline to compare against.
+bool legacy_parse_seat_label(const std::string& label, int& out_index0) {
+    if (label.size() < 2) return false;
+
+    char row = label[0];
+    if (row == 'A') row = 'a';
+    if (row != 'a') return false;
+
+    try {
+        std::size_t pos = 0;
+        int num = std::stoi(label.substr(1), &pos);
+        if (pos != label.size() - 1) return false;
+        if (num < 1 || num > 20) return false;
+        out_index0 = num - 1;
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+const std::vector<std::string>& valid_labels() {
+    static const std::vector<std::string> labels = {"a1", "a7", "A12", "a20", "a3", "a19"};
+    return labels;
+}
+
+// Typical bot garbage: every one of these makes std::stoi throw
+const std::vector<std::string>& malformed_labels() {
+    static const std::vector<std::string> labels = {"ax", "a", "a-", "a_1", "aa", "a99999999999999"};
+    return labels;
+}
+
+template <typename Parse>
+void run_parser(benchmark::State& state, const std::vector<std::string>& labels, Parse parse) {
+    int idx = 0;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        for (const auto& l : labels) {
+            benchmark::DoNotOptimize(parse(l, idx));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(labels.size()));
+    perf.report(state);
+}
+
+void BM_ParseLabel_Legacy_Valid(benchmark::State& state) {
+    run_parser(state, valid_labels(), legacy_parse_seat_label);
+}
+
+void BM_ParseLabel_Legacy_Malformed(benchmark::State& state) {
+    run_parser(state, malformed_labels(), legacy_parse_seat_label);
+}
+
+void BM_ParseLabel_FromChars_Valid(benchmark::State& state) {
+    run_parser(state, valid_labels(), [](const std::string& l, int& idx) {
+        return booking::BookingService::try_parse_seat_label(l, idx);
+    });
+}
+
+void BM_ParseLabel_FromChars_Malformed(benchmark::State& state) {
+    run_parser(state, malformed_labels(), [](const std::string& l, int& idx) {
+        return booking::BookingService::try_parse_seat_label(l, idx);
+    });
+}
+
+void BM_ParseLabel_Layout_MultiLetterRows(benchmark::State& state) {
+    static const booking::HallLayout layout = booking::HallLayout::uniform(40, 30);
+    static const std::vector<std::string> labels = {"a1", "k30", "z15", "aa4", "AN28", "ab12"};
+    run_parser(state, labels, [](const std::string& l, int& seat) {
+        return layout.try_parse_label(l, seat);
+    });
+}
+
+// Free-seat rendering for protocol encoders: per-label std::string vs the label table
+void BM_FormatLabels_Strings(benchmark::State& state) {
+    static const booking::HallLayout layout = booking::HallLayout::uniform(40, 30);
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        std::string out;
+        for (int r = 0; r < layout.row_count(); ++r) {
+            for (int c = 0; c < layout.row_seats(r); c += 2) {
+                out += layout.row_label(r) + std::to_string(c + 1);
+                out += ' ';
+            }
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 600);
+    perf.report(state);
+}
+
+void BM_FormatLabels_Table(benchmark::State& state) {
+    static const booking::HallLayout layout = booking::HallLayout::uniform(40, 30);
+    std::vector<std::uint64_t> words(40, 0x5555555555555555u);
+    std::vector<char> buf(layout.max_rendered_size());
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(layout.render_labels(words.data(), 40, ' ', buf.data()));
+    }
+    state.SetItemsProcessed(state.iterations() * 600);
+    perf.report(state);
+}
+
+// A 24-seat group request: labels split first and parsed one by one with a duplicate
+// test per seat, vs one scan_list pass over the request line and a popcount check
+const std::string& group_request() {
+    static const std::string list =
+        "a1 a2 a3 a4 a5 a6 b1 b2 b3 b4 b5 b6 k10 k11 k12 k13 k14 k15 ab20 ab21 ab22 ab23 ab24 ab25";
+    return list;
+}
+
+void BM_ParseGroup_Tokens(benchmark::State& state) {
+    static const booking::HallLayout layout = booking::HallLayout::uniform(40, 30);
+    std::vector<std::string_view> tokens;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        booking::split_tokens(group_request(), tokens);
+        booking::SeatMask mask;
+        bool ok = true;
+        for (const std::string_view l : tokens) {
+            int seat = -1;
+            if (!layout.try_parse_label(l, seat) || mask.test(seat)) {
+                ok = false;
+                break;
+            }
+            mask.set(seat);
+        }
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(mask);
+    }
+    state.SetItemsProcessed(state.iterations() * 24);
+    perf.report(state);
+}
+
+void BM_ParseGroup_ScanList(benchmark::State& state) {
+    static const booking::HallLayout layout = booking::HallLayout::uniform(40, 30);
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        booking::SeatMask mask;
+        int labels = 0;
+        bool ok = true;
+        booking::seat_label::scan_list(group_request(), [&](std::string_view, std::uint32_t code, int number) {
+            int seat = -1;
+            ok = layout.try_seat(code, number, seat);
+            if (ok) mask.set(seat);
+            ++labels;
+            return ok;
+        });
+        ok = ok && mask.count() == labels;
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(mask);
+    }
+    state.SetItemsProcessed(state.iterations() * 24);
+    perf.report(state);
+}
+
+// Hostile input (what the fuzz target throws at the parsers): digit strings past int range,
+// UTF-8 and full-width letters, empty and sign-prefixed labels, and a row name longer than
+// any layout's. Each must be rejected in time bounded by its length, without allocating.
+const std::vector<std::string>& adversarial_labels() {
+    static const std::vector<std::string> labels = {
+        "",
+        "a" + std::string(300, '9'),
+        "a2147483648",
+        "a" + std::string(40, '0') + "1",
+        "a\xc3\xa9" "1",
+        "\xef\xbc\xa1" "1",
+        "a-1",
+        std::string(70, 'b') + "1",
+    };
+    return labels;
+}
+
+void BM_ParseLabel_Adversarial(benchmark::State& state) {
+    run_parser(state, adversarial_labels(), [](const std::string& l, int& idx) {
+        return booking::BookingService::try_parse_seat_label(l, idx);
+    });
+}
+
+void BM_ParseLabel_Layout_Adversarial(benchmark::State& state) {
+    static const booking::HallLayout layout = booking::HallLayout::uniform(40, 30);
+    run_parser(state, adversarial_labels(), [](const std::string& l, int& seat) {
+        return layout.try_parse_label(l, seat);
+    });
+}
+
+// A bot's request line: the adversarial labels, separated by runs of spaces and tabs
+void BM_ScanList_Adversarial(benchmark::State& state) {
+    std::string line;
+    for (const auto& l : adversarial_labels()) line += l + " \t  ";
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        int rejected = 0;
+        booking::seat_label::scan_list(line, [&](std::string_view, std::uint32_t code, int) {
+            rejected += code == 0u;
+            return true;
+        });
+        benchmark::DoNotOptimize(rejected);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(line.size()));
+    perf.report(state);
+}
+
+} // namespace
+
+BENCHMARK(BM_FormatLabels_Strings);
+BENCHMARK(BM_FormatLabels_Table);
+BENCHMARK(BM_ParseLabel_Legacy_Valid);
+BENCHMARK(BM_ParseLabel_Legacy_Malformed);
+BENCHMARK(BM_ParseLabel_FromChars_Valid);
+BENCHMARK(BM_ParseLabel_FromChars_Malformed);
+BENCHMARK(BM_ParseLabel_Layout_MultiLetterRows);
+BENCHMARK(BM_ParseGroup_Tokens);
+BENCHMARK(BM_ParseGroup_ScanList);
+BENCHMARK(BM_ParseLabel_Adversarial);
+BENCHMARK(BM_ParseLabel_Layout_Adversarial);
+BENCHMARK(BM_ScanList_Adversarial);
@@ -0,0 +1,104 @@
+#include <benchmark/benchmark.h>
+
+#include "perf_counters.hpp"
+#include "seat_heatmap.hpp"
+#include "seat_scan.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+namespace scan = booking::seat_scan;
+
+// A city page: many shows of ~600 seats (10 rows of 60), each scanned for counts and a block of 4
+constexpr std::size_t kRowsPerShow = 10;
+constexpr std::size_t kShows = 512;
+
+const std::vector<std::uint64_t>& city_words() {
+    static const std::vector<std::uint64_t> words = [] {
+        std::vector<std::uint64_t> w(kRowsPerShow * kShows);
+        std::uint64_t x = 0x9E3779B97F4A7C15u;
+        for (auto& v : w) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            v = (x | (x >> 2)) & ((std::uint64_t{1} << 60) - 1u);
+        }
+        return w;
+    }();
+    return words;
+}
+
+const scan::Kernels* kernels_for(int index) {
+    switch (index) {
+        case 0: return &scan::scalar_kernels();
+        case 1: return scan::avx2_kernels();
+        default: return scan::neon_kernels();
+    }
+}
+
+void BM_CityCounts(benchmark::State& state) {
+    const scan::Kernels* k = kernels_for(static_cast<int>(state.range(0)));
+    if (!k) {
+        state.SkipWithError("ISA not available");
+        return;
+    }
+    const std::vector<std::uint64_t>& words = city_words();
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        int total = 0;
+        for (std::size_t s = 0; s < kShows; ++s) total += k->count_free(words.data() + s * kRowsPerShow, kRowsPerShow);
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetLabel(scan::to_string(k->isa));
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kShows));
+    perf.report(state);
+}
+BENCHMARK(BM_CityCounts)->DenseRange(0, 2);
+
+void BM_CityRuns(benchmark::State& state) {
+    const scan::Kernels* k = kernels_for(static_cast<int>(state.range(0)));
+    if (!k) {
+        state.SkipWithError("ISA not available");
+        return;
+    }
+    const std::vector<std::uint64_t>& words = city_words();
+    std::uint64_t out[kRowsPerShow];
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        std::uint64_t rows = 0;
+        for (std::size_t s = 0; s < kShows; ++s) rows ^= k->find_runs(words.data() + s * kRowsPerShow, kRowsPerShow, 4, out);
+        benchmark::DoNotOptimize(rows);
+    }
+    state.SetLabel(scan::to_string(k->isa));
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kShows));
+    perf.report(state);
+}
+BENCHMARK(BM_CityRuns)->DenseRange(0, 2);
+
+// A year of one hall's shows (10 rows), summed into per-seat sale counts
+void BM_SeatHeatmap(benchmark::State& state) {
+    namespace heatmap = booking::seat_heatmap;
+    const heatmap::Kernels* k = state.range(0) == 0 ? &heatmap::scalar_kernels() : heatmap::avx2_kernels();
+    if (!k) {
+        state.SkipWithError("ISA not available");
+        return;
+    }
+    constexpr std::size_t kYear = 365u * 6u;
+    const std::vector<std::uint64_t>& city = city_words();
+    std::vector<std::uint64_t> words(kYear * kRowsPerShow);
+    for (std::size_t i = 0; i < words.size(); ++i) words[i] = ~city[i % city.size()]; // sold seats
+    std::vector<std::uint32_t> counts(kRowsPerShow * 64u);
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        k->add_columns(words.data(), kYear, kRowsPerShow, counts.data());
+        benchmark::DoNotOptimize(counts.data());
+    }
+    state.SetLabel(scan::to_string(k->isa));
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kYear));
+    perf.report(state);
+}
+BENCHMARK(BM_SeatHeatmap)->DenseRange(0, 1);
+
+} // namespace
@@ -0,0 +1,157 @@
+#include <benchmark/benchmark.h>
+
+#include "huge_pages.hpp"
+#include "perf_counters.hpp"
+#include "show_table.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Minimal stand-in for BookingService::ShowState: what a booking reads first
+struct alignas(64) State {
+    std::atomic<std::uint64_t> word{0};
+};
+
+// Pseudo-random but reproducible show ids to look up (a listing page touches shows in no order)
+std::vector<int> lookup_order(int shows) {
+    std::vector<int> ids(4096);
+    std::uint32_t x = 12345u;
+    for (int& id : ids) {
+        x = x * 1664525u + 1013904223u;
+        id = static_cast<int>(x % static_cast<std::uint32_t>(shows));
+    }
+    return ids;
+}
+
+// The previous layout: one map node plus one separately allocated state per show
+void BM_ShowLookupUnorderedMap(benchmark::State& state) {
+    const int shows = static_cast<int>(state.range(0));
+    std::unordered_map<int, std::unique_ptr<State>> map;
+    for (int id = 0; id < shows; ++id) map.emplace(id, std::make_unique<State>());
+    const std::vector<int> ids = lookup_order(shows);
+
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        for (int id : ids) {
+            auto it = map.find(id);
+            if (it != map.end()) sum += it->second->word.load(std::memory_order_relaxed);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ids.size()));
+    perf.report(state);
+}
+BENCHMARK(BM_ShowLookupUnorderedMap)->Arg(64)->Arg(4096)->Arg(262144);
+
+void BM_ShowLookupFlatTable(benchmark::State& state) {
+    const int shows = static_cast<int>(state.range(0));
+    booking::ShowTable<State> table;
+    for (int id = 0; id < shows; ++id) table.emplace(id, [](State&) {});
+    const std::vector<int> ids = lookup_order(shows);
+
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        for (int id : ids) {
+            const State* st = table.find(id);
+            if (st) sum += st->word.load(std::memory_order_relaxed);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ids.size()));
+    perf.report(state);
+}
+BENCHMARK(BM_ShowLookupFlatTable)->Arg(64)->Arg(4096)->Arg(262144);
+
+// The same lookups with ids spread over the whole int range: each goes through the
+// SparseIdMap probe before the state
+void BM_ShowLookupSparseIds(benchmark::State& state) {
+    const int shows = static_cast<int>(state.range(0));
+    constexpr int kStride = 509; // spreads `shows` ids far past the dense range
+    const auto sparse = [](int i) { return booking::ShowTable<State>::kMaxId + i * kStride; };
+    booking::ShowTable<State> table;
+    for (int i = 0; i < shows; ++i) table.emplace(sparse(i), [](State&) {});
+    const std::vector<int> ids = lookup_order(shows);
+
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        for (int i : ids) {
+            const State* st = table.find(sparse(i));
+            if (st) sum += st->word.load(std::memory_order_relaxed);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ids.size()));
+    perf.report(state);
+}
+BENCHMARK(BM_ShowLookupSparseIds)->Arg(64)->Arg(4096)->Arg(262144);
+
+// Random lookups over a large table with its chunks on normal or huge pages (arg 1: HugePages)
+void BM_ShowLookupHugePages(benchmark::State& state) {
+    const int shows = static_cast<int>(state.range(0));
+    const auto pages = static_cast<booking::HugePages>(state.range(1));
+    booking::set_huge_pages(pages);
+    auto table = std::make_unique<booking::ShowTable<State>>(true);
+    for (int id = 0; id < shows; ++id) table->emplace(id, [](State&) {});
+    booking::set_huge_pages(booking::HugePages::Off);
+    state.SetLabel(booking::to_string(table->backing(0)));
+    const std::vector<int> ids = lookup_order(shows);
+
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        for (int id : ids) {
+            const State* st = table->find(id);
+            if (st) sum += st->word.load(std::memory_order_relaxed);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    const auto lookups = state.iterations() * static_cast<std::int64_t>(ids.size());
+    state.SetItemsProcessed(lookups);
+    perf.report(state);
+}
+BENCHMARK(BM_ShowLookupHugePages)
+    ->Args({1 << 20, static_cast<int>(booking::HugePages::Off)})
+    ->Args({1 << 20, static_cast<int>(booking::HugePages::Transparent)})
+    ->Args({1 << 20, static_cast<int>(booking::HugePages::Explicit2M)});
+
+// One booking and one cancellation on a row word, then a listing's loads of eight rows, with
+// the booking paths' default orders (arg 0: seq_cst) or BOOKING_RELAXED_ORDERING's (arg 1:
+// acquire loads, acq_rel read-modify-writes). Same code on x86; on AArch64 the loads differ.
+void BM_SeatWordCycle(benchmark::State& state) {
+    const bool relaxed = state.range(0) != 0;
+    const std::memory_order load = relaxed ? std::memory_order_acquire : std::memory_order_seq_cst;
+    const std::memory_order update = relaxed ? std::memory_order_acq_rel : std::memory_order_seq_cst;
+    state.SetLabel(relaxed ? "acquire/acq_rel" : "seq_cst");
+    std::array<std::atomic<std::uint64_t>, 8> words{};
+
+    const booking::bench::PerfCounters perf;
+    std::uint64_t free_seats = 0;
+    int col = 0;
+    for (auto _ : state) {
+        std::atomic<std::uint64_t>& word = words[static_cast<std::size_t>(col & 7)];
+        const std::uint64_t bit = std::uint64_t{1} << (col & 63);
+        std::uint64_t current = word.load(load);
+        while ((current & bit) == 0u && !word.compare_exchange_weak(current, current | bit, update, load)) {
+        }
+        word.fetch_and(~bit, update);
+        for (const std::atomic<std::uint64_t>& w : words) {
+            free_seats += static_cast<std::uint64_t>(__builtin_popcountll(~w.load(load)));
+        }
+        ++col;
+    }
+    benchmark::DoNotOptimize(free_seats);
+    state.SetItemsProcessed(state.iterations());
+    perf.report(state);
+}
+BENCHMARK(BM_SeatWordCycle)->Arg(0)->Arg(1);
+
+} // namespace
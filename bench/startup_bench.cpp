@@ -0,0 +1,154 @@
+#include <benchmark/benchmark.h>
+
+#include "booking_service.hpp"
+#include "huge_pages.hpp"
+#include "perf_counters.hpp"
+#include "schedule_loader.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace {
+
+// 1000 movies, 500 theaters, the four layouts of schedule_loader_bench and `shows` shows
+booking::Schedule make_schedule(int shows) {
+    booking::Schedule s;
+    for (int m = 0; m < 1000; ++m) s.movies.push_back(booking::ScheduleMovie{m, "Movie " + std::to_string(m)});
+    for (int t = 0; t < 500; ++t) s.theaters.push_back(booking::ScheduleTheater{t, "Theater " + std::to_string(t)});
+    s.layouts.push_back(booking::ScheduleLayout{0, booking::HallLayout::uniform(10, 24)});
+    s.layouts.push_back(booking::ScheduleLayout{1, booking::HallLayout::uniform(12, 20)});
+    s.layouts.push_back(booking::ScheduleLayout{2, booking::HallLayout({{"a", 10}, {"b", 12}, {"c", 14}, {"d", 16}})});
+    s.layouts.push_back(booking::ScheduleLayout{3, booking::HallLayout::uniform(20, 30)});
+    s.shows.reserve(static_cast<std::size_t>(shows));
+    for (int id = 0; id < shows; ++id) {
+        s.shows.push_back(booking::ScheduleShow{id, id % 1000, id % 500, id % 4, 1700000000 + 900 * (id % 96), id % 12});
+    }
+    return s;
+}
+
+// Resident set of the process now (bytes)
+std::int64_t resident_bytes() {
+    long pages = 0;
+    long resident = 0;
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        std::fclose(f);
+    }
+    return static_cast<std::int64_t>(resident) * sysconf(_SC_PAGESIZE);
+}
+
+// High-water resident set of the process so far (bytes; never goes down between benchmarks)
+double peak_resident_mb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;
+}
+
+// Memory counters of a service holding `shows` shows, built while `before` bytes were resident
+void report_memory(benchmark::State& state, std::int64_t before, int shows) {
+    const double bytes = static_cast<double>(resident_bytes() - before);
+    state.counters["rss_mb"] = bytes / (1024.0 * 1024.0);
+    state.counters["bytes_per_show"] = bytes / static_cast<double>(shows);
+    state.counters["peak_rss_mb"] = peak_resident_mb();
+}
+
+// Snapshot of a service of `shows` shows with one booking on every 100th show, written once per size
+class SnapshotFiles {
+public:
+    ~SnapshotFiles() {
+        for (const auto& file : paths_) std::remove(file.second.c_str());
+    }
+
+    const std::string& get(int shows) {
+        std::string& path = paths_[shows];
+        if (path.empty()) {
+            path = "/tmp/startup_bench_" + std::to_string(shows) + ".snap";
+            booking::BookingService svc{booking::BookingService::EmptyCatalog{}};
+            svc.load_schedule(make_schedule(shows));
+            for (int id = 0; id < shows; id += 100) svc.book_seats(id, {"a1", "a2"});
+            svc.write_snapshot(path);
+        }
+        return path;
+    }
+
+private:
+    std::map<int, std::string> paths_;
+};
+
+SnapshotFiles& snapshot_files() {
+    static SnapshotFiles files;
+    return files;
+}
+
+// Service construction and a bulk load of an already parsed schedule (arg 1: HugePages)
+void BM_StartupBulkLoad(benchmark::State& state) {
+    const int shows = static_cast<int>(state.range(0));
+    const booking::Schedule schedule = make_schedule(shows);
+    booking::set_huge_pages(static_cast<booking::HugePages>(state.range(1)));
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        state.PauseTiming();
+        booking::Schedule copy = schedule;
+        const std::int64_t before = resident_bytes();
+        state.ResumeTiming();
+
+        auto svc = std::make_unique<booking::BookingService>(booking::BookingService::EmptyCatalog{});
+        benchmark::DoNotOptimize(svc->load_schedule(std::move(copy)));
+
+        state.PauseTiming();
+        report_memory(state, before, shows);
+        state.SetLabel(booking::to_string(svc->seat_state_pages(0)));
+        svc.reset();
+        state.ResumeTiming();
+    }
+    booking::set_huge_pages(booking::HugePages::Off);
+    state.SetItemsProcessed(state.iterations() * shows);
+    perf.report(state);
+}
+// Dense ids are bounded by ShowTable::kMaxId (2^22), so the largest catalog is 4M shows
+BENCHMARK(BM_StartupBulkLoad)
+    ->ArgsProduct({{10000, 1000000, 4000000},
+                   {static_cast<int>(booking::HugePages::Off), static_cast<int>(booking::HugePages::Transparent)}})
+    ->Unit(benchmark::kMillisecond);
+
+// Restore from a snapshot file (arg 1: SnapshotLoad); a lazy restore also reports the time
+// to decode the pending shows afterwards
+void BM_StartupSnapshot(benchmark::State& state) {
+    const int shows = static_cast<int>(state.range(0));
+    const auto load = static_cast<booking::SnapshotLoad>(state.range(1));
+    const std::string& path = snapshot_files().get(shows);
+    double decode_rest_ms = 0;
+    const booking::bench::PerfCounters perf;
+    for (auto _ : state) {
+        state.PauseTiming();
+        const std::int64_t before = resident_bytes();
+        state.ResumeTiming();
+
+        auto svc = std::make_unique<booking::BookingService>(booking::BookingService::EmptyCatalog{});
+        benchmark::DoNotOptimize(svc->restore_snapshot(path, load));
+
+        state.PauseTiming();
+        report_memory(state, before, shows);
+        const auto start = std::chrono::steady_clock::now();
+        svc->load_lazy_shows();
+        decode_rest_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        svc.reset();
+        state.ResumeTiming();
+    }
+    state.SetLabel(booking::to_string(load));
+    state.counters["decode_rest_ms"] = decode_rest_ms / static_cast<double>(state.iterations());
+    state.SetItemsProcessed(state.iterations() * shows);
+    perf.report(state);
+}
+BENCHMARK(BM_StartupSnapshot)
+    ->ArgsProduct({{10000, 1000000, 4000000},
+                   {static_cast<int>(booking::SnapshotLoad::Eager), static_cast<int>(booking::SnapshotLoad::Lazy)}})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+# Optimised release build: LTO plus profile-guided optimisation trained on the load
+# generator's mixed workload (Zipf show popularity, explicit and best-available parties,
+# reads, cancellations and premiere bursts).
+#
+#   ./build_release_pgo.sh            # build build-pgo/
+#   ./build_release_pgo.sh --compare  # also build build-release/ (no PGO/LTO) and compare them
+set -e
+
+BUILD_DIR=build-pgo
+PLAIN_DIR=build-release
+CXX_STD=17
+PROFILE_DIR="$(pwd)/${BUILD_DIR}/pgo-profiles"
+TARGETS="booking_cli booking_server booking_loadgen booking_replay booking_bench"
+TRAIN_ARGS="--threads=4 --seconds=10 --shows=5000 --zipf=0.99 --best-ratio=0.3 --read-ratio=0.5 \
+--cancel-ratio=0.1 --burst-every-ms=2000 --burst-ms=300 --burst-share=0.5"
+BENCH_ARGS="--threads=4 --seconds=10 --shows=5000 --zipf=0.99 --best-ratio=0.3 --read-ratio=0.5 \
+--cancel-ratio=0.1"
+
+# Builds the given targets that exist in the configured tree (booking_bench needs Google Benchmark)
+build_targets() {
+  local dir=$1
+  for t in ${TARGETS}; do
+    if cmake --build "${dir}" --target help | grep -q "^\.\.\. ${t}$\|^${t}:"; then
+      cmake --build "${dir}" --target "${t}"
+    fi
+  done
+}
+
+configure() {
+  cmake -S . -B "$1" -G Ninja -DCMAKE_BUILD_TYPE=Release -DCXX_STD=${CXX_STD} \
+    -DBOOKING_SIMULATION=OFF "${@:2}"
+}
+
+echo "==> Instrumented build (C++${CXX_STD}, LTO, PGO generate)"
+rm -rf "${PROFILE_DIR}"
+configure ${BUILD_DIR} -DBOOKING_LTO=ON -DBOOKING_PGO=GENERATE -DBOOKING_PGO_DIR="${PROFILE_DIR}"
+cmake --build ${BUILD_DIR} --target booking_loadgen
+
+echo "==> Training run"
+./${BUILD_DIR}/booking_loadgen ${TRAIN_ARGS}
+
+if ls "${PROFILE_DIR}"/*.profraw >/dev/null 2>&1; then
+  llvm-profdata merge -output="${PROFILE_DIR}/booking.profdata" "${PROFILE_DIR}"/*.profraw
+fi
+
+echo "==> Optimised build (LTO, PGO use)"
+configure ${BUILD_DIR} -DBOOKING_LTO=ON -DBOOKING_PGO=USE -DBOOKING_PGO_DIR="${PROFILE_DIR}"
+build_targets ${BUILD_DIR}
+
+if [ "$1" = "--compare" ]; then
+  echo "==> Plain Release build"
+  configure ${PLAIN_DIR} -DBOOKING_LTO=OFF -DBOOKING_PGO=OFF
+  build_targets ${PLAIN_DIR}
+
+  echo "==> Release"
+  ./${PLAIN_DIR}/booking_loadgen ${BENCH_ARGS} | grep "^total"
+  echo "==> Release + LTO + PGO"
+  ./${BUILD_DIR}/booking_loadgen ${BENCH_ARGS} | grep "^total"
+fi
+
+echo "==> Done: ${BUILD_DIR}/"
@@ -0,0 +1,74 @@
+// libFuzzer target for the seat label parsers (clients send labels unchecked).
+//
+// Every input is parsed as one label by BookingService::try_parse_seat_label and by each
+// grammar's HallLayout::try_parse_label, and as a label list by seat_label::scan_list in
+// each grammar. Besides memory errors (built with ASan/UBSan), the target traps when the
+// parsers disagree: a parsed seat must exist and its own label must parse back to it, and
+// scan_list must report exactly the tokens and codes that splitting by hand gives.
+
+#include "booking_service.hpp"
+#include "hall_layout.hpp"
+#include "seat_label.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace {
+
+namespace seat_label = booking::seat_label;
+using booking::HallLayout;
+
+void check(bool ok) {
+    if (!ok) __builtin_trap();
+}
+
+template <typename G>
+void fuzz_grammar(std::string_view input, seat_label::LabelGrammar grammar) {
+    static const HallLayout layout = HallLayout::uniform(HallLayout::kMaxRows, HallLayout::kMaxRowSeats, grammar);
+
+    int seat = -1;
+    if (layout.try_parse_label(input, seat)) {
+        check(layout.contains(seat));
+        int again = -1;
+        check(layout.try_parse_label(layout.label_view(seat), again) && again == seat);
+    }
+
+    // scan_list against a plain split on spaces and tabs
+    std::size_t pos = 0;
+    seat_label::scan_list<G>(input, [&](std::string_view label, std::uint32_t code, int number) {
+        while (pos < input.size() && (input[pos] == ' ' || input[pos] == '\t')) ++pos;
+        std::size_t end = pos;
+        while (end < input.size() && input[end] != ' ' && input[end] != '\t') ++end;
+        check(label.data() == input.data() + pos && label.size() == end - pos);
+        pos = end;
+
+        std::uint32_t expected_code = 0;
+        int expected_number = 0;
+        const bool ok = seat_label::split_as<G>(label, expected_code, expected_number);
+        check(code == (ok ? expected_code : 0u));
+        check(!ok || number == expected_number);
+        return true;
+    });
+    while (pos < input.size() && (input[pos] == ' ' || input[pos] == '\t')) ++pos;
+    check(pos == input.size());
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    const std::string_view input(reinterpret_cast<const char*>(data), size);
+
+    int index0 = -1;
+    if (booking::BookingService::try_parse_seat_label(input, index0)) {
+        check(index0 >= 0 && index0 < 20); // the single row of seats a1..a20
+        int again = -1;
+        check(booking::BookingService::try_parse_seat_label(booking::BookingService::seat_label_from_index0(index0),
+                                                             again) && again == index0);
+    }
+
+    fuzz_grammar<seat_label::RowSeat>(input, seat_label::LabelGrammar::RowSeat);
+    fuzz_grammar<seat_label::SeatRow>(input, seat_label::LabelGrammar::SeatRow);
+    fuzz_grammar<seat_label::RowDashSeat>(input, seat_label::LabelGrammar::RowDashSeat);
+    return 0;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @file admission.hpp
+ * @brief Per-show admission gate ("virtual waiting room") for premiere traffic.
+ *
+ * On a ticket drop most bookers of a hot show would only lose the seat CAS. A gate hands
+ * out booking slots at a fixed rate, in arrival order: each admitted booker takes the
+ * next slot of a virtual schedule (generic cell rate algorithm), and a booker whose slot
+ * would start too far in the future is shed with one load, before its labels are even
+ * parsed. Gates are per show, so a hot show never slows down the others.
+ */
+
+namespace booking {
+
+/** @brief Admission rate of one show (BookingService::set_admission_policy). */
+struct AdmissionPolicy {
+    double per_second = 0.0; /**< Bookers admitted per second; <= 0 disables the gate. */
+    int burst = 1;           /**< Bookers that may be admitted back to back after a quiet period (>= 1). */
+};
+
+/**
+ * @brief Lock-free rate gate of one show.
+ *
+ * @details
+ * The state is the theoretical start of the next free slot (tat). Admitting at time t
+ * takes the slot max(tat, t) if it starts no later than t + tolerance, by CASing tat one
+ * interval further; tolerance = (burst - 1) intervals. A shed booker writes nothing, so
+ * the shedding rate does not depend on how many bookers are turned away.
+ */
+class AdmissionGate {
+public:
+    AdmissionGate() = default;
+    AdmissionGate(const AdmissionGate&) = delete;
+    AdmissionGate& operator=(const AdmissionGate&) = delete;
+
+    /** @brief Applies @p policy (a rate <= 0 opens the gate). Serialised by the caller. */
+    void configure(const AdmissionPolicy& policy) {
+        const std::int64_t interval =
+            policy.per_second > 0.0 ? std::max<std::int64_t>(1, static_cast<std::int64_t>(1e9 / policy.per_second)) : 0;
+        tolerance_ns_.store(interval * (std::max(policy.burst, 1) - 1), std::memory_order_relaxed);
+        interval_ns_.store(interval, std::memory_order_relaxed);
+    }
+
+    /** @brief True if the gate limits its show. */
+    bool enabled() const { return interval_ns_.load(std::memory_order_relaxed) != 0; }
+
+    /** @brief Takes the next slot if it starts by @p now_ns plus the burst tolerance. */
+    bool try_admit(std::int64_t now_ns) {
+        const std::int64_t interval = interval_ns_.load(std::memory_order_relaxed);
+        if (interval == 0) return true;
+        const std::int64_t tolerance = tolerance_ns_.load(std::memory_order_relaxed);
+        std::int64_t tat = tat_ns_.load(std::memory_order_relaxed);
+        while (true) {
+            const std::int64_t start = std::max(tat, now_ns);
+            if (start - now_ns > tolerance) return false; // shed: nothing written
+            if (tat_ns_.compare_exchange_weak(tat, start + interval, std::memory_order_relaxed)) return true;
+        }
+    }
+
+    /** @brief Nanoseconds from @p now_ns until a booker would be admitted again (0 = now). */
+    std::int64_t retry_after_ns(std::int64_t now_ns) const {
+        if (interval_ns_.load(std::memory_order_relaxed) == 0) return 0;
+        const std::int64_t wait = tat_ns_.load(std::memory_order_relaxed) - now_ns
+                                  - tolerance_ns_.load(std::memory_order_relaxed);
+        return wait > 0 ? wait : 0;
+    }
+
+private:
+    alignas(64) std::atomic<std::int64_t> tat_ns_{0}; /**< Start of the next free slot. */
+    std::atomic<std::int64_t> interval_ns_{0};        /**< Slot length; 0 = gate open. */
+    std::atomic<std::int64_t> tolerance_ns_{0};       /**< How far ahead a slot may start. */
+};
+
+} // namespace booking
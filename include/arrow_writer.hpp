@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file arrow_writer.hpp
+ * @brief Streaming writer of Apache Arrow IPC files (Feather v2) from column buffers.
+ *
+ * The file is what pyarrow.ipc.open_file, pandas.read_feather, Polars and DuckDB read:
+ *
+ *     "ARROW1" + 2 pad bytes
+ *     Schema message  RecordBatch message + body  ...  end-of-stream marker
+ *     Footer (schema and the location of every record batch)
+ *     i32 footer size  "ARROW1"
+ *
+ * Messages are encapsulated as 0xFFFFFFFF, an i32 metadata size, a flatbuffer (Arrow
+ * Message.fbs / Schema.fbs / File.fbs, metadata version V5) padded to 8 bytes, then the
+ * body. A body is the batch's buffers, each padded to 8 bytes and written straight from the
+ * caller's column memory: no row is ever assembled. Columns are non-nullable, so their
+ * validity buffers are empty.
+ *
+ * Only the column types the booking exports use are supported; every value is
+ * little-endian, as the host's.
+ */
+
+namespace booking {
+
+/** @brief Logical type of an Arrow column. */
+enum class ArrowType : std::uint8_t {
+    Int32,     /**< int32. */
+    UInt32,    /**< uint32. */
+    Int64,     /**< int64. */
+    Timestamp, /**< timestamp[s, tz=UTC], stored as int64 seconds since the epoch. */
+    Utf8,      /**< utf8: int32 offsets (rows + 1) into the characters. */
+};
+
+/** @brief Named column of a schema. */
+struct ArrowField {
+    std::string name;
+    ArrowType type = ArrowType::Int64;
+};
+
+/**
+ * @brief Column memory of one record batch (not owned; must stay valid during the call).
+ *
+ * Fixed-width types: @ref values points at the batch's values. Utf8: @ref values points at
+ * rows + 1 int32 offsets starting at 0, and @ref chars at the characters they index.
+ */
+struct ArrowColumn {
+    const void* values = nullptr;
+    const char* chars = nullptr;
+};
+
+/**
+ * @brief Writes one Arrow IPC file batch by batch.
+ *
+ * @details
+ * The file is written to "<path>.tmp" and renamed over @p path by @ref finish, so a reader
+ * never sees a partial export. Not thread-safe.
+ */
+class ArrowFileWriter {
+public:
+    explicit ArrowFileWriter(std::vector<ArrowField> schema);
+
+    /** @brief Removes the temporary file unless @ref finish succeeded. */
+    ~ArrowFileWriter();
+
+    ArrowFileWriter(const ArrowFileWriter&) = delete;
+    ArrowFileWriter& operator=(const ArrowFileWriter&) = delete;
+
+    /** @brief Creates the temporary file and writes the magic and the schema; false on an I/O error. */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Appends a record batch of @p rows rows (one ArrowColumn per schema field).
+     * @return False on an I/O error (later calls fail too).
+     */
+    bool write_batch(std::size_t rows, const ArrowColumn* columns);
+
+    /** @brief Writes the footer, syncs and renames the file into place; false on an I/O error. */
+    bool finish();
+
+    /** @brief Record batches written so far. */
+    std::size_t batches() const { return blocks_.size(); }
+
+    /** @brief Rows written so far. */
+    std::uint64_t rows() const { return rows_; }
+
+private:
+    /** @brief Footer entry of a record batch (File.fbs Block). */
+    struct Block {
+        std::int64_t offset;
+        std::int32_t metadata_length;
+        std::int32_t pad;
+        std::int64_t body_length;
+    };
+
+    /** @brief Writes @p size bytes and pads them to 8; false on an I/O error. */
+    bool put(const void* data, std::size_t size);
+
+    std::vector<ArrowField> schema_;
+    std::vector<Block> blocks_;
+    std::string path_;
+    std::string tmp_;
+    int fd_ = -1;
+    bool ok_ = false;
+    bool finished_ = false;
+    std::uint64_t offset_ = 0; /**< Bytes written (always a multiple of 8). */
+    std::uint64_t rows_ = 0;
+};
+
+} // namespace booking
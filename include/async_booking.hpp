@@ -0,0 +1,246 @@
+#pragma once
+
+#if __cplusplus < 202002L
+#error "async_booking.hpp needs C++20 coroutines (configure with -DCXX_STD=20)"
+#endif
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "booking_service.hpp"
+
+/**
+ * @file async_booking.hpp
+ * @brief Coroutine API over BookingService: many in-flight bookings on one thread.
+ *
+ * With a Sync journal every booking blocks its thread until the record is durable (and,
+ * with a commit wait, replicated), so a thread-per-request server needs a thread per
+ * booking in flight. Here a booking takes its seats at once, then suspends the coroutine
+ * that asked for it until its journal record is durable; one thread drives thousands of
+ * such coroutines through a CommitLoop, and one group commit resumes all of them.
+ *
+ * @code
+ * CommitLoop loop(service);
+ * loop.spawn([](CommitLoop& l, ShowId show) -> Task<void> {
+ *     const BookingResult res = co_await l.book_seats(show, {"a1", "a2"});
+ *     if (res.success) reply_ok(res.id); // durable here
+ * }(loop, show));
+ * loop.run();
+ * @endcode
+ */
+
+namespace booking {
+
+class CommitLoop;
+
+template <typename T>
+class Task;
+
+namespace detail {
+
+/** @brief Promise state shared by every Task: lazy start, continuation, detached frames. */
+struct TaskPromiseBase {
+    /** @brief Resumes the awaiting coroutine, or frees a spawned frame, at the end. */
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> done) noexcept {
+            TaskPromiseBase& p = done.promise();
+            if (p.continuation) return p.continuation;
+            if (p.spawned) {
+                --*p.spawned;
+                done.destroy();
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+
+    /** @brief The booking API reports failures by status, never by exception. */
+    void unhandled_exception() const noexcept { std::terminate(); }
+
+    std::coroutine_handle<> continuation; /**< Coroutine awaiting this task. */
+    std::size_t* spawned = nullptr;       /**< Live-task counter of the CommitLoop owning the frame. */
+};
+
+/** @brief Result slot of a Task<T>. */
+template <typename T>
+struct TaskResult {
+    void return_value(T value) { result.emplace(std::move(value)); }
+    T take() { return std::move(*result); }
+
+    std::optional<T> result;
+};
+
+template <>
+struct TaskResult<void> {
+    void return_void() const noexcept {}
+    void take() const noexcept {}
+};
+
+} // namespace detail
+
+/**
+ * @brief Lazily started coroutine returning @p T to the coroutine that co_awaits it.
+ *
+ * @details
+ * The body runs when the task is awaited (or spawned on a CommitLoop), and the awaiting
+ * coroutine is resumed by symmetric transfer when it returns, so chains of tasks never
+ * grow the stack. A task is owned by one awaiter; it is move-only.
+ */
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    struct promise_type : detail::TaskPromiseBase, detail::TaskResult<T> {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    T await_resume() { return handle_.promise().take(); }
+
+private:
+    friend class CommitLoop;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * @brief Single-threaded scheduler resuming coroutines once their journal records commit.
+ *
+ * @details
+ * Awaiting one of the operations below performs it immediately (the seats are taken
+ * before the first suspension, exactly as the blocking call would take them) and parks
+ * the coroutine on the operation's commit LSN. poll resumes every parked coroutine whose
+ * LSN is below the commit horizon; run additionally blocks on the journal for the oldest
+ * one until no spawned task is left. Without a Sync journal nothing is parked.
+ *
+ * A CommitLoop and its coroutines belong to one thread; the BookingService may be used
+ * by other threads (and other loops) at the same time.
+ */
+class CommitLoop {
+public:
+    /** @brief Returns the LSN below which commits are acknowledged. */
+    using Horizon = std::function<std::uint64_t()>;
+
+    /** @brief Loop over @p service (kept by reference), acknowledging at local durability. */
+    explicit CommitLoop(BookingService& service);
+
+    /** @brief Runs the remaining tasks to completion. */
+    ~CommitLoop();
+
+    CommitLoop(const CommitLoop&) = delete;
+    CommitLoop& operator=(const CommitLoop&) = delete;
+
+    /**
+     * @brief Replaces the commit horizon poll checks (default: the journal's durable LSN).
+     *
+     * With a quorum commit wait, poll must not acknowledge at local durability: pass e.g.
+     * the minimum of journal_durable_lsn and ReplicationSource::committed_lsn. run keeps
+     * blocking in BookingService::wait_journal, which includes the commit wait.
+     */
+    void set_horizon(Horizon horizon);
+
+    /** @brief Starts @p task on this thread (up to its first suspension); the loop owns its frame. */
+    void spawn(Task<void> task);
+
+    /** @brief Resumes the parked coroutines whose commits are acknowledged; returns how many. */
+    std::size_t poll();
+
+    /** @brief Drives parked coroutines, blocking on the journal, until every spawned task finished. */
+    void run();
+
+    /** @brief Coroutines parked on a commit. */
+    std::size_t pending() const { return parked_.size(); }
+
+    /** @brief Spawned tasks not finished yet. */
+    std::size_t active() const { return spawned_; }
+
+    /** @brief Awaiter of a commit LSN; co_await yields false if the journal failed. */
+    struct CommitAwaiter {
+        bool await_ready() const { return lsn == 0u || lsn <= loop->horizon_(); }
+        void await_suspend(std::coroutine_handle<> waiting) { loop->park(lsn, waiting); }
+        bool await_resume() const { return lsn == 0u || !loop->failed_; }
+
+        CommitLoop* loop;
+        std::uint64_t lsn;
+    };
+
+    /** @brief Awaiter of a booking; co_await yields its BookingResult once committed. */
+    struct BookingAwaiter : CommitAwaiter {
+        BookingResult await_resume() const { return result; }
+
+        BookingResult result;
+    };
+
+    /** @brief Awaits commit LSN @p lsn (0: nothing to wait for). */
+    CommitAwaiter commit(std::uint64_t lsn) { return CommitAwaiter{this, lsn}; }
+
+    /** @brief BookingService::book_seats, acknowledged once committed. */
+    BookingAwaiter book_seats(ShowId show_id, const std::vector<std::string>& seat_labels);
+
+    /** @brief BookingService::book_seat_mask, acknowledged once committed. */
+    BookingAwaiter book_seat_mask(ShowId show_id, const SeatMask& seats);
+
+    /** @brief BookingService::hold_seats (holds are not journaled: ready at once). */
+    BookingAwaiter hold_seats(ShowId show_id, const std::vector<std::string>& seat_labels,
+                              std::chrono::milliseconds ttl);
+
+    /** @brief BookingService::confirm_hold, acknowledged once committed. */
+    BookingAwaiter confirm_hold(HoldId hold_id);
+
+private:
+    /** @brief (commit LSN, coroutine), oldest LSN on top. */
+    using Parked = std::pair<std::uint64_t, std::coroutine_handle<>>;
+
+    struct LaterFirst {
+        bool operator()(const Parked& a, const Parked& b) const { return a.first > b.first; }
+    };
+
+    void park(std::uint64_t lsn, std::coroutine_handle<> waiting) { parked_.emplace(lsn, waiting); }
+
+    /** @brief Resumes the parked coroutines with LSN <= @p horizon. */
+    std::size_t resume_up_to(std::uint64_t horizon);
+
+    BookingService& service_;
+    Horizon horizon_;
+    std::priority_queue<Parked, std::vector<Parked>, LaterFirst> parked_;
+    std::size_t spawned_ = 0;
+    bool failed_ = false; /**< The journal reported a failed commit wait. */
+};
+
+} // namespace booking
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+/**
+ * @file atomic_wait.hpp
+ * @brief Sleeping until an atomic changes, without polling it.
+ *
+ * atomic_wait(a, old) blocks while @p a still holds @p old; atomic_notify_all(a) wakes the
+ * threads blocked on @p a after a store. Waiters are counted in a fixed table of parking
+ * buckets hashed by address, so a notify that finds no waiter in its bucket costs one load
+ * and no system call. On Linux a 4-byte atomic sleeps in futex(2) on its own word; other
+ * sizes and platforms sleep on the bucket's condition variable (a parking lot).
+ *
+ * Unlike std::atomic::wait (C++20), a notify only uses the address to find the bucket and
+ * never reads the atomic, so the waiter may free it as soon as it sees the new value: a
+ * request on the caller's stack can be completed and notified in that order.
+ */
+
+namespace booking {
+
+namespace atomic_wait_detail {
+
+/** @brief One parking bucket: the waiters of every atomic hashed to it. */
+struct alignas(64) Bucket {
+    std::atomic<std::uint32_t> waiters{0}; /**< Threads between announcing and leaving a wait. */
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+/** @brief Bucket of the atomic at @p address. */
+Bucket& bucket(const void* address);
+
+/** @brief Sleeps in futex(2) while the word at @p address holds @p old (may return spuriously). */
+void futex_wait(const void* address, std::uint32_t old);
+
+/** @brief Wakes every futex(2) waiter of the word at @p address. */
+void futex_wake_all(const void* address);
+
+/** @brief True if 4-byte atomics of type @p T can sleep in futex(2). */
+template <typename T>
+constexpr bool uses_futex() {
+#if defined(__linux__)
+    return sizeof(std::atomic<T>) == sizeof(std::uint32_t) && std::is_trivially_copyable<T>::value;
+#else
+    return false;
+#endif
+}
+
+} // namespace atomic_wait_detail
+
+/** @brief Blocks while @p a holds @p old (compared by value); returns once a load differs. */
+template <typename T>
+void atomic_wait(const std::atomic<T>& a, T old, std::memory_order order = std::memory_order_acquire) {
+    if (a.load(order) != old) return;
+    atomic_wait_detail::Bucket& b = atomic_wait_detail::bucket(&a);
+    b.waiters.fetch_add(1u);
+    std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the notifier's fence
+    if constexpr (atomic_wait_detail::uses_futex<T>()) {
+        std::uint32_t word = 0;
+        __builtin_memcpy(&word, &old, sizeof(T));
+        while (a.load(order) == old) atomic_wait_detail::futex_wait(&a, word);
+    } else {
+        std::unique_lock<std::mutex> lock(b.mutex);
+        b.cv.wait(lock, [&] { return a.load(order) != old; });
+    }
+    b.waiters.fetch_sub(1u, std::memory_order_release);
+}
+
+/** @brief Wakes the threads in @ref atomic_wait on @p a; call after the store they wait for. */
+template <typename T>
+void atomic_notify_all(const std::atomic<T>& a) {
+    atomic_wait_detail::Bucket& b = atomic_wait_detail::bucket(&a);
+    // Either the waiter's announcement precedes this fence and is seen below, or its next
+    // load of the atomic follows the fence and sees the store
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (b.waiters.load(std::memory_order_relaxed) == 0u) return;
+    if constexpr (atomic_wait_detail::uses_futex<T>()) {
+        atomic_wait_detail::futex_wake_all(&a);
+    } else {
+        { std::lock_guard<std::mutex> lock(b.mutex); } // a waiter past its check is in cv.wait now
+        b.cv.notify_all();
+    }
+}
+
+} // namespace booking
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "journal.hpp"
+
+/**
+ * @file audit_tap.hpp
+ * @brief Copy of every committed journal record, shipped to an external audit sink
+ *        (a message queue producer, a file) without ever making a booking wait for it.
+ *
+ * The journal's writer thread hands each group commit's records to an AuditTap
+ * (Journal::set_commit_tap, BookingService::set_journal_tap) right after the commit. The
+ * tap copies them into a lock-free single-producer byte ring; a sink thread of its own
+ * drains the ring every @ref AuditTapOptions::linger, cuts the records into batches of up
+ * to @ref AuditTapOptions::batch_bytes, compresses each batch and passes it to the sink.
+ *
+ * When the sink is slow or down the ring fills up. The writer thread then appends the
+ * records to a spill file instead (a buffered write, never a sync), and keeps doing so
+ * until the sink thread has delivered the whole file, so batches reach the sink in LSN
+ * order. Records still undelivered when the tap is destroyed are left in the spill file,
+ * and a tap opened on it later delivers them first. Delivery is at least once: a sink
+ * that fails after accepting a batch sees it again, so sinks deduplicate by LSN.
+ *
+ * Batch payload (all varints, see seat_map_codec.hpp), about 8 bytes for a typical
+ * booking against 40 in the journal:
+ *
+ *     count | first lsn
+ *     per record: lsn - previous end lsn | zigzag show delta | zigzag booking id delta
+ *                 | op byte | first word byte | word count byte
+ *                 | per word: n <= 7 then n column bytes, or 0xFF then the u64 word
+ */
+
+namespace booking {
+
+/** @brief One compressed batch of audit records. */
+struct AuditBatch {
+    std::uint64_t first_lsn = 0;       /**< LSN of the first record. */
+    std::uint64_t end_lsn = 0;         /**< LSN just after the last record. */
+    std::size_t records = 0;           /**< Records in the batch. */
+    std::size_t raw_bytes = 0;         /**< Their size in the journal format. */
+    std::vector<std::uint8_t> payload; /**< Encoded records (@ref decode_audit_batch). */
+};
+
+/**
+ * @brief Receives audit batches on the tap's sink thread, in LSN order.
+ * @return False if the batch was not accepted; it is offered again after
+ *         AuditTapOptions::retry, and nothing after it is offered meanwhile.
+ */
+using AuditSink = std::function<bool(const AuditBatch& batch)>;
+
+/** @brief Tuning of an AuditTap. */
+struct AuditTapOptions {
+    std::size_t ring_bytes = std::size_t{4} << 20;           /**< Ring size, rounded up to a power of two. */
+    std::size_t batch_bytes = std::size_t{64} << 10;         /**< Journal bytes per batch at most. */
+    std::chrono::milliseconds linger{5};                     /**< Longest a record waits to be batched. */
+    std::chrono::milliseconds retry{100};                    /**< Pause after the sink refused a batch. */
+    std::string spill_path;                                  /**< Spill file ("" = drop records instead). */
+};
+
+/** @brief Counters of an AuditTap (monotonic). */
+struct AuditStats {
+    std::uint64_t batches = 0;          /**< Batches the sink accepted. */
+    std::uint64_t records = 0;          /**< Records in them. */
+    std::uint64_t raw_bytes = 0;        /**< Their journal-format bytes. */
+    std::uint64_t payload_bytes = 0;    /**< Their encoded bytes. */
+    std::uint64_t delivered_lsn = 0;    /**< Records below this LSN were accepted. */
+    std::uint64_t sink_failures = 0;    /**< Batches the sink refused. */
+    std::uint64_t spilled_bytes = 0;    /**< Journal bytes that went to the spill file. */
+    std::uint64_t dropped_bytes = 0;    /**< Journal bytes lost: full ring and no (or a failing) spill file. */
+};
+
+/**
+ * @brief Appends @p records (journal-format bytes, see JournalReader::records) to @p out.
+ * @return The records encoded; a torn or corrupt record ends the input.
+ */
+std::size_t encode_audit_batch(std::string_view records, AuditBatch& out);
+
+/**
+ * @brief Decodes a batch payload into @p out (appended); false if it is malformed.
+ */
+bool decode_audit_batch(const std::uint8_t* payload, std::size_t size, std::vector<JournalRecord>& out);
+
+/**
+ * @brief Sink appending each batch to @p path as a frame (u32 little-endian payload
+ *        size, then the payload) and fdatasync-ing it; refuses batches while the file
+ *        cannot be opened or written.
+ */
+AuditSink audit_file_sink(const std::string& path);
+
+/**
+ * @brief Decodes every frame of a file written by @ref audit_file_sink into @p out.
+ * @return False if @p path cannot be read or a frame is malformed (earlier frames are kept).
+ */
+bool read_audit_file(const std::string& path, std::vector<JournalRecord>& out);
+
+/**
+ * @brief Non-blocking bridge from the journal's commits to an AuditSink.
+ *
+ * @details
+ * @ref offer is called by one thread only (the journal writer) and is lock-free unless it
+ * spills; the sink runs on the tap's own thread. Destroy the tap after the journal that
+ * feeds it (BookingService keeps its journal until it is destroyed).
+ */
+class AuditTap {
+public:
+    /**
+     * @brief Starts the sink thread; records left in an existing spill file are
+     *        delivered first (a torn tail is truncated).
+     */
+    AuditTap(AuditSink sink, AuditTapOptions options = {});
+
+    /** @brief Makes a last delivery attempt, then keeps what is left in the spill file. */
+    ~AuditTap();
+
+    AuditTap(const AuditTap&) = delete;
+    AuditTap& operator=(const AuditTap&) = delete;
+
+    /** @brief Queues committed journal @p records (whole records, in LSN order). Producer only. */
+    void offer(std::string_view records);
+
+    /** @brief Journal::CommitTap calling @ref offer. */
+    Journal::CommitTap journal_tap() {
+        return [this](std::string_view records) { offer(records); };
+    }
+
+    /**
+     * @brief Waits until everything offered before the call was delivered or dropped.
+     * @return False on timeout (e.g. the sink is down).
+     */
+    bool flush(std::chrono::milliseconds timeout);
+
+    /** @brief Current counters. */
+    AuditStats stats() const;
+
+    /** @brief True if a spill file was given and could be opened. */
+    bool spill_open() const { return spill_fd_ >= 0; }
+
+private:
+    void run();
+
+    /** @brief Moves queued records (the ring first, then the spill file) into @ref pending_. */
+    bool fill();
+
+    /** @brief Delivers @ref pending_ batch by batch; false once the sink refuses one. */
+    bool deliver_pending();
+
+    /** @brief Copies @p n ring bytes from position @p pos into @p out. */
+    void copy_out(std::uint64_t pos, std::size_t n, char* out) const;
+
+    /** @brief Appends @p records to the spill file (producer, or the sink thread at shutdown). */
+    bool spill(std::string_view records);
+
+    /** @brief Rewrites the spill file as the undelivered records, oldest first (at shutdown). */
+    void keep_undelivered();
+
+    AuditSink sink_;
+    const AuditTapOptions options_;
+    std::unique_ptr<char[]> ring_;
+    std::size_t mask_ = 0;
+    int spill_fd_ = -1;
+
+    alignas(64) std::atomic<std::uint64_t> tail_{0};  /**< Producer: next ring byte to write. */
+    std::uint64_t head_cache_ = 0;                    /**< Producer's copy of head_. */
+    bool spilling_ = false;                           /**< Producer: offers go to the spill file. */
+    std::uint64_t spill_end_ = 0;                     /**< Producer: logical end of the spill file. */
+    /** @brief Logical spill offset the file starts at (raised when the producer empties it). */
+    std::atomic<std::uint64_t> spill_base_{0};
+    std::atomic<std::uint64_t> spill_written_{0};     /**< Logical end published to the sink thread. */
+
+    alignas(64) std::atomic<std::uint64_t> head_{0};  /**< Sink thread: next ring byte to read. */
+    std::atomic<std::uint64_t> spill_read_{0};        /**< Sink thread: spill bytes delivered. */
+    std::string pending_;                             /**< Sink thread: records taken, not yet delivered. */
+    std::size_t pending_offset_ = 0;                  /**< Delivered prefix of pending_. */
+    bool pending_spilled_ = false;                    /**< pending_ came from the spill file. */
+
+    std::atomic<std::uint64_t> offered_bytes_{0};
+    std::atomic<std::uint64_t> settled_bytes_{0};     /**< Delivered or dropped. */
+    std::atomic<std::uint64_t> batches_{0};
+    std::atomic<std::uint64_t> records_{0};
+    std::atomic<std::uint64_t> raw_bytes_{0};
+    std::atomic<std::uint64_t> payload_bytes_{0};
+    std::atomic<std::uint64_t> delivered_lsn_{0};
+    std::atomic<std::uint64_t> sink_failures_{0};
+    std::atomic<std::uint64_t> spilled_bytes_{0};
+    std::atomic<std::uint64_t> dropped_bytes_{0};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+} // namespace booking
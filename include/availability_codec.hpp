@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "hall_layout.hpp"
+#include "ids.hpp"
+#include "seat_mask.hpp"
+
+/**
+ * @file availability_codec.hpp
+ * @brief Encoders writing a show's free seats straight from its seat words into a buffer.
+ *
+ * A network response needs the free seats as bytes, not as a vector of label strings that
+ * is joined afterwards. These encoders read the free-seat words (one per row, bit set =>
+ * seat free, as loaded by BookingService) and write one of three payloads into a caller's
+ * buffer, which a server can hand to writev next to its response header:
+ *
+ *     Bitmap   per row, ceil(seats / 8) bytes of the row's free bits (bit c = column c,
+ *              least significant bit first); the row widths come from the layout
+ *     Runs     3 bytes per run of adjacent free seats: u8 row, u8 first column, u8 length
+ *     Labels   the free seats' labels separated by ',' (HallLayout::render_labels)
+ *
+ * Bitmap has a fixed size for a layout (8 bytes for a 64-seat row), Runs is smallest for
+ * nearly empty or nearly sold out halls, and Labels needs no layout on the client.
+ *
+ * An availability blob (BookingService::encode_availability_blob) carries the payloads
+ * of every show in one versioned file for edge caches, all little-endian:
+ *
+ *     header   "BKAVAIL1" | u64 version | u64 show count | u8 encoding | 3 zero bytes
+ *              | u32 crc32c of everything after the header
+ *     index    per show, by ascending show id: i64 show id | u64 changes | u64 offset
+ *              | u32 size | i32 layout id
+ *     payload  per show, @c size bytes at @c offset (from the start of the blob)
+ *
+ * The index sits at a fixed place, so an edge can fetch the header and index first and
+ * then one show's payload with an HTTP range request; @c changes is the show's update
+ * counter, equal across versions for a show nobody booked.
+ */
+
+namespace booking {
+
+/** @brief Payload format of @ref encode_free_seats. */
+enum class SeatEncoding : std::uint8_t {
+    Bitmap = 0,
+    Runs = 1,
+    Labels = 2,
+};
+
+/** @brief Name of an encoding ("bitmap", "runs", "labels"). */
+const char* to_string(SeatEncoding encoding);
+
+/** @brief Number of encodings (valid values are below it). */
+constexpr std::uint8_t kSeatEncodings = 3;
+
+/** @brief Upper bound of the bytes @ref encode_free_seats writes for @p layout. */
+std::size_t max_encoded_size(const HallLayout& layout, SeatEncoding encoding);
+
+/**
+ * @brief Writes the free seats of @p free_words in @p encoding to @p out.
+ *
+ * @param free_words One word per row, @p word_count of them (at most layout.row_count());
+ *        bits of nonexistent seats are ignored.
+ * @param out Room for @ref max_encoded_size bytes; nothing is allocated.
+ * @return One past the last byte written.
+ */
+char* encode_free_seats(const HallLayout& layout, const std::uint64_t* free_words, int word_count,
+                        SeatEncoding encoding, char* out);
+
+/**
+ * @brief Decodes a Bitmap or Runs payload of @p layout into @p out (the free seats).
+ * @return False if the payload is malformed or names seats the layout does not have
+ *         (Labels payloads are not decoded).
+ */
+bool decode_free_seats(const HallLayout& layout, SeatEncoding encoding, const char* data, std::size_t size,
+                       SeatMask& out);
+
+/** @brief Bytes of an availability blob's header. */
+constexpr std::size_t kAvailabilityBlobHeader = 32;
+
+/** @brief Bytes of one index entry of an availability blob. */
+constexpr std::size_t kAvailabilityBlobEntry = 32;
+
+/** @brief One show of an availability blob's index. */
+struct AvailabilityBlobEntry {
+    ShowId show_id;             /**< Show. */
+    std::uint64_t changes = 0;  /**< The show's update counter when encoded. */
+    std::uint64_t offset = 0;   /**< Start of its payload in the blob. */
+    std::uint32_t size = 0;     /**< Bytes of its payload. */
+    LayoutId layout_id = -1;    /**< Layout to decode the payload with. */
+};
+
+/** @brief Header and index of an availability blob (see @ref read_availability_blob). */
+struct AvailabilityBlobIndex {
+    std::uint64_t version = 0;                  /**< Blob version (higher = newer). */
+    SeatEncoding encoding = SeatEncoding::Bitmap; /**< Encoding of every payload. */
+    std::vector<AvailabilityBlobEntry> shows;   /**< By ascending show id. */
+};
+
+/**
+ * @brief Reads the header and index of an availability blob.
+ * @return False if it is malformed: bad magic or checksum, unknown encoding, or a payload
+ *         outside the blob.
+ */
+bool read_availability_blob(const char* data, std::size_t size, AvailabilityBlobIndex& out);
+
+} // namespace booking
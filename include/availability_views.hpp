@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ids.hpp"
+
+/**
+ * @file availability_views.hpp
+ * @brief Per-movie show orderings by seats left and by cheapest free seat.
+ *
+ * BookingService::enable_availability_views keeps one AvailabilityViews in step with the
+ * seat change feed (change_feed.hpp): every change names a show whose statistics are
+ * recomputed from its authoritative words and moved within its movie's two orderings.
+ * The views therefore never re-sort a movie's shows; "sort by availability" listings
+ * walk the first entries of an ordering.
+ *
+ * Updates are idempotent (a show's entry is replaced by the statistics it has now), so
+ * a change applied twice, or after the state it describes was already read, is harmless.
+ */
+
+namespace booking {
+
+/** @brief One show of an availability view. */
+struct RankedShow {
+    ShowId show_id;
+    int seats_left = 0;                  /**< Free seats. */
+    std::uint32_t cheapest_price = 0;    /**< Price of the cheapest free seat (kNoPrice if none is for sale). */
+
+    static constexpr std::uint32_t kNoPrice = std::numeric_limits<std::uint32_t>::max();
+};
+
+/**
+ * @brief Shows of each movie ordered by seats left (most first) and by cheapest free seat
+ *        (cheapest first), maintained one show at a time.
+ *
+ * @details
+ * Thread-safe: updates take an exclusive lock, queries a shared one. Ties are broken by
+ * show id, so orderings are deterministic.
+ */
+class AvailabilityViews {
+public:
+    /** @brief Adds @p show of @p movie (replacing an earlier entry of the same id). */
+    void add_show(ShowId show, MovieId movie, int seats_left, std::uint32_t cheapest_price);
+
+    /** @brief Removes @p show; false if it is not in the views. */
+    bool remove_show(ShowId show);
+
+    /** @brief Moves @p show to its new place in its movie's orderings; false if it is not in the views. */
+    bool update(ShowId show, int seats_left, std::uint32_t cheapest_price);
+
+    /** @brief Whether @p show is in the views. */
+    bool contains(ShowId show) const;
+
+    /** @brief Shows in the views. */
+    std::size_t size() const;
+
+    /** @brief Estimated bytes: a map node per show and movie, and a tree node per ordering key. */
+    std::size_t bytes() const;
+
+    /** @brief Ids of every show in the views (for a full resync). */
+    std::vector<ShowId> shows() const;
+
+    /** @brief Up to @p limit shows of @p movie, most seats left first. */
+    std::vector<RankedShow> by_seats_left(MovieId movie, std::size_t limit) const;
+
+    /** @brief Up to @p limit shows of @p movie with a seat for sale, cheapest first. */
+    std::vector<RankedShow> by_cheapest_seat(MovieId movie, std::size_t limit) const;
+
+private:
+    /** @brief Ordering key: (rank, show id) with the smaller rank first. */
+    struct Key {
+        std::int64_t rank;
+        std::int64_t show;
+        bool operator<(const Key& o) const { return rank != o.rank ? rank < o.rank : show < o.show; }
+    };
+
+    struct Entry {
+        MovieId movie;
+        int seats_left = 0;
+        std::uint32_t cheapest_price = RankedShow::kNoPrice;
+    };
+
+    struct MovieView {
+        std::set<Key> by_seats; /**< rank = -seats_left. */
+        std::set<Key> by_price; /**< rank = cheapest_price; shows with nothing for sale are left out. */
+    };
+
+    void insert_keys(ShowId show, const Entry& e);
+    void erase_keys(ShowId show, const Entry& e);
+    std::vector<RankedShow> walk(const std::set<Key>& order, std::size_t limit) const;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<ShowId, Entry> shows_;
+    std::unordered_map<MovieId, MovieView> movies_;
+};
+
+} // namespace booking
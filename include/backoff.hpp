@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <thread>
+
+/**
+ * @file backoff.hpp
+ * @brief Bounded exponential backoff for CAS retry loops.
+ *
+ * A failed compare-and-swap means another thread won the word. Retrying immediately makes
+ * every contender hammer the same cache line, so retries back off in three stages:
+ * a few pause instructions, exponentially more pauses, then yielding the CPU. After
+ * BackoffPolicy::max_retries failed attempts the caller gives up instead of spinning forever.
+ */
+
+namespace booking {
+
+/**
+ * @brief Tuning knobs for CAS retry loops.
+ */
+struct BackoffPolicy {
+    std::uint32_t max_retries = 256;    /**< Failed CAS attempts before giving up (0 = unbounded). */
+    std::uint32_t max_pause_spins = 64; /**< Upper bound of pause instructions per backoff step. */
+    std::uint32_t yield_after = 16;     /**< Retries after which each step also yields the CPU. */
+};
+
+/** @brief Processor hint that the current thread is busy-waiting. */
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/**
+ * @brief Per-operation backoff state.
+ *
+ * @details
+ * Construct one per CAS loop and call @ref retry after each failed attempt.
+ */
+class Backoff {
+public:
+    explicit Backoff(const BackoffPolicy& policy) : policy_(policy) {}
+
+    /**
+     * @brief Waits before the next attempt.
+     * @return False once the retry budget is exhausted (the caller should give up).
+     */
+    bool retry() {
+        ++retries_;
+        if (policy_.max_retries != 0 && retries_ > policy_.max_retries) return false;
+
+        for (std::uint32_t i = 0; i < spins_; ++i) cpu_relax();
+        if (spins_ < policy_.max_pause_spins) spins_ *= 2;
+        if (retries_ > policy_.yield_after) std::this_thread::yield();
+        return true;
+    }
+
+    /** @brief Failed attempts so far. */
+    std::uint32_t retries() const { return retries_; }
+
+private:
+    const BackoffPolicy& policy_;
+    std::uint32_t retries_ = 0;
+    std::uint32_t spins_ = 1;
+};
+
+} // namespace booking
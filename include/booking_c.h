@@ -0,0 +1,142 @@
+#ifndef BOOKING_C_H
+#define BOOKING_C_H
+
+/**
+ * @file booking_c.h
+ * @brief C ABI over BookingService for embedding it in other languages (cgo, ctypes, cffi).
+ *
+ * The service is an opaque handle. Seats cross the boundary as seat masks, one uint64_t
+ * word per row with bit c of word r = seat (r, c) (the layout of SeatMask); callers pass
+ * as many words as their show has rows, at most BOOKING_MASK_WORDS. Label lists are one
+ * caller-owned byte string ("a1 a2 b7") and listings are written into caller buffers, so
+ * no call allocates on the caller's behalf or needs a vector of strings marshalled.
+ *
+ * Every call that can fail returns an int: 0 (BOOKING_OK) on success, a positive
+ * BookingStatus value when the service rejected the request (the same numbering as the
+ * C++ enum), or a negative booking_error when the call itself was wrong or failed. No
+ * C++ exception crosses the boundary. A handle may be used from many threads at once,
+ * exactly like the BookingService it wraps; only booking_service_destroy must not race
+ * with other calls.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Words of a full seat mask (rows of the largest layout). */
+#define BOOKING_MASK_WORDS 64
+
+/** @brief Success (BookingStatus::Ok, ScheduleStatus::Ok). */
+#define BOOKING_OK 0
+
+/** @brief Errors of the calls themselves (negative, unlike the service's statuses). */
+enum booking_error {
+    BOOKING_E_ARGUMENT = -1,     /**< A required pointer is null or a size is out of range. */
+    BOOKING_E_BUFFER = -2,       /**< The output buffer is too small; the needed size is reported. */
+    BOOKING_E_UNKNOWN_SHOW = -3, /**< The show does not exist (reads; bookings report InvalidShow). */
+    BOOKING_E_NO_MEMORY = -4,    /**< An allocation failed. */
+    BOOKING_E_INTERNAL = -5      /**< Any other C++ exception. */
+};
+
+/** @brief Opaque BookingService. */
+typedef struct booking_service booking_service;
+
+/** @brief Details of a booking call (BookingResult). */
+typedef struct booking_result {
+    int32_t status;                          /**< BookingStatus value (0 = Ok). */
+    int32_t label_index;                     /**< Label/index errors: position of the offending entry, else -1. */
+    uint64_t id;                             /**< BookingId of bookings and confirms, HoldId of holds, else 0. */
+    uint64_t conflicts[BOOKING_MASK_WORDS];  /**< AlreadyBooked: seats taken; NotOwner: seats not owned. */
+} booking_result;
+
+/** @brief Service with the sample catalog (BookingService()); NULL if it cannot be allocated. */
+booking_service* booking_service_create(void);
+
+/** @brief Service with an empty catalog, to fill with booking_load_schedule_file. */
+booking_service* booking_service_create_empty(void);
+
+/** @brief Destroys @p service (NULL is ignored). */
+void booking_service_destroy(booking_service* service);
+
+/**
+ * @brief Loads a schedule export into the catalog (BookingService::load_schedule_file).
+ * @param out_line If not NULL, receives the 1-based line of a ParseError (0 otherwise).
+ * @return BOOKING_OK, a positive ScheduleStatus value or a booking_error.
+ */
+int booking_load_schedule_file(booking_service* service, const char* path, size_t* out_line);
+
+/** @brief First show of a movie at a theater, or -1 if there is none (or @p service is NULL). */
+int64_t booking_find_show(const booking_service* service, int64_t movie_id, int64_t theater_id);
+
+/** @brief Rows of the show's layout (the words of its seat masks), or a booking_error. */
+int booking_show_rows(const booking_service* service, int64_t show_id);
+
+/**
+ * @brief Writes the label of seat index @p seat (row * 64 + column) as a NUL-terminated string.
+ * @return Label length, or a booking_error (BOOKING_E_BUFFER if @p capacity is not above it).
+ */
+int booking_seat_label(const booking_service* service, int64_t show_id, int seat, char* buffer, size_t capacity);
+
+/**
+ * @brief Free seats of a show as a mask (BookingService::available_seats_mask).
+ * @param out_words Receives the first @p n_words words; rows past them are not reported.
+ * @return Number of free seats in the whole show, or a booking_error.
+ */
+int booking_available_mask(const booking_service* service, int64_t show_id, uint64_t* out_words, size_t n_words);
+
+/** @brief Number of free seats of a show, or a booking_error. */
+int booking_available_count(const booking_service* service, int64_t show_id);
+
+/**
+ * @brief Free seat labels separated by spaces ("a1 a2 a5"), NUL-terminated.
+ * @param out_length If not NULL, receives the label text's length, also when the buffer is
+ *        too small (then BOOKING_E_BUFFER is returned and @p buffer holds nothing useful).
+ * @return Number of free seats, or a booking_error.
+ */
+int booking_available_labels(const booking_service* service, int64_t show_id, char* buffer, size_t capacity,
+                             size_t* out_length);
+
+/**
+ * @brief Books a seat mask, all-or-nothing (BookingService::book_seat_mask).
+ * @param result If not NULL, receives the details (the BookingId in result->id).
+ * @return BOOKING_OK, a positive BookingStatus value or a booking_error.
+ */
+int booking_book_mask(booking_service* service, int64_t show_id, const uint64_t* words, size_t n_words,
+                      booking_result* result);
+
+/** @brief Books a label list ("a1 a2 b7", @p length bytes, no NUL needed) (BookingService::book_label_list). */
+int booking_book_labels(booking_service* service, int64_t show_id, const char* labels, size_t length,
+                        booking_result* result);
+
+/**
+ * @brief Books the best @p n adjacent free seats (BookingService::book_best_available).
+ * @param out_words If not NULL, receives the first @p n_words words of the booked seats.
+ */
+int booking_book_best_available(booking_service* service, int64_t show_id, int n, uint64_t* out_words,
+                                size_t n_words, booking_result* result);
+
+/** @brief Cancels seats of booking @p booking_id (BookingService::cancel_seat_mask). */
+int booking_cancel_mask(booking_service* service, int64_t show_id, const uint64_t* words, size_t n_words,
+                        uint32_t booking_id, booking_result* result);
+
+/** @brief Holds a seat mask for @p ttl_ms milliseconds (the HoldId in result->id). */
+int booking_hold_mask(booking_service* service, int64_t show_id, const uint64_t* words, size_t n_words,
+                      uint32_t ttl_ms, booking_result* result);
+
+/** @brief Turns a hold into a booking (the BookingId in result->id). */
+int booking_confirm_hold(booking_service* service, uint64_t hold_id, booking_result* result);
+
+/** @brief Releases a hold. */
+int booking_release_hold(booking_service* service, uint64_t hold_id, booking_result* result);
+
+/** @brief Static description of a return code: a BookingStatus value or a booking_error. */
+const char* booking_status_string(int code);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* BOOKING_C_H */
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "booking_service.hpp"
+
+/**
+ * @file booking_history.hpp
+ * @brief Recording of concurrent booking histories and an offline linearizability check.
+ *
+ * Worker threads record every booking, cancellation and hold they run, together with
+ * the ticks of a shared logical clock taken just before the call and just after it
+ * returned (HistoryRecorder). check_linearizable then decides whether some sequential
+ * order of the recorded operations exists that respects their real-time order and that a
+ * single-threaded seat map would answer exactly as the service did. This is the search of
+ * Wing and Gong, with Lowe's memoisation of (operations linearized, state).
+ *
+ * The search is specialised for seat sets, which keeps large histories tractable:
+ * - Operations on different shows, or on disjoint seats of one show, commute. Each
+ *   connected group of overlapping operations is checked on its own.
+ * - Every group is cut at quiescent points (no operation in flight). The seat owners
+ *   after all the operations before a cut do not depend on their order, so each segment
+ *   starts from the state the previous one ended in.
+ *
+ * Outcomes that depend on nothing the model tracks are left out: Contended, Throttled,
+ * validation errors, failed confirms and releases (an unrecorded expiry may have settled
+ * the hold), and conflicts with a concurrent request that failed too (it may have held
+ * some of the seats before rolling back). The history must start on empty shows, and holds must not expire
+ * while it is recorded.
+ */
+
+namespace booking {
+
+/** @brief Operation of a history event. */
+enum class HistoryOp : std::uint8_t {
+    Book,        /**< Seats booked all-or-nothing; id = the BookingId. */
+    Cancel,      /**< arg = the BookingId the seats were cancelled under. */
+    Hold,        /**< Seats held; id = the HoldId. */
+    ConfirmHold, /**< arg = the HoldId; id = the new BookingId. */
+    ReleaseHold, /**< arg = the HoldId. */
+};
+
+/** @brief Static name of a history operation (e.g. "book"). */
+const char* to_string(HistoryOp op);
+
+/** @brief One completed operation of a history. */
+struct HistoryEvent {
+    HistoryOp op = HistoryOp::Book;
+    BookingStatus status = BookingStatus::Ok;
+    std::uint32_t thread = 0;
+    ShowId show_id;
+    std::uint64_t arg = 0;       /**< See HistoryOp. */
+    std::uint64_t id = 0;        /**< BookingResult::id. */
+    std::uint64_t invoked = 0;   /**< Clock tick before the call. */
+    std::uint64_t completed = 0; /**< Clock tick after it returned. */
+    std::uint32_t words = 0;     /**< Offset of the seat words in History::words. */
+    std::int16_t first_word = 0; /**< Seats: words [first_word, end_word) of the mask. */
+    std::int16_t end_word = 0;
+};
+
+/** @brief Recorded operations of all threads; seat masks stored compactly. */
+struct History {
+    std::vector<HistoryEvent> events;
+    std::vector<std::uint64_t> words; /**< Seat words of all events, back to back. */
+
+    /** @brief Seats of @p event (empty for confirms and releases). */
+    SeatMask seats(const HistoryEvent& event) const;
+};
+
+/**
+ * @brief Per-thread, lock-free recorder of a History.
+ *
+ * @details
+ * Thread t appends to its own lane only; the clock is the one shared atomic. Usage:
+ * @code
+ * const std::uint64_t t0 = recorder.now();
+ * const BookingResult r = svc.book_seat_mask(show, seats);
+ * recorder.record(thread, HistoryOp::Book, show, seats, 0, t0, r);
+ * @endcode
+ */
+class HistoryRecorder {
+public:
+    /** @brief Recorder for threads 0..@p threads-1. */
+    explicit HistoryRecorder(unsigned threads);
+
+    HistoryRecorder(const HistoryRecorder&) = delete;
+    HistoryRecorder& operator=(const HistoryRecorder&) = delete;
+
+    /** @brief Next tick of the logical clock (take it right before the call). */
+    std::uint64_t now() { return clock_.fetch_add(1u, std::memory_order_acq_rel); }
+
+    /**
+     * @brief Appends an operation of thread @p thread invoked at tick @p invoked that
+     *        returned @p result; ticks its completion.
+     *
+     * @param seats The seats requested (or given back by the service, e.g. best
+     *        available); ignored for confirms and releases.
+     */
+    void record(unsigned thread, HistoryOp op, ShowId show_id, const SeatMask& seats, std::uint64_t arg,
+                std::uint64_t invoked, const BookingResult& result);
+
+    /** @brief Operations recorded so far. Call once the threads stopped recording. */
+    std::size_t size() const;
+
+    /** @brief Merges the lanes into one history (in completion order) and clears them. */
+    History take();
+
+private:
+    struct alignas(64) Lane {
+        History history;
+    };
+
+    std::vector<Lane> lanes_;
+    std::atomic<std::uint64_t> clock_{1};
+};
+
+/** @brief Outcome of check_linearizable. */
+enum class LinearizabilityVerdict : std::uint8_t {
+    Linearizable, /**< Some legal sequential order exists. */
+    Violation,    /**< No legal order: see LinearizabilityReport::witness. */
+    Unknown,      /**< The step budget ran out first. */
+};
+
+/** @brief Static name of a verdict (e.g. "linearizable"). */
+const char* to_string(LinearizabilityVerdict verdict);
+
+/** @brief Result of check_linearizable. */
+struct LinearizabilityReport {
+    LinearizabilityVerdict verdict = LinearizabilityVerdict::Linearizable;
+    std::size_t checked = 0;  /**< Events the model constrains (the others are left out). */
+    std::size_t groups = 0;   /**< Independent segments searched. */
+    std::size_t largest = 0;  /**< Events of the largest segment. */
+    std::uint64_t steps = 0;  /**< Search steps taken. */
+    ShowId show_id;           /**< Violation: the show. */
+    std::vector<std::size_t> witness; /**< Violation: indices in History::events of the failing segment. */
+};
+
+/**
+ * @brief Checks that @p history is linearizable with respect to a sequential seat map.
+ *
+ * @param max_steps Search budget over all segments; Unknown once it is spent.
+ */
+LinearizabilityReport check_linearizable(const History& history, std::uint64_t max_steps = std::uint64_t{1} << 26);
+
+} // namespace booking
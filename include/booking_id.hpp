@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @file booking_id.hpp
+ * @brief Booking identifiers and a scalable generator handing out per-thread id blocks.
+ *
+ * A single shared counter would make every booking thread increment the same cache line.
+ * Instead each thread reserves a block of ids with one atomic add and then allocates from
+ * it without any shared write, so the counter is touched once per kBlockSize bookings.
+ * Ids are unique per generator but not ordered across threads.
+ */
+
+namespace booking {
+
+/**
+ * @brief Booking identifier returned by successful bookings (never 0).
+ *
+ * Every seat of a booking records its BookingId; a cancellation must present it.
+ */
+using BookingId = std::uint32_t;
+
+/**
+ * @brief Thread-scalable BookingId generator.
+ */
+class BookingIdGenerator {
+public:
+    /** @brief Number of ids reserved by a thread at a time. */
+    static constexpr BookingId kBlockSize = 1024;
+
+    BookingIdGenerator() : serial_(next_serial().fetch_add(1, std::memory_order_relaxed)) {}
+
+    BookingIdGenerator(const BookingIdGenerator&) = delete;
+    BookingIdGenerator& operator=(const BookingIdGenerator&) = delete;
+
+    /** @brief Returns a fresh, non-zero id. */
+    BookingId next() {
+        // One cached block per thread; the serial tells generators apart, so a block
+        // cached for a destroyed generator is never reused by a new one at the same address
+        thread_local Block block;
+        if (block.serial != serial_ || block.next == block.end) {
+            const BookingId begin = blocks_->fetch_add(kBlockSize, std::memory_order_relaxed);
+            block = Block{serial_, begin, begin + kBlockSize};
+        }
+        BookingId id = block.next++;
+        if (id == 0u) id = next(); // 0 means "no booking"; only hit on the first block / wrap-around
+        return id;
+    }
+
+    /**
+     * @brief Makes sure blocks reserved from now on only contain ids greater than @p id
+     *        (e.g. after restoring bookings).
+     *
+     * @note Blocks already cached by threads are not affected.
+     */
+    void advance_past(BookingId id) {
+        const BookingId floor = (id / kBlockSize + 1u) * kBlockSize;
+        BookingId cur = blocks_->load(std::memory_order_relaxed);
+        while (cur < floor && !blocks_->compare_exchange_weak(cur, floor, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Reserves blocks from @p counter from now on (e.g. one in shared memory that the
+     *        generators of several processes use), after moving it past this generator's ids.
+     *
+     * @note Call before handing out ids concurrently; @p counter must outlive the generator.
+     */
+    void share(std::atomic<BookingId>& counter) {
+        const BookingId own = blocks_->load(std::memory_order_relaxed);
+        blocks_ = &counter;
+        if (own != 0u) advance_past(own - 1u);
+    }
+
+    /** @brief Number of ids reserved so far (upper bound of ids handed out). */
+    std::uint64_t reserved() const { return blocks_->load(std::memory_order_relaxed); }
+
+private:
+    struct Block {
+        std::uint64_t serial = 0; /**< Generator that reserved the block (0 = none). */
+        BookingId next = 0;       /**< Next id to return. */
+        BookingId end = 0;        /**< One past the last id of the block. */
+    };
+
+    static std::atomic<std::uint64_t>& next_serial() {
+        static std::atomic<std::uint64_t> serial{1};
+        return serial;
+    }
+
+    std::uint64_t serial_;                 /**< Unique, never reused generator serial. */
+    std::atomic<BookingId> next_block_{0}; /**< First id of the next unreserved block (unless shared). */
+    std::atomic<BookingId>* blocks_ = &next_block_; /**< Counter blocks are reserved from. */
+};
+
+} // namespace booking
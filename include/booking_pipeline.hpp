@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "booking_service.hpp"
+#include "mpsc_queue.hpp"
+
+/**
+ * @file booking_pipeline.hpp
+ * @brief Two-stage booking pipeline: validation on the I/O threads, seat updates on workers.
+ *
+ * A front end that books label requests inline spends most of each call parsing labels
+ * and validating the request while holding the booking thread of a hot show. Here the two
+ * stages are separate. Any number of I/O threads @ref BookingPipeline::prepare requests
+ * into compact seat masks (label parsing, layout and duplicate checks, rejections answered
+ * on the spot). They then @ref BookingPipeline::submit the masks to a fixed set of booking
+ * workers, which only run the CAS. Show s is booked by worker s % workers, so the updates
+ * of a hot show stay on one core and never wait behind validation, and each stage can be
+ * sized separately.
+ *
+ * With a queue bound, the hand-off between the stages is bounded too: a submission to a
+ * worker that already has that many requests waiting is refused with BookingStatus::Busy
+ * instead of queued, so an overloaded pipeline answers quickly rather than letting
+ * requests wait behind an ever longer queue. The I/O thread answers the refusal and can
+ * stop reading its sockets until the depths (PipelineStats) fall.
+ */
+
+namespace booking {
+
+/**
+ * @brief A prepared booking handed from the validation stage to a booking worker.
+ *
+ * @details Owned by the caller (embed it in the connection's or request's own state); it
+ * must stay alive until @ref done has run. Derive from it to carry the caller's context.
+ */
+struct PipelineRequest : MpscNode {
+    ShowId show_id;
+    SeatMask seats;       /**< Filled by BookingPipeline::prepare. */
+    BookingResult result; /**< Outcome, set before @ref done runs. */
+
+    /** @brief Completion, called on the booking worker (keep it short: it delays the show's next update). */
+    void (*done)(PipelineRequest& request) = nullptr;
+};
+
+/** @brief Counters of a BookingPipeline (approximate while requests are running). */
+struct PipelineStats {
+    std::uint64_t prepared = 0; /**< Requests validated into a mask. */
+    std::uint64_t rejected = 0; /**< Requests failed by validation (never submitted). */
+    std::uint64_t booked = 0;   /**< Requests run by the workers, successful or not. */
+    std::uint64_t busy = 0;     /**< Submissions refused because their worker's queue was full. */
+    std::uint64_t queued = 0;   /**< Requests submitted but not yet run, over all workers. */
+    std::uint64_t max_queued = 0; /**< Deepest any worker's queue has been. */
+};
+
+/**
+ * @brief Pool of booking workers fed by lock-free MPSC queues.
+ *
+ * @details
+ * One intrusive MpscQueue per worker takes submissions from every I/O thread without
+ * allocating. Idle workers spin briefly, then park on a condition variable; submitters
+ * only notify a worker that announced it is parking (as in ShowExecutor).
+ */
+class BookingPipeline {
+public:
+    /**
+     * @brief Starts @p workers booking threads over @p service (0 = hardware concurrency).
+     * @param max_queue_depth Requests a worker may have waiting before @ref submit refuses
+     *        more (0 = unbounded).
+     */
+    explicit BookingPipeline(BookingService& service, unsigned workers = 0, std::size_t max_queue_depth = 0);
+
+    /** @brief Runs the submitted requests, then stops the workers. */
+    ~BookingPipeline();
+
+    BookingPipeline(const BookingPipeline&) = delete;
+    BookingPipeline& operator=(const BookingPipeline&) = delete;
+
+    /** @brief Number of booking workers. */
+    unsigned worker_count() const { return static_cast<unsigned>(workers_.size()); }
+
+    /** @brief Worker booking show @p show_id. */
+    unsigned worker_of(ShowId show_id) const {
+        if (show_id.value() < 0) return 0u;
+        return static_cast<unsigned>(static_cast<std::uint64_t>(show_id.value()) % workers_.size());
+    }
+
+    /**
+     * @brief Validation stage: parses @p seat_labels of @p show_id into @p request.
+     *
+     * @details Runs on the calling thread and touches no seat. Thread-safe.
+     * @return Ok if the request may be @ref submit "submitted"; otherwise the booking
+     *         error to answer (as BookingService::parse_seat_labels).
+     */
+    BookingResult prepare(PipelineRequest& request, ShowId show_id, Span<const std::string_view> seat_labels);
+
+    /**
+     * @brief Booking stage: queues a prepared @p request to its show's worker, which books
+     *        its mask (BookingService::book_seat_mask) and calls its completion. Thread-safe.
+     * @return False if the worker's queue is full: the request was not queued, its result
+     *         is Busy and its completion is not called.
+     */
+    bool submit(PipelineRequest& request);
+
+    /** @brief Requests waiting for or running on worker @p worker (approximate). */
+    std::size_t queue_depth(unsigned worker) const {
+        return workers_[worker]->depth.load(std::memory_order_relaxed);
+    }
+
+    PipelineStats stats() const;
+
+private:
+    struct alignas(64) Worker {
+        MpscQueue queue;
+        std::thread thread;
+        std::atomic<bool> parked{false}; /**< Announced before sleeping (Dekker with submit). */
+        std::mutex park_mutex;
+        std::condition_variable park_cv;
+        std::atomic<std::uint64_t> booked{0}; /**< Written by the worker only. */
+        std::atomic<std::size_t> depth{0};     /**< Submitted, not yet run: reserved by submit, released by the worker. */
+        std::atomic<std::size_t> max_depth{0};
+        std::atomic<std::uint64_t> busy{0};
+    };
+
+    /** @brief Books every request queued for @p w; returns how many ran. */
+    std::size_t drain(Worker& w);
+    void worker_loop(Worker& w);
+
+    BookingService& service_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<std::uint64_t> prepared_{0};
+    std::atomic<std::uint64_t> rejected_{0};
+    std::size_t max_queue_depth_ = 0;
+    std::atomic<bool> stopping_{false};
+};
+
+} // namespace booking
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "booking_service.hpp"
+#include "http_gateway.hpp"
+#include "text_protocol.hpp"
+#include "wire_protocol.hpp"
+
+/**
+ * @file booking_server.hpp
+ * @brief Non-blocking TCP front end speaking the text protocol (see text_protocol.hpp).
+ *
+ * The same port also serves the binary protocol (wire_protocol.hpp) and HTTP/1.1
+ * (http_gateway.hpp): a connection's first byte picks its protocol (kWireMagic for binary,
+ * an uppercase letter, as in "GET", for HTTP; text commands are lowercase).
+ *
+ * One thread runs an edge-triggered epoll loop over the listening socket and every
+ * connection; there is no thread per connection. Each readable event reads everything
+ * the kernel has, executes every complete request line in order and sends all their
+ * responses with one write, so pipelined requests cost one read and one write per batch.
+ * A connection whose unsent responses exceed a high-water mark is not read again until
+ * they drain (backpressure on clients that pipeline without reading). With a client rate
+ * limit every request is first charged to its peer address's token bucket
+ * (rate_limiter.hpp); requests over the limit are answered Throttled unparsed.
+ *
+ * With the io_uring backend the same loop is completion-based: accepts, receives (into
+ * registered buffers, on registered "fixed" file slots) and sends are queued on one ring
+ * and a whole round of them is submitted and reaped with a single io_uring_enter call.
+ * Kernels or sandboxes without io_uring fall back to epoll.
+ *
+ * With BookingServerOptions::busy_poll_us the loop never sleeps: epoll is polled with a
+ * zero timeout, or the io_uring completion queue is spun on without entering the kernel,
+ * and every socket asks the kernel to busy-poll its device queue (SO_BUSY_POLL) instead of
+ * waiting for an interrupt. That trades one core (pin it with poll_cpu) for receive
+ * latency without the wake-up of a sleeping thread.
+ *
+ * Every text connection is a session with its own TextCommandHandler: the show handles
+ * it has routed (ShowRoutes), its token buffer and the show it named last stay with the
+ * customer across requests, since one session browses and books one show. In
+ * OwnerThreads mode (BookingService::set_execution_mode) the session is pinned to that
+ * show's owner thread: each batch of lines read from the connection is parsed, executed
+ * and answered on the owner in one hand-off (BookingService::run_on_owner) rather than
+ * one per booking, so the show's words, its cached seat map and the session's buffers
+ * stay in one core's cache.
+ */
+
+namespace booking {
+
+/**
+ * @brief Outcome of BookingServer::listen.
+ */
+enum class ServerStatus : std::uint8_t {
+    Ok,           /**< Listening. */
+    SocketError,  /**< socket/epoll/eventfd creation failed. */
+    BindError,    /**< Address invalid or in use. */
+    ListenError,  /**< listen() failed. */
+};
+
+/** @brief Static description of a server status. */
+const char* to_string(ServerStatus status);
+
+/**
+ * @brief Event loop implementation.
+ */
+enum class ServerBackend : std::uint8_t {
+    Auto,     /**< io_uring when the kernel allows it, else Epoll. */
+    Epoll,    /**< Edge-triggered epoll + recv/send. */
+    IoUring,  /**< io_uring with fixed files and registered receive buffers. */
+};
+
+/** @brief Static name of a server backend. */
+const char* to_string(ServerBackend backend);
+
+/**
+ * @brief Server tuning.
+ */
+struct BookingServerOptions {
+    std::string host = "127.0.0.1";            /**< IPv4 address to bind. */
+    std::uint16_t port = 0;                    /**< TCP port (0 = any free port, see BookingServer::port). */
+    int backlog = 1024;                        /**< listen() backlog. */
+    std::size_t max_line = 64 * 1024;          /**< Longest request line; longer ones close the connection. */
+    std::size_t output_high_water = 1 << 20;   /**< Unsent bytes at which a connection stops being read. */
+    ServerBackend backend = ServerBackend::Auto; /**< Event loop (IoUring falls back to Epoll if unavailable). */
+    std::size_t max_connections = 1024;        /**< io_uring: fixed file slots / receive buffers; extra clients are refused. */
+    std::size_t recv_buffer = 16 * 1024;       /**< io_uring: registered receive buffer per connection. */
+    RateLimit client_rate{};                   /**< Requests per client (peer IPv4 address); rate <= 0 = unlimited. */
+    std::size_t rate_limit_clients = 4096;     /**< Clients tracked by the rate limiter. */
+    bool read_only = false;                    /**< Replica: bookings and cancellations answer ReadOnlyReplica. */
+    bool cluster_admin = false;                /**< Cluster node: accept ClusterRouter's export/import commands. */
+    LiveConfig* config = nullptr;              /**< Live tunables (live_config.hpp); their client_rate overrides the above. */
+    bool config_admin = false;                 /**< With config: answer GET/PUT /admin/config over HTTP. */
+    bool http = true;                          /**< Answer connections that open with an HTTP request (http_gateway.hpp). */
+    int busy_poll_us = 0;                      /**< > 0: spin instead of sleeping; SO_BUSY_POLL budget per socket read. */
+    int poll_cpu = -1;                         /**< Pin the thread calling BookingServer::run to this CPU (-1 = don't). */
+    bool session_affinity = true;              /**< OwnerThreads mode: run text sessions on their show's owner thread. */
+};
+
+/**
+ * @brief Single-threaded epoll server for a BookingService.
+ *
+ * @details
+ * Call @ref listen, then @ref run on the serving thread; @ref stop may be called from any
+ * thread (it wakes the loop through an eventfd).
+ */
+class BookingServer {
+public:
+    BookingServer(BookingService& service, BookingServerOptions options = {});
+    ~BookingServer();
+
+    BookingServer(const BookingServer&) = delete;
+    BookingServer& operator=(const BookingServer&) = delete;
+
+    /** @brief Creates the listening socket and the epoll instance. */
+    ServerStatus listen();
+
+    /** @brief Bound port (after a successful listen). */
+    std::uint16_t port() const { return port_; }
+
+    /** @brief Event loop in use (Epoll or IoUring) after a successful listen. */
+    ServerBackend backend() const { return backend_; }
+
+    /** @brief Serves connections until @ref stop; closes them all on return. Call once. */
+    void run();
+
+    /** @brief Makes @ref run return. Thread-safe. */
+    void stop();
+
+    /**
+     * @brief Switches bookings and cancellations off (replica, standby) or on, e.g. when a
+     *        WarmStandby is promoted (standby.hpp). Thread-safe; applies from each
+     *        connection's next request on.
+     */
+    void set_read_only(bool read_only) { read_only_.store(read_only, std::memory_order_relaxed); }
+
+    /** @brief True while bookings and cancellations answer ReadOnlyReplica. */
+    bool read_only() const { return read_only_.load(std::memory_order_relaxed); }
+
+    /** @brief Open connections (approximate when read from another thread). */
+    std::size_t connection_count() const { return connection_count_.load(std::memory_order_relaxed); }
+
+    /** @brief Rejection counters of the per-client rate limit (all zero without one). Thread-safe. */
+    RateLimiterStats rate_limit_stats() const { return rate_limiter_ ? rate_limiter_->stats() : RateLimiterStats{}; }
+
+    /** @brief Busy-polling rounds that found nothing to do (0 unless busy_poll_us is set). Thread-safe. */
+    std::uint64_t idle_polls() const { return idle_polls_.load(std::memory_order_relaxed); }
+
+    /** @brief Batches of text lines run on their session's owner thread. Thread-safe. */
+    std::uint64_t pinned_batches() const { return pinned_batches_.load(std::memory_order_relaxed); }
+
+private:
+    struct Connection {
+        int fd = -1;
+        std::string in;        /**< Received bytes not yet executed (a partial line at most, unless paused). */
+        std::size_t in_pos = 0; /**< Start of the unexecuted part of @ref in. */
+        std::string out;       /**< Responses not yet sent. */
+        std::size_t out_pos = 0; /**< Sent prefix of @ref out. */
+        bool closing = false;  /**< Close once @ref out is flushed. */
+        bool eof = false;      /**< Peer shut down its side. */
+        bool binary = false;   /**< Speaks the binary protocol (first byte was kWireMagic). */
+        bool http = false;     /**< Speaks HTTP/1.1 (first byte was an uppercase letter). */
+        bool detected = false; /**< The protocol has been chosen. */
+        std::uint64_t client = 0; /**< Rate-limit key (peer address). */
+        std::unique_ptr<TextCommandHandler> session; /**< Text protocol: the session's handler, made on its first line. */
+    };
+
+    struct Uring; /**< io_uring loop state. */
+
+    void run_epoll();
+    void accept_all();
+
+    /** @brief Reads, executes and writes until the connection would block; false to close it. */
+    bool service(Connection& c);
+
+    /** @brief Executes the complete lines or frames of c.in; false on a protocol violation. */
+    bool execute_lines(Connection& c);
+
+    /** @brief Text-protocol body of @ref execute_lines: executes the complete lines of c.in. */
+    void execute_text(Connection& c);
+
+    /** @brief Binary-protocol body of @ref execute_lines: decodes frames in place from c.in. */
+    void execute_frames(Connection& c);
+
+    /** @brief HTTP body of @ref execute_lines: executes the complete requests of c.in. */
+    void execute_requests(Connection& c);
+
+    /** @brief Sends as much of c.out as the socket takes; false on a socket error. */
+    bool flush(Connection& c);
+
+    void close_connection(int fd);
+
+    /** @brief Per-socket options of an accepted connection (TCP_NODELAY, SO_BUSY_POLL). */
+    void tune_socket(int fd) const;
+
+    /** @brief Sets up the ring and registers files and buffers; false to use epoll. */
+    bool init_uring();
+    void run_uring();
+
+    BookingService& service_;
+    BookingServerOptions options_;
+    WireCommandHandler wire_handler_;
+    HttpCommandHandler http_handler_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::uint16_t port_ = 0;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+    std::atomic<std::size_t> connection_count_{0};
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> read_only_{false};       /**< Starts as BookingServerOptions::read_only. */
+    std::atomic<std::uint64_t> idle_polls_{0};
+    std::atomic<std::uint64_t> pinned_batches_{0};
+    ServerBackend backend_ = ServerBackend::Epoll;
+    std::unique_ptr<Uring> uring_;
+    std::unique_ptr<ClientRateLimiter> rate_limiter_; /**< Per-client buckets, if client_rate or config is set. */
+    std::uint64_t config_listener_ = 0;               /**< Follows options_.config's client_rate. */
+};
+
+} // namespace booking
@@ -1,12 +1,73 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
+#include "admission.hpp"
+#include "availability_codec.hpp"
+#include "availability_views.hpp"
+#include "backoff.hpp"
+#include "booking_id.hpp"
+#include "change_feed.hpp"
+#include "dirty_shows.hpp"
+#include "epoch.hpp"
+#include "flat_combiner.hpp"
+#include "hall_layout.hpp"
+#include "heavy_hitters.hpp"
+#include "htm.hpp"
+#include "huge_pages.hpp"
+#include "ids.hpp"
+#include "journal.hpp"
+#include "layout_registry.hpp"
+#include "lazy_seat_maps.hpp"
+#include "live_config.hpp"
+#include "memory_budget.hpp"
+#include "mpsc_queue.hpp"
+#include "profiler.hpp"
+#include "object_pool.hpp"
+#include "request_arena.hpp"
+#include "request_dedupe.hpp"
+#include "sales_analytics.hpp"
+#include "schedule_loader.hpp"
+#include "seat_heatmap.hpp"
+#include "seat_mask.hpp"
+#include "seat_words.hpp"
+#include "seat_run_summary.hpp"
+#include "seat_states.hpp"
+#include "service_metrics.hpp"
+#include "shared_seats.hpp"
+#include "slo_monitor.hpp"
+#include "show_executor.hpp"
+#include "show_gate.hpp"
+#include "sim_scheduler.hpp"
+#include "show_table.hpp"
+#include "show_time_index.hpp"
+#include "snapshot.hpp"
+#include "span.hpp"
+#include "string_arena.hpp"
+#include "theater_capacity.hpp"
+#include "thread_pool.hpp"
+#include "timer_wheel.hpp"
+#include "title_index.hpp"
+
 /**
  * @file booking_service.hpp
  * @brief Public API for the in-memory movie booking service (atomic implementation).
@@ -17,41 +78,37 @@
  *
  * Concurrency model (atomic implementation):
  * - Each show has its own independent booking state (no cross-show contention).
- * - Seats are tracked via an atomic bitmask (20 LSB bits used).
+ * - Seats are tracked via an array of atomic 64-bit words sized from the show's
+ *   HallLayout (one word per row).
  * - Booking is all-or-nothing using a CAS loop (compare-and-swap).
  *
- * Seat labels are "a1".."a20", mapped to indices [0..19].
+ * With the default layout seat labels are "a1".."a20", mapped to indices [0..19].
  */
 
 namespace booking {
 
 /**
- * @brief Movie identifier type.
- *
- * Kept as an alias for readability in public APIs.
- */
-using MovieId = int;
-
-/**
- * @brief Theater identifier type.
- *
- * Kept as an alias for readability in public APIs.
+ * @brief Start time of a show: seconds since the Unix epoch (UTC).
  */
-using TheaterId = int;
+using ShowTime = std::int64_t;
 
 /**
- * @brief Show identifier type.
- *
- * Kept as an alias for readability in public APIs.
+ * @brief Seat hold identifier returned by BookingService::hold_seats (never 0).
  */
-using ShowId = int;
+using HoldId = std::uint64_t;
 
 /**
  * @brief Represents a movie.
+ *
+ * @details
+ * Catalog strings are views: BookingService::add_movie / add_theater / load_schedule copy
+ * them into the service's StringArena (equal strings stored once), and everything the
+ * service returns points there, valid for the lifetime of the service. Listing calls
+ * therefore copy no string data.
  */
 struct Movie {
-    MovieId id;           /**< Unique movie identifier. */
-    std::string title;    /**< Human-readable movie title. */
+    MovieId id;             /**< Unique movie identifier. */
+    std::string_view title; /**< Human-readable movie title (interned by the service, see below). */
 };
 
 /**
@@ -59,7 +116,27 @@ struct Movie {
  */
 struct Theater {
     TheaterId id;         /**< Unique theater identifier. */
-    std::string name;     /**< Human-readable theater name. */
+    std::string_view name; /**< Human-readable theater name (interned by the service). */
+    double latitude = std::numeric_limits<double>::quiet_NaN();  /**< WGS84 degrees (NaN = unknown). */
+    double longitude = std::numeric_limits<double>::quiet_NaN(); /**< WGS84 degrees (NaN = unknown). */
+
+    /** @brief True if the theater has coordinates (it then appears in radius queries). */
+    bool has_location() const { return !std::isnan(latitude) && !std::isnan(longitude); }
+};
+
+/**
+ * @brief One page of a cursor-paginated listing (see BookingService::list_movies_page).
+ *
+ * @details
+ * A cursor is an opaque position in the listing's stable order; 0 starts at the
+ * beginning. Cursors stay valid across catalog updates: entries added behind the cursor
+ * are not revisited and entries added ahead of it appear on later pages.
+ */
+template <typename T>
+struct Page {
+    std::vector<T> items;          /**< Entries of this page, in listing order. */
+    std::uint64_t next_cursor = 0; /**< Cursor of the following page (after the last one: of entries added later). */
+    bool more = false;             /**< Whether entries follow this page. */
 };
 
 /**
@@ -69,14 +146,517 @@ struct Show {
     ShowId id;            /**< Unique show identifier. */
     MovieId movie_id;     /**< The movie being shown. */
     TheaterId theater_id; /**< The theater where the show runs. */
+    LayoutId layout_id = 0; /**< Seat map of the hall (index into the service layout table). */
+    ShowTime start_time = 0; /**< Start of the show (see @ref find_shows_between). */
+    int hall = 0;           /**< Hall (screen) number within the theater. */
+};
+
+/**
+ * @brief One show of a movie with its free seats (see BookingService::movie_showtimes).
+ */
+struct ShowAvailability {
+    ShowId show_id;                /**< The show. */
+    TheaterId theater_id;          /**< Where it runs. */
+    std::string_view theater_name; /**< Interned theater name (valid for the service's lifetime). */
+    ShowTime start_time = 0;       /**< Start of the show. */
+    int hall = 0;                  /**< Hall number within the theater. */
+    int free_seats = 0;            /**< Seats not booked or held. */
+    int seat_count = 0;            /**< Seats of the hall. */
+};
+
+/** @brief Attendance of one theater on one day (see BookingService::theater_attendance). */
+struct DailyAttendance {
+    int seats_taken = 0; /**< Seats booked or held in the theater's shows of that day. */
+    int cap = -1;        /**< Daily cap; -1 = none. */
+};
+
+/**
+ * @brief Catalog shows stored column-wise (structure of arrays).
+ *
+ * @details
+ * Each Show field lives in its own contiguous array, so a filter reads only the columns
+ * it tests and runs on the vectorised kernels of column_scan.hpp. The scanned columns
+ * hold 32-bit dense indexes instead of the 64-bit ids: the show's ShowTable position and
+ * the movie's and theater's catalog slots (index into Catalog::movies / theaters), so a
+ * movie filter still streams 4 bytes per show. Row order is insertion order.
+ */
+class ShowColumns {
+public:
+    /** @brief Number of shows. */
+    std::size_t size() const { return ids_.size(); }
+
+    void reserve(std::size_t n);
+
+    /** @brief Appends @p show, stored at table position @p position, of the movie and theater in the given slots. */
+    void push_back(const Show& show, int position, std::int32_t movie_slot, std::int32_t theater_slot);
+
+    /** @brief Removes row @p row (later rows move up by one). */
+    void erase(std::size_t row);
+
+    /** @brief Removes the rows listed (ascending) in @p rows in one compaction pass. */
+    void erase_rows(const std::vector<std::uint32_t>& rows);
+
+    /** @brief Moves the show of row @p row to hall @p hall with seat map @p layout_id. */
+    void relocate(std::size_t row, LayoutId layout_id, int hall);
+
+    /** @brief Reassembles row @p row; @p movies and @p theaters are the catalog's (the slots index them). */
+    Show row(std::size_t row, const std::vector<Movie>& movies, const std::vector<Theater>& theaters) const;
+
+    /** @brief Row of the show at table position @p position, or size() if there is none. */
+    std::size_t find(int position) const;
+
+    /**
+     * @brief Appends the rows of the movie in slot @p movie_slot that start in
+     *        [@p from, @p to) to @p rows, in row order.
+     */
+    void select(std::int32_t movie_slot, ShowTime from, ShowTime to, std::vector<std::uint32_t>& rows) const;
+
+    const HugeVector<ShowId>& ids() const { return ids_; }
+    const HugeVector<std::int32_t>& movie_slots() const { return movie_slots_; }
+    const HugeVector<std::int32_t>& theater_slots() const { return theater_slots_; }
+    const HugeVector<ShowTime>& start_times() const { return start_times_; }
+    const HugeVector<int>& halls() const { return halls_; }
+    const HugeVector<LayoutId>& layout_ids() const { return layout_ids_; }
+
+    /** @brief Bytes reserved by the columns. */
+    std::size_t bytes() const {
+        return ids_.capacity() * sizeof(ShowId) + start_times_.capacity() * sizeof(ShowTime)
+               + (positions_.capacity() + movie_slots_.capacity() + theater_slots_.capacity()) * sizeof(std::int32_t)
+               + layout_ids_.capacity() * sizeof(LayoutId) + halls_.capacity() * sizeof(int);
+    }
+
+private:
+    // Large catalogs keep their columns on huge pages (see set_huge_pages)
+    HugeVector<ShowId> ids_;
+    HugeVector<std::int32_t> positions_;
+    HugeVector<std::int32_t> movie_slots_;
+    HugeVector<std::int32_t> theater_slots_;
+    HugeVector<LayoutId> layout_ids_;
+    HugeVector<ShowTime> start_times_;
+    HugeVector<int> halls_;
+};
+
+/** @brief One booking of an archived show (see ColdShowStore). */
+struct ArchivedBooking {
+    BookingId id = 0;       /**< Booking id. */
+    std::vector<int> seats; /**< Seat indices (HallLayout::seat_index), ascending. */
+};
+
+/** @brief Final state of a show moved to cold storage by BookingService::archive_shows_before. */
+struct ArchivedShow {
+    Show show{};                           /**< Catalog entry as it was. */
+    int seat_count = 0;                    /**< Seats of its hall. */
+    std::vector<ArchivedBooking> bookings; /**< Bookings in id order. */
+
+    /** @brief Seats sold. */
+    int booked_seats() const {
+        int n = 0;
+        for (const ArchivedBooking& b : bookings) n += static_cast<int>(b.seats.size());
+        return n;
+    }
+};
+
+/**
+ * @brief Read-only, compressed store of shows that have played (for reporting).
+ *
+ * @details
+ * Each show is encoded once into an append-only byte log: its catalog fields and then its
+ * bookings as delta-coded variable-length integers (a booking id and its seat indices
+ * typically fit in a few bytes), instead of a ShowState, owner rows and catalog index
+ * entries. Lookups binary-search a sorted (show id, offset) index and decode the record.
+ * Thread-safe.
+ */
+class ColdShowStore {
+public:
+    /** @brief Stores @p show; false (nothing stored) if its id is already archived. */
+    bool add(const ArchivedShow& show);
+
+    /** @brief Decodes show @p show_id into @p out; false if it is not archived. */
+    bool find(ShowId show_id, ArchivedShow& out) const;
+
+    /** @brief True if show @p show_id is archived. */
+    bool contains(ShowId show_id) const;
+
+    /** @brief Archived show ids, ascending. */
+    std::vector<ShowId> ids() const;
+
+    /**
+     * @brief Appends the sold seats of every archived show of @p layout_id starting in
+     *        [@p from, @p to) to @p out as @p words booking words per show (bit c of word
+     *        r = seat (r, c)); returns how many shows were appended.
+     *
+     * @details
+     * One sequential pass over the log, decoding each record once; for heatmaps
+     * (BookingService::seat_heatmap).
+     */
+    std::size_t booked_words(LayoutId layout_id, ShowTime from, ShowTime to, std::size_t words,
+                             std::vector<std::uint64_t>& out) const;
+
+    /** @brief Number of archived shows. */
+    std::size_t size() const;
+
+    /** @brief Bytes of encoded records. */
+    std::size_t bytes() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::uint8_t> log_;                       /**< Encoded records, appended. */
+    std::vector<std::pair<ShowId, std::uint64_t>> index_; /**< (show id, offset in log_), sorted. */
+};
+
+/**
+ * @brief Outcome of a booking attempt.
+ */
+enum class BookingStatus : std::uint8_t {
+    Ok,                 /**< Seats were booked. */
+    InvalidShow,        /**< The show id does not exist. */
+    NoSeats,            /**< The request contained no seats. */
+    InvalidSeatLabel,   /**< A label could not be parsed or names no seat of the layout. */
+    DuplicateSeatLabel, /**< The same seat was requested twice. */
+    AlreadyBooked,      /**< At least one requested seat is already booked. */
+    InvalidSeatIndex,   /**< A seat index or mask bit names no seat of the layout. */
+    Contended,          /**< The CAS retry budget was exhausted; the caller may retry later. */
+    UnknownHold,        /**< The hold id is unknown, or the hold was already confirmed/released. */
+    HoldExpired,        /**< The hold's TTL elapsed before it was confirmed. */
+    HoldCapacity,       /**< Too many outstanding holds. */
+    HoldTooLarge,       /**< A hold may span at most BookingService::kMaxHoldRows rows. */
+    NotOwner,           /**< A seat to cancel is not booked under the given BookingId. */
+    NoContiguousSeats,  /**< No row has the requested number of adjacent free seats. */
+    Waitlisted,         /**< Sold out for now: queued, the waitlist callback reports the booking. */
+    Throttled,          /**< Shed by the show's admission gate (retry after admission_retry_after) or a client rate limit. */
+    CompanionSeatRule,  /**< A companion seat was requested without a booked wheelchair space next to it. */
+    SingleSeatGap,      /**< The booking would leave a single free seat alone (HallLayout::set_forbid_single_gaps). */
+    ReadOnlyReplica,    /**< The server is a read replica (replication.hpp); bookings go to the primary. */
+    RequestInFlight,    /**< A request with this request id is still running; retry later for its outcome. */
+    RequestIdReused,    /**< The request id was already used for a different request. */
+    TheaterCapReached,  /**< The theater's daily attendance cap has no room for the seats (set_theater_daily_cap). */
+    Busy,               /**< A bounded queue in front of the service is full (BookingPipeline); retry later. */
+    DeadlineExceeded,   /**< The request's deadline (BookingService::DeadlineScope) passed before it reached the seats. */
+    SalesClosed,        /**< The show is not on sale (BookingService::set_sales_state). */
+};
+
+/**
+ * @brief Static description of a status (e.g. "One or more seats already booked").
+ */
+const char* to_string(BookingStatus status);
+
+/**
+ * @brief Outcome of a catalog update (see BookingService::add_show etc.).
+ */
+enum class CatalogStatus : std::uint8_t {
+    Ok,             /**< The catalog was updated. */
+    DuplicateId,    /**< An entry with this id already exists (show ids are never reused). */
+    InvalidId,      /**< The id is outside the supported range. */
+    UnknownMovie,   /**< The show references a movie that does not exist. */
+    UnknownTheater, /**< The show references a theater that does not exist. */
+    UnknownLayout,  /**< The show references a layout that does not exist. */
+    UnknownShow,    /**< The show to remove does not exist. */
+    NoSharedRoom,   /**< The shared seat region is full or holds the show with another layout. */
+    OverQuota,      /**< The tenant's catalog already holds its quota of shows (tenant_registry.hpp). */
+};
+
+/** @brief Static description of a catalog status. */
+const char* to_string(CatalogStatus status);
+
+/**
+ * @brief Outcome of BookingService::availability_if_changed.
+ */
+enum class AvailabilityStatus : std::uint8_t {
+    Changed,     /**< The seats changed since the known version (or none was given); here they are. */
+    Unchanged,   /**< Nothing changed since the known version; no seat was read. */
+    UnknownShow, /**< The show does not exist. */
+};
+
+/** @brief Static description of an availability status. */
+const char* to_string(AvailabilityStatus status);
+
+/**
+ * @brief Outcome of BookingService::availability_diff.
+ */
+enum class DiffStatus : std::uint8_t {
+    Ok,          /**< The seats taken and freed since the given position. */
+    UnknownShow, /**< The show does not exist. */
+    NoFeed,      /**< The change feed is not enabled (see BookingService::enable_change_feed). */
+    Resync,      /**< The position left the feed's ring (or is ahead of it): reread the whole seat map. */
+};
+
+/** @brief Static description of a diff status. */
+const char* to_string(DiffStatus status);
+
+/** @brief Seats of one show that changed between two change feed positions. */
+struct AvailabilityDiff {
+    DiffStatus status = DiffStatus::Ok;
+    SeatMask taken;             /**< Seats booked or held since the position (free before, taken now). */
+    SeatMask freed;             /**< Seats cancelled, released or expired since the position. */
+    std::uint64_t position = 0; /**< Position to pass to the next call (also set on Resync). */
+};
+
+/**
+ * @brief Outcome of BookingService::move_show.
+ */
+enum class MoveStatus : std::uint8_t {
+    Ok,            /**< The show runs in the new hall, its bookings and holds remapped. */
+    UnknownShow,   /**< The show is not in the catalog. */
+    UnknownLayout, /**< The new layout does not exist. */
+    SeatLost,      /**< A booked or held seat has no seat in the new hall; nothing changed. */
+    SeatClash,     /**< Two booked or held seats translate to the same seat; nothing changed. */
+    HoldTooWide,   /**< A hold would span more rows of the new hall than a hold can; nothing changed. */
+    Unsupported,   /**< The show's seats are in a shared region, or a journal is attached. */
+};
+
+/** @brief Static description of a move status. */
+const char* to_string(MoveStatus status);
+
+/**
+ * @brief Whether a show sells seats (BookingService::set_sales_state).
+ */
+enum class SalesState : std::uint8_t {
+    Open,     /**< On sale (the state of a new show). */
+    NotOpen,  /**< Sales have not opened yet (e.g. a premiere before its on-sale time). */
+    Closed,   /**< Sales are over (e.g. the show has started). */
+    Blackout, /**< Withdrawn from sale for a while (e.g. a private screening). */
 };
 
+/** @brief Static name of a sales state ("open", "not open", "closed", "blackout"). */
+const char* to_string(SalesState state);
+
 /**
  * @brief Result of a booking attempt.
+ *
+ * @details
+ * Building a result never allocates: the human-readable text is only rendered on demand
+ * by @ref message, typically when logging or printing in the CLI.
  */
 struct BookingResult {
-    bool success;         /**< True if booking succeeded; false otherwise. */
-    std::string message;  /**< Human-readable result description (useful for CLI & tests). */
+    bool success = false;                        /**< True if booking succeeded; false otherwise. */
+    BookingStatus status = BookingStatus::Ok;    /**< Machine-readable outcome. */
+    SeatMask conflicts;                          /**< AlreadyBooked: seats taken; NotOwner: seats not owned. */
+    int label_index = -1;                        /**< Label/index errors: position of the offending entry; bundles: of the failed item. */
+    int suggested_row = -1;                      /**< AlreadyBooked: row of @ref suggested_seats, or -1 if there is no suggestion. */
+    std::uint64_t suggested_seats = 0;           /**< AlreadyBooked: free seats of suggested_row to book instead of the request's seats there. */
+    std::uint64_t id = 0;                        /**< Bookings: the BookingId; hold_seats: the HoldId; else 0. */
+    std::array<char, 16> label{};                /**< Label errors: NUL-terminated (truncated) copy of it. */
+
+    /** @brief Successful result. */
+    static BookingResult ok();
+
+    /** @brief Failed result with @p status and no further details. */
+    static BookingResult error(BookingStatus status);
+
+    /** @brief Failed label validation for the label at position @p index. */
+    static BookingResult label_error(BookingStatus status, int index, std::string_view bad_label);
+
+    /** @brief Failed validation of the seat index at position @p index. */
+    static BookingResult index_error(BookingStatus status, int index);
+
+    /** @brief Failed because @p taken seats were already booked. */
+    static BookingResult conflict(const SeatMask& taken);
+
+    /**
+     * @brief The request with its seats in @ref suggested_row replaced by @ref suggested_seats,
+     *        or an empty mask if there is no suggestion.
+     *
+     * @details
+     * A conflict whose taken seats all lie in one row suggests, from the same row word the
+     * conflict was found on, as many free seats near the requested ones (a run stays one run,
+     * within an aisle block and without leaving a single-seat gap). It is a hint, not a hold:
+     * booking the alternative may still fail, but a client can retry once instead of
+     * re-listing the show's seats.
+     */
+    SeatMask alternative(const SeatMask& request) const;
+
+    /** @brief Failed cancellation: @p foreign seats are not owned by the booking. */
+    static BookingResult not_owner(const SeatMask& foreign);
+
+    /**
+     * @brief Renders a human-readable description (useful for CLI & tests), e.g.
+     *        "Invalid seat label: a1x".
+     */
+    std::string message() const;
+
+    /** @brief Appends @ref message to @p out (no allocation while @p out has capacity). */
+    void append_message(std::string& out) const;
+};
+
+/**
+ * @brief Per-show CAS contention counters (see BookingService::contention_stats).
+ */
+struct ContentionStats {
+    std::uint64_t cas_retries = 0;      /**< Failed CAS attempts that were retried. */
+    std::uint64_t contended = 0;        /**< Requests that gave up after exhausting the retry budget. */
+    std::uint64_t conflicts = 0;        /**< Requests rejected because a seat was already booked. */
+};
+
+/** @brief How a hot show's requests are serialised (see HotShowPolicy). */
+enum class HotShowStrategy : std::uint8_t {
+    OwnerThreads, /**< Queued to a small ShowExecutor started on the first promotion. */
+    Combining,    /**< Flat combining: whichever caller holds the show's combiner applies everyone's requests. */
+};
+
+const char* to_string(HotShowStrategy strategy);
+
+/**
+ * @brief When a show is switched to serialised execution because of contention
+ *        (see BookingService::set_hot_show_policy).
+ *
+ * @details
+ * A show is promoted when, over one window, its failed CAS attempts reach both
+ * @ref promote_min_failures and @ref promote_failure_ratio of all its word updates (a
+ * window closes on the first failure after its end, and longer ones are scaled down to
+ * the window length). It is demoted once it is applied at fewer than
+ * @ref demote_requests_per_second over a window.
+ */
+struct HotShowPolicy {
+    bool enabled = false;                         /**< Track contention and promote shows automatically. */
+    std::chrono::milliseconds window{100};        /**< Length of one measurement window. */
+    std::uint32_t promote_min_failures = 64;      /**< Failed CAS attempts per window before a show can be promoted. */
+    double promote_failure_ratio = 0.2;           /**< Failed / (failed + successful) CAS needed to promote. */
+    double demote_requests_per_second = 2000.0;   /**< Load below which a hot show goes back to Shared. */
+    HotShowStrategy strategy = HotShowStrategy::OwnerThreads; /**< Applied to shows promoted from now on. */
+    unsigned workers = 1;                         /**< Owner threads serving hot shows (started on the first promotion). */
+};
+
+/** @brief Promotion counters (see BookingService::hot_show_stats). */
+struct HotShowStats {
+    std::uint64_t promotions = 0; /**< Shows switched to owner-thread execution so far. */
+    std::uint64_t demotions = 0;  /**< Shows switched back to Shared so far. */
+    std::uint64_t hot = 0;        /**< Shows hot right now. */
+    std::uint64_t combining_passes = 0;  /**< Combiner passes over hot shows (Combining strategy). */
+    std::uint64_t combined_requests = 0; /**< Requests those passes applied. */
+};
+
+/** @brief Occupancy and contention of one show (see BookingService::show_stats). */
+struct ShowStats {
+    ShowId show_id;
+    int seats = 0;                 /**< Seats of the show's layout. */
+    int booked = 0;                /**< Seats not available (booked or held). */
+    double occupancy = 0.0;        /**< booked / seats. */
+    std::uint64_t changes = 0;     /**< Successful seat-word updates (bookings, cancellations, holds, ...). */
+    ContentionStats contention;
+    double conflict_rate = 0.0;    /**< conflicts / (conflicts + changes): share of writes refused as taken. */
+};
+
+/** @brief A frequently booked show (see BookingService::hot_shows). */
+struct HotShow {
+    ShowId show_id;
+    std::uint64_t requests = 0; /**< Estimated booking attempts (see heavy_hitters.hpp). */
+    std::uint64_t error = 0;    /**< Maximum overestimate of @ref requests. */
+    ShowStats stats;
+};
+
+/** @brief Catalog-wide occupancy and contention (see BookingService::service_stats). */
+struct ServiceStats {
+    std::size_t shows = 0;
+    std::uint64_t seats = 0;
+    std::uint64_t booked = 0;
+    double occupancy = 0.0;        /**< booked / seats over all shows. */
+    std::uint64_t changes = 0;
+    ContentionStats contention;    /**< Summed over all shows. */
+    double conflict_rate = 0.0;    /**< As ShowStats::conflict_rate, over all shows. */
+    std::vector<HotShow> hot;      /**< Most requested shows, most requested first. */
+};
+
+/**
+ * @brief Settings of BookingService::set_incremental_snapshots.
+ *
+ * @details
+ * The directory holds one base snapshot, "base.snap" (a full snapshot, snapshot.hpp),
+ * and the deltas written after it, "delta-<n>.snap" for n = 1, 2, ...
+ */
+struct IncrementalSnapshotOptions {
+    std::string directory;                     /**< Existing directory for the files (empty = off). */
+    std::chrono::milliseconds interval{60000}; /**< Pause between two passes. */
+    unsigned full_every = 60;                  /**< Deltas after which a pass writes a new base instead. */
+    bool compact_journal = false;              /**< After each new base, drop the journal records it covers. */
+};
+
+/** @brief Counters of the incremental snapshot writer (see BookingService::incremental_snapshot_stats). */
+struct IncrementalSnapshotStats {
+    std::uint64_t bases = 0;         /**< Base snapshots written. */
+    std::uint64_t deltas = 0;        /**< Deltas written. */
+    std::uint64_t delta_shows = 0;   /**< Show states those deltas carried. */
+    std::uint64_t failures = 0;      /**< Passes that failed (the next pass writes a base). */
+    std::uint64_t compactions = 0;   /**< Journal compactions after a base (IncrementalSnapshotOptions::compact_journal). */
+};
+
+/** @brief Settings of BookingService::set_occupancy_export. */
+struct OccupancyExportOptions {
+    std::string path;                         /**< File to keep current, e.g. in /dev/shm (empty = off). */
+    std::chrono::milliseconds interval{1000}; /**< Pause between two publications. */
+};
+
+/** @brief Settings of BookingService::set_availability_export. */
+struct AvailabilityExportOptions {
+    std::string path;                         /**< File to keep current (empty = none). */
+    /** @brief Called with every blob and its version, e.g. to upload it to a CDN (empty = none). */
+    std::function<void(const std::string& blob, std::uint64_t version)> push;
+    std::chrono::milliseconds interval{1000}; /**< Pause between two blobs. */
+    SeatEncoding encoding = SeatEncoding::Bitmap; /**< Payload of every show. */
+};
+
+/** @brief One occupancy threshold of a PricingPolicy. */
+struct PriceStep {
+    double min_occupancy = 0.0; /**< Applies from this share of seats taken (0..1). */
+    int adjust_percent = 0;     /**< Price change in percent, e.g. +10 or -15 (at least -100). */
+};
+
+/** @brief Settings of BookingService::set_dynamic_pricing. */
+struct PricingPolicy {
+    std::vector<PriceStep> steps;             /**< The highest min_occupancy reached applies (empty = off). */
+    std::chrono::milliseconds interval{1000}; /**< Pause between two repricing passes. */
+};
+
+/**
+ * @brief One entry of a batched booking call (see BookingService::book_seats_batch).
+ */
+struct BookingRequest {
+    ShowId show_id;                              /**< Show to book. */
+    Span<const std::string_view> seat_labels;    /**< Seat labels; storage owned by the caller. */
+    const SeatMask* seats = nullptr;             /**< Seats as a mask instead of labels (then seat_labels is ignored). */
+};
+
+/**
+ * @brief One show's part of a multi-show booking (see BookingService::book_bundle).
+ */
+struct BundleItem {
+    ShowId show_id = -1; /**< Show to book. */
+    SeatMask seats;      /**< Seats of that show. */
+};
+
+/** @brief Stage of a bulk reservation (see BookingService::book_bulk). */
+enum class BulkPhase : std::uint8_t {
+    Validated,   /**< The whole plan was checked; no seat has been touched yet. */
+    Acquiring,   /**< A show's seats were taken (or failed to be). */
+    RollingBack, /**< A show's seats were released after another show failed. */
+    Committed,   /**< Every part is booked and recorded. */
+};
+
+const char* to_string(BulkPhase phase);
+
+/**
+ * @brief Progress callback of BookingService::book_bulk: the phase, the shows done in
+ *        it and the shows it covers. Calls are serialised, possibly from pool threads.
+ */
+using BulkProgress = std::function<void(BulkPhase phase, std::size_t done, std::size_t total)>;
+
+/**
+ * @brief Seat state of one show moving between cluster nodes (see cluster.hpp).
+ */
+struct ShowTransfer {
+    /** @brief Seats of one booking. */
+    struct Booking {
+        BookingId id = 0;
+        SeatMask seats;
+    };
+    /** @brief Seats of one active hold and its remaining TTL. */
+    struct Hold {
+        SeatMask seats;
+        std::chrono::milliseconds ttl{0};
+    };
+
+    ShowId show_id = -1;
+    std::vector<Booking> bookings; /**< In booking id order. */
+    std::vector<Hold> holds;
 };
 
 /**
@@ -92,16 +672,19 @@ struct BookingResult {
  *
  * ### Thread-safety
  * - Multiple threads may call @ref book_seats concurrently for the same show.
+ * - Catalog reads run lock-free against an immutable snapshot; catalog updates publish a
+ *   new snapshot and may run concurrently with reads and bookings.
  * - Overbooking is prevented via atomic updates.
  * - Booking multiple seats is **all-or-nothing**: if any requested seat is already booked,
  *   no seats are booked.
  *
  * ### Seat representation
- * Seats are stored as an atomic 32-bit mask; 20 least significant bits represent seats:
- * - bit i == 0 => seat available
- * - bit i == 1 => seat booked
+ * Each show owns one atomic 64-bit word per row of its HallLayout:
+ * - bit c of word r == 0 => seat (r, c) available
+ * - bit c of word r == 1 => seat (r, c) booked
  *
- * Seat labels are "a1".."a20".
+ * Requests within a single row cost exactly one CAS loop on one word, as with the
+ * original single-mask design. With the default layout seat labels are "a1".."a20".
  */
 class BookingService {
 public:
@@ -109,124 +692,2463 @@ public:
      * @brief Constructs the service and initializes in-memory data.
      *
      * @details
-     * The constructor sets up a minimal sample dataset (movies, theaters, shows) and
-     * creates per-show booking state entries in \c show_state_.
+     * The constructor sets up a minimal sample dataset (movies, theaters, shows) through
+     * the catalog update API, which also creates the per-show booking state.
      */
     BookingService();
 
+    /**
+     * @brief Constructs the sample dataset with every show using @p layout.
+     *
+     * @param layout Seat map used for all sample shows (registered as layout 0).
+     */
+    explicit BookingService(HallLayout layout);
+
+    /** @brief Tag selecting the constructor that starts with an empty catalog. */
+    struct EmptyCatalog {};
+
+    /**
+     * @brief Constructs a service without movies, theaters, shows or layouts (e.g. to
+     *        fill it with @ref load_schedule_file).
+     */
+    explicit BookingService(EmptyCatalog);
+
+    /** @brief Frees the published catalog snapshot. */
+    ~BookingService();
+
+    BookingService(const BookingService&) = delete;
+    BookingService& operator=(const BookingService&) = delete;
+
     /**
      * @brief Returns all available movies.
      * @return Vector of movies stored by the service.
      *
-     * @note Returns by value (copy). The dataset is small and keeps the API simple.
+     * @note Returns by value (copy). The dataset is small and keeps the API simple;
+     *       @ref catalog_view reads the same data without allocating.
      */
     std::vector<Movie> list_movies() const;
 
+    /** @brief Number of shows in the catalog. */
+    std::size_t show_count() const;
+
+    /**
+     * @brief Movies whose title best matches @p query, at most @p limit, best first.
+     *
+     * @details
+     * Case and punctuation are ignored. Titles equal to the query rank first, then titles
+     * starting with it, then titles with a later word starting with it, then titles
+     * with a word prefix within one typo (queries of 5+ characters) or two (10+)
+     * of it; ties go to the shorter title. Served from the snapshot's TitleIndex
+     * (title_index.hpp): a binary search for prefix matches, and only if they do not fill
+     * @p limit, a pass over the posting lists of the query's trigrams.
+     */
+    std::vector<Movie> search_movies(std::string_view query, std::size_t limit = 10) const;
+
+    /**
+     * @brief Up to @p limit movies from @p cursor on, in insertion order.
+     *
+     * @details
+     * Copies only the page out of the snapshot's movie array; as movies are append-only,
+     * the cursor is the slot of the next movie.
+     */
+    Page<Movie> list_movies_page(std::uint64_t cursor, std::size_t limit) const;
+
+    class CatalogView;
+    class ShowHandle;
+
+    /**
+     * @brief Pins the current catalog snapshot for allocation-free reads.
+     *
+     * @details
+     * The returned handle exposes spans over the snapshot's own arrays (movies, theaters,
+     * per-movie theater lists, per-(movie, theater) show timelines). They stay valid, and
+     * unchanged by concurrent catalog updates, until the handle is destroyed.
+     */
+    CatalogView catalog_view() const;
+
     /**
      * @brief Lists theaters that have at least one show for the given movie.
      *
      * @param movie_id The movie identifier.
      * @return Vector of theaters sorted by theater id (stable, deterministic output).
      *
+     * @details
+     * Served from a precomputed movie -> theaters index: one hash lookup plus one copy.
+     *
      * @note Deterministic ordering is useful for unit tests and predictable CLI output.
      */
     std::vector<Theater> list_theaters_for_movie(MovieId movie_id) const;
 
+    /**
+     * @brief Up to @p limit theaters showing @p movie_id from @p cursor on, by theater id.
+     *
+     * @details
+     * One binary search in the movie's sorted theater list, then a copy of the page; the
+     * cursor is the smallest theater id the next page may hold.
+     */
+    Page<Theater> list_theaters_for_movie_page(MovieId movie_id, std::uint64_t cursor, std::size_t limit) const;
+
+    /**
+     * @brief Theaters showing a movie within @p radius_km of a point, nearest first.
+     *
+     * @param movie_id The movie identifier.
+     * @param latitude, longitude Query point in WGS84 degrees.
+     * @param radius_km Search radius (great-circle distance).
+     * @return Theaters with a location inside the radius, by distance (ties by id).
+     *
+     * @details
+     * Visits only the location grid cells overlapping the radius (see geo.hpp) and checks
+     * each candidate against the movie's sorted theater list; when the movie plays in fewer
+     * theaters than there are cells to visit, that list is scanned instead.
+     */
+    std::vector<Theater> list_theaters_for_movie(MovieId movie_id, double latitude, double longitude,
+                                                 double radius_km) const;
+
     /**
      * @brief Finds a show for a given (movie, theater) pair.
      *
      * @param movie_id The movie identifier.
      * @param theater_id The theater identifier.
      * @return The show id if it exists; otherwise returns -1.
+     *
+     * @details
+     * Constant-time lookup in the (movie, theater) index. If several shows exist for the
+     * pair, the first one added is returned (see @ref find_shows).
      */
     ShowId find_show(MovieId movie_id, TheaterId theater_id) const;
 
     /**
-     * @brief Lists available seats for a show.
-     *
-     * @param show_id The show identifier.
-     * @return Vector of seat labels that are currently free (e.g. "a1", "a2", ...).
+     * @brief Catalog publications so far; changes whenever a catalog update may have changed
+     *        what @ref find_show returns.
      *
      * @details
-     * Reads the current atomic booking mask once and converts all 0-bits into labels.
+     * Lets a caller cache lookups (see ShowRoutes): read the version before looking up and
+     * keep the result while the version is the same.
      */
-    std::vector<std::string> list_available_seats(ShowId show_id) const;
+    std::uint64_t catalog_version() const { return catalog_generation_.load(std::memory_order_acquire); }
 
     /**
-     * @brief Books one or more seats for a show atomically (all-or-nothing).
-     *
-     * @param show_id The show identifier.
-     * @param seat_labels Seat labels to book (e.g. {"a1","a2"}).
-     * @return BookingResult describing success or the reason for failure.
+     * @brief Finds all shows for a given (movie, theater) pair.
      *
-     * @details
-     * - Validates the show id and that seat_labels is non-empty.
-     * - Parses and validates seat labels (range + duplicates).
-     * - Converts requested seats to a bitmask.
-     * - Uses a CAS loop on the atomic mask to ensure:
-     *   - no overbooking under concurrency
-     *   - all-or-nothing booking for multiple seats
+     * @param movie_id The movie identifier.
+     * @param theater_id The theater identifier.
+     * @return Show ids in insertion order; empty if there is none.
      */
-    BookingResult book_seats(ShowId show_id, const std::vector<std::string>& seat_labels);
+    std::vector<ShowId> find_shows(MovieId movie_id, TheaterId theater_id) const;
 
     /**
-     * @brief Parses a seat label (e.g. "a1") into a zero-based index [0..19].
+     * @brief Shows of a movie at a theater starting in [@p from, @p to).
      *
-     * @param label Input seat label (expected "a1".."a20", case-insensitive for 'a').
-     * @param out_index0 Output seat index in [0..19] on success.
-     * @return True if label is valid; false otherwise.
+     * @return Shows sorted by start time (ties by show id).
      *
      * @details
-     * Uses std::stoi on the numeric suffix and ensures the suffix is fully consumed.
+     * Two binary searches over the (movie, theater) pair's contiguous array of shows,
+     * which the catalog keeps sorted by start time.
      */
-    static bool try_parse_seat_label(const std::string& label, int& out_index0);
+    std::vector<Show> find_shows_between(MovieId movie_id, TheaterId theater_id, ShowTime from, ShowTime to) const;
 
     /**
-     * @brief Converts a seat index [0..19] into a label ("a1".."a20").
+     * @brief Shows of a movie at any of @p theater_ids ("theaters near me") starting in
+     *        [@p from, @p to).
      *
-     * @param index0 Zero-based seat index [0..19].
-     * @return Seat label string.
+     * @return Shows of all listed theaters merged by start time (ties by show id);
+     *         duplicate theater ids are ignored.
      */
-    static std::string seat_label_from_index0(int index0);
+    std::vector<Show> find_shows_between(MovieId movie_id, Span<const TheaterId> theater_ids, ShowTime from,
+                                         ShowTime to) const;
 
-private:
     /**
-     * @brief Number of seats in each show.
+     * @brief Shows of a movie at any theater starting in [@p from, @p to).
+     *
+     * @return Shows sorted by start time (ties by show id).
+     *
+     * @details
+     * A scan of the movie and start time columns of the catalog (see ShowColumns); no
+     * other show field is read unless the show matches.
      */
-    static constexpr int kSeatCount = 20;
+    std::vector<Show> find_movie_shows_between(MovieId movie_id, ShowTime from, ShowTime to) const;
 
     /**
-     * @brief Internal per-show seat booking state (atomic bitmask).
+     * @brief Shows of any movie at a theater starting in [@p from, @p to) ("what's on tonight").
+     *
+     * @return Shows sorted by start time (ties by show id).
      *
      * @details
-     * This type is stored behind a std::unique_ptr because std::atomic is non-copyable,
-     * and we want stable storage for per-show state inside an unordered_map.
+     * One descent into the (theater, start time) skip list (show_time_index.hpp), then a
+     * walk along its bottom level; it takes no lock and runs while catalog writers insert
+     * and remove shows in place, without copying the index.
      */
-    struct ShowState {
-        std::atomic<std::uint32_t> booked_mask; /**< 20 LSB bits represent seats a1..a20. */
-
-        /** @brief Initializes all seats as available (mask=0). */
-        ShowState() : booked_mask(0u) {}
-
-        ShowState(const ShowState&) = delete;
-        ShowState& operator=(const ShowState&) = delete;
-    };
-
-    // In-memory data (small sample dataset)
-    std::vector<Movie> movies_;     /**< Stored movies. */
-    std::vector<Theater> theaters_; /**< Stored theaters. */
-    std::vector<Show> shows_;       /**< Stored shows (movie x theater). */
+    std::vector<Show> find_theater_shows_between(TheaterId theater_id, ShowTime from, ShowTime to) const;
 
     /**
-     * @brief Per-show booking state map.
+     * @brief Every show of a movie starting in [@p from, @p to) with its theater and free
+     *        seat count: the data of a movie page in one call.
      *
-     * @details
-     * Key: show id
-     * Value: pointer to per-show ShowState
+     * @param out Receives the shows, appended sorted by start time (ties by show id); not
+     *        cleared, so a caller reusing one buffer stays allocation-free once it has grown.
+     * @return Number of shows appended.
      *
-     * Using unordered_map enables O(1) average lookup for seat operations.
+     * @details
+     * One pass: the movie and start time columns are matched into a bitmap (on the
+     * request arena, see request_arena.hpp), and each matching row is read from the show
+     * columns and its state's free words counted as in @ref available_count, all under one
+     * snapshot guard. Replaces list_theaters_for_movie + find_show + available_count per
+     * theater.
      */
-    std::unordered_map<ShowId, std::unique_ptr<ShowState>> show_state_;
+    std::size_t movie_showtimes(MovieId movie_id, ShowTime from, ShowTime to, std::vector<ShowAvailability>& out) const;
+
+    /**
+     * @brief Returns the seat layout of a show.
+     *
+     * @param show_id The show identifier.
+     * @return Pointer to the layout, or nullptr if the show does not exist.
+     */
+    const HallLayout* layout_for_show(ShowId show_id) const;
+
+    /**
+     * @brief Adds a movie to the catalog.
+     * @return Ok or DuplicateId.
+     */
+    CatalogStatus add_movie(const Movie& movie);
+
+    /**
+     * @brief Adds a theater to the catalog.
+     * @return Ok or DuplicateId.
+     */
+    CatalogStatus add_theater(const Theater& theater);
+
+    /**
+     * @brief Registers a seat layout for new shows.
+     * @return Id to use in Show::layout_id; a layout equal to a registered one gets its id.
+     */
+    LayoutId add_layout(HallLayout layout);
+
+    /**
+     * @brief Adds a show and creates its booking state (all seats available).
+     *
+     * @param show Show to add; its movie, theater and layout must exist.
+     * @return Ok, DuplicateId, InvalidId (a negative id, or a new id of 2^22 and up once
+     *         2^22 such sparse ids are held), UnknownMovie, UnknownTheater or UnknownLayout.
+     *
+     * @details
+     * Catalog updates are serialised among themselves and never block readers: the
+     * catalog is copied, updated and published with one atomic pointer store, and the old
+     * snapshot is reclaimed once no reader can still use it (epoch-based reclamation).
+     */
+    CatalogStatus add_show(const Show& show);
+
+    /**
+     * @brief Removes a show from the catalog (find_show, list_theaters_for_movie, ...).
+     *
+     * @return Ok or UnknownShow.
+     *
+     * @details
+     * Only the catalog entry is removed: the show's booking state stays addressable by id,
+     * so existing bookings can still be audited and cancelled, and the id is not reused.
+     */
+    CatalogStatus remove_show(ShowId show_id);
+
+    /**
+     * @brief Moves a show to another hall (and seat map) while it keeps selling.
+     *
+     * @param layout_id Seat map of the new hall.
+     * @param translation Seat index of the new hall for each seat index of the current
+     *        one, -1 = none (see HallLayout::translate_to); empty = translate by label.
+     * @return Ok, or why nothing was changed.
+     *
+     * @details
+     * Only this show pauses: it is frozen on the service's ShowGate (show_gate.hpp), which
+     * drains the requests writing it and holds new ones at their lookup, without a lock
+     * or a shared write on any booking path. Its booked and held seats are then remapped
+     * through the table (bits, owners and the seats of its active holds, as one group
+     * write for the seqlock readers), the catalog row gets the new hall and layout, and
+     * the show thaws. Booking ids and hold ids stay valid. A request that parsed its seats
+     * against the old hall before the freeze and reaches the show after it is answered
+     * Contended, so its client retries against the new hall.
+     *
+     * Word storage is reused when the new hall has no more rows; a larger hall gets new
+     * storage, and the old words and owners stay allocated until the service is
+     * destroyed, so readers that looked the show up earlier finish on them.
+     */
+    MoveStatus move_show(ShowId show_id, LayoutId layout_id, int hall, Span<const int> translation = {});
+
+    /**
+     * @brief Opens, closes or blacks out the sales of a show.
+     *
+     * @return False if the show is unknown.
+     *
+     * @details
+     * The state is one byte in the show's first cache line, next to its booking words, and
+     * every booking CAS loop reads it with the word it replaces: a show that is not Open
+     * answers SalesClosed without a lock or a catalog lookup on the booking path. Opening
+     * is a single store, so a premiere goes on sale at once. Any other state is stored,
+     * then the show is frozen on the service's ShowGate to drain the requests already
+     * past the check, so once the call returns no new booking or hold can land. Holds
+     * taken before still confirm (and release); cancellations are not affected.
+     */
+    bool set_sales_state(ShowId show_id, SalesState state);
+
+    /** @brief Sales state of a show; Closed for an unknown show. */
+    SalesState sales_state(ShowId show_id) const;
+
+    /**
+     * @brief Closes the sales of every open show that starts at or before @p now.
+     *
+     * @return Number of shows closed. Run it from a periodic job, like @ref archive_shows_before.
+     */
+    std::size_t close_started_shows(ShowTime now);
+
+    /**
+     * @brief Moves every show that started before @p cutoff to cold storage.
+     *
+     * @return Number of shows archived.
+     *
+     * @details
+     * Each such show is removed from the catalog and from the booking state table (its id
+     * then answers InvalidShow, or UnknownShow, and cannot be added again), its active
+     * holds are released, and its final bookings are encoded into @ref cold_shows. Its
+     * owner table, large-hall words and cached rendering are freed by the next call, so a
+     * request that was already running on the show when it was archived finishes on valid
+     * memory; run it from a periodic maintenance job (e.g. hourly). Shows on shared seats
+     * keep their (shared) state. A booking that races the archive of its own show may be
+     * missing from the record.
+     */
+    std::size_t archive_shows_before(ShowTime cutoff);
+
+    /** @brief Shows archived by @ref archive_shows_before. */
+    const ColdShowStore& cold_shows() const { return cold_shows_; }
+
+    /**
+     * @brief How often each seat of hall layout @p layout_id sold, over its archived shows
+     *        (@ref cold_shows) that started in [@p from, @p to).
+     *
+     * @return Counts per seat index; empty counts if the layout is unknown.
+     *
+     * @details
+     * Decodes the cold store once into booking words, then sums the seat columns with the
+     * seat_heatmap.hpp kernels in chunks of shows on @ref thread_pool. Shows still in the
+     * catalog are not counted: their seats may still sell. Meant for reporting jobs.
+     */
+    SeatHeatmap seat_heatmap(LayoutId layout_id, ShowTime from = std::numeric_limits<ShowTime>::min(),
+                             ShowTime to = std::numeric_limits<ShowTime>::max()) const;
+
+    /**
+     * @brief Bytes in use per subsystem (see memory_budget.hpp), with peaks and budgets.
+     *
+     * @details
+     * Measures the catalog, seat states, indexes, holds and buffers from the sizes of their
+     * structures (one pass over the catalog's shows and maps, under the catalog lock) and
+     * reads the charged cache counter. Meant for monitoring and maintenance jobs, not
+     * request paths.
+     */
+    MemoryUsage memory_usage() const;
+
+    /**
+     * @brief Caps @p subsystem at @p bytes (0 = no budget).
+     *
+     * @details
+     * A Caches budget is enforced when a rendering is published: one that does not fit is
+     * served but not cached. The other budgets are enforced by @ref enforce_memory_budgets.
+     */
+    void set_memory_budget(MemorySubsystem subsystem, std::size_t bytes);
+
+    /** @brief Caps the sum of all subsystems at @p bytes (0 = none), e.g. 3/4 of cgroup_memory_limit(). */
+    void set_memory_budget_total(std::size_t bytes);
+
+    /**
+     * @brief Evicts until every budget holds, or nothing more can be evicted.
+     *
+     * @param now Current time; only shows that started before it are archived.
+     *
+     * @details
+     * Rendered availability goes first: it is rebuilt by the next read. If the states, or the
+     * total, are still over budget, the shows that started before @p now are moved to
+     * cold storage as by @ref archive_shows_before, the earliest first and an eighth of them
+     * per pass, until the budgets hold. Their memory is freed by the pass after theirs, or
+     * by the next archive call. Run it from the same maintenance job as archiving.
+     */
+    MemoryEviction enforce_memory_budgets(ShowTime now);
+
+    /** @brief Drops every cached availability rendering; returns how many were dropped. */
+    std::size_t evict_cached_availability();
+
+    /**
+     * @brief Loads a schedule export (see schedule_loader.hpp) into the catalog.
+     *
+     * @param path Schedule file; it is memory-mapped, not read into a buffer.
+     * @param threads Chunks parsed in parallel (0 = the thread pool's worker count).
+     * @return Ok, IoError, ParseError (with the line) or CatalogError.
+     *
+     * @details
+     * The file is parsed in parallel chunks on @ref thread_pool, then merged with @ref load_schedule.
+     */
+    ScheduleError load_schedule_file(const std::string& path, unsigned threads = 0);
+
+    /**
+     * @brief Adds every record of a parsed schedule to the catalog, all-or-nothing.
+     *
+     * @param schedule Records to add; its layout ids are remapped to new LayoutIds.
+     * @return Ok, or CatalogError (duplicate ids, unknown references, ids out of range)
+     *         with nothing loaded.
+     *
+     * @details
+     * Validates everything first, then builds the new snapshot in one pass with storage
+     * reserved up front and publishes it once, so readers see either none or all of the
+     * schedule. Much cheaper than one @ref add_show per record, which copies the catalog.
+     */
+    ScheduleError load_schedule(Schedule schedule);
+
+    /**
+     * @brief Removes @p removals from the catalog and adds @p additions, all-or-nothing, in
+     *        one published snapshot.
+     *
+     * @param additions Records to add, as for @ref load_schedule.
+     * @param removals Shows to remove, as by @ref remove_show (their booking state stays).
+     * @return Ok, or CatalogError (as for @ref load_schedule, or a removal that is not in
+     *         the catalog or is listed twice) with nothing changed.
+     *
+     * @details
+     * The whole batch is validated, then applied to one copy of the catalog that replaces
+     * the old one with a single pointer swap: a reader sees the catalog before or after
+     * the batch, never a show moved halfway (e.g. removed from its old time but not yet
+     * added at its new one). A show id removed in the batch cannot be added back by it.
+     * The theater timetable (@ref find_theater_shows_between) is updated in place, entry
+     * by entry, just before the swap.
+     */
+    ScheduleError apply_schedule_batch(Schedule additions, Span<const ShowId> removals);
+
+    /**
+     * @brief Writes a binary snapshot (see snapshot.hpp) of the catalog, all layouts and
+     *        the booking state of every catalog show.
+     *
+     * @param path Destination; written to "<path>.tmp", synced and renamed over @p path.
+     * @return Ok or IoError.
+     *
+     * @details
+     * Runs concurrently with bookings: only catalog writers wait. Each row word is read
+     * atomically, so the snapshot is fuzzy: a booking in flight may be captured in part.
+     * Replaying the journal on top (see @ref replay_journal) makes it exact.
+     * Holds are not persisted: held seats (set bits without an owner) are written free.
+     */
+    SnapshotStatus write_snapshot(const std::string& path) const;
+
+    /**
+     * @brief Exports the catalog and seat ownership as Arrow IPC files for offline analytics.
+     *
+     * @details
+     * Writes two files into @p directory (arrow_writer.hpp), each in record batches of up to
+     * @p batch_rows rows filled from the show columns and the owner rows, never from Show
+     * objects:
+     * - shows.arrow, one row per show: show_id, movie_id, movie_title, theater_id,
+     *   theater_name, start_time, hall, seats (capacity) and booked (seats with an owner);
+     * - seats.arrow, one row per booked seat: show_id, seat (seat index), label and booking_id.
+     * Consistency is that of @ref write_snapshot: catalog writers wait, bookings do not, and
+     * held seats (no owner yet) are left out.
+     * @return Ok or IoError.
+     */
+    SnapshotStatus export_arrow(const std::string& directory, std::size_t batch_rows = 65536) const;
+
+    /**
+     * @brief Publishes the occupancy of every show as one Arrow IPC file at @p path.
+     *
+     * @details
+     * One row per show: show_id, movie_id, theater_id, start_time, seats (capacity), taken
+     * (seats booked or held) and changes (the show's update counter, so a consumer can
+     * skip the shows that did not change). taken is the popcount of the show's booking
+     * words, read with one atomic load per row straight from the state array; no owner is
+     * read and nothing is rendered. The file replaces @p path with a rename, so a reader
+     * that mapped the previous one keeps a consistent copy. Under /dev/shm the file is
+     * shared memory: readers such as pyarrow.memory_map use its columns in place, without a
+     * request to (or serialization in) the booking process per query.
+     * @return Ok or IoError.
+     */
+    SnapshotStatus publish_occupancy(const std::string& path) const;
+
+    /**
+     * @brief Keeps @p options.path current with @ref publish_occupancy, republished every
+     *        @p options.interval by a background thread (an empty path stops it).
+     * @return Status of the first publication; on error nothing is started.
+     */
+    SnapshotStatus set_occupancy_export(const OccupancyExportOptions& options);
+
+    /** @brief Occupancy files published so far. */
+    std::uint64_t occupancy_publications() const { return occupancy_publications_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Encodes the free seats of every catalog show into one availability blob.
+     *
+     * @param out Replaced by the blob (format in availability_codec.hpp).
+     * @param encoding Payload of every show (Bitmap: a fixed size per layout).
+     * @return Version of the blob: one more than the previous blob's.
+     *
+     * @details
+     * Built for edge caches that serve seat maps instead of the booking process. The
+     * shows are split into chunks encoded in parallel on the service's thread pool, each
+     * show's words loaded as one consistent snapshot (as for available_seats_mask) straight
+     * from the state array; the payloads are then copied behind the index in show id
+     * order. The blob as a whole is not one instant: each show is exact as of its own read.
+     */
+    std::uint64_t encode_availability_blob(std::string& out, SeatEncoding encoding = SeatEncoding::Bitmap) const;
+
+    /**
+     * @brief Keeps an availability blob current: encoded every @p options.interval by a
+     *        background thread, written to @p options.path (replaced with a rename) and
+     *        handed to @p options.push. Options with neither stop it.
+     * @return Status of the first blob; on error nothing is started.
+     */
+    SnapshotStatus set_availability_export(const AvailabilityExportOptions& options);
+
+    /** @brief Version of the last availability blob encoded (0 = none yet). */
+    std::uint64_t availability_version() const { return availability_version_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Reprices every show with @p policy, again every @p policy.interval on a
+     *        background thread; a policy without steps stops it and drops the prices.
+     *
+     * @details
+     * A pass reads each catalog show's occupancy as the popcount of its booking words
+     * (relaxed loads straight from the state array, as @ref publish_occupancy; held seats
+     * count as taken), in chunks on the service's thread pool, picks its step and publishes
+     * the whole price table with one pointer swap. Readers (@ref price_adjustment,
+     * @ref price_quote) load the table under an epoch guard and replaced tables are
+     * reclaimed once no reader holds them, so neither side takes a lock or touches the
+     * lines bookings CAS on. Prices lag occupancy by at most one interval.
+     */
+    void set_dynamic_pricing(const PricingPolicy& policy);
+
+    /** @brief Runs one repricing pass now; returns the number of shows priced (0 when pricing is off). */
+    std::size_t reprice();
+
+    /** @brief Adjustment in percent of @p show_id in the current price table (0 if off or not priced yet). */
+    int price_adjustment(ShowId show_id) const;
+
+    /**
+     * @brief Price of @p seats of @p show_id now: HallLayout::price_of adjusted by the show's
+     *        step (rounded down); 0 for an unknown show.
+     */
+    std::uint64_t price_quote(ShowId show_id, const SeatMask& seats) const;
+
+    /** @brief Price tables published so far. */
+    std::uint64_t price_table_version() const { return price_table_version_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Adds the catalog and booking state of a snapshot file, all-or-nothing.
+     *
+     * @param path Snapshot written by @ref write_snapshot; it is memory-mapped and its
+     *        records are used in place.
+     * @return Ok, IoError, BadMagic, UnsupportedVersion, Corrupt (checksum or bounds) or
+     *         CatalogError (ids that clash with the catalog); nothing is restored on error.
+     *
+     * @details
+     * Seat words and owners are installed before the shows are published. Booking ids
+     * handed out afterwards are greater than every restored one.
+     * Intended for a warm restart into a service built with EmptyCatalog before it serves
+     * traffic.
+     *
+     * With SnapshotLoad::Lazy only the catalog is installed: the file is validated and
+     * stays mapped, and each show with bookings decodes its seat map on its first access
+     * (booking, read, snapshot or journal replay), so start-up time follows the catalog
+     * rather than the seat state. A show that is never accessed is never decoded.
+     */
+    SnapshotStatus restore_snapshot(const std::string& path, SnapshotLoad load = SnapshotLoad::Eager);
+
+    /** @brief Shows of lazy restores whose seats are not decoded yet. */
+    std::size_t lazy_shows_pending() const;
+
+    /**
+     * @brief Decodes every show still pending from a lazy restore (e.g. from a background
+     *        thread once the service serves traffic).
+     * @return Shows that were pending when the call started.
+     */
+    std::size_t load_lazy_shows();
+
+    /**
+     * @brief Keeps an incremental snapshot in @p options.directory, refreshed every
+     *        @p options.interval by a background thread (an empty directory stops it).
+     *
+     * @return Status of the first pass, which writes a base snapshot; on error nothing is
+     *         started.
+     *
+     * @details
+     * Every successful seat update marks its show in a bitmap of changed shows (one load,
+     * and one atomic OR on the first change of the interval). Each later pass drains that
+     * bitmap and writes only the marked shows' seat maps to the next delta, so the cost of
+     * a pass follows the shows that sold something rather than the size of the catalog. A
+     * pass writes a new base instead (and deletes the old deltas) after
+     * @p options.full_every deltas, after a catalog change, or after a failed pass.
+     * Bookings never wait for a pass: states are read with the same fuzzy atomic loads as
+     * @ref write_snapshot, and journal replay from the last file's LSN makes them exact.
+     * Seat changes made by other processes on shared seats are not tracked.
+     *
+     * With @p options.compact_journal the passes double as a checkpointer: each new base
+     * is followed by @ref compact_journal at the base's LSN, so recovery
+     * (@ref restore_snapshot_chain, then @ref replay_journal) reads at most one base, its
+     * deltas and the journal written since that base, however long the service has run.
+     */
+    SnapshotStatus set_incremental_snapshots(const IncrementalSnapshotOptions& options);
+
+    /** @brief Runs one pass of @ref set_incremental_snapshots now (IoError when it is off). */
+    SnapshotStatus write_incremental_snapshot();
+
+    /** @brief Counters of @ref set_incremental_snapshots. */
+    IncrementalSnapshotStats incremental_snapshot_stats() const;
+
+    /**
+     * @brief @ref restore_snapshot of the base snapshot in @p directory, then applies its
+     *        deltas in order.
+     *
+     * @return Status of the base restore. A delta that is missing, damaged, or written
+     *         for another base ends the chain: the state is that of the last delta applied.
+     *
+     * @details
+     * Shows a delta names but the catalog lacks are skipped. The journal replay start
+     * (see @ref replay_journal) moves to the LSN of the last delta applied. With
+     * SnapshotLoad::Lazy the base is restored lazily; shows a delta names are decoded then.
+     */
+    SnapshotStatus restore_snapshot_chain(const std::string& directory, SnapshotLoad load = SnapshotLoad::Eager);
+
+    /**
+     * @brief Journal LSN the restored snapshots cover (0 without one): journal records below
+     *        it are already in the state (a standby tails the journal from here, standby.hpp).
+     */
+    std::uint64_t restored_journal_lsn() const { return replay_from_lsn_; }
+
+    /**
+     * @brief Keeps the seat state of every show added from now on in the shared-memory
+     *        region @p name, so worker processes on one host book against the same seats.
+     *
+     * @param name POSIX shared memory name ("/cinema-seats"); created by the first process.
+     * @param capacity, slots Size and show slots of a newly created region (see SharedSeatRegion).
+     * @return Ok, IoError, BadHeader, or InUse if the service already has shows.
+     *
+     * @details
+     * Each process loads the same schedule; a show's booking words and owner table are
+     * claimed in the region by the first process that adds it and mapped by the others,
+     * and booking ids are reserved from a counter in the region so they stay unique across
+     * processes. Bookings, cancellations and holds then run exactly as in one process:
+     * CASes on the shared words, no IPC. add_show / load_schedule fail with NoSharedRoom
+     * when the region is full or another process added the show with a different layout.
+     * Holds, journals, metrics and contention counters remain per process (a hold of a
+     * process that dies is not released).
+     * @note Call on an EmptyCatalog service, before adding shows.
+     */
+    SharedSeatsStatus attach_shared_seats(const std::string& name,
+                                          std::size_t capacity = SharedSeatRegion::kDefaultCapacity,
+                                          std::size_t slots = 1u << 16);
+
+    /**
+     * @brief Keeps the seat state of every show added from now on in the file @p path,
+     *        ideally on persistent memory, so bookings survive a restart without a journal.
+     *
+     * @param path Seat region file; created if missing, recovered otherwise. On a DAX
+     *        filesystem (PMEM, CXL memory) it is mapped with MAP_SYNC.
+     * @param capacity, slots Size and show slots of a newly created file (see SharedSeatRegion).
+     * @return Ok, IoError, BadHeader, Locked if another process has the file open, or InUse
+     *         if the service already has shows.
+     *
+     * @details
+     * The words and owner tables are the shared-seat blocks of @ref attach_shared_seats, kept
+     * in the file. On a DAX mapping a booking writes back its words and owner entries and
+     * fences once before it returns (a cancellation after its release), so an acknowledged
+     * booking or cancellation is durable; the same load_schedule after a restart finds the
+     * shows' seats and owners as they were, and old booking ids keep cancelling. Seats left
+     * set without an owner (holds, bookings cut short by the crash) are freed on open.
+     * Without DAX the file is an ordinary mapping: durable only after @ref sync_persistent_seats
+     * or a clean unmap.
+     * @note Call on an EmptyCatalog service, before adding shows.
+     */
+    SharedSeatsStatus attach_persistent_seats(const std::string& path,
+                                              std::size_t capacity = SharedSeatRegion::kDefaultCapacity,
+                                              std::size_t slots = 1u << 16);
+
+    /** @brief Writes the seat file of @ref attach_persistent_seats back to storage (msync); false if none. */
+    bool sync_persistent_seats();
+
+    /**
+     * @brief Starts journaling bookings and cancellations to @p path (see journal.hpp).
+     *
+     * @param path Journal file; created if missing, appended to otherwise.
+     * @param mode Sync: booking calls return once their record is fsync-ed (concurrent
+     *        bookings share one sync); Async: a background sync follows shortly; None: written only.
+     * @param backend Writer I/O (io_uring when available by default, see JournalBackend).
+     * @return Ok, IoError or BadHeader.
+     *
+     * @details
+     * Appending is lock-free. A booking is journaled after its owners are recorded and a
+     * cancellation after its seats are released, so per seat the journal order is the
+     * order in which the operations took effect. Holds are not journaled; confirming
+     * one journals the booking.
+     * @note Call once, before serving traffic (after @ref restore_snapshot and
+     *       @ref replay_journal when recovering).
+     */
+    JournalStatus open_journal(const std::string& path, JournalMode mode,
+                               JournalBackend backend = JournalBackend::Auto);
+
+    /**
+     * @brief Waits until every journaled operation so far is durable.
+     * @return False if no journal is open or it hit an I/O error.
+     */
+    bool sync_journal();
+
+    /**
+     * @brief Drops the journal records below @p before_lsn (Journal::compact), e.g. those
+     *        covered by a snapshot whose SnapshotHeader::journal_lsn is @p before_lsn.
+     * @return Ok, or IoError if no journal is open or the rewrite failed.
+     */
+    JournalStatus compact_journal(std::uint64_t before_lsn);
+
+    /**
+     * @brief Adds @p wait to the durability a Sync journal waits for (Journal::set_commit_wait),
+     *        e.g. ReplicationSource::wait_committed for quorum commits.
+     * @return False if no journal is open.
+     * @note Call after @ref open_journal and before serving traffic.
+     */
+    bool set_journal_commit_wait(Journal::CommitWait wait);
+
+    /**
+     * @brief Passes every committed journal batch to @p tap on the journal's writer thread
+     *        (Journal::set_commit_tap), e.g. AuditTap::journal_tap for an audit log.
+     * @return False if no journal is open.
+     * @note Call after @ref open_journal and before serving traffic; the tap must outlive
+     *       the journal, which lives as long as the service.
+     */
+    bool set_journal_tap(Journal::CommitTap tap);
+
+    /**
+     * @brief Blocks until the journal record of @p commit_lsn is durable, including the commit
+     *        wait (what a Sync operation waits for before returning).
+     * @return False if no journal is open or it hit an I/O error.
+     */
+    bool wait_journal(std::uint64_t commit_lsn);
+
+    /** @brief Journal records below this LSN are durable locally (0 without a journal). */
+    std::uint64_t journal_durable_lsn() const { return journal_ ? journal_->durable_lsn() : 0u; }
+
+    /**
+     * @brief Applies the records of a journal on top of the current state (recovery).
+     *
+     * @param path Journal written by @ref open_journal.
+     * @return Counts of applied and skipped records; status IoError/BadHeader if the file
+     *         cannot be read (a missing file has nothing to replay and is Ok).
+     *
+     * @details
+     * Records older than the snapshot given to @ref restore_snapshot are skipped; the rest
+     * are applied in order, which is idempotent against the fuzzy snapshot: a booking
+     * sets its seats and owners, a cancellation frees the seats still owned by its
+     * booking. Replay stops at the first torn or corrupt record. Records for shows that
+     * are not in the catalog are skipped (catalog changes are persisted by snapshots).
+     *
+     * The file is memory-mapped and replayed on the thread pool (@ref set_thread_pool):
+     * records are located from their headers, checksummed in parallel chunks, and then
+     * partitioned by show, each partition applying its shows' records in journal order
+     * while the partitions run side by side. Small journals replay on the calling thread.
+     * @note Call before serving traffic and before @ref open_journal.
+     */
+    JournalReplay replay_journal(const std::string& path);
+
+    /**
+     * @brief Applies one journal record to the seat state while the service serves reads
+     *        (recovery replay and replicas, see replication.hpp).
+     *
+     * @details
+     * Same idempotent rules as @ref replay_journal; records spanning several rows are
+     * applied under the show's seqlock, so availability reads never see half of one.
+     * Bookings applied this way are not journaled again.
+     * @return False if the record was skipped (unknown show or booking id 0).
+     */
+    bool apply_journal_record(const JournalRecord& record);
+
+    /**
+     * @brief Lists available seats for a show.
+     *
+     * @param show_id The show identifier.
+     * @return Vector of seat labels that are currently free (e.g. "a1", "a2", ...).
+     *
+     * @details
+     * Loads each row word once and converts all 0-bits of existing seats into labels,
+     * in row-major order.
+     */
+    std::vector<std::string> list_available_seats(ShowId show_id) const;
+
+    /** @brief @ref list_available_seats through a handle (see @ref show_handle). */
+    std::vector<std::string> list_available_seats(ShowHandle& show) const;
+
+    /**
+     * @brief @ref list_available_seats with the vector and labels allocated from @p resource
+     *        (e.g. a RequestArena scope's, so a listing never reaches the global heap).
+     */
+    std::pmr::vector<std::pmr::string> list_available_seats(ShowId show_id, std::pmr::memory_resource* resource) const;
+
+    /**
+     * @brief Appends the labels of the free seats of a show to @p out.
+     *
+     * @param show_id The show identifier.
+     * @param out Buffer the labels are appended to ("a1 a2 a5"), in row-major order.
+     * @param separator Byte written between two labels.
+     * @return Number of free seats, or -1 if the show does not exist (@p out unchanged).
+     *
+     * @details
+     * For protocol encoders: labels are copied from the layout's prerendered table
+     * (HallLayout::render_labels), so a reused @p out is not reallocated once it has grown.
+     */
+    int append_available_seats(ShowId show_id, std::string& out, char separator = ' ') const;
+
+    /**
+     * @brief Appends the free seats of a show to @p out in @p encoding (see
+     *        availability_codec.hpp).
+     *
+     * @return Number of free seats, or -1 if the show does not exist (@p out unchanged).
+     *
+     * @details
+     * The payload is written straight from the loaded seat words into @p out's spare room,
+     * without label strings in between; a reused @p out is not reallocated once it has
+     * grown. Callers with their own buffers (e.g. for writev) can load
+     * @ref available_seats_mask and call encode_free_seats directly.
+     */
+    int append_available_seats(ShowId show_id, SeatEncoding encoding, std::string& out) const;
+
+    /**
+     * @brief @ref append_available_seats with a space separator, served from a per-show
+     *        cache of the last rendered payload.
+     *
+     * @return Number of free seats, or -1 if the show does not exist (@p out unchanged).
+     *
+     * @details
+     * For hot availability reads (a premiere drop): the cached payload is keyed by the
+     * free-seat words it was rendered from, so a read loads the show's words, compares
+     * them with the cached ones and, while nobody booked, only copies the shared buffer.
+     * When the words differ the payload is rendered again and published for the next
+     * readers; replaced payloads are reclaimed through an epoch domain, so reads never
+     * block or count references. The output is always that of the words loaded by the
+     * call, as with the uncached path.
+     */
+    int append_cached_available_seats(ShowId show_id, std::string& out) const;
+
+    /** @brief @ref append_cached_available_seats through a handle (see @ref show_handle). */
+    int append_cached_available_seats(ShowHandle& show, std::string& out) const;
+
+    /**
+     * @brief Publishes every seat-word change from now on to a broadcast ring of
+     *        @p capacity slots (power of two), for push-based seat map updates.
+     *
+     * @details
+     * After each successful CAS or release of a booking word (bookings, holds,
+     * cancellations, expiries, rollbacks) the (show, row, old bits, new bits) change is
+     * appended with a sequence number; see change_feed.hpp for reading it and for
+     * resyncing after a gap. Restores and journal replays are not published, nor are
+     * changes made by other processes sharing the seats (@ref attach_shared_seats).
+     * Without a feed the booking paths pay one pointer test; with one, every word write
+     * is also a group write of its show (two more atomic adds), so that
+     * @ref availability_snapshot can cut seats and feed together. With @p lanes > 1 booking
+     * threads take sequence numbers from per-thread lanes instead of one shared counter
+     * (see change_feed.hpp), for many cores booking unrelated shows.
+     * @note Call before serving traffic; later calls are ignored.
+     * @throws std::invalid_argument if @p capacity is not a power of two >= 2, or @p lanes
+     *         not a power of two <= min(64, @p capacity).
+     */
+    void enable_change_feed(std::size_t capacity = 1u << 16, std::size_t lanes = 1);
+
+    /** @brief The change feed to subscribe to, or nullptr if not enabled. */
+    const SeatChangeFeed* change_feed() const { return change_feed_.get(); }
+
+    /**
+     * @brief Taps every successful booking into approximate sales analytics: tickets sold
+     *        per movie per minute and distinct customers per movie (sales_analytics.hpp).
+     *
+     * @details
+     * Recorded where a booking's owners are set (seat, best-available, batch, group,
+     * bundle, partial and confirmed hold bookings and waitlist promotions), into sketches
+     * of the recording thread: no shared write, lock or event store on the booking path.
+     * Customers are named with SalesAnalytics::CustomerScope. Journal replays and restores
+     * are not recorded. Without analytics the booking paths pay one pointer test.
+     * @note Call before serving traffic; later calls are ignored.
+     * @throws std::invalid_argument on invalid @p options.
+     */
+    void enable_sales_analytics(const SalesAnalyticsOptions& options = SalesAnalyticsOptions{});
+
+    /** @brief The analytics to query, or nullptr if not enabled. */
+    const SalesAnalytics* sales_analytics() const { return sales_.get(); }
+
+    /**
+     * @brief Maintains per-movie show orderings by seats left and by cheapest free seat
+     *        for @ref shows_by_seats_left and @ref shows_by_cheapest_seat.
+     *
+     * @details
+     * Enables the change feed (with @p feed_capacity slots, if it is not enabled yet) and
+     * subscribes an AvailabilityViews (availability_views.hpp) to it. Each drain of the
+     * feed recomputes the shows it names from their live words and moves them within
+     * their movie's orderings; a gap in the feed resyncs every show. Shows added to or
+     * removed from the catalog join or leave the views with their catalog update.
+     * @note Call before serving traffic; later calls are ignored.
+     */
+    void enable_availability_views(std::size_t feed_capacity = 1u << 16);
+
+    /** @brief The views, or nullptr if not enabled. */
+    const AvailabilityViews* availability_views() const { return views_.get(); }
+
+    /**
+     * @brief Applies the feed changes published since the last drain to the views.
+     * @return Number of shows recomputed (0 without views).
+     */
+    std::size_t refresh_availability_views() const;
+
+    /**
+     * @brief Up to @p limit shows of @p movie_id, most seats left first (ties by show id).
+     *
+     * @details
+     * Drains the pending feed changes first unless another thread is draining, in which
+     * case the views may trail that drain. Empty without @ref enable_availability_views.
+     */
+    std::vector<RankedShow> shows_by_seats_left(MovieId movie_id, std::size_t limit) const;
+
+    /**
+     * @brief Up to @p limit shows of @p movie_id with a seat for sale, cheapest free seat
+     *        first (ties by show id); as @ref shows_by_seats_left otherwise.
+     */
+    std::vector<RankedShow> shows_by_cheapest_seat(MovieId movie_id, std::size_t limit) const;
+
+    /**
+     * @brief Maintains the longest run of adjacent free seats of every show (in one row,
+     *        not across an aisle) for @ref shows_with_adjacent_seats and
+     *        @ref filter_adjacent_seats.
+     *
+     * @details
+     * A SeatRunSummary (seat_run_summary.hpp): one byte per row and one per show, kept
+     * apart from the seat words and refreshed by the writer after each successful word
+     * update, so screening shows reads one cache line per 64 shows and no seat map. The
+     * same hierarchy serves single shows: book_best_available fails at once when the
+     * show's longest run is too short and otherwise loads only the rows with a long enough
+     * run, and @ref available_count reads the show's free seat total.
+     * Shows added to or removed from the catalog join or leave it with their catalog
+     * update. Seats written by another process into a shared seat region are not seen.
+     * @note Call before serving traffic; later calls are ignored.
+     */
+    void enable_seat_run_summary();
+
+    /** @brief True if @ref enable_seat_run_summary was called. */
+    bool seat_run_summary_enabled() const { return run_summary_.load(std::memory_order_acquire) != nullptr; }
+
+    /**
+     * @brief Shows with at least @p n adjacent free seats in one row, in ShowTable order.
+     *
+     * @details
+     * With @ref enable_seat_run_summary one vectorised byte comparison per 64 shows;
+     * without it every show's words are loaded. Exact for the words seen at the time.
+     */
+    std::vector<ShowId> shows_with_adjacent_seats(int n) const;
+
+    /**
+     * @brief Removes from @p shows (e.g. a @ref find_movie_shows_between result) the shows
+     *        without @p n adjacent free seats in one row; order is kept.
+     */
+    void filter_adjacent_seats(std::vector<Show>& shows, int n) const;
+
+    /**
+     * @brief Enables request-id idempotency for @ref book_seats_once and
+     *        @ref book_seat_mask_once: a repeat of a request id within @p ttl of its
+     *        completion is answered with the original outcome.
+     *
+     * @details
+     * Ids live in a RequestDedupe of about @p capacity slots; each call costs one probe
+     * of it before the booking and one store after. Without it the _once calls are plain
+     * bookings.
+     * @note Call before serving traffic; later calls are ignored.
+     */
+    void enable_request_dedupe(std::chrono::milliseconds ttl = std::chrono::minutes(10),
+                               std::size_t capacity = 1u << 16);
+
+    /** @brief The request id table, or nullptr if not enabled. */
+    const RequestDedupe* request_dedupe() const { return dedupe_.get(); }
+
+    /**
+     * @brief Allocation-free availability snapshot as a seat bitmap.
+     *
+     * @param show_id The show identifier.
+     * @param out_free Filled with the free seats (bit set => seat available); cleared on entry.
+     * @return Number of free seats (popcount of @p out_free), or -1 if the show does not exist.
+     *
+     * @details
+     * Each row word is loaded once. Label formatting is left to the caller
+     * (see HallLayout::label).
+     */
+    int available_seats_mask(ShowId show_id, SeatMask& out_free) const;
+
+    /** @brief Known version that matches no show version (always returns the seats). */
+    static constexpr std::uint64_t kNoVersion = ~std::uint64_t{0};
+
+    /**
+     * @brief Conditional availability read for clients that cache seat maps.
+     *
+     * @param known_version Version returned by an earlier call, or @ref kNoVersion.
+     * @param out_free On Changed, the free seats (as @ref available_seats_mask); untouched otherwise.
+     * @param out_version On Changed, the version @p out_free is at least as new as.
+     *
+     * @details
+     * Every show has a change counter, bumped after each successful update of one of
+     * its booking words (bookings, holds, cancellations, expiries, rollbacks, journal
+     * replay). The counter is loaded before the words, so a change can only make a
+     * later call report Changed again, never hide it: when the counter still equals
+     * @p known_version the call returns Unchanged after a single load. Shows on shared
+     * seats keep the counter in the shared region, so changes made by other processes
+     * count too.
+     */
+    AvailabilityStatus availability_if_changed(ShowId show_id, std::uint64_t known_version, SeatMask& out_free,
+                                               std::uint64_t& out_version) const;
+
+    /**
+     * @brief Seats of a show taken and freed since change feed position @p since.
+     *
+     * @param since Position returned by the previous call, or the feed's head() read
+     *        before the seat map the client started from.
+     *
+     * @details
+     * Scans the change feed from @p since to its head (stopping at a change still being
+     * written) and folds the changes of the show into per-row flip masks, so the cost is
+     * linear in the changes since the last poll, not in the size of the hall. A seat that
+     * was booked and cancelled in between is in neither mask. Start from a seat map and
+     * position of @ref availability_snapshot and flip the seats of both masks: that is
+     * exact whatever order the changes were numbered in. Needs @ref enable_change_feed;
+     * returns Resync (with the current head as position) when the client fell more than
+     * a ring behind.
+     */
+    AvailabilityDiff availability_diff(ShowId show_id, std::uint64_t since) const;
+
+    /**
+     * @brief A show's free seats and the change feed position to diff them from.
+     *
+     * @param out_free Filled with the free seats; cleared on entry.
+     * @param position Set to a position for @ref availability_diff (0 without a feed).
+     * @return Number of free seats, or -1 if the show does not exist.
+     *
+     * @details
+     * The seats and the position are one cut of the show: every change in @p out_free is
+     * numbered below the position and every later one at or above it, so the diffs from
+     * the position hold exactly the changes the seat map misses. Read like
+     * available_seats_mask, between two group-write counts with no writer in between
+     * (with a feed, every seat write is a group write; SeatChangeFeed::cut keeps idle lanes
+     * from numbering a later change below the position). Starting point of a mirror such
+     * as SeatMapClient.
+     */
+    int availability_snapshot(ShowId show_id, SeatMask& out_free, std::uint64_t& position) const;
+
+    /**
+     * @brief Number of free seats of a show ("X seats left").
+     *
+     * @param show_id The show identifier.
+     * @return Free seat count, or -1 if the show does not exist.
+     *
+     * @details
+     * Derived from one load and one popcount per row word, so the booking path keeps no
+     * extra shared counter to update. With @ref enable_seat_run_summary, the show's total
+     * kept there instead (one load). Allocation-free.
+     */
+    int available_count(ShowId show_id) const;
+
+    /**
+     * @brief Rows of a show that have a free seat (bit r = row r); 0 if sold out or unknown.
+     *
+     * @details
+     * Halls of more than four rows (arenas up to 64 rows of 64 seats) keep this as a
+     * summary word next to their word pointer, refreshed by the updates that fill or free
+     * a row; the seat searches (book_best_available, book_group) load only the words of
+     * these rows. Smaller halls compute it from their words.
+     */
+    std::uint64_t rows_with_free_seats(ShowId show_id) const;
+
+    /**
+     * @brief Bulk @ref available_count for listing pages.
+     *
+     * @param show_ids Shows to query.
+     * @param out_counts Receives one count per show (-1 for unknown shows); must be at least
+     *        as long as @p show_ids.
+     * @return Number of known shows.
+     *
+     * @details
+     * Each count is the popcount of the show's free words, read straight from its state
+     * (or its read mirror, see @ref set_read_mirror).
+     * Lists of 4096 shows or more are split into chunks counted in parallel on
+     * @ref thread_pool; allocation-free either way.
+     */
+    std::size_t available_counts(Span<const ShowId> show_ids, Span<int> out_counts) const;
+
+    /**
+     * @brief Serves availability reads from a reader-side mirror refreshed every @p refresh.
+     *
+     * @details
+     * Every read of a show's free seats loads the booking words that writers CAS on, so
+     * heavy read traffic keeps stealing those lines from the writers. With a mirror, a
+     * refresher thread copies each show's free words into a separate table every
+     * @p refresh (only rewriting the shows that changed), and @ref list_available_seats,
+     * @ref append_available_seats, @ref append_cached_available_seats,
+     * @ref available_seats_mask, @ref available_count and @ref available_counts read the
+     * copy under a per-show seqlock instead. Their results may then be up to @p refresh
+     * (plus one refresh pass) old; a show not mirrored yet, or that changed its layout since,
+     * is read live. Bookings, cancellations and @ref availability_if_changed always use the
+     * authoritative words. A zero @p refresh stops the refresher and reads live again.
+     *
+     * @note Not synchronised with concurrent calls of itself.
+     */
+    void set_read_mirror(std::chrono::microseconds refresh);
+
+    /** @brief Refresh interval of the read mirror (zero = off). */
+    std::chrono::microseconds read_mirror() const { return mirror_refresh_; }
+
+    /**
+     * @brief Copies the free words of every show that changed into the read mirror now.
+     * @return Number of shows whose mirror was rewritten. Thread-safe.
+     */
+    std::size_t refresh_read_mirrors();
+
+    /**
+     * @brief Books one or more seats for a show atomically (all-or-nothing).
+     *
+     * @param show_id The show identifier.
+     * @param seat_labels Seat labels to book (e.g. {"a1","a2"}).
+     * @return BookingResult describing success or the reason for failure.
+     *
+     * @details
+     * - Validates the show id and that seat_labels is non-empty.
+     * - Parses and validates seat labels against the show layout (range + duplicates).
+     * - Converts requested seats to a SeatMask.
+     * - Uses a CAS loop on the row word to ensure:
+     *   - no overbooking under concurrency
+     *   - all-or-nothing booking for multiple seats
+     *
+     * Requests spanning several rows acquire the row words in ascending order, each with
+     * its own CAS loop, and roll back the words already taken on the first conflict.
+     * A concurrent request may briefly observe (and fail on) seats of a group booking that
+     * is being rolled back, but no seat is ever booked twice and no lock is taken.
+     *
+     * On layouts with seat categories each CAS also checks, on the word it replaces, that
+     * every requested companion seat ends up next to a booked wheelchair space; otherwise
+     * nothing is booked and the result is CompanionSeatRule. Layouts that forbid single
+     * gaps likewise reject (SingleSeatGap) a word that would gain an isolated free seat.
+     */
+    BookingResult book_seats(ShowId show_id, const std::vector<std::string>& seat_labels);
+
+    /**
+     * @brief @ref book_seats without waiting for a Sync journal (asynchronous callers).
+     *
+     * @param commit_lsn Receives the LSN to await with @ref wait_journal before the booking
+     *        may be acknowledged; 0 if there is nothing to wait for (failure, no Sync journal).
+     */
+    BookingResult book_seats(ShowId show_id, const std::vector<std::string>& seat_labels, std::uint64_t* commit_lsn);
+
+    /**
+     * @brief Looks @p show_id up once for repeated calls of one caller (an invalid handle
+     *        if there is no such show).
+     *
+     * @details
+     * A connection that books and lists the same show over and over passes the handle to
+     * the ShowHandle overloads of @ref book_seats, @ref list_available_seats and
+     * @ref hold_seats, which use its state pointer directly instead of looking the id up.
+     * Show states never move, and a handle checks one epoch counter, bumped whenever show
+     * states are erased, before using its pointer; a stale handle looks the id up again.
+     * A handle is not synchronised: give each thread its own.
+     */
+    ShowHandle show_handle(ShowId show_id) const;
+
+    /** @brief @ref book_seats through a handle (InvalidShow if its show no longer exists). */
+    BookingResult book_seats(ShowHandle& show, const std::vector<std::string>& seat_labels);
+
+    /**
+     * @brief Zero-copy variant of @ref book_seats taking string_view labels.
+     *
+     * @param show_id The show identifier.
+     * @param seat_labels Views of the seat labels, e.g. pointing into a network buffer.
+     * @return Same results as @ref book_seats.
+     */
+    BookingResult book_seat_labels(ShowId show_id, Span<const std::string_view> seat_labels);
+
+    /** @brief @ref book_seat_labels through a handle (see @ref show_handle). */
+    BookingResult book_seat_labels(ShowHandle& show, Span<const std::string_view> seat_labels);
+
+    /**
+     * @brief @ref book_seat_labels on a space- or tab-separated label list, e.g. the tail of
+     *        a request line ("a1 a2 b7").
+     *
+     * @details
+     * For large group requests from gateways: the list is split and parsed in one pass
+     * (see @ref label_list_to_mask_or_fail) instead of being tokenized first. label_index
+     * of a failure counts labels in the list.
+     */
+    BookingResult book_label_list(ShowId show_id, std::string_view seat_labels);
+
+    /** @brief @ref book_label_list through a handle (see @ref show_handle). */
+    BookingResult book_label_list(ShowHandle& show, std::string_view seat_labels);
+
+    /**
+     * @brief Validation stage of @ref book_seat_labels on its own: resolves @p seat_labels
+     *        to a mask of show @p show_id without touching its seats.
+     *
+     * @details Lets a front end parse on its I/O threads and hand only the mask to the
+     * threads that book it (see BookingPipeline); @ref book_seat_mask then re-checks the
+     * mask against the layout with one AND per word.
+     * @return Ok, or the error book_seat_labels would return for the labels (InvalidShow,
+     *         NoSeats, InvalidSeatLabel, DuplicateSeatLabel with label_index and label).
+     */
+    BookingResult parse_seat_labels(ShowId show_id, Span<const std::string_view> seat_labels, SeatMask& out) const;
+
+    /**
+     * @brief Books pre-parsed seat indices (see HallLayout::seat_index), all-or-nothing.
+     *
+     * @param show_id The show identifier.
+     * @param seats Seat indices of the show layout.
+     * @return As @ref book_seats; InvalidSeatIndex / DuplicateSeatLabel carry the position
+     *         of the offending index in BookingResult::label_index.
+     */
+    BookingResult book_seat_indices(ShowId show_id, Span<const int> seats);
+
+    /**
+     * @brief Books a ready seat mask, all-or-nothing.
+     *
+     * @param show_id The show identifier.
+     * @param seats Requested seats; every bit must name a seat of the show layout.
+     * @return As @ref book_seats; InvalidSeatIndex if a bit lies outside the layout.
+     */
+    BookingResult book_seat_mask(ShowId show_id, const SeatMask& seats);
+
+    /** @brief @ref book_seat_mask without waiting for a Sync journal (see the deferred @ref book_seats). */
+    BookingResult book_seat_mask(ShowId show_id, const SeatMask& seats, std::uint64_t* commit_lsn);
+
+    /**
+     * @brief Idempotent @ref book_seats: a repeat of @p request_id gets the original outcome
+     *        (see @ref enable_request_dedupe).
+     *
+     * @param request_id Client-chosen id of the logical request (e.g. 64 random bits), sent
+     *        again unchanged on every retry.
+     * @return As @ref book_seats; for a repeat, the status, BookingId and label_index of the
+     *         original (its seat masks are not kept); RequestInFlight while the original is
+     *         still running; RequestIdReused if the id came with another show or other seats.
+     *         Transient failures (Contended, Throttled) are not remembered: a retry runs again.
+     */
+    BookingResult book_seats_once(std::uint64_t request_id, ShowId show_id, const std::vector<std::string>& seat_labels);
+
+    /** @brief Idempotent @ref book_seat_mask (see @ref book_seats_once). */
+    BookingResult book_seat_mask_once(std::uint64_t request_id, ShowId show_id, const SeatMask& seats);
+
+    /**
+     * @brief Books as many of @p seats as are free (partial mode for resellers and other
+     *        "as many of these as possible" clients).
+     *
+     * @param show_id The show identifier.
+     * @param seats Requested seats; every bit must name a seat of the show layout.
+     * @param out_seats On success, the seats obtained (a subset of @p seats); cleared on entry.
+     * @return Ok with the BookingId if at least one seat was obtained, BookingResult::conflicts
+     *         then holding the requested seats that were not; AlreadyBooked (conflicts: all
+     *         of @p seats) if none was free; InvalidSeatIndex as @ref book_seat_mask.
+     *
+     * @details
+     * Each row's CAS sets `req & ~current` of the very word it replaces, so finding the free
+     * seats and taking them is one loop and a failed request needs no second, smaller round
+     * trip. The companion and single-seat-gap rules are checked on that word as in
+     * @ref book_seats; a row whose free seats would break them is skipped (its seats are not
+     * obtained), and if every row is skipped the result is CompanionSeatRule or
+     * SingleSeatGap. Rows are taken in ascending order as one group write; if a row's CAS
+     * runs out of retries the rows already taken are released and the result is Contended.
+     */
+    BookingResult book_any_seat_mask(ShowId show_id, const SeatMask& seats, SeatMask& out_seats);
+
+    /** @brief Label form of @ref book_any_seat_mask (label errors as @ref book_seats). */
+    BookingResult book_any_seats(ShowId show_id, const std::vector<std::string>& seat_labels, SeatMask& out_seats);
+
+    /**
+     * @brief Books the best @p n adjacent seats of one row.
+     *
+     * @param show_id The show identifier.
+     * @param n Number of seats wanted together, in [1..64].
+     * @param out_seats On success, the booked seats; cleared on entry.
+     * @return Ok with the BookingId, NoSeats (n < 1), NoContiguousSeats or Contended.
+     *
+     * @details
+     * Each row word is loaded once; runs of n free seats are found with shift-and-AND,
+     * vectorised over all rows (see seat_scan.hpp), and the candidate closest to the row
+     * centre is picked with bit scans. Among rows the lowest HallLayout::run_cost wins (ties: front row). Wheelchair
+     * and companion seats (HallLayout::set_seat_categories) are never picked, nor runs that would leave a single
+     * free seat on layouts that forbid it (candidates filtered with gap_leaving_starts), nor runs across an aisle
+     * (filtered with the layout's precomputed HallLayout::block_starts). The run is booked with the usual
+     * CAS; if another thread took one of its seats first, the search is repeated on fresh
+     * state (bounded by the backoff policy).
+     */
+    BookingResult book_best_available(ShowId show_id, int n, SeatMask& out_seats);
+
+    /**
+     * @brief @ref book_best_available among the seats priced at most @p max_price.
+     *
+     * @return As book_best_available; NoContiguousSeats if no run of n free seats is
+     *         within the budget.
+     *
+     * @details
+     * The free row words are ANDed with the layout's cumulative price mask for the budget
+     * (see HallLayout::set_price_tiers) before the run search, and the run is booked with
+     * one CAS like any best-available booking. Layouts without tiers price every seat at 0.
+     * The price paid is HallLayout::price_of(@p out_seats).
+     */
+    BookingResult book_best_under(ShowId show_id, int n, std::uint32_t max_price, SeatMask& out_seats);
+
+    /**
+     * @brief Books @p n adjacent seats at the lowest price level that has them.
+     *
+     * @details
+     * Price levels are tried from the cheapest, each as one AND of the free words with the
+     * level's mask followed by the vectorised run search, on a single load of the rows; in
+     * the first level with a run the best placed run wins. Seats of a more expensive level
+     * are only used when no cheaper combination fits. Without tiers this is
+     * book_best_available.
+     */
+    BookingResult book_cheapest_available(ShowId show_id, int n, SeatMask& out_seats);
+
+    /**
+     * @brief Books @p n seats for a group: one run in a row if any row has one, else two
+     *        runs stacked in consecutive rows.
+     *
+     * @param show_id The show identifier.
+     * @param n Group size, in [1..128].
+     * @param out_seats On success, the booked seats; cleared on entry.
+     * @return As book_best_available; NoContiguousSeats if neither one row nor two
+     *         consecutive rows can seat the group.
+     *
+     * @details
+     * A single row is searched exactly as by book_best_available. Otherwise the group is
+     * split into a front and a back part whose columns overlap (the shorter part lies
+     * within the columns of the longer one). Row pairs are tried in order of their
+     * HallLayout::row_cost sum, which bounds the cost of any split in them, and splits from
+     * the most even (uneven splits pay a penalty); the search stops as soon as that bound
+     * reaches the best plan found (branch and bound), so a typical call inspects a few row
+     * pairs. Each candidate is a handful of word operations: run starts of both parts
+     * (free words, category masks, aisle blocks and the single-seat rule as in the
+     * best-available search), smeared by the allowed offset to find aligned starts, and a
+     * bit scan for the most central one. The chosen seats are booked with the multi-word
+     * acquisition of book_seat_mask; if another request took one of them first, the search
+     * is repeated on fresh state (bounded by the backoff policy).
+     */
+    BookingResult book_group(ShowId show_id, int n, SeatMask& out_seats);
+
+    /**
+     * @brief Books seats in several shows together (double features, bundled tickets):
+     *        every part or none.
+     *
+     * @param items One part per show (masks as for @ref book_seat_mask).
+     * @param out_ids Receives the BookingId of each part, in item order; cancel a part with
+     *        its show's id. Must hold at least items.size() entries.
+     * @return Ok; or the failure of the part that could not be booked, with label_index set
+     *         to its item position (conflicts filled in on AlreadyBooked, as for
+     *         book_seat_mask); NoSeats for an empty bundle or too short @p out_ids.
+     *
+     * @details
+     * Every part is validated before any seat is touched. The parts are then acquired in
+     * ascending show id order, each with the usual CAS path (one CAS for a single-row part),
+     * and on the first failure the shows already taken are released again, so a conflict
+     * is always reported for the lowest show that has one. Nothing is locked: like a group
+     * booking across rows, a concurrent request may briefly see (and fail on) seats of a
+     * bundle that is rolling back. Owners are recorded once every part is held; parts are
+     * journaled per show, with one durability wait for the bundle.
+     */
+    BookingResult book_bundle(Span<const BundleItem> items, Span<BookingId> out_ids);
+
+    /**
+     * @brief Books a large multi-show plan (group sales, events): every part or none,
+     *        with the shows acquired in parallel.
+     *
+     * @param items Parts as for @ref book_bundle; several parts may name the same show as
+     *        long as their seats do not overlap (DuplicateSeatLabel otherwise).
+     * @param out_ids Receives the BookingId of each part, in item order.
+     * @param progress Optional; told when the plan is validated, as each show is acquired
+     *        or rolled back, and when the plan commits.
+     * @return As @ref book_bundle: Ok, or the failure of the first part (in show id order)
+     *         that could not be booked with label_index set to its item position.
+     *
+     * @details
+     * The whole plan is validated before any seat is touched, including a check of every
+     * part against the current seats, so a plan that already conflicts fails without
+     * writing. Parts are then merged per show and the shows are acquired on the work-stealing
+     * pool, one book_seat_mask-style acquisition each; after the first failure no further
+     * show is started, and the shows already taken are released in parallel. Once all are
+     * held the owners are recorded per part (in parallel over shows), with one durability
+     * wait for the plan. As with bundles nothing is locked, so a concurrent request may
+     * briefly see seats of a plan that is rolling back.
+     */
+    BookingResult book_bulk(Span<const BundleItem> items, Span<BookingId> out_ids,
+                            const BulkProgress& progress = nullptr);
+
+    /**
+     * @brief Moves the seat state of a show out of this service (cluster rebalancing).
+     *
+     * @param out Receives the show's bookings (with their ids) and active holds.
+     * @return Ok, or UnknownShow.
+     *
+     * @details
+     * Active holds are settled and every seat of the show is freed; with a journal the
+     * bookings are journaled as cancellations, so a replay here does not bring them back.
+     * Waitlisted requests are not moved. The caller must keep bookings of this show away
+     * while it moves (ClusterRouter does); other shows are not affected.
+     */
+    CatalogStatus take_show_state(ShowId show_id, ShowTransfer& out);
+
+    /**
+     * @brief Installs the seat state taken from another node with @ref take_show_state.
+     *
+     * @return Ok; UnknownShow; DuplicateId if a seat to install is not free here.
+     *
+     * @details
+     * Bookings keep their ids (later ids of this service start above them) and are
+     * journaled; holds are placed again with their remaining TTL under new hold ids.
+     */
+    CatalogStatus put_show_state(const ShowTransfer& in);
+
+    /** @brief Receives the booking of a waitlist entry (result, booked seats). */
+    using WaitlistCallback = std::function<void(const BookingResult&, const SeatMask&)>;
+
+    /**
+     * @brief @ref book_best_available that waits in line instead of failing when the show
+     *        is sold out.
+     *
+     * @param on_booked Called once with the booking when the entry is satisfied (required).
+     * @return As book_best_available if the seats were booked right away (@p on_booked is
+     *         not called); Waitlisted if the request was queued; NoContiguousSeats only if
+     *         no row of the hall is wide enough for @p n.
+     *
+     * @details
+     * Each show has a FIFO waitlist, a lock-free MPSC queue of entries. A request joins it
+     * when the show has no run of @p n free seats, or when others already wait (no cutting
+     * in line). Cancellations and hold releases or expiries that free seats of the show
+     * then book for the entries at the head, in order, until the head entry does not fit
+     * yet; clients are called back instead of retrying. One thread at a time drains a
+     * waitlist: a release that finds another drain running leaves it one more pass.
+     *
+     * @note @p on_booked runs on the thread that freed the seats (possibly inside this call,
+     *       before it returns): keep it short. It may call back into the service. Entries
+     *       not satisfied when the service is destroyed are dropped without a call.
+     */
+    BookingResult join_waitlist(ShowId show_id, int n, WaitlistCallback on_booked, SeatMask& out_seats);
+
+    /** @brief Entries waiting on the show's waitlist (0 for unknown shows). */
+    std::size_t waitlist_size(ShowId show_id) const;
+
+    /**
+     * @brief Limits the bookers of a hot show to @p policy (a rate <= 0 lifts the limit).
+     *
+     * @return Ok, or UnknownShow.
+     *
+     * @details
+     * Every booking call of the show (book_seats and its label/index/mask/best variants,
+     * batch requests, holds and waitlist joins) first passes the show's AdmissionGate: a
+     * booker that does not get a slot of the configured rate returns Throttled at once,
+     * before labels are parsed or a seat word is touched. Admitted bookers are spread
+     * evenly in arrival order, so the show's words see a contention the CAS loop can
+     * sustain; shows without a policy pay one table lookup.
+     */
+    CatalogStatus set_admission_policy(ShowId show_id, const AdmissionPolicy& policy);
+
+    /** @brief Time until the show's gate admits a booker again (zero if now or ungated). */
+    std::chrono::nanoseconds admission_retry_after(ShowId show_id) const;
+
+    /**
+     * @brief Caps the seats taken per day across all halls of @p theater_id (a licence
+     *        limit); a negative @p max_seats lifts the cap.
+     *
+     * @return Ok, or UnknownTheater.
+     *
+     * @details
+     * Each (theater, UTC day of the show start) pair has one CapacityCounter. A booking of
+     * a capped show reserves its seats on the counter right before the seat CAS and keeps
+     * them once the CAS succeeds; a failed CAS or a later release (cancel, expired hold)
+     * gives them back, and a booking that does not fit fails with TheaterCapReached.
+     * Services without caps pay one relaxed load per booking. The counter of a show
+     * starts from the seats the show has taken when the cap (or the show) is installed, so
+     * set the first cap of a theater before its shows go on sale for an exact count:
+     * bookings racing that call may be counted twice or not at all. Later calls only
+     * change the limit.
+     */
+    CatalogStatus set_theater_daily_cap(TheaterId theater_id, int max_seats);
+
+    /** @brief Attendance of @p theater_id on the UTC day containing @p at (zero if no cap was ever set). */
+    DailyAttendance theater_attendance(TheaterId theater_id, ShowTime at) const;
+
+    /**
+     * @brief Books many requests, possibly for many shows, in one pass.
+     *
+     * @param requests Requests in arrival order.
+     * @return One result per request, in the same order.
+     *
+     * @details
+     * Requests are grouped by show, so each show is looked up once and its words are
+     * loaded once. Within a show the requests are resolved in arrival order against the
+     * loaded state (first come, first served; each request stays all-or-nothing), and the
+     * accepted seats are then published with one CAS loop per touched word. If another
+     * thread changed the show in between, that show's requests fall back to individual
+     * bookings in the same order, so results stay deterministic for a given start state.
+     * Each show's group holds a ShowGate pass like a single booking, so its requests are
+     * answered Contended if the show moved halls (@ref move_show) since it was looked up.
+     * Large batches book their shows in parallel on @ref thread_pool.
+     */
+    std::vector<BookingResult> book_seats_batch(Span<const BookingRequest> requests);
+
+    /**
+     * @brief @ref book_seats_batch into a caller buffer.
+     *
+     * @param out_results Receives one result per request; must be at least as long as @p requests.
+     * @return Number of successful requests.
+     *
+     * @details
+     * The grouping temporaries live in the calling thread's RequestArena, so apart from
+     * journal and parallel fan-out bookkeeping a batch performs no heap allocation.
+     */
+    std::size_t book_seats_batch(Span<const BookingRequest> requests, Span<BookingResult> out_results);
+
+    /**
+     * @brief Cancels seats of a booking; they become available immediately.
+     *
+     * @param show_id The show identifier.
+     * @param seat_labels Seats to cancel (all or a subset of the booking's seats).
+     * @param booking_id BookingResult::id of the booking.
+     * @return Ok, the label errors of @ref book_seats, or NotOwner (with the offending seats
+     *         in BookingResult::conflicts) if a seat is not booked under @p booking_id.
+     *
+     * @details
+     * All-or-nothing and lock-free: every seat's owner entry is claimed with a CAS
+     * (booking_id -> 0, undone on the first mismatch), then the seat bits are cleared with
+     * one atomic AND per row. Owners are cleared before bits, so a seat re-booked right
+     * after it was freed never has its new owner erased.
+     */
+    BookingResult cancel_seats(ShowId show_id, const std::vector<std::string>& seat_labels, BookingId booking_id);
+
+    /** @brief @ref cancel_seats with caller-owned label views (no allocation). */
+    BookingResult cancel_seat_labels(ShowId show_id, Span<const std::string_view> seat_labels, BookingId booking_id);
+
+    /** @brief Mask-based variant of @ref cancel_seats. */
+    BookingResult cancel_seat_mask(ShowId show_id, const SeatMask& seats, BookingId booking_id);
+
+    /**
+     * @brief Returns the booking that owns a seat.
+     *
+     * @param show_id The show identifier.
+     * @param seat Seat index (see HallLayout::seat_index).
+     * @return The owner's BookingId, or 0 if the seat is free, held, or the show/seat is unknown.
+     */
+    BookingId seat_owner(ShowId show_id, int seat) const;
+
+    /**
+     * @brief Page kind backing the seat state of a show (see set_huge_pages).
+     *
+     * @return Off if the state is on normal heap pages or the show is unknown.
+     */
+    HugePages seat_state_pages(ShowId show_id) const;
+
+    /** @brief NUMA node index (see NumaTopology) the seat state of a show is bound to, or -1. */
+    int seat_state_node(ShowId show_id) const;
+
+    /**
+     * @brief Collects the seats owned by a booking (e.g. for auditing or a full refund).
+     *
+     * @param show_id The show identifier.
+     * @param booking_id The booking.
+     * @param out_seats Filled with the booking's seats; cleared on entry.
+     * @return Number of seats found, or -1 if the show does not exist.
+     *
+     * @details
+     * Scans only the booked bits of the show, so its cost is proportional to the number
+     * of booked seats. Relaxed snapshot: concurrent cancellations may or may not be seen.
+     */
+    int booking_seats(ShowId show_id, BookingId booking_id, SeatMask& out_seats) const;
+
+    /** @brief Maximum number of rows a single hold may span. */
+    static constexpr int kMaxHoldRows = 4;
+
+    /** @brief Number of hold slots allocated by the constructor. */
+    static constexpr std::size_t kDefaultHoldCapacity = 16384;
+
+    /**
+     * @brief Temporarily reserves seats (e.g. while payment runs), all-or-nothing.
+     *
+     * @param show_id The show identifier.
+     * @param seat_labels Seats to hold.
+     * @param ttl Time after which the hold expires unless confirmed (capped by a live
+     *        config's hold.max_ttl_ms, see @ref use_live_config).
+     * @return On success, BookingResult::id is the HoldId; otherwise the same failures as
+     *         @ref book_seats plus HoldCapacity / HoldTooLarge.
+     *
+     * @details
+     * Held seats are set in the booking words with the same CAS protocol as
+     * @ref book_seats, so a seat can never be held or booked twice. Creating a hold is
+     * lock-free: the slot comes from a lock-free free list and its expiry is handed to the
+     * reaper through a lock-free inbox. The show's hold mask (@ref held_seats_mask) marks
+     * which of the taken seats are held.
+     */
+    BookingResult hold_seats(ShowId show_id, const std::vector<std::string>& seat_labels,
+                             std::chrono::milliseconds ttl);
+
+    /** @brief Mask-based variant of @ref hold_seats. */
+    BookingResult hold_seat_mask(ShowId show_id, const SeatMask& seats, std::chrono::milliseconds ttl);
+
+    /** @brief @ref hold_seats through a handle (see @ref show_handle). */
+    BookingResult hold_seats(ShowHandle& show, const std::vector<std::string>& seat_labels,
+                             std::chrono::milliseconds ttl);
+
+    /**
+     * @brief Turns a hold into a permanent booking.
+     *
+     * @details
+     * The seats stay taken in the booking words: confirming settles the hold slot with one
+     * CAS, clears the show's hold mask bits (one atomic AND per row) and records the owner,
+     * so it costs no more than a booking.
+     *
+     * @return Ok with the new BookingId in BookingResult::id, UnknownHold (unknown/already settled) or HoldExpired (TTL elapsed; the
+     *         seats are released).
+     */
+    BookingResult confirm_hold(HoldId hold_id);
+
+    /** @brief @ref confirm_hold without waiting for a Sync journal (see the deferred @ref book_seats). */
+    BookingResult confirm_hold(HoldId hold_id, std::uint64_t* commit_lsn);
+
+    /**
+     * @brief Releases a hold; its seats become available immediately.
+     *
+     * @return Ok or UnknownHold.
+     */
+    BookingResult release_hold(HoldId hold_id);
+
+    /**
+     * @brief Leases a block of seats to a remote seller (a lobby kiosk or a partner site,
+     *        offline_kiosk.hpp), all-or-nothing.
+     *
+     * @param ttl Time after which @ref expire_leases returns the seats still leased
+     *        (0 = until given back).
+     * @return On success, BookingResult::id is the lease's BookingId; otherwise the same
+     *         failures as @ref book_seat_mask (except Throttled).
+     *
+     * @details
+     * The block is booked under the lease's id, journaled like any booking, so no other
+     * seller can take its seats while the remote one sells them without asking this
+     * service: its traffic never reaches the show's seat words. Sold seats come back
+     * through @ref settle_lease and unsold ones through @ref cancel_seat_mask with the
+     * lease's id. Leased seats are not counted as sales.
+     */
+    BookingResult lease_seat_mask(ShowId show_id, const SeatMask& block,
+                                  std::chrono::milliseconds ttl = std::chrono::milliseconds::zero());
+
+    /**
+     * @brief Extends a lease to @p ttl from now (0 = until given back).
+     *
+     * @return Ok; HoldExpired if its TTL already elapsed; UnknownHold if the lease owns no
+     *         seat of the show. Lease TTLs are not journaled: after a restart a lease is
+     *         kept until renewed, which arms its TTL again.
+     */
+    BookingResult renew_lease(ShowId show_id, BookingId lease_id, std::chrono::milliseconds ttl);
+
+    /**
+     * @brief Returns the seats still leased by every lease whose TTL elapsed by @p now.
+     * @return Seats returned.
+     *
+     * @details
+     * Called periodically by a housekeeping thread, like @ref expire_holds. The seats are
+     * cancelled under the lease's id (journaled); seats already settled stay booked.
+     * Leases are few (one per seller and show), so the pass scans them all.
+     */
+    std::size_t expire_leases(std::chrono::steady_clock::time_point now);
+
+    /** @brief @ref expire_leases at the current steady_clock time. */
+    std::size_t expire_leases() { return expire_leases(std::chrono::steady_clock::now()); }
+
+    /**
+     * @brief Turns seats a kiosk sold from lease @p lease_id into a booking of their own.
+     *
+     * @return Ok with the new BookingId in BookingResult::id; NotOwner (conflicts = the seats
+     *         the lease no longer owns, e.g. cancelled here meanwhile) or HoldExpired (the
+     *         lease's TTL elapsed) changes nothing.
+     *
+     * @details
+     * The seats stay taken: each owner entry moves from the lease to the new booking with
+     * one CAS, and the move is journaled as one Book record (replay overwrites the owners).
+     */
+    BookingResult settle_lease(ShowId show_id, const SeatMask& seats, BookingId lease_id);
+
+    /**
+     * @brief Seats of a show currently held (not yet confirmed or released).
+     *
+     * @param out_held Filled with the held seats; cleared on entry.
+     * @return Number of held seats, or -1 if the show does not exist.
+     *
+     * @details
+     * Each show keeps a hold mask parallel to its booking words: one word per row whose set
+     * bits are seats taken by an active hold. The booking words stay the union of booked
+     * and held seats, so a seat is free only when both are clear and every free-seat read
+     * still loads one word per row; a taken seat outside the hold mask is booked. Bits are
+     * set after a hold takes its seats and cleared before they are released or confirmed,
+     * so the mask never names a free seat.
+     */
+    int held_seats_mask(ShowId show_id, SeatMask& out_held) const;
+
+    /**
+     * @brief Every seat position of a show as a packed 2-bit state (seat_states.hpp).
+     *
+     * @param out Filled with SeatStateRows::kWordsPerRow words per row: seats 0..31 of the
+     *        row, then 32..63. Positions that are not seats of the layout are Blocked.
+     * @return Number of seats, or -1 if the show does not exist.
+     *
+     * @details
+     * Each row is read from its booking word and its hold mask word (@ref held_seats_mask),
+     * so a hold being placed or confirmed at that moment may read as booked for a row.
+     */
+    int seat_states(ShowId show_id, std::vector<std::uint64_t>& out) const;
+
+    /**
+     * @brief Expires all holds whose TTL elapsed by @p now.
+     *
+     * @return Number of holds that expired (released their seats).
+     *
+     * @details
+     * Drives a hierarchical timer wheel, so the cost is proportional to the number of
+     * expiring holds, not to the number outstanding. Intended to be called periodically by
+     * one housekeeping thread; a concurrent call returns 0 immediately instead of waiting.
+     */
+    std::size_t expire_holds(std::chrono::steady_clock::time_point now);
+
+    /** @brief @ref expire_holds at the current steady_clock time. */
+    std::size_t expire_holds() { return expire_holds(std::chrono::steady_clock::now()); }
+
+    /**
+     * @brief Re-sizes the hold table.
+     *
+     * @note Discards all outstanding hold bookkeeping; call before serving traffic.
+     */
+    void set_hold_capacity(std::size_t capacity);
+
+    /**
+     * @brief Sets the CAS retry/backoff policy used by all booking paths.
+     *
+     * @note Not synchronised with concurrent bookings; configure before serving traffic.
+     *       Overridden by a live config (@ref use_live_config), which can change it live.
+     */
+    void set_backoff_policy(const BackoffPolicy& policy) { backoff_ = policy; }
+
+    /** @brief Current CAS retry/backoff policy (the live config's, if one is in use). */
+    const BackoffPolicy& backoff_policy() const { return live_config_ ? live_config_->current().backoff : backoff_; }
+
+    /**
+     * @brief Takes the CAS backoff, the hold TTL cap and the admission gates from @p config,
+     *        following its reloads (live_config.hpp).
+     *
+     * @details
+     * Booking paths read the current snapshot with one load per request. Admission lines
+     * are applied on each publish (a show dropped from them gets its gate opened); shows
+     * the catalog does not know are skipped.
+     *
+     * @note Call before serving traffic; @p config must outlive the service (or a later
+     *       call with nullptr, which detaches it).
+     */
+    void use_live_config(LiveConfig* config);
+
+    /**
+     * @brief Books multi-row requests with one hardware transaction where the CPU has RTM
+     *        (see htm.hpp); false (nothing changes) if it does not.
+     *
+     * @details
+     * A multi-row booking first tries up to kHtmAttempts transactions that check and set
+     * every row at once, then falls back to the lock-free per-row protocol, which also
+     * reports the conflicting seats when a seat turns out to be taken. Layouts with
+     * seating rules and shows of capped theaters always take the software path.
+     *
+     * @note Not synchronised with concurrent bookings; configure before serving traffic.
+     */
+    bool enable_hardware_transactions(bool on = true) {
+        htm_ = on && htm::supported();
+        return htm_;
+    }
+
+    /** @brief Transactions tried per multi-row booking before the software fallback. */
+    static constexpr int kHtmAttempts = 3;
+
+    /** @brief Counters of the hardware transaction path (all zero while it is off). */
+    struct HtmStats {
+        std::uint64_t commits = 0;   /**< Bookings committed by a transaction. */
+        std::uint64_t aborts = 0;    /**< Aborted transactions (each is retried or falls back). */
+        std::uint64_t fallbacks = 0; /**< Bookings that ran the software protocol after trying transactions. */
+    };
+
+    /** @brief Transaction path counters since construction. */
+    HtmStats htm_stats() const {
+        return HtmStats{htm_commits_.load(std::memory_order_relaxed), htm_aborts_.load(std::memory_order_relaxed),
+                        htm_fallbacks_.load(std::memory_order_relaxed)};
+    }
+
+    /**
+     * @brief Selects who applies bookings, cancellations and holds (see show_executor.hpp).
+     *
+     * @param mode Shared (default): the calling thread; OwnerThreads: the show's owner thread,
+     *        fed through SPSC rings, so a hot show is only ever written by one core.
+     * @param workers OwnerThreads: number of owner threads (0 = hardware concurrency).
+     *        They are pinned and assigned shows per the current set_numa_placement.
+     *
+     * @details
+     * Requests are validated (labels parsed, layout checked) on the calling thread either
+     * way; reads, batches, hold confirmation/release and expiry stay on the calling thread.
+     *
+     * @note Not synchronised with concurrent calls; switch while no request is in flight.
+     */
+    void set_execution_mode(ExecutionMode mode, unsigned workers = 0);
+
+    /** @brief Current execution mode. */
+    ExecutionMode execution_mode() const {
+        return executor_ ? ExecutionMode::OwnerThreads : ExecutionMode::Shared;
+    }
+
+    /**
+     * @brief Deadline of the calling thread's bookings, cancellations and holds while in scope.
+     *
+     * @details
+     * A request that reaches the seats after the deadline fails with DeadlineExceeded
+     * without touching them. With owner threads the check is made again when the owner
+     * dequeues it, so a request that waited past its deadline is dropped unrun. Owner
+     * threads serve hold requests after bookings and cancellations (RequestLane). Scopes
+     * nest; the innermost one applies.
+     */
+    class DeadlineScope {
+    public:
+        explicit DeadlineScope(std::chrono::steady_clock::time_point deadline) : previous_(request_deadline_) {
+            request_deadline_ = deadline;
+        }
+        ~DeadlineScope() { request_deadline_ = previous_; }
+
+        DeadlineScope(const DeadlineScope&) = delete;
+        DeadlineScope& operator=(const DeadlineScope&) = delete;
+
+    private:
+        std::chrono::steady_clock::time_point previous_;
+    };
+
+    /** @brief Requests dropped by owner threads because their deadline passed while queued. */
+    std::uint64_t expired_requests() const { return executor_ ? executor_->expired_count() : 0u; }
+
+    /**
+     * @brief Runs @p fn on the owner thread of @p show_id in OwnerThreads mode, inline otherwise.
+     *
+     * @details
+     * For callers serving several requests of one show in a row (a server session): they
+     * reach the owner in one hand-off instead of one per booking, and what @p fn touches
+     * stays in the owner core's cache. Service calls made by @p fn run inline on the owner,
+     * including those for other shows, which stays correct because owners apply requests
+     * with the same atomic operations as the Shared mode. The result type must be
+     * default-constructible.
+     */
+    template <typename F>
+    auto run_on_owner(ShowId show_id, F&& fn) -> decltype(fn()) {
+        if (executor_) return executor_->run(show_id.value(), RequestLane::Book, fn);
+        return fn();
+    }
+
+    /**
+     * @brief Selects the pool that parses schedule files and books large batches (see thread_pool.hpp).
+     *
+     * @param pool Kept by pointer and must outlive the service; null = ThreadPool::shared().
+     *
+     * @note Not synchronised with concurrent calls; set before serving traffic.
+     */
+    void set_thread_pool(ThreadPool* pool) { thread_pool_ = pool; }
+
+    /** @brief Pool used for bulk work. */
+    ThreadPool& thread_pool() const { return thread_pool_ ? *thread_pool_ : ThreadPool::shared(); }
+
+    /**
+     * @brief Reads the contention counters of a show.
+     *
+     * @param show_id The show identifier.
+     * @param out Filled with the counters (relaxed reads; values may be slightly stale).
+     * @return False if the show does not exist.
+     */
+    bool contention_stats(ShowId show_id, ContentionStats& out) const;
+
+    /**
+     * @brief Enables adaptive execution of contended shows in Shared mode.
+     *
+     * @details
+     * Failed CAS attempts (already counted for @ref contention_stats) drive the detection,
+     * so uncontended bookings pay nothing. A promoted ("hot") show has its bookings,
+     * cancellations and holds serialised, so its words stop bouncing between cores and
+     * its CAS operations stop failing: with HotShowStrategy::OwnerThreads they are queued
+     * to a small set of owner threads, as in OwnerThreads mode; with Combining the callers
+     * publish them and one of them applies all published requests in arrival order (see
+     * flat_combiner.hpp). Other shows keep running on the calling threads. Has no effect
+     * in OwnerThreads mode, where every show already has an owner.
+     *
+     * @note Not synchronised with concurrent calls; set while no request is in flight.
+     */
+    void set_hot_show_policy(const HotShowPolicy& policy) { hot_policy_ = policy; }
+
+    /** @brief Current hot-show policy. */
+    const HotShowPolicy& hot_show_policy() const { return hot_policy_; }
+
+    /**
+     * @brief Promotes (or demotes) a show by hand, e.g. a premiere before its sale opens.
+     *
+     * @details
+     * A hand-promoted show is still demoted automatically under an enabled policy once
+     * its load drops. Thread-safe.
+     *
+     * @return False if the show does not exist.
+     */
+    bool set_show_hot(ShowId show_id, bool hot);
+
+    /** @brief True if the show's requests are currently serialised as a hot show. */
+    bool show_is_hot(ShowId show_id) const;
+
+    /**
+     * @brief Prepares a show known to sell out (a premiere) before its sale opens, or
+     *        clears the mark with @p expected = false.
+     *
+     * @details
+     * Everything the first requests of a ticket drop would otherwise pay for is done now:
+     * the show is promoted as by @ref set_show_hot (starting the hot-show owner threads or
+     * its combiner) and stays hot while its load is still low, until the mark is cleared;
+     * its owner rows are allocated; one warm-up request on its owner thread loads its seat
+     * words and owner rows into that core's cache; and its availability payload is
+     * rendered for @ref append_cached_available_seats. A show sharing its promotion slot
+     * with a show that is hot already is prepared but not promoted (see @ref show_is_hot).
+     * Thread-safe.
+     *
+     * @return False if the show does not exist.
+     */
+    bool expect_hot(ShowId show_id, bool expected = true);
+
+    /** @brief True if @ref expect_hot marked the show and the mark holds it hot. */
+    bool show_expected_hot(ShowId show_id) const;
+
+    /** @brief Promotion and demotion counters. Thread-safe. */
+    HotShowStats hot_show_stats() const;
+
+    /**
+     * @brief Occupancy and contention counters of one show.
+     *
+     * @details
+     * Read in bulk from the show's state: the popcount of its seat words and its relaxed
+     * counters, no per-seat work or strings. Thread-safe; a concurrent booking may be seen
+     * in the words but not yet in the counters.
+     *
+     * @return False if the show does not exist.
+     */
+    bool show_stats(ShowId show_id, ShowStats& out) const;
+
+    /**
+     * @brief Bulk @ref show_stats.
+     *
+     * @param out Receives one entry per show (show_id invalid for unknown shows); must be
+     *        at least as long as @p show_ids.
+     * @return Number of known shows.
+     *
+     * @details
+     * Lists of 4096 shows or more are split into chunks read in parallel on @ref thread_pool,
+     * as in @ref available_counts.
+     */
+    std::size_t show_stats(Span<const ShowId> show_ids, Span<ShowStats> out) const;
+
+    /**
+     * @brief The @p k shows with the most booking attempts, most requested first.
+     *
+     * @details
+     * Every booking attempt (seat, best-available, hold, group and bundle bookings) adds
+     * its show to a per-thread Space-Saving sketch (heavy_hitters.hpp) while metrics are
+     * on (@ref set_metrics_enabled): a hashed lookup among 8 thread-private counters.
+     * Counts are estimates since the service started; @ref HotShow::error bounds their
+     * overcount.
+     */
+    std::vector<HotShow> hot_shows(std::size_t k) const;
+
+    /**
+     * @brief Occupancy and contention totals of every catalog show, plus the
+     *        @p top_k @ref hot_shows.
+     *
+     * @details
+     * Shows are read as in @ref show_stats, in parallel chunks on @ref thread_pool for
+     * large catalogs. On a lazily restored service this decodes every show.
+     */
+    ServiceStats service_stats(std::size_t top_k = 10) const;
+
+    /**
+     * @brief Turns API instrumentation on or off (on by default).
+     *
+     * @details
+     * When on, every public booking, hold, cancellation and availability call records its
+     * latency and outcome in a per-thread shard (see service_metrics.hpp): two clock reads
+     * and a few uncontended relaxed stores, no lock.
+     */
+    void set_metrics_enabled(bool on) { metrics_.set_enabled(on); }
+
+    /**
+     * @brief Aggregates the API metrics of all threads.
+     *
+     * @param out Per MetricsApi: latency histogram (ns) and result counts indexed by
+     *        BookingStatus.
+     */
+    void collect_metrics(std::array<ServiceMetrics::ApiTotals, kMetricsApis>& out) const { metrics_.collect(out); }
+
+    /**
+     * @brief Tracks latency SLOs of the API metrics: samples them every @p policy.interval
+     *        on a background thread and calls @p policy.on_alert when a budget's error
+     *        budget burns fast; a policy without budgets stops it.
+     *
+     * @details
+     * Compliance and burn rates come from the same per-thread histograms as
+     * @ref collect_metrics (see slo_monitor.hpp), so tracking adds nothing to the request
+     * path; it needs metrics on. The windows start with this call. The hook runs on the
+     * sampling thread and may call @ref slo_status but not set_slos.
+     */
+    void set_slos(SloPolicy policy);
+
+    /** @brief Takes one SLO sample at @p now (the background thread's step); false when SLOs are off. */
+    bool evaluate_slos(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    /** @brief Status of every SLO budget as of the last sample (empty when SLOs are off). */
+    std::vector<SloStatus> slo_status() const;
+
+    /**
+     * @brief Renders the API metrics and the summed contention counters of all catalog
+     *        shows in the Prometheus text exposition format.
+     *
+     * @details
+     * booking_requests_total{api,status} (counter), booking_request_duration_seconds{api}
+     * (summary with p50/p90/p99/p999), booking_cas_retries_total, booking_contended_total,
+     * booking_conflicts_total, booking_shows, booking_seats, booking_seats_booked,
+     * booking_hot_show_requests{show} of the 10 most requested shows (see @ref service_stats)
+     * and, with SLOs set, booking_slo_compliance{api} and booking_slo_burn_rate{api,window}.
+     */
+    std::string metrics_prometheus() const;
+
+    /**
+     * @brief Parses a seat label of the default layout (e.g. "a1") into a zero-based index [0..19].
+     *
+     * @param label Input seat label (expected "a1".."a20", case-insensitive for 'a').
+     * @param out_index0 Output seat index in [0..19] on success.
+     * @return True if label is valid; false otherwise.
+     *
+     * @details
+     * Parsed by the default layout (HallLayout::try_parse_label with its grammar's
+     * specialised parser): no allocation, no exceptions, and the whole label must match.
+     */
+    static bool try_parse_seat_label(std::string_view label, int& out_index0);
+
+    /**
+     * @brief Converts a seat index [0..19] into a label ("a1".."a20").
+     *
+     * @param index0 Zero-based seat index [0..19].
+     * @return Seat label string (copied from a prerendered single-row label table).
+     */
+    static std::string seat_label_from_index0(int index0);
+
+private:
+    /**
+     * @brief Number of seats in the default (single row) layout.
+     */
+    static constexpr int kSeatCount = 20;
+
+    /**
+     * @brief Owners of one row's seats (0 = free or held).
+     *
+     * @details
+     * Cache-line aligned: a row is exactly four lines, so rows never share a line and
+     * owner writes of one row never invalidate a neighbouring row's entries.
+     */
+    struct alignas(64) OwnerRow {
+        std::array<std::atomic<BookingId>, HallLayout::kMaxRowSeats> seats; /**< Indexed by column. */
+    };
+
+    /**
+     * @brief Rendered free-seat labels of a show (@ref append_cached_available_seats).
+     *
+     * @details
+     * Immutable once published in ShowState::rendered; valid for as long as the show
+     * still has the same layout and free words.
+     */
+    struct RenderedSeats {
+        const HallLayout* layout = nullptr;     /**< Layout the labels were rendered for. */
+        std::vector<std::uint64_t> free_words;  /**< Free bits the labels were rendered from. */
+        std::string text;                       /**< Space-separated labels. */
+        int free_count = 0;                     /**< Number of labels in @ref text. */
+
+        /** @brief True if rendered for @p l from the @p count words of @p words. */
+        bool matches(const HallLayout* l, const std::uint64_t* words, int count) const {
+            return layout == l && free_words.size() == static_cast<std::size_t>(count)
+                   && std::equal(free_words.begin(), free_words.end(), words);
+        }
+    };
+
+    /**
+     * @brief Internal per-show seat booking state (one atomic word per row).
+     *
+     * @details
+     * Stored in place in a ShowTable, one pair of cache lines per show:
+     * - line 0 is what every booking reads: layout, words and owners pointers, and the
+     *   words themselves for halls of up to kInlineWords rows (the sample halls), so a
+     *   booking of a small hall touches a single line and no separate allocation;
+     * - line 1 holds the contention counters, so their increments never invalidate line 0
+     *   of the show or a line of a neighbouring show.
+     */
+    struct alignas(64) ShowState {
+        /** @brief Rows whose words are stored inline in the first cache line. */
+        static constexpr int kInlineWords = 4;
+
+        const HallLayout* layout = nullptr;            /**< Seat map of the show (nullptr = unused). */
+        /** @brief Bit c of word r = seat (r, c); inline, heap, or @ref cold_words until the first booking. */
+        std::atomic<std::atomic<std::uint64_t>*> word_array{nullptr};
+        std::atomic<OwnerRow*> owners{nullptr};        /**< One OwnerRow per row; allocated on first booking. */
+        std::int16_t word_count = 0;                   /**< Number of booking words (rows). */
+        /** @brief SalesState of the show, read by every booking CAS loop (@ref set_sales_state). */
+        std::atomic<std::uint8_t> sales{0};
+        bool row_summary = false;                      /**< inline_words[0] holds the free-row summary. */
+        std::uint32_t position = 0;                    /**< ShowTable position of the show (see @ref id_of). */
+        /** @brief Words of halls with few rows; with heap words, the first is the free-row summary. */
+        mutable std::atomic<std::uint64_t> inline_words[kInlineWords]{};
+
+        // Contention counters, updated with relaxed increments off the uncontended path
+        alignas(64) std::atomic<std::uint64_t> cas_retries{0}; /**< Failed CAS attempts that were retried. */
+        std::atomic<std::uint64_t> contended{0};   /**< Requests that exhausted the retry budget. */
+        std::atomic<std::uint64_t> conflicts{0};   /**< Requests rejected as already booked. */
+        std::unique_ptr<std::atomic<std::uint64_t>[]> heap_words; /**< Words of larger halls. */
+        /** @brief Last rendered availability (read path cache; replaced under @ref render_epochs_). */
+        mutable std::atomic<const RenderedSeats*> rendered{nullptr};
+        /** @brief Change counter and group-write seqlock: @ref own_version or in the shared region. */
+        std::atomic<std::uint64_t>* version = nullptr;
+        std::atomic<std::uint64_t> own_version[2]{}; /**< Counters of a show that is not shared. */
+
+        ShowState() = default;
+        ~ShowState() {
+            if (!shared()) delete[] owners.load(std::memory_order_relaxed);
+            delete rendered.load(std::memory_order_relaxed);
+        }
+        ShowState(const ShowState&) = delete;
+        ShowState& operator=(const ShowState&) = delete;
+
+        /** @brief Binds the show at table position @p pos to @p l with all seats available (all words 0, no owners). */
+        void init(int pos, const HallLayout& l);
+
+        /** @brief Binds the show at table position @p pos to @p l using the words and owners of a shared region block as they are. */
+        void init_shared(int pos, const HallLayout& l, const SharedSeatRegion::Block& block);
+
+        /** @brief True if words and owners live in @ref shared_seats_. */
+        bool shared() const { return version != own_version; }
+
+        /**
+         * @brief All-zero words shared by every cold show (never holds a set bit).
+         *
+         * @details
+         * A show of more than kInlineWords rows starts with its words pointing here, so a
+         * schedule of far-future shows nobody has booked costs no word arrays; reads see
+         * every seat free. Writers that set bits go through @ref ensure_words, which
+         * installs the show's own zeroed words first. Clearing bits (a release) and
+         * storing zeros leave this block as it is, so they need no promotion.
+         */
+        static std::atomic<std::uint64_t> cold_words[HallLayout::kMaxRows];
+
+        /** @brief True while the show's words are @ref cold_words (not booked since init). */
+        bool cold() const { return words() == cold_words; }
+
+        /**
+         * @brief The show's words (@ref word_array); acquire, so the words @ref ensure_words
+         *        or a hall move installed are seen initialised.
+         */
+        std::atomic<std::uint64_t>* words() const { return word_array.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Free-row summary (bit r = row r has a free seat), or nullptr.
+         *
+         * @details
+         * Kept for halls whose words are on the heap (more than kInlineWords rows), in the
+         * inline word they leave unused, so it shares the first cache line with the word
+         * pointer every booking loads. Smaller halls scan their few words instead, and shows
+         * on shared seats have none (other processes write their words).
+         */
+        std::atomic<std::uint64_t>* free_rows() const { return row_summary ? &inline_words[0] : nullptr; }
+
+        /** @brief Successful word updates so far (@ref availability_if_changed). */
+        std::atomic<std::uint64_t>& changes() const { return version[0]; }
+
+        /**
+         * @brief Seqlock of the updates spanning several words (@ref GroupWrite):
+         *        active writers in the low kGroupWriters bits, completed ones above.
+         */
+        std::atomic<std::uint64_t>& group_writes() const { return version[1]; }
+    };
+
+    /**
+     * @brief Owner table of a show, allocating it on first use.
+     *
+     * @details
+     * Shows that are never booked (most of a large schedule) cost no owner memory; the
+     * first booking installs the zeroed table with a CAS.
+     */
+    static OwnerRow* ensure_owners(ShowState& st);
+
+    /**
+     * @brief Words of a show, installing its own zeroed words if it is still cold.
+     *
+     * @details
+     * Called by every path that sets seat bits. Concurrent first bookings race one CAS
+     * of the words pointer; the losers free their copy and use the winner's, so no bit
+     * set after the install can land in @ref ShowState::cold_words.
+     */
+    static std::atomic<std::uint64_t>* ensure_words(ShowState& st);
+
+    /** @brief Owner entry of a seat index in @p rows. */
+    static std::atomic<BookingId>& owner_of(OwnerRow* rows, int seat) {
+        return rows[HallLayout::row_of(seat)].seats[static_cast<std::size_t>(HallLayout::col_of(seat))];
+    }
+
+    /**
+     * @brief Immutable catalog snapshot (movies, theaters, shows and their lookup indexes).
+     *
+     * @details
+     * Never modified once published: writers copy the current snapshot, update the copy
+     * and swap the pointer, so readers need no lock.
+     */
+    /** @brief (movie, theater) key of the show indexes. */
+    struct ShowPair {
+        MovieId movie;
+        TheaterId theater;
+
+        bool operator==(const ShowPair& o) const { return movie == o.movie && theater == o.theater; }
+    };
+
+    struct ShowPairHash {
+        std::size_t operator()(const ShowPair& p) const {
+            const auto m = static_cast<std::uint64_t>(p.movie.value());
+            const auto t = static_cast<std::uint64_t>(p.theater.value());
+            return std::hash<std::uint64_t>{}(m * 0x9E3779B97F4A7C15u ^ t);
+        }
+    };
+
+    struct Catalog {
+        std::vector<Movie> movies;     /**< Stored movies (titles point into @ref strings_); append-only. */
+        std::vector<Theater> theaters; /**< Stored theaters; append-only. */
+        ShowColumns shows;             /**< Stored shows (movie x theater), column-wise. */
+
+        /** @brief Movie id -> slot (index in @ref movies; slots never change). */
+        std::unordered_map<MovieId, std::int32_t> movie_slots;
+
+        /** @brief Theater id -> slot (index in @ref theaters). */
+        std::unordered_map<TheaterId, std::int32_t> theater_slots;
+
+        /**
+         * @brief (movie, theater) -> shows index used by @ref find_show / @ref find_shows.
+         *
+         * @details
+         * Key: @ref show_key of the pair
+         * Value: show ids in insertion order (never empty)
+         */
+        std::unordered_map<ShowPair, std::vector<ShowId>, ShowPairHash> show_index;
+
+        /**
+         * @brief (movie, theater) -> shows sorted by start time, used by
+         *        @ref find_shows_between.
+         *
+         * @details
+         * Same keys as @ref show_index; values are ordered by (start_time, id) so a time
+         * range is found with two binary searches.
+         */
+        std::unordered_map<ShowPair, std::vector<Show>, ShowPairHash> shows_by_time;
+
+        /**
+         * @brief Inverted movie -> theaters index used by @ref list_theaters_for_movie.
+         *
+         * @details
+         * Value: theaters that have at least one show of the movie, sorted by theater id.
+         * Updated when the first show of a (movie, theater) pair is added or the last one
+         * is removed.
+         */
+        std::unordered_map<MovieId, std::vector<Theater>> theaters_by_movie;
+
+        /**
+         * @brief Location grid: geo_cell_key -> ids of the located theaters in the cell.
+         *
+         * @details
+         * Used by the radius overload of @ref list_theaters_for_movie. Theaters without
+         * coordinates are not indexed.
+         */
+        std::unordered_map<std::uint32_t, std::vector<TheaterId>> theater_grid;
+
+        /**
+         * @brief Title search index over @ref movies (slot = movie slot), used by @ref search_movies.
+         *
+         * @details
+         * Shared between snapshots: only updates that add movies copy it, so show and
+         * theater updates do not pay for the index.
+         */
+        std::shared_ptr<const TitleIndex> titles = std::make_shared<const TitleIndex>();
+    };
+
+    /**
+     * @brief Interned catalog strings referenced by every snapshot.
+     *
+     * @details
+     * Declared before the snapshot pointer so it outlives the reclamation of the last
+     * snapshot; only catalog writers (under @ref catalog_mutex_) intern.
+     */
+    StringArena strings_;
+
+    std::atomic<const Catalog*> catalog_{nullptr}; /**< Published snapshot (never null after construction). */
+    mutable std::mutex catalog_mutex_;             /**< Serialises catalog writers (and snapshot writers). */
+    mutable EpochManager catalog_epochs_;          /**< Reclaims snapshots replaced by writers. */
+
+    /**
+     * @brief Shows by (theater, start time), updated in place by catalog writers rather than
+     *        copied with every snapshot; readers guard it with @ref catalog_epochs_.
+     */
+    ShowTimeIndex<Show> theater_times_{catalog_epochs_};
+
+    /**
+     * @brief Copy-on-write catalog update: applies @p update to a copy of the current
+     *        snapshot and publishes it if @p update returns Ok.
+     *
+     * @note The caller holds @ref catalog_mutex_.
+     */
+    template <typename Update>
+    CatalogStatus update_catalog(Update&& update);
+
+    /** @brief Removes show @p show_id from @ref theater_times_ and every index of @p c but its show columns. */
+    void unindex_show(Catalog& c, ShowId show_id, MovieId movie_id, TheaterId theater_id);
+
+    /**
+     * @brief Removes the shows at @p rows (ascending catalog rows) from the catalog in one update and
+     *        their state from @ref show_state_. The caller holds @ref catalog_mutex_.
+     */
+    void remove_shows_locked(const std::vector<std::uint32_t>& rows);
+
+    /** @brief Points the catalog row of @p show_id at @p layout_id and @p hall. The caller holds @ref catalog_mutex_. */
+    void relocate_show_locked(ShowId show_id, LayoutId layout_id, int hall);
+
+    /**
+     * @brief Translates the seats, owners and active holds of frozen show @p st to @p to
+     *        through @p table (@ref move_show); nothing changes unless it returns Ok.
+     *        The caller holds @ref catalog_mutex_.
+     */
+    MoveStatus remap_frozen(ShowState& st, const HallLayout& to, Span<const int> table);
+
+    /** @brief Fills the booking state of the i-th show of a schedule being loaded. */
+    using ShowRestore = std::function<void(std::size_t, ShowState&)>;
+
+    /**
+     * @brief @ref load_schedule and @ref apply_schedule_batch body; @p restore (if set) runs on
+     *        each new show's state before the catalog that publishes it.
+     *
+     * @note The caller holds @ref catalog_mutex_.
+     */
+    ScheduleError load_schedule_locked(Schedule& schedule, const ShowRestore& restore,
+                                       Span<const ShowId> removals = {});
+
+    /**
+     * @brief Seat layouts referenced by Show::layout_id, each distinct layout stored once.
+     *
+     * @details
+     * Layouts never move, so ShowState::layout stays valid when the registry grows. Only
+     * used by catalog writers (under @ref catalog_mutex_); shows reach their layout through
+     * ShowState::layout.
+     */
+    LayoutRegistry layouts_;
+
+    /** @brief Shared seat region of @ref attach_shared_seats (outlives the states pointing into it). */
+    std::unique_ptr<SharedSeatRegion> shared_seats_;
+
+    /** @brief True if @ref shared_seats_ is a DAX file: bookings write their seats back (@ref persist_seats). */
+    bool persistent_seats_ = false;
+
+    /** @brief Writes back the words and owner entries of @p seats and fences (DAX seat files only). */
+    void persist_seats(const ShowState& st, const SeatMask& seats) const;
+
+    /**
+     * @brief Block of @p show_id in the shared region, or nulls if there is no room.
+     *
+     * @note The caller holds @ref catalog_mutex_ and has checked that a region is attached.
+     */
+    SharedSeatRegion::Block claim_shared(ShowId show_id, const HallLayout& layout);
+
+    /**
+     * @brief Per-show booking state, indexed directly by show id.
+     *
+     * @details
+     * A flat chunked array instead of a hash map of pointers: O(1) indexing with no
+     * hashing, states of neighbouring shows packed contiguously, and stable addresses
+     * (hold slots keep ShowState pointers). Lookups are lock-free and may run while a
+     * catalog writer adds a show.
+     */
+    ShowTable<ShowState> show_state_{true}; // huge-page slabs when set_huge_pages allows
+
+    /** @brief Freezes the show being moved (@ref move_show); every show-writing request holds a pass. */
+    ShowGate show_gate_;
+
+    /** @brief Completed @ref move_show calls; while 0, requests skip the stale-layout check. */
+    std::atomic<std::uint64_t> show_moves_{0};
+
+    /** @brief Words and owners replaced by @ref move_show (kept for earlier readers; under @ref catalog_mutex_). */
+    std::vector<std::unique_ptr<std::atomic<std::uint64_t>[]>> moved_words_;
+    std::vector<std::unique_ptr<OwnerRow[]>> moved_owners_;
+
+    /** @brief Last show the calling thread looked up, with the layout it had then. */
+    struct Lookup {
+        ShowId show;
+        const HallLayout* layout;
+    };
+    static inline thread_local Lookup last_lookup_{};
+
+    /**
+     * @brief Waits while @p show_id is frozen, records the lookup of @p st for
+     *        @ref moved_since_lookup and tags the thread with the show for profilers.
+     */
+    void note_lookup(ShowId show_id, const ShowState* st) const {
+        if (show_gate_.frozen(show_id.value())) show_gate_.wait_thawed(show_id.value());
+        last_lookup_ = Lookup{show_id, st ? st->layout : nullptr};
+        profile_tag_show(show_id);
+    }
+
+    /** @brief True if @p show_id, last looked up by this thread, has moved halls since. */
+    bool moved_since_lookup(ShowId show_id) const {
+        if (show_moves_.load(std::memory_order_acquire) == 0u || last_lookup_.show != show_id) return false;
+        const ShowState* st = show_state_.find(show_id);
+        return st && st->layout != last_lookup_.layout;
+    }
+
+    /** @brief Renderings a thread retires before handing them over (one per changed show read). */
+    static constexpr std::size_t kRenderRetireBatch = 64;
+
+    /** @brief Reclaims ShowState::rendered payloads replaced by a newer rendering. */
+    mutable EpochManager render_epochs_{kRenderRetireBatch};
+
+    /**
+     * @brief Reader-side copy of a show's free words (see @ref set_read_mirror).
+     *
+     * @details
+     * Written only by @ref refresh_read_mirrors under a seqlock; its line is never
+     * touched by the booking path.
+     */
+    struct alignas(64) SeatMirror {
+        static constexpr int kInlineWords = 5;
+
+        std::atomic<std::uint64_t> seq{0};  /**< Odd while being rewritten; 0 = never written. */
+        std::atomic<int> word_count{0};     /**< Words mirrored (compared with the show's before use). */
+        std::atomic<std::uint64_t> inline_words[kInlineWords]{}; /**< Free words of small halls. */
+        std::atomic<std::atomic<std::uint64_t>*> heap_words{nullptr}; /**< kMaxRows free words of larger halls; owned. */
+
+        SeatMirror() = default;
+        ~SeatMirror() { delete[] heap_words.load(std::memory_order_relaxed); }
+        SeatMirror(const SeatMirror&) = delete;
+        SeatMirror& operator=(const SeatMirror&) = delete;
+
+        /** @brief Copies the @p count mirrored words to @p out; false if the mirror cannot serve them. */
+        bool load(int count, std::uint64_t* out) const;
+    };
+    static_assert(sizeof(SeatMirror) == 64, "SeatMirror: expected one cache line");
+
+    ShowTable<SeatMirror> mirrors_{true};
+    std::atomic<bool> mirror_reads_{false};          /**< Readers use @ref mirrors_. */
+    std::chrono::microseconds mirror_refresh_{0};
+    std::mutex mirror_mutex_;                        /**< Serialises refreshes (and mirror creation). */
+    std::mutex mirror_thread_mutex_;                 /**< Guards @ref mirror_stop_. */
+    std::condition_variable mirror_cv_;
+    bool mirror_stop_ = false;
+    std::thread mirror_thread_;                      /**< Refresher (joined by set_read_mirror(0)). */
+
+    /** @brief Free words of @p st for a reader: from its mirror when enabled and usable, else live. */
+    void load_read_words(const ShowState& st, std::uint64_t* out) const;
+
+    /** @brief Key of a (movie, theater) pair in the show indexes. */
+    static ShowPair show_key(MovieId movie_id, TheaterId theater_id) { return ShowPair{movie_id, theater_id}; }
 
     /**
      * @brief Returns mutable ShowState for a show id (or nullptr if not found).
@@ -244,12 +3166,659 @@ private:
      */
     const ShowState* get_state(ShowId show_id) const;
 
+    /** @brief Id of the show whose state is @p st (from its table position). */
+    ShowId id_of(const ShowState& st) const { return show_state_.id_at(static_cast<int>(st.position)); }
+
+    /** @brief Bumped before show states are erased: handles taken earlier look their id up again. */
+    std::atomic<std::uint64_t> state_epoch_{0};
+
+    /** @brief State of @p show, refreshing a stale handle (nullptr if the show is gone). */
+    ShowState* resolve(ShowHandle& show) const;
+
+    /** @brief @ref book_seats on a looked-up state (nullptr = InvalidShow). */
+    BookingResult book_labels_on(ShowState* st, ShowId show_id, const std::vector<std::string>& seat_labels,
+                                 std::uint64_t* commit_lsn);
+
+    /** @brief @ref book_seat_labels on a looked-up state (nullptr = InvalidShow). */
+    BookingResult book_views_on(ShowState* st, ShowId show_id, Span<const std::string_view> seat_labels);
+
+    /** @brief @ref book_label_list on a looked-up state (nullptr = InvalidShow). */
+    BookingResult book_list_on(ShowState* st, ShowId show_id, std::string_view seat_labels);
+
+    /** @brief @ref list_available_seats on a looked-up state (nullptr = no seats). */
+    std::vector<std::string> list_labels_on(const ShowState* st) const;
+
+    /** @brief @ref append_cached_available_seats on a looked-up state (nullptr = -1). */
+    int append_cached_on(const ShowState* st, std::string& out) const;
+
+    /** @brief Bytes a rendering is charged to MemorySubsystem::Caches. */
+    static std::size_t rendered_bytes(const RenderedSeats& r) {
+        return sizeof(RenderedSeats) + r.text.capacity() + r.free_words.capacity() * sizeof(std::uint64_t);
+    }
+
+    /** @brief Releases a rendering unpublished from a show: uncharged now, freed once no reader holds it. */
+    void retire_rendered(const RenderedSeats* r) const {
+        memory_.release(MemorySubsystem::Caches, rendered_bytes(*r));
+        render_epochs_.retire(r);
+    }
+
+    /** @brief Estimated bytes of a catalog snapshot's arrays and maps. */
+    static std::size_t catalog_bytes(const Catalog& c);
+
+    /** @brief Live bytes and budgets (see @ref memory_usage); caches are charged from const read paths. */
+    mutable MemoryAccounts memory_;
+
+    /** @brief @ref hold_seat_mask on a looked-up state (nullptr = InvalidShow). */
+    BookingResult hold_mask_on(ShowState* st, ShowId show_id, const SeatMask& seats, std::chrono::milliseconds ttl);
+
+    /** @brief Low bits of ShowState::group_writes counting the writers in progress. */
+    static constexpr std::uint64_t kGroupWriters = 0xFFFFu;
+
+    /**
+     * @brief Brackets an update of several words of one show (writer side of the seqlock).
+     *
+     * @details
+     * Entered before the first word is touched and left after the last one (rollbacks
+     * included), so a reader that saw no writer in progress before its loads and the
+     * same seqlock value after them read no part of a group booking, cancellation or
+     * hold release. Single-word updates are atomic on their own and skip it.
+     */
+    class GroupWrite {
+    public:
+        explicit GroupWrite(const ShowState& st) : writes_(st.group_writes()) { writes_.fetch_add(1u); }
+        ~GroupWrite() { writes_.fetch_add(kGroupWriters, std::memory_order_release); } // -1 writer, +1 completed
+        GroupWrite(const GroupWrite&) = delete;
+        GroupWrite& operator=(const GroupWrite&) = delete;
+
+    private:
+        std::atomic<std::uint64_t>& writes_;
+    };
+
+    /**
+     * @brief Loads the free-seat word of every row of @p st into @p out[0..word_count)
+     *        as one consistent snapshot.
+     *
+     * @details
+     * Seqlock reader: retries while a GroupWrite is in progress or completed during the
+     * loads, so no multi-word update is seen half applied. Writers never wait for it.
+     */
+    static void load_free_words(const ShowState& st, std::uint64_t* out);
+
+    /** @brief Lifecycle of a hold slot (low 32 bits of HoldSlot::state). */
+    enum HoldPhase : std::uint32_t {
+        kHoldFree = 0,      /**< On the free list. */
+        kHoldActive = 1,    /**< Seats held, awaiting confirm/release/expiry. */
+        kHoldConfirmed = 2, /**< Seats converted to a booking. */
+        kHoldReleased = 3,  /**< Seats released (explicitly or by expiry). */
+    };
+
+    /** @brief End-of-list marker for hold slot indices. */
+    static constexpr std::uint32_t kNoSlot = 0xFFFFFFFFu;
+
+    /**
+     * @brief One hold record.
+     *
+     * @details
+     * A slot is recycled (generation bumped) by the reaper when its timer fires, which may
+     * race with late confirm/release calls. All fields are therefore atomics read with
+     * relaxed ordering, and every transition is validated by a CAS on @c state, whose high
+     * 32 bits hold the generation that is also encoded in the HoldId.
+     */
+    struct HoldSlot {
+        std::atomic<std::uint64_t> state{std::uint64_t{1} << 32};   /**< (generation << 32) | HoldPhase. */
+        std::atomic<std::uint32_t> next{kNoSlot};                   /**< Free list / inbox link. */
+        std::uint32_t wheel_next = kNoSlot;                         /**< Timer wheel bucket link (reaper only). */
+        std::atomic<ShowState*> show{nullptr};                      /**< Show whose seats are held. */
+        std::atomic<std::uint64_t> deadline_ms{0};                  /**< Expiry in ms since hold_epoch_. */
+        std::atomic<std::uint32_t> rows{0};                         /**< Up to 4 row indices, 8 bits each. */
+        std::atomic<std::uint8_t> row_count{0};                     /**< Number of valid entries in rows. */
+        std::array<std::atomic<std::uint64_t>, kMaxHoldRows> bits{}; /**< Held bits per row. */
+    };
+
+    /** @brief Links hold slots into the expiry wheel through HoldSlot::wheel_next. */
+    struct HoldWheelLinks {
+        HoldSlot* slots = nullptr;
+        std::uint32_t& next(std::uint32_t id) const { return slots[id].wheel_next; }
+        std::uint64_t deadline(std::uint32_t id) const {
+            return slots[id].deadline_ms.load(std::memory_order_relaxed);
+        }
+    };
+
+    /** @brief Hold mask of one show (see @ref held_seats_mask), created by its first hold. */
+    struct HeldWords {
+        std::array<std::atomic<std::uint64_t>, HallLayout::kMaxRows> rows{};
+    };
+
+    ShowTable<HeldWords> held_words_;
+    std::mutex held_words_mutex_; /**< Serialises the creation of hold masks. */
+
+    /** @brief Hold mask of @p show_id, created on first use. */
+    HeldWords& held_words_of(ShowId show_id);
+
+    /** @brief Sets (or, with @p held false, clears) the seats of hold @p h in its show's hold mask. */
+    void mark_held(const HoldSlot& h, bool held);
+
+    /** @brief A lease with a TTL (lease_seat_mask). */
+    struct LeaseTimer {
+        ShowId show_id;
+        std::chrono::steady_clock::time_point deadline;
+    };
+    std::mutex leases_mutex_;                           /**< Guards lease_timers_. */
+    std::unordered_map<BookingId, LeaseTimer> lease_timers_; /**< Leases with a TTL, by lease id. */
+
+    std::unique_ptr<HoldSlot[]> hold_slots_;            /**< Fixed-size hold table. */
+    std::size_t hold_capacity_ = 0;                     /**< Number of slots in hold_slots_. */
+    std::atomic<std::uint64_t> hold_free_{0};           /**< Free list head: (ABA tag << 32) | slot. */
+    std::atomic<std::uint32_t> hold_inbox_{kNoSlot};    /**< New holds not yet scheduled on the wheel. */
+    std::mutex reaper_mutex_;                           /**< Serialises expire_holds (try_lock only). */
+    IntrusiveTimerWheel<HoldWheelLinks> hold_wheel_;    /**< Expiry timers, ticks in ms since hold_epoch_. */
+    std::chrono::steady_clock::time_point hold_epoch_;  /**< Time origin of the hold timer wheel. */
+
+    /** @brief Milliseconds since hold_epoch_. */
+    std::uint64_t hold_clock_ms(std::chrono::steady_clock::time_point t) const;
+
+    /** @brief Pops a free hold slot, or kNoSlot if the table is full. */
+    std::uint32_t pop_free_hold();
+
+    /** @brief Returns a slot to the free list. */
+    void push_free_hold(std::uint32_t slot);
+
+    /** @brief Clears the held bits of a slot from its show's words and serves its waitlist. */
+    void release_hold_bits(const HoldSlot& h);
+
+    /** @brief Takes a ShowGate pass for the show of @p h (none for a slot never used). */
+    void hold_pass(const HoldSlot& h, std::optional<ShowGate::Pass>& pass) const;
+
+    /** @brief Settles an active hold (phase Active -> @p phase) identified by @p hold_id. */
+    bool settle_hold(HoldId hold_id, HoldPhase phase, HoldSlot*& out_slot);
+
+    /** @brief Outcome of an acquisition attempt. */
+    enum class Acquire {
+        Acquired,  /**< All requested bits were set. */
+        Conflict,  /**< A requested bit was already set; nothing changed. */
+        Contended, /**< The retry budget was exhausted; nothing changed. */
+        Rejected,  /**< The result would break the layout's companion seat rule; nothing changed. */
+        Gap,       /**< The result would leave an isolated free seat; nothing changed. */
+        OverCap,   /**< The theater's daily cap has no room for the seats; nothing changed. */
+        Closed,    /**< The show is not on sale (SalesState); nothing changed. */
+    };
+
+    /** @brief CAS retry/backoff policy of all booking paths (without a live config). */
+    BackoffPolicy backoff_;
+
+    /** @brief Live tunables (@ref use_live_config), and this service's listener on them. */
+    LiveConfig* live_config_ = nullptr;
+    std::uint64_t live_listener_ = 0;
+
+    /** @brief Sets the admission gates @p current lists and opens those only @p previous did. */
+    void apply_admission(const TuningConfig& previous, const TuningConfig& current);
+
+    /** @brief Multi-row bookings try hardware transactions first (@ref enable_hardware_transactions). */
+    bool htm_ = false;
+    mutable std::atomic<std::uint64_t> htm_commits_{0};
+    mutable std::atomic<std::uint64_t> htm_aborts_{0};
+    mutable std::atomic<std::uint64_t> htm_fallbacks_{0};
+
+    /**
+     * @brief Hardware transaction attempts of @ref try_acquire_words: true if one booked
+     *        @p req (published like the per-row CASes), false if the software protocol must run.
+     */
+    bool try_acquire_words_htm(ShowState& st, const SeatMask& req) const;
+
+    /** @brief Pool for bulk work (null = ThreadPool::shared()). */
+    ThreadPool* thread_pool_ = nullptr;
+
+    /** @brief API latency/outcome metrics (recorded from const readers too). */
+    mutable ServiceMetrics metrics_;
+
+    /** @brief Booking attempts per show, for @ref hot_shows (recorded while metrics are on). */
+    mutable HeavyHitters show_demand_;
+
+    /** @brief Counts @p attempts booking attempts on @p st for @ref hot_shows. */
+    void note_demand(const ShowState& st, std::uint64_t attempts = 1u) const {
+        if (attempts != 0u && metrics_.enabled()) show_demand_.add(id_of(st).value(), attempts);
+    }
+
+    /** @brief @ref show_stats of one resolved show. */
+    static void fill_show_stats(const ShowState& st, ShowId show_id, ShowStats& out);
+
+    /** @brief Outcome of a result for the metrics. */
+    void note_outcome(MetricsApi api, const BookingResult& r) const {
+        metrics_.count(api, static_cast<std::uint8_t>(r.status));
+    }
+    void note_outcome(MetricsApi api, const std::vector<BookingResult>& results) const {
+        note_outcome(api, Span<const BookingResult>(results));
+    }
+    void note_outcome(MetricsApi api, Span<const BookingResult> results) const {
+        for (const BookingResult& r : results) note_outcome(api, r);
+    }
+    void note_outcome(MetricsApi api, int count) const {
+        metrics_.count(api, static_cast<std::uint8_t>(count < 0 ? BookingStatus::InvalidShow : BookingStatus::Ok));
+    }
+    void note_outcome(MetricsApi api, const std::vector<std::string>&) const {
+        metrics_.count(api, static_cast<std::uint8_t>(BookingStatus::Ok));
+    }
+    void note_outcome(MetricsApi api, const std::pmr::vector<std::pmr::string>&) const {
+        metrics_.count(api, static_cast<std::uint8_t>(BookingStatus::Ok));
+    }
+
+    /**
+     * @brief Runs the body of a public entry point, tagged with @p api for profilers
+     *        (profiler.hpp), recording its latency and outcome unless metrics are off or it
+     *        was called from another entry point.
+     */
+    template <typename Body>
+    auto measured(MetricsApi api, Body&& body) const {
+        const ProfileScope tag(api);
+        if (!metrics_.enabled()) return body();
+        const ServiceMetrics::Scope scope;
+        if (!scope.outermost()) return body();
+        const auto start = std::chrono::steady_clock::now();
+        auto result = body();
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        metrics_.record_latency(api, static_cast<std::uint64_t>(ns.count()));
+        note_outcome(api, result);
+        return result;
+    }
+
+    /** @brief BookingId source (per-thread blocks, no shared write per booking). */
+    BookingIdGenerator booking_ids_;
+
+    /**
+     * @brief Allocates a BookingId, records it as the owner of every seat in @p seats and
+     *        journals the booking.
+     *
+     * @param commit_lsn If set, receives the journal commit LSN and the caller waits for
+     *        durability (batches wait once); otherwise a Sync journal is awaited here.
+     * @param sale False for seats taken but not sold yet (a kiosk lease): sales analytics
+     *        skip them.
+     */
+    BookingId record_owner(ShowState& st, const SeatMask& seats, std::uint64_t* commit_lsn = nullptr,
+                           bool sale = true);
+
+    /** @brief Journals an operation and, in Sync mode, waits until it is durable. */
+    void journal_commit(JournalOp op, const ShowState& st, BookingId id, const SeatMask& seats);
+
+    /** @brief Open journal (nullptr = journaling off). */
+    std::unique_ptr<Journal> journal_;
+
+    ColdShowStore cold_shows_;
+    std::mutex archive_mutex_; /**< Serialises @ref archive_shows_before passes. */
+
+    /** @brief Heap state of an archived show, kept until the next archive pass. */
+    struct RetiredShow {
+        std::unique_ptr<OwnerRow[]> owners;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> words;
+    };
+    std::vector<RetiredShow> archive_retired_;
+
+    /** @brief Journal LSN of the restored snapshot; older records are not replayed. */
+    std::uint64_t replay_from_lsn_ = 0;
+
+    /**
+     * @brief Catalog publications so far (bumped under @ref catalog_mutex_ after the store);
+     *        a delta needs an unchanged catalog.
+     */
+    std::atomic<std::uint64_t> catalog_generation_{0};
+
+    /**
+     * @brief @ref write_snapshot; @p out_header receives the header written and
+     *        @p out_generation the catalog generation captured.
+     */
+    SnapshotStatus write_snapshot_file(const std::string& path, SnapshotHeader& out_header,
+                                       std::uint64_t& out_generation) const;
+
+    /**
+     * @brief Appends the seat map of @p st (holds dropped); @p scratch holds 64 owners per row.
+     * @return Highest owner written (0 = no bookings).
+     */
+    static BookingId encode_show_seats(const ShowState& st, std::vector<BookingId>& scratch,
+                                       std::vector<std::uint8_t>& out);
+
+    /**
+     * @brief Decodes a validated seat map into the empty state @p st; @p scratch receives
+     *        64 owners per row.
+     * @return Highest owner installed.
+     */
+    static BookingId install_seat_map(ShowState& st, const std::uint8_t* data, std::size_t size,
+                                      std::vector<BookingId>& scratch);
+
+    /** @brief Decodes show @p st from @p lazy if it is still pending (cold path of get_state). */
+    void load_lazy_show(LazySeatMaps& lazy, const ShowState& st) const;
+
+    /** @brief Seat maps of a lazy restore not decoded yet (nullptr = none pending). */
+    mutable std::atomic<LazySeatMaps*> lazy_seats_{nullptr};
+    /** @brief Every lazy restore's maps, kept (mapped) until destruction: readers may still hold one. */
+    std::vector<std::unique_ptr<LazySeatMaps>> lazy_seats_owned_;
+
+    /** @brief One incremental snapshot pass (base or delta); the caller holds @ref incremental_mutex_. */
+    SnapshotStatus incremental_pass_locked();
+
+    /** @brief Marks @p st changed for the next snapshot delta (when incremental snapshots are on). */
+    void note_write(const ShowState& st) const {
+        if (DirtyShows* dirty = dirty_shows_.load(std::memory_order_acquire)) dirty->mark(static_cast<int>(st.position));
+    }
+
+    std::atomic<DirtyShows*> dirty_shows_{nullptr};  /**< Shows changed since the last pass (nullptr = off). */
+    std::unique_ptr<DirtyShows> dirty_shows_owned_;  /**< Created by the first set_incremental_snapshots. */
+    IncrementalSnapshotOptions incremental_;         /**< Current settings (empty directory = off). */
+    std::mutex incremental_mutex_;                   /**< Serialises passes and settings changes. */
+    bool has_base_ = false;                          /**< False: the next pass writes a base. */
+    std::uint64_t base_checksum_ = 0;                /**< SnapshotHeader::checksum of the current base. */
+    std::uint64_t base_generation_ = 0;              /**< catalog_generation_ the base was written at. */
+    std::uint64_t next_delta_ = 1;                   /**< Sequence of the next delta. */
+    std::atomic<std::uint64_t> snapshot_bases_{0};
+    std::atomic<std::uint64_t> journal_compactions_{0};
+    std::atomic<std::uint64_t> snapshot_deltas_{0};
+    std::atomic<std::uint64_t> snapshot_delta_shows_{0};
+    std::atomic<std::uint64_t> snapshot_failures_{0};
+    std::mutex incremental_thread_mutex_;            /**< Guards @ref incremental_stop_. */
+    std::condition_variable incremental_cv_;
+    bool incremental_stop_ = false;
+    std::thread incremental_thread_;                 /**< Pass loop (joined when snapshots stop). */
+
+    mutable std::atomic<std::uint64_t> occupancy_publications_{0};
+    std::mutex occupancy_mutex_;                     /**< Guards @ref occupancy_stop_. */
+    std::condition_variable occupancy_cv_;
+    bool occupancy_stop_ = false;
+    std::thread occupancy_thread_;                   /**< Publication loop of set_occupancy_export. */
+    mutable std::atomic<std::uint64_t> availability_version_{0};
+    std::mutex availability_mutex_;                  /**< Guards @ref availability_stop_. */
+    std::condition_variable availability_cv_;
+    bool availability_stop_ = false;
+    std::thread availability_thread_;                /**< Publication loop of set_availability_export. */
+
+    /** @brief Adjustments of every show at one repricing pass (see set_dynamic_pricing). */
+    struct PriceTable {
+        std::vector<ShowId> shows;          /**< Ascending. */
+        std::vector<std::int16_t> adjust;   /**< Percent, parallel to shows. */
+    };
+
+    mutable EpochManager pricing_epochs_;            /**< Reclaims replaced price tables. */
+    std::atomic<const PriceTable*> price_table_{nullptr};
+    std::atomic<std::uint64_t> price_table_version_{0};
+    std::mutex pricing_mutex_;                       /**< Serialises passes; guards @ref pricing_policy_. */
+    PricingPolicy pricing_policy_;                   /**< Steps sorted by min_occupancy. */
+    std::mutex pricing_loop_mutex_;                  /**< Guards @ref pricing_stop_. */
+    std::condition_variable pricing_cv_;
+    bool pricing_stop_ = false;
+    std::thread pricing_thread_;                     /**< Repricing loop of set_dynamic_pricing. */
+
+    mutable std::mutex slo_mutex_;                   /**< Guards @ref slo_ (not held while sampling). */
+    std::shared_ptr<SloMonitor> slo_;                /**< Monitor of set_slos (null = off). */
+    std::mutex slo_loop_mutex_;                      /**< Guards @ref slo_stop_. */
+    std::condition_variable slo_cv_;
+    bool slo_stop_ = false;
+    std::thread slo_thread_;                         /**< Sampling loop of set_slos. */
+
+    HotShowPolicy hot_policy_;
+    mutable std::mutex hot_mutex_;                            /**< Serialises starting the hot executor. */
+    mutable std::atomic<std::uint64_t> hot_promotions_{0};
+    mutable std::atomic<std::uint64_t> hot_demotions_{0};
+    mutable std::atomic<std::int64_t> hot_count_{0};
+    mutable std::atomic<ShowExecutor*> hot_executor_{nullptr}; /**< Published @ref hot_executor_owned_. */
+
+    /**
+     * @brief Hot-show tracking of the shows whose id maps to it.
+     *
+     * @details
+     * ShowState has no room left in its two lines, and only a few shows are ever contended
+     * at a time, so tracking lives in a fixed table indexed by show id. A slot follows one
+     * show at a time and is taken over by another while not hot; two hot shows never share
+     * a slot (the second is simply not promoted).
+     */
+    struct alignas(64) HeatSlot {
+        std::atomic<ShowId> show{-1};                 /**< Show tracked (or hot) in this slot. */
+        std::atomic<bool> hot{false};                 /**< @ref show is routed to the hot-show owner threads. */
+        std::atomic<bool> expected{false};            /**< @ref show is held hot by @ref expect_hot (never demoted by load). */
+        std::atomic<std::uint64_t> window_start{0};   /**< Current window's start (steady clock, ns; 0 = none). */
+        std::atomic<std::uint64_t> retries{0};        /**< cas_retries of @ref show at the window start. */
+        std::atomic<std::uint64_t> changes{0};        /**< changes() of @ref show at the window start. */
+        std::atomic<std::uint64_t> requests{0};       /**< Requests applied in the window (owner or combiner only). */
+        std::atomic<bool> combining{false};           /**< @ref show runs through @ref combiner, not the executor. */
+        std::atomic<FlatCombiner*> combiner{nullptr}; /**< Created on the first Combining promotion; owned. */
+
+        HeatSlot() = default;
+        ~HeatSlot() { delete combiner.load(std::memory_order_relaxed); }
+        HeatSlot(const HeatSlot&) = delete;
+        HeatSlot& operator=(const HeatSlot&) = delete;
+    };
+    static constexpr std::size_t kHeatSlots = 1024;
+    std::unique_ptr<HeatSlot[]> heat_slots_ = std::make_unique<HeatSlot[]>(kHeatSlots);
+
+    /** @brief Slot tracking show @p show_id. */
+    HeatSlot& heat_slot(ShowId show_id) const {
+        return heat_slots_[static_cast<std::size_t>(static_cast<std::uint64_t>(show_id.value()) % kHeatSlots)];
+    }
+
+    /** @brief True if show @p show_id is routed to the hot-show owner threads. */
+    bool is_hot(ShowId show_id) const {
+        const HeatSlot& slot = heat_slot(show_id);
+        return slot.hot.load(std::memory_order_acquire) && slot.show.load(std::memory_order_relaxed) == show_id;
+    }
+
+    /** @brief Owner threads of hot shows (Shared mode), started on the first promotion. */
+    mutable std::unique_ptr<ShowExecutor> hot_executor_owned_;
+
+    /** @brief Owner threads (OwnerThreads mode); declared last so it stops first. */
+    std::unique_ptr<ShowExecutor> executor_;
+
+    /** @brief Deadline of the calling thread's requests (set by DeadlineScope). */
+    static inline thread_local std::chrono::steady_clock::time_point request_deadline_ = ShowExecutor::kNoDeadline;
+
+    /**
+     * @brief Runs @p body on the owner thread of @p show_id: inline in Shared mode, unless
+     *        the show is hot (then on a hot-show owner thread or through its combiner).
+     *
+     * @details
+     * Booking bodies (returning a BookingResult) fail with DeadlineExceeded instead of
+     * running once the calling thread's DeadlineScope has passed, including while queued
+     * for an owner thread.
+     */
+    template <typename Body>
+    auto on_owner(ShowId show_id, Body&& body, RequestLane lane = RequestLane::Book) {
+        const ShowGate::Pass pass(show_gate_, show_id.value());
+        if constexpr (std::is_same_v<decltype(body()), BookingResult>) {
+            if (moved_since_lookup(show_id)) return BookingResult::error(BookingStatus::Contended);
+            const std::chrono::steady_clock::time_point deadline = request_deadline_;
+            if (deadline != ShowExecutor::kNoDeadline) {
+                if (std::chrono::steady_clock::now() > deadline) {
+                    return BookingResult::error(BookingStatus::DeadlineExceeded);
+                }
+                if (executor_) {
+                    bool expired = false;
+                    BookingResult res = executor_->run_until(show_id.value(), lane, deadline, body, expired);
+                    return expired ? BookingResult::error(BookingStatus::DeadlineExceeded) : res;
+                }
+            }
+        }
+        if (executor_) return executor_->run(show_id.value(), lane, body);
+        if (hot_count_.load(std::memory_order_relaxed) <= 0 || !is_hot(show_id)) return body();
+        const auto hot_body = [&] {
+            note_hot_request(show_id);
+            return body();
+        };
+        HeatSlot& slot = heat_slot(show_id);
+        if (slot.combining.load(std::memory_order_relaxed)) {
+            if (FlatCombiner* combiner = slot.combiner.load(std::memory_order_acquire)) return combiner->run(hot_body);
+        } else if (ShowExecutor* hot = hot_executor_.load(std::memory_order_acquire)) {
+            return hot->run(show_id.value(), lane, hot_body);
+        }
+        return body();
+    }
+
+    /** @brief Counts @p retries failed CAS attempts on @p st and promotes it if it ran hot. */
+    void note_cas_retries(ShowState& st, std::uint32_t retries) const;
+
+    /** @brief Counts one owner-applied request of hot show @p show_id; demotes it if its load dropped. */
+    void note_hot_request(ShowId show_id);
+
+    /** @brief Switches @p show_id to or from hot-show execution; false if it already was (or cannot be). */
+    bool mark_hot(ShowId show_id, bool hot) const;
+
+    /**
+     * @brief Sets @p req in word @p w of @p st if none of its bits are already set (bounded
+     *        CAS loop); a successful CAS bumps the show version and is published to the
+     *        change feed. A capped show reserves the seats on its theater's counter first
+     *        (OverCap if they do not fit) and gives them back if no CAS succeeds.
+     *
+     * @param out_conflict On Conflict, the requested bits that were already set.
+     * @param retries Incremented by the number of failed CAS attempts.
+     * @param out_word On Conflict (if non-null), the word value the conflict was found on.
+     */
+    Acquire try_acquire_word(ShowState& st, int w, std::uint64_t req, std::uint64_t& out_conflict,
+                             std::uint32_t& retries, std::uint64_t* out_word = nullptr) const;
+
+    /** @brief Clears the bits of @p seats (one AND per row; multi-row releases as one group write). */
+    void release_mask(ShowState& st, const SeatMask& seats) const;
+
+    /** @brief Clears @p bits of word @p w of @p st (one atomic AND), gives them back to its cap and publishes the change. */
+    void release_word(ShowState& st, int w, std::uint64_t bits) const {
+        std::optional<GroupWrite> group; // with a feed, the change and its feed entry are one group write
+        if (change_feed_) group.emplace(st);
+        sim_point();
+        const std::uint64_t old = st.words()[w].fetch_and(~bits, seat_words::kWordUpdate);
+        if (CapacityCounter* cap = capacity_of(st)) cap->release(popcount64(old & bits));
+        st.changes().fetch_add(1u, std::memory_order_release);
+        note_write(st);
+        note_runs(st, w);
+        if (change_feed_) change_feed_->publish(id_of(st), w, old, old & ~bits);
+    }
+
+    /** @brief Feed of @ref enable_change_feed (nullptr = disabled, the common case). */
+    std::unique_ptr<SeatChangeFeed> change_feed_;
+
+    /** @brief Sketches of @ref enable_sales_analytics (nullptr = disabled, the common case). */
+    std::unique_ptr<SalesAnalytics> sales_;
+
+    /** @brief Free-run summary of @ref enable_seat_run_summary (nullptr = disabled, the common case). */
+    std::atomic<SeatRunSummary*> run_summary_{nullptr};
+    std::unique_ptr<SeatRunSummary> run_summary_owned_;
+
+    /**
+     * @brief Refreshes row @p w of @p st in its free-row summary and, if enabled, the run
+     *        summary (after a word update).
+     */
+    void note_runs(const ShowState& st, int w) const {
+        if (std::atomic<std::uint64_t>* rows = st.free_rows()) refresh_free_row(*rows, st, w);
+        if (SeatRunSummary* runs = run_summary_.load(std::memory_order_acquire)) refresh_runs(*runs, st, w);
+    }
+
+    /** @brief Refreshes every row of @p st in its summaries (after a bulk update). */
+    void note_all_runs(const ShowState& st) const {
+        if (std::atomic<std::uint64_t>* rows = st.free_rows()) {
+            rows->fetch_and(row_bits(st.word_count), std::memory_order_relaxed); // rows a move removed
+            for (int w = 0; w < st.word_count; ++w) refresh_free_row(*rows, st, w);
+        }
+        if (SeatRunSummary* runs = run_summary_.load(std::memory_order_acquire)) {
+            runs->trim(static_cast<int>(st.position), st.word_count);
+            for (int w = 0; w < st.word_count; ++w) refresh_runs(*runs, st, w);
+        }
+    }
+
+    /**
+     * @brief Run summary to answer for @p st from, or nullptr: none is enabled, the show is
+     *        not listed in it yet, or its words are shared (other processes write them).
+     */
+    const SeatRunSummary* summary_of(const ShowState& st) const;
+
+    /**
+     * @brief Free-seat words of @p st for a seat search (seat_words::load_free, no
+     *        snapshot: the CAS decides), skipping full rows if it has a free-row summary
+     *        and the rows outside @p rows (the others get 0).
+     */
+    static void load_search_words(const ShowState& st, std::uint64_t* out, std::uint64_t rows = ~std::uint64_t{0}) {
+        rows &= row_bits(st.word_count);
+        if (const std::atomic<std::uint64_t>* free = st.free_rows()) rows &= free->load(std::memory_order_acquire);
+        if (rows == row_bits(st.word_count)) {
+            seat_words::load_free(st.words(), st.layout->row_masks(), out, st.word_count);
+        } else {
+            seat_words::load_free_rows(st.words(), st.layout->row_masks(), out, st.word_count, rows);
+        }
+    }
+
+    /** @brief Bits 0 .. @p rows - 1. */
+    static std::uint64_t row_bits(int rows) {
+        return rows >= 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << rows) - 1u;
+    }
+
     /**
-     * @brief Converts a list of seat labels into a bitmask.
+     * @brief Sets bit @p w of @p rows iff row @p w of @p st has a free seat.
      *
+     * @details
+     * Only a word update that fills a row or frees a full one writes the summary. The
+     * writer then checks the word again, so of two racing updates the later one repairs
+     * the summary: once the updates of a row stop, its bit matches its word. That takes
+     * one total order over the word update, the summary update and the loads after each
+     * (seq_cst; in BOOKING_RELAXED_ORDERING mode a fence after the acq_rel word update).
+     * Meanwhile a search may skip a row that was just freed, as if it had read the word a
+     * moment earlier.
+     */
+    static void refresh_free_row(std::atomic<std::uint64_t>& rows, const ShowState& st, int w) {
+        if constexpr (seat_words::kRelaxedOrdering) std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::uint64_t bit = std::uint64_t{1} << w;
+        const std::uint64_t seats = st.layout->row_mask(w);
+        while (true) {
+            const bool free = (~st.words()[w].load(std::memory_order_seq_cst) & seats) != 0u;
+            if (((rows.load(std::memory_order_seq_cst) & bit) != 0u) == free) return;
+            if (free) {
+                rows.fetch_or(bit, std::memory_order_seq_cst);
+            } else {
+                rows.fetch_and(~bit, std::memory_order_seq_cst);
+            }
+        }
+    }
+
+    /** @brief Recomputes row @p w of @p st in @p runs from its live word. */
+    static void refresh_runs(SeatRunSummary& runs, const ShowState& st, int w);
+
+    /** @brief Longest free run of @p st, from its live words. */
+    static int longest_free_run(const ShowState& st);
+
+    /** @brief Orderings of @ref enable_availability_views (nullptr = disabled). */
+    std::unique_ptr<AvailabilityViews> views_;
+    mutable std::unique_ptr<SeatChangeSubscriber> views_feed_; /**< The views' position in the change feed. */
+    mutable std::mutex views_mutex_;                           /**< Serialises drains of @ref views_feed_. */
+
+    /** @brief Adds show @p show_id of @p movie_id to @p views with the statistics of its live words. */
+    void view_show(AvailabilityViews& views, ShowId show_id, MovieId movie_id) const;
+
+    /** @brief Seats left and cheapest free seat price of @p st, from its live words. */
+    static void show_availability(const ShowState& st, int& seats_left, std::uint32_t& cheapest_price);
+
+    /** @brief @ref refresh_availability_views body; the caller holds @ref views_mutex_. */
+    std::size_t drain_availability_views() const;
+
+    /** @brief Table of @ref enable_request_dedupe (nullptr = disabled). */
+    std::unique_ptr<RequestDedupe> dedupe_;
+
+    /**
+     * @brief Runs @p book once per request id: claims @p request_id in dedupe_, then replays,
+     *        rejects or runs and records the outcome.
+     */
+    template <typename F>
+    BookingResult deduplicated(std::uint64_t request_id, std::uint64_t fingerprint, F&& book);
+
+    /**
+     * @brief All-or-nothing acquisition of a multi-word request (ordered CAS with rollback).
+     *
+     * @param st Show state to update (its retry counter is updated).
+     * @param req Requested seats.
+     * @param out_conflicts On Conflict, requested seats found booked.
+     * @param out_word On Conflict (if non-null), the value of the first conflicting word.
+     * @return Acquired, or Conflict/Contended with the state unchanged.
+     */
+    Acquire try_acquire_words(ShowState& st, const SeatMask& req, SeatMask& out_conflicts,
+                              std::uint64_t* out_word = nullptr) const;
+
+    /**
+     * @brief Converts a list of seat labels into a seat mask.
+     *
+     * @param layout Layout the labels are parsed against.
      * @param labels List of seat labels.
-     * @param out_error Filled with error message on failure; cleared on entry.
-     * @return Bitmask representing requested seats, or 0 on failure.
+     * @param out_mask Filled with the requested seats on success.
+     * @param out_bad_index Position of the offending label on failure.
+     * @return BookingStatus::Ok, InvalidSeatLabel or DuplicateSeatLabel.
      *
      * @details
      * Performs:
@@ -258,8 +3827,224 @@ private:
      *
      * This helper does not check current booking state; it only validates the request.
      */
-    static std::uint32_t seats_to_mask_or_fail(const std::vector<std::string>& labels,
-                                               std::string& out_error);
+    static BookingStatus seats_to_mask_or_fail(const HallLayout& layout,
+                                               const std::vector<std::string>& labels,
+                                               SeatMask& out_mask,
+                                               int& out_bad_index);
+
+    /** @brief string_view overload of @ref seats_to_mask_or_fail. */
+    static BookingStatus seats_to_mask_or_fail(const HallLayout& layout,
+                                               Span<const std::string_view> labels,
+                                               SeatMask& out_mask,
+                                               int& out_bad_index);
+
+    /**
+     * @brief @ref seats_to_mask_or_fail on a space- or tab-separated label list.
+     *
+     * @param out_bad_label The offending label on failure (a view into @p label_list).
+     * @return Ok, NoSeats (no label), InvalidSeatLabel or DuplicateSeatLabel.
+     *
+     * @details
+     * The list is split by seat_label::scan_list, which classifies 64 bytes per step with
+     * SIMD compares. Seats are set without testing for duplicates; the mask's popcount is
+     * compared with the label count once at the end, and only a request that does repeat a
+     * seat is scanned again to find the first repeat.
+     */
+    static BookingStatus label_list_to_mask_or_fail(const HallLayout& layout, std::string_view label_list,
+                                                    SeatMask& out_mask, int& out_bad_index,
+                                                    std::string_view& out_bad_label);
+
+    /**
+     * @brief Books a validated, non-empty request on @p st (single-word fast path or
+     *        ordered multi-word acquisition).
+     */
+    BookingResult book_mask_on(ShowState& st, const SeatMask& req_mask) const;
+
+    /**
+     * @brief @ref book_mask_on followed by @ref record_owner on success, on the show's owner
+     *        (@p commit_lsn as in the deferred @ref book_seats).
+     */
+    BookingResult book_owned(ShowState& st, const SeatMask& req_mask, std::uint64_t* commit_lsn = nullptr);
+
+    /**
+     * @brief Finds and books the best run of @p n adjacent seats (body of book_best_available).
+     *
+     * @details
+     * With @p first_level >= 0 only seats of HallLayout::level_seats are considered,
+     * trying the levels from @p first_level to @p last_level and taking the first one that
+     * has a run; -1 (the default) considers every seat.
+     */
+    BookingResult book_best_on(ShowState& st, int n, SeatMask& out_seats, int first_level = -1, int last_level = -1);
+
+    /**
+     * @brief Checks every part of a bundle or bulk plan (show, non-empty seats of its layout)
+     *        and fills @p states; Ok or the first failure with label_index set.
+     */
+    BookingResult check_bundle(Span<const BundleItem> items, std::vector<ShowState*>& states);
+
+    /** @brief Finds and books a group of @p n seats over two consecutive rows (body of book_group). */
+    BookingResult book_group_on(ShowState& st, int n, SeatMask& out_seats);
+
+    /**
+     * @brief Sets the bits of @p req that are free in word @p w of @p st (CAS loop with the
+     *        checks of @ref try_acquire_word).
+     *
+     * @param out_got On Acquired, the bits set; Conflict if none of @p req was free.
+     */
+    Acquire try_acquire_free(ShowState& st, int w, std::uint64_t req, std::uint64_t& out_got,
+                             std::uint32_t& retries) const;
+
+    /** @brief Books the free part of @p req and records its owner (body of book_any_seat_mask, on the show's owner). */
+    BookingResult book_any_on(ShowState& st, const SeatMask& req, SeatMask& out_seats);
+
+    /** @brief Releases validated @p seats owned by @p booking_id (body of cancel_seat_mask). */
+    BookingResult cancel_owned(ShowState& st, const SeatMask& seats, BookingId booking_id);
+
+    /** @brief Queued request of @ref join_waitlist. */
+    struct WaitlistEntry : MpscNode {
+        int seats = 0;              /**< Adjacent seats wanted. */
+        WaitlistCallback on_booked; /**< Receives the booking. */
+    };
+
+    /**
+     * @brief Waitlist of one show.
+     *
+     * @details
+     * Producers (joining requests) push lock-free; the consumer side (@ref front and the
+     * queue's pop) belongs to whichever thread won @ref drains, and the acq_rel updates of
+     * that counter order one drainer's work before the next one's.
+     */
+    struct Waitlist {
+        MpscQueue queue;                      /**< Entries in arrival order. */
+        WaitlistEntry* front = nullptr;       /**< Popped head that does not fit yet (drainer only). */
+        std::atomic<std::uint64_t> drains{0}; /**< Drain passes requested; 0 = nobody draining. */
+        std::atomic<std::uint64_t> waiting{0};/**< Entries not satisfied yet. */
+        ObjectPool<WaitlistEntry>* entries = nullptr; /**< Where the entries come from. */
+
+        Waitlist() = default;
+        ~Waitlist() {
+            if (!entries) return; // never emplaced
+            entries->release(front);
+            while (MpscNode* n = queue.pop()) entries->release(static_cast<WaitlistEntry*>(n));
+        }
+        Waitlist(const Waitlist&) = delete;
+        Waitlist& operator=(const Waitlist&) = delete;
+    };
+
+    /** @brief Admission gates by show id, created by the first @ref set_admission_policy of a show. */
+    ShowTable<AdmissionGate> admission_;
+    std::mutex admission_mutex_; /**< Serialises policy changes. */
+
+    /** @brief True unless the show's admission gate sheds this booker (Throttled). */
+    bool admit_booker(ShowId show_id) const {
+        AdmissionGate* gate = admission_.find(show_id);
+        return !gate || gate->try_admit(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /** @brief Attendance counter of a capped show (ShowTable entries of @ref show_caps_). */
+    struct ShowCap {
+        CapacityCounter* counter = nullptr;
+    };
+
+    /** @brief Counters of the shows of capped theaters (guarded by catalog_mutex_ for writes). */
+    ShowTable<ShowCap> show_caps_;
+    std::atomic<bool> caps_on_{false}; /**< Set by the first set_theater_daily_cap: ungated shows skip the lookup. */
+    std::unordered_map<TheaterId, int> theater_caps_; /**< Cap per theater (guarded by catalog_mutex_). */
+    /** @brief Counter per (theater, UTC day); never freed, so shows may keep raw pointers. Guarded by catalog_mutex_. */
+    std::map<std::pair<TheaterId, std::int64_t>, std::unique_ptr<CapacityCounter>> capacity_counters_;
+
+    /** @brief Counter of @p st, or nullptr if its theater is not capped. */
+    CapacityCounter* capacity_of(const ShowState& st) const {
+        if (!caps_on_.load(std::memory_order_acquire)) return nullptr;
+        const ShowCap* cap = show_caps_.find(id_of(st));
+        return cap ? cap->counter : nullptr;
+    }
+
+    /** @brief Attaches @p show to its theater's counter of its day if the theater is capped; catalog_mutex_ held. */
+    void attach_capacity_locked(const Show& show);
+
+    /** @brief Gives back the seats of show @p show_id and drops it from @ref show_caps_; catalog_mutex_ held. */
+    void detach_capacity_locked(ShowId show_id);
+
+    /** @brief Seats of @p st booked or held, from its live words. */
+    static int taken_seats(const ShowState& st);
+
+    /** @brief Storage of waitlist entries: acquired by joiners, released by whichever thread serves them. */
+    ObjectPool<WaitlistEntry> waitlist_entries_;
+    /** @brief Waitlists by show id, created by the first @ref join_waitlist of a show. */
+    ShowTable<Waitlist> waitlists_;
+    std::mutex waitlist_mutex_; /**< Serialises the creation of waitlists. */
+
+    /** @brief Serves the waitlist of @p st, if anybody waits (after seats were freed). */
+    void notify_waitlist(ShowState& st) {
+        Waitlist* wl = waitlists_.find(id_of(st));
+        if (seat_words::kRelaxedOrdering) std::atomic_thread_fence(std::memory_order_seq_cst); // see seat_words.hpp
+        if (wl && wl->waiting.load() != 0u) drain_waitlist(st, *wl); // seq_cst: pairs with a joining waiting++
+    }
+
+    /** @brief Books for the head entries of @p wl while they fit, or hands the pass to the running drain. */
+    void drain_waitlist(ShowState& st, Waitlist& wl);
+};
+
+/**
+ * @brief Read-only handle on one catalog snapshot (see BookingService::catalog_view).
+ *
+ * @details
+ * Holds an epoch guard, so the snapshot and every span handed out stay alive until the
+ * handle is destroyed; catalog writers keep publishing new snapshots meanwhile and the
+ * handle keeps seeing its own. Like the guard it must be destroyed on the thread that
+ * created it, and it should be short-lived: it delays the reclamation of replaced snapshots.
+ * Strings inside the spans point into the service's arena and outlive the handle.
+ */
+class BookingService::CatalogView {
+public:
+    explicit CatalogView(const BookingService& service);
+
+    CatalogView(const CatalogView&) = delete;
+    CatalogView& operator=(const CatalogView&) = delete;
+
+    /** @brief All movies, in insertion order. */
+    Span<const Movie> movies() const;
+
+    /** @brief All theaters, in insertion order. */
+    Span<const Theater> theaters() const;
+
+    /** @brief Theaters with a show of @p movie_id, sorted by theater id (empty if none). */
+    Span<const Theater> theaters_for_movie(MovieId movie_id) const;
+
+    /**
+     * @brief Shows of (movie, theater) starting in [from, to), by start time then show id.
+     *
+     * @details
+     * A sub-span of the snapshot's sorted timeline: two binary searches, no copy.
+     */
+    Span<const Show> shows_between(MovieId movie_id, TheaterId theater_id, ShowTime from, ShowTime to) const;
+
+private:
+    EpochManager::Guard guard_;
+    const Catalog* catalog_;
+};
+
+/**
+ * @brief One caller's cached reference to a show's booking state (see BookingService::show_handle).
+ */
+class BookingService::ShowHandle {
+public:
+    ShowHandle() = default;
+
+    /** @brief The show the handle refers to. */
+    ShowId show_id() const { return show_id_; }
+
+    /** @brief True if the show existed when the handle was taken or last used. */
+    bool valid() const { return state_ != nullptr; }
+
+private:
+    friend class BookingService;
+
+    ShowId show_id_;
+    ShowState* state_ = nullptr;  /**< Stays valid while epoch_ is current: states never move. */
+    std::uint64_t epoch_ = 0;     /**< BookingService::state_epoch_ when state_ was looked up. */
 };
 
 } // namespace booking
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "ids.hpp"
+
+/**
+ * @file change_feed.hpp
+ * @brief Lock-free broadcast ring of seat-word changes, for pushing seat map updates.
+ *
+ * Every successful update of a booking word (book, hold, cancel, release, rollback) is
+ * published as one SeatChange carrying the word's value before and after. Any number of
+ * subscribers read the ring independently, each at its own position; nobody waits for
+ * them, so a subscriber that falls more than a ring behind loses events and is told so
+ * (the sequence numbers jump) and resyncs from BookingService::available_seats_mask.
+ *
+ * Changes of one word may be published in a different order than the CASes that made
+ * them (the publishing threads race for sequence numbers). Apply a change to a mirrored
+ * word as `mirror ^= old_bits ^ new_bits`: the flips commute, so once the feed has caught
+ * up the mirror is exact whatever the order.
+ *
+ * With several lanes, producers do not share a sequence counter: each thread takes its
+ * numbers from the lane it was assigned (lane l hands out l, l + lanes, l + 2 * lanes, ...),
+ * so publishing touches no cache line that other threads write. A reader that finds a
+ * position of an idle lane below the head skips it by claiming it as a hole, which readers
+ * step over; subscribers never see holes. The price is ring space: under a single busy
+ * producer a polling reader fills up to lanes - 1 holes per change.
+ */
+
+namespace booking {
+
+/** @brief One published word update. */
+struct SeatChange {
+    std::uint64_t seq = 0;      /**< Position in the feed (consecutive from 0). */
+    ShowId show_id;             /**< Show whose word changed. */
+    std::int32_t word = 0;      /**< Row (booking word index). */
+    std::uint64_t old_bits = 0; /**< Booked/held bits before the update. */
+    std::uint64_t new_bits = 0; /**< Booked/held bits after the update. */
+};
+
+/** @brief Outcome of SeatChangeFeed::read. */
+enum class FeedRead : std::uint8_t {
+    Ok,      /**< The change was copied out. */
+    Hole,    /**< Nobody published at this position (an idle lane's skipped number). */
+    NotYet,  /**< Not published yet (the feed has not reached this sequence number). */
+    Lost,    /**< Overwritten: the reader fell more than a ring behind. */
+};
+
+/**
+ * @brief Multi-producer broadcast ring of SeatChange records.
+ *
+ * @details
+ * A producer takes a sequence number with one fetch_add and writes its slot under a
+ * per-slot version (odd while writing, even when published), so readers copy a slot
+ * optimistically and retry or report Lost when the version moved. A producer only waits
+ * for the producer of the same slot one lap earlier, which has long finished unless the
+ * ring is tiny. Sequence numbers come from per-thread lanes (see the file comment).
+ */
+class SeatChangeFeed {
+public:
+    /** @brief Most lanes a feed can have. */
+    static constexpr std::size_t kMaxLanes = 64;
+
+    /**
+     * @brief Creates a ring of @p capacity slots whose numbers come from @p lanes lanes.
+     * @throws std::invalid_argument unless @p capacity is a power of two >= 2 and @p lanes
+     *         a power of two <= min(@ref kMaxLanes, @p capacity) (a lap of the ring then
+     *         comes back to the same lane).
+     */
+    explicit SeatChangeFeed(std::size_t capacity, std::size_t lanes = 1);
+
+    SeatChangeFeed(const SeatChangeFeed&) = delete;
+    SeatChangeFeed& operator=(const SeatChangeFeed&) = delete;
+
+    /** @brief Publishes a change of (@p show_id, @p word) from @p old_bits to @p new_bits. */
+    void publish(ShowId show_id, int word, std::uint64_t old_bits, std::uint64_t new_bits);
+
+    /**
+     * @brief One past the highest sequence number taken: every number below it is
+     *        published, in flight, or (with lanes) an idle lane's that a reader will skip.
+     */
+    std::uint64_t head() const;
+
+    /**
+     * @brief @ref head, after which every change published is numbered at or above it.
+     *
+     * @details
+     * With lanes, an idle lane may still hand out numbers below head(); this claims them
+     * as holes first. A change numbered below the cut therefore took its seats before the
+     * call, so a seat map read after it contains it (see BookingService::availability_snapshot).
+     */
+    std::uint64_t cut() const;
+
+    /** @brief Number of lanes. */
+    std::size_t lanes() const { return lane_count_; }
+
+    /** @brief Number of slots. */
+    std::size_t capacity() const { return mask_ + 1u; }
+
+    /** @brief Bytes of the ring. */
+    std::size_t bytes() const { return capacity() * sizeof(Slot) + lane_count_ * sizeof(Lane); }
+
+    /**
+     * @brief Copies change @p seq into @p out if it is still in the ring.
+     *
+     * @details
+     * If @p seq belongs to an idle lane and a later number has been taken, claims it
+     * (and the lane's other unused numbers up to it) as holes and returns Hole.
+     */
+    FeedRead read(std::uint64_t seq, SeatChange& out) const;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> version{0};  /**< 2 * seq + 1 while writing, 2 * seq + 2 when published. */
+        std::atomic<std::int64_t> show{-1};     /**< Show id. */
+        std::atomic<std::int32_t> word{0};
+        std::atomic<std::uint64_t> old_bits{0};
+        std::atomic<std::uint64_t> new_bits{0};
+    };
+
+    /** @brief Next index of one lane (its sequence numbers are index * lanes + lane). */
+    struct alignas(64) Lane {
+        std::atomic<std::uint64_t> next{0};
+    };
+
+    /** @brief Waits for the previous lap's writer of @p seq's slot, then fills it via @p fill. */
+    template <typename Fill>
+    void write_slot(std::uint64_t seq, Fill&& fill) const;
+
+    /** @brief Lane of the calling thread (threads are dealt lanes round robin). */
+    Lane& own_lane(std::size_t& lane);
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t mask_;
+    std::size_t lane_count_;
+    mutable std::unique_ptr<Lane[]> lanes_; /**< Readers claim idle lanes' numbers as holes. */
+};
+
+/**
+ * @brief One reader of a SeatChangeFeed (use from one thread).
+ */
+class SeatChangeSubscriber {
+public:
+    /** @brief Starts at the feed's current head: only changes published from now on are read. */
+    explicit SeatChangeSubscriber(const SeatChangeFeed& feed) : feed_(feed), next_(feed.head()) {}
+
+    /**
+     * @brief Copies up to @p max pending changes into @p out, oldest first.
+     *
+     * @return Number of changes copied. Stops early at a change still being written.
+     *
+     * @details
+     * If changes were lost the subscriber skips to the oldest change still in the ring
+     * and sets @p gap; every change returned by that call follows the gap. The caller
+     * should resync its seat maps (all of them: the lost changes are unknown) before
+     * applying them.
+     */
+    std::size_t poll(SeatChange* out, std::size_t max, bool& gap);
+
+    /** @brief Sequence number of the next change this subscriber reads. */
+    std::uint64_t position() const { return next_; }
+
+private:
+    const SeatChangeFeed& feed_;
+    std::uint64_t next_;
+};
+
+} // namespace booking
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "booking_service.hpp"
+#include "text_protocol.hpp"
+
+/**
+ * @file cluster.hpp
+ * @brief Partitioning of the show space over booking nodes by consistent hashing.
+ *
+ * Every node is a booking_server loading the same catalog, started as a cluster node
+ * (BookingServerOptions::cluster_admin); each show's seats live on exactly one of them.
+ * A ClusterRouter places shows on a HashRing of the nodes and forwards every text
+ * protocol request of a show to its node over a small pool of persistent connections.
+ *
+ * Adding or removing a node changes the owner of about 1/N of the shows. Those are
+ * moved one at a time: the router holds back the requests of the moving show, takes
+ * its state (bookings with their ids, holds) out of the old node with "export",
+ * installs it on the new node with "import" and reroutes. Requests for every other
+ * show keep flowing to their nodes during the move.
+ */
+
+namespace booking {
+
+/** @brief Cluster node id (small integer chosen by the operator, < ClusterRouter::kMaxNodes). */
+using NodeId = std::uint32_t;
+
+/** @brief Node id meaning "no node". */
+constexpr NodeId kNoNode = ~NodeId{0};
+
+/**
+ * @brief Consistent hash ring of nodes with virtual points.
+ *
+ * @details
+ * Each node owns @c virtual_nodes pseudo-random points of the 64-bit hash circle; a show
+ * belongs to the node of the first point at or after its hash. Adding a node only takes
+ * shows from its neighbours' arcs, so about shows / nodes of them change owner.
+ */
+class HashRing {
+public:
+    /** @brief Points per node: spreads shows within a few percent of even. */
+    static constexpr int kDefaultVirtualNodes = 128;
+
+    /** @brief Adds @p node's points (no-op if already present). */
+    void add_node(NodeId node, int virtual_nodes = kDefaultVirtualNodes);
+
+    /** @brief Removes @p node's points. */
+    void remove_node(NodeId node);
+
+    /** @brief True if @p node has points on the ring. */
+    bool contains(NodeId node) const;
+
+    /** @brief True if the ring has no nodes. */
+    bool empty() const { return points_.empty(); }
+
+    /** @brief Node owning @p show_id; kNoNode on an empty ring. */
+    NodeId owner(ShowId show_id) const;
+
+private:
+    std::vector<std::pair<std::uint64_t, NodeId>> points_; /**< (hash, node), sorted by hash. */
+};
+
+/** @brief Outcome of a cluster membership change. */
+enum class ClusterStatus : std::uint8_t {
+    Ok,            /**< Done; affected shows were moved. */
+    InvalidNode,   /**< The node id is out of range, already a member, or not a member. */
+    ConnectError,  /**< The node could not be reached. */
+    NodeError,     /**< A node failed or refused a show move (moves done so far stay done). */
+    LastNode,      /**< The last node cannot leave while the cluster has shows. */
+};
+
+/** @brief Static description of a cluster status. */
+const char* to_string(ClusterStatus status);
+
+/**
+ * @brief Thin request router of a booking cluster.
+ *
+ * @details
+ * The router only resolves (movie, theater) to a show with its local copy of the catalog
+ * and forwards the request line verbatim; requests without a show (movies, theaters,
+ * help, and show lookups that fail) go to any node, which holds the full catalog.
+ * A request holds its show's stripe of a reader/writer gate while it is in flight, and a
+ * move takes the stripe exclusively, so no request of a moving show reaches either node
+ * mid-move. execute may be called from many threads; membership changes are serialised.
+ */
+class ClusterRouter {
+public:
+    /** @brief Highest node id + 1. */
+    static constexpr NodeId kMaxNodes = 64;
+
+    /** @brief Persistent connections per node (requests beyond them queue). */
+    static constexpr std::size_t kConnectionsPerNode = 4;
+
+    /** @brief Router placing the shows of @p catalog (kept by reference, same schedule as the nodes). */
+    explicit ClusterRouter(const BookingService& catalog, int virtual_nodes = HashRing::kDefaultVirtualNodes);
+    ~ClusterRouter();
+
+    ClusterRouter(const ClusterRouter&) = delete;
+    ClusterRouter& operator=(const ClusterRouter&) = delete;
+
+    /** @brief Adds the node at @p host:@p port and moves the shows it now owns to it. */
+    ClusterStatus add_node(NodeId node, const std::string& host, std::uint16_t port);
+
+    /** @brief Moves @p node's shows to the remaining nodes and disconnects it. */
+    ClusterStatus remove_node(NodeId node);
+
+    /** @brief Node currently serving @p show_id (kNoNode if none). */
+    NodeId owner(ShowId show_id) const;
+
+    /** @brief Shows moved between nodes so far. */
+    std::size_t shows_moved() const { return moved_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Forwards one text protocol request line and appends the node's response.
+     * @return Close after "quit"; a failed node is answered with "ERR 0 cluster node unavailable".
+     */
+    CommandOutcome execute(std::string_view line, std::string& out);
+
+private:
+    struct Node;
+
+    /** @brief Stripes of the per-show request gate. */
+    static constexpr std::size_t kGateStripes = 256;
+
+    std::shared_mutex& gate(ShowId show_id) { return gates_[static_cast<std::size_t>(show_id.value()) % kGateStripes]; }
+
+    /** @brief Placement slot of @p show_id (nullptr for shows added to the catalog later). */
+    std::atomic<NodeId>* placement(ShowId show_id) const;
+
+    /** @brief Sends @p request to @p node and appends its response (up to its status line). */
+    ClusterStatus call(Node& node, std::string_view request, std::string& response);
+
+    /** @brief Moves @p show_id from @p from to @p to under the show's gate. */
+    ClusterStatus move_show(ShowId show_id, NodeId from, NodeId to);
+
+    /** @brief Moves every show whose owner differs on @p next, then installs @p next. */
+    ClusterStatus rebalance(const HashRing& next);
+
+    /** @brief Lowest connected node (kNoNode if none). */
+    NodeId any_node() const;
+
+    const BookingService& catalog_;
+    int virtual_nodes_;
+    std::mutex admin_mutex_;                                 /**< Serialises add_node / remove_node. */
+    HashRing ring_;                                          /**< Members (under admin_mutex_). */
+    std::shared_ptr<const HashRing> route_ring_;             /**< Ring for shows without a placement slot. */
+    std::array<std::unique_ptr<Node>, kMaxNodes> nodes_;     /**< Created on first add, never freed before the router. */
+    std::array<std::atomic<bool>, kMaxNodes> live_{};        /**< Members. */
+    std::unordered_map<ShowId, std::size_t> show_index_;     /**< Catalog shows at construction -> placement slot. */
+    std::unique_ptr<std::atomic<NodeId>[]> placements_;      /**< Node serving each indexed show. */
+    std::vector<ShowId> shows_;                              /**< Indexed shows, by slot. */
+    std::array<std::shared_mutex, kGateStripes> gates_;
+    std::atomic<std::size_t> moved_{0};
+};
+
+} // namespace booking
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "seat_scan.hpp"
+
+/**
+ * @file column_scan.hpp
+ * @brief Vectorised filter kernels over catalog columns (see BookingService::ShowColumns).
+ *
+ * Filters produce a selection bitmap with one bit per row (bit i of word i / 64), so
+ * predicates on several columns combine with word-wise ANDs and the matching rows are
+ * read back with count-trailing-zeros. Every kernel has a portable scalar version; the
+ * AVX2 version is selected once at start-up when the CPU supports it, and both return
+ * identical results.
+ */
+
+namespace booking {
+namespace column_scan {
+
+using seat_scan::Isa;
+
+/** @brief Words of a selection bitmap over @p rows rows. */
+inline std::size_t bitmap_words(std::size_t rows) {
+    return (rows + 63u) / 64u;
+}
+
+/**
+ * @brief One implementation of every kernel.
+ */
+struct Kernels {
+    Isa isa; /**< Instruction set the kernels use. */
+
+    /** @brief bits[0..bitmap_words(n)) = rows i with col[i] == value (unused tail bits cleared). */
+    void (*match_eq)(const std::int32_t* col, std::size_t n, std::int32_t value, std::uint64_t* bits);
+
+    /** @brief bits &= rows i with lo <= col[i] < hi. */
+    void (*and_range)(const std::int64_t* col, std::size_t n, std::int64_t lo, std::int64_t hi, std::uint64_t* bits);
+
+    /** @brief First i with col[i] == value, or @p n. */
+    std::size_t (*find_eq)(const std::int32_t* col, std::size_t n, std::int32_t value);
+
+    /** @brief bits[0..bitmap_words(n)) = rows i with col[i] >= value (unused tail bits cleared). */
+    void (*match_ge_u8)(const std::uint8_t* col, std::size_t n, std::uint8_t value, std::uint64_t* bits);
+};
+
+/** @brief Portable kernels (always available). */
+const Kernels& scalar_kernels();
+
+/** @brief AVX2 kernels, or nullptr if not compiled in or not supported by this CPU. */
+const Kernels* avx2_kernels();
+
+/** @brief Best kernels for the running CPU (chosen once, on first use). */
+const Kernels& kernels();
+
+} // namespace column_scan
+} // namespace booking
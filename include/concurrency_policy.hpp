@@ -0,0 +1,229 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+#include "backoff.hpp"
+#include "flat_combiner.hpp"
+#include "seat_mask.hpp"
+
+/**
+ * @file concurrency_policy.hpp
+ * @brief The seat booking core under interchangeable synchronisation strategies, for A/B
+ *        measurements against the atomic design of BookingService.
+ *
+ * BookingService books with a CAS loop per row word (see BookingService::try_acquire_word).
+ * PolicyShows runs the same all-or-nothing multi-row protocol on the same word layout with
+ * the strategy chosen by a policy type:
+ * - AtomicCasPolicy: lock-free CAS per word with ordered acquisition and rollback (the
+ *   BookingService design);
+ * - ShowMutexPolicy / ShowSpinlockPolicy: one std::mutex / test-and-test-and-set spinlock
+ *   per show around plain read-check-write;
+ * - ShowRwLockPolicy: one std::shared_mutex per show, readers share it;
+ * - FlatCombiningPolicy: one FlatCombiner per show applies every thread's requests.
+ *
+ * bench/concurrency_policy_bench.cpp compares them across thread counts, contention (how
+ * many shows the threads spread over) and read shares, so a deployment can pick on data.
+ * The service itself keeps the atomic design; the other strategies exist for measurement.
+ */
+
+namespace booking {
+
+/** @brief Synchronisation strategy of a PolicyShows. */
+enum class ConcurrencyPolicy : std::uint8_t {
+    AtomicCas,     /**< Lock-free CAS per row word. */
+    ShowMutex,     /**< std::mutex per show. */
+    ShowSpinlock,  /**< Spinlock per show. */
+    ShowRwLock,    /**< std::shared_mutex per show (shared readers). */
+    FlatCombining, /**< FlatCombiner per show. */
+};
+
+/** @brief Lowercase name of @p policy (e.g. "show_mutex"). */
+const char* to_string(ConcurrencyPolicy policy);
+
+/** @brief Test-and-test-and-set spinlock (spins on a load, backs off with pause instructions). */
+class Spinlock {
+public:
+    void lock() {
+        while (locked_.exchange(true, std::memory_order_acquire)) {
+            while (locked_.load(std::memory_order_relaxed)) cpu_relax();
+        }
+    }
+    bool try_lock() { return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire); }
+    void unlock() { locked_.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> locked_{false};
+};
+
+/** @brief Lock-free CAS per row word: no per-show lock. */
+struct AtomicCasPolicy {
+    static constexpr ConcurrencyPolicy kPolicy = ConcurrencyPolicy::AtomicCas;
+    static constexpr bool kLocked = false;
+    struct Lock {};
+};
+
+/** @brief Exclusive lock @p L per show for readers and writers. */
+template <typename L, ConcurrencyPolicy P>
+struct ExclusiveLockPolicy {
+    static constexpr ConcurrencyPolicy kPolicy = P;
+    static constexpr bool kLocked = true;
+    using Lock = L;
+
+    template <typename F>
+    static auto write(Lock& lock, F&& fn) {
+        std::lock_guard<Lock> guard(lock);
+        return fn();
+    }
+    template <typename F>
+    static auto read(Lock& lock, F&& fn) {
+        std::lock_guard<Lock> guard(lock);
+        return fn();
+    }
+};
+
+using ShowMutexPolicy = ExclusiveLockPolicy<std::mutex, ConcurrencyPolicy::ShowMutex>;
+using ShowSpinlockPolicy = ExclusiveLockPolicy<Spinlock, ConcurrencyPolicy::ShowSpinlock>;
+
+/** @brief std::shared_mutex per show: writers exclusive, readers shared. */
+struct ShowRwLockPolicy {
+    static constexpr ConcurrencyPolicy kPolicy = ConcurrencyPolicy::ShowRwLock;
+    static constexpr bool kLocked = true;
+    using Lock = std::shared_mutex;
+
+    template <typename F>
+    static auto write(Lock& lock, F&& fn) {
+        std::unique_lock<Lock> guard(lock);
+        return fn();
+    }
+    template <typename F>
+    static auto read(Lock& lock, F&& fn) {
+        std::shared_lock<Lock> guard(lock);
+        return fn();
+    }
+};
+
+/** @brief FlatCombiner per show: every request, reads included, is applied by the combiner. */
+struct FlatCombiningPolicy {
+    static constexpr ConcurrencyPolicy kPolicy = ConcurrencyPolicy::FlatCombining;
+    static constexpr bool kLocked = true;
+    using Lock = FlatCombiner;
+
+    template <typename F>
+    static auto write(Lock& lock, F&& fn) {
+        return lock.run(fn);
+    }
+    template <typename F>
+    static auto read(Lock& lock, F&& fn) {
+        return lock.run(fn);
+    }
+};
+
+/**
+ * @brief Seat words of a fixed set of shows, booked all-or-nothing under @p Policy.
+ *
+ * @tparam Policy AtomicCasPolicy, ShowMutexPolicy, ShowSpinlockPolicy, ShowRwLockPolicy or
+ *         FlatCombiningPolicy.
+ *
+ * @details
+ * Shows are numbered 0..show_count-1 and have @p rows words of 64 seats each. Each show
+ * (lock and word pointer) fills its own cache line, as a BookingService show state does.
+ */
+template <typename Policy>
+class PolicyShows {
+public:
+    PolicyShows(int show_count, int rows) : rows_(rows), shows_(new Show[static_cast<std::size_t>(show_count)]) {
+        for (int s = 0; s < show_count; ++s) {
+            Show& show = shows_[static_cast<std::size_t>(s)];
+            show.words.reset(new std::atomic<std::uint64_t>[static_cast<std::size_t>(rows)]);
+            for (int w = 0; w < rows; ++w) show.words[w].store(0u, std::memory_order_relaxed);
+        }
+    }
+
+    /** @brief Books @p seats of @p show if none of them is booked; false (nothing changed) otherwise. */
+    bool book(int show, const SeatMask& seats) {
+        Show& s = shows_[static_cast<std::size_t>(show)];
+        if constexpr (Policy::kLocked) {
+            return Policy::write(s.lock, [&] {
+                for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+                    if ((s.words[w].load(std::memory_order_relaxed) & seats.word(w)) != 0u) return false;
+                }
+                for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+                    s.words[w].store(s.words[w].load(std::memory_order_relaxed) | seats.word(w), std::memory_order_relaxed);
+                }
+                return true;
+            });
+        } else {
+            // Ascending words, rollback on the first conflict (BookingService::try_acquire_words)
+            for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+                const std::uint64_t bits = seats.word(w);
+                if (bits == 0u || acquire_word(s.words[w], bits)) continue;
+                for (int prev = seats.first_word(); prev < w; ++prev) {
+                    if (seats.word(prev) != 0u) s.words[prev].fetch_and(~seats.word(prev), std::memory_order_release);
+                }
+                return false;
+            }
+            return true;
+        }
+    }
+
+    /** @brief Frees @p seats of @p show. */
+    void cancel(int show, const SeatMask& seats) {
+        Show& s = shows_[static_cast<std::size_t>(show)];
+        if constexpr (Policy::kLocked) {
+            Policy::write(s.lock, [&] {
+                for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+                    s.words[w].store(s.words[w].load(std::memory_order_relaxed) & ~seats.word(w), std::memory_order_relaxed);
+                }
+                return true;
+            });
+        } else {
+            for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+                if (seats.word(w) != 0u) s.words[w].fetch_and(~seats.word(w), std::memory_order_release);
+            }
+        }
+    }
+
+    /** @brief Booked seats of @p show (a consistent count under the locked policies). */
+    int booked(int show) const {
+        const Show& s = shows_[static_cast<std::size_t>(show)];
+        const auto count = [&] {
+            int n = 0;
+            for (int w = 0; w < rows_; ++w) n += popcount64(s.words[w].load(std::memory_order_acquire));
+            return n;
+        };
+        if constexpr (Policy::kLocked) {
+            return Policy::read(s.lock, count);
+        } else {
+            return count();
+        }
+    }
+
+    int rows() const { return rows_; }
+
+private:
+    struct alignas(64) Show {
+        mutable typename Policy::Lock lock;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> words;
+    };
+
+    /** @brief CAS loop of one word (unbounded, so every policy completes every request). */
+    static bool acquire_word(std::atomic<std::uint64_t>& word, std::uint64_t bits) {
+        static const BackoffPolicy kUnbounded{0, 64, 16};
+        Backoff backoff(kUnbounded);
+        std::uint64_t current = word.load(std::memory_order_relaxed);
+        while (true) {
+            if ((current & bits) != 0u) return false;
+            if (word.compare_exchange_weak(current, current | bits, std::memory_order_acq_rel)) return true;
+            backoff.retry();
+        }
+    }
+
+    int rows_;
+    std::unique_ptr<Show[]> shows_;
+};
+
+} // namespace booking
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file crc32c.hpp
+ * @brief CRC-32C (Castagnoli), the checksum of journal records.
+ *
+ * Uses the SSE4.2 crc32 instruction (eight bytes per instruction) when the CPU has it,
+ * chosen once at run time, and a table-driven byte loop otherwise. Both give the same
+ * value, so files checksummed on one machine verify on any other.
+ */
+
+namespace booking {
+
+/**
+ * @brief CRC-32C of @p size bytes at @p data, continuing from @p crc (the result of the
+ *        previous piece, or 0 for the first).
+ */
+std::uint32_t crc32c(const void* data, std::size_t size, std::uint32_t crc = 0);
+
+/** @brief True if @ref crc32c uses the hardware instruction on this machine. */
+bool crc32c_hardware();
+
+} // namespace booking
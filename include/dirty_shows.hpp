@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @file dirty_shows.hpp
+ * @brief Bitmap of the shows whose seats changed since it was last drained.
+ *
+ * A writer marks its show after every successful seat update; a snapshot writer drains the
+ * bitmap and serialises only the marked shows. Marking loads the show's bit first and
+ * only writes the word if the bit is clear, so after the first change of a show in an
+ * interval its updates only read a line that stays shared in every core's cache.
+ */
+
+namespace booking {
+
+/**
+ * @brief Lock-free set of show ids in [0, capacity).
+ */
+class DirtyShows {
+public:
+    /** @brief Empty set of ids below @p capacity. */
+    explicit DirtyShows(std::size_t capacity)
+        : word_count_((capacity + 63u) / 64u), words_(new std::atomic<std::uint64_t>[word_count_]()) {}
+
+    /** @brief Adds @p id (ignored if out of range). Lock-free; wait-free when already marked. */
+    void mark(int id) {
+        const auto i = static_cast<std::size_t>(id) >> 6;
+        if (id < 0 || i >= word_count_) return;
+        const std::uint64_t bit = std::uint64_t{1} << (id & 63);
+        // Sequentially consistent with the seat CAS and the drain, so a change that finds its
+        // bit set is either seen by the drain that clears it or marks again after it
+        if ((words_[i].load() & bit) == 0u) words_[i].fetch_or(bit);
+    }
+
+    /** @brief Calls @p fn(id) for every marked id, ascending, removing it from the set. */
+    template <typename Fn>
+    void drain(Fn&& fn) {
+        for (std::size_t i = 0; i < word_count_; ++i) {
+            if (words_[i].load(std::memory_order_relaxed) == 0u) continue;
+            for (std::uint64_t bits = words_[i].exchange(0u); bits != 0u; bits &= bits - 1u) {
+                fn(static_cast<int>(i * 64u + static_cast<std::size_t>(__builtin_ctzll(bits))));
+            }
+        }
+    }
+
+    /** @brief Removes every id. */
+    void clear() {
+        drain([](int) {});
+    }
+
+private:
+    std::size_t word_count_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> words_;
+};
+
+} // namespace booking
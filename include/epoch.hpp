@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @file epoch.hpp
+ * @brief Epoch-based reclamation for read-mostly data published through atomic pointers.
+ *
+ * Readers bracket their accesses with an EpochManager::Guard, which only announces the
+ * current global epoch in the reader's own cache line: reads never block and never write
+ * shared state. A writer that replaces a published object retires the old one; it is
+ * freed once every reader that might still see it has left its guard.
+ *
+ * Domains whose writers retire often (e.g. a read cache republished on every change)
+ * defer retirees in a per-thread list and hand them over a batch at a time, so a retire
+ * takes no lock and writes no shared line until the batch is full; the cost is up to a
+ * batch of garbage per writing thread.
+ */
+
+namespace booking {
+
+/**
+ * @brief Epoch-based reclamation domain.
+ *
+ * @details
+ * Each thread uses one reader slot per domain, assigned on first use from a process-wide
+ * registry of kMaxThreads indices (released when the thread exits). Threads beyond that
+ * limit still work: they are counted in a shared overflow counter, which simply pauses
+ * reclamation while any of them is reading.
+ */
+class EpochManager {
+public:
+    /** @brief Number of per-thread reader slots. */
+    static constexpr std::size_t kMaxThreads = 256;
+
+    /**
+     * @brief Domain whose threads hand retirees over @p batch at a time (1 = at once).
+     * @note Threads without a reader slot always hand them over at once.
+     */
+    explicit EpochManager(std::size_t batch = 1);
+
+    /** @brief Frees all retired objects (no reader may be active). */
+    ~EpochManager();
+
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    /**
+     * @brief Read-side critical section; objects loaded inside stay alive until it ends.
+     *
+     * @details
+     * Guards nest. Wait-free: one store to the thread's own slot and a fence.
+     */
+    class Guard {
+    public:
+        explicit Guard(const EpochManager& domain);
+        ~Guard();
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        const EpochManager& domain_;
+        int slot_; /**< Reader slot, or -1 when counted as overflow. */
+    };
+
+    /**
+     * @brief Hands @p object over for deletion once no reader can hold it.
+     *
+     * @details
+     * Call after the object was unpublished. When the thread's batch is full (at once
+     * without batching), also attempts to reclaim earlier retirees.
+     */
+    template <typename T>
+    void retire(const T* object) {
+        retire_raw(const_cast<T*>(object), [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    /**
+     * @brief Hands the calling thread's deferred retirees over, then frees retired objects
+     *        that no reader can reach; returns how many.
+     */
+    std::size_t reclaim();
+
+    /** @brief Retired objects not freed yet (deferred ones included). */
+    std::size_t pending() const;
+
+    /** @brief Retirees a thread defers before handing them over. */
+    std::size_t batch() const { return batch_; }
+
+    /**
+     * @brief Process-wide index of the calling thread in [0, kMaxThreads), or -1 if none is free.
+     *
+     * @details
+     * Assigned on first use and released when the thread exits; other per-thread structures
+     * (ObjectPool caches) key on it too.
+     */
+    static int thread_index();
+
+private:
+    struct Retired {
+        void* object;
+        void (*deleter)(void*);
+        std::uint64_t epoch; /**< Global epoch when it was retired. */
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> epoch{0}; /**< Announced epoch; 0 = not reading. */
+        int depth = 0;                       /**< Guard nesting (owner thread only). */
+        std::vector<Retired> deferred;       /**< Retirees not handed over yet (owner thread only). */
+        std::atomic<std::size_t> deferred_count{0}; /**< Size of @ref deferred, for @ref pending. */
+    };
+
+    void retire_raw(void* object, void (*deleter)(void*));
+
+    /** @brief Moves @p slot's deferred retirees to @ref retired_ and advances the epoch past them. */
+    void hand_over(Slot& slot);
+
+    std::size_t batch_;
+    std::atomic<std::uint64_t> global_{1};              /**< Current epoch (never 0). */
+    std::unique_ptr<Slot[]> slots_;                      /**< One slot per registered thread. */
+    mutable std::atomic<std::uint32_t> overflow_readers_{0}; /**< Readers without a slot. */
+    mutable std::mutex retired_mutex_;                   /**< Protects retired_. */
+    std::vector<Retired> retired_;                       /**< Awaiting reclamation. */
+};
+
+} // namespace booking
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "mpsc_queue.hpp"
+
+/**
+ * @file flat_combiner.hpp
+ * @brief Flat combining: one thread applies the requests every waiting thread published.
+ *
+ * When many threads update the same cache line, each CAS steals the line from the last
+ * writer and most of them fail, so throughput falls as threads are added. With flat
+ * combining a thread publishes its request in a list and whichever thread holds the
+ * combiner lock applies all published requests in one pass, in arrival order, while the
+ * others wait for their result. The line stays in the combiner's cache and each pass
+ * amortises the lock over all requests queued meanwhile, so throughput grows with the
+ * number of waiting threads instead of collapsing.
+ *
+ * Unlike ShowExecutor there is no dedicated thread: the combiner is whichever caller got
+ * the lock, so an idle combiner costs nothing.
+ */
+
+namespace booking {
+
+/**
+ * @brief Serialises calls through a publication list applied by a rotating combiner.
+ *
+ * @details
+ * @ref run may be called from any thread, including from inside a request this combiner
+ * is applying (the nested call runs inline).
+ */
+class FlatCombiner {
+public:
+    FlatCombiner() = default;
+    FlatCombiner(const FlatCombiner&) = delete;
+    FlatCombiner& operator=(const FlatCombiner&) = delete;
+
+    /**
+     * @brief Runs @p fn under the combiner (possibly on another thread) and returns its result.
+     *
+     * @details
+     * The calls of all threads are applied one at a time, in the order they were published.
+     * The result type must be default-constructible.
+     */
+    template <typename F>
+    auto run(F&& fn) -> decltype(fn()) {
+        using Result = decltype(fn());
+        if (current_ == this) return fn();
+
+        struct Call final : Request {
+            std::remove_reference_t<F>* fn;
+            Result result{};
+        } call;
+        call.fn = &fn;
+        call.invoke = [](Request* r) {
+            Call* c = static_cast<Call*>(r);
+            c->result = (*c->fn)();
+        };
+        publish(call);
+        return std::move(call.result);
+    }
+
+    /** @brief Combining passes that applied at least one request so far. */
+    std::uint64_t passes() const { return passes_.load(std::memory_order_relaxed); }
+
+    /** @brief Requests applied so far (requests / passes = mean batch). */
+    std::uint64_t requests() const { return requests_.load(std::memory_order_relaxed); }
+
+private:
+    /** @brief Type-erased call living on the publisher's stack. */
+    struct Request : MpscNode {
+        void (*invoke)(Request*) = nullptr;
+        std::atomic<bool> done{false};
+    };
+
+    /** @brief Queues @p request and returns once some combiner (maybe this thread) applied it. */
+    void publish(Request& request);
+
+    /** @brief Applies the reachable requests (up to a pass limit); the caller holds @ref busy_. */
+    void combine();
+
+    MpscQueue published_;
+    alignas(64) std::atomic<bool> busy_{false}; /**< Combiner lock. */
+    std::atomic<std::uint64_t> passes_{0};
+    std::atomic<std::uint64_t> requests_{0};
+
+    /** @brief Combiner the calling thread is applying requests of (nullptr = none). */
+    static thread_local const FlatCombiner* current_;
+};
+
+} // namespace booking
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @file geo.hpp
+ * @brief Great-circle distances and the fixed grid used by the theater location index.
+ *
+ * The grid splits latitude and longitude into kGeoCellDegrees cells. A radius query visits
+ * the cells of the query's bounding box (wrapping at the antimeridian) and filters the
+ * candidates by exact distance.
+ */
+
+namespace booking {
+
+/** @brief Mean Earth radius used for distances. */
+constexpr double kEarthRadiusKm = 6371.0088;
+
+/** @brief Cell edge of the location grid (about 11 km of latitude). */
+constexpr double kGeoCellDegrees = 0.1;
+
+/** @brief Grid cells per latitude column and per longitude row. */
+constexpr int kGeoLatCells = 1800;
+constexpr int kGeoLonCells = 3600;
+
+/** @brief Degrees to radians. */
+constexpr double kRadiansPerDegree = 3.14159265358979323846 / 180.0;
+
+/** @brief Haversine distance in kilometres between two WGS84 points given in degrees. */
+inline double distance_km(double lat1, double lon1, double lat2, double lon2) {
+    const double dlat = (lat2 - lat1) * kRadiansPerDegree;
+    const double dlon = (lon2 - lon1) * kRadiansPerDegree;
+    const double a = std::sin(dlat / 2) * std::sin(dlat / 2)
+                     + std::cos(lat1 * kRadiansPerDegree) * std::cos(lat2 * kRadiansPerDegree) * std::sin(dlon / 2)
+                           * std::sin(dlon / 2);
+    return 2.0 * kEarthRadiusKm * std::asin(std::sqrt(a < 1.0 ? a : 1.0));
+}
+
+/** @brief Latitude row of the grid (clamped to the poles). */
+inline int geo_lat_cell(double lat) {
+    const int c = static_cast<int>(std::floor((lat + 90.0) / kGeoCellDegrees));
+    return c < 0 ? 0 : (c >= kGeoLatCells ? kGeoLatCells - 1 : c);
+}
+
+/** @brief Longitude column of the grid (wrapped into [0, kGeoLonCells)). */
+inline int geo_lon_cell(double lon) {
+    const int c = static_cast<int>(std::floor((lon + 180.0) / kGeoCellDegrees)) % kGeoLonCells;
+    return c < 0 ? c + kGeoLonCells : c;
+}
+
+/** @brief Hash key of a grid cell. */
+inline std::uint32_t geo_cell_key(int lat_cell, int lon_cell) {
+    return static_cast<std::uint32_t>(lat_cell) * kGeoLonCells + static_cast<std::uint32_t>(lon_cell);
+}
+
+/**
+ * @brief Grid cells covering a radius: latitude rows [lat_first, lat_last] times
+ *        lon_count longitude columns starting at lon_first (modulo kGeoLonCells).
+ */
+struct GeoCellRange {
+    int lat_first;
+    int lat_last;
+    int lon_first;
+    int lon_count;
+
+    /** @brief Number of cells in the range. */
+    std::uint64_t size() const {
+        return static_cast<std::uint64_t>(lat_last - lat_first + 1) * static_cast<std::uint64_t>(lon_count);
+    }
+};
+
+/** @brief Cells of the bounding box of the circle of @p radius_km around (lat, lon). */
+inline GeoCellRange geo_cells_within(double lat, double lon, double radius_km) {
+    const double dlat = radius_km / (kEarthRadiusKm * kRadiansPerDegree);
+    const double lat_lo = lat - dlat;
+    const double lat_hi = lat + dlat;
+    GeoCellRange r{geo_lat_cell(lat_lo), geo_lat_cell(lat_hi), 0, kGeoLonCells};
+    if (lat_lo <= -90.0 || lat_hi >= 90.0) return r; // the circle contains a pole
+    // Longitude degrees per km grow towards the poles: use the box edge closest to one
+    const double edge = std::fabs(lat_lo) > std::fabs(lat_hi) ? std::fabs(lat_lo) : std::fabs(lat_hi);
+    const double dlon = dlat / std::cos(edge * kRadiansPerDegree);
+    if (dlon >= 180.0) return r;
+    const int span = static_cast<int>(std::ceil(2.0 * dlon / kGeoCellDegrees)) + 1;
+    if (span >= kGeoLonCells) return r;
+    r.lon_first = geo_lon_cell(lon - dlon);
+    r.lon_count = span;
+    return r;
+}
+
+} // namespace booking
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "seat_label.hpp"
+
+/**
+ * @file hall_layout.hpp
+ * @brief Seat map geometry (rows, seats per row, labels) shared by shows.
+ *
+ * A hall layout describes how seats are arranged and labelled. Each row is mapped onto
+ * exactly one 64-bit booking word, so a seat is addressed by a *seat index*:
+ *
+ *     seat index = row * 64 + column   (column is zero-based)
+ *
+ * This keeps the common "book seats in one row" request on a single atomic word while
+ * allowing halls of up to 64 rows x 64 seats. Seat labels are the row prefix followed by
+ * the one-based column number (e.g. "a1", "c12", "aa7"), unless the layout uses another
+ * label grammar ("12c", "balc-3"; see seat_label::LabelGrammar).
+ */
+
+namespace booking {
+
+/**
+ * @brief Layout identifier type (index into the service layout table).
+ */
+using LayoutId = int;
+
+/**
+ * @brief Description of one row of seats.
+ */
+struct RowSpec {
+    std::string label;    /**< Row prefix used in seat labels (1-6 letters, e.g. "a", "bb"). */
+    int seats;            /**< Number of seats in the row, in [1..64]. */
+};
+
+class SeatMask;
+
+/**
+ * @brief Seats sold at one price (see HallLayout::set_price_tiers).
+ */
+struct PriceTier {
+    std::string name;                   /**< Display name (e.g. "premium"). */
+    std::uint32_t price = 0;            /**< Price of each seat, in the smallest currency unit. */
+    std::array<std::uint64_t, 64> seats{}; /**< Seat bits by row, as in a booking word (one word per row). */
+};
+
+/**
+ * @brief Accessible seating overlays of a layout (see HallLayout::set_seat_categories).
+ *
+ * @details
+ * Both masks are seat bits by row, as in a booking word. Category seats are kept out of
+ * the automatic searches (book_best_available and friends) and are booked by naming
+ * them. A companion seat may only be booked when a wheelchair space next to it in the
+ * same row is booked as well, by the same request or an earlier one.
+ */
+struct SeatCategories {
+    std::array<std::uint64_t, 64> wheelchair{}; /**< Wheelchair spaces. */
+    std::array<std::uint64_t, 64> companion{};  /**< Companion seats; each must neighbour a wheelchair space. */
+};
+
+/**
+ * @brief Immutable seat map geometry of a hall.
+ *
+ * @details
+ * Row labels are matched case-insensitively and stored lower-case.
+ * The default sample layout is a single row "a" with 20 seats ("a1".."a20").
+ */
+class HallLayout {
+public:
+    /** @brief Maximum number of rows (one booking word per row). */
+    static constexpr int kMaxRows = 64;
+
+    /** @brief Maximum number of seats in a single row (bits in a booking word). */
+    static constexpr int kMaxRowSeats = 64;
+
+    /**
+     * @brief Builds a layout from explicit row descriptions.
+     *
+     * @param rows Rows in front-to-back order.
+     * @param grammar How seat labels combine row prefix and seat number (parsing and
+     *        formatting both use the grammar's specialised seat_label::split_as / format_as).
+     * @throws std::invalid_argument if there are no rows, too many rows, a row width is
+     *         out of range, or a row label is empty, longer than 6 letters, non-alphabetic
+     *         or duplicated.
+     */
+    explicit HallLayout(std::vector<RowSpec> rows,
+                        seat_label::LabelGrammar grammar = seat_label::LabelGrammar::RowSeat);
+
+    /**
+     * @brief Creates a single-row layout "a1".."aN".
+     * @param seats Number of seats in [1..64].
+     */
+    static HallLayout single_row(int seats);
+
+    /**
+     * @brief Creates a rectangular layout with rows labelled "a".."z","aa","ab",...
+     * @param rows Number of rows in [1..64].
+     * @param seats_per_row Number of seats per row in [1..64].
+     * @param grammar Label grammar (see the constructor).
+     */
+    static HallLayout uniform(int rows, int seats_per_row,
+                              seat_label::LabelGrammar grammar = seat_label::LabelGrammar::RowSeat);
+
+    /** @brief Grammar of this layout's seat labels. */
+    seat_label::LabelGrammar label_grammar() const { return grammar_; }
+
+    /** @brief Number of rows (and booking words). */
+    int row_count() const { return static_cast<int>(rows_.size()); }
+
+    /** @brief Total number of seats over all rows. */
+    int seat_count() const { return seat_count_; }
+
+    /** @brief Number of seats in @p row. */
+    int row_seats(int row) const { return rows_[static_cast<std::size_t>(row)].seats; }
+
+    /** @brief Lower-case label prefix of @p row. */
+    const std::string& row_label(int row) const { return rows_[static_cast<std::size_t>(row)].label; }
+
+    /** @brief Bits of the booking word of @p row that correspond to existing seats. */
+    std::uint64_t row_mask(int row) const { return row_masks_[static_cast<std::size_t>(row)]; }
+
+    /** @brief row_mask of every row, row_count() entries (for the seat_words loops). */
+    const std::uint64_t* row_masks() const { return row_masks_.data(); }
+
+    /** @brief Converts (row, column) to a seat index. */
+    static int seat_index(int row, int col) { return row * kMaxRowSeats + col; }
+
+    /** @brief Row (booking word) of a seat index. */
+    static int row_of(int seat) { return seat / kMaxRowSeats; }
+
+    /** @brief Column (bit within the booking word) of a seat index. */
+    static int col_of(int seat) { return seat % kMaxRowSeats; }
+
+    /**
+     * @brief Preference score of @p n adjacent seats starting at (@p row, @p start); lower is better.
+     *
+     * @details
+     * Sum of the distances (in half seats) of the row from the middle row and of the run's
+     * centre from the middle of its row, so the centre of the hall scores 0. The row part
+     * comes from a table computed at construction.
+     */
+    int run_cost(int row, int start, int n) const {
+        const int offset = 2 * start + n - row_seats(row);
+        return row_cost_[static_cast<std::size_t>(row)] + (offset < 0 ? -offset : offset);
+    }
+
+    /** @brief Row part of @ref run_cost: the least cost of any run in @p row. */
+    int row_cost(int row) const { return row_cost_[static_cast<std::size_t>(row)]; }
+
+    /**
+     * @brief Assigns seats to price tiers.
+     *
+     * @details
+     * Tiers are kept sorted by price; tiers of equal price form one *price level*. For each
+     * level the layout stores the union of the seats of that level and all cheaper ones,
+     * one word per row, so "n adjacent seats at most this price" is the free words ANDed
+     * with one level mask. Seats in no tier are not sold by the price-aware searches. A
+     * layout without tiers prices every seat at 0. Set tiers before adding the layout to
+     * a service.
+     *
+     * @throws std::invalid_argument if a tier names a seat the layout does not have or
+     *         two tiers share a seat.
+     */
+    void set_price_tiers(std::vector<PriceTier> tiers);
+
+    /** @brief Tiers in ascending price order (empty: every seat costs 0). */
+    const std::vector<PriceTier>& price_tiers() const { return tiers_; }
+
+    /** @brief Number of distinct tier prices (0 without tiers). */
+    int price_levels() const { return static_cast<int>(level_prices_.size()); }
+
+    /** @brief Price of level @p level (ascending with the level). */
+    std::uint32_t level_price(int level) const { return level_prices_[static_cast<std::size_t>(level)]; }
+
+    /** @brief Seats priced at most level_price(@p level), row_count() words. */
+    const std::uint64_t* level_seats(int level) const {
+        return level_words_.data() + static_cast<std::size_t>(level) * rows_.size();
+    }
+
+    /** @brief Highest level priced at most @p max_price, or -1 if every tier costs more. */
+    int level_at_most(std::uint32_t max_price) const;
+
+    /**
+     * @brief Total price of @p seats (0 for seats in no tier).
+     */
+    std::uint64_t price_of(const SeatMask& seats) const;
+
+    /**
+     * @brief Sets the wheelchair and companion overlays (replacing earlier ones).
+     *
+     * @details
+     * Set them before adding the layout to a service.
+     * @throws std::invalid_argument if a category names a seat the layout does not have,
+     *         a seat is in both categories, or a companion seat has no wheelchair space
+     *         next to it.
+     */
+    void set_seat_categories(const SeatCategories& categories);
+
+    /** @brief Current overlays (all zero by default). */
+    const SeatCategories& seat_categories() const { return categories_; }
+
+    /** @brief True if any seat has a category (the booking CAS then checks the companion rule). */
+    bool has_seat_categories() const { return has_categories_; }
+
+    /** @brief row_masks() without the category seats: what the automatic searches may pick. */
+    const std::uint64_t* open_row_masks() const { return open_row_masks_.data(); }
+
+    /**
+     * @brief True if setting @p req in row @p row, leaving the row word at @p after, keeps
+     *        every requested companion seat next to a booked wheelchair space.
+     */
+    bool companion_rule_ok(int row, std::uint64_t req, std::uint64_t after) const {
+        const std::uint64_t companions = req & categories_.companion[static_cast<std::size_t>(row)];
+        if (companions == 0u) return true;
+        const std::uint64_t spaces = after & categories_.wheelchair[static_cast<std::size_t>(row)];
+        return (companions & ~neighbours(row, spaces)) == 0u;
+    }
+
+    /**
+     * @brief Places aisles inside rows.
+     *
+     * @details
+     * Bit c of @p after[r] puts an aisle between seats c and c+1 (zero-based) of row r, so
+     * they are no longer neighbours: the automatic searches do not pick a run across the
+     * aisle and a companion seat does not count as next to a wheelchair space across it.
+     * Seat indices and labels are unchanged. For each run length the layout then stores
+     * the run starts that have no aisle inside (@ref block_starts), so the searches filter
+     * a row's candidates with one AND. Set aisles before seat categories and before adding
+     * the layout to a service.
+     *
+     * @throws std::invalid_argument if a bit has no seat on both sides.
+     */
+    void set_aisles(const std::array<std::uint64_t, kMaxRows>& after);
+
+    /** @brief Aisle bits by row (see @ref set_aisles). */
+    const std::array<std::uint64_t, kMaxRows>& aisles() const { return aisles_; }
+
+    /** @brief True if some row has an aisle. */
+    bool has_aisles() const { return !block_starts_.empty(); }
+
+    /** @brief Bits c of row @p row such that seats c and c+1 exist and sit side by side. */
+    std::uint64_t adjacent(int row) const { return adjacent_[static_cast<std::size_t>(row)]; }
+
+    /** @brief Seats of row @p row next to a seat of @p seats (across no aisle). */
+    std::uint64_t neighbours(int row, std::uint64_t seats) const {
+        const std::uint64_t adj = adjacent(row);
+        return ((seats & adj) << 1) | ((seats >> 1) & adj);
+    }
+
+    /**
+     * @brief Starts c of row @p row such that seats c .. c+n-1 exist and form one block
+     *        (no aisle inside); a table lookup on layouts with aisles.
+     * @param n Run length in [1..64].
+     */
+    std::uint64_t block_starts(int row, int n) const;
+
+    /**
+     * @brief Forbids (or allows again) bookings that leave a single free seat between
+     *        booked seats or between a booked seat and the row end.
+     *
+     * @details
+     * Enforced by the booking CAS on the word it replaces: a booking may not create an
+     * isolated free seat (seat_runs.hpp, isolated_seats), so gaps that existed before, or
+     * that a cancellation opens, do not block the row. The automatic searches skip runs
+     * that would leave one. Seats of different rows are not neighbours.
+     */
+    void set_forbid_single_gaps(bool on) { forbid_single_gaps_ = on; }
+
+    /** @brief True if bookings must not leave single-seat gaps. */
+    bool forbids_single_gaps() const { return forbid_single_gaps_; }
+
+    /** @brief True if bookings check a rule in their CAS (seat categories or single gaps). */
+    bool has_booking_rules() const { return has_categories_ || forbid_single_gaps_; }
+
+    /** @brief True if @p seat addresses an existing seat of this layout. */
+    bool contains(int seat) const;
+
+    /**
+     * @brief Parses a seat label (e.g. "c12") into a seat index.
+     *
+     * @param label Input label: row prefix (case-insensitive) and 1-based seat number, in
+     *        the layout's label grammar.
+     * @param out_seat Output seat index on success.
+     * @return True if the label names an existing seat; false otherwise.
+     *
+     * @details
+     * Non-throwing and allocation-free: one call of the grammar's parser
+     * (seat_label::split_as, chosen at construction); the row is matched by comparing
+     * precomputed row codes.
+     */
+    bool try_parse_label(std::string_view label, int& out_seat) const;
+
+    /**
+     * @brief @ref try_parse_label on a label already split into its row code and number
+     *        (see seat_label::split_as, seat_label::scan_list).
+     */
+    bool try_seat(std::uint32_t code, int num, int& out_seat) const;
+
+    /**
+     * @brief Translation table to @p to by label: for every seat index of this layout
+     *        (row_count() * kMaxRowSeats entries), the index of the seat of @p to with the
+     *        same label, or -1 (also for indices that are not seats here).
+     */
+    std::vector<int> translate_to(const HallLayout& to) const;
+
+    /**
+     * @brief Formats a seat index as a label (e.g. "c12", in the layout's grammar).
+     * @param seat A seat index contained in this layout.
+     */
+    std::string label(int seat) const { return std::string(label_view(seat)); }
+
+    /**
+     * @brief Label of @p seat as a view into the layout's label table.
+     *
+     * @details
+     * All labels are rendered once at construction into one contiguous buffer, so this is
+     * two table loads. The view lives as long as the layout.
+     *
+     * @param seat A seat index contained in this layout.
+     */
+    std::string_view label_view(int seat) const {
+        const std::size_t dense = row_first_[static_cast<std::size_t>(row_of(seat))] + static_cast<std::size_t>(col_of(seat));
+        return std::string_view(label_chars_.data() + label_offsets_[dense],
+                                static_cast<std::size_t>(label_offsets_[dense + 1] - label_offsets_[dense]));
+    }
+
+    /**
+     * @brief Writes the labels of the seats set in @p words (row-major, @p separator between
+     *        labels) to @p out and returns the end of the written bytes.
+     *
+     * @details
+     * Bits of nonexistent seats are ignored. @p out needs room for
+     * @ref max_rendered_size bytes; nothing is allocated.
+     *
+     * @param words One word per row, @p word_count of them (at most row_count()).
+     */
+    char* render_labels(const std::uint64_t* words, int word_count, char separator, char* out) const;
+
+    /** @brief Upper bound of the bytes @ref render_labels writes (every seat set). */
+    std::size_t max_rendered_size() const { return label_chars_.size() + static_cast<std::size_t>(seat_count_); }
+
+    /**
+     * @brief Generates the label of the n-th row ("a".."z","aa",...), zero-based.
+     */
+    static std::string row_label_for(int row);
+
+private:
+    std::vector<RowSpec> rows_; /**< Row descriptions (labels normalised to lower-case). */
+    seat_label::LabelGrammar grammar_ = seat_label::LabelGrammar::RowSeat; /**< Label grammar. */
+    seat_label::SplitFn split_ = &seat_label::split_as<seat_label::RowSeat>; /**< Parser of grammar_. */
+    std::array<std::uint32_t, kMaxRows> row_codes_{}; /**< seat_label::row_code of each row label. */
+    int seat_count_ = 0;        /**< Cached total seat count. */
+    bool sequential_codes_ = true; /**< Row r is labelled row_label_for(r) for every row. */
+    std::array<std::uint64_t, kMaxRows> row_masks_{}; /**< Existing-seat bits of each row word. */
+    std::array<std::uint64_t, kMaxRows> open_row_masks_{}; /**< row_masks_ minus category seats. */
+    SeatCategories categories_;     /**< Wheelchair and companion overlays. */
+    bool has_categories_ = false;   /**< Some overlay bit is set. */
+    bool forbid_single_gaps_ = false; /**< Bookings may not leave isolated free seats. */
+    std::array<std::uint64_t, kMaxRows> aisles_{};   /**< Aisle after seat c of each row. */
+    std::array<std::uint64_t, kMaxRows> adjacent_{}; /**< Seat c and c+1 are neighbours. */
+    std::vector<std::uint64_t> block_starts_;   /**< With aisles: row_count() x 64 block starts, by run length - 1. */
+    std::array<std::uint16_t, kMaxRows> row_cost_{}; /**< Row part of run_cost (distance from the middle row). */
+    std::array<std::uint16_t, kMaxRows> row_first_{}; /**< Dense number (row-major) of each row's first seat. */
+    std::string label_chars_;                   /**< Every seat label, back to back, row-major. */
+    std::vector<std::uint16_t> label_offsets_;  /**< seat_count + 1 offsets into label_chars_. */
+    std::vector<PriceTier> tiers_;              /**< Price tiers, ascending price. */
+    std::vector<std::uint32_t> level_prices_;   /**< Distinct tier prices, ascending. */
+    std::vector<std::uint64_t> level_words_;    /**< Cumulative seats of each level, row_count() words each. */
+};
+
+} // namespace booking
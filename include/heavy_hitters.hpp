@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "thread_shards.hpp"
+
+/**
+ * @file heavy_hitters.hpp
+ * @brief Streaming top-K of frequent keys (Space-Saving), sharded per recording thread.
+ *
+ * Each recording thread owns a small set-associative Space-Saving sketch: a key hashes to
+ * one set of kWays counters; a hit increments its counter, a miss replaces the set's
+ * smallest counter c with the new key at c + weight, remembering c as the key's possible
+ * overcount. The owning thread is the only writer (see thread_shards.hpp), and readers
+ * merge all shards on demand.
+ *
+ * On one thread, a key with more than 1/kWays of the weight recorded into its set is
+ * always tracked, and a tracked key's true weight lies in [count - error, count]. Merged
+ * counts sum the threads that still track a key, so a key spread thinly over many threads
+ * can come out low; the hot keys this is meant for dominate their sets everywhere. Reads
+ * while writers run may pair a counter with the key that just replaced it, so a
+ * concurrent top() is approximate on top of the sketch's own error.
+ */
+
+namespace booking {
+
+class HeavyHitters {
+public:
+    /** @brief Counters per set. */
+    static constexpr std::size_t kWays = 8;
+    /** @brief Sets per thread (kSets * kWays keys tracked per thread). */
+    static constexpr std::size_t kSets = 32;
+
+    /** @brief Merged estimate of one key. */
+    struct Item {
+        std::int64_t key = -1;
+        std::uint64_t count = 0; /**< Estimated weight (sum over the threads tracking the key). */
+        std::uint64_t error = 0; /**< Maximum overestimate of @ref count. */
+    };
+
+    HeavyHitters() = default;
+
+    HeavyHitters(const HeavyHitters&) = delete;
+    HeavyHitters& operator=(const HeavyHitters&) = delete;
+
+    /** @brief Records @p weight occurrences of @p key (a non-negative key). */
+    void add(std::int64_t key, std::uint64_t weight = 1);
+
+    /** @brief The @p k keys of largest merged count, largest first (ties by key). */
+    std::vector<Item> top(std::size_t k) const;
+
+private:
+    struct Counter {
+        std::atomic<std::int64_t> key{-1}; /**< -1 = free. */
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> error{0};
+    };
+
+    /** @brief One recording thread's sketch. */
+    struct alignas(64) Shard {
+        std::array<std::array<Counter, kWays>, kSets> sets;
+    };
+
+    ThreadShards<Shard> shards_;
+};
+
+} // namespace booking
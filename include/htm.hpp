@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "seat_mask.hpp"
+
+/**
+ * @file htm.hpp
+ * @brief Hardware transactional memory fast path for multi-row bookings.
+ *
+ * A booking of several rows takes one CAS per row in ascending order and rolls the taken
+ * rows back on a conflict (BookingService::try_acquire_words). On CPUs with Intel RTM the
+ * same all-or-nothing update can run as one hardware transaction: every word is checked
+ * and written inside it, and the commit makes all rows visible at once. A transaction may
+ * abort for reasons the caller cannot control (interrupts, capacity, another thread
+ * touching a line), so it is only a fast path: callers retry a few times and then fall
+ * back to the lock-free protocol, which stays correct against concurrent transactions
+ * (a transactional write to a word aborts or orders against any CAS on it).
+ *
+ * Support is detected at run time (CPUID); builds for other architectures compile the
+ * portable stub, which reports Unsupported.
+ */
+
+namespace booking {
+namespace htm {
+
+/** @brief Outcome of one transactional attempt. */
+enum class Outcome : std::uint8_t {
+    Committed,   /**< All requested bits were set in one transaction. */
+    Conflict,    /**< A requested bit was already set; nothing changed. */
+    Aborted,     /**< The transaction aborted (retry, or fall back); nothing changed. */
+    Unsupported, /**< No RTM on this CPU or build; nothing changed. */
+};
+
+/** @brief Lowercase name of @p outcome (e.g. "committed"). */
+const char* to_string(Outcome outcome);
+
+/** @brief True if RTM transactions can run here (compiled in and reported by the CPU). */
+bool supported();
+
+/**
+ * @brief Sets the bits of @p req in @p words (word w of the mask -> words[w]) in one
+ *        transaction if none of them is set.
+ *
+ * @param out_old On Committed, the replaced value of each word of the mask's range.
+ */
+Outcome or_words(std::atomic<std::uint64_t>* words, const SeatMask& req, std::uint64_t* out_old);
+
+} // namespace htm
+} // namespace booking
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "booking_service.hpp"
+#include "rate_limiter.hpp"
+#include "show_routes.hpp"
+#include "text_protocol.hpp"
+
+/**
+ * @file http_gateway.hpp
+ * @brief HTTP/1.1 gateway to a BookingService, served by BookingServer next to the text
+ *        and binary protocols.
+ *
+ * Endpoints (JSON responses):
+ *
+ *     GET  /movies                               ->  200 [{"id":1,"title":"Inception"},...]
+ *     GET  /movies/<movie_id>/theaters           ->  200 [{"id":1,"name":"Downtown"},...]
+ *     GET  /shows/<movie_id>/<theater_id>/seats  ->  200 {"free":18,"seats":"a1 a2 ..."}
+ *     POST /shows/<movie_id>/<theater_id>/book   ->  201 {"booking_id":17}
+ *
+ * With a live config (HttpCommandHandler::set_live_config) the tunables can be changed too:
+ *
+ *     GET  /admin/config                         ->  200 {"version":3,"backoff_max_retries":256,...}
+ *     PUT  /admin/config                         ->  200 {"version":4}   (body: config text)
+ *
+ * The body of a book request is the seat label list ("a1 a2", BookingService::book_label_list).
+ * A failed booking answers {"status":<BookingStatus value>,"error":"..."} with a matching
+ * HTTP status (409 for seats already booked, 429 when throttled, ...); other errors answer
+ * {"error":"..."}.
+ *
+ * Connections are persistent: HTTP/1.1 keeps them open unless a request says
+ * "Connection: close", HTTP/1.0 only if it says "Connection: keep-alive". Requests may be
+ * pipelined; their responses are appended in order. Bodies need a Content-Length (chunked
+ * requests are refused). HTTP/2 is not spoken: a prior-knowledge HTTP/2 preface is answered
+ * 505 and the connection closed; an "Upgrade: h2c" header is ignored.
+ */
+
+namespace booking {
+
+/**
+ * @brief Executes pipelined HTTP/1.1 requests against a service.
+ *
+ * @details
+ * The catalog endpoints (/movies, /movies/<id>/theaters) only change with the catalog, so
+ * their responses are kept in memory keyed by path and answered with a copy of the cached
+ * header and body while BookingService::catalog_version is unchanged; the first request
+ * after a catalog update clears the cache. Seat maps and bookings always go to the service
+ * (shows named by movie and theater are routed through a ShowRoutes cache). One handler
+ * per thread, like TextCommandHandler.
+ */
+class HttpCommandHandler {
+public:
+    /** @brief Cached catalog responses at which the cache is cleared (bounds ids probed by clients). */
+    static constexpr std::size_t kMaxCachedResponses = 4096;
+
+    explicit HttpCommandHandler(BookingService& service) : service_(service), routes_(service) {}
+
+    /**
+     * @brief Executes the complete requests in @p data and appends the responses to @p out.
+     *
+     * @details
+     * Stops early once @p out holds @p out_limit bytes, and after a request that closes the
+     * connection (@p outcome is then Close).
+     * @return Bytes consumed, or -1 on a malformed or oversized request (an error response
+     *         was appended; the connection should close after sending it).
+     */
+    std::ptrdiff_t execute(const char* data, std::size_t size, std::string& out, CommandOutcome& outcome,
+                           std::size_t out_limit = static_cast<std::size_t>(-1));
+
+    /** @brief Longest request head and body accepted (413/431 beyond it; default 64 KiB). */
+    void set_max_request(std::size_t bytes) { max_request_ = bytes; }
+
+    /** @brief Charges the following requests to @p client's bucket of @p limiter (nullptr = unlimited). */
+    void set_client(std::uint64_t client, ClientRateLimiter* limiter) {
+        client_ = client;
+        limiter_ = limiter;
+    }
+
+    /** @brief Serves /admin/config from @p config (nullptr = no admin endpoint, 404). */
+    void set_live_config(LiveConfig* config) { config_ = config; }
+
+    /** @brief Answers book requests with ReadOnlyReplica (403). */
+    void set_read_only(bool read_only) { read_only_ = read_only; }
+
+    /** @brief Catalog requests answered from the response cache. */
+    std::uint64_t cache_hits() const { return cache_hits_; }
+
+    /** @brief Catalog requests that had to render their response. */
+    std::uint64_t cache_misses() const { return cache_misses_; }
+
+private:
+    /** @brief Cached response: status line and headers up to (excluding) the connection header, and body. */
+    struct CachedResponse {
+        std::string head;
+        std::string body;
+    };
+
+    /** @brief Appends the response to one parsed request. */
+    void respond(std::string_view method, std::string_view path, std::string_view body, bool keep_alive,
+                 bool announce_keep_alive, std::string& out);
+
+    /** @brief Appends the cached response for @p path, rendering it on a miss; false if @p path is no catalog path. */
+    bool respond_cached(std::string_view path, bool keep_alive, bool announce_keep_alive, std::string& out);
+
+    /** @brief Renders a catalog endpoint's body; false if @p path names none. */
+    bool render_catalog(std::string_view path, std::string& body) const;
+
+    void seats(BookingService::ShowHandle& show, std::string& body, int& status);
+    void book(BookingService::ShowHandle& show, std::string_view labels, std::string& body, int& status);
+    void admin_config(std::string_view method, std::string_view text, std::string& body, int& status);
+
+    BookingService& service_;
+    ShowRoutes routes_;
+    std::unordered_map<std::string, CachedResponse> cache_;
+    std::string key_;                       /**< Reused lookup key (the request path). */
+    std::uint64_t cache_version_ = 0;       /**< Catalog version the cached responses were rendered at. */
+    std::uint64_t cache_hits_ = 0;
+    std::uint64_t cache_misses_ = 0;
+    std::string body_;                      /**< Reused body buffer of uncached responses. */
+    std::size_t max_request_ = 64 * 1024;
+    ClientRateLimiter* limiter_ = nullptr;
+    std::uint64_t client_ = 0;
+    bool read_only_ = false;
+    LiveConfig* config_ = nullptr;
+};
+
+} // namespace booking
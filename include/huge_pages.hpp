@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <vector>
+
+/**
+ * @file huge_pages.hpp
+ * @brief Large memory regions backed by huge pages, with fallback to normal pages.
+ *
+ * Random lookups over millions of shows touch a different 4 KiB page almost every time,
+ * so the TLB, not the cache, becomes the bottleneck. A region mapped on 2 MiB or 1 GiB
+ * pages needs 512x or 262144x fewer TLB entries. Explicit huge pages (MAP_HUGETLB) must
+ * be reserved by the administrator (vm.nr_hugepages); when none are free the mapping falls
+ * back to the next smaller kind, down to transparent huge pages (madvise(MADV_HUGEPAGE))
+ * and finally normal pages, so a setting never makes an allocation fail.
+ *
+ * The process-wide @ref set_huge_pages setting applies to the show state table
+ * (ShowTable chunks created with huge pages enabled) and to the catalog columns
+ * (HugePageAllocator); set it before loading the schedule.
+ */
+
+namespace booking {
+
+/** @brief Page kind requested for (or backing) a region. */
+enum class HugePages : std::uint8_t {
+    Off,         /**< Normal pages (no hint). */
+    Transparent, /**< Normal mapping with madvise(MADV_HUGEPAGE). */
+    Explicit2M,  /**< MAP_HUGETLB with 2 MiB pages. */
+    Explicit1G,  /**< MAP_HUGETLB with 1 GiB pages. */
+};
+
+const char* to_string(HugePages pages);
+
+/** @brief Parses "off", "thp", "2m" or "1g"; false (and @p out unchanged) otherwise. */
+bool parse_huge_pages(std::string_view text, HugePages& out);
+
+/** @brief Page size of @p pages in bytes (4 KiB for Off and Transparent). */
+std::size_t huge_page_bytes(HugePages pages);
+
+/** @brief Sets the page kind used for new show state and catalog regions. Thread-safe. */
+void set_huge_pages(HugePages pages);
+
+/** @brief Current setting of @ref set_huge_pages (Off by default). */
+HugePages huge_pages();
+
+/** @brief One mapped region. */
+struct HugeRegion {
+    void* data = nullptr;              /**< Start (page-aligned); null if mapping failed. */
+    std::size_t bytes = 0;             /**< Mapped length (rounded up to the page size). */
+    HugePages backing = HugePages::Off; /**< Kind actually obtained after fallbacks. */
+};
+
+/**
+ * @brief Maps @p bytes of zeroed memory, preferring @p pages and falling back to smaller kinds.
+ *
+ * @details
+ * Mapping with Explicit1G tries 1 GiB, then 2 MiB pages, then Transparent; Explicit2M
+ * tries 2 MiB pages then Transparent. The result has data == nullptr only if even a
+ * normal mapping failed.
+ */
+HugeRegion map_huge(std::size_t bytes, HugePages pages);
+
+/** @brief Unmaps a region returned by @ref map_huge (no-op for an empty one). */
+void unmap_huge(const HugeRegion& region);
+
+/** @brief Bytes currently mapped by @ref map_huge, per backing kind. */
+struct HugePageStats {
+    std::uint64_t normal_bytes = 0;      /**< Off (including fallbacks). */
+    std::uint64_t transparent_bytes = 0; /**< Transparent (best effort: the kernel may still use 4 KiB pages). */
+    std::uint64_t huge_2m_bytes = 0;     /**< Explicit2M. */
+    std::uint64_t huge_1g_bytes = 0;     /**< Explicit1G. */
+};
+
+/** @brief Snapshot of the mapped-bytes counters. Thread-safe. */
+HugePageStats huge_page_stats();
+
+/** @brief Allocations of at least this many bytes go through @ref map_huge (smaller ones use new). */
+constexpr std::size_t kHugeAllocMin = std::size_t{2} << 20;
+
+/** @brief @ref map_huge for an allocator: returns a block of @p bytes (header included in the mapping). */
+void* huge_allocate(std::size_t bytes);
+
+/** @brief Frees a block of @ref huge_allocate. */
+void huge_deallocate(void* p);
+
+/**
+ * @brief Stateless allocator placing large arrays on huge pages (see @ref set_huge_pages).
+ *
+ * @details
+ * Requests of kHugeAllocMin bytes or more are mapped with the current setting; the mapping
+ * is recorded in a header, so changing the setting later never confuses a deallocation.
+ * Smaller requests use operator new.
+ */
+template <typename T>
+struct HugePageAllocator {
+    using value_type = T;
+
+    HugePageAllocator() = default;
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        const std::size_t bytes = n * sizeof(T);
+        if (bytes < kHugeAllocMin) return static_cast<T*>(::operator new(bytes));
+        return static_cast<T*>(huge_allocate(bytes));
+    }
+
+    void deallocate(T* p, std::size_t n) {
+        if (n * sizeof(T) < kHugeAllocMin) {
+            ::operator delete(p);
+        } else {
+            huge_deallocate(p);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const HugePageAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const HugePageAllocator<U>&) const { return false; }
+};
+
+/** @brief Vector whose large buffers live on huge pages. */
+template <typename T>
+using HugeVector = std::vector<T, HugePageAllocator<T>>;
+
+} // namespace booking
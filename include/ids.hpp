@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+
+/**
+ * @file ids.hpp
+ * @brief Strong 64-bit identifiers of movies, theaters and shows.
+ *
+ * Each kind of entity has its own Id type, so a movie id does not convert to a show id.
+ * An Id is a single 64-bit word (trivially copyable, no padding), wide enough for the ids
+ * of an upstream system, with an explicit invalid state: the default-constructed Id,
+ * returned where the API used to return -1. Negative values are never valid.
+ *
+ * The service does not index by these ids directly: shows map to 32-bit ShowTable
+ * positions and movies and theaters to 32-bit catalog slots, so hot arrays and scanned
+ * columns stay as compact as with 32-bit ids.
+ */
+
+namespace booking {
+
+/**
+ * @brief Identifier of an entity of kind @p Tag.
+ *
+ * @details
+ * Constructible from an integer (implicitly, so literals and ids read from files name ids
+ * directly); the raw value is only read back through @ref value.
+ */
+template <typename Tag>
+class Id {
+public:
+    using Rep = std::int64_t;
+
+    /** @brief The invalid id. */
+    constexpr Id() noexcept = default;
+
+    /** @brief Id @p value (invalid if negative). */
+    constexpr Id(Rep value) noexcept : value_(value) {}
+
+    /** @brief The invalid id (same as a default-constructed one). */
+    static constexpr Id invalid() noexcept { return Id(); }
+
+    /** @brief False for the invalid id (and any negative value). */
+    constexpr bool valid() const noexcept { return value_ >= 0; }
+
+    /** @brief Raw value (e.g. for file formats and protocols). */
+    constexpr Rep value() const noexcept { return value_; }
+
+    friend constexpr bool operator==(Id a, Id b) noexcept { return a.value_ == b.value_; }
+    friend constexpr bool operator!=(Id a, Id b) noexcept { return a.value_ != b.value_; }
+    friend constexpr bool operator<(Id a, Id b) noexcept { return a.value_ < b.value_; }
+    friend constexpr bool operator<=(Id a, Id b) noexcept { return a.value_ <= b.value_; }
+    friend constexpr bool operator>(Id a, Id b) noexcept { return a.value_ > b.value_; }
+    friend constexpr bool operator>=(Id a, Id b) noexcept { return a.value_ >= b.value_; }
+
+    friend std::ostream& operator<<(std::ostream& os, Id id) { return os << id.value_; }
+
+private:
+    Rep value_ = -1;
+};
+
+/** @brief Decimal form of @p id. */
+template <typename Tag>
+std::string to_string(Id<Tag> id) {
+    return std::to_string(id.value());
+}
+
+/** @brief Movie identifier. */
+using MovieId = Id<struct MovieIdTag>;
+
+/** @brief Theater identifier. */
+using TheaterId = Id<struct TheaterIdTag>;
+
+/** @brief Show identifier. */
+using ShowId = Id<struct ShowIdTag>;
+
+static_assert(sizeof(ShowId) == 8 && alignof(ShowId) == 8, "an id is one 64-bit word");
+
+} // namespace booking
+
+namespace std {
+
+template <typename Tag>
+struct hash<booking::Id<Tag>> {
+    std::size_t operator()(booking::Id<Tag> id) const noexcept { return std::hash<std::int64_t>{}(id.value()); }
+};
+
+} // namespace std
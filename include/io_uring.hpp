@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+
+/**
+ * @file io_uring.hpp
+ * @brief Minimal io_uring wrapper over the raw system calls (no liburing dependency).
+ *
+ * Covers what the server and journal need: set up a ring, fill submission entries,
+ * submit-and-wait in one io_uring_enter call, reap completions and register buffers and
+ * files. Setup fails cleanly on kernels (or sandboxes) without io_uring, so callers can
+ * fall back to epoll / write().
+ *
+ * A ring is used by one thread.
+ */
+
+namespace booking {
+
+/**
+ * @brief One io_uring instance (submission + completion queue).
+ */
+class IoUring {
+public:
+    IoUring() = default;
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    /**
+     * @brief Sets up a ring with at least @p entries submission slots.
+     * @return False if io_uring is unavailable (ENOSYS, EPERM under seccomp, old kernel).
+     */
+    bool init(unsigned entries);
+
+    /** @brief True after a successful @ref init. */
+    bool ok() const { return fd_ >= 0; }
+
+    /** @brief Zeroed submission entry, or null if the queue is full (submit first). */
+    io_uring_sqe* get_sqe();
+
+    /**
+     * @brief Submits the filled entries and waits for at least @p wait_nr completions.
+     * @return Entries submitted, or -errno.
+     */
+    int submit(unsigned wait_nr = 0);
+
+    /** @brief Next completion, or null if none is ready. */
+    io_uring_cqe* peek_cqe();
+
+    /** @brief Marks the completion returned by @ref peek_cqe as consumed. */
+    void cqe_seen();
+
+    /** @brief Registers fixed buffers (IORING_REGISTER_BUFFERS); 0 or -errno. */
+    int register_buffers(const iovec* iovs, unsigned count);
+
+    /** @brief Registers a fixed file table; -1 entries are empty slots. 0 or -errno. */
+    int register_files(const int* fds, unsigned count);
+
+    /** @brief Replaces fixed file slots [offset, offset + count) (-1 empties a slot). 0 or -errno. */
+    int update_files(unsigned offset, const int* fds, unsigned count);
+
+    /** @brief Fills @p sqe for a read/write style operation. */
+    static void prep(io_uring_sqe* sqe, std::uint8_t opcode, int fd, const void* addr, std::uint32_t len,
+                     std::uint64_t offset, std::uint64_t user_data) {
+        sqe->opcode = opcode;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(addr);
+        sqe->len = len;
+        sqe->off = offset;
+        sqe->user_data = user_data;
+    }
+
+private:
+    int fd_ = -1;
+    void* sq_ring_ = nullptr;
+    std::size_t sq_ring_size_ = 0;
+    void* cq_ring_ = nullptr;          /**< Same mapping as sq_ring_ with IORING_FEAT_SINGLE_MMAP. */
+    std::size_t cq_ring_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqes_size_ = 0;
+
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned sq_local_tail_ = 0;       /**< Filled but not yet published entries end here. */
+    unsigned sq_submitted_ = 0;        /**< Entries handed to the kernel. */
+
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+};
+
+} // namespace booking
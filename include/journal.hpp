@@ -0,0 +1,415 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "ids.hpp"
+#include "io_uring.hpp"
+#include "seat_mask.hpp"
+
+/**
+ * @file journal.hpp
+ * @brief Append-only write-ahead journal of bookings and cancellations with group commit.
+ *
+ * Booking threads append records to a bounded lock-free multi-producer ring (one claim
+ * per record, no lock); a dedicated writer thread drains the ring in order, writes
+ * everything that is ready with one write() and makes it durable with one fdatasync(),
+ * so concurrent bookings share the cost of a sync. With the io_uring backend the write
+ * (from a registered buffer to a registered file) and the datasync are submitted as one
+ * linked pair, one system call per batch. With the Mapped backend the file is preallocated
+ * in fixed-size segments and mapped: a batch is a memcpy into the mapping and one msync of
+ * the pages it touched, and a new segment is allocated only when the mapping is full.
+ * The Direct backend bypasses the page cache: the batch is copied behind the partial block
+ * the records end in and written as whole, aligned blocks with O_DIRECT | O_DSYNC, so the
+ * write itself is the sync and there is no dirty page cache for writeback to flush later.
+ *
+ * File layout: a 16-byte header ("BKJRNL" + two format bytes, version, reserved) followed by
+ * records, all little-endian:
+ *
+ *     u64 lsn | i64 show | u32 booking id | u8 first word | u8 word count | u8 op | pad
+ *     u64 checksum (CRC-32C of the 3 header words and the seat words, crc32c.hpp)
+ *     u64 seat words [word count]          rows first_word .. first_word + count - 1
+ *
+ * A record is valid only if its checksum matches, so a torn write at the tail after a
+ * crash is detected and ignored (and truncated when the journal is reopened). The unused,
+ * zero-filled rest of a preallocated segment (or of a Direct block) reads as the end of the journal.
+ * Version 2 files (checksummed with snapshot_checksum) are still read; opening one for
+ * appending rewrites its records in the current format first.
+ * LSNs increase through the file and continue across reopenings.
+ *
+ * Journal::compact drops the records a snapshot already covers, so the file (and recovery
+ * time) stays bounded by the snapshot interval rather than by uptime.
+ *
+ * A commit wait (Journal::set_commit_wait) extends what "durable" means for Sync
+ * operations, e.g. to "fsync-ed here and on a quorum of replicas" (replication.hpp);
+ * a JournalMirror keeps such a replica's byte-identical copy of the file.
+ */
+
+namespace booking {
+
+/** @brief Bytes of the journal file header that precedes the records. */
+constexpr std::size_t kJournalHeaderSize = 16;
+
+/** @brief Format version written (2: 64-bit show ids, 3: CRC-32C record checksums). */
+constexpr std::uint32_t kJournalVersion = 3;
+
+/** @brief Journaled operation. */
+enum class JournalOp : std::uint8_t {
+    Book = 1,   /**< The seats were booked under the booking id. */
+    Cancel = 2, /**< The booking id's seats were cancelled. */
+};
+
+/**
+ * @brief When a journaled operation returns relative to its record becoming durable.
+ */
+enum class JournalMode : std::uint8_t {
+    Sync,  /**< The operation waits until its record is fsync-ed (group commit). */
+    Async, /**< The writer fsyncs each batch; the operation does not wait. */
+    None,  /**< Records are written but never fsync-ed (survive a process crash, not a power loss). */
+};
+
+/** @brief How the writer thread issues its writes and syncs. */
+enum class JournalBackend : std::uint8_t {
+    Auto,     /**< io_uring when the kernel allows it, else Write. */
+    Write,    /**< write() + fdatasync(). */
+    IoUring,  /**< Linked WRITE_FIXED + FSYNC(DATASYNC) on a registered buffer and file. */
+    Mapped,   /**< memcpy into preallocated, memory-mapped segments + msync. */
+    Direct,   /**< Block-aligned O_DIRECT | O_DSYNC writes that bypass the page cache. */
+};
+
+/** @brief Static name of a journal backend. */
+const char* to_string(JournalBackend backend);
+
+/** @brief Outcome of opening or reading a journal. */
+enum class JournalStatus : std::uint8_t {
+    Ok,        /**< Opened / read. */
+    IoError,   /**< The file could not be opened, read or written. */
+    BadHeader, /**< The file is not a journal or has an unsupported version. */
+};
+
+/** @brief Static description of a journal status. */
+const char* to_string(JournalStatus status);
+
+/** @brief Decoded journal record. */
+struct JournalRecord {
+    std::uint64_t lsn = 0;           /**< Log sequence number. */
+    std::uint64_t end_lsn = 0;       /**< LSN just after the record (the next record's LSN). */
+    JournalOp op = JournalOp::Book;  /**< Operation. */
+    ShowId show_id;                  /**< Show of the operation. */
+    std::uint32_t booking_id = 0;    /**< Booking the seats belong to. */
+    SeatMask seats;                  /**< Seats booked or cancelled. */
+};
+
+/** @brief Where a record sits in the journal bytes (see JournalReader::next_span). */
+struct JournalSpan {
+    std::size_t offset = 0; /**< First byte of the record. */
+    ShowId show_id;         /**< Show of the record (unverified until decoded). */
+};
+
+/** @brief Outcome of replaying a journal (see BookingService::replay_journal). */
+struct JournalReplay {
+    JournalStatus status = JournalStatus::Ok; /**< Ok, IoError or BadHeader. */
+    std::size_t applied = 0;                  /**< Records applied. */
+    std::size_t skipped = 0;                  /**< Records already in the snapshot or for unknown shows. */
+};
+
+/**
+ * @brief Sequential reader of journal bytes (e.g. a mapped file).
+ */
+class JournalReader {
+public:
+    /** @brief Checks the file header; see @ref status. */
+    explicit JournalReader(std::string_view bytes);
+
+    /** @brief Reader of bare records without the file header (a replication stream, see replication.hpp). */
+    static JournalReader records(std::string_view bytes);
+
+    /** @brief Ok if the header is valid (an empty input reads as an empty journal). */
+    JournalStatus status() const { return status_; }
+
+    /** @brief Format version of the file (the current one for bare records). */
+    std::uint32_t version() const { return version_; }
+
+    /**
+     * @brief Decodes the next record.
+     * @return False at the end of the valid records (end of input or a torn/corrupt record).
+     */
+    bool next(JournalRecord& out);
+
+    /**
+     * @brief Steps over the next record after checking only the shape of its header, not
+     *        its checksum, so the records can be located before they are decoded.
+     * @return False at the end of the input or at bytes that cannot be a record.
+     */
+    bool next_span(JournalSpan& out);
+
+    /**
+     * @brief Validates and decodes the record at @p span, as @ref next would have.
+     * @note Const: threads may decode different spans of one reader concurrently.
+     */
+    bool decode(const JournalSpan& span, JournalRecord& out) const;
+
+    /** @brief Byte offset just past the last record returned (the valid prefix of the file). */
+    std::size_t offset() const { return offset_; }
+
+private:
+    /** @brief Size of the record at @p offset from its header alone (0 if it cannot be one). */
+    std::size_t record_size(std::size_t offset) const;
+
+    std::string_view bytes_;
+    std::size_t offset_ = 0;
+    JournalStatus status_ = JournalStatus::Ok;
+    std::uint32_t version_ = kJournalVersion;
+};
+
+/**
+ * @brief Journal writer: lock-free multi-producer ring drained by one group-commit thread.
+ */
+class Journal {
+public:
+    /** @brief Default ring capacity in slots (one 64-byte slot holds a record of up to 5 rows). */
+    static constexpr std::size_t kDefaultRingSlots = 1u << 16;
+
+    /** @brief Default segment size of the Mapped backend. */
+    static constexpr std::size_t kDefaultSegmentBytes = std::size_t{64} << 20;
+
+    /** @brief Alignment of the Direct backend's writes (offset, length and buffer). */
+    static constexpr std::size_t kDirectBlock = 4096;
+
+    /**
+     * @brief Extra commit condition: called with a commit LSN once the records below it are
+     *        durable locally; returns false if they cannot be committed.
+     */
+    using CommitWait = std::function<bool(std::uint64_t commit_lsn)>;
+
+    /**
+     * @brief Called on the writer thread with the records of each batch right after it is
+     *        committed (bare records, see JournalReader::records); must not block.
+     */
+    using CommitTap = std::function<void(std::string_view records)>;
+
+    Journal() = default;
+
+    /** @brief Writes and syncs every appended record, then stops the writer thread. */
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    /**
+     * @brief Opens (or creates) @p path for appending and starts the writer thread.
+     *
+     * @param ring_slots Ring capacity, rounded up to a power of two (at least 16 slots);
+     *        producers wait for space when the writer falls this far behind.
+     * @param backend Write path; Auto and IoUring fall back to Write without io_uring, Direct
+     *        where the file system refuses O_DIRECT (e.g. tmpfs).
+     * @param segment_bytes Mapped backend: the file grows by this much (rounded up to
+     *        pages) whenever the mapping is full; on close it is cut back to its records.
+     * @return Ok, IoError or BadHeader. Existing records are kept; a torn tail is truncated.
+     * @note Call once, before any append.
+     */
+    JournalStatus open(const std::string& path, JournalMode mode, std::size_t ring_slots = kDefaultRingSlots,
+                       JournalBackend backend = JournalBackend::Auto,
+                       std::size_t segment_bytes = kDefaultSegmentBytes);
+
+    /** @brief Durability mode given to @ref open. */
+    JournalMode mode() const { return mode_; }
+
+    /** @brief Write path in use (never Auto) after @ref open. */
+    JournalBackend backend() const { return backend_; }
+
+    /** @brief Bytes of the ring and the writer's buffers (a Mapped file's pages are not counted). */
+    std::size_t bytes() const {
+        if (!ring_) return 0;
+        return (mask_ + 1u) * sizeof(Slot) + kBatchWords * sizeof(std::uint64_t)
+               + (backend_ == JournalBackend::Direct ? kDirectBlocks * sizeof(DirectBlock) : 0u);
+    }
+
+    /**
+     * @brief Appends a record; lock-free unless the ring is full.
+     * @return The record's commit LSN, to pass to @ref wait_durable.
+     */
+    std::uint64_t append(JournalOp op, ShowId show_id, std::uint32_t booking_id, const SeatMask& seats);
+
+    /**
+     * @brief Blocks until every record with a commit LSN <= @p commit_lsn is written
+     *        (and fsync-ed unless the mode is None), then for the commit wait if one is set.
+     * @return False if the writer hit an I/O error (the record may not be durable) or the
+     *         commit wait failed.
+     */
+    bool wait_durable(std::uint64_t commit_lsn);
+
+    /**
+     * @brief Makes @ref wait_durable also wait for @p wait (empty = local durability only).
+     * @note Set before appending; the function must stay callable while the journal is open.
+     */
+    void set_commit_wait(CommitWait wait) { commit_wait_ = std::move(wait); }
+
+    /**
+     * @brief Hands every batch committed from now on to @p tap (empty = none), e.g. an
+     *        AuditTap (audit_tap.hpp). Records that failed to commit are not passed on.
+     * @note Set before appending; the function must stay callable while the journal is open.
+     */
+    void set_commit_tap(CommitTap tap) { commit_tap_ = std::move(tap); }
+
+    /** @brief @ref wait_durable for everything appended so far. */
+    bool sync() { return wait_durable(next_lsn()); }
+
+    /** @brief LSN the next record will get; every record below it has been appended. */
+    std::uint64_t next_lsn() const { return tail_.load(std::memory_order_acquire); }
+
+    /** @brief Records below this LSN are durable. */
+    std::uint64_t durable_lsn() const { return durable_.load(std::memory_order_acquire); }
+
+    /** @brief True once a write or sync failed; later records are discarded. */
+    bool failed() const { return failed_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Drops the records below @p before_lsn (e.g. those a snapshot covers) from the file.
+     *
+     * @details
+     * The writer thread copies the records from @p before_lsn on behind a fresh header to
+     * "<path>.tmp", syncs it and renames it over the journal between two group commits;
+     * appends continue meanwhile and land in the new file. The newest record is always
+     * kept, so a reopened journal continues its LSNs. A ReplicationSource reading the old
+     * file switches to the new one once it has shipped the old one to its end.
+     * @return Ok, or IoError with the journal unchanged. Blocks until the rewrite is done.
+     */
+    JournalStatus compact(std::uint64_t before_lsn);
+
+    /** @brief Bytes @ref compact has dropped from the file so far. */
+    std::uint64_t compacted_bytes() const { return compacted_bytes_.load(std::memory_order_relaxed); }
+
+    /** @brief Ring positions (= LSNs) taken by a record of @p word_count rows. */
+    static std::size_t slots_for(int word_count) {
+        return word_count <= kSlotWords ? 1u : static_cast<std::size_t>((word_count + kSlotWords - 1) / kSlotWords);
+    }
+
+private:
+    static constexpr int kSlotWords = 5;
+
+    /** @brief Ring slot: a record header (first slot only) and up to 5 seat words. */
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> seq{0}; /**< Position + 1 when published; position + capacity when free. */
+        std::int64_t show_id = 0;
+        std::uint32_t booking_id = 0;
+        std::uint8_t first_word = 0;
+        std::uint8_t word_count = 0;
+        JournalOp op = JournalOp::Book;
+        std::uint64_t words[kSlotWords] = {};
+    };
+
+    Slot& slot(std::uint64_t pos) { return ring_[static_cast<std::size_t>(pos) & mask_]; }
+
+    /** @brief Words of the writer's batch buffer: 1 MiB plus room for the record that crosses it. */
+    static constexpr std::size_t kBatchWords = (std::size_t{1} << 17) + 4u + SeatMask::kWords;
+
+    /** @brief Writer thread: drain, write, sync, publish durability, repeat. */
+    void run();
+
+    /** @brief Writes (and unless mode None, syncs) @p bytes of the batch buffer; false on error. */
+    bool commit(std::size_t bytes);
+
+    /** @brief Sets up the ring, registers the batch buffer and the file; false to use Write. */
+    bool init_uring();
+
+    /** @brief Writer side of @ref compact: rewrites the file and answers the request. */
+    void compact_file();
+
+    /** @brief Mapped backend: (re)maps fd_ with room for @p bytes past file_offset_; false on error. */
+    bool map_segments(std::size_t bytes);
+
+    /** @brief Mapped backend: drops the mapping and cuts the preallocated tail off the file. */
+    void unmap_segments();
+
+    /**
+     * @brief Direct backend: opens path_ for O_DIRECT writes and loads the partial block
+     *        file_offset_ is in; false if the file system refuses O_DIRECT.
+     */
+    bool open_direct();
+
+    struct alignas(kDirectBlock) DirectBlock {
+        char bytes[kDirectBlock];
+    };
+
+    /** @brief Blocks of the Direct staging buffer: a whole batch behind one partial block. */
+    static constexpr std::size_t kDirectBlocks = kBatchWords * 8u / kDirectBlock + 2u;
+
+    std::string path_;
+    int fd_ = -1;
+    JournalMode mode_ = JournalMode::Sync;
+    JournalBackend backend_ = JournalBackend::Write;
+    std::unique_ptr<std::uint64_t[]> batch_;         /**< Writer: records of the current group commit. */
+    std::unique_ptr<IoUring> uring_;                 /**< IoUring backend only (batch_ is registered with it). */
+    std::uint64_t file_offset_ = 0;                  /**< Writer: end of the records (IoUring, Mapped write there). */
+    char* map_ = nullptr;                            /**< Mapped: the whole file, preallocated segments included. */
+    std::size_t map_size_ = 0;
+    std::size_t segment_bytes_ = kDefaultSegmentBytes;
+    int direct_fd_ = -1;                             /**< Direct: O_DIRECT descriptor of the same file. */
+    std::unique_ptr<DirectBlock[]> direct_;          /**< Direct: partial block, then the batch. */
+    std::unique_ptr<Slot[]> ring_;
+    std::size_t mask_ = 0;
+
+    alignas(64) std::atomic<std::uint64_t> tail_{0}; /**< Next position to claim (= LSN). */
+    alignas(64) std::atomic<std::uint64_t> durable_{0}; /**< Positions below are durable. */
+    std::atomic<bool> failed_{false};
+    std::atomic<bool> stop_{false};
+    std::atomic<int> waiters_{0};                    /**< Threads blocked in wait_durable. */
+    std::uint64_t head_ = 0;                         /**< Writer: next position to drain. */
+
+    std::mutex mutex_;                               /**< Guards the condition variables only. */
+    std::condition_variable wake_writer_;
+    std::condition_variable durable_cv_;             /**< Also signals finished compactions. */
+    std::atomic<bool> compact_requested_{false};
+    std::uint64_t compact_before_ = 0;               /**< Guarded by mutex_, like the two below. */
+    std::uint64_t compact_generation_ = 0;           /**< Finished compactions. */
+    JournalStatus compact_status_ = JournalStatus::Ok;
+    std::atomic<std::uint64_t> compacted_bytes_{0};
+    std::thread writer_;
+    CommitWait commit_wait_;
+    CommitTap commit_tap_;
+};
+
+/**
+ * @brief Verbatim copy of another journal, appended record batch by record batch.
+ *
+ * @details
+ * A replica's durable log: the records arrive already encoded (a replication frame) and
+ * are written unchanged, so the copy is a valid journal with the primary's LSNs; a
+ * replica promoted to primary opens it with Journal::open and continues after its last
+ * record.
+ */
+class JournalMirror {
+public:
+    JournalMirror() = default;
+    ~JournalMirror();
+
+    JournalMirror(const JournalMirror&) = delete;
+    JournalMirror& operator=(const JournalMirror&) = delete;
+
+    /** @brief Opens (or creates) @p path; a torn tail is truncated like Journal::open does. */
+    JournalStatus open(const std::string& path);
+
+    /** @brief LSN after the last record in the file (0 for a new file). */
+    std::uint64_t next_lsn() const { return next_lsn_; }
+
+    /**
+     * @brief Appends the records of @p records at or after @ref next_lsn and fdatasyncs once.
+     * @return False on an I/O error or a record that does not decode.
+     */
+    bool append(std::string_view records);
+
+private:
+    int fd_ = -1;
+    std::uint64_t next_lsn_ = 0;
+};
+
+} // namespace booking
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file latency_histogram.hpp
+ * @brief Fixed-size log-linear latency histogram (HDR-style, ~3% relative error).
+ *
+ * Values (e.g. nanoseconds) are bucketed by their power of two and, within it, by the next
+ * 5 bits, so every bucket is at most 1/32 of its value wide and any 64-bit value fits
+ * without configuration. Recording is a bit scan and an increment; percentiles walk the
+ * 1920 buckets once.
+ */
+
+namespace booking {
+
+/**
+ * @brief Log-linear histogram of 64-bit values.
+ *
+ * @details
+ * Not synchronised: give each thread its own histogram and @ref merge them to report.
+ */
+class LatencyHistogram {
+public:
+    /** @brief Sub-buckets per power of two (log2). */
+    static constexpr int kSubBits = 5;
+
+    /** @brief Number of buckets (values 0..31 exactly, then 32 per power of two). */
+    static constexpr std::size_t kBuckets = static_cast<std::size_t>(64 - kSubBits + 1) << kSubBits;
+
+    /** @brief Bucket of @p value. */
+    static std::size_t bucket_of(std::uint64_t value) {
+        if (value < (std::uint64_t{1} << kSubBits)) return static_cast<std::size_t>(value);
+        const int msb = 63 - __builtin_clzll(value);
+        const int shift = msb - kSubBits;
+        return (static_cast<std::size_t>(shift + 1) << kSubBits) + static_cast<std::size_t>((value >> shift) - (1u << kSubBits));
+    }
+
+    /** @brief Largest value that falls into bucket @p index. */
+    static std::uint64_t bucket_upper(std::size_t index) {
+        constexpr std::size_t kSub = std::size_t{1} << kSubBits;
+        if (index < kSub) return index;
+        const int shift = static_cast<int>(index >> kSubBits) - 1;
+        const std::uint64_t top = kSub + (index & (kSub - 1u));
+        return ((top + 1u) << shift) - 1u;
+    }
+
+    /** @brief Records one value. */
+    void record(std::uint64_t value) {
+        ++buckets_[bucket_of(value)];
+        ++count_;
+        sum_ += value;
+        if (value > max_) max_ = value;
+    }
+
+    /** @brief Adds all values of @p other. */
+    void merge(const LatencyHistogram& other) {
+        for (std::size_t i = 0; i < kBuckets; ++i) buckets_[i] += other.buckets_[i];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        if (other.max_ > max_) max_ = other.max_;
+    }
+
+    /**
+     * @brief Adds bucket counts gathered elsewhere (e.g. from concurrent recorders).
+     *
+     * @param counts Values per bucket for buckets [0, n); n <= kBuckets.
+     * @param sum Sum of those values.
+     * @param max Largest of those values.
+     */
+    void merge_buckets(const std::uint64_t* counts, std::size_t n, std::uint64_t sum, std::uint64_t max) {
+        for (std::size_t i = 0; i < n; ++i) {
+            buckets_[i] += counts[i];
+            count_ += counts[i];
+        }
+        sum_ += sum;
+        if (max > max_) max_ = max;
+    }
+
+    /** @brief Number of recorded values. */
+    std::uint64_t count() const { return count_; }
+
+    /** @brief Largest recorded value (0 if empty). */
+    std::uint64_t max() const { return max_; }
+
+    /** @brief Mean of the recorded values (0 if empty). */
+    double mean() const { return count_ == 0u ? 0.0 : static_cast<double>(sum_) / static_cast<double>(count_); }
+
+    /** @brief Number of values in bucket @p index. */
+    std::uint64_t bucket_count(std::size_t index) const { return buckets_[index]; }
+
+    /**
+     * @brief Value at quantile @p q in [0, 1] (e.g. 0.99), as the upper bound of its bucket
+     *        capped by the maximum; 0 if empty.
+     */
+    std::uint64_t percentile(double q) const {
+        if (count_ == 0u) return 0u;
+        std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(count_) + 0.5);
+        if (rank < 1u) rank = 1u;
+        if (rank > count_) rank = count_;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            seen += buckets_[i];
+            if (seen >= rank) return bucket_upper(i) < max_ ? bucket_upper(i) : max_;
+        }
+        return max_;
+    }
+
+private:
+    std::array<std::uint64_t, kBuckets> buckets_{}; /**< Values per bucket. */
+    std::uint64_t count_ = 0;                       /**< Recorded values. */
+    std::uint64_t sum_ = 0;                         /**< Sum of recorded values. */
+    std::uint64_t max_ = 0;                         /**< Largest recorded value. */
+};
+
+} // namespace booking
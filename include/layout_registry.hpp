@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "hall_layout.hpp"
+
+/**
+ * @file layout_registry.hpp
+ * @brief Append-only registry of immutable, deduplicated hall layouts.
+ */
+
+namespace booking {
+
+/**
+ * @brief Interns hall layouts and hands out stable ids and references.
+ *
+ * @details
+ * Every show of a hall shares its layout (row widths, labels, category and price overlays
+ * and their precomputed label, mask and cost tables), so the registry stores each distinct
+ * layout once and shows refer to it by LayoutId; per-show state keeps only its booking
+ * words and a pointer to the shared layout. Two layouts are equal when their rows (labels
+ * and widths), aisles, price tiers, seat categories and gap rule are. Layouts are never moved,
+ * changed or freed before the registry, so references stay valid as it grows. Interning
+ * is not thread-safe: writers serialise it externally.
+ */
+class LayoutRegistry {
+public:
+    using Entries = std::vector<std::unique_ptr<const HallLayout>>;
+
+    LayoutRegistry() = default;
+    LayoutRegistry(const LayoutRegistry&) = delete;
+    LayoutRegistry& operator=(const LayoutRegistry&) = delete;
+
+    /** @brief Id of the registry's copy of @p layout, storing it on first use. */
+    LayoutId intern(HallLayout layout);
+
+    /** @brief Id of a layout equal to @p layout, or -1 if none is registered. */
+    LayoutId find(const HallLayout& layout) const;
+
+    /** @brief True if @p id names a registered layout. */
+    bool contains(LayoutId id) const { return id >= 0 && static_cast<std::size_t>(id) < layouts_.size(); }
+
+    /** @brief Layout @p id (must be registered). */
+    const HallLayout& at(LayoutId id) const { return *layouts_[static_cast<std::size_t>(id)]; }
+
+    /** @brief Distinct layouts stored. */
+    std::size_t size() const { return layouts_.size(); }
+
+    /** @brief Layouts in id order. */
+    Entries::const_iterator begin() const { return layouts_.begin(); }
+    Entries::const_iterator end() const { return layouts_.end(); }
+
+    /** @brief Hash of everything layout equality compares. */
+    static std::uint64_t fingerprint(const HallLayout& layout);
+
+    /** @brief Layout equality as used for deduplication. */
+    static bool same(const HallLayout& a, const HallLayout& b);
+
+private:
+    Entries layouts_;                                     /**< Indexed by LayoutId. */
+    std::unordered_multimap<std::uint64_t, LayoutId> index_; /**< Fingerprint -> ids. */
+};
+
+} // namespace booking
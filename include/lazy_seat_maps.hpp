@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "atomic_wait.hpp"
+#include "schedule_loader.hpp"
+#include "snapshot.hpp"
+
+/**
+ * @file lazy_seat_maps.hpp
+ * @brief Seat maps of a mapped snapshot that are decoded into their shows on first access.
+ *
+ * A lazy restore publishes the catalog right away and leaves every show with bookings
+ * pending: its seat map stays in the mapping until a reader first asks for the show. The
+ * pending set of dense ids is a bitmap, so a reader of a show that is loaded (or never had
+ * bookings) pays one acquire load; sparse ids (see show_table.hpp) are looked up in the
+ * sorted entries instead. The first reader of a pending show claims it, decodes the seat
+ * map into the state and then marks it loaded with a release store, which publishes the
+ * state to every later reader; readers that arrive during the decode wait for it.
+ */
+
+namespace booking {
+
+/**
+ * @brief Pending seat maps of one snapshot, keyed by show id.
+ */
+class LazySeatMaps {
+public:
+    /**
+     * @brief Takes @p file and the @p view opened on it; every show of @p view whose seat
+     *        map has a booking (@ref SnapshotShow::max_booking != 0) starts pending.
+     */
+    LazySeatMaps(std::unique_ptr<MappedFile> file, const SnapshotView& view) : file_(std::move(file)), view_(view) {
+        const SnapshotShow* shows = view_.shows();
+        for (std::uint64_t i = 0; i < view_.header().shows.count; ++i) {
+            if (shows[i].max_booking != 0u && shows[i].id >= 0) {
+                entries_.push_back(Entry{shows[i].id, static_cast<std::uint32_t>(i)});
+            }
+        }
+        std::sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) { return a.id < b.id; });
+        states_.reset(new std::atomic<std::uint8_t>[entries_.size()]());
+        std::int64_t dense_end = 0;
+        for (const Entry& e : entries_) {
+            if (e.id < kBitmapIds) dense_end = e.id + 1;
+        }
+        bits_ = std::vector<std::atomic<std::uint64_t>>((static_cast<std::size_t>(dense_end) + 63u) / 64u);
+        for (const Entry& e : entries_) {
+            if (e.id >= kBitmapIds) continue;
+            std::atomic<std::uint64_t>& word = bits_[static_cast<std::size_t>(e.id) / 64u];
+            word.store(word.load(std::memory_order_relaxed) | bit(e.id), std::memory_order_relaxed);
+        }
+        remaining_.store(entries_.size(), std::memory_order_relaxed);
+    }
+
+    LazySeatMaps(const LazySeatMaps&) = delete;
+    LazySeatMaps& operator=(const LazySeatMaps&) = delete;
+
+    /** @brief Ids below this are tracked in the bitmap (the dense ids of ShowTable). */
+    static constexpr std::int64_t kBitmapIds = 1 << 22;
+
+    /** @brief True until show @p show is loaded; false for shows that were never pending. */
+    bool pending(ShowId show) const {
+        const std::int64_t id = show.value();
+        if (id >= kBitmapIds) {
+            const std::size_t k = entry(id);
+            return k != entries_.size() && states_[k].load(std::memory_order_acquire) != kLoaded;
+        }
+        const auto i = static_cast<std::size_t>(id) / 64u;
+        return id >= 0 && i < bits_.size() && (bits_[i].load(std::memory_order_acquire) & bit(id)) != 0u;
+    }
+
+    /**
+     * @brief Loads show @p show if it is pending: the first caller runs
+     *        @p decode(const SnapshotShow&) and publishes the show, concurrent callers wait
+     *        until it has. Returns at once for shows that are not pending.
+     */
+    template <typename Decode>
+    void load(ShowId show, Decode&& decode) {
+        if (!pending(show)) return;
+        const std::int64_t id = show.value();
+        const std::size_t k = entry(id);
+        std::uint8_t expected = kPending;
+        if (states_[k].compare_exchange_strong(expected, kLoading, std::memory_order_acquire)) {
+            decode(view_.shows()[entries_[k].index]);
+            states_[k].store(kLoaded, std::memory_order_release);
+            if (id < kBitmapIds) bits_[static_cast<std::size_t>(id) / 64u].fetch_and(~bit(id), std::memory_order_release);
+            remaining_.fetch_sub(1u, std::memory_order_acq_rel);
+            atomic_notify_all(states_[k]); // lookups of the show that found it loading
+            return;
+        }
+        atomic_wait(states_[k], static_cast<std::uint8_t>(kLoading)); // another thread is decoding it
+    }
+
+    /**
+     * @brief Shows still pending. Once it reads 0, every decode happens-before the read (the
+     *        decrements form one release sequence).
+     */
+    std::size_t remaining() const { return remaining_.load(std::memory_order_acquire); }
+
+    /** @brief Ids of the shows still pending, ascending. */
+    std::vector<ShowId> pending_ids() const {
+        std::vector<ShowId> ids;
+        for (const Entry& e : entries_) {
+            if (pending(e.id)) ids.push_back(e.id);
+        }
+        return ids;
+    }
+
+    /** @brief The snapshot the seat maps are decoded from. */
+    const SnapshotView& view() const { return view_; }
+
+private:
+    struct Entry {
+        std::int64_t id;
+        std::uint32_t index; /**< Into the snapshot's shows section. */
+    };
+
+    static constexpr std::uint8_t kPending = 0;
+    static constexpr std::uint8_t kLoading = 1;
+    static constexpr std::uint8_t kLoaded = 2;
+
+    static std::uint64_t bit(std::int64_t id) { return std::uint64_t{1} << (id & 63); }
+
+    /** @brief Index of @p id's entry, or entries_.size(). */
+    std::size_t entry(std::int64_t id) const {
+        const auto it = std::lower_bound(entries_.begin(), entries_.end(), id,
+                                         [](const Entry& e, std::int64_t key) { return e.id < key; });
+        return it != entries_.end() && it->id == id ? static_cast<std::size_t>(it - entries_.begin()) : entries_.size();
+    }
+
+    std::unique_ptr<MappedFile> file_;
+    SnapshotView view_;
+    std::vector<Entry> entries_;                          /**< Pending at construction, sorted by id. */
+    std::unique_ptr<std::atomic<std::uint8_t>[]> states_; /**< Per entry: kPending, kLoading or kLoaded. */
+    std::vector<std::atomic<std::uint64_t>> bits_;        /**< Bit per dense show id: still pending. */
+    std::atomic<std::size_t> remaining_{0};
+};
+
+} // namespace booking
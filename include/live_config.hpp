@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "admission.hpp"
+#include "backoff.hpp"
+#include "ids.hpp"
+#include "rate_limiter.hpp"
+
+/**
+ * @file live_config.hpp
+ * @brief Tuning knobs that can be changed while the service runs (from a file or the
+ *        HTTP admin endpoint), published as immutable snapshots.
+ *
+ * During a premiere the CAS backoff, the hold TTL cap, the per-client rate limit and the
+ * admission rates of hot shows want adjusting without a restart. A LiveConfig keeps the
+ * current TuningConfig behind one atomic pointer: a hot path reads it with one load, and
+ * a reload builds a new snapshot and swaps the pointer. Snapshots are never freed while
+ * the LiveConfig lives (reloads are an operator's edits, a handful per day), so a reader
+ * needs no guard and may keep a reference for as long as it likes.
+ *
+ * Config text is one "key = value" per line; '#' starts a comment. Keys:
+ *
+ *     backoff.max_retries = 256          BackoffPolicy of every booking path
+ *     backoff.max_pause_spins = 64
+ *     backoff.yield_after = 16
+ *     hold.max_ttl_ms = 0                longest hold TTL granted (0 = as asked)
+ *     client_rate = 50:10                requests per second[:burst] per client (0 = unlimited)
+ *     admission.<show id> = 200:20       bookers per second[:burst] of a show (0 = gate open)
+ *
+ * Keys a text leaves out take the LiveConfig's defaults, so deleting a line undoes it; a
+ * show dropped from the admission lines gets its gate opened.
+ */
+
+namespace booking {
+
+/** @brief One snapshot of the live tunables. */
+struct TuningConfig {
+    BackoffPolicy backoff{};                   /**< CAS retry policy (BookingService). */
+    std::chrono::milliseconds max_hold_ttl{0}; /**< Hold TTLs are capped at this (0 = no cap). */
+    RateLimit client_rate{};                   /**< Per-client request rate (BookingServer). */
+    std::vector<std::pair<ShowId, AdmissionPolicy>> admission; /**< Admission gates set by this config. */
+};
+
+/** @brief Outcome of parsing or loading config text. */
+enum class ConfigStatus : std::uint8_t {
+    Ok,         /**< Parsed (and published). */
+    IoError,    /**< The file could not be read. */
+    ParseError, /**< A malformed line; see ConfigError::line. */
+};
+
+/** @brief Static description of a config status. */
+const char* to_string(ConfigStatus status);
+
+/** @brief Details of a failed parse or reload. */
+struct ConfigError {
+    ConfigStatus status = ConfigStatus::Ok; /**< Outcome. */
+    std::size_t line = 0;                   /**< 1-based line of the offending entry (0 = n/a). */
+    const char* reason = "";                /**< Static description of the problem. */
+};
+
+/**
+ * @brief Parses config @p text over @p out (keys not in the text keep @p out's values).
+ * @return Ok, or ParseError for the first malformed line (@p out is then unspecified).
+ */
+ConfigError parse_tuning(std::string_view text, TuningConfig& out);
+
+/**
+ * @brief Current TuningConfig of a service, swapped atomically on reload.
+ *
+ * @details
+ * Thread-safe. Reloads and listeners are serialised; listeners run on the reloading
+ * thread, after the new snapshot is visible to readers.
+ */
+class LiveConfig {
+public:
+    /** @brief Called with the previous and the new snapshot after each publish. */
+    using Listener = std::function<void(const TuningConfig& previous, const TuningConfig& current)>;
+
+    /** @brief Config whose current snapshot, and the base of every reload, is @p defaults. */
+    explicit LiveConfig(TuningConfig defaults = {});
+    ~LiveConfig();
+
+    LiveConfig(const LiveConfig&) = delete;
+    LiveConfig& operator=(const LiveConfig&) = delete;
+
+    /** @brief Current snapshot (one acquire load; valid for the LiveConfig's lifetime). */
+    const TuningConfig& current() const { return *current_.load(std::memory_order_acquire); }
+
+    /** @brief Snapshots published so far (1 = only the defaults). */
+    std::uint64_t version() const { return version_.load(std::memory_order_relaxed); }
+
+    /** @brief Makes @p config current and tells the listeners. */
+    void publish(TuningConfig config);
+
+    /** @brief Parses @p text over the defaults and publishes it; nothing changes on error. */
+    ConfigError reload(std::string_view text);
+
+    /** @brief @ref reload with the contents of @p path. */
+    ConfigError reload_file(const std::string& path);
+
+    /**
+     * @brief Reloads @p path whenever its modification time changes, checked every
+     *        @p interval on a thread of its own (replaces an earlier watch).
+     * @return The first load's outcome; the watch starts either way, so a file fixed
+     *         later is picked up.
+     */
+    ConfigError watch(const std::string& path, std::chrono::milliseconds interval = std::chrono::seconds(1));
+
+    /** @brief Stops the watch thread, if any. */
+    void stop_watching();
+
+    /** @brief Outcome of the watch thread's last reload (Ok before the first). */
+    ConfigError last_watch_error() const;
+
+    /** @brief Adds @p listener; returns the id that removes it. */
+    std::uint64_t subscribe(Listener listener);
+
+    /** @brief Removes a listener; after return it is not running and will not run again. */
+    void unsubscribe(std::uint64_t id);
+
+private:
+    const TuningConfig defaults_;
+    std::atomic<const TuningConfig*> current_{nullptr};
+    std::atomic<std::uint64_t> version_{0};
+
+    mutable std::mutex mutex_;                                      /**< Serialises publishes and listeners. */
+    std::vector<std::unique_ptr<const TuningConfig>> published_;    /**< Every snapshot, kept for readers. */
+    std::vector<std::pair<std::uint64_t, Listener>> listeners_;
+    std::uint64_t next_listener_ = 1;
+    ConfigError watch_error_;
+
+    std::thread watcher_;
+    std::mutex watch_mutex_;
+    std::condition_variable watch_cv_;
+    bool watch_stop_ = false;
+};
+
+} // namespace booking
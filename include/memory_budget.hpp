@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file memory_budget.hpp
+ * @brief Live byte counts and budgets of the service's memory, per subsystem.
+ *
+ * Memory that grows while the service runs is counted in one of six subsystems. The cache
+ * of rendered availability, which grows from the read path, is charged when a rendering is
+ * published and released when it is retired. The other subsystems are measured by
+ * BookingService::memory_usage from the sizes of their structures, because charging every
+ * node of the catalog's maps would slow updates down for a figure only monitoring reads.
+ *
+ * A budget caps a subsystem. The cache will not publish a rendering that would take it
+ * over its budget, and BookingService::enforce_memory_budgets evicts what can be rebuilt
+ * or archived: rendered availability first, then shows that have already started (to
+ * cold storage). A total budget, e.g. a share of @ref cgroup_memory_limit, is enforced
+ * the same way.
+ */
+
+namespace booking {
+
+/** @brief What a byte of the service's memory is used for. */
+enum class MemorySubsystem : std::uint8_t {
+    Catalog, /**< Catalog snapshot (movies, theaters, shows, their indexes), interned strings, cold shows. */
+    States,  /**< Per-show seat words and owner tables (the show table). */
+    Indexes, /**< Optional read indexes: adjacent-seat summary, availability views. */
+    Holds,   /**< Hold slots and per-show hold masks. */
+    Caches,  /**< Rendered availability payloads (append_cached_available_seats). */
+    Buffers, /**< Journal ring and batch, change feed ring, request dedupe table. */
+};
+
+/** @brief Number of @ref MemorySubsystem values. */
+constexpr int kMemorySubsystems = 6;
+
+/** @brief Lower-case name of a subsystem (e.g. "caches"). */
+const char* to_string(MemorySubsystem subsystem);
+
+/** @brief Bytes of every subsystem at one point in time (see BookingService::memory_usage). */
+struct MemoryUsage {
+    std::array<std::size_t, kMemorySubsystems> live{};   /**< Bytes in use, by subsystem. */
+    std::array<std::size_t, kMemorySubsystems> peak{};   /**< Highest live value seen, by subsystem. */
+    std::array<std::size_t, kMemorySubsystems> budget{}; /**< Budget, by subsystem (0 = none). */
+    std::size_t total = 0;                               /**< Sum of @ref live. */
+    std::size_t total_budget = 0;                        /**< Budget of @ref total (0 = none). */
+
+    /** @brief Live bytes of @p s. */
+    std::size_t of(MemorySubsystem s) const { return live[static_cast<std::size_t>(s)]; }
+
+    /** @brief True if @p s is above its budget. */
+    bool over(MemorySubsystem s) const {
+        const auto i = static_cast<std::size_t>(s);
+        return budget[i] != 0u && live[i] > budget[i];
+    }
+};
+
+/** @brief What BookingService::enforce_memory_budgets evicted. */
+struct MemoryEviction {
+    std::size_t renderings = 0;     /**< Cached availability payloads dropped. */
+    std::size_t shows_archived = 0; /**< Started shows moved to cold storage. */
+};
+
+/**
+ * @brief Live byte counters and budgets of the subsystems.
+ *
+ * @details
+ * Each counter has its own cache line. Counters change when a rendering is published or
+ * retired, or when usage is measured, not on every request, so relaxed read-modify-writes
+ * on them are cheap enough.
+ */
+class MemoryAccounts {
+public:
+    /** @brief Counts @p bytes more for @p s. */
+    void charge(MemorySubsystem s, std::size_t bytes);
+
+    /**
+     * @brief Counts @p bytes more for @p s unless that would take it over its budget.
+     * @return False (nothing charged) if it would.
+     */
+    bool try_charge(MemorySubsystem s, std::size_t bytes);
+
+    /** @brief Counts @p bytes less for @p s. */
+    void release(MemorySubsystem s, std::size_t bytes);
+
+    /** @brief Sets the count of a subsystem that is measured rather than charged. */
+    void set(MemorySubsystem s, std::size_t bytes);
+
+    /** @brief Live bytes of @p s. */
+    std::size_t live(MemorySubsystem s) const {
+        return counter(s).live.load(std::memory_order_relaxed);
+    }
+
+    /** @brief Caps @p s at @p bytes (0 = no budget). */
+    void set_budget(MemorySubsystem s, std::size_t bytes) { counter(s).budget.store(bytes, std::memory_order_relaxed); }
+
+    /** @brief Budget of @p s (0 = none). */
+    std::size_t budget(MemorySubsystem s) const { return counter(s).budget.load(std::memory_order_relaxed); }
+
+    /** @brief Caps the sum of all subsystems at @p bytes (0 = no budget). */
+    void set_total_budget(std::size_t bytes) { total_budget_.store(bytes, std::memory_order_relaxed); }
+
+    /** @brief Budget of the sum of all subsystems (0 = none). */
+    std::size_t total_budget() const { return total_budget_.load(std::memory_order_relaxed); }
+
+    /** @brief Sum of the live bytes of all subsystems. */
+    std::size_t total() const;
+
+    /** @brief Current counts, peaks and budgets. */
+    MemoryUsage usage() const;
+
+private:
+    struct alignas(64) Counter {
+        std::atomic<std::size_t> live{0};
+        std::atomic<std::size_t> peak{0};
+        std::atomic<std::size_t> budget{0};
+    };
+
+    Counter& counter(MemorySubsystem s) { return counters_[static_cast<std::size_t>(s)]; }
+    const Counter& counter(MemorySubsystem s) const { return counters_[static_cast<std::size_t>(s)]; }
+
+    /** @brief Raises the peak of @p c to @p live if it is higher. */
+    static void raise_peak(Counter& c, std::size_t live);
+
+    std::array<Counter, kMemorySubsystems> counters_;
+    std::atomic<std::size_t> total_budget_{0};
+};
+
+/**
+ * @brief Memory limit of the process's cgroup: memory.max (v2) or
+ *        memory.limit_in_bytes (v1); 0 if there is none or it cannot be read.
+ */
+std::size_t cgroup_memory_limit();
+
+} // namespace booking
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * @file mpsc_queue.hpp
+ * @brief Unbounded lock-free multi-producer / single-consumer intrusive queue.
+ *
+ * Producers link their node with one exchange on the head and one store (never a CAS
+ * loop, so a push is wait-free); the consumer walks the links from the tail. Nodes are
+ * owned by the caller: the queue never allocates or frees.
+ */
+
+namespace booking {
+
+/** @brief Link embedded in queued objects (derive from it). */
+struct MpscNode {
+    std::atomic<MpscNode*> next{nullptr};
+};
+
+/**
+ * @brief Intrusive MPSC queue of MpscNode-derived objects (Vyukov's algorithm).
+ *
+ * @details
+ * Any thread may @ref push; one thread at a time may @ref pop. Between the two steps of a
+ * push the newest node is not reachable yet: pop then reports the queue as empty, so a
+ * producer that needs its node consumed must notify the consumer after pushing.
+ */
+class MpscQueue {
+public:
+    MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /** @brief Appends @p node (not in any queue). Any thread. */
+    void push(MpscNode* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release); // links the node for the consumer
+    }
+
+    /** @brief Removes the oldest node, or returns nullptr if none is reachable. Consumer only. */
+    MpscNode* pop() {
+        MpscNode* tail = tail_;
+        MpscNode* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &stub_) { // skip the stub
+            if (!next) return nullptr;
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail_ = next;
+            return tail;
+        }
+        if (tail != head_.load(std::memory_order_acquire)) return nullptr; // a push is half done
+        // tail is the last node: put the stub behind it so it can be handed out
+        push(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            tail_ = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+private:
+    alignas(64) std::atomic<MpscNode*> head_; /**< Newest node (producers). */
+    alignas(64) MpscNode* tail_;              /**< Oldest node (consumer). */
+    MpscNode stub_;                           /**< Placeholder that keeps the list non-empty. */
+};
+
+} // namespace booking
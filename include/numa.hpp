@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @file numa.hpp
+ * @brief NUMA topology discovery and placement of show state and owner threads.
+ *
+ * On a multi-socket host a CAS on a booking word homed on the other socket costs several
+ * times a local one. With Local placement the shows are striped over the nodes in runs of
+ * kNumaStripeShows ids (one ShowTable chunk): each run's state is bound to its node's
+ * memory and, in OwnerThreads mode, owned by a worker pinned to that node, so a show's
+ * words are only ever touched from their own socket. Interleaved placement spreads the
+ * state pages round-robin over all nodes instead, the usual baseline.
+ *
+ * The topology is read from sysfs (/sys/devices/system/node); memory policies are set
+ * with the mbind system call directly, so no libnuma is needed. On a single-node host,
+ * or where sysfs or mbind is unavailable, every placement degrades to the normal
+ * behaviour.
+ */
+
+namespace booking {
+
+/** @brief Where show state and owner threads go. */
+enum class NumaPlacement : std::uint8_t {
+    Off,         /**< No binding, no pinning (first-touch). */
+    Local,       /**< Stripe shows over nodes; bind each stripe's state and pin its owners there. */
+    Interleaved, /**< Interleave the state pages over all nodes. */
+};
+
+const char* to_string(NumaPlacement placement);
+
+/** @brief Parses "off", "local" or "interleave"; false (and @p out unchanged) otherwise. */
+bool parse_numa_placement(std::string_view text, NumaPlacement& out);
+
+/** @brief Consecutive show ids placed on the same node (log2); matches ShowTable::kChunkBits. */
+constexpr int kNumaStripeBits = 6;
+constexpr std::int64_t kNumaStripeShows = std::int64_t{1} << kNumaStripeBits;
+
+/**
+ * @brief Parses a sysfs CPU list such as "0-3,8,10-11" into @p out (appended, ascending).
+ * @return false on malformed input.
+ */
+bool parse_cpu_list(std::string_view text, std::vector<int>& out);
+
+/**
+ * @brief NUMA nodes that have CPUs, in node id order.
+ */
+class NumaTopology {
+public:
+    /** @brief One node: OS id and its CPUs. */
+    struct Node {
+        int id = 0;
+        std::vector<int> cpus;
+    };
+
+    /**
+     * @brief Reads the nodes below @p node_dir (a sysfs-style directory of nodeN/cpulist files).
+     *
+     * @details
+     * Nodes without CPUs are skipped. If nothing can be read the result is one node 0
+     * holding every online CPU, so callers never see an empty topology.
+     */
+    static NumaTopology discover(const std::string& node_dir = "/sys/devices/system/node");
+
+    /** @brief Topology of this machine, discovered once. */
+    static const NumaTopology& system();
+
+    /** @brief Topology made of @p nodes (empty = one node with every online CPU). */
+    explicit NumaTopology(std::vector<Node> nodes);
+
+    std::size_t node_count() const { return nodes_.size(); }
+    const Node& node(std::size_t index) const { return nodes_[index]; }
+
+    /** @brief Index of the node holding @p cpu, or -1. */
+    int node_of_cpu(int cpu) const;
+
+    /** @brief Index of the node show @p show_id is placed on under Local placement. */
+    std::size_t node_of_show(std::int64_t show_id) const {
+        return show_id < 0 ? 0u : static_cast<std::size_t>(static_cast<std::uint64_t>(show_id) >> kNumaStripeBits)
+                                      % nodes_.size();
+    }
+
+private:
+    std::vector<Node> nodes_;
+};
+
+/**
+ * @brief Sets the memory policy of [@p data, @p data + @p bytes) before it is touched.
+ *
+ * @details
+ * Local binds the range to node @p node_index of @p topology; Interleaved interleaves it
+ * over all nodes; Off does nothing. @p data must be page-aligned.
+ *
+ * @return true if the policy was applied (always false for Off or a single-node topology).
+ */
+bool bind_memory(void* data, std::size_t bytes, const NumaTopology& topology, NumaPlacement placement,
+                 std::size_t node_index);
+
+/** @brief Restricts @p thread to the CPUs of node @p node_index; false if the kernel refused. */
+bool pin_to_node(std::thread& thread, const NumaTopology& topology, std::size_t node_index);
+
+/** @brief Sets the placement used for new show state and owner threads. Thread-safe. */
+void set_numa_placement(NumaPlacement placement);
+
+/** @brief Current setting of @ref set_numa_placement (Off by default). */
+NumaPlacement numa_placement();
+
+} // namespace booking
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "epoch.hpp"
+
+/**
+ * @file object_pool.hpp
+ * @brief Lock-free per-thread object pool with cross-thread return.
+ *
+ * Every thread has its own cache in each pool (keyed on EpochManager::thread_index): a
+ * plain free list it alone touches, plus an atomic stack that other threads push returned
+ * objects onto. An object always goes back to the cache of the thread that first carved
+ * it, so a producer/consumer pair (one thread acquires, another releases) recycles the
+ * same few blocks instead of migrating memory between threads. The owner takes the whole
+ * return stack with one exchange when its free list runs dry, which keeps the stack free
+ * of ABA. New storage is carved in blocks of kBlockObjects, so the allocator is only
+ * reached while a pool grows.
+ */
+
+namespace booking {
+
+/**
+ * @brief Pool of T objects recycled through per-thread caches.
+ *
+ * @details
+ * @ref acquire constructs an object and @ref release destroys it and keeps its storage;
+ * any thread may release an object acquired by any other. Threads beyond
+ * EpochManager::kMaxThreads bypass the pool and use the heap. Every object must be
+ * released before the pool is destroyed.
+ */
+template <typename T>
+class ObjectPool {
+public:
+    /** @brief Objects carved per block when a thread's cache is empty. */
+    static constexpr std::size_t kBlockObjects = 64;
+
+    ObjectPool() : caches_(new Cache[EpochManager::kMaxThreads]) {}
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    /** @brief Releases objects through the pool (for @ref Ptr). */
+    struct Deleter {
+        ObjectPool* pool = nullptr;
+        void operator()(T* object) const { pool->release(object); }
+    };
+
+    /** @brief Owning handle that returns its object to the pool. */
+    using Ptr = std::unique_ptr<T, Deleter>;
+
+    /** @brief Constructs a T from @p args in recycled storage. */
+    template <typename... Args>
+    T* acquire(Args&&... args) {
+        Node* node = take();
+        try {
+            return ::new (static_cast<void*>(node->storage)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            put(node);
+            throw;
+        }
+    }
+
+    /** @brief @ref acquire wrapped in a @ref Ptr. */
+    template <typename... Args>
+    Ptr make(Args&&... args) {
+        return Ptr(acquire(std::forward<Args>(args)...), Deleter{this});
+    }
+
+    /** @brief Destroys @p object and returns its storage to its home cache. Any thread. */
+    void release(T* object) {
+        if (!object) return;
+        object->~T();
+        put(reinterpret_cast<Node*>(object));
+    }
+
+    /** @brief Blocks carved so far (a sizing statistic). */
+    std::size_t blocks() const { return blocks_.load(std::memory_order_relaxed); }
+
+private:
+    struct Node {
+        alignas(T) unsigned char storage[sizeof(T)]; /**< First member: a T* is a Node*. */
+        Node* next = nullptr;                        /**< Free-list link. */
+        int home = -1;                               /**< Cache that carved it; -1 = heap. */
+    };
+
+    struct alignas(64) Cache {
+        Node* free = nullptr;                      /**< Owner-only free list. */
+        std::vector<std::unique_ptr<Node[]>> owned; /**< Blocks carved by this cache (owner only). */
+        alignas(64) std::atomic<Node*> returned{nullptr}; /**< Pushed by other threads. */
+    };
+
+    Node* take() {
+        const int index = EpochManager::thread_index();
+        if (index < 0) return new Node();
+        Cache& cache = caches_[static_cast<std::size_t>(index)];
+        if (!cache.free) cache.free = cache.returned.exchange(nullptr, std::memory_order_acquire);
+        if (!cache.free) {
+            std::unique_ptr<Node[]> block(new Node[kBlockObjects]);
+            for (std::size_t i = 0; i < kBlockObjects; ++i) {
+                block[i].home = index;
+                block[i].next = i + 1u < kBlockObjects ? &block[i + 1u] : nullptr;
+            }
+            cache.free = &block[0];
+            cache.owned.push_back(std::move(block));
+            blocks_.fetch_add(1u, std::memory_order_relaxed);
+        }
+        Node* node = cache.free;
+        cache.free = node->next;
+        return node;
+    }
+
+    void put(Node* node) {
+        if (node->home < 0) {
+            delete node;
+            return;
+        }
+        Cache& home = caches_[static_cast<std::size_t>(node->home)];
+        if (node->home == EpochManager::thread_index()) {
+            node->next = home.free;
+            home.free = node;
+            return;
+        }
+        Node* head = home.returned.load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while (!home.returned.compare_exchange_weak(head, node, std::memory_order_release,
+                                                      std::memory_order_relaxed));
+    }
+
+    std::unique_ptr<Cache[]> caches_;
+    std::atomic<std::size_t> blocks_{0};
+};
+
+} // namespace booking
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "booking_service.hpp"
+#include "journal.hpp"
+
+/**
+ * @file offline_kiosk.hpp
+ * @brief Offline kiosk: sells from a block of seats leased by the core service, without a
+ *        round trip per sale, and reconciles through its local journal when reconnected.
+ *
+ * A lobby kiosk that loses its link to the core would otherwise stop selling. Instead,
+ * while connected, it leases a block of seats per show (BookingService::lease_seat_mask):
+ * the core books the block under the lease's id, so no other seller can take those seats.
+ * The kiosk then books from the block in memory, under a mutex, and appends each sale to a
+ * journal of its own; the sale is durable once that journal has synced it. Conflicts are
+ * impossible by construction: the kiosk only sells seats nobody else can.
+ *
+ * reconcile() replays the pending sales in sale order: each becomes a booking of its own in
+ * the core (BookingService::settle_lease), and the kiosk reports the core's BookingId of
+ * every sale. Unsold seats can be given back at the same time. Once everything is settled
+ * the local journal is compacted to the leases and sales still open.
+ *
+ * The local journal uses the core's format: a lease is a Book record under the lease's id,
+ * a sale a Book record under a kiosk sale id (kKioskSaleBit set, so it never equals a core
+ * BookingId), and Cancel records end sales and remove seats from a lease. open() replays it,
+ * so a restarted kiosk keeps its leases and the sales it has not reconciled yet. A kiosk
+ * that stops between the core settling a sale and its own journal recording that reports
+ * the sale as a conflict on the next reconcile (NotOwner: the lease no longer owns it).
+ *
+ * With KioskOptions::lease_ttl the core returns a lease's unsold seats by itself once its
+ * TTL elapses (BookingService::expire_leases), so an allotment given to a partner site
+ * that never comes back is not lost; the kiosk stops selling KioskOptions::sell_margin
+ * before that, and renew() extends the lease while the link is up.
+ *
+ * The core is reached through functions, so any transport works; the BookingService
+ * constructor wires them to a service in process. Layouts come from the kiosk's own copy
+ * of the schedule, so labels are parsed offline.
+ */
+
+namespace booking {
+
+/** @brief Set in every kiosk sale id (core BookingIds stay below it). */
+inline constexpr BookingId kKioskSaleBit = BookingId{1} << 31;
+
+/** @brief Offline kiosk configuration. */
+struct KioskOptions {
+    std::string journal_path;                 /**< Local journal of leases and sales. */
+    JournalMode mode = JournalMode::Sync;     /**< Sync: a sale returns once it is durable. */
+    std::chrono::milliseconds lease_ttl{0};   /**< TTL asked for each lease and renewal (0 = none). */
+    std::chrono::milliseconds sell_margin{0}; /**< Sales stop this long before a lease's TTL elapses. */
+};
+
+/** @brief Outcome of OfflineKiosk::reconcile. */
+struct KioskReconcile {
+    /** @brief One sale sent to the core. */
+    struct Sale {
+        ShowId show_id;
+        BookingId sale_id = 0;    /**< Kiosk sale id given to the buyer. */
+        BookingId booking_id = 0; /**< Core BookingId of the seats (0 if not settled). */
+        SeatMask seats;
+        BookingStatus status = BookingStatus::Ok; /**< The core's answer (NotOwner: the lease lost the seats). */
+    };
+    std::vector<Sale> sales;   /**< Sales answered by the core, in sale order. */
+    std::size_t settled = 0;   /**< Sales that became bookings. */
+    std::size_t conflicts = 0; /**< Sales the core refused (their seats are dropped from the lease). */
+    std::size_t returned = 0;  /**< Unsold seats given back. */
+    bool complete = true;      /**< False if the core became unreachable: call again later. */
+};
+
+/**
+ * @brief Sells leased seats locally and settles them with the core later.
+ *
+ * @details
+ * Thread-safe. One lease per show at a time; reconcile() with return_unsold ends them.
+ */
+class OfflineKiosk {
+public:
+    /** @brief Leases @p block in the core (lease_seat_mask) into @p out; false if unreachable. */
+    using Lease =
+        std::function<bool(ShowId show_id, const SeatMask& block, std::chrono::milliseconds ttl, BookingResult& out)>;
+    /** @brief Renews lease @p lease_id in the core (renew_lease) into @p out; false if unreachable. */
+    using Renew =
+        std::function<bool(ShowId show_id, BookingId lease_id, std::chrono::milliseconds ttl, BookingResult& out)>;
+    /**
+     * @brief Settles sold seats of lease @p lease_id (settle_lease), or returns unsold ones
+     *        (cancel_seat_mask with the lease's id), into @p out; false if unreachable.
+     */
+    using Settle = std::function<bool(ShowId show_id, const SeatMask& seats, BookingId lease_id, BookingResult& out)>;
+    /** @brief Layout of a show from the kiosk's schedule (nullptr if unknown). */
+    using Layouts = std::function<const HallLayout*(ShowId show_id)>;
+
+    /** @brief Kiosk of a core reached through @p lease, @p renew, @p settle and @p give_back. */
+    OfflineKiosk(Lease lease, Renew renew, Settle settle, Settle give_back, Layouts layouts, KioskOptions options);
+
+    /** @brief Kiosk of an in-process core (tests, single-binary deployments). */
+    OfflineKiosk(BookingService& core, KioskOptions options);
+
+    OfflineKiosk(const OfflineKiosk&) = delete;
+    OfflineKiosk& operator=(const OfflineKiosk&) = delete;
+
+    /**
+     * @brief Replays the local journal (leases and pending sales) and opens it for appending.
+     * @note Call once, before anything else.
+     */
+    JournalStatus open();
+
+    /**
+     * @brief Leases @p block of @p show_id from the core (needs the link).
+     * @return The core's answer (id = the lease's BookingId); InvalidShow if the kiosk has
+     *         no layout for the show, AlreadyBooked (conflicts = the current block) if the
+     *         show already has a lease here, Busy if the core could not be reached.
+     */
+    BookingResult lease(ShowId show_id, const SeatMask& block);
+
+    /**
+     * @brief Extends the show's lease by KioskOptions::lease_ttl from now (needs the link).
+     * @return The core's answer; InvalidShow if the show has no lease here, Busy if the
+     *         core could not be reached. A restarted kiosk renews before selling again.
+     */
+    BookingResult renew(ShowId show_id);
+
+    /**
+     * @brief Books seats from the show's lease, without the core.
+     * @return Ok with the kiosk sale id; InvalidShow if the show has no lease here, label
+     *         errors as BookingService::book_seats, AlreadyBooked (conflicts = the seats
+     *         sold or not leased) if a seat is not free in the lease, HoldExpired within
+     *         KioskOptions::sell_margin of the lease's TTL.
+     */
+    BookingResult book_seats(ShowId show_id, const std::vector<std::string>& seat_labels);
+
+    /** @brief Cancels seats of a sale not reconciled yet; they are free in the lease again. */
+    BookingResult cancel_seats(ShowId show_id, const std::vector<std::string>& seat_labels, BookingId sale_id);
+
+    /** @brief Free seats of the show's lease in @p out_free; -1 if the show has no lease. */
+    int available_seats_mask(ShowId show_id, SeatMask& out_free) const;
+
+    /** @brief Labels of the free seats of the show's lease, row-major. */
+    std::vector<std::string> list_available_seats(ShowId show_id) const;
+
+    /**
+     * @brief Settles every pending sale with the core, in sale order, then (if
+     *        @p return_unsold) gives back each lease's unsold seats and ends the leases.
+     *
+     * @details
+     * Stops at the first call the core does not answer; sales keep their order and the
+     * next call resumes. Sales made meanwhile wait for the next call. Leases whose TTL
+     * elapsed end here: the core returns their unsold seats itself (expire_leases).
+     */
+    KioskReconcile reconcile(bool return_unsold = false);
+
+    /** @brief Sales not reconciled yet. */
+    std::size_t pending_sales() const;
+
+private:
+    /** @brief A lease held for one show. */
+    struct Leased {
+        BookingId lease_id = 0;
+        std::shared_ptr<const HallLayout> layout; /**< nullptr if the kiosk's schedule lost the show. */
+        SeatMask block;                           /**< Seats still leased (sold ones until settled). */
+        SeatMask free;                            /**< Seats of the block not sold. */
+        /** Core deadline as seen here (max = no TTL; min = unknown after a restart, renew first). */
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    };
+
+    /** @brief A sale not reconciled yet. */
+    struct Sale {
+        ShowId show_id;
+        SeatMask seats;
+    };
+
+    /** @brief Applies one record of the local journal (replay and live updates share it). */
+    void apply(JournalOp op, ShowId show_id, BookingId id, const SeatMask& seats);
+
+    /** @brief In Sync mode, waits until @p commit_lsn is durable (called unlocked). */
+    void await(std::uint64_t commit_lsn);
+
+    /** @brief Labels to seats of @p layout; status as BookingService::book_seats. */
+    static BookingResult parse(const HallLayout& layout, const std::vector<std::string>& labels, SeatMask& out);
+
+    /** @brief Rewrites the journal as the open leases and sales (after a complete reconcile). */
+    void checkpoint();
+
+    Lease lease_;
+    Renew renew_;
+    Settle settle_;
+    Settle give_back_;
+    Layouts layouts_;
+    KioskOptions options_;
+
+    Journal journal_;
+    mutable std::mutex mutex_;                     /**< Guards the state below; appends happen under it. */
+    std::unordered_map<ShowId, Leased> leases_;
+    std::map<BookingId, Sale> sales_;              /**< Pending sales by sale id: sale order. */
+    BookingId next_sale_ = 1;                      /**< Next sale id without kKioskSaleBit. */
+    std::mutex core_mutex_;                        /**< One lease or reconcile at a time. */
+};
+
+} // namespace booking
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "booking_service.hpp"
+#include "mpsc_queue.hpp"
+
+/**
+ * @file payment_workflow.hpp
+ * @brief Hold-to-payment workflow: hold seats, hand out a ticket, settle on the payment callback.
+ *
+ * A payment provider answers in seconds. Holding seats, waiting for the provider and then
+ * confirming on the same thread costs a thread per payment in flight. Here @ref
+ * PaymentWorkflow::begin holds the seats (BookingService::hold_seats) and returns at
+ * once with a PaymentTicket; the payment system later reports the outcome with @ref
+ * PaymentWorkflow::complete from whatever thread its callback runs on. That call only
+ * flips the ticket's state and queues it. A small set of settling workers then confirms
+ * or releases the hold and runs the ticket's completion. A pending payment is one slot of
+ * a fixed table (about a hundred bytes), not a blocked thread.
+ *
+ * A ticket the payment system never answers is settled as TimedOut once its hold's TTL
+ * has elapsed, so the slot is not lost.
+ *
+ * @code
+ * PaymentWorkflow payments(service);
+ * const BookingResult r = payments.begin(show, {"a1", "a2"}, std::chrono::minutes(5),
+ *     [](PaymentTicket, PaymentOutcome outcome, const BookingResult& settled) {
+ *         if (outcome == PaymentOutcome::Paid && settled.success) reply_booked(settled.id);
+ *     });
+ * if (r.success) provider.charge(card, [&payments, ticket = r.id](bool ok) {
+ *     payments.complete(ticket, ok ? PaymentOutcome::Paid : PaymentOutcome::Declined);
+ * });
+ * @endcode
+ */
+
+namespace booking {
+
+/** @brief Ticket of a pending payment returned by PaymentWorkflow::begin (never 0). */
+using PaymentTicket = std::uint64_t;
+
+/** @brief How a payment ended. */
+enum class PaymentOutcome : std::uint8_t {
+    Paid,     /**< Charged: the hold is confirmed into a booking. */
+    Declined, /**< Refused: the hold is released. */
+    TimedOut, /**< No answer before the hold's TTL (or the provider gave up): the hold is released. */
+};
+
+/** @brief Static name of a payment outcome ("paid", "declined", "timed out"). */
+const char* to_string(PaymentOutcome outcome);
+
+/** @brief Counters of a PaymentWorkflow (approximate while payments are settling). */
+struct PaymentStats {
+    std::uint64_t started = 0;   /**< Tickets handed out. */
+    std::uint64_t paid = 0;      /**< Settled as Paid (the confirmation itself may still have failed). */
+    std::uint64_t declined = 0;  /**< Settled as Declined. */
+    std::uint64_t timed_out = 0; /**< Settled as TimedOut, reported or swept. */
+    std::uint64_t pending = 0;   /**< Tickets not settled yet. */
+};
+
+/**
+ * @brief Table of pending payments settled by worker threads through MPSC queues.
+ *
+ * @details
+ * Tickets live in a fixed table of slots recycled through a lock-free free list, like
+ * the service's hold slots: a ticket carries its slot and the slot's generation, so a late
+ * or repeated @ref complete of a settled ticket fails its CAS instead of touching the
+ * slot's next payment. Tickets of show s settle on worker s % workers, in the order they
+ * were completed. Idle workers park on a condition variable with a short timeout, and
+ * worker 0 sweeps the table for expired tickets on its way.
+ */
+class PaymentWorkflow {
+public:
+    /**
+     * @brief Called on a settling worker once a ticket is settled.
+     *
+     * @details @p result is the confirmation (Paid: Ok with the BookingId, or HoldExpired
+     * if the payment came after the hold's TTL), the release (Declined: Ok, or
+     * UnknownHold if the hold had already expired) or HoldExpired (TimedOut).
+     */
+    using Completion = std::function<void(PaymentTicket ticket, PaymentOutcome outcome, const BookingResult& result)>;
+
+    /** @brief Default number of ticket slots. */
+    static constexpr std::size_t kDefaultCapacity = 16384;
+
+    /**
+     * @brief Starts @p workers settling threads over @p service (kept by reference).
+     * @param capacity Tickets that may be pending at once.
+     * @param sweep_interval How often expired tickets are looked for.
+     */
+    explicit PaymentWorkflow(BookingService& service, unsigned workers = 1, std::size_t capacity = kDefaultCapacity,
+                             std::chrono::milliseconds sweep_interval = std::chrono::milliseconds(100));
+
+    /**
+     * @brief Settles the completed tickets, stops the workers, then releases the holds of
+     *        tickets still pending (their completions are not called).
+     */
+    ~PaymentWorkflow();
+
+    PaymentWorkflow(const PaymentWorkflow&) = delete;
+    PaymentWorkflow& operator=(const PaymentWorkflow&) = delete;
+
+    /** @brief Number of settling workers. */
+    unsigned worker_count() const { return static_cast<unsigned>(workers_.size()); }
+
+    /**
+     * @brief Holds @p seat_labels of @p show_id for @p ttl and registers @p done for the payment.
+     *
+     * @return On success, BookingResult::id is the PaymentTicket; otherwise the
+     *         BookingService::hold_seats failure, or Busy if every ticket slot is pending.
+     *         @p done is only called for a ticket that was handed out. Thread-safe.
+     */
+    BookingResult begin(ShowId show_id, const std::vector<std::string>& seat_labels, std::chrono::milliseconds ttl,
+                        Completion done);
+
+    /**
+     * @brief Reports the payment of @p ticket; the ticket is settled on its worker.
+     *
+     * @return False if the ticket is unknown or already settled (a repeated callback, or
+     *         one arriving after the ticket timed out). Thread-safe and non-blocking.
+     */
+    bool complete(PaymentTicket ticket, PaymentOutcome outcome);
+
+    /** @brief Tickets handed out and not settled yet. */
+    std::size_t pending() const { return pending_.load(std::memory_order_relaxed); }
+
+    PaymentStats stats() const;
+
+private:
+    /** @brief Lifecycle of a ticket slot (low 32 bits of Slot::state). */
+    enum Phase : std::uint32_t {
+        kFree = 0,     /**< On the free list. */
+        kPending = 1,  /**< Seats held, waiting for the payment. */
+        kSettling = 2, /**< Outcome known (Slot::outcome), queued to its worker. */
+    };
+
+    static constexpr std::uint32_t kNoSlot = 0xFFFFFFFFu;
+
+    /**
+     * @brief One pending payment.
+     *
+     * @details
+     * The plain fields are written by @ref begin before @c state turns Pending (release)
+     * and read by the worker after the CAS of @ref complete or the sweep (acquire). Only
+     * the deadline is atomic: the sweep reads it before its CAS validates the generation.
+     */
+    struct Slot : MpscNode {
+        std::atomic<std::uint64_t> state{std::uint64_t{1} << 32}; /**< (generation << 32) | Phase. */
+        std::atomic<std::uint32_t> next{kNoSlot};                 /**< Free list link. */
+        PaymentOutcome outcome = PaymentOutcome::Paid;
+        ShowId show_id;
+        HoldId hold = 0;
+        std::atomic<std::int64_t> deadline_ns{0}; /**< Hold expiry (steady_clock); read by the sweep. */
+        Completion done;
+    };
+
+    struct alignas(64) Worker {
+        MpscQueue queue;
+        std::thread thread;
+        std::atomic<bool> parked{false}; /**< Announced before sleeping (Dekker with complete). */
+        std::mutex park_mutex;
+        std::condition_variable park_cv;
+    };
+
+    std::uint32_t pop_free();
+    void push_free(std::uint32_t slot);
+
+    /** @brief Moves a pending slot to Settling with @p outcome; false if @p expected is stale. */
+    bool settle(Slot& s, std::uint64_t expected, PaymentOutcome outcome);
+
+    /** @brief Times out the pending tickets whose hold has expired by @p now. */
+    void sweep(std::chrono::steady_clock::time_point now);
+
+    /** @brief Confirms or releases every ticket queued for @p w; returns how many ran. */
+    std::size_t drain(Worker& w);
+    void worker_loop(unsigned index);
+
+    BookingService& service_;
+    const std::size_t capacity_;
+    const std::chrono::milliseconds sweep_interval_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<std::uint64_t> free_{kNoSlot}; /**< Tagged Treiber stack head: (tag << 32) | slot. */
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<std::size_t> pending_{0};
+    std::atomic<std::uint64_t> started_{0};
+    std::atomic<std::uint64_t> paid_{0};
+    std::atomic<std::uint64_t> declined_{0};
+    std::atomic<std::uint64_t> timed_out_{0};
+    std::atomic<bool> stopping_{false};
+};
+
+} // namespace booking
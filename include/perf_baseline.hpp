@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "span.hpp"
+
+/**
+ * @file perf_baseline.hpp
+ * @brief Statistical comparison of Google Benchmark results against a stored baseline.
+ *
+ * The performance regression suite (ctest label @c booking_perf, tool booking_perf_check)
+ * runs a fixed set of booking_bench benchmarks with repetitions and compares each
+ * benchmark's per-repetition times with those of a committed baseline, both in the JSON
+ * format booking_bench writes with @c --benchmark_out. A benchmark regressed when its
+ * median time grew by more than a threshold and a two-sided Mann-Whitney U test says the
+ * two sets of repetitions differ (the test is on ranks, so one slow outlier repetition
+ * neither hides nor fakes a change).
+ */
+
+namespace booking {
+
+/** @brief Repetitions of one benchmark (aggregate rows are skipped). */
+struct PerfRun {
+    std::string name;        /**< run_name, e.g. "BM_FindShow/10000". */
+    std::vector<double> ns;  /**< Time per iteration of each repetition, in nanoseconds. */
+};
+
+/**
+ * @brief Reads the iteration rows of Google Benchmark JSON output, grouped by run name.
+ *
+ * @details
+ * Uses real_time for benchmarks measured in real time (a "/real_time" component in the
+ * run name), else cpu_time.
+ *
+ * @return False if @p json is not benchmark output (no "benchmarks" array, or a row
+ *         without a name or time).
+ */
+bool parse_benchmark_json(std::string_view json, std::vector<PerfRun>& out);
+
+/** @brief Two-sided p-value of the Mann-Whitney U test (normal approximation, ties corrected). */
+double mann_whitney_p(Span<const double> a, Span<const double> b);
+
+/** @brief Regression thresholds. */
+struct PerfThresholds {
+    double max_slowdown = 0.10; /**< Tolerated growth of the median time (0.10 = 10%). */
+    double alpha = 0.05;        /**< Significance level of the U test. */
+};
+
+/** @brief Outcome of one benchmark. */
+enum class PerfVerdict : std::uint8_t {
+    Unchanged,  /**< No significant difference. */
+    Faster,     /**< Significantly faster. */
+    Slower,     /**< Significantly slower, within max_slowdown. */
+    Regression, /**< Significantly slower by more than max_slowdown. */
+    Missing,    /**< In the baseline but not measured. */
+    New,        /**< Measured but not in the baseline. */
+};
+
+/** @brief Static name of a verdict (e.g. "regression"). */
+const char* to_string(PerfVerdict verdict);
+
+/** @brief Comparison of one benchmark. */
+struct PerfDelta {
+    std::string name;
+    double baseline_ns = 0; /**< Median of the baseline (0 if New). */
+    double current_ns = 0;  /**< Median of the measurement (0 if Missing). */
+    double change = 0;      /**< current / baseline - 1. */
+    double p_value = 1;
+    PerfVerdict verdict = PerfVerdict::Unchanged;
+};
+
+/** @brief Compares every benchmark of @p baseline and @p current (baseline order, new ones last). */
+std::vector<PerfDelta> compare_perf(const std::vector<PerfRun>& baseline, const std::vector<PerfRun>& current,
+                                    const PerfThresholds& thresholds = {});
+
+/** @brief True if a comparison fails the suite (a Regression or a Missing benchmark). */
+bool perf_failed(const std::vector<PerfDelta>& deltas);
+
+/** @brief Writes one line per benchmark: medians, change, p-value and verdict. */
+void write_perf_report(std::ostream& out, const std::vector<PerfDelta>& deltas);
+
+} // namespace booking
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file pmem.hpp
+ * @brief Cache-line write-back for seat state kept in persistent memory.
+ *
+ * On a DAX mapping (a file on a PMEM or CXL memory filesystem mapped with MAP_SYNC) a
+ * store is durable once its cache line has been written back to the memory and the
+ * write-back is fenced. flush() writes back the lines of a range without waiting, so a
+ * booking flushes its words and owners and then pays one drain() before it is
+ * acknowledged.
+ *
+ * The instruction is picked once at run time (CPUID): CLWB, which keeps the line cached,
+ * else CLFLUSHOPT, else CLFLUSH (which is ordered by itself). Builds for other
+ * architectures compile the portable stub: flush() does nothing and drain() is a fence.
+ */
+
+namespace booking {
+namespace pmem {
+
+/** @brief Write-back instruction used by flush(). */
+enum class FlushKind : std::uint8_t {
+    None,       /**< Not an x86 build: nothing to write back by hand. */
+    Clflush,    /**< CLFLUSH: evicts the line; serialised, drain() is a no-op fence. */
+    Clflushopt, /**< CLFLUSHOPT: evicts the line; ordered by drain(). */
+    Clwb,       /**< CLWB: writes the line back and may keep it cached; ordered by drain(). */
+};
+
+/** @brief Instruction name of @p kind ("clwb", ...; "none"). */
+const char* to_string(FlushKind kind);
+
+/** @brief Instruction flush() uses on this CPU. */
+FlushKind flush_kind();
+
+/** @brief Starts writing back every cache line of [@p addr, @p addr + @p bytes). */
+void flush(const void* addr, std::size_t bytes);
+
+/** @brief Waits until the write-backs started so far are durable (SFENCE). */
+void drain();
+
+/** @brief flush() then drain(). */
+inline void persist(const void* addr, std::size_t bytes) {
+    flush(addr, bytes);
+    drain();
+}
+
+} // namespace pmem
+} // namespace booking
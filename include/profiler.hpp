@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "ids.hpp"
+#include "service_metrics.hpp"
+
+/**
+ * @file profiler.hpp
+ * @brief Per-thread "current API call / show" tags for sampling profilers, and a SIGPROF
+ *        sampler that counts CPU samples by tag.
+ *
+ * When CPU spikes, a flame graph of functions does not say which shows or calls burn it.
+ * Every thread keeps one ProfileTag: the public entry points set the API for their scope
+ * (ProfileScope, restored on return) and each show lookup sets the show, so a sample can
+ * be attributed by reading the tag of the thread it interrupted. Tagging is two relaxed
+ * thread-local stores per call and one per lookup; nothing is shared between threads.
+ *
+ * profile_start() arms ITIMER_PROF: the kernel sends SIGPROF as the process consumes CPU,
+ * and the handler (async-signal-safe: no allocation, no lock) adds the interrupted
+ * thread's tag to a fixed lock-free table. profile_collect() reads the counts and
+ * write_folded_profile() renders them as folded stacks ("book_seats;show 42 17") for
+ * flamegraph.pl, speedscope or inferno. External samplers (perf with a user-space hook,
+ * an eBPF profiler reading TLS) can read profile_tag() the same way.
+ *
+ * Work a thread does outside any API call (background passes, owner threads running a
+ * request for another thread) is tagged with no API and the last show it looked up.
+ *
+ * Tagging compiles to nothing without BOOKING_PROFILE_TAGS (CMake option of the same name);
+ * the sampler still runs and counts every sample under no API and no show.
+ */
+
+#ifndef BOOKING_PROFILE_TAGS
+#define BOOKING_PROFILE_TAGS 0
+#endif
+
+namespace booking {
+
+/** @brief API tag value meaning "not inside a public call". */
+inline constexpr std::uint8_t kNoProfileApi = 0xFF;
+
+/** @brief What a thread is working on, as seen by a sampler interrupting it. */
+struct ProfileTag {
+    std::atomic<std::int64_t> show{-1};            /**< Show id of the last lookup (-1 = none). */
+    std::atomic<std::uint8_t> api{kNoProfileApi};  /**< MetricsApi of the innermost call in progress. */
+};
+
+namespace detail {
+
+inline thread_local ProfileTag profile_tag_local;
+
+} // namespace detail
+
+/** @brief The calling thread's tag (constant-initialised thread-local; safe to read from a signal handler). */
+inline ProfileTag& profile_tag() { return detail::profile_tag_local; }
+
+/** @brief Tags the calling thread with @p show_id (done by every show lookup). */
+inline void profile_tag_show(ShowId show_id) {
+#if BOOKING_PROFILE_TAGS
+    detail::profile_tag_local.show.store(show_id.value(), std::memory_order_relaxed);
+#else
+    (void)show_id;
+#endif
+}
+
+/**
+ * @brief Tags the enclosing scope with an API call; the previous tag (API and show) is
+ *        restored on exit, so nested calls attribute to the innermost one.
+ */
+class ProfileScope {
+public:
+#if BOOKING_PROFILE_TAGS
+    explicit ProfileScope(MetricsApi api)
+        : api_(detail::profile_tag_local.api.load(std::memory_order_relaxed)),
+          show_(detail::profile_tag_local.show.load(std::memory_order_relaxed)) {
+        detail::profile_tag_local.api.store(static_cast<std::uint8_t>(api), std::memory_order_relaxed);
+        std::atomic_signal_fence(std::memory_order_release);
+    }
+
+    ~ProfileScope() {
+        std::atomic_signal_fence(std::memory_order_release);
+        detail::profile_tag_local.api.store(api_, std::memory_order_relaxed);
+        detail::profile_tag_local.show.store(show_, std::memory_order_relaxed);
+    }
+#else
+    explicit ProfileScope(MetricsApi api) { (void)api; }
+#endif
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+#if BOOKING_PROFILE_TAGS
+private:
+    std::uint8_t api_;
+    std::int64_t show_;
+#endif
+};
+
+/** @brief CPU samples of one (API, show) tag. */
+struct ProfileSample {
+    std::uint8_t api = kNoProfileApi; /**< MetricsApi value or kNoProfileApi. */
+    ShowId show = -1;                 /**< -1 = no show looked up. */
+    std::uint64_t samples = 0;
+};
+
+/** @brief Distinct tags the sampler counts; samples of further tags are dropped (see profile_dropped()). */
+inline constexpr std::size_t kProfileTags = 4096;
+
+/**
+ * @brief Starts sampling the process's CPU time @p hz times per second (SIGPROF).
+ * @return False if sampling already runs or the timer or handler could not be installed.
+ */
+bool profile_start(int hz = 997);
+
+/** @brief Stops sampling and restores the previous SIGPROF handler; the counts are kept. */
+void profile_stop();
+
+/** @brief True between profile_start() and profile_stop(). */
+bool profile_running();
+
+/** @brief Counts per tag, most samples first. */
+std::vector<ProfileSample> profile_collect();
+
+/** @brief Clears the counts (call while sampling is stopped). */
+void profile_reset();
+
+/** @brief Samples dropped because the tag table was full. */
+std::uint64_t profile_dropped();
+
+/**
+ * @brief Writes @p samples as folded stacks, one "api;show N count" line each (frames
+ *        "(none)" / "(no show)" where the tag is unset), for flame graph tools.
+ */
+void write_folded_profile(std::ostream& out, const std::vector<ProfileSample>& samples);
+
+} // namespace booking
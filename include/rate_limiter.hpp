@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @file rate_limiter.hpp
+ * @brief Per-client token buckets in a lock-free open-addressing table.
+ *
+ * The server checks every request against its client's bucket before it is parsed, so a
+ * bot that floods one connection (or many from one address) is turned away for the cost
+ * of a hash probe and one atomic operation, and never reaches the label parser or the
+ * seat words.
+ */
+
+namespace booking {
+
+/** @brief Request rate allowed per client. */
+struct RateLimit {
+    double per_second = 0.0; /**< Sustained requests per second; <= 0 disables limiting. */
+    int burst = 1;           /**< Requests a client may send back to back after a quiet period (>= 1). */
+};
+
+/** @brief Totals of a ClientRateLimiter. */
+struct RateLimiterStats {
+    std::uint64_t rejected = 0;   /**< Requests turned away. */
+    std::uint64_t untracked = 0;  /**< Requests of clients that found no slot and shared the overflow bucket. */
+    std::size_t clients = 0;      /**< Slots holding a client. */
+};
+
+/**
+ * @brief Token bucket per client id, one word of state each.
+ *
+ * @details
+ * A bucket is stored as its theoretical arrival time (tat): the bucket holds
+ * (now + tolerance - tat) / interval tokens, tolerance = (burst - 1) intervals. Taking a
+ * token is one CAS moving tat an interval ahead; a rejection only loads tat and bumps the
+ * slot's rejection counter, so a flooding client contends on nobody's line but its own.
+ *
+ * Clients are found by linear probing over a short window of a fixed table; slots are
+ * claimed with a CAS on the key and never freed. When the window is full, a client whose
+ * bucket has refilled completely (its state is then the same as a fresh one) gives its
+ * slot up to the newcomer; failing that the newcomer shares one overflow bucket with
+ * every other untracked client (counted in RateLimiterStats::untracked).
+ */
+class ClientRateLimiter {
+public:
+    /** @brief Probe window of a lookup. */
+    static constexpr std::size_t kProbe = 8;
+
+    /**
+     * @brief Creates a limiter for up to @p capacity clients (rounded up to a power of two).
+     */
+    explicit ClientRateLimiter(const RateLimit& limit, std::size_t capacity = 4096);
+
+    ClientRateLimiter(const ClientRateLimiter&) = delete;
+    ClientRateLimiter& operator=(const ClientRateLimiter&) = delete;
+
+    /** @brief True if requests are limited at all. */
+    bool enabled() const { return interval_ns_.load(std::memory_order_relaxed) != 0; }
+
+    /**
+     * @brief Applies @p limit to every client from the next request on (rate <= 0 = unlimited).
+     *
+     * @details
+     * Thread-safe; buckets keep their state, so a client that was flooding stays throttled
+     * only as long as its backlog lasts at the new rate. A request racing the change may
+     * see the new interval with the old tolerance.
+     */
+    void set_limit(const RateLimit& limit);
+
+    /** @brief Takes a token from @p client's bucket at time @p now_ns (steady clock); false = reject. */
+    bool allow(std::uint64_t client, std::int64_t now_ns);
+
+    /** @brief @ref allow at the current steady-clock time. */
+    bool allow(std::uint64_t client);
+
+    /** @brief Sums the per-slot counters (approximate while requests are running). */
+    RateLimiterStats stats() const;
+
+private:
+    struct alignas(32) Slot {
+        std::atomic<std::uint64_t> key{0};      /**< client + 1; 0 = free. */
+        std::atomic<std::int64_t> tat{0};       /**< Theoretical arrival time of the next request (ns). */
+        std::atomic<std::uint64_t> rejected{0}; /**< Requests of this slot turned away. */
+    };
+
+    /** @brief Finds or claims @p client's slot; the overflow slot if the window is taken. */
+    Slot& slot_for(std::uint64_t client, std::int64_t now_ns);
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t mask_;
+    std::atomic<std::int64_t> interval_ns_{0};  /**< Nanoseconds per token; 0 = unlimited. */
+    std::atomic<std::int64_t> tolerance_ns_{0}; /**< How far ahead of now a bucket's tat may run. */
+    Slot overflow_;
+    std::atomic<std::uint64_t> untracked_{0};
+};
+
+} // namespace booking
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "booking_service.hpp"
+#include "seat_map_client.hpp"
+
+/**
+ * @file regional_cache.hpp
+ * @brief Read cache for a remote region: seat maps mirrored from the home region's change
+ *        feed, served locally within an explicit staleness bound.
+ *
+ * A region that reads availability over a WAN mirrors the shows it serves, like a
+ * SeatMapClient: a show's first read fetches its snapshot and later refreshes ask the home
+ * region for the diff since the mirror's change feed position (one round trip per show,
+ * carrying only the seats that changed). A background thread refreshes every mirrored show
+ * each sync interval, so reads are answered from memory without a round trip.
+ *
+ * Every answer carries its staleness: the time since the refresh it reflects was requested.
+ * Everything the home region completed before that instant is in the answer. A read that
+ * finds its show older than the bound it asks for refreshes the show first (readers of one
+ * show share that round trip); if the home region cannot be reached the answer is the local
+ * one, flagged Stale, and the caller decides whether to serve it.
+ *
+ * Bookings and cancellations are forwarded to the home region, which stays the only
+ * writer. Seats a forwarded booking took (or that its conflict named as taken) are hidden
+ * from this region's reads at once, until a refresh requested afterwards covers them.
+ *
+ * The home region is reached through functions, so the cache works over any transport
+ * that carries a snapshot, a diff and a booking; the BookingService constructor wires them
+ * to a service in process. Thread-safe: any number of threads read and book.
+ */
+
+namespace booking {
+
+/** @brief Outcome of a RegionalReadCache read. */
+enum class RegionalReadStatus : std::uint8_t {
+    Ok,          /**< Answered within the staleness bound. */
+    Stale,       /**< The home region could not be reached: the local answer is older than the bound. */
+    UnknownShow, /**< The home region does not know the show (or was never reachable for it). */
+};
+
+/** @brief Static description of a regional read status. */
+const char* to_string(RegionalReadStatus status);
+
+/** @brief A read answered by a RegionalReadCache. */
+struct RegionalRead {
+    RegionalReadStatus status = RegionalReadStatus::Ok;
+    /** Age of the answer: it reflects every booking the home region completed before now - staleness. */
+    std::chrono::nanoseconds staleness{0};
+};
+
+/** @brief Regional read cache tuning. */
+struct RegionalCacheOptions {
+    std::chrono::milliseconds max_staleness{1000}; /**< Bound of reads that do not name one. */
+    std::chrono::milliseconds sync_interval{100};  /**< Background refresh period (0 = refresh by hand). */
+};
+
+/** @brief Counters of a RegionalReadCache. */
+struct RegionalCacheStats {
+    std::uint64_t local_reads = 0;     /**< Reads answered from the mirror without a round trip. */
+    std::uint64_t refreshed_reads = 0; /**< Reads that refreshed their show first (past their bound). */
+    std::uint64_t stale_reads = 0;     /**< Reads answered Stale. */
+    std::uint64_t refreshes = 0;       /**< Diffs and snapshots fetched from the home region. */
+    std::uint64_t resyncs = 0;         /**< Snapshots fetched because a diff fell out of the home feed's ring. */
+    std::uint64_t forwarded = 0;       /**< Bookings and cancellations forwarded. */
+};
+
+/**
+ * @brief Mirror of the home region's seat maps, refreshed from its change feed.
+ */
+class RegionalReadCache {
+public:
+    /** @brief Fills a show's snapshot; false if the show is unknown or the home region unreachable. */
+    using Snapshot = SeatMapClient::Snapshot;
+    /**
+     * @brief Diff since a position (BookingService::availability_diff of the home region);
+     *        false if the home region could not be reached.
+     */
+    using Diff = std::function<bool(ShowId show_id, std::uint64_t since, AvailabilityDiff& out)>;
+    /** @brief Books seats in the home region (BookingService::book_seats). */
+    using Book = std::function<BookingResult(ShowId show_id, const std::vector<std::string>& seats)>;
+    /** @brief Cancels seats in the home region (BookingService::cancel_seats). */
+    using Cancel =
+        std::function<BookingResult(ShowId show_id, const std::vector<std::string>& seats, BookingId booking_id)>;
+
+    /** @brief Cache of a home region reached through @p snapshot, @p diff, @p book and @p cancel. */
+    RegionalReadCache(Snapshot snapshot, Diff diff, Book book, Cancel cancel, RegionalCacheOptions options = {});
+
+    /** @brief Cache of an in-process home service (which needs BookingService::enable_change_feed). */
+    explicit RegionalReadCache(BookingService& home, RegionalCacheOptions options = {});
+
+    /** @brief Stops the refresh thread. */
+    ~RegionalReadCache();
+
+    RegionalReadCache(const RegionalReadCache&) = delete;
+    RegionalReadCache& operator=(const RegionalReadCache&) = delete;
+
+    /** @brief Free seats of @p show_id in @p out_free (empty unless Ok or Stale), at most @p bound old. */
+    RegionalRead available_seats_mask(ShowId show_id, SeatMask& out_free, std::chrono::nanoseconds bound);
+    RegionalRead available_seats_mask(ShowId show_id, SeatMask& out_free) {
+        return available_seats_mask(show_id, out_free, options_.max_staleness);
+    }
+
+    /** @brief Number of free seats of @p show_id in @p out_count, at most @p bound old. */
+    RegionalRead available_count(ShowId show_id, int& out_count, std::chrono::nanoseconds bound);
+    RegionalRead available_count(ShowId show_id, int& out_count) {
+        return available_count(show_id, out_count, options_.max_staleness);
+    }
+
+    /** @brief Labels of the free seats of @p show_id, row-major (BookingService::list_available_seats). */
+    RegionalRead list_available_seats(ShowId show_id, std::vector<std::string>& out, std::chrono::nanoseconds bound);
+    RegionalRead list_available_seats(ShowId show_id, std::vector<std::string>& out) {
+        return list_available_seats(show_id, out, options_.max_staleness);
+    }
+
+    /** @brief Forwards a booking to the home region; its seats leave this region's reads at once. */
+    BookingResult book_seats(ShowId show_id, const std::vector<std::string>& seats);
+
+    /** @brief Forwards a cancellation to the home region (reflected by the next refresh). */
+    BookingResult cancel_seats(ShowId show_id, const std::vector<std::string>& seats, BookingId booking_id);
+
+    /**
+     * @brief Refreshes every mirrored show now (what the background thread does each interval).
+     * @return Shows the home region could not refresh.
+     */
+    std::size_t refresh_all();
+
+    /** @brief Stops mirroring @p show_id (its next read fetches a snapshot again). */
+    void forget(ShowId show_id);
+
+    /** @brief Shows mirrored. */
+    std::size_t show_count() const;
+
+    /** @brief Counters so far. */
+    RegionalCacheStats stats() const;
+
+private:
+    struct Show;
+
+    /** @brief The mirror of @p show_id, created (not yet fetched) on first use. */
+    std::shared_ptr<Show> show_of(ShowId show_id);
+
+    /** @brief @ref fresh for a read: drops the mirror of a show the home region does not know. */
+    RegionalRead read(ShowId show_id, const std::shared_ptr<Show>& show, std::chrono::nanoseconds bound);
+
+    /**
+     * @brief Brings @p show to at most @p bound old, fetching from the home region if it is
+     *        older; returns the read's status and staleness (under no lock).
+     */
+    RegionalRead fresh(ShowId show_id, Show& show, std::chrono::nanoseconds bound);
+
+    /** @brief One round trip: snapshot (first time, or after a resync) or diff; false if unreachable. */
+    bool refresh(ShowId show_id, Show& show);
+
+    /**
+     * @brief Copies @p show's free seats, minus the seats booked here since, into @p out (and
+     *        its hall into @p layout); returns the count.
+     */
+    static int copy_free(const Show& show, SeatMask& out, std::shared_ptr<const HallLayout>* layout = nullptr);
+
+    /** @brief Background thread: @ref refresh_all every sync interval until stopped. */
+    void run();
+
+    Snapshot snapshot_;
+    Diff diff_;
+    Book book_;
+    Cancel cancel_;
+    RegionalCacheOptions options_;
+
+    mutable std::shared_mutex shows_mutex_; /**< Guards the map; each Show has its own locks. */
+    std::unordered_map<ShowId, std::shared_ptr<Show>> shows_; /**< Shared: readers keep theirs across forget(). */
+
+    std::atomic<std::uint64_t> local_reads_{0};
+    std::atomic<std::uint64_t> refreshed_reads_{0};
+    std::atomic<std::uint64_t> stale_reads_{0};
+    std::atomic<std::uint64_t> refreshes_{0};
+    std::atomic<std::uint64_t> resyncs_{0};
+    std::atomic<std::uint64_t> forwarded_{0};
+
+    std::mutex loop_mutex_;
+    std::condition_variable loop_cv_;
+    bool loop_stop_ = false;
+    std::thread loop_;
+};
+
+} // namespace booking
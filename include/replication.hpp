@@ -0,0 +1,230 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "booking_service.hpp"
+
+/**
+ * @file replication.hpp
+ * @brief Primary/replica log shipping of the booking journal.
+ *
+ * The primary journals every booking and cancellation (journal.hpp); a ReplicationSource
+ * tails that file and streams its records, unchanged, to every connected replica. A
+ * ReplicaClient applies them to its own BookingService with
+ * BookingService::apply_journal_record, so replicas answer availability reads locally
+ * and read capacity grows with the number of replicas. Bookings stay on the primary.
+ *
+ * Stream, all little-endian: the replica opens with "BKREPL\r\n" and the u64 LSN it wants
+ * to resume from; the source then sends frames of
+ *
+ *     u32 record bytes | u32 flags | u64 next LSN | journal records (format of journal.hpp)
+ *
+ * A frame flagged caught-up was read at the end of the journal file: once it is applied
+ * the replica holds everything the primary had journaled when the frame was sent. An
+ * idle source sends an empty caught-up frame every heartbeat interval, so a replica's
+ * staleness stays below the heartbeat interval plus the network delay while connected.
+ * Records are applied idempotently, so resending after a reconnect is harmless.
+ *
+ * After applying a frame (and making it durable in its JournalMirror, if it keeps one)
+ * the replica acknowledges it with the frame's u64 next LSN. A source configured with
+ * ReplicationOptions::sync_replicas turns this into a quorum commit: installed as the
+ * primary journal's commit wait, a Sync booking returns only once its record is
+ * fsync-ed on the primary and acknowledged by that many replicas. With 2k + 1 servers and
+ * sync_replicas = k every acknowledged booking is on a majority, so promoting the replica
+ * with the highest LSN (Raft's election rule, applied by the operator) loses none of them.
+ * Commits are batched (one frame and one replica fsync carry every record journaled
+ * meanwhile) and pipelined (frames do not wait for the acknowledgement of the previous one).
+ */
+
+namespace booking {
+
+/** @brief Outcome of starting a replication source or replica. */
+enum class ReplicationStatus : std::uint8_t {
+    Ok,           /**< Listening / connected. */
+    SocketError,  /**< A socket could not be created. */
+    BindError,    /**< The source address is invalid or in use. */
+    ConnectError, /**< The primary could not be reached or refused the stream. */
+    IoError,      /**< The replica's journal mirror could not be opened. */
+};
+
+/** @brief Static description of a replication status. */
+const char* to_string(ReplicationStatus status);
+
+/** @brief Replication tuning. */
+struct ReplicationOptions {
+    std::string host = "127.0.0.1";                    /**< Source: IPv4 address to bind. */
+    std::uint16_t port = 0;                            /**< Source: TCP port (0 = any free port). */
+    std::chrono::milliseconds poll_interval{1};        /**< Source: pause when the journal has nothing new. */
+    std::chrono::milliseconds heartbeat_interval{50};  /**< Source: idle caught-up frames. */
+    std::chrono::milliseconds reconnect_interval{100}; /**< Replica: pause before reconnecting. */
+    int sync_replicas = 0;                             /**< Source: replica acknowledgements a commit needs (0 = asynchronous). */
+    std::string journal_path;                          /**< Replica: JournalMirror made durable before acknowledging (empty = none). */
+};
+
+/**
+ * @brief Primary side: ships a journal file to every connected replica.
+ *
+ * @details
+ * One thread accepts replicas and one thread per replica reads the journal with pread()
+ * from the replica's resume point and sends every complete record it finds, so a slow
+ * replica never delays the primary's bookings or the other replicas. Records are shipped
+ * once they are written to the file (durable in Sync and Async journal modes). When
+ * Journal::compact replaces the file, a shipper finishes the old file and continues in the
+ * new one after the last LSN it sent; a replica resuming from below the compaction point
+ * must first be seeded from a snapshot.
+ */
+class ReplicationSource {
+public:
+    /** @brief Source of the journal at @p journal_path (it may not exist yet). */
+    explicit ReplicationSource(std::string journal_path, ReplicationOptions options = {});
+
+    /** @brief @ref stop. */
+    ~ReplicationSource();
+
+    ReplicationSource(const ReplicationSource&) = delete;
+    ReplicationSource& operator=(const ReplicationSource&) = delete;
+
+    /** @brief Binds, listens and starts accepting replicas. */
+    ReplicationStatus listen();
+
+    /** @brief Bound port after @ref listen. */
+    std::uint16_t port() const { return port_; }
+
+    /** @brief Replicas currently being streamed to. */
+    std::size_t replica_count() const { return replicas_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Blocks until ReplicationOptions::sync_replicas replicas acknowledged every
+     *        record below @p commit_lsn (immediately true when sync_replicas is 0).
+     * @return False once the source is stopped.
+     *
+     * @details
+     * The commit wait of the primary's journal (Journal::set_commit_wait). Without enough
+     * connected replicas it waits for them: a primary cut off from its quorum stops
+     * acknowledging bookings rather than acknowledging bookings a failover could lose.
+     */
+    bool wait_committed(std::uint64_t commit_lsn);
+
+    /** @brief Every record below this LSN is acknowledged by sync_replicas replicas. */
+    std::uint64_t committed_lsn() const { return committed_.load(std::memory_order_acquire); }
+
+    /** @brief Disconnects the replicas and joins the threads; idempotent. */
+    void stop();
+
+private:
+    void accept_loop();
+
+    struct Shipper;
+
+    /** @brief Streams the journal to @p s's replica until it disconnects or @ref stop. */
+    void ship(Shipper& s);
+
+    /** @brief Joins and closes the shippers whose replica left (under mutex_). */
+    void reap_locked();
+
+    /** @brief Recomputes committed_ from the shippers' acknowledgements (under mutex_). */
+    void update_commit_locked();
+
+    std::string path_;
+    ReplicationOptions options_;
+    int listen_fd_ = -1;
+    std::uint16_t port_ = 0;
+    std::atomic<bool> stop_{false};
+    std::atomic<std::size_t> replicas_{0};
+    std::thread acceptor_;
+    std::mutex mutex_;              /**< Guards shippers_ and committed_ updates. */
+    std::vector<std::unique_ptr<Shipper>> shippers_;
+    std::condition_variable commit_cv_;
+    std::atomic<std::uint64_t> committed_{0};
+    std::atomic<bool> kicked_{false}; /**< A commit waiter woke the shippers and none has shipped since. */
+};
+
+/**
+ * @brief Replica side: applies a primary's journal stream to a local BookingService.
+ *
+ * @details
+ * The service must hold the primary's catalog (the same schedule, or a snapshot of the
+ * primary restored before @ref start) and should only serve reads, e.g. behind a
+ * BookingServer with BookingServerOptions::read_only. One thread receives and applies
+ * frames; after a disconnect it reconnects and resumes from @ref next_lsn. With
+ * ReplicationOptions::journal_path every frame is appended to that JournalMirror and
+ * fdatasync-ed before it is acknowledged; a restarted replica replays the mirror into its
+ * service (BookingService::replay_journal) and resumes after its last record.
+ */
+class ReplicaClient {
+public:
+    explicit ReplicaClient(BookingService& service, ReplicationOptions options = {});
+
+    /** @brief @ref stop. */
+    ~ReplicaClient();
+
+    ReplicaClient(const ReplicaClient&) = delete;
+    ReplicaClient& operator=(const ReplicaClient&) = delete;
+
+    /**
+     * @brief Connects to the source at @p host:@p port and starts applying its stream.
+     * @param from_lsn First LSN wanted (e.g. the LSN of a restored snapshot; 0 = all); with a
+     *        journal mirror at least the mirror's next LSN.
+     * @return ConnectError if the first connection fails (nothing is started then), IoError
+     *         if the journal mirror cannot be opened.
+     */
+    ReplicationStatus start(const std::string& host, std::uint16_t port, std::uint64_t from_lsn = 0);
+
+    /** @brief Disconnects and joins the apply thread; idempotent. */
+    void stop();
+
+    /** @brief True while a stream is connected. */
+    bool connected() const { return connected_.load(std::memory_order_acquire); }
+
+    /** @brief LSN after the last record received (the resume point). */
+    std::uint64_t next_lsn() const { return next_lsn_.load(std::memory_order_acquire); }
+
+    /** @brief Records applied and skipped (unknown shows) so far. */
+    std::uint64_t applied_records() const { return applied_.load(std::memory_order_relaxed); }
+    std::uint64_t skipped_records() const { return skipped_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Age of the newest point at which this replica held the primary's whole journal
+     *        (nanoseconds::max() before the first caught-up frame).
+     */
+    std::chrono::nanoseconds staleness() const;
+
+    /** @brief True if reads reflect every booking the primary journaled more than @p bound ago. */
+    bool fresh(std::chrono::nanoseconds bound) const { return staleness() <= bound; }
+
+private:
+    /** @brief Apply thread: receives from @p fd, then reconnects until @ref stop. */
+    void run(int fd);
+
+    /** @brief Applies the frames arriving on @p fd until the stream ends. */
+    void receive(int fd);
+
+    /** @brief Connects and sends the resume point; -1 on failure. */
+    int dial() const;
+
+    BookingService& service_;
+    ReplicationOptions options_;
+    std::string host_;
+    std::uint16_t port_ = 0;
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> connected_{false};
+    std::mutex fd_mutex_;          /**< Orders stop()'s shutdown against the apply thread's close. */
+    int fd_ = -1;                   /**< Connected stream, -1 between connections. */
+    std::atomic<std::uint64_t> next_lsn_{0};
+    std::atomic<std::uint64_t> applied_{0};
+    std::atomic<std::uint64_t> skipped_{0};
+    std::atomic<std::int64_t> caught_up_ns_{-1}; /**< Steady time of the last caught-up frame; -1 = never. */
+    std::unique_ptr<JournalMirror> mirror_;       /**< Durable copy of the stream (journal_path). */
+    std::thread thread_;
+};
+
+} // namespace booking
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+/**
+ * @file request_arena.hpp
+ * @brief Per-thread monotonic arena for the temporaries of one request or batch.
+ *
+ * Each thread owns one RequestArena: an std::pmr::monotonic_buffer_resource over a buffer
+ * allocated once, on the thread's first request. Allocation is a pointer bump and freeing
+ * is a no-op; when the outermost RequestArena::Scope of the thread ends, the whole arena
+ * is rewound to the start of its buffer. A request whose temporaries fit in the buffer
+ * therefore never reaches malloc in steady state. Larger requests spill to the heap and
+ * the spilled blocks are returned at the same rewind.
+ *
+ * The booking APIs taking a memory resource (BookingService::list_available_seats, the
+ * span form of BookingService::book_seats_batch) use it for their temporaries; callers
+ * may allocate their own per-request data from it too, inside a Scope.
+ */
+
+namespace booking {
+
+/**
+ * @brief Monotonic arena with scope-based rewinding.
+ *
+ * @details
+ * Not thread-safe: use the calling thread's @ref local arena, or one arena per thread.
+ * Memory allocated from the arena is valid until the outermost Scope open at the time
+ * of the allocation ends, so never keep arena memory past the request it belongs to.
+ */
+class RequestArena {
+public:
+    /** @brief Bytes of the buffer of @ref local arenas. */
+    static constexpr std::size_t kDefaultCapacity = 64 * 1024;
+
+    /** @brief Arena over a buffer of @p capacity bytes, spilling to @p upstream beyond it. */
+    explicit RequestArena(std::size_t capacity = kDefaultCapacity,
+                          std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    /** @brief The calling thread's arena (created on first use). */
+    static RequestArena& local();
+
+    /** @brief Memory resource handing out arena memory. */
+    std::pmr::memory_resource* resource() { return &resource_; }
+
+    /** @brief Buffer size in bytes. */
+    std::size_t capacity() const { return capacity_; }
+
+    /** @brief Rewinds the arena now; every pointer into it dangles. */
+    void reset() { resource_.release(); }
+
+    /**
+     * @brief Marks one request: the arena is rewound when the outermost scope ends.
+     *
+     * Scopes nest, so an API opening one inside a caller's scope does not free the
+     * caller's allocations.
+     */
+    class Scope {
+    public:
+        explicit Scope(RequestArena& arena) : arena_(arena) { ++arena_.depth_; }
+        ~Scope() {
+            if (--arena_.depth_ == 0u) arena_.reset();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /** @brief The arena's memory resource. */
+        std::pmr::memory_resource* resource() const { return arena_.resource(); }
+
+    private:
+        RequestArena& arena_;
+    };
+
+private:
+    std::size_t capacity_;
+    std::unique_ptr<std::byte[]> buffer_;
+    std::pmr::monotonic_buffer_resource resource_;
+    unsigned depth_ = 0; /**< Open scopes. */
+};
+
+} // namespace booking
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @file request_dedupe.hpp
+ * @brief Time-bounded table of recent request ids and their outcomes (idempotent retries).
+ *
+ * A client that times out retries with the same request id; the booking paths look the id
+ * up first and answer a repeat with the outcome of the original request instead of running
+ * it again (and failing it as "already booked" by the client's own seats).
+ */
+
+namespace booking {
+
+/** @brief Totals of a RequestDedupe (approximate while requests are running). */
+struct DedupeStats {
+    std::uint64_t replays = 0;    /**< Repeats answered with the stored outcome. */
+    std::uint64_t mismatches = 0; /**< Repeats whose request differed from the original. */
+    std::uint64_t untracked = 0;  /**< Requests that found no slot and ran without deduplication. */
+    std::size_t entries = 0;      /**< Slots holding an unexpired request. */
+};
+
+/**
+ * @brief Lock-free open-addressing table from request id to the request's outcome.
+ *
+ * @details
+ * Ids are found by linear probing over a short window of a fixed table, as in
+ * ClientRateLimiter: a new id claims the first free slot of its window with one CAS on the
+ * key, or failing that the first slot whose entry has expired, so a lookup is one probe of
+ * a few adjacent cache lines. Each slot carries a state word, (expiry << 2) | phase: the
+ * claimer marks it pending, runs the request and publishes the outcome with one release
+ * store. A concurrent repeat of a pending request is told so (InFlight) rather than made
+ * to wait. Outcomes are read under the state word like a seqlock (state and key read again
+ * after the copy), so a slot that is being reused is never half read. Entries live for the
+ * table's TTL after they complete; a request that cannot be tracked (its window holds
+ * only live entries) simply runs without deduplication.
+ */
+class RequestDedupe {
+public:
+    /** @brief Probe window of a lookup. */
+    static constexpr std::size_t kProbe = 8;
+
+    /** @brief Outcome of @ref claim. */
+    enum class Claim : std::uint8_t {
+        Owner,     /**< First sighting: run the request, then @ref complete (or @ref abandon) the slot. */
+        Replay,    /**< A repeat: the stored outcome was copied out. */
+        Mismatch,  /**< The id was used for a different request (another fingerprint). */
+        InFlight,  /**< The original request is still running. */
+        Untracked, /**< No slot: run the request without deduplication. */
+    };
+
+    /** @brief Claim of a slot by the request that runs (see @ref complete). */
+    struct Ticket {
+        std::size_t slot = 0;
+        std::uint64_t state = 0; /**< The pending state the claim wrote. */
+    };
+
+    /** @brief Stored outcome of a request. */
+    struct Record {
+        std::uint64_t id = 0;     /**< E.g. the booking id. */
+        std::uint32_t status = 0; /**< E.g. the BookingStatus. */
+        std::int32_t detail = -1; /**< E.g. the label index of a failure. */
+    };
+
+    /**
+     * @brief Creates a table for about @p capacity recent requests (rounded up to a power
+     *        of two) kept for @p ttl after they complete.
+     */
+    RequestDedupe(std::chrono::nanoseconds ttl, std::size_t capacity);
+
+    RequestDedupe(const RequestDedupe&) = delete;
+    RequestDedupe& operator=(const RequestDedupe&) = delete;
+
+    /**
+     * @brief Looks @p request_id up at steady-clock time @p now_ns, claiming it if new.
+     *
+     * @param fingerprint Digest of the request, compared on repeats.
+     * @param out On Replay, the stored outcome.
+     * @param out_ticket On Owner, the claim to complete.
+     */
+    Claim claim(std::uint64_t request_id, std::uint64_t fingerprint, std::int64_t now_ns, Record& out,
+                Ticket& out_ticket);
+
+    /**
+     * @brief Publishes the outcome of the request holding @p ticket, at time @p now_ns.
+     *
+     * @details A claim that outlived the TTL may have been taken over; its outcome is then dropped.
+     */
+    void complete(const Ticket& ticket, const Record& record, std::int64_t now_ns);
+
+    /** @brief Gives up the claim of @p ticket (transient failures): a repeat runs again. */
+    void abandon(const Ticket& ticket);
+
+    /** @brief Entry lifetime after completion. */
+    std::chrono::nanoseconds ttl() const { return std::chrono::nanoseconds(ttl_ns_); }
+
+    /** @brief Current steady-clock time in the table's units. */
+    static std::int64_t now_ns();
+
+    DedupeStats stats(std::int64_t now_ns) const;
+
+    /** @brief Bytes of the table. */
+    std::size_t bytes() const { return (mask_ + 1u) * sizeof(Slot); }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> key{0};         /**< request id + 1; 0 = never used. */
+        std::atomic<std::uint64_t> state{0};       /**< (expiry ns << 2) | phase. */
+        std::atomic<std::uint64_t> fingerprint{0};
+        std::atomic<std::uint64_t> id{0};
+        std::atomic<std::uint64_t> outcome{0};     /**< status << 32 | detail. */
+    };
+
+    /** @brief Claim or replay through slot @p index, whose key is @p key; false = look again. */
+    bool match(std::size_t index, std::uint64_t key, std::uint64_t fingerprint, std::int64_t now_ns,
+               Record& out, Ticket& ticket, Claim& result);
+
+    /** @brief Takes over slot @p index, whose state was @p seen, for @p key. */
+    bool take_over(std::size_t index, std::uint64_t seen, std::uint64_t key, std::uint64_t fingerprint,
+                   std::int64_t now_ns, Ticket& ticket);
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t mask_;
+    std::int64_t ttl_ns_;
+    std::atomic<std::uint64_t> replays_{0};
+    std::atomic<std::uint64_t> mismatches_{0};
+    std::atomic<std::uint64_t> untracked_{0};
+};
+
+} // namespace booking
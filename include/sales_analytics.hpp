@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ids.hpp"
+#include "show_table.hpp"
+#include "thread_shards.hpp"
+
+/**
+ * @file sales_analytics.hpp
+ * @brief Approximate tickets sold per movie per minute and distinct customers per movie.
+ *
+ * BookingService::enable_sales_analytics taps every successful booking (the point where
+ * its owners are recorded) into two sketches kept per recording thread (thread_shards.hpp)
+ * and merged on read, so the booking path only touches thread-private lines:
+ * - a count-min sketch per minute of a sliding window (uint32 cells, depth rows of
+ *   width cells; a minute's table is recycled when its slot comes round again), queried
+ *   as the minimum over rows of the cells summed over threads, so an estimate never
+ *   undercounts and overcounts by at most e/width of that minute's tickets with
+ *   probability 1 - e^-depth;
+ * - a HyperLogLog per movie (2^precision one-byte registers, standard error about
+ *   1.04 / sqrt(2^precision)), allocated on a thread's first sale of the movie and
+ *   merged by register-wise maximum.
+ *
+ * Customers are whatever the caller names with a CustomerScope around its booking calls
+ * (e.g. an account id); sales outside one count tickets but no customer.
+ */
+
+namespace booking {
+
+/** @brief Sizes of the sketches (see BookingService::enable_sales_analytics). */
+struct SalesAnalyticsOptions {
+    std::size_t minutes = 60;  /**< Minutes kept (window of @ref SalesAnalytics::tickets). */
+    std::size_t width = 256;   /**< Cells per count-min row (power of two). */
+    std::size_t depth = 4;     /**< Count-min rows. */
+    int hll_precision = 10;    /**< log2 of the HyperLogLog registers per movie, 4..16. */
+    std::size_t movies = 1024; /**< Distinct movies a thread tracks customers for (power of two). */
+};
+
+class SalesAnalytics {
+public:
+    /** @throws std::invalid_argument if a size is zero, not a power of two where required, or out of range. */
+    explicit SalesAnalytics(const SalesAnalyticsOptions& options = SalesAnalyticsOptions{});
+    ~SalesAnalytics();
+
+    SalesAnalytics(const SalesAnalytics&) = delete;
+    SalesAnalytics& operator=(const SalesAnalytics&) = delete;
+
+    const SalesAnalyticsOptions& options() const { return options_; }
+
+    /** @brief Minutes since the Unix epoch, the time axis of @ref record. */
+    static std::int64_t current_minute();
+
+    /**
+     * @brief Names the customer of the booking calls made on this thread while it lives.
+     *
+     * @details
+     * Scopes nest; the innermost one wins. Customer 0 means none.
+     */
+    class CustomerScope {
+    public:
+        explicit CustomerScope(std::uint64_t customer) : previous_(current()) { current() = customer; }
+        ~CustomerScope() { current() = previous_; }
+        CustomerScope(const CustomerScope&) = delete;
+        CustomerScope& operator=(const CustomerScope&) = delete;
+
+        /** @brief Customer of the calling thread (0 = none). */
+        static std::uint64_t& current() {
+            thread_local std::uint64_t customer = 0;
+            return customer;
+        }
+
+    private:
+        std::uint64_t previous_;
+    };
+
+    /**
+     * @brief Records a sale of @p tickets seats of @p movie at @p minute, by @p customer
+     *        (0 = unknown). A minute older than the window is dropped.
+     */
+    void record(MovieId movie, std::uint64_t customer, std::uint32_t tickets, std::int64_t minute);
+
+    /** @brief Sets the movie of show @p show (for @ref record_show). Calls must be serialised. */
+    void set_show_movie(ShowId show, MovieId movie);
+
+    /** @brief Movie set for @p show, or the invalid id. Lock-free. */
+    MovieId movie_of(ShowId show) const;
+
+    /** @brief @ref record for the movie of @p show at @ref current_minute (dropped if the show has none). */
+    void record_show(ShowId show, std::uint64_t customer, std::uint32_t tickets) {
+        const MovieId movie = movie_of(show);
+        if (movie.valid()) record(movie, customer, tickets, current_minute());
+    }
+
+    /** @brief Estimated tickets of @p movie sold in @p minute (0 outside the window). */
+    std::uint64_t tickets(MovieId movie, std::int64_t minute) const;
+
+    /**
+     * @brief Estimated tickets of @p movie per minute of [@p from_minute, @p to_minute),
+     *        one entry per minute.
+     */
+    std::vector<std::uint64_t> tickets_per_minute(MovieId movie, std::int64_t from_minute, std::int64_t to_minute) const;
+
+    /** @brief Estimated number of distinct customers who bought tickets of @p movie. */
+    double distinct_customers(MovieId movie) const;
+
+private:
+    /** @brief Count-min table of one minute. */
+    struct MinuteTable {
+        std::atomic<std::int64_t> minute{-1}; /**< Minute counted here; -1 while empty or being recycled. */
+        std::unique_ptr<std::atomic<std::uint32_t>[]> cells; /**< depth rows of width cells. */
+    };
+
+    /** @brief HyperLogLog registers of one movie. */
+    struct MovieRegisters {
+        std::atomic<std::int64_t> movie{-1}; /**< Raw MovieId; -1 = free slot. */
+        std::unique_ptr<std::atomic<std::uint8_t>[]> registers;
+    };
+
+    /** @brief One recording thread's sketches. */
+    struct Shard {
+        std::unique_ptr<MinuteTable[]> minutes;
+        std::unique_ptr<MovieRegisters[]> movies;
+    };
+
+    /** @brief Movie of a show (ShowTable objects must be default-constructible). */
+    struct ShowMovie {
+        std::atomic<std::int64_t> movie{-1};
+    };
+
+    std::unique_ptr<Shard> make_shard() const;
+
+    /** @brief Cell of row @p row for a movie hashed to @p hash. */
+    std::size_t cell_of(std::uint64_t hash, std::size_t row) const;
+
+    SalesAnalyticsOptions options_;
+    ThreadShards<Shard> shards_;
+    ShowTable<ShowMovie> show_movies_;
+};
+
+} // namespace booking
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hall_layout.hpp"
+#include "ids.hpp"
+
+/**
+ * @file schedule_loader.hpp
+ * @brief Parallel parser for schedule exports (CSV records of movies, theaters, layouts, shows).
+ *
+ * One record per line, comma separated; fields may be double-quoted ("" escapes a quote).
+ * Empty lines and lines starting with '#' are ignored.
+ *
+ *     movie,<id>,<title>
+ *     theater,<id>,<name>[,<latitude>,<longitude>]
+ *     layout,<id>,<rows>x<seats>              uniform hall, e.g. 12x20
+ *     layout,<id>,<label>:<seats>|...         explicit rows, e.g. a:10|b:12|c:12
+ *     show,<id>,<movie id>,<theater id>,<layout id>[,<start time>[,<hall>]]
+ *
+ * Show start times are seconds since the Unix epoch (default 0); the hall is the screen
+ * number within the theater (default 0).
+ *
+ * Layout ids are local to the file and are remapped when the schedule is loaded into a
+ * BookingService (see BookingService::load_schedule). The input is split at line
+ * boundaries into one chunk per thread and the chunks are parsed in parallel on a ThreadPool.
+ */
+
+namespace booking {
+
+class ThreadPool;
+
+/** @brief Movie record of a schedule file. */
+struct ScheduleMovie {
+    MovieId id;
+    std::string title;
+};
+
+/** @brief Theater record of a schedule file. */
+struct ScheduleTheater {
+    TheaterId id;
+    std::string name;
+    double latitude = std::numeric_limits<double>::quiet_NaN();  /**< WGS84 degrees (NaN = unknown). */
+    double longitude = std::numeric_limits<double>::quiet_NaN();
+};
+
+/** @brief Layout record of a schedule file. */
+struct ScheduleLayout {
+    int id;             /**< File-local layout id. */
+    HallLayout layout;  /**< Parsed geometry. */
+};
+
+/** @brief Show record of a schedule file. */
+struct ScheduleShow {
+    ShowId id;
+    MovieId movie_id;
+    TheaterId theater_id;
+    int layout_id;      /**< File-local layout id. */
+    std::int64_t start_time = 0; /**< Seconds since the Unix epoch. */
+    int hall = 0;       /**< Screen number within the theater. */
+};
+
+/**
+ * @brief Parsed contents of a schedule, records in file order.
+ */
+struct Schedule {
+    std::vector<ScheduleMovie> movies;
+    std::vector<ScheduleTheater> theaters;
+    std::vector<ScheduleLayout> layouts;
+    std::vector<ScheduleShow> shows;
+};
+
+/**
+ * @brief Outcome of parsing or loading a schedule.
+ */
+enum class ScheduleStatus : std::uint8_t {
+    Ok,            /**< Parsed (and loaded). */
+    IoError,       /**< The file could not be opened or mapped. */
+    ParseError,    /**< A malformed record; see ScheduleError::line. */
+    CatalogError,  /**< Records that conflict with each other or the catalog; nothing was loaded. */
+};
+
+/** @brief Static description of a schedule status. */
+const char* to_string(ScheduleStatus status);
+
+/**
+ * @brief Details of a failed parse/load.
+ */
+struct ScheduleError {
+    ScheduleStatus status = ScheduleStatus::Ok; /**< Outcome. */
+    std::size_t line = 0;                       /**< 1-based line of the offending record (0 = n/a). */
+    const char* reason = "";                    /**< Static description of the problem. */
+};
+
+/**
+ * @brief Parses schedule text.
+ *
+ * @param text Whole file contents.
+ * @param threads Chunks parsed in parallel (0 = the pool's worker count); small inputs use fewer.
+ * @param out Receives the records of the whole text in file order.
+ * @param pool Pool the chunks run on (null = ThreadPool::shared()).
+ * @return Ok, or ParseError for the first malformed line.
+ */
+ScheduleError parse_schedule(std::string_view text, unsigned threads, Schedule& out, ThreadPool* pool = nullptr);
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ */
+class MappedFile {
+public:
+    /** @brief Maps @p path; check @ref ok. */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** @brief True if the file was mapped (an empty file maps to an empty view). */
+    bool ok() const { return ok_; }
+
+    /** @brief File contents. */
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool ok_ = false;
+};
+
+} // namespace booking
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "hall_layout.hpp"
+#include "seat_scan.hpp"
+
+/**
+ * @file seat_heatmap.hpp
+ * @brief Per-seat sale counts over many shows of one hall ("which seats sell first").
+ *
+ * Each show contributes its booked seats as booking words (bit c of word r = seat (r, c)),
+ * one block of words per show. The kernels sum a column of bits across all the shows:
+ * the portable one transposes 64 shows x 64 seats at a time so that one popcount yields
+ * one seat's count over 64 shows; the AVX2 one keeps bit-sliced counters (plane k holds
+ * bit k of every seat's count) for 256 seats per register and adds a show with a ripple
+ * of ANDs and XORs, flushing the planes to the counts every 255 shows. The AVX2 version
+ * is selected once at start-up when the CPU supports it, and both return identical
+ * results.
+ */
+
+namespace booking {
+
+/** @brief How often each seat of a hall sold (see BookingService::seat_heatmap). */
+struct SeatHeatmap {
+    LayoutId layout_id = -1;           /**< Hall layout summed over. */
+    std::size_t shows = 0;             /**< Shows summed. */
+    std::vector<std::uint32_t> counts; /**< Per seat index (HallLayout::seat_index): shows that sold it. */
+
+    /** @brief Share of the shows that sold seat index @p seat (0 if there were none). */
+    double frequency(int seat) const {
+        return shows == 0u ? 0.0 : counts[static_cast<std::size_t>(seat)] / static_cast<double>(shows);
+    }
+};
+
+namespace seat_heatmap {
+
+using seat_scan::Isa;
+
+/**
+ * @brief One implementation of every kernel.
+ */
+struct Kernels {
+    Isa isa; /**< Instruction set the kernels use. */
+
+    /**
+     * @brief counts[w * 64 + c] += number of shows s in [0, n) with bit c of
+     *        words[s * stride + w] set, for every w in [0, stride).
+     */
+    void (*add_columns)(const std::uint64_t* words, std::size_t n, std::size_t stride, std::uint32_t* counts);
+};
+
+/** @brief Portable kernels (always available). */
+const Kernels& scalar_kernels();
+
+/** @brief AVX2 kernels, or nullptr if not compiled in or not supported by this CPU. */
+const Kernels* avx2_kernels();
+
+/** @brief Best kernels for the running CPU (chosen once, on first use). */
+const Kernels& kernels();
+
+} // namespace seat_heatmap
+} // namespace booking
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @file seat_label.hpp
+ * @brief Non-throwing, allocation-free seat label tokenizer.
+ *
+ * A seat label is an alphabetic row prefix followed by a decimal seat number ("a1", "C12",
+ * "ab7"), or another arrangement of the two chosen by a label grammar ("12c", "balc-3";
+ * see @ref booking::seat_label::Grammar). The tokenizer works on std::string_view and never allocates or throws, so
+ * malformed input from untrusted clients costs a few comparisons.
+ *
+ * Row prefixes are encoded as a bijective base-26 code ("a" = 1, "z" = 26, "aa" = 27, ...),
+ * case-insensitive, so a layout can match a row by comparing one integer.
+ *
+ * Whole label lists ("a1 a2 b7 ...", as in a request line) are split by @ref scan_list,
+ * which classifies 64 bytes at a time with SIMD compares (SSE2 on x86-64, NEON on AArch64)
+ * and finds labels, row prefixes and digits with bit scans instead of a loop per byte.
+ */
+
+namespace booking {
+namespace seat_label {
+
+/** @brief Longest row prefix accepted (keeps row codes within 32 bits). */
+constexpr std::size_t kMaxRowLetters = 6;
+
+/**
+ * @brief Encodes an alphabetic row prefix as a bijective base-26 code.
+ *
+ * @param letters Row prefix (case-insensitive).
+ * @return Code >= 1, or 0 if @p letters is empty, too long or not alphabetic.
+ */
+constexpr std::uint32_t row_code(std::string_view letters) {
+    if (letters.empty() || letters.size() > kMaxRowLetters) return 0u;
+    std::uint32_t code = 0u;
+    for (const char c : letters) {
+        const unsigned lower = static_cast<unsigned char>(c) | 0x20u; // ASCII fold to lower-case
+        if (lower < 'a' || lower > 'z') return 0u;
+        code = code * 26u + (lower - 'a' + 1u);
+    }
+    return code;
+}
+
+/**
+ * @brief Value of the decimal digits @p digits; -1 if it does not fit an int.
+ * @details Leading zeros are skipped, so the result is that of std::from_chars.
+ */
+constexpr int parse_digits(std::string_view digits) {
+    std::size_t i = 0;
+    while (i < digits.size() && digits[i] == '0') ++i;
+    if (digits.size() - i > 9u) return -1; // 10+ significant digits: 1e9 or more, and may overflow
+    int value = 0;
+    for (; i < digits.size(); ++i) value = value * 10 + (digits[i] - '0');
+    return value;
+}
+
+/** @brief Length of the run of ASCII letters (either case) that starts @p s. */
+constexpr std::size_t letter_run(std::string_view s) {
+    std::size_t n = 0;
+    while (n < s.size() && ((static_cast<unsigned char>(s[n]) | 0x20u) - 'a') < 26u) ++n;
+    return n;
+}
+
+/** @brief Length of the run of decimal digits that starts @p s. */
+constexpr std::size_t digit_run(std::string_view s) {
+    std::size_t n = 0;
+    while (n < s.size() && static_cast<unsigned>(static_cast<unsigned char>(s[n]) - '0') < 10u) ++n;
+    return n;
+}
+
+/**
+ * @brief Label grammar: where the row prefix goes and what separates it from the seat number.
+ *
+ * @details
+ * The grammar is a type, so @ref split_as and @ref format_as are compiled once per
+ * grammar with its shape folded in: a parser tests the label's bytes, never the grammar.
+ * Layouts pick theirs at run time through @ref LabelGrammar.
+ */
+template <bool RowFirst, char Separator = '\0'>
+struct Grammar {
+    static constexpr bool kRowFirst = RowFirst;   /**< Row prefix before the seat number. */
+    static constexpr char kSeparator = Separator; /**< Between row and number; '\0' = none. */
+    static constexpr std::size_t kSeparatorSize = Separator == '\0' ? 0u : 1u;
+};
+
+using RowSeat = Grammar<true>;           /**< "c12", "ab7" (the default). */
+using SeatRow = Grammar<false>;          /**< "12c", "7ab". */
+using RowDashSeat = Grammar<true, '-'>;  /**< "balc-3", "c-12". */
+
+/** @brief Run-time name of a grammar, as stored by a HallLayout. */
+enum class LabelGrammar : std::uint8_t {
+    RowSeat = 0,     /**< @ref seat_label::RowSeat */
+    SeatRow = 1,     /**< @ref seat_label::SeatRow */
+    RowDashSeat = 2, /**< @ref seat_label::RowDashSeat */
+};
+
+/**
+ * @brief Splits a label of grammar @p G into its row code and its seat number.
+ *
+ * @param label Input label, e.g. "c12" (RowSeat) or "12c" (SeatRow).
+ * @param out_row_code Row prefix code (see @ref row_code).
+ * @param out_number Seat number as written (1-based, not range-checked).
+ * @return True if the label is exactly a row prefix and digits in the grammar's order
+ *         and separator; false otherwise (including signs, whitespace and numbers that
+ *         overflow an int).
+ */
+template <typename G>
+constexpr bool split_as(std::string_view label, std::uint32_t& out_row_code, int& out_number) {
+    const std::size_t head = G::kRowFirst ? letter_run(label) : digit_run(label);
+    if (head == 0 || head + G::kSeparatorSize >= label.size()) return false;
+    if constexpr (G::kSeparatorSize != 0u) {
+        if (label[head] != G::kSeparator) return false;
+    }
+    const std::string_view tail = label.substr(head + G::kSeparatorSize);
+    if ((G::kRowFirst ? digit_run(tail) : letter_run(tail)) != tail.size()) return false;
+
+    const std::string_view letters = G::kRowFirst ? label.substr(0, head) : tail;
+    const int number = parse_digits(G::kRowFirst ? tail : label.substr(0, head));
+    const std::uint32_t code = row_code(letters);
+    if (number < 0 || code == 0u) return false;
+    out_row_code = code;
+    out_number = number;
+    return true;
+}
+
+/**
+ * @brief Writes the label of seat @p number (1-based, below 100) of row @p row in grammar
+ *        @p G to @p out and returns the end of the written bytes.
+ */
+template <typename G>
+constexpr char* format_as(std::string_view row, int number, char* out) {
+    char digits[2] = {};
+    const std::size_t n = number >= 10 ? 2u : 1u;
+    digits[0] = static_cast<char>(n == 2u ? '0' + number / 10 : '0' + number);
+    digits[1] = static_cast<char>('0' + number % 10);
+    const auto put = [&out](const char* p, std::size_t size) {
+        for (std::size_t i = 0; i < size; ++i) *out++ = p[i];
+    };
+    put(G::kRowFirst ? row.data() : digits, G::kRowFirst ? row.size() : n);
+    if constexpr (G::kSeparatorSize != 0u) *out++ = G::kSeparator;
+    put(G::kRowFirst ? digits : row.data(), G::kRowFirst ? n : row.size());
+    return out;
+}
+
+/** @brief Parser of one grammar (an instantiation of @ref split_as). */
+using SplitFn = bool (*)(std::string_view, std::uint32_t&, int&);
+
+/** @brief Formatter of one grammar (an instantiation of @ref format_as). */
+using FormatFn = char* (*)(std::string_view, int, char*);
+
+/** @brief Calls @p fn with a value of the grammar type named by @p grammar and returns its result. */
+template <typename Fn>
+constexpr decltype(auto) with_grammar(LabelGrammar grammar, Fn&& fn) {
+    switch (grammar) {
+    case LabelGrammar::SeatRow: return fn(SeatRow{});
+    case LabelGrammar::RowDashSeat: return fn(RowDashSeat{});
+    case LabelGrammar::RowSeat: break;
+    }
+    return fn(RowSeat{});
+}
+
+/** @brief Parser specialised for @p grammar. */
+constexpr SplitFn splitter(LabelGrammar grammar) {
+    return with_grammar(grammar, [](auto g) -> SplitFn { return &split_as<decltype(g)>; });
+}
+
+/** @brief Formatter specialised for @p grammar. */
+constexpr FormatFn formatter(LabelGrammar grammar) {
+    return with_grammar(grammar, [](auto g) -> FormatFn { return &format_as<decltype(g)>; });
+}
+
+/** @brief @ref split_as in the default grammar ("c12"). */
+constexpr bool split(std::string_view label, std::uint32_t& out_row_code, int& out_number) {
+    return split_as<RowSeat>(label, out_row_code, out_number);
+}
+
+/** @brief Classes of the bytes of one block of a label list: bit i describes byte i. */
+struct ByteClasses {
+    std::uint64_t separators = 0; /**< Space or tab. */
+    std::uint64_t letters = 0;    /**< ASCII letters (either case). */
+    std::uint64_t digits = 0;     /**< '0'..'9'. */
+};
+
+/** @brief Bytes classified per call of @ref classify. */
+constexpr std::size_t kBlock = 64;
+
+/**
+ * @brief Classifies @p n (at most @ref kBlock) bytes at @p p.
+ * @details Bits at and above @p n are clear in every mask.
+ */
+ByteClasses classify(const char* p, std::size_t n);
+
+/**
+ * @brief Calls @p on_label(label, row_code, number) for every label of a space- or
+ *        tab-separated list, in order, until it returns false.
+ *
+ * @details
+ * @p row_code and @p number are those of @ref split_as in grammar @p G, and @p row_code is
+ * 0 when @p label is malformed. Each block of the list is classified once (@ref classify).
+ * In the default grammar a label is then checked with a few mask operations (letters form
+ * its prefix, digits the rest) and only its digits and letters are read again, to compute
+ * its number and row code; other grammars split each label with their own parser.
+ */
+template <typename G = RowSeat, typename OnLabel>
+void scan_list(std::string_view list, OnLabel&& on_label) {
+    const char* const p = list.data();
+    const std::size_t n = list.size();
+    std::size_t pos = 0;
+    while (pos < n) {
+        const std::size_t len = n - pos < kBlock ? n - pos : kBlock;
+        const ByteClasses c = classify(p + pos, len);
+        const std::uint64_t in_block = len == kBlock ? ~std::uint64_t{0} : (std::uint64_t{1} << len) - 1u;
+        const std::uint64_t stops = c.separators | ~in_block;
+        std::uint64_t pending = ~c.separators & in_block; // bytes of labels not reported yet
+        std::size_t next = pos + len;
+        while (pending != 0u) {
+            const unsigned start = static_cast<unsigned>(__builtin_ctzll(pending));
+            const std::uint64_t after = stops >> start;
+            if (after == 0u && pos + kBlock < n) {
+                if (start != 0u) {
+                    next = pos + start; // the label runs past the block: classify again from it
+                    break;
+                }
+                // A label longer than a block is never a seat, but is split exactly all the same
+                std::size_t end = pos + kBlock;
+                while (end < n && p[end] != ' ' && p[end] != '\t') ++end;
+                const std::string_view label(p + pos, end - pos);
+                std::uint32_t code = 0u;
+                int number = 0;
+                if (!split_as<G>(label, code, number)) code = 0u;
+                if (!on_label(label, code, number)) return;
+                next = end;
+                break;
+            }
+            const unsigned end = after == 0u ? static_cast<unsigned>(kBlock)
+                                             : start + static_cast<unsigned>(__builtin_ctzll(after));
+            const std::uint64_t below_end = end == kBlock ? ~std::uint64_t{0} : (std::uint64_t{1} << end) - 1u;
+            const std::uint64_t bytes = below_end & ~((std::uint64_t{1} << start) - 1u);
+            pending &= ~bytes;
+
+            const std::string_view label(p + pos + start, end - start);
+            std::uint32_t code = 0u;
+            int number = 0;
+            if constexpr (std::is_same<G, RowSeat>::value) {
+                const std::uint64_t letters = c.letters & bytes;
+                const std::uint64_t digits = c.digits & bytes;
+                const unsigned row_len = static_cast<unsigned>(__builtin_popcountll(letters));
+                // Letters then digits, nothing else: the letters are the low bytes of the label
+                if ((letters | digits) == bytes && digits != 0u && row_len != 0u &&
+                    (letters >> start) == (std::uint64_t{1} << row_len) - 1u) {
+                    number = parse_digits(label.substr(row_len));
+                    if (number >= 0) code = row_code(label.substr(0, row_len));
+                }
+            } else if (!split_as<G>(label, code, number)) {
+                code = 0u;
+            }
+            if (!on_label(label, code, number)) return;
+        }
+        pos = next;
+    }
+}
+
+} // namespace seat_label
+} // namespace booking
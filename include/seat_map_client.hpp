@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "booking_service.hpp"
+
+/**
+ * @file seat_map_client.hpp
+ * @brief Client-side cache of seat maps kept current with availability diffs.
+ *
+ * A SeatMapClient mirrors the free seats of the shows it subscribes to and answers the
+ * availability reads of BookingService (available_count, available_seats_mask,
+ * list_available_seats, layout_for_show) from that mirror, so a seat map page polled
+ * thousands of times costs the server one diff per sync instead of one full read per
+ * render. Subscribing fetches a snapshot (BookingService::availability_snapshot); each
+ * sync() then asks for the diff since the last position (BookingService::availability_diff)
+ * and flips the seats it names. A diff that fell out of the change feed's ring
+ * (Resync) is answered with a new snapshot.
+ *
+ * The client only sees the server through two calls, so the same cache works in process
+ * (the BookingService constructor) or over any transport that carries a snapshot and a
+ * diff. Use one client from one thread. Diffs carry seats, not halls: resubscribe a show
+ * moved to another hall (BookingService::move_show) to fetch its new layout.
+ */
+
+namespace booking {
+
+/** @brief A show's seat map as fetched by a SeatMapClient. */
+struct SeatMapSnapshot {
+    std::shared_ptr<const HallLayout> layout; /**< The show's hall. */
+    SeatMask free;                            /**< Free seats when read. */
+    std::uint64_t position = 0;               /**< Change feed position to diff from. */
+};
+
+/** @brief Outcome of subscribing to a show. */
+enum class SubscribeStatus : std::uint8_t {
+    Ok,          /**< Mirrored (or already was). */
+    UnknownShow, /**< The show does not exist. */
+    NoFeed,      /**< The server has no change feed, so the show could not be kept current. */
+};
+
+/** @brief Static description of a subscribe status. */
+const char* to_string(SubscribeStatus status);
+
+/**
+ * @brief Local mirror of subscribed shows' seat maps (use from one thread).
+ */
+class SeatMapClient {
+public:
+    /** @brief Fills a snapshot of a show; false if it does not exist or the server has no feed. */
+    using Snapshot = std::function<bool(ShowId show_id, SeatMapSnapshot& out)>;
+    /** @brief BookingService::availability_diff of the server. */
+    using Diff = std::function<AvailabilityDiff(ShowId show_id, std::uint64_t since)>;
+
+    /** @brief Client of a remote server reached through @p snapshot and @p diff. */
+    SeatMapClient(Snapshot snapshot, Diff diff) : snapshot_(std::move(snapshot)), diff_(std::move(diff)) {}
+
+    /** @brief Client of an in-process service (which needs BookingService::enable_change_feed). */
+    explicit SeatMapClient(const BookingService& service);
+
+    /** @brief Starts mirroring @p show_id (a snapshot is fetched now). */
+    SubscribeStatus subscribe(ShowId show_id);
+
+    /** @brief Stops mirroring @p show_id. */
+    void unsubscribe(ShowId show_id) { shows_.erase(show_id); }
+
+    /** @brief True if @p show_id is mirrored. */
+    bool subscribed(ShowId show_id) const { return shows_.count(show_id) != 0u; }
+
+    /**
+     * @brief Brings every mirrored show up to date with the server.
+     *
+     * @return Number of seats whose state changed in the mirror.
+     *
+     * @details
+     * One diff per show; a show the server does not know is dropped, and one whose diff
+     * asks to resync is fetched again.
+     */
+    std::size_t sync();
+
+    /** @brief Free seats of a mirrored show, or -1 if it is not mirrored. */
+    int available_count(ShowId show_id) const;
+
+    /** @brief Free seats of a mirrored show in @p out_free; -1 if not mirrored (then empty). */
+    int available_seats_mask(ShowId show_id, SeatMask& out_free) const;
+
+    /** @brief Labels of a mirrored show's free seats, row-major (empty if not mirrored). */
+    std::vector<std::string> list_available_seats(ShowId show_id) const;
+
+    /** @brief Hall of a mirrored show, or nullptr. */
+    const HallLayout* layout_for_show(ShowId show_id) const;
+
+    /** @brief Snapshots fetched because a diff fell out of the server's ring. */
+    std::size_t resyncs() const { return resyncs_; }
+
+private:
+    struct Mirror {
+        std::shared_ptr<const HallLayout> layout;
+        std::array<std::uint64_t, HallLayout::kMaxRows> free{};
+        std::uint64_t position = 0;
+    };
+
+    /** @brief Replaces @p mirror with a snapshot; false if the server could not give one. */
+    bool refetch(ShowId show_id, Mirror& mirror);
+
+    Snapshot snapshot_;
+    Diff diff_;
+    std::unordered_map<ShowId, Mirror> shows_;
+    std::size_t resyncs_ = 0;
+};
+
+} // namespace booking
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "booking_id.hpp"
+
+/**
+ * @file seat_map_codec.hpp
+ * @brief Compact byte encoding of a show's booking words and seat owners.
+ *
+ * Most shows of a large hall are nearly empty or nearly sold out, so their row words are
+ * mostly 0 or equal to the row mask, and a booking's seats are usually adjacent. The
+ * encoding picks one container per row, as roaring bitmaps do:
+ *
+ *     tag (kind << 5 | arg)     kind      payload
+ *     Empty                     0         arg + 1 consecutive rows with no seat set
+ *     Full                      1         arg + 1 consecutive rows with every seat set
+ *     Listed                    2         arg column bytes: the seats set
+ *     Holes                     3         arg column bytes: the seats of the row not set
+ *     Raw                       4         the u64 word, little-endian
+ *
+ * followed by the owners of the set seats in row-major order as runs: varint run length,
+ * then the zigzag varint difference of the run's booking id from the previous run's id.
+ * An empty hall takes one byte per 32 rows and a sold-out one a byte per 32 rows plus
+ * about two bytes per booking, against 8 bytes per row and 256 bytes of owners per row
+ * for the raw words and owner tables.
+ */
+
+namespace booking {
+
+/** @brief Appends @p v as a little-endian base-128 varint (7 bits per byte). */
+inline void append_varint(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    while (v >= 0x80u) {
+        out.push_back(static_cast<std::uint8_t>(v | 0x80u));
+        v >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+/** @brief Reads a varint at @p p (advanced past it); false if it runs past @p end or overflows. */
+inline bool read_varint(const std::uint8_t*& p, const std::uint8_t* end, std::uint64_t& out) {
+    std::uint64_t v = 0;
+    for (int shift = 0; shift < 64 && p != end; shift += 7) {
+        const std::uint8_t byte = *p++;
+        v |= static_cast<std::uint64_t>(byte & 0x7Fu) << shift;
+        if ((byte & 0x80u) == 0u) {
+            out = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Signed value mapped so small magnitudes stay small (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...). */
+inline std::uint64_t zigzag(std::int64_t v) {
+    return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+}
+
+/** @brief Inverse of @ref zigzag. */
+inline std::int64_t unzigzag(std::uint64_t v) {
+    return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1u);
+}
+
+/**
+ * @brief Appends the encoding of a seat map to @p out.
+ *
+ * @param words Row words (bit c of word r = seat (r, c) taken); bits outside the row mask
+ *        must be 0.
+ * @param row_masks Valid seats of each row (HallLayout::row_mask).
+ * @param row_count Number of rows.
+ * @param owners Booking id of every seat, 64 per row (row * 64 + column), or nullptr to
+ *        record every set seat with owner 0.
+ */
+void encode_seat_map(const std::uint64_t* words, const std::uint64_t* row_masks, int row_count,
+                     const BookingId* owners, std::vector<std::uint8_t>& out);
+
+/**
+ * @brief Decodes a seat map written by @ref encode_seat_map for the same row masks.
+ *
+ * @param words_out Receives the @p row_count words, or nullptr.
+ * @param owners_out Receives the owner of every set seat (row * 64 + column; other
+ *        entries are left as they are), or nullptr. With both outputs null the call only
+ *        validates the input.
+ * @return False if @p size bytes are not exactly one valid encoding for these rows.
+ */
+bool decode_seat_map(const std::uint8_t* data, std::size_t size, const std::uint64_t* row_masks, int row_count,
+                     std::uint64_t* words_out, BookingId* owners_out);
+
+} // namespace booking
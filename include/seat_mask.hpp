@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "hall_layout.hpp"
+
+/**
+ * @file seat_mask.hpp
+ * @brief Fixed-capacity, allocation-free set of seats stored as one 64-bit word per row.
+ *
+ * The word layout matches the per-show booking words: word w holds row w and bit c
+ * holds column c (see HallLayout). The mask also tracks the range of words that may be
+ * non-zero so that operations over small requests only touch the words they use.
+ */
+
+namespace booking {
+
+/** @brief Population count of a 64-bit word. */
+inline int popcount64(std::uint64_t x) { return __builtin_popcountll(x); }
+
+/** @brief Index of the lowest set bit (undefined for x == 0). */
+inline int ctz64(std::uint64_t x) { return __builtin_ctzll(x); }
+
+/**
+ * @brief Set of seats, one 64-bit word per row.
+ */
+class SeatMask {
+public:
+    /** @brief Number of words (rows) a mask can hold. */
+    static constexpr int kWords = HallLayout::kMaxRows;
+
+    /** @brief Adds a seat index. */
+    void set(int seat) { or_word(HallLayout::row_of(seat), std::uint64_t{1} << HallLayout::col_of(seat)); }
+
+    /** @brief True if the seat index is in the set. */
+    bool test(int seat) const {
+        return (words_[static_cast<std::size_t>(HallLayout::row_of(seat))]
+                >> HallLayout::col_of(seat)) & 1u;
+    }
+
+    /** @brief Returns word @p w (0 outside the tracked range). */
+    std::uint64_t word(int w) const { return words_[static_cast<std::size_t>(w)]; }
+
+    /** @brief ORs @p bits into word @p w and extends the tracked range. */
+    void or_word(int w, std::uint64_t bits) {
+        if (bits == 0u) return;
+        words_[static_cast<std::size_t>(w)] |= bits;
+        if (w < lo_) lo_ = w;
+        if (w + 1 > hi_) hi_ = w + 1;
+    }
+
+    /** @brief First word that may be non-zero. */
+    int first_word() const { return lo_; }
+
+    /** @brief One past the last word that may be non-zero. */
+    int end_word() const { return hi_; }
+
+    /** @brief True if no seat is set. */
+    bool empty() const {
+        for (int w = lo_; w < hi_; ++w) {
+            if (words_[static_cast<std::size_t>(w)] != 0u) return false;
+        }
+        return true;
+    }
+
+    /** @brief True if all seats lie in a single word. */
+    bool single_word() const { return hi_ - lo_ == 1; }
+
+    /** @brief Number of seats in the set. */
+    int count() const {
+        int n = 0;
+        for (int w = lo_; w < hi_; ++w) n += popcount64(words_[static_cast<std::size_t>(w)]);
+        return n;
+    }
+
+private:
+    std::array<std::uint64_t, kWords> words_{}; /**< Seat bits, one word per row. */
+    int lo_ = kWords;                           /**< First possibly non-zero word. */
+    int hi_ = 0;                                /**< One past the last possibly non-zero word. */
+};
+
+} // namespace booking
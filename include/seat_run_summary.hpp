@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "hall_layout.hpp"
+
+/**
+ * @file seat_run_summary.hpp
+ * @brief Longest run of adjacent free seats of every show, for "N seats together" filters.
+ *
+ * Every show keeps one byte per row (its longest free run) and one byte for the show (the
+ * longest of its rows). The show bytes of 64 consecutive ShowTable positions share one
+ * cache line, so screening all shows for a run of at least N compares a line of bytes per
+ * 64 shows (column_scan::Kernels::match_ge_u8) instead of loading every seat map; only
+ * the shows that pass need their words.
+ *
+ * The summary is a hierarchy: 64-show chunk -> show -> row. Below the show byte, the row
+ * bytes of a show are one cache line, so a best-seat search compares them in one kernel
+ * call to find the rows with a run of N (@ref rows_with_run) and loads only those words.
+ * Each row also keeps its free seat count and each show their total, adjusted by the
+ * difference whenever a row count changes, so counting a show's free seats is one load
+ * (@ref free_seats).
+ *
+ * Writers refresh a row after each successful update of its word: store the row's run and
+ * count, then the show's maximum, and check each against what they are computed from. A
+ * writer that finds its store outdated by a racing update stores again, so once the
+ * updates of a show stop, its summary matches its words.
+ */
+
+namespace booking {
+
+/**
+ * @brief Per-show longest free runs, indexed by ShowTable position (chunks of 64 shows
+ *        allocated on first use).
+ */
+class SeatRunSummary {
+public:
+    /** @brief Positions per chunk (one cache line of show bytes). */
+    static constexpr int kChunkShows = 64;
+
+    /** @brief Summary of positions below @p max_positions, all runs 0. */
+    explicit SeatRunSummary(int max_positions);
+    ~SeatRunSummary();
+
+    SeatRunSummary(const SeatRunSummary&) = delete;
+    SeatRunSummary& operator=(const SeatRunSummary&) = delete;
+
+    /**
+     * @brief Longest run of adjacent set bits of @p free_bits (bit c = seat c is free),
+     *        where bit c of @p aisles separates seats c and c + 1.
+     */
+    static int longest_run(std::uint64_t free_bits, std::uint64_t aisles);
+
+    /**
+     * @brief Refreshes row @p row of the show at @p position and the show's maximum and
+     *        total over its @p rows rows.
+     *
+     * @param aisles Aisles of the row (see @ref longest_run).
+     * @param row_free Returns the free seats of the row's current word.
+     */
+    template <typename RowFree>
+    void refresh(int position, int row, int rows, std::uint64_t aisles, RowFree&& row_free) {
+        Chunk* c = chunk(position);
+        if (c == nullptr) return;
+        const int slot = position % kChunkShows;
+        std::uint8_t* runs = c->rows[slot];
+        std::uint64_t free_bits = 0u;
+        do {
+            free_bits = row_free();
+            __atomic_store_n(&runs[row], static_cast<std::uint8_t>(longest_run(free_bits, aisles)), __ATOMIC_SEQ_CST);
+            set_count(*c, slot, row, static_cast<std::uint8_t>(__builtin_popcountll(free_bits)));
+        } while (row_free() != free_bits);
+        std::uint8_t best = 0;
+        do {
+            best = max_of(runs, rows);
+            __atomic_store_n(&c->show[slot], best, __ATOMIC_SEQ_CST);
+        } while (max_of(runs, rows) != best);
+    }
+
+    /**
+     * @brief Includes (or, with @p listed false, excludes) @p position in
+     *        @ref for_each_at_least; positions start excluded, and their runs are kept either way.
+     */
+    void list(int position, bool listed = true);
+
+    /** @brief Bytes of the chunks allocated so far and the chunk directory. */
+    std::size_t bytes() const {
+        return allocated_.load(std::memory_order_relaxed) * sizeof(Chunk) + chunk_count_ * sizeof(std::atomic<Chunk*>);
+    }
+
+    /**
+     * @brief Clears rows @p rows and above of the show at @p position (rows a hall move
+     *        removed), so they no longer count in its total.
+     */
+    void trim(int position, int rows);
+
+    /** @brief Longest free run of the show at @p position (0 if none or out of range). */
+    int longest(int position) const;
+
+    /** @brief True if @p position is listed (a catalog show, summarised since it was added). */
+    bool listed(int position) const;
+
+    /** @brief Free seats of the show at @p position (0 if none or out of range). */
+    int free_seats(int position) const;
+
+    /**
+     * @brief Rows of the show at @p position whose longest free run is at least @p n
+     *        (bit r = row r), from one comparison of its row bytes.
+     */
+    std::uint64_t rows_with_run(int position, int n) const;
+
+    /** @brief Calls @p fn(position) for every listed position whose longest run is at least @p n, ascending. */
+    template <typename Fn>
+    void for_each_at_least(int n, Fn&& fn) const {
+        if (n < 1) n = 1;
+        if (n > 255) return;
+        const int used = used_chunks_.load(std::memory_order_acquire);
+        for (int i = 0; i < used; ++i) {
+            const Chunk* c = chunks_[static_cast<std::size_t>(i)].load(std::memory_order_acquire);
+            if (c == nullptr) continue;
+            for (std::uint64_t bits = match(*c, n); bits != 0u; bits &= bits - 1u) {
+                fn(i * kChunkShows + __builtin_ctzll(bits));
+            }
+        }
+    }
+
+private:
+    struct alignas(64) Chunk {
+        std::uint8_t show[kChunkShows]{};                             /**< Longest run per show (scanned). */
+        std::uint8_t rows[kChunkShows][HallLayout::kMaxRows]{};      /**< Longest run per row. */
+        std::uint8_t counts[kChunkShows][HallLayout::kMaxRows]{};    /**< Free seats per row. */
+        std::uint16_t totals[kChunkShows]{};                          /**< Free seats per show (sum of counts). */
+        std::atomic<std::uint64_t> listed{0};                         /**< Bit per slot: a catalog show. */
+    };
+
+    /**
+     * @brief Stores @p count as the free seats of @p row and adds the change to the show's
+     *        total: racing refreshes of a row each add the difference they swapped in, so
+     *        the total stays the sum of the row counts.
+     */
+    static void set_count(Chunk& c, int slot, int row, std::uint8_t count) {
+        const std::uint8_t old = __atomic_exchange_n(&c.counts[slot][row], count, __ATOMIC_SEQ_CST);
+        if (old != count) {
+            __atomic_fetch_add(&c.totals[slot], static_cast<std::uint16_t>(count - old), __ATOMIC_SEQ_CST);
+        }
+    }
+
+    /** @brief Chunk of @p position if allocated, else null. */
+    const Chunk* find(int position) const {
+        if (position < 0 || static_cast<std::size_t>(position / kChunkShows) >= chunk_count_) return nullptr;
+        return chunks_[static_cast<std::size_t>(position / kChunkShows)].load(std::memory_order_acquire);
+    }
+
+    static std::uint8_t max_of(const std::uint8_t* runs, int rows) {
+        std::uint8_t best = 0;
+        for (int r = 0; r < rows; ++r) {
+            const std::uint8_t run = __atomic_load_n(&runs[r], __ATOMIC_SEQ_CST);
+            if (run > best) best = run;
+        }
+        return best;
+    }
+
+    /** @brief Listed shows of @p c with a run of at least @p n, one bit per slot. */
+    static std::uint64_t match(const Chunk& c, int n);
+
+    /** @brief Chunk of @p position, allocated on first use (null if out of range). */
+    Chunk* chunk(int position);
+
+    std::size_t chunk_count_;
+    std::unique_ptr<std::atomic<Chunk*>[]> chunks_;
+    std::atomic<int> used_chunks_{0}; /**< One past the highest chunk allocated. */
+    std::atomic<std::size_t> allocated_{0}; /**< Chunks allocated. */
+};
+
+} // namespace booking
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+
+#include "seat_mask.hpp"
+
+/**
+ * @file seat_runs.hpp
+ * @brief Bit tricks for finding runs of adjacent free seats within a row word.
+ *
+ * With bit c of a word meaning "seat c is free", ANDing the word with itself shifted right
+ * by k keeps bit c only if seats c and c+k are both free. Doubling the shift distance
+ * finds every start of a run of n free seats in O(log n) word operations.
+ */
+
+namespace booking {
+
+/** @brief Index of the highest set bit (undefined for x == 0). */
+inline int msb64(std::uint64_t x) { return 63 - __builtin_clzll(x); }
+
+/**
+ * @brief Bits c such that seats c .. c+n-1 are all set in @p free_bits.
+ *
+ * @param free_bits Free seats of one row (bit set => free).
+ * @param n Run length in [1..64]; other values yield 0.
+ */
+inline std::uint64_t run_starts(std::uint64_t free_bits, int n) {
+    if (n < 1 || n > 64) return 0u;
+    std::uint64_t runs = free_bits;
+    int len = 1; // runs marks starts of runs of length len
+    while (len < n && runs != 0u) {
+        const int step = len < n - len ? len : n - len;
+        runs &= runs >> step;
+        len += step;
+    }
+    return runs;
+}
+
+/**
+ * @brief Free seats of @p free_bits whose neighbours in the row are both taken (or missing).
+ *
+ * @param free_bits Free seats of one row (bit set => free); nonexistent seats must be 0.
+ */
+inline std::uint64_t isolated_seats(std::uint64_t free_bits) {
+    return free_bits & ~(free_bits << 1) & ~(free_bits >> 1);
+}
+
+/**
+ * @brief Run starts c for which booking seats c .. c+n-1 would leave seat c-1 or c+n as an
+ *        isolated free seat.
+ *
+ * @details
+ * Seat c-1 is left alone if it is free and c-2 is not (bits of `free & ~(free << 1)`,
+ * moved up one to line up with c); seat c+n likewise if c+n+1 is not free (bits of
+ * `free & ~(free >> 1)`, moved down n). Answers every start of the word at once.
+ *
+ * @param free_bits Free seats of one row; nonexistent seats must be 0.
+ * @param n Run length in [1..64].
+ */
+inline std::uint64_t gap_leaving_starts(std::uint64_t free_bits, int n) {
+    const std::uint64_t left = (free_bits & ~(free_bits << 1)) << 1;
+    const std::uint64_t right = n >= 64 ? 0u : (free_bits & ~(free_bits >> 1)) >> n;
+    return left | right;
+}
+
+/**
+ * @brief The set bit of @p candidates closest to position @p target (ties: the lower one).
+ *
+ * @param candidates Non-zero set of positions.
+ * @param target Preferred position in [0..63].
+ */
+inline int nearest_bit(std::uint64_t candidates, int target) {
+    const std::uint64_t below_mask = (std::uint64_t{1} << target) - 1u;
+    const std::uint64_t at_or_above = candidates & ~below_mask;
+    const std::uint64_t below = candidates & below_mask;
+    if (at_or_above == 0u) return msb64(below);
+    const int up = ctz64(at_or_above);
+    if (below == 0u) return up;
+    const int down = msb64(below);
+    return target - down <= up - target ? down : up;
+}
+
+} // namespace booking
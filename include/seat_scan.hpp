@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file seat_scan.hpp
+ * @brief Vectorised kernels over arrays of seat words (availability counts and run finding).
+ *
+ * The kernels work on plain snapshots of free-seat words (bit set => seat free), one word
+ * per row as in SeatMask, so callers load the atomic booking words once and then scan them
+ * with wide registers. Every kernel has a portable scalar version; AVX2 (x86-64) and NEON
+ * (AArch64) versions are selected once at start-up from the CPU features, and all versions
+ * return identical results.
+ */
+
+namespace booking {
+namespace seat_scan {
+
+/** @brief Instruction set of a kernel table. */
+enum class Isa : std::uint8_t {
+    Scalar, /**< Portable 64-bit code. */
+    Avx2,   /**< x86-64 AVX2 (256-bit). */
+    Neon,   /**< AArch64 Advanced SIMD (128-bit). */
+};
+
+/** @brief Name of an instruction set ("scalar", "avx2", "neon"). */
+const char* to_string(Isa isa);
+
+/**
+ * @brief One implementation of every kernel.
+ */
+struct Kernels {
+    Isa isa; /**< Instruction set the kernels use. */
+
+    /** @brief Total number of set bits of @p words[0..n). */
+    int (*count_free)(const std::uint64_t* words, std::size_t n);
+
+    /** @brief out[i] = popcount(words[i]) for i in [0..n). */
+    void (*row_free_counts)(const std::uint64_t* words, std::size_t n, std::uint8_t* out);
+
+    /**
+     * @brief out[i] = run_starts(words[i], run) for i in [0..n) (see seat_runs.hpp).
+     * @return Bitset of the rows (i < 64) that have at least one run; rows >= 64 are not reported.
+     */
+    std::uint64_t (*find_runs)(const std::uint64_t* words, std::size_t n, int run, std::uint64_t* out);
+};
+
+/** @brief Portable kernels (always available). */
+const Kernels& scalar_kernels();
+
+/** @brief AVX2 kernels, or nullptr if not compiled in or not supported by this CPU. */
+const Kernels* avx2_kernels();
+
+/** @brief NEON kernels, or nullptr if not compiled in. */
+const Kernels* neon_kernels();
+
+/** @brief Best kernels for the running CPU (chosen once, on first use). */
+const Kernels& kernels();
+
+} // namespace seat_scan
+} // namespace booking
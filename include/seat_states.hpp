@@ -0,0 +1,200 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @file seat_states.hpp
+ * @brief Packed 2-bit seat states (free / held / booked / blocked), 32 seats per word.
+ *
+ * The booking words keep one bit per seat (taken or not) and the hold mask says which
+ * taken seats are held, so telling the states apart costs a second load per row. This
+ * encoding keeps a seat's whole state in two adjacent bits of one word: a row of up to 32
+ * seats is one atomic word, and "are all these seats free" or "take these seats from held
+ * to booked" is one compare and one CAS on it.
+ *
+ * Seat c of a word is bits 2c (low) and 2c + 1 (high). Operations take seat sets as
+ * "slot masks": the low bit of each selected seat set, i.e. @ref seat_states::spread of a
+ * 32-bit seat mask. All tests work on every slot at once with shifts and masks.
+ */
+
+namespace booking {
+
+/** @brief State of one seat; the value is its 2-bit code. */
+enum class SeatState : std::uint8_t {
+    Free = 0,    /**< Can be held or booked. */
+    Held = 1,    /**< Taken by an unconfirmed hold. */
+    Booked = 2,  /**< Sold. */
+    Blocked = 3, /**< Not for sale (broken, reserved, or no seat at that position). */
+};
+
+/** @brief Lower-case name of a seat state (e.g. "held"). */
+inline const char* to_string(SeatState state) {
+    switch (state) {
+        case SeatState::Free: return "free";
+        case SeatState::Held: return "held";
+        case SeatState::Booked: return "booked";
+        case SeatState::Blocked: return "blocked";
+    }
+    return "unknown";
+}
+
+namespace seat_states {
+
+/** @brief Seats per 64-bit word. */
+constexpr int kSeatsPerWord = 32;
+
+/** @brief Low bit of every slot. */
+constexpr std::uint64_t kLowBits = 0x5555555555555555ull;
+
+/** @brief Slot mask of seat mask @p seats: bit c moves to bit 2c. */
+inline std::uint64_t spread(std::uint32_t seats) {
+    std::uint64_t x = seats;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & kLowBits;
+    return x;
+}
+
+/** @brief Seat mask of slot mask @p slots: the inverse of @ref spread. */
+inline std::uint32_t gather(std::uint64_t slots) {
+    std::uint64_t x = slots & kLowBits;
+    x = (x | (x >> 1)) & 0x3333333333333333ull;
+    x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x >> 4)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x >> 8)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFull;
+    return static_cast<std::uint32_t>(x);
+}
+
+/** @brief @p state in every slot. */
+inline std::uint64_t broadcast(SeatState state) { return kLowBits * static_cast<std::uint64_t>(state); }
+
+/** @brief Slot mask of the seats of @p word in @p state. */
+inline std::uint64_t slots_in(std::uint64_t word, SeatState state) {
+    const std::uint64_t diff = word ^ broadcast(state); // 00 in the slots that match
+    return ~(diff | (diff >> 1)) & kLowBits;
+}
+
+/** @brief True if every seat of slot mask @p slots is in @p state in @p word. */
+inline bool all_in(std::uint64_t word, std::uint64_t slots, SeatState state) {
+    return (slots_in(word, state) & slots) == slots;
+}
+
+/** @brief @p word with the seats of slot mask @p slots set to @p state. */
+inline std::uint64_t with(std::uint64_t word, std::uint64_t slots, SeatState state) {
+    const std::uint64_t both = slots | (slots << 1);
+    return (word & ~both) | (broadcast(state) & both);
+}
+
+/** @brief State of seat @p seat (0..31) of @p word. */
+inline SeatState get(std::uint64_t word, int seat) { return static_cast<SeatState>((word >> (2 * seat)) & 3u); }
+
+/**
+ * @brief Word of 32 seats from one-bit masks; the masks must be disjoint (a seat in
+ *        several reads as Blocked).
+ */
+inline std::uint64_t pack(std::uint32_t held, std::uint32_t booked, std::uint32_t blocked) {
+    return spread(held | blocked) | (spread(booked | blocked) << 1);
+}
+
+} // namespace seat_states
+
+/**
+ * @brief Rows of atomic 2-bit seat-state words; a row of up to 32 seats is one word.
+ *
+ * @details
+ * Every seat starts Free. @ref transition moves a set of seats of one row from one state
+ * to another with one CAS per word, all-or-nothing: if any of them is not in the expected
+ * state nothing changes. Rows of 33 to 64 seats span two words; their transitions CAS the
+ * low word first and undo it if the high word fails, so a reader may briefly see the low
+ * half moved, as with the multi-row bookings of the booking words.
+ */
+class SeatStateRows {
+public:
+    /** @brief Most words a row takes (64 seats). */
+    static constexpr int kWordsPerRow = 2;
+
+    /** @brief @p rows rows of up to @p seats_per_row (1..64) seats, all Free. */
+    SeatStateRows(int rows, int seats_per_row)
+        : rows_(rows), words_per_row_(seats_per_row > seat_states::kSeatsPerWord ? 2 : 1),
+          words_(new std::atomic<std::uint64_t>[static_cast<std::size_t>(rows * words_per_row_)]) {
+        for (std::size_t i = 0; i < word_count(); ++i) words_[i].store(0u, std::memory_order_relaxed);
+    }
+
+    /** @brief Number of rows. */
+    int rows() const { return rows_; }
+
+    /** @brief Number of state words (rows times words per row). */
+    std::size_t word_count() const { return static_cast<std::size_t>(rows_ * words_per_row_); }
+
+    /** @brief State of seat @p seat of row @p row. */
+    SeatState get(int row, int seat) const {
+        const std::uint64_t word = word_of(row, seat / seat_states::kSeatsPerWord).load(std::memory_order_acquire);
+        return seat_states::get(word, seat % seat_states::kSeatsPerWord);
+    }
+
+    /** @brief Seats (bit c = seat c) of row @p row in @p state. */
+    std::uint64_t seats_in(int row, SeatState state) const {
+        std::uint64_t seats = 0;
+        for (int w = 0; w < words_per_row_; ++w) {
+            const std::uint64_t word = word_of(row, w).load(std::memory_order_acquire);
+            seats |= std::uint64_t{seat_states::gather(seat_states::slots_in(word, state))}
+                     << (w * seat_states::kSeatsPerWord);
+        }
+        return seats;
+    }
+
+    /** @brief True if every seat of @p seats (bit c = seat c) of row @p row is in @p state. */
+    bool all_in(int row, std::uint64_t seats, SeatState state) const {
+        return (seats_in(row, state) & seats) == seats;
+    }
+
+    /**
+     * @brief Moves the seats of @p seats (bit c = seat c) of row @p row from @p from to
+     *        @p to, all-or-nothing.
+     * @return False (nothing changed) if any of them is not in @p from.
+     */
+    bool transition(int row, std::uint64_t seats, SeatState from, SeatState to) {
+        if (words_per_row_ == 1 && (seats >> 32) != 0u) return false; // past the row
+        const std::uint64_t low = seat_states::spread(static_cast<std::uint32_t>(seats));
+        if (!cas_word(word_of(row, 0), low, from, to)) return false;
+        const std::uint64_t high = seat_states::spread(static_cast<std::uint32_t>(seats >> 32));
+        if (high == 0u) return true;
+        if (cas_word(word_of(row, 1), high, from, to)) return true;
+        cas_word(word_of(row, 0), low, to, from); // the low seats are still ours
+        return false;
+    }
+
+    /** @brief Bytes of the state words. */
+    std::size_t bytes() const { return word_count() * sizeof(std::uint64_t); }
+
+private:
+    std::atomic<std::uint64_t>& word_of(int row, int w) {
+        return words_[static_cast<std::size_t>(row * words_per_row_ + w)];
+    }
+    const std::atomic<std::uint64_t>& word_of(int row, int w) const {
+        return words_[static_cast<std::size_t>(row * words_per_row_ + w)];
+    }
+
+    /** @brief One word's all-or-nothing move of slot mask @p slots from @p from to @p to. */
+    static bool cas_word(std::atomic<std::uint64_t>& word, std::uint64_t slots, SeatState from, SeatState to) {
+        if (slots == 0u) return true;
+        std::uint64_t cur = word.load(std::memory_order_acquire);
+        do {
+            if (!seat_states::all_in(cur, slots, from)) return false;
+        } while (!word.compare_exchange_weak(cur, seat_states::with(cur, slots, to), std::memory_order_acq_rel,
+                                             std::memory_order_acquire));
+        return true;
+    }
+
+    int rows_;
+    int words_per_row_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> words_;
+};
+
+} // namespace booking
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "seat_mask.hpp"
+
+/**
+ * @file seat_words.hpp
+ * @brief Loops over a show's atomic row words, specialised at compile time per word count.
+ *
+ * A hall's row count is only known at runtime, but it is small and fixed per layout. These
+ * templates take the word count as a template parameter so the loads are straight-line
+ * code; the runtime entry points dispatch once on the count: halls of up to kBlock rows
+ * (the inline-word halls) get a single specialised block, larger halls a loop of unrolled
+ * blocks plus one specialised tail.
+ *
+ * It also holds the memory orders of the booking paths' word updates. By default they are
+ * seq_cst. With BOOKING_RELAXED_ORDERING (CMake option of the same name), the CAS loops load
+ * words with acquire and update them with acq_rel. That is enough because:
+ *  - A seat's exclusivity comes from the word's modification order: two CASes on one word
+ *    are serialised whatever their memory order.
+ *  - Owner rows and hold slots are cleared before a release (release) and read after a
+ *    successful CAS (acquire), so a booker sees the previous owner's clean-up.
+ *  - Seqlock readers (GroupWrite) need the group entry ordered before the word store, which
+ *    the release half of the CAS gives.
+ * The one store-then-load pattern across two locations, a release checking the waitlist
+ * against a joining waiter, gets explicit seq_cst fences in this mode. What is lost is a
+ * single total order over writes to different words, which nothing reads. x86 compiles
+ * both modes to the same locked instructions. On AArch64 the difference is the loads
+ * (LDAPR instead of LDAR from ARMv8.3) and the fences; see BM_SeatWordCycle in
+ * bench/show_state_bench.cpp.
+ */
+
+#ifndef BOOKING_RELAXED_ORDERING
+#define BOOKING_RELAXED_ORDERING 0
+#endif
+
+namespace booking {
+namespace seat_words {
+
+/** @brief True when the booking words use acquire/acq_rel instead of seq_cst. */
+constexpr bool kRelaxedOrdering = BOOKING_RELAXED_ORDERING != 0;
+
+/** @brief Order of the booking paths' word loads (also the order of a failed CAS). */
+constexpr std::memory_order kWordLoad = kRelaxedOrdering ? std::memory_order_acquire : std::memory_order_seq_cst;
+
+/** @brief Order of the booking paths' word read-modify-writes (CAS, fetch_and, fetch_or). */
+constexpr std::memory_order kWordUpdate = kRelaxedOrdering ? std::memory_order_acq_rel : std::memory_order_seq_cst;
+
+/** @brief Words per unrolled block. */
+constexpr int kBlock = 4;
+
+/** @brief out[i] = ~words[i] & masks[i] for i in I..., as one expression. */
+template <std::size_t... I>
+inline void load_free_unrolled(const std::atomic<std::uint64_t>* words, const std::uint64_t* masks,
+                               std::uint64_t* out, std::index_sequence<I...>) {
+    ((out[I] = ~words[I].load(std::memory_order_acquire) & masks[I]), ...);
+}
+
+/** @brief Free-seat words of a hall with exactly @p N rows. */
+template <int N>
+inline void load_free_fixed(const std::atomic<std::uint64_t>* words, const std::uint64_t* masks,
+                            std::uint64_t* out) {
+    load_free_unrolled(words, masks, out, std::make_index_sequence<static_cast<std::size_t>(N)>{});
+}
+
+/**
+ * @brief Free-seat words (bit set => seat exists and is not booked/held) of @p count rows.
+ *
+ * @param words The show's booking words.
+ * @param masks Existing-seat mask of each row (HallLayout::row_masks).
+ * @param out Receives @p count words.
+ */
+inline void load_free(const std::atomic<std::uint64_t>* words, const std::uint64_t* masks, std::uint64_t* out,
+                      int count) {
+    int w = 0;
+    for (; w + kBlock <= count; w += kBlock) load_free_fixed<kBlock>(words + w, masks + w, out + w);
+    switch (count - w) {
+        case 3: load_free_fixed<3>(words + w, masks + w, out + w); break;
+        case 2: load_free_fixed<2>(words + w, masks + w, out + w); break;
+        case 1: load_free_fixed<1>(words + w, masks + w, out + w); break;
+        default: break;
+    }
+}
+
+/**
+ * @brief load_free of the rows set in @p rows (bit r = row r) only; the other rows of
+ *        @p count get 0, without a load of their words.
+ *
+ * For a hall with a free-row summary (BookingService::ShowState::free_rows), so a search
+ * of a mostly sold arena reads the words of its rows that still have seats.
+ */
+inline void load_free_rows(const std::atomic<std::uint64_t>* words, const std::uint64_t* masks, std::uint64_t* out,
+                           int count, std::uint64_t rows) {
+    for (int w = 0; w < count; ++w) out[w] = 0u;
+    for (; rows != 0u; rows &= rows - 1u) {
+        const int w = ctz64(rows);
+        out[w] = ~words[w].load(std::memory_order_acquire) & masks[w];
+    }
+}
+
+} // namespace seat_words
+} // namespace booking
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "latency_histogram.hpp"
+
+/**
+ * @file service_metrics.hpp
+ * @brief Per-thread latency histograms and outcome counters of the public service API.
+ *
+ * Every recording thread owns a shard (found through a thread_local cache) and is its only
+ * writer, so recording is a few relaxed loads and stores on thread-private cache lines:
+ * no lock, no read-modify-write, no shared line. Readers sum all shards on demand; the
+ * result is a consistent-enough snapshot (each counter is read atomically).
+ *
+ * Recording compiles to nothing without BOOKING_METRICS (CMake option of the same name):
+ * enabled() is then constant false, so BookingService's timing wrapper folds to the call
+ * itself, and the counters stay zero whatever set_enabled() was given.
+ */
+
+#ifndef BOOKING_METRICS
+#define BOOKING_METRICS 0
+#endif
+
+namespace booking {
+
+/** @brief Instrumented API entry points (label, index and mask variants share one entry). */
+enum class MetricsApi : std::uint8_t {
+    BookSeats,
+    BookBestAvailable,
+    BookBatch,
+    CancelSeats,
+    HoldSeats,
+    ConfirmHold,
+    ReleaseHold,
+    ListAvailableSeats,
+    AvailableCount,
+    JoinWaitlist,
+    BookBundle,
+    BookGroup,
+    BookBulk,
+};
+
+/** @brief Number of MetricsApi values. */
+constexpr std::size_t kMetricsApis = 13;
+
+/** @brief Metric label of an API ("book_seats", ...). */
+const char* to_string(MetricsApi api);
+
+/**
+ * @brief Sharded, lock-free-to-record API metrics.
+ */
+class ServiceMetrics {
+public:
+    /** @brief Outcome slots per API (indexed by the numeric BookingStatus). */
+    static constexpr std::size_t kOutcomes = 32;
+
+    /** @brief Latency buckets kept (LatencyHistogram buckets up to ~68 s in ns; larger values are clamped). */
+    static constexpr std::size_t kLatencyBuckets = 1024;
+
+    /** @brief Aggregated metrics of one API. */
+    struct ApiTotals {
+        LatencyHistogram latency;                      /**< Call latency in nanoseconds. */
+        std::array<std::uint64_t, kOutcomes> outcomes{}; /**< Results per status. */
+    };
+
+    ServiceMetrics();
+    ~ServiceMetrics();
+
+    ServiceMetrics(const ServiceMetrics&) = delete;
+    ServiceMetrics& operator=(const ServiceMetrics&) = delete;
+
+    /** @brief True if calls should be recorded (never without BOOKING_METRICS). */
+    bool enabled() const { return BOOKING_METRICS && enabled_.load(std::memory_order_relaxed); }
+
+    /** @brief Turns recording on or off (already recorded values are kept). */
+    void set_enabled(bool on) { enabled_.store(on, std::memory_order_relaxed); }
+
+    /** @brief Records one call's latency. */
+    void record_latency(MetricsApi api, std::uint64_t ns);
+
+    /** @brief Counts one result with status @p outcome. */
+    void count(MetricsApi api, std::uint8_t outcome);
+
+    /** @brief Sums every shard into @p out (one entry per MetricsApi). */
+    void collect(std::array<ApiTotals, kMetricsApis>& out) const;
+
+    /**
+     * @brief Marks the outermost instrumented call on this thread.
+     *
+     * @details
+     * Public entry points may call each other (cancel_seats -> cancel_seat_mask); only the
+     * outermost one is recorded.
+     */
+    class Scope {
+    public:
+        Scope() : outermost_(depth()++ == 0) {}
+        ~Scope() { --depth(); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        bool outermost() const { return outermost_; }
+
+    private:
+        static int& depth() {
+            thread_local int d = 0;
+            return d;
+        }
+        bool outermost_;
+    };
+
+private:
+    struct ApiShard {
+        std::array<std::atomic<std::uint64_t>, kLatencyBuckets> buckets{};
+        std::array<std::atomic<std::uint64_t>, kOutcomes> outcomes{};
+        std::atomic<std::uint64_t> sum{0};
+        std::atomic<std::uint64_t> max{0};
+    };
+
+    /** @brief One recording thread's metrics. */
+    struct alignas(64) Shard {
+        std::array<ApiShard, kMetricsApis> apis;
+    };
+
+    /** @brief Single-writer increment: the owning thread is the only one storing. */
+    static void bump(std::atomic<std::uint64_t>& a, std::uint64_t n) {
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    /** @brief Calling thread's shard (created on its first record). */
+    Shard& local();
+
+    /** @brief Slow path of @ref local: finds or creates the thread's shard. */
+    Shard* attach();
+
+    std::uint64_t serial_;                /**< Unique, never reused; keys the thread_local cache. */
+    std::atomic<bool> enabled_{true};
+    mutable std::mutex shards_mutex_;     /**< Guards the shard list (attach and collect only). */
+    std::vector<std::pair<std::thread::id, std::unique_ptr<Shard>>> shards_;
+};
+
+} // namespace booking
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "booking_service.hpp"
+
+/**
+ * @file sharded_booking_service.hpp
+ * @brief BookingService partitioned by show id into independent shards.
+ *
+ * Show s lives in shard s % shard_count(): its catalog entry, booking state, owners and
+ * holds belong to that shard only, so threads working on different shards share no
+ * memory at all. Movies, theaters and layouts are small and replicated into every shard
+ * (in the same order, so LayoutIds agree). Per-show calls are routed; catalog-wide reads
+ * fan out to all shards and merge; schedule loads, batches and snapshots fan out in
+ * parallel on a ThreadPool.
+ *
+ * On NUMA hosts (built with libnuma) shard i is assigned node i % nodes and everything it
+ * allocates (construction, shows added, schedules loaded) is allocated by a thread running
+ * on that node, so first-touch places its state in local memory. Threads serving a shard
+ * should run on its node (see @ref ShardedBookingService::shard_node).
+ */
+
+namespace booking {
+
+/**
+ * @brief Show-partitioned service with the BookingService API.
+ *
+ * @details
+ * Differences from BookingService: @ref find_show returns the lowest matching show id
+ * and @ref find_shows returns ids in ascending order (insertion order is per shard), and
+ * hold ids carry their shard (they stay opaque).
+ */
+class ShardedBookingService {
+public:
+    /**
+     * @brief Builds @p shard_count shards (0 = hardware concurrency) with the sample
+     *        dataset of BookingService().
+     */
+    explicit ShardedBookingService(std::size_t shard_count = 0);
+
+    /** @brief Builds @p shard_count shards (0 = hardware concurrency) with an empty catalog. */
+    ShardedBookingService(std::size_t shard_count, BookingService::EmptyCatalog);
+
+    ShardedBookingService(const ShardedBookingService&) = delete;
+    ShardedBookingService& operator=(const ShardedBookingService&) = delete;
+
+    /** @brief Number of shards. */
+    std::size_t shard_count() const { return shards_.size(); }
+
+    /** @brief Shard that owns @p show_id. */
+    std::size_t shard_of(ShowId show_id) const {
+        return show_id.valid() ? static_cast<std::size_t>(show_id.value()) % shards_.size() : 0u;
+    }
+
+    /** @brief Direct access to one shard (e.g. for snapshots, journals or metrics). */
+    BookingService& shard(std::size_t index) { return *shards_[index]; }
+    const BookingService& shard(std::size_t index) const { return *shards_[index]; }
+
+    /** @brief NUMA node of a shard (-1 when not NUMA-aware). */
+    int shard_node(std::size_t index) const { return nodes_[index]; }
+
+    /**
+     * @brief Selects the pool of the parallel fan-outs, for this service and every shard.
+     * @param pool Kept by pointer and must outlive the service; null = ThreadPool::shared().
+     * @note Not synchronised with concurrent calls; set before serving traffic.
+     */
+    void set_thread_pool(ThreadPool* pool);
+
+    /** @brief Pool used for the parallel fan-outs. */
+    ThreadPool& thread_pool() const { return thread_pool_ ? *thread_pool_ : ThreadPool::shared(); }
+
+    /**
+     * @brief Writes every shard's snapshot (see BookingService::write_snapshot), shards in parallel.
+     * @param paths One file per shard, in shard order.
+     * @return Ok, or the first failure in shard order (IoError if @p paths has the wrong size).
+     */
+    SnapshotStatus write_snapshots(const std::vector<std::string>& paths) const;
+
+    // Catalog (see BookingService)
+    std::vector<Movie> list_movies() const;
+    Page<Movie> list_movies_page(std::uint64_t cursor, std::size_t limit) const;
+    std::vector<Theater> list_theaters_for_movie(MovieId movie_id) const;
+    /** @brief Merges each shard's page from @p cursor; the smallest @p limit ids are among them. */
+    Page<Theater> list_theaters_for_movie_page(MovieId movie_id, std::uint64_t cursor, std::size_t limit) const;
+    std::vector<Theater> list_theaters_for_movie(MovieId movie_id, double latitude, double longitude,
+                                                 double radius_km) const;
+    ShowId find_show(MovieId movie_id, TheaterId theater_id) const;
+    std::vector<ShowId> find_shows(MovieId movie_id, TheaterId theater_id) const;
+    std::vector<Show> find_shows_between(MovieId movie_id, TheaterId theater_id, ShowTime from, ShowTime to) const;
+    std::vector<Show> find_shows_between(MovieId movie_id, Span<const TheaterId> theater_ids, ShowTime from,
+                                         ShowTime to) const;
+    std::vector<Show> find_movie_shows_between(MovieId movie_id, ShowTime from, ShowTime to) const;
+    /** @brief Every shard appends its shows to @p out, then the appended range is sorted by start time. */
+    std::size_t movie_showtimes(MovieId movie_id, ShowTime from, ShowTime to, std::vector<ShowAvailability>& out) const;
+    const HallLayout* layout_for_show(ShowId show_id) const;
+    CatalogStatus add_movie(const Movie& movie);
+    CatalogStatus add_theater(const Theater& theater);
+    LayoutId add_layout(HallLayout layout);
+    CatalogStatus add_show(const Show& show);
+    CatalogStatus remove_show(ShowId show_id);
+
+    /**
+     * @brief Loads a schedule, all-or-nothing.
+     *
+     * @details
+     * The records are validated against the replicated catalog first; then every shard
+     * loads the movies, theaters and layouts plus its own shows, all shards in parallel.
+     */
+    ScheduleError load_schedule(Schedule schedule);
+    ScheduleError load_schedule_file(const std::string& path, unsigned threads = 0);
+
+    // Availability
+    std::vector<std::string> list_available_seats(ShowId show_id) const;
+    int available_seats_mask(ShowId show_id, SeatMask& out_free) const;
+    AvailabilityStatus availability_if_changed(ShowId show_id, std::uint64_t known_version, SeatMask& out_free,
+                                               std::uint64_t& out_version) const;
+    int available_count(ShowId show_id) const;
+
+    /** @brief Bulk available_count; lists longer than 1024 shows are counted in parallel chunks. */
+    std::size_t available_counts(Span<const ShowId> show_ids, Span<int> out_counts) const;
+
+    // Booking and cancellation
+    BookingResult book_seats(ShowId show_id, const std::vector<std::string>& seat_labels);
+    BookingResult book_seat_labels(ShowId show_id, Span<const std::string_view> seat_labels);
+    BookingResult book_seat_indices(ShowId show_id, Span<const int> seats);
+    BookingResult book_seat_mask(ShowId show_id, const SeatMask& seats);
+    BookingResult book_seats_once(std::uint64_t request_id, ShowId show_id, const std::vector<std::string>& seat_labels);
+    BookingResult book_seat_mask_once(std::uint64_t request_id, ShowId show_id, const SeatMask& seats);
+    BookingResult book_any_seats(ShowId show_id, const std::vector<std::string>& seat_labels, SeatMask& out_seats);
+    BookingResult book_any_seat_mask(ShowId show_id, const SeatMask& seats, SeatMask& out_seats);
+    BookingResult book_best_available(ShowId show_id, int n, SeatMask& out_seats);
+    BookingResult book_best_under(ShowId show_id, int n, std::uint32_t max_price, SeatMask& out_seats);
+    BookingResult book_cheapest_available(ShowId show_id, int n, SeatMask& out_seats);
+    BookingResult book_group(ShowId show_id, int n, SeatMask& out_seats);
+    BookingResult join_waitlist(ShowId show_id, int n, BookingService::WaitlistCallback on_booked, SeatMask& out_seats);
+    std::size_t waitlist_size(ShowId show_id) const;
+    CatalogStatus set_admission_policy(ShowId show_id, const AdmissionPolicy& policy);
+    std::chrono::nanoseconds admission_retry_after(ShowId show_id) const;
+
+    /** @brief Splits the batch by shard, books the parts in parallel, and returns results in request order. */
+    std::vector<BookingResult> book_seats_batch(Span<const BookingRequest> requests);
+
+    /**
+     * @brief Books a bundle on its shard, or part by part in show order across shards, cancelling
+     *        the parts already booked when one fails.
+     */
+    BookingResult book_bundle(Span<const BundleItem> items, Span<BookingId> out_ids);
+
+    /**
+     * @brief Books a bulk plan on its shard, or each shard's part in parallel across shards,
+     *        cancelling the parts already booked when one fails (progress summed over shards).
+     */
+    BookingResult book_bulk(Span<const BundleItem> items, Span<BookingId> out_ids,
+                            const BulkProgress& progress = nullptr);
+
+    BookingResult cancel_seats(ShowId show_id, const std::vector<std::string>& seat_labels, BookingId booking_id);
+    BookingResult cancel_seat_mask(ShowId show_id, const SeatMask& seats, BookingId booking_id);
+    BookingId seat_owner(ShowId show_id, int seat) const;
+    int booking_seats(ShowId show_id, BookingId booking_id, SeatMask& out_seats) const;
+
+    // Holds
+    BookingResult hold_seats(ShowId show_id, const std::vector<std::string>& seat_labels,
+                             std::chrono::milliseconds ttl);
+    BookingResult hold_seat_mask(ShowId show_id, const SeatMask& seats, std::chrono::milliseconds ttl);
+    BookingResult confirm_hold(HoldId hold_id);
+    BookingResult release_hold(HoldId hold_id);
+
+    /** @brief Expires due holds of every shard. */
+    std::size_t expire_holds(std::chrono::steady_clock::time_point now);
+    std::size_t expire_holds() { return expire_holds(std::chrono::steady_clock::now()); }
+
+    /** @brief Hold slots per shard (capacity * shard_count() must stay below 2^32). */
+    void set_hold_capacity(std::size_t capacity);
+
+    // Tuning and statistics
+    void set_backoff_policy(const BackoffPolicy& policy);
+    /** @brief Gives every shard its own request id table (a request id is looked up on its show's shard). */
+    void enable_request_dedupe(std::chrono::milliseconds ttl = std::chrono::minutes(10),
+                               std::size_t capacity_per_shard = 1u << 16);
+    bool contention_stats(ShowId show_id, ContentionStats& out) const;
+
+private:
+    void init_shards(std::size_t shard_count);
+
+    /** @brief Runs @p fn on the NUMA node of shard @p index (inline when not NUMA-aware). */
+    void on_shard_node(std::size_t index, const std::function<void()>& fn) const;
+
+    BookingService& owner(ShowId show_id) { return *shards_[shard_of(show_id)]; }
+    const BookingService& owner(ShowId show_id) const { return *shards_[shard_of(show_id)]; }
+
+    /** @brief Runs @p query on every shard and merges the answers by (start time, id). */
+    template <typename Query>
+    std::vector<Show> merge_by_start(Query&& query) const;
+
+    /** @brief Low (slot) half of a HoldId. */
+    static constexpr HoldId kSlotMask = 0xffffffffu;
+
+    /**
+     * @brief Folds the shard into a successful hold result's id (slot * shards + shard).
+     *        Assumes hold capacity * shards < 2^32.
+     */
+    BookingResult wrap_hold(std::size_t shard, BookingResult r) const;
+    std::size_t hold_shard(HoldId hold_id) const;
+    HoldId unwrap_hold(HoldId hold_id) const;
+
+    std::vector<std::unique_ptr<BookingService>> shards_;
+    std::vector<int> nodes_;                 /**< NUMA node per shard (-1 = any). */
+    ThreadPool* thread_pool_ = nullptr;      /**< Fan-out pool (null = ThreadPool::shared()). */
+
+    std::mutex writer_mutex_;                /**< Serialises catalog writers across shards. */
+    std::unordered_set<MovieId> movie_ids_;  /**< Replicated movies (for schedule validation). */
+    std::unordered_set<TheaterId> theater_ids_; /**< Replicated theaters. */
+};
+
+} // namespace booking
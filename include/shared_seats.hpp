@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "booking_id.hpp"
+
+/**
+ * @file shared_seats.hpp
+ * @brief Shared-memory region holding the seat words and owners of shows, for several
+ *        worker processes booking against one seat state.
+ *
+ * The region is a POSIX shared memory object laid out as
+ *
+ *     SharedSeatHeader
+ *     SharedSeatSlot[slot_count]   open-addressed table keyed by show id
+ *     blocks                       per show: booking words and change counter, then the owner table
+ *
+ * Everything inside is addressed by offset, so each process may map it anywhere, and all
+ * shared fields are address-free lock-free atomics: a CAS on a seat word behaves the same
+ * whether the competing thread lives in this process or another. Slots and blocks are
+ * claimed with atomic operations too; nothing in the region is ever freed.
+ *
+ * The same layout can live in a file instead (@ref SharedSeatRegion::open_file): on a DAX
+ * filesystem over persistent memory (PMEM, CXL memory) it is mapped with MAP_SYNC, so
+ * the seat words and owners are the durable state and a booking is durable once their
+ * cache lines are written back (pmem.hpp). Such a region belongs to one process at a time
+ * and is recovered when it is opened again.
+ */
+
+namespace booking {
+
+/** @brief Region magic ("BKSEATS" + version byte). */
+constexpr std::uint64_t kSharedSeatsMagic = 0x0353544145534B42u;
+
+/** @brief Outcome of SharedSeatRegion::open. */
+enum class SharedSeatsStatus : std::uint8_t {
+    Ok,         /**< The region is mapped and initialised. */
+    IoError,    /**< shm_open, ftruncate or mmap failed. */
+    BadHeader,  /**< The object exists but is not a seat region (or a different version). */
+    InUse,      /**< The service already has shows; attach before adding any. */
+    Locked,     /**< Another process has the persistent region file open. */
+};
+
+/** @brief Static description of a shared seats status. */
+const char* to_string(SharedSeatsStatus status);
+
+/** @brief Region header (first cache line of the mapping). */
+struct alignas(64) SharedSeatHeader {
+    std::uint64_t magic;                       /**< kSharedSeatsMagic. */
+    std::atomic<std::uint32_t> state;          /**< 0 = fresh, 1 = initialising, 2 = ready. */
+    std::uint32_t slot_count;                  /**< Power of two. */
+    std::uint64_t capacity;                    /**< Bytes usable by the region (mapping size). */
+    std::atomic<std::uint64_t> next_block;     /**< Offset of the first unclaimed block byte. */
+    std::atomic<BookingId> booking_ids;        /**< Shared BookingIdGenerator block counter. */
+};
+
+/** @brief Index entry of one show. */
+struct SharedSeatSlot {
+    std::atomic<std::uint64_t> key;    /**< show id + 1 (0 = free). */
+    std::atomic<std::uint64_t> block;  /**< Block offset; 0 = being set up, kSharedSeatsFailed = no room. */
+    std::uint32_t words;               /**< Booking words of the show (valid once block is set). */
+    std::uint32_t owner_bytes;         /**< Owner table size (valid once block is set). */
+    std::uint64_t reserved = 0;
+};
+
+/** @brief SharedSeatSlot::block of a show whose block did not fit. */
+constexpr std::uint64_t kSharedSeatsFailed = ~std::uint64_t{0};
+
+/**
+ * @brief One process's mapping of a shared seat region.
+ *
+ * @details
+ * Every process opens the region by name; the first one creates and initialises it, the
+ * others wait until it is ready. A show's block is claimed by whichever process adds the
+ * show first; later processes adding the same show id get the same block, provided they
+ * ask for the same number of words and owner bytes (same hall layout).
+ */
+class SharedSeatRegion {
+public:
+    /** @brief Default mapping size; pages are only backed once touched. */
+    static constexpr std::size_t kDefaultCapacity = std::size_t{64} << 20;
+
+    /** @brief Owner entries per booking word in an owner table (one BookingId per bit), for recovery. */
+    static constexpr std::uint32_t kOwnerRowSeats = 64;
+
+    SharedSeatRegion() = default;
+    ~SharedSeatRegion();
+
+    SharedSeatRegion(const SharedSeatRegion&) = delete;
+    SharedSeatRegion& operator=(const SharedSeatRegion&) = delete;
+
+    /**
+     * @brief Creates or opens the shared memory object @p name ("/name") and maps it.
+     *
+     * @param capacity Size of a newly created region (an existing one keeps its size).
+     * @param slots Show slots of a newly created region (rounded up to a power of two).
+     */
+    SharedSeatsStatus open(const std::string& name, std::size_t capacity = kDefaultCapacity,
+                           std::size_t slots = 1u << 16);
+
+    /**
+     * @brief Creates or opens the region file @p path, locks it for this process and maps it.
+     *
+     * @param capacity, slots As for @ref open (an existing file keeps its size).
+     * @return Ok, IoError, BadHeader, or Locked if another process has it open.
+     *
+     * @details
+     * On a DAX filesystem (e.g. ext4 or xfs mounted -o dax on PMEM or CXL memory) the file
+     * is mapped with MAP_SYNC and @ref dax is true: stores reach the memory once their
+     * lines are written back, with no msync. Elsewhere it is an ordinary shared file
+     * mapping: the state survives a crash of the process (the kernel owns the pages) but
+     * not of the host until @ref sync.
+     *
+     * An existing file is recovered before it is used: seats whose bit is set without an
+     * owner are freed (holds of the previous run, or a booking or cancellation cut short
+     * before it was acknowledged), group-write seqlocks are reset, a show slot whose block
+     * was never published is marked failed, and the booking id counter is moved past every
+     * recorded owner.
+     */
+    SharedSeatsStatus open_file(const std::string& path, std::size_t capacity = kDefaultCapacity,
+                                std::size_t slots = 1u << 16);
+
+    /** @brief True if the region is a file opened by @ref open_file. */
+    bool persistent() const { return lock_fd_ >= 0; }
+
+    /** @brief True if the region file is mapped with MAP_SYNC (stores are durable once written back). */
+    bool dax() const { return dax_; }
+
+    /** @brief Seats freed by the recovery of @ref open_file. */
+    std::uint64_t recovered_seats() const { return recovered_seats_; }
+
+    /** @brief Writes the whole mapping back to its file (msync); true on success. */
+    bool sync();
+
+    /** @brief Removes the object @p name; mappings stay valid until unmapped. */
+    static bool remove(const std::string& name);
+
+    /** @brief Show block returned by @ref claim. */
+    struct Block {
+        std::atomic<std::uint64_t>* words = nullptr;   /**< @p words booking words. */
+        std::atomic<std::uint64_t>* version = nullptr; /**< Change counter and group-write seqlock (after the words). */
+        void* owners = nullptr;                        /**< Zeroed owner table (64-byte aligned). */
+    };
+
+    /**
+     * @brief Block of @p show_id, claiming it on first use.
+     *
+     * @return The block, or nulls if the region has no room or the show was claimed with a
+     *         different size by another process. Idempotent per show id.
+     */
+    Block claim(std::int64_t show_id, std::uint32_t words, std::uint32_t owner_bytes);
+
+    /** @brief Counter the BookingIdGenerators of all attached services reserve from. */
+    std::atomic<BookingId>& booking_ids() { return header_->booking_ids; }
+
+    /** @brief Bytes of the block area claimed so far (all processes). */
+    std::uint64_t used_bytes() const { return header_->next_block.load(std::memory_order_relaxed); }
+
+private:
+    /** @brief Maps @p fd (@p size bytes) and sets up or checks the header. */
+    SharedSeatsStatus map(int fd, std::size_t size, std::uint32_t slot_count, std::uint64_t first_block, int flags);
+
+    /** @brief Frees unowned seats and repairs the header of a reopened region file (see @ref open_file). */
+    void recover();
+
+    /** @brief Writes back @p bytes at @p addr if the region is on DAX (no fence). */
+    void write_back(const void* addr, std::size_t bytes) const;
+
+    SharedSeatSlot* slots() const { return reinterpret_cast<SharedSeatSlot*>(base_ + sizeof(SharedSeatHeader)); }
+
+    /** @brief Block at offset @p at: @p words words and two counters, then the owners at @p words_bytes. */
+    Block block_at(std::uint64_t at, std::uint32_t words, std::uint64_t words_bytes) const {
+        auto* w = reinterpret_cast<std::atomic<std::uint64_t>*>(base_ + at);
+        return Block{w, w + words, base_ + at + words_bytes};
+    }
+
+    char* base_ = nullptr;
+    std::size_t size_ = 0;
+    SharedSeatHeader* header_ = nullptr;
+    int lock_fd_ = -1;                   /**< Locked region file (open_file), else -1. */
+    bool dax_ = false;
+    std::uint64_t recovered_seats_ = 0;
+};
+
+} // namespace booking
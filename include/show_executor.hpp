@@ -0,0 +1,230 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "numa.hpp"
+#include "spsc_queue.hpp"
+
+/**
+ * @file show_executor.hpp
+ * @brief Thread-per-core executor: every show is owned by one worker thread.
+ *
+ * Requests for show s are handed to worker s % workers through lock-free SPSC rings (one
+ * ring per producer thread and worker) and applied by that worker one after another. A
+ * hot show's booking words and owner rows then stay in the owner core's cache instead of
+ * bouncing between every client core, and its CAS operations never fail.
+ *
+ * The caller blocks until its request has run (it spins briefly, then yields). Idle
+ * workers park on a condition variable; producers only notify a worker that announced it
+ * is parking.
+ *
+ * Every request travels in a priority lane (RequestLane): a worker runs all waiting
+ * Confirm requests before any Book request, and so on down to Read, so payment
+ * confirmations never wait behind polls however many are queued. A request may carry a
+ * deadline; one still queued when its deadline passes is dropped by the worker unrun.
+ *
+ * With NUMA placement the workers are pinned round-robin to the nodes (see numa.hpp);
+ * with Local placement a show is owned by a worker of the node its state stripe is bound
+ * to, so its CAS operations stay on one socket.
+ */
+
+namespace booking {
+
+/**
+ * @brief How BookingService applies show mutations.
+ */
+enum class ExecutionMode : std::uint8_t {
+    Shared,        /**< The calling thread applies its request (CAS on the shared words). */
+    OwnerThreads,  /**< The show's owner thread applies it (see ShowExecutor). */
+};
+
+/** @brief Static name of an execution mode. */
+const char* to_string(ExecutionMode mode);
+
+/**
+ * @brief Priority lane of an executor request; lower values run first.
+ */
+enum class RequestLane : std::uint8_t {
+    Confirm = 0, /**< Confirmation of an existing hold (the customer is paying). */
+    Book = 1,    /**< New booking. */
+    Hold = 2,    /**< New hold. */
+    Read = 3,    /**< Availability reads and other requests that change nothing. */
+};
+
+/** @brief Number of request lanes. */
+constexpr std::size_t kRequestLanes = 4;
+
+/** @brief Static name of a request lane ("confirm", "book", "hold", "read"). */
+const char* to_string(RequestLane lane);
+
+/**
+ * @brief Pool of show-owning worker threads fed by SPSC rings.
+ *
+ * @details
+ * Up to @ref kMaxProducers threads get their own rings; further producer threads (and
+ * code already running on a worker) run their requests inline, which stays correct
+ * because the owner applies requests with the same atomic operations as the shared mode.
+ */
+class ShowExecutor {
+public:
+    /** @brief Producer threads with dedicated rings. */
+    static constexpr std::size_t kMaxProducers = 256;
+
+    /** @brief Default slots of every producer -> worker ring. */
+    static constexpr std::size_t kDefaultRingCapacity = 256;
+
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Deadline of requests that never expire. */
+    static constexpr Clock::time_point kNoDeadline = Clock::time_point::max();
+
+    /**
+     * @brief Starts @p workers threads (0 = hardware concurrency).
+     * @param ring_capacity Slots of every producer -> worker ring (power of two).
+     * @param placement Off: unpinned, show s owned by worker s % workers. Interleaved: worker i
+     *        pinned to node i % nodes. Local: pinned likewise, and each show owned by a worker
+     *        of its stripe's node (needs at least one worker per node, else shows are owned
+     *        as with Interleaved).
+     */
+    explicit ShowExecutor(unsigned workers = 0, std::size_t ring_capacity = kDefaultRingCapacity,
+                          NumaPlacement placement = NumaPlacement::Off);
+
+    /** @brief Runs the queued requests, then stops the workers. */
+    ~ShowExecutor();
+
+    ShowExecutor(const ShowExecutor&) = delete;
+    ShowExecutor& operator=(const ShowExecutor&) = delete;
+
+    /** @brief Number of worker threads. */
+    unsigned worker_count() const { return static_cast<unsigned>(workers_.size()); }
+
+    /** @brief Worker owning show @p show_id. */
+    unsigned owner_of(std::int64_t show_id) const {
+        if (show_id < 0) return 0u;
+        const auto id = static_cast<std::uint64_t>(show_id);
+        if (node_workers_.empty()) return static_cast<unsigned>(id % workers_.size());
+        const std::vector<unsigned>& local = node_workers_[topology_->node_of_show(show_id)];
+        return local[id % local.size()];
+    }
+
+    /** @brief NUMA node index worker @p index is pinned to (-1 if not pinned). */
+    int worker_node(unsigned index) const { return workers_[index]->node; }
+
+    /** @brief True if the calling thread is one of this executor's workers. */
+    bool on_worker() const;
+
+    /**
+     * @brief Runs @p fn on the owner of @p show_id and returns its result.
+     *
+     * @details
+     * Runs inline on a worker thread or when the caller has no ring. The result type must
+     * be default-constructible.
+     */
+    template <typename F>
+    auto run(std::int64_t show_id, F&& fn) -> decltype(fn()) {
+        return run(show_id, RequestLane::Book, fn);
+    }
+
+    /** @brief @ref run in priority lane @p lane. */
+    template <typename F>
+    auto run(std::int64_t show_id, RequestLane lane, F&& fn) -> decltype(fn()) {
+        bool expired = false;
+        return run_until(show_id, lane, kNoDeadline, fn, expired);
+    }
+
+    /**
+     * @brief @ref run in lane @p lane, unless the owner only reaches it after @p deadline.
+     *
+     * @param expired Set if the request was dropped unrun (the result is then
+     *        default-constructed). Requests run inline are never dropped.
+     */
+    template <typename F>
+    auto run_until(std::int64_t show_id, RequestLane lane, Clock::time_point deadline, F&& fn, bool& expired)
+        -> decltype(fn()) {
+        using Result = decltype(fn());
+        expired = false;
+        Lanes* lanes = producer_lanes(); // null on a worker thread
+
+        if (!lanes) return fn();
+
+        struct Call final : Task {
+            std::remove_reference_t<F>* fn;
+            Result result{};
+        } call;
+        call.fn = &fn;
+        call.deadline = deadline;
+        call.invoke = [](Task* t) {
+            Call* c = static_cast<Call*>(t);
+            c->result = (*c->fn)();
+        };
+        submit(*lanes, owner_of(show_id), lane, &call);
+        wait(call);
+        expired = call.expired;
+        return std::move(call.result);
+    }
+
+    /** @brief Requests dropped because their deadline passed while queued (approximate). */
+    std::uint64_t expired_count() const;
+
+private:
+    /** @brief Type-erased request living on the caller's stack. */
+    struct Task {
+        void (*invoke)(Task*) = nullptr;
+        Clock::time_point deadline = kNoDeadline;
+        bool expired = false;             /**< Set by the worker before @ref done. */
+        std::atomic<std::uint32_t> done{0}; /**< 1 once run (4 bytes: the caller sleeps on it in a futex). */
+    };
+
+    /** @brief One producer's rings, indexed by worker * kRequestLanes + lane. */
+    struct Lanes {
+        std::thread::id producer;
+        std::vector<std::unique_ptr<SpscQueue<Task*>>> rings;
+    };
+
+    struct alignas(64) Worker {
+        std::thread thread;
+        std::atomic<bool> parked{false};  /**< Announced before sleeping (Dekker with producers). */
+        std::mutex park_mutex;
+        std::condition_variable park_cv;
+        int node = -1;                    /**< Pinned NUMA node index (-1 = unpinned). */
+        std::atomic<std::uint64_t> expired{0}; /**< Written by the worker only. */
+    };
+
+    /** @brief The calling thread's lanes (registered on first use); null on a worker or if out of slots. */
+    Lanes* producer_lanes();
+
+    void submit(Lanes& lanes, unsigned worker, RequestLane lane, Task* task);
+    static void wait(const Task& task);
+    void worker_loop(unsigned index);
+
+    /**
+     * @brief Pops and runs every request queued for @p index, highest lane first (a lower
+     *        lane is only drained while the higher ones are empty); returns how many ran.
+     */
+    std::size_t drain(unsigned index);
+
+    /** @brief Pops and runs (or drops, if expired) the requests queued in one lane of @p index. */
+    std::size_t drain_lane(unsigned index, std::size_t lane);
+
+    const std::uint64_t serial_;                  /**< Tells executors apart in thread caches. */
+    const std::size_t ring_capacity_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    const NumaTopology* topology_ = nullptr;      /**< Set when workers are pinned. */
+    std::vector<std::vector<unsigned>> node_workers_; /**< Local placement: workers of each node; else empty. */
+    std::array<std::unique_ptr<Lanes>, kMaxProducers> lanes_{};
+    std::atomic<std::size_t> lane_count_{0};      /**< Published producers (release). */
+    std::mutex lanes_mutex_;                      /**< Serialises producer registration. */
+    std::atomic<bool> stopping_{false};
+};
+
+} // namespace booking
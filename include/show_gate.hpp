@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+/**
+ * @file show_gate.hpp
+ * @brief Freezes one show's booking state while every other show keeps running.
+ *
+ * A request that writes a show's seat state holds a ShowGate::Pass for it. A pass only
+ * announces the show in the calling thread's own slot (a plain store and a compiler
+ * barrier), so writers share no cache line. Freezing a show sets the gate's frozen show,
+ * forces a memory barrier on every thread of the process (membarrier(2), private
+ * expedited) and waits until no slot still announces the show: a pass entered before the
+ * barrier is seen and drained; one entered after it sees the frozen show and waits for the
+ * thaw. Where membarrier is unavailable, passes issue a full fence themselves instead.
+ */
+
+namespace booking {
+
+/**
+ * @brief Per-thread announcements of the shows being written, and one frozen show.
+ *
+ * @details
+ * Passes nest (up to kDepth per thread; deeper ones and threads without an
+ * EpochManager::thread_index slot are counted in a shared overflow counter instead). A pass
+ * for a show the thread already holds a pass for never waits, so a request that re-enters
+ * its own show cannot deadlock against a freeze that is draining it.
+ */
+class ShowGate {
+public:
+    /** @brief Passes a thread can hold in its slot. */
+    static constexpr int kDepth = 4;
+
+    /** @brief No show (not a show id, not even the invalid id -1). */
+    static constexpr std::int64_t kNone = std::numeric_limits<std::int64_t>::min();
+
+    ShowGate();
+    ~ShowGate();
+
+    ShowGate(const ShowGate&) = delete;
+    ShowGate& operator=(const ShowGate&) = delete;
+
+    /** @brief Announces a write to @p show for the pass's lifetime; waits first while the show is frozen. */
+    class Pass {
+    public:
+        Pass(const ShowGate& gate, std::int64_t show);
+        ~Pass();
+
+        Pass(const Pass&) = delete;
+        Pass& operator=(const Pass&) = delete;
+
+    private:
+        const ShowGate& gate_;
+        int slot_;  /**< Thread slot, or -1 when counted as overflow. */
+        int depth_; /**< Entry of the slot this pass uses. */
+    };
+
+    /** @brief True if @p show is frozen (one relaxed load). */
+    bool frozen(std::int64_t show) const { return frozen_.load(std::memory_order_relaxed) == show; }
+
+    /** @brief Waits until @p show is not frozen (asleep: see atomic_wait.hpp). */
+    void wait_thawed(std::int64_t show) const;
+
+    /**
+     * @brief Freezes @p show and returns once no pass for it is held; new passes wait.
+     * @note One show at a time: calls are serialised by the caller, each followed by @ref thaw.
+     */
+    void freeze(std::int64_t show);
+
+    /** @brief Lets the passes waiting for the frozen show in; writes before it are visible to them. */
+    void thaw();
+
+    /** @brief True if passes rely on membarrier(2) rather than a fence of their own. */
+    static bool asymmetric();
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<std::int64_t> shows[kDepth]; /**< Announced shows; kNone = entry unused. */
+        int depth = 0;                           /**< Entries in use (owner thread only). */
+    };
+
+    std::atomic<std::int64_t> frozen_{kNone};
+    std::unique_ptr<Slot[]> slots_;
+    mutable std::atomic<std::uint32_t> overflow_{0}; /**< Passes held outside the slots. */
+};
+
+} // namespace booking
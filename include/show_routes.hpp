@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+#include "booking_service.hpp"
+
+/**
+ * @file show_routes.hpp
+ * @brief Per-connection cache of (movie, theater) -> show handle lookups.
+ */
+
+namespace booking {
+
+/**
+ * @brief Routes (movie, theater) pairs to show handles without going back to the catalog.
+ *
+ * @details
+ * The text protocol and the CLI name a show by movie and theater on every seats and book
+ * command. The first command for a pair resolves it with BookingService::find_show and
+ * keeps a ShowHandle (see BookingService::show_handle); repeats are one hash lookup in a
+ * table of the connection's own, and the handle skips the show id lookup too. The table
+ * remembers the BookingService::catalog_version it was filled at and is emptied when the
+ * version moves, so a route never outlives the catalog it was looked up in. Pairs without
+ * a show are not cached. Not synchronised: one per connection or thread.
+ */
+class ShowRoutes {
+public:
+    explicit ShowRoutes(const BookingService& service) : service_(service) {}
+
+    /**
+     * @brief Handle of the show BookingService::find_show returns for the pair, or nullptr
+     *        if there is none.
+     *
+     * @details The handle stays owned by the table; it is valid until the next call.
+     */
+    BookingService::ShowHandle* find(MovieId movie_id, TheaterId theater_id);
+
+    /** @brief Pairs currently cached. */
+    std::size_t size() const { return routes_.size(); }
+
+    /** @brief Lookups answered from the table. */
+    std::uint64_t hits() const { return hits_; }
+
+    /** @brief Lookups that went to the catalog. */
+    std::uint64_t misses() const { return misses_; }
+
+private:
+    struct Pair {
+        MovieId movie;
+        TheaterId theater;
+        bool operator==(const Pair& o) const { return movie == o.movie && theater == o.theater; }
+    };
+
+    struct PairHash {
+        std::size_t operator()(const Pair& p) const {
+            const auto m = static_cast<std::uint64_t>(p.movie.value());
+            const auto t = static_cast<std::uint64_t>(p.theater.value());
+            return std::hash<std::uint64_t>{}(m * 0x9E3779B97F4A7C15u ^ t);
+        }
+    };
+
+    const BookingService& service_;
+    std::unordered_map<Pair, BookingService::ShowHandle, PairHash> routes_;
+    std::uint64_t version_ = 0;  /**< Catalog version the cached routes were looked up at. */
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+};
+
+} // namespace booking
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "huge_pages.hpp"
+#include "ids.hpp"
+#include "numa.hpp"
+#include "sparse_id_map.hpp"
+
+/**
+ * @file show_table.hpp
+ * @brief Dense id -> object table stored in contiguous, cache-line aligned chunks.
+ *
+ * Show ids are small dense integers, so a hash map only adds a node allocation and a
+ * pointer chase per lookup. ShowTable indexes a chunk by the high bits of the id and the
+ * object by the low bits: a lookup is a few dependent loads from small, hot arrays and no
+ * hashing. Objects of neighbouring ids are packed next to each other, and objects never
+ * move once created (chunks are never reallocated), so raw pointers to them stay valid.
+ * A placed table carves its chunks from slabs mapped on huge pages (see huge_pages.hpp)
+ * and/or bound to the NUMA node of their show stripe (see numa.hpp) while the
+ * process-wide settings ask for it.
+ *
+ * Ids from kMaxId up (any 64-bit ShowId) are sparse: a SparseIdMap (see sparse_id_map.hpp)
+ * assigns each one the next position after the dense range, in insertion order, and its
+ * object lives in the chunks at that position. Positions are 32-bit; lookups of dense ids
+ * never touch the map.
+ */
+
+namespace booking {
+
+/**
+ * @brief Chunked table of default-constructible objects indexed by a dense id.
+ *
+ * @tparam T Stored type (may be non-copyable/non-movable, e.g. contain atomics).
+ *
+ * @details
+ * @ref find is lock-free and may run concurrently with @ref emplace (of dense or sparse
+ * ids); emplace calls must be serialised by the caller. The chunk directory grows by publishing a larger copy; old
+ * directories are kept until the table is destroyed (their total size is bounded by the
+ * size of the current one).
+ */
+template <typename T>
+class ShowTable {
+public:
+    /** @brief Objects per chunk (ids sharing their high bits). */
+    static constexpr int kChunkBits = 6;
+    static constexpr int kChunkSize = 1 << kChunkBits;
+
+    /** @brief Ids in [0, kMaxId) are dense: their position is the id. */
+    static constexpr int kMaxId = 1 << 22;
+
+    /** @brief Sparse ids (kMaxId and up) a table holds at most. Bounds the chunk directory to 1 MiB. */
+    static constexpr int kMaxSparse = 1 << 22;
+
+    /** @brief Positions are in [0, kMaxPositions). */
+    static constexpr int kMaxPositions = kMaxId + kMaxSparse;
+
+    ShowTable() = default;
+
+    /**
+     * @brief Table whose chunks are placed (if @p placed) according to set_huge_pages and
+     *        set_numa_placement at the time each chunk is created.
+     */
+    explicit ShowTable(bool placed) : placed_(placed) {}
+
+    ShowTable(const ShowTable&) = delete;
+    ShowTable& operator=(const ShowTable&) = delete;
+
+    ~ShowTable() {
+        Directory* dir = dir_.load(std::memory_order_relaxed);
+        if (dir) {
+            for (std::size_t c = 0; c < dir->size; ++c) {
+                Chunk* chunk = dir->chunks[c].load(std::memory_order_relaxed);
+                if (chunk && chunk->in_slab) {
+                    chunk->~Chunk();
+                } else {
+                    delete chunk;
+                }
+            }
+        }
+        for (const Slab& slab : slabs_) unmap_huge(slab.region);
+    }
+
+    /** @brief Returns the object of @p id, or nullptr if it was never emplaced. */
+    T* find(ShowId id) const {
+        const std::int64_t v = id.value();
+        if (v < kMaxId) return v < 0 ? nullptr : at_position(static_cast<int>(v));
+        const std::uint32_t s = sparse_.find(static_cast<std::uint64_t>(v));
+        return s == SparseIdMap::kNoSlot ? nullptr : at_position(kMaxId + static_cast<int>(s));
+    }
+
+    /**
+     * @brief Position of @p id: the id itself if it is dense, else the one its first
+     *        emplace assigned (kept across erase); -1 if a sparse id was never emplaced.
+     */
+    int position(ShowId id) const {
+        const std::int64_t v = id.value();
+        if (v < kMaxId) return v < 0 ? -1 : static_cast<int>(v);
+        const std::uint32_t s = sparse_.find(static_cast<std::uint64_t>(v));
+        return s == SparseIdMap::kNoSlot ? -1 : kMaxId + static_cast<int>(s);
+    }
+
+    /**
+     * @brief Id emplaced at @p position (see @ref position); the invalid id if there is none.
+     *        Dense positions are their id; sparse ones read the id stored beside the object.
+     */
+    ShowId id_at(int position) const {
+        if (position < kMaxId) return position < 0 ? ShowId() : ShowId(position);
+        const Directory* dir = dir_.load(std::memory_order_acquire);
+        const std::size_t c = static_cast<std::size_t>(position) >> kChunkBits;
+        if (!dir || c >= dir->size) return ShowId();
+        const Chunk* chunk = dir->chunks[c].load(std::memory_order_acquire);
+        return chunk ? chunk->ids[position & (kChunkSize - 1)] : ShowId();
+    }
+
+    /** @brief Returns the object at @p position (see @ref position), or nullptr if none is live there. */
+    T* at_position(int position) const {
+        const Directory* dir = dir_.load(std::memory_order_acquire);
+        const std::size_t c = static_cast<std::size_t>(position) >> kChunkBits;
+        if (position < 0 || !dir || c >= dir->size) return nullptr;
+        Chunk* chunk = dir->chunks[c].load(std::memory_order_acquire);
+        const int slot = position & (kChunkSize - 1);
+        if (!chunk || ((chunk->live.load(std::memory_order_acquire) >> slot) & 1u) == 0u) return nullptr;
+        return &chunk->items[slot];
+    }
+
+    /**
+     * @brief Creates the object of @p id: calls @p init on it, then makes it visible to find.
+     *
+     * @throws std::invalid_argument if @p id is negative, already present, or a new sparse
+     *         id when kMaxSparse are held.
+     */
+    template <typename Init>
+    T& emplace(ShowId id, Init&& init) {
+        if (!accepts(id)) {
+            throw std::invalid_argument("ShowTable: id out of range");
+        }
+        int position = this->position(id);
+        if (position < 0) {
+            // A new sparse id: published to the map first, its object is found once live
+            position = kMaxId + static_cast<int>(sparse_.size());
+            sparse_.insert(static_cast<std::uint64_t>(id.value()), static_cast<std::uint32_t>(position - kMaxId));
+        }
+        const std::size_t c = static_cast<std::size_t>(position) >> kChunkBits;
+        Directory* dir = grow_to(c + 1);
+        Chunk* chunk = dir->chunks[c].load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new_chunk(c);
+            if (position >= kMaxId) chunk->ids.reset(new ShowId[kChunkSize]);
+            ++chunk_count_;
+            dir->chunks[c].store(chunk, std::memory_order_release);
+        }
+        const int slot = position & (kChunkSize - 1);
+        const std::uint64_t bit = std::uint64_t{1} << slot;
+        const std::uint64_t live = chunk->live.load(std::memory_order_relaxed);
+        if ((live & bit) != 0u) {
+            throw std::invalid_argument("ShowTable: duplicate id");
+        }
+        if (chunk->ids) chunk->ids[slot] = id;
+        init(chunk->items[slot]);
+        chunk->live.store(live | bit, std::memory_order_release);
+        ++size_;
+        return chunk->items[slot];
+    }
+
+    /**
+     * @brief Makes @p id invisible to @ref find (false if it was not present).
+     *
+     * @details
+     * The object itself stays constructed where it is until the table is destroyed, so a
+     * reader that found it before keeps a valid pointer; emplacing @p id again
+     * re-initialises that same object. Serialised with @ref emplace by the caller.
+     */
+    bool erase(ShowId id) {
+        if (!find(id)) return false;
+        const int position = this->position(id);
+        const Directory* dir = dir_.load(std::memory_order_relaxed);
+        Chunk* chunk = dir->chunks[static_cast<std::size_t>(position) >> kChunkBits].load(std::memory_order_relaxed);
+        const std::uint64_t bit = std::uint64_t{1} << (position & (kChunkSize - 1));
+        chunk->live.store(chunk->live.load(std::memory_order_relaxed) & ~bit, std::memory_order_release);
+        --size_;
+        return true;
+    }
+
+    /** @brief True if @p id can be held: non-negative, and dense, already mapped or within kMaxSparse. */
+    bool accepts(ShowId id) const {
+        return id.valid()
+               && (id.value() < kMaxId || sparse_.size() < static_cast<std::size_t>(kMaxSparse) || position(id) >= 0);
+    }
+
+    /** @brief True if @p id can be emplaced (accepted and not present). */
+    bool available(ShowId id) const { return accepts(id) && find(id) == nullptr; }
+
+    /** @brief Sparse ids emplaced so far (erased ones included: they keep their position). */
+    std::size_t sparse_count() const { return sparse_.size(); }
+
+    /** @brief Number of objects present. */
+    std::size_t size() const { return size_; }
+
+    /** @brief Bytes of the chunks and chunk directories allocated so far (objects' own heap memory excluded). */
+    std::size_t bytes() const {
+        const Directory* dir = dir_.load(std::memory_order_acquire);
+        return chunk_count_ * sizeof(Chunk) + (dir ? dir->size * sizeof(std::atomic<Chunk*>) : 0u);
+    }
+
+    /** @brief Page kind of the slab holding @p id's object (Off if it is on the normal heap or absent). */
+    HugePages backing(ShowId id) const {
+        if (!find(id)) return HugePages::Off;
+        const Directory* dir = dir_.load(std::memory_order_acquire);
+        const Chunk* chunk =
+            dir->chunks[static_cast<std::size_t>(position(id)) >> kChunkBits].load(std::memory_order_acquire);
+        return chunk->in_slab ? chunk->backing : HugePages::Off;
+    }
+
+    /** @brief NUMA node index (see NumaTopology) @p id's object was bound to, or -1 if it was not bound. */
+    int node(ShowId id) const {
+        if (!find(id)) return -1;
+        const Directory* dir = dir_.load(std::memory_order_acquire);
+        const Chunk* chunk =
+            dir->chunks[static_cast<std::size_t>(position(id)) >> kChunkBits].load(std::memory_order_acquire);
+        return chunk->node;
+    }
+
+private:
+    struct Chunk {
+        T items[kChunkSize];                 /**< Objects, contiguous and (for aligned T) line-aligned. */
+        std::atomic<std::uint64_t> live{0};  /**< Bit i set => items[i] was emplaced. */
+        bool in_slab = false;                /**< Placed in a slab (not owned by new). */
+        HugePages backing = HugePages::Off;  /**< Page kind of that slab. */
+        int node = -1;                       /**< NUMA node index the slab is bound to (-1 = none). */
+        std::unique_ptr<ShowId[]> ids;       /**< Ids of the items of a sparse chunk (null for dense chunks). */
+    };
+
+    /** @brief Mapped region chunks are carved from. */
+    struct Slab {
+        HugeRegion region;
+        std::size_t used = 0; /**< Bytes handed out. */
+        int node = -1;        /**< Bound node index; -1 = not bound. */
+    };
+
+    /**
+     * @brief Storage for chunk @p c: carved from the open slab of its node (a new slab when
+     *        that one is full), or from new when neither huge pages nor NUMA binding apply.
+     */
+    Chunk* new_chunk(std::size_t c) {
+        const HugePages pages = placed_ ? huge_pages() : HugePages::Off;
+        const NumaPlacement numa = placed_ ? numa_placement() : NumaPlacement::Off;
+        const NumaTopology& topology = NumaTopology::system();
+        const bool bind = numa != NumaPlacement::Off && topology.node_count() > 1u;
+        if (pages == HugePages::Off && !bind) return new Chunk();
+
+        // Local: one open slab per node; Interleaved and unbound: one shared open slab
+        const std::size_t lane =
+            numa == NumaPlacement::Local ? topology.node_of_show(static_cast<std::int64_t>(c) << kChunkBits) : 0u;
+        if (open_slab_.size() <= lane) open_slab_.resize(lane + 1u, kNoSlab);
+        const std::size_t align = alignof(Chunk);
+        std::size_t offset = 0;
+        if (open_slab_[lane] != kNoSlab) {
+            const Slab& open = slabs_[open_slab_[lane]];
+            offset = (open.used + align - 1u) / align * align;
+        }
+        if (open_slab_[lane] == kNoSlab || offset + sizeof(Chunk) > slabs_[open_slab_[lane]].region.bytes) {
+            const std::size_t slab_bytes = std::max({kSlabBytes, huge_page_bytes(pages), sizeof(Chunk)});
+            Slab slab;
+            slab.region = map_huge(slab_bytes, pages);
+            if (!slab.region.data || (slab.region.backing == HugePages::Off && !bind)) {
+                unmap_huge(slab.region);
+                return new Chunk(); // nothing to gain over a plain heap chunk
+            }
+            // Set the policy before the first touch, so the pages are allocated in place
+            if (bind && bind_memory(slab.region.data, slab.region.bytes, topology, numa, lane)) {
+                slab.node = numa == NumaPlacement::Local ? static_cast<int>(lane) : -1;
+            }
+            slabs_.push_back(slab);
+            open_slab_[lane] = slabs_.size() - 1u;
+            offset = 0;
+        }
+        Slab& slab = slabs_[open_slab_[lane]];
+        Chunk* chunk = ::new (static_cast<char*>(slab.region.data) + offset) Chunk();
+        chunk->in_slab = true;
+        chunk->backing = slab.region.backing;
+        chunk->node = slab.node;
+        slab.used = offset + sizeof(Chunk);
+        return chunk;
+    }
+
+    struct Directory {
+        std::size_t size;                                    /**< Number of chunk pointers. */
+        std::unique_ptr<std::atomic<Chunk*>[]> chunks;       /**< Null = no id in that range. */
+    };
+
+    Directory* grow_to(std::size_t needed) {
+        Directory* dir = dir_.load(std::memory_order_relaxed);
+        if (dir && dir->size >= needed) return dir;
+
+        std::size_t size = dir ? dir->size : 1u;
+        while (size < needed) size *= 2;
+        auto bigger = std::make_unique<Directory>(Directory{size, std::make_unique<std::atomic<Chunk*>[]>(size)});
+        for (std::size_t c = 0; c < size; ++c) {
+            Chunk* chunk = dir && c < dir->size ? dir->chunks[c].load(std::memory_order_relaxed) : nullptr;
+            bigger->chunks[c].store(chunk, std::memory_order_relaxed);
+        }
+        dir_.store(bigger.get(), std::memory_order_release);
+        directories_.push_back(std::move(bigger)); // readers may still use older ones
+        return directories_.back().get();
+    }
+
+    std::atomic<Directory*> dir_{nullptr};                /**< Current chunk directory. */
+    std::vector<std::unique_ptr<Directory>> directories_; /**< All directories ever published. */
+    std::size_t size_ = 0;                                 /**< Emplaced objects. */
+    std::size_t chunk_count_ = 0;                          /**< Chunks created. */
+    SparseIdMap sparse_;                                   /**< Sparse id -> position - kMaxId. */
+
+    static constexpr std::size_t kSlabBytes = std::size_t{2} << 20; /**< Smallest slab (one 2 MiB page). */
+    static constexpr std::size_t kNoSlab = ~std::size_t{0};
+    static_assert(kChunkBits == kNumaStripeBits, "a chunk must be one NUMA stripe of shows");
+    bool placed_ = false;                                  /**< Chunks may come from slabs_. */
+    std::vector<Slab> slabs_;                              /**< Every slab mapped so far. */
+    std::vector<std::size_t> open_slab_;                   /**< Per lane: slab chunks are carved from. */
+};
+
+} // namespace booking
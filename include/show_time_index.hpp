@@ -0,0 +1,191 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+#include "epoch.hpp"
+
+/**
+ * @file show_time_index.hpp
+ * @brief Skip list of shows ordered by (theater, start time, show id), scanned without locks.
+ *
+ * The catalog snapshot is copied on every update, so a range index inside it costs a
+ * copy per inserted show. This index lives beside the snapshot instead: the one writer
+ * (the catalog writer, under its mutex) links and unlinks nodes in place, and readers
+ * walk it concurrently with acquire loads only.
+ *
+ * A node is fully built before it is linked, bottom level first, each level with one
+ * release store into its predecessor, so a reader that reaches it sees its value and its
+ * forward pointers. Unlinking rewrites the predecessors top level first and leaves the
+ * node's own pointers intact: a reader standing on it walks on to its old successor. The
+ * node is then retired to the epoch domain the readers guard themselves with, so it is
+ * freed only after every such reader has left. A reader racing an update sees the show
+ * either in the index or not; nothing in between.
+ */
+
+namespace booking {
+
+/**
+ * @brief Lock-free-read, single-writer skip list keyed by (theater, start time, id).
+ *
+ * @tparam Value Copyable record with `theater_id`, `start_time` and `id` members
+ *         (BookingService stores its Show records).
+ *
+ * @details
+ * Writers (@ref insert, @ref erase) must be serialised by the caller. Readers
+ * (@ref scan, @ref size) may run at any time but must hold an EpochManager::Guard of the
+ * domain given to the constructor for as long as they use what they read.
+ */
+template <typename Value>
+class ShowTimeIndex {
+public:
+    /** @brief Levels of the list: enough for 4^12 (16 million) entries at p = 1/4. */
+    static constexpr int kMaxHeight = 12;
+
+    /** @brief Index whose unlinked nodes are retired to @p epochs. */
+    explicit ShowTimeIndex(EpochManager& epochs) : epochs_(epochs), head_(Value{}, kMaxHeight) {}
+
+    /** @brief Frees the linked nodes (no reader may be active). */
+    ~ShowTimeIndex() {
+        Node* n = head_.next[0].load(std::memory_order_relaxed);
+        while (n) {
+            Node* next = n->next[0].load(std::memory_order_relaxed);
+            delete n;
+            n = next;
+        }
+    }
+
+    ShowTimeIndex(const ShowTimeIndex&) = delete;
+    ShowTimeIndex& operator=(const ShowTimeIndex&) = delete;
+
+    /** @brief Links @p value; false (nothing changed) if its key is already in. Writer only. */
+    bool insert(const Value& value) {
+        const Key key = key_of(value);
+        Node* preds[kMaxHeight];
+        Node* found = find(key, preds);
+        if (found && !(key < key_of(found->value))) return false;
+
+        const int height = random_height();
+        Node* node = new Node(value, height);
+        for (int l = 0; l < height; ++l) {
+            node->next[l].store(preds[l]->next[l].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        for (int l = 0; l < height; ++l) preds[l]->next[l].store(node, std::memory_order_release);
+        size_.store(size_.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+        return true;
+    }
+
+    /** @brief Unlinks the entry of @p value's key and retires it; false if absent. Writer only. */
+    bool erase(const Value& value) {
+        const Key key = key_of(value);
+        Node* preds[kMaxHeight];
+        Node* node = find(key, preds);
+        if (!node || key < key_of(node->value)) return false;
+        for (int l = node->height - 1; l >= 0; --l) {
+            preds[l]->next[l].store(node->next[l].load(std::memory_order_relaxed), std::memory_order_release);
+        }
+        size_.store(size_.load(std::memory_order_relaxed) - 1u, std::memory_order_relaxed);
+        epochs_.retire(node);
+        return true;
+    }
+
+    /** @brief Replaces the entry of @p value's key with @p value (e.g. a new hall); false if absent. */
+    bool replace(const Value& value) { return erase(value) && insert(value); }
+
+    /**
+     * @brief Calls @p fn with each entry of @p theater starting in [@p from, @p to), in
+     *        (start time, id) order. Reader: hold a guard of the index's epoch domain.
+     */
+    template <typename TheaterId, typename Fn>
+    void scan(TheaterId theater, std::int64_t from, std::int64_t to, Fn&& fn) const {
+        const Key first{static_cast<std::int64_t>(theater.value()), from, std::numeric_limits<std::int64_t>::min()};
+        for (const Node* n = lower_bound(first); n; n = n->next[0].load(std::memory_order_acquire)) {
+            const Key k = key_of(n->value);
+            if (k.theater != first.theater || k.start >= to) break;
+            fn(n->value);
+        }
+    }
+
+    /** @brief Number of entries. */
+    std::size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    /** @brief Approximate bytes of the nodes (value, tower of forward pointers, allocation). */
+    std::size_t bytes() const {
+        // Expected tower height at p = 1/4 is 4/3 pointers
+        return size() * (sizeof(Node) + 2u * sizeof(std::atomic<Node*>) + 16u);
+    }
+
+private:
+    struct Key {
+        std::int64_t theater;
+        std::int64_t start;
+        std::int64_t id;
+
+        friend bool operator<(const Key& a, const Key& b) {
+            if (a.theater != b.theater) return a.theater < b.theater;
+            return a.start != b.start ? a.start < b.start : a.id < b.id;
+        }
+    };
+
+    struct Node {
+        Node(const Value& v, int h) : value(v), height(h), next(new std::atomic<Node*>[static_cast<std::size_t>(h)]) {
+            for (int l = 0; l < h; ++l) next[l].store(nullptr, std::memory_order_relaxed);
+        }
+
+        Value value;
+        int height;
+        std::unique_ptr<std::atomic<Node*>[]> next; /**< Forward pointer per level. */
+    };
+
+    static Key key_of(const Value& v) {
+        return Key{static_cast<std::int64_t>(v.theater_id.value()), static_cast<std::int64_t>(v.start_time),
+                   static_cast<std::int64_t>(v.id.value())};
+    }
+
+    /** @brief First node with a key >= @p key; @p preds gets its predecessor on every level. */
+    Node* find(const Key& key, Node** preds) {
+        Node* x = &head_;
+        for (int l = kMaxHeight - 1; l >= 0; --l) {
+            Node* n = x->next[l].load(std::memory_order_relaxed); // the writer's own stores
+            while (n && key_of(n->value) < key) {
+                x = n;
+                n = x->next[l].load(std::memory_order_relaxed);
+            }
+            preds[l] = x;
+        }
+        return x->next[0].load(std::memory_order_relaxed);
+    }
+
+    /** @brief Reader side of @ref find: first node with a key >= @p key. */
+    const Node* lower_bound(const Key& key) const {
+        const Node* x = &head_;
+        for (int l = kMaxHeight - 1; l >= 0; --l) {
+            const Node* n = x->next[l].load(std::memory_order_acquire);
+            while (n && key_of(n->value) < key) {
+                x = n;
+                n = x->next[l].load(std::memory_order_acquire);
+            }
+        }
+        return x->next[0].load(std::memory_order_acquire);
+    }
+
+    /** @brief Geometric tower height (p = 1/4) from a writer-only xorshift state. */
+    int random_height() {
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 7;
+        rng_ ^= rng_ << 17;
+        int h = 1;
+        for (std::uint64_t bits = rng_; h < kMaxHeight && (bits & 3u) == 0u; bits >>= 2) ++h;
+        return h;
+    }
+
+    EpochManager& epochs_;
+    Node head_;                       /**< Sentinel with a full tower; its value is never read. */
+    std::atomic<std::size_t> size_{0};
+    std::uint64_t rng_ = 0x9E3779B97F4A7C15ull;
+};
+
+} // namespace booking
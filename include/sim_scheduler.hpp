@@ -0,0 +1,125 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file sim_scheduler.hpp
+ * @brief Deterministic simulation of concurrent requests: seeded, replayable interleavings.
+ *
+ * Races between multi-word bookings, cancellations and holds depend on where one thread's
+ * CAS lands between another's load and CAS, which real threads hit rarely and never twice
+ * the same way. A SimScheduler runs a set of tasks as simulated threads: each task has its
+ * own thread, but only one runs at a time. At every schedule point (@ref sim_point, placed
+ * before each seat-word and owner CAS of BookingService) the running task hands control
+ * to a task picked by a PRNG seeded by the caller. The code between two points therefore
+ * runs as one atomic step, and the seed alone fixes the interleaving. A failure found with
+ * seed s replays exactly with seed s. Sweeping seeds explores the interleavings.
+ *
+ * Simulated tasks must not block on each other outside schedule points: use Shared
+ * execution without hot-show promotion, and no Sync journal wait. Schedule points compile
+ * to nothing without BOOKING_SIMULATION (CMake option of the same name); otherwise a point
+ * outside a simulation costs one thread-local load.
+ */
+
+#ifndef BOOKING_SIMULATION
+#define BOOKING_SIMULATION 0
+#endif
+
+namespace booking {
+
+class SimScheduler;
+
+namespace detail {
+
+/** @brief Scheduler of the simulated task running on this thread (null outside a simulation). */
+extern thread_local SimScheduler* sim_current;
+
+} // namespace detail
+
+/**
+ * @brief Runs tasks one at a time, switching between them at schedule points chosen by a seed.
+ *
+ * @details
+ * At each point every unfinished task (the running one included) is equally likely to run
+ * next, so both long uninterrupted runs and fine-grained interleavings come up across
+ * seeds. One simulation at a time per scheduler; schedulers on different threads are
+ * independent.
+ */
+class SimScheduler {
+public:
+    using Task = std::function<void()>;
+
+    explicit SimScheduler(std::uint64_t seed) : seed_(seed) {}
+
+    SimScheduler(const SimScheduler&) = delete;
+    SimScheduler& operator=(const SimScheduler&) = delete;
+
+    /**
+     * @brief Runs @p tasks to completion as simulated threads, then returns.
+     *
+     * @details The PRNG restarts from the seed on every call, so equal calls take equal
+     * schedules. Must not be called from a simulated task.
+     */
+    void run(std::vector<Task> tasks);
+
+    /** @brief Switches to the task the schedule picks (called by @ref sim_point). */
+    void yield();
+
+    std::uint64_t seed() const { return seed_; }
+
+    /** @brief Schedule points passed by the last @ref run. */
+    std::uint64_t points() const { return points_; }
+
+    /** @brief Points of the last @ref run at which another task was picked. */
+    std::uint64_t switches() const { return switches_; }
+
+    /** @brief Digest of the tasks picked during the last @ref run: equal runs, equal digests. */
+    std::uint64_t schedule_hash() const { return hash_; }
+
+private:
+    struct Slot {
+        std::thread thread;
+        std::condition_variable turn; /**< Signalled when the task is picked. */
+        bool done = false;
+    };
+
+    /** @brief Picks the next task among the unfinished ones (mutex_ held). */
+    std::size_t pick();
+
+    /** @brief Hands control to @p next and waits for @p self's next turn (mutex_ held). */
+    void switch_to(std::size_t next, std::size_t self, std::unique_lock<std::mutex>& lock);
+
+    void task_main(std::size_t self, const Task& task);
+
+    const std::uint64_t seed_;
+    std::uint64_t rng_ = 0;
+    std::mutex mutex_;
+    std::condition_variable finished_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::size_t running_ = 0;
+    std::size_t remaining_ = 0;
+    std::uint64_t points_ = 0;
+    std::uint64_t switches_ = 0;
+    std::uint64_t hash_ = 0;
+};
+
+/**
+ * @brief Schedule point: inside a simulation, the running task may be switched out here.
+ *
+ * @details Place before an access whose interleaving with other requests matters (a CAS
+ * on shared state), never while holding a lock another task may wait for.
+ */
+inline void sim_point() {
+#if BOOKING_SIMULATION
+    if (SimScheduler* sim = detail::sim_current) sim->yield();
+#endif
+}
+
+} // namespace booking
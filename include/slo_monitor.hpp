@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "service_metrics.hpp"
+
+/**
+ * @file slo_monitor.hpp
+ * @brief Latency SLOs of the public API evaluated from the service's own histograms.
+ *
+ * A budget says what share of an API's calls must finish within a threshold ("99% of
+ * book_seats under 2 ms"). The monitor samples the cumulative ServiceMetrics histograms:
+ * per budget it keeps (time, calls, calls within the threshold) points, and the difference
+ * between the newest point and the one a window back gives the window's compliance and its
+ * burn rate, the share of slow calls divided by the share the objective allows (1 = the
+ * error budget runs out exactly at the end of the window).
+ *
+ * Alerts use two windows: a budget fires when both the long window and the short one burn
+ * faster than SloPolicy::fast_burn (the long one shows the burn is significant, the short
+ * one that it is still happening) and resolves once the short window drops below it. The
+ * hook is called on each transition. Sampling reads the shards under their list mutex, so
+ * it costs the recording threads nothing.
+ *
+ * The threshold is compared with histogram bucket bounds (about 3% apart): a call counts
+ * as within it when its whole bucket is, so compliance is never overstated.
+ */
+
+namespace booking {
+
+/** @brief Latency objective of one API. */
+struct SloBudget {
+    MetricsApi api = MetricsApi::BookSeats;
+    std::chrono::nanoseconds threshold{std::chrono::milliseconds(2)}; /**< Latency a call must stay within. */
+    double objective = 0.99;                                           /**< Share of calls that must (0..1). */
+};
+
+/** @brief Compliance of one budget over the monitor's windows. */
+struct SloStatus {
+    SloBudget budget;
+    std::uint64_t calls = 0;        /**< Calls in the long window. */
+    std::uint64_t within = 0;       /**< ... of which within the threshold. */
+    double compliance = 1.0;        /**< within / calls (1 without calls). */
+    double budget_left = 1.0;       /**< Share of the window's error budget not yet spent (negative once overspent). */
+    double burn_rate = 0.0;         /**< Over the long window. */
+    double short_burn_rate = 0.0;   /**< Over the short window. */
+    bool alerting = false;          /**< A fast-burn alert is firing. */
+};
+
+/** @brief Hook argument: the budget's status when its alert fired (@p firing) or resolved. */
+struct SloAlert {
+    SloStatus status;
+    bool firing = true;
+};
+
+using SloAlertHook = std::function<void(const SloAlert&)>;
+
+/** @brief Settings of an SloMonitor (and of BookingService::set_slos). */
+struct SloPolicy {
+    std::vector<SloBudget> budgets;                      /**< Empty = no SLO tracking. */
+    std::chrono::seconds window{3600};                   /**< Compliance and long burn window. */
+    std::chrono::seconds short_window{300};              /**< Short burn window. */
+    double fast_burn = 14.4;                             /**< Burn rate that fires an alert (2% of a 30-day budget per hour). */
+    std::uint64_t min_calls = 100;                       /**< Calls the short window needs before an alert fires. */
+    std::chrono::milliseconds interval{10000};           /**< Sampling period of BookingService::set_slos. */
+    SloAlertHook on_alert;                               /**< Called on each firing / resolved transition. */
+};
+
+/**
+ * @brief Rolling-window SLO compliance of a set of budgets.
+ *
+ * @details
+ * Thread-safe; sample() is meant for one periodic caller. The hook runs on the sampling
+ * thread, after the monitor's lock is released.
+ */
+class SloMonitor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit SloMonitor(SloPolicy policy);
+
+    /** @brief Adds a point of the cumulative metrics @p totals taken at @p now and raises alert transitions. */
+    void sample(const std::array<ServiceMetrics::ApiTotals, kMetricsApis>& totals, Clock::time_point now);
+
+    /** @brief Status of every budget as of the last sample, in policy order. */
+    std::vector<SloStatus> status() const;
+
+    /** @brief Calls of @p h that are within @p threshold (whole buckets only). */
+    static std::uint64_t within(const LatencyHistogram& h, std::chrono::nanoseconds threshold);
+
+private:
+    struct Point {
+        Clock::time_point at;
+        std::uint64_t calls;
+        std::uint64_t within;
+    };
+
+    /** @brief Burn rate between the newest point of @p points and the last one at or before @p since. */
+    double burn(const std::deque<Point>& points, Clock::time_point since, double objective,
+                std::uint64_t* calls = nullptr, std::uint64_t* within = nullptr) const;
+
+    SloPolicy policy_;
+    mutable std::mutex mutex_;
+    std::vector<std::deque<Point>> points_; /**< Per budget, oldest first, reaching back one window. */
+    std::vector<SloStatus> status_;
+};
+
+} // namespace booking
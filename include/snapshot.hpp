@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @file snapshot.hpp
+ * @brief Versioned binary snapshot of the catalog and all seat words.
+ *
+ * The file is a fixed header followed by fixed-size little-endian records in 8-byte aligned
+ * sections, so a mapped file is used in place: loading is a bounds check, a checksum pass
+ * and pointer casts, with no parsing.
+ *
+ *     SnapshotHeader
+ *     SnapshotName[movies]  SnapshotName[theaters]
+ *     SnapshotLayout[layouts]  SnapshotRow[layout rows]
+ *     SnapshotShow[shows]
+ *     u8[seat maps]         booking words and owners of every show (seat_map_codec.hpp)
+ *     char[strings]         titles, names and row labels referenced by offset/length
+ *
+ * Seat maps are the one encoded section: an empty or sold-out hall takes a few bytes
+ * instead of 8 bytes of words and 256 bytes of owners per row, so a snapshot (and the
+ * transfer of one to a new replica) shrinks by one to two orders of magnitude.
+ *
+ * The checksum covers everything after the header.
+ */
+
+namespace booking {
+
+/**
+ * @brief Current snapshot format version (2: show start time and hall, 3: theater
+ *        locations, 4: encoded seat maps, 5: highest booking per show, 6: 64-bit ids).
+ */
+constexpr std::uint32_t kSnapshotVersion = 6;
+
+/** @brief File magic ("BKSNAP" + two format bytes). */
+constexpr char kSnapshotMagic[8] = {'B', 'K', 'S', 'N', 'A', 'P', '\r', '\n'};
+
+/** @brief Location of one section (offset in bytes from the file start, record count). */
+struct SnapshotSection {
+    std::uint64_t offset;
+    std::uint64_t count;
+};
+
+/** @brief File header. */
+struct SnapshotHeader {
+    char magic[8];               /**< kSnapshotMagic. */
+    std::uint32_t version;       /**< kSnapshotVersion. */
+    std::uint32_t header_size;   /**< sizeof(SnapshotHeader). */
+    std::uint64_t file_size;     /**< Total size in bytes. */
+    std::uint64_t checksum;      /**< snapshot_checksum of bytes [header_size, file_size). */
+    std::uint64_t journal_lsn;   /**< Journal LSN when writing started; replay resumes here (0 = no journal). */
+    SnapshotSection movies;      /**< SnapshotName records. */
+    SnapshotSection theaters;    /**< SnapshotName records. */
+    SnapshotSection layouts;     /**< SnapshotLayout records. */
+    SnapshotSection rows;        /**< SnapshotRow records. */
+    SnapshotSection shows;       /**< SnapshotShow records. */
+    SnapshotSection seat_maps;   /**< Bytes of encoded seat maps. */
+    SnapshotSection strings;     /**< Bytes. */
+};
+
+/** @brief Movie or theater record. */
+struct SnapshotName {
+    std::int64_t id;
+    std::uint32_t name_offset;   /**< Into the strings section. */
+    std::uint32_t name_length;
+    double latitude;             /**< Theater location (NaN = unknown; always NaN for movies). */
+    double longitude;
+};
+
+/** @brief Layout record (its rows are rows[first_row, first_row + row_count)). */
+struct SnapshotLayout {
+    std::uint32_t first_row;
+    std::uint32_t row_count;
+};
+
+/** @brief Row of a layout. */
+struct SnapshotRow {
+    std::uint32_t label_offset;  /**< Into the strings section. */
+    std::uint32_t label_length;
+    std::int32_t seats;
+    std::uint32_t label_grammar; /**< seat_label::LabelGrammar of the layout (0 = RowSeat, as before). */
+};
+
+/** @brief Show record; its seat map is seat_maps[seat_map, seat_map + seat_map_size). */
+struct SnapshotShow {
+    std::int64_t id;
+    std::int64_t movie_id;
+    std::int64_t theater_id;
+    std::int32_t layout_id;      /**< Index into the layouts section. */
+    std::int32_t hall;           /**< Show::hall. */
+    std::uint64_t seat_map;      /**< Byte offset into the seat maps section. */
+    std::uint64_t seat_map_size; /**< Bytes of the seat map. */
+    std::int64_t start_time;     /**< Show::start_time. */
+    std::uint32_t max_booking;   /**< Highest owner in the seat map (0 = no bookings); a lazy restore skips decoding. */
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(SnapshotHeader) == 152, "snapshot header layout");
+static_assert(sizeof(SnapshotName) == 32 && sizeof(SnapshotLayout) == 8, "snapshot record layout");
+static_assert(sizeof(SnapshotRow) == 16 && sizeof(SnapshotShow) == 64, "snapshot record layout");
+
+/** @brief Current snapshot delta format version (2: 64-bit show ids). */
+constexpr std::uint32_t kSnapshotDeltaVersion = 2;
+
+/** @brief Delta file magic ("BKDELT" + two format bytes). */
+constexpr char kSnapshotDeltaMagic[8] = {'B', 'K', 'D', 'E', 'L', 'T', '\r', '\n'};
+
+/**
+ * @brief Header of a snapshot delta: the seat maps of the shows that changed since the
+ *        previous delta (or since the base snapshot), laid out as
+ *
+ *     SnapshotDeltaHeader
+ *     SnapshotDeltaShow[shows]
+ *     u8[seat maps]         as in a full snapshot
+ *
+ * A delta applies only on top of the base snapshot whose checksum it names and of the
+ * deltas numbered below it.
+ */
+struct SnapshotDeltaHeader {
+    char magic[8];               /**< kSnapshotDeltaMagic. */
+    std::uint32_t version;       /**< kSnapshotDeltaVersion. */
+    std::uint32_t header_size;   /**< sizeof(SnapshotDeltaHeader). */
+    std::uint64_t file_size;     /**< Total size in bytes. */
+    std::uint64_t checksum;      /**< snapshot_checksum of bytes [header_size, file_size). */
+    std::uint64_t journal_lsn;   /**< Journal LSN when writing started (0 = no journal). */
+    std::uint64_t base_checksum; /**< SnapshotHeader::checksum of the base snapshot. */
+    std::uint64_t sequence;      /**< 1 for the first delta after the base, then +1. */
+    SnapshotSection shows;       /**< SnapshotDeltaShow records. */
+    SnapshotSection seat_maps;   /**< Bytes of encoded seat maps. */
+};
+
+/** @brief Changed show of a delta; its seat map is seat_maps[seat_map, seat_map + seat_map_size). */
+struct SnapshotDeltaShow {
+    std::int64_t id;
+    std::uint64_t seat_map;      /**< Byte offset into the seat maps section. */
+    std::uint64_t seat_map_size; /**< Bytes of the seat map. */
+};
+
+static_assert(sizeof(SnapshotDeltaHeader) == 88 && sizeof(SnapshotDeltaShow) == 24, "snapshot delta layout");
+
+/**
+ * @brief Order-dependent 64-bit checksum of a sequence of 8-byte words.
+ *
+ * @details
+ * Streaming: feed consecutive blocks (each a whole number of words) by passing the
+ * previous result as @p seed.
+ */
+std::uint64_t snapshot_checksum(const std::uint64_t* words, std::size_t count, std::uint64_t seed = 0);
+
+/**
+ * @brief Outcome of writing or restoring a snapshot.
+ */
+enum class SnapshotStatus : std::uint8_t {
+    Ok,                 /**< Written / restored. */
+    IoError,            /**< The file could not be created, written, opened or mapped. */
+    BadMagic,           /**< Not a snapshot file. */
+    UnsupportedVersion, /**< Written by an incompatible version (or a big-endian host). */
+    Corrupt,            /**< Truncated, checksum mismatch or out-of-bounds references. */
+    CatalogError,       /**< The snapshot conflicts with the service's catalog; nothing restored. */
+};
+
+/** @brief Static description of a snapshot status. */
+const char* to_string(SnapshotStatus status);
+
+/**
+ * @brief When a restore decodes the seat maps of a snapshot.
+ */
+enum class SnapshotLoad : std::uint8_t {
+    Eager, /**< Every show's seats before the restore returns. */
+    Lazy,  /**< Each show's seats on its first access; the file stays mapped until then. */
+};
+
+/** @brief Static name of a snapshot load mode. */
+const char* to_string(SnapshotLoad load);
+
+/**
+ * @brief Validated, typed view of a mapped snapshot.
+ */
+class SnapshotView {
+public:
+    /**
+     * @brief Validates @p bytes (header, bounds of every section and reference, checksum,
+     *        the encoding of every seat map).
+     * @return Ok, or the first problem found; the view is only usable on Ok.
+     */
+    SnapshotStatus open(std::string_view bytes);
+
+    const SnapshotHeader& header() const { return *header_; }
+    const SnapshotName* movies() const { return at<SnapshotName>(header_->movies); }
+    const SnapshotName* theaters() const { return at<SnapshotName>(header_->theaters); }
+    const SnapshotLayout* layouts() const { return at<SnapshotLayout>(header_->layouts); }
+    const SnapshotRow* rows() const { return at<SnapshotRow>(header_->rows); }
+    const SnapshotShow* shows() const { return at<SnapshotShow>(header_->shows); }
+    const std::uint8_t* seat_maps() const { return at<std::uint8_t>(header_->seat_maps); }
+
+    /** @brief String of the strings section. */
+    std::string_view string(std::uint32_t offset, std::uint32_t length) const {
+        return std::string_view(at<char>(header_->strings) + offset, length);
+    }
+
+private:
+    template <typename T>
+    const T* at(const SnapshotSection& s) const {
+        return reinterpret_cast<const T*>(base_ + s.offset);
+    }
+
+    const char* base_ = nullptr;
+    const SnapshotHeader* header_ = nullptr;
+};
+
+/**
+ * @brief Validated, typed view of a mapped snapshot delta.
+ */
+class SnapshotDeltaView {
+public:
+    /**
+     * @brief Validates @p bytes (header, bounds of both sections and every seat map
+     *        reference, checksum); seat maps are decoded against the service's layouts
+     *        when applied.
+     * @return Ok, or the first problem found; the view is only usable on Ok.
+     */
+    SnapshotStatus open(std::string_view bytes);
+
+    const SnapshotDeltaHeader& header() const { return *header_; }
+    const SnapshotDeltaShow* shows() const {
+        return reinterpret_cast<const SnapshotDeltaShow*>(base_ + header_->shows.offset);
+    }
+    const std::uint8_t* seat_maps() const {
+        return reinterpret_cast<const std::uint8_t*>(base_ + header_->seat_maps.offset);
+    }
+
+private:
+    const char* base_ = nullptr;
+    const SnapshotDeltaHeader* header_ = nullptr;
+};
+
+} // namespace booking
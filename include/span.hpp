@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @file span.hpp
+ * @brief Minimal non-owning contiguous view (subset of C++20 std::span) for C++17 builds.
+ */
+
+namespace booking {
+
+/**
+ * @brief Non-owning view over @c size() contiguous elements of type T.
+ *
+ * @details
+ * Used by the zero-copy APIs so callers can pass vectors, arrays or raw buffers
+ * (e.g. straight out of a network buffer) without building a container.
+ * The viewed storage must outlive the span.
+ */
+template <typename T>
+class Span {
+public:
+    Span() = default;
+
+    /** @brief View over [data, data + size). */
+    Span(T* data, std::size_t size) : data_(data), size_(size) {}
+
+    /** @brief View over a C array. */
+    template <std::size_t N>
+    Span(T (&arr)[N]) : data_(arr), size_(N) {}
+
+    /** @brief View over a std::vector (const or mutable elements). */
+    template <typename U, typename A>
+    Span(std::vector<U, A>& v) : data_(v.data()), size_(v.size()) {}
+
+    /** @brief Read-only view over a const std::vector. */
+    template <typename U, typename A>
+    Span(const std::vector<U, A>& v) : data_(v.data()), size_(v.size()) {}
+
+    /** @brief View over a std::array. */
+    template <typename U, std::size_t N>
+    Span(std::array<U, N>& a) : data_(a.data()), size_(N) {}
+
+    /** @brief Read-only view over a const std::array. */
+    template <typename U, std::size_t N>
+    Span(const std::array<U, N>& a) : data_(a.data()), size_(N) {}
+
+    T* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T& operator[](std::size_t i) const { return data_[i]; }
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+
+    /** @brief Sub-view [offset, offset + count). */
+    Span subspan(std::size_t offset, std::size_t count) const { return Span(data_ + offset, count); }
+
+private:
+    T* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace booking
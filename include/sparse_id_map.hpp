@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if defined(__SSE2__)
+#define BOOKING_SPARSE_ID_MAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/**
+ * @file sparse_id_map.hpp
+ * @brief Open-addressing id -> slot map with lock-free lookups, for ids too sparse for a dense table.
+ *
+ * Laid out as a Swiss table: keys and slots in flat arrays and, beside them, one control
+ * byte per entry (0x80 = empty, else the low 7 bits of the key's hash). Entries are probed
+ * in groups of 16 control bytes; one SSE2 compare (or SWAR on two words without SSE2)
+ * finds the entries of a group whose hash bits match, so a lookup usually touches one
+ * control group and one key. The table is insert-only: an entry is never removed, which
+ * lets a lookup stop at the first group with an empty entry.
+ */
+
+namespace booking {
+
+/**
+ * @brief Insert-only map of 64-bit ids to 32-bit slots.
+ *
+ * @details
+ * @ref find is lock-free and may run concurrently with @ref insert; insert calls must be
+ * serialised by the caller. An insert writes the key and slot, then publishes the control
+ * byte with a release store. A full table grows by publishing a rehashed copy twice the
+ * size; old tables are kept until the map is destroyed (their total size is bounded by
+ * the size of the current one), so a reader still probing one stays valid.
+ */
+class SparseIdMap {
+public:
+    /** @brief No slot (returned by @ref find for an absent id). */
+    static constexpr std::uint32_t kNoSlot = ~std::uint32_t{0};
+
+    /** @brief Control bytes probed together. */
+    static constexpr std::size_t kGroupSize = 16;
+
+    SparseIdMap() = default;
+    SparseIdMap(const SparseIdMap&) = delete;
+    SparseIdMap& operator=(const SparseIdMap&) = delete;
+
+    /** @brief Slot of @p id, or kNoSlot. */
+    std::uint32_t find(std::uint64_t id) const {
+        const Table* t = table_.load(std::memory_order_acquire);
+        if (!t) return kNoSlot;
+        const std::uint64_t h = hash(id);
+        const std::uint8_t tag = static_cast<std::uint8_t>(h & 0x7Fu);
+        std::size_t group = static_cast<std::size_t>(h >> 7) & t->group_mask;
+        for (std::size_t step = 1;; ++step) {
+            const std::atomic<std::uint64_t>* ctrl = &t->ctrl[group * 2u];
+            const std::uint64_t lo = ctrl[0].load(std::memory_order_acquire);
+            const std::uint64_t hi = ctrl[1].load(std::memory_order_acquire);
+            for (std::uint32_t m = match(lo, hi, tag); m != 0u; m &= m - 1u) {
+                const std::size_t e = group * kGroupSize + static_cast<std::size_t>(__builtin_ctz(m));
+                if (t->keys[e].load(std::memory_order_relaxed) == id) return t->slots[e].load(std::memory_order_relaxed);
+            }
+            if (empty(lo, hi) != 0u) return kNoSlot;
+            group = (group + step) & t->group_mask; // triangular probing visits every group
+        }
+    }
+
+    /**
+     * @brief Maps @p id to @p slot.
+     * @return False (and no change) if @p id is already present.
+     */
+    bool insert(std::uint64_t id, std::uint32_t slot);
+
+    /** @brief Number of ids. */
+    std::size_t size() const { return size_; }
+
+    /** @brief Entries of the current table (0 before the first insert). */
+    std::size_t capacity() const {
+        const Table* t = table_.load(std::memory_order_acquire);
+        return t ? (t->group_mask + 1u) * kGroupSize : 0u;
+    }
+
+    /** @brief Mixes @p id so that sequential and strided ids spread over the groups. */
+    static std::uint64_t hash(std::uint64_t id) {
+        std::uint64_t h = id * 0x9E3779B97F4A7C15u;
+        return h ^ (h >> 29);
+    }
+
+private:
+    static constexpr std::uint8_t kEmpty = 0x80;
+    static constexpr std::uint64_t kEmptyWord = 0x8080808080808080u;
+
+    struct Table {
+        std::size_t group_mask;                              /**< Groups - 1 (a power of two minus one). */
+        std::unique_ptr<std::atomic<std::uint64_t>[]> ctrl;  /**< Two words of control bytes per group. */
+        std::unique_ptr<std::atomic<std::uint64_t>[]> keys;
+        std::unique_ptr<std::atomic<std::uint32_t>[]> slots;
+    };
+
+    /** @brief Bit i set: control byte i of the group (lo word first) is @p tag. */
+    static std::uint32_t match(std::uint64_t lo, std::uint64_t hi, std::uint8_t tag) {
+#if BOOKING_SPARSE_ID_MAP_SSE2
+        const __m128i group = _mm_set_epi64x(static_cast<long long>(hi), static_cast<long long>(lo));
+        const __m128i eq = _mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(tag)));
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(eq));
+#else
+        return match_word(lo, tag) | match_word(hi, tag) << 8;
+#endif
+    }
+
+    /** @brief Bit i set: control byte i of the group is empty. */
+    static std::uint32_t empty(std::uint64_t lo, std::uint64_t hi) {
+#if BOOKING_SPARSE_ID_MAP_SSE2
+        return static_cast<std::uint32_t>(
+            _mm_movemask_epi8(_mm_set_epi64x(static_cast<long long>(hi), static_cast<long long>(lo))));
+#else
+        return byte_mask(lo & kEmptyWord) | byte_mask(hi & kEmptyWord) << 8;
+#endif
+    }
+
+#if !BOOKING_SPARSE_ID_MAP_SSE2
+    /** @brief Bit i set: the high bit of byte i of @p msbs is set. */
+    static std::uint32_t byte_mask(std::uint64_t msbs) {
+        return static_cast<std::uint32_t>(((msbs >> 7) * 0x0102040810204080u) >> 56);
+    }
+
+    /** @brief SWAR equality of the 8 bytes of @p word with @p tag (exact, as tags are 7-bit). */
+    static std::uint32_t match_word(std::uint64_t word, std::uint8_t tag) {
+        const std::uint64_t x = word ^ (0x0101010101010101u * tag);
+        return byte_mask(~(((x & 0x7F7F7F7F7F7F7F7Fu) + 0x7F7F7F7F7F7F7F7Fu) | x) & kEmptyWord);
+    }
+#endif
+
+    /** @brief Writes @p id -> @p slot into the first empty entry of its probe sequence in @p t. */
+    static void place(Table& t, std::uint64_t id, std::uint32_t slot);
+
+    /** @brief New table of @p groups groups, all entries empty. */
+    static std::unique_ptr<Table> make_table(std::size_t groups);
+
+    std::atomic<Table*> table_{nullptr};                /**< Current table. */
+    std::vector<std::unique_ptr<Table>> tables_;        /**< All tables ever published. */
+    std::size_t size_ = 0;
+};
+
+} // namespace booking
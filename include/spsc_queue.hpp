@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+/**
+ * @file spsc_queue.hpp
+ * @brief Bounded lock-free single-producer / single-consumer ring.
+ *
+ * The producer owns the tail index and the consumer the head index; each side keeps a
+ * cached copy of the other's index and only reloads it when the ring looks full (or
+ * empty), so in steady state a push or pop touches no cache line written by the other
+ * side except the slot itself.
+ */
+
+namespace booking {
+
+/**
+ * @brief Fixed-capacity SPSC ring of trivially copyable values.
+ *
+ * @tparam T Element type (copied in and out).
+ *
+ * @details
+ * Exactly one thread may call @ref push and exactly one (other) thread @ref pop.
+ */
+template <typename T>
+class SpscQueue {
+public:
+    /**
+     * @brief Creates a ring of @p capacity slots.
+     * @throws std::invalid_argument unless @p capacity is a power of two >= 2.
+     */
+    explicit SpscQueue(std::size_t capacity)
+        : slots_(new T[capacity]), mask_(capacity - 1u) {
+        if (capacity < 2u || (capacity & (capacity - 1u)) != 0u) {
+            throw std::invalid_argument("SpscQueue capacity must be a power of two >= 2");
+        }
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /** @brief Number of slots. */
+    std::size_t capacity() const { return mask_ + 1u; }
+
+    /** @brief Appends @p value; false if the ring is full. Producer only. */
+    bool push(const T& value) {
+        const std::size_t tail = producer_.tail.load(std::memory_order_relaxed);
+        if (tail - producer_.head_cache > mask_) {
+            producer_.head_cache = consumer_.head.load(std::memory_order_acquire);
+            if (tail - producer_.head_cache > mask_) return false;
+        }
+        slots_[tail & mask_] = value;
+        producer_.tail.store(tail + 1u, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Removes the oldest value into @p out; false if the ring is empty. Consumer only. */
+    bool pop(T& out) {
+        const std::size_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (head == consumer_.tail_cache) {
+            consumer_.tail_cache = producer_.tail.load(std::memory_order_acquire);
+            if (head == consumer_.tail_cache) return false;
+        }
+        out = slots_[head & mask_];
+        consumer_.head.store(head + 1u, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief True if no value is queued (exact only when called by the consumer). */
+    bool empty() const {
+        return consumer_.head.load(std::memory_order_acquire) == producer_.tail.load(std::memory_order_acquire);
+    }
+
+private:
+    struct alignas(64) Producer {
+        std::atomic<std::size_t> tail{0};  /**< Next slot to write. */
+        std::size_t head_cache = 0;        /**< Consumer head as last seen by the producer. */
+    };
+    struct alignas(64) Consumer {
+        std::atomic<std::size_t> head{0};  /**< Next slot to read. */
+        std::size_t tail_cache = 0;        /**< Producer tail as last seen by the consumer. */
+    };
+
+    std::unique_ptr<T[]> slots_;
+    std::size_t mask_;
+    Producer producer_;
+    Consumer consumer_;
+};
+
+} // namespace booking
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "booking_service.hpp"
+
+/**
+ * @file standby.hpp
+ * @brief Warm standby: a second process that keeps its seat state current from the
+ *        primary's snapshot and journal files and is promoted in place.
+ *
+ * A ReplicaClient (replication.hpp) needs the primary process to stream to it; a standby
+ * on the same host or on shared storage reads the primary's files directly. It restores
+ * the primary's snapshot or checkpoint directory with SnapshotLoad::Lazy, so the file stays
+ * memory-mapped and a show decodes on its first access, then a tail thread follows the
+ * journal file and applies every new record with BookingService::apply_journal_record
+ * within a poll interval of its write. Reads can be served meanwhile, e.g. by a
+ * BookingServer with BookingServerOptions::read_only.
+ *
+ * When the primary fails, promote() applies the few records written since the last poll,
+ * stops the tail and opens the same journal for appending: Journal::open truncates a torn
+ * tail and continues the LSNs, and the state array already holds every record, so nothing
+ * is replayed at failover. BookingServer::set_read_only(false) then takes bookings.
+ *
+ * The journal is tailed like a ReplicationSource reads it: whole records only, the
+ * zero-filled end of a Mapped journal is its end, and a journal replaced by
+ * Journal::compact is finished before continuing in the new file. Promoting while the old
+ * primary still writes would fork the journal; fencing it (stopping the process, revoking
+ * the storage) is the operator's or cluster manager's job.
+ */
+
+namespace booking {
+
+/** @brief Warm standby configuration. */
+struct StandbyOptions {
+    std::string snapshot_path;                  /**< Primary's snapshot file or checkpoint directory (empty = none). */
+    std::string journal_path;                   /**< Primary's journal, tailed, then appended to when promoted. */
+    SnapshotLoad load = SnapshotLoad::Lazy;     /**< How the snapshot is restored. */
+    std::chrono::milliseconds poll_interval{1}; /**< Pause when the journal has nothing new. */
+};
+
+/**
+ * @brief Follows a primary's journal into a local BookingService until promoted.
+ *
+ * @details
+ * Without a snapshot the service must already hold the primary's catalog (the same
+ * schedule) and the journal is applied from its start; with one, the service should be
+ * built with BookingService::EmptyCatalog and records the snapshot covers are skipped.
+ */
+class WarmStandby {
+public:
+    WarmStandby(BookingService& service, StandbyOptions options);
+
+    /** @brief @ref stop. */
+    ~WarmStandby();
+
+    WarmStandby(const WarmStandby&) = delete;
+    WarmStandby& operator=(const WarmStandby&) = delete;
+
+    /**
+     * @brief Restores the snapshot and starts tailing the journal (it may not exist yet).
+     * @return The snapshot restore's status; nothing is started on error.
+     * @note Call once, before the service serves traffic.
+     */
+    SnapshotStatus start();
+
+    /**
+     * @brief Makes the service the primary: applies the journal to its end, stops the tail
+     *        and opens the journal with @p mode and @p backend (BookingService::open_journal).
+     * @return The journal's status; on error the tail stays stopped and the call may be retried.
+     */
+    JournalStatus promote(JournalMode mode = JournalMode::Sync, JournalBackend backend = JournalBackend::Auto);
+
+    /** @brief True once @ref promote succeeded. */
+    bool promoted() const { return promoted_.load(std::memory_order_acquire); }
+
+    /** @brief Stops tailing and joins the thread; idempotent (the service keeps its state). */
+    void stop();
+
+    /** @brief LSN after the last record applied or covered by the snapshot. */
+    std::uint64_t next_lsn() const { return next_lsn_.load(std::memory_order_acquire); }
+
+    /** @brief Records applied and skipped (unknown shows) so far. */
+    std::uint64_t applied_records() const { return applied_.load(std::memory_order_relaxed); }
+    std::uint64_t skipped_records() const { return skipped_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Age of the newest point at which the standby held the whole journal
+     *        (nanoseconds::max() before the tail first reached its end).
+     */
+    std::chrono::nanoseconds staleness() const;
+
+private:
+    /** @brief Tail thread: @ref poll until @ref stop, pausing whenever the journal is read to its end. */
+    void run();
+
+    /**
+     * @brief Reads and applies the next chunk of the journal.
+     * @return True if the journal was read to its end (nothing more to apply for now).
+     */
+    bool poll();
+
+    /** @brief Closes the journal file and forgets the read position. */
+    void close_file();
+
+    BookingService& service_;
+    StandbyOptions options_;
+    std::unique_ptr<char[]> buf_;  /**< Read chunk. */
+    int file_ = -1;                /**< Journal being tailed, -1 until it exists. */
+    std::int64_t file_pos_ = 0;    /**< Offset of the first byte not applied yet. */
+    bool header_checked_ = false;  /**< The file header of file_ was valid. */
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> promoted_{false};
+    std::atomic<std::uint64_t> next_lsn_{0};
+    std::atomic<std::uint64_t> applied_{0};
+    std::atomic<std::uint64_t> skipped_{0};
+    std::atomic<std::int64_t> caught_up_ns_{-1}; /**< Steady time of the last read that reached the end; -1 = never. */
+    std::mutex mutex_;
+    std::condition_variable cv_;   /**< Wakes the tail thread for @ref stop. */
+    std::thread thread_;
+};
+
+} // namespace booking
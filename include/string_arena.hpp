@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @file string_arena.hpp
+ * @brief Append-only interning arena for catalog strings (titles, names).
+ */
+
+namespace booking {
+
+/**
+ * @brief Interns strings into large chunks and hands out stable views.
+ *
+ * @details
+ * Equal strings are stored once. Chunks are never moved or freed before the arena, so a
+ * returned view stays valid for the arena's lifetime and can be copied around (and read
+ * from any thread) without owning anything. Interning is not thread-safe: writers
+ * serialise it externally.
+ */
+class StringArena {
+public:
+    /** @brief Bytes per chunk; longer strings get a chunk of their own. */
+    static constexpr std::size_t kChunkSize = 64 * 1024;
+
+    StringArena() = default;
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    /** @brief Returns the arena's copy of @p s, storing it on first use. */
+    std::string_view intern(std::string_view s);
+
+    /** @brief Distinct strings stored. */
+    std::size_t size() const { return index_.size(); }
+
+    /** @brief Bytes reserved by all chunks. */
+    std::size_t capacity_bytes() const { return reserved_; }
+
+private:
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char* cursor_ = nullptr;     /**< Free space of the current chunk. */
+    std::size_t left_ = 0;       /**< Bytes left at cursor_. */
+    std::size_t reserved_ = 0;
+    std::unordered_set<std::string_view> index_; /**< Views into the chunks. */
+};
+
+} // namespace booking
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "admission.hpp"
+#include "booking_service.hpp"
+
+/**
+ * @file tenant_registry.hpp
+ * @brief Several cinema chains (tenants) served by one process.
+ *
+ * Every tenant owns a BookingService of its own, so its catalog columns, state arrays,
+ * owner rows and strings are allocated together and never interleaved with another
+ * chain's: a scan of one tenant's shows touches only that tenant's memory. What the
+ * tenants share is the process: code, the thread pool, the server and its connections.
+ *
+ * A noisy tenant is contained by its quota, checked before a request reaches its service:
+ * a request rate (an AdmissionGate, the same GCRA as the per-show gates), a cap on its
+ * requests running at once and a cap on its catalog size. Counters are per tenant, on
+ * the tenant's own cache lines, and exported with a tenant label.
+ */
+
+namespace booking {
+
+/** @brief Limits of one tenant (zero / a rate <= 0 = unlimited). */
+struct TenantQuota {
+    std::size_t max_shows = 0;       /**< Shows the tenant's catalog may hold. */
+    AdmissionPolicy requests;        /**< Requests admitted per second, tenant-wide. */
+    std::uint32_t max_in_flight = 0; /**< Requests of the tenant running at once. */
+};
+
+/** @brief Outcome of Tenant::admit. */
+enum class TenantAdmission : std::uint8_t {
+    Admitted,    /**< The request may run; release the ticket when it is done. */
+    RateLimited, /**< The tenant is over its request rate. */
+    Busy,        /**< The tenant already has max_in_flight requests running. */
+};
+
+/** @brief Static description of an admission outcome. */
+const char* to_string(TenantAdmission admission);
+
+/** @brief Counters of one tenant. */
+struct TenantStats {
+    std::uint64_t admitted = 0;     /**< Requests admitted. */
+    std::uint64_t rate_limited = 0; /**< Requests turned away by the rate. */
+    std::uint64_t busy = 0;         /**< Requests turned away by max_in_flight. */
+    std::uint32_t in_flight = 0;    /**< Requests running now. */
+    std::size_t shows = 0;          /**< Shows in the tenant's catalog. */
+};
+
+/**
+ * @brief One cinema chain: its BookingService, quota and counters.
+ *
+ * @details
+ * Requests take a ticket from @ref admit and run on @ref service while it is held.
+ * Catalog writes that grow the catalog go through @ref add_show / @ref load_schedule,
+ * which enforce max_shows; the service's other catalog calls are unaffected.
+ */
+class Tenant {
+public:
+    /** @brief Admission of one request; releases its in-flight slot when destroyed. */
+    class Ticket {
+    public:
+        Ticket() = default;
+        Ticket(Ticket&& other) noexcept : tenant_(other.tenant_), status_(other.status_) { other.tenant_ = nullptr; }
+        Ticket& operator=(Ticket&& other) noexcept;
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+        ~Ticket() { release(); }
+
+        /** @brief True if the request was admitted. */
+        explicit operator bool() const { return status_ == TenantAdmission::Admitted; }
+
+        TenantAdmission status() const { return status_; }
+
+        /** @brief Gives the in-flight slot back early (idempotent). */
+        void release();
+
+    private:
+        friend class Tenant;
+        Ticket(Tenant* tenant, TenantAdmission status) : tenant_(tenant), status_(status) {}
+
+        Tenant* tenant_ = nullptr; /**< Set while an in-flight slot is held. */
+        TenantAdmission status_ = TenantAdmission::Busy;
+    };
+
+    /** @brief Creates a tenant with an empty catalog. */
+    Tenant(std::string name, const TenantQuota& quota);
+
+    Tenant(const Tenant&) = delete;
+    Tenant& operator=(const Tenant&) = delete;
+
+    const std::string& name() const { return name_; }
+
+    /** @brief The tenant's own service. */
+    BookingService& service() { return service_; }
+    const BookingService& service() const { return service_; }
+
+    /** @brief Current quota. */
+    TenantQuota quota() const;
+
+    /** @brief Replaces the quota; requests already running keep their slots. */
+    void set_quota(const TenantQuota& quota);
+
+    /**
+     * @brief Admits a request at @p now_ns (steady clock): the in-flight cap first, then
+     *        the rate, so a busy tenant does not use up its rate on requests it turns away.
+     */
+    Ticket admit(std::int64_t now_ns);
+
+    /** @brief @ref admit at the current steady-clock time. */
+    Ticket admit();
+
+    /** @brief BookingService::add_show, or OverQuota if the catalog holds max_shows shows. */
+    CatalogStatus add_show(const Show& show);
+
+    /**
+     * @brief BookingService::load_schedule, or CatalogError with nothing loaded if the
+     *        schedule could take the catalog past max_shows.
+     */
+    ScheduleError load_schedule(Schedule schedule);
+
+    /** @brief Reads the counters (approximate while requests are running). */
+    TenantStats stats() const;
+
+private:
+    const std::string name_;
+
+    // Written by every request of the tenant, so kept off the lines of the fields above
+    alignas(64) AdmissionGate gate_;
+    alignas(64) std::atomic<std::uint32_t> in_flight_{0};
+    std::atomic<std::uint32_t> max_in_flight_{0};
+    std::atomic<std::uint64_t> admitted_{0};
+    std::atomic<std::uint64_t> rate_limited_{0};
+    std::atomic<std::uint64_t> busy_{0};
+
+    /** @brief Serialises quota changes and the quota-checked catalog writes. */
+    alignas(64) mutable std::mutex mutex_;
+    TenantQuota quota_;
+    BookingService service_{BookingService::EmptyCatalog{}};
+};
+
+/**
+ * @brief Tenants of the process by name.
+ *
+ * @details
+ * Tenants are added, never removed, and keep their address. Lookups are lock-free: they
+ * read an immutable name-sorted index that @ref add_tenant replaces (older indexes are
+ * kept until the registry is destroyed, so a lookup never needs to pin anything).
+ */
+class TenantRegistry {
+public:
+    TenantRegistry() = default;
+    ~TenantRegistry();
+
+    TenantRegistry(const TenantRegistry&) = delete;
+    TenantRegistry& operator=(const TenantRegistry&) = delete;
+
+    /** @brief Adds a tenant with an empty catalog; null if @p name is empty or taken. */
+    Tenant* add_tenant(std::string name, const TenantQuota& quota = {});
+
+    /** @brief The tenant called @p name, or null. */
+    Tenant* find(std::string_view name) const;
+
+    /** @brief Number of tenants. */
+    std::size_t size() const;
+
+    /** @brief Tenants in name order. */
+    std::vector<Tenant*> tenants() const;
+
+    /**
+     * @brief Per-tenant admission counters, running requests, shows and booked seats in
+     *        the Prometheus text format, labelled tenant="<name>".
+     */
+    std::string metrics_prometheus() const;
+
+private:
+    using Index = std::vector<Tenant*>;
+
+    std::atomic<const Index*> index_{nullptr};
+    std::mutex mutex_; /**< Serialises @ref add_tenant. */
+    std::vector<std::unique_ptr<Tenant>> owned_;
+    std::vector<std::unique_ptr<const Index>> indexes_; /**< Every index published, current last. */
+};
+
+} // namespace booking
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "booking_service.hpp"
+#include "rate_limiter.hpp"
+#include "show_routes.hpp"
+
+/**
+ * @file text_protocol.hpp
+ * @brief Line-based text protocol mirroring the CLI commands.
+ *
+ * One request per line (LF or CRLF), tokens separated by spaces or tabs:
+ *
+ *     movies [<cursor> <limit>]
+ *     search <title words>
+ *     theaters <movie_id> [<cursor> <limit>]
+ *     seats <movie_id> <theater_id>
+ *     book <movie_id> <theater_id> <seat> [<seat> ...]
+ *     cancel <movie_id> <theater_id> <booking_id> <seat> [<seat> ...]
+ *     help
+ *     quit
+ *
+ * Every response is zero or more data lines followed by exactly one status line that
+ * starts with "OK" or "ERR", so a client can pipeline requests and match responses by
+ * order:
+ *
+ *     movies         ->  "1 Inception" ... "OK 3"
+ *     movies 0 2     ->  "1 Inception" "2 Interstellar" "OK 2 2"   (page; then "movies 2 2")
+ *     search matrx   ->  "3 The Matrix"  "OK 1"          (BookingService::search_movies)
+ *     seats 1 1      ->  "a1 a2 ... a20"   "OK 20"
+ *     book 1 1 a1    ->  "OK 17"                       (the booking id)
+ *     book 1 1 a1 a2 ->  "ERR 5 One or more seats already booked taken=a1 try=a2,a3"
+ *
+ * The number after ERR is the BookingStatus value for booking failures and 0 for
+ * protocol errors. A failed book lists the seats found taken and, when it has one, the
+ * suggested request to retry with (see BookingResult::alternative). A request over its client's rate limit is answered with the
+ * Throttled status without being parsed.
+ *
+ * With a cursor and limit, movies and theaters return one page (BookingService::list_movies_page,
+ * list_theaters_for_movie_page) and, when entries follow it, the cursor of the next page
+ * after the count on the status line.
+ *
+ * Cluster nodes (TextCommandHandler::set_cluster_admin) also accept the show moves of
+ * ClusterRouter (cluster.hpp), by show id:
+ *
+ *     export <show_id>           ->  "<state>" "OK"   (the show's seats are freed here)
+ *     import <show_id> <state>   ->  "OK"
+ *
+ * where a state is a space-separated list of "<booking_id>=<seat>.<seat>..." bookings
+ * and "h<ttl_ms>=<seat>.<seat>..." holds, seats as HallLayout seat indices.
+ */
+
+namespace booking {
+
+/**
+ * @brief What the transport should do after a command.
+ */
+enum class CommandOutcome : std::uint8_t {
+    Continue,  /**< Keep reading requests. */
+    Close,     /**< Flush the responses, then close (after "quit"). */
+};
+
+/** @brief Command named by the first token of a request (see @ref parse_command). */
+enum class TextCommand : std::uint8_t {
+    Unknown,
+    Movies,
+    Search,
+    Theaters,
+    Seats,
+    Book,
+    Cancel,
+    Export,
+    Import,
+    Help,
+    Quit, /**< "quit" or "exit". */
+};
+
+/** @brief Lowercase name of @p command (e.g. "book"; "quit" for Quit). */
+const char* to_string(TextCommand command);
+
+/**
+ * @brief Command named by @p token (case-sensitive), Unknown if none.
+ *
+ * @details
+ * A perfect hash of the first and last characters and the length picks the one command
+ * the token can be, so dispatch costs one table load and one compare whatever the command.
+ */
+TextCommand parse_command(std::string_view token);
+
+/** @brief Splits @p line into space- or tab-separated views into it (replacing @p out). */
+void split_tokens(std::string_view line, std::vector<std::string_view>& out);
+
+/** @brief Parses all of @p token as a decimal integer; false (and @p out unspecified) otherwise. */
+template <typename Int>
+bool parse_token(std::string_view token, Int& out) {
+    const char* end = token.data() + token.size();
+    const auto res = std::from_chars(token.data(), end, out);
+    return res.ec == std::errc() && res.ptr == end;
+}
+
+/** @brief @ref parse_token for ids. */
+template <typename Tag>
+bool parse_token(std::string_view token, Id<Tag>& out) {
+    typename Id<Tag>::Rep value = 0;
+    if (!parse_token(token, value)) return false;
+    out = value;
+    return true;
+}
+
+/**
+ * @brief Executes text protocol commands against a service.
+ *
+ * @details
+ * Parses in place (no iostreams, no per-token strings) and dispatches through
+ * @ref parse_command; seat labels are passed to
+ * BookingService::book_seat_labels as views into the request line. Shows named by movie
+ * and theater are routed through a ShowRoutes cache, so repeated seats and book commands
+ * for a show skip the catalog. One handler per thread (or connection): it keeps a
+ * reusable token buffer and the route cache.
+ */
+class TextCommandHandler {
+public:
+    explicit TextCommandHandler(BookingService& service) : service_(service), routes_(service) {}
+
+    /**
+     * @brief Executes one request line and appends its response to @p out.
+     * @param line Request without its line terminator (a trailing CR is ignored).
+     */
+    CommandOutcome execute(std::string_view line, std::string& out);
+
+    /**
+     * @brief Charges the following requests to @p client's bucket of @p limiter
+     *        (nullptr = unlimited; the limiter must outlive its use).
+     */
+    void set_client(std::uint64_t client, ClientRateLimiter* limiter) {
+        client_ = client;
+        limiter_ = limiter;
+    }
+
+    /** @brief Answers book and cancel with ReadOnlyReplica (a replica server, see replication.hpp). */
+    void set_read_only(bool read_only) { read_only_ = read_only; }
+
+    /** @brief Enables the export and import commands of a cluster node. */
+    void set_cluster_admin(bool admin) { cluster_admin_ = admin; }
+
+    /** @brief Show the last seats, book or cancel command named (invalid before the first). */
+    ShowId last_show() const { return last_show_; }
+
+    /** @brief Cache of the shows this handler has named. */
+    const ShowRoutes& routes() const { return routes_; }
+
+private:
+    void movies(std::string& out);
+    void search(std::string& out);
+    void theaters(std::string& out);
+    void seats(std::string& out);
+    void book(std::string& out);
+    void cancel(std::string& out);
+    void export_show(std::string& out);
+    void import_show(std::string& out);
+
+    /**
+     * @brief Resolves tokens 1 and 2 (movie, theater) to a show through @ref routes_;
+     *        nullptr after appending an error.
+     */
+    BookingService::ShowHandle* show_arg(std::string& out);
+
+    BookingService& service_;
+    ShowRoutes routes_;                     /**< Shows this connection has named so far. */
+    std::vector<std::string_view> tokens_;  /**< Tokens of the current line. */
+    ClientRateLimiter* limiter_ = nullptr;  /**< Rate limit of the current client, if any. */
+    std::uint64_t client_ = 0;
+    ShowId last_show_;                      /**< See @ref last_show. */
+    bool read_only_ = false;
+    bool cluster_admin_ = false;
+};
+
+} // namespace booking
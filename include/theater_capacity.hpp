@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <climits>
+
+/**
+ * @file theater_capacity.hpp
+ * @brief Attendance counter of one theater and day, for licence caps across halls.
+ *
+ * A capped booking reserves its seats on the counter right before the seat CAS and keeps
+ * the reservation if the CAS succeeds (reserve-then-commit); a failed CAS, or a release
+ * of the seats later, gives them back. The counter is one atomic word: bookings of
+ * different halls of the theater contend on it only for one CAS each and never wait on a
+ * theater-wide lock.
+ */
+
+namespace booking {
+
+/**
+ * @brief Seats taken against a cap, shared by the shows of one theater on one day.
+ *
+ * @details
+ * The number taken never exceeds the cap through @ref try_reserve; @ref add counts seats
+ * that are already taken (installed state, a counter attached to a selling show) and may
+ * go past it. Lowering the cap below the seats taken only blocks new reservations.
+ */
+class CapacityCounter {
+public:
+    /** @brief Cap of a counter that admits everything. */
+    static constexpr int kUncapped = INT_MAX;
+
+    explicit CapacityCounter(int cap = kUncapped) : cap_(cap) {}
+    CapacityCounter(const CapacityCounter&) = delete;
+    CapacityCounter& operator=(const CapacityCounter&) = delete;
+
+    /** @brief Takes @p seats if they fit under the cap; false (nothing taken) otherwise. */
+    bool try_reserve(int seats) {
+        const int cap = cap_.load(std::memory_order_relaxed);
+        int taken = taken_.load(std::memory_order_relaxed);
+        while (true) {
+            if (taken > cap - seats) return false; // nothing written: a full theater sheds for one load
+            if (taken_.compare_exchange_weak(taken, taken + seats, std::memory_order_relaxed)) return true;
+        }
+    }
+
+    /** @brief Gives back @p seats taken by @ref try_reserve or @ref add. */
+    void release(int seats) { taken_.fetch_sub(seats, std::memory_order_relaxed); }
+
+    /** @brief Counts @p seats that are taken already, regardless of the cap. */
+    void add(int seats) { taken_.fetch_add(seats, std::memory_order_relaxed); }
+
+    /** @brief Sets the cap (kUncapped lifts it). */
+    void set_cap(int cap) { cap_.store(cap, std::memory_order_relaxed); }
+
+    int cap() const { return cap_.load(std::memory_order_relaxed); }
+    int taken() const { return taken_.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<int> taken_{0}; /**< Seats reserved or booked. */
+    std::atomic<int> cap_;                  /**< Largest number of seats that may be taken. */
+};
+
+} // namespace booking
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "work_stealing_deque.hpp"
+
+/**
+ * @file thread_pool.hpp
+ * @brief Work-stealing thread pool for bulk and fan-out operations.
+ *
+ * Every worker owns a Chase–Lev deque (work_stealing_deque.hpp). A parallel loop is split
+ * in halves recursively: the worker running a range pushes its right half on its own
+ * deque and keeps the left half, so the work stays on one core until an idle worker
+ * steals the oldest (largest) half from the top. Work submitted from outside the pool
+ * goes through a small locked injection queue; the submitting thread then helps run
+ * jobs until its loop is done, so a loop never waits on a busy pool and nested loops on
+ * worker threads cannot deadlock.
+ *
+ * Schedule loading, ShardedBookingService fan-out (schedule loads, batches, snapshots)
+ * and large booking batches run on a pool; ThreadPool::shared() is used unless a
+ * service is given its own with set_thread_pool.
+ */
+
+namespace booking {
+
+/** @brief Construction parameters of a ThreadPool. */
+struct ThreadPoolOptions {
+    unsigned workers = 0;              /**< Worker threads (0 = hardware concurrency). */
+    bool pin_workers = false;          /**< Pin worker i to the i-th CPU the process may run on (round-robin). */
+    std::size_t deque_capacity = 1024; /**< Slots of each worker's deque (power of two); a full deque runs work inline. */
+};
+
+/**
+ * @brief Fixed set of worker threads with per-worker work-stealing deques.
+ *
+ * @details
+ * parallel_for may be called from any thread, including the pool's own workers (nested
+ * loops), and blocks until the whole range is done. The loop body must not throw.
+ */
+class ThreadPool {
+public:
+    /** @brief Starts the workers. */
+    explicit ThreadPool(const ThreadPoolOptions& options = ThreadPoolOptions{});
+
+    /** @brief Stops and joins the workers (no loop may still be running). */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** @brief Process-wide pool (hardware concurrency, unpinned), started on first use. */
+    static ThreadPool& shared();
+
+    /** @brief Number of worker threads. */
+    unsigned worker_count() const { return static_cast<unsigned>(workers_.size()); }
+
+    /** @brief CPU worker @p index is pinned to (-1 if not pinned). */
+    int worker_cpu(unsigned index) const { return workers_[index]->cpu; }
+
+    /** @brief True if the calling thread is one of this pool's workers. */
+    bool on_worker() const;
+
+    /** @brief Jobs taken from another worker's deque so far (a balance statistic). */
+    std::uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Runs @p body(begin, end) over [0, @p count) in chunks of @p grain items.
+     *
+     * @details
+     * Chunks run in parallel on the workers and the calling thread; a single chunk runs
+     * inline. Returns once every chunk has finished.
+     */
+    template <typename F>
+    void parallel_for(std::size_t count, std::size_t grain, F&& body);
+
+private:
+    /** @brief Type-erased unit of work; lives in the parallel_for frame that submitted it. */
+    struct Job {
+        void (*run)(Job*) = nullptr;
+    };
+
+    struct alignas(64) Worker {
+        explicit Worker(std::size_t capacity) : deque(capacity) {}
+
+        WorkStealingDeque<Job> deque;
+        std::thread thread;
+        int cpu = -1;
+    };
+
+    /** @brief Queues @p job: on the calling worker's deque, else in the injection queue. */
+    void submit(Job* job);
+
+    /** @brief Runs other jobs until @p pending drops to zero. */
+    void help_until_done(const std::atomic<std::size_t>& pending);
+
+    /** @brief Next job for the calling thread: own deque, injection queue, then a random victim. */
+    Job* find_job();
+
+    /** @brief True if any deque or the injection queue looks non-empty. */
+    bool has_work() const;
+
+    void worker_loop(unsigned index);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex inject_mutex_;
+    std::deque<Job*> injected_;                 /**< Jobs from threads outside the pool. */
+    std::atomic<std::size_t> injected_count_{0};
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+    std::atomic<unsigned> sleepers_{0};         /**< Workers parked or about to (Dekker with submit). */
+    std::atomic<std::uint64_t> steals_{0};
+    std::atomic<bool> stopping_{false};
+};
+
+template <typename F>
+void ThreadPool::parallel_for(std::size_t count, std::size_t grain, F&& body) {
+    if (count == 0u) return;
+    grain = std::max<std::size_t>(grain, 1u);
+    const std::size_t chunks = (count - 1u) / grain + 1u;
+    if (chunks == 1u) {
+        body(std::size_t{0}, count);
+        return;
+    }
+
+    struct Loop;
+    struct Range final : Job {
+        Loop* loop = nullptr;
+        std::size_t lo = 0; /**< First chunk. */
+        std::size_t hi = 0; /**< One past the last chunk. */
+    };
+    struct Loop {
+        ThreadPool* pool;
+        std::remove_reference_t<F>* body;
+        std::size_t count;
+        std::size_t grain;
+        std::atomic<std::size_t> pending; /**< Chunks not finished yet. */
+        std::vector<Range> ranges;        /**< Range starting at chunk c lives in ranges[c]. */
+    };
+    Loop loop{this, &body, count, grain, {chunks}, std::vector<Range>(chunks)};
+
+    // Every split hands out a right half starting at a fresh chunk, so each slot is used once
+    const auto run_range = [](Job* job) {
+        Range& r = *static_cast<Range*>(job);
+        Loop& l = *r.loop;
+        while (r.hi - r.lo > 1u) {
+            const std::size_t mid = r.lo + (r.hi - r.lo) / 2u;
+            Range& right = l.ranges[mid];
+            right.lo = mid;
+            right.hi = r.hi;
+            r.hi = mid;
+            l.pool->submit(&right);
+        }
+        const std::size_t begin = r.lo * l.grain;
+        (*l.body)(begin, std::min(l.count, begin + l.grain));
+        l.pending.fetch_sub(1u, std::memory_order_acq_rel); // the caller may return (and free l) now
+    };
+    for (Range& r : loop.ranges) {
+        r.run = run_range;
+        r.loop = &loop;
+    }
+    Range& root = loop.ranges[0];
+    root.hi = chunks;
+    run_range(&root); // the caller splits first and keeps the leftmost chunk
+    help_until_done(loop.pending);
+}
+
+} // namespace booking
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @file thread_shards.hpp
+ * @brief One lazily created object per recording thread, enumerable by readers.
+ *
+ * The sketches recorded from the booking path (heavy_hitters.hpp, sales_analytics.hpp)
+ * keep their state in thread-private shards: the owning thread is the shard's only
+ * writer, so it updates with relaxed loads and stores instead of read-modify-writes on
+ * shared lines, and readers merge every shard on demand. A thread finds its shard
+ * through a thread_local cache keyed by the instance's serial; only a thread's first
+ * record takes the lock. Shards live as long as the instance.
+ */
+
+namespace booking {
+
+template <typename Shard>
+class ThreadShards {
+public:
+    ThreadShards() : serial_(next_serial().fetch_add(1, std::memory_order_relaxed)) {}
+
+    ThreadShards(const ThreadShards&) = delete;
+    ThreadShards& operator=(const ThreadShards&) = delete;
+
+    /** @brief Calling thread's shard, created with @p make() (returning unique_ptr<Shard>) on first use. */
+    template <typename Make>
+    Shard& local(Make&& make) {
+        // The serial tells instances apart, so a cache entry of a destroyed instance is never reused
+        struct Cache {
+            std::uint64_t serial = 0;
+            Shard* shard = nullptr;
+        };
+        thread_local Cache cache;
+        if (cache.serial != serial_) cache = Cache{serial_, attach(make)};
+        return *cache.shard;
+    }
+
+    /** @brief Calls @p f(const Shard&) for every shard, holding the shard list lock. */
+    template <typename F>
+    void for_each(F&& f) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : shards_) f(static_cast<const Shard&>(*entry.second));
+    }
+
+private:
+    static std::atomic<std::uint64_t>& next_serial() {
+        static std::atomic<std::uint64_t> serial{1};
+        return serial;
+    }
+
+    /** @brief Slow path of @ref local: finds or creates the thread's shard. */
+    template <typename Make>
+    Shard* attach(Make& make) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const std::thread::id self = std::this_thread::get_id();
+        for (auto& entry : shards_) {
+            if (entry.first == self) return entry.second.get(); // thread alternating between instances
+        }
+        shards_.emplace_back(self, make());
+        return shards_.back().second.get();
+    }
+
+    std::uint64_t serial_;     /**< Unique per Shard type, never reused; keys the thread_local cache. */
+    mutable std::mutex mutex_; /**< Guards @ref shards_ (attach and for_each only). */
+    std::vector<std::pair<std::thread::id, std::unique_ptr<Shard>>> shards_;
+};
+
+} // namespace booking
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @file timer_wheel.hpp
+ * @brief Hierarchical timer wheel for O(1) scheduling and expiry of many timers.
+ *
+ * Timers are identified by a 32-bit id and expire at an absolute tick. The wheel has four
+ * levels (256, 64, 64 and 64 slots); level k covers deadlines up to 2^(8 + 6k) ticks ahead.
+ * Scheduling appends to one bucket, and advancing one tick touches one level-0 bucket plus
+ * an occasional cascade of a higher-level bucket, so expiring N timers costs O(N) regardless
+ * of how many are outstanding. Deadlines further ahead than the top level are clamped to it
+ * and re-cascaded until they are due.
+ *
+ * TimerWheel keeps (id, deadline) entries in per-bucket vectors. IntrusiveTimerWheel links
+ * records that already live in a slab through a 32-bit next index stored in the record, so
+ * a bucket is one index and scheduling never allocates.
+ *
+ * The wheels themselves are not thread-safe; one owner thread schedules and advances them.
+ */
+
+namespace booking {
+
+namespace detail {
+
+/** @brief Level layout and bucket selection shared by both wheels. */
+struct WheelGeometry {
+    static constexpr int kLevels = 4;
+    static constexpr int kLevel0Bits = 8;
+    static constexpr int kLevelBits = 6;
+    static constexpr int kTotalBits = kLevel0Bits + (kLevels - 1) * kLevelBits;
+
+    static int shift(int level) { return level == 0 ? 0 : kLevel0Bits + (level - 1) * kLevelBits; }
+
+    static std::size_t slot_of(int level, std::uint64_t tick) {
+        const int bits = level == 0 ? kLevel0Bits : kLevelBits;
+        return static_cast<std::size_t>((tick >> shift(level)) & ((std::uint64_t{1} << bits) - 1u));
+    }
+
+    /**
+     * @brief Level and bucket of a timer due at @p deadline when @p next is the next tick to
+     *        process; same selection as the classic Linux cascading timer wheel.
+     */
+    static std::pair<int, std::size_t> bucket_of(std::uint64_t next, std::uint64_t deadline) {
+        std::uint64_t at = deadline < next ? next : deadline;
+        if (at - next >= (std::uint64_t{1} << kTotalBits)) {
+            at = next + (std::uint64_t{1} << kTotalBits) - 1u; // clamp; re-placed when reached
+        }
+        const std::uint64_t delta = at - next;
+        int level = 0;
+        while (level < kLevels - 1 && delta >= (std::uint64_t{1} << shift(level + 1))) ++level;
+        return {level, slot_of(level, at)};
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief Four-level hierarchical timer wheel.
+ */
+class TimerWheel {
+public:
+    /** @brief Creates a wheel whose current time is @p start_tick. */
+    explicit TimerWheel(std::uint64_t start_tick = 0) : next_(start_tick + 1u) {}
+
+    /** @brief Last processed tick (every timer with deadline <= now() has fired). */
+    std::uint64_t now() const { return next_ - 1u; }
+
+    /** @brief Number of scheduled timers. */
+    std::size_t size() const { return size_; }
+
+    /**
+     * @brief Schedules timer @p id to fire at tick @p deadline (on the next advance if due).
+     */
+    void schedule(std::uint32_t id, std::uint64_t deadline) {
+        place(Entry{id, deadline});
+        ++size_;
+    }
+
+    /**
+     * @brief Advances time to @p now, calling @p on_expire(id) for every due timer.
+     *
+     * @return Number of timers fired.
+     */
+    template <typename OnExpire>
+    std::size_t advance(std::uint64_t now, OnExpire&& on_expire) {
+        std::size_t fired = 0;
+        while (next_ <= now) {
+            if (size_ == 0) { // nothing scheduled: jump straight to the target time
+                next_ = now + 1u;
+                break;
+            }
+
+            // Reaching a level boundary moves the next coarse bucket one level down
+            const std::size_t index = slot_of(0, next_);
+            for (int level = 1; level < kLevels; ++level) {
+                if (slot_of(level - 1, next_) != 0u) break;
+                cascade(level, slot_of(level, next_));
+            }
+
+            std::vector<Entry>& due = levels_[0][index];
+            pending_.swap(due);
+            const std::uint64_t tick = next_++;
+            for (const Entry& e : pending_) {
+                if (e.deadline <= tick) {
+                    on_expire(e.id);
+                    ++fired;
+                    --size_;
+                } else {
+                    place(e); // clamped long deadline: schedule the remainder
+                }
+            }
+            pending_.clear();
+            if (due.empty()) due.swap(pending_); // keep the bucket capacity for reuse
+        }
+        return fired;
+    }
+
+private:
+    static constexpr int kLevels = detail::WheelGeometry::kLevels;
+
+    struct Entry {
+        std::uint32_t id;
+        std::uint64_t deadline;
+    };
+
+    static std::size_t slot_of(int level, std::uint64_t tick) { return detail::WheelGeometry::slot_of(level, tick); }
+
+    void place(const Entry& e) {
+        const auto [level, slot] = detail::WheelGeometry::bucket_of(next_, e.deadline);
+        levels_[static_cast<std::size_t>(level)][slot].push_back(e);
+    }
+
+    void cascade(int level, std::size_t slot) {
+        std::vector<Entry>& bucket = levels_[static_cast<std::size_t>(level)][slot];
+        if (bucket.empty()) return;
+        std::vector<Entry> moving;
+        moving.swap(bucket);
+        for (const Entry& e : moving) place(e);
+    }
+
+    std::uint64_t next_;                                           /**< Next tick to process. */
+    std::size_t size_ = 0;                                         /**< Scheduled timers. */
+    std::vector<Entry> pending_;                                   /**< Scratch list of the bucket being fired. */
+    std::array<std::array<std::vector<Entry>, 256>, kLevels> levels_; /**< Buckets (levels > 0 use 64). */
+};
+
+/**
+ * @brief Timer wheel over records of a slab, linked intrusively by 32-bit index.
+ *
+ * @p Links maps a record id to its link and deadline:
+ * @code
+ * struct Links {
+ *     std::uint32_t& next(std::uint32_t id);     // link word owned by the wheel while scheduled
+ *     std::uint64_t deadline(std::uint32_t id);  // fixed while the record is scheduled
+ * };
+ * @endcode
+ * A record may be scheduled once at a time. Timers of one bucket fire in no particular
+ * order; @p on_expire may reuse the record (its link has been read already).
+ */
+template <typename Links>
+class IntrusiveTimerWheel {
+public:
+    static constexpr std::uint32_t kNone = 0xFFFFFFFFu; /**< End of a bucket list. */
+
+    /** @brief Creates a wheel over @p links whose current time is @p start_tick. */
+    explicit IntrusiveTimerWheel(Links links = Links{}, std::uint64_t start_tick = 0)
+        : links_(links), next_(start_tick + 1u) {
+        for (auto& level : levels_) level.fill(kNone);
+    }
+
+    /** @brief Last processed tick (every timer with deadline <= now() has fired). */
+    std::uint64_t now() const { return next_ - 1u; }
+
+    /** @brief Number of scheduled timers. */
+    std::size_t size() const { return size_; }
+
+    /** @brief Schedules record @p id to fire at its deadline (on the next advance if due). */
+    void schedule(std::uint32_t id) {
+        place(id);
+        ++size_;
+    }
+
+    /**
+     * @brief Advances time to @p now, calling @p on_expire(id) for every due timer.
+     *
+     * @return Number of timers fired.
+     */
+    template <typename OnExpire>
+    std::size_t advance(std::uint64_t now, OnExpire&& on_expire) {
+        std::size_t fired = 0;
+        while (next_ <= now) {
+            if (size_ == 0) {
+                next_ = now + 1u;
+                break;
+            }
+
+            const std::size_t index = slot_of(0, next_);
+            for (int level = 1; level < kLevels; ++level) {
+                if (slot_of(level - 1, next_) != 0u) break;
+                cascade(level, slot_of(level, next_));
+            }
+
+            std::uint32_t id = levels_[0][index];
+            levels_[0][index] = kNone;
+            const std::uint64_t tick = next_++;
+            while (id != kNone) {
+                const std::uint32_t next = links_.next(id);
+                if (links_.deadline(id) <= tick) {
+                    --size_;
+                    ++fired;
+                    on_expire(id);
+                } else {
+                    place(id); // clamped long deadline: schedule the remainder
+                }
+                id = next;
+            }
+        }
+        return fired;
+    }
+
+private:
+    static constexpr int kLevels = detail::WheelGeometry::kLevels;
+
+    static std::size_t slot_of(int level, std::uint64_t tick) { return detail::WheelGeometry::slot_of(level, tick); }
+
+    void place(std::uint32_t id) {
+        const auto [level, slot] = detail::WheelGeometry::bucket_of(next_, links_.deadline(id));
+        std::uint32_t& head = levels_[static_cast<std::size_t>(level)][slot];
+        links_.next(id) = head;
+        head = id;
+    }
+
+    void cascade(int level, std::size_t slot) {
+        std::uint32_t& head = levels_[static_cast<std::size_t>(level)][slot];
+        std::uint32_t id = head;
+        head = kNone;
+        while (id != kNone) {
+            const std::uint32_t next = links_.next(id);
+            place(id);
+            id = next;
+        }
+    }
+
+    Links links_;                                                 /**< Record links and deadlines. */
+    std::uint64_t next_;                                          /**< Next tick to process. */
+    std::size_t size_ = 0;                                        /**< Scheduled timers. */
+    std::array<std::array<std::uint32_t, 256>, kLevels> levels_{}; /**< Bucket heads (levels > 0 use 64). */
+};
+
+} // namespace booking
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "span.hpp"
+
+/**
+ * @file title_index.hpp
+ * @brief Prefix and typo-tolerant search over movie titles (BookingService::search_movies).
+ *
+ * Titles are normalised (ASCII lowercase; runs of other punctuation and spaces become one
+ * space; bytes >= 0x80 are kept, so UTF-8 passes through unchanged) and indexed twice:
+ * - every word start of every title, as (slot, offset) pairs sorted by the text from the
+ *   offset on, so the titles with a word starting with the query form one contiguous
+ *   range found by binary search (the sorted array is the flattened form of a trie);
+ * - trigram postings of the word-padded title (" the godfather" -> " th", "the", "he ",
+ *   ...), sorted slot lists per trigram. A query within k edits (insertions, deletions,
+ *   substitutions, swaps of neighbours) of a word prefix shares at least
+ *   grams(query) - 4k of its distinct trigrams, which bounds the candidates that are
+ *   verified with a bounded edit distance.
+ *
+ * Slots are the caller's (BookingService uses the movie's catalog slot); titles are only
+ * ever appended.
+ */
+
+namespace booking {
+
+class TitleIndex {
+public:
+    /** @brief How a title matched a query, best first. */
+    enum class MatchKind : std::uint8_t {
+        Exact,       /**< The whole title equals the query. */
+        TitlePrefix, /**< The title starts with the query. */
+        WordPrefix,  /**< A later word of the title starts with the query. */
+        Fuzzy,       /**< A word prefix is within the typo budget of the query. */
+    };
+
+    /** @brief One search result. */
+    struct Match {
+        std::int32_t slot = -1;
+        MatchKind kind = MatchKind::Exact;
+        std::uint32_t distance = 0; /**< Edits (0 unless @ref kind is Fuzzy). */
+    };
+
+    /** @brief Typos tolerated for a normalised query of @p length bytes (0 below 5, 1 below 10, else 2). */
+    static std::uint32_t typo_budget(std::size_t length);
+
+    /** @brief The normalised form titles and queries are compared in. */
+    static std::string normalize(std::string_view text);
+
+    /** @brief Number of titles indexed (the next slot). */
+    std::size_t size() const { return titles_.size(); }
+
+    /** @brief Indexes @p title at slot @ref size(). */
+    void add(std::string_view title);
+
+    /** @brief Indexes @p titles at slots @ref size(), size() + 1, ...; one merge for the batch. */
+    void add(Span<const std::string_view> titles);
+
+    /**
+     * @brief Best @p limit matches of @p query: by kind, then edits, then shorter title, then slot.
+     *
+     * @details
+     * Fuzzy candidates are only looked for when the prefix matches do not fill @p limit.
+     * An empty (after normalisation) query matches nothing.
+     */
+    std::vector<Match> search(std::string_view query, std::size_t limit) const;
+
+private:
+    /** @brief A word start: text of title @ref slot from byte @ref offset on. */
+    struct WordStart {
+        std::int32_t slot;
+        std::uint32_t offset;
+    };
+
+    std::string_view suffix(const WordStart& w) const {
+        return std::string_view(titles_[static_cast<std::size_t>(w.slot)]).substr(w.offset);
+    }
+
+    /** @brief Smallest edits turning @p query into a prefix of a word of title @p slot, or > @p budget. */
+    std::uint32_t word_prefix_distance(std::string_view query, std::int32_t slot, std::uint32_t budget) const;
+
+    std::vector<std::string> titles_; /**< Normalised titles by slot. */
+    std::vector<WordStart> words_;    /**< Sorted by suffix text, then slot. */
+    std::unordered_map<std::uint32_t, std::vector<std::int32_t>> trigrams_; /**< Packed trigram -> ascending slots. */
+};
+
+/** @brief Converts a TitleIndex::MatchKind to lowercase text. */
+const char* to_string(TitleIndex::MatchKind kind);
+
+} // namespace booking
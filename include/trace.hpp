@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/**
+ * @file trace.hpp
+ * @brief Hot-path tracing: timestamped stage events in per-thread ring buffers.
+ *
+ * A p99 spike of book_seats says nothing about where the time went. Trace points around
+ * each stage (show lookup, label parsing, the seat CAS, CAS retries, the journal wait; for
+ * list_available_seats the seat-word load and the rendering) write one fixed-size event
+ * each into a ring owned by the calling thread: no locks, no allocation after the first
+ * event of a thread, the oldest events overwritten once a ring is full. Timestamps are
+ * TSC ticks (steady-clock nanoseconds where there is no TSC).
+ *
+ * Tracing is off until trace_start(); a trace point then costs one relaxed load. Trace
+ * points compile to nothing without BOOKING_TRACING (CMake option of the same name).
+ * trace_collect() gathers the events of all threads and write_chrome_trace() renders them
+ * as Chrome trace JSON, which chrome://tracing and Perfetto (ui.perfetto.dev) open.
+ */
+
+#ifndef BOOKING_TRACING
+#define BOOKING_TRACING 0
+#endif
+
+namespace booking {
+
+/** @brief Traced stage of a request. */
+enum class TraceStage : std::uint8_t {
+    BookSeats, /**< A label booking (book_seats, book_seat_labels) end to end; arg = show id. */
+    ListSeats, /**< list_available_seats end to end; arg = show id. */
+    Lookup,    /**< Show lookup and admission. */
+    Parse,     /**< Seat labels to a mask; arg = label count. */
+    Acquire,   /**< The seat-word CASes of a booking (and their rollback). */
+    CasRetry,  /**< Instant: CASes of one request retried; arg = retries. */
+    Journal,   /**< Journal append and, in Sync mode, the durability wait. */
+    LoadSeats, /**< Consistent load of the seat words. */
+    Render,    /**< Free seats to labels. */
+};
+
+/** @brief Static name of a stage (e.g. "book_seats"). */
+const char* to_string(TraceStage stage);
+
+/** @brief One traced stage: [begin, end] in trace_clock() ticks (begin == end: instant). */
+struct TraceEvent {
+    std::uint64_t begin = 0;
+    std::uint64_t end = 0;
+    std::uint64_t arg = 0;
+    std::uint32_t thread = 0; /**< Small index of the recording thread. */
+    TraceStage stage = TraceStage::BookSeats;
+};
+
+/** @brief Events each thread's ring keeps before overwriting its oldest (32 bytes each). */
+inline constexpr std::size_t kTraceRingEvents = std::size_t{1} << 14;
+
+/** @brief Timestamp of a trace event: TSC ticks on x86, else steady-clock nanoseconds. */
+inline std::uint64_t trace_clock() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/** @brief trace_clock() ticks per microsecond (measured once against the steady clock). */
+double trace_ticks_per_us();
+
+namespace detail {
+
+extern std::atomic<bool> trace_on;
+
+/** @brief Appends an event to the calling thread's ring. */
+void trace_write(TraceStage stage, std::uint64_t begin, std::uint64_t end, std::uint64_t arg);
+
+} // namespace detail
+
+/** @brief Starts recording trace events (all threads). */
+void trace_start();
+
+/** @brief Stops recording; the rings keep their events for trace_collect(). */
+void trace_stop();
+
+/** @brief True between trace_start() and trace_stop(). */
+inline bool trace_running() {
+    return BOOKING_TRACING && detail::trace_on.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Takes the events recorded since the last collection, of all threads, ordered by
+ *        begin.
+ *
+ * @details
+ * Best called after trace_stop(). While threads keep tracing, events they overwrite
+ * during the copy are dropped rather than returned torn.
+ */
+std::vector<TraceEvent> trace_collect();
+
+/**
+ * @brief Writes @p events as Chrome trace JSON (complete "X" and instant "i" events, one
+ *        track per thread, microseconds from the first event).
+ */
+void write_chrome_trace(std::ostream& out, const std::vector<TraceEvent>& events);
+
+/**
+ * @brief Traces the enclosing scope as one stage.
+ *
+ * @details
+ * @code
+ * TraceScope trace(TraceStage::Parse, labels.size());
+ * @endcode
+ */
+class TraceScope {
+public:
+    explicit TraceScope(TraceStage stage, std::uint64_t arg = 0) {
+#if BOOKING_TRACING
+        if (trace_running()) {
+            stage_ = stage;
+            arg_ = arg;
+            begin_ = trace_clock();
+        }
+#else
+        (void)stage;
+        (void)arg;
+#endif
+    }
+
+    ~TraceScope() {
+#if BOOKING_TRACING
+        if (begin_ != 0u) detail::trace_write(stage_, begin_, trace_clock(), arg_);
+#endif
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+#if BOOKING_TRACING
+private:
+    std::uint64_t begin_ = 0; // 0 = not traced
+    std::uint64_t arg_ = 0;
+    TraceStage stage_ = TraceStage::BookSeats;
+#endif
+};
+
+/** @brief Records an instant event of @p stage. */
+inline void trace_instant(TraceStage stage, std::uint64_t arg) {
+#if BOOKING_TRACING
+    if (trace_running()) {
+        const std::uint64_t now = trace_clock();
+        detail::trace_write(stage, now, now, arg);
+    }
+#else
+    (void)stage;
+    (void)arg;
+#endif
+}
+
+} // namespace booking
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "booking_service.hpp"
+
+/**
+ * @file traffic_replay.hpp
+ * @brief Deterministic parallel replay of JSONL traffic captures.
+ *
+ * A capture holds one JSON object per line; keys may come in any order and unknown keys
+ * are ignored:
+ *
+ *     {"op":"book","show":12,"seats":["a1","a2"],"id":7}
+ *     {"op":"best","show":12,"n":3,"id":8}
+ *     {"op":"cancel","show":12,"booking":7}                  (all seats of booking 7)
+ *     {"op":"cancel","show":12,"booking":7,"seats":["a2"]}
+ *     {"op":"seats","show":12}
+ *     {"op":"count","show":12}
+ *
+ * "id" is the booking id the capture recorded for a booking; cancellations name it in
+ * "booking" and are mapped to the id the replay assigned, so a capture replays against a
+ * fresh service whatever ids it hands out.
+ */
+
+namespace booking {
+
+/** @brief Operation of a capture record. */
+enum class ReplayOpKind : std::uint8_t {
+    Book,            /**< "book": book_seat_labels. */
+    BookBest,        /**< "best": book_best_available. */
+    Cancel,          /**< "cancel": cancel_seats / cancel_seat_mask. */
+    ListSeats,       /**< "seats": list_available_seats. */
+    AvailableCount,  /**< "count": available_count. */
+};
+
+/** @brief Capture record decoded in place (seat labels point into the line). */
+struct ReplayOp {
+    ReplayOpKind kind = ReplayOpKind::AvailableCount;
+    ShowId show_id = -1;
+    int count = 0;                        /**< "n" of a best-available booking. */
+    std::uint64_t id = 0;                 /**< Captured booking id of a booking (0 = none). */
+    std::uint64_t booking = 0;            /**< Captured booking id a cancellation refers to. */
+    std::vector<std::string_view> seats;  /**< "seats" labels (reused between calls). */
+};
+
+/**
+ * @brief Decodes one capture line.
+ * @return False if the line is not a flat JSON object with a known "op" and a "show".
+ */
+bool parse_replay_op(std::string_view line, ReplayOp& out);
+
+/**
+ * @brief Extracts only the "show" field of a capture line (used to route lines).
+ * @return False if the line has no integer "show" field.
+ */
+bool scan_replay_show(std::string_view line, ShowId& out);
+
+/** @brief Replay settings. */
+struct ReplayOptions {
+    unsigned workers = 0;             /**< Worker threads (0 = one per core). */
+    std::size_t queue_capacity = 4096; /**< Lines in flight per worker (power of two). */
+};
+
+/** @brief Outcome of a replay. */
+struct ReplayStats {
+    std::uint64_t lines = 0;      /**< Non-blank lines read. */
+    std::uint64_t ops = 0;        /**< Operations executed. */
+    std::uint64_t failed = 0;     /**< Bookings and cancellations the service rejected. */
+    std::uint64_t malformed = 0;  /**< Lines that could not be decoded. */
+    std::uint64_t unmapped = 0;   /**< Cancellations of a booking id the replay never assigned. */
+    double seconds = 0.0;         /**< Wall time of the replay. */
+    std::uint64_t checksum = 0;   /**< seat_state_checksum of every show the capture touched. */
+};
+
+/**
+ * @brief Replays a capture against @p service.
+ *
+ * @details
+ * The calling thread splits @p capture into lines and routes each one by show id to a
+ * worker (show % workers) over an SPSC ring, so the operations of one show run in capture
+ * order on one thread while different shows run in parallel. The final state, and hence
+ * the checksum, does not depend on the worker count.
+ */
+ReplayStats replay_traffic(BookingService& service, std::string_view capture, ReplayOptions options = {});
+
+/**
+ * @brief Order-independent checksum of the free-seat bitmaps of @p shows.
+ *
+ * @details
+ * Booking ids are not included: they depend on thread interleaving, seat occupancy does not.
+ */
+std::uint64_t seat_state_checksum(const BookingService& service, Span<const ShowId> shows);
+
+} // namespace booking
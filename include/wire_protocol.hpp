@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "booking_service.hpp"
+#include "rate_limiter.hpp"
+
+/**
+ * @file wire_protocol.hpp
+ * @brief Fixed-layout binary request/response frames, decoded in place.
+ *
+ * All fields are little-endian. A request is a 32-byte header followed by a payload whose
+ * size follows from the op and count, so a frame is recognised without scanning:
+ *
+ *     u8 magic (0xB1) | u8 op | u16 count | u32 flags | i64 show id | u64 request id | u64 arg
+ *
+ *     BookMask        count = mask words; payload: u64 first word, u64 words[count];
+ *                     flag kWireIdempotent: the request id is an idempotency key (a retry
+ *                     gets the original outcome, see BookingService::book_seat_mask_once)
+ *     CancelMask      as BookMask; arg = booking id
+ *     BookIndices     count = seats; payload: u16 seat indices[count], padded to 8 bytes
+ *     BookBest        count = adjacent seats wanted; no payload
+ *     AvailableCount  no payload
+ *     AvailableSeats  count = SeatEncoding (availability_codec.hpp); no payload
+ *     Batch           count = requests, arg = payload bytes; payload: that many complete
+ *                     request frames of the other ops (at most kMaxWireBatch requests and
+ *                     kMaxWireBatchBytes bytes)
+ *
+ * Every request gets one 24-byte response, in request order:
+ *
+ *     u8 magic (0xB1) | u8 op | u8 status | u8 reserved | i32 value | u64 request id | u64 id
+ *
+ * status is the BookingStatus; id is the booking id of a successful booking; value is the
+ * first seat index of a BookBest run and the count of AvailableCount (-1 = unknown show).
+ * An AvailableSeats response is followed by value bytes of encoded free seats (none unless
+ * status is Ok) and carries the number of free seats in id; the payload is encoded straight
+ * into the output buffer behind its header.
+ * A request over its client's rate limit gets status Throttled without being executed.
+ *
+ * A Batch is answered by a Batch response (value = number of requests) followed by the
+ * responses of its requests in their order. It runs as one unit: first its writes other
+ * than plain BookMask requests one by one, then all plain BookMask requests through a
+ * single BookingService::book_seats_batch call (one lookup and one word load per show),
+ * then its AvailableCount requests through one available_counts call, and AvailableSeats
+ * as the responses are written; so a batch's reads see its bookings. Clients that book for
+ * several shows, or book and re-read availability, pay for one frame, one decode pass and
+ * one response write. A batch with a malformed or nested Batch request is malformed.
+ *
+ * The server picks the protocol per connection from the first byte (text requests never
+ * start with 0xB1).
+ */
+
+namespace booking {
+
+/** @brief First byte of every frame. */
+constexpr std::uint8_t kWireMagic = 0xB1;
+
+/** @brief Size of a request header. */
+constexpr std::size_t kWireHeaderSize = 32;
+
+/** @brief Request flag: the request id identifies the logical request across retries. */
+constexpr std::uint32_t kWireIdempotent = 1u;
+
+/** @brief Size of a response. */
+constexpr std::size_t kWireResponseSize = 24;
+
+/** @brief Most requests in one Batch frame. */
+constexpr std::uint16_t kMaxWireBatch = 256;
+
+/** @brief Most payload bytes of one Batch frame. */
+constexpr std::size_t kMaxWireBatchBytes = 64 * 1024;
+
+/** @brief Request operations. */
+enum class WireOp : std::uint8_t {
+    BookMask = 1,
+    CancelMask = 2,
+    BookIndices = 3,
+    BookBest = 4,
+    AvailableCount = 5,
+    AvailableSeats = 6,
+    Batch = 7,
+};
+
+/** @brief Outcome of decoding one request frame. */
+enum class WireDecode : std::uint8_t {
+    Ok,          /**< A complete, well-formed frame. */
+    Incomplete,  /**< More bytes are needed. */
+    Malformed,   /**< Bad magic, op or count: the stream cannot be resynchronised. */
+};
+
+/**
+ * @brief Request decoded in place: header fields plus a pointer to the payload.
+ *
+ * @details
+ * The payload pointer refers to the receive buffer (it may be unaligned; words are read
+ * with memcpy, which compiles to plain loads).
+ */
+struct WireRequestView {
+    WireOp op = WireOp::AvailableCount;
+    std::uint16_t count = 0;
+    std::uint32_t flags = 0;
+    ShowId show_id;
+    std::uint64_t request_id = 0;
+    std::uint64_t arg = 0;
+    const unsigned char* payload = nullptr;
+    std::size_t frame_size = 0;   /**< Header + payload bytes. */
+};
+
+/** @brief Decoded response. */
+struct WireResponse {
+    WireOp op = WireOp::AvailableCount;
+    BookingStatus status = BookingStatus::Ok;
+    std::int32_t value = 0;
+    std::uint64_t request_id = 0;
+    std::uint64_t id = 0;
+};
+
+/** @brief Decodes the frame at the start of @p data (@p size bytes available). */
+WireDecode decode_request(const void* data, std::size_t size, WireRequestView& out);
+
+/**
+ * @brief Fills @p out with the seats of a BookMask/CancelMask payload.
+ * @return False if the words run past the 64-row mask.
+ */
+bool decode_mask(const WireRequestView& req, SeatMask& out);
+
+/** @brief Appends a mask request (BookMask or CancelMask) to @p out. */
+void encode_mask_request(std::string& out, WireOp op, ShowId show_id, std::uint64_t request_id, const SeatMask& seats,
+                         std::uint64_t arg = 0, std::uint32_t flags = 0);
+
+/** @brief Appends a request without payload (BookBest, AvailableCount) to @p out. */
+void encode_request(std::string& out, WireOp op, ShowId show_id, std::uint64_t request_id, std::uint16_t count = 0);
+
+/** @brief Appends a BookIndices request to @p out. */
+void encode_indices_request(std::string& out, ShowId show_id, std::uint64_t request_id, Span<const int> seats);
+
+/** @brief Appends a Batch request carrying @p count encoded request @p frames to @p out. */
+void encode_batch_request(std::string& out, std::uint64_t request_id, std::string_view frames, std::uint16_t count);
+
+/** @brief Appends a response to @p out. */
+void encode_response(std::string& out, const WireResponse& r);
+
+/** @brief Decodes a response from the start of @p data; false if fewer than 24 bytes or bad magic. */
+bool decode_response(const void* data, std::size_t size, WireResponse& out);
+
+/**
+ * @brief Executes binary requests against a service.
+ */
+class WireCommandHandler {
+public:
+    explicit WireCommandHandler(BookingService& service) : service_(service) {}
+
+    /**
+     * @brief Executes the complete frames in @p data and appends the responses to @p out.
+     *
+     * @details
+     * Stops early once @p out holds @p out_limit bytes, so a server can pause a client that
+     * does not read its responses.
+     * @return Bytes consumed, or -1 on a malformed frame (the connection should close).
+     */
+    std::ptrdiff_t execute(const void* data, std::size_t size, std::string& out,
+                           std::size_t out_limit = static_cast<std::size_t>(-1));
+
+    /** @brief Charges the following requests to @p client's bucket of @p limiter (nullptr = unlimited). */
+    void set_client(std::uint64_t client, ClientRateLimiter* limiter) {
+        client_ = client;
+        limiter_ = limiter;
+    }
+
+    /** @brief Answers every booking and cancellation op with ReadOnlyReplica. */
+    void set_read_only(bool read_only) { read_only_ = read_only; }
+
+private:
+    WireResponse run(const WireRequestView& req);
+
+    /** @brief Appends the response and payload of an AvailableSeats request. */
+    void available_seats(const WireRequestView& req, std::string& out);
+
+    /** @brief Executes a Batch request and appends its responses; false if it is malformed. */
+    bool batch(const WireRequestView& req, std::string& out);
+
+    BookingService& service_;
+    // Per-batch scratch, reused across batches
+    std::vector<WireRequestView> batch_requests_;
+    std::vector<WireResponse> batch_responses_;
+    std::vector<SeatMask> batch_masks_;
+    std::vector<BookingRequest> batch_bookings_;
+    std::vector<std::size_t> batch_positions_;   /**< Request index of each batch_bookings_ / batch_shows_ entry. */
+    std::vector<BookingResult> batch_results_;
+    std::vector<ShowId> batch_shows_;
+    std::vector<int> batch_counts_;
+    ClientRateLimiter* limiter_ = nullptr;
+    std::uint64_t client_ = 0;
+    bool read_only_ = false;
+};
+
+} // namespace booking
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+/**
+ * @file work_stealing_deque.hpp
+ * @brief Bounded Chase–Lev work-stealing deque.
+ *
+ * The owner pushes and pops at the bottom like a stack (newest first, warm in its cache);
+ * thieves take from the top (oldest first, usually the largest piece of split work) with
+ * one CAS. Owner and thieves only contend on the last element. Memory orders follow Lê,
+ * Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory
+ * Models" (PPoPP 2013), with release/acquire on bottom instead of the standalone fence so
+ * the hand-over of an element is visible to sanitizers.
+ */
+
+namespace booking {
+
+/**
+ * @brief Fixed-capacity work-stealing deque of pointers.
+ *
+ * @tparam T Pointee type; the deque stores T* and never owns them.
+ *
+ * @details
+ * Exactly one thread (the owner) may call @ref push and @ref pop; any thread may call
+ * @ref steal. The ring does not grow: a full deque rejects the push and the owner runs
+ * the work itself.
+ */
+template <typename T>
+class WorkStealingDeque {
+public:
+    /**
+     * @brief Creates a deque of @p capacity slots.
+     * @throws std::invalid_argument unless @p capacity is a power of two >= 2.
+     */
+    explicit WorkStealingDeque(std::size_t capacity)
+        : slots_(new std::atomic<T*>[capacity]()), mask_(static_cast<std::int64_t>(capacity) - 1) {
+        if (capacity < 2u || (capacity & (capacity - 1u)) != 0u) {
+            throw std::invalid_argument("WorkStealingDeque capacity must be a power of two >= 2");
+        }
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /** @brief Number of slots. */
+    std::size_t capacity() const { return static_cast<std::size_t>(mask_ + 1); }
+
+    /** @brief Pushes @p item at the bottom; false if the deque is full. Owner only. */
+    bool push(T* item) {
+        const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        const std::int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t > mask_) return false;
+        slots_[b & mask_].store(item, std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_release); // publishes the slot (and *item) to thieves
+        return true;
+    }
+
+    /** @brief Pops the newest item; null if empty (or a thief took the last one). Owner only. */
+    T* pop() {
+        const std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_release); // every bottom store releases: thieves may read any of them
+        std::atomic_thread_fence(std::memory_order_seq_cst); // bottom before top (Dekker with steal)
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_release); // was empty
+            return nullptr;
+        }
+        T* item = slots_[b & mask_].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Last item: race the thieves for it
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_release);
+        }
+        return item;
+    }
+
+    /** @brief Takes the oldest item; null if empty or another thief / the owner won it. Any thread. */
+    T* steal() {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+        T* item = slots_[t & mask_].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    /** @brief True if the deque looked empty (a hint: it may change at once). */
+    bool empty() const {
+        return top_.load(std::memory_order_acquire) >= bottom_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::unique_ptr<std::atomic<T*>[]> slots_;
+    std::int64_t mask_;
+    alignas(64) std::atomic<std::int64_t> top_{0};    /**< Next item to steal. */
+    alignas(64) std::atomic<std::int64_t> bottom_{0}; /**< Next free slot (owner side). */
+};
+
+} // namespace booking
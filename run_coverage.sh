@@ -21,6 +21,7 @@ book 22 1 a1
 seats 1 1
 seaats
 EOF
+  printf 'movies\nbook 1 1 a5 a6\ncancel 1 1 1 a5\nbogus\nquit\n' | "$CLI" --batch
 else
   echo "CLI not found at $CLI (skipping CLI coverage run)"
 fi
@@ -0,0 +1,327 @@
+#include "arrow_writer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace booking {
+
+namespace {
+
+constexpr char kArrowMagic[8] = {'A', 'R', 'R', 'O', 'W', '1', '\0', '\0'};
+constexpr std::uint32_t kContinuation = 0xFFFFFFFFu;
+constexpr std::uint64_t kMetadataV5 = 4;
+
+// Union tags of Message.fbs MessageHeader and Schema.fbs Type
+constexpr std::uint64_t kHeaderSchema = 1;
+constexpr std::uint64_t kHeaderRecordBatch = 3;
+constexpr std::uint64_t kTypeInt = 2;
+constexpr std::uint64_t kTypeUtf8 = 5;
+constexpr std::uint64_t kTypeTimestamp = 10;
+
+std::size_t round_up(std::size_t n, std::size_t align) {
+    return (n + align - 1u) / align * align;
+}
+
+/**
+ * @brief Front-to-back flatbuffer builder.
+ *
+ * @details
+ * Flatbuffers are usually built back to front; here an object is written before the
+ * objects it references, which is equally valid since a reference (uoffset) only has to
+ * point forward and a table finds its vtable through a signed offset. A reference field
+ * is left 0 by @ref add and filled in by @ref point once its target is written.
+ */
+class FlatBuilder {
+public:
+    /** @brief Fields of one table, by slot (the field's index in the schema). */
+    struct Table {
+        struct Field {
+            int slot;
+            std::size_t size;
+            std::uint64_t value;
+            bool ref;
+        };
+        std::vector<Field> fields;
+
+        Table& scalar(int slot, std::size_t size, std::uint64_t value) {
+            fields.push_back(Field{slot, size, value, false});
+            return *this;
+        }
+        Table& ref(int slot) {
+            fields.push_back(Field{slot, 4u, 0u, true});
+            return *this;
+        }
+    };
+
+    FlatBuilder() : bytes_(4u, '\0') {} // the root reference
+
+    /**
+     * @brief Writes a vtable and the table @p t after it.
+     * @param refs Receives the positions of the reference fields, in declaration order.
+     * @return Position of the table.
+     */
+    std::size_t add(const Table& t, std::size_t* refs = nullptr) {
+        int slots = 0;
+        std::size_t align = 4;
+        for (const auto& f : t.fields) {
+            slots = std::max(slots, f.slot + 1);
+            align = std::max(align, f.size);
+        }
+        std::vector<std::uint16_t> field_offsets(static_cast<std::size_t>(slots), 0u);
+        std::vector<std::size_t> at;
+        std::size_t size = 4; // the vtable offset
+        for (const auto& f : t.fields) {
+            size = round_up(size, f.size);
+            at.push_back(size);
+            field_offsets[static_cast<std::size_t>(f.slot)] = static_cast<std::uint16_t>(size);
+            size += f.size;
+        }
+
+        pad(2);
+        const std::size_t vtable = bytes_.size();
+        put(static_cast<std::uint16_t>(4 + 2 * slots));
+        put(static_cast<std::uint16_t>(size));
+        for (std::uint16_t o : field_offsets) put(o);
+        pad(align);
+        const std::size_t table = bytes_.size();
+        bytes_.resize(table + size, '\0');
+        store(table, static_cast<std::int32_t>(table - vtable));
+        std::size_t ref = 0;
+        for (std::size_t i = 0; i < t.fields.size(); ++i) {
+            const auto& f = t.fields[i];
+            if (f.ref) {
+                if (refs) refs[ref++] = table + at[i];
+            } else {
+                std::memcpy(&bytes_[table + at[i]], &f.value, f.size); // little-endian host
+            }
+        }
+        return table;
+    }
+
+    /** @brief Writes a string; returns its position. */
+    std::size_t string(std::string_view s) {
+        pad(4);
+        const std::size_t pos = bytes_.size();
+        put(static_cast<std::uint32_t>(s.size()));
+        bytes_.append(s.data(), s.size());
+        bytes_.push_back('\0');
+        return pos;
+    }
+
+    /** @brief Writes a vector of @p count references; element i is at position + 4 + 4 i. */
+    std::size_t refs(std::size_t count) {
+        pad(4);
+        const std::size_t pos = bytes_.size();
+        put(static_cast<std::uint32_t>(count));
+        bytes_.resize(bytes_.size() + 4u * count, '\0');
+        return pos;
+    }
+
+    /** @brief Writes a vector of @p count 8-byte aligned structs of @p size bytes each; returns its position. */
+    std::size_t structs(const void* data, std::size_t count, std::size_t size) {
+        pad(8);
+        bytes_.resize(bytes_.size() + 4u, '\0'); // the length goes just before an 8-byte boundary
+        const std::size_t pos = bytes_.size() - 4u;
+        store(pos, static_cast<std::uint32_t>(count));
+        bytes_.append(static_cast<const char*>(data), count * size);
+        return pos;
+    }
+
+    /** @brief Points the reference field at @p ref to @p target. */
+    void point(std::size_t ref, std::size_t target) { store(ref, static_cast<std::uint32_t>(target - ref)); }
+
+    /** @brief Makes @p table the root table. */
+    void root(std::size_t table) { point(0, table); }
+
+    /** @brief The buffer, padded to 8 bytes. */
+    std::string& finish() {
+        pad(8);
+        return bytes_;
+    }
+
+private:
+    template <typename T>
+    void put(T v) {
+        bytes_.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    template <typename T>
+    void store(std::size_t pos, T v) {
+        std::memcpy(&bytes_[pos], &v, sizeof(v));
+    }
+
+    void pad(std::size_t align) { bytes_.resize(round_up(bytes_.size(), align), '\0'); }
+
+    std::string bytes_;
+};
+
+/** @brief Writes a Schema.fbs Schema table of @p fields; returns its position. */
+std::size_t add_schema(FlatBuilder& b, const std::vector<ArrowField>& fields) {
+    std::size_t fields_ref = 0;
+    const std::size_t schema = b.add(FlatBuilder::Table{}.scalar(0, 2, 0 /* little-endian */).ref(1), &fields_ref);
+    const std::size_t list = b.refs(fields.size());
+    b.point(fields_ref, list);
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        const ArrowType type = fields[i].type;
+        const std::uint64_t type_tag = type == ArrowType::Utf8 ? kTypeUtf8
+                                       : type == ArrowType::Timestamp ? kTypeTimestamp
+                                                                      : kTypeInt;
+        std::size_t refs[3]; // name, type, children
+        const std::size_t field = b.add(FlatBuilder::Table{}
+                                            .ref(0)
+                                            .scalar(1, 1, 0 /* not nullable */)
+                                            .scalar(2, 1, type_tag)
+                                            .ref(3)
+                                            .ref(5),
+                                        refs);
+        b.point(list + 4u + 4u * i, field);
+        b.point(refs[0], b.string(fields[i].name));
+
+        const auto integer = [&](std::uint64_t bits, bool is_signed) {
+            b.point(refs[1], b.add(FlatBuilder::Table{}.scalar(0, 4, bits).scalar(1, 1, is_signed ? 1u : 0u)));
+        };
+        std::size_t timezone = 0;
+        switch (type) {
+            case ArrowType::Int32: integer(32, true); break;
+            case ArrowType::UInt32: integer(32, false); break;
+            case ArrowType::Int64: integer(64, true); break;
+            case ArrowType::Timestamp:
+                b.point(refs[1], b.add(FlatBuilder::Table{}.scalar(0, 2, 0 /* SECOND */).ref(1), &timezone));
+                b.point(timezone, b.string("UTC"));
+                break;
+            case ArrowType::Utf8: b.point(refs[1], b.add(FlatBuilder::Table{})); break;
+        }
+        b.point(refs[2], b.refs(0));
+    }
+    return schema;
+}
+
+/** @brief Bytes of one value of a fixed-width type. */
+std::size_t value_size(ArrowType type) {
+    return type == ArrowType::Int64 || type == ArrowType::Timestamp ? 8u : 4u;
+}
+
+bool write_all(int fd, const void* data, std::size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0u) {
+        const ssize_t n = ::write(fd, p, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+ArrowFileWriter::ArrowFileWriter(std::vector<ArrowField> schema) : schema_(std::move(schema)) {}
+
+ArrowFileWriter::~ArrowFileWriter() {
+    if (fd_ >= 0) ::close(fd_);
+    if (!tmp_.empty() && !finished_) std::remove(tmp_.c_str());
+}
+
+bool ArrowFileWriter::put(const void* data, std::size_t size) {
+    static constexpr char kZeros[8] = {};
+    const std::size_t padding = round_up(size, 8u) - size;
+    ok_ = ok_ && write_all(fd_, data, size) && write_all(fd_, kZeros, padding);
+    offset_ += size + padding;
+    return ok_;
+}
+
+bool ArrowFileWriter::open(const std::string& path) {
+    path_ = path;
+    tmp_ = path + ".tmp";
+    fd_ = ::open(tmp_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    ok_ = fd_ >= 0;
+
+    FlatBuilder b;
+    std::size_t header = 0;
+    b.root(b.add(FlatBuilder::Table{}.scalar(0, 2, kMetadataV5).scalar(1, 1, kHeaderSchema).ref(2), &header));
+    b.point(header, add_schema(b, schema_));
+    const std::string& metadata = b.finish();
+    const std::uint32_t prefix[2] = {kContinuation, static_cast<std::uint32_t>(metadata.size())};
+    return put(kArrowMagic, sizeof(kArrowMagic)) && put(prefix, sizeof(prefix)) && put(metadata.data(), metadata.size());
+}
+
+bool ArrowFileWriter::write_batch(std::size_t rows, const ArrowColumn* columns) {
+    if (!ok_) return false;
+    struct Pair {
+        std::int64_t a;
+        std::int64_t b;
+    };
+    std::vector<Pair> nodes;   // FieldNode: length, null count
+    std::vector<Pair> buffers; // Buffer: offset in the body, length
+    std::vector<std::pair<const void*, std::size_t>> parts;
+    std::int64_t body = 0;
+    const auto buffer = [&](const void* data, std::size_t size) {
+        buffers.push_back(Pair{body, static_cast<std::int64_t>(size)});
+        if (size != 0u) parts.emplace_back(data, size);
+        body += static_cast<std::int64_t>(round_up(size, 8u));
+    };
+    for (std::size_t c = 0; c < schema_.size(); ++c) {
+        nodes.push_back(Pair{static_cast<std::int64_t>(rows), 0});
+        buffer(nullptr, 0u); // validity: no nulls
+        if (schema_[c].type == ArrowType::Utf8) {
+            const auto* offsets = static_cast<const std::int32_t*>(columns[c].values);
+            buffer(offsets, 4u * (rows + 1u));
+            buffer(columns[c].chars, static_cast<std::size_t>(offsets[rows]));
+        } else {
+            buffer(columns[c].values, value_size(schema_[c].type) * rows);
+        }
+    }
+
+    FlatBuilder b;
+    std::size_t header = 0;
+    b.root(b.add(FlatBuilder::Table{}
+                     .scalar(0, 2, kMetadataV5)
+                     .scalar(1, 1, kHeaderRecordBatch)
+                     .ref(2)
+                     .scalar(3, 8, static_cast<std::uint64_t>(body)),
+                 &header));
+    std::size_t lists[2];
+    b.point(header, b.add(FlatBuilder::Table{}.scalar(0, 8, rows).ref(1).ref(2), lists));
+    b.point(lists[0], b.structs(nodes.data(), nodes.size(), sizeof(Pair)));
+    b.point(lists[1], b.structs(buffers.data(), buffers.size(), sizeof(Pair)));
+    const std::string& metadata = b.finish();
+
+    const Block block{static_cast<std::int64_t>(offset_), static_cast<std::int32_t>(8u + metadata.size()), 0,
+                      body};
+    const std::uint32_t prefix[2] = {kContinuation, static_cast<std::uint32_t>(metadata.size())};
+    if (!put(prefix, sizeof(prefix)) || !put(metadata.data(), metadata.size())) return false;
+    for (const auto& [data, size] : parts) {
+        if (!put(data, size)) return false;
+    }
+    blocks_.push_back(block);
+    rows_ += rows;
+    return true;
+}
+
+bool ArrowFileWriter::finish() {
+    if (!ok_) return false;
+    const std::uint32_t end_of_stream[2] = {kContinuation, 0u};
+    if (!put(end_of_stream, sizeof(end_of_stream))) return false;
+
+    FlatBuilder b;
+    std::size_t refs[2]; // schema, record batches
+    b.root(b.add(FlatBuilder::Table{}.scalar(0, 2, kMetadataV5).ref(1).ref(3), refs));
+    b.point(refs[0], add_schema(b, schema_));
+    b.point(refs[1], b.structs(blocks_.data(), blocks_.size(), sizeof(Block)));
+    const std::string& footer = b.finish();
+    const std::int32_t footer_size = static_cast<std::int32_t>(footer.size());
+    ok_ = write_all(fd_, footer.data(), footer.size()) && write_all(fd_, &footer_size, sizeof(footer_size))
+          && write_all(fd_, kArrowMagic, 6u) && ::fsync(fd_) == 0;
+    ok_ = ::close(fd_) == 0 && ok_;
+    fd_ = -1;
+    finished_ = ok_ && ::rename(tmp_.c_str(), path_.c_str()) == 0;
+    return finished_;
+}
+
+} // namespace booking
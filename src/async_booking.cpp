@@ -0,0 +1,68 @@
+#include "async_booking.hpp"
+
+namespace booking {
+
+CommitLoop::CommitLoop(BookingService& service)
+    : service_(service), horizon_([&service] { return service.journal_durable_lsn(); }) {}
+
+CommitLoop::~CommitLoop() { run(); }
+
+void CommitLoop::set_horizon(Horizon horizon) { horizon_ = std::move(horizon); }
+
+void CommitLoop::spawn(Task<void> task) {
+    const std::coroutine_handle<Task<void>::promise_type> handle = std::exchange(task.handle_, {});
+    handle.promise().spawned = &spawned_;
+    ++spawned_;
+    handle.resume();
+}
+
+std::size_t CommitLoop::resume_up_to(std::uint64_t horizon) {
+    std::size_t resumed = 0;
+    while (!parked_.empty() && parked_.top().first <= horizon) {
+        const std::coroutine_handle<> waiting = parked_.top().second;
+        parked_.pop();
+        waiting.resume(); // may park again, on a later LSN
+        ++resumed;
+    }
+    return resumed;
+}
+
+std::size_t CommitLoop::poll() {
+    if (parked_.empty()) return 0;
+    return resume_up_to(horizon_());
+}
+
+void CommitLoop::run() {
+    while (!parked_.empty()) {
+        if (poll() != 0u) continue;
+        // Nothing acknowledged yet: block for the oldest commit, which releases everything up to it
+        const std::uint64_t oldest = parked_.top().first;
+        if (!service_.wait_journal(oldest)) failed_ = true;
+        resume_up_to(oldest);
+    }
+}
+
+CommitLoop::BookingAwaiter CommitLoop::book_seats(ShowId show_id, const std::vector<std::string>& seat_labels) {
+    BookingAwaiter op{{this, 0u}, {}};
+    op.result = service_.book_seats(show_id, seat_labels, &op.lsn);
+    return op;
+}
+
+CommitLoop::BookingAwaiter CommitLoop::book_seat_mask(ShowId show_id, const SeatMask& seats) {
+    BookingAwaiter op{{this, 0u}, {}};
+    op.result = service_.book_seat_mask(show_id, seats, &op.lsn);
+    return op;
+}
+
+CommitLoop::BookingAwaiter CommitLoop::hold_seats(ShowId show_id, const std::vector<std::string>& seat_labels,
+                                                  std::chrono::milliseconds ttl) {
+    return BookingAwaiter{{this, 0u}, service_.hold_seats(show_id, seat_labels, ttl)};
+}
+
+CommitLoop::BookingAwaiter CommitLoop::confirm_hold(HoldId hold_id) {
+    BookingAwaiter op{{this, 0u}, {}};
+    op.result = service_.confirm_hold(hold_id, &op.lsn);
+    return op;
+}
+
+} // namespace booking
@@ -0,0 +1,45 @@
+#include "atomic_wait.hpp"
+
+#include <climits>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace booking {
+namespace atomic_wait_detail {
+
+namespace {
+
+constexpr std::size_t kBuckets = 256; /**< Power of two: distinct hot atomics rarely share one. */
+
+Bucket g_buckets[kBuckets];
+
+} // namespace
+
+Bucket& bucket(const void* address) {
+    // Fibonacci hashing of the address without its low bits (atomics are at least 4 apart)
+    const auto key = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(address)) >> 2;
+    return g_buckets[(key * 0x9E3779B97F4A7C15u) >> 56];
+}
+
+#if defined(__linux__)
+
+void futex_wait(const void* address, std::uint32_t old) {
+    // EAGAIN (the word changed), EINTR and spurious wakeups all return: the caller loads again
+    syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, old, nullptr, nullptr, 0);
+}
+
+void futex_wake_all(const void* address) { syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0); }
+
+#else
+
+void futex_wait(const void*, std::uint32_t) {}
+void futex_wake_all(const void*) {}
+
+#endif
+
+} // namespace atomic_wait_detail
+} // namespace booking
@@ -0,0 +1,412 @@
+#include "audit_tap.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "schedule_loader.hpp"
+#include "seat_map_codec.hpp"
+
+namespace booking {
+
+namespace {
+
+/** @brief Journal bytes the sink thread reads from the spill file at a time. */
+constexpr std::size_t kSpillChunk = std::size_t{1} << 20;
+
+/** @brief Word tag: the u64 word follows (more than 7 seats set). */
+constexpr std::uint8_t kRawWord = 0xFFu;
+
+bool pwrite_all(int fd, const char* data, std::size_t size, std::uint64_t offset) {
+    while (size > 0u) {
+        const ssize_t n = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+        offset += static_cast<std::uint64_t>(n);
+    }
+    return true;
+}
+
+std::size_t pread_all(int fd, char* data, std::size_t size, std::uint64_t offset) {
+    std::size_t done = 0;
+    while (done < size) {
+        const ssize_t n = ::pread(fd, data + done, size - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += static_cast<std::size_t>(n);
+    }
+    return done;
+}
+
+/** @brief Length of the whole records at the start of @p bytes. */
+std::size_t whole_records(std::string_view bytes) {
+    JournalReader reader = JournalReader::records(bytes);
+    JournalRecord r;
+    while (reader.next(r)) {
+    }
+    return reader.offset();
+}
+
+std::size_t round_up_pow2(std::size_t n) {
+    std::size_t p = 64;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+} // namespace
+
+std::size_t encode_audit_batch(std::string_view records, AuditBatch& out) {
+    JournalReader reader = JournalReader::records(records);
+    std::vector<JournalRecord> batch;
+    for (JournalRecord r; reader.next(r);) batch.push_back(r);
+    out = AuditBatch{};
+    out.records = batch.size();
+    out.raw_bytes = reader.offset();
+    if (batch.empty()) return 0;
+    out.first_lsn = batch.front().lsn;
+    out.end_lsn = batch.back().end_lsn;
+
+    std::vector<std::uint8_t>& p = out.payload;
+    append_varint(p, batch.size());
+    append_varint(p, out.first_lsn);
+    std::uint64_t prev_end = out.first_lsn;
+    std::int64_t prev_show = 0;
+    std::int64_t prev_booking = 0;
+    for (const JournalRecord& r : batch) {
+        append_varint(p, r.lsn - prev_end);
+        append_varint(p, zigzag(r.show_id.value() - prev_show));
+        append_varint(p, zigzag(static_cast<std::int64_t>(r.booking_id) - prev_booking));
+        const int first = r.seats.first_word();
+        const int count = std::max(r.seats.end_word() - first, 0);
+        p.push_back(static_cast<std::uint8_t>(r.op));
+        p.push_back(static_cast<std::uint8_t>(first));
+        p.push_back(static_cast<std::uint8_t>(count));
+        for (int w = first; w < first + count; ++w) {
+            const std::uint64_t word = r.seats.word(w);
+            const int n = popcount64(word);
+            if (n <= 7) {
+                p.push_back(static_cast<std::uint8_t>(n));
+                for (std::uint64_t b = word; b != 0u; b &= b - 1u) p.push_back(static_cast<std::uint8_t>(ctz64(b)));
+            } else {
+                p.push_back(kRawWord);
+                for (int k = 0; k < 8; ++k) p.push_back(static_cast<std::uint8_t>(word >> (8 * k)));
+            }
+        }
+        prev_end = r.end_lsn;
+        prev_show = r.show_id.value();
+        prev_booking = r.booking_id;
+    }
+    return batch.size();
+}
+
+bool decode_audit_batch(const std::uint8_t* payload, std::size_t size, std::vector<JournalRecord>& out) {
+    const std::uint8_t* p = payload;
+    const std::uint8_t* const end = payload + size;
+    std::uint64_t count = 0;
+    std::uint64_t prev_end = 0;
+    if (!read_varint(p, end, count) || !read_varint(p, end, prev_end)) return false;
+    std::int64_t prev_show = 0;
+    std::int64_t prev_booking = 0;
+    for (std::uint64_t i = 0; i < count; ++i) {
+        std::uint64_t gap = 0;
+        std::uint64_t show = 0;
+        std::uint64_t booking = 0;
+        if (!read_varint(p, end, gap) || !read_varint(p, end, show) || !read_varint(p, end, booking)) return false;
+        if (end - p < 3) return false;
+        JournalRecord r;
+        r.lsn = prev_end + gap;
+        r.show_id = ShowId(prev_show + unzigzag(show));
+        prev_booking += unzigzag(booking);
+        r.booking_id = static_cast<std::uint32_t>(prev_booking);
+        r.op = static_cast<JournalOp>(p[0]);
+        const int first = p[1];
+        const int words = p[2];
+        p += 3;
+        if (first + words > SeatMask::kWords) return false;
+        for (int w = first; w < first + words; ++w) {
+            if (p == end) return false;
+            const std::uint8_t n = *p++;
+            std::uint64_t word = 0;
+            if (n == kRawWord) {
+                if (end - p < 8) return false;
+                for (int k = 0; k < 8; ++k) word |= static_cast<std::uint64_t>(p[k]) << (8 * k);
+                p += 8;
+            } else {
+                if (n > 7u || end - p < n) return false;
+                for (int k = 0; k < n; ++k) {
+                    if (p[k] >= 64u) return false;
+                    word |= std::uint64_t{1} << p[k];
+                }
+                p += n;
+            }
+            if (word != 0u) r.seats.or_word(w, word);
+        }
+        r.end_lsn = r.lsn + Journal::slots_for(words);
+        prev_end = r.end_lsn;
+        prev_show = r.show_id.value();
+        out.push_back(r);
+    }
+    return p == end;
+}
+
+AuditSink audit_file_sink(const std::string& path) {
+    auto fd = std::make_shared<int>(-1);
+    return [fd, path](const AuditBatch& batch) {
+        if (*fd < 0) *fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (*fd < 0) return false;
+        std::string frame(4u + batch.payload.size(), '\0');
+        const auto n = static_cast<std::uint32_t>(batch.payload.size());
+        for (int k = 0; k < 4; ++k) frame[static_cast<std::size_t>(k)] = static_cast<char>(n >> (8 * k));
+        std::memcpy(&frame[4], batch.payload.data(), batch.payload.size());
+        const off_t before = ::lseek(*fd, 0, SEEK_END);
+        for (std::size_t done = 0; done < frame.size();) {
+            const ssize_t w = ::write(*fd, frame.data() + done, frame.size() - done);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) {
+                if (before >= 0) { // no half frame: the batch is resent
+                    [[maybe_unused]] const int cut = ::ftruncate(*fd, before);
+                }
+                return false;
+            }
+            done += static_cast<std::size_t>(w);
+        }
+        return ::fdatasync(*fd) == 0;
+    };
+}
+
+bool read_audit_file(const std::string& path, std::vector<JournalRecord>& out) {
+    const MappedFile file(path);
+    if (!file.ok()) return false;
+    const std::string_view bytes = file.view();
+    const auto* p = reinterpret_cast<const std::uint8_t*>(bytes.data());
+    std::size_t left = bytes.size();
+    while (left != 0u) {
+        if (left < 4u) return false;
+        const std::uint32_t n = p[0] | p[1] << 8 | p[2] << 16 | static_cast<std::uint32_t>(p[3]) << 24;
+        if (left - 4u < n || !decode_audit_batch(p + 4, n, out)) return false;
+        p += 4u + n;
+        left -= 4u + n;
+    }
+    return true;
+}
+
+AuditTap::AuditTap(AuditSink sink, AuditTapOptions options)
+    : sink_(std::move(sink)), options_(std::move(options)) {
+    const std::size_t capacity = round_up_pow2(options_.ring_bytes);
+    ring_.reset(new char[capacity]);
+    mask_ = capacity - 1u;
+    if (!options_.spill_path.empty()) {
+        spill_fd_ = ::open(options_.spill_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (spill_fd_ >= 0) {
+            // Records a previous tap left behind go first; a torn last one is dropped
+            const off_t size = ::lseek(spill_fd_, 0, SEEK_END);
+            std::string left(size > 0 ? static_cast<std::size_t>(size) : 0u, '\0');
+            left.resize(pread_all(spill_fd_, &left[0], left.size(), 0));
+            const std::size_t valid = whole_records(left);
+            if (valid != left.size()) {
+                [[maybe_unused]] const int cut = ::ftruncate(spill_fd_, static_cast<off_t>(valid));
+            }
+            spill_end_ = valid;
+            spilling_ = valid != 0u;
+            spill_written_.store(valid, std::memory_order_relaxed);
+            offered_bytes_.store(valid, std::memory_order_relaxed);
+        }
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+AuditTap::~AuditTap() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+    if (spill_fd_ >= 0) ::close(spill_fd_);
+}
+
+void AuditTap::offer(std::string_view records) {
+    if (records.empty()) return;
+    offered_bytes_.fetch_add(records.size(), std::memory_order_relaxed);
+    if (spilling_ && spill_read_.load(std::memory_order_acquire) == spill_end_) {
+        // The sink thread delivered the whole spill file (and the ring before it): back to the ring
+        spill_base_.store(spill_end_, std::memory_order_release);
+        [[maybe_unused]] const int cut = ::ftruncate(spill_fd_, 0); // else it only grows
+        spilling_ = false;
+    }
+    if (!spilling_) {
+        const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t capacity = mask_ + 1u;
+        if (tail + records.size() - head_cache_ > capacity) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+        }
+        if (tail + records.size() - head_cache_ <= capacity) {
+            const std::size_t at = static_cast<std::size_t>(tail) & mask_;
+            const std::size_t first = std::min(records.size(), capacity - at);
+            std::memcpy(&ring_[at], records.data(), first);
+            std::memcpy(&ring_[0], records.data() + first, records.size() - first);
+            tail_.store(tail + records.size(), std::memory_order_release);
+            return;
+        }
+        if (spill_fd_ < 0) { // nowhere to keep them
+            dropped_bytes_.fetch_add(records.size(), std::memory_order_relaxed);
+            settled_bytes_.fetch_add(records.size(), std::memory_order_relaxed);
+            return;
+        }
+        spilling_ = true;
+    }
+    if (!spill(records)) {
+        dropped_bytes_.fetch_add(records.size(), std::memory_order_relaxed);
+        settled_bytes_.fetch_add(records.size(), std::memory_order_relaxed);
+    }
+}
+
+bool AuditTap::spill(std::string_view records) {
+    const std::uint64_t base = spill_base_.load(std::memory_order_relaxed);
+    if (!pwrite_all(spill_fd_, records.data(), records.size(), spill_end_ - base)) return false;
+    spill_end_ += records.size();
+    spilled_bytes_.fetch_add(records.size(), std::memory_order_relaxed);
+    spill_written_.store(spill_end_, std::memory_order_release);
+    return true;
+}
+
+void AuditTap::copy_out(std::uint64_t pos, std::size_t n, char* out) const {
+    const std::size_t at = static_cast<std::size_t>(pos) & mask_;
+    const std::size_t first = std::min(n, mask_ + 1u - at);
+    std::memcpy(out, &ring_[at], first);
+    std::memcpy(out + first, &ring_[0], n - first);
+}
+
+bool AuditTap::fill() {
+    // The spill end is read before the ring: records spilled by then were offered after
+    // everything the ring holds, so the ring is drained first
+    const std::uint64_t written = spill_written_.load(std::memory_order_acquire);
+    const std::uint64_t head = head_.load(std::memory_order_relaxed);
+    const std::uint64_t tail = tail_.load(std::memory_order_acquire);
+    pending_.clear();
+    pending_offset_ = 0;
+    if (tail != head) {
+        pending_.resize(static_cast<std::size_t>(tail - head));
+        copy_out(head, pending_.size(), &pending_[0]);
+        head_.store(tail, std::memory_order_release);
+        pending_spilled_ = false;
+        return true;
+    }
+    const std::uint64_t read = spill_read_.load(std::memory_order_relaxed);
+    if (read == written) return false;
+    const std::uint64_t base = spill_base_.load(std::memory_order_acquire);
+    pending_.resize(static_cast<std::size_t>(std::min<std::uint64_t>(written - read, kSpillChunk)));
+    pending_.resize(pread_all(spill_fd_, &pending_[0], pending_.size(), read - base));
+    pending_.resize(whole_records(pending_));
+    pending_spilled_ = true;
+    return !pending_.empty();
+}
+
+bool AuditTap::deliver_pending() {
+    while (pending_offset_ < pending_.size()) {
+        // Whole records up to batch_bytes (at least one)
+        const std::string_view rest = std::string_view(pending_).substr(pending_offset_);
+        JournalReader reader = JournalReader::records(rest);
+        std::size_t cut = 0;
+        for (JournalRecord r; reader.next(r);) {
+            if (cut != 0u && reader.offset() > options_.batch_bytes) break;
+            cut = reader.offset();
+        }
+        if (cut == 0u) { // not a record: cannot happen for committed journal bytes
+            dropped_bytes_.fetch_add(rest.size(), std::memory_order_relaxed);
+            settled_bytes_.fetch_add(rest.size(), std::memory_order_relaxed);
+            if (pending_spilled_) spill_read_.fetch_add(rest.size(), std::memory_order_release);
+            pending_offset_ = pending_.size();
+            break;
+        }
+        AuditBatch batch;
+        encode_audit_batch(rest.substr(0, cut), batch);
+        if (!sink_(batch)) {
+            sink_failures_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        pending_offset_ += cut;
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        records_.fetch_add(batch.records, std::memory_order_relaxed);
+        raw_bytes_.fetch_add(cut, std::memory_order_relaxed);
+        payload_bytes_.fetch_add(batch.payload.size(), std::memory_order_relaxed);
+        delivered_lsn_.store(batch.end_lsn, std::memory_order_relaxed);
+        if (pending_spilled_) spill_read_.fetch_add(cut, std::memory_order_release);
+        settled_bytes_.fetch_add(cut, std::memory_order_release); // the sink's writes before flush returns
+    }
+    return true;
+}
+
+void AuditTap::run() {
+    bool refused = false;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // The producer never notifies (it must not take a lock): poll every linger
+            if (wake_.wait_for(lock, refused ? options_.retry : options_.linger, [this] { return stop_; })) break;
+        }
+        refused = false;
+        while ((pending_offset_ < pending_.size() || fill()) && !refused) refused = !deliver_pending();
+    }
+    // Last attempt, then whatever the sink did not take stays in the spill file
+    bool delivered = true;
+    while (delivered && (pending_offset_ < pending_.size() || fill())) delivered = deliver_pending();
+    keep_undelivered(); // empties the file if everything was delivered
+}
+
+void AuditTap::keep_undelivered() {
+    // Oldest first: the rest of pending_ if it came from the ring, the ring, then the spill
+    // file from the first undelivered byte (the producer has stopped offering)
+    std::string left;
+    if (!pending_spilled_) left.assign(pending_, pending_offset_, std::string::npos);
+    const std::uint64_t head = head_.load(std::memory_order_relaxed);
+    const std::uint64_t tail = tail_.load(std::memory_order_acquire);
+    const std::size_t kept = left.size();
+    left.resize(kept + static_cast<std::size_t>(tail - head));
+    copy_out(head, static_cast<std::size_t>(tail - head), &left[kept]);
+    head_.store(tail, std::memory_order_relaxed);
+    if (spill_fd_ < 0) {
+        dropped_bytes_.fetch_add(left.size(), std::memory_order_relaxed);
+        return;
+    }
+    const std::uint64_t read = spill_read_.load(std::memory_order_relaxed);
+    const std::uint64_t written = spill_written_.load(std::memory_order_acquire);
+    const std::uint64_t base = spill_base_.load(std::memory_order_acquire);
+    const std::size_t from_ring = left.size();
+    left.resize(from_ring + static_cast<std::size_t>(written - read));
+    left.resize(from_ring + pread_all(spill_fd_, &left[from_ring], left.size() - from_ring, read - base));
+    if (!pwrite_all(spill_fd_, left.data(), left.size(), 0)
+        || ::ftruncate(spill_fd_, static_cast<off_t>(left.size())) != 0 || ::fdatasync(spill_fd_) != 0) {
+        dropped_bytes_.fetch_add(from_ring, std::memory_order_relaxed);
+    }
+}
+
+bool AuditTap::flush(std::chrono::milliseconds timeout) {
+    const std::uint64_t target = offered_bytes_.load(std::memory_order_relaxed);
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (settled_bytes_.load(std::memory_order_acquire) < target) {
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+AuditStats AuditTap::stats() const {
+    AuditStats s;
+    s.batches = batches_.load(std::memory_order_relaxed);
+    s.records = records_.load(std::memory_order_relaxed);
+    s.raw_bytes = raw_bytes_.load(std::memory_order_relaxed);
+    s.payload_bytes = payload_bytes_.load(std::memory_order_relaxed);
+    s.delivered_lsn = delivered_lsn_.load(std::memory_order_relaxed);
+    s.sink_failures = sink_failures_.load(std::memory_order_relaxed);
+    s.spilled_bytes = spilled_bytes_.load(std::memory_order_relaxed);
+    s.dropped_bytes = dropped_bytes_.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace booking
@@ -0,0 +1,148 @@
+#include "availability_codec.hpp"
+
+#include "crc32c.hpp"
+
+#include <cstring>
+
+namespace booking {
+
+namespace {
+
+std::size_t row_bytes(const HallLayout& layout, int row) {
+    return (static_cast<std::size_t>(layout.row_seats(row)) + 7u) / 8u;
+}
+
+/** @brief Bits [start, start + len) of a word (len >= 1). */
+std::uint64_t bit_range(int start, int len) {
+    const std::uint64_t ones = len >= 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << len) - 1u;
+    return ones << start;
+}
+
+} // namespace
+
+const char* to_string(SeatEncoding encoding) {
+    switch (encoding) {
+        case SeatEncoding::Bitmap: return "bitmap";
+        case SeatEncoding::Runs: return "runs";
+        case SeatEncoding::Labels: return "labels";
+    }
+    return "unknown";
+}
+
+std::size_t max_encoded_size(const HallLayout& layout, SeatEncoding encoding) {
+    std::size_t size = 0;
+    switch (encoding) {
+        case SeatEncoding::Bitmap:
+            for (int r = 0; r < layout.row_count(); ++r) size += row_bytes(layout, r);
+            return size;
+        case SeatEncoding::Runs:
+            // Every other seat free: ceil(seats / 2) runs of one
+            for (int r = 0; r < layout.row_count(); ++r) {
+                size += 3u * ((static_cast<std::size_t>(layout.row_seats(r)) + 1u) / 2u);
+            }
+            return size;
+        case SeatEncoding::Labels:
+            return layout.max_rendered_size();
+    }
+    return 0;
+}
+
+char* encode_free_seats(const HallLayout& layout, const std::uint64_t* free_words, int word_count,
+                        SeatEncoding encoding, char* out) {
+    const int rows = word_count < layout.row_count() ? word_count : layout.row_count();
+    switch (encoding) {
+        case SeatEncoding::Bitmap:
+            for (int r = 0; r < rows; ++r) {
+                const std::uint64_t bits = free_words[r] & layout.row_mask(r);
+                const std::size_t n = row_bytes(layout, r);
+                for (std::size_t b = 0; b < n; ++b) *out++ = static_cast<char>(bits >> (8u * b));
+            }
+            return out;
+        case SeatEncoding::Runs:
+            for (int r = 0; r < rows; ++r) {
+                std::uint64_t bits = free_words[r] & layout.row_mask(r);
+                while (bits != 0u) {
+                    const int start = ctz64(bits);
+                    const std::uint64_t rest = ~(bits >> start);
+                    const int len = rest == 0u ? 64 - start : ctz64(rest);
+                    *out++ = static_cast<char>(r);
+                    *out++ = static_cast<char>(start);
+                    *out++ = static_cast<char>(len);
+                    bits &= ~bit_range(start, len);
+                }
+            }
+            return out;
+        case SeatEncoding::Labels:
+            return layout.render_labels(free_words, rows, ',', out);
+    }
+    return out;
+}
+
+bool decode_free_seats(const HallLayout& layout, SeatEncoding encoding, const char* data, std::size_t size,
+                       SeatMask& out) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    out = SeatMask{};
+    switch (encoding) {
+        case SeatEncoding::Bitmap: {
+            std::size_t pos = 0;
+            for (int r = 0; r < layout.row_count() && pos < size; ++r) {
+                const std::size_t n = row_bytes(layout, r);
+                if (size - pos < n) return false;
+                std::uint64_t bits = 0;
+                for (std::size_t b = 0; b < n; ++b) bits |= static_cast<std::uint64_t>(p[pos + b]) << (8u * b);
+                if ((bits & ~layout.row_mask(r)) != 0u) return false;
+                out.or_word(r, bits);
+                pos += n;
+            }
+            return pos == size;
+        }
+        case SeatEncoding::Runs: {
+            if (size % 3u != 0u) return false;
+            for (std::size_t pos = 0; pos < size; pos += 3u) {
+                const int row = p[pos];
+                const int start = p[pos + 1];
+                const int len = p[pos + 2];
+                if (row >= layout.row_count() || len == 0 || start + len > 64) return false;
+                const std::uint64_t bits = bit_range(start, len);
+                if ((bits & ~layout.row_mask(row)) != 0u) return false;
+                out.or_word(row, bits);
+            }
+            return true;
+        }
+        case SeatEncoding::Labels:
+            return false;
+    }
+    return false;
+}
+
+bool read_availability_blob(const char* data, std::size_t size, AvailabilityBlobIndex& out) {
+    out = AvailabilityBlobIndex{};
+    if (size < kAvailabilityBlobHeader || std::memcmp(data, "BKAVAIL1", 8) != 0) return false;
+    std::uint64_t count = 0;
+    std::uint32_t crc = 0;
+    std::memcpy(&out.version, data + 8, 8);
+    std::memcpy(&count, data + 16, 8);
+    const auto encoding = static_cast<std::uint8_t>(data[24]);
+    std::memcpy(&crc, data + 28, 4);
+    if (encoding >= kSeatEncodings) return false;
+    out.encoding = static_cast<SeatEncoding>(encoding);
+    if (count > (size - kAvailabilityBlobHeader) / kAvailabilityBlobEntry) return false;
+    if (crc32c(data + kAvailabilityBlobHeader, size - kAvailabilityBlobHeader) != crc) return false;
+
+    out.shows.resize(static_cast<std::size_t>(count));
+    const char* p = data + kAvailabilityBlobHeader;
+    for (AvailabilityBlobEntry& e : out.shows) {
+        std::int64_t show = 0;
+        std::memcpy(&show, p, 8);
+        std::memcpy(&e.changes, p + 8, 8);
+        std::memcpy(&e.offset, p + 16, 8);
+        std::memcpy(&e.size, p + 24, 4);
+        std::memcpy(&e.layout_id, p + 28, 4);
+        e.show_id = ShowId(show);
+        if (e.offset > size || e.size > size - e.offset) return false;
+        p += kAvailabilityBlobEntry;
+    }
+    return true;
+}
+
+} // namespace booking
@@ -0,0 +1,105 @@
+#include "availability_views.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace booking {
+
+void AvailabilityViews::insert_keys(ShowId show, const Entry& e) {
+    MovieView& view = movies_[e.movie];
+    view.by_seats.insert(Key{-static_cast<std::int64_t>(e.seats_left), show.value()});
+    if (e.cheapest_price != RankedShow::kNoPrice) view.by_price.insert(Key{e.cheapest_price, show.value()});
+}
+
+void AvailabilityViews::erase_keys(ShowId show, const Entry& e) {
+    auto view = movies_.find(e.movie);
+    view->second.by_seats.erase(Key{-static_cast<std::int64_t>(e.seats_left), show.value()});
+    view->second.by_price.erase(Key{e.cheapest_price, show.value()});
+    if (view->second.by_seats.empty()) movies_.erase(view);
+}
+
+void AvailabilityViews::add_show(ShowId show, MovieId movie, int seats_left, std::uint32_t cheapest_price) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto [it, inserted] = shows_.try_emplace(show);
+    if (!inserted) erase_keys(show, it->second);
+    it->second = Entry{movie, seats_left, cheapest_price};
+    insert_keys(show, it->second);
+}
+
+bool AvailabilityViews::remove_show(ShowId show) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = shows_.find(show);
+    if (it == shows_.end()) return false;
+    erase_keys(show, it->second);
+    shows_.erase(it);
+    return true;
+}
+
+bool AvailabilityViews::update(ShowId show, int seats_left, std::uint32_t cheapest_price) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = shows_.find(show);
+    if (it == shows_.end()) return false;
+    Entry& e = it->second;
+    if (e.seats_left == seats_left && e.cheapest_price == cheapest_price) return true; // most changes of a big hall
+    erase_keys(show, e);
+    e.seats_left = seats_left;
+    e.cheapest_price = cheapest_price;
+    insert_keys(show, e);
+    return true;
+}
+
+bool AvailabilityViews::contains(ShowId show) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return shows_.count(show) != 0u;
+}
+
+std::size_t AvailabilityViews::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return shows_.size();
+}
+
+std::size_t AvailabilityViews::bytes() const {
+    // Node payloads plus about two pointers of node and bucket overhead each
+    constexpr std::size_t kNode = 2 * sizeof(void*);
+    constexpr std::size_t kTreeNode = 4 * sizeof(void*);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::size_t keys = 0;
+    for (const auto& m : movies_) keys += m.second.by_seats.size() + m.second.by_price.size();
+    return shows_.size() * (sizeof(std::pair<const ShowId, Entry>) + kNode)
+           + movies_.size() * (sizeof(std::pair<const MovieId, MovieView>) + kNode)
+           + keys * (sizeof(Key) + kTreeNode);
+}
+
+std::vector<ShowId> AvailabilityViews::shows() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<ShowId> out;
+    out.reserve(shows_.size());
+    for (const auto& entry : shows_) out.push_back(entry.first);
+    return out;
+}
+
+std::vector<RankedShow> AvailabilityViews::walk(const std::set<Key>& order, std::size_t limit) const {
+    std::vector<RankedShow> out;
+    out.reserve(std::min(limit, order.size()));
+    for (auto it = order.begin(); it != order.end() && out.size() < limit; ++it) {
+        const Entry& e = shows_.at(ShowId(it->show));
+        out.push_back(RankedShow{ShowId(it->show), e.seats_left, e.cheapest_price});
+    }
+    return out;
+}
+
+std::vector<RankedShow> AvailabilityViews::by_seats_left(MovieId movie, std::size_t limit) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto view = movies_.find(movie);
+    if (view == movies_.end()) return {};
+    return walk(view->second.by_seats, limit);
+}
+
+std::vector<RankedShow> AvailabilityViews::by_cheapest_seat(MovieId movie, std::size_t limit) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto view = movies_.find(movie);
+    if (view == movies_.end()) return {};
+    return walk(view->second.by_price, limit);
+}
+
+} // namespace booking
@@ -0,0 +1,214 @@
+#include "booking_service.hpp"
+
+#include "seat_map_codec.hpp"
+
+#include <algorithm>
+#include <map>
+
+// Archiving: shows that have played leave the catalog and the booking state table and are
+// kept as compact read-only records, so a long-running service does not grow with every
+// show it ever sold.
+
+namespace booking {
+
+namespace {
+
+void put_signed(std::vector<std::uint8_t>& out, std::int64_t v) { append_varint(out, zigzag(v)); }
+
+/** @brief Next varint of a record this store wrote (trusted: no bounds). */
+std::uint64_t get_varint(const std::uint8_t*& p) {
+    std::uint64_t v = 0;
+    read_varint(p, p + 10, v);
+    return v;
+}
+
+std::int64_t get_signed(const std::uint8_t*& p) { return unzigzag(get_varint(p)); }
+
+} // namespace
+
+bool ColdShowStore::add(const ArchivedShow& show) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto pos = std::lower_bound(index_.begin(), index_.end(), show.show.id,
+                                [](const std::pair<ShowId, std::uint64_t>& e, ShowId id) { return e.first < id; });
+    if (pos != index_.end() && pos->first == show.show.id) return false;
+    index_.insert(pos, {show.show.id, log_.size()});
+
+    // Record: catalog fields, then bookings by ascending id, each with its ascending seats,
+    // both as deltas from the previous value
+    put_signed(log_, show.show.id.value());
+    put_signed(log_, show.show.movie_id.value());
+    put_signed(log_, show.show.theater_id.value());
+    put_signed(log_, show.show.layout_id);
+    put_signed(log_, show.show.start_time);
+    put_signed(log_, show.show.hall);
+    append_varint(log_, static_cast<std::uint64_t>(show.seat_count));
+    append_varint(log_, show.bookings.size());
+    BookingId last_id = 0;
+    for (const ArchivedBooking& b : show.bookings) {
+        append_varint(log_, b.id - last_id);
+        last_id = b.id;
+        append_varint(log_, b.seats.size());
+        int last_seat = 0;
+        for (int seat : b.seats) {
+            append_varint(log_, static_cast<std::uint64_t>(seat - last_seat));
+            last_seat = seat;
+        }
+    }
+    return true;
+}
+
+bool ColdShowStore::find(ShowId show_id, ArchivedShow& out) const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto pos = std::lower_bound(index_.begin(), index_.end(), show_id,
+                                [](const std::pair<ShowId, std::uint64_t>& e, ShowId id) { return e.first < id; });
+    if (pos == index_.end() || pos->first != show_id) return false;
+
+    const std::uint8_t* p = log_.data() + pos->second;
+    out = ArchivedShow{};
+    out.show.id = ShowId(get_signed(p));
+    out.show.movie_id = MovieId(get_signed(p));
+    out.show.theater_id = TheaterId(get_signed(p));
+    out.show.layout_id = static_cast<LayoutId>(get_signed(p));
+    out.show.start_time = static_cast<ShowTime>(get_signed(p));
+    out.show.hall = static_cast<int>(get_signed(p));
+    out.seat_count = static_cast<int>(get_varint(p));
+    out.bookings.resize(static_cast<std::size_t>(get_varint(p)));
+    BookingId last_id = 0;
+    for (ArchivedBooking& b : out.bookings) {
+        last_id += get_varint(p);
+        b.id = last_id;
+        b.seats.resize(static_cast<std::size_t>(get_varint(p)));
+        int last_seat = 0;
+        for (int& seat : b.seats) {
+            last_seat += static_cast<int>(get_varint(p));
+            seat = last_seat;
+        }
+    }
+    return true;
+}
+
+bool ColdShowStore::contains(ShowId show_id) const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return std::binary_search(index_.begin(), index_.end(), std::pair<ShowId, std::uint64_t>{show_id, 0u},
+                              [](const std::pair<ShowId, std::uint64_t>& a, const std::pair<ShowId, std::uint64_t>& b) {
+                                  return a.first < b.first;
+                              });
+}
+
+std::vector<ShowId> ColdShowStore::ids() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ShowId> out;
+    out.reserve(index_.size());
+    for (const auto& e : index_) out.push_back(e.first);
+    return out;
+}
+
+std::size_t ColdShowStore::booked_words(LayoutId layout_id, ShowTime from, ShowTime to, std::size_t words,
+                                       std::vector<std::uint64_t>& out) const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t shows = 0;
+    const std::uint8_t* p = log_.data();
+    const std::uint8_t* const end = p + log_.size();
+    while (p < end) { // records are back to back in the log
+        for (int field = 0; field < 3; ++field) get_signed(p); // id, movie, theater
+        const auto layout = static_cast<LayoutId>(get_signed(p));
+        const auto start = static_cast<ShowTime>(get_signed(p));
+        get_signed(p); // hall
+        get_varint(p); // seat count
+        const bool counted = layout == layout_id && start >= from && start < to;
+        std::uint64_t* row = nullptr;
+        if (counted) {
+            out.resize(out.size() + words, 0u);
+            row = out.data() + out.size() - words;
+            ++shows;
+        }
+        const std::uint64_t bookings = get_varint(p);
+        for (std::uint64_t b = 0; b < bookings; ++b) {
+            get_varint(p); // booking id delta
+            const std::uint64_t seats = get_varint(p);
+            int seat = 0;
+            for (std::uint64_t i = 0; i < seats; ++i) {
+                seat += static_cast<int>(get_varint(p));
+                const auto w = static_cast<std::size_t>(HallLayout::row_of(seat));
+                if (row && w < words) row[w] |= std::uint64_t{1} << (seat % HallLayout::kMaxRowSeats);
+            }
+        }
+    }
+    return shows;
+}
+
+std::size_t ColdShowStore::size() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return index_.size();
+}
+
+std::size_t ColdShowStore::bytes() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return log_.size();
+}
+
+std::size_t BookingService::archive_shows_before(ShowTime cutoff) {
+    const std::lock_guard<std::mutex> pass(archive_mutex_);
+    // Requests that found a show archived by the previous pass have long finished
+    archive_retired_.clear();
+
+    std::vector<Show> shows;
+    std::vector<ShowState*> states;
+    {
+        const std::lock_guard<std::mutex> lock(catalog_mutex_);
+        const Catalog* c = catalog_.load(std::memory_order_acquire);
+        const ShowColumns& columns = c->shows;
+        std::vector<std::uint32_t> rows;
+        for (std::size_t i = 0; i < columns.size(); ++i) {
+            if (columns.start_times()[i] >= cutoff) continue;
+            rows.push_back(static_cast<std::uint32_t>(i));
+            shows.push_back(columns.row(i, c->movies, c->theaters));
+            states.push_back(get_state_mut(columns.ids()[i]));
+        }
+        if (rows.empty()) return 0;
+        remove_shows_locked(rows);
+    }
+
+    for (std::size_t i = 0; i < shows.size(); ++i) {
+        ShowState* st = states[i];
+        ArchivedShow record;
+        record.show = shows[i];
+        record.seat_count = st->layout->seat_count();
+        on_owner(id_of(*st), [&] {
+            // Held seats were never sold: release them instead of recording them
+            for (std::size_t slot = 0; slot < hold_capacity_; ++slot) {
+                HoldSlot& h = hold_slots_[slot];
+                const std::uint64_t state = h.state.load(std::memory_order_acquire);
+                if ((state & 0xFFFFFFFFu) != kHoldActive || h.show.load(std::memory_order_relaxed) != st) continue;
+                HoldSlot* settled = nullptr;
+                settle_hold((state & ~std::uint64_t{0xFFFFFFFFu}) | slot, kHoldReleased, settled);
+            }
+
+            std::map<BookingId, std::vector<int>> bookings;
+            OwnerRow* rows = st->owners.load(std::memory_order_acquire);
+            const std::atomic<std::uint64_t>* words = st->words();
+            for (int w = 0; rows && w < st->word_count; ++w) {
+                for (std::uint64_t b = words[w].load(); b != 0u; b &= b - 1u) {
+                    const int seat = HallLayout::seat_index(w, ctz64(b));
+                    const BookingId id = owner_of(rows, seat).load(std::memory_order_acquire);
+                    if (id != 0u) bookings[id].push_back(seat);
+                }
+            }
+            for (auto& b : bookings) record.bookings.push_back(ArchivedBooking{b.first, std::move(b.second)});
+            return true;
+        });
+        cold_shows_.add(record);
+
+        if (st->shared()) continue; // words and owners belong to the shared region
+        RetiredShow retired;
+        retired.owners.reset(st->owners.exchange(nullptr, std::memory_order_acq_rel));
+        retired.words = std::move(st->heap_words);
+        archive_retired_.push_back(std::move(retired));
+        if (const RenderedSeats* rendered = st->rendered.exchange(nullptr, std::memory_order_acq_rel)) {
+            retire_rendered(rendered);
+        }
+    }
+    return shows.size();
+}
+
+} // namespace booking
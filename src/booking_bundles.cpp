@@ -0,0 +1,244 @@
+#include "booking_service.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// Bundles: seats of several shows booked all-or-nothing, acquired in show id order with
+// the shows already taken rolled back on the first failure. Bulk plans do the same for
+// many shows at once, acquiring (and rolling back) the shows in parallel.
+
+namespace booking {
+
+namespace {
+
+BookingResult failed_item(BookingResult r, std::size_t item) {
+    r.label_index = static_cast<int>(item);
+    return r;
+}
+
+/** @brief Item positions in ascending show id order (stable: equal shows keep item order). */
+std::vector<std::size_t> show_order(Span<const BundleItem> items) {
+    std::vector<std::size_t> order(items.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return items[a].show_id < items[b].show_id;
+    });
+    return order;
+}
+
+/** @brief One show of a bulk plan: its merged seats and its items (a range of the show order). */
+struct BulkShow {
+    std::size_t first = 0; /**< Position in the show order of its first item. */
+    std::size_t last = 0;  /**< One past its last item. */
+    SeatMask seats;
+};
+
+} // namespace
+
+const char* to_string(BulkPhase phase) {
+    switch (phase) {
+        case BulkPhase::Validated: return "validated";
+        case BulkPhase::Acquiring: return "acquiring";
+        case BulkPhase::RollingBack: return "rolling-back";
+        case BulkPhase::Committed: return "committed";
+    }
+    return "unknown";
+}
+
+BookingResult BookingService::check_bundle(Span<const BundleItem> items, std::vector<ShowState*>& states) {
+    states.assign(items.size(), nullptr);
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        ShowState* st = get_state_mut(items[i].show_id);
+        if (!st) {
+            return failed_item(BookingResult::error(BookingStatus::InvalidShow), i);
+        }
+        const SeatMask& seats = items[i].seats;
+        if (seats.empty()) {
+            return failed_item(BookingResult::error(BookingStatus::NoSeats), i);
+        }
+        for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+            const std::uint64_t valid = w < st->word_count ? st->layout->row_mask(w) : 0u;
+            if ((seats.word(w) & ~valid) != 0u) {
+                return failed_item(BookingResult::error(BookingStatus::InvalidSeatIndex), i);
+            }
+        }
+        states[i] = st;
+    }
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        if (!admit_booker(items[i].show_id)) {
+            return failed_item(BookingResult::error(BookingStatus::Throttled), i);
+        }
+    }
+    return BookingResult::ok();
+}
+
+BookingResult BookingService::book_bundle(Span<const BundleItem> items, Span<BookingId> out_ids) {
+    return measured(MetricsApi::BookBundle, [&] {
+        if (items.empty() || out_ids.size() < items.size()) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+        for (std::size_t i = 0; i < items.size(); ++i) out_ids[i] = 0u;
+
+        // Validate every part before touching a seat
+        std::vector<ShowState*> states;
+        const BookingResult checked = check_bundle(items, states);
+        if (!checked.success) {
+            return checked;
+        }
+
+        // One global order: the lowest conflicting show is the one reported
+        const std::vector<std::size_t> order = show_order(items);
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            const std::size_t i = order[k];
+            ShowState& st = *states[i];
+            const BookingResult part = on_owner(id_of(st), [&] { return book_mask_on(st, items[i].seats); });
+            if (part.success) continue;
+            for (std::size_t prev = k; prev-- > 0;) {
+                ShowState& taken = *states[order[prev]];
+                on_owner(id_of(taken), [&] {
+                    release_mask(taken, items[order[prev]].seats);
+                    notify_waitlist(taken); // requests may have been turned away meanwhile
+                    return BookingResult::ok();
+                });
+            }
+            return failed_item(part, i);
+        }
+
+        // Every part is held: record the owners, then wait once for the journal
+        std::uint64_t commit_lsn = 0;
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            out_ids[i] = on_owner(id_of(*states[i]), [&] { return record_owner(*states[i], items[i].seats, &commit_lsn); });
+        }
+        if (journal_ && journal_->mode() == JournalMode::Sync && commit_lsn != 0u) {
+            journal_->wait_durable(commit_lsn);
+        }
+        BookingResult res = BookingResult::ok();
+        res.id = out_ids[0];
+        return res;
+    });
+}
+
+BookingResult BookingService::book_bulk(Span<const BundleItem> items, Span<BookingId> out_ids,
+                                        const BulkProgress& progress) {
+    return measured(MetricsApi::BookBulk, [&] {
+        if (items.empty() || out_ids.size() < items.size()) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+        for (std::size_t i = 0; i < items.size(); ++i) out_ids[i] = 0u;
+
+        std::vector<ShowState*> states;
+        const BookingResult checked = check_bundle(items, states);
+        if (!checked.success) {
+            return checked;
+        }
+
+        // Merge the parts per show; parts of one show must not share seats and, so that a
+        // plan that already conflicts fails before writing, must find their seats free now
+        const std::vector<std::size_t> order = show_order(items);
+        std::vector<BulkShow> shows;
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            const std::size_t i = order[k];
+            if (k == 0 || items[order[k - 1]].show_id != items[i].show_id) shows.push_back(BulkShow{k, k, SeatMask{}});
+            BulkShow& show = shows.back();
+            const ShowState& st = *states[i];
+            SeatMask taken;
+            for (int w = items[i].seats.first_word(); w < items[i].seats.end_word(); ++w) {
+                const std::uint64_t bits = items[i].seats.word(w);
+                if ((show.seats.word(w) & bits) != 0u) {
+                    return failed_item(BookingResult::error(BookingStatus::DuplicateSeatLabel), i);
+                }
+                show.seats.or_word(w, bits);
+                taken.or_word(w, st.words()[w].load(std::memory_order_relaxed) & bits);
+            }
+            if (!taken.empty()) {
+                return failed_item(BookingResult::conflict(taken), i);
+            }
+            show.last = k + 1;
+        }
+
+        std::mutex progress_mutex;
+        std::size_t progress_done[4] = {};
+        const auto report = [&](BulkPhase phase) {
+            if (!progress) return;
+            const std::lock_guard<std::mutex> lock(progress_mutex);
+            progress(phase, ++progress_done[static_cast<std::size_t>(phase)], shows.size());
+        };
+        if (progress) progress(BulkPhase::Validated, shows.size(), shows.size());
+
+        // Acquire the shows in parallel; once one fails the rest are not started
+        std::vector<BookingResult> parts(shows.size());
+        std::vector<char> held(shows.size(), 0);
+        std::atomic<bool> failed{false};
+        thread_pool().parallel_for(shows.size(), 1u, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t s = begin; s < end && !failed.load(std::memory_order_relaxed); ++s) {
+                ShowState& st = *states[order[shows[s].first]];
+                parts[s] = on_owner(id_of(st), [&] { return book_mask_on(st, shows[s].seats); });
+                held[s] = parts[s].success ? 1 : 0;
+                if (!parts[s].success) failed.store(true, std::memory_order_relaxed);
+                report(BulkPhase::Acquiring);
+            }
+        });
+
+        if (failed.load()) {
+            thread_pool().parallel_for(shows.size(), 1u, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t s = begin; s < end; ++s) {
+                    if (!held[s]) continue;
+                    ShowState& st = *states[order[shows[s].first]];
+                    on_owner(id_of(st), [&] {
+                        release_mask(st, shows[s].seats);
+                        notify_waitlist(st);
+                        return BookingResult::ok();
+                    });
+                    report(BulkPhase::RollingBack);
+                }
+            });
+            // Report the first show that failed, at the part holding its first taken seat
+            for (std::size_t s = 0; s < shows.size(); ++s) {
+                if (held[s] || parts[s].status == BookingStatus::Ok) continue; // held, or never started
+                std::size_t item = order[shows[s].first];
+                for (std::size_t k = shows[s].first; k < shows[s].last; ++k) {
+                    const SeatMask& seats = items[order[k]].seats;
+                    bool hit = false;
+                    for (int w = seats.first_word(); w < seats.end_word() && !hit; ++w) {
+                        hit = (seats.word(w) & parts[s].conflicts.word(w)) != 0u;
+                    }
+                    if (hit) {
+                        item = order[k];
+                        break;
+                    }
+                }
+                return failed_item(parts[s], item);
+            }
+        }
+
+        // Every show is held: record the owners per part, then wait once for the journal
+        std::atomic<std::uint64_t> commit_lsn{0};
+        thread_pool().parallel_for(shows.size(), 1u, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t s = begin; s < end; ++s) {
+                ShowState& st = *states[order[shows[s].first]];
+                std::uint64_t lsn = 0;
+                on_owner(id_of(st), [&] {
+                    for (std::size_t k = shows[s].first; k < shows[s].last; ++k) {
+                        out_ids[order[k]] = record_owner(st, items[order[k]].seats, &lsn);
+                    }
+                    return BookingResult::ok();
+                });
+                std::uint64_t seen = commit_lsn.load(std::memory_order_relaxed);
+                while (lsn > seen && !commit_lsn.compare_exchange_weak(seen, lsn)) {
+                }
+            }
+        });
+        if (journal_ && journal_->mode() == JournalMode::Sync && commit_lsn.load() != 0u) {
+            journal_->wait_durable(commit_lsn.load());
+        }
+        if (progress) progress(BulkPhase::Committed, shows.size(), shows.size());
+        BookingResult res = BookingResult::ok();
+        res.id = out_ids[0];
+        return res;
+    });
+}
+
+} // namespace booking
@@ -0,0 +1,207 @@
+#include "booking_c.h"
+
+#include "booking_service.hpp"
+#include "schedule_loader.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <string>
+
+using booking::BookingResult;
+using booking::BookingService;
+using booking::SeatMask;
+
+/** @brief The opaque handle: the service itself, nothing cached beside it. */
+struct booking_service {
+    booking_service() = default;
+    explicit booking_service(BookingService::EmptyCatalog empty) : service(empty) {}
+
+    BookingService service;
+};
+
+namespace {
+
+static_assert(BOOKING_MASK_WORDS == SeatMask::kWords, "C masks have the words of SeatMask");
+static_assert(static_cast<int>(booking::BookingStatus::Ok) == BOOKING_OK, "statuses keep their C++ values");
+
+/** @brief Runs @p fn, turning any exception into a booking_error. */
+template <typename Fn>
+int guarded(Fn&& fn) noexcept {
+    try {
+        return fn();
+    } catch (const std::bad_alloc&) {
+        return BOOKING_E_NO_MEMORY;
+    } catch (...) {
+        return BOOKING_E_INTERNAL;
+    }
+}
+
+/** @brief Mask of the caller's @p n_words words, or false if they are not a valid array. */
+bool read_mask(const std::uint64_t* words, std::size_t n_words, SeatMask& out) {
+    if (n_words > static_cast<std::size_t>(SeatMask::kWords) || (words == nullptr && n_words != 0u)) return false;
+    for (std::size_t w = 0; w < n_words; ++w) out.or_word(static_cast<int>(w), words[w]);
+    return true;
+}
+
+void write_mask(const SeatMask& mask, std::uint64_t* words, std::size_t n_words) {
+    if (words == nullptr) return;
+    if (n_words > static_cast<std::size_t>(SeatMask::kWords)) n_words = SeatMask::kWords;
+    for (std::size_t w = 0; w < n_words; ++w) words[w] = mask.word(static_cast<int>(w));
+}
+
+/** @brief Copies @p r into @p out (if any) and returns its status as the call's result. */
+int report(const BookingResult& r, booking_result* out) {
+    if (out != nullptr) {
+        out->status = static_cast<std::int32_t>(r.status);
+        out->label_index = r.label_index;
+        out->id = r.id;
+        write_mask(r.conflicts, out->conflicts, BOOKING_MASK_WORDS);
+    }
+    return static_cast<int>(r.status);
+}
+
+} // namespace
+
+extern "C" {
+
+booking_service* booking_service_create(void) { return new (std::nothrow) booking_service(); }
+
+booking_service* booking_service_create_empty(void) {
+    return new (std::nothrow) booking_service(BookingService::EmptyCatalog{});
+}
+
+void booking_service_destroy(booking_service* service) { delete service; }
+
+int booking_load_schedule_file(booking_service* service, const char* path, std::size_t* out_line) {
+    if (out_line != nullptr) *out_line = 0;
+    if (service == nullptr || path == nullptr) return BOOKING_E_ARGUMENT;
+    return guarded([&] {
+        const booking::ScheduleError err = service->service.load_schedule_file(path);
+        if (out_line != nullptr) *out_line = err.line;
+        return static_cast<int>(err.status);
+    });
+}
+
+int64_t booking_find_show(const booking_service* service, int64_t movie_id, int64_t theater_id) {
+    if (service == nullptr) return -1;
+    return service->service.find_show(movie_id, theater_id).value();
+}
+
+int booking_show_rows(const booking_service* service, int64_t show_id) {
+    if (service == nullptr) return BOOKING_E_ARGUMENT;
+    const booking::HallLayout* layout = service->service.layout_for_show(show_id);
+    return layout != nullptr ? layout->row_count() : BOOKING_E_UNKNOWN_SHOW;
+}
+
+int booking_seat_label(const booking_service* service, int64_t show_id, int seat, char* buffer, std::size_t capacity) {
+    if (service == nullptr || buffer == nullptr) return BOOKING_E_ARGUMENT;
+    const booking::HallLayout* layout = service->service.layout_for_show(show_id);
+    if (layout == nullptr) return BOOKING_E_UNKNOWN_SHOW;
+    if (!layout->contains(seat)) return BOOKING_E_ARGUMENT;
+    const std::string_view label = layout->label_view(seat);
+    if (label.size() >= capacity) return BOOKING_E_BUFFER;
+    std::memcpy(buffer, label.data(), label.size());
+    buffer[label.size()] = '\0';
+    return static_cast<int>(label.size());
+}
+
+int booking_available_mask(const booking_service* service, int64_t show_id, std::uint64_t* out_words,
+                           std::size_t n_words) {
+    if (service == nullptr || (out_words == nullptr && n_words != 0u)) return BOOKING_E_ARGUMENT;
+    SeatMask free;
+    const int n = service->service.available_seats_mask(show_id, free);
+    if (n < 0) return BOOKING_E_UNKNOWN_SHOW;
+    write_mask(free, out_words, n_words);
+    return n;
+}
+
+int booking_available_count(const booking_service* service, int64_t show_id) {
+    if (service == nullptr) return BOOKING_E_ARGUMENT;
+    const int n = service->service.available_count(show_id);
+    return n >= 0 ? n : BOOKING_E_UNKNOWN_SHOW;
+}
+
+int booking_available_labels(const booking_service* service, int64_t show_id, char* buffer, std::size_t capacity,
+                             std::size_t* out_length) {
+    if (service == nullptr || (buffer == nullptr && capacity != 0u)) return BOOKING_E_ARGUMENT;
+    return guarded([&] {
+        // One buffer per calling thread: it stops growing once it fits the largest show
+        thread_local std::string text;
+        text.clear();
+        const int n = service->service.append_available_seats(show_id, text);
+        if (n < 0) return static_cast<int>(BOOKING_E_UNKNOWN_SHOW);
+        if (out_length != nullptr) *out_length = text.size();
+        if (text.size() >= capacity) return static_cast<int>(BOOKING_E_BUFFER);
+        std::memcpy(buffer, text.data(), text.size());
+        buffer[text.size()] = '\0';
+        return n;
+    });
+}
+
+int booking_book_mask(booking_service* service, int64_t show_id, const std::uint64_t* words, std::size_t n_words,
+                      booking_result* result) {
+    SeatMask seats;
+    if (service == nullptr || !read_mask(words, n_words, seats)) return BOOKING_E_ARGUMENT;
+    return guarded([&] { return report(service->service.book_seat_mask(show_id, seats), result); });
+}
+
+int booking_book_labels(booking_service* service, int64_t show_id, const char* labels, std::size_t length,
+                        booking_result* result) {
+    if (service == nullptr || (labels == nullptr && length != 0u)) return BOOKING_E_ARGUMENT;
+    return guarded([&] {
+        return report(service->service.book_label_list(show_id, std::string_view(labels, length)), result);
+    });
+}
+
+int booking_book_best_available(booking_service* service, int64_t show_id, int n, std::uint64_t* out_words,
+                                std::size_t n_words, booking_result* result) {
+    if (service == nullptr) return BOOKING_E_ARGUMENT;
+    return guarded([&] {
+        SeatMask seats;
+        const int status = report(service->service.book_best_available(show_id, n, seats), result);
+        write_mask(seats, out_words, n_words);
+        return status;
+    });
+}
+
+int booking_cancel_mask(booking_service* service, int64_t show_id, const std::uint64_t* words, std::size_t n_words,
+                        uint32_t booking_id, booking_result* result) {
+    SeatMask seats;
+    if (service == nullptr || !read_mask(words, n_words, seats)) return BOOKING_E_ARGUMENT;
+    return guarded([&] { return report(service->service.cancel_seat_mask(show_id, seats, booking_id), result); });
+}
+
+int booking_hold_mask(booking_service* service, int64_t show_id, const std::uint64_t* words, std::size_t n_words,
+                      uint32_t ttl_ms, booking_result* result) {
+    SeatMask seats;
+    if (service == nullptr || !read_mask(words, n_words, seats)) return BOOKING_E_ARGUMENT;
+    return guarded([&] {
+        return report(service->service.hold_seat_mask(show_id, seats, std::chrono::milliseconds(ttl_ms)), result);
+    });
+}
+
+int booking_confirm_hold(booking_service* service, uint64_t hold_id, booking_result* result) {
+    if (service == nullptr) return BOOKING_E_ARGUMENT;
+    return guarded([&] { return report(service->service.confirm_hold(hold_id), result); });
+}
+
+int booking_release_hold(booking_service* service, uint64_t hold_id, booking_result* result) {
+    if (service == nullptr) return BOOKING_E_ARGUMENT;
+    return guarded([&] { return report(service->service.release_hold(hold_id), result); });
+}
+
+const char* booking_status_string(int code) {
+    switch (code) {
+        case BOOKING_E_ARGUMENT: return "Invalid argument";
+        case BOOKING_E_BUFFER: return "Buffer too small";
+        case BOOKING_E_UNKNOWN_SHOW: return "Unknown show";
+        case BOOKING_E_NO_MEMORY: return "Out of memory";
+        case BOOKING_E_INTERNAL: return "Internal error";
+        default: break;
+    }
+    if (code < 0 || code > static_cast<int>(booking::BookingStatus::SalesClosed)) return "Unknown status";
+    return booking::to_string(static_cast<booking::BookingStatus>(code));
+}
+
+} // extern "C"
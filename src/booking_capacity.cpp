@@ -0,0 +1,87 @@
+#include "booking_service.hpp"
+
+#include "seat_scan.hpp"
+
+#include <array>
+#include <mutex>
+
+// Theater caps: daily attendance limits across the halls of a theater, enforced with one
+// shared counter per (theater, day) that the seat CAS reserves on (try_acquire_word).
+
+namespace booking {
+
+namespace {
+
+constexpr std::int64_t kSecondsPerDay = 86400;
+
+/** @brief UTC day number of @p t (floor division, so times before the epoch work too). */
+std::int64_t utc_day(ShowTime t) {
+    const std::int64_t day = t / kSecondsPerDay;
+    return t % kSecondsPerDay < 0 ? day - 1 : day;
+}
+
+} // namespace
+
+int BookingService::taken_seats(const ShowState& st) {
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    load_free_words(st, free_words.data());
+    return st.layout->seat_count()
+           - seat_scan::kernels().count_free(free_words.data(), static_cast<std::size_t>(st.word_count));
+}
+
+void BookingService::attach_capacity_locked(const Show& show) {
+    const auto cap = theater_caps_.find(show.theater_id);
+    if (cap == theater_caps_.end() || show_caps_.find(show.id)) return;
+    const ShowState* st = get_state(show.id);
+    if (!st) return;
+    std::unique_ptr<CapacityCounter>& counter = capacity_counters_[{show.theater_id, utc_day(show.start_time)}];
+    if (!counter) counter = std::make_unique<CapacityCounter>(cap->second);
+    show_caps_.emplace(show.id, [&](ShowCap& c) { c.counter = counter.get(); });
+    // Counted once the counter is published: later bookings reserve on it themselves
+    counter->add(taken_seats(*st));
+}
+
+void BookingService::detach_capacity_locked(ShowId show_id) {
+    const ShowCap* cap = show_caps_.find(show_id);
+    if (!cap) return;
+    if (const ShowState* st = get_state(show_id)) cap->counter->release(taken_seats(*st));
+    show_caps_.erase(show_id);
+}
+
+CatalogStatus BookingService::set_theater_daily_cap(TheaterId theater_id, int max_seats) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    const auto slot = c->theater_slots.find(theater_id);
+    if (slot == c->theater_slots.end()) return CatalogStatus::UnknownTheater;
+    const int cap = max_seats < 0 ? CapacityCounter::kUncapped : max_seats;
+
+    const auto [entry, first] = theater_caps_.try_emplace(theater_id, cap);
+    if (!first) {
+        // Already attached: only the limit of the theater's counters changes
+        entry->second = cap;
+        for (auto it = capacity_counters_.lower_bound({theater_id, INT64_MIN});
+             it != capacity_counters_.end() && it->first.first == theater_id; ++it) {
+            it->second->set_cap(cap);
+        }
+        return CatalogStatus::Ok;
+    }
+    caps_on_.store(true, std::memory_order_release);
+    for (std::size_t row = 0; row < c->shows.size(); ++row) {
+        if (c->shows.theater_slots()[row] != slot->second) continue;
+        attach_capacity_locked(c->shows.row(row, c->movies, c->theaters));
+    }
+    return CatalogStatus::Ok;
+}
+
+DailyAttendance BookingService::theater_attendance(TheaterId theater_id, ShowTime at) const {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    DailyAttendance out;
+    const auto cap = theater_caps_.find(theater_id);
+    if (cap == theater_caps_.end()) return out;
+    out.cap = cap->second == CapacityCounter::kUncapped ? -1 : cap->second;
+    const auto counter = capacity_counters_.find({theater_id, utc_day(at)});
+    if (counter != capacity_counters_.end()) out.seats_taken = counter->second->taken();
+    return out;
+}
+
+} // namespace booking
@@ -0,0 +1,746 @@
+#include "booking_service.hpp"
+
+#include "column_scan.hpp"
+#include "geo.hpp"
+#include "request_arena.hpp"
+#include "seat_scan.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+// Catalog: movies, theaters and shows behind an RCU-style snapshot pointer. Readers load
+// the pointer inside an epoch guard; writers copy, update and publish a new snapshot.
+
+namespace booking {
+
+const char* to_string(CatalogStatus status) {
+    switch (status) {
+        case CatalogStatus::Ok: return "Catalog updated";
+        case CatalogStatus::DuplicateId: return "Duplicate id";
+        case CatalogStatus::InvalidId: return "Id out of range";
+        case CatalogStatus::UnknownMovie: return "Unknown movie";
+        case CatalogStatus::UnknownTheater: return "Unknown theater";
+        case CatalogStatus::UnknownLayout: return "Unknown layout";
+        case CatalogStatus::UnknownShow: return "Unknown show";
+        case CatalogStatus::NoSharedRoom: return "No room in the shared seat region";
+        case CatalogStatus::OverQuota: return "Show quota exceeded";
+    }
+    return "Unknown status";
+}
+
+namespace {
+
+/** @brief Order of Catalog::shows_by_time: start time, then show id. */
+bool starts_before(const Show& a, const Show& b) {
+    return a.start_time != b.start_time ? a.start_time < b.start_time : a.id < b.id;
+}
+
+/** @brief The shows of sorted @p list that start in [from, to), as a sub-span. */
+Span<const Show> time_range(const std::vector<Show>& list, ShowTime from, ShowTime to) {
+    const auto first = std::lower_bound(list.begin(), list.end(), from,
+                                        [](const Show& s, ShowTime t) { return s.start_time < t; });
+    const auto last = std::lower_bound(first, list.end(), to,
+                                       [](const Show& s, ShowTime t) { return s.start_time < t; });
+    return Span<const Show>(list.data() + (first - list.begin()), static_cast<std::size_t>(last - first));
+}
+
+/** @brief Appends the shows of sorted @p list that start in [from, to). */
+void append_range(const std::vector<Show>& list, ShowTime from, ShowTime to, std::vector<Show>& out) {
+    const Span<const Show> range = time_range(list, from, to);
+    out.insert(out.end(), range.begin(), range.end());
+}
+
+/** @brief Adds a located theater to the location grid. */
+void index_location(std::unordered_map<std::uint32_t, std::vector<TheaterId>>& grid, const Theater& t) {
+    if (t.has_location()) grid[geo_cell_key(geo_lat_cell(t.latitude), geo_lon_cell(t.longitude))].push_back(t.id);
+}
+
+} // namespace
+
+void ShowColumns::reserve(std::size_t n) {
+    ids_.reserve(n);
+    positions_.reserve(n);
+    movie_slots_.reserve(n);
+    theater_slots_.reserve(n);
+    layout_ids_.reserve(n);
+    start_times_.reserve(n);
+    halls_.reserve(n);
+}
+
+void ShowColumns::push_back(const Show& show, int position, std::int32_t movie_slot, std::int32_t theater_slot) {
+    ids_.push_back(show.id);
+    positions_.push_back(position);
+    movie_slots_.push_back(movie_slot);
+    theater_slots_.push_back(theater_slot);
+    layout_ids_.push_back(show.layout_id);
+    start_times_.push_back(show.start_time);
+    halls_.push_back(show.hall);
+}
+
+void ShowColumns::erase(std::size_t row) {
+    const auto at = static_cast<std::ptrdiff_t>(row);
+    ids_.erase(ids_.begin() + at);
+    positions_.erase(positions_.begin() + at);
+    movie_slots_.erase(movie_slots_.begin() + at);
+    theater_slots_.erase(theater_slots_.begin() + at);
+    layout_ids_.erase(layout_ids_.begin() + at);
+    start_times_.erase(start_times_.begin() + at);
+    halls_.erase(halls_.begin() + at);
+}
+
+void ShowColumns::erase_rows(const std::vector<std::uint32_t>& rows) {
+    if (rows.empty()) return;
+    std::size_t out = rows.front();
+    std::size_t next = 0;
+    for (std::size_t in = rows.front(); in < ids_.size(); ++in) {
+        if (next < rows.size() && rows[next] == in) {
+            ++next;
+            continue;
+        }
+        ids_[out] = ids_[in];
+        positions_[out] = positions_[in];
+        movie_slots_[out] = movie_slots_[in];
+        theater_slots_[out] = theater_slots_[in];
+        layout_ids_[out] = layout_ids_[in];
+        start_times_[out] = start_times_[in];
+        halls_[out] = halls_[in];
+        ++out;
+    }
+    ids_.resize(out);
+    positions_.resize(out);
+    movie_slots_.resize(out);
+    theater_slots_.resize(out);
+    layout_ids_.resize(out);
+    start_times_.resize(out);
+    halls_.resize(out);
+}
+
+Show ShowColumns::row(std::size_t row, const std::vector<Movie>& movies, const std::vector<Theater>& theaters) const {
+    return Show{ids_[row],
+                movies[static_cast<std::size_t>(movie_slots_[row])].id,
+                theaters[static_cast<std::size_t>(theater_slots_[row])].id,
+                layout_ids_[row],
+                start_times_[row],
+                halls_[row]};
+}
+
+void ShowColumns::relocate(std::size_t row, LayoutId layout_id, int hall) {
+    layout_ids_[row] = layout_id;
+    halls_[row] = hall;
+}
+
+std::size_t ShowColumns::find(int position) const {
+    if (position < 0) return size();
+    return column_scan::kernels().find_eq(positions_.data(), positions_.size(), position);
+}
+
+void ShowColumns::select(std::int32_t movie_slot, ShowTime from, ShowTime to, std::vector<std::uint32_t>& rows) const {
+    const column_scan::Kernels& k = column_scan::kernels();
+    std::vector<std::uint64_t> bits(column_scan::bitmap_words(size()));
+    k.match_eq(movie_slots_.data(), size(), movie_slot, bits.data());
+    k.and_range(start_times_.data(), size(), from, to, bits.data());
+    for (std::size_t w = 0; w < bits.size(); ++w) {
+        for (std::uint64_t b = bits[w]; b != 0u; b &= b - 1u) {
+            rows.push_back(static_cast<std::uint32_t>(w * 64u + static_cast<std::size_t>(__builtin_ctzll(b))));
+        }
+    }
+}
+
+template <typename Update>
+CatalogStatus BookingService::update_catalog(Update&& update) {
+    const Catalog* current = catalog_.load(std::memory_order_relaxed); // only writers store it
+    auto next = std::make_unique<Catalog>(*current);
+    const CatalogStatus status = update(*next);
+    if (status != CatalogStatus::Ok) return status;
+
+    catalog_.store(next.release());
+    ++catalog_generation_;
+    catalog_epochs_.retire(current);
+    return CatalogStatus::Ok;
+}
+
+CatalogStatus BookingService::add_movie(const Movie& movie) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    return update_catalog([&](Catalog& c) {
+        if (!c.movie_slots.emplace(movie.id, static_cast<std::int32_t>(c.movies.size())).second) {
+            return CatalogStatus::DuplicateId;
+        }
+        c.movies.push_back(Movie{movie.id, strings_.intern(movie.title)});
+        auto titles = std::make_shared<TitleIndex>(*c.titles);
+        titles->add(c.movies.back().title);
+        c.titles = std::move(titles);
+        return CatalogStatus::Ok;
+    });
+}
+
+CatalogStatus BookingService::add_theater(const Theater& theater) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    return update_catalog([&](Catalog& c) {
+        if (!c.theater_slots.emplace(theater.id, static_cast<std::int32_t>(c.theaters.size())).second) {
+            return CatalogStatus::DuplicateId;
+        }
+        Theater stored = theater;
+        stored.name = strings_.intern(theater.name);
+        c.theaters.push_back(stored);
+        index_location(c.theater_grid, stored);
+        return CatalogStatus::Ok;
+    });
+}
+
+LayoutId BookingService::add_layout(HallLayout layout) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    return layouts_.intern(std::move(layout));
+}
+
+CatalogStatus BookingService::add_show(const Show& show) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    if (!show_state_.accepts(show.id)) return CatalogStatus::InvalidId;
+    // An archived show keeps its id: its (unlinked) state may still be in use
+    if (!show_state_.available(show.id) || cold_shows_.contains(show.id)) return CatalogStatus::DuplicateId;
+    if (!layouts_.contains(show.layout_id)) return CatalogStatus::UnknownLayout;
+    const HallLayout& layout = layouts_.at(show.layout_id);
+    SharedSeatRegion::Block block;
+    if (shared_seats_) {
+        block = claim_shared(show.id, layout); // idempotent: a failed update may retry
+        if (!block.words) return CatalogStatus::NoSharedRoom;
+    }
+
+    return update_catalog([&](Catalog& c) {
+        const auto movie = c.movie_slots.find(show.movie_id);
+        if (movie == c.movie_slots.end()) return CatalogStatus::UnknownMovie;
+        const auto theater_slot = c.theater_slots.find(show.theater_id);
+        if (theater_slot == c.theater_slots.end()) return CatalogStatus::UnknownTheater;
+        const Theater* theater = &c.theaters[static_cast<std::size_t>(theater_slot->second)];
+
+        // Booking state first: a published show id always has its state (and position)
+        show_state_.emplace(show.id, [&](ShowState& st) {
+            const int position = show_state_.position(show.id);
+            if (block.words) {
+                st.init_shared(position, layout, block);
+            } else {
+                st.init(position, layout);
+            }
+        });
+        if (sales_) sales_->set_show_movie(show.id, show.movie_id);
+        if (views_) view_show(*views_, show.id, show.movie_id);
+        if (SeatRunSummary* runs = run_summary_.load(std::memory_order_relaxed)) {
+            note_all_runs(*get_state(show.id));
+            runs->list(show_state_.position(show.id));
+        }
+        if (!theater_caps_.empty()) attach_capacity_locked(show);
+        c.shows.push_back(show, show_state_.position(show.id), movie->second, theater_slot->second);
+        const ShowPair key = show_key(show.movie_id, show.theater_id);
+        std::vector<ShowId>& pair_shows = c.show_index[key];
+        pair_shows.push_back(show.id);
+        std::vector<Show>& timed = c.shows_by_time[key];
+        timed.insert(std::upper_bound(timed.begin(), timed.end(), show, starts_before), show);
+        theater_times_.insert(show);
+
+        // First show of this (movie, theater) pair: insert the theater into the movie's sorted list
+        if (pair_shows.size() == 1u) {
+            std::vector<Theater>& list = c.theaters_by_movie[show.movie_id];
+            auto pos = std::lower_bound(list.begin(), list.end(), theater->id,
+                                        [](const Theater& t, TheaterId id) { return t.id < id; });
+            list.insert(pos, *theater);
+        }
+        return CatalogStatus::Ok;
+    });
+}
+
+void BookingService::unindex_show(Catalog& c, ShowId show_id, MovieId movie_id, TheaterId theater_id) {
+    const ShowPair key = show_key(movie_id, theater_id);
+    auto timed = c.shows_by_time.find(key);
+    const auto entry = std::find_if(timed->second.begin(), timed->second.end(),
+                                    [&](const Show& s) { return s.id == show_id; });
+    theater_times_.erase(*entry);
+    timed->second.erase(entry);
+    auto pair = c.show_index.find(key);
+    std::vector<ShowId>& pair_shows = pair->second;
+    pair_shows.erase(std::find(pair_shows.begin(), pair_shows.end(), show_id));
+    if (!pair_shows.empty()) return;
+
+    // Last show of the pair: the theater no longer shows this movie
+    c.show_index.erase(pair);
+    c.shows_by_time.erase(timed);
+    auto movie = c.theaters_by_movie.find(movie_id);
+    std::vector<Theater>& list = movie->second;
+    list.erase(std::find_if(list.begin(), list.end(), [&](const Theater& t) { return t.id == theater_id; }));
+    if (list.empty()) c.theaters_by_movie.erase(movie);
+}
+
+CatalogStatus BookingService::remove_show(ShowId show_id) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    return update_catalog([&](Catalog& c) {
+        const std::size_t row = c.shows.find(show_state_.position(show_id));
+        if (row == c.shows.size()) return CatalogStatus::UnknownShow;
+        const Show show = c.shows.row(row, c.movies, c.theaters);
+        c.shows.erase(row);
+        unindex_show(c, show_id, show.movie_id, show.theater_id);
+        if (views_) views_->remove_show(show_id);
+        if (SeatRunSummary* runs = run_summary_.load(std::memory_order_relaxed)) {
+            runs->list(show_state_.position(show_id), false);
+        }
+        return CatalogStatus::Ok;
+    });
+}
+
+void BookingService::relocate_show_locked(ShowId show_id, LayoutId layout_id, int hall) {
+    update_catalog([&](Catalog& c) {
+        const std::size_t row = c.shows.find(show_state_.position(show_id));
+        if (row == c.shows.size()) return CatalogStatus::UnknownShow;
+        c.shows.relocate(row, layout_id, hall);
+        const Show show = c.shows.row(row, c.movies, c.theaters);
+        for (Show& timed : c.shows_by_time[show_key(show.movie_id, show.theater_id)]) {
+            if (timed.id == show_id) timed = show;
+        }
+        theater_times_.replace(show);
+        return CatalogStatus::Ok;
+    });
+}
+
+void BookingService::remove_shows_locked(const std::vector<std::uint32_t>& rows) {
+    if (rows.empty()) return;
+    std::vector<ShowId> ids;
+    ids.reserve(rows.size());
+    update_catalog([&](Catalog& c) {
+        for (std::uint32_t row : rows) {
+            const Show show = c.shows.row(row, c.movies, c.theaters);
+            ids.push_back(show.id);
+            unindex_show(c, show.id, show.movie_id, show.theater_id);
+            if (SeatRunSummary* runs = run_summary_.load(std::memory_order_relaxed)) {
+                runs->list(show_state_.position(show.id), false);
+            }
+        }
+        c.shows.erase_rows(rows);
+        return CatalogStatus::Ok;
+    });
+    // Unpublished from the catalog first, so find_show can no longer return them
+    state_epoch_.fetch_add(1, std::memory_order_acq_rel); // handles taken so far look their show up again
+    for (ShowId id : ids) {
+        if (views_) views_->remove_show(id);
+        detach_capacity_locked(id);
+        if (HeldWords* held = held_words_.find(id)) {
+            for (std::atomic<std::uint64_t>& row : held->rows) row.store(0u, std::memory_order_relaxed);
+        }
+        show_state_.erase(id);
+    }
+}
+
+ScheduleError BookingService::load_schedule_file(const std::string& path, unsigned threads) {
+    MappedFile file(path);
+    if (!file.ok()) {
+        return ScheduleError{ScheduleStatus::IoError, 0, "cannot open or map the file"};
+    }
+    Schedule schedule;
+    const ScheduleError parsed = parse_schedule(file.view(), threads, schedule, &thread_pool());
+    if (parsed.status != ScheduleStatus::Ok) return parsed;
+    return load_schedule(std::move(schedule));
+}
+
+namespace {
+
+ScheduleError catalog_error(const char* reason) {
+    return ScheduleError{ScheduleStatus::CatalogError, 0, reason};
+}
+
+} // namespace
+
+ScheduleError BookingService::load_schedule(Schedule schedule) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    return load_schedule_locked(schedule, nullptr);
+}
+
+ScheduleError BookingService::apply_schedule_batch(Schedule additions, Span<const ShowId> removals) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    return load_schedule_locked(additions, nullptr, removals);
+}
+
+ScheduleError BookingService::load_schedule_locked(Schedule& schedule, const ShowRestore& restore,
+                                                   Span<const ShowId> removals) {
+    const Catalog* current = catalog_.load(std::memory_order_relaxed);
+
+    std::vector<std::uint32_t> removed_rows;
+    removed_rows.reserve(removals.size());
+    for (ShowId id : removals) {
+        const std::size_t row = current->shows.find(show_state_.position(id));
+        if (row == current->shows.size()) return catalog_error("removal of a show not in the catalog");
+        removed_rows.push_back(static_cast<std::uint32_t>(row));
+    }
+    std::sort(removed_rows.begin(), removed_rows.end());
+    if (std::adjacent_find(removed_rows.begin(), removed_rows.end()) != removed_rows.end()) {
+        return catalog_error("show removed twice");
+    }
+
+    // Validate everything before touching any state; the slots are those of the new snapshot
+    std::unordered_map<MovieId, std::int32_t> movie_slots = current->movie_slots;
+    movie_slots.reserve(current->movies.size() + schedule.movies.size());
+    for (std::size_t i = 0; i < schedule.movies.size(); ++i) {
+        const auto slot = static_cast<std::int32_t>(current->movies.size() + i);
+        if (!movie_slots.emplace(schedule.movies[i].id, slot).second) return catalog_error("duplicate movie id");
+    }
+
+    std::unordered_map<TheaterId, std::int32_t> theater_slots = current->theater_slots;
+    theater_slots.reserve(current->theaters.size() + schedule.theaters.size());
+    for (std::size_t i = 0; i < schedule.theaters.size(); ++i) {
+        const auto slot = static_cast<std::int32_t>(current->theaters.size() + i);
+        if (!theater_slots.emplace(schedule.theaters[i].id, slot).second) return catalog_error("duplicate theater id");
+    }
+
+    std::unordered_map<int, std::size_t> layout_index; // file-local id -> index into schedule.layouts
+    layout_index.reserve(schedule.layouts.size());
+    for (std::size_t i = 0; i < schedule.layouts.size(); ++i) {
+        if (!layout_index.emplace(schedule.layouts[i].id, i).second) return catalog_error("duplicate layout id");
+    }
+
+    std::unordered_set<ShowId> new_show_ids;
+    new_show_ids.reserve(schedule.shows.size());
+    std::size_t new_sparse = 0;
+    for (const ScheduleShow& s : schedule.shows) {
+        if (!show_state_.accepts(s.id)) return catalog_error("show id out of range");
+        if (s.id.value() >= ShowTable<ShowState>::kMaxId && show_state_.position(s.id) < 0
+            && show_state_.sparse_count() + ++new_sparse > static_cast<std::size_t>(ShowTable<ShowState>::kMaxSparse)) {
+            return catalog_error("too many sparse show ids");
+        }
+        if (!show_state_.available(s.id) || cold_shows_.contains(s.id) || !new_show_ids.insert(s.id).second) {
+            return catalog_error("duplicate show id");
+        }
+        if (movie_slots.count(s.movie_id) == 0u) return catalog_error("show references an unknown movie");
+        if (theater_slots.count(s.theater_id) == 0u) return catalog_error("show references an unknown theater");
+        if (layout_index.count(s.layout_id) == 0u) return catalog_error("show references an unknown layout");
+    }
+    std::vector<SharedSeatRegion::Block> blocks;
+    if (shared_seats_) {
+        blocks.reserve(schedule.shows.size());
+        for (const ScheduleShow& s : schedule.shows) {
+            blocks.push_back(claim_shared(s.id, schedule.layouts[layout_index[s.layout_id]].layout));
+            if (!blocks.back().words) return catalog_error("no room for the show in the shared seat region");
+        }
+    }
+
+    // Build the new snapshot in one pass, removals first
+    auto next = std::make_unique<Catalog>(*current);
+    for (std::uint32_t row : removed_rows) {
+        const Show show = next->shows.row(row, next->movies, next->theaters);
+        unindex_show(*next, show.id, show.movie_id, show.theater_id);
+        if (views_) views_->remove_show(show.id);
+        if (SeatRunSummary* runs = run_summary_.load(std::memory_order_relaxed)) {
+            runs->list(show_state_.position(show.id), false);
+        }
+    }
+    next->shows.erase_rows(removed_rows);
+    next->movie_slots = std::move(movie_slots);
+    next->theater_slots = std::move(theater_slots);
+    next->movies.reserve(next->movies.size() + schedule.movies.size());
+    for (const ScheduleMovie& m : schedule.movies) next->movies.push_back(Movie{m.id, strings_.intern(m.title)});
+    if (!schedule.movies.empty()) {
+        std::vector<std::string_view> new_titles;
+        new_titles.reserve(schedule.movies.size());
+        for (std::size_t i = next->movies.size() - schedule.movies.size(); i < next->movies.size(); ++i) {
+            new_titles.push_back(next->movies[i].title);
+        }
+        auto titles = std::make_shared<TitleIndex>(*next->titles);
+        titles->add(new_titles);
+        next->titles = std::move(titles);
+    }
+    next->theaters.reserve(next->theaters.size() + schedule.theaters.size());
+    for (const ScheduleTheater& t : schedule.theaters) {
+        next->theaters.push_back(Theater{t.id, strings_.intern(t.name), t.latitude, t.longitude});
+        index_location(next->theater_grid, next->theaters.back());
+    }
+    // Halls sharing a layout (with each other or with earlier shows) share one registry entry
+    std::vector<LayoutId> layout_ids;
+    layout_ids.reserve(schedule.layouts.size());
+    for (ScheduleLayout& l : schedule.layouts) layout_ids.push_back(layouts_.intern(std::move(l.layout)));
+
+    next->shows.reserve(next->shows.size() + schedule.shows.size());
+    next->show_index.reserve(next->show_index.size() + schedule.shows.size());
+    std::unordered_set<MovieId> touched_movies;
+    std::unordered_set<ShowPair, ShowPairHash> touched_pairs;
+    for (std::size_t i = 0; i < schedule.shows.size(); ++i) {
+        const ScheduleShow& s = schedule.shows[i];
+        const Show show{s.id, s.movie_id, s.theater_id, layout_ids[layout_index[s.layout_id]], s.start_time, s.hall};
+        const HallLayout& layout = layouts_.at(show.layout_id);
+        show_state_.emplace(show.id, [&](ShowState& st) {
+            const int position = show_state_.position(show.id);
+            if (shared_seats_) {
+                st.init_shared(position, layout, blocks[i]);
+            } else {
+                st.init(position, layout);
+            }
+            if (restore) restore(i, st);
+        });
+        if (sales_) sales_->set_show_movie(show.id, show.movie_id);
+        if (views_) view_show(*views_, show.id, show.movie_id);
+        if (SeatRunSummary* runs = run_summary_.load(std::memory_order_relaxed)) {
+            note_all_runs(*get_state(show.id));
+            runs->list(show_state_.position(show.id));
+        }
+        if (!theater_caps_.empty()) attach_capacity_locked(show);
+
+        const std::int32_t theater_slot = next->theater_slots[show.theater_id];
+        next->shows.push_back(show, show_state_.position(show.id), next->movie_slots[show.movie_id], theater_slot);
+        const ShowPair key = show_key(show.movie_id, show.theater_id);
+        std::vector<ShowId>& pair_shows = next->show_index[key];
+        pair_shows.push_back(show.id);
+        next->shows_by_time[key].push_back(show);
+        theater_times_.insert(show);
+        touched_pairs.insert(key);
+        if (pair_shows.size() == 1u) {
+            next->theaters_by_movie[show.movie_id].push_back(next->theaters[static_cast<std::size_t>(theater_slot)]);
+            touched_movies.insert(show.movie_id);
+        }
+    }
+    // Appended theaters are sorted once per movie instead of on every insert
+    for (MovieId m : touched_movies) {
+        std::vector<Theater>& list = next->theaters_by_movie[m];
+        std::sort(list.begin(), list.end(), [](const Theater& a, const Theater& b) { return a.id < b.id; });
+    }
+    for (const ShowPair& key : touched_pairs) {
+        std::vector<Show>& timed = next->shows_by_time[key];
+        std::sort(timed.begin(), timed.end(), starts_before);
+    }
+
+    catalog_.store(next.release());
+    ++catalog_generation_;
+    catalog_epochs_.retire(current);
+    return ScheduleError{};
+}
+
+std::vector<Movie> BookingService::list_movies() const {
+    EpochManager::Guard guard(catalog_epochs_);
+    return catalog_.load(std::memory_order_acquire)->movies;
+}
+
+std::size_t BookingService::show_count() const {
+    EpochManager::Guard guard(catalog_epochs_);
+    return catalog_.load(std::memory_order_acquire)->shows.size();
+}
+
+std::vector<Movie> BookingService::search_movies(std::string_view query, std::size_t limit) const {
+    EpochManager::Guard guard(catalog_epochs_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    std::vector<Movie> out;
+    for (const TitleIndex::Match& m : c->titles->search(query, limit)) {
+        out.push_back(c->movies[static_cast<std::size_t>(m.slot)]);
+    }
+    return out;
+}
+
+Page<Movie> BookingService::list_movies_page(std::uint64_t cursor, std::size_t limit) const {
+    EpochManager::Guard guard(catalog_epochs_);
+    const std::vector<Movie>& movies = catalog_.load(std::memory_order_acquire)->movies;
+    Page<Movie> page;
+    page.next_cursor = cursor;
+    if (cursor >= movies.size()) return page;
+    const auto first = static_cast<std::size_t>(cursor);
+    const std::size_t last = first + std::min(limit, movies.size() - first);
+    page.items.assign(movies.begin() + static_cast<std::ptrdiff_t>(first),
+                      movies.begin() + static_cast<std::ptrdiff_t>(last));
+    page.more = last < movies.size();
+    page.next_cursor = last;
+    return page;
+}
+
+BookingService::CatalogView BookingService::catalog_view() const { return CatalogView(*this); }
+
+BookingService::CatalogView::CatalogView(const BookingService& service)
+    : guard_(service.catalog_epochs_), catalog_(service.catalog_.load(std::memory_order_acquire)) {}
+
+Span<const Movie> BookingService::CatalogView::movies() const { return catalog_->movies; }
+
+Span<const Theater> BookingService::CatalogView::theaters() const { return catalog_->theaters; }
+
+Span<const Theater> BookingService::CatalogView::theaters_for_movie(MovieId movie_id) const {
+    auto it = catalog_->theaters_by_movie.find(movie_id);
+    if (it == catalog_->theaters_by_movie.end()) return {};
+    return it->second;
+}
+
+Span<const Show> BookingService::CatalogView::shows_between(MovieId movie_id, TheaterId theater_id, ShowTime from,
+                                                           ShowTime to) const {
+    auto it = catalog_->shows_by_time.find(show_key(movie_id, theater_id));
+    if (it == catalog_->shows_by_time.end()) return {};
+    return time_range(it->second, from, to);
+}
+
+std::vector<Theater> BookingService::list_theaters_for_movie(MovieId movie_id) const {
+    // Single lookup in the inverted index; the list is kept sorted by theater id on insert
+    EpochManager::Guard guard(catalog_epochs_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    auto it = c->theaters_by_movie.find(movie_id);
+    if (it == c->theaters_by_movie.end()) return {};
+    return it->second;
+}
+
+Page<Theater> BookingService::list_theaters_for_movie_page(MovieId movie_id, std::uint64_t cursor,
+                                                          std::size_t limit) const {
+    EpochManager::Guard guard(catalog_epochs_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    Page<Theater> page;
+    page.next_cursor = cursor;
+    auto it = c->theaters_by_movie.find(movie_id);
+    if (it == c->theaters_by_movie.end()) return page;
+    const std::vector<Theater>& list = it->second;
+    // Ids are resumed from rather than positions, so a theater added or removed between pages shifts nothing
+    const auto first = std::lower_bound(list.begin(), list.end(), cursor, [](const Theater& t, std::uint64_t id) {
+        return static_cast<std::uint64_t>(t.id.value()) < id;
+    });
+    const auto last = first + static_cast<std::ptrdiff_t>(std::min(limit, static_cast<std::size_t>(list.end() - first)));
+    page.items.assign(first, last);
+    page.more = last != list.end();
+    page.next_cursor = page.more       ? static_cast<std::uint64_t>(last->id.value())
+                       : first != last ? static_cast<std::uint64_t>((last - 1)->id.value()) + 1u
+                                       : cursor;
+    return page;
+}
+
+std::vector<Theater> BookingService::list_theaters_for_movie(MovieId movie_id, double latitude, double longitude,
+                                                           double radius_km) const {
+    std::vector<Theater> out;
+    if (!(radius_km >= 0.0) || std::isnan(latitude) || std::isnan(longitude)) return out;
+    EpochManager::Guard guard(catalog_epochs_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    auto it = c->theaters_by_movie.find(movie_id);
+    if (it == c->theaters_by_movie.end()) return out;
+    const std::vector<Theater>& list = it->second;
+
+    const GeoCellRange cells = geo_cells_within(latitude, longitude, radius_km);
+
+    std::vector<std::pair<double, std::size_t>> hits; // (distance, index in list)
+    const auto consider = [&](std::size_t index) {
+        const Theater& t = list[index];
+        if (!t.has_location()) return;
+        const double d = distance_km(latitude, longitude, t.latitude, t.longitude);
+        if (d <= radius_km) hits.emplace_back(d, index);
+    };
+    if (cells.size() >= list.size()) {
+        for (std::size_t i = 0; i < list.size(); ++i) consider(i);
+    } else {
+        for (int lat_cell = cells.lat_first; lat_cell <= cells.lat_last; ++lat_cell) {
+            for (int k = 0; k < cells.lon_count; ++k) {
+                auto cell = c->theater_grid.find(geo_cell_key(lat_cell, (cells.lon_first + k) % kGeoLonCells));
+                if (cell == c->theater_grid.end()) continue;
+                for (TheaterId id : cell->second) {
+                    auto pos = std::lower_bound(list.begin(), list.end(), id,
+                                                [](const Theater& t, TheaterId v) { return t.id < v; });
+                    if (pos != list.end() && pos->id == id) consider(static_cast<std::size_t>(pos - list.begin()));
+                }
+            }
+        }
+    }
+    // Ties by index = ties by theater id (the list is sorted by id)
+    std::sort(hits.begin(), hits.end());
+    out.reserve(hits.size());
+    for (const auto& h : hits) out.push_back(list[h.second]);
+    return out;
+}
+
+ShowId BookingService::find_show(MovieId movie_id, TheaterId theater_id) const {
+    EpochManager::Guard guard(catalog_epochs_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    auto it = c->show_index.find(show_key(movie_id, theater_id));
+    if (it == c->show_index.end()) return ShowId::invalid();
+    return it->second.front(); // entries are never left empty
+}
+
+std::vector<ShowId> BookingService::find_shows(MovieId movie_id, TheaterId theater_id) const {
+    EpochManager::Guard guard(catalog_epochs_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    auto it = c->show_index.find(show_key(movie_id, theater_id));
+    if (it == c->show_index.end()) return {};
+    return it->second;
+}
+
+std::vector<Show> BookingService::find_shows_between(MovieId movie_id, TheaterId theater_id, ShowTime from,
+                                                    ShowTime to) const {
+    std::vector<Show> out;
+    EpochManager::Guard guard(catalog_epochs_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    auto it = c->shows_by_time.find(show_key(movie_id, theater_id));
+    if (it != c->shows_by_time.end()) append_range(it->second, from, to, out);
+    return out;
+}
+
+std::vector<Show> BookingService::find_shows_between(MovieId movie_id, Span<const TheaterId> theater_ids,
+                                                    ShowTime from, ShowTime to) const {
+    std::vector<TheaterId> theaters(theater_ids.begin(), theater_ids.end());
+    std::sort(theaters.begin(), theaters.end());
+    theaters.erase(std::unique(theaters.begin(), theaters.end()), theaters.end());
+
+    std::vector<Show> out;
+    EpochManager::Guard guard(catalog_epochs_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    for (TheaterId theater_id : theaters) {
+        auto it = c->shows_by_time.find(show_key(movie_id, theater_id));
+        if (it == c->shows_by_time.end()) continue;
+        // Each appended range is sorted: merge it into the sorted prefix
+        const std::ptrdiff_t mid = static_cast<std::ptrdiff_t>(out.size());
+        append_range(it->second, from, to, out);
+        std::inplace_merge(out.begin(), out.begin() + mid, out.end(), starts_before);
+    }
+    return out;
+}
+
+std::vector<Show> BookingService::find_theater_shows_between(TheaterId theater_id, ShowTime from,
+                                                            ShowTime to) const {
+    std::vector<Show> out;
+    EpochManager::Guard guard(catalog_epochs_);
+    theater_times_.scan(theater_id, from, to, [&](const Show& show) { out.push_back(show); });
+    return out;
+}
+
+std::vector<Show> BookingService::find_movie_shows_between(MovieId movie_id, ShowTime from, ShowTime to) const {
+    std::vector<Show> out;
+    std::vector<std::uint32_t> rows;
+    {
+        EpochManager::Guard guard(catalog_epochs_);
+        const Catalog* c = catalog_.load(std::memory_order_acquire);
+        const auto movie = c->movie_slots.find(movie_id);
+        if (movie == c->movie_slots.end()) return out;
+        c->shows.select(movie->second, from, to, rows);
+        out.reserve(rows.size());
+        for (std::uint32_t r : rows) out.push_back(c->shows.row(r, c->movies, c->theaters));
+    }
+    std::sort(out.begin(), out.end(), starts_before);
+    return out;
+}
+
+std::size_t BookingService::movie_showtimes(MovieId movie_id, ShowTime from, ShowTime to,
+                                            std::vector<ShowAvailability>& out) const {
+    const std::size_t first = out.size();
+    EpochManager::Guard guard(catalog_epochs_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    const auto movie = c->movie_slots.find(movie_id);
+    if (movie == c->movie_slots.end()) return 0;
+
+    const ShowColumns& shows = c->shows;
+    const column_scan::Kernels& k = column_scan::kernels();
+    RequestArena::Scope scratch(RequestArena::local());
+    std::pmr::vector<std::uint64_t> bits(column_scan::bitmap_words(shows.size()), scratch.resource());
+    k.match_eq(shows.movie_slots().data(), shows.size(), movie->second, bits.data());
+    k.and_range(shows.start_times().data(), shows.size(), from, to, bits.data());
+
+    const seat_scan::Kernels& count = seat_scan::kernels();
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    for (std::size_t w = 0; w < bits.size(); ++w) {
+        for (std::uint64_t b = bits[w]; b != 0u; b &= b - 1u) {
+            const std::size_t row = w * 64u + static_cast<std::size_t>(__builtin_ctzll(b));
+            const ShowState* st = get_state(shows.ids()[row]);
+            if (!st) continue; // removed after this snapshot was published
+            load_read_words(*st, free_words.data());
+            const Theater& theater = c->theaters[static_cast<std::size_t>(shows.theater_slots()[row])];
+            out.push_back(ShowAvailability{shows.ids()[row], theater.id, theater.name, shows.start_times()[row],
+                                           shows.halls()[row],
+                                           count.count_free(free_words.data(), static_cast<std::size_t>(st->word_count)),
+                                           st->layout->seat_count()});
+        }
+    }
+    std::sort(out.begin() + static_cast<std::ptrdiff_t>(first), out.end(),
+              [](const ShowAvailability& a, const ShowAvailability& b) {
+                  return a.start_time != b.start_time ? a.start_time < b.start_time : a.show_id < b.show_id;
+              });
+    return out.size() - first;
+}
+
+} // namespace booking
@@ -0,0 +1,93 @@
+#include "booking_service.hpp"
+
+#include <string>
+
+// Idempotent bookings: a request id seen before within the dedupe TTL is answered with the
+// outcome of its first run.
+
+namespace booking {
+
+namespace {
+
+constexpr std::uint64_t kFnvOffset = 0xcbf29ce484222325u;
+constexpr std::uint64_t kFnvPrime = 0x100000001b3u;
+
+void mix(std::uint64_t& h, std::uint64_t v) {
+    h = (h ^ v) * kFnvPrime;
+}
+
+std::uint64_t request_fingerprint(ShowId show_id, const SeatMask& seats) {
+    std::uint64_t h = kFnvOffset;
+    mix(h, static_cast<std::uint64_t>(show_id.value()));
+    for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+        mix(h, static_cast<std::uint64_t>(w));
+        mix(h, seats.word(w));
+    }
+    return h;
+}
+
+std::uint64_t request_fingerprint(ShowId show_id, const std::vector<std::string>& labels) {
+    std::uint64_t h = kFnvOffset;
+    mix(h, static_cast<std::uint64_t>(show_id.value()));
+    for (const std::string& label : labels) {
+        for (const char c : label) mix(h, static_cast<unsigned char>(c));
+        mix(h, label.size());
+    }
+    return h;
+}
+
+/** @brief Outcomes that a retry may improve on; they are not remembered. */
+bool transient(BookingStatus status) {
+    return status == BookingStatus::Contended || status == BookingStatus::Throttled;
+}
+
+} // namespace
+
+void BookingService::enable_request_dedupe(std::chrono::milliseconds ttl, std::size_t capacity) {
+    if (!dedupe_) dedupe_ = std::make_unique<RequestDedupe>(ttl, capacity);
+}
+
+template <typename F>
+BookingResult BookingService::deduplicated(std::uint64_t request_id, std::uint64_t fingerprint, F&& book) {
+    RequestDedupe::Record record;
+    RequestDedupe::Ticket ticket;
+    switch (dedupe_->claim(request_id, fingerprint, RequestDedupe::now_ns(), record, ticket)) {
+        case RequestDedupe::Claim::Replay: {
+            BookingResult r = BookingResult::error(static_cast<BookingStatus>(record.status));
+            r.success = r.status == BookingStatus::Ok;
+            r.id = record.id;
+            r.label_index = record.detail;
+            return r;
+        }
+        case RequestDedupe::Claim::Mismatch:
+            return BookingResult::error(BookingStatus::RequestIdReused);
+        case RequestDedupe::Claim::InFlight:
+            return BookingResult::error(BookingStatus::RequestInFlight);
+        case RequestDedupe::Claim::Untracked:
+            return book();
+        case RequestDedupe::Claim::Owner:
+            break;
+    }
+    BookingResult r = book();
+    if (transient(r.status)) {
+        dedupe_->abandon(ticket);
+    } else {
+        dedupe_->complete(ticket, RequestDedupe::Record{r.id, static_cast<std::uint32_t>(r.status), r.label_index},
+                          RequestDedupe::now_ns());
+    }
+    return r;
+}
+
+BookingResult BookingService::book_seats_once(std::uint64_t request_id, ShowId show_id,
+                                              const std::vector<std::string>& seat_labels) {
+    if (!dedupe_) return book_seats(show_id, seat_labels);
+    return deduplicated(request_id, request_fingerprint(show_id, seat_labels),
+                        [&] { return book_seats(show_id, seat_labels); });
+}
+
+BookingResult BookingService::book_seat_mask_once(std::uint64_t request_id, ShowId show_id, const SeatMask& seats) {
+    if (!dedupe_) return book_seat_mask(show_id, seats);
+    return deduplicated(request_id, request_fingerprint(show_id, seats), [&] { return book_seat_mask(show_id, seats); });
+}
+
+} // namespace booking
@@ -0,0 +1,98 @@
+#include "booking_service.hpp"
+#include "seat_words.hpp"
+
+#include <array>
+#include <thread>
+
+// Availability diffs: the seats a show gained and lost between two change feed positions,
+// folded from the feed instead of re-reading and re-rendering the whole seat map.
+
+namespace booking {
+
+const char* to_string(DiffStatus status) {
+    switch (status) {
+        case DiffStatus::Ok: return "Seats diffed";
+        case DiffStatus::UnknownShow: return "Unknown show";
+        case DiffStatus::NoFeed: return "Change feed not enabled";
+        case DiffStatus::Resync: return "Position left the change feed";
+    }
+    return "Unknown status";
+}
+
+AvailabilityDiff BookingService::availability_diff(ShowId show_id, std::uint64_t since) const {
+    AvailabilityDiff diff;
+    if (!get_state(show_id)) {
+        diff.status = DiffStatus::UnknownShow;
+        return diff;
+    }
+    if (!change_feed_) {
+        diff.status = DiffStatus::NoFeed;
+        return diff;
+    }
+    const std::uint64_t head = change_feed_->head();
+    diff.position = head;
+    if (since > head || head - since > change_feed_->capacity()) {
+        diff.status = DiffStatus::Resync;
+        return diff;
+    }
+
+    // Per row: bits flipped an odd number of times, bits seen, and the direction of the
+    // first change seen of each bit. A word's changes alternate direction, so a bit that
+    // flipped an odd number of times ended the way its first change went.
+    std::array<std::uint64_t, HallLayout::kMaxRows> flipped{};
+    std::array<std::uint64_t, HallLayout::kMaxRows> seen{};
+    std::array<std::uint64_t, HallLayout::kMaxRows> first_taken{};
+    SeatChange change;
+    std::uint64_t seq = since;
+    for (; seq < head; ++seq) {
+        const FeedRead read = change_feed_->read(seq, change);
+        if (read == FeedRead::NotYet) break; // the rest waits for the next call
+        if (read == FeedRead::Hole) continue;
+        if (read == FeedRead::Lost) {
+            diff.status = DiffStatus::Resync;
+            return diff;
+        }
+        if (change.show_id != show_id) continue;
+        const auto w = static_cast<std::size_t>(change.word);
+        const std::uint64_t bits = change.old_bits ^ change.new_bits;
+        first_taken[w] |= bits & change.new_bits & ~seen[w];
+        seen[w] |= bits;
+        flipped[w] ^= bits;
+    }
+    for (std::size_t w = 0; w < flipped.size(); ++w) {
+        if (flipped[w] == 0u) continue;
+        diff.taken.or_word(static_cast<int>(w), flipped[w] & first_taken[w]);
+        diff.freed.or_word(static_cast<int>(w), flipped[w] & ~first_taken[w]);
+    }
+    diff.position = seq;
+    return diff;
+}
+
+int BookingService::availability_snapshot(ShowId show_id, SeatMask& out_free, std::uint64_t& position) const {
+    out_free = SeatMask{};
+    position = 0;
+    const ShowState* st = get_state(show_id);
+    if (!st) return -1;
+
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    if (!change_feed_) {
+        load_free_words(*st, free_words.data());
+    } else {
+        // load_free_words with the cut inside: no seat write, and so no feed entry, in flight
+        const std::atomic<std::uint64_t>& writes = st->group_writes();
+        for (unsigned attempt = 1;; ++attempt) {
+            const std::uint64_t before = writes.load(std::memory_order_acquire);
+            if ((before & kGroupWriters) == 0u) {
+                position = change_feed_->cut();
+                seat_words::load_free(st->words(), st->layout->row_masks(), free_words.data(), st->word_count);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (writes.load(std::memory_order_relaxed) == before) break;
+            }
+            if (attempt % 16u == 0u) std::this_thread::yield(); // a writer was preempted mid-write
+        }
+    }
+    for (int w = 0; w < st->word_count; ++w) out_free.or_word(w, free_words[static_cast<std::size_t>(w)]);
+    return seat_scan::kernels().count_free(free_words.data(), static_cast<std::size_t>(st->word_count));
+}
+
+} // namespace booking
@@ -0,0 +1,140 @@
+#include "booking_service.hpp"
+
+#include "crc32c.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+// Availability blobs for edge caches: every catalog show's free seats encoded in parallel
+// from the state array into one versioned file with an index for range fetches.
+
+namespace booking {
+
+namespace {
+
+/** @brief Shows per parallel chunk: each chunk encodes into its own buffer. */
+constexpr std::size_t kBlobChunk = 1024;
+
+template <typename T>
+void put(char* at, T value) {
+    std::memcpy(at, &value, sizeof(value));
+}
+
+/** @brief Replaces @p path with @p blob (written to a temporary file first). */
+bool write_blob(const std::string& path, const std::string& blob) {
+    const std::string tmp = path + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    bool ok = true;
+    for (std::size_t done = 0; ok && done < blob.size();) {
+        const ssize_t n = ::write(fd, blob.data() + done, blob.size() - done);
+        ok = n > 0;
+        if (ok) done += static_cast<std::size_t>(n);
+    }
+    ::close(fd);
+    if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+std::uint64_t BookingService::encode_availability_blob(std::string& out, SeatEncoding encoding) const {
+    EpochManager::Guard guard(catalog_epochs_);
+    const ShowColumns& shows = catalog_.load(std::memory_order_acquire)->shows;
+    const std::size_t count = shows.size();
+    std::vector<std::uint32_t> order(count); // rows by show id
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) { return shows.ids()[a] < shows.ids()[b]; });
+
+    // Each chunk encodes its shows into its own buffer, then the buffers are placed
+    std::vector<std::string> payloads((count + kBlobChunk - 1u) / kBlobChunk);
+    std::vector<std::uint32_t> sizes(count, 0u);
+    std::vector<std::uint64_t> changes(count, 0u);
+    thread_pool().parallel_for(payloads.size(), 1u, [&](std::size_t begin, std::size_t end) {
+        std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+        for (std::size_t c = begin; c < end; ++c) {
+            std::string& buffer = payloads[c];
+            const std::size_t last = std::min(count, (c + 1u) * kBlobChunk);
+            for (std::size_t i = c * kBlobChunk; i < last; ++i) {
+                const ShowState* st = get_state(shows.ids()[order[i]]);
+                if (!st) continue;
+                changes[i] = st->changes().load(std::memory_order_acquire);
+                load_free_words(*st, free_words.data());
+                const std::size_t at = buffer.size();
+                buffer.resize(at + max_encoded_size(*st->layout, encoding));
+                char* const first = buffer.data() + at;
+                char* const past = encode_free_seats(*st->layout, free_words.data(), st->word_count, encoding, first);
+                sizes[i] = static_cast<std::uint32_t>(past - first);
+                buffer.resize(at + sizes[i]);
+            }
+        }
+    });
+
+    const std::size_t index_end = kAvailabilityBlobHeader + count * kAvailabilityBlobEntry;
+    std::size_t total = index_end;
+    for (const std::string& buffer : payloads) total += buffer.size();
+    out.assign(total, '\0');
+    std::uint64_t offset = index_end;
+    for (std::size_t i = 0; i < count; ++i) {
+        char* entry = out.data() + kAvailabilityBlobHeader + i * kAvailabilityBlobEntry;
+        put(entry, shows.ids()[order[i]].value());
+        put(entry + 8, changes[i]);
+        put(entry + 16, offset);
+        put(entry + 24, sizes[i]);
+        put(entry + 28, static_cast<std::int32_t>(shows.layout_ids()[order[i]]));
+        offset += sizes[i];
+    }
+    offset = index_end;
+    for (const std::string& buffer : payloads) {
+        std::memcpy(out.data() + offset, buffer.data(), buffer.size());
+        offset += buffer.size();
+    }
+
+    const std::uint64_t version = availability_version_.fetch_add(1u, std::memory_order_relaxed) + 1u;
+    std::memcpy(out.data(), "BKAVAIL1", 8);
+    put(out.data() + 8, version);
+    put(out.data() + 16, static_cast<std::uint64_t>(count));
+    out[24] = static_cast<char>(encoding);
+    put(out.data() + 28, crc32c(out.data() + kAvailabilityBlobHeader, total - kAvailabilityBlobHeader));
+    return version;
+}
+
+SnapshotStatus BookingService::set_availability_export(const AvailabilityExportOptions& options) {
+    if (availability_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(availability_mutex_);
+            availability_stop_ = true;
+        }
+        availability_cv_.notify_all();
+        availability_thread_.join();
+        availability_stop_ = false;
+    }
+    if (options.path.empty() && !options.push) return SnapshotStatus::Ok;
+    const auto publish = [this, options] {
+        std::string blob;
+        const std::uint64_t version = encode_availability_blob(blob, options.encoding);
+        if (!options.path.empty() && !write_blob(options.path, blob)) return false;
+        if (options.push) options.push(blob, version);
+        return true;
+    };
+    if (!publish()) return SnapshotStatus::IoError;
+    const std::chrono::milliseconds interval = std::max(options.interval, std::chrono::milliseconds(1));
+    availability_thread_ = std::thread([this, publish, interval] {
+        std::unique_lock<std::mutex> lock(availability_mutex_);
+        while (!availability_cv_.wait_for(lock, interval, [this] { return availability_stop_; })) {
+            lock.unlock();
+            publish();
+            lock.lock();
+        }
+    });
+    return SnapshotStatus::Ok;
+}
+
+} // namespace booking
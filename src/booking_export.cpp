@@ -0,0 +1,226 @@
+#include "booking_service.hpp"
+
+#include "arrow_writer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Arrow export for analytics: record batches filled column by column from the show
+// columns, the catalog's movies and theaters and the owner rows of each show, and the
+// occupancy file, which reads only the state array.
+
+namespace booking {
+
+namespace {
+
+static_assert(sizeof(ShowId) == sizeof(std::int64_t) && sizeof(ShowTime) == sizeof(std::int64_t)
+                  && sizeof(int) == sizeof(std::int32_t) && sizeof(BookingId) == sizeof(std::uint32_t),
+              "show columns are exported in place");
+
+/** @brief A Utf8 column being filled: offsets and characters. */
+struct TextColumn {
+    std::vector<std::int32_t> offsets{0};
+    std::string chars;
+
+    void add(std::string_view s) {
+        chars.append(s.data(), s.size());
+        offsets.push_back(static_cast<std::int32_t>(chars.size()));
+    }
+    void clear() {
+        offsets.assign(1u, 0);
+        chars.clear();
+    }
+    ArrowColumn column() const { return ArrowColumn{offsets.data(), chars.data()}; }
+};
+
+/** @brief Booked seats waiting for the next seats.arrow batch. */
+struct SeatBatch {
+    std::vector<std::int64_t> show_ids;
+    std::vector<std::int32_t> seats;
+    TextColumn labels;
+    std::vector<BookingId> bookings;
+
+    std::size_t size() const { return seats.size(); }
+
+    bool flush(ArrowFileWriter& out) {
+        if (seats.empty()) return true;
+        const ArrowColumn columns[] = {{show_ids.data(), nullptr}, {seats.data(), nullptr}, labels.column(),
+                                       {bookings.data(), nullptr}};
+        const bool ok = out.write_batch(seats.size(), columns);
+        show_ids.clear();
+        seats.clear();
+        labels.clear();
+        bookings.clear();
+        return ok;
+    }
+};
+
+} // namespace
+
+SnapshotStatus BookingService::export_arrow(const std::string& directory, std::size_t batch_rows) const {
+    batch_rows = std::max<std::size_t>(batch_rows, 1u);
+    ArrowFileWriter show_file({{"show_id", ArrowType::Int64},
+                               {"movie_id", ArrowType::Int64},
+                               {"movie_title", ArrowType::Utf8},
+                               {"theater_id", ArrowType::Int64},
+                               {"theater_name", ArrowType::Utf8},
+                               {"start_time", ArrowType::Timestamp},
+                               {"hall", ArrowType::Int32},
+                               {"seats", ArrowType::Int32},
+                               {"booked", ArrowType::Int32}});
+    ArrowFileWriter seat_file({{"show_id", ArrowType::Int64},
+                               {"seat", ArrowType::Int32},
+                               {"label", ArrowType::Utf8},
+                               {"booking_id", ArrowType::UInt32}});
+    if (!show_file.open(directory + "/shows.arrow") || !seat_file.open(directory + "/seats.arrow")) {
+        return SnapshotStatus::IoError;
+    }
+
+    // Catalog writers wait (the columns and layouts stay fixed); bookings do not
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    const ShowColumns& shows = c->shows;
+
+    std::vector<std::int64_t> movie_ids;
+    std::vector<std::int64_t> theater_ids;
+    std::vector<std::int32_t> capacities;
+    std::vector<std::int32_t> booked;
+    TextColumn titles;
+    TextColumn names;
+    SeatBatch seats;
+    for (std::size_t begin = 0; begin < shows.size(); begin += batch_rows) {
+        const std::size_t end = std::min(shows.size(), begin + batch_rows);
+        movie_ids.clear();
+        theater_ids.clear();
+        capacities.clear();
+        booked.clear();
+        titles.clear();
+        names.clear();
+        for (std::size_t i = begin; i < end; ++i) {
+            const Movie& m = c->movies[static_cast<std::size_t>(shows.movie_slots()[i])];
+            const Theater& t = c->theaters[static_cast<std::size_t>(shows.theater_slots()[i])];
+            movie_ids.push_back(m.id.value());
+            theater_ids.push_back(t.id.value());
+            titles.add(m.title);
+            names.add(t.name);
+
+            // Each word is read once, and a seat counts only if its owner is seen (holds do not)
+            const ShowState& st = *get_state(shows.ids()[i]);
+            const OwnerRow* owners = st.owners.load(std::memory_order_acquire);
+            std::int32_t sold = 0;
+            const std::atomic<std::uint64_t>* words = st.words();
+            for (int w = 0; owners && w < st.word_count; ++w) {
+                for (std::uint64_t bits = words[w].load() & st.layout->row_mask(w); bits != 0u; bits &= bits - 1u) {
+                    const int col = ctz64(bits);
+                    const BookingId id = owners[w].seats[static_cast<std::size_t>(col)].load(std::memory_order_relaxed);
+                    if (id == 0u) continue;
+                    const int seat = HallLayout::seat_index(w, col);
+                    seats.show_ids.push_back(shows.ids()[i].value());
+                    seats.seats.push_back(seat);
+                    seats.labels.add(st.layout->label_view(seat));
+                    seats.bookings.push_back(id);
+                    ++sold;
+                    if (seats.size() == batch_rows && !seats.flush(seat_file)) return SnapshotStatus::IoError;
+                }
+            }
+            capacities.push_back(st.layout->seat_count());
+            booked.push_back(sold);
+        }
+        // Ids, start times and halls go out in place from the columns
+        const ArrowColumn columns[] = {{shows.ids().data() + begin, nullptr},
+                                       {movie_ids.data(), nullptr},
+                                       titles.column(),
+                                       {theater_ids.data(), nullptr},
+                                       names.column(),
+                                       {shows.start_times().data() + begin, nullptr},
+                                       {shows.halls().data() + begin, nullptr},
+                                       {capacities.data(), nullptr},
+                                       {booked.data(), nullptr}};
+        if (!show_file.write_batch(end - begin, columns)) return SnapshotStatus::IoError;
+    }
+    if (!seats.flush(seat_file) || !show_file.finish() || !seat_file.finish()) return SnapshotStatus::IoError;
+    return SnapshotStatus::Ok;
+}
+
+SnapshotStatus BookingService::publish_occupancy(const std::string& path) const {
+    constexpr std::size_t kBatchRows = 65536;
+    ArrowFileWriter out({{"show_id", ArrowType::Int64},
+                         {"movie_id", ArrowType::Int64},
+                         {"theater_id", ArrowType::Int64},
+                         {"start_time", ArrowType::Timestamp},
+                         {"seats", ArrowType::Int32},
+                         {"taken", ArrowType::Int32},
+                         {"changes", ArrowType::Int64}});
+    if (!out.open(path)) return SnapshotStatus::IoError;
+
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    const ShowColumns& shows = c->shows;
+    std::vector<std::int64_t> movie_ids;
+    std::vector<std::int64_t> theater_ids;
+    std::vector<std::int32_t> capacities;
+    std::vector<std::int32_t> taken;
+    std::vector<std::int64_t> changes;
+    for (std::size_t begin = 0; begin < shows.size(); begin += kBatchRows) {
+        const std::size_t end = std::min(shows.size(), begin + kBatchRows);
+        movie_ids.clear();
+        theater_ids.clear();
+        capacities.clear();
+        taken.clear();
+        changes.clear();
+        for (std::size_t i = begin; i < end; ++i) {
+            movie_ids.push_back(c->movies[static_cast<std::size_t>(shows.movie_slots()[i])].id.value());
+            theater_ids.push_back(c->theaters[static_cast<std::size_t>(shows.theater_slots()[i])].id.value());
+            const ShowState& st = *get_state(shows.ids()[i]);
+            int n = 0;
+            const std::atomic<std::uint64_t>* words = st.words();
+            for (int w = 0; w < st.word_count; ++w) {
+                n += popcount64(words[w].load(std::memory_order_relaxed) & st.layout->row_mask(w));
+            }
+            capacities.push_back(st.layout->seat_count());
+            taken.push_back(n);
+            changes.push_back(static_cast<std::int64_t>(st.changes().load(std::memory_order_relaxed)));
+        }
+        const ArrowColumn columns[] = {{shows.ids().data() + begin, nullptr},
+                                       {movie_ids.data(), nullptr},
+                                       {theater_ids.data(), nullptr},
+                                       {shows.start_times().data() + begin, nullptr},
+                                       {capacities.data(), nullptr},
+                                       {taken.data(), nullptr},
+                                       {changes.data(), nullptr}};
+        if (!out.write_batch(end - begin, columns)) return SnapshotStatus::IoError;
+    }
+    if (!out.finish()) return SnapshotStatus::IoError;
+    occupancy_publications_.fetch_add(1u, std::memory_order_relaxed);
+    return SnapshotStatus::Ok;
+}
+
+SnapshotStatus BookingService::set_occupancy_export(const OccupancyExportOptions& options) {
+    if (occupancy_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(occupancy_mutex_);
+            occupancy_stop_ = true;
+        }
+        occupancy_cv_.notify_all();
+        occupancy_thread_.join();
+        occupancy_stop_ = false;
+    }
+    if (options.path.empty()) return SnapshotStatus::Ok;
+    const SnapshotStatus status = publish_occupancy(options.path);
+    if (status != SnapshotStatus::Ok) return status;
+    const std::chrono::milliseconds interval = std::max(options.interval, std::chrono::milliseconds(1));
+    occupancy_thread_ = std::thread([this, path = options.path, interval] {
+        std::unique_lock<std::mutex> lock(occupancy_mutex_);
+        while (!occupancy_cv_.wait_for(lock, interval, [this] { return occupancy_stop_; })) {
+            lock.unlock();
+            publish_occupancy(path);
+            lock.lock();
+        }
+    });
+    return SnapshotStatus::Ok;
+}
+
+} // namespace booking
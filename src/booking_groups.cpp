@@ -0,0 +1,153 @@
+#include "booking_service.hpp"
+#include "seat_runs.hpp"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+
+// Group seating: groups that fit no single row are split over two consecutive rows, found
+// by a branch-and-bound search over row pairs and splits on the free row words.
+
+namespace booking {
+
+namespace {
+
+/** @brief Largest group: one full row in front of another. */
+constexpr int kMaxGroup = 2 * HallLayout::kMaxRowSeats;
+
+/** @brief Cost of each seat of difference between the two parts (in run_cost units). */
+constexpr int kImbalanceCost = 2;
+
+std::uint64_t run_bits(int n) {
+    return n >= 64 ? ~std::uint64_t{0} : ((std::uint64_t{1} << n) - 1u);
+}
+
+/** @brief Bits s such that @p starts has a bit in [s, s + @p span]. */
+std::uint64_t reach_down(std::uint64_t starts, int span) {
+    int covered = 0; // starts marks s if a bit is in [s, s + covered]
+    while (covered < span && starts != 0u) {
+        const int step = std::min(covered + 1, span - covered);
+        starts |= starts >> step;
+        covered += step;
+    }
+    return starts;
+}
+
+/** @brief A group split over two rows (the longer part first). */
+struct GroupPlan {
+    int cost = INT_MAX;
+    int long_row = -1;
+    int long_start = 0;
+    int long_n = 0;
+    int short_row = -1;
+    int short_start = 0;
+};
+
+} // namespace
+
+BookingResult BookingService::book_group(ShowId show_id, int n, SeatMask& out_seats) {
+    return measured(MetricsApi::BookGroup, [&] {
+        out_seats = SeatMask{};
+        ShowState* st = get_state_mut(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (!admit_booker(show_id)) {
+            return BookingResult::error(BookingStatus::Throttled);
+        }
+        if (n < 1) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+        if (n > kMaxGroup) {
+            return BookingResult::error(BookingStatus::NoContiguousSeats);
+        }
+        return on_owner(show_id, [&] {
+            if (n <= HallLayout::kMaxRowSeats) {
+                const BookingResult one_row = book_best_on(*st, n, out_seats);
+                if (one_row.status != BookingStatus::NoContiguousSeats) return one_row;
+            }
+            return book_group_on(*st, n, out_seats);
+        });
+    });
+}
+
+BookingResult BookingService::book_group_on(ShowState& st, int n, SeatMask& out_seats) {
+    const HallLayout& layout = *st.layout;
+    const bool no_gaps = layout.forbids_single_gaps();
+    const bool aisles = layout.has_aisles();
+    const int rows = st.word_count;
+    Backoff backoff(backoff_policy());
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    std::array<std::uint64_t, HallLayout::kMaxRows> scan_words;
+
+    // Row pairs (r, r + 1) by the least cost any plan in them can have
+    std::array<std::pair<int, int>, HallLayout::kMaxRows> pairs;
+    int pair_count = 0;
+    for (int r = 0; r + 1 < rows; ++r) pairs[pair_count++] = {layout.row_cost(r) + layout.row_cost(r + 1), r};
+    std::sort(pairs.begin(), pairs.begin() + pair_count);
+
+    while (true) {
+        load_search_words(st, free_words.data());
+        const std::uint64_t* open = layout.open_row_masks();
+        for (int w = 0; w < rows; ++w) scan_words[w] = free_words[w] & open[w];
+
+        // Starts of a part of `len` seats in `row` that the search may pick
+        const auto part_starts = [&](int row, int len) {
+            std::uint64_t starts = run_starts(scan_words[row], len);
+            if (aisles) starts &= layout.block_starts(row, len);
+            if (no_gaps && starts != 0u) starts &= ~gap_leaving_starts(free_words[row], len);
+            return starts;
+        };
+
+        GroupPlan best;
+        for (int p = 0; p < pair_count && pairs[p].first < best.cost; ++p) {
+            const int front = pairs[p].second;
+            for (int long_n = (n + 1) / 2; long_n < n && long_n <= HallLayout::kMaxRowSeats; ++long_n) {
+                const int short_n = n - long_n;
+                const int imbalance = kImbalanceCost * (long_n - short_n);
+                if (pairs[p].first + imbalance >= best.cost) break; // more uneven splits only cost more
+                for (int side = 0; side < (long_n == short_n ? 1 : 2); ++side) {
+                    const int long_row = front + side;
+                    const int short_row = front + 1 - side;
+                    const std::uint64_t long_starts = part_starts(long_row, long_n);
+                    if (long_starts == 0u) continue;
+                    const std::uint64_t short_starts = part_starts(short_row, short_n);
+                    if (short_starts == 0u) continue;
+                    // The shorter part starts within [s, s + long_n - short_n] of the longer one's start s
+                    const int slack = long_n - short_n;
+                    const std::uint64_t aligned = long_starts & reach_down(short_starts, slack);
+                    if (aligned == 0u) continue;
+                    const int long_start = nearest_bit(aligned, (layout.row_seats(long_row) - long_n) / 2);
+                    const std::uint64_t window = short_starts & (run_bits(slack + 1) << long_start);
+                    const int short_start = nearest_bit(window, long_start + slack / 2);
+                    const int cost = layout.run_cost(long_row, long_start, long_n)
+                                     + layout.run_cost(short_row, short_start, short_n) + imbalance;
+                    if (cost < best.cost) best = GroupPlan{cost, long_row, long_start, long_n, short_row, short_start};
+                }
+            }
+        }
+        if (best.long_row < 0) {
+            return BookingResult::error(BookingStatus::NoContiguousSeats);
+        }
+
+        SeatMask seats;
+        seats.or_word(best.long_row, run_bits(best.long_n) << best.long_start);
+        seats.or_word(best.short_row, run_bits(n - best.long_n) << best.short_start);
+        BookingResult res = book_mask_on(st, seats);
+        if (res.success) {
+            out_seats = seats;
+            res.id = record_owner(st, seats);
+            return res;
+        }
+        if (res.status == BookingStatus::Contended) {
+            return res;
+        }
+        // Someone took or changed the rows after the scan; search again on fresh state
+        if (!backoff.retry()) {
+            st.contended.fetch_add(1, std::memory_order_relaxed);
+            return BookingResult::error(BookingStatus::Contended);
+        }
+    }
+}
+
+} // namespace booking
@@ -0,0 +1,50 @@
+#include "booking_service.hpp"
+
+#include <algorithm>
+
+// Seat heatmaps: how often each seat of a hall sold over the shows that played in it,
+// summed from the cold store with the seat_heatmap.hpp column kernels.
+
+namespace booking {
+
+namespace {
+
+/** @brief Shows per parallel chunk: each chunk sums into its own counts. */
+constexpr std::size_t kHeatmapChunk = 4096;
+
+} // namespace
+
+SeatHeatmap BookingService::seat_heatmap(LayoutId layout_id, ShowTime from, ShowTime to) const {
+    SeatHeatmap heatmap;
+    heatmap.layout_id = layout_id;
+    std::size_t rows = 0;
+    {
+        const std::lock_guard<std::mutex> lock(catalog_mutex_); // the registry grows under it
+        if (!layouts_.contains(layout_id)) return heatmap;
+        rows = static_cast<std::size_t>(layouts_.at(layout_id).row_count());
+    }
+    const std::size_t seats = rows * HallLayout::kMaxRowSeats;
+    heatmap.counts.assign(seats, 0u);
+
+    std::vector<std::uint64_t> words;
+    heatmap.shows = cold_shows_.booked_words(layout_id, from, to, rows, words);
+    if (heatmap.shows == 0u) return heatmap;
+
+    const seat_heatmap::Kernels& k = seat_heatmap::kernels();
+    const std::size_t chunks = (heatmap.shows + kHeatmapChunk - 1u) / kHeatmapChunk;
+    std::vector<std::vector<std::uint32_t>> partial(chunks);
+    thread_pool().parallel_for(chunks, 1u, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            const std::size_t first = c * kHeatmapChunk;
+            const std::size_t n = std::min(kHeatmapChunk, heatmap.shows - first);
+            partial[c].assign(seats, 0u);
+            k.add_columns(words.data() + first * rows, n, rows, partial[c].data());
+        }
+    });
+    for (const std::vector<std::uint32_t>& counts : partial) {
+        for (std::size_t s = 0; s < seats; ++s) heatmap.counts[s] += counts[s];
+    }
+    return heatmap;
+}
+
+} // namespace booking
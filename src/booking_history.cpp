@@ -0,0 +1,428 @@
+#include "booking_history.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace booking {
+
+namespace {
+
+/** @brief Owner token of a booking or a hold; 0 = free. */
+std::uint64_t booking_token(std::uint64_t id) {
+    return id << 1;
+}
+
+std::uint64_t hold_token(std::uint64_t id) {
+    return (id << 1) | 1u;
+}
+
+std::uint64_t mix64(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief An event as the sequential model sees it: either every seat is owned by
+ *        @ref expect (then set to @ref set), or some seat is not (and nothing changes).
+ */
+struct ModelOp {
+    std::size_t event = 0;
+    bool all = true;          /**< Succeeded: all seats == expect; failed: some seat != expect. */
+    std::uint64_t expect = 0;
+    std::uint64_t set = 0;
+    std::vector<int> seats;   /**< Seat indices of the show, then of the group. */
+    std::uint64_t invoked = 0;
+    std::uint64_t completed = 0;
+};
+
+std::vector<int> seat_list(const SeatMask& mask) {
+    std::vector<int> seats;
+    for (int w = mask.first_word(); w < mask.end_word(); ++w) {
+        for (std::uint64_t bits = mask.word(w); bits != 0u; bits &= bits - 1u) {
+            seats.push_back(HallLayout::seat_index(w, ctz64(bits)));
+        }
+    }
+    return seats;
+}
+
+bool seats_overlap(const History& history, const HistoryEvent& a, const HistoryEvent& b) {
+    const int first = std::max(a.first_word, b.first_word);
+    const int end = std::min(a.end_word, b.end_word);
+    for (int w = first; w < end; ++w) {
+        if ((history.words[a.words + static_cast<std::uint32_t>(w - a.first_word)]
+             & history.words[b.words + static_cast<std::uint32_t>(w - b.first_word)]) != 0u) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Marks the failed bookings and holds that a rolled-back one may explain.
+ *
+ * A multi-row request takes its words one CAS at a time and gives them back when a later
+ * one fails, so a request running at the same time may see those seats taken although
+ * no sequential order has them owned. Such a failure is consistent with any state.
+ */
+std::vector<bool> tentative_conflicts(const History& history) {
+    std::vector<std::size_t> failed; // may have held some of their seats for a while
+    for (std::size_t i = 0; i < history.events.size(); ++i) {
+        const HistoryEvent& e = history.events[i];
+        if ((e.op == HistoryOp::Book || e.op == HistoryOp::Hold)
+            && (e.status == BookingStatus::AlreadyBooked || e.status == BookingStatus::Contended)) {
+            failed.push_back(i);
+        }
+    }
+    std::vector<bool> excused(history.events.size(), false);
+    if (failed.size() < 2u) return excused;
+    std::sort(failed.begin(), failed.end(), [&](std::size_t a, std::size_t b) {
+        return history.events[a].invoked < history.events[b].invoked;
+    });
+    std::uint64_t longest = 0;
+    for (const std::size_t i : failed) {
+        longest = std::max(longest, history.events[i].completed - history.events[i].invoked);
+    }
+    for (std::size_t k = 0; k < failed.size(); ++k) {
+        const HistoryEvent& e = history.events[failed[k]];
+        if (e.status != BookingStatus::AlreadyBooked) continue;
+        const std::uint64_t from = e.invoked > longest ? e.invoked - longest : 0u;
+        auto it = std::lower_bound(failed.begin(), failed.end(), from, [&](std::size_t i, std::uint64_t t) {
+            return history.events[i].invoked < t;
+        });
+        for (; it != failed.end() && history.events[*it].invoked < e.completed; ++it) {
+            const HistoryEvent& other = history.events[*it];
+            if (*it == failed[k] || other.completed < e.invoked) continue;
+            if (seats_overlap(history, e, other)) {
+                excused[failed[k]] = true;
+                break;
+            }
+        }
+    }
+    return excused;
+}
+
+/** @brief Translates the events the model constrains; the others are left out. */
+std::vector<ModelOp> model_ops(const History& history) {
+    std::unordered_map<std::uint64_t, std::size_t> holds; // HoldId -> event that took it
+    for (std::size_t i = 0; i < history.events.size(); ++i) {
+        const HistoryEvent& e = history.events[i];
+        if (e.op == HistoryOp::Hold && e.status == BookingStatus::Ok) holds.emplace(e.id, i);
+    }
+    const std::vector<bool> excused = tentative_conflicts(history);
+    std::vector<ModelOp> ops;
+    for (std::size_t i = 0; i < history.events.size(); ++i) {
+        const HistoryEvent& e = history.events[i];
+        const bool ok = e.status == BookingStatus::Ok;
+        ModelOp m;
+        m.event = i;
+        m.all = ok;
+        m.invoked = e.invoked;
+        m.completed = e.completed;
+        switch (e.op) {
+            case HistoryOp::Book:
+            case HistoryOp::Hold:
+                if (!ok && (e.status != BookingStatus::AlreadyBooked || excused[i])) continue;
+                m.expect = 0u;
+                m.set = e.op == HistoryOp::Book ? booking_token(e.id) : hold_token(e.id);
+                break;
+            case HistoryOp::Cancel:
+                if (!ok && e.status != BookingStatus::NotOwner) continue;
+                m.expect = booking_token(e.arg);
+                m.set = 0u;
+                break;
+            case HistoryOp::ConfirmHold:
+            case HistoryOp::ReleaseHold: {
+                if (!ok) continue; // may have lost to an expiry the history does not show
+                const auto hold = holds.find(e.arg);
+                if (hold == holds.end()) continue;
+                m.expect = hold_token(e.arg);
+                m.set = e.op == HistoryOp::ConfirmHold ? booking_token(e.id) : 0u;
+                m.seats = seat_list(history.seats(history.events[hold->second]));
+                break;
+            }
+        }
+        if (m.seats.empty()) m.seats = seat_list(history.seats(e));
+        if (m.seats.empty()) continue;
+        ops.push_back(std::move(m));
+    }
+    return ops;
+}
+
+std::size_t find_root(std::vector<std::size_t>& parent, std::size_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+/** @brief Call or return of an operation in the time-ordered list of a segment. */
+struct Entry {
+    std::size_t op = 0;   /**< Index in the segment. */
+    bool call = false;
+    Entry* match = nullptr;
+    Entry* prev = nullptr;
+    Entry* next = nullptr;
+};
+
+struct PairHash {
+    std::size_t operator()(const std::pair<std::uint64_t, std::uint64_t>& k) const {
+        return static_cast<std::size_t>(k.first ^ (k.second * 0x9e3779b97f4a7c15ull));
+    }
+};
+
+/**
+ * @brief Wing-Gong search over one segment, starting from (and leaving its end state in)
+ *        @p owners, indexed by group seat.
+ */
+LinearizabilityVerdict search_segment(const std::vector<const ModelOp*>& ops, std::vector<std::uint64_t>& owners,
+                                      std::uint64_t& steps, std::uint64_t max_steps) {
+    const std::size_t n = ops.size();
+    std::vector<Entry> entries(2 * n);
+    std::vector<Entry*> order(2 * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        Entry& call = entries[2 * i];
+        Entry& ret = entries[2 * i + 1];
+        call.op = ret.op = i;
+        call.call = true;
+        call.match = &ret;
+        order[2 * i] = &call;
+        order[2 * i + 1] = &ret;
+    }
+    const auto time_of = [&](const Entry* e) { return e->call ? ops[e->op]->invoked : ops[e->op]->completed; };
+    std::sort(order.begin(), order.end(), [&](const Entry* a, const Entry* b) { return time_of(a) < time_of(b); });
+    Entry head;
+    Entry* prev = &head;
+    for (Entry* e : order) {
+        e->prev = prev;
+        prev->next = e;
+        prev = e;
+    }
+
+    // The state is hashed incrementally: XOR of one digest per (seat, owner) and per linearized op
+    const auto seat_digest = [](std::size_t seat, std::uint64_t owner) {
+        return std::make_pair(mix64(seat * 0x100000001b3u + owner), mix64((owner << 16) ^ seat ^ 0x5bd1e995u));
+    };
+    std::pair<std::uint64_t, std::uint64_t> digest{0u, 0u};
+    const auto toggle = [&](const std::pair<std::uint64_t, std::uint64_t>& d) {
+        digest.first ^= d.first;
+        digest.second ^= d.second;
+    };
+    for (std::size_t s = 0; s < owners.size(); ++s) toggle(seat_digest(s, owners[s]));
+    const auto op_digest = [](std::size_t op) { return std::make_pair(mix64(op + 0x243f6a88u), mix64(~op)); };
+
+    std::vector<Entry*> calls; // linearized so far, in order
+    std::unordered_set<std::pair<std::uint64_t, std::uint64_t>, PairHash> seen;
+
+    const auto apply = [&](const ModelOp& m, std::uint64_t from, std::uint64_t to) {
+        for (const int s : m.seats) {
+            const auto seat = static_cast<std::size_t>(s);
+            toggle(seat_digest(seat, from));
+            owners[seat] = to;
+            toggle(seat_digest(seat, to));
+        }
+    };
+    const auto legal = [&](const ModelOp& m) {
+        for (const int s : m.seats) {
+            const bool match = owners[static_cast<std::size_t>(s)] == m.expect;
+            if (!m.all && !match) return true;
+            if (m.all && !match) return false;
+        }
+        return m.all;
+    };
+    const auto lift = [](Entry* call) {
+        call->prev->next = call->next;
+        if (call->next) call->next->prev = call->prev;
+        Entry* ret = call->match;
+        ret->prev->next = ret->next;
+        if (ret->next) ret->next->prev = ret->prev;
+    };
+    const auto unlift = [](Entry* call) {
+        Entry* ret = call->match;
+        ret->prev->next = ret;
+        if (ret->next) ret->next->prev = ret;
+        call->prev->next = call;
+        if (call->next) call->next->prev = call;
+    };
+
+    Entry* entry = head.next;
+    while (head.next) {
+        if (++steps > max_steps) return LinearizabilityVerdict::Unknown;
+        if (entry->call) {
+            const ModelOp& m = *ops[entry->op];
+            if (legal(m)) {
+                if (m.all) apply(m, m.expect, m.set);
+                toggle(op_digest(entry->op));
+                if (seen.insert(digest).second) {
+                    calls.push_back(entry);
+                    lift(entry);
+                    entry = head.next;
+                    continue;
+                }
+                toggle(op_digest(entry->op));
+                if (m.all) apply(m, m.set, m.expect);
+            }
+            entry = entry->next;
+        } else {
+            // A return reached before its call was linearized: undo the last choice
+            if (calls.empty()) return LinearizabilityVerdict::Violation;
+            Entry* call = calls.back();
+            calls.pop_back();
+            const ModelOp& m = *ops[call->op];
+            toggle(op_digest(call->op));
+            if (m.all) apply(m, m.set, m.expect);
+            unlift(call);
+            entry = call->next;
+        }
+    }
+    return LinearizabilityVerdict::Linearizable;
+}
+
+} // namespace
+
+const char* to_string(HistoryOp op) {
+    switch (op) {
+        case HistoryOp::Book: return "book";
+        case HistoryOp::Cancel: return "cancel";
+        case HistoryOp::Hold: return "hold";
+        case HistoryOp::ConfirmHold: return "confirm-hold";
+        case HistoryOp::ReleaseHold: return "release-hold";
+    }
+    return "unknown";
+}
+
+const char* to_string(LinearizabilityVerdict verdict) {
+    switch (verdict) {
+        case LinearizabilityVerdict::Linearizable: return "linearizable";
+        case LinearizabilityVerdict::Violation: return "violation";
+        case LinearizabilityVerdict::Unknown: return "unknown";
+    }
+    return "unknown";
+}
+
+SeatMask History::seats(const HistoryEvent& event) const {
+    SeatMask mask;
+    for (int w = event.first_word; w < event.end_word; ++w) {
+        mask.or_word(w, words[event.words + static_cast<std::size_t>(w - event.first_word)]);
+    }
+    return mask;
+}
+
+HistoryRecorder::HistoryRecorder(unsigned threads) : lanes_(threads == 0u ? 1u : threads) {}
+
+void HistoryRecorder::record(unsigned thread, HistoryOp op, ShowId show_id, const SeatMask& seats,
+                             std::uint64_t arg, std::uint64_t invoked, const BookingResult& result) {
+    History& h = lanes_[thread].history;
+    HistoryEvent e;
+    e.op = op;
+    e.status = result.status;
+    e.thread = thread;
+    e.show_id = show_id;
+    e.arg = arg;
+    e.id = result.id;
+    e.invoked = invoked;
+    e.words = static_cast<std::uint32_t>(h.words.size());
+    if (op != HistoryOp::ConfirmHold && op != HistoryOp::ReleaseHold && !seats.empty()) {
+        e.first_word = static_cast<std::int16_t>(seats.first_word());
+        e.end_word = static_cast<std::int16_t>(seats.end_word());
+        for (int w = seats.first_word(); w < seats.end_word(); ++w) h.words.push_back(seats.word(w));
+    }
+    e.completed = now();
+    h.events.push_back(e);
+}
+
+std::size_t HistoryRecorder::size() const {
+    std::size_t n = 0;
+    for (const Lane& lane : lanes_) n += lane.history.events.size();
+    return n;
+}
+
+History HistoryRecorder::take() {
+    History out;
+    for (Lane& lane : lanes_) {
+        const auto base = static_cast<std::uint32_t>(out.words.size());
+        out.words.insert(out.words.end(), lane.history.words.begin(), lane.history.words.end());
+        for (HistoryEvent e : lane.history.events) {
+            e.words += base;
+            out.events.push_back(e);
+        }
+        lane.history = History{};
+    }
+    std::sort(out.events.begin(), out.events.end(),
+              [](const HistoryEvent& a, const HistoryEvent& b) { return a.completed < b.completed; });
+    return out;
+}
+
+LinearizabilityReport check_linearizable(const History& history, std::uint64_t max_steps) {
+    LinearizabilityReport report;
+    std::vector<ModelOp> ops = model_ops(history);
+    report.checked = ops.size();
+
+    // Group the operations that share a seat of the same show (transitively)
+    std::vector<std::size_t> parent(ops.size());
+    std::iota(parent.begin(), parent.end(), std::size_t{0});
+    {
+        std::unordered_map<std::uint64_t, std::size_t> first_user; // (show, seat) -> op
+        for (std::size_t i = 0; i < ops.size(); ++i) {
+            const auto show = static_cast<std::uint64_t>(history.events[ops[i].event].show_id.value());
+            for (const int s : ops[i].seats) {
+                const std::uint64_t key = show * (HallLayout::kMaxRows * HallLayout::kMaxRowSeats) + static_cast<std::uint64_t>(s);
+                const auto it = first_user.emplace(key, i).first;
+                parent[find_root(parent, i)] = find_root(parent, it->second);
+            }
+        }
+    }
+    std::unordered_map<std::size_t, std::vector<std::size_t>> groups;
+    for (std::size_t i = 0; i < ops.size(); ++i) groups[find_root(parent, i)].push_back(i);
+
+    std::vector<std::size_t> roots;
+    for (const auto& g : groups) roots.push_back(g.first);
+    std::sort(roots.begin(), roots.end()); // deterministic report order
+
+    for (const std::size_t root : roots) {
+        std::vector<std::size_t>& members = groups[root];
+        // Group-local seat indices
+        std::unordered_map<int, int> local;
+        for (const std::size_t i : members) {
+            for (int& s : ops[i].seats) s = local.emplace(s, static_cast<int>(local.size())).first->second;
+        }
+        std::vector<std::uint64_t> owners(local.size(), 0u);
+
+        std::sort(members.begin(), members.end(),
+                  [&](std::size_t a, std::size_t b) { return ops[a].invoked < ops[b].invoked; });
+        std::size_t begin = 0;
+        while (begin < members.size()) {
+            // Segment: up to the next point where nothing is in flight
+            std::uint64_t horizon = ops[members[begin]].completed;
+            std::size_t end = begin + 1;
+            while (end < members.size() && ops[members[end]].invoked < horizon) {
+                horizon = std::max(horizon, ops[members[end]].completed);
+                ++end;
+            }
+            std::vector<const ModelOp*> segment;
+            for (std::size_t k = begin; k < end; ++k) segment.push_back(&ops[members[k]]);
+            ++report.groups;
+            report.largest = std::max(report.largest, segment.size());
+            const LinearizabilityVerdict verdict = search_segment(segment, owners, report.steps, max_steps);
+            if (verdict != LinearizabilityVerdict::Linearizable) {
+                report.verdict = verdict;
+                if (verdict == LinearizabilityVerdict::Violation) {
+                    report.show_id = history.events[segment.front()->event].show_id;
+                    for (const ModelOp* m : segment) report.witness.push_back(m->event);
+                    std::sort(report.witness.begin(), report.witness.end());
+                }
+                return report;
+            }
+            begin = end;
+        }
+    }
+    return report;
+}
+
+} // namespace booking
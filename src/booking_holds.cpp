@@ -0,0 +1,363 @@
+#include "booking_service.hpp"
+
+#include <optional>
+
+// Seat holds: temporary reservations with TTL, confirmed into bookings or released.
+// Bits are taken with the same CAS protocol as book_seats; the bookkeeping around them
+// (slot allocation, expiry scheduling) is lock-free on the booking threads.
+
+namespace booking {
+
+void BookingService::set_hold_capacity(std::size_t capacity) {
+    std::lock_guard<std::mutex> lock(reaper_mutex_);
+    hold_capacity_ = capacity;
+    hold_slots_.reset(new HoldSlot[capacity]);
+    hold_inbox_.store(kNoSlot);
+    hold_wheel_ = IntrusiveTimerWheel<HoldWheelLinks>(HoldWheelLinks{hold_slots_.get()},
+                                                      hold_clock_ms(std::chrono::steady_clock::now()));
+
+    // Thread every slot onto the free list: slot i -> i + 1
+    for (std::size_t i = 0; i < capacity; ++i) {
+        hold_slots_[i].next.store(i + 1 < capacity ? static_cast<std::uint32_t>(i + 1) : kNoSlot);
+    }
+    hold_free_.store(capacity > 0 ? 0u : kNoSlot);
+}
+
+std::uint64_t BookingService::hold_clock_ms(std::chrono::steady_clock::time_point t) const {
+    if (t <= hold_epoch_) return 0u;
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(t - hold_epoch_).count());
+}
+
+std::uint32_t BookingService::pop_free_hold() {
+    // Treiber stack pop; the tag in the high half defeats ABA when a slot is recycled
+    std::uint64_t head = hold_free_.load(std::memory_order_acquire);
+    while (true) {
+        const std::uint32_t slot = static_cast<std::uint32_t>(head);
+        if (slot == kNoSlot) return kNoSlot;
+        const std::uint32_t next = hold_slots_[slot].next.load(std::memory_order_relaxed);
+        const std::uint64_t desired = (((head >> 32) + 1u) << 32) | next;
+        if (hold_free_.compare_exchange_weak(head, desired, std::memory_order_acquire)) {
+            return slot;
+        }
+    }
+}
+
+void BookingService::push_free_hold(std::uint32_t slot) {
+    std::uint64_t head = hold_free_.load(std::memory_order_relaxed);
+    while (true) {
+        hold_slots_[slot].next.store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+        const std::uint64_t desired = (((head >> 32) + 1u) << 32) | slot;
+        if (hold_free_.compare_exchange_weak(head, desired, std::memory_order_release)) {
+            return;
+        }
+    }
+}
+
+BookingService::HeldWords& BookingService::held_words_of(ShowId show_id) {
+    HeldWords* held = held_words_.find(show_id);
+    if (!held) {
+        std::lock_guard<std::mutex> lock(held_words_mutex_);
+        held = held_words_.find(show_id);
+        if (!held) held = &held_words_.emplace(show_id, [](HeldWords&) {});
+    }
+    return *held;
+}
+
+void BookingService::mark_held(const HoldSlot& h, bool held) {
+    HeldWords& words = held_words_of(id_of(*h.show.load(std::memory_order_relaxed)));
+    const std::uint32_t rows = h.rows.load(std::memory_order_relaxed);
+    for (int k = 0; k < h.row_count.load(std::memory_order_relaxed); ++k) {
+        std::atomic<std::uint64_t>& row = words.rows[(rows >> (8 * k)) & 0xFFu];
+        const std::uint64_t bits = h.bits[static_cast<std::size_t>(k)].load(std::memory_order_relaxed);
+        if (held) {
+            row.fetch_or(bits, std::memory_order_release);
+        } else {
+            row.fetch_and(~bits, std::memory_order_release);
+        }
+    }
+}
+
+int BookingService::held_seats_mask(ShowId show_id, SeatMask& out_held) const {
+    out_held = SeatMask{};
+    const ShowState* st = get_state(show_id);
+    if (!st) return -1;
+    const HeldWords* held = held_words_.find(show_id);
+    if (!held) return 0;
+    int count = 0;
+    for (int w = 0; w < st->word_count; ++w) {
+        const std::uint64_t bits = held->rows[static_cast<std::size_t>(w)].load(std::memory_order_acquire);
+        out_held.or_word(w, bits);
+        count += popcount64(bits);
+    }
+    return count;
+}
+
+int BookingService::seat_states(ShowId show_id, std::vector<std::uint64_t>& out) const {
+    out.clear();
+    const ShowState* st = get_state(show_id);
+    if (!st) return -1;
+    const HeldWords* held = held_words_.find(show_id);
+    out.reserve(static_cast<std::size_t>(st->word_count) * SeatStateRows::kWordsPerRow);
+    for (int w = 0; w < st->word_count; ++w) {
+        const std::uint64_t held_bits =
+            held ? held->rows[static_cast<std::size_t>(w)].load(std::memory_order_acquire) : 0u;
+        const std::uint64_t taken = st->words()[w].load(std::memory_order_acquire);
+        const std::uint64_t blocked = ~st->layout->row_mask(w);
+        const std::uint64_t booked = taken & ~held_bits & ~blocked;
+        const std::uint64_t on_hold = taken & held_bits & ~blocked;
+        for (int half = 0; half < SeatStateRows::kWordsPerRow; ++half) {
+            const int shift = half * seat_states::kSeatsPerWord;
+            out.push_back(seat_states::pack(static_cast<std::uint32_t>(on_hold >> shift),
+                                            static_cast<std::uint32_t>(booked >> shift),
+                                            static_cast<std::uint32_t>(blocked >> shift)));
+        }
+    }
+    return st->layout->seat_count();
+}
+
+void BookingService::release_hold_bits(const HoldSlot& h) {
+    mark_held(h, false); // before the seats are free again
+    ShowState* st = h.show.load(std::memory_order_relaxed);
+    const std::uint32_t rows = h.rows.load(std::memory_order_relaxed);
+    const int row_count = h.row_count.load(std::memory_order_relaxed);
+    std::optional<GroupWrite> group;
+    if (row_count > 1) group.emplace(*st);
+    for (int k = 0; k < row_count; ++k) {
+        const int w = static_cast<int>((rows >> (8 * k)) & 0xFFu);
+        release_word(*st, w, h.bits[static_cast<std::size_t>(k)].load(std::memory_order_relaxed));
+    }
+    group.reset();
+    notify_waitlist(*st);
+}
+
+BookingResult BookingService::hold_seats(ShowId show_id, const std::vector<std::string>& seat_labels,
+                                         std::chrono::milliseconds ttl) {
+    return measured(MetricsApi::HoldSeats, [&] {
+        const ShowState* st = get_state(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (seat_labels.empty()) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+
+        SeatMask req_mask;
+        int bad_index = -1;
+        const BookingStatus parsed = seats_to_mask_or_fail(*st->layout, seat_labels, req_mask, bad_index);
+        if (parsed != BookingStatus::Ok) {
+            return BookingResult::label_error(parsed, bad_index, seat_labels[static_cast<std::size_t>(bad_index)]);
+        }
+        return hold_seat_mask(show_id, req_mask, ttl);
+    });
+}
+
+BookingResult BookingService::hold_seats(ShowHandle& show, const std::vector<std::string>& seat_labels,
+                                         std::chrono::milliseconds ttl) {
+    return measured(MetricsApi::HoldSeats, [&] {
+        ShowState* st = resolve(show);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (seat_labels.empty()) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+
+        SeatMask req_mask;
+        int bad_index = -1;
+        const BookingStatus parsed = seats_to_mask_or_fail(*st->layout, seat_labels, req_mask, bad_index);
+        if (parsed != BookingStatus::Ok) {
+            return BookingResult::label_error(parsed, bad_index, seat_labels[static_cast<std::size_t>(bad_index)]);
+        }
+        return hold_mask_on(st, show.show_id(), req_mask, ttl);
+    });
+}
+
+BookingResult BookingService::hold_seat_mask(ShowId show_id, const SeatMask& seats,
+                                             std::chrono::milliseconds ttl) {
+    return measured(MetricsApi::HoldSeats, [&] { return hold_mask_on(get_state_mut(show_id), show_id, seats, ttl); });
+}
+
+BookingResult BookingService::hold_mask_on(ShowState* st, ShowId show_id, const SeatMask& seats,
+                                           std::chrono::milliseconds ttl) {
+    if (!st) {
+        return BookingResult::error(BookingStatus::InvalidShow);
+    }
+    if (!admit_booker(show_id)) {
+        return BookingResult::error(BookingStatus::Throttled);
+    }
+    if (seats.empty()) {
+        return BookingResult::error(BookingStatus::NoSeats);
+    }
+    if (live_config_) {
+        const std::chrono::milliseconds cap = live_config_->current().max_hold_ttl;
+        if (cap.count() > 0 && ttl > cap) ttl = cap;
+    }
+
+    // Record the touched rows compactly; validate against the layout on the way
+    std::uint32_t rows = 0;
+    int row_count = 0;
+    std::array<std::uint64_t, kMaxHoldRows> bits{};
+    for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+        const std::uint64_t b = seats.word(w);
+        if (b == 0u) continue;
+        const std::uint64_t valid = w < st->word_count ? st->layout->row_mask(w) : 0u;
+        if ((b & ~valid) != 0u) {
+            return BookingResult::error(BookingStatus::InvalidSeatIndex);
+        }
+        if (row_count == kMaxHoldRows) {
+            return BookingResult::error(BookingStatus::HoldTooLarge);
+        }
+        rows |= static_cast<std::uint32_t>(w) << (8 * row_count);
+        bits[static_cast<std::size_t>(row_count)] = b;
+        ++row_count;
+    }
+
+    // Held until the slot is published, so a move_show either sees the hold or waits for it
+    const ShowGate::Pass pass(show_gate_, show_id.value());
+    const std::uint32_t slot = pop_free_hold();
+    if (slot == kNoSlot) {
+        return BookingResult::error(BookingStatus::HoldCapacity);
+    }
+
+    BookingResult res = on_owner(show_id, [&] { return book_mask_on(*st, seats); }, RequestLane::Hold);
+    if (!res.success) {
+        push_free_hold(slot); // never published: reuse with the same generation
+        return res;
+    }
+
+    HoldSlot& h = hold_slots_[slot];
+    h.show.store(st, std::memory_order_relaxed);
+    h.deadline_ms.store(hold_clock_ms(std::chrono::steady_clock::now()) + static_cast<std::uint64_t>(ttl.count()),
+                        std::memory_order_relaxed);
+    h.rows.store(rows, std::memory_order_relaxed);
+    h.row_count.store(static_cast<std::uint8_t>(row_count), std::memory_order_relaxed);
+    for (int k = 0; k < row_count; ++k) {
+        h.bits[static_cast<std::size_t>(k)].store(bits[static_cast<std::size_t>(k)], std::memory_order_relaxed);
+    }
+    mark_held(h, true);
+
+    const std::uint64_t generation = h.state.load(std::memory_order_relaxed) >> 32;
+    h.state.store((generation << 32) | kHoldActive, std::memory_order_release);
+
+    // Hand the new hold to the reaper (lock-free push onto the inbox)
+    std::uint32_t head = hold_inbox_.load(std::memory_order_relaxed);
+    do {
+        h.next.store(head, std::memory_order_relaxed);
+    } while (!hold_inbox_.compare_exchange_weak(head, slot, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+
+    res.id = (generation << 32) | slot;
+    return res;
+}
+
+void BookingService::hold_pass(const HoldSlot& h, std::optional<ShowGate::Pass>& pass) const {
+    // Taken before the settle, so a move_show cannot remap the rows between the settle and their release
+    if (const ShowState* st = h.show.load(std::memory_order_acquire)) pass.emplace(show_gate_, id_of(*st).value());
+}
+
+bool BookingService::settle_hold(HoldId hold_id, HoldPhase phase, HoldSlot*& out_slot) {
+    const std::uint64_t slot = hold_id & 0xFFFFFFFFu;
+    if (slot >= hold_capacity_) return false;
+
+    HoldSlot& h = hold_slots_[slot];
+    std::uint64_t expected = (hold_id & ~std::uint64_t{0xFFFFFFFFu}) | kHoldActive;
+    const std::uint64_t desired = (expected & ~std::uint64_t{0xFFFFFFFFu}) | phase;
+    sim_point();
+    if (!h.state.compare_exchange_strong(expected, desired, std::memory_order_acq_rel)) {
+        return false;
+    }
+    out_slot = &h;
+    return true;
+}
+
+BookingResult BookingService::confirm_hold(HoldId hold_id) {
+    return confirm_hold(hold_id, nullptr);
+}
+
+BookingResult BookingService::confirm_hold(HoldId hold_id, std::uint64_t* commit_lsn) {
+    if (commit_lsn) *commit_lsn = 0;
+    return measured(MetricsApi::ConfirmHold, [&] {
+        const std::uint64_t slot = hold_id & 0xFFFFFFFFu;
+        if (slot >= hold_capacity_) {
+            return BookingResult::error(BookingStatus::UnknownHold);
+        }
+
+        // A hold past its TTL must not be confirmed even if the reaper has not run yet
+        const std::uint64_t now_ms = hold_clock_ms(std::chrono::steady_clock::now());
+        std::optional<ShowGate::Pass> pass;
+        hold_pass(hold_slots_[slot], pass);
+        HoldSlot* h = nullptr;
+        if (now_ms > hold_slots_[slot].deadline_ms.load(std::memory_order_relaxed)) {
+            if (settle_hold(hold_id, kHoldReleased, h)) {
+                release_hold_bits(*h);
+                return BookingResult::error(BookingStatus::HoldExpired);
+            }
+            return BookingResult::error(BookingStatus::UnknownHold);
+        }
+
+        if (!settle_hold(hold_id, kHoldConfirmed, h)) {
+            return BookingResult::error(BookingStatus::UnknownHold);
+        }
+
+        // The held bits simply stay set in the words; they now belong to a regular booking
+        mark_held(*h, false);
+        SeatMask seats;
+        const std::uint32_t rows = h->rows.load(std::memory_order_relaxed);
+        for (int k = 0; k < h->row_count.load(std::memory_order_relaxed); ++k) {
+            seats.or_word(static_cast<int>((rows >> (8 * k)) & 0xFFu),
+                          h->bits[static_cast<std::size_t>(k)].load(std::memory_order_relaxed));
+        }
+        BookingResult res = BookingResult::ok();
+        res.id = record_owner(*h->show.load(std::memory_order_relaxed), seats, commit_lsn);
+        if (commit_lsn && journal_->mode() != JournalMode::Sync) *commit_lsn = 0;
+        return res;
+    });
+}
+
+BookingResult BookingService::release_hold(HoldId hold_id) {
+    return measured(MetricsApi::ReleaseHold, [&] {
+        std::optional<ShowGate::Pass> pass;
+        if ((hold_id & 0xFFFFFFFFu) < hold_capacity_) hold_pass(hold_slots_[hold_id & 0xFFFFFFFFu], pass);
+        HoldSlot* h = nullptr;
+        if (!settle_hold(hold_id, kHoldReleased, h)) {
+            return BookingResult::error(BookingStatus::UnknownHold);
+        }
+        release_hold_bits(*h);
+        return BookingResult::ok();
+    });
+}
+
+std::size_t BookingService::expire_holds(std::chrono::steady_clock::time_point now) {
+    std::unique_lock<std::mutex> lock(reaper_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) return 0;
+
+    // Schedule holds created since the last run
+    std::uint32_t slot = hold_inbox_.exchange(kNoSlot, std::memory_order_acquire);
+    while (slot != kNoSlot) {
+        const std::uint32_t next = hold_slots_[slot].next.load(std::memory_order_relaxed);
+        hold_wheel_.schedule(slot); // links the slot itself: no allocation
+        slot = next;
+    }
+
+    std::size_t expired = 0;
+    hold_wheel_.advance(hold_clock_ms(now), [&](std::uint32_t id) {
+        HoldSlot& h = hold_slots_[id];
+        std::optional<ShowGate::Pass> pass;
+        hold_pass(h, pass);
+        std::uint64_t state = h.state.load(std::memory_order_acquire);
+        const std::uint64_t generation = state >> 32;
+        if ((state & 0xFFFFFFFFu) == kHoldActive
+            && h.state.compare_exchange_strong(state, (generation << 32) | kHoldReleased,
+                                               std::memory_order_acq_rel)) {
+            release_hold_bits(h);
+            ++expired;
+        }
+        // Settled one way or another: recycle the slot under a new generation
+        h.state.store(((generation + 1u) << 32) | kHoldFree, std::memory_order_release);
+        push_free_hold(id);
+    });
+    return expired;
+}
+
+} // namespace booking
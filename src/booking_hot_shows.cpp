@@ -0,0 +1,188 @@
+#include "booking_service.hpp"
+
+#include "trace.hpp"
+
+#include <chrono>
+#include <string>
+
+// Hot shows: in Shared mode a show whose CAS operations keep failing is handed to a few
+// owner threads (or to a flat combiner) until its load drops, so a premiere stops
+// stalling the cores selling it.
+
+namespace booking {
+
+namespace {
+
+std::uint64_t now_ns() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now().time_since_epoch())
+                                          .count());
+}
+
+std::uint64_t window_ns(const HotShowPolicy& policy) {
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(policy.window).count();
+    return ns > 0 ? static_cast<std::uint64_t>(ns) : 1u;
+}
+
+} // namespace
+
+const char* to_string(HotShowStrategy strategy) {
+    switch (strategy) {
+        case HotShowStrategy::OwnerThreads: return "owner-threads";
+        case HotShowStrategy::Combining: return "combining";
+    }
+    return "unknown";
+}
+
+void BookingService::note_cas_retries(ShowState& st, std::uint32_t retries) const {
+    if (retries == 0u) return;
+    trace_instant(TraceStage::CasRetry, retries);
+    const std::uint64_t failures = st.cas_retries.fetch_add(retries, std::memory_order_relaxed) + retries;
+    if (!hot_policy_.enabled || executor_) return;
+    HeatSlot& slot = heat_slot(id_of(st));
+    if (slot.hot.load(std::memory_order_relaxed)) return; // this show or another one is hot already
+
+    const std::uint64_t now = now_ns();
+    const std::uint64_t window = window_ns(hot_policy_);
+    ShowId tracked = slot.show.load(std::memory_order_relaxed);
+    std::uint64_t start = slot.window_start.load(std::memory_order_relaxed);
+    if (tracked == id_of(st) && start != 0u && now - start < window) return;
+    // One thread closes the window (or takes the slot over); the others keep counting into the next one
+    if (!slot.window_start.compare_exchange_strong(start, now, std::memory_order_relaxed)) return;
+    if (tracked != id_of(st)) {
+        slot.show.store(id_of(st), std::memory_order_relaxed);
+        start = 0u;
+    }
+    const std::uint64_t changes = st.changes().load(std::memory_order_relaxed);
+    const std::uint64_t window_failures = failures - slot.retries.exchange(failures, std::memory_order_relaxed);
+    const std::uint64_t window_changes = changes - slot.changes.exchange(changes, std::memory_order_relaxed);
+    if (start == 0u) return; // a first window only sets the baseline
+    // Windows close on the first failure after their end, so scale a longer one back to the window length
+    const double scaled_failures =
+        static_cast<double>(window_failures) * static_cast<double>(window) / static_cast<double>(now - start);
+    if (scaled_failures < static_cast<double>(hot_policy_.promote_min_failures)) return;
+    const double ratio = static_cast<double>(window_failures) / static_cast<double>(window_failures + window_changes);
+    if (ratio >= hot_policy_.promote_failure_ratio) mark_hot(id_of(st), true);
+}
+
+void BookingService::note_hot_request(ShowId show_id) {
+    HeatSlot& slot = heat_slot(show_id);
+    if (!is_hot(show_id)) return; // demoted while this request was queued
+    const std::uint64_t requests = slot.requests.fetch_add(1u, std::memory_order_relaxed) + 1u;
+    const std::uint64_t now = now_ns();
+    const std::uint64_t start = slot.window_start.load(std::memory_order_relaxed);
+    if (now - start < window_ns(hot_policy_)) return;
+    slot.requests.store(0u, std::memory_order_relaxed);
+    slot.window_start.store(now, std::memory_order_relaxed);
+    const double per_second = static_cast<double>(requests) * 1e9 / static_cast<double>(now - start);
+    if (hot_policy_.enabled && per_second < hot_policy_.demote_requests_per_second
+        && !slot.expected.load(std::memory_order_relaxed)) {
+        mark_hot(show_id, false);
+    }
+}
+
+bool BookingService::mark_hot(ShowId show_id, bool hot) const {
+    HeatSlot& slot = heat_slot(show_id);
+    if (!hot) {
+        if (!is_hot(show_id)) return false;
+        bool expected = true;
+        if (!slot.hot.compare_exchange_strong(expected, false, std::memory_order_acq_rel)) return false;
+        slot.expected.store(false, std::memory_order_relaxed);
+        // The next contended update starts a fresh promotion window
+        slot.window_start.store(0u, std::memory_order_relaxed);
+        hot_demotions_.fetch_add(1u, std::memory_order_relaxed);
+        hot_count_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    if (executor_) return false; // OwnerThreads mode: every show already has an owner
+    const bool combining = hot_policy_.strategy == HotShowStrategy::Combining;
+    if (combining && !slot.combiner.load(std::memory_order_acquire)) {
+        const std::lock_guard<std::mutex> lock(hot_mutex_);
+        if (!slot.combiner.load(std::memory_order_relaxed)) {
+            slot.combiner.store(new FlatCombiner(), std::memory_order_release);
+        }
+    } else if (!combining && !hot_executor_.load(std::memory_order_acquire)) {
+        const std::lock_guard<std::mutex> lock(hot_mutex_);
+        if (!hot_executor_owned_) {
+            hot_executor_owned_ = std::make_unique<ShowExecutor>(hot_policy_.workers, ShowExecutor::kDefaultRingCapacity,
+                                                                 numa_placement());
+            hot_executor_.store(hot_executor_owned_.get(), std::memory_order_release);
+        }
+    }
+    // The slot is claimed under its hot flag, so a show sharing it cannot take it over
+    // meanwhile; a caller that reads the fields before they are set just runs the request
+    // inline (or through the other strategy), which is always correct in Shared mode
+    bool expected = false;
+    if (!slot.hot.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) return false;
+    slot.show.store(show_id, std::memory_order_relaxed);
+    slot.combining.store(combining, std::memory_order_relaxed);
+    slot.requests.store(0u, std::memory_order_relaxed);
+    slot.window_start.store(now_ns(), std::memory_order_relaxed);
+    hot_promotions_.fetch_add(1u, std::memory_order_relaxed);
+    hot_count_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool BookingService::set_show_hot(ShowId show_id, bool hot) {
+    if (!get_state(show_id)) return false;
+    mark_hot(show_id, hot);
+    return true;
+}
+
+bool BookingService::show_is_hot(ShowId show_id) const {
+    return get_state(show_id) && is_hot(show_id);
+}
+
+bool BookingService::expect_hot(ShowId show_id, bool expected) {
+    ShowState* st = get_state_mut(show_id); // also decodes a lazily loaded show
+    if (!st) return false;
+    HeatSlot& slot = heat_slot(show_id);
+    if (!expected) {
+        if (is_hot(show_id)) slot.expected.store(false, std::memory_order_relaxed);
+        return true;
+    }
+
+    mark_hot(show_id, true);
+    if (is_hot(show_id)) slot.expected.store(true, std::memory_order_relaxed);
+    {
+        const ShowGate::Pass pass(show_gate_, show_id.value());
+        ensure_owners(*st); // the first booking does not allocate
+    }
+    // Runs where the show's requests will run, so its lines are in that core's cache
+    on_owner(show_id, [&] {
+        std::uint64_t sum = 0;
+        const OwnerRow* rows = st->owners.load(std::memory_order_acquire);
+        const std::atomic<std::uint64_t>* words = st->words();
+        for (int w = 0; w < st->word_count; ++w) {
+            sum += words[w].load(std::memory_order_relaxed);
+            for (int c = 0; rows && c < HallLayout::kMaxRowSeats; c += 8) { // one entry per cache line
+                sum += rows[w].seats[static_cast<std::size_t>(c)].load(std::memory_order_relaxed);
+            }
+        }
+        return sum;
+    });
+    std::string payload;
+    append_cached_on(st, payload);
+    return true;
+}
+
+bool BookingService::show_expected_hot(ShowId show_id) const {
+    return get_state(show_id) && is_hot(show_id) && heat_slot(show_id).expected.load(std::memory_order_relaxed);
+}
+
+HotShowStats BookingService::hot_show_stats() const {
+    HotShowStats s;
+    s.promotions = hot_promotions_.load(std::memory_order_relaxed);
+    s.demotions = hot_demotions_.load(std::memory_order_relaxed);
+    const std::int64_t hot = hot_count_.load(std::memory_order_relaxed);
+    s.hot = hot > 0 ? static_cast<std::uint64_t>(hot) : 0u;
+    for (std::size_t i = 0; i < kHeatSlots; ++i) {
+        if (const FlatCombiner* combiner = heat_slots_[i].combiner.load(std::memory_order_acquire)) {
+            s.combining_passes += combiner->passes();
+            s.combined_requests += combiner->requests();
+        }
+    }
+    return s;
+}
+
+} // namespace booking
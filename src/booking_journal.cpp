@@ -0,0 +1,157 @@
+#include "booking_service.hpp"
+
+#include "trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+// Write-ahead journal hooks and recovery replay. The CAS paths are unchanged: a record is
+// appended after an operation took effect, and replay re-applies operations idempotently.
+
+namespace booking {
+
+namespace {
+
+/** @brief Records per checksum chunk of a parallel replay; smaller journals replay on one thread. */
+constexpr std::size_t kReplayChunk = 4096;
+
+} // namespace
+
+JournalStatus BookingService::open_journal(const std::string& path, JournalMode mode, JournalBackend backend) {
+    auto journal = std::make_unique<Journal>();
+    const JournalStatus status = journal->open(path, mode, Journal::kDefaultRingSlots, backend);
+    if (status == JournalStatus::Ok) journal_ = std::move(journal);
+    return status;
+}
+
+bool BookingService::sync_journal() {
+    return journal_ && journal_->sync();
+}
+
+JournalStatus BookingService::compact_journal(std::uint64_t before_lsn) {
+    return journal_ ? journal_->compact(before_lsn) : JournalStatus::IoError;
+}
+
+bool BookingService::set_journal_commit_wait(Journal::CommitWait wait) {
+    if (!journal_) return false;
+    journal_->set_commit_wait(std::move(wait));
+    return true;
+}
+
+bool BookingService::set_journal_tap(Journal::CommitTap tap) {
+    if (!journal_) return false;
+    journal_->set_commit_tap(std::move(tap));
+    return true;
+}
+
+bool BookingService::wait_journal(std::uint64_t commit_lsn) {
+    return journal_ && journal_->wait_durable(commit_lsn);
+}
+
+void BookingService::journal_commit(JournalOp op, const ShowState& st, BookingId id, const SeatMask& seats) {
+    const TraceScope trace(TraceStage::Journal);
+    const std::uint64_t commit_lsn = journal_->append(op, id_of(st), id, seats);
+    if (journal_->mode() == JournalMode::Sync) journal_->wait_durable(commit_lsn);
+}
+
+JournalReplay BookingService::replay_journal(const std::string& path) {
+    JournalReplay result;
+    MappedFile file(path);
+    if (!file.ok()) return result; // no journal yet: nothing to replay
+    JournalReader reader(file.view());
+    result.status = reader.status();
+    if (result.status != JournalStatus::Ok) return result;
+
+    // Locate the records from their headers alone, then checksum them in parallel: the
+    // journal ends at the first damaged record, as for a sequential read
+    std::vector<JournalSpan> spans;
+    for (JournalSpan span; reader.next_span(span);) spans.push_back(span);
+    ThreadPool& pool = thread_pool();
+    std::atomic<std::size_t> valid{spans.size()};
+    pool.parallel_for(spans.size(), kReplayChunk, [&](std::size_t begin, std::size_t end) {
+        JournalRecord r;
+        for (std::size_t i = begin; i < end && i < valid.load(std::memory_order_relaxed); ++i) {
+            if (reader.decode(spans[i], r)) continue;
+            std::size_t seen = valid.load(std::memory_order_relaxed);
+            while (i < seen && !valid.compare_exchange_weak(seen, i, std::memory_order_relaxed)) {
+            }
+            break;
+        }
+    });
+    spans.resize(valid.load(std::memory_order_relaxed));
+
+    // Each partition owns the shows that hash to it and applies their records in file
+    // order, so per show the order is the journal's while shows replay side by side
+    const std::size_t partitions = spans.size() < kReplayChunk ? 1u : pool.worker_count() + 1u;
+    std::vector<std::vector<std::uint32_t>> owned(partitions);
+    const auto partition_of = [partitions](ShowId show) {
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(show.value()) * 0x9E3779B97F4A7C15ull) >> 32)
+               % partitions;
+    };
+    for (std::size_t i = 0; i < spans.size(); ++i) {
+        owned[partition_of(spans[i].show_id)].push_back(static_cast<std::uint32_t>(i));
+    }
+    std::atomic<std::size_t> applied{0};
+    pool.parallel_for(partitions, 1u, [&](std::size_t begin, std::size_t end) {
+        JournalRecord r;
+        std::size_t mine = 0;
+        for (std::size_t p = begin; p < end; ++p) {
+            for (const std::uint32_t i : owned[p]) {
+                if (reader.decode(spans[i], r) && r.lsn >= replay_from_lsn_ && apply_journal_record(r)) ++mine;
+            }
+        }
+        applied.fetch_add(mine, std::memory_order_relaxed);
+    });
+    result.applied = applied.load(std::memory_order_relaxed);
+    result.skipped = spans.size() - result.applied;
+    return result;
+}
+
+bool BookingService::apply_journal_record(const JournalRecord& r) {
+    ShowState* st = get_state_mut(r.show_id);
+    if (!st || r.booking_id == 0u) return false;
+    const int end = std::min<int>(r.seats.end_word(), st->word_count);
+    const auto apply = [&] {
+        if (r.op == JournalOp::Book) {
+            // Overwrites whatever the snapshot had for these seats
+            OwnerRow* rows = ensure_owners(*st);
+            std::atomic<std::uint64_t>* const words = ensure_words(*st);
+            for (int w = r.seats.first_word(); w < end; ++w) {
+                const std::uint64_t bits = r.seats.word(w) & st->layout->row_mask(w);
+                for (std::uint64_t b = bits; b != 0u; b &= b - 1u) {
+                    rows[w].seats[static_cast<std::size_t>(ctz64(b))].store(r.booking_id, std::memory_order_relaxed);
+                }
+                words[w].fetch_or(bits);
+            }
+            booking_ids_.advance_past(r.booking_id);
+        } else {
+            // Only seats still owned by the booking: a later booking of a freed seat may
+            // have been journaled before this cancellation
+            OwnerRow* rows = st->owners.load(std::memory_order_acquire);
+            for (int w = r.seats.first_word(); rows && w < end; ++w) {
+                for (std::uint64_t b = r.seats.word(w); b != 0u; b &= b - 1u) {
+                    const int col = ctz64(b);
+                    std::atomic<BookingId>& owner = rows[w].seats[static_cast<std::size_t>(col)];
+                    if (owner.load(std::memory_order_relaxed) != r.booking_id) continue;
+                    owner.store(0u, std::memory_order_relaxed);
+                    st->words()[w].fetch_and(~(std::uint64_t{1} << col));
+                }
+            }
+        }
+    };
+    if (r.seats.single_word()) {
+        apply();
+    } else {
+        const GroupWrite group(*st); // replica readers never see half a group booking
+        apply();
+    }
+    st->changes().fetch_add(1u, std::memory_order_release);
+    note_write(*st);
+    note_all_runs(*st);
+    return true;
+}
+
+
+} // namespace booking
@@ -0,0 +1,153 @@
+#include "booking_service.hpp"
+
+// Seat leases: a block of seats booked under a lease id, sold by a remote seller (a kiosk
+// or a partner site) and settled back into bookings of their own (offline_kiosk.hpp).
+// A lease with a TTL returns its unsold seats when expire_leases finds it elapsed.
+
+namespace booking {
+
+namespace {
+
+/** @brief True if every bit of @p seats names a seat of @p layout (@p word_count rows). */
+bool valid_seats(const HallLayout& layout, int word_count, const SeatMask& seats) {
+    for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+        const std::uint64_t valid = w < word_count ? layout.row_mask(w) : 0u;
+        if ((seats.word(w) & ~valid) != 0u) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+BookingResult BookingService::lease_seat_mask(ShowId show_id, const SeatMask& block, std::chrono::milliseconds ttl) {
+    const auto now = std::chrono::steady_clock::now();
+    BookingResult r = measured(MetricsApi::BookSeats, [&] {
+        ShowState* st = get_state_mut(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (block.empty()) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+        if (!valid_seats(*st->layout, st->word_count, block)) {
+            return BookingResult::error(BookingStatus::InvalidSeatIndex);
+        }
+        return on_owner(show_id, [&] {
+            BookingResult r = book_mask_on(*st, block);
+            if (r.success) r.id = record_owner(*st, block, nullptr, false);
+            return r;
+        });
+    });
+    if (r.success && ttl.count() > 0) {
+        std::lock_guard<std::mutex> lock(leases_mutex_);
+        lease_timers_[static_cast<BookingId>(r.id)] = LeaseTimer{show_id, now + ttl};
+    }
+    return r;
+}
+
+BookingResult BookingService::renew_lease(ShowId show_id, BookingId lease_id, std::chrono::milliseconds ttl) {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(leases_mutex_);
+    const auto it = lease_timers_.find(lease_id);
+    if (it != lease_timers_.end() && it->second.show_id == show_id && it->second.deadline <= now) {
+        return BookingResult::error(BookingStatus::HoldExpired); // the seats go back on the next pass
+    }
+    // Not timed here: a lease granted without a TTL, or one from before a restart
+    SeatMask owned;
+    if (lease_id == 0u || booking_seats(show_id, lease_id, owned) <= 0) {
+        return BookingResult::error(BookingStatus::UnknownHold);
+    }
+    if (ttl.count() > 0) {
+        lease_timers_[lease_id] = LeaseTimer{show_id, now + ttl};
+    } else if (it != lease_timers_.end()) {
+        lease_timers_.erase(it);
+    }
+    return BookingResult::ok();
+}
+
+std::size_t BookingService::expire_leases(std::chrono::steady_clock::time_point now) {
+    // Held throughout, so a renewal cannot re-arm a lease whose seats are being returned
+    std::lock_guard<std::mutex> lock(leases_mutex_);
+    std::size_t returned = 0;
+    for (auto it = lease_timers_.begin(); it != lease_timers_.end();) {
+        if (it->second.deadline > now) {
+            ++it;
+            continue;
+        }
+        // A settlement that began before the deadline may move seats meanwhile: look again
+        const ShowId show_id = it->second.show_id;
+        for (SeatMask owned; booking_seats(show_id, it->first, owned) > 0;) {
+            if (cancel_seat_mask(show_id, owned, it->first).success) {
+                returned += static_cast<std::size_t>(owned.count());
+                break;
+            }
+        }
+        it = lease_timers_.erase(it);
+    }
+    return returned;
+}
+
+BookingResult BookingService::settle_lease(ShowId show_id, const SeatMask& seats, BookingId lease_id) {
+    return measured(MetricsApi::BookSeats, [&] {
+        ShowState* st = get_state_mut(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (seats.empty()) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+        if (!valid_seats(*st->layout, st->word_count, seats)) {
+            return BookingResult::error(BookingStatus::InvalidSeatIndex);
+        }
+        {
+            std::lock_guard<std::mutex> lock(leases_mutex_);
+            const auto it = lease_timers_.find(lease_id);
+            if (it != lease_timers_.end() && it->second.deadline <= std::chrono::steady_clock::now()) {
+                return BookingResult::error(BookingStatus::HoldExpired);
+            }
+        }
+        return on_owner(show_id, [&] {
+            OwnerRow* rows = st->owners.load(std::memory_order_acquire);
+            if (!rows || lease_id == 0u) return BookingResult::not_owner(seats);
+
+            // Move every owner entry lease -> booking; a mismatch moves the ones done back
+            const BookingId id = booking_ids_.next();
+            SeatMask moved;
+            SeatMask foreign;
+            for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+                for (std::uint64_t bits = seats.word(w); bits != 0u; bits &= bits - 1u) {
+                    const int seat = HallLayout::seat_index(w, ctz64(bits));
+                    BookingId expected = lease_id;
+                    sim_point();
+                    if (owner_of(rows, seat).compare_exchange_strong(expected, id, std::memory_order_acq_rel)) {
+                        moved.set(seat);
+                    } else {
+                        foreign.set(seat);
+                    }
+                }
+            }
+            if (!foreign.empty()) {
+                for (int w = moved.first_word(); w < moved.end_word(); ++w) {
+                    for (std::uint64_t bits = moved.word(w); bits != 0u; bits &= bits - 1u) {
+                        const int seat = HallLayout::seat_index(w, ctz64(bits));
+                        owner_of(rows, seat).store(lease_id, std::memory_order_release);
+                    }
+                }
+                return BookingResult::not_owner(foreign);
+            }
+
+            note_write(*st); // the owners changed, the seat words did not
+            if (persistent_seats_) persist_seats(*st, seats);
+            if (sales_) {
+                sales_->record_show(show_id, SalesAnalytics::CustomerScope::current(),
+                                    static_cast<std::uint32_t>(seats.count()));
+            }
+            if (journal_) journal_commit(JournalOp::Book, *st, id, seats);
+            BookingResult r = BookingResult::ok();
+            r.id = id;
+            return r;
+        });
+    });
+}
+
+} // namespace booking
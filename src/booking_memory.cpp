@@ -0,0 +1,126 @@
+#include "booking_service.hpp"
+
+#include <algorithm>
+
+// Memory accounting: the bytes of each subsystem (memory_budget.hpp), and the budgets
+// that evict cached renderings and started shows before the process outgrows its limit.
+
+namespace booking {
+
+namespace {
+
+/** @brief Node and bucket overhead of an unordered_map entry, beyond its value. */
+constexpr std::size_t kMapNode = 2 * sizeof(void*);
+
+/** @brief Bytes of an unordered_map whose values are vectors, counting their elements. */
+template <typename Map>
+std::size_t map_of_vectors_bytes(const Map& m) {
+    std::size_t bytes = m.size() * (sizeof(typename Map::value_type) + kMapNode);
+    for (const auto& e : m) bytes += e.second.capacity() * sizeof(typename Map::mapped_type::value_type);
+    return bytes;
+}
+
+template <typename Map>
+std::size_t map_bytes(const Map& m) {
+    return m.size() * (sizeof(typename Map::value_type) + kMapNode);
+}
+
+} // namespace
+
+std::size_t BookingService::catalog_bytes(const Catalog& c) {
+    return sizeof(Catalog) + c.movies.capacity() * sizeof(Movie) + c.theaters.capacity() * sizeof(Theater)
+           + c.shows.bytes() + map_bytes(c.movie_slots) + map_bytes(c.theater_slots)
+           + map_of_vectors_bytes(c.show_index) + map_of_vectors_bytes(c.shows_by_time)
+           + map_of_vectors_bytes(c.theaters_by_movie) + map_of_vectors_bytes(c.theater_grid);
+}
+
+MemoryUsage BookingService::memory_usage() const {
+    std::size_t catalog = 0;
+    std::size_t states = show_state_.bytes();
+    {
+        const std::lock_guard<std::mutex> lock(catalog_mutex_);
+        const Catalog* c = catalog_.load(std::memory_order_acquire);
+        catalog = catalog_bytes(*c) + theater_times_.bytes() + strings_.capacity_bytes() + cold_shows_.bytes();
+        const ShowColumns& columns = c->shows;
+        for (std::size_t i = 0; i < columns.size(); ++i) {
+            const ShowState* st = show_state_.find(columns.ids()[i]);
+            if (!st || st->shared()) continue; // shared words and owners live in the shared region
+            const auto rows = static_cast<std::size_t>(st->word_count);
+            if (st->word_count > ShowState::kInlineWords && !st->cold()) states += rows * sizeof(std::uint64_t);
+            if (st->owners.load(std::memory_order_acquire)) states += rows * sizeof(OwnerRow);
+        }
+    }
+    std::size_t indexes = 0;
+    if (const SeatRunSummary* summary = run_summary_.load(std::memory_order_acquire)) indexes += summary->bytes();
+    if (views_) indexes += views_->bytes();
+    const std::size_t holds = hold_capacity_ * sizeof(HoldSlot) + held_words_.bytes();
+    std::size_t buffers = 0;
+    if (journal_) buffers += journal_->bytes();
+    if (change_feed_) buffers += change_feed_->bytes();
+    if (dedupe_) buffers += dedupe_->bytes();
+
+    memory_.set(MemorySubsystem::Catalog, catalog);
+    memory_.set(MemorySubsystem::States, states);
+    memory_.set(MemorySubsystem::Indexes, indexes);
+    memory_.set(MemorySubsystem::Holds, holds);
+    memory_.set(MemorySubsystem::Buffers, buffers);
+    return memory_.usage();
+}
+
+void BookingService::set_memory_budget(MemorySubsystem subsystem, std::size_t bytes) {
+    memory_.set_budget(subsystem, bytes);
+}
+
+void BookingService::set_memory_budget_total(std::size_t bytes) { memory_.set_total_budget(bytes); }
+
+std::size_t BookingService::evict_cached_availability() {
+    std::vector<ShowId> ids;
+    {
+        const std::lock_guard<std::mutex> lock(catalog_mutex_);
+        const HugeVector<ShowId>& columns = catalog_.load(std::memory_order_acquire)->shows.ids();
+        ids.assign(columns.begin(), columns.end());
+    }
+    std::size_t dropped = 0;
+    for (const ShowId id : ids) {
+        const ShowState* st = show_state_.find(id);
+        if (!st) continue;
+        if (const RenderedSeats* rendered = st->rendered.exchange(nullptr, std::memory_order_acq_rel)) {
+            retire_rendered(rendered);
+            ++dropped;
+        }
+    }
+    return dropped;
+}
+
+MemoryEviction BookingService::enforce_memory_budgets(ShowTime now) {
+    MemoryEviction evicted;
+    MemoryUsage usage = memory_usage();
+    const auto over_total = [&] { return usage.total_budget != 0u && usage.total > usage.total_budget; };
+
+    if (usage.over(MemorySubsystem::Caches) || over_total()) {
+        evicted.renderings = evict_cached_availability();
+        usage = memory_usage();
+    }
+    if (!usage.over(MemorySubsystem::States) && !over_total()) return evicted;
+
+    // Started shows, earliest first: a cutoff just past the start of every eighth of them
+    std::vector<ShowTime> started;
+    {
+        const std::lock_guard<std::mutex> lock(catalog_mutex_);
+        const HugeVector<ShowTime>& starts = catalog_.load(std::memory_order_acquire)->shows.start_times();
+        for (const ShowTime t : starts) {
+            if (t < now) started.push_back(t);
+        }
+    }
+    std::sort(started.begin(), started.end());
+    const std::size_t step = std::max<std::size_t>(1u, started.size() / 8u);
+    for (std::size_t next = step; !started.empty(); next += step) {
+        const std::size_t last = std::min(next, started.size()) - 1u;
+        evicted.shows_archived += archive_shows_before(started[last] + 1);
+        usage = memory_usage();
+        if ((!usage.over(MemorySubsystem::States) && !over_total()) || last + 1u == started.size()) break;
+    }
+    return evicted;
+}
+
+} // namespace booking
@@ -0,0 +1,134 @@
+#include "booking_service.hpp"
+
+#include <cstdio>
+
+// Prometheus text export of the API metrics, the per-show contention counters and the
+// occupancy and hot shows of service_stats.
+
+namespace booking {
+
+namespace {
+
+const char* status_label(std::size_t status) {
+    switch (static_cast<BookingStatus>(status)) {
+        case BookingStatus::Ok: return "ok";
+        case BookingStatus::InvalidShow: return "invalid_show";
+        case BookingStatus::NoSeats: return "no_seats";
+        case BookingStatus::InvalidSeatLabel: return "invalid_seat_label";
+        case BookingStatus::DuplicateSeatLabel: return "duplicate_seat_label";
+        case BookingStatus::AlreadyBooked: return "already_booked";
+        case BookingStatus::InvalidSeatIndex: return "invalid_seat_index";
+        case BookingStatus::Contended: return "contended";
+        case BookingStatus::UnknownHold: return "unknown_hold";
+        case BookingStatus::HoldExpired: return "hold_expired";
+        case BookingStatus::HoldCapacity: return "hold_capacity";
+        case BookingStatus::HoldTooLarge: return "hold_too_large";
+        case BookingStatus::NotOwner: return "not_owner";
+        case BookingStatus::NoContiguousSeats: return "no_contiguous_seats";
+        case BookingStatus::Waitlisted: return "waitlisted";
+        case BookingStatus::Throttled: return "throttled";
+        case BookingStatus::CompanionSeatRule: return "companion_seat_rule";
+        case BookingStatus::SingleSeatGap: return "single_seat_gap";
+        case BookingStatus::ReadOnlyReplica: return "read_only_replica";
+        case BookingStatus::RequestInFlight: return "request_in_flight";
+        case BookingStatus::RequestIdReused: return "request_id_reused";
+        case BookingStatus::TheaterCapReached: return "theater_cap_reached";
+        case BookingStatus::Busy: return "busy";
+        case BookingStatus::DeadlineExceeded: return "deadline_exceeded";
+        case BookingStatus::SalesClosed: return "sales_closed";
+    }
+    return "other";
+}
+
+std::string seconds(double ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9f", ns * 1e-9);
+    return buf;
+}
+
+constexpr std::size_t kPrometheusHotShows = 10; /**< Shows exported as booking_hot_show_requests. */
+
+void counter(std::string& out, const char* name, const char* help, std::uint64_t value) {
+    out += std::string("# HELP ") + name + ' ' + help + "\n# TYPE " + name + " counter\n";
+    out += std::string(name) + ' ' + std::to_string(value) + '\n';
+}
+
+void gauge(std::string& out, const char* name, const char* help, std::uint64_t value) {
+    out += std::string("# HELP ") + name + ' ' + help + "\n# TYPE " + name + " gauge\n";
+    out += std::string(name) + ' ' + std::to_string(value) + '\n';
+}
+
+} // namespace
+
+std::string BookingService::metrics_prometheus() const {
+    std::array<ServiceMetrics::ApiTotals, kMetricsApis> totals;
+    metrics_.collect(totals);
+
+    std::string out;
+    out += "# HELP booking_requests_total Results of public API calls by outcome.\n"
+           "# TYPE booking_requests_total counter\n";
+    for (std::size_t a = 0; a < kMetricsApis; ++a) {
+        for (std::size_t o = 0; o < ServiceMetrics::kOutcomes; ++o) {
+            if (totals[a].outcomes[o] == 0u) continue;
+            out += std::string("booking_requests_total{api=\"") + to_string(static_cast<MetricsApi>(a)) + "\",status=\""
+                   + status_label(o) + "\"} " + std::to_string(totals[a].outcomes[o]) + '\n';
+        }
+    }
+
+    static constexpr const char* kQuantiles[] = {"0.5", "0.9", "0.99", "0.999"};
+    static constexpr double kQuantileValues[] = {0.5, 0.9, 0.99, 0.999};
+    out += "# HELP booking_request_duration_seconds Latency of public API calls.\n"
+           "# TYPE booking_request_duration_seconds summary\n";
+    for (std::size_t a = 0; a < kMetricsApis; ++a) {
+        const LatencyHistogram& h = totals[a].latency;
+        if (h.count() == 0u) continue;
+        const std::string api = std::string("{api=\"") + to_string(static_cast<MetricsApi>(a)) + '"';
+        for (std::size_t q = 0; q < 4u; ++q) {
+            out += "booking_request_duration_seconds" + api + ",quantile=\"" + kQuantiles[q] + "\"} "
+                   + seconds(static_cast<double>(h.percentile(kQuantileValues[q]))) + '\n';
+        }
+        out += "booking_request_duration_seconds_sum" + api + "} "
+               + seconds(h.mean() * static_cast<double>(h.count())) + '\n';
+        out += "booking_request_duration_seconds_count" + api + "} " + std::to_string(h.count()) + '\n';
+    }
+
+    // Contention counters and seat words live in each show's state; sum them over the catalog
+    const ServiceStats stats = service_stats(kPrometheusHotShows);
+    counter(out, "booking_cas_retries_total", "Failed seat CAS attempts that were retried.", stats.contention.cas_retries);
+    counter(out, "booking_contended_total", "Requests that exhausted the CAS retry budget.", stats.contention.contended);
+    counter(out, "booking_conflicts_total", "Requests rejected because a seat was taken.", stats.contention.conflicts);
+    gauge(out, "booking_shows", "Shows in the catalog.", stats.shows);
+    gauge(out, "booking_seats", "Seats of all catalog shows.", stats.seats);
+    gauge(out, "booking_seats_booked", "Seats booked or held.", stats.booked);
+    if (!stats.hot.empty()) {
+        out += "# HELP booking_hot_show_requests Estimated booking attempts of the most requested shows.\n"
+               "# TYPE booking_hot_show_requests gauge\n";
+        for (const HotShow& hot : stats.hot) {
+            out += "booking_hot_show_requests{show=\"" + to_string(hot.show_id) + "\"} " + std::to_string(hot.requests)
+                   + '\n';
+        }
+    }
+
+    const std::vector<SloStatus> slos = slo_status();
+    if (!slos.empty()) {
+        char value[32];
+        out += "# HELP booking_slo_compliance Share of calls within the SLO latency threshold over the SLO window.\n"
+               "# TYPE booking_slo_compliance gauge\n";
+        for (const SloStatus& s : slos) {
+            std::snprintf(value, sizeof(value), "%.6f", s.compliance);
+            out += std::string("booking_slo_compliance{api=\"") + to_string(s.budget.api) + "\"} " + value + '\n';
+        }
+        out += "# HELP booking_slo_burn_rate Error budget burn rate (1 = spent exactly over the window).\n"
+               "# TYPE booking_slo_burn_rate gauge\n";
+        for (const SloStatus& s : slos) {
+            const std::string api = std::string("booking_slo_burn_rate{api=\"") + to_string(s.budget.api);
+            std::snprintf(value, sizeof(value), "%.6f", s.burn_rate);
+            out += api + "\",window=\"long\"} " + value + '\n';
+            std::snprintf(value, sizeof(value), "%.6f", s.short_burn_rate);
+            out += api + "\",window=\"short\"} " + value + '\n';
+        }
+    }
+    return out;
+}
+
+} // namespace booking
@@ -0,0 +1,163 @@
+#include "booking_service.hpp"
+
+#include <algorithm>
+
+// Moving a show to another hall while it keeps selling: the show is frozen on show_gate_,
+// its seats, owners and active holds are translated to the new layout, and the catalog row
+// is repointed. Every other show is untouched throughout.
+
+namespace booking {
+
+const char* to_string(MoveStatus status) {
+    switch (status) {
+        case MoveStatus::Ok: return "Ok";
+        case MoveStatus::UnknownShow: return "Unknown show";
+        case MoveStatus::UnknownLayout: return "Unknown layout";
+        case MoveStatus::SeatLost: return "A taken seat has no seat in the new hall";
+        case MoveStatus::SeatClash: return "Two taken seats translate to the same seat";
+        case MoveStatus::HoldTooWide: return "A hold would span too many rows";
+        case MoveStatus::Unsupported: return "Show cannot be moved";
+    }
+    return "Unknown";
+}
+
+MoveStatus BookingService::move_show(ShowId show_id, LayoutId layout_id, int hall, Span<const int> translation) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    const Catalog* catalog = catalog_.load(std::memory_order_relaxed); // only writers store it
+    if (catalog->shows.find(show_state_.position(show_id)) == catalog->shows.size()) return MoveStatus::UnknownShow;
+    ShowState* st = get_state_mut(show_id); // decodes a lazily loaded show before the freeze
+    if (!st) return MoveStatus::UnknownShow;
+    if (!layouts_.contains(layout_id)) return MoveStatus::UnknownLayout;
+    if (st->shared() || journal_) return MoveStatus::Unsupported;
+
+    const HallLayout& to = layouts_.at(layout_id);
+    std::vector<int> by_label;
+    if (translation.empty()) {
+        by_label = st->layout->translate_to(to);
+        translation = Span<const int>(by_label);
+    }
+
+    show_gate_.freeze(show_id.value());
+    const MoveStatus status = remap_frozen(*st, to, translation);
+    if (status == MoveStatus::Ok) show_moves_.fetch_add(1u, std::memory_order_release); // before the thaw
+    show_gate_.thaw();
+
+    // The catalog copy is made after the thaw, so its cost is not part of the pause
+    if (status == MoveStatus::Ok) relocate_show_locked(show_id, layout_id, hall);
+    return status;
+}
+
+MoveStatus BookingService::remap_frozen(ShowState& st, const HallLayout& to, Span<const int> table) {
+    const auto target_of = [&](int seat) {
+        const int target = static_cast<std::size_t>(seat) < table.size() ? table[static_cast<std::size_t>(seat)] : -1;
+        return target >= 0 && to.contains(target) ? target : -1;
+    };
+
+    // Seats and their owners; nothing is written until everything has translated
+    const int rows = to.row_count();
+    std::array<std::uint64_t, HallLayout::kMaxRows> words{};
+    std::array<std::uint64_t, HallLayout::kMaxRows> old_words{};
+    OwnerRow* old_owners = st.owners.load(std::memory_order_acquire);
+    std::unique_ptr<OwnerRow[]> owners;
+    if (old_owners) owners.reset(new OwnerRow[static_cast<std::size_t>(rows)]()); // value-init: all 0
+    const std::atomic<std::uint64_t>* from = st.words();
+    for (int w = 0; w < st.word_count; ++w) {
+        old_words[static_cast<std::size_t>(w)] = from[w].load(std::memory_order_relaxed);
+        for (std::uint64_t bits = old_words[static_cast<std::size_t>(w)]; bits != 0u; bits &= bits - 1u) {
+            const int seat = HallLayout::seat_index(w, ctz64(bits));
+            const int target = target_of(seat);
+            if (target < 0) return MoveStatus::SeatLost;
+            const std::uint64_t bit = std::uint64_t{1} << HallLayout::col_of(target);
+            std::uint64_t& word = words[static_cast<std::size_t>(HallLayout::row_of(target))];
+            if ((word & bit) != 0u) return MoveStatus::SeatClash;
+            word |= bit;
+            if (owners) {
+                owner_of(owners.get(), target).store(owner_of(old_owners, seat).load(std::memory_order_relaxed),
+                                                     std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Active holds of the show (their seats are among the bits above, so they translate)
+    struct HeldRows {
+        HoldSlot* slot;
+        std::uint32_t rows;
+        int row_count;
+        std::array<std::uint64_t, kMaxHoldRows> bits;
+    };
+    std::vector<HeldRows> holds;
+    for (std::size_t i = 0; i < hold_capacity_; ++i) {
+        HoldSlot& h = hold_slots_[i];
+        if ((h.state.load(std::memory_order_acquire) & 0xFFFFFFFFu) != kHoldActive) continue;
+        if (h.show.load(std::memory_order_relaxed) != &st) continue;
+        std::array<std::uint64_t, HallLayout::kMaxRows> held{};
+        const std::uint32_t old_rows = h.rows.load(std::memory_order_relaxed);
+        for (int k = 0; k < h.row_count.load(std::memory_order_relaxed); ++k) {
+            const int w = static_cast<int>((old_rows >> (8 * k)) & 0xFFu);
+            for (std::uint64_t bits = h.bits[static_cast<std::size_t>(k)].load(std::memory_order_relaxed); bits != 0u;
+                 bits &= bits - 1u) {
+                const int target = target_of(HallLayout::seat_index(w, ctz64(bits)));
+                if (target < 0) return MoveStatus::SeatLost;
+                held[static_cast<std::size_t>(HallLayout::row_of(target))] |= std::uint64_t{1}
+                                                                              << HallLayout::col_of(target);
+            }
+        }
+        HeldRows moved{&h, 0u, 0, {}};
+        for (int w = 0; w < rows; ++w) {
+            if (held[static_cast<std::size_t>(w)] == 0u) continue;
+            if (moved.row_count == kMaxHoldRows) return MoveStatus::HoldTooWide;
+            moved.rows |= static_cast<std::uint32_t>(w) << (8 * moved.row_count);
+            moved.bits[static_cast<std::size_t>(moved.row_count++)] = held[static_cast<std::size_t>(w)];
+        }
+        holds.push_back(moved);
+    }
+
+    // Storage: reused if it has room for the new rows, else allocated as by init; replaced
+    // words and owners stay allocated for readers that loaded the old pointers
+    if (st.cold()) ensure_words(st); // its rows are rewritten below
+    std::atomic<std::uint64_t>* const current = st.words();
+    const int capacity = current == st.inline_words ? ShowState::kInlineWords : int{st.word_count};
+    std::atomic<std::uint64_t>* storage = current;
+    if (rows > capacity) {
+        if (st.heap_words) moved_words_.push_back(std::move(st.heap_words));
+        st.heap_words.reset(new std::atomic<std::uint64_t>[static_cast<std::size_t>(rows)]());
+        storage = st.heap_words.get();
+    }
+
+    const ShowId show_id = id_of(st);
+    const int touched = std::max<int>(st.word_count, rows);
+    const int written = storage == current ? touched : rows; // reused storage: clear the rows left behind
+    {
+        const GroupWrite group(st);
+        for (int w = 0; w < written; ++w) storage[w].store(words[static_cast<std::size_t>(w)], std::memory_order_relaxed);
+        st.word_array.store(storage, std::memory_order_release); // readers load it with acquire
+        st.word_count = static_cast<std::int16_t>(rows);
+        st.layout = &to;
+        if (owners) moved_owners_.emplace_back(st.owners.exchange(owners.release(), std::memory_order_acq_rel));
+        if (HeldWords* held = held_words_.find(show_id)) { // rebuilt from the translated holds
+            for (std::atomic<std::uint64_t>& row : held->rows) row.store(0u, std::memory_order_relaxed);
+        }
+        for (const HeldRows& moved : holds) {
+            moved.slot->rows.store(moved.rows, std::memory_order_relaxed);
+            moved.slot->row_count.store(static_cast<std::uint8_t>(moved.row_count), std::memory_order_relaxed);
+            for (int k = 0; k < moved.row_count; ++k) {
+                moved.slot->bits[static_cast<std::size_t>(k)].store(moved.bits[static_cast<std::size_t>(k)],
+                                                                   std::memory_order_relaxed);
+            }
+            mark_held(*moved.slot, true);
+        }
+    }
+    st.changes().fetch_add(1u, std::memory_order_release);
+    note_write(st);
+    note_all_runs(st);
+    if (change_feed_) {
+        for (int w = 0; w < touched; ++w) {
+            const std::uint64_t before = old_words[static_cast<std::size_t>(w)];
+            const std::uint64_t after = words[static_cast<std::size_t>(w)];
+            if (before != after) change_feed_->publish(show_id, w, before, after);
+        }
+    }
+    return MoveStatus::Ok;
+}
+
+} // namespace booking
@@ -0,0 +1,161 @@
+#include "booking_service.hpp"
+#include "seat_runs.hpp"
+
+// Partial bookings: each row's CAS takes whichever requested seats the replaced word has free.
+
+namespace booking {
+
+BookingResult BookingService::book_any_seats(ShowId show_id, const std::vector<std::string>& seat_labels,
+                                             SeatMask& out_seats) {
+    return measured(MetricsApi::BookSeats, [&] {
+        out_seats = SeatMask{};
+        ShowState* st = get_state_mut(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (!admit_booker(show_id)) {
+            return BookingResult::error(BookingStatus::Throttled);
+        }
+        if (seat_labels.empty()) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+        SeatMask req_mask;
+        int bad_index = -1;
+        const BookingStatus parsed = seats_to_mask_or_fail(*st->layout, seat_labels, req_mask, bad_index);
+        if (parsed != BookingStatus::Ok) {
+            return BookingResult::label_error(parsed, bad_index, seat_labels[static_cast<std::size_t>(bad_index)]);
+        }
+        return on_owner(show_id, [&] { return book_any_on(*st, req_mask, out_seats); });
+    });
+}
+
+BookingResult BookingService::book_any_seat_mask(ShowId show_id, const SeatMask& seats, SeatMask& out_seats) {
+    return measured(MetricsApi::BookSeats, [&] {
+        out_seats = SeatMask{};
+        ShowState* st = get_state_mut(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (!admit_booker(show_id)) {
+            return BookingResult::error(BookingStatus::Throttled);
+        }
+        if (seats.empty()) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+        for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+            const std::uint64_t valid = w < st->word_count ? st->layout->row_mask(w) : 0u;
+            if ((seats.word(w) & ~valid) != 0u) {
+                return BookingResult::error(BookingStatus::InvalidSeatIndex);
+            }
+        }
+        return on_owner(show_id, [&] { return book_any_on(*st, seats, out_seats); });
+    });
+}
+
+BookingService::Acquire BookingService::try_acquire_free(ShowState& st, int w, std::uint64_t req,
+                                                         std::uint64_t& out_got, std::uint32_t& retries) const {
+    std::optional<GroupWrite> group; // with a feed, the CAS and its feed entry are one group write
+    if (change_feed_) group.emplace(st);
+    std::atomic<std::uint64_t>& word = ensure_words(st)[w];
+    const HallLayout& layout = *st.layout;
+    const bool rules = layout.has_booking_rules();
+    CapacityCounter* const cap = capacity_of(st);
+    Backoff backoff(backoff_policy());
+    std::uint64_t current = word.load(seat_words::kWordLoad);
+    while (true) {
+        if (st.sales.load(std::memory_order_acquire) != 0u) {
+            retries += backoff.retries();
+            return Acquire::Closed;
+        }
+        const std::uint64_t got = req & ~current;
+        if (got == 0u) {
+            retries += backoff.retries();
+            return Acquire::Conflict;
+        }
+        const std::uint64_t desired = current | got;
+        if (rules) {
+            if (!layout.companion_rule_ok(w, got, desired)) {
+                retries += backoff.retries();
+                return Acquire::Rejected;
+            }
+            const std::uint64_t seats = layout.row_mask(w);
+            if (layout.forbids_single_gaps()
+                && (isolated_seats(~desired & seats) & ~isolated_seats(~current & seats)) != 0u) {
+                retries += backoff.retries();
+                return Acquire::Gap;
+            }
+        }
+        // The free part changes with the word: reserved per attempt, given back if the CAS fails
+        if (cap && !cap->try_reserve(popcount64(got))) {
+            retries += backoff.retries();
+            return Acquire::OverCap;
+        }
+        sim_point();
+        if (word.compare_exchange_weak(current, desired, seat_words::kWordUpdate, seat_words::kWordLoad)) {
+            retries += backoff.retries();
+            st.changes().fetch_add(1u, std::memory_order_release);
+            note_write(st);
+            note_runs(st, w);
+            if (change_feed_) change_feed_->publish(id_of(st), w, current, desired);
+            out_got = got;
+            return Acquire::Acquired;
+        }
+        if (cap) cap->release(popcount64(got));
+        // A new value of the word: its free part is recomputed on the next pass
+        if (!backoff.retry()) {
+            retries += backoff.retries() - 1u;
+            return Acquire::Contended;
+        }
+    }
+}
+
+BookingResult BookingService::book_any_on(ShowState& st, const SeatMask& req, SeatMask& out_seats) {
+    SeatMask got;
+    BookingStatus skipped = BookingStatus::AlreadyBooked; // why no seat was obtained
+    std::uint32_t retries = 0;
+    bool contended = false;
+    const auto take_rows = [&] {
+        for (int w = req.first_word(); w < req.end_word() && !contended; ++w) {
+            const std::uint64_t bits = req.word(w);
+            if (bits == 0u) continue;
+            std::uint64_t row_got = 0u;
+            switch (try_acquire_free(st, w, bits, row_got, retries)) {
+                case Acquire::Acquired: got.or_word(w, row_got); break;
+                case Acquire::Conflict: break;
+                case Acquire::Rejected: skipped = BookingStatus::CompanionSeatRule; break;
+                case Acquire::Gap: skipped = BookingStatus::SingleSeatGap; break;
+                case Acquire::OverCap: skipped = BookingStatus::TheaterCapReached; break;
+                case Acquire::Closed: skipped = BookingStatus::SalesClosed; break;
+                case Acquire::Contended: contended = true; break;
+            }
+        }
+        if (contended && !got.empty()) release_mask(st, got);
+    };
+    if (req.single_word()) {
+        take_rows();
+    } else {
+        const GroupWrite group(st);
+        take_rows();
+    }
+    note_cas_retries(st, retries);
+
+    if (contended) {
+        st.contended.fetch_add(1, std::memory_order_relaxed);
+        return BookingResult::error(BookingStatus::Contended);
+    }
+    if (got.empty()) {
+        if (skipped != BookingStatus::AlreadyBooked) return BookingResult::error(skipped);
+        st.conflicts.fetch_add(1, std::memory_order_relaxed);
+        return BookingResult::conflict(req);
+    }
+    BookingResult res = BookingResult::ok();
+    for (int w = req.first_word(); w < req.end_word(); ++w) {
+        const std::uint64_t missed = req.word(w) & ~got.word(w);
+        if (missed != 0u) res.conflicts.or_word(w, missed);
+    }
+    out_seats = got;
+    res.id = record_owner(st, got);
+    return res;
+}
+
+} // namespace booking
@@ -0,0 +1,125 @@
+#include "booking_pipeline.hpp"
+
+#include <chrono>
+
+namespace booking {
+
+namespace {
+
+constexpr int kSpinPolls = 256;                             /**< Empty polls before a worker parks. */
+constexpr auto kParkTimeout = std::chrono::milliseconds(1); /**< Safety net for a missed wake-up. */
+
+} // namespace
+
+BookingPipeline::BookingPipeline(BookingService& service, unsigned workers, std::size_t max_queue_depth)
+    : service_(service), max_queue_depth_(max_queue_depth) {
+    if (workers == 0u) workers = std::thread::hardware_concurrency();
+    if (workers == 0u) workers = 1u;
+    workers_.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i) workers_.push_back(std::make_unique<Worker>());
+    for (auto& w : workers_) {
+        Worker* worker = w.get();
+        w->thread = std::thread([this, worker] { worker_loop(*worker); });
+    }
+}
+
+BookingPipeline::~BookingPipeline() {
+    stopping_.store(true, std::memory_order_seq_cst);
+    for (auto& w : workers_) {
+        std::lock_guard<std::mutex> lock(w->park_mutex);
+        w->park_cv.notify_one();
+    }
+    for (auto& w : workers_) w->thread.join();
+}
+
+BookingResult BookingPipeline::prepare(PipelineRequest& request, ShowId show_id,
+                                       Span<const std::string_view> seat_labels) {
+    request.show_id = show_id;
+    BookingResult res = service_.parse_seat_labels(show_id, seat_labels, request.seats);
+    (res.success ? prepared_ : rejected_).fetch_add(1u, std::memory_order_relaxed);
+    return res;
+}
+
+bool BookingPipeline::submit(PipelineRequest& request) {
+    Worker& w = *workers_[worker_of(request.show_id)];
+    // Reserve a queue slot first, so concurrent submitters cannot overshoot the bound
+    const std::size_t depth = w.depth.fetch_add(1u, std::memory_order_relaxed) + 1u;
+    if (max_queue_depth_ != 0u && depth > max_queue_depth_) {
+        w.depth.fetch_sub(1u, std::memory_order_relaxed);
+        w.busy.fetch_add(1u, std::memory_order_relaxed);
+        request.result = BookingResult::error(BookingStatus::Busy);
+        return false;
+    }
+    std::size_t seen = w.max_depth.load(std::memory_order_relaxed);
+    while (depth > seen && !w.max_depth.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {
+    }
+    w.queue.push(&request);
+
+    // Pairs with the fence in worker_loop: either the worker sees the request or we see it parked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (w.parked.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(w.park_mutex);
+        w.parked.store(false, std::memory_order_relaxed);
+        w.park_cv.notify_one();
+    }
+    return true;
+}
+
+PipelineStats BookingPipeline::stats() const {
+    PipelineStats out;
+    out.prepared = prepared_.load(std::memory_order_relaxed);
+    out.rejected = rejected_.load(std::memory_order_relaxed);
+    for (const auto& w : workers_) {
+        out.booked += w->booked.load(std::memory_order_relaxed);
+        out.busy += w->busy.load(std::memory_order_relaxed);
+        out.queued += w->depth.load(std::memory_order_relaxed);
+        const std::uint64_t deepest = w->max_depth.load(std::memory_order_relaxed);
+        if (deepest > out.max_queued) out.max_queued = deepest;
+    }
+    return out;
+}
+
+std::size_t BookingPipeline::drain(Worker& w) {
+    std::size_t ran = 0;
+    while (MpscNode* node = w.queue.pop()) {
+        PipelineRequest& request = *static_cast<PipelineRequest*>(node);
+        request.result = service_.book_seat_mask(request.show_id, request.seats);
+        w.booked.store(w.booked.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+        w.depth.fetch_sub(1u, std::memory_order_relaxed);
+        if (request.done) request.done(request); // the caller may free it from here on
+        ++ran;
+    }
+    return ran;
+}
+
+void BookingPipeline::worker_loop(Worker& w) {
+    int idle = 0;
+    while (true) {
+        if (drain(w) != 0u) {
+            idle = 0;
+            continue;
+        }
+        if (stopping_.load(std::memory_order_acquire)) {
+            if (drain(w) == 0u) break; // submitted before the stop request
+            continue;
+        }
+        if (++idle < kSpinPolls) continue;
+
+        // Announce parking, then look once more (Dekker with submit)
+        w.parked.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (drain(w) != 0u) {
+            w.parked.store(false, std::memory_order_relaxed);
+            idle = 0;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(w.park_mutex);
+        w.park_cv.wait_for(lock, kParkTimeout, [&] {
+            return !w.parked.load(std::memory_order_relaxed) || stopping_.load(std::memory_order_acquire);
+        });
+        w.parked.store(false, std::memory_order_relaxed);
+        idle = 0;
+    }
+}
+
+} // namespace booking
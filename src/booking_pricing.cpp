@@ -0,0 +1,111 @@
+#include "booking_service.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+// Dynamic pricing: occupancy steps computed in bulk by a background pass and published as
+// one read-only price table per pass, swapped in with a pointer and reclaimed by epochs.
+
+namespace booking {
+
+namespace {
+
+/** @brief Shows per parallel chunk of a repricing pass. */
+constexpr std::size_t kPricingChunk = 4096;
+
+} // namespace
+
+std::size_t BookingService::reprice() {
+    std::lock_guard<std::mutex> pass(pricing_mutex_);
+    const std::vector<PriceStep>& steps = pricing_policy_.steps;
+    if (steps.empty()) return 0;
+
+    auto* table = new PriceTable;
+    {
+        EpochManager::Guard guard(catalog_epochs_);
+        const ShowColumns& shows = catalog_.load(std::memory_order_acquire)->shows;
+        const std::size_t count = shows.size();
+        std::vector<std::uint32_t> order(count); // rows by show id
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(),
+                  [&](std::uint32_t a, std::uint32_t b) { return shows.ids()[a] < shows.ids()[b]; });
+        table->shows.resize(count);
+        table->adjust.assign(count, 0);
+        thread_pool().parallel_for(count, kPricingChunk, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const ShowId id = shows.ids()[order[i]];
+                table->shows[i] = id;
+                const ShowState* st = get_state(id);
+                if (!st || st->layout->seat_count() == 0) continue;
+                int taken = 0;
+                const std::atomic<std::uint64_t>* words = st->words();
+                for (int w = 0; w < st->word_count; ++w) {
+                    taken += popcount64(words[w].load(std::memory_order_relaxed) & st->layout->row_mask(w));
+                }
+                const double occupancy = static_cast<double>(taken) / st->layout->seat_count();
+                for (const PriceStep& step : steps) {
+                    if (occupancy < step.min_occupancy) break;
+                    table->adjust[i] = static_cast<std::int16_t>(step.adjust_percent);
+                }
+            }
+        });
+    }
+
+    const PriceTable* old = price_table_.exchange(table, std::memory_order_acq_rel);
+    if (old) pricing_epochs_.retire(old);
+    price_table_version_.fetch_add(1u, std::memory_order_relaxed);
+    return table->shows.size();
+}
+
+void BookingService::set_dynamic_pricing(const PricingPolicy& policy) {
+    if (pricing_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(pricing_loop_mutex_);
+            pricing_stop_ = true;
+        }
+        pricing_cv_.notify_all();
+        pricing_thread_.join();
+        pricing_stop_ = false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pricing_mutex_);
+        pricing_policy_ = policy;
+        for (PriceStep& step : pricing_policy_.steps) step.adjust_percent = std::clamp(step.adjust_percent, -100, 10000);
+        std::stable_sort(pricing_policy_.steps.begin(), pricing_policy_.steps.end(),
+                         [](const PriceStep& a, const PriceStep& b) { return a.min_occupancy < b.min_occupancy; });
+    }
+    if (policy.steps.empty()) {
+        if (const PriceTable* old = price_table_.exchange(nullptr, std::memory_order_acq_rel)) {
+            pricing_epochs_.retire(old);
+        }
+        return;
+    }
+    reprice();
+    const std::chrono::milliseconds interval = std::max(policy.interval, std::chrono::milliseconds(1));
+    pricing_thread_ = std::thread([this, interval] {
+        std::unique_lock<std::mutex> lock(pricing_loop_mutex_);
+        while (!pricing_cv_.wait_for(lock, interval, [this] { return pricing_stop_; })) {
+            lock.unlock();
+            reprice();
+            lock.lock();
+        }
+    });
+}
+
+int BookingService::price_adjustment(ShowId show_id) const {
+    EpochManager::Guard guard(pricing_epochs_);
+    const PriceTable* table = price_table_.load(std::memory_order_acquire);
+    if (!table) return 0;
+    const auto it = std::lower_bound(table->shows.begin(), table->shows.end(), show_id);
+    if (it == table->shows.end() || *it != show_id) return 0;
+    return table->adjust[static_cast<std::size_t>(it - table->shows.begin())];
+}
+
+std::uint64_t BookingService::price_quote(ShowId show_id, const SeatMask& seats) const {
+    const HallLayout* layout = layout_for_show(show_id);
+    if (!layout) return 0;
+    const std::uint64_t base = layout->price_of(seats);
+    return base * static_cast<std::uint64_t>(100 + price_adjustment(show_id)) / 100u;
+}
+
+} // namespace booking
@@ -0,0 +1,108 @@
+#include "booking_service.hpp"
+
+#include <array>
+
+// Read mirror: a refresher copies the free words of every show into a table of its own, so
+// availability readers stop pulling the lines writers CAS on into their caches.
+
+namespace booking {
+
+namespace {
+
+/** @brief Seqlock re-reads before a reader gives up on the mirror and reads live. */
+constexpr int kMirrorAttempts = 4;
+
+} // namespace
+
+bool BookingService::SeatMirror::load(int count, std::uint64_t* out) const {
+    for (int attempt = 0; attempt < kMirrorAttempts; ++attempt) {
+        const std::uint64_t before = seq.load(std::memory_order_acquire);
+        if (before == 0u) return false; // never written
+        if ((before & 1u) != 0u) continue;
+        if (word_count.load(std::memory_order_relaxed) != count) return false;
+        const std::atomic<std::uint64_t>* words =
+            count <= kInlineWords ? inline_words : heap_words.load(std::memory_order_relaxed);
+        for (int w = 0; w < count; ++w) out[w] = words[w].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == before) return true;
+    }
+    return false; // the refresher keeps rewriting it: the live words are as cheap
+}
+
+void BookingService::load_read_words(const ShowState& st, std::uint64_t* out) const {
+    if (mirror_reads_.load(std::memory_order_relaxed)) {
+        const SeatMirror* mirror = mirrors_.find(id_of(st));
+        if (mirror && mirror->load(st.word_count, out)) return;
+    }
+    load_free_words(st, out);
+}
+
+std::size_t BookingService::refresh_read_mirrors() {
+    std::lock_guard<std::mutex> lock(mirror_mutex_);
+    EpochManager::Guard guard(catalog_epochs_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    std::size_t refreshed = 0;
+    for (ShowId show_id : c->shows.ids()) {
+        const ShowState* st = get_state(show_id);
+        if (!st) continue;
+        load_free_words(*st, free_words.data());
+        const int count = st->word_count;
+        SeatMirror* mirror = mirrors_.find(show_id);
+        if (!mirror) {
+            mirror = &mirrors_.emplace(show_id, [](SeatMirror&) {});
+        }
+        std::atomic<std::uint64_t>* words = mirror->inline_words;
+        if (count > SeatMirror::kInlineWords) {
+            words = mirror->heap_words.load(std::memory_order_relaxed);
+            if (!words) {
+                // Sized for any layout, so a reader never sees the array replaced
+                words = new std::atomic<std::uint64_t>[HallLayout::kMaxRows]{};
+                mirror->heap_words.store(words, std::memory_order_relaxed); // published by the seq below
+            }
+        }
+        const std::uint64_t seq = mirror->seq.load(std::memory_order_relaxed);
+        if (seq != 0u && mirror->word_count.load(std::memory_order_relaxed) == count) {
+            bool same = true;
+            for (int w = 0; w < count && same; ++w) same = words[w].load(std::memory_order_relaxed) == free_words[w];
+            if (same) continue;
+        }
+        mirror->seq.store(seq + 1u, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release); // odd before any word changes
+        mirror->word_count.store(count, std::memory_order_relaxed);
+        for (int w = 0; w < count; ++w) words[w].store(free_words[w], std::memory_order_relaxed);
+        mirror->seq.store(seq + 2u, std::memory_order_release);
+        ++refreshed;
+    }
+    return refreshed;
+}
+
+void BookingService::set_read_mirror(std::chrono::microseconds refresh) {
+    if (mirror_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mirror_thread_mutex_);
+            mirror_stop_ = true;
+        }
+        mirror_cv_.notify_all();
+        mirror_thread_.join();
+        mirror_stop_ = false;
+    }
+    mirror_refresh_ = refresh;
+    if (refresh <= std::chrono::microseconds::zero()) {
+        mirror_refresh_ = std::chrono::microseconds::zero();
+        mirror_reads_.store(false, std::memory_order_relaxed);
+        return;
+    }
+    refresh_read_mirrors(); // readers start from a complete mirror
+    mirror_reads_.store(true, std::memory_order_relaxed);
+    mirror_thread_ = std::thread([this, refresh] {
+        std::unique_lock<std::mutex> lock(mirror_thread_mutex_);
+        while (!mirror_cv_.wait_for(lock, refresh, [this] { return mirror_stop_; })) {
+            lock.unlock();
+            refresh_read_mirrors();
+            lock.lock();
+        }
+    });
+}
+
+} // namespace booking
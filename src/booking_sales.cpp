@@ -0,0 +1,56 @@
+#include "booking_service.hpp"
+
+// Sales windows: each show carries its SalesState in the first cache line of its seat state,
+// where the booking CAS loops read it. Opening is a store; closing also drains the show on
+// show_gate_, so nothing books it after the call returns.
+
+namespace booking {
+
+const char* to_string(SalesState state) {
+    switch (state) {
+        case SalesState::Open: return "open";
+        case SalesState::NotOpen: return "not open";
+        case SalesState::Closed: return "closed";
+        case SalesState::Blackout: return "blackout";
+    }
+    return "unknown";
+}
+
+bool BookingService::set_sales_state(ShowId show_id, SalesState state) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_); // one freeze at a time (see move_show)
+    ShowState* st = get_state_mut(show_id);
+    if (!st) return false;
+    const auto previous = st->sales.exchange(static_cast<std::uint8_t>(state), std::memory_order_acq_rel);
+    if (state != SalesState::Open && previous == static_cast<std::uint8_t>(SalesState::Open)) {
+        // Requests that read Open before the store finish their CAS before the thaw
+        show_gate_.freeze(show_id.value());
+        show_gate_.thaw();
+    }
+    return true;
+}
+
+SalesState BookingService::sales_state(ShowId show_id) const {
+    const ShowState* st = get_state(show_id);
+    if (!st) return SalesState::Closed;
+    return static_cast<SalesState>(st->sales.load(std::memory_order_acquire));
+}
+
+std::size_t BookingService::close_started_shows(ShowTime now) {
+    std::vector<ShowId> started;
+    {
+        EpochManager::Guard guard(catalog_epochs_);
+        const ShowColumns& shows = catalog_.load(std::memory_order_acquire)->shows;
+        for (std::size_t i = 0; i < shows.size(); ++i) {
+            if (shows.start_times()[i] > now) continue;
+            const ShowState* st = get_state(shows.ids()[i]);
+            if (st && st->sales.load(std::memory_order_relaxed) == static_cast<std::uint8_t>(SalesState::Open)) {
+                started.push_back(shows.ids()[i]);
+            }
+        }
+    }
+    std::size_t closed = 0;
+    for (const ShowId id : started) closed += set_sales_state(id, SalesState::Closed) ? 1u : 0u;
+    return closed;
+}
+
+} // namespace booking
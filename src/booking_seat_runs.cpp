@@ -0,0 +1,80 @@
+#include "booking_service.hpp"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+
+// Seat run summary: the longest run of adjacent free seats of every show, kept beside the
+// seat words so "N seats together" filters screen shows without loading their seat maps.
+
+namespace booking {
+
+void BookingService::refresh_runs(SeatRunSummary& runs, const ShowState& st, int w) {
+    const HallLayout& layout = *st.layout;
+    runs.refresh(static_cast<int>(st.position), w, st.word_count, layout.aisles()[w],
+                 [&] { return ~st.words()[w].load(std::memory_order_acquire) & layout.row_mask(w); });
+}
+
+const SeatRunSummary* BookingService::summary_of(const ShowState& st) const {
+    const SeatRunSummary* runs = run_summary_.load(std::memory_order_acquire);
+    if (runs == nullptr || st.shared() || !runs->listed(static_cast<int>(st.position))) return nullptr;
+    return runs;
+}
+
+int BookingService::longest_free_run(const ShowState& st) {
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    load_free_words(st, free_words.data());
+    int best = 0;
+    for (int w = 0; w < st.word_count; ++w) {
+        best = std::max(best, SeatRunSummary::longest_run(free_words[static_cast<std::size_t>(w)],
+                                                          st.layout->aisles()[w]));
+    }
+    return best;
+}
+
+void BookingService::enable_seat_run_summary() {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    if (run_summary_.load(std::memory_order_relaxed)) return;
+    run_summary_owned_ = std::make_unique<SeatRunSummary>(ShowTable<ShowState>::kMaxPositions);
+    // Published before the backfill: a write racing it refreshes its row itself, and a
+    // refresh recomputes from the live word, so both orders end on the same run
+    run_summary_.store(run_summary_owned_.get(), std::memory_order_release);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    for (std::size_t row = 0; row < c->shows.size(); ++row) {
+        if (const ShowState* st = get_state(c->shows.ids()[row])) {
+            note_all_runs(*st);
+            run_summary_owned_->list(static_cast<int>(st->position));
+        }
+    }
+}
+
+std::vector<ShowId> BookingService::shows_with_adjacent_seats(int n) const {
+    std::vector<ShowId> out;
+    if (const SeatRunSummary* runs = run_summary_.load(std::memory_order_acquire)) {
+        runs->for_each_at_least(n, [&](int position) { out.push_back(show_state_.id_at(position)); });
+        return out;
+    }
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    std::vector<std::pair<int, ShowId>> found; // (position, id): ShowTable order
+    for (std::size_t row = 0; row < c->shows.size(); ++row) {
+        const ShowId id = c->shows.ids()[row];
+        const ShowState* st = get_state(id);
+        if (st && longest_free_run(*st) >= std::max(n, 1)) found.emplace_back(static_cast<int>(st->position), id);
+    }
+    std::sort(found.begin(), found.end());
+    out.reserve(found.size());
+    for (const auto& entry : found) out.push_back(entry.second);
+    return out;
+}
+
+void BookingService::filter_adjacent_seats(std::vector<Show>& shows, int n) const {
+    const SeatRunSummary* runs = run_summary_.load(std::memory_order_acquire);
+    shows.erase(std::remove_if(shows.begin(), shows.end(), [&](const Show& show) {
+        const ShowState* st = get_state(show.id);
+        if (st == nullptr) return true;
+        const int longest = runs ? runs->longest(static_cast<int>(st->position)) : longest_free_run(*st);
+        return longest < std::max(n, 1);
+    }), shows.end());
+}
+
+} // namespace booking
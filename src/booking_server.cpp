@@ -0,0 +1,574 @@
+#include "booking_server.hpp"
+
+#include "io_uring.hpp"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace booking {
+
+namespace {
+
+constexpr std::size_t kReadChunk = 64 * 1024;
+constexpr int kMaxEvents = 256;
+
+/** @brief io_uring user data: operation in the top byte, connection slot below. */
+enum UringOp : std::uint64_t { kOpAccept = 1, kOpRecv = 2, kOpSend = 3, kOpWake = 4 };
+
+/** @brief Rate-limit key of a connection: the peer's IPv4 address (0 if unknown). */
+std::uint64_t peer_client_id(int fd) {
+    sockaddr_in addr{};
+    socklen_t len = sizeof(addr);
+    if (::getpeername(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0 || addr.sin_family != AF_INET) return 0;
+    return ntohl(addr.sin_addr.s_addr);
+}
+
+std::uint64_t uring_tag(UringOp op, std::size_t slot) {
+    return (static_cast<std::uint64_t>(op) << 56) | slot;
+}
+
+/** @brief epoll user data of the wake-up eventfd (connections use their fd). */
+constexpr std::uint64_t kWakeTag = ~std::uint64_t{0};
+constexpr std::uint64_t kListenTag = kWakeTag - 1u;
+
+} // namespace
+
+const char* to_string(ServerBackend backend) {
+    switch (backend) {
+        case ServerBackend::Auto: return "auto";
+        case ServerBackend::Epoll: return "epoll";
+        case ServerBackend::IoUring: return "io_uring";
+    }
+    return "unknown";
+}
+
+const char* to_string(ServerStatus status) {
+    switch (status) {
+        case ServerStatus::Ok: return "listening";
+        case ServerStatus::SocketError: return "cannot create socket/epoll/eventfd";
+        case ServerStatus::BindError: return "cannot bind the address";
+        case ServerStatus::ListenError: return "cannot listen on the socket";
+    }
+    return "unknown status";
+}
+
+BookingServer::BookingServer(BookingService& service, BookingServerOptions options)
+    : service_(service), options_(std::move(options)), wire_handler_(service), http_handler_(service) {
+    if (options_.config) {
+        // Always tracked, so a rate limit set by a later reload applies to connected clients too
+        rate_limiter_ = std::make_unique<ClientRateLimiter>(options_.config->current().client_rate,
+                                                            options_.rate_limit_clients);
+        config_listener_ = options_.config->subscribe([this](const TuningConfig&, const TuningConfig& current) {
+            rate_limiter_->set_limit(current.client_rate);
+        });
+        if (options_.config_admin) http_handler_.set_live_config(options_.config);
+    } else if (options_.client_rate.per_second > 0.0) {
+        rate_limiter_ = std::make_unique<ClientRateLimiter>(options_.client_rate, options_.rate_limit_clients);
+    }
+    read_only_.store(options_.read_only, std::memory_order_relaxed);
+    http_handler_.set_max_request(options_.max_line);
+}
+
+/** @brief io_uring state: one connection per fixed file slot, each with its own receive buffer. */
+struct BookingServer::Uring {
+    struct Slot {
+        Connection conn;
+        bool in_use = false;
+        bool recv_pending = false;
+        bool send_pending = false;
+        bool shut_down = false;  /**< shutdown() issued to finish a pending receive. */
+    };
+
+    IoUring ring;
+    std::unique_ptr<char[]> buffers;       /**< Registered buffer 0: max_connections x recv_buffer. */
+    std::vector<Slot> slots;
+    std::vector<std::size_t> free_slots;
+    std::uint64_t wake_value = 0;          /**< Target of the eventfd read. */
+    std::size_t open = 0;
+
+    io_uring_sqe* sqe() {
+        io_uring_sqe* e = ring.get_sqe();
+        while (!e) {
+            ring.submit(0); // full: hand the queued entries to the kernel first
+            e = ring.get_sqe();
+        }
+        return e;
+    }
+};
+
+BookingServer::~BookingServer() {
+    if (options_.config) options_.config->unsubscribe(config_listener_);
+    for (auto& entry : connections_) ::close(entry.first);
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+    if (epoll_fd_ >= 0) ::close(epoll_fd_);
+    if (wake_fd_ >= 0) ::close(wake_fd_);
+}
+
+ServerStatus BookingServer::listen() {
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (epoll_fd_ < 0 || wake_fd_ < 0 || listen_fd_ < 0) return ServerStatus::SocketError;
+
+    const int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (options_.busy_poll_us > 0) tune_socket(listen_fd_); // busy-poll for incoming connections too
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options_.port);
+    if (::inet_pton(AF_INET, options_.host.c_str(), &addr.sin_addr) != 1
+        || ::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        return ServerStatus::BindError;
+    }
+    if (::listen(listen_fd_, options_.backlog) != 0) return ServerStatus::ListenError;
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = kListenTag;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.data.u64 = kWakeTag;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+    // epoll stays set up as the fallback
+    if (options_.backend != ServerBackend::Epoll && init_uring()) backend_ = ServerBackend::IoUring;
+    return ServerStatus::Ok;
+}
+
+void BookingServer::stop() {
+    stop_.store(true, std::memory_order_release);
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const ssize_t n = ::write(wake_fd_, &one, sizeof(one));
+}
+
+void BookingServer::tune_socket(int fd) const {
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (options_.busy_poll_us <= 0) return;
+    // Best effort: budgets above net.core.busy_read need CAP_NET_ADMIN, and the loop spins anyway
+    ::setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &options_.busy_poll_us, sizeof(options_.busy_poll_us));
+#ifdef SO_PREFER_BUSY_POLL
+    ::setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &one, sizeof(one));
+#endif
+}
+
+void BookingServer::run() {
+    if (options_.poll_cpu >= 0 && options_.poll_cpu < CPU_SETSIZE) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(options_.poll_cpu, &set);
+        ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+    }
+    if (uring_) {
+        run_uring();
+    } else {
+        run_epoll();
+    }
+}
+
+void BookingServer::run_epoll() {
+    std::array<epoll_event, kMaxEvents> events;
+    const bool busy = options_.busy_poll_us > 0;
+    while (!stop_.load(std::memory_order_acquire)) {
+        const int n = ::epoll_wait(epoll_fd_, events.data(), kMaxEvents, busy ? 0 : -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (n == 0) idle_polls_.fetch_add(1, std::memory_order_relaxed);
+        for (int i = 0; i < n; ++i) {
+            const std::uint64_t tag = events[static_cast<std::size_t>(i)].data.u64;
+            if (tag == kWakeTag) continue; // stop_ is checked by the loop
+            if (tag == kListenTag) {
+                accept_all();
+                continue;
+            }
+            const int fd = static_cast<int>(tag);
+            auto it = connections_.find(fd);
+            if (it == connections_.end()) continue;
+            if (!service(*it->second)) close_connection(fd);
+        }
+    }
+    for (auto& entry : connections_) ::close(entry.first);
+    connections_.clear();
+    connection_count_.store(0, std::memory_order_relaxed);
+}
+
+void BookingServer::accept_all() {
+    while (true) {
+        const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return; // EAGAIN, or an error on one pending connection
+        tune_socket(fd);
+
+        auto c = std::make_unique<Connection>();
+        c->fd = fd;
+        if (rate_limiter_) c->client = peer_client_id(fd);
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET; // registered once, never modified
+        ev.data.u64 = static_cast<std::uint64_t>(fd);
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections_.emplace(fd, std::move(c));
+        connection_count_.store(connections_.size(), std::memory_order_relaxed);
+    }
+}
+
+bool BookingServer::service(Connection& c) {
+    // Edge-triggered: keep going until the socket would block in the direction we need
+    while (true) {
+        if (!flush(c)) return false;
+        const std::size_t unsent = c.out.size() - c.out_pos;
+        if (unsent != 0u) {
+            if (unsent >= options_.output_high_water || c.closing) return true; // wait for EPOLLOUT
+        } else if (c.closing) {
+            return false;
+        }
+
+        // Run lines buffered while the connection was paused before reading more
+        const std::size_t before = c.out.size();
+        if (!execute_lines(c)) return false;
+        if (c.out.size() != before || c.closing) continue; // a malformed frame closes without output
+
+        if (c.eof) {
+            // Half-closed: answer what was complete, then close
+            c.closing = true;
+            continue;
+        }
+        const std::size_t old_size = c.in.size();
+        c.in.resize(old_size + kReadChunk);
+        const ssize_t got = ::recv(c.fd, &c.in[old_size], kReadChunk, 0);
+        if (got <= 0) {
+            c.in.resize(old_size);
+            if (got == 0) {
+                c.eof = true;
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+            if (errno == EINTR) continue;
+            return false;
+        }
+        c.in.resize(old_size + static_cast<std::size_t>(got));
+    }
+}
+
+bool BookingServer::execute_lines(Connection& c) {
+    const bool read_only = read_only_.load(std::memory_order_relaxed);
+    wire_handler_.set_client(c.client, rate_limiter_.get());
+    wire_handler_.set_read_only(read_only);
+    http_handler_.set_client(c.client, rate_limiter_.get());
+    http_handler_.set_read_only(read_only);
+    if (!c.detected && c.in_pos < c.in.size()) {
+        const unsigned char first = static_cast<unsigned char>(c.in[c.in_pos]);
+        c.binary = first == kWireMagic;
+        c.http = options_.http && first >= 'A' && first <= 'Z';
+        c.detected = true;
+    }
+    if (c.binary) {
+        execute_frames(c);
+        return true;
+    }
+    if (c.http) {
+        execute_requests(c);
+        return true;
+    }
+    if (!c.session) {
+        c.session = std::make_unique<TextCommandHandler>(service_);
+        c.session->set_cluster_admin(options_.cluster_admin);
+        c.session->set_client(c.client, rate_limiter_.get());
+    }
+    c.session->set_read_only(read_only);
+    const ShowId show = c.session->last_show();
+    if (options_.session_affinity && show.valid() && service_.execution_mode() == ExecutionMode::OwnerThreads
+        && c.in.find('\n', c.in_pos) != std::string::npos) {
+        // The whole batch runs on the owner of the session's show; this thread waits for it
+        service_.run_on_owner(show, [&] {
+            execute_text(c);
+            return true;
+        });
+        pinned_batches_.fetch_add(1u, std::memory_order_relaxed);
+    } else {
+        execute_text(c);
+    }
+    return true;
+}
+
+void BookingServer::execute_text(Connection& c) {
+    while (c.in_pos < c.in.size() && !c.closing) {
+        if (c.out.size() - c.out_pos >= options_.output_high_water) break; // paused until flushed
+        const std::size_t nl = c.in.find('\n', c.in_pos);
+        if (nl == std::string::npos) break;
+        const std::string_view line(c.in.data() + c.in_pos, nl - c.in_pos);
+        c.in_pos = nl + 1u;
+        if (c.session->execute(line, c.out) == CommandOutcome::Close) c.closing = true;
+    }
+    // Drop the executed prefix; keep at most a partial line
+    if (c.in_pos == c.in.size()) {
+        c.in.clear();
+        c.in_pos = 0;
+    } else if (c.in_pos > kReadChunk) {
+        c.in.erase(0, c.in_pos);
+        c.in_pos = 0;
+    }
+    if (c.in.size() - c.in_pos > options_.max_line && c.in.find('\n', c.in_pos) == std::string::npos) {
+        c.out += "ERR 0 line too long\n";
+        c.closing = true;
+        c.in.clear();
+        c.in_pos = 0;
+    }
+}
+
+void BookingServer::execute_frames(Connection& c) {
+    if (c.closing) return;
+    const std::ptrdiff_t used = wire_handler_.execute(c.in.data() + c.in_pos, c.in.size() - c.in_pos, c.out,
+                                                      c.out_pos + options_.output_high_water);
+    if (used < 0) {
+        // No way to find the next frame boundary: answer what came before, then close
+        c.closing = true;
+        c.in.clear();
+        c.in_pos = 0;
+        return;
+    }
+    c.in_pos += static_cast<std::size_t>(used);
+    if (c.in_pos == c.in.size()) {
+        c.in.clear();
+        c.in_pos = 0;
+    } else if (c.in_pos > kReadChunk) {
+        c.in.erase(0, c.in_pos);
+        c.in_pos = 0;
+    }
+}
+
+void BookingServer::execute_requests(Connection& c) {
+    if (c.closing) return;
+    CommandOutcome outcome = CommandOutcome::Continue;
+    const std::ptrdiff_t used = http_handler_.execute(c.in.data() + c.in_pos, c.in.size() - c.in_pos, c.out, outcome,
+                                                      c.out_pos + options_.output_high_water);
+    if (used < 0) {
+        // The error response is queued; the rest of the stream cannot be trusted
+        c.closing = true;
+        c.in.clear();
+        c.in_pos = 0;
+        return;
+    }
+    if (outcome == CommandOutcome::Close) c.closing = true;
+    c.in_pos += static_cast<std::size_t>(used);
+    if (c.in_pos == c.in.size()) {
+        c.in.clear();
+        c.in_pos = 0;
+    } else if (c.in_pos > kReadChunk) {
+        c.in.erase(0, c.in_pos);
+        c.in_pos = 0;
+    }
+}
+
+bool BookingServer::flush(Connection& c) {
+    while (c.out_pos < c.out.size()) {
+        const ssize_t sent = ::send(c.fd, c.out.data() + c.out_pos, c.out.size() - c.out_pos, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+            if (errno == EINTR) continue;
+            return false;
+        }
+        c.out_pos += static_cast<std::size_t>(sent);
+    }
+    c.out.clear();
+    c.out_pos = 0;
+    return true;
+}
+
+void BookingServer::close_connection(int fd) {
+    ::close(fd); // also removes it from the epoll set
+    connections_.erase(fd);
+    connection_count_.store(connections_.size(), std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------------------
+// io_uring backend
+// ---------------------------------------------------------------------------------------
+
+bool BookingServer::init_uring() {
+    if (options_.max_connections == 0u || options_.recv_buffer == 0u) return false;
+    auto u = std::make_unique<Uring>();
+    if (!u->ring.init(2048)) return false;
+
+    // Sparse fixed file table (one slot per connection) and one registered receive area
+    const std::vector<int> empty(options_.max_connections, -1);
+    if (u->ring.register_files(empty.data(), static_cast<unsigned>(empty.size())) != 0) return false;
+    const std::size_t bytes = options_.max_connections * options_.recv_buffer;
+    u->buffers.reset(new char[bytes]);
+    const iovec iov{u->buffers.get(), bytes};
+    if (u->ring.register_buffers(&iov, 1) != 0) return false;
+
+    u->slots.resize(options_.max_connections);
+    u->free_slots.reserve(options_.max_connections);
+    for (std::size_t i = options_.max_connections; i-- > 0;) u->free_slots.push_back(i);
+    uring_ = std::move(u);
+    return true;
+}
+
+void BookingServer::run_uring() {
+    Uring& u = *uring_;
+    const auto arm_accept = [&] {
+        IoUring::prep(u.sqe(), IORING_OP_ACCEPT, listen_fd_, nullptr, 0, 0, uring_tag(kOpAccept, 0));
+    };
+    const auto arm_wake = [&] {
+        IoUring::prep(u.sqe(), IORING_OP_READ, wake_fd_, &u.wake_value, sizeof(u.wake_value), 0,
+                      uring_tag(kOpWake, 0));
+    };
+    const auto arm_recv = [&](std::size_t slot) {
+        Uring::Slot& s = u.slots[slot];
+        io_uring_sqe* e = u.sqe();
+        IoUring::prep(e, IORING_OP_READ_FIXED, static_cast<int>(slot), u.buffers.get() + slot * options_.recv_buffer,
+                      static_cast<std::uint32_t>(options_.recv_buffer), 0, uring_tag(kOpRecv, slot));
+        e->flags = IOSQE_FIXED_FILE;
+        e->buf_index = 0;
+        s.recv_pending = true;
+    };
+    const auto arm_send = [&](std::size_t slot) {
+        Uring::Slot& s = u.slots[slot];
+        Connection& c = s.conn;
+        if (s.send_pending || c.out_pos == c.out.size()) return;
+        io_uring_sqe* e = u.sqe();
+        IoUring::prep(e, IORING_OP_SEND, static_cast<int>(slot), c.out.data() + c.out_pos,
+                      static_cast<std::uint32_t>(c.out.size() - c.out_pos), 0, uring_tag(kOpSend, slot));
+        e->flags = IOSQE_FIXED_FILE;
+        e->msg_flags = MSG_NOSIGNAL;
+        s.send_pending = true;
+    };
+    const auto release = [&](std::size_t slot) {
+        Uring::Slot& s = u.slots[slot];
+        const int none = -1;
+        u.ring.update_files(static_cast<unsigned>(slot), &none, 1); // drops the ring's reference
+        ::close(s.conn.fd);
+        s = Uring::Slot{};
+        u.free_slots.push_back(slot);
+        connection_count_.store(--u.open, std::memory_order_relaxed);
+    };
+    // Continues a connection after a completion: execute, send, read more, or close when done.
+    // c.out is only modified while no send from it is in flight.
+    const auto advance = [&](std::size_t slot) {
+        Uring::Slot& s = u.slots[slot];
+        Connection& c = s.conn;
+        if (!s.send_pending) {
+            if (c.out.size() - c.out_pos < options_.output_high_water) execute_lines(c);
+            if (c.eof) c.closing = true; // answer what was complete, then close
+            arm_send(slot);
+        }
+        if (c.closing) {
+            if (!s.send_pending) {
+                if (!s.recv_pending) {
+                    release(slot);
+                } else if (!s.shut_down) {
+                    ::shutdown(c.fd, SHUT_RDWR); // completes the pending receive
+                    s.shut_down = true;
+                }
+            }
+            return;
+        }
+        if (!s.recv_pending && c.out.size() - c.out_pos < options_.output_high_water) arm_recv(slot);
+    };
+
+    arm_accept();
+    arm_wake();
+    const unsigned wait_nr = options_.busy_poll_us > 0 ? 0u : 1u;
+    while (!stop_.load(std::memory_order_acquire)) {
+        // One system call submits everything queued by the last round and waits for completions;
+        // busy polling only enters the kernel to submit and otherwise spins on the completion ring
+        if (u.ring.submit(wait_nr) < 0 && errno != EINTR && errno != EBUSY) break;
+        if (wait_nr == 0u && !u.ring.peek_cqe()) {
+            idle_polls_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        while (io_uring_cqe* cqe = u.ring.peek_cqe()) {
+            const std::uint64_t tag = cqe->user_data;
+            const int res = cqe->res;
+            u.ring.cqe_seen();
+            const std::size_t slot = static_cast<std::size_t>(tag & 0xffffffffu);
+            switch (static_cast<UringOp>(tag >> 56)) {
+                case kOpWake:
+                    arm_wake();
+                    break;
+                case kOpAccept: {
+                    if (!stop_.load(std::memory_order_acquire)) arm_accept();
+                    if (res < 0) break;
+                    if (u.free_slots.empty()) {
+                        ::close(res); // at max_connections
+                        break;
+                    }
+                    const std::size_t free_slot = u.free_slots.back();
+                    if (u.ring.update_files(static_cast<unsigned>(free_slot), &res, 1) < 0) {
+                        ::close(res);
+                        break;
+                    }
+                    u.free_slots.pop_back();
+                    tune_socket(res);
+                    Uring::Slot& s = u.slots[free_slot];
+                    s.in_use = true;
+                    s.conn.fd = res;
+                    if (rate_limiter_) s.conn.client = peer_client_id(res);
+                    connection_count_.store(++u.open, std::memory_order_relaxed);
+                    arm_recv(free_slot);
+                    break;
+                }
+                case kOpRecv: {
+                    Uring::Slot& s = u.slots[slot];
+                    s.recv_pending = false;
+                    Connection& c = s.conn;
+                    if (res > 0 && !c.closing) {
+                        c.in.append(u.buffers.get() + slot * options_.recv_buffer, static_cast<std::size_t>(res));
+                    } else if (res == 0) {
+                        c.eof = true;
+                    } else if (res < 0) {
+                        c.closing = true;
+                        c.out.clear(); // connection error: nothing more can be sent
+                        c.out_pos = 0;
+                    }
+                    advance(slot);
+                    break;
+                }
+                case kOpSend: {
+                    Uring::Slot& s = u.slots[slot];
+                    s.send_pending = false;
+                    Connection& c = s.conn;
+                    if (res < 0) {
+                        c.closing = true;
+                        c.out.clear();
+                        c.out_pos = 0;
+                    } else {
+                        c.out_pos += static_cast<std::size_t>(res);
+                        if (c.out_pos == c.out.size()) {
+                            c.out.clear();
+                            c.out_pos = 0;
+                        }
+                    }
+                    advance(slot);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Stop: closing the ring (with the server) cancels whatever is still in flight
+    for (std::size_t i = 0; i < u.slots.size(); ++i) {
+        if (u.slots[i].in_use) ::close(u.slots[i].conn.fd);
+    }
+    uring_.reset();
+    connection_count_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace booking
@@ -1,177 +1,1637 @@
 #include "booking_service.hpp"
 
+#include "seat_label.hpp"
+#include "seat_runs.hpp"
+#include "seat_scan.hpp"
+#include "seat_words.hpp"
+#include "trace.hpp"
+
 #include <algorithm>
-#include <unordered_set>
+#include <climits>
+#include <thread>
 
 namespace booking {
 
-BookingService::BookingService() {
-    // Minimal sample data (you can expand later)
-    movies_.emplace_back(Movie{1, "Inception"});
-    movies_.emplace_back(Movie{2, "Interstellar"});
-    movies_.emplace_back(Movie{3, "The Matrix"});
+const char* to_string(BookingStatus status) {
+    switch (status) {
+        case BookingStatus::Ok: return "Booked successfully";
+        case BookingStatus::InvalidShow: return "Invalid show id";
+        case BookingStatus::NoSeats: return "No seats provided";
+        case BookingStatus::InvalidSeatLabel: return "Invalid seat label";
+        case BookingStatus::DuplicateSeatLabel: return "Duplicate seat label";
+        case BookingStatus::AlreadyBooked: return "One or more seats already booked";
+        case BookingStatus::InvalidSeatIndex: return "Invalid seat index";
+        case BookingStatus::Contended: return "Too much contention, retry later";
+        case BookingStatus::UnknownHold: return "Unknown or already settled hold";
+        case BookingStatus::HoldExpired: return "Hold expired";
+        case BookingStatus::HoldCapacity: return "Too many outstanding holds";
+        case BookingStatus::HoldTooLarge: return "Hold spans too many rows";
+        case BookingStatus::NotOwner: return "Seats not owned by this booking";
+        case BookingStatus::NoContiguousSeats: return "Not enough adjacent seats available";
+        case BookingStatus::Waitlisted: return "Sold out, queued on the waitlist";
+        case BookingStatus::Throttled: return "Too many requests, retry later";
+        case BookingStatus::CompanionSeatRule: return "Companion seats need a wheelchair space booked next to them";
+        case BookingStatus::SingleSeatGap: return "Booking would leave a single seat empty";
+        case BookingStatus::ReadOnlyReplica: return "Read-only replica, book on the primary";
+        case BookingStatus::RequestInFlight: return "Request still in progress, retry later";
+        case BookingStatus::RequestIdReused: return "Request id already used for a different request";
+        case BookingStatus::TheaterCapReached: return "Theater attendance cap reached for the day";
+        case BookingStatus::Busy: return "Server busy, retry later";
+        case BookingStatus::DeadlineExceeded: return "Request deadline passed before it ran";
+        case BookingStatus::SalesClosed: return "Show is not on sale";
+    }
+    return "Unknown status";
+}
 
-    theaters_.emplace_back(Theater{1, "Central Cinema"});
-    theaters_.emplace_back(Theater{2, "Mall Theater"});
+const char* to_string(AvailabilityStatus status) {
+    switch (status) {
+        case AvailabilityStatus::Changed: return "Seats changed";
+        case AvailabilityStatus::Unchanged: return "Seats unchanged";
+        case AvailabilityStatus::UnknownShow: return "Unknown show";
+    }
+    return "Unknown status";
+}
 
-    // Shows (movie x theater)
-    shows_.emplace_back(Show{1, 1, 1}); // Inception @ Central
-    shows_.emplace_back(Show{2, 1, 2}); // Inception @ Mall
-    shows_.emplace_back(Show{3, 2, 1}); // Interstellar @ Central
-    shows_.emplace_back(Show{4, 3, 2}); // Matrix @ Mall
+BookingResult BookingResult::ok() {
+    BookingResult res;
+    res.success = true;
+    return res;
+}
 
-    // Initialize per-show state
-    for (const auto& show : shows_) { //using a range loop with const reference to avoid copying and showing the intend that objects won't be modified
-        show_state_.emplace(show.id, std::make_unique<ShowState>());
+BookingResult BookingResult::error(BookingStatus status) {
+    BookingResult res;
+    res.status = status;
+    return res;
+}
+
+BookingResult BookingResult::index_error(BookingStatus status, int index) {
+    BookingResult res = error(status);
+    res.label_index = index;
+    return res;
+}
+
+BookingResult BookingResult::label_error(BookingStatus status, int index, std::string_view bad_label) {
+    BookingResult res = error(status);
+    res.label_index = index;
+    // Keep a truncated copy so message() can be rendered later without owning a string
+    const std::size_t n = std::min(bad_label.size(), res.label.size() - 1);
+    std::copy_n(bad_label.begin(), n, res.label.begin());
+    res.label[n] = '\0';
+    return res;
+}
+
+BookingResult BookingResult::conflict(const SeatMask& taken) {
+    BookingResult res = error(BookingStatus::AlreadyBooked);
+    res.conflicts = taken;
+    return res;
+}
+
+SeatMask BookingResult::alternative(const SeatMask& request) const {
+    SeatMask out;
+    if (suggested_row < 0) return out;
+    for (int w = request.first_word(); w < request.end_word(); ++w) {
+        out.or_word(w, w == suggested_row ? suggested_seats : request.word(w));
     }
+    return out;
 }
 
-std::vector<Movie> BookingService::list_movies() const {
-    return movies_;
+BookingResult BookingResult::not_owner(const SeatMask& foreign) {
+    BookingResult res = error(BookingStatus::NotOwner);
+    res.conflicts = foreign;
+    return res;
 }
 
-std::vector<Theater> BookingService::list_theaters_for_movie(MovieId movie_id) const {
-    std::vector<Theater> result;
+std::string BookingResult::message() const {
+    std::string out;
+    append_message(out);
+    return out;
+}
 
-    // Collect unique theater IDs that have a show for this movie
-    std::unordered_set<TheaterId> theater_ids;
-    for (const auto& show : shows_) {
-        if (show.movie_id == movie_id) {
-            theater_ids.insert(show.theater_id); //insert used instead of emplace as the argument is a primitive(int). So insert and emplace give the same performance here
-        }
+void BookingResult::append_message(std::string& out) const {
+    out += to_string(status);
+    if ((status == BookingStatus::InvalidSeatLabel || status == BookingStatus::DuplicateSeatLabel)
+        && label[0] != '\0') {
+        out += ": ";
+        out += label.data();
+    }
+}
+
+void BookingService::ShowState::init(int pos, const HallLayout& l) {
+    static_assert(sizeof(ShowState) == 128, "ShowState: expected one booking line + one counter line");
+    position = static_cast<std::uint32_t>(pos);
+    layout = &l;
+    word_count = static_cast<std::int16_t>(l.row_count());
+    sales.store(0u, std::memory_order_relaxed);
+    version = own_version;
+    row_summary = word_count > kInlineWords;
+    if (!row_summary) {
+        for (int w = 0; w < word_count; ++w) inline_words[w].store(0u, std::memory_order_relaxed);
+        word_array.store(inline_words, std::memory_order_relaxed);
+        return;
+    }
+    heap_words.reset(); // allocated by the first booking (ensure_words)
+    word_array.store(cold_words, std::memory_order_relaxed);
+    std::uint64_t rows = 0u; // rows with seats: all free
+    for (int w = 0; w < word_count; ++w) {
+        if (l.row_mask(w) != 0u) rows |= std::uint64_t{1} << w;
     }
+    inline_words[0].store(rows, std::memory_order_relaxed);
+}
 
-    // Return theaters in the same order as theaters_ (stable, predictable)
-    for (const auto& theater : theaters_) {
-        if (theater_ids.find(theater.id) != theater_ids.end()) {
-            result.push_back(theater);  //push_back used instead of emplace_back because the theather object is already created, so the same performance. Only if the objects needs to be created from arguments then emplace_back would be better.
-        }
+std::atomic<std::uint64_t> BookingService::ShowState::cold_words[HallLayout::kMaxRows]{};
+
+void BookingService::ShowState::init_shared(int pos, const HallLayout& l, const SharedSeatRegion::Block& block) {
+    position = static_cast<std::uint32_t>(pos);
+    layout = &l;
+    word_count = static_cast<std::int16_t>(l.row_count());
+    sales.store(0u, std::memory_order_relaxed);
+    row_summary = false; // other processes write these words
+    word_array.store(block.words, std::memory_order_relaxed);
+    version = block.version;
+    owners.store(static_cast<OwnerRow*>(block.owners), std::memory_order_relaxed);
+}
+
+BookingService::OwnerRow* BookingService::ensure_owners(ShowState& st) {
+    OwnerRow* rows = st.owners.load(std::memory_order_acquire);
+    if (rows) return rows;
+    OwnerRow* fresh = new OwnerRow[static_cast<std::size_t>(st.word_count)](); // value-init: all 0
+    if (st.owners.compare_exchange_strong(rows, fresh, std::memory_order_acq_rel)) return fresh;
+    delete[] fresh; // another booking installed it first
+    return rows;
+}
+
+std::atomic<std::uint64_t>* BookingService::ensure_words(ShowState& st) {
+    std::atomic<std::uint64_t>* words = st.words();
+    if (words != ShowState::cold_words) return words;
+    auto* fresh = new std::atomic<std::uint64_t>[static_cast<std::size_t>(st.word_count)](); // value-init: all 0
+    if (st.word_array.compare_exchange_strong(words, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        st.heap_words.reset(fresh); // only the winner owns it
+        return fresh;
     }
-    // sort the theathers by ID(optional)
-    std::sort(result.begin(), result.end(),
-          [](const Theater& a, const Theater& b) {
-              return a.id < b.id;
-          });
+    delete[] fresh; // another booking installed its words first
+    return words;
+}
+
+BookingService::BookingService() : BookingService(HallLayout::single_row(kSeatCount)) {}
+
+BookingService::BookingService(HallLayout layout)
+    : catalog_(new Catalog()), hold_epoch_(std::chrono::steady_clock::now()) {
+    set_hold_capacity(kDefaultHoldCapacity);
+    add_layout(std::move(layout));
+
+    // Minimal sample data (you can expand later)
+    add_movie(Movie{1, "Inception"});
+    add_movie(Movie{2, "Interstellar"});
+    add_movie(Movie{3, "The Matrix"});
+
+    add_theater(Theater{1, "Central Cinema"});
+    add_theater(Theater{2, "Mall Theater"});
+
+    // Shows (movie x theater)
+    add_show(Show{1, 1, 1}); // Inception @ Central
+    add_show(Show{2, 1, 2}); // Inception @ Mall
+    add_show(Show{3, 2, 1}); // Interstellar @ Central
+    add_show(Show{4, 3, 2}); // Matrix @ Mall
+}
+
+BookingService::BookingService(EmptyCatalog)
+    : catalog_(new Catalog()), hold_epoch_(std::chrono::steady_clock::now()) {
+    set_hold_capacity(kDefaultHoldCapacity);
+}
 
-    //returning a std::vector because it keeps stable ordering all the time(needed for unit tests). Also vector is faster, and has lower memory overhead
-    return result;
+BookingService::~BookingService() {
+    use_live_config(nullptr);
+    set_read_mirror(std::chrono::microseconds::zero());
+    set_incremental_snapshots(IncrementalSnapshotOptions{});
+    set_occupancy_export(OccupancyExportOptions{});
+    set_availability_export(AvailabilityExportOptions{});
+    set_dynamic_pricing(PricingPolicy{});
+    set_slos(SloPolicy{});
+    delete catalog_.load();
 }
 
-ShowId BookingService::find_show(MovieId movie_id, TheaterId theater_id) const {
-    for (const auto& show : shows_) {
-        if (show.movie_id == movie_id && show.theater_id == theater_id) {
-            return show.id;
+const HallLayout* BookingService::layout_for_show(ShowId show_id) const {
+    const ShowState* st = get_state(show_id);
+    return st ? st->layout : nullptr;
+}
+
+namespace {
+
+/** @brief Appends the labels of the free seats in @p free_words to @p out, in row-major order. */
+template <typename Labels>
+void collect_free_labels(const HallLayout& layout, const std::uint64_t* free_words, int word_count, Labels& out) {
+    std::size_t total = 0;
+    for (int w = 0; w < word_count; ++w) total += static_cast<std::size_t>(popcount64(free_words[w]));
+    out.reserve(total);
+    for (int w = 0; w < word_count; ++w) {
+        std::uint64_t free_bits = free_words[w];
+        while (free_bits != 0u) {
+            const int col = ctz64(free_bits);
+            free_bits &= free_bits - 1u; // clear the lowest set bit
+            out.emplace_back(layout.label_view(HallLayout::seat_index(w, col)));
         }
     }
-    return -1;
 }
 
+} // namespace
+
 std::vector<std::string> BookingService::list_available_seats(ShowId show_id) const {
+    return measured(MetricsApi::ListAvailableSeats, [&] {
+        const TraceScope trace(TraceStage::ListSeats, static_cast<std::uint64_t>(show_id.value()));
+        const ShowState* st = nullptr;
+        {
+            const TraceScope stage(TraceStage::Lookup);
+            st = get_state(show_id);
+        }
+        return list_labels_on(st);
+    });
+}
+
+std::vector<std::string> BookingService::list_available_seats(ShowHandle& show) const {
+    return measured(MetricsApi::ListAvailableSeats, [&] {
+        const TraceScope trace(TraceStage::ListSeats, static_cast<std::uint64_t>(show.show_id().value()));
+        return list_labels_on(resolve(show));
+    });
+}
+
+std::vector<std::string> BookingService::list_labels_on(const ShowState* st) const {
     std::vector<std::string> out;
-    const ShowState* st = get_state(show_id);
     if (!st) return out;
 
-    const std::uint32_t mask = st->booked_mask.load(); //load is an atomic read operation
-    for (int i = 0; i < kSeatCount; ++i) {
-        const std::uint32_t bit = (1u << i);
-        if ((mask & bit) == 0u) {
-            out.push_back(seat_label_from_index0(i));
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    {
+        const TraceScope stage(TraceStage::LoadSeats);
+        load_read_words(*st, free_words.data());
+    }
+    const TraceScope stage(TraceStage::Render);
+    collect_free_labels(*st->layout, free_words.data(), st->word_count, out);
+    return out;
+}
+
+std::pmr::vector<std::pmr::string> BookingService::list_available_seats(ShowId show_id,
+                                                                        std::pmr::memory_resource* resource) const {
+    return measured(MetricsApi::ListAvailableSeats, [&] {
+        const TraceScope trace(TraceStage::ListSeats, static_cast<std::uint64_t>(show_id.value()));
+        std::pmr::vector<std::pmr::string> out(resource);
+        const ShowState* st = nullptr;
+        {
+            const TraceScope stage(TraceStage::Lookup);
+            st = get_state(show_id);
         }
+        if (!st) return out;
+
+        std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+        {
+            const TraceScope stage(TraceStage::LoadSeats);
+            load_read_words(*st, free_words.data());
+        }
+        const TraceScope stage(TraceStage::Render);
+        collect_free_labels(*st->layout, free_words.data(), st->word_count, out);
+        return out;
+    });
+}
+
+int BookingService::append_available_seats(ShowId show_id, std::string& out, char separator) const {
+    return measured(MetricsApi::ListAvailableSeats, [&] {
+        const ShowState* st = get_state(show_id);
+        if (!st) return -1;
+        std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+        load_read_words(*st, free_words.data());
+        const std::size_t old_size = out.size();
+        out.resize(old_size + st->layout->max_rendered_size());
+        char* const end = st->layout->render_labels(free_words.data(), st->word_count, separator, &out[old_size]);
+        out.resize(static_cast<std::size_t>(end - out.data()));
+        return seat_scan::kernels().count_free(free_words.data(), static_cast<std::size_t>(st->word_count));
+    });
+}
+
+int BookingService::append_available_seats(ShowId show_id, SeatEncoding encoding, std::string& out) const {
+    return measured(MetricsApi::ListAvailableSeats, [&] {
+        const ShowState* st = get_state(show_id);
+        if (!st) return -1;
+        std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+        load_read_words(*st, free_words.data());
+        const std::size_t old_size = out.size();
+        out.resize(old_size + max_encoded_size(*st->layout, encoding));
+        char* const end = encode_free_seats(*st->layout, free_words.data(), st->word_count, encoding, &out[old_size]);
+        out.resize(static_cast<std::size_t>(end - out.data()));
+        return seat_scan::kernels().count_free(free_words.data(), static_cast<std::size_t>(st->word_count));
+    });
+}
+
+int BookingService::append_cached_available_seats(ShowId show_id, std::string& out) const {
+    return measured(MetricsApi::ListAvailableSeats, [&] { return append_cached_on(get_state(show_id), out); });
+}
+
+int BookingService::append_cached_available_seats(ShowHandle& show, std::string& out) const {
+    return measured(MetricsApi::ListAvailableSeats, [&] { return append_cached_on(resolve(show), out); });
+}
+
+int BookingService::append_cached_on(const ShowState* st, std::string& out) const {
+    if (!st) return -1;
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    load_read_words(*st, free_words.data());
+
+    EpochManager::Guard guard(render_epochs_);
+    const RenderedSeats* cached = st->rendered.load(std::memory_order_acquire);
+    if (cached && cached->matches(st->layout, free_words.data(), st->word_count)) {
+        out += cached->text; // nobody booked since: share the last rendering
+        return cached->free_count;
+    }
+
+    // Seats changed: render once and publish it for the readers that follow
+    auto fresh = std::make_unique<RenderedSeats>();
+    fresh->layout = st->layout;
+    fresh->free_words.assign(free_words.begin(), free_words.begin() + st->word_count);
+    fresh->text.resize(st->layout->max_rendered_size());
+    char* const end = st->layout->render_labels(free_words.data(), st->word_count, ' ', &fresh->text[0]);
+    fresh->text.resize(static_cast<std::size_t>(end - fresh->text.data()));
+    fresh->free_count =
+        seat_scan::kernels().count_free(free_words.data(), static_cast<std::size_t>(st->word_count));
+    out += fresh->text;
+    const int free_count = fresh->free_count;
+    const std::size_t bytes = rendered_bytes(*fresh);
+    if (!memory_.try_charge(MemorySubsystem::Caches, bytes)) {
+        // Over the cache budget: serve this rendering uncached and drop the stale one
+        if (cached && st->rendered.compare_exchange_strong(cached, nullptr, std::memory_order_acq_rel)) {
+            retire_rendered(cached);
+        }
+        return free_count;
+    }
+    if (st->rendered.compare_exchange_strong(cached, fresh.get(), std::memory_order_acq_rel)) {
+        fresh.release();
+        if (cached) retire_rendered(cached);
+    } else {
+        memory_.release(MemorySubsystem::Caches, bytes); // another reader published first: ours was still right
+    }
+    return free_count;
+}
+
+int BookingService::available_seats_mask(ShowId show_id, SeatMask& out_free) const {
+    out_free = SeatMask{};
+    const ShowState* st = get_state(show_id);
+    if (!st) return -1;
+
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    load_read_words(*st, free_words.data());
+    for (int w = 0; w < st->word_count; ++w) out_free.or_word(w, free_words[static_cast<std::size_t>(w)]);
+    return seat_scan::kernels().count_free(free_words.data(), static_cast<std::size_t>(st->word_count));
+}
+
+AvailabilityStatus BookingService::availability_if_changed(ShowId show_id, std::uint64_t known_version,
+                                                          SeatMask& out_free, std::uint64_t& out_version) const {
+    const ShowState* st = get_state(show_id);
+    if (!st) return AvailabilityStatus::UnknownShow;
+    // Version before words: a change racing with this read shows up in the next call
+    const std::uint64_t version = st->changes().load(std::memory_order_acquire);
+    if (version == known_version) return AvailabilityStatus::Unchanged;
+
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    load_free_words(*st, free_words.data());
+    out_free = SeatMask{};
+    for (int w = 0; w < st->word_count; ++w) out_free.or_word(w, free_words[static_cast<std::size_t>(w)]);
+    out_version = version;
+    return AvailabilityStatus::Changed;
+}
+
+namespace {
+
+constexpr std::size_t kParallelCountShows = 4096; /**< Shorter lists are counted on the calling thread. */
+constexpr std::size_t kCountChunkShows = 1024;    /**< Shows per parallel chunk (a few microseconds of work). */
+
+} // namespace
+
+int BookingService::available_count(ShowId show_id) const {
+    return measured(MetricsApi::AvailableCount, [&] {
+        const ShowState* st = get_state(show_id);
+        if (!st) return -1;
+        if (const SeatRunSummary* summary = summary_of(*st)) return summary->free_seats(static_cast<int>(st->position));
+        std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+        load_read_words(*st, free_words.data());
+        return seat_scan::kernels().count_free(free_words.data(), static_cast<std::size_t>(st->word_count));
+    });
+}
+
+std::uint64_t BookingService::rows_with_free_seats(ShowId show_id) const {
+    const ShowState* st = get_state(show_id);
+    if (!st) return 0u;
+    if (const std::atomic<std::uint64_t>* rows = st->free_rows()) {
+        return rows->load(std::memory_order_acquire) & row_bits(st->word_count);
+    }
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    seat_words::load_free(st->words(), st->layout->row_masks(), free_words.data(), st->word_count);
+    std::uint64_t out = 0u;
+    for (int w = 0; w < st->word_count; ++w) {
+        if (free_words[static_cast<std::size_t>(w)] != 0u) out |= std::uint64_t{1} << w;
     }
     return out;
 }
 
+std::size_t BookingService::available_counts(Span<const ShowId> show_ids, Span<int> out_counts) const {
+    const seat_scan::Kernels& k = seat_scan::kernels();
+    const auto count_range = [&](std::size_t begin, std::size_t end) {
+        std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+        std::size_t known = 0;
+        for (std::size_t i = begin; i < end; ++i) {
+            const ShowState* st = get_state(show_ids[i]);
+            if (!st) {
+                out_counts[i] = -1;
+                continue;
+            }
+            load_read_words(*st, free_words.data());
+            out_counts[i] = k.count_free(free_words.data(), static_cast<std::size_t>(st->word_count));
+            ++known;
+        }
+        return known;
+    };
+    if (show_ids.size() < kParallelCountShows) return count_range(0, show_ids.size());
+
+    // Large pages: chunks of shows on the pool, each writing its own slice of out_counts
+    std::atomic<std::size_t> known{0};
+    thread_pool().parallel_for(show_ids.size(), kCountChunkShows, [&](std::size_t begin, std::size_t end) {
+        known.fetch_add(count_range(begin, end), std::memory_order_relaxed);
+    });
+    return known.load(std::memory_order_relaxed);
+}
+
+void BookingService::load_free_words(const ShowState& st, std::uint64_t* out) {
+    if (st.word_count == 1) { // nothing spans several words
+        seat_words::load_free(st.words(), st.layout->row_masks(), out, 1);
+        return;
+    }
+    const std::atomic<std::uint64_t>& writes = st.group_writes();
+    for (unsigned attempt = 1;; ++attempt) {
+        const std::uint64_t before = writes.load(std::memory_order_acquire);
+        if ((before & kGroupWriters) == 0u) {
+            seat_words::load_free(st.words(), st.layout->row_masks(), out, st.word_count);
+            // A word written by a group makes its GroupWrite entry visible to the re-check
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (writes.load(std::memory_order_relaxed) == before) return;
+        }
+        sim_point(); // in a simulation the writer only finishes if it is scheduled
+        if (attempt % 16u == 0u) std::this_thread::yield(); // a writer was preempted mid-group
+    }
+}
+
 BookingResult BookingService::book_seats(ShowId show_id, const std::vector<std::string>& seat_labels) {
-    ShowState* st = get_state_mut(show_id);
+    return book_seats(show_id, seat_labels, nullptr);
+}
+
+BookingResult BookingService::book_seats(ShowId show_id, const std::vector<std::string>& seat_labels,
+                                         std::uint64_t* commit_lsn) {
+    return measured(MetricsApi::BookSeats, [&] {
+        const TraceScope trace(TraceStage::BookSeats, static_cast<std::uint64_t>(show_id.value()));
+        ShowState* st = nullptr;
+        {
+            const TraceScope stage(TraceStage::Lookup);
+            st = get_state_mut(show_id);
+        }
+        return book_labels_on(st, show_id, seat_labels, commit_lsn);
+    });
+}
+
+BookingResult BookingService::book_seats(ShowHandle& show, const std::vector<std::string>& seat_labels) {
+    return measured(MetricsApi::BookSeats, [&] {
+        const TraceScope trace(TraceStage::BookSeats, static_cast<std::uint64_t>(show.show_id().value()));
+        return book_labels_on(resolve(show), show.show_id(), seat_labels, nullptr);
+    });
+}
+
+BookingResult BookingService::book_labels_on(ShowState* st, ShowId show_id,
+                                             const std::vector<std::string>& seat_labels, std::uint64_t* commit_lsn) {
     if (!st) {
-        return BookingResult{false, "Invalid show id"};
+        return BookingResult::error(BookingStatus::InvalidShow);
+    }
+    if (!admit_booker(show_id)) {
+        return BookingResult::error(BookingStatus::Throttled);
     }
     if (seat_labels.empty()) {
-        return BookingResult{false, "No seats provided"};
+        return BookingResult::error(BookingStatus::NoSeats);
     }
 
-    std::string err;
-    const std::uint32_t req = seats_to_mask_or_fail(seat_labels, err);
-    if (!err.empty()) {
-        return BookingResult{false, err};
+    SeatMask req_mask;
+    int bad_index = -1;
+    BookingStatus parsed = BookingStatus::Ok;
+    {
+        const TraceScope stage(TraceStage::Parse, seat_labels.size());
+        parsed = seats_to_mask_or_fail(*st->layout, seat_labels, req_mask, bad_index);
     }
+    if (parsed != BookingStatus::Ok) {
+        return BookingResult::label_error(parsed, bad_index, seat_labels[static_cast<std::size_t>(bad_index)]);
+    }
+    return book_owned(*st, req_mask, commit_lsn);
+}
+
+BookingResult BookingService::book_seat_labels(ShowId show_id, Span<const std::string_view> seat_labels) {
+    return measured(MetricsApi::BookSeats, [&] {
+        const TraceScope trace(TraceStage::BookSeats, static_cast<std::uint64_t>(show_id.value()));
+        ShowState* st = nullptr;
+        {
+            const TraceScope stage(TraceStage::Lookup);
+            st = get_state_mut(show_id);
+        }
+        return book_views_on(st, show_id, seat_labels);
+    });
+}
 
-    // CAS loop: atomic all-or-nothing booking
-    std::uint32_t current = st->booked_mask.load();
+BookingResult BookingService::book_seat_labels(ShowHandle& show, Span<const std::string_view> seat_labels) {
+    return measured(MetricsApi::BookSeats, [&] {
+        const TraceScope trace(TraceStage::BookSeats, static_cast<std::uint64_t>(show.show_id().value()));
+        return book_views_on(resolve(show), show.show_id(), seat_labels);
+    });
+}
+
+BookingResult BookingService::book_label_list(ShowId show_id, std::string_view seat_labels) {
+    return measured(MetricsApi::BookSeats, [&] {
+        const TraceScope trace(TraceStage::BookSeats, static_cast<std::uint64_t>(show_id.value()));
+        ShowState* st = nullptr;
+        {
+            const TraceScope stage(TraceStage::Lookup);
+            st = get_state_mut(show_id);
+        }
+        return book_list_on(st, show_id, seat_labels);
+    });
+}
+
+BookingResult BookingService::book_label_list(ShowHandle& show, std::string_view seat_labels) {
+    return measured(MetricsApi::BookSeats, [&] {
+        const TraceScope trace(TraceStage::BookSeats, static_cast<std::uint64_t>(show.show_id().value()));
+        return book_list_on(resolve(show), show.show_id(), seat_labels);
+    });
+}
+
+BookingResult BookingService::book_list_on(ShowState* st, ShowId show_id, std::string_view seat_labels) {
+    if (!st) {
+        return BookingResult::error(BookingStatus::InvalidShow);
+    }
+    if (!admit_booker(show_id)) {
+        return BookingResult::error(BookingStatus::Throttled);
+    }
+
+    SeatMask req_mask;
+    int bad_index = -1;
+    std::string_view bad_label;
+    BookingStatus parsed = BookingStatus::Ok;
+    {
+        const TraceScope stage(TraceStage::Parse, seat_labels.size());
+        parsed = label_list_to_mask_or_fail(*st->layout, seat_labels, req_mask, bad_index, bad_label);
+    }
+    if (parsed == BookingStatus::NoSeats) {
+        return BookingResult::error(BookingStatus::NoSeats);
+    }
+    if (parsed != BookingStatus::Ok) {
+        return BookingResult::label_error(parsed, bad_index, bad_label);
+    }
+    return book_owned(*st, req_mask);
+}
+
+BookingResult BookingService::book_views_on(ShowState* st, ShowId show_id, Span<const std::string_view> seat_labels) {
+    if (!st) {
+        return BookingResult::error(BookingStatus::InvalidShow);
+    }
+    if (!admit_booker(show_id)) {
+        return BookingResult::error(BookingStatus::Throttled);
+    }
+    if (seat_labels.empty()) {
+        return BookingResult::error(BookingStatus::NoSeats);
+    }
+
+    SeatMask req_mask;
+    int bad_index = -1;
+    BookingStatus parsed = BookingStatus::Ok;
+    {
+        const TraceScope stage(TraceStage::Parse, seat_labels.size());
+        parsed = seats_to_mask_or_fail(*st->layout, seat_labels, req_mask, bad_index);
+    }
+    if (parsed != BookingStatus::Ok) {
+        return BookingResult::label_error(parsed, bad_index, seat_labels[static_cast<std::size_t>(bad_index)]);
+    }
+    return book_owned(*st, req_mask);
+}
+
+BookingResult BookingService::parse_seat_labels(ShowId show_id, Span<const std::string_view> seat_labels,
+                                                SeatMask& out) const {
+    out = SeatMask{};
+    const ShowState* st = get_state(show_id);
+    if (!st) {
+        return BookingResult::error(BookingStatus::InvalidShow);
+    }
+    if (seat_labels.empty()) {
+        return BookingResult::error(BookingStatus::NoSeats);
+    }
+    int bad_index = -1;
+    const BookingStatus parsed = seats_to_mask_or_fail(*st->layout, seat_labels, out, bad_index);
+    if (parsed != BookingStatus::Ok) {
+        out = SeatMask{};
+        return BookingResult::label_error(parsed, bad_index, seat_labels[static_cast<std::size_t>(bad_index)]);
+    }
+    return BookingResult::ok();
+}
+
+BookingResult BookingService::book_seat_indices(ShowId show_id, Span<const int> seats) {
+    return measured(MetricsApi::BookSeats, [&] {
+        ShowState* st = get_state_mut(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (!admit_booker(show_id)) {
+            return BookingResult::error(BookingStatus::Throttled);
+        }
+        if (seats.empty()) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+
+        SeatMask req_mask;
+        for (std::size_t i = 0; i < seats.size(); ++i) {
+            if (!st->layout->contains(seats[i])) {
+                return BookingResult::index_error(BookingStatus::InvalidSeatIndex, static_cast<int>(i));
+            }
+            if (req_mask.test(seats[i])) {
+                return BookingResult::index_error(BookingStatus::DuplicateSeatLabel, static_cast<int>(i));
+            }
+            req_mask.set(seats[i]);
+        }
+        return book_owned(*st, req_mask);
+    });
+}
+
+BookingResult BookingService::book_seat_mask(ShowId show_id, const SeatMask& seats) {
+    return book_seat_mask(show_id, seats, nullptr);
+}
+
+BookingResult BookingService::book_seat_mask(ShowId show_id, const SeatMask& seats, std::uint64_t* commit_lsn) {
+    return measured(MetricsApi::BookSeats, [&] {
+        ShowState* st = get_state_mut(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (!admit_booker(show_id)) {
+            return BookingResult::error(BookingStatus::Throttled);
+        }
+        if (seats.empty()) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+        // Every bit must name an existing seat of the layout
+        for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+            const std::uint64_t valid = w < st->word_count ? st->layout->row_mask(w) : 0u;
+            if ((seats.word(w) & ~valid) != 0u) {
+                return BookingResult::error(BookingStatus::InvalidSeatIndex);
+            }
+        }
+        return book_owned(*st, seats, commit_lsn);
+    });
+}
+
+BookingResult BookingService::book_best_available(ShowId show_id, int n, SeatMask& out_seats) {
+    return measured(MetricsApi::BookBestAvailable, [&] {
+        out_seats = SeatMask{};
+        ShowState* st = get_state_mut(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (!admit_booker(show_id)) {
+            return BookingResult::error(BookingStatus::Throttled);
+        }
+        if (n < 1) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+        return on_owner(show_id, [&] { return book_best_on(*st, n, out_seats); });
+    });
+}
+
+BookingResult BookingService::book_best_under(ShowId show_id, int n, std::uint32_t max_price, SeatMask& out_seats) {
+    return measured(MetricsApi::BookBestAvailable, [&] {
+        out_seats = SeatMask{};
+        ShowState* st = get_state_mut(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (!admit_booker(show_id)) {
+            return BookingResult::error(BookingStatus::Throttled);
+        }
+        if (n < 1) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+        if (st->layout->price_levels() == 0) { // unpriced: every seat costs 0
+            return on_owner(show_id, [&] { return book_best_on(*st, n, out_seats); });
+        }
+        const int level = st->layout->level_at_most(max_price);
+        if (level < 0) {
+            return BookingResult::error(BookingStatus::NoContiguousSeats);
+        }
+        return on_owner(show_id, [&] { return book_best_on(*st, n, out_seats, level, level); });
+    });
+}
+
+BookingResult BookingService::book_cheapest_available(ShowId show_id, int n, SeatMask& out_seats) {
+    return measured(MetricsApi::BookBestAvailable, [&] {
+        out_seats = SeatMask{};
+        ShowState* st = get_state_mut(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (!admit_booker(show_id)) {
+            return BookingResult::error(BookingStatus::Throttled);
+        }
+        if (n < 1) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+        const int levels = st->layout->price_levels();
+        return on_owner(show_id, [&] {
+            return levels == 0 ? book_best_on(*st, n, out_seats) : book_best_on(*st, n, out_seats, 0, levels - 1);
+        });
+    });
+}
+
+BookingResult BookingService::book_best_on(ShowState& st, int n, SeatMask& out_seats, int first_level, int last_level) {
+    note_demand(st);
+    const std::uint64_t run_bits = n >= 64 ? ~std::uint64_t{0} : ((std::uint64_t{1} << n) - 1u);
+
+    const HallLayout& layout = *st.layout;
+    const bool open_only = layout.has_seat_categories();
+    const bool no_gaps = layout.forbids_single_gaps();
+    const bool aisles = layout.has_aisles();
+    Backoff backoff(backoff_policy());
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    std::array<std::uint64_t, HallLayout::kMaxRows> scan_words;
+    std::array<std::uint64_t, HallLayout::kMaxRows> run_words;
+    const SeatRunSummary* summary = summary_of(st);
     while (true) {
+        // With a run summary, descend it first: only rows with a free run of n can hold the
+        // seats (the level, category and gap rules only shorten runs)
+        std::uint64_t candidates = ~std::uint64_t{0};
+        if (summary) {
+            if (summary->longest(static_cast<int>(st.position)) < n) {
+                return BookingResult::error(BookingStatus::NoContiguousSeats);
+            }
+            candidates = summary->rows_with_run(static_cast<int>(st.position), n);
+        }
+        // Load every candidate row once (no snapshot needed: the CAS decides), then find the
+        // runs of all rows with the vector kernel, within the cheapest price level that has one
+        load_search_words(st, free_words.data(), candidates);
+        const std::size_t words = static_cast<std::size_t>(st.word_count);
+        std::uint64_t rows = 0;
+        for (int level = first_level; level <= last_level; ++level) {
+            const std::uint64_t* scan = free_words.data();
+            if (level >= 0 || open_only) {
+                // Seats the search may not pick count as taken (single gaps are judged on free_words)
+                const std::uint64_t* open = layout.open_row_masks();
+                const std::uint64_t* priced = level >= 0 ? layout.level_seats(level) : open;
+                for (std::size_t w = 0; w < words; ++w) scan_words[w] = free_words[w] & open[w] & priced[w];
+                scan = scan_words.data();
+            }
+            rows = seat_scan::kernels().find_runs(scan, words, n, run_words.data());
+            if (no_gaps || aisles) {
+                // Runs must not leave a single gap or cross an aisle (precomputed block starts)
+                for (std::uint64_t left = rows; left != 0u; left &= left - 1u) {
+                    const std::size_t w = static_cast<std::size_t>(ctz64(left));
+                    if (no_gaps) run_words[w] &= ~gap_leaving_starts(free_words[w], n);
+                    if (aisles) run_words[w] &= layout.block_starts(static_cast<int>(w), n);
+                    if (run_words[w] == 0u) rows &= ~(std::uint64_t{1} << w);
+                }
+            }
+            if (rows != 0u) break;
+        }
+        int best_cost = INT_MAX;
+        int best_row = -1;
+        int best_col = 0;
+        while (rows != 0u) {
+            const int w = ctz64(rows);
+            rows &= rows - 1u;
+            const std::uint64_t starts = run_words[static_cast<std::size_t>(w)];
+            const int ideal = (layout.row_seats(w) - n) / 2;
+            const int col = nearest_bit(starts, ideal);
+            const int cost = layout.run_cost(w, col, n);
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_row = w;
+                best_col = col;
+            }
+        }
+        if (best_row < 0) {
+            return BookingResult::error(BookingStatus::NoContiguousSeats);
+        }
+
+        const std::uint64_t bits = run_bits << best_col;
+        std::uint64_t taken = 0u;
+        std::uint32_t retries = 0;
+        const Acquire outcome = try_acquire_word(st, best_row, bits, taken, retries);
+        note_cas_retries(st, retries);
+        if (outcome == Acquire::Acquired) {
+            out_seats.or_word(best_row, bits);
+            BookingResult res = BookingResult::ok();
+            res.id = record_owner(st, out_seats);
+            return res;
+        }
+        if (outcome == Acquire::OverCap) {
+            return BookingResult::error(BookingStatus::TheaterCapReached);
+        }
+        if (outcome == Acquire::Closed) {
+            return BookingResult::error(BookingStatus::SalesClosed);
+        }
+        // Conflict: someone took part of the run after the scan; search again on fresh state
+        if (outcome == Acquire::Contended || !backoff.retry()) {
+            st.contended.fetch_add(1, std::memory_order_relaxed);
+            return BookingResult::error(BookingStatus::Contended);
+        }
+    }
+}
+
+namespace {
+
+constexpr std::size_t kParallelBatchRequests = 1024; /**< Smaller batches book faster on one thread. */
+
+/**
+ * @brief Conflict result for @p req, with an alternative (see BookingResult::alternative)
+ *        when all of @p taken lies in one row whose booking word read @p word.
+ */
+BookingResult conflict_result(const HallLayout& layout, const SeatMask& req, const SeatMask& taken,
+                              std::uint64_t word) {
+    BookingResult res = BookingResult::conflict(taken);
+    if (taken.first_word() + 1 != taken.end_word()) return res;
+    const int row = taken.first_word();
+    const std::uint64_t bits = req.word(row);
+    const std::uint64_t free = ~word & layout.row_mask(row);
+    // Category seats are only suggested to requests that asked for some
+    const std::uint64_t open_seats = layout.open_row_masks()[row];
+    const std::uint64_t candidates = (bits & ~open_seats) != 0u ? free : free & open_seats;
+    const int n = popcount64(bits);
+    const int first = ctz64(bits);
+    const std::uint64_t run_bits = n >= 64 ? ~std::uint64_t{0} : ((std::uint64_t{1} << n) - 1u);
+
+    std::uint64_t seats = 0u;
+    if ((bits >> first) == run_bits) {
+        // A run: the nearest run of as many seats the row would accept
+        std::uint64_t starts = run_starts(candidates, n);
+        if (layout.has_aisles()) starts &= layout.block_starts(row, n);
+        if (layout.forbids_single_gaps() && starts != 0u) starts &= ~gap_leaving_starts(free, n);
+        if (starts == 0u) return res;
+        seats = run_bits << nearest_bit(starts, first);
+    } else {
+        // Single seats: keep the free ones, replace each taken one by its nearest free seat
+        seats = bits & free;
+        for (std::uint64_t lost = bits & word; lost != 0u; lost &= lost - 1u) {
+            const std::uint64_t left = candidates & ~seats;
+            if (left == 0u) return res;
+            seats |= std::uint64_t{1} << nearest_bit(left, ctz64(lost));
+        }
+    }
+    res.suggested_row = row;
+    res.suggested_seats = seats;
+    return res;
+}
+
+} // namespace
+
+std::vector<BookingResult> BookingService::book_seats_batch(Span<const BookingRequest> requests) {
+    std::vector<BookingResult> results(requests.size());
+    book_seats_batch(requests, results);
+    return results;
+}
+
+std::size_t BookingService::book_seats_batch(Span<const BookingRequest> requests, Span<BookingResult> out_results) {
+    const Span<BookingResult> results(out_results.data(), requests.size());
+    measured(MetricsApi::BookBatch, [&] {
+        for (std::size_t i = 0; i < requests.size(); ++i) results[i] = BookingResult{};
+        RequestArena::Scope scratch(RequestArena::local());
+
+        // Group by show while keeping arrival order inside each group
+        std::pmr::vector<std::size_t> order(requests.size(), scratch.resource());
+        for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+        // Ties broken by index: the order of a stable sort, without its heap scratch buffer
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return requests[a].show_id != requests[b].show_id ? requests[a].show_id < requests[b].show_id : a < b;
+        });
+
+        std::pmr::vector<SeatMask> masks(requests.size(), scratch.resource());
+        std::pmr::vector<std::size_t> groups(scratch.resource()); // start of each show's run in order, plus the end
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            if (k == 0u || requests[order[k]].show_id != requests[order[k - 1u]].show_id) groups.push_back(k);
+        }
+        groups.push_back(order.size());
+
+        // Each group touches only its own show and its own results
+        const auto book_group = [&](std::size_t group_begin, std::size_t group_end) {
+            const ShowId show_id = requests[order[group_begin]].show_id;
+            ShowState* st = get_state_mut(show_id); // one lookup per show
+            if (!st) {
+                for (std::size_t k = group_begin; k < group_end; ++k) {
+                    results[order[k]] = BookingResult::error(BookingStatus::InvalidShow);
+                }
+                return;
+            }
+            // Held until the owners are recorded, so a move_show freeze waits for the whole group
+            const ShowGate::Pass pass(show_gate_, show_id.value());
+            if (moved_since_lookup(show_id)) {
+                for (std::size_t k = group_begin; k < group_end; ++k) {
+                    results[order[k]] = BookingResult::error(BookingStatus::Contended);
+                }
+                return;
+            }
+
+            // Requests shed by the show's admission gate never reach the words
+            bool any_admitted = false;
+            for (std::size_t k = group_begin; k < group_end; ++k) {
+                if (admit_booker(show_id)) {
+                    any_admitted = true;
+                } else {
+                    results[order[k]] = BookingResult::error(BookingStatus::Throttled);
+                }
+            }
+            if (!any_admitted) return;
+
+            // Snapshot of the show, loaded once for the whole group
+            std::array<std::uint64_t, HallLayout::kMaxRows> current{};
+            const std::atomic<std::uint64_t>* words = st->words();
+            for (int w = 0; w < st->word_count; ++w) current[static_cast<std::size_t>(w)] = words[w].load();
+
+            SeatMask accepted;
+            bool any_accepted = false;
+            std::uint64_t attempts = 0; // requests that reached the words, for hot_shows
+            for (std::size_t k = group_begin; k < group_end; ++k) {
+                const std::size_t i = order[k];
+                if (results[i].status == BookingStatus::Throttled) continue;
+                if (const SeatMask* seats = requests[i].seats) {
+                    if (seats->empty()) {
+                        results[i] = BookingResult::error(BookingStatus::NoSeats);
+                        continue;
+                    }
+                    bool valid = true;
+                    for (int w = seats->first_word(); w < seats->end_word(); ++w) {
+                        const std::uint64_t row = w < st->word_count ? st->layout->row_mask(w) : 0u;
+                        valid = valid && (seats->word(w) & ~row) == 0u;
+                    }
+                    if (!valid) {
+                        results[i] = BookingResult::error(BookingStatus::InvalidSeatIndex);
+                        continue;
+                    }
+                    masks[i] = *seats;
+                } else {
+                    const Span<const std::string_view> labels = requests[i].seat_labels;
+                    if (labels.empty()) {
+                        results[i] = BookingResult::error(BookingStatus::NoSeats);
+                        continue;
+                    }
+                    int bad_index = -1;
+                    const BookingStatus parsed = seats_to_mask_or_fail(*st->layout, labels, masks[i], bad_index);
+                    if (parsed != BookingStatus::Ok) {
+                        results[i] =
+                            BookingResult::label_error(parsed, bad_index, labels[static_cast<std::size_t>(bad_index)]);
+                        continue;
+                    }
+                }
+
+                ++attempts;
+                SeatMask taken;
+                for (int w = masks[i].first_word(); w < masks[i].end_word(); ++w) {
+                    taken.or_word(w, current[static_cast<std::size_t>(w)] & masks[i].word(w));
+                }
+                if (!taken.empty()) {
+                    const int row = taken.first_word();
+                    results[i] = conflict_result(*st->layout, masks[i], taken, current[static_cast<std::size_t>(row)]);
+                    continue;
+                }
+                for (int w = masks[i].first_word(); w < masks[i].end_word(); ++w) {
+                    current[static_cast<std::size_t>(w)] |= masks[i].word(w);
+                    accepted.or_word(w, masks[i].word(w));
+                }
+                results[i] = BookingResult::ok();
+                any_accepted = true;
+            }
+
+            if (any_accepted) {
+                std::uint64_t commit_lsn = 0;
+                SeatMask ignored;
+                const bool published = try_acquire_words(*st, accepted, ignored) == Acquire::Acquired;
+                for (std::size_t k = group_begin; k < group_end; ++k) {
+                    const std::size_t i = order[k];
+                    if (!results[i].success) continue;
+                    if (published) {
+                        results[i].id = record_owner(*st, masks[i], &commit_lsn);
+                    } else {
+                        // Someone else booked in between: replay this show's accepted requests one by one
+                        --attempts; // counted again by the replay
+                        results[i] = book_owned(*st, masks[i]);
+                    }
+                }
+                // One durability wait for the whole group (records are committed in order)
+                if (journal_ && journal_->mode() == JournalMode::Sync && commit_lsn != 0u) {
+                    journal_->wait_durable(commit_lsn);
+                }
+            }
+            note_demand(*st, attempts); // one sketch update per show
+        };
+
+        const std::size_t group_count = groups.size() - 1u;
+        if (requests.size() >= kParallelBatchRequests && group_count > 1u) {
+            thread_pool().parallel_for(group_count, 1u, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t g = begin; g < end; ++g) book_group(groups[g], groups[g + 1u]);
+            });
+        } else {
+            for (std::size_t g = 0; g < group_count; ++g) book_group(groups[g], groups[g + 1u]);
+        }
+        return Span<const BookingResult>(results.data(), results.size());
+    });
+    std::size_t succeeded = 0;
+    for (const BookingResult& r : results) succeeded += r.success ? 1u : 0u;
+    return succeeded;
+}
+
+BookingResult BookingService::book_mask_on(ShowState& st, const SeatMask& req_mask) const {
+    note_demand(st);
+    SeatMask taken;
+    std::uint64_t word = 0u; // on Conflict: the value of the first conflicting word
+    Acquire outcome;
+    if (req_mask.single_word()) {
+        // Fast path: CAS loop on the single row word, exactly like a single-mask show
+        const int w = req_mask.first_word();
+        std::uint64_t taken_bits = 0u;
+        std::uint32_t retries = 0;
+        outcome = try_acquire_word(st, w, req_mask.word(w), taken_bits, retries, &word);
+        note_cas_retries(st, retries);
+        taken.or_word(w, taken_bits);
+    } else {
+        outcome = try_acquire_words(st, req_mask, taken, &word);
+    }
+
+    switch (outcome) {
+        case Acquire::Acquired:
+            return BookingResult::ok();
+        case Acquire::Conflict:
+            st.conflicts.fetch_add(1, std::memory_order_relaxed);
+            return conflict_result(*st.layout, req_mask, taken, word);
+        case Acquire::Rejected:
+            return BookingResult::error(BookingStatus::CompanionSeatRule);
+        case Acquire::Gap:
+            return BookingResult::error(BookingStatus::SingleSeatGap);
+        case Acquire::OverCap:
+            return BookingResult::error(BookingStatus::TheaterCapReached);
+        case Acquire::Closed:
+            return BookingResult::error(BookingStatus::SalesClosed);
+        case Acquire::Contended:
+            break;
+    }
+    st.contended.fetch_add(1, std::memory_order_relaxed);
+    return BookingResult::error(BookingStatus::Contended);
+}
+
+BookingResult BookingService::book_owned(ShowState& st, const SeatMask& req_mask, std::uint64_t* commit_lsn) {
+    if (commit_lsn) *commit_lsn = 0;
+    BookingResult res = on_owner(id_of(st), [&] {
+        BookingResult r = [&] {
+            const TraceScope trace(TraceStage::Acquire);
+            return book_mask_on(st, req_mask);
+        }();
+        if (r.success) r.id = record_owner(st, req_mask, commit_lsn);
+        return r;
+    });
+    if (commit_lsn && (!journal_ || journal_->mode() != JournalMode::Sync)) *commit_lsn = 0;
+    return res;
+}
+
+BookingId BookingService::record_owner(ShowState& st, const SeatMask& seats, std::uint64_t* commit_lsn, bool sale) {
+    sim_point();
+    const BookingId id = booking_ids_.next();
+
+    // The seats' bits are already ours, so plain stores cannot race with another owner
+    OwnerRow* rows = ensure_owners(st);
+    for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+        std::uint64_t bits = seats.word(w);
+        while (bits != 0u) {
+            owner_of(rows, HallLayout::seat_index(w, ctz64(bits))).store(id, std::memory_order_release);
+            bits &= bits - 1u;
+        }
+    }
+    note_write(st); // again: a delta pass between the CAS and here wrote the seats unowned
+    if (persistent_seats_) persist_seats(st, seats);
+    if (sales_ && sale) {
+        sales_->record_show(id_of(st), SalesAnalytics::CustomerScope::current(),
+                            static_cast<std::uint32_t>(seats.count()));
+    }
+
+    // Journaled once the owners are visible: a cancellation (which needs them) always follows
+    if (journal_) {
+        if (commit_lsn) {
+            *commit_lsn = journal_->append(JournalOp::Book, id_of(st), id, seats);
+        } else {
+            journal_commit(JournalOp::Book, st, id, seats);
+        }
+    }
+    return id;
+}
+
+BookingResult BookingService::cancel_seats(ShowId show_id, const std::vector<std::string>& seat_labels,
+                                           BookingId booking_id) {
+    return measured(MetricsApi::CancelSeats, [&] {
+        const ShowState* st = get_state(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (seat_labels.empty()) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+
+        SeatMask req_mask;
+        int bad_index = -1;
+        const BookingStatus parsed = seats_to_mask_or_fail(*st->layout, seat_labels, req_mask, bad_index);
+        if (parsed != BookingStatus::Ok) {
+            return BookingResult::label_error(parsed, bad_index, seat_labels[static_cast<std::size_t>(bad_index)]);
+        }
+        return cancel_seat_mask(show_id, req_mask, booking_id);
+    });
+}
+
+BookingResult BookingService::cancel_seat_labels(ShowId show_id, Span<const std::string_view> seat_labels,
+                                                 BookingId booking_id) {
+    return measured(MetricsApi::CancelSeats, [&] {
+        const ShowState* st = get_state(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (seat_labels.empty()) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+
+        SeatMask req_mask;
+        int bad_index = -1;
+        const BookingStatus parsed = seats_to_mask_or_fail(*st->layout, seat_labels, req_mask, bad_index);
+        if (parsed != BookingStatus::Ok) {
+            return BookingResult::label_error(parsed, bad_index, seat_labels[static_cast<std::size_t>(bad_index)]);
+        }
+        return cancel_seat_mask(show_id, req_mask, booking_id);
+    });
+}
+
+BookingResult BookingService::cancel_seat_mask(ShowId show_id, const SeatMask& seats, BookingId booking_id) {
+    return measured(MetricsApi::CancelSeats, [&] {
+        ShowState* st = get_state_mut(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (seats.empty()) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+        for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+            const std::uint64_t valid = w < st->word_count ? st->layout->row_mask(w) : 0u;
+            if ((seats.word(w) & ~valid) != 0u) {
+                return BookingResult::error(BookingStatus::InvalidSeatIndex);
+            }
+        }
+
+        return on_owner(show_id, [&] { return cancel_owned(*st, seats, booking_id); });
+    });
+}
+
+BookingResult BookingService::cancel_owned(ShowState& st, const SeatMask& seats, BookingId booking_id) {
+    // Claim every owner entry (booking_id -> 0); a mismatch undoes the claims made so far
+    OwnerRow* rows = st.owners.load(std::memory_order_acquire);
+    if (!rows) {
+        return BookingResult::not_owner(seats); // nothing of this show was ever booked
+    }
+    SeatMask foreign;
+    for (int w = seats.first_word(); w < seats.end_word() && foreign.empty(); ++w) {
+        std::uint64_t bits = seats.word(w);
+        while (bits != 0u) {
+            const int seat = HallLayout::seat_index(w, ctz64(bits));
+            BookingId expected = booking_id;
+            sim_point();
+            if (booking_id == 0u
+                || !owner_of(rows, seat).compare_exchange_strong(expected, 0u, std::memory_order_acq_rel)) {
+                foreign.set(seat);
+                break;
+            }
+            bits &= bits - 1u;
+        }
+    }
+    if (!foreign.empty()) {
+        for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+            std::uint64_t bits = seats.word(w);
+            while (bits != 0u) {
+                const int seat = HallLayout::seat_index(w, ctz64(bits));
+                if (foreign.test(seat)) {
+                    return BookingResult::not_owner(foreign);
+                }
+                owner_of(rows, seat).store(booking_id, std::memory_order_release);
+                bits &= bits - 1u;
+            }
+        }
+        return BookingResult::not_owner(foreign);
+    }
+
+    // Owners are cleared first: the bits can now be released, one atomic AND per row
+    release_mask(st, seats);
+    if (persistent_seats_) persist_seats(st, seats);
+    if (journal_) journal_commit(JournalOp::Cancel, st, booking_id, seats);
+    notify_waitlist(st);
+    return BookingResult::ok();
+}
+
+void BookingService::release_mask(ShowState& st, const SeatMask& seats) const {
+    if (seats.single_word()) {
+        release_word(st, seats.first_word(), seats.word(seats.first_word()));
+        return;
+    }
+    const GroupWrite group(st);
+    for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+        const std::uint64_t bits = seats.word(w);
+        if (bits != 0u) release_word(st, w, bits);
+    }
+}
+
+BookingId BookingService::seat_owner(ShowId show_id, int seat) const {
+    const ShowState* st = get_state(show_id);
+    if (!st || !st->layout->contains(seat)) return 0u;
+    OwnerRow* rows = st->owners.load(std::memory_order_acquire);
+    return rows ? owner_of(rows, seat).load(std::memory_order_acquire) : 0u;
+}
+
+HugePages BookingService::seat_state_pages(ShowId show_id) const {
+    return show_state_.backing(show_id);
+}
+
+int BookingService::seat_state_node(ShowId show_id) const {
+    return show_state_.node(show_id);
+}
+
+int BookingService::booking_seats(ShowId show_id, BookingId booking_id, SeatMask& out_seats) const {
+    out_seats = SeatMask{};
+    const ShowState* st = get_state(show_id);
+    if (!st) return -1;
+    if (booking_id == 0u) return 0;
+
+    const OwnerRow* rows = st->owners.load(std::memory_order_acquire);
+    if (!rows) return 0;
+
+    int found = 0;
+    const std::atomic<std::uint64_t>* words = st->words();
+    for (int w = 0; w < st->word_count; ++w) {
+        std::uint64_t booked = words[w].load(std::memory_order_acquire);
+        while (booked != 0u) {
+            const int col = ctz64(booked);
+            booked &= booked - 1u;
+            if (rows[w].seats[static_cast<std::size_t>(col)].load(std::memory_order_relaxed) == booking_id) {
+                out_seats.set(HallLayout::seat_index(w, col));
+                ++found;
+            }
+        }
+    }
+    return found;
+}
+
+BookingService::Acquire BookingService::try_acquire_word(ShowState& st, int w, std::uint64_t req,
+                                                         std::uint64_t& out_conflict,
+                                                         std::uint32_t& retries, std::uint64_t* out_word) const {
+    // CAS loop: atomic all-or-nothing booking of the bits of one word
+    std::optional<GroupWrite> group; // with a feed, the CAS and its feed entry are one group write
+    if (change_feed_) group.emplace(st);
+    std::atomic<std::uint64_t>& word = ensure_words(st)[w];
+    const HallLayout& layout = *st.layout;
+    const bool rules = layout.has_booking_rules();
+    CapacityCounter* const cap = capacity_of(st);
+    bool reserved = false; // seats taken on cap, kept if the CAS succeeds
+    const auto fail = [&](Acquire outcome, std::uint32_t attempts) {
+        if (reserved) cap->release(popcount64(req));
+        retries += attempts;
+        return outcome;
+    };
+    Backoff backoff(backoff_policy());
+    std::uint64_t current = word.load(seat_words::kWordLoad);
+    while (true) {
+        // Read with every value the CAS may replace: set_sales_state drains the loops that passed it
+        if (st.sales.load(std::memory_order_acquire) != 0u) return fail(Acquire::Closed, backoff.retries());
         if ((current & req) != 0u) {
-            return BookingResult{false, "One or more seats already booked"};
+            out_conflict = current & req;
+            if (out_word) *out_word = current;
+            return fail(Acquire::Conflict, backoff.retries());
+        }
+        const std::uint64_t desired = (current | req);
+        // Judged on the same value the CAS replaces, so a concurrent cancel cannot slip past it
+        if (rules) {
+            if (!layout.companion_rule_ok(w, req, desired)) {
+                return fail(Acquire::Rejected, backoff.retries());
+            }
+            const std::uint64_t seats = layout.row_mask(w);
+            if (layout.forbids_single_gaps()
+                && (isolated_seats(~desired & seats) & ~isolated_seats(~current & seats)) != 0u) {
+                return fail(Acquire::Gap, backoff.retries());
+            }
+        }
+        // Reserve-then-commit: the theater's seats are taken once, before the first CAS
+        if (cap && !reserved) {
+            if (!cap->try_reserve(popcount64(req))) return fail(Acquire::OverCap, backoff.retries());
+            reserved = true;
         }
-        const std::uint32_t desired = (current | req);
-        if (st->booked_mask.compare_exchange_weak(current, desired)) { // On failure: compare_exchange_weak updates current to the latest value in the atomic then you loop and retry with the new current
-            return BookingResult{true, "Booked successfully"};
+        sim_point(); // simulations interleave other requests between the judgement and the CAS
+        if (word.compare_exchange_weak(current, desired, seat_words::kWordUpdate, seat_words::kWordLoad)) { // On failure: compare_exchange_weak updates current to the latest value in the atomic then you loop and retry with the new current
+            retries += backoff.retries();
+            st.changes().fetch_add(1u, std::memory_order_release);
+            note_write(st);
+            note_runs(st, w);
+            if (change_feed_) change_feed_->publish(id_of(st), w, current, desired); // current: the replaced value
+            return Acquire::Acquired;
+        }
+        // compare_exchange updated 'current' to latest value; back off, then retry
+        if (!backoff.retry()) {
+            return fail(Acquire::Contended, backoff.retries() - 1u); // the rejected attempt is not retried
+        }
+    }
+}
+
+BookingService::Acquire BookingService::try_acquire_words(ShowState& st, const SeatMask& req,
+                                                          SeatMask& out_conflicts, std::uint64_t* out_word) const {
+    // Acquire words in ascending order; on the first conflict release the words already taken.
+    // Every thread uses the same order and nobody waits on a word, so there is no deadlock and
+    // no lock: a conflicting request just rolls back and fails.
+    const GroupWrite group(st);
+    if (htm_ && try_acquire_words_htm(st, req)) return Acquire::Acquired;
+    std::uint32_t retries = 0;
+    Acquire outcome = Acquire::Acquired;
+    for (int w = req.first_word(); w < req.end_word(); ++w) {
+        const std::uint64_t bits = req.word(w);
+        if (bits == 0u) continue;
+        std::uint64_t taken = 0u;
+        outcome = try_acquire_word(st, w, bits, taken, retries, out_word);
+        if (outcome != Acquire::Acquired) {
+            for (int prev = req.first_word(); prev < w; ++prev) {
+                const std::uint64_t prev_bits = req.word(prev);
+                if (prev_bits != 0u) {
+                    release_word(st, prev, prev_bits); // only clears bits this request set
+                }
+            }
+            if (outcome == Acquire::Conflict) {
+                // Report the conflicting seats of this word and of the words not yet attempted
+                out_conflicts.or_word(w, taken);
+                for (int rest = w + 1; rest < req.end_word(); ++rest) {
+                    out_conflicts.or_word(rest, st.words()[rest].load(seat_words::kWordLoad) & req.word(rest));
+                }
+            }
+            break;
+        }
+    }
+    note_cas_retries(st, retries);
+    return outcome;
+}
+
+bool BookingService::try_acquire_words_htm(ShowState& st, const SeatMask& req) const {
+    if (st.layout->has_booking_rules() || capacity_of(st) || st.sales.load(std::memory_order_acquire) != 0u) {
+        return false; // judged by the CAS path only
+    }
+    std::array<std::uint64_t, HallLayout::kMaxRows> old;
+    for (int attempt = 0; attempt < kHtmAttempts; ++attempt) {
+        switch (htm::or_words(ensure_words(st), req, old.data())) {
+            case htm::Outcome::Committed:
+                htm_commits_.fetch_add(1, std::memory_order_relaxed);
+                for (int w = req.first_word(); w < req.end_word(); ++w) {
+                    const std::uint64_t bits = req.word(w);
+                    if (bits == 0u) continue;
+                    const std::uint64_t replaced = old[static_cast<std::size_t>(w - req.first_word())];
+                    st.changes().fetch_add(1u, std::memory_order_release);
+                    note_runs(st, w);
+                    if (change_feed_) change_feed_->publish(id_of(st), w, replaced, replaced | bits);
+                }
+                note_write(st);
+                return true;
+            case htm::Outcome::Aborted:
+                htm_aborts_.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case htm::Outcome::Conflict: // the software path finds and reports the taken seats
+            case htm::Outcome::Unsupported:
+                attempt = kHtmAttempts;
+                break;
         }
-        // compare_exchange updated 'current' to latest value; retry
     }
+    htm_fallbacks_.fetch_add(1, std::memory_order_relaxed);
+    return false;
 }
 
-bool BookingService::try_parse_seat_label(const std::string& label, int& out_index0) {
-    // Expected format: a1..a20 (case-insensitive 'a')
-    if (label.size() < 2) return false; //check that a label has at least 2 chars in the string as a1 or a2, not just a
+CatalogStatus BookingService::set_admission_policy(ShowId show_id, const AdmissionPolicy& policy) {
+    if (!get_state(show_id)) return CatalogStatus::UnknownShow;
+    std::lock_guard<std::mutex> lock(admission_mutex_);
+    AdmissionGate* gate = admission_.find(show_id);
+    if (!gate) gate = &admission_.emplace(show_id, [](AdmissionGate&) {});
+    gate->configure(policy);
+    return CatalogStatus::Ok;
+}
 
-    char row = label[0];
-    if (row == 'A') row = 'a'; // check that the first character in the string is A or a, and if it's A convert it to lowercase
-    if (row != 'a') return false;
+void BookingService::use_live_config(LiveConfig* config) {
+    if (live_config_) live_config_->unsubscribe(live_listener_);
+    live_config_ = config;
+    live_listener_ = 0;
+    if (!config) return;
+    live_listener_ = config->subscribe(
+        [this](const TuningConfig& previous, const TuningConfig& current) { apply_admission(previous, current); });
+    apply_admission(TuningConfig{}, config->current());
+}
 
-    try {
-        std::size_t pos = 0;
-        int num = std::stoi(label.substr(1), &pos); // use stoi to convert string to integer, taking a substring  starting from possition 1 in the label string, so after a, and returning at which possition it stoped
+void BookingService::apply_admission(const TuningConfig& previous, const TuningConfig& current) {
+    for (const auto& [show_id, policy] : previous.admission) {
+        const bool kept = std::any_of(current.admission.begin(), current.admission.end(),
+                                      [show_id = show_id](const auto& entry) { return entry.first == show_id; });
+        if (!kept) set_admission_policy(show_id, AdmissionPolicy{});
+    }
+    for (const auto& [show_id, policy] : current.admission) set_admission_policy(show_id, policy);
+}
 
-        // Ensure the entire numeric part was consumed (no "a12x")
-        if (pos != label.size() - 1) return false;
+std::chrono::nanoseconds BookingService::admission_retry_after(ShowId show_id) const {
+    const AdmissionGate* gate = admission_.find(show_id);
+    if (!gate) return std::chrono::nanoseconds{0};
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::nanoseconds{gate->retry_after_ns(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count())};
+}
 
-        if (num < 1 || num > kSeatCount) return false; // check that the seat number is in range 1-20
+void BookingService::enable_change_feed(std::size_t capacity, std::size_t lanes) {
+    if (!change_feed_) change_feed_ = std::make_unique<SeatChangeFeed>(capacity, lanes);
+}
 
-        out_index0 = num - 1;
-        return true;
-    } catch (...) {
-        return false; // if any exceptions thrown then return false
+void BookingService::enable_sales_analytics(const SalesAnalyticsOptions& options) {
+    if (sales_) return;
+    auto sales = std::make_unique<SalesAnalytics>(options);
+    // Shows already in the catalog; later ones are added with their booking state
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    for (std::size_t row = 0; row < c->shows.size(); ++row) {
+        const std::int32_t movie_slot = c->shows.movie_slots()[row];
+        sales->set_show_movie(c->shows.ids()[row], c->movies[static_cast<std::size_t>(movie_slot)].id);
     }
+    sales_ = std::move(sales);
+}
+
+void BookingService::set_execution_mode(ExecutionMode mode, unsigned workers) {
+    executor_.reset(); // drains and joins the previous owner threads
+    if (mode == ExecutionMode::OwnerThreads) executor_ = std::make_unique<ShowExecutor>(workers, ShowExecutor::kDefaultRingCapacity, numa_placement());
+}
+
+bool BookingService::contention_stats(ShowId show_id, ContentionStats& out) const {
+    const ShowState* st = get_state(show_id);
+    if (!st) return false;
+    out.cas_retries = st->cas_retries.load(std::memory_order_relaxed);
+    out.contended = st->contended.load(std::memory_order_relaxed);
+    out.conflicts = st->conflicts.load(std::memory_order_relaxed);
+    return true;
+}
+
+bool BookingService::try_parse_seat_label(std::string_view label, int& out_index0) {
+    // The default layout's grammar and row ("a1".."a20"); its one row makes the seat index the column
+    static const HallLayout row = HallLayout::single_row(kSeatCount);
+    return row.try_parse_label(label, out_index0);
 }
 
 // Method used for converting a seat index counting from 0 to a human readable seats naming in range a1...a20
 std::string BookingService::seat_label_from_index0(int index0) {
-    return std::string("a") + std::to_string(index0 + 1);
+    static const HallLayout row = HallLayout::single_row(HallLayout::kMaxRowSeats);
+    if (index0 < 0 || index0 >= HallLayout::kMaxRowSeats) return std::string("a") + std::to_string(index0 + 1);
+    return row.label(index0);
 }
 
 //Below we have 2 similar methods but one is const and second no because: One provides mutable access for write operations, the other enforces read-only access for const methods. This preserves const-correctness and prevents accidental mutation of shared state.
 BookingService::ShowState* BookingService::get_state_mut(ShowId show_id) {
-    auto it = show_state_.find(show_id);
-    if (it == show_state_.end()) return nullptr;
-    return it->second.get();
+    ShowState* st = show_state_.find(show_id);
+    if (st) {
+        if (LazySeatMaps* lazy = lazy_seats_.load(std::memory_order_acquire)) load_lazy_show(*lazy, *st);
+    }
+    note_lookup(show_id, st);
+    return st;
 }
 
 const BookingService::ShowState* BookingService::get_state(ShowId show_id) const {
-    auto it = show_state_.find(show_id);
-    if (it == show_state_.end()) return nullptr;
-    return it->second.get();
+    const ShowState* st = show_state_.find(show_id);
+    if (st) {
+        if (LazySeatMaps* lazy = lazy_seats_.load(std::memory_order_acquire)) load_lazy_show(*lazy, *st);
+    }
+    note_lookup(show_id, st);
+    return st;
 }
 
-std::uint32_t BookingService::seats_to_mask_or_fail(const std::vector<std::string>& labels,
-                                                    std::string& out_error) {
-    out_error.clear();
-    std::uint32_t mask = 0u;
+BookingService::ShowHandle BookingService::show_handle(ShowId show_id) const {
+    ShowHandle handle;
+    handle.show_id_ = show_id;
+    handle.epoch_ = state_epoch_.load(std::memory_order_acquire);
+    handle.state_ = show_state_.find(show_id);
+    return handle;
+}
 
-    for (const auto& lbl : labels) {
-        int idx0 = -1;
-        if (!try_parse_seat_label(lbl, idx0)) {
-            out_error = "Invalid seat label: " + lbl;
-            return 0u;
-        }
+BookingService::ShowState* BookingService::resolve(ShowHandle& show) const {
+    // Epoch read before the lookup: a removal racing with the refresh leaves the handle stale.
+    // A handle without a state retries too, so one taken before its show was added picks it up.
+    const std::uint64_t epoch = state_epoch_.load(std::memory_order_acquire);
+    if (epoch != show.epoch_ || show.state_ == nullptr) {
+        show.epoch_ = epoch;
+        show.state_ = show_state_.find(show.show_id_);
+    }
+    ShowState* st = show.state_;
+    if (st) {
+        if (LazySeatMaps* lazy = lazy_seats_.load(std::memory_order_acquire)) load_lazy_show(*lazy, *st);
+    }
+    note_lookup(show.show_id_, st);
+    return st;
+}
 
-        const std::uint32_t bit = (1u << idx0);
-        if (mask & bit) {
-            out_error = "Duplicate seat label: " + lbl;
-            return 0u;
-        }
+namespace {
+
+// Seats of the first @p count labels, checked one by one: finds the first duplicate once
+// the popcount has shown there is one
+template <typename SeatAt>
+int first_duplicate(std::size_t count, SeatAt seat_at) {
+    SeatMask seen;
+    for (std::size_t i = 0; i < count; ++i) {
+        const int seat = seat_at(i);
+        if (seen.test(seat)) return static_cast<int>(i);
+        seen.set(seat);
+    }
+    return -1;
+}
+
+// Shared by the std::string and std::string_view entry points
+template <typename Labels>
+BookingStatus labels_to_mask(const HallLayout& layout, const Labels& labels,
+                             SeatMask& out_mask, int& out_bad_index) {
+    out_mask = SeatMask{};
+
+    // Duplicates are rare: set every seat, then compare the popcount with the label count
+    std::size_t parsed = 0;
+    for (; parsed < labels.size(); ++parsed) {
+        int seat = -1;
+        if (!layout.try_parse_label(labels[parsed], seat)) break;
+        out_mask.set(seat);
+    }
+    if (static_cast<std::size_t>(out_mask.count()) != parsed) {
+        out_bad_index = first_duplicate(parsed, [&](std::size_t i) {
+            int seat = -1;
+            layout.try_parse_label(labels[i], seat);
+            return seat;
+        });
+        return BookingStatus::DuplicateSeatLabel;
+    }
+    if (parsed != labels.size()) {
+        out_bad_index = static_cast<int>(parsed);
+        return BookingStatus::InvalidSeatLabel;
+    }
+    return BookingStatus::Ok;
+}
+
+} // namespace
+
+BookingStatus BookingService::seats_to_mask_or_fail(const HallLayout& layout,
+                                                    const std::vector<std::string>& labels,
+                                                    SeatMask& out_mask,
+                                                    int& out_bad_index) {
+    return labels_to_mask(layout, labels, out_mask, out_bad_index);
+}
+
+BookingStatus BookingService::seats_to_mask_or_fail(const HallLayout& layout,
+                                                    Span<const std::string_view> labels,
+                                                    SeatMask& out_mask,
+                                                    int& out_bad_index) {
+    return labels_to_mask(layout, labels, out_mask, out_bad_index);
+}
+
+BookingStatus BookingService::label_list_to_mask_or_fail(const HallLayout& layout, std::string_view label_list,
+                                                         SeatMask& out_mask, int& out_bad_index,
+                                                         std::string_view& out_bad_label) {
+    out_mask = SeatMask{};
 
-        mask |= bit;
+    std::size_t parsed = 0;
+    bool bad = false;
+    // One scan_list instantiation per grammar: the layout's is chosen once per list
+    const auto scan = [&](auto on_label) {
+        seat_label::with_grammar(layout.label_grammar(), [&](auto grammar) {
+            seat_label::scan_list<decltype(grammar)>(label_list, on_label);
+        });
+    };
+    scan([&](std::string_view label, std::uint32_t code, int number) {
+        int seat = -1;
+        if (!layout.try_seat(code, number, seat)) {
+            out_bad_label = label;
+            bad = true;
+            return false;
+        }
+        out_mask.set(seat);
+        ++parsed;
+        return true;
+    });
+    if (static_cast<std::size_t>(out_mask.count()) != parsed) {
+        // Second pass over the labels before the first bad one, to name the first duplicate
+        SeatMask seen;
+        int index = 0;
+        scan([&](std::string_view label, std::uint32_t code, int number) {
+            int seat = -1;
+            layout.try_seat(code, number, seat);
+            if (seen.test(seat)) {
+                out_bad_label = label;
+                return false;
+            }
+            seen.set(seat);
+            ++index;
+            return true;
+        });
+        out_bad_index = index;
+        return BookingStatus::DuplicateSeatLabel;
+    }
+    if (bad) {
+        out_bad_index = static_cast<int>(parsed);
+        return BookingStatus::InvalidSeatLabel;
     }
-    return mask;
+    if (parsed == 0u) return BookingStatus::NoSeats;
+    return BookingStatus::Ok;
 }
 } // namespace booking
\ No newline at end of file
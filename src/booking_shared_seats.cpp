@@ -0,0 +1,61 @@
+#include "booking_service.hpp"
+
+#include "pmem.hpp"
+
+// Shared seat state: show words and owner tables placed in a shared-memory region so the
+// services of several processes book against one seat state (see shared_seats.hpp), or in
+// a seat file that persists them.
+
+namespace booking {
+
+SharedSeatsStatus BookingService::attach_shared_seats(const std::string& name, std::size_t capacity,
+                                                      std::size_t slots) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    if (shared_seats_ || show_state_.size() != 0u) return SharedSeatsStatus::InUse;
+    auto region = std::make_unique<SharedSeatRegion>();
+    const SharedSeatsStatus status = region->open(name, capacity, slots);
+    if (status != SharedSeatsStatus::Ok) return status;
+    booking_ids_.share(region->booking_ids());
+    shared_seats_ = std::move(region);
+    return SharedSeatsStatus::Ok;
+}
+
+SharedSeatsStatus BookingService::attach_persistent_seats(const std::string& path, std::size_t capacity,
+                                                          std::size_t slots) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    if (shared_seats_ || show_state_.size() != 0u) return SharedSeatsStatus::InUse;
+    auto region = std::make_unique<SharedSeatRegion>();
+    const SharedSeatsStatus status = region->open_file(path, capacity, slots);
+    if (status != SharedSeatsStatus::Ok) return status;
+    booking_ids_.share(region->booking_ids());
+    persistent_seats_ = region->dax();
+    shared_seats_ = std::move(region);
+    return SharedSeatsStatus::Ok;
+}
+
+bool BookingService::sync_persistent_seats() {
+    return shared_seats_ && shared_seats_->persistent() && shared_seats_->sync();
+}
+
+void BookingService::persist_seats(const ShowState& st, const SeatMask& seats) const {
+    const OwnerRow* rows = st.owners.load(std::memory_order_relaxed);
+    for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+        const std::uint64_t bits = seats.word(w);
+        if (bits == 0u) continue;
+        pmem::flush(&st.words()[w], sizeof(std::uint64_t));
+        const auto first = static_cast<std::size_t>(ctz64(bits));
+        const auto last = static_cast<std::size_t>(63 - __builtin_clzll(bits));
+        pmem::flush(&rows[w].seats[first], sizeof(BookingId) * (last - first + 1u));
+    }
+    pmem::drain();
+}
+
+SharedSeatRegion::Block BookingService::claim_shared(ShowId show_id, const HallLayout& layout) {
+    static_assert(alignof(OwnerRow) <= 64, "shared blocks are 64-byte aligned");
+    static_assert(sizeof(OwnerRow) == SharedSeatRegion::kOwnerRowSeats * sizeof(BookingId),
+                  "seat file recovery reads owner rows as kOwnerRowSeats ids");
+    const auto rows = static_cast<std::uint32_t>(layout.row_count());
+    return shared_seats_->claim(show_id.value(), rows, rows * static_cast<std::uint32_t>(sizeof(OwnerRow)));
+}
+
+} // namespace booking
@@ -0,0 +1,55 @@
+#include "booking_service.hpp"
+
+// Latency SLOs: a background thread samples the API histograms into an SloMonitor, which
+// keeps the rolling windows and raises the fast-burn alerts (see slo_monitor.hpp).
+
+namespace booking {
+
+void BookingService::set_slos(SloPolicy policy) {
+    if (slo_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(slo_loop_mutex_);
+            slo_stop_ = true;
+        }
+        slo_cv_.notify_all();
+        slo_thread_.join();
+        slo_stop_ = false;
+    }
+    std::shared_ptr<SloMonitor> monitor;
+    if (!policy.budgets.empty()) monitor = std::make_shared<SloMonitor>(policy);
+    {
+        std::lock_guard<std::mutex> lock(slo_mutex_);
+        slo_ = monitor;
+    }
+    if (!monitor) return;
+    evaluate_slos(); // the first point: windows start here
+    const std::chrono::milliseconds interval = std::max(policy.interval, std::chrono::milliseconds(1));
+    slo_thread_ = std::thread([this, interval] {
+        std::unique_lock<std::mutex> lock(slo_loop_mutex_);
+        while (!slo_cv_.wait_for(lock, interval, [this] { return slo_stop_; })) {
+            lock.unlock();
+            evaluate_slos();
+            lock.lock();
+        }
+    });
+}
+
+bool BookingService::evaluate_slos(std::chrono::steady_clock::time_point now) {
+    std::shared_ptr<SloMonitor> monitor;
+    {
+        std::lock_guard<std::mutex> lock(slo_mutex_);
+        monitor = slo_;
+    }
+    if (!monitor) return false;
+    std::array<ServiceMetrics::ApiTotals, kMetricsApis> totals;
+    metrics_.collect(totals);
+    monitor->sample(totals, now);
+    return true;
+}
+
+std::vector<SloStatus> BookingService::slo_status() const {
+    std::lock_guard<std::mutex> lock(slo_mutex_);
+    return slo_ ? slo_->status() : std::vector<SloStatus>{};
+}
+
+} // namespace booking
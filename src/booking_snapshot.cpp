@@ -0,0 +1,594 @@
+#include "booking_service.hpp"
+
+#include "seat_map_codec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Snapshot writer and restore: the catalog as fixed-size records plus every show's encoded
+// seat map, laid out as described in snapshot.hpp, and incremental snapshots: a base plus
+// deltas holding the seat maps of the shows that changed.
+
+namespace booking {
+
+namespace {
+
+/**
+ * @brief Buffered file writer that checksums everything after the header as it goes.
+ */
+class SnapshotFile {
+public:
+    /** @brief Creates @p path with room for a header of @p header_size bytes. */
+    SnapshotFile(const std::string& path, std::size_t header_size)
+        : fd_(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)), buffer_(kBufferWords) {
+        ok_ = fd_ >= 0;
+        if (ok_) ok_ = ::lseek(fd_, static_cast<off_t>(header_size), SEEK_SET) >= 0;
+    }
+
+    ~SnapshotFile() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    SnapshotFile(const SnapshotFile&) = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+    /** @brief Appends raw bytes. */
+    void put(const void* data, std::size_t size) {
+        const char* p = static_cast<const char*>(data);
+        while (size > 0u && ok_) {
+            const std::size_t n = std::min(size, kBufferBytes - used_);
+            std::memcpy(reinterpret_cast<char*>(buffer_.data()) + used_, p, n);
+            used_ += n;
+            p += n;
+            size -= n;
+            if (used_ == kBufferBytes) flush();
+        }
+    }
+
+    template <typename T>
+    void put(const T& record) {
+        put(&record, sizeof(T));
+    }
+
+    /** @brief Zero-pads the payload to a multiple of 8 bytes (every section starts aligned). */
+    void align() {
+        static constexpr char kZeros[8] = {};
+        const std::size_t rem = (written_ + used_) % 8u;
+        if (rem != 0u) put(kZeros, 8u - rem);
+    }
+
+    /** @brief Flushes, fills in @p header (size, checksum), writes it and syncs the file. */
+    template <typename Header>
+    bool finish(Header& header) {
+        align();
+        flush();
+        header.file_size = sizeof(Header) + written_;
+        header.checksum = checksum_;
+        if (ok_) ok_ = ::pwrite(fd_, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+        if (ok_) ok_ = ::fsync(fd_) == 0;
+        return ok_;
+    }
+
+    bool ok() const { return ok_; }
+
+private:
+    static constexpr std::size_t kBufferWords = 8192;
+    static constexpr std::size_t kBufferBytes = kBufferWords * 8u;
+
+    void flush() {
+        // Whole words only: flushes happen at a full buffer or after align()
+        checksum_ = snapshot_checksum(buffer_.data(), used_ / 8u, checksum_);
+        const char* p = reinterpret_cast<const char*>(buffer_.data());
+        std::size_t left = used_;
+        while (left > 0u && ok_) {
+            const ssize_t n = ::write(fd_, p, left);
+            if (n < 0 && errno == EINTR) continue;
+            ok_ = n > 0;
+            if (ok_) {
+                p += n;
+                left -= static_cast<std::size_t>(n);
+            }
+        }
+        written_ += used_;
+        used_ = 0;
+    }
+
+    int fd_;
+    bool ok_ = false;
+    std::vector<std::uint64_t> buffer_; /**< Word storage so the checksum reads aligned words. */
+    std::size_t used_ = 0;              /**< Bytes buffered. */
+    std::uint64_t written_ = 0;         /**< Payload bytes written. */
+    std::uint64_t checksum_ = 0;        /**< Running checksum of the written payload. */
+};
+
+std::uint64_t padded(std::uint64_t bytes) {
+    return (bytes + 7u) & ~std::uint64_t{7};
+}
+
+std::string base_path(const std::string& directory) {
+    return directory + "/base.snap";
+}
+
+std::string delta_path(const std::string& directory, std::uint64_t sequence) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/delta-%06llu.snap", static_cast<unsigned long long>(sequence));
+    return directory + name;
+}
+
+} // namespace
+
+BookingId BookingService::encode_show_seats(const ShowState& st, std::vector<BookingId>& scratch,
+                                            std::vector<std::uint8_t>& out) {
+    // Words and owners are read once each; a seat is written booked only if its owner
+    // was seen, which drops holds and keeps the words consistent with their owners
+    std::array<std::uint64_t, HallLayout::kMaxRows> words{};
+    std::array<std::uint64_t, HallLayout::kMaxRows> row_masks{};
+    scratch.resize(64u * HallLayout::kMaxRows);
+    const OwnerRow* owners = st.owners.load(std::memory_order_acquire);
+    BookingId max_id = 0;
+    for (int w = 0; w < st.word_count; ++w) {
+        std::uint64_t word = owners ? st.words()[w].load() : 0u; // ordered after a drain of dirty_shows_
+        for (std::uint64_t bits = word; bits != 0u; bits &= bits - 1u) {
+            const int col = ctz64(bits);
+            const BookingId id = owners[w].seats[static_cast<std::size_t>(col)].load(std::memory_order_relaxed);
+            scratch[static_cast<std::size_t>(w) * 64u + static_cast<std::size_t>(col)] = id;
+            if (id == 0u) word &= ~(std::uint64_t{1} << col);
+            max_id = std::max(max_id, id);
+        }
+        words[static_cast<std::size_t>(w)] = word;
+        row_masks[static_cast<std::size_t>(w)] = st.layout->row_mask(w);
+    }
+    encode_seat_map(words.data(), row_masks.data(), st.word_count, scratch.data(), out);
+    return max_id;
+}
+
+BookingId BookingService::install_seat_map(ShowState& st, const std::uint8_t* data, std::size_t size,
+                                           std::vector<BookingId>& owners) {
+    std::array<std::uint64_t, HallLayout::kMaxRows> words{};
+    std::array<std::uint64_t, HallLayout::kMaxRows> row_masks{};
+    owners.resize(64u * HallLayout::kMaxRows);
+    for (int w = 0; w < st.word_count; ++w) row_masks[static_cast<std::size_t>(w)] = st.layout->row_mask(w);
+    // Validated by SnapshotView::open for the same row masks
+    decode_seat_map(data, size, row_masks.data(), st.word_count, words.data(), owners.data());
+    BookingId max_id = 0;
+    OwnerRow* rows = nullptr;
+    for (int w = 0; w < st.word_count; ++w) {
+        const std::uint64_t word = words[static_cast<std::size_t>(w)];
+        (word != 0u ? ensure_words(st) : st.words())[w].store(word, std::memory_order_relaxed); // 0: cold stays cold
+        if (word == 0u) continue;
+        if (!rows) rows = ensure_owners(st);
+        for (std::uint64_t bits = word; bits != 0u; bits &= bits - 1u) {
+            const int col = ctz64(bits);
+            const BookingId id = owners[static_cast<std::size_t>(w) * 64u + static_cast<std::size_t>(col)];
+            rows[w].seats[static_cast<std::size_t>(col)].store(id, std::memory_order_relaxed);
+            max_id = std::max(max_id, id);
+        }
+    }
+    st.changes().fetch_add(1u, std::memory_order_relaxed); // the words may be shared ones
+    return max_id;
+}
+
+void BookingService::load_lazy_show(LazySeatMaps& lazy, const ShowState& st) const {
+    if (!lazy.pending(id_of(st))) return;
+    // The state is not const: get_state hands out const views of mutable states
+    ShowState& target = const_cast<ShowState&>(st);
+    lazy.load(id_of(st), [&](const SnapshotShow& s) {
+        std::vector<BookingId> owners;
+        install_seat_map(target, lazy.view().seat_maps() + s.seat_map, s.seat_map_size, owners);
+    });
+    note_all_runs(target);
+    // The last show loaded: later lookups skip the check
+    if (lazy.remaining() == 0u) {
+        LazySeatMaps* expected = &lazy;
+        lazy_seats_.compare_exchange_strong(expected, nullptr, std::memory_order_release);
+    }
+}
+
+std::size_t BookingService::lazy_shows_pending() const {
+    const LazySeatMaps* lazy = lazy_seats_.load(std::memory_order_acquire);
+    return lazy ? lazy->remaining() : 0u;
+}
+
+std::size_t BookingService::load_lazy_shows() {
+    LazySeatMaps* lazy = lazy_seats_.load(std::memory_order_acquire);
+    if (!lazy) return 0u;
+    const std::vector<ShowId> ids = lazy->pending_ids();
+    for (ShowId id : ids) get_state(id);
+    return ids.size();
+}
+
+SnapshotStatus BookingService::write_snapshot(const std::string& path) const {
+    SnapshotHeader header{};
+    std::uint64_t generation = 0;
+    return write_snapshot_file(path, header, generation);
+}
+
+SnapshotStatus BookingService::write_snapshot_file(const std::string& path, SnapshotHeader& header,
+                                                   std::uint64_t& out_generation) const {
+    // Catalog writers wait (layouts_ and the catalog stay fixed); bookings do not
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    out_generation = catalog_generation_;
+    // Every record below this LSN took effect before any state is read
+    const std::uint64_t journal_lsn = journal_ ? journal_->next_lsn() : 0u;
+
+    std::uint64_t row_total = 0;
+    std::uint64_t string_total = 0;
+    for (const Movie& m : c->movies) string_total += m.title.size();
+    for (const Theater& t : c->theaters) string_total += t.name.size();
+    for (const auto& layout : layouts_) {
+        row_total += static_cast<std::uint64_t>(layout->row_count());
+        for (int r = 0; r < layout->row_count(); ++r) string_total += layout->row_label(r).size();
+    }
+    if (string_total > UINT32_MAX) return SnapshotStatus::IoError;
+
+    std::vector<std::uint8_t> seat_maps;
+    std::vector<std::uint64_t> map_offsets;
+    std::vector<BookingId> max_bookings;
+    map_offsets.reserve(c->shows.size() + 1u);
+    max_bookings.reserve(c->shows.size());
+    std::vector<BookingId> scratch;
+    for (ShowId show_id : c->shows.ids()) {
+        map_offsets.push_back(seat_maps.size());
+        max_bookings.push_back(encode_show_seats(*get_state(show_id), scratch, seat_maps));
+    }
+    map_offsets.push_back(seat_maps.size());
+
+    header = SnapshotHeader{};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = kSnapshotVersion;
+    header.header_size = sizeof(SnapshotHeader);
+    header.journal_lsn = journal_lsn;
+    std::uint64_t offset = sizeof(SnapshotHeader);
+    auto section = [&](SnapshotSection& s, std::uint64_t count, std::uint64_t record_size) {
+        s = SnapshotSection{offset, count};
+        offset += padded(count * record_size);
+    };
+    section(header.movies, c->movies.size(), sizeof(SnapshotName));
+    section(header.theaters, c->theaters.size(), sizeof(SnapshotName));
+    section(header.layouts, layouts_.size(), sizeof(SnapshotLayout));
+    section(header.rows, row_total, sizeof(SnapshotRow));
+    section(header.shows, c->shows.size(), sizeof(SnapshotShow));
+    section(header.seat_maps, seat_maps.size(), 1u);
+    section(header.strings, string_total, 1u);
+
+    const std::string tmp = path + ".tmp";
+    SnapshotFile out(tmp, sizeof(SnapshotHeader));
+    std::uint32_t string_offset = 0;
+    auto name_record = [&](std::int64_t id, std::string_view name, double latitude, double longitude) {
+        out.put(SnapshotName{id, string_offset, static_cast<std::uint32_t>(name.size()), latitude, longitude});
+        string_offset += static_cast<std::uint32_t>(name.size());
+    };
+    constexpr double kNoLocation = std::numeric_limits<double>::quiet_NaN();
+    for (const Movie& m : c->movies) name_record(m.id.value(), m.title, kNoLocation, kNoLocation);
+    out.align();
+    for (const Theater& t : c->theaters) name_record(t.id.value(), t.name, t.latitude, t.longitude);
+    out.align();
+
+    std::uint32_t first_row = 0;
+    for (const auto& layout : layouts_) {
+        out.put(SnapshotLayout{first_row, static_cast<std::uint32_t>(layout->row_count())});
+        first_row += static_cast<std::uint32_t>(layout->row_count());
+    }
+    out.align();
+    for (const auto& layout : layouts_) {
+        for (int r = 0; r < layout->row_count(); ++r) {
+            const std::string& label = layout->row_label(r);
+            out.put(SnapshotRow{string_offset, static_cast<std::uint32_t>(label.size()), layout->row_seats(r),
+                                static_cast<std::uint32_t>(layout->label_grammar())});
+            string_offset += static_cast<std::uint32_t>(label.size());
+        }
+    }
+    out.align();
+
+    for (std::size_t i = 0; i < c->shows.size(); ++i) {
+        const Show show = c->shows.row(i, c->movies, c->theaters);
+        out.put(SnapshotShow{show.id.value(), show.movie_id.value(), show.theater_id.value(), show.layout_id, show.hall,
+                             map_offsets[i], map_offsets[i + 1] - map_offsets[i], show.start_time, max_bookings[i], 0u});
+    }
+    out.align();
+    out.put(seat_maps.data(), seat_maps.size());
+    out.align();
+
+    for (const Movie& m : c->movies) out.put(m.title.data(), m.title.size());
+    for (const Theater& t : c->theaters) out.put(t.name.data(), t.name.size());
+    for (const auto& layout : layouts_) {
+        for (int r = 0; r < layout->row_count(); ++r) out.put(layout->row_label(r).data(), layout->row_label(r).size());
+    }
+
+    if (!out.finish(header) || ::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return SnapshotStatus::IoError;
+    }
+    return SnapshotStatus::Ok;
+}
+
+SnapshotStatus BookingService::restore_snapshot(const std::string& path, SnapshotLoad load) {
+    auto file = std::make_unique<MappedFile>(path);
+    if (!file->ok()) return SnapshotStatus::IoError;
+    SnapshotView view;
+    const SnapshotStatus opened = view.open(file->view());
+    if (opened != SnapshotStatus::Ok) return opened;
+    const SnapshotHeader& h = view.header();
+
+    Schedule schedule;
+    schedule.movies.reserve(h.movies.count);
+    for (std::uint64_t i = 0; i < h.movies.count; ++i) {
+        const SnapshotName& m = view.movies()[i];
+        schedule.movies.push_back(ScheduleMovie{m.id, std::string(view.string(m.name_offset, m.name_length))});
+    }
+    schedule.theaters.reserve(h.theaters.count);
+    for (std::uint64_t i = 0; i < h.theaters.count; ++i) {
+        const SnapshotName& t = view.theaters()[i];
+        schedule.theaters.push_back(
+            ScheduleTheater{t.id, std::string(view.string(t.name_offset, t.name_length)), t.latitude, t.longitude});
+    }
+    schedule.layouts.reserve(h.layouts.count);
+    try {
+        for (std::uint64_t i = 0; i < h.layouts.count; ++i) {
+            const SnapshotLayout& l = view.layouts()[i];
+            std::vector<RowSpec> rows;
+            rows.reserve(l.row_count);
+            auto grammar = seat_label::LabelGrammar::RowSeat;
+            for (std::uint32_t r = l.first_row; r < l.first_row + l.row_count; ++r) {
+                const SnapshotRow& row = view.rows()[r];
+                rows.push_back(RowSpec{std::string(view.string(row.label_offset, row.label_length)), row.seats});
+                if (row.label_grammar > static_cast<std::uint32_t>(seat_label::LabelGrammar::RowDashSeat)) {
+                    return SnapshotStatus::Corrupt;
+                }
+                grammar = static_cast<seat_label::LabelGrammar>(row.label_grammar);
+            }
+            schedule.layouts.push_back(ScheduleLayout{static_cast<int>(i), HallLayout(std::move(rows), grammar)});
+        }
+    } catch (const std::invalid_argument&) {
+        return SnapshotStatus::Corrupt;
+    }
+    schedule.shows.reserve(h.shows.count);
+    for (std::uint64_t i = 0; i < h.shows.count; ++i) {
+        const SnapshotShow& s = view.shows()[i];
+        schedule.shows.push_back(ScheduleShow{s.id, s.movie_id, s.theater_id, s.layout_id, s.start_time, s.hall});
+    }
+
+    BookingId max_id = 0;
+    std::vector<BookingId> owners;
+    auto restore = [&](std::size_t i, ShowState& st) {
+        const SnapshotShow& s = view.shows()[i];
+        if (load == SnapshotLoad::Lazy) {
+            max_id = std::max(max_id, s.max_booking); // decoded by the first get_state
+        } else {
+            max_id = std::max(max_id, install_seat_map(st, view.seat_maps() + s.seat_map, s.seat_map_size, owners));
+        }
+    };
+
+    std::unique_ptr<LazySeatMaps> lazy;
+    if (load == SnapshotLoad::Lazy) {
+        // An earlier lazy restore finishes first: lookups check one set of maps
+        load_lazy_shows();
+        lazy = std::make_unique<LazySeatMaps>(std::move(file), view);
+    }
+    {
+        std::lock_guard<std::mutex> lock(catalog_mutex_);
+        if (load_schedule_locked(schedule, restore).status != ScheduleStatus::Ok) return SnapshotStatus::CatalogError;
+        // Published before restore returns, i.e. before the service serves the new shows
+        if (lazy && lazy->remaining() != 0u) {
+            lazy_seats_.store(lazy.get(), std::memory_order_release);
+            lazy_seats_owned_.push_back(std::move(lazy));
+        }
+    }
+    booking_ids_.advance_past(max_id);
+    replay_from_lsn_ = h.journal_lsn;
+    return SnapshotStatus::Ok;
+}
+
+SnapshotStatus BookingService::incremental_pass_locked() {
+    const std::string& directory = incremental_.directory;
+    if (directory.empty()) return SnapshotStatus::IoError;
+    DirtyShows& dirty = *dirty_shows_owned_;
+
+    if (has_base_ && next_delta_ <= incremental_.full_every) {
+        SnapshotDeltaHeader header{};
+        std::vector<SnapshotDeltaShow> shows;
+        std::vector<std::uint8_t> seat_maps;
+        bool catalog_changed = false;
+        {
+            // Held only while states are encoded, not for the file I/O
+            std::lock_guard<std::mutex> lock(catalog_mutex_);
+            catalog_changed = catalog_generation_ != base_generation_;
+            if (!catalog_changed) {
+                header.journal_lsn = journal_ ? journal_->next_lsn() : 0u;
+                std::vector<BookingId> scratch;
+                dirty.drain([&](int position) {
+                    // Marked by table position, which is the id except for sparse ids
+                    const ShowState* found = show_state_.at_position(position);
+                    const ShowState* st = found ? get_state(id_of(*found)) : nullptr;
+                    if (!st) return;
+                    shows.push_back(SnapshotDeltaShow{id_of(*st).value(), seat_maps.size(), 0u});
+                    encode_show_seats(*st, scratch, seat_maps);
+                    shows.back().seat_map_size = seat_maps.size() - shows.back().seat_map;
+                });
+            }
+        }
+        if (!catalog_changed) {
+            if (shows.empty()) return SnapshotStatus::Ok; // nothing sold since the last pass
+            std::memcpy(header.magic, kSnapshotDeltaMagic, sizeof(kSnapshotDeltaMagic));
+            header.version = kSnapshotDeltaVersion;
+            header.header_size = sizeof(SnapshotDeltaHeader);
+            header.base_checksum = base_checksum_;
+            header.sequence = next_delta_;
+            header.shows = SnapshotSection{sizeof(SnapshotDeltaHeader), shows.size()};
+            header.seat_maps =
+                SnapshotSection{header.shows.offset + padded(shows.size() * sizeof(SnapshotDeltaShow)), seat_maps.size()};
+
+            const std::string path = delta_path(directory, next_delta_);
+            const std::string tmp = path + ".tmp";
+            SnapshotFile out(tmp, sizeof(SnapshotDeltaHeader));
+            out.put(shows.data(), shows.size() * sizeof(SnapshotDeltaShow));
+            out.align();
+            out.put(seat_maps.data(), seat_maps.size());
+            if (!out.finish(header) || ::rename(tmp.c_str(), path.c_str()) != 0) {
+                std::remove(tmp.c_str());
+                has_base_ = false; // the drained shows are in no file: start over from a base
+                snapshot_failures_.fetch_add(1u, std::memory_order_relaxed);
+                return SnapshotStatus::IoError;
+            }
+            ++next_delta_;
+            snapshot_deltas_.fetch_add(1u, std::memory_order_relaxed);
+            snapshot_delta_shows_.fetch_add(shows.size(), std::memory_order_relaxed);
+            return SnapshotStatus::Ok;
+        }
+    }
+
+    // New base: changes from here on belong to its deltas (a change made while it is
+    // written lands in both, which is harmless)
+    dirty.clear();
+    SnapshotHeader header{};
+    std::uint64_t generation = 0;
+    const SnapshotStatus status = write_snapshot_file(base_path(directory), header, generation);
+    if (status != SnapshotStatus::Ok) {
+        has_base_ = false;
+        snapshot_failures_.fetch_add(1u, std::memory_order_relaxed);
+        return status;
+    }
+    // Deltas of the previous base no longer apply (and fail its checksum check if left over)
+    for (std::uint64_t n = 1; std::remove(delta_path(directory, n).c_str()) == 0; ++n) {
+    }
+    has_base_ = true;
+    base_checksum_ = header.checksum;
+    base_generation_ = generation;
+    next_delta_ = 1;
+    snapshot_bases_.fetch_add(1u, std::memory_order_relaxed);
+    // Recovery starts at this base at the earliest, so older records are dead weight; a
+    // failed compaction only leaves them in place
+    if (incremental_.compact_journal && header.journal_lsn != 0u
+        && compact_journal(header.journal_lsn) == JournalStatus::Ok) {
+        journal_compactions_.fetch_add(1u, std::memory_order_relaxed);
+    }
+    return SnapshotStatus::Ok;
+}
+
+SnapshotStatus BookingService::set_incremental_snapshots(const IncrementalSnapshotOptions& options) {
+    if (incremental_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(incremental_thread_mutex_);
+            incremental_stop_ = true;
+        }
+        incremental_cv_.notify_all();
+        incremental_thread_.join();
+        incremental_stop_ = false;
+    }
+    std::lock_guard<std::mutex> lock(incremental_mutex_);
+    incremental_ = options;
+    has_base_ = false;
+    if (options.directory.empty()) {
+        dirty_shows_.store(nullptr, std::memory_order_release);
+        return SnapshotStatus::Ok;
+    }
+    if (!dirty_shows_owned_) dirty_shows_owned_ = std::make_unique<DirtyShows>(ShowTable<ShowState>::kMaxPositions);
+    dirty_shows_.store(dirty_shows_owned_.get(), std::memory_order_release); // before the base is read
+    const SnapshotStatus status = incremental_pass_locked();
+    if (status != SnapshotStatus::Ok) {
+        incremental_ = IncrementalSnapshotOptions{};
+        dirty_shows_.store(nullptr, std::memory_order_release);
+        return status;
+    }
+    const std::chrono::milliseconds interval = std::max(options.interval, std::chrono::milliseconds(1));
+    incremental_thread_ = std::thread([this, interval] {
+        std::unique_lock<std::mutex> lock(incremental_thread_mutex_);
+        while (!incremental_cv_.wait_for(lock, interval, [this] { return incremental_stop_; })) {
+            lock.unlock();
+            write_incremental_snapshot();
+            lock.lock();
+        }
+    });
+    return SnapshotStatus::Ok;
+}
+
+SnapshotStatus BookingService::write_incremental_snapshot() {
+    std::lock_guard<std::mutex> lock(incremental_mutex_);
+    return incremental_pass_locked();
+}
+
+IncrementalSnapshotStats BookingService::incremental_snapshot_stats() const {
+    IncrementalSnapshotStats s;
+    s.bases = snapshot_bases_.load(std::memory_order_relaxed);
+    s.deltas = snapshot_deltas_.load(std::memory_order_relaxed);
+    s.delta_shows = snapshot_delta_shows_.load(std::memory_order_relaxed);
+    s.failures = snapshot_failures_.load(std::memory_order_relaxed);
+    s.compactions = journal_compactions_.load(std::memory_order_relaxed);
+    return s;
+}
+
+SnapshotStatus BookingService::restore_snapshot_chain(const std::string& directory, SnapshotLoad load) {
+    std::uint64_t base_checksum = 0;
+    {
+        MappedFile base(base_path(directory));
+        if (!base.ok()) return SnapshotStatus::IoError;
+        SnapshotView view;
+        const SnapshotStatus opened = view.open(base.view());
+        if (opened != SnapshotStatus::Ok) return opened;
+        base_checksum = view.header().checksum;
+    }
+    const SnapshotStatus restored = restore_snapshot(base_path(directory), load);
+    if (restored != SnapshotStatus::Ok) return restored;
+
+    std::array<std::uint64_t, HallLayout::kMaxRows> words{};
+    std::array<std::uint64_t, HallLayout::kMaxRows> row_masks{};
+    std::vector<BookingId> owners(64u * HallLayout::kMaxRows);
+    BookingId max_id = 0;
+    for (std::uint64_t sequence = 1;; ++sequence) {
+        MappedFile file(delta_path(directory, sequence));
+        if (!file.ok()) break;
+        SnapshotDeltaView view;
+        if (view.open(file.view()) != SnapshotStatus::Ok) break;
+        const SnapshotDeltaHeader& h = view.header();
+        if (h.base_checksum != base_checksum || h.sequence != sequence) break;
+
+        // Every seat map must decode before any of them is applied
+        const auto decode = [&](const SnapshotDeltaShow& s, const ShowState& st, std::uint64_t* out_words,
+                                BookingId* out_owners) {
+            for (int w = 0; w < st.word_count; ++w) row_masks[static_cast<std::size_t>(w)] = st.layout->row_mask(w);
+            return decode_seat_map(view.seat_maps() + s.seat_map, s.seat_map_size, row_masks.data(), st.word_count,
+                                   out_words, out_owners);
+        };
+        bool valid = true;
+        for (std::uint64_t i = 0; i < h.shows.count && valid; ++i) {
+            const ShowState* st = get_state(view.shows()[i].id);
+            valid = !st || decode(view.shows()[i], *st, nullptr, nullptr);
+        }
+        if (!valid) break;
+
+        for (std::uint64_t i = 0; i < h.shows.count; ++i) {
+            ShowState* st = get_state_mut(view.shows()[i].id);
+            if (!st) continue;
+            decode(view.shows()[i], *st, words.data(), owners.data());
+            OwnerRow* rows = st->owners.load(std::memory_order_relaxed);
+            for (int w = 0; w < st->word_count; ++w) {
+                const std::uint64_t word = words[static_cast<std::size_t>(w)];
+                (word != 0u ? ensure_words(*st) : st->words())[w].store(word, std::memory_order_relaxed);
+                if (word != 0u && !rows) rows = ensure_owners(*st);
+                if (!rows) continue;
+                for (std::size_t col = 0; col < 64u; ++col) {
+                    const bool booked = (word >> col & 1u) != 0u;
+                    const BookingId id = booked ? owners[static_cast<std::size_t>(w) * 64u + col] : 0u;
+                    rows[w].seats[col].store(id, std::memory_order_relaxed);
+                    max_id = std::max(max_id, id);
+                }
+            }
+            st->changes().fetch_add(1u, std::memory_order_release);
+            note_all_runs(*st);
+        }
+        replay_from_lsn_ = std::max(replay_from_lsn_, h.journal_lsn);
+    }
+    booking_ids_.advance_past(max_id);
+    return SnapshotStatus::Ok;
+}
+
+} // namespace booking
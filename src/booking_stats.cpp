@@ -0,0 +1,135 @@
+#include "booking_service.hpp"
+
+#include "seat_scan.hpp"
+
+#include <array>
+#include <mutex>
+
+// Admin statistics: occupancy and conflict rates read in bulk from the show states, and
+// the most requested shows from the booking path's heavy-hitters sketch.
+
+namespace booking {
+
+namespace {
+
+constexpr std::size_t kParallelStatsShows = 4096; /**< Shorter lists are read on the calling thread. */
+constexpr std::size_t kStatsChunkShows = 1024;    /**< Shows per parallel chunk. */
+
+double ratio(std::uint64_t part, std::uint64_t whole) {
+    return whole == 0u ? 0.0 : static_cast<double>(part) / static_cast<double>(whole);
+}
+
+/** @brief Adds one show to running totals. */
+void accumulate(ServiceStats& sum, const ShowStats& s) {
+    ++sum.shows;
+    sum.seats += static_cast<std::uint64_t>(s.seats);
+    sum.booked += static_cast<std::uint64_t>(s.booked);
+    sum.changes += s.changes;
+    sum.contention.cas_retries += s.contention.cas_retries;
+    sum.contention.contended += s.contention.contended;
+    sum.contention.conflicts += s.contention.conflicts;
+}
+
+/** @brief Adds the totals of a chunk to running totals. */
+void merge(ServiceStats& sum, const ServiceStats& part) {
+    sum.shows += part.shows;
+    sum.seats += part.seats;
+    sum.booked += part.booked;
+    sum.changes += part.changes;
+    sum.contention.cas_retries += part.contention.cas_retries;
+    sum.contention.contended += part.contention.contended;
+    sum.contention.conflicts += part.contention.conflicts;
+}
+
+} // namespace
+
+void BookingService::fill_show_stats(const ShowState& st, ShowId show_id, ShowStats& out) {
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    load_free_words(st, free_words.data());
+    const int free = seat_scan::kernels().count_free(free_words.data(), static_cast<std::size_t>(st.word_count));
+    out.show_id = show_id;
+    out.seats = st.layout->seat_count();
+    out.booked = out.seats - free;
+    out.occupancy = ratio(static_cast<std::uint64_t>(out.booked), static_cast<std::uint64_t>(out.seats));
+    out.changes = st.changes().load(std::memory_order_relaxed);
+    out.contention.cas_retries = st.cas_retries.load(std::memory_order_relaxed);
+    out.contention.contended = st.contended.load(std::memory_order_relaxed);
+    out.contention.conflicts = st.conflicts.load(std::memory_order_relaxed);
+    out.conflict_rate = ratio(out.contention.conflicts, out.contention.conflicts + out.changes);
+}
+
+bool BookingService::show_stats(ShowId show_id, ShowStats& out) const {
+    const ShowState* st = get_state(show_id);
+    if (!st) return false;
+    fill_show_stats(*st, show_id, out);
+    return true;
+}
+
+std::size_t BookingService::show_stats(Span<const ShowId> show_ids, Span<ShowStats> out) const {
+    const auto read_range = [&](std::size_t begin, std::size_t end) {
+        std::size_t known = 0;
+        for (std::size_t i = begin; i < end; ++i) {
+            out[i] = ShowStats{};
+            const ShowState* st = get_state(show_ids[i]);
+            if (!st) continue;
+            fill_show_stats(*st, show_ids[i], out[i]);
+            ++known;
+        }
+        return known;
+    };
+    if (show_ids.size() < kParallelStatsShows) return read_range(0, show_ids.size());
+
+    std::atomic<std::size_t> known{0};
+    thread_pool().parallel_for(show_ids.size(), kStatsChunkShows, [&](std::size_t begin, std::size_t end) {
+        known.fetch_add(read_range(begin, end), std::memory_order_relaxed);
+    });
+    return known.load(std::memory_order_relaxed);
+}
+
+std::vector<HotShow> BookingService::hot_shows(std::size_t k) const {
+    std::vector<HotShow> out;
+    for (const HeavyHitters::Item& item : show_demand_.top(k)) {
+        HotShow hot;
+        hot.show_id = ShowId(item.key);
+        if (!show_stats(hot.show_id, hot.stats)) continue; // removed from the catalog since
+        hot.requests = item.count;
+        hot.error = item.error;
+        out.push_back(hot);
+    }
+    return out;
+}
+
+ServiceStats BookingService::service_stats(std::size_t top_k) const {
+    ServiceStats total;
+    {
+        EpochManager::Guard guard(catalog_epochs_);
+        const HugeVector<ShowId>& ids = catalog_.load(std::memory_order_acquire)->shows.ids();
+        const auto sum_range = [&](std::size_t begin, std::size_t end, ServiceStats& sum) {
+            ShowStats s;
+            for (std::size_t i = begin; i < end; ++i) {
+                const ShowState* st = get_state(ids[i]);
+                if (!st) continue;
+                fill_show_stats(*st, ids[i], s);
+                accumulate(sum, s);
+            }
+        };
+        if (ids.size() < kParallelStatsShows) {
+            sum_range(0, ids.size(), total);
+        } else {
+            // Each chunk sums privately and merges once
+            std::mutex merge_mutex;
+            thread_pool().parallel_for(ids.size(), kStatsChunkShows, [&](std::size_t begin, std::size_t end) {
+                ServiceStats part;
+                sum_range(begin, end, part);
+                std::lock_guard<std::mutex> lock(merge_mutex);
+                merge(total, part);
+            });
+        }
+    }
+    total.occupancy = ratio(total.booked, total.seats);
+    total.conflict_rate = ratio(total.contention.conflicts, total.contention.conflicts + total.changes);
+    total.hot = hot_shows(top_k);
+    return total;
+}
+
+} // namespace booking
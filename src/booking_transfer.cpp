@@ -0,0 +1,123 @@
+#include "booking_service.hpp"
+
+#include <algorithm>
+#include <map>
+#include <optional>
+
+// Show moves between cluster nodes: the seat state of one show is taken out of one
+// service and installed in another while the router keeps the show's requests away.
+
+namespace booking {
+
+CatalogStatus BookingService::take_show_state(ShowId show_id, ShowTransfer& out) {
+    out = ShowTransfer{};
+    out.show_id = show_id;
+    ShowState* st = get_state_mut(show_id);
+    if (!st) return CatalogStatus::UnknownShow;
+
+    return on_owner(show_id, [&] {
+        // Settle the show's active holds first: their seats have no owner
+        const std::uint64_t now_ms = hold_clock_ms(std::chrono::steady_clock::now());
+        for (std::size_t slot = 0; slot < hold_capacity_; ++slot) {
+            HoldSlot& h = hold_slots_[slot];
+            const std::uint64_t state = h.state.load(std::memory_order_acquire);
+            if ((state & 0xFFFFFFFFu) != kHoldActive || h.show.load(std::memory_order_relaxed) != st) continue;
+            HoldSlot* settled = nullptr;
+            if (!settle_hold((state & ~std::uint64_t{0xFFFFFFFFu}) | slot, kHoldReleased, settled)) continue;
+            mark_held(h, false); // the seats are released with the bookings below
+            ShowTransfer::Hold hold;
+            const std::uint32_t rows = h.rows.load(std::memory_order_relaxed);
+            for (int k = 0; k < h.row_count.load(std::memory_order_relaxed); ++k) {
+                hold.seats.or_word(static_cast<int>((rows >> (8 * k)) & 0xFFu),
+                                   h.bits[static_cast<std::size_t>(k)].load(std::memory_order_relaxed));
+            }
+            const std::uint64_t deadline = h.deadline_ms.load(std::memory_order_relaxed);
+            if (deadline <= now_ms) continue; // expired meanwhile: freed below, not moved
+            hold.ttl = std::chrono::milliseconds(deadline - now_ms);
+            out.holds.push_back(hold);
+        }
+
+        // Group the booked seats by owner, clearing the owners on the way
+        std::map<BookingId, SeatMask> bookings;
+        SeatMask taken;
+        OwnerRow* rows = st->owners.load(std::memory_order_acquire);
+        for (int w = 0; w < st->word_count; ++w) {
+            const std::uint64_t bits = st->words()[w].load();
+            if (bits != 0u) taken.or_word(w, bits);
+            for (std::uint64_t b = bits; rows && b != 0u; b &= b - 1u) {
+                const int seat = HallLayout::seat_index(w, ctz64(b));
+                const BookingId id = owner_of(rows, seat).exchange(0u, std::memory_order_acq_rel);
+                if (id != 0u) bookings[id].set(seat);
+            }
+        }
+        if (!taken.empty()) release_mask(*st, taken);
+        for (const auto& b : bookings) {
+            out.bookings.push_back(ShowTransfer::Booking{b.first, b.second});
+            if (journal_) journal_commit(JournalOp::Cancel, *st, b.first, b.second);
+        }
+        return CatalogStatus::Ok;
+    });
+}
+
+CatalogStatus BookingService::put_show_state(const ShowTransfer& in) {
+    ShowState* st = get_state_mut(in.show_id);
+    if (!st) return CatalogStatus::UnknownShow;
+
+    const CatalogStatus installed = on_owner(in.show_id, [&] {
+        // Every seat must be free and valid here before anything is installed
+        std::array<std::uint64_t, HallLayout::kMaxRows> wanted{};
+        const auto claim = [&](const SeatMask& seats) {
+            for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+                const std::uint64_t bits = seats.word(w);
+                const std::uint64_t valid = w < st->word_count ? st->layout->row_mask(w) : 0u;
+                if ((bits & ~valid) != 0u || (bits & wanted[static_cast<std::size_t>(w)]) != 0u) return false;
+                if ((bits & st->words()[w].load()) != 0u) return false;
+                wanted[static_cast<std::size_t>(w)] |= bits;
+            }
+            return true;
+        };
+        for (const ShowTransfer::Booking& b : in.bookings) {
+            if (b.id == 0u || !claim(b.seats)) return CatalogStatus::DuplicateId;
+        }
+        for (const ShowTransfer::Hold& h : in.holds) {
+            if (!claim(h.seats)) return CatalogStatus::DuplicateId;
+        }
+
+        BookingId max_id = 0;
+        for (const ShowTransfer::Booking& b : in.bookings) {
+            // Seats are checked free and the show is quiesced: installed as they were, without
+            // re-checking seating rules the source already applied
+            std::optional<GroupWrite> group;
+            if (!b.seats.single_word() || change_feed_) group.emplace(*st);
+            for (int w = b.seats.first_word(); w < b.seats.end_word(); ++w) {
+                const std::uint64_t bits = b.seats.word(w);
+                if (bits == 0u) continue;
+                const std::uint64_t old = ensure_words(*st)[w].fetch_or(bits);
+                if (CapacityCounter* cap = capacity_of(*st)) cap->add(popcount64(bits & ~old)); // moved in, not sold
+                st->changes().fetch_add(1u, std::memory_order_release);
+                note_write(*st);
+                note_runs(*st, w);
+                if (change_feed_) change_feed_->publish(id_of(*st), w, old, old | bits);
+            }
+            group.reset();
+            OwnerRow* rows = ensure_owners(*st);
+            for (int w = b.seats.first_word(); w < b.seats.end_word(); ++w) {
+                for (std::uint64_t bits = b.seats.word(w); bits != 0u; bits &= bits - 1u) {
+                    owner_of(rows, HallLayout::seat_index(w, ctz64(bits))).store(b.id, std::memory_order_release);
+                }
+            }
+            if (journal_) journal_commit(JournalOp::Book, *st, b.id, b.seats);
+            max_id = std::max(max_id, b.id);
+        }
+        booking_ids_.advance_past(max_id); // ids issued here never collide with moved ones
+        return CatalogStatus::Ok;
+    });
+    if (installed != CatalogStatus::Ok) return installed;
+
+    for (const ShowTransfer::Hold& h : in.holds) {
+        if (!hold_seat_mask(in.show_id, h.seats, h.ttl).success) return CatalogStatus::DuplicateId;
+    }
+    return CatalogStatus::Ok;
+}
+
+} // namespace booking
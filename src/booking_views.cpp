@@ -0,0 +1,116 @@
+#include "booking_service.hpp"
+
+#include "seat_scan.hpp"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+
+// Availability views: per-movie orderings by seats left and cheapest free seat, kept up to
+// date by draining the seat change feed instead of re-sorting a movie's shows per listing.
+
+namespace booking {
+
+namespace {
+
+constexpr std::size_t kViewDrainBatch = 256; /**< Changes copied out of the feed per poll. */
+
+} // namespace
+
+void BookingService::show_availability(const ShowState& st, int& seats_left, std::uint32_t& cheapest_price) {
+    std::array<std::uint64_t, HallLayout::kMaxRows> free_words;
+    load_free_words(st, free_words.data());
+    const auto rows = static_cast<std::size_t>(st.word_count);
+    seats_left = seat_scan::kernels().count_free(free_words.data(), rows);
+    cheapest_price = RankedShow::kNoPrice;
+    const HallLayout& layout = *st.layout;
+    if (layout.price_levels() == 0) {
+        if (seats_left > 0) cheapest_price = 0; // untiered halls price every seat at 0
+        return;
+    }
+    // Levels are cumulative and ascending: the first one with a free seat names the cheapest
+    for (int level = 0; level < layout.price_levels(); ++level) {
+        const std::uint64_t* seats = layout.level_seats(level);
+        for (std::size_t w = 0; w < rows; ++w) {
+            if ((free_words[w] & seats[w]) != 0u) {
+                cheapest_price = layout.level_price(level);
+                return;
+            }
+        }
+    }
+}
+
+void BookingService::view_show(AvailabilityViews& views, ShowId show_id, MovieId movie_id) const {
+    const ShowState* st = get_state(show_id);
+    if (!st) return;
+    int seats_left = 0;
+    std::uint32_t cheapest_price = RankedShow::kNoPrice;
+    show_availability(*st, seats_left, cheapest_price);
+    views.add_show(show_id, movie_id, seats_left, cheapest_price);
+}
+
+void BookingService::enable_availability_views(std::size_t feed_capacity) {
+    if (views_) return;
+    enable_change_feed(feed_capacity);
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    // Subscribe before reading the shows: a change racing the backfill is read again later,
+    // and recomputing a show from its words is idempotent
+    views_feed_ = std::make_unique<SeatChangeSubscriber>(*change_feed_);
+    auto views = std::make_unique<AvailabilityViews>();
+    const Catalog* c = catalog_.load(std::memory_order_acquire);
+    for (std::size_t row = 0; row < c->shows.size(); ++row) {
+        const std::int32_t movie_slot = c->shows.movie_slots()[row];
+        view_show(*views, c->shows.ids()[row], c->movies[static_cast<std::size_t>(movie_slot)].id);
+    }
+    views_ = std::move(views);
+}
+
+std::size_t BookingService::drain_availability_views() const {
+    std::vector<ShowId> dirty;
+    bool resync = false;
+    std::array<SeatChange, kViewDrainBatch> batch;
+    for (;;) {
+        bool gap = false;
+        const std::size_t n = views_feed_->poll(batch.data(), batch.size(), gap);
+        resync = resync || gap;
+        for (std::size_t i = 0; i < n; ++i) dirty.push_back(batch[i].show_id);
+        if (n < batch.size()) break;
+    }
+    if (resync) dirty = views_->shows(); // the lost changes are unknown: recompute everything
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    std::size_t refreshed = 0;
+    for (const ShowId id : dirty) {
+        const ShowState* st = get_state(id);
+        if (!st) continue;
+        int seats_left = 0;
+        std::uint32_t cheapest_price = RankedShow::kNoPrice;
+        show_availability(*st, seats_left, cheapest_price);
+        // Shows not (or no longer) in the catalog are not in the views and stay out
+        if (views_->update(id, seats_left, cheapest_price)) ++refreshed;
+    }
+    return refreshed;
+}
+
+std::size_t BookingService::refresh_availability_views() const {
+    if (!views_) return 0;
+    std::lock_guard<std::mutex> lock(views_mutex_);
+    return drain_availability_views();
+}
+
+std::vector<RankedShow> BookingService::shows_by_seats_left(MovieId movie_id, std::size_t limit) const {
+    if (!views_) return {};
+    std::unique_lock<std::mutex> lock(views_mutex_, std::try_to_lock);
+    if (lock.owns_lock()) drain_availability_views();
+    return views_->by_seats_left(movie_id, limit);
+}
+
+std::vector<RankedShow> BookingService::shows_by_cheapest_seat(MovieId movie_id, std::size_t limit) const {
+    if (!views_) return {};
+    std::unique_lock<std::mutex> lock(views_mutex_, std::try_to_lock);
+    if (lock.owns_lock()) drain_availability_views();
+    return views_->by_cheapest_seat(movie_id, limit);
+}
+
+} // namespace booking
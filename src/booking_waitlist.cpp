@@ -0,0 +1,87 @@
+#include "booking_service.hpp"
+#include "seat_runs.hpp"
+
+#include <memory>
+
+// Waitlists: requests for sold-out shows queue per show and are booked by the threads
+// whose cancellations or hold releases free seats, instead of clients retrying.
+
+namespace booking {
+
+BookingResult BookingService::join_waitlist(ShowId show_id, int n, WaitlistCallback on_booked, SeatMask& out_seats) {
+    return measured(MetricsApi::JoinWaitlist, [&] {
+        out_seats = SeatMask{};
+        ShowState* st = get_state_mut(show_id);
+        if (!st) {
+            return BookingResult::error(BookingStatus::InvalidShow);
+        }
+        if (!admit_booker(show_id)) {
+            return BookingResult::error(BookingStatus::Throttled);
+        }
+        if (n < 1 || !on_booked) {
+            return BookingResult::error(BookingStatus::NoSeats);
+        }
+        // A request no row can ever hold would block its waitlist forever
+        bool fits = false;
+        const HallLayout& layout = *st->layout;
+        for (int r = 0; r < layout.row_count() && !fits; ++r) {
+            std::uint64_t starts = run_starts(layout.open_row_masks()[r], n) & layout.block_starts(r, n);
+            if (layout.forbids_single_gaps()) starts &= ~gap_leaving_starts(layout.row_mask(r), n);
+            fits = starts != 0u;
+        }
+        if (!fits) {
+            return BookingResult::error(BookingStatus::NoContiguousSeats);
+        }
+
+        Waitlist* wl = waitlists_.find(show_id);
+        if (!wl) {
+            std::lock_guard<std::mutex> lock(waitlist_mutex_);
+            wl = waitlists_.find(show_id);
+            if (!wl) wl = &waitlists_.emplace(show_id, [this](Waitlist& w) { w.entries = &waitlist_entries_; });
+        }
+        return on_owner(show_id, [&] {
+            if (wl->waiting.load() == 0u) {
+                const BookingResult now = book_best_on(*st, n, out_seats);
+                if (now.status != BookingStatus::NoContiguousSeats) return now;
+            }
+            ObjectPool<WaitlistEntry>::Ptr entry = waitlist_entries_.make();
+            entry->seats = n;
+            entry->on_booked = std::move(on_booked);
+            wl->waiting.fetch_add(1u); // seq_cst: a release either sees it or is seen by the drain below
+            if (seat_words::kRelaxedOrdering) std::atomic_thread_fence(std::memory_order_seq_cst); // seat_words.hpp
+            wl->queue.push(entry.release());
+            drain_waitlist(*st, *wl); // seats may have been freed since the attempt above
+            return BookingResult::error(BookingStatus::Waitlisted);
+        });
+    });
+}
+
+std::size_t BookingService::waitlist_size(ShowId show_id) const {
+    const Waitlist* wl = waitlists_.find(show_id);
+    return wl ? static_cast<std::size_t>(wl->waiting.load(std::memory_order_relaxed)) : 0u;
+}
+
+void BookingService::drain_waitlist(ShowState& st, Waitlist& wl) {
+    if (wl.drains.fetch_add(1u, std::memory_order_acq_rel) != 0u) return; // the running drain goes again
+    std::uint64_t passes = 1;
+    while (true) {
+        // One pass: book for the head entries, in order, until one does not fit yet
+        while (true) {
+            if (!wl.front) wl.front = static_cast<WaitlistEntry*>(wl.queue.pop());
+            if (!wl.front) break; // empty, or a push is half done (its producer drains next)
+            SeatMask seats;
+            const BookingResult r = book_best_on(st, wl.front->seats, seats);
+            if (r.status == BookingStatus::NoContiguousSeats || r.status == BookingStatus::Contended) break;
+            const ObjectPool<WaitlistEntry>::Ptr served(wl.front, {&waitlist_entries_});
+            wl.front = nullptr;
+            wl.waiting.fetch_sub(1u, std::memory_order_relaxed);
+            served->on_booked(r, seats);
+        }
+        // Requests that arrived during the pass are ours to serve as well
+        const std::uint64_t left = wl.drains.fetch_sub(passes, std::memory_order_acq_rel) - passes;
+        if (left == 0u) return;
+        passes = left;
+    }
+}
+
+} // namespace booking
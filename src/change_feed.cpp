@@ -0,0 +1,143 @@
+#include "change_feed.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace booking {
+
+namespace {
+
+constexpr std::int64_t kHoleShow = -2; /**< Show id of a hole (-1 is the invalid id). */
+
+} // namespace
+
+SeatChangeFeed::SeatChangeFeed(std::size_t capacity, std::size_t lanes)
+    : slots_(new Slot[capacity]), mask_(capacity - 1u), lane_count_(lanes), lanes_(new Lane[lanes]) {
+    if (capacity < 2u || (capacity & (capacity - 1u)) != 0u) {
+        throw std::invalid_argument("SeatChangeFeed capacity must be a power of two >= 2");
+    }
+    if (lanes == 0u || (lanes & (lanes - 1u)) != 0u || lanes > kMaxLanes || lanes > capacity) {
+        throw std::invalid_argument("SeatChangeFeed lanes must be a power of two <= min(64, capacity)");
+    }
+}
+
+std::uint64_t SeatChangeFeed::head() const {
+    std::uint64_t head = 0;
+    for (std::size_t l = 0; l < lane_count_; ++l) {
+        const std::uint64_t next = lanes_[l].next.load(std::memory_order_acquire);
+        if (next != 0u) head = std::max<std::uint64_t>(head, (next - 1u) * lane_count_ + l + 1u);
+    }
+    return head;
+}
+
+std::uint64_t SeatChangeFeed::cut() const {
+    const std::uint64_t position = head();
+    if (lane_count_ == 1u) return position; // one counter: numbers are taken in order
+    for (std::size_t l = 0; l < lane_count_; ++l) {
+        if (position <= l) continue;
+        const std::uint64_t end = (position - l + lane_count_ - 1u) / lane_count_; // first index at or past it
+        Lane& lane = lanes_[l];
+        std::uint64_t next = lane.next.load(std::memory_order_acquire);
+        while (next < end && !lane.next.compare_exchange_weak(next, end, std::memory_order_acq_rel)) {
+        }
+        for (std::uint64_t i = next; i < end; ++i) {
+            write_slot(i * lane_count_ + l, [](Slot& s) { s.show.store(kHoleShow, std::memory_order_relaxed); });
+        }
+    }
+    return position;
+}
+
+SeatChangeFeed::Lane& SeatChangeFeed::own_lane(std::size_t& lane) {
+    static std::atomic<std::size_t> threads{0};
+    thread_local const std::size_t thread_index = threads.fetch_add(1u, std::memory_order_relaxed);
+    lane = lane_count_ == 1u ? 0u : thread_index % lane_count_;
+    return lanes_[lane];
+}
+
+template <typename Fill>
+void SeatChangeFeed::write_slot(std::uint64_t seq, Fill&& fill) const {
+    Slot& slot = slots_[seq & mask_];
+
+    // Wait for the writer of this slot one lap ago (done long since unless the ring is tiny)
+    const std::uint64_t lap = static_cast<std::uint64_t>(mask_) + 1u;
+    const std::uint64_t previous = seq >= lap ? 2u * (seq - lap) + 2u : 0u;
+    while (slot.version.load(std::memory_order_acquire) != previous) std::this_thread::yield();
+
+    slot.version.store(2u * seq + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); // the odd version is visible before the fields
+    fill(slot);
+    slot.version.store(2u * seq + 2u, std::memory_order_release);
+}
+
+void SeatChangeFeed::publish(ShowId show_id, int word, std::uint64_t old_bits, std::uint64_t new_bits) {
+    std::size_t lane = 0;
+    const std::uint64_t index = own_lane(lane).next.fetch_add(1u, std::memory_order_relaxed);
+    write_slot(index * lane_count_ + lane, [&](Slot& slot) {
+        slot.show.store(show_id.value(), std::memory_order_relaxed);
+        slot.word.store(word, std::memory_order_relaxed);
+        slot.old_bits.store(old_bits, std::memory_order_relaxed);
+        slot.new_bits.store(new_bits, std::memory_order_relaxed);
+    });
+}
+
+FeedRead SeatChangeFeed::read(std::uint64_t seq, SeatChange& out) const {
+    const Slot& slot = slots_[seq & mask_];
+    const std::uint64_t published = 2u * seq + 2u;
+    const std::uint64_t before = slot.version.load(std::memory_order_acquire);
+    if (before > published) return FeedRead::Lost;
+    if (before < published) {
+        if (lane_count_ == 1u || seq >= head()) return FeedRead::NotYet;
+        // A later number was taken: unless this one's lane took it too (its writer is
+        // still filling the slot), claim the lane's numbers up to it as holes
+        Lane& lane = lanes_[seq % lane_count_];
+        const std::uint64_t index = seq / lane_count_;
+        std::uint64_t next = lane.next.load(std::memory_order_acquire);
+        do {
+            if (next > index) return FeedRead::NotYet;
+        } while (!lane.next.compare_exchange_weak(next, index + 1u, std::memory_order_acq_rel));
+        for (std::uint64_t i = next; i <= index; ++i) {
+            write_slot(i * lane_count_ + seq % lane_count_, [](Slot& s) {
+                s.show.store(kHoleShow, std::memory_order_relaxed);
+            });
+        }
+        return FeedRead::Hole;
+    }
+
+    const std::int64_t show = slot.show.load(std::memory_order_relaxed);
+    const std::int32_t word = slot.word.load(std::memory_order_relaxed);
+    const std::uint64_t old_bits = slot.old_bits.load(std::memory_order_relaxed);
+    const std::uint64_t new_bits = slot.new_bits.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire); // field loads happen before the re-check
+    if (slot.version.load(std::memory_order_relaxed) != published) return FeedRead::Lost;
+    if (show == kHoleShow) return FeedRead::Hole;
+
+    out.seq = seq;
+    out.show_id = ShowId(show);
+    out.word = word;
+    out.old_bits = old_bits;
+    out.new_bits = new_bits;
+    return FeedRead::Ok;
+}
+
+std::size_t SeatChangeSubscriber::poll(SeatChange* out, std::size_t max, bool& gap) {
+    gap = false;
+    std::size_t n = 0;
+    while (n < max) {
+        const FeedRead r = feed_.read(next_, out[n]);
+        if (r == FeedRead::Ok || r == FeedRead::Hole) {
+            if (r == FeedRead::Ok) ++n;
+            ++next_;
+            continue;
+        }
+        if (r == FeedRead::NotYet || n != 0u) break; // a loss is reported by the next call
+        // Lost: jump to the oldest change that can still be in the ring
+        const std::uint64_t head = feed_.head();
+        const std::uint64_t oldest = head > feed_.capacity() ? head - feed_.capacity() : 0u;
+        next_ = oldest > next_ ? oldest : next_ + 1u;
+        gap = true;
+    }
+    return n;
+}
+
+} // namespace booking
@@ -1,45 +1,202 @@
 #include "booking_service.hpp"
+#include "show_routes.hpp"
+#include "text_protocol.hpp"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
-#include <sstream>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Interactive CLI; with --batch it replays a command file (or stdin) instead:
+//
+//   booking_cli [--batch [FILE|-]] [--schedule=FILE]
+//
+// Batch mode prints no prompts, executes each line with the text protocol handler (see
+// text_protocol.hpp for the response format), buffers output in 1 MiB chunks and reports
+// the throughput on stderr. Interactive mode shares its tokenizer, command table and show
+// route cache.
 
 static void print_help() {
     std::cout
         << "Commands:\n"
         << "  movies\n"
+        << "  search <title words>\n"
         << "  theaters <movie_id>\n"
         << "  seats <movie_id> <theater_id>\n"
         << "  book <movie_id> <theater_id> a1 a2 ...\n"
         << "  exit \n";
 }
 
-int main() {
-    booking::BookingService svc;
+namespace {
+
+constexpr std::size_t kChunk = 1u << 20;
+
+bool write_all(int fd, const std::string& data) {
+    std::size_t done = 0;
+    while (done < data.size()) {
+        const ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/** @brief Executes every line of @p fd; returns the process exit code. */
+int run_batch(booking::BookingService& svc, int fd) {
+    booking::TextCommandHandler handler(svc);
+    std::string in;  // unexecuted input: at most one partial line after each pass
+    std::string out;
+    out.reserve(2 * kChunk);
+    std::uint64_t commands = 0;
+    std::uint64_t bytes = 0;
+    bool done = false;
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto run_line = [&](std::string_view line) {
+        if (line.empty() || line == "\r") return;
+        ++commands;
+        if (handler.execute(line, out) == booking::CommandOutcome::Close) done = true;
+    };
+
+    while (!done) {
+        const std::size_t old_size = in.size();
+        in.resize(old_size + kChunk);
+        const ssize_t got = ::read(fd, &in[old_size], kChunk);
+        if (got < 0 && errno == EINTR) {
+            in.resize(old_size);
+            continue;
+        }
+        if (got < 0) {
+            std::perror("read");
+            return 1;
+        }
+        in.resize(old_size + static_cast<std::size_t>(got));
+        bytes += static_cast<std::uint64_t>(got);
+        if (got == 0) {
+            if (!in.empty()) run_line(in); // last line without a newline
+            break;
+        }
+
+        std::size_t pos = 0;
+        while (!done) {
+            const void* nl = std::memchr(in.data() + pos, '\n', in.size() - pos);
+            if (!nl) break;
+            const std::size_t end = static_cast<std::size_t>(static_cast<const char*>(nl) - in.data());
+            run_line(std::string_view(in.data() + pos, end - pos));
+            pos = end + 1u;
+            if (out.size() >= kChunk) {
+                if (!write_all(STDOUT_FILENO, out)) return 1;
+                out.clear();
+            }
+        }
+        in.erase(0, pos);
+    }
+    if (!write_all(STDOUT_FILENO, out)) return 1;
+
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "%llu commands, %.1f MiB in %.3f s: %.0f commands/s\n",
+                 static_cast<unsigned long long>(commands), static_cast<double>(bytes) / (1024.0 * 1024.0), secs,
+                 secs > 0.0 ? static_cast<double>(commands) / secs : 0.0);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool batch = false;
+    std::string batch_file = "-";
+    std::string schedule;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--batch") {
+            batch = true;
+            if (i + 1 < argc && std::strncmp(argv[i + 1], "--", 2) != 0) batch_file = argv[++i];
+        } else if (arg.rfind("--batch=", 0) == 0) {
+            batch = true;
+            batch_file = arg.substr(8);
+        } else if (arg.rfind("--schedule=", 0) == 0) {
+            schedule = arg.substr(11);
+        } else {
+            std::cerr << "unknown option " << arg << "\n"
+                      << "usage: booking_cli [--batch [FILE|-]] [--schedule=FILE]\n";
+            return 2;
+        }
+    }
+
+    std::unique_ptr<booking::BookingService> owned;
+    if (schedule.empty()) {
+        owned = std::make_unique<booking::BookingService>();
+    } else {
+        owned = std::make_unique<booking::BookingService>(booking::BookingService::EmptyCatalog{});
+        const booking::ScheduleError err = owned->load_schedule_file(schedule);
+        if (err.status != booking::ScheduleStatus::Ok) {
+            std::cerr << schedule << ":" << err.line << ": " << booking::to_string(err.status) << ": " << err.reason
+                      << "\n";
+            return 1;
+        }
+    }
+    booking::BookingService& svc = *owned;
+
+    if (batch) {
+        const int fd = batch_file == "-" ? STDIN_FILENO : ::open(batch_file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            std::perror(batch_file.c_str());
+            return 1;
+        }
+        const int rc = run_batch(svc, fd);
+        if (fd != STDIN_FILENO) ::close(fd);
+        return rc;
+    }
 
     std::cout << "Movie Booking CLI\n";
     print_help();
 
     std::string line;
+    std::vector<std::string_view> tokens;
+    booking::ShowRoutes routes(svc);
     while (true) {
         std::cout << "\n> ";
         if (!std::getline(std::cin, line)) break;
-        if (line == "exit") break;
-        if (line.empty()) continue;
+        booking::split_tokens(line, tokens);
+        if (tokens.empty()) continue;
 
-        std::istringstream iss(line);
-        std::string cmd;
-        iss >> cmd;
+        // Ids that do not parse stay -1, which no movie, theater or show has
+        booking::MovieId movie_id = -1;
+        booking::TheaterId theater_id = -1;
+        if (tokens.size() > 1u) booking::parse_token(tokens[1], movie_id);
+        if (tokens.size() > 2u) booking::parse_token(tokens[2], theater_id);
 
-        if (cmd == "help") {
+        const booking::TextCommand cmd = booking::parse_command(tokens[0]);
+        if (cmd == booking::TextCommand::Quit) break;
+        if (cmd == booking::TextCommand::Help) {
             print_help();
-        } else if (cmd == "movies") {
+        } else if (cmd == booking::TextCommand::Movies) {
             std::vector<booking::Movie> ms = svc.list_movies();
             for (std::size_t i = 0; i < ms.size(); ++i) {
                 std::cout << ms[i].id << ": " << ms[i].title << "\n";
             }
-        } else if (cmd == "theaters") {
-            int movie_id = -1;
-            iss >> movie_id;
+        } else if (cmd == booking::TextCommand::Search) {
+            std::string query;
+            for (std::size_t i = 1; i < tokens.size(); ++i) {
+                if (i > 1) query += ' ';
+                query += tokens[i];
+            }
+            std::vector<booking::Movie> ms = svc.search_movies(query);
+            if (ms.empty()) std::cout << "No movies match\n";
+            for (std::size_t i = 0; i < ms.size(); ++i) {
+                std::cout << ms[i].id << ": " << ms[i].title << "\n";
+            }
+        } else if (cmd == booking::TextCommand::Theaters) {
             std::vector<booking::Theater> ts = svc.list_theaters_for_movie(movie_id);
             if (ts.empty()) {
                 std::cout << "No theaters found for movie_id=" << movie_id << "\n";
@@ -48,34 +205,27 @@ int main() {
                     std::cout << ts[i].id << ": " << ts[i].name << "\n";
                 }
             }
-        } else if (cmd == "seats") {
-            int movie_id = -1, theater_id = -1;
-            iss >> movie_id >> theater_id;
-            const booking::ShowId show_id = svc.find_show(movie_id, theater_id);
-            if (show_id < 0) {
+        } else if (cmd == booking::TextCommand::Seats) {
+            booking::BookingService::ShowHandle* show = routes.find(movie_id, theater_id);
+            if (!show) {
                 std::cout << "No show for that movie+theater\n";
                 continue;
             }
-            std::vector<std::string> seats = svc.list_available_seats(show_id);
+            std::vector<std::string> seats = svc.list_available_seats(*show);
             std::cout << "Available seats (" << seats.size() << "): ";
             for (std::size_t i = 0; i < seats.size(); ++i) {
                 std::cout << seats[i] << (i + 1 < seats.size() ? ", " : "\n");
             }
-        } else if (cmd == "book") {
-            int movie_id = -1, theater_id = -1;
-            iss >> movie_id >> theater_id;
-            const booking::ShowId show_id = svc.find_show(movie_id, theater_id);
-            if (show_id < 0) {
+        } else if (cmd == booking::TextCommand::Book) {
+            booking::BookingService::ShowHandle* show = routes.find(movie_id, theater_id);
+            if (!show) {
                 std::cout << "No show for that movie+theater\n";
                 continue;
             }
-
-            std::vector<std::string> seats;
-            std::string s;
-            while (iss >> s) seats.push_back(s);
-
-            booking::BookingResult r = svc.book_seats(show_id, seats);
-            std::cout << (r.success ? "OK: " : "FAIL: ") << r.message << "\n";
+            const std::size_t first_seat = tokens.size() < 3u ? tokens.size() : 3u;
+            const booking::Span<const std::string_view> seats(tokens.data() + first_seat, tokens.size() - first_seat);
+            booking::BookingResult r = svc.book_seat_labels(*show, seats);
+            std::cout << (r.success ? "OK: " : "FAIL: ") << r.message() << "\n";
         } else {
             std::cout << "Unknown command. Type 'help'.\n";
         }
@@ -0,0 +1,350 @@
+#include "cluster.hpp"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+
+namespace booking {
+
+namespace {
+
+/** @brief Longest a node may take to answer one request before its connection is dropped. */
+constexpr int kCallTimeoutSeconds = 5;
+
+std::uint64_t mix64(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/** @brief Ring position of a show (shows and node points share the hash circle). */
+std::uint64_t show_point(ShowId show_id) {
+    return mix64(static_cast<std::uint64_t>(show_id.value()) ^ 0x5bd1e995u);
+}
+
+std::uint64_t node_point(NodeId node, int replica) {
+    return mix64((static_cast<std::uint64_t>(node) << 32) | static_cast<std::uint32_t>(replica));
+}
+
+template <typename Int>
+bool parse_int(std::string_view token, Int& out) {
+    const char* end = token.data() + token.size();
+    const auto res = std::from_chars(token.data(), end, out);
+    return res.ec == std::errc() && res.ptr == end;
+}
+
+template <typename Tag>
+bool parse_int(std::string_view token, Id<Tag>& out) {
+    typename Id<Tag>::Rep value = 0;
+    if (!parse_int(token, value)) return false;
+    out = value;
+    return true;
+}
+
+/** @brief Splits off the next space/tab separated token of @p rest. */
+std::string_view next_token(std::string_view& rest) {
+    std::size_t i = 0;
+    while (i < rest.size() && (rest[i] == ' ' || rest[i] == '\t')) ++i;
+    const std::size_t start = i;
+    while (i < rest.size() && rest[i] != ' ' && rest[i] != '\t') ++i;
+    const std::string_view token = rest.substr(start, i - start);
+    rest.remove_prefix(i);
+    return token;
+}
+
+bool is_status_line(std::string_view line) {
+    return line.substr(0, 2) == "OK" || line.substr(0, 3) == "ERR";
+}
+
+bool send_all(int fd, const char* p, std::size_t size) {
+    while (size > 0u) {
+        const ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+int dial(const std::string& host, std::uint16_t port) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    const timeval timeout{kCallTimeoutSeconds, 0};
+    const int one = 1;
+    if (::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1
+        || ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+} // namespace
+
+void HashRing::add_node(NodeId node, int virtual_nodes) {
+    if (contains(node)) return;
+    for (int r = 0; r < virtual_nodes; ++r) points_.emplace_back(node_point(node, r), node);
+    std::sort(points_.begin(), points_.end());
+}
+
+void HashRing::remove_node(NodeId node) {
+    points_.erase(std::remove_if(points_.begin(), points_.end(), [&](const auto& p) { return p.second == node; }),
+                  points_.end());
+}
+
+bool HashRing::contains(NodeId node) const {
+    return std::any_of(points_.begin(), points_.end(), [&](const auto& p) { return p.second == node; });
+}
+
+NodeId HashRing::owner(ShowId show_id) const {
+    if (points_.empty()) return kNoNode;
+    const std::pair<std::uint64_t, NodeId> key{show_point(show_id), 0u};
+    const auto it = std::lower_bound(points_.begin(), points_.end(), key);
+    return (it == points_.end() ? points_.front() : *it).second; // wraps past the last point
+}
+
+const char* to_string(ClusterStatus status) {
+    switch (status) {
+        case ClusterStatus::Ok: return "cluster updated";
+        case ClusterStatus::InvalidNode: return "invalid node for this change";
+        case ClusterStatus::ConnectError: return "cannot connect to the node";
+        case ClusterStatus::NodeError: return "a node failed a show move";
+        case ClusterStatus::LastNode: return "the last node cannot leave";
+    }
+    return "unknown cluster status";
+}
+
+/** @brief One member: its address and a pool of blocking request/response connections. */
+struct ClusterRouter::Node {
+    struct Connection {
+        std::mutex mutex;
+        int fd = -1;
+        std::string in; /**< Bytes received past the last response. */
+    };
+
+    std::string host;
+    std::uint16_t port = 0;
+    std::array<Connection, kConnectionsPerNode> connections;
+    std::atomic<std::size_t> next{0};
+
+    ~Node() { disconnect(); }
+
+    void disconnect() {
+        for (Connection& c : connections) {
+            std::lock_guard<std::mutex> lock(c.mutex);
+            if (c.fd >= 0) ::close(c.fd);
+            c.fd = -1;
+            c.in.clear();
+        }
+    }
+};
+
+ClusterRouter::ClusterRouter(const BookingService& catalog, int virtual_nodes)
+    : catalog_(catalog), virtual_nodes_(virtual_nodes), route_ring_(std::make_shared<const HashRing>()) {
+    // Index the catalog's shows once: placements are then lock-free atomic loads
+    {
+        const BookingService::CatalogView view = catalog_.catalog_view();
+        for (const Movie& m : view.movies()) {
+            for (const Theater& t : view.theaters_for_movie(m.id)) {
+                for (const Show& s : view.shows_between(m.id, t.id, std::numeric_limits<ShowTime>::min(),
+                                                        std::numeric_limits<ShowTime>::max())) {
+                    if (show_index_.emplace(s.id, shows_.size()).second) shows_.push_back(s.id);
+                }
+            }
+        }
+    }
+    placements_ = std::make_unique<std::atomic<NodeId>[]>(shows_.size());
+    for (std::size_t i = 0; i < shows_.size(); ++i) placements_[i].store(kNoNode, std::memory_order_relaxed);
+}
+
+ClusterRouter::~ClusterRouter() = default;
+
+std::atomic<NodeId>* ClusterRouter::placement(ShowId show_id) const {
+    const auto it = show_index_.find(show_id);
+    return it == show_index_.end() ? nullptr : &placements_[it->second];
+}
+
+NodeId ClusterRouter::owner(ShowId show_id) const {
+    if (const std::atomic<NodeId>* p = placement(show_id)) return p->load(std::memory_order_acquire);
+    return std::atomic_load(&route_ring_)->owner(show_id);
+}
+
+NodeId ClusterRouter::any_node() const {
+    for (NodeId n = 0; n < kMaxNodes; ++n) {
+        if (live_[n].load(std::memory_order_acquire)) return n;
+    }
+    return kNoNode;
+}
+
+ClusterStatus ClusterRouter::call(Node& node, std::string_view request, std::string& response) {
+    Node::Connection& c = node.connections[node.next.fetch_add(1u, std::memory_order_relaxed) % kConnectionsPerNode];
+    std::lock_guard<std::mutex> lock(c.mutex);
+    if (c.fd < 0) c.fd = dial(node.host, node.port);
+    if (c.fd < 0) return ClusterStatus::ConnectError;
+
+    std::string line(request);
+    line += '\n';
+    bool ok = send_all(c.fd, line.data(), line.size());
+    std::size_t scan = 0;
+    while (ok) {
+        // Consume whole lines until the status line that ends this response
+        const std::size_t eol = c.in.find('\n', scan);
+        if (eol != std::string::npos) {
+            const bool last = is_status_line(std::string_view(c.in).substr(scan, eol - scan));
+            scan = eol + 1u;
+            if (!last) continue;
+            response.append(c.in, 0, scan);
+            c.in.erase(0, scan);
+            return ClusterStatus::Ok;
+        }
+        char buf[4096];
+        const ssize_t n = ::recv(c.fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) continue;
+        ok = n > 0;
+        if (ok) c.in.append(buf, static_cast<std::size_t>(n));
+    }
+    // The stream is out of step now: drop it, the next request reconnects
+    ::close(c.fd);
+    c.fd = -1;
+    c.in.clear();
+    return ClusterStatus::NodeError;
+}
+
+CommandOutcome ClusterRouter::execute(std::string_view line, std::string& out) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    std::string_view rest = line;
+    const std::string_view cmd = next_token(rest);
+    if (cmd == "quit" || cmd == "exit") {
+        out += "OK\n";
+        return CommandOutcome::Close;
+    }
+    if (cmd == "export" || cmd == "import") {
+        out += "ERR 0 unknown command\n"; // show moves are the router's own business
+        return CommandOutcome::Continue;
+    }
+
+    ShowId show_id = -1;
+    if (cmd == "book" || cmd == "seats" || cmd == "cancel") {
+        MovieId movie_id = -1;
+        TheaterId theater_id = -1;
+        if (parse_int(next_token(rest), movie_id) && parse_int(next_token(rest), theater_id)) {
+            show_id = catalog_.find_show(movie_id, theater_id);
+        }
+    }
+
+    ClusterStatus status = ClusterStatus::ConnectError;
+    if (show_id.valid()) {
+        // Held while the request is in flight: a move of this show waits for it
+        std::shared_lock<std::shared_mutex> lock(gate(show_id));
+        const NodeId node = owner(show_id);
+        if (node != kNoNode) status = call(*nodes_[node], line, out);
+    } else {
+        const NodeId node = any_node();
+        if (node != kNoNode) status = call(*nodes_[node], line, out);
+    }
+    if (status != ClusterStatus::Ok) out += "ERR 0 cluster node unavailable\n";
+    return CommandOutcome::Continue;
+}
+
+ClusterStatus ClusterRouter::move_show(ShowId show_id, NodeId from, NodeId to) {
+    std::unique_lock<std::shared_mutex> lock(gate(show_id));
+    std::string request = "export ";
+    request += to_string(show_id);
+    std::string response;
+    if (call(*nodes_[from], request, response) != ClusterStatus::Ok || response.compare(0, 3, "ERR") == 0) {
+        return ClusterStatus::NodeError;
+    }
+    // "<state>\nOK\n": the state line is empty for a show without bookings or holds
+    const std::string_view state = std::string_view(response).substr(0, response.find('\n'));
+
+    request = "import ";
+    request += to_string(show_id);
+    request += ' ';
+    request.append(state.data(), state.size());
+    std::string answer;
+    if (call(*nodes_[to], request, answer) != ClusterStatus::Ok || answer.compare(0, 2, "OK") != 0) {
+        answer.clear();
+        call(*nodes_[from], request, answer); // put the seats back where they were
+        return ClusterStatus::NodeError;
+    }
+    placement(show_id)->store(to, std::memory_order_release);
+    moved_.fetch_add(1u, std::memory_order_relaxed);
+    return ClusterStatus::Ok;
+}
+
+ClusterStatus ClusterRouter::rebalance(const HashRing& next) {
+    ClusterStatus status = ClusterStatus::Ok;
+    for (std::size_t i = 0; i < shows_.size() && status == ClusterStatus::Ok; ++i) {
+        const NodeId target = next.owner(shows_[i]);
+        const NodeId current = placements_[i].load(std::memory_order_acquire);
+        if (current == target) continue;
+        if (current == kNoNode) {
+            placements_[i].store(target, std::memory_order_release); // first node: nothing to move
+        } else {
+            status = move_show(shows_[i], current, target);
+        }
+    }
+    std::atomic_store(&route_ring_, std::make_shared<const HashRing>(next));
+    return status;
+}
+
+ClusterStatus ClusterRouter::add_node(NodeId node, const std::string& host, std::uint16_t port) {
+    std::lock_guard<std::mutex> admin(admin_mutex_);
+    if (node >= kMaxNodes || live_[node].load(std::memory_order_relaxed)) return ClusterStatus::InvalidNode;
+    if (!nodes_[node]) nodes_[node] = std::make_unique<Node>();
+    Node& n = *nodes_[node];
+    n.disconnect();
+    n.host = host; // no request reaches a non-member, so the address can change here
+    n.port = port;
+    std::string response;
+    if (call(n, "help", response) != ClusterStatus::Ok) return ClusterStatus::ConnectError;
+
+    HashRing next = ring_;
+    next.add_node(node, virtual_nodes_);
+    live_[node].store(true, std::memory_order_release);
+    const ClusterStatus status = rebalance(next);
+    if (status != ClusterStatus::Ok) {
+        rebalance(ring_); // move back what already went to the new node
+        live_[node].store(false, std::memory_order_release);
+        return status;
+    }
+    ring_ = std::move(next);
+    return ClusterStatus::Ok;
+}
+
+ClusterStatus ClusterRouter::remove_node(NodeId node) {
+    std::lock_guard<std::mutex> admin(admin_mutex_);
+    if (node >= kMaxNodes || !live_[node].load(std::memory_order_relaxed)) return ClusterStatus::InvalidNode;
+    HashRing next = ring_;
+    next.remove_node(node);
+    if (next.empty() && !shows_.empty()) return ClusterStatus::LastNode;
+
+    const ClusterStatus status = rebalance(next);
+    if (status != ClusterStatus::Ok) {
+        rebalance(ring_); // keep the node whole rather than half-drained
+        return status;
+    }
+    live_[node].store(false, std::memory_order_release);
+    ring_ = std::move(next);
+    nodes_[node]->disconnect();
+    return ClusterStatus::Ok;
+}
+
+} // namespace booking
@@ -0,0 +1,150 @@
+#include "column_scan.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BOOKING_COLUMN_SCAN_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace booking {
+namespace column_scan {
+
+namespace {
+
+// ---- Scalar ----------------------------------------------------------------------------
+
+void match_eq_scalar(const std::int32_t* col, std::size_t n, std::int32_t value, std::uint64_t* bits) {
+    for (std::size_t base = 0; base < n; base += 64u) {
+        const std::size_t m = n - base < 64u ? n - base : 64u;
+        std::uint64_t word = 0;
+        for (std::size_t i = 0; i < m; ++i) word |= static_cast<std::uint64_t>(col[base + i] == value) << i;
+        bits[base / 64u] = word;
+    }
+}
+
+void and_range_scalar(const std::int64_t* col, std::size_t n, std::int64_t lo, std::int64_t hi,
+                      std::uint64_t* bits) {
+    for (std::size_t base = 0; base < n; base += 64u) {
+        std::uint64_t& word = bits[base / 64u];
+        if (word == 0u) continue; // nothing left to filter in this block
+        const std::size_t m = n - base < 64u ? n - base : 64u;
+        std::uint64_t keep = 0;
+        for (std::size_t i = 0; i < m; ++i) {
+            const std::int64_t v = col[base + i];
+            keep |= static_cast<std::uint64_t>(v >= lo && v < hi) << i;
+        }
+        word &= keep;
+    }
+}
+
+std::size_t find_eq_scalar(const std::int32_t* col, std::size_t n, std::int32_t value) {
+    for (std::size_t i = 0; i < n; ++i) {
+        if (col[i] == value) return i;
+    }
+    return n;
+}
+
+void match_ge_u8_scalar(const std::uint8_t* col, std::size_t n, std::uint8_t value, std::uint64_t* bits) {
+    for (std::size_t base = 0; base < n; base += 64u) {
+        const std::size_t m = n - base < 64u ? n - base : 64u;
+        std::uint64_t word = 0;
+        for (std::size_t i = 0; i < m; ++i) word |= static_cast<std::uint64_t>(col[base + i] >= value) << i;
+        bits[base / 64u] = word;
+    }
+}
+
+const Kernels kScalar{Isa::Scalar, match_eq_scalar, and_range_scalar, find_eq_scalar, match_ge_u8_scalar};
+
+// ---- AVX2 ------------------------------------------------------------------------------
+
+#if BOOKING_COLUMN_SCAN_AVX2
+
+__attribute__((target("avx2"))) inline std::uint64_t eq_bits8(const std::int32_t* p, __m256i v) {
+    const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, v))));
+}
+
+__attribute__((target("avx2"))) void match_eq_avx2(const std::int32_t* col, std::size_t n, std::int32_t value,
+                                                   std::uint64_t* bits) {
+    const __m256i v = _mm256_set1_epi32(value);
+    std::size_t base = 0;
+    for (; base + 64u <= n; base += 64u) {
+        std::uint64_t word = 0;
+        for (int k = 0; k < 8; ++k) word |= eq_bits8(col + base + 8 * k, v) << (8 * k);
+        bits[base / 64u] = word;
+    }
+    if (base < n) match_eq_scalar(col + base, n - base, value, bits + base / 64u);
+}
+
+__attribute__((target("avx2"))) void and_range_avx2(const std::int64_t* col, std::size_t n, std::int64_t lo,
+                                                    std::int64_t hi, std::uint64_t* bits) {
+    const __m256i lo_v = _mm256_set1_epi64x(lo);
+    const __m256i hi_v = _mm256_set1_epi64x(hi);
+    std::size_t base = 0;
+    for (; base + 64u <= n; base += 64u) {
+        std::uint64_t& word = bits[base / 64u];
+        if (word == 0u) continue;
+        std::uint64_t keep = 0;
+        for (int k = 0; k < 16; ++k) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(col + base + 4 * k));
+            // lo <= x < hi  <=>  !(lo > x) && (hi > x)
+            const __m256i in = _mm256_andnot_si256(_mm256_cmpgt_epi64(lo_v, x), _mm256_cmpgt_epi64(hi_v, x));
+            keep |= static_cast<std::uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(in))) << (4 * k);
+        }
+        word &= keep;
+    }
+    if (base < n) and_range_scalar(col + base, n - base, lo, hi, bits + base / 64u);
+}
+
+__attribute__((target("avx2"))) std::size_t find_eq_avx2(const std::int32_t* col, std::size_t n, std::int32_t value) {
+    const __m256i v = _mm256_set1_epi32(value);
+    std::size_t i = 0;
+    for (; i + 8u <= n; i += 8u) {
+        const std::uint64_t hit = eq_bits8(col + i, v);
+        if (hit != 0u) return i + static_cast<std::size_t>(__builtin_ctzll(hit));
+    }
+    return i + find_eq_scalar(col + i, n - i, value);
+}
+
+__attribute__((target("avx2"))) void match_ge_u8_avx2(const std::uint8_t* col, std::size_t n, std::uint8_t value,
+                                                      std::uint64_t* bits) {
+    const __m256i v = _mm256_set1_epi8(static_cast<char>(value));
+    std::size_t base = 0;
+    for (; base + 64u <= n; base += 64u) {
+        std::uint64_t word = 0;
+        for (int k = 0; k < 2; ++k) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(col + base + 32 * k));
+            // Unsigned x >= v  <=>  max(x, v) == x
+            const __m256i ge = _mm256_cmpeq_epi8(_mm256_max_epu8(x, v), x);
+            word |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(ge))) << (32 * k);
+        }
+        bits[base / 64u] = word;
+    }
+    if (base < n) match_ge_u8_scalar(col + base, n - base, value, bits + base / 64u);
+}
+
+const Kernels kAvx2{Isa::Avx2, match_eq_avx2, and_range_avx2, find_eq_avx2, match_ge_u8_avx2};
+
+#endif // BOOKING_COLUMN_SCAN_AVX2
+
+} // namespace
+
+const Kernels& scalar_kernels() {
+    return kScalar;
+}
+
+const Kernels* avx2_kernels() {
+#if BOOKING_COLUMN_SCAN_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported ? &kAvx2 : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const Kernels& kernels() {
+    static const Kernels& selected = avx2_kernels() ? *avx2_kernels() : kScalar;
+    return selected;
+}
+
+} // namespace column_scan
+} // namespace booking
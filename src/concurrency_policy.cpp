@@ -0,0 +1,16 @@
+#include "concurrency_policy.hpp"
+
+namespace booking {
+
+const char* to_string(ConcurrencyPolicy policy) {
+    switch (policy) {
+        case ConcurrencyPolicy::AtomicCas: return "atomic_cas";
+        case ConcurrencyPolicy::ShowMutex: return "show_mutex";
+        case ConcurrencyPolicy::ShowSpinlock: return "show_spinlock";
+        case ConcurrencyPolicy::ShowRwLock: return "show_rwlock";
+        case ConcurrencyPolicy::FlatCombining: return "flat_combining";
+    }
+    return "unknown";
+}
+
+} // namespace booking
@@ -0,0 +1,70 @@
+#include "crc32c.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BOOKING_CRC32C_SSE42 1
+#include <immintrin.h>
+#endif
+
+namespace booking {
+
+namespace {
+
+constexpr std::uint32_t kPolynomial = 0x82F63B78u; // Castagnoli, reflected
+
+constexpr std::array<std::uint32_t, 256> make_table() {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < 256u; ++i) {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c & 1u) != 0u ? (c >> 1) ^ kPolynomial : c >> 1;
+        table[i] = c;
+    }
+    return table;
+}
+
+constexpr std::array<std::uint32_t, 256> kTable = make_table();
+
+std::uint32_t crc32c_scalar(const unsigned char* p, std::size_t size, std::uint32_t crc) {
+    for (std::size_t i = 0; i < size; ++i) crc = kTable[(crc ^ p[i]) & 0xffu] ^ (crc >> 8);
+    return crc;
+}
+
+#if BOOKING_CRC32C_SSE42
+
+__attribute__((target("sse4.2"))) std::uint32_t crc32c_sse42(const unsigned char* p, std::size_t size,
+                                                             std::uint32_t crc) {
+    std::uint64_t c = crc;
+    for (; size >= 8u; p += 8, size -= 8u) {
+        std::uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        c = _mm_crc32_u64(c, word);
+    }
+    std::uint32_t tail = static_cast<std::uint32_t>(c);
+    for (; size > 0u; ++p, --size) tail = _mm_crc32_u8(tail, *p);
+    return tail;
+}
+
+#endif
+
+} // namespace
+
+bool crc32c_hardware() {
+#if BOOKING_CRC32C_SSE42
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+std::uint32_t crc32c(const void* data, std::size_t size, std::uint32_t crc) {
+    const auto* p = static_cast<const unsigned char*>(data);
+#if BOOKING_CRC32C_SSE42
+    if (crc32c_hardware()) return ~crc32c_sse42(p, size, ~crc);
+#endif
+    return ~crc32c_scalar(p, size, ~crc);
+}
+
+} // namespace booking
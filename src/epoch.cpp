@@ -0,0 +1,140 @@
+#include "epoch.hpp"
+
+#include <algorithm>
+
+namespace booking {
+
+namespace {
+
+// Process-wide registry of reader indices, shared by all domains
+std::atomic<bool> g_index_used[EpochManager::kMaxThreads];
+
+struct ThreadIndex {
+    int index = -1;
+
+    ThreadIndex() {
+        for (std::size_t i = 0; i < EpochManager::kMaxThreads; ++i) {
+            bool expected = false;
+            if (!g_index_used[i].load(std::memory_order_relaxed)
+                && g_index_used[i].compare_exchange_strong(expected, true)) {
+                index = static_cast<int>(i);
+                return;
+            }
+        }
+    }
+
+    ~ThreadIndex() {
+        if (index >= 0) g_index_used[index].store(false, std::memory_order_release);
+    }
+};
+
+} // namespace
+
+int EpochManager::thread_index() {
+    thread_local ThreadIndex registration;
+    return registration.index;
+}
+
+EpochManager::EpochManager(std::size_t batch) : batch_(batch == 0u ? 1u : batch), slots_(new Slot[kMaxThreads]) {}
+
+EpochManager::~EpochManager() {
+    for (const Retired& r : retired_) r.deleter(r.object);
+    for (std::size_t i = 0; i < kMaxThreads; ++i) {
+        for (const Retired& r : slots_[i].deferred) r.deleter(r.object);
+    }
+}
+
+EpochManager::Guard::Guard(const EpochManager& domain) : domain_(domain), slot_(thread_index()) {
+    if (slot_ < 0) {
+        domain_.overflow_readers_.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return;
+    }
+    Slot& slot = domain_.slots_[static_cast<std::size_t>(slot_)];
+    if (slot.depth++ == 0) {
+        slot.epoch.store(domain_.global_.load());
+        // Order the announcement before every load of a protected pointer
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+EpochManager::Guard::~Guard() {
+    if (slot_ < 0) {
+        domain_.overflow_readers_.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+    Slot& slot = domain_.slots_[static_cast<std::size_t>(slot_)];
+    if (--slot.depth == 0) slot.epoch.store(0, std::memory_order_release);
+}
+
+void EpochManager::retire_raw(void* object, void (*deleter)(void*)) {
+    const int index = batch_ > 1u ? thread_index() : -1;
+    if (index >= 0) {
+        // Stamped with the current epoch; the hand-over advances it past the whole batch
+        Slot& slot = slots_[static_cast<std::size_t>(index)];
+        slot.deferred.push_back(Retired{object, deleter, global_.load()});
+        slot.deferred_count.store(slot.deferred.size(), std::memory_order_relaxed);
+        if (slot.deferred.size() < batch_) return;
+        hand_over(slot);
+        reclaim();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        // A reader that announces a later epoch started after the object was unpublished
+        retired_.push_back(Retired{object, deleter, global_.fetch_add(1)});
+    }
+    reclaim();
+}
+
+void EpochManager::hand_over(Slot& slot) {
+    if (slot.deferred.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        retired_.insert(retired_.end(), slot.deferred.begin(), slot.deferred.end());
+    }
+    // Readers announcing a later epoch started after every object of the batch was unpublished
+    global_.fetch_add(1);
+    slot.deferred.clear();
+    slot.deferred_count.store(0, std::memory_order_relaxed);
+}
+
+std::size_t EpochManager::reclaim() {
+    if (batch_ > 1u) {
+        const int index = thread_index();
+        if (index >= 0) hand_over(slots_[static_cast<std::size_t>(index)]);
+    }
+    std::vector<Retired> ready;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        if (retired_.empty()) return 0;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (overflow_readers_.load() != 0u) return 0;
+
+        // Oldest epoch still announced by a reader
+        std::uint64_t oldest = UINT64_MAX;
+        for (std::size_t i = 0; i < kMaxThreads; ++i) {
+            const std::uint64_t e = slots_[i].epoch.load();
+            if (e != 0u && e < oldest) oldest = e;
+        }
+        auto keep = std::partition(retired_.begin(), retired_.end(),
+                                   [&](const Retired& r) { return r.epoch >= oldest; });
+        ready.assign(keep, retired_.end());
+        retired_.erase(keep, retired_.end());
+    }
+    for (const Retired& r : ready) r.deleter(r.object);
+    return ready.size();
+}
+
+std::size_t EpochManager::pending() const {
+    std::size_t deferred = 0;
+    if (batch_ > 1u) {
+        for (std::size_t i = 0; i < kMaxThreads; ++i) {
+            deferred += slots_[i].deferred_count.load(std::memory_order_relaxed);
+        }
+    }
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    return retired_.size() + deferred;
+}
+
+} // namespace booking
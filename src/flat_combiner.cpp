@@ -0,0 +1,57 @@
+#include "flat_combiner.hpp"
+
+#include "backoff.hpp"
+
+#include <thread>
+
+namespace booking {
+
+namespace {
+
+/** @brief Polls of the done flag before a waiter starts yielding its core. */
+constexpr int kSpinWaits = 256;
+
+/** @brief Requests one pass applies at most, so a combiner under steady load still returns. */
+constexpr std::uint64_t kMaxPass = 256;
+
+} // namespace
+
+thread_local const FlatCombiner* FlatCombiner::current_ = nullptr;
+
+void FlatCombiner::publish(Request& request) {
+    published_.push(&request);
+    for (int polls = 0;; ++polls) {
+        if (request.done.load(std::memory_order_acquire)) return;
+        // Whoever finds the lock free combines; a request behind a half-done push stays for the next pass
+        if (!busy_.load(std::memory_order_relaxed) && !busy_.exchange(true, std::memory_order_acquire)) {
+            combine();
+            busy_.store(false, std::memory_order_release);
+            continue;
+        }
+        if (polls < kSpinWaits) {
+            cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void FlatCombiner::combine() {
+    const FlatCombiner* outer = current_;
+    current_ = this;
+    std::uint64_t applied = 0;
+    while (applied < kMaxPass) {
+        MpscNode* node = published_.pop();
+        if (!node) break;
+        Request* request = static_cast<Request*>(node);
+        request->invoke(request);
+        request->done.store(true, std::memory_order_release); // the publisher may free it now
+        ++applied;
+    }
+    current_ = outer;
+    if (applied == 0u) return; // everything was applied already, or the next push is half done
+    passes_.fetch_add(1u, std::memory_order_relaxed);
+    requests_.fetch_add(applied, std::memory_order_relaxed);
+}
+
+} // namespace booking
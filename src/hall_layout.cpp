@@ -0,0 +1,275 @@
+#include "hall_layout.hpp"
+
+#include "seat_label.hpp"
+#include "seat_mask.hpp"
+#include "seat_runs.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+namespace booking {
+
+HallLayout::HallLayout(std::vector<RowSpec> rows, seat_label::LabelGrammar grammar)
+    : rows_(std::move(rows)), grammar_(grammar), split_(seat_label::splitter(grammar)) {
+    if (rows_.empty() || static_cast<int>(rows_.size()) > kMaxRows) {
+        throw std::invalid_argument("HallLayout: row count must be in [1..64]");
+    }
+
+    for (std::size_t r = 0; r < rows_.size(); ++r) {
+        RowSpec& row = rows_[r];
+        if (row.seats < 1 || row.seats > kMaxRowSeats) {
+            throw std::invalid_argument("HallLayout: row width must be in [1..64]");
+        }
+        if (row.label.empty()) {
+            throw std::invalid_argument("HallLayout: empty row label");
+        }
+        for (char& c : row.label) {
+            if (!std::isalpha(static_cast<unsigned char>(c))) {
+                throw std::invalid_argument("HallLayout: row labels must be alphabetic");
+            }
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        row_codes_[r] = seat_label::row_code(row.label);
+        if (row_codes_[r] == 0u) {
+            throw std::invalid_argument("HallLayout: row labels must have 1-6 letters");
+        }
+        for (std::size_t prev = 0; prev < r; ++prev) {
+            if (row_codes_[prev] == row_codes_[r]) {
+                throw std::invalid_argument("HallLayout: duplicate row label " + row.label);
+            }
+        }
+        row_masks_[r] = row.seats == kMaxRowSeats ? ~std::uint64_t{0} : ((std::uint64_t{1} << row.seats) - 1u);
+        open_row_masks_[r] = row_masks_[r];
+        adjacent_[r] = row_masks_[r] & (row_masks_[r] >> 1);
+        seat_count_ += row.seats;
+        sequential_codes_ = sequential_codes_ && row_codes_[r] == static_cast<std::uint32_t>(r + 1);
+    }
+
+    const int rows_n = row_count();
+    for (int r = 0; r < rows_n; ++r) {
+        const int offset = 2 * r + 1 - rows_n;
+        row_cost_[static_cast<std::size_t>(r)] = static_cast<std::uint16_t>(offset < 0 ? -offset : offset);
+    }
+
+    // Label table: at most 64 x 64 labels of 6 letters, a separator and 2 digits, so offsets fit 16 bits
+    static_assert(kMaxRows * kMaxRowSeats * 9 <= 0xFFFF, "label offsets are 16-bit");
+    const seat_label::FormatFn format = seat_label::formatter(grammar);
+    label_offsets_.reserve(static_cast<std::size_t>(seat_count_) + 1u);
+    label_offsets_.push_back(0);
+    int dense = 0;
+    for (int r = 0; r < rows_n; ++r) {
+        row_first_[static_cast<std::size_t>(r)] = static_cast<std::uint16_t>(dense);
+        for (int col = 1; col <= row_seats(r); ++col) {
+            char label[seat_label::kMaxRowLetters + 3];
+            label_chars_.append(label, format(row_label(r), col, label));
+            label_offsets_.push_back(static_cast<std::uint16_t>(label_chars_.size()));
+        }
+        dense += row_seats(r);
+    }
+}
+
+HallLayout HallLayout::single_row(int seats) {
+    return HallLayout({RowSpec{"a", seats}});
+}
+
+HallLayout HallLayout::uniform(int rows, int seats_per_row, seat_label::LabelGrammar grammar) {
+    if (rows < 1 || rows > kMaxRows) {
+        throw std::invalid_argument("HallLayout: row count must be in [1..64]");
+    }
+    std::vector<RowSpec> specs;
+    specs.reserve(static_cast<std::size_t>(rows));
+    for (int r = 0; r < rows; ++r) {
+        specs.push_back(RowSpec{row_label_for(r), seats_per_row});
+    }
+    return HallLayout(std::move(specs), grammar);
+}
+
+std::string HallLayout::row_label_for(int row) {
+    // Bijective base-26: 0 -> "a", 25 -> "z", 26 -> "aa", 27 -> "ab", ...
+    std::string out;
+    int n = row + 1;
+    while (n > 0) {
+        --n;
+        out.insert(out.begin(), static_cast<char>('a' + n % 26));
+        n /= 26;
+    }
+    return out;
+}
+
+bool HallLayout::contains(int seat) const {
+    if (seat < 0) return false;
+    const int row = row_of(seat);
+    return row < row_count() && col_of(seat) < row_seats(row);
+}
+
+std::vector<int> HallLayout::translate_to(const HallLayout& to) const {
+    std::vector<int> table(static_cast<std::size_t>(row_count()) * kMaxRowSeats, -1);
+    for (int r = 0; r < row_count(); ++r) {
+        for (int c = 0; c < row_seats(r); ++c) {
+            const int seat = seat_index(r, c);
+            int target = -1;
+            if (to.try_parse_label(label_view(seat), target)) table[static_cast<std::size_t>(seat)] = target;
+        }
+    }
+    return table;
+}
+
+bool HallLayout::try_parse_label(std::string_view label, int& out_seat) const {
+    std::uint32_t code = 0u;
+    int num = 0;
+    if (!split_(label, code, num)) return false;
+    return try_seat(code, num, out_seat);
+}
+
+bool HallLayout::try_seat(std::uint32_t code, int num, int& out_seat) const {
+    if (code == 0u) return false; // a malformed label (seat_label::scan_list)
+    // Rows labelled "a","b",...: the row code is the row number, no search needed
+    if (sequential_codes_) {
+        const int r = static_cast<int>(code) - 1;
+        if (r >= row_count() || num < 1 || num > row_seats(r)) return false;
+        out_seat = seat_index(r, num - 1);
+        return true;
+    }
+
+    for (int r = 0; r < row_count(); ++r) {
+        if (row_codes_[static_cast<std::size_t>(r)] == code) {
+            if (num < 1 || num > row_seats(r)) return false;
+            out_seat = seat_index(r, num - 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+char* HallLayout::render_labels(const std::uint64_t* words, int word_count, char separator, char* out) const {
+    char* const start = out;
+    for (int w = 0; w < word_count && w < row_count(); ++w) {
+        std::uint64_t bits = words[w] & row_mask(w);
+        while (bits != 0u) {
+            const std::string_view l = label_view(seat_index(w, ctz64(bits)));
+            bits &= bits - 1u;
+            if (out != start) *out++ = separator;
+            std::memcpy(out, l.data(), l.size());
+            out += l.size();
+        }
+    }
+    return out;
+}
+
+static_assert(std::tuple_size<decltype(PriceTier::seats)>::value == HallLayout::kMaxRows, "one tier word per row");
+
+void HallLayout::set_price_tiers(std::vector<PriceTier> tiers) {
+    std::array<std::uint64_t, kMaxRows> priced{};
+    for (const PriceTier& tier : tiers) {
+        for (int r = 0; r < kMaxRows; ++r) {
+            const std::uint64_t bits = tier.seats[static_cast<std::size_t>(r)];
+            if (bits == 0u) continue;
+            if (r >= row_count() || (bits & ~row_mask(r)) != 0u) {
+                throw std::invalid_argument("HallLayout: price tier " + tier.name + " names a seat outside the layout");
+            }
+            if ((bits & priced[static_cast<std::size_t>(r)]) != 0u) {
+                throw std::invalid_argument("HallLayout: price tier " + tier.name + " overlaps another tier");
+            }
+            priced[static_cast<std::size_t>(r)] |= bits;
+        }
+    }
+    std::stable_sort(tiers.begin(), tiers.end(),
+                     [](const PriceTier& a, const PriceTier& b) { return a.price < b.price; });
+
+    tiers_ = std::move(tiers);
+    level_prices_.clear();
+    level_words_.clear();
+    const std::size_t rows_n = rows_.size();
+    for (const PriceTier& tier : tiers_) {
+        if (level_prices_.empty() || level_prices_.back() != tier.price) {
+            // A new level starts from everything cheaper
+            level_prices_.push_back(tier.price);
+            const std::size_t prev = level_words_.size();
+            level_words_.resize(prev + rows_n, 0u);
+            if (prev != 0u) std::copy_n(level_words_.begin() + static_cast<std::ptrdiff_t>(prev - rows_n), rows_n,
+                                        level_words_.begin() + static_cast<std::ptrdiff_t>(prev));
+        }
+        std::uint64_t* level = level_words_.data() + level_words_.size() - rows_n;
+        for (std::size_t r = 0; r < rows_n; ++r) level[r] |= tier.seats[r];
+    }
+}
+
+int HallLayout::level_at_most(std::uint32_t max_price) const {
+    const auto it = std::upper_bound(level_prices_.begin(), level_prices_.end(), max_price);
+    return static_cast<int>(it - level_prices_.begin()) - 1;
+}
+
+std::uint64_t HallLayout::price_of(const SeatMask& seats) const {
+    std::uint64_t total = 0;
+    for (const PriceTier& tier : tiers_) {
+        for (int w = seats.first_word(); w < seats.end_word() && w < row_count(); ++w) {
+            total += static_cast<std::uint64_t>(tier.price)
+                     * static_cast<std::uint64_t>(popcount64(seats.word(w) & tier.seats[static_cast<std::size_t>(w)]));
+        }
+    }
+    return total;
+}
+
+void HallLayout::set_seat_categories(const SeatCategories& categories) {
+    std::array<std::uint64_t, kMaxRows> open{};
+    bool any = false;
+    for (int r = 0; r < kMaxRows; ++r) {
+        const std::size_t i = static_cast<std::size_t>(r);
+        const std::uint64_t spaces = categories.wheelchair[i];
+        const std::uint64_t companions = categories.companion[i];
+        if ((spaces | companions) == 0u) {
+            if (r < row_count()) open[i] = row_mask(r);
+            continue;
+        }
+        if (r >= row_count() || ((spaces | companions) & ~row_mask(r)) != 0u) {
+            throw std::invalid_argument("HallLayout: seat category names a seat outside the layout");
+        }
+        if ((spaces & companions) != 0u) {
+            throw std::invalid_argument("HallLayout: a seat is both a wheelchair space and a companion seat");
+        }
+        const std::uint64_t alone = companions & ~neighbours(r, spaces);
+        if (alone != 0u) {
+            throw std::invalid_argument("HallLayout: companion seat " + label(seat_index(r, ctz64(alone)))
+                                        + " has no wheelchair space next to it");
+        }
+        open[i] = row_mask(r) & ~(spaces | companions);
+        any = true;
+    }
+    categories_ = categories;
+    open_row_masks_ = open;
+    has_categories_ = any;
+}
+
+void HallLayout::set_aisles(const std::array<std::uint64_t, kMaxRows>& after) {
+    std::array<std::uint64_t, kMaxRows> adjacent{};
+    for (int r = 0; r < kMaxRows; ++r) {
+        const std::size_t i = static_cast<std::size_t>(r);
+        const std::uint64_t pairs = r < row_count() ? row_mask(r) & (row_mask(r) >> 1) : 0u;
+        if ((after[i] & ~pairs) != 0u) {
+            throw std::invalid_argument("HallLayout: aisle without a seat on both sides");
+        }
+        adjacent[i] = pairs & ~after[i];
+    }
+    aisles_ = after;
+    adjacent_ = adjacent;
+    block_starts_.clear();
+    if (std::all_of(after.begin(), after.end(), [](std::uint64_t a) { return a == 0u; })) return;
+
+    // Run starts without an aisle inside: n seats need n - 1 neighbour links in a row
+    block_starts_.resize(rows_.size() * static_cast<std::size_t>(kMaxRowSeats));
+    for (int r = 0; r < row_count(); ++r) {
+        std::uint64_t* row = block_starts_.data() + static_cast<std::size_t>(r) * kMaxRowSeats;
+        row[0] = row_mask(r);
+        for (int n = 2; n <= kMaxRowSeats; ++n) row[n - 1] = run_starts(adjacent_[static_cast<std::size_t>(r)], n - 1);
+    }
+}
+
+std::uint64_t HallLayout::block_starts(int row, int n) const {
+    if (n < 1 || n > kMaxRowSeats) return 0u;
+    if (block_starts_.empty()) return run_starts(row_mask(row), n);
+    return block_starts_[static_cast<std::size_t>(row) * kMaxRowSeats + static_cast<std::size_t>(n - 1)];
+}
+
+} // namespace booking
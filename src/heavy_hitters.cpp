@@ -0,0 +1,67 @@
+#include "heavy_hitters.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace booking {
+
+namespace {
+
+std::size_t set_of(std::int64_t key) {
+    // Fibonacci hashing: consecutive show ids spread over all sets
+    static_assert((HeavyHitters::kSets & (HeavyHitters::kSets - 1u)) == 0u, "kSets is a power of two");
+    const std::uint64_t h = static_cast<std::uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(h >> 32) & (HeavyHitters::kSets - 1u);
+}
+
+} // namespace
+
+void HeavyHitters::add(std::int64_t key, std::uint64_t weight) {
+    std::array<Counter, kWays>& set = shards_.local([] { return std::make_unique<Shard>(); }).sets[set_of(key)];
+    Counter* smallest = &set[0];
+    std::uint64_t smallest_count = set[0].count.load(std::memory_order_relaxed);
+    for (Counter& c : set) {
+        const std::uint64_t count = c.count.load(std::memory_order_relaxed);
+        if (c.key.load(std::memory_order_relaxed) == key) {
+            c.count.store(count + weight, std::memory_order_relaxed);
+            return;
+        }
+        if (count < smallest_count) {
+            smallest = &c;
+            smallest_count = count;
+        }
+    }
+    // Space-Saving replacement: the new key inherits the evicted count as its possible overcount
+    smallest->count.store(smallest_count + weight, std::memory_order_relaxed);
+    smallest->error.store(smallest_count, std::memory_order_relaxed);
+    smallest->key.store(key, std::memory_order_relaxed);
+}
+
+std::vector<HeavyHitters::Item> HeavyHitters::top(std::size_t k) const {
+    std::unordered_map<std::int64_t, Item> merged;
+    shards_.for_each([&](const Shard& shard) {
+        for (const auto& set : shard.sets) {
+            for (const Counter& c : set) {
+                const std::int64_t key = c.key.load(std::memory_order_relaxed);
+                if (key < 0) continue;
+                Item& item = merged[key];
+                item.key = key;
+                item.count += c.count.load(std::memory_order_relaxed);
+                item.error += c.error.load(std::memory_order_relaxed);
+            }
+        }
+    });
+    std::vector<Item> out;
+    out.reserve(merged.size());
+    for (const auto& entry : merged) out.push_back(entry.second);
+    const auto larger = [](const Item& a, const Item& b) { return a.count != b.count ? a.count > b.count : a.key < b.key; };
+    if (out.size() > k) {
+        std::partial_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(k), out.end(), larger);
+        out.resize(k);
+    } else {
+        std::sort(out.begin(), out.end(), larger);
+    }
+    return out;
+}
+
+} // namespace booking
@@ -0,0 +1,81 @@
+#include "htm.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BOOKING_HTM_RTM 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace booking {
+namespace htm {
+
+const char* to_string(Outcome outcome) {
+    switch (outcome) {
+        case Outcome::Committed: return "committed";
+        case Outcome::Conflict: return "conflict";
+        case Outcome::Aborted: return "aborted";
+        case Outcome::Unsupported: return "unsupported";
+    }
+    return "unknown";
+}
+
+#if BOOKING_HTM_RTM
+
+namespace {
+
+constexpr unsigned kTakenAbort = 0x01; /**< Explicit abort code: a requested seat is booked. */
+
+bool cpu_has_rtm() {
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+    return (ebx & (1u << 11)) != 0u; // CPUID.(EAX=7,ECX=0):EBX.RTM[bit 11]
+}
+
+__attribute__((target("rtm"))) Outcome or_words_rtm(std::atomic<std::uint64_t>* words, const SeatMask& req,
+                                                    std::uint64_t* out_old) {
+    const int first = req.first_word();
+    const int end = req.end_word();
+    const unsigned status = _xbegin();
+    if (status == _XBEGIN_STARTED) {
+        // Inside the transaction relaxed accesses are plain moves; the commit orders them
+        for (int w = first; w < end; ++w) {
+            const std::uint64_t current = words[w].load(std::memory_order_relaxed);
+            if ((current & req.word(w)) != 0u) _xabort(kTakenAbort);
+            out_old[w - first] = current;
+        }
+        for (int w = first; w < end; ++w) {
+            if (req.word(w) != 0u) words[w].store(out_old[w - first] | req.word(w), std::memory_order_relaxed);
+        }
+        _xend();
+        return Outcome::Committed;
+    }
+    if ((status & _XABORT_EXPLICIT) != 0u && _XABORT_CODE(status) == kTakenAbort) return Outcome::Conflict;
+    return Outcome::Aborted;
+}
+
+} // namespace
+
+bool supported() {
+    static const bool rtm = cpu_has_rtm();
+    return rtm;
+}
+
+Outcome or_words(std::atomic<std::uint64_t>* words, const SeatMask& req, std::uint64_t* out_old) {
+    if (!supported()) return Outcome::Unsupported;
+    return or_words_rtm(words, req, out_old);
+}
+
+#else
+
+bool supported() {
+    return false;
+}
+
+Outcome or_words(std::atomic<std::uint64_t>*, const SeatMask&, std::uint64_t*) {
+    return Outcome::Unsupported;
+}
+
+#endif // BOOKING_HTM_RTM
+
+} // namespace htm
+} // namespace booking
@@ -0,0 +1,422 @@
+#include "http_gateway.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+namespace booking {
+
+namespace {
+
+constexpr std::string_view kHeadEnd = "\r\n\r\n";
+constexpr std::string_view kHttp2Preface = "PRI * HTTP/2.0";
+
+const char* reason_phrase(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        case 505: return "HTTP Version Not Supported";
+    }
+    return "Unknown";
+}
+
+/** @brief HTTP status answering a failed booking. */
+int http_status(BookingStatus status) {
+    switch (status) {
+        case BookingStatus::Ok: return 201;
+        case BookingStatus::Waitlisted: return 202;
+        case BookingStatus::InvalidShow: return 404;
+        case BookingStatus::NoSeats:
+        case BookingStatus::InvalidSeatLabel:
+        case BookingStatus::DuplicateSeatLabel:
+        case BookingStatus::InvalidSeatIndex: return 400;
+        case BookingStatus::Throttled: return 429;
+        case BookingStatus::ReadOnlyReplica: return 403;
+        case BookingStatus::Contended:
+        case BookingStatus::RequestInFlight:
+        case BookingStatus::Busy: return 503;
+        case BookingStatus::DeadlineExceeded: return 504;
+        case BookingStatus::SalesClosed: return 403;
+        default: return 409;
+    }
+}
+
+void append_number(std::string& out, std::uint64_t v) {
+    char buf[24];
+    const auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+}
+
+/** @brief Appends @p s as a JSON string literal. */
+void append_json_string(std::string& out, std::string_view s) {
+    static const char kHex[] = "0123456789abcdef";
+    out += '"';
+    for (const char ch : s) {
+        const unsigned char c = static_cast<unsigned char>(ch);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += ch;
+        } else if (c < 0x20u) {
+            out += "\\u00";
+            out += kHex[c >> 4];
+            out += kHex[c & 15u];
+        } else {
+            out += ch;
+        }
+    }
+    out += '"';
+}
+
+void append_error_body(std::string& out, std::string_view message) {
+    out += "{\"error\":";
+    append_json_string(out, message);
+    out += '}';
+}
+
+void append_status_body(std::string& out, const BookingResult& r) {
+    std::string message;
+    r.append_message(message);
+    out += "{\"status\":";
+    append_number(out, static_cast<std::uint64_t>(r.status));
+    out += ",\"error\":";
+    append_json_string(out, message);
+    out += '}';
+}
+
+/** @brief Status line and the headers every response has, up to the connection header. */
+void append_head(std::string& out, int status, std::size_t body_size) {
+    out += "HTTP/1.1 ";
+    append_number(out, static_cast<std::uint64_t>(status));
+    out += ' ';
+    out += reason_phrase(status);
+    out += "\r\nContent-Type: application/json\r\nContent-Length: ";
+    append_number(out, body_size);
+    out += "\r\n";
+}
+
+void append_end_of_head(std::string& out, bool keep_alive, bool announce_keep_alive) {
+    if (!keep_alive) {
+        out += "Connection: close\r\n";
+    } else if (announce_keep_alive) {
+        out += "Connection: keep-alive\r\n";
+    }
+    out += "\r\n";
+}
+
+void append_response(std::string& out, int status, std::string_view body, bool keep_alive,
+                     bool announce_keep_alive) {
+    append_head(out, status, body.size());
+    append_end_of_head(out, keep_alive, announce_keep_alive);
+    out += body;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if ((static_cast<unsigned char>(a[i]) | 0x20u) != (static_cast<unsigned char>(b[i]) | 0x20u)) return false;
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r' || s.back() == '\n')) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+/** @brief True if the comma-separated header value @p value lists @p token (case-insensitive). */
+bool lists_token(std::string_view value, std::string_view token) {
+    while (!value.empty()) {
+        const std::size_t comma = value.find(',');
+        if (iequals(trim(value.substr(0, comma)), token)) return true;
+        if (comma == std::string_view::npos) break;
+        value.remove_prefix(comma + 1u);
+    }
+    return false;
+}
+
+/** @brief Removes and returns the next '/'-separated segment of @p path. */
+std::string_view next_segment(std::string_view& path) {
+    if (!path.empty() && path.front() == '/') path.remove_prefix(1);
+    const std::size_t slash = path.find('/');
+    const std::string_view segment = path.substr(0, slash);
+    path = slash == std::string_view::npos ? std::string_view{} : path.substr(slash);
+    return segment;
+}
+
+} // namespace
+
+std::ptrdiff_t HttpCommandHandler::execute(const char* data, std::size_t size, std::string& out,
+                                           CommandOutcome& outcome, std::size_t out_limit) {
+    outcome = CommandOutcome::Continue;
+    const std::string_view in(data, size);
+    std::size_t pos = 0;
+    const auto fail = [&](int status, std::string_view message) -> std::ptrdiff_t {
+        body_.clear();
+        append_error_body(body_, message);
+        append_response(out, status, body_, false, false);
+        outcome = CommandOutcome::Close;
+        return -1;
+    };
+
+    while (pos < size && out.size() < out_limit) {
+        const std::size_t head_end = in.find(kHeadEnd, pos);
+        if (head_end == std::string_view::npos) {
+            if (size - pos > max_request_) return fail(431, "request head too large");
+            break;
+        }
+        if (head_end - pos > max_request_) return fail(431, "request head too large");
+        const std::string_view head = in.substr(pos, head_end - pos);
+
+        // Request line: <method> <target> <version>
+        const std::size_t line_end = head.find("\r\n");
+        const std::string_view request_line = head.substr(0, line_end);
+        if (request_line.substr(0, kHttp2Preface.size()) == kHttp2Preface) {
+            return fail(505, "HTTP/2 is not supported; use HTTP/1.1");
+        }
+        const std::size_t sp1 = request_line.find(' ');
+        const std::size_t sp2 = sp1 == std::string_view::npos ? sp1 : request_line.find(' ', sp1 + 1u);
+        if (sp2 == std::string_view::npos) return fail(400, "malformed request line");
+        const std::string_view method = request_line.substr(0, sp1);
+        const std::string_view target = request_line.substr(sp1 + 1u, sp2 - sp1 - 1u);
+        const std::string_view version = request_line.substr(sp2 + 1u);
+        const bool http10 = version == "HTTP/1.0";
+        if (!http10 && version != "HTTP/1.1") return fail(505, "only HTTP/1.0 and HTTP/1.1 are supported");
+
+        // Headers
+        std::size_t content_length = 0;
+        bool close = false;
+        bool keep_alive_requested = false;
+        std::string_view headers = line_end == std::string_view::npos ? std::string_view{} : head.substr(line_end + 2u);
+        while (!headers.empty()) {
+            const std::size_t eol = headers.find("\r\n");
+            const std::string_view line = headers.substr(0, eol);
+            headers = eol == std::string_view::npos ? std::string_view{} : headers.substr(eol + 2u);
+            const std::size_t colon = line.find(':');
+            if (colon == std::string_view::npos || colon == 0u) return fail(400, "malformed header");
+            const std::string_view name = line.substr(0, colon);
+            const std::string_view value = trim(line.substr(colon + 1u));
+            if (iequals(name, "content-length")) {
+                if (!parse_token(value, content_length)) return fail(400, "malformed Content-Length");
+            } else if (iequals(name, "transfer-encoding")) {
+                return fail(501, "chunked requests are not supported; send a Content-Length");
+            } else if (iequals(name, "connection")) {
+                close = close || lists_token(value, "close");
+                keep_alive_requested = keep_alive_requested || lists_token(value, "keep-alive");
+            }
+        }
+        if (content_length > max_request_) return fail(413, "request body too large");
+        const std::size_t body_start = head_end + kHeadEnd.size();
+        if (size - body_start < content_length) break; // body still arriving
+        const std::string_view body = in.substr(body_start, content_length);
+        pos = body_start + content_length;
+
+        const bool keep_alive = http10 ? keep_alive_requested && !close : !close;
+        const bool announce = http10 && keep_alive;
+        if (limiter_ && !limiter_->allow(client_)) {
+            body_.clear();
+            append_status_body(body_, BookingResult::error(BookingStatus::Throttled));
+            append_response(out, 429, body_, keep_alive, announce);
+        } else {
+            respond(method, target, body, keep_alive, announce, out);
+        }
+        if (!keep_alive) {
+            outcome = CommandOutcome::Close;
+            break;
+        }
+    }
+    return static_cast<std::ptrdiff_t>(pos);
+}
+
+void HttpCommandHandler::respond(std::string_view method, std::string_view path, std::string_view body,
+                                 bool keep_alive, bool announce_keep_alive, std::string& out) {
+    body_.clear();
+    int status = 200;
+    std::string_view rest = path;
+    const std::string_view resource = next_segment(rest);
+    if (resource == "movies") {
+        if (method != "GET") {
+            status = 405;
+            append_error_body(body_, "use GET");
+        } else if (!respond_cached(path, keep_alive, announce_keep_alive, out)) {
+            status = 404;
+            append_error_body(body_, "no such resource");
+        } else {
+            return;
+        }
+    } else if (resource == "shows") {
+        MovieId movie_id = -1;
+        TheaterId theater_id = -1;
+        const std::string_view movie = next_segment(rest);
+        const std::string_view theater = next_segment(rest);
+        const std::string_view action = next_segment(rest);
+        const bool seats_path = action == "seats" && rest.empty();
+        const bool book_path = action == "book" && rest.empty();
+        BookingService::ShowHandle* show = nullptr;
+        if (!seats_path && !book_path) {
+            status = 404;
+            append_error_body(body_, "no such resource");
+        } else if (method != (seats_path ? "GET" : "POST")) {
+            status = 405;
+            append_error_body(body_, seats_path ? "use GET" : "use POST");
+        } else if (!parse_token(movie, movie_id) || !parse_token(theater, theater_id)) {
+            status = 400;
+            append_error_body(body_, "movie and theater ids must be integers");
+        } else if ((show = routes_.find(movie_id, theater_id)) == nullptr) {
+            status = 404;
+            append_error_body(body_, "no show for that movie+theater");
+        } else if (seats_path) {
+            seats(*show, body_, status);
+        } else {
+            book(*show, body, body_, status);
+        }
+    } else if (resource == "admin" && config_ && next_segment(rest) == "config" && rest.empty()) {
+        admin_config(method, body, body_, status);
+    } else {
+        status = 404;
+        append_error_body(body_, "no such resource");
+    }
+    append_response(out, status, body_, keep_alive, announce_keep_alive);
+}
+
+bool HttpCommandHandler::respond_cached(std::string_view path, bool keep_alive, bool announce_keep_alive,
+                                        std::string& out) {
+    const std::uint64_t version = service_.catalog_version();
+    if (version != cache_version_) {
+        cache_.clear();
+        cache_version_ = version;
+    }
+    key_.assign(path.data(), path.size());
+    auto it = cache_.find(key_);
+    if (it != cache_.end()) {
+        ++cache_hits_;
+    } else {
+        ++cache_misses_;
+        CachedResponse response;
+        if (!render_catalog(path, response.body)) return false;
+        append_head(response.head, 200, response.body.size());
+        if (cache_.size() >= kMaxCachedResponses) cache_.clear();
+        it = cache_.emplace(key_, std::move(response)).first;
+    }
+    out += it->second.head;
+    append_end_of_head(out, keep_alive, announce_keep_alive);
+    out += it->second.body;
+    return true;
+}
+
+bool HttpCommandHandler::render_catalog(std::string_view path, std::string& body) const {
+    const BookingService::CatalogView view = service_.catalog_view();
+    if (path == "/movies") {
+        body += '[';
+        const Span<const Movie> ms = view.movies();
+        for (std::size_t i = 0; i < ms.size(); ++i) {
+            if (i > 0) body += ',';
+            body += "{\"id\":";
+            append_number(body, static_cast<std::uint64_t>(ms[i].id.value()));
+            body += ",\"title\":";
+            append_json_string(body, ms[i].title);
+            body += '}';
+        }
+        body += ']';
+        return true;
+    }
+    std::string_view rest = path;
+    next_segment(rest); // "movies"
+    MovieId movie_id = -1;
+    if (!parse_token(next_segment(rest), movie_id) || next_segment(rest) != "theaters" || !rest.empty()) {
+        return false;
+    }
+    body += '[';
+    const Span<const Theater> ts = view.theaters_for_movie(movie_id);
+    for (std::size_t i = 0; i < ts.size(); ++i) {
+        if (i > 0) body += ',';
+        body += "{\"id\":";
+        append_number(body, static_cast<std::uint64_t>(ts[i].id.value()));
+        body += ",\"name\":";
+        append_json_string(body, ts[i].name);
+        body += '}';
+    }
+    body += ']';
+    return true;
+}
+
+void HttpCommandHandler::seats(BookingService::ShowHandle& show, std::string& body, int& status) {
+    body += "{\"free\":";
+    const std::size_t count_at = body.size();
+    body += ",\"seats\":\"";
+    const int free_seats = service_.append_cached_available_seats(show, body);
+    body += "\"}";
+    // Labels need no escaping; the count is known only after they are written
+    char buf[24];
+    const auto res = std::to_chars(buf, buf + sizeof(buf), free_seats < 0 ? 0 : free_seats);
+    body.insert(count_at, buf, static_cast<std::size_t>(res.ptr - buf));
+    status = 200;
+}
+
+void HttpCommandHandler::book(BookingService::ShowHandle& show, std::string_view labels, std::string& body,
+                              int& status) {
+    if (read_only_) {
+        status = 403;
+        append_status_body(body, BookingResult::error(BookingStatus::ReadOnlyReplica));
+        return;
+    }
+    const BookingResult r = service_.book_label_list(show, trim(labels));
+    status = http_status(r.success ? BookingStatus::Ok : r.status);
+    if (r.success) {
+        body += "{\"booking_id\":";
+        append_number(body, r.id);
+        body += '}';
+        return;
+    }
+    append_status_body(body, r);
+}
+
+void HttpCommandHandler::admin_config(std::string_view method, std::string_view text, std::string& body,
+                                      int& status) {
+    if (method == "PUT") {
+        const ConfigError error = config_->reload(text);
+        if (error.status != ConfigStatus::Ok) {
+            status = 400;
+            std::string message = "line ";
+            message += std::to_string(error.line);
+            message += ": ";
+            message += error.reason;
+            append_error_body(body, message);
+            return;
+        }
+    } else if (method != "GET") {
+        status = 405;
+        append_error_body(body, "use GET or PUT");
+        return;
+    }
+    const TuningConfig& current = config_->current();
+    body += "{\"version\":";
+    append_number(body, config_->version());
+    if (method == "GET") {
+        body += ",\"backoff_max_retries\":";
+        append_number(body, current.backoff.max_retries);
+        body += ",\"max_hold_ttl_ms\":";
+        append_number(body, static_cast<std::uint64_t>(current.max_hold_ttl.count()));
+        body += ",\"client_rate\":";
+        append_number(body, static_cast<std::uint64_t>(std::max(current.client_rate.per_second, 0.0)));
+        body += ",\"admission_shows\":";
+        append_number(body, current.admission.size());
+    }
+    body += '}';
+    status = 200;
+}
+
+} // namespace booking
@@ -0,0 +1,124 @@
+#include "huge_pages.hpp"
+
+#include <atomic>
+
+#include <sys/mman.h>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+namespace booking {
+
+namespace {
+
+std::atomic<HugePages> g_setting{HugePages::Off};
+
+std::atomic<std::uint64_t> g_mapped[4]; /**< Bytes mapped per HugePages value. */
+
+/** @brief Bytes in front of a huge_allocate block (keeps the payload line-aligned). */
+constexpr std::size_t kHeaderBytes = 64;
+static_assert(sizeof(HugeRegion) <= kHeaderBytes, "HugeRegion must fit in the block header");
+
+std::size_t round_up(std::size_t bytes, std::size_t page) {
+    return (bytes + page - 1u) / page * page;
+}
+
+/** @brief One mmap attempt of @p pages; fills @p out on success. */
+bool try_map(std::size_t bytes, HugePages pages, HugeRegion& out) {
+    const std::size_t length = round_up(bytes, huge_page_bytes(pages));
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_HUGETLB
+    if (pages == HugePages::Explicit2M) flags |= MAP_HUGETLB | (21 << MAP_HUGE_SHIFT);
+    if (pages == HugePages::Explicit1G) flags |= MAP_HUGETLB | (30 << MAP_HUGE_SHIFT);
+#else
+    if (pages == HugePages::Explicit2M || pages == HugePages::Explicit1G) return false;
+#endif
+    void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (p == MAP_FAILED) return false;
+#ifdef MADV_HUGEPAGE
+    if (pages == HugePages::Transparent) ::madvise(p, length, MADV_HUGEPAGE); // a hint: failure is harmless
+#endif
+    out = HugeRegion{p, length, pages};
+    g_mapped[static_cast<std::size_t>(pages)].fetch_add(length, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace
+
+const char* to_string(HugePages pages) {
+    switch (pages) {
+        case HugePages::Off: return "off";
+        case HugePages::Transparent: return "thp";
+        case HugePages::Explicit2M: return "2m";
+        case HugePages::Explicit1G: return "1g";
+    }
+    return "unknown";
+}
+
+bool parse_huge_pages(std::string_view text, HugePages& out) {
+    for (HugePages p : {HugePages::Off, HugePages::Transparent, HugePages::Explicit2M, HugePages::Explicit1G}) {
+        if (text == to_string(p)) {
+            out = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::size_t huge_page_bytes(HugePages pages) {
+    switch (pages) {
+        case HugePages::Explicit2M: return std::size_t{2} << 20;
+        case HugePages::Explicit1G: return std::size_t{1} << 30;
+        default: return std::size_t{4} << 10;
+    }
+}
+
+void set_huge_pages(HugePages pages) {
+    g_setting.store(pages, std::memory_order_relaxed);
+}
+
+HugePages huge_pages() {
+    return g_setting.load(std::memory_order_relaxed);
+}
+
+HugeRegion map_huge(std::size_t bytes, HugePages pages) {
+    HugeRegion region;
+    if (bytes == 0u) return region;
+    // Largest page kind first, each falling back to the next smaller one
+    if (pages == HugePages::Explicit1G && try_map(bytes, HugePages::Explicit1G, region)) return region;
+    if (pages >= HugePages::Explicit2M && try_map(bytes, HugePages::Explicit2M, region)) return region;
+    if (pages >= HugePages::Transparent && try_map(bytes, HugePages::Transparent, region)) return region;
+    try_map(bytes, HugePages::Off, region);
+    return region;
+}
+
+void unmap_huge(const HugeRegion& region) {
+    if (!region.data) return;
+    ::munmap(region.data, region.bytes);
+    g_mapped[static_cast<std::size_t>(region.backing)].fetch_sub(region.bytes, std::memory_order_relaxed);
+}
+
+HugePageStats huge_page_stats() {
+    HugePageStats s;
+    s.normal_bytes = g_mapped[static_cast<std::size_t>(HugePages::Off)].load(std::memory_order_relaxed);
+    s.transparent_bytes = g_mapped[static_cast<std::size_t>(HugePages::Transparent)].load(std::memory_order_relaxed);
+    s.huge_2m_bytes = g_mapped[static_cast<std::size_t>(HugePages::Explicit2M)].load(std::memory_order_relaxed);
+    s.huge_1g_bytes = g_mapped[static_cast<std::size_t>(HugePages::Explicit1G)].load(std::memory_order_relaxed);
+    return s;
+}
+
+void* huge_allocate(std::size_t bytes) {
+    const HugeRegion region = map_huge(bytes + kHeaderBytes, huge_pages());
+    if (!region.data) throw std::bad_alloc();
+    ::new (region.data) HugeRegion(region);
+    return static_cast<char*>(region.data) + kHeaderBytes;
+}
+
+void huge_deallocate(void* p) {
+    if (!p) return;
+    const HugeRegion region = *reinterpret_cast<const HugeRegion*>(static_cast<char*>(p) - kHeaderBytes);
+    unmap_huge(region);
+}
+
+} // namespace booking
@@ -0,0 +1,137 @@
+#include "io_uring.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace booking {
+
+namespace {
+
+int sys_setup(unsigned entries, io_uring_params* p) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int sys_register(int fd, unsigned opcode, const void* arg, unsigned nr) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr));
+}
+
+template <typename T>
+T* at(void* base, std::uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+} // namespace
+
+IoUring::~IoUring() {
+    if (sqes_) ::munmap(sqes_, sqes_size_);
+    if (cq_ring_ && cq_ring_ != sq_ring_) ::munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_) ::munmap(sq_ring_, sq_ring_size_);
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool IoUring::init(unsigned entries) {
+    io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+    const int fd = sys_setup(entries, &p);
+    if (fd < 0) return false;
+    fd_ = fd;
+
+    sq_ring_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    const bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0u;
+    if (single) sq_ring_size_ = cq_ring_size_ = sq_ring_size_ > cq_ring_size_ ? sq_ring_size_ : cq_ring_size_;
+
+    sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                      IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        sq_ring_ = nullptr;
+        return false;
+    }
+    if (single) {
+        cq_ring_ = sq_ring_;
+    } else {
+        cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                          IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            cq_ring_ = nullptr;
+            return false;
+        }
+    }
+    sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return false;
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    sq_head_ = at<unsigned>(sq_ring_, p.sq_off.head);
+    sq_tail_ = at<unsigned>(sq_ring_, p.sq_off.tail);
+    sq_array_ = at<unsigned>(sq_ring_, p.sq_off.array);
+    sq_mask_ = *at<unsigned>(sq_ring_, p.sq_off.ring_mask);
+    sq_entries_ = *at<unsigned>(sq_ring_, p.sq_off.ring_entries);
+    sq_local_tail_ = sq_submitted_ = *sq_tail_;
+
+    cq_head_ = at<unsigned>(cq_ring_, p.cq_off.head);
+    cq_tail_ = at<unsigned>(cq_ring_, p.cq_off.tail);
+    cq_mask_ = *at<unsigned>(cq_ring_, p.cq_off.ring_mask);
+    cqes_ = at<io_uring_cqe>(cq_ring_, p.cq_off.cqes);
+    return true;
+}
+
+io_uring_sqe* IoUring::get_sqe() {
+    const unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sq_local_tail_ - head >= sq_entries_) return nullptr;
+    const unsigned index = sq_local_tail_ & sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    ++sq_local_tail_;
+    return sqe;
+}
+
+int IoUring::submit(unsigned wait_nr) {
+    // Publish the new tail, then one enter call submits and (optionally) waits
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+    const unsigned to_submit = sq_local_tail_ - sq_submitted_;
+    if (to_submit == 0u && wait_nr == 0u) return 0;
+    int n;
+    do {
+        n = sys_enter(fd_, to_submit, wait_nr, wait_nr != 0u ? IORING_ENTER_GETEVENTS : 0u);
+    } while (n < 0 && errno == EINTR && to_submit == 0u);
+    if (n < 0) return -errno;
+    sq_submitted_ += static_cast<unsigned>(n);
+    return n;
+}
+
+io_uring_cqe* IoUring::peek_cqe() {
+    const unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) return nullptr;
+    return &cqes_[head & cq_mask_];
+}
+
+void IoUring::cqe_seen() {
+    __atomic_store_n(cq_head_, *cq_head_ + 1u, __ATOMIC_RELEASE);
+}
+
+int IoUring::register_buffers(const iovec* iovs, unsigned count) {
+    return sys_register(fd_, IORING_REGISTER_BUFFERS, iovs, count) < 0 ? -errno : 0;
+}
+
+int IoUring::register_files(const int* fds, unsigned count) {
+    return sys_register(fd_, IORING_REGISTER_FILES, fds, count) < 0 ? -errno : 0;
+}
+
+int IoUring::update_files(unsigned offset, const int* fds, unsigned count) {
+    io_uring_files_update update;
+    std::memset(&update, 0, sizeof(update));
+    update.offset = offset;
+    update.fds = reinterpret_cast<std::uint64_t>(fds);
+    return sys_register(fd_, IORING_REGISTER_FILES_UPDATE, &update, count) < 0 ? -errno : 0;
+}
+
+} // namespace booking
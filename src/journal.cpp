@@ -0,0 +1,610 @@
+#include "journal.hpp"
+
+#include "crc32c.hpp"
+#include "schedule_loader.hpp"
+#include "snapshot.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace booking {
+
+namespace {
+
+constexpr char kJournalMagic[8] = {'B', 'K', 'J', 'R', 'N', 'L', '\r', '\n'};
+constexpr std::uint32_t kJournalVersion2 = 2; // still read: snapshot_checksum records
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+};
+
+struct RecordHeader {
+    std::uint64_t lsn;
+    std::int64_t show_id;
+    std::uint32_t booking_id;
+    std::uint8_t first_word;
+    std::uint8_t word_count;
+    std::uint8_t op;
+    std::uint8_t reserved;
+    std::uint64_t checksum;
+};
+
+static_assert(sizeof(FileHeader) == kJournalHeaderSize && sizeof(RecordHeader) == 32, "journal record layout");
+
+constexpr std::size_t kHeaderWords = 3; // RecordHeader words covered by the checksum
+
+std::uint64_t record_checksum(const RecordHeader& h, const std::uint64_t* words,
+                              std::uint32_t version = kJournalVersion) {
+    std::uint64_t head[kHeaderWords];
+    std::memcpy(head, &h, sizeof(head));
+    if (version == kJournalVersion2) {
+        return snapshot_checksum(words, h.word_count, snapshot_checksum(head, kHeaderWords));
+    }
+    return crc32c(words, 8u * h.word_count, crc32c(head, sizeof(head)));
+}
+
+/** @brief Appends @p r, encoded in the current format, to @p out. */
+void append_record(std::string& out, const JournalRecord& r) {
+    RecordHeader h{};
+    h.lsn = r.lsn;
+    h.show_id = r.show_id.value();
+    h.booking_id = r.booking_id;
+    h.first_word = static_cast<std::uint8_t>(r.seats.first_word());
+    h.word_count = static_cast<std::uint8_t>(r.seats.end_word() - r.seats.first_word());
+    h.op = static_cast<std::uint8_t>(r.op);
+    std::uint64_t words[SeatMask::kWords];
+    for (int w = 0; w < h.word_count; ++w) words[w] = r.seats.word(h.first_word + w);
+    h.checksum = record_checksum(h, words);
+    out.append(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.append(reinterpret_cast<const char*>(words), 8u * h.word_count);
+}
+
+std::size_t page_size() {
+    static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return page;
+}
+
+bool write_all(int fd, const void* data, std::size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0u) {
+        const ssize_t n = ::write(fd, p, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool pwrite_all(int fd, const char* data, std::size_t size, std::uint64_t offset) {
+    while (size > 0u) {
+        const ssize_t n = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+        offset += static_cast<std::uint64_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+const char* to_string(JournalBackend backend) {
+    switch (backend) {
+        case JournalBackend::Auto: return "auto";
+        case JournalBackend::Write: return "write";
+        case JournalBackend::IoUring: return "io_uring";
+        case JournalBackend::Mapped: return "mapped";
+        case JournalBackend::Direct: return "direct";
+    }
+    return "unknown";
+}
+
+const char* to_string(JournalStatus status) {
+    switch (status) {
+        case JournalStatus::Ok: return "Journal ok";
+        case JournalStatus::IoError: return "Journal I/O error";
+        case JournalStatus::BadHeader: return "Not a journal file";
+    }
+    return "Unknown status";
+}
+
+JournalReader::JournalReader(std::string_view bytes) : bytes_(bytes) {
+    if (bytes_.empty()) return;
+    FileHeader h;
+    if (bytes_.size() < sizeof(h)) {
+        status_ = JournalStatus::BadHeader;
+        return;
+    }
+    std::memcpy(&h, bytes_.data(), sizeof(h));
+    if (std::memcmp(h.magic, kJournalMagic, sizeof(kJournalMagic)) != 0
+        || (h.version != kJournalVersion && h.version != kJournalVersion2)) {
+        status_ = JournalStatus::BadHeader;
+        return;
+    }
+    version_ = h.version;
+    offset_ = sizeof(h);
+}
+
+JournalReader JournalReader::records(std::string_view bytes) {
+    JournalReader reader{std::string_view{}};
+    reader.bytes_ = bytes;
+    return reader;
+}
+
+std::size_t JournalReader::record_size(std::size_t offset) const {
+    if (status_ != JournalStatus::Ok || bytes_.size() - offset < sizeof(RecordHeader)) return 0;
+    RecordHeader h;
+    std::memcpy(&h, bytes_.data() + offset, sizeof(h));
+    if (h.word_count == 0u || h.first_word + h.word_count > SeatMask::kWords) return 0;
+    if (h.op != static_cast<std::uint8_t>(JournalOp::Book) && h.op != static_cast<std::uint8_t>(JournalOp::Cancel)) {
+        return 0;
+    }
+    const std::size_t size = sizeof(h) + 8u * h.word_count;
+    return bytes_.size() - offset < size ? 0u : size;
+}
+
+bool JournalReader::decode(const JournalSpan& span, JournalRecord& out) const {
+    if (record_size(span.offset) == 0u) return false;
+    RecordHeader h;
+    std::memcpy(&h, bytes_.data() + span.offset, sizeof(h));
+    std::uint64_t words[SeatMask::kWords];
+    std::memcpy(words, bytes_.data() + span.offset + sizeof(h), 8u * h.word_count);
+    if (record_checksum(h, words, version_) != h.checksum) return false;
+
+    out.lsn = h.lsn;
+    out.end_lsn = h.lsn + Journal::slots_for(h.word_count);
+    out.op = static_cast<JournalOp>(h.op);
+    out.show_id = ShowId(h.show_id);
+    out.booking_id = h.booking_id;
+    out.seats = SeatMask{};
+    for (int w = 0; w < h.word_count; ++w) out.seats.or_word(h.first_word + w, words[w]);
+    return true;
+}
+
+bool JournalReader::next(JournalRecord& out) {
+    const JournalSpan span{offset_, ShowId{}};
+    if (!decode(span, out)) return false;
+    offset_ += record_size(span.offset);
+    return true;
+}
+
+bool JournalReader::next_span(JournalSpan& out) {
+    const std::size_t size = record_size(offset_);
+    if (size == 0u) return false;
+    RecordHeader h;
+    std::memcpy(&h, bytes_.data() + offset_, sizeof(h));
+    out.offset = offset_;
+    out.show_id = ShowId(h.show_id);
+    offset_ += size;
+    return true;
+}
+
+namespace {
+
+/** @brief Current-format file header. */
+FileHeader file_header() {
+    FileHeader h{};
+    std::memcpy(h.magic, kJournalMagic, sizeof(kJournalMagic));
+    h.version = kJournalVersion;
+    return h;
+}
+
+/**
+ * @brief Opens @p path positioned after its last valid record (a torn tail is cut off),
+ *        writing the file header into a new file; @p next_lsn receives the LSN to continue at.
+ *        An older-format file is first rewritten in the current format (via a renamed copy).
+ */
+JournalStatus open_for_append(const std::string& path, int& fd, std::uint64_t& next_lsn) {
+    std::size_t valid = 0;
+    {
+        MappedFile existing(path);
+        if (existing.ok()) {
+            JournalReader reader(existing.view());
+            if (reader.status() != JournalStatus::Ok) return reader.status();
+            std::string upgraded;
+            JournalRecord r;
+            while (reader.next(r)) {
+                next_lsn = r.end_lsn;
+                if (reader.version() != kJournalVersion) append_record(upgraded, r);
+            }
+            valid = reader.offset();
+            if (reader.version() != kJournalVersion && valid != 0u) {
+                const FileHeader h = file_header();
+                const std::string tmp = path + ".tmp";
+                const int out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                const bool ok = out >= 0 && write_all(out, &h, sizeof(h))
+                                && write_all(out, upgraded.data(), upgraded.size()) && ::fsync(out) == 0;
+                if (out >= 0) ::close(out);
+                if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0) {
+                    ::unlink(tmp.c_str());
+                    return JournalStatus::IoError;
+                }
+                valid = sizeof(h) + upgraded.size();
+            }
+        }
+    }
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644); // read too: the Mapped backend maps it
+    if (fd < 0) return JournalStatus::IoError;
+    if (valid == 0u) {
+        const FileHeader h = file_header();
+        if (::ftruncate(fd, 0) != 0 || !write_all(fd, &h, sizeof(h)) || ::fsync(fd) != 0) {
+            return JournalStatus::IoError;
+        }
+    } else if (::ftruncate(fd, static_cast<off_t>(valid)) != 0 || ::lseek(fd, 0, SEEK_END) < 0) {
+        return JournalStatus::IoError;
+    }
+    return JournalStatus::Ok;
+}
+
+} // namespace
+
+JournalStatus Journal::open(const std::string& path, JournalMode mode, std::size_t ring_slots,
+                            JournalBackend backend, std::size_t segment_bytes) {
+    std::uint64_t next = 0;
+    const JournalStatus opened = open_for_append(path, fd_, next);
+    if (opened != JournalStatus::Ok) return opened;
+    path_ = path;
+    file_offset_ = static_cast<std::uint64_t>(::lseek(fd_, 0, SEEK_CUR));
+    batch_.reset(new std::uint64_t[kBatchWords]);
+    mode_ = mode;
+    if (backend == JournalBackend::Mapped) {
+        segment_bytes_ = std::max(page_size(), (segment_bytes + page_size() - 1u) / page_size() * page_size());
+        if (!map_segments(0)) return JournalStatus::IoError;
+        backend_ = JournalBackend::Mapped;
+    } else if (backend == JournalBackend::Direct && open_direct()) {
+        backend_ = JournalBackend::Direct;
+    } else {
+        const bool uring = (backend == JournalBackend::Auto || backend == JournalBackend::IoUring) && init_uring();
+        backend_ = uring ? JournalBackend::IoUring : JournalBackend::Write;
+    }
+
+    std::size_t capacity = 16;
+    while (capacity < ring_slots) capacity <<= 1u;
+    ring_.reset(new Slot[capacity]);
+    mask_ = capacity - 1u;
+    for (std::uint64_t p = next; p < next + capacity; ++p) slot(p).seq.store(p, std::memory_order_relaxed);
+    head_ = next;
+    durable_.store(next, std::memory_order_relaxed);
+    tail_.store(next, std::memory_order_release);
+    writer_ = std::thread([this] { run(); });
+    return JournalStatus::Ok;
+}
+
+Journal::~Journal() {
+    if (writer_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_.store(true, std::memory_order_release);
+        }
+        wake_writer_.notify_one();
+        writer_.join();
+    }
+    if (map_) unmap_segments();
+    if (direct_fd_ >= 0) {
+        ::close(direct_fd_);
+        [[maybe_unused]] const int cut = ::ftruncate(fd_, static_cast<off_t>(file_offset_)); // the block padding
+    }
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool Journal::map_segments(std::size_t bytes) {
+    const std::size_t need = static_cast<std::size_t>(file_offset_) + bytes;
+    if (map_ && need <= map_size_) return true;
+    // Whole segments, allocated now so that appends never extend the file
+    const std::size_t size = (need / segment_bytes_ + 1u) * segment_bytes_;
+    if (::posix_fallocate(fd_, 0, static_cast<off_t>(size)) != 0) return false;
+    if (mode_ != JournalMode::None && ::fsync(fd_) != 0) return false; // the new size is durable too
+    void* p = map_ ? ::mremap(map_, map_size_, size, MREMAP_MAYMOVE)
+                   : ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) return false;
+    map_ = static_cast<char*>(p);
+    map_size_ = size;
+    return true;
+}
+
+void Journal::unmap_segments() {
+    ::munmap(map_, map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+    [[maybe_unused]] const int cut = ::ftruncate(fd_, static_cast<off_t>(file_offset_)); // a reopen cuts it otherwise
+}
+
+bool Journal::open_direct() {
+    const int flags = O_WRONLY | O_DIRECT | O_CLOEXEC | (mode_ == JournalMode::None ? 0 : O_DSYNC);
+    const int fd = ::open(path_.c_str(), flags);
+    if (fd < 0) return false;
+    if (!direct_) direct_.reset(new DirectBlock[kDirectBlocks]);
+    // The next batch starts inside this block: its records are written again, unchanged
+    const std::size_t carried = static_cast<std::size_t>(file_offset_ % kDirectBlock);
+    if (carried != 0u
+        && ::pread(fd_, direct_[0].bytes, carried, static_cast<off_t>(file_offset_ - carried))
+               != static_cast<ssize_t>(carried)) {
+        ::close(fd);
+        return false;
+    }
+    if (direct_fd_ >= 0) ::close(direct_fd_);
+    direct_fd_ = fd;
+    return true;
+}
+
+std::uint64_t Journal::append(JournalOp op, ShowId show_id, std::uint32_t booking_id, const SeatMask& seats) {
+    const int first = seats.first_word();
+    const int count = seats.end_word() - first;
+    const std::size_t slots = slots_for(count);
+    // One claim reserves all of the record's slots, so records stay contiguous in the ring
+    const std::uint64_t pos = tail_.fetch_add(slots, std::memory_order_acq_rel);
+
+    for (std::size_t k = 0; k < slots; ++k) {
+        Slot& s = slot(pos + k);
+        while (s.seq.load(std::memory_order_acquire) != pos + k) std::this_thread::yield(); // ring full
+        if (k == 0u) {
+            s.op = op;
+            s.show_id = show_id.value();
+            s.booking_id = booking_id;
+            s.first_word = static_cast<std::uint8_t>(first);
+            s.word_count = static_cast<std::uint8_t>(count);
+        }
+        const int begin = static_cast<int>(k) * kSlotWords;
+        for (int i = 0; i < kSlotWords && begin + i < count; ++i) s.words[i] = seats.word(first + begin + i);
+        s.seq.store(pos + k + 1u, std::memory_order_release);
+    }
+    return pos + slots;
+}
+
+bool Journal::wait_durable(std::uint64_t commit_lsn) {
+    if (durable_.load(std::memory_order_acquire) >= commit_lsn) {
+        return !failed() && (!commit_wait_ || commit_wait_(commit_lsn));
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiters_.fetch_add(1, std::memory_order_seq_cst); // pairs with the writer's durable_ store
+    wake_writer_.notify_one(); // skip the writer's idle wait: someone is blocked on this batch
+    durable_cv_.wait(lock, [&] { return durable_.load(std::memory_order_acquire) >= commit_lsn; });
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+    lock.unlock();
+    return !failed() && (!commit_wait_ || commit_wait_(commit_lsn));
+}
+
+bool Journal::init_uring() {
+    auto ring = std::make_unique<IoUring>();
+    if (!ring->init(4)) return false;
+    const iovec iov{batch_.get(), kBatchWords * sizeof(std::uint64_t)};
+    if (ring->register_buffers(&iov, 1) != 0 || ring->register_files(&fd_, 1) != 0) return false;
+    uring_ = std::move(ring);
+    return true;
+}
+
+bool Journal::commit(std::size_t bytes) {
+    if (backend_ == JournalBackend::Mapped) {
+        if (!map_segments(bytes)) return false;
+        std::memcpy(map_ + file_offset_, batch_.get(), bytes);
+        const std::size_t first_page = static_cast<std::size_t>(file_offset_) / page_size() * page_size();
+        file_offset_ += bytes;
+        return mode_ == JournalMode::None
+               || ::msync(map_ + first_page, static_cast<std::size_t>(file_offset_) - first_page, MS_SYNC) == 0;
+    }
+    if (backend_ == JournalBackend::Direct) {
+        // Whole blocks from the one the records end in; the rest of the last block is zeros
+        char* const buffer = direct_[0].bytes;
+        const std::size_t carried = static_cast<std::size_t>(file_offset_ % kDirectBlock);
+        const std::size_t end = carried + bytes;
+        const std::size_t size = (end + kDirectBlock - 1u) / kDirectBlock * kDirectBlock;
+        std::memcpy(buffer + carried, batch_.get(), bytes);
+        std::memset(buffer + end, 0, size - end);
+        if (!pwrite_all(direct_fd_, buffer, size, file_offset_ - carried)) return false; // O_DSYNC: durable
+        file_offset_ += bytes;
+        std::memmove(buffer, buffer + end / kDirectBlock * kDirectBlock, end % kDirectBlock);
+        return true;
+    }
+    if (backend_ == JournalBackend::Write) {
+        return write_all(fd_, batch_.get(), bytes) && (mode_ == JournalMode::None || ::fdatasync(fd_) == 0);
+    }
+
+    // Write linked to a datasync: the sync only runs after a complete write
+    io_uring_sqe* write = uring_->get_sqe();
+    IoUring::prep(write, IORING_OP_WRITE_FIXED, 0, batch_.get(), static_cast<std::uint32_t>(bytes), file_offset_, 1);
+    write->flags = IOSQE_FIXED_FILE;
+    write->buf_index = 0;
+    unsigned expected = 1;
+    if (mode_ != JournalMode::None) {
+        write->flags |= IOSQE_IO_LINK;
+        io_uring_sqe* sync = uring_->get_sqe();
+        IoUring::prep(sync, IORING_OP_FSYNC, 0, nullptr, 0, 0, 2);
+        sync->flags = IOSQE_FIXED_FILE;
+        sync->fsync_flags = IORING_FSYNC_DATASYNC;
+        expected = 2;
+    }
+    if (uring_->submit(expected) < 0) return false;
+
+    std::int32_t written = -1;
+    bool synced = mode_ == JournalMode::None;
+    for (unsigned reaped = 0; reaped < expected;) {
+        io_uring_cqe* cqe = uring_->peek_cqe();
+        if (!cqe) {
+            if (uring_->submit(1) < 0) return false;
+            continue;
+        }
+        if (cqe->user_data == 1u) written = cqe->res;
+        if (cqe->user_data == 2u) synced = cqe->res == 0;
+        uring_->cqe_seen();
+        ++reaped;
+    }
+    if (written < 0) return false;
+    const std::size_t done = static_cast<std::size_t>(written);
+    file_offset_ += done;
+    if (done == bytes && synced) return true;
+
+    // Short write (the linked sync was cancelled): finish synchronously
+    if (::lseek(fd_, static_cast<off_t>(file_offset_), SEEK_SET) < 0) return false;
+    if (!write_all(fd_, reinterpret_cast<const char*>(batch_.get()) + done, bytes - done)) return false;
+    file_offset_ += bytes - done;
+    return mode_ == JournalMode::None || ::fdatasync(fd_) == 0;
+}
+
+JournalStatus Journal::compact(std::uint64_t before_lsn) {
+    if (!writer_.joinable()) return JournalStatus::IoError;
+    std::unique_lock<std::mutex> lock(mutex_);
+    durable_cv_.wait(lock, [&] { return !compact_requested_.load(std::memory_order_relaxed); }); // one at a time
+    const std::uint64_t generation = compact_generation_;
+    compact_before_ = before_lsn;
+    compact_requested_.store(true, std::memory_order_release);
+    wake_writer_.notify_one();
+    durable_cv_.wait(lock, [&] { return compact_generation_ != generation; });
+    return compact_status_;
+}
+
+void Journal::compact_file() {
+    std::uint64_t before = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        before = compact_before_;
+    }
+    JournalStatus status = JournalStatus::IoError;
+    std::size_t dropped = 0;
+    {
+        // Everything up to file_offset_ has been written by this thread, so the file is whole
+        MappedFile file(path_);
+        JournalReader reader(file.ok() ? file.view() : std::string_view{});
+        if (file.ok() && reader.status() == JournalStatus::Ok && file.view().size() >= kJournalHeaderSize) {
+            std::size_t keep = 0;
+            std::size_t newest = kJournalHeaderSize;
+            JournalRecord r;
+            for (std::size_t at = reader.offset(); reader.next(r); at = reader.offset()) {
+                newest = at;
+                if (keep == 0u && r.lsn >= before) keep = at;
+            }
+            if (keep == 0u) keep = newest; // the newest record carries the LSN to continue at
+            const std::string_view kept = file.view().substr(keep, reader.offset() - keep);
+            dropped = keep - kJournalHeaderSize;
+            status = JournalStatus::Ok;
+            if (dropped != 0u) {
+                const std::string tmp = path_ + ".tmp";
+                const int fd = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if (fd < 0 || !write_all(fd, file.view().data(), kJournalHeaderSize)
+                    || !write_all(fd, kept.data(), kept.size()) || ::fsync(fd) != 0
+                    || ::rename(tmp.c_str(), path_.c_str()) != 0
+                    || (uring_ && uring_->update_files(0, &fd, 1) < 0)) {
+                    if (fd >= 0) ::close(fd);
+                    ::unlink(tmp.c_str());
+                    status = JournalStatus::IoError;
+                } else {
+                    if (map_) {
+                        ::munmap(map_, map_size_); // the old file is gone: no need to cut its tail
+                        map_ = nullptr;
+                    }
+                    ::close(fd_);
+                    fd_ = fd;
+                    file_offset_ = kJournalHeaderSize + kept.size();
+                    compacted_bytes_.fetch_add(dropped, std::memory_order_relaxed);
+                    if ((backend_ == JournalBackend::Mapped && !map_segments(0))
+                        || (backend_ == JournalBackend::Direct && !open_direct())) {
+                        failed_.store(true, std::memory_order_release);
+                    }
+                }
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    compact_status_ = status;
+    compact_requested_.store(false, std::memory_order_relaxed);
+    ++compact_generation_;
+    durable_cv_.notify_all();
+}
+
+void Journal::run() {
+    std::uint64_t* const batch = batch_.get();
+    for (;;) {
+        if (compact_requested_.load(std::memory_order_acquire)) compact_file();
+        // Drain every published record, in order
+        std::size_t batch_words = 0;
+        std::uint64_t head = head_;
+        while (slot(head).seq.load(std::memory_order_acquire) == head + 1u) {
+            const Slot& first = slot(head);
+            RecordHeader h{};
+            h.lsn = head;
+            h.show_id = first.show_id;
+            h.booking_id = first.booking_id;
+            h.first_word = first.first_word;
+            h.word_count = first.word_count;
+            h.op = static_cast<std::uint8_t>(first.op);
+            const std::size_t slots = slots_for(h.word_count);
+
+            std::uint64_t words[SeatMask::kWords];
+            for (std::size_t k = 0; k < slots; ++k) {
+                const Slot& s = slot(head + k);
+                while (s.seq.load(std::memory_order_acquire) != head + k + 1u) std::this_thread::yield();
+                const int begin = static_cast<int>(k) * kSlotWords;
+                for (int i = 0; i < kSlotWords && begin + i < h.word_count; ++i) words[begin + i] = s.words[i];
+            }
+            h.checksum = record_checksum(h, words);
+
+            std::memcpy(batch + batch_words, &h, sizeof(h));
+            std::memcpy(batch + batch_words + sizeof(h) / 8u, words, 8u * h.word_count);
+            batch_words += sizeof(h) / 8u + h.word_count;
+            for (std::size_t k = 0; k < slots; ++k) {
+                slot(head + k).seq.store(head + k + mask_ + 1u, std::memory_order_release);
+            }
+            head += slots;
+            if (batch_words >= (1u << 17)) break; // 1 MiB per write
+        }
+
+        if (head != head_) {
+            // Group commit: one write and one sync for the whole batch
+            if (!failed() && !commit(batch_words * 8u)) failed_.store(true, std::memory_order_release);
+            if (commit_tap_ && !failed()) {
+                commit_tap_(std::string_view(reinterpret_cast<const char*>(batch), batch_words * 8u));
+            }
+            head_ = head;
+            durable_.store(head, std::memory_order_seq_cst);
+            if (waiters_.load(std::memory_order_seq_cst) > 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                durable_cv_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stop_.load(std::memory_order_acquire) && tail_.load(std::memory_order_acquire) == head_) break;
+        if (slot(head_).seq.load(std::memory_order_acquire) == head_ + 1u) continue; // published meanwhile
+        if (compact_requested_.load(std::memory_order_relaxed)) continue;
+        // Async producers never notify: poll at a short interval while idle
+        wake_writer_.wait_for(lock, std::chrono::milliseconds(1));
+    }
+}
+
+JournalMirror::~JournalMirror() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+JournalStatus JournalMirror::open(const std::string& path) {
+    return open_for_append(path, fd_, next_lsn_);
+}
+
+bool JournalMirror::append(std::string_view records) {
+    // Skip what the file already has (a resent prefix after a reconnect)
+    JournalReader reader = JournalReader::records(records);
+    JournalRecord r;
+    std::size_t begin = 0;
+    std::uint64_t next = next_lsn_;
+    while (reader.next(r)) {
+        if (r.lsn < next_lsn_) begin = reader.offset();
+        next = std::max(next, r.end_lsn);
+    }
+    if (reader.offset() != records.size()) return false;
+    if (begin == records.size()) return true;
+    if (!write_all(fd_, records.data() + begin, records.size() - begin) || ::fdatasync(fd_) != 0) return false;
+    next_lsn_ = next;
+    return true;
+}
+
+} // namespace booking
@@ -0,0 +1,83 @@
+#include "layout_registry.hpp"
+
+#include <string_view>
+
+namespace booking {
+
+namespace {
+
+constexpr std::uint64_t kFnvOffset = 0xcbf29ce484222325u;
+constexpr std::uint64_t kFnvPrime = 0x100000001b3u;
+
+void mix(std::uint64_t& h, std::uint64_t v) {
+    h = (h ^ v) * kFnvPrime;
+}
+
+void mix(std::uint64_t& h, std::string_view s) {
+    for (const char c : s) mix(h, static_cast<unsigned char>(c));
+    mix(h, s.size());
+}
+
+} // namespace
+
+std::uint64_t LayoutRegistry::fingerprint(const HallLayout& layout) {
+    std::uint64_t h = kFnvOffset;
+    for (int r = 0; r < layout.row_count(); ++r) {
+        mix(h, layout.row_label(r));
+        mix(h, static_cast<std::uint64_t>(layout.row_seats(r)));
+    }
+    for (const PriceTier& t : layout.price_tiers()) {
+        mix(h, t.name);
+        mix(h, t.price);
+        for (const std::uint64_t w : t.seats) mix(h, w);
+    }
+    const SeatCategories& c = layout.seat_categories();
+    for (std::size_t r = 0; r < c.wheelchair.size(); ++r) {
+        mix(h, c.wheelchair[r]);
+        mix(h, c.companion[r]);
+    }
+    for (const std::uint64_t a : layout.aisles()) mix(h, a);
+    mix(h, layout.forbids_single_gaps() ? 1u : 0u);
+    mix(h, static_cast<std::uint64_t>(layout.label_grammar()));
+    return h;
+}
+
+bool LayoutRegistry::same(const HallLayout& a, const HallLayout& b) {
+    if (a.row_count() != b.row_count() || a.forbids_single_gaps() != b.forbids_single_gaps()
+        || a.aisles() != b.aisles() || a.label_grammar() != b.label_grammar()) {
+        return false;
+    }
+    for (int r = 0; r < a.row_count(); ++r) {
+        if (a.row_seats(r) != b.row_seats(r) || a.row_label(r) != b.row_label(r)) return false;
+    }
+    const std::vector<PriceTier>& ta = a.price_tiers();
+    const std::vector<PriceTier>& tb = b.price_tiers();
+    if (ta.size() != tb.size()) return false;
+    for (std::size_t i = 0; i < ta.size(); ++i) {
+        if (ta[i].name != tb[i].name || ta[i].price != tb[i].price || ta[i].seats != tb[i].seats) return false;
+    }
+    return a.seat_categories().wheelchair == b.seat_categories().wheelchair
+           && a.seat_categories().companion == b.seat_categories().companion;
+}
+
+LayoutId LayoutRegistry::find(const HallLayout& layout) const {
+    const auto range = index_.equal_range(fingerprint(layout));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (same(at(it->second), layout)) return it->second;
+    }
+    return -1;
+}
+
+LayoutId LayoutRegistry::intern(HallLayout layout) {
+    const std::uint64_t h = fingerprint(layout);
+    const auto range = index_.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (same(at(it->second), layout)) return it->second;
+    }
+    const auto id = static_cast<LayoutId>(layouts_.size());
+    layouts_.push_back(std::make_unique<const HallLayout>(std::move(layout)));
+    index_.emplace(h, id);
+    return id;
+}
+
+} // namespace booking
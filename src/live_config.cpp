@@ -0,0 +1,192 @@
+#include "live_config.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+
+#include "schedule_loader.hpp"
+
+namespace booking {
+
+namespace {
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+template <typename T>
+bool parse_int(std::string_view s, T& out) {
+    const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc() && end == s.data() + s.size();
+}
+
+/** @brief "<per second>[:<burst>]", as --client-rate; a rate <= 0 disables the limit. */
+bool parse_rate(std::string_view s, double& per_second, int& burst) {
+    const std::size_t colon = s.find(':');
+    const std::string rate(s.substr(0, colon));
+    char* end = nullptr;
+    per_second = std::strtod(rate.c_str(), &end);
+    if (rate.empty() || end != rate.c_str() + rate.size()) return false;
+    burst = 1;
+    return colon == std::string_view::npos || (parse_int(s.substr(colon + 1), burst) && burst >= 1);
+}
+
+std::int64_t mtime_ns(const std::string& path) {
+    struct stat st {};
+    if (::stat(path.c_str(), &st) != 0) return -1;
+    return static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+} // namespace
+
+const char* to_string(ConfigStatus status) {
+    switch (status) {
+        case ConfigStatus::Ok: return "Config loaded";
+        case ConfigStatus::IoError: return "Cannot read config file";
+        case ConfigStatus::ParseError: return "Malformed config line";
+    }
+    return "Unknown status";
+}
+
+ConfigError parse_tuning(std::string_view text, TuningConfig& out) {
+    std::size_t line_no = 0;
+    while (!text.empty()) {
+        const std::size_t nl = text.find('\n');
+        std::string_view line = text.substr(0, nl);
+        text = nl == std::string_view::npos ? std::string_view() : text.substr(nl + 1);
+        ++line_no;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        const auto fail = [line_no](const char* reason) {
+            return ConfigError{ConfigStatus::ParseError, line_no, reason};
+        };
+        const std::size_t eq = line.find('=');
+        if (eq == std::string_view::npos) return fail("expected key = value");
+        const std::string_view key = trim(line.substr(0, eq));
+        const std::string_view value = trim(line.substr(eq + 1));
+
+        if (key == "backoff.max_retries") {
+            if (!parse_int(value, out.backoff.max_retries)) return fail("expected a count");
+        } else if (key == "backoff.max_pause_spins") {
+            if (!parse_int(value, out.backoff.max_pause_spins)) return fail("expected a count");
+        } else if (key == "backoff.yield_after") {
+            if (!parse_int(value, out.backoff.yield_after)) return fail("expected a count");
+        } else if (key == "hold.max_ttl_ms") {
+            std::int64_t ms = 0;
+            if (!parse_int(value, ms) || ms < 0) return fail("expected milliseconds");
+            out.max_hold_ttl = std::chrono::milliseconds(ms);
+        } else if (key == "client_rate") {
+            if (!parse_rate(value, out.client_rate.per_second, out.client_rate.burst)) {
+                return fail("expected <per second>[:<burst>]");
+            }
+        } else if (key.substr(0, 10) == "admission.") {
+            std::int32_t show = 0;
+            AdmissionPolicy policy;
+            if (!parse_int(key.substr(10), show) || show < 0) return fail("expected admission.<show id>");
+            if (!parse_rate(value, policy.per_second, policy.burst)) return fail("expected <per second>[:<burst>]");
+            const auto it = std::find_if(out.admission.begin(), out.admission.end(),
+                                         [show](const auto& entry) { return entry.first == ShowId(show); });
+            if (it != out.admission.end()) {
+                it->second = policy; // the last line of a show wins
+            } else {
+                out.admission.emplace_back(ShowId(show), policy);
+            }
+        } else {
+            return fail("unknown key");
+        }
+    }
+    return {};
+}
+
+LiveConfig::LiveConfig(TuningConfig defaults) : defaults_(std::move(defaults)) {
+    published_.push_back(std::make_unique<const TuningConfig>(defaults_));
+    current_.store(published_.back().get(), std::memory_order_release);
+    version_.store(1u, std::memory_order_relaxed);
+}
+
+LiveConfig::~LiveConfig() { stop_watching(); }
+
+void LiveConfig::publish(TuningConfig config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const TuningConfig& previous = *current_.load(std::memory_order_relaxed);
+    published_.push_back(std::make_unique<const TuningConfig>(std::move(config)));
+    const TuningConfig& now = *published_.back();
+    current_.store(&now, std::memory_order_release);
+    version_.fetch_add(1u, std::memory_order_relaxed);
+    for (const auto& listener : listeners_) listener.second(previous, now);
+}
+
+ConfigError LiveConfig::reload(std::string_view text) {
+    TuningConfig config = defaults_;
+    const ConfigError error = parse_tuning(text, config);
+    if (error.status == ConfigStatus::Ok) publish(std::move(config));
+    return error;
+}
+
+ConfigError LiveConfig::reload_file(const std::string& path) {
+    const MappedFile file(path);
+    if (!file.ok()) return ConfigError{ConfigStatus::IoError, 0, "cannot open the config file"};
+    return reload(file.view());
+}
+
+ConfigError LiveConfig::watch(const std::string& path, std::chrono::milliseconds interval) {
+    stop_watching();
+    std::int64_t seen = mtime_ns(path);
+    const ConfigError first = reload_file(path);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        watch_error_ = first;
+    }
+    watcher_ = std::thread([this, path, interval, seen]() mutable {
+        std::unique_lock<std::mutex> lock(watch_mutex_);
+        while (!watch_cv_.wait_for(lock, interval, [this] { return watch_stop_; })) {
+            const std::int64_t mtime = mtime_ns(path);
+            if (mtime == seen) continue;
+            seen = mtime;
+            lock.unlock();
+            const ConfigError error = reload_file(path); // a bad edit keeps the last good snapshot
+            {
+                std::lock_guard<std::mutex> guard(mutex_);
+                watch_error_ = error;
+            }
+            lock.lock();
+        }
+    });
+    return first;
+}
+
+void LiveConfig::stop_watching() {
+    if (!watcher_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(watch_mutex_);
+        watch_stop_ = true;
+    }
+    watch_cv_.notify_all();
+    watcher_.join();
+    watch_stop_ = false;
+}
+
+ConfigError LiveConfig::last_watch_error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return watch_error_;
+}
+
+std::uint64_t LiveConfig::subscribe(Listener listener) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listeners_.emplace_back(next_listener_, std::move(listener));
+    return next_listener_++;
+}
+
+void LiveConfig::unsubscribe(std::uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listeners_.erase(std::remove_if(listeners_.begin(), listeners_.end(),
+                                    [id](const auto& listener) { return listener.first == id; }),
+                     listeners_.end());
+}
+
+} // namespace booking
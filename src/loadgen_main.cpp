@@ -0,0 +1,356 @@
+#include "booking_history.hpp"
+#include "booking_service.hpp"
+#include "latency_histogram.hpp"
+#include "profiler.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Load generator: replays a synthetic traffic mix against an in-process BookingService and
+// reports throughput and latency percentiles per operation.
+//
+//   booking_loadgen [--threads=N] [--seconds=S] [--shows=N] [--rows=R] [--seats=S]
+//                   [--zipf=EXP] [--read-ratio=F] [--best-ratio=F] [--cancel-ratio=F]
+//                   [--burst-every-ms=MS] [--burst-ms=MS] [--burst-share=F] [--seed=N]
+//                   [--owners=N] [--check-history=1] [--trace=FILE] [--profile=FILE]
+//
+// --check-history records every booking and cancellation and checks afterwards that the
+// history is linearizable (booking_history.hpp); the exit status is 1 on a violation.
+// --trace writes the stage events of the run's last requests (trace.hpp) to FILE as
+// Chrome trace JSON, for chrome://tracing or ui.perfetto.dev. --profile samples the run's
+// CPU time by API call and show (profiler.hpp) and writes folded stacks to FILE, for
+// flamegraph.pl or speedscope.
+
+namespace {
+
+using booking::BookingService;
+using booking::LatencyHistogram;
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    double seconds = 5.0;
+    int shows = 2000;
+    int rows = 16;
+    int seats = 24;
+    double zipf = 1.1;          // show popularity exponent (0 = uniform)
+    double read_ratio = 0.8;    // seat-map reads among all operations
+    double best_ratio = 0.5;    // best-available among bookings (the rest pick explicit seats)
+    double cancel_ratio = 0.3;  // chance that a write cancels an earlier booking instead
+    int burst_every_ms = 0;     // premiere bursts: period (0 = none)
+    int burst_ms = 250;         // ... and length
+    double burst_share = 0.8;   // share of writes that hit the premiere (show 0) during a burst
+    std::uint64_t seed = 42;
+    int owners = -1;            // OwnerThreads execution mode with N owner threads (-1 = shared, 0 = per core)
+    bool check_history = false; // record the writes and check them for linearizability
+    std::string trace;          // Chrome trace output file (empty = no tracing)
+    std::string profile;        // folded-stack CPU profile output file (empty = no profiling)
+};
+
+enum Op { kList, kCount, kBook, kBest, kCancel, kOps };
+const char* const kOpNames[kOps] = {"list_seats", "available_count", "book_seats", "best_available", "cancel"};
+
+struct ThreadStats {
+    LatencyHistogram latency[kOps];
+    std::uint64_t ok[kOps] = {};
+    std::uint64_t conflicts = 0;      // AlreadyBooked / NoContiguousSeats
+    std::uint64_t contended = 0;
+};
+
+bool parse_option(const char* arg, Options& o) {
+    const char* eq = std::strchr(arg, '=');
+    if (std::strncmp(arg, "--", 2) != 0 || !eq) return false;
+    const std::string key(arg + 2, eq);
+    const char* v = eq + 1;
+    if (key == "threads") o.threads = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+    else if (key == "seconds") o.seconds = std::strtod(v, nullptr);
+    else if (key == "shows") o.shows = std::atoi(v);
+    else if (key == "rows") o.rows = std::atoi(v);
+    else if (key == "seats") o.seats = std::atoi(v);
+    else if (key == "zipf") o.zipf = std::strtod(v, nullptr);
+    else if (key == "read-ratio") o.read_ratio = std::strtod(v, nullptr);
+    else if (key == "best-ratio") o.best_ratio = std::strtod(v, nullptr);
+    else if (key == "cancel-ratio") o.cancel_ratio = std::strtod(v, nullptr);
+    else if (key == "burst-every-ms") o.burst_every_ms = std::atoi(v);
+    else if (key == "burst-ms") o.burst_ms = std::atoi(v);
+    else if (key == "burst-share") o.burst_share = std::strtod(v, nullptr);
+    else if (key == "seed") o.seed = std::strtoull(v, nullptr, 10);
+    else if (key == "owners") o.owners = std::atoi(v);
+    else if (key == "check-history") o.check_history = std::atoi(v) != 0;
+    else if (key == "trace") o.trace = v;
+    else if (key == "profile") o.profile = v;
+    else return false;
+    return true;
+}
+
+bool valid(const Options& o) {
+    return o.threads >= 1 && o.seconds > 0 && o.shows >= 1 && o.shows < booking::ShowTable<int>::kMaxId
+           && o.rows >= 1 && o.rows <= booking::HallLayout::kMaxRows && o.seats >= 1
+           && o.seats <= booking::HallLayout::kMaxRowSeats && o.zipf >= 0;
+}
+
+/** @brief Zipf(s) sampler over ranks 0..n-1 by inverse CDF lookup. */
+class Zipf {
+public:
+    Zipf(int n, double s) : cdf_(static_cast<std::size_t>(n)) {
+        double total = 0.0;
+        for (int k = 0; k < n; ++k) total += 1.0 / std::pow(k + 1.0, s);
+        double acc = 0.0;
+        for (int k = 0; k < n; ++k) {
+            acc += 1.0 / std::pow(k + 1.0, s) / total;
+            cdf_[static_cast<std::size_t>(k)] = acc;
+        }
+        cdf_.back() = 1.0;
+    }
+
+    int operator()(double u) const {
+        return static_cast<int>(std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin());
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+/** @brief Party size: mostly couples, some singles and small groups, few large ones. */
+int group_size(double u) {
+    if (u < 0.15) return 1;
+    if (u < 0.55) return 2;
+    if (u < 0.70) return 3;
+    if (u < 0.90) return 4;
+    return 5 + static_cast<int>((u - 0.90) * 40.0); // 5..8
+}
+
+struct Booking {
+    booking::ShowId show;
+    booking::BookingId id;
+    booking::SeatMask seats;
+};
+
+void worker(BookingService& svc, const Options& o, const Zipf& zipf, unsigned index, Clock::time_point start,
+            const std::atomic<bool>& stop, ThreadStats& stats, booking::HistoryRecorder* history) {
+    std::mt19937_64 rng(o.seed * 1000003u + index);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<Booking> mine; // this thread's live bookings, cancelled at random
+    std::vector<std::string> labels;
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        const Clock::time_point t0 = Clock::now();
+        bool burst = false;
+        if (o.burst_every_ms > 0) {
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t0 - start).count();
+            burst = ms % o.burst_every_ms < o.burst_ms;
+        }
+        booking::ShowId show = zipf(uniform(rng));
+        Op op;
+        if (uniform(rng) < o.read_ratio) {
+            op = uniform(rng) < 0.5 ? kList : kCount;
+        } else {
+            if (burst && uniform(rng) < o.burst_share) show = 0;
+            if (!mine.empty() && uniform(rng) < o.cancel_ratio) op = kCancel;
+            else op = uniform(rng) < o.best_ratio ? kBest : kBook;
+        }
+
+        bool ok = false;
+        booking::BookingResult r;
+        const std::uint64_t invoked = history ? history->now() : 0u;
+        switch (op) {
+            case kList: ok = !svc.list_available_seats(show).empty(); break;
+            case kCount: ok = svc.available_count(show) > 0; break;
+            case kBest: {
+                Booking b{show, 0, {}};
+                r = svc.book_best_available(show, group_size(uniform(rng)), b.seats);
+                if (history) history->record(index, booking::HistoryOp::Book, show, b.seats, 0, invoked, r);
+                if (r.success) {
+                    b.id = static_cast<booking::BookingId>(r.id);
+                    mine.push_back(b);
+                }
+                break;
+            }
+            case kBook: {
+                // Adjacent seats at a random spot, as picked from a seat map
+                const int n = std::min(group_size(uniform(rng)), o.seats);
+                const int row = static_cast<int>(uniform(rng) * o.rows);
+                const int col = static_cast<int>(uniform(rng) * (o.seats - n + 1));
+                labels.clear();
+                for (int c = col; c < col + n; ++c) {
+                    labels.push_back(booking::HallLayout::row_label_for(row) + std::to_string(c + 1));
+                }
+                r = svc.book_seats(show, labels);
+                Booking b{show, static_cast<booking::BookingId>(r.id), {}};
+                for (int c = col; c < col + n; ++c) b.seats.set(booking::HallLayout::seat_index(row, c));
+                if (history) history->record(index, booking::HistoryOp::Book, show, b.seats, 0, invoked, r);
+                if (r.success) mine.push_back(b);
+                break;
+            }
+            case kCancel: {
+                const std::size_t pick = static_cast<std::size_t>(uniform(rng) * static_cast<double>(mine.size()));
+                std::swap(mine[pick], mine.back());
+                r = svc.cancel_seat_mask(mine.back().show, mine.back().seats, mine.back().id);
+                if (history) {
+                    history->record(index, booking::HistoryOp::Cancel, mine.back().show, mine.back().seats,
+                                    mine.back().id, invoked, r);
+                }
+                mine.pop_back();
+                break;
+            }
+            default: break;
+        }
+        if (op >= kBook) {
+            ok = r.success;
+            if (r.status == booking::BookingStatus::AlreadyBooked || r.status == booking::BookingStatus::NoContiguousSeats) {
+                ++stats.conflicts;
+            } else if (r.status == booking::BookingStatus::Contended) {
+                ++stats.contended;
+            }
+        }
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+        stats.latency[op].record(static_cast<std::uint64_t>(ns));
+        stats.ok[op] += ok ? 1u : 0u;
+    }
+}
+
+double us(std::uint64_t ns) {
+    return static_cast<double>(ns) / 1000.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        if (!parse_option(argv[i], o)) {
+            std::cerr << "unknown option " << argv[i] << "\n"
+                      << "usage: booking_loadgen [--threads=N] [--seconds=S] [--shows=N] [--rows=R] [--seats=S]\n"
+                      << "       [--zipf=EXP] [--read-ratio=F] [--best-ratio=F] [--cancel-ratio=F]\n"
+                      << "       [--burst-every-ms=MS] [--burst-ms=MS] [--burst-share=F] [--seed=N]\n"
+                      << "       [--owners=N] [--check-history=1] [--trace=FILE] [--profile=FILE]\n";
+            return 2;
+        }
+    }
+    if (!valid(o)) {
+        std::cerr << "invalid option value\n";
+        return 2;
+    }
+
+    BookingService svc{BookingService::EmptyCatalog{}};
+    booking::Schedule schedule;
+    schedule.movies.push_back(booking::ScheduleMovie{1, "Premiere"});
+    schedule.theaters.push_back(booking::ScheduleTheater{1, "Multiplex"});
+    schedule.layouts.push_back(booking::ScheduleLayout{0, booking::HallLayout::uniform(o.rows, o.seats)});
+    for (int s = 0; s < o.shows; ++s) schedule.shows.push_back(booking::ScheduleShow{s, 1, 1, 0});
+    svc.load_schedule(std::move(schedule));
+    if (o.owners >= 0) svc.set_execution_mode(booking::ExecutionMode::OwnerThreads, static_cast<unsigned>(o.owners));
+
+    const Zipf zipf(o.shows, o.zipf);
+    std::vector<ThreadStats> stats(o.threads);
+    std::vector<std::thread> threads;
+    std::atomic<bool> stop{false};
+    std::unique_ptr<booking::HistoryRecorder> history;
+    if (o.check_history) history = std::make_unique<booking::HistoryRecorder>(o.threads);
+    if (!o.trace.empty()) booking::trace_start();
+    if (!o.profile.empty() && !booking::profile_start()) {
+        std::fprintf(stderr, "cannot start the profiler\n");
+        return 1;
+    }
+    const Clock::time_point start = Clock::now();
+    for (unsigned t = 0; t < o.threads; ++t) {
+        threads.emplace_back(worker, std::ref(svc), std::cref(o), std::cref(zipf), t, start, std::cref(stop),
+                             std::ref(stats[t]), history.get());
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(o.seconds));
+    stop.store(true);
+    for (auto& t : threads) t.join();
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    booking::trace_stop();
+    booking::profile_stop();
+
+    ThreadStats total;
+    for (const ThreadStats& s : stats) {
+        for (int op = 0; op < kOps; ++op) {
+            total.latency[op].merge(s.latency[op]);
+            total.ok[op] += s.ok[op];
+        }
+        total.conflicts += s.conflicts;
+        total.contended += s.contended;
+    }
+
+    std::printf("threads=%u seconds=%.1f shows=%d hall=%dx%d zipf=%.2f read=%.2f best=%.2f cancel=%.2f burst=%d/%dms@%.2f mode=%s\n",
+                o.threads, elapsed, o.shows, o.rows, o.seats, o.zipf, o.read_ratio, o.best_ratio, o.cancel_ratio,
+                o.burst_every_ms, o.burst_ms, o.burst_share, booking::to_string(svc.execution_mode()));
+    std::printf("%-16s %12s %7s %12s %9s %9s %9s %9s\n", "op", "count", "ok%", "ops/s", "p50us", "p99us", "p999us",
+                "maxus");
+    std::uint64_t all = 0;
+    LatencyHistogram writes;
+    for (int op = 0; op < kOps; ++op) {
+        const LatencyHistogram& h = total.latency[op];
+        all += h.count();
+        if (op >= kBook) writes.merge(h);
+        std::printf("%-16s %12llu %7.1f %12.0f %9.2f %9.2f %9.2f %9.2f\n", kOpNames[op],
+                    static_cast<unsigned long long>(h.count()),
+                    h.count() ? 100.0 * static_cast<double>(total.ok[op]) / static_cast<double>(h.count()) : 0.0,
+                    static_cast<double>(h.count()) / elapsed, us(h.percentile(0.5)), us(h.percentile(0.99)),
+                    us(h.percentile(0.999)), us(h.max()));
+    }
+    std::printf("%-16s %12llu %7s %12.0f %9.2f %9.2f %9.2f %9.2f\n", "writes", static_cast<unsigned long long>(writes.count()),
+                "", static_cast<double>(writes.count()) / elapsed, us(writes.percentile(0.5)), us(writes.percentile(0.99)),
+                us(writes.percentile(0.999)), us(writes.max()));
+    std::printf("total ops/s %.0f  conflicts %llu  contended %llu\n", static_cast<double>(all) / elapsed,
+                static_cast<unsigned long long>(total.conflicts), static_cast<unsigned long long>(total.contended));
+
+    if (!o.trace.empty()) {
+        const std::vector<booking::TraceEvent> events = booking::trace_collect();
+        std::ofstream out(o.trace);
+        booking::write_chrome_trace(out, events);
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", o.trace.c_str());
+            return 1;
+        }
+        std::printf("trace %zu events -> %s\n", events.size(), o.trace.c_str());
+    }
+
+    if (!o.profile.empty()) {
+        const std::vector<booking::ProfileSample> samples = booking::profile_collect();
+        std::ofstream out(o.profile);
+        booking::write_folded_profile(out, samples);
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", o.profile.c_str());
+            return 1;
+        }
+        std::printf("profile %zu tags -> %s\n", samples.size(), o.profile.c_str());
+    }
+
+    if (history) {
+        const booking::History recorded = history->take();
+        const auto t0 = Clock::now();
+        const booking::LinearizabilityReport report = booking::check_linearizable(recorded);
+        const double check_s = std::chrono::duration<double>(Clock::now() - t0).count();
+        std::printf("history %zu events  checked %zu  segments %zu  largest %zu  steps %llu  %.2fs: %s\n",
+                    recorded.events.size(), report.checked, report.groups, report.largest,
+                    static_cast<unsigned long long>(report.steps), check_s, booking::to_string(report.verdict));
+        if (report.verdict == booking::LinearizabilityVerdict::Violation) {
+            std::printf("violation on show %lld:\n", static_cast<long long>(report.show_id.value()));
+            for (const std::size_t i : report.witness) {
+                const booking::HistoryEvent& e = recorded.events[i];
+                std::printf("  t%u %s [%llu, %llu] arg=%llu -> %s id=%llu\n", e.thread, booking::to_string(e.op),
+                            static_cast<unsigned long long>(e.invoked), static_cast<unsigned long long>(e.completed),
+                            static_cast<unsigned long long>(e.arg), booking::to_string(e.status),
+                            static_cast<unsigned long long>(e.id));
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
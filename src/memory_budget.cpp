@@ -0,0 +1,89 @@
+#include "memory_budget.hpp"
+
+#include <fstream>
+#include <string>
+
+namespace booking {
+
+const char* to_string(MemorySubsystem subsystem) {
+    switch (subsystem) {
+        case MemorySubsystem::Catalog: return "catalog";
+        case MemorySubsystem::States: return "states";
+        case MemorySubsystem::Indexes: return "indexes";
+        case MemorySubsystem::Holds: return "holds";
+        case MemorySubsystem::Caches: return "caches";
+        case MemorySubsystem::Buffers: return "buffers";
+    }
+    return "unknown";
+}
+
+void MemoryAccounts::charge(MemorySubsystem s, std::size_t bytes) {
+    Counter& c = counter(s);
+    raise_peak(c, c.live.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+bool MemoryAccounts::try_charge(MemorySubsystem s, std::size_t bytes) {
+    Counter& c = counter(s);
+    const std::size_t budget = c.budget.load(std::memory_order_relaxed);
+    std::size_t live = c.live.load(std::memory_order_relaxed);
+    do {
+        if (budget != 0u && live + bytes > budget) return false;
+    } while (!c.live.compare_exchange_weak(live, live + bytes, std::memory_order_relaxed));
+    raise_peak(c, live + bytes);
+    return true;
+}
+
+void MemoryAccounts::release(MemorySubsystem s, std::size_t bytes) {
+    counter(s).live.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void MemoryAccounts::set(MemorySubsystem s, std::size_t bytes) {
+    Counter& c = counter(s);
+    c.live.store(bytes, std::memory_order_relaxed);
+    raise_peak(c, bytes);
+}
+
+std::size_t MemoryAccounts::total() const {
+    std::size_t sum = 0;
+    for (const Counter& c : counters_) sum += c.live.load(std::memory_order_relaxed);
+    return sum;
+}
+
+MemoryUsage MemoryAccounts::usage() const {
+    MemoryUsage u;
+    for (std::size_t i = 0; i < counters_.size(); ++i) {
+        u.live[i] = counters_[i].live.load(std::memory_order_relaxed);
+        u.peak[i] = counters_[i].peak.load(std::memory_order_relaxed);
+        u.budget[i] = counters_[i].budget.load(std::memory_order_relaxed);
+        u.total += u.live[i];
+    }
+    u.total_budget = total_budget();
+    return u;
+}
+
+void MemoryAccounts::raise_peak(Counter& c, std::size_t live) {
+    std::size_t peak = c.peak.load(std::memory_order_relaxed);
+    while (live > peak && !c.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+namespace {
+
+/** @brief First number in @p path, or 0 if the file is missing or says "max". */
+std::size_t read_limit(const char* path) {
+    std::ifstream in(path);
+    std::string text;
+    if (!(in >> text) || text.empty() || text[0] < '0' || text[0] > '9' || text.size() > 19) return 0;
+    const unsigned long long value = std::stoull(text);
+    // cgroup v1 reports "no limit" as the largest page-aligned 63-bit value
+    return value >= (1ull << 60) ? 0u : static_cast<std::size_t>(value);
+}
+
+} // namespace
+
+std::size_t cgroup_memory_limit() {
+    if (const std::size_t v2 = read_limit("/sys/fs/cgroup/memory.max")) return v2;
+    return read_limit("/sys/fs/cgroup/memory/memory.limit_in_bytes");
+}
+
+} // namespace booking
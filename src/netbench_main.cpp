@@ -0,0 +1,551 @@
+#include "hall_layout.hpp"
+#include "latency_histogram.hpp"
+#include "seat_mask.hpp"
+#include "span.hpp"
+#include "wire_protocol.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// End-to-end benchmark: drives booking_server over TCP from a multi-connection client and
+// reports throughput and latency percentiles for every protocol, workload and connection
+// count of a sweep, so server-level features (batching, io_uring, busy polling) are
+// compared with the protocol, syscalls and queueing included.
+//
+//   booking_netbench [--server=PATH] [--server-args="ARGS"] [--target=HOST:PORT]
+//                    [--protocols=text,wire,http] [--workloads=seats,count,book]
+//                    [--connections=1,4,16,64] [--pipeline=N] [--threads=N]
+//                    [--seconds=S] [--warmup=S] [--seed=N] [--csv=FILE] [--write-schedule=FILE]
+//
+// By default it writes a schedule (8 movies x 8 theaters, one 16x32 hall each) to a
+// temporary file, starts the booking_server next to it (or --server) on a free loopback
+// port with that schedule and --server-args (e.g. "--backend=epoll --busy-poll=50"), and
+// stops it at the end. To measure across real NICs, start booking_server on another host
+// with the schedule written by --write-schedule=FILE and pass --target.
+//
+// Workloads: seats reads a random show's seat map (text "seats", wire AvailableSeats as a
+// bitmap, GET .../seats); count reads its free count (wire AvailableCount only); book books
+// a random seat and cancels it again, so halls never sell out (text and wire; HTTP has no
+// cancel, so an HTTP book run sells the halls out and its ok% drops accordingly).
+// Each connection keeps --pipeline requests in flight; latency runs from queueing a request
+// to reading its whole response, and only requests sent after --warmup count. The exit
+// status is 1 if a run got no responses.
+
+namespace {
+
+using booking::LatencyHistogram;
+using Clock = std::chrono::steady_clock;
+
+constexpr int kMovies = 8;
+constexpr int kTheaters = 8;
+constexpr int kRows = 16;
+constexpr int kSeats = 32;
+
+enum class Protocol { Text, Wire, Http };
+enum class Workload { Seats, Count, Book };
+
+const char* name(Protocol p) { return p == Protocol::Text ? "text" : p == Protocol::Wire ? "wire" : "http"; }
+const char* name(Workload w) { return w == Workload::Seats ? "seats" : w == Workload::Count ? "count" : "book"; }
+
+struct Options {
+    std::string server;      // booking_server binary (default: next to this one)
+    std::string server_args; // extra arguments for it, space separated
+    std::string target;      // HOST:PORT of a running server (no launch)
+    std::vector<Protocol> protocols{Protocol::Text, Protocol::Wire, Protocol::Http};
+    std::vector<Workload> workloads{Workload::Seats, Workload::Count, Workload::Book};
+    std::vector<int> connections{1, 4, 16, 64};
+    int pipeline = 1;        // requests in flight per connection
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency() / 2); // client threads (<= connections)
+    double seconds = 2.0;
+    double warmup = 0.2;
+    std::uint64_t seed = 42;
+    std::string csv;
+    std::string write_schedule;
+};
+
+bool split_list(const char* v, std::vector<std::string>& out) {
+    out.clear();
+    for (const char* p = v; *p;) {
+        const char* comma = std::strchr(p, ',');
+        const std::size_t n = comma ? static_cast<std::size_t>(comma - p) : std::strlen(p);
+        if (n == 0) return false;
+        out.emplace_back(p, n);
+        p += n + (comma ? 1 : 0);
+    }
+    return !out.empty();
+}
+
+bool parse_option(const char* arg, Options& o) {
+    const char* eq = std::strchr(arg, '=');
+    if (std::strncmp(arg, "--", 2) != 0 || !eq) return false;
+    const std::string key(arg + 2, eq);
+    const char* v = eq + 1;
+    std::vector<std::string> items;
+    if (key == "server") o.server = v;
+    else if (key == "server-args") o.server_args = v;
+    else if (key == "target" && std::strchr(v, ':')) o.target = v;
+    else if (key == "pipeline") o.pipeline = std::max(1, std::atoi(v));
+    else if (key == "threads") o.threads = std::max(1u, static_cast<unsigned>(std::strtoul(v, nullptr, 10)));
+    else if (key == "seconds") o.seconds = std::strtod(v, nullptr);
+    else if (key == "warmup") o.warmup = std::strtod(v, nullptr);
+    else if (key == "seed") o.seed = std::strtoull(v, nullptr, 10);
+    else if (key == "csv") o.csv = v;
+    else if (key == "write-schedule") o.write_schedule = v;
+    else if (key == "protocols" && split_list(v, items)) {
+        o.protocols.clear();
+        for (const std::string& p : items) {
+            if (p == "text") o.protocols.push_back(Protocol::Text);
+            else if (p == "wire") o.protocols.push_back(Protocol::Wire);
+            else if (p == "http") o.protocols.push_back(Protocol::Http);
+            else return false;
+        }
+    }
+    else if (key == "workloads" && split_list(v, items)) {
+        o.workloads.clear();
+        for (const std::string& w : items) {
+            if (w == "seats") o.workloads.push_back(Workload::Seats);
+            else if (w == "count") o.workloads.push_back(Workload::Count);
+            else if (w == "book") o.workloads.push_back(Workload::Book);
+            else return false;
+        }
+    }
+    else if (key == "connections" && split_list(v, items)) {
+        o.connections.clear();
+        for (const std::string& c : items) o.connections.push_back(std::max(1, std::atoi(c.c_str())));
+    }
+    else return false;
+    return true;
+}
+
+int show_id_of(int movie, int theater) { return (movie - 1) * kTheaters + (theater - 1); }
+
+bool supported(Protocol p, Workload w) { return w != Workload::Count || p == Protocol::Wire; }
+
+bool write_schedule(const std::string& path) {
+    std::ofstream out(path);
+    for (int m = 1; m <= kMovies; ++m) out << "movie," << m << ",Movie " << m << "\n";
+    for (int t = 1; t <= kTheaters; ++t) out << "theater," << t << ",Theater " << t << "\n";
+    out << "layout,0," << kRows << "x" << kSeats << "\n";
+    for (int m = 1; m <= kMovies; ++m) {
+        for (int t = 1; t <= kTheaters; ++t) out << "show," << show_id_of(m, t) << "," << m << "," << t << ",0\n";
+    }
+    return static_cast<bool>(out);
+}
+
+/** @brief booking_server started for the run; stopped (SIGTERM) by @ref stop. */
+struct Server {
+    pid_t pid = -1;
+    FILE* out = nullptr; // its stdout
+
+    bool start(const Options& o, const std::string& schedule, std::string& host, int& port) {
+        std::vector<std::string> args{o.server, "--host=127.0.0.1", "--port=0", "--schedule=" + schedule};
+        for (const char* p = o.server_args.c_str(); *p;) {
+            const std::size_t n = std::strcspn(p, " ");
+            if (n > 0) args.emplace_back(p, n);
+            p += n + (p[n] ? 1 : 0);
+        }
+        int fds[2];
+        if (::pipe(fds) != 0) return false;
+        pid = ::fork();
+        if (pid < 0) return false;
+        if (pid == 0) {
+            ::dup2(fds[1], STDOUT_FILENO);
+            ::close(fds[0]);
+            ::close(fds[1]);
+            std::vector<char*> argv;
+            for (std::string& a : args) argv.push_back(a.data());
+            argv.push_back(nullptr);
+            ::execv(argv[0], argv.data());
+            std::perror(argv[0]);
+            ::_exit(127);
+        }
+        ::close(fds[1]);
+        out = ::fdopen(fds[0], "r");
+        char line[256];
+        unsigned bound = 0;
+        while (std::fgets(line, sizeof(line), out)) {
+            if (std::sscanf(line, "listening on 127.0.0.1:%u", &bound) == 1) {
+                host = "127.0.0.1";
+                port = static_cast<int>(bound);
+                return true;
+            }
+        }
+        return false; // exited before listening (its error went to stderr)
+    }
+
+    void stop() {
+        if (pid > 0) {
+            ::kill(pid, SIGTERM);
+            char line[256];
+            while (out && std::fgets(line, sizeof(line), out)) {} // its exit report
+            ::waitpid(pid, nullptr, 0);
+        }
+        if (out) std::fclose(out);
+    }
+};
+
+int connect_to(const std::string& host, int port) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<std::uint16_t>(port));
+    if (::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1
+        || ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+/** @brief One request in flight. */
+struct Pending {
+    Clock::time_point sent;
+    int movie = 0;
+    int theater = 0;
+    int seat = -1; // book: the seat index (a cancel follows a successful one)
+    bool cancel = false;
+};
+
+struct Connection {
+    int fd = -1;
+    std::string out;
+    std::size_t out_pos = 0;
+    std::string in;
+    std::size_t in_pos = 0;
+    std::deque<Pending> pending;
+    std::vector<std::pair<Pending, std::uint64_t>> cancels; // bookings to cancel next, with their ids
+};
+
+struct RunStats {
+    LatencyHistogram latency;
+    std::uint64_t ok = 0;
+    std::uint64_t errors = 0; // transport failures
+};
+
+std::string label_of(int seat) {
+    return std::string(1, static_cast<char>('a' + seat / kSeats)) + std::to_string(seat % kSeats + 1);
+}
+
+/** @brief Appends the request for @p p to @p c's output. */
+void queue(Protocol proto, Workload work, Connection& c, const Pending& p, std::uint64_t booking_id) {
+    const booking::ShowId show(show_id_of(p.movie, p.theater));
+    const std::string mt = std::to_string(p.movie) + " " + std::to_string(p.theater);
+    const std::string path = "/shows/" + std::to_string(p.movie) + "/" + std::to_string(p.theater);
+    switch (proto) {
+        case Protocol::Text:
+            if (work == Workload::Seats) c.out += "seats " + mt + "\n";
+            else if (!p.cancel) c.out += "book " + mt + " " + label_of(p.seat) + "\n";
+            else c.out += "cancel " + mt + " " + std::to_string(booking_id) + " " + label_of(p.seat) + "\n";
+            break;
+        case Protocol::Wire:
+            if (work == Workload::Seats) {
+                booking::encode_request(c.out, booking::WireOp::AvailableSeats, show, 0,
+                                        static_cast<std::uint16_t>(booking::SeatEncoding::Bitmap));
+            } else if (work == Workload::Count) {
+                booking::encode_request(c.out, booking::WireOp::AvailableCount, show, 0);
+            } else if (p.cancel) {
+                booking::SeatMask seats;
+                seats.set(booking::HallLayout::seat_index(p.seat / kSeats, p.seat % kSeats));
+                booking::encode_mask_request(c.out, booking::WireOp::CancelMask, show, 0, seats, booking_id);
+            } else {
+                const int index = booking::HallLayout::seat_index(p.seat / kSeats, p.seat % kSeats);
+                booking::encode_indices_request(c.out, show, 0, booking::Span<const int>(&index, 1));
+            }
+            break;
+        case Protocol::Http:
+            if (work == Workload::Seats) {
+                c.out += "GET " + path + "/seats HTTP/1.1\r\nHost: bench\r\n\r\n";
+            } else {
+                const std::string body = label_of(p.seat);
+                c.out += "POST " + path + "/book HTTP/1.1\r\nHost: bench\r\nContent-Length: "
+                         + std::to_string(body.size()) + "\r\n\r\n" + body;
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Parses one complete response at @p c's input position.
+ * @return Bytes it spans (0 = incomplete, -1 = malformed); @p ok and @p id describe it.
+ */
+std::ptrdiff_t parse_response(Protocol proto, const Connection& c, bool& ok, std::uint64_t& id) {
+    const char* data = c.in.data() + c.in_pos;
+    const std::size_t size = c.in.size() - c.in_pos;
+    switch (proto) {
+        case Protocol::Text: {
+            // Data lines, then one status line starting with OK or ERR
+            for (std::size_t pos = 0; pos < size;) {
+                const char* nl = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+                if (!nl) return 0;
+                const std::size_t end = static_cast<std::size_t>(nl - data) + 1u;
+                if (std::strncmp(data + pos, "OK", 2) == 0 || std::strncmp(data + pos, "ERR", 3) == 0) {
+                    ok = data[pos] == 'O';
+                    id = ok ? std::strtoull(data + pos + 2, nullptr, 10) : 0;
+                    return static_cast<std::ptrdiff_t>(end);
+                }
+                pos = end;
+            }
+            return 0;
+        }
+        case Protocol::Wire: {
+            booking::WireResponse r;
+            if (size < booking::kWireResponseSize) return 0;
+            if (!booking::decode_response(data, size, r)) return -1;
+            std::size_t span = booking::kWireResponseSize;
+            if (r.op == booking::WireOp::AvailableSeats && r.status == booking::BookingStatus::Ok && r.value > 0) {
+                span += static_cast<std::size_t>(r.value);
+            }
+            if (size < span) return 0;
+            ok = r.status == booking::BookingStatus::Ok;
+            id = r.id;
+            return static_cast<std::ptrdiff_t>(span);
+        }
+        case Protocol::Http: {
+            const std::string_view head(data, size);
+            const std::size_t head_end = head.find("\r\n\r\n");
+            if (head_end == std::string_view::npos) return 0;
+            const std::size_t cl = head.substr(0, head_end).find("Content-Length: ");
+            if (cl == std::string_view::npos || head.substr(0, 9) != "HTTP/1.1 ") return -1;
+            const std::size_t body_size = std::strtoull(data + cl + 16, nullptr, 10);
+            const std::size_t span = head_end + 4u + body_size;
+            if (size < span) return 0;
+            ok = data[9] == '2';
+            const std::size_t at = head.substr(head_end, body_size + 4u).find("\"booking_id\":");
+            id = at == std::string_view::npos ? 0 : std::strtoull(data + head_end + at + 13, nullptr, 10);
+            return static_cast<std::ptrdiff_t>(span);
+        }
+    }
+    return -1;
+}
+
+/** @brief Closed loop over @p conns until @p stop; records requests sent from @p measure_from on. */
+void drive(Protocol proto, Workload work, std::vector<Connection>& conns, int pipeline, Clock::time_point measure_from,
+           Clock::time_point stop, std::uint64_t seed, RunStats& stats) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> movie(1, kMovies);
+    std::uniform_int_distribution<int> theater(1, kTheaters);
+    std::uniform_int_distribution<int> seat(0, kRows * kSeats - 1);
+    const auto next = [&](Connection& c) {
+        Pending p;
+        std::uint64_t booking_id = 0;
+        if (!c.cancels.empty()) {
+            p = c.cancels.back().first;
+            booking_id = c.cancels.back().second;
+            c.cancels.pop_back();
+            p.cancel = true;
+        } else {
+            p.movie = movie(rng);
+            p.theater = theater(rng);
+            if (work == Workload::Book) p.seat = seat(rng);
+        }
+        p.sent = Clock::now();
+        queue(proto, work, c, p, booking_id);
+        c.pending.push_back(p);
+    };
+
+    std::vector<pollfd> fds(conns.size());
+    std::vector<char> buf(64 * 1024);
+    while (Clock::now() < stop) {
+        for (std::size_t i = 0; i < conns.size(); ++i) {
+            Connection& c = conns[i];
+            while (c.fd >= 0 && static_cast<int>(c.pending.size()) < pipeline) next(c);
+            if (c.fd >= 0 && c.out_pos < c.out.size()) {
+                const ssize_t sent = ::send(c.fd, c.out.data() + c.out_pos, c.out.size() - c.out_pos, MSG_NOSIGNAL);
+                if (sent > 0) c.out_pos += static_cast<std::size_t>(sent);
+                if (c.out_pos == c.out.size()) {
+                    c.out.clear();
+                    c.out_pos = 0;
+                }
+            }
+            fds[i] = pollfd{c.fd, static_cast<short>(POLLIN | (c.out.empty() ? 0 : POLLOUT)), 0};
+        }
+        if (::poll(fds.data(), fds.size(), 50) <= 0) continue;
+        for (std::size_t i = 0; i < conns.size(); ++i) {
+            Connection& c = conns[i];
+            if (c.fd < 0 || !(fds[i].revents & (POLLIN | POLLERR | POLLHUP))) continue;
+            const ssize_t got = ::recv(c.fd, buf.data(), buf.size(), 0);
+            if (got <= 0) {
+                ++stats.errors;
+                ::close(c.fd);
+                c.fd = -1;
+                continue;
+            }
+            c.in.append(buf.data(), static_cast<std::size_t>(got));
+            const Clock::time_point now = Clock::now();
+            while (!c.pending.empty()) {
+                bool ok = false;
+                std::uint64_t id = 0;
+                const std::ptrdiff_t used = parse_response(proto, c, ok, id);
+                if (used == 0) break;
+                if (used < 0) {
+                    ++stats.errors;
+                    ::close(c.fd);
+                    c.fd = -1;
+                    break;
+                }
+                c.in_pos += static_cast<std::size_t>(used);
+                const Pending p = c.pending.front();
+                c.pending.pop_front();
+                if (p.sent >= measure_from) {
+                    stats.latency.record(static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(now - p.sent).count()));
+                    stats.ok += ok ? 1u : 0u;
+                }
+                if (ok && work == Workload::Book && !p.cancel && proto != Protocol::Http) c.cancels.emplace_back(p, id);
+            }
+            if (c.in_pos == c.in.size()) {
+                c.in.clear();
+                c.in_pos = 0;
+            }
+        }
+    }
+}
+
+double us(std::uint64_t ns) { return static_cast<double>(ns) / 1000.0; }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        if (!parse_option(argv[i], o)) {
+            std::fprintf(stderr,
+                         "unknown option %s\n"
+                         "usage: booking_netbench [--server=PATH] [--server-args=\"ARGS\"] [--target=HOST:PORT]\n"
+                         "                        [--protocols=text,wire,http] [--workloads=seats,count,book]\n"
+                         "                        [--connections=1,4,16,64] [--pipeline=N] [--threads=N]\n"
+                         "                        [--seconds=S] [--warmup=S] [--seed=N] [--csv=FILE]\n"
+                         "                        [--write-schedule=FILE]\n",
+                         argv[i]);
+            return 2;
+        }
+    }
+    if (!o.write_schedule.empty()) {
+        if (!write_schedule(o.write_schedule)) {
+            std::fprintf(stderr, "cannot write %s\n", o.write_schedule.c_str());
+            return 1;
+        }
+        if (o.target.empty()) return 0;
+    }
+    ::signal(SIGPIPE, SIG_IGN);
+
+    std::string host;
+    int port = 0;
+    Server server;
+    std::string schedule;
+    if (!o.target.empty()) {
+        const std::size_t colon = o.target.rfind(':');
+        host = o.target.substr(0, colon);
+        port = std::atoi(o.target.c_str() + colon + 1);
+    } else {
+        if (o.server.empty()) {
+            const std::string self = argv[0];
+            const std::size_t slash = self.rfind('/');
+            o.server = (slash == std::string::npos ? std::string(".") : self.substr(0, slash)) + "/booking_server";
+        }
+        char tmpl[] = "/tmp/booking_netbench_XXXXXX";
+        const int fd = ::mkstemp(tmpl);
+        if (fd < 0) return 1;
+        ::close(fd);
+        schedule = tmpl;
+        if (!write_schedule(schedule) || !server.start(o, schedule, host, port)) {
+            std::fprintf(stderr, "cannot start %s\n", o.server.c_str());
+            server.stop();
+            std::remove(schedule.c_str());
+            return 1;
+        }
+    }
+
+    std::FILE* csv = o.csv.empty() ? nullptr : std::fopen(o.csv.c_str(), "w");
+    if (csv) {
+        std::fprintf(csv, "protocol,workload,connections,pipeline,requests,ok_pct,req_per_s,"
+                          "p50_us,p99_us,p999_us,max_us\n");
+    }
+    std::printf("server=%s:%d seconds=%.1f warmup=%.1f pipeline=%d threads<=%u%s%s\n", host.c_str(), port, o.seconds,
+                o.warmup, o.pipeline, o.threads, o.server_args.empty() ? "" : " args=", o.server_args.c_str());
+    std::printf("%-5s %-6s %6s %12s %7s %12s %9s %9s %9s %9s\n", "proto", "work", "conns", "requests", "ok%", "req/s",
+                "p50us", "p99us", "p999us", "maxus");
+
+    int status = 0;
+    for (const Protocol proto : o.protocols) {
+        for (const Workload work : o.workloads) {
+            if (!supported(proto, work)) continue;
+            for (const int n : o.connections) {
+                const unsigned threads = std::min(o.threads, static_cast<unsigned>(n));
+                std::vector<std::vector<Connection>> groups(threads);
+                bool connected = true;
+                for (int i = 0; i < n; ++i) {
+                    Connection c;
+                    c.fd = connect_to(host, port);
+                    connected = connected && c.fd >= 0;
+                    groups[static_cast<std::size_t>(i) % threads].push_back(std::move(c));
+                }
+                std::vector<RunStats> stats(threads);
+                const Clock::time_point start = Clock::now();
+                const Clock::time_point measure_from = start + std::chrono::duration_cast<Clock::duration>(
+                                                                   std::chrono::duration<double>(o.warmup));
+                const Clock::time_point stop = measure_from + std::chrono::duration_cast<Clock::duration>(
+                                                                  std::chrono::duration<double>(o.seconds));
+                std::vector<std::thread> workers;
+                for (unsigned t = 0; connected && t < threads; ++t) {
+                    workers.emplace_back([&, t] {
+                        drive(proto, work, groups[t], o.pipeline, measure_from, stop, o.seed + t, stats[t]);
+                    });
+                }
+                for (std::thread& w : workers) w.join();
+                for (auto& group : groups) {
+                    for (Connection& c : group) {
+                        if (c.fd >= 0) ::close(c.fd);
+                    }
+                }
+
+                RunStats total;
+                for (const RunStats& s : stats) {
+                    total.latency.merge(s.latency);
+                    total.ok += s.ok;
+                    total.errors += s.errors;
+                }
+                const LatencyHistogram& h = total.latency;
+                const double ok_pct =
+                    h.count() ? 100.0 * static_cast<double>(total.ok) / static_cast<double>(h.count()) : 0.0;
+                const double rate = static_cast<double>(h.count()) / o.seconds;
+                std::printf("%-5s %-6s %6d %12llu %7.1f %12.0f %9.2f %9.2f %9.2f %9.2f%s\n", name(proto), name(work), n,
+                            static_cast<unsigned long long>(h.count()), ok_pct, rate, us(h.percentile(0.5)),
+                            us(h.percentile(0.99)), us(h.percentile(0.999)), us(h.max()),
+                            !connected ? "  (connect failed)" : total.errors ? "  (connections lost)" : "");
+                std::fflush(stdout);
+                if (csv) {
+                    std::fprintf(csv, "%s,%s,%d,%d,%llu,%.1f,%.0f,%.2f,%.2f,%.2f,%.2f\n", name(proto), name(work), n,
+                                 o.pipeline, static_cast<unsigned long long>(h.count()), ok_pct, rate,
+                                 us(h.percentile(0.5)), us(h.percentile(0.99)), us(h.percentile(0.999)), us(h.max()));
+                }
+                if (h.count() == 0u || !connected) status = 1;
+            }
+        }
+    }
+    if (csv) std::fclose(csv);
+    server.stop();
+    if (!schedule.empty()) std::remove(schedule.c_str());
+    return status;
+}
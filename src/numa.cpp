@@ -0,0 +1,169 @@
+#include "numa.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace booking {
+
+namespace {
+
+// From <linux/mempolicy.h>, which is not always installed
+constexpr int kMpolBind = 2;
+constexpr int kMpolInterleave = 3;
+
+std::atomic<NumaPlacement> g_placement{NumaPlacement::Off};
+
+/** @brief Whole content of @p path, or empty if it cannot be read. */
+std::string read_file(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return {};
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+bool parse_int(std::string_view text, std::size_t& pos, int& out) {
+    const std::size_t start = pos;
+    int v = 0;
+    while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+        v = v * 10 + (text[pos] - '0');
+        if (v > (1 << 20)) return false;
+        ++pos;
+    }
+    out = v;
+    return pos > start;
+}
+
+/** @brief Every CPU the process may run on, as one node 0. */
+NumaTopology::Node whole_machine() {
+    NumaTopology::Node node;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) node.cpus.push_back(cpu);
+        }
+    }
+    if (node.cpus.empty()) {
+        const unsigned n = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned cpu = 0; cpu < n; ++cpu) node.cpus.push_back(static_cast<int>(cpu));
+    }
+    return node;
+}
+
+} // namespace
+
+const char* to_string(NumaPlacement placement) {
+    switch (placement) {
+        case NumaPlacement::Off: return "off";
+        case NumaPlacement::Local: return "local";
+        case NumaPlacement::Interleaved: return "interleave";
+    }
+    return "unknown";
+}
+
+bool parse_numa_placement(std::string_view text, NumaPlacement& out) {
+    for (NumaPlacement p : {NumaPlacement::Off, NumaPlacement::Local, NumaPlacement::Interleaved}) {
+        if (text == to_string(p)) {
+            out = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_cpu_list(std::string_view text, std::vector<int>& out) {
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) text.remove_suffix(1);
+    std::vector<int> cpus;
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        int lo = 0;
+        if (!parse_int(text, pos, lo)) return false;
+        int hi = lo;
+        if (pos < text.size() && text[pos] == '-') {
+            ++pos;
+            if (!parse_int(text, pos, hi) || hi < lo) return false;
+        }
+        for (int cpu = lo; cpu <= hi; ++cpu) cpus.push_back(cpu);
+        if (pos < text.size()) {
+            if (text[pos] != ',') return false;
+            ++pos;
+        }
+    }
+    out.insert(out.end(), cpus.begin(), cpus.end());
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return true;
+}
+
+NumaTopology::NumaTopology(std::vector<Node> nodes) : nodes_(std::move(nodes)) {
+    if (nodes_.empty()) nodes_.push_back(whole_machine());
+}
+
+NumaTopology NumaTopology::discover(const std::string& node_dir) {
+    std::vector<int> ids;
+    if (!parse_cpu_list(read_file(node_dir + "/online"), ids)) ids.clear(); // same list syntax as CPUs
+    std::vector<Node> nodes;
+    for (int id : ids) {
+        Node node;
+        node.id = id;
+        if (!parse_cpu_list(read_file(node_dir + "/node" + std::to_string(id) + "/cpulist"), node.cpus)) continue;
+        if (!node.cpus.empty()) nodes.push_back(std::move(node));
+    }
+    return NumaTopology(std::move(nodes));
+}
+
+const NumaTopology& NumaTopology::system() {
+    static const NumaTopology topology = discover();
+    return topology;
+}
+
+int NumaTopology::node_of_cpu(int cpu) const {
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        if (std::binary_search(nodes_[i].cpus.begin(), nodes_[i].cpus.end(), cpu)) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool bind_memory(void* data, std::size_t bytes, const NumaTopology& topology, NumaPlacement placement,
+                 std::size_t node_index) {
+    if (placement == NumaPlacement::Off || topology.node_count() < 2u || !data || bytes == 0u) return false;
+    constexpr std::size_t kMaskBits = 1024;
+    unsigned long mask[kMaskBits / (8 * sizeof(unsigned long))] = {};
+    const auto add = [&](int id) {
+        const auto bit = static_cast<std::size_t>(id);
+        if (bit < kMaskBits) mask[bit / (8 * sizeof(unsigned long))] |= 1ul << (bit % (8 * sizeof(unsigned long)));
+    };
+    int mode = kMpolBind;
+    if (placement == NumaPlacement::Local) {
+        add(topology.node(node_index % topology.node_count()).id);
+    } else {
+        mode = kMpolInterleave;
+        for (std::size_t i = 0; i < topology.node_count(); ++i) add(topology.node(i).id);
+    }
+    return ::syscall(SYS_mbind, data, bytes, mode, mask, kMaskBits + 1u, 0u) == 0;
+}
+
+bool pin_to_node(std::thread& thread, const NumaTopology& topology, std::size_t node_index) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : topology.node(node_index % topology.node_count()).cpus) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return ::pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+}
+
+void set_numa_placement(NumaPlacement placement) {
+    g_placement.store(placement, std::memory_order_relaxed);
+}
+
+NumaPlacement numa_placement() {
+    return g_placement.load(std::memory_order_relaxed);
+}
+
+} // namespace booking
@@ -0,0 +1,356 @@
+#include "offline_kiosk.hpp"
+
+#include "schedule_loader.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace booking {
+
+namespace {
+
+/** @brief Seats of @p a that are not in @p b. */
+SeatMask minus(const SeatMask& a, const SeatMask& b) {
+    SeatMask out;
+    for (int w = a.first_word(); w < a.end_word(); ++w) out.or_word(w, a.word(w) & ~b.word(w));
+    return out;
+}
+
+} // namespace
+
+OfflineKiosk::OfflineKiosk(Lease lease, Renew renew, Settle settle, Settle give_back, Layouts layouts,
+                           KioskOptions options)
+    : lease_(std::move(lease)), renew_(std::move(renew)), settle_(std::move(settle)), give_back_(std::move(give_back)),
+      layouts_(std::move(layouts)), options_(std::move(options)) {}
+
+OfflineKiosk::OfflineKiosk(BookingService& core, KioskOptions options)
+    : OfflineKiosk(
+          [&core](ShowId show_id, const SeatMask& block, std::chrono::milliseconds ttl, BookingResult& out) {
+              out = core.lease_seat_mask(show_id, block, ttl);
+              return true;
+          },
+          [&core](ShowId show_id, BookingId lease_id, std::chrono::milliseconds ttl, BookingResult& out) {
+              out = core.renew_lease(show_id, lease_id, ttl);
+              return true;
+          },
+          [&core](ShowId show_id, const SeatMask& seats, BookingId lease_id, BookingResult& out) {
+              out = core.settle_lease(show_id, seats, lease_id);
+              return true;
+          },
+          [&core](ShowId show_id, const SeatMask& seats, BookingId lease_id, BookingResult& out) {
+              out = core.cancel_seat_mask(show_id, seats, lease_id);
+              return true;
+          },
+          [&core](ShowId show_id) { return core.layout_for_show(show_id); }, std::move(options)) {}
+
+JournalStatus OfflineKiosk::open() {
+    {
+        // Leases and sales not reconciled before the kiosk stopped
+        MappedFile file(options_.journal_path);
+        if (file.ok()) {
+            JournalReader reader(file.view());
+            if (reader.status() != JournalStatus::Ok) return reader.status();
+            std::lock_guard<std::mutex> lock(mutex_);
+            JournalRecord r;
+            while (reader.next(r)) apply(r.op, r.show_id, r.booking_id, r.seats);
+        }
+    }
+    return journal_.open(options_.journal_path, options_.mode);
+}
+
+void OfflineKiosk::apply(JournalOp op, ShowId show_id, BookingId id, const SeatMask& seats) {
+    const auto lease = leases_.find(show_id);
+    if ((id & kKioskSaleBit) != 0u) {
+        if (op == JournalOp::Book) {
+            sales_[id] = Sale{show_id, seats};
+            if (lease != leases_.end()) lease->second.free = minus(lease->second.free, seats);
+            next_sale_ = std::max(next_sale_, (id & ~kKioskSaleBit) + 1u);
+            return;
+        }
+        const auto sale = sales_.find(id);
+        if (sale == sales_.end()) return;
+        sale->second.seats = minus(sale->second.seats, seats);
+        if (sale->second.seats.empty()) sales_.erase(sale);
+        if (lease == leases_.end()) return;
+        for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+            lease->second.free.or_word(w, seats.word(w) & lease->second.block.word(w)); // unless settled
+        }
+        return;
+    }
+
+    if (op == JournalOp::Book) {
+        Leased& leased = leases_[show_id];
+        if (leased.lease_id != id) {
+            // Replayed: the TTL left in the core is unknown until the lease is renewed
+            leased.deadline = options_.lease_ttl.count() > 0 ? std::chrono::steady_clock::time_point::min()
+                                                             : std::chrono::steady_clock::time_point::max();
+        }
+        leased.lease_id = id;
+        leased.block = seats;
+        leased.free = seats;
+        if (!leased.layout && layouts_) {
+            const HallLayout* layout = layouts_(show_id);
+            if (layout) leased.layout = std::make_shared<const HallLayout>(*layout);
+        }
+        return;
+    }
+    if (lease == leases_.end() || lease->second.lease_id != id) return;
+    lease->second.block = minus(lease->second.block, seats);
+    lease->second.free = minus(lease->second.free, seats);
+    if (lease->second.block.empty()) leases_.erase(lease);
+}
+
+void OfflineKiosk::await(std::uint64_t commit_lsn) {
+    if (options_.mode == JournalMode::Sync) journal_.wait_durable(commit_lsn);
+}
+
+BookingResult OfflineKiosk::parse(const HallLayout& layout, const std::vector<std::string>& labels, SeatMask& out) {
+    out = SeatMask{};
+    if (labels.empty()) return BookingResult::error(BookingStatus::NoSeats);
+    for (std::size_t i = 0; i < labels.size(); ++i) {
+        int seat = -1;
+        if (!layout.try_parse_label(labels[i], seat)) {
+            return BookingResult::label_error(BookingStatus::InvalidSeatLabel, static_cast<int>(i), labels[i]);
+        }
+        if (out.test(seat)) {
+            return BookingResult::label_error(BookingStatus::DuplicateSeatLabel, static_cast<int>(i), labels[i]);
+        }
+        out.set(seat);
+    }
+    return BookingResult::ok();
+}
+
+BookingResult OfflineKiosk::lease(ShowId show_id, const SeatMask& block) {
+    const std::lock_guard<std::mutex> talking(core_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = leases_.find(show_id);
+        if (it != leases_.end()) return BookingResult::conflict(it->second.block);
+    }
+    if (!layouts_ || !layouts_(show_id)) return BookingResult::error(BookingStatus::InvalidShow);
+    const auto asked = std::chrono::steady_clock::now(); // the core's deadline is later
+    BookingResult r;
+    if (!lease_(show_id, block, options_.lease_ttl, r)) return BookingResult::error(BookingStatus::Busy);
+    if (!r.success) return r;
+
+    std::uint64_t lsn = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        apply(JournalOp::Book, show_id, static_cast<BookingId>(r.id), block);
+        if (options_.lease_ttl.count() > 0) leases_[show_id].deadline = asked + options_.lease_ttl;
+        lsn = journal_.append(JournalOp::Book, show_id, static_cast<BookingId>(r.id), block);
+    }
+    await(lsn);
+    return r;
+}
+
+BookingResult OfflineKiosk::renew(ShowId show_id) {
+    const std::lock_guard<std::mutex> talking(core_mutex_);
+    BookingId lease_id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = leases_.find(show_id);
+        if (it == leases_.end()) return BookingResult::error(BookingStatus::InvalidShow);
+        lease_id = it->second.lease_id;
+    }
+    const auto asked = std::chrono::steady_clock::now();
+    BookingResult r;
+    if (!renew_(show_id, lease_id, options_.lease_ttl, r)) return BookingResult::error(BookingStatus::Busy);
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = leases_.find(show_id);
+    if (it == leases_.end() || it->second.lease_id != lease_id) return r;
+    if (r.success) {
+        it->second.deadline = options_.lease_ttl.count() > 0 ? asked + options_.lease_ttl
+                                                             : std::chrono::steady_clock::time_point::max();
+    } else if (r.status == BookingStatus::HoldExpired || r.status == BookingStatus::UnknownHold) {
+        it->second.deadline = asked; // over in the core: the next reconcile ends it here
+    }
+    return r;
+}
+
+BookingResult OfflineKiosk::book_seats(ShowId show_id, const std::vector<std::string>& seat_labels) {
+    BookingResult r;
+    std::uint64_t lsn = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = leases_.find(show_id);
+        if (it == leases_.end() || !it->second.layout) return BookingResult::error(BookingStatus::InvalidShow);
+        const auto deadline = it->second.deadline;
+        if (deadline != std::chrono::steady_clock::time_point::max()
+            && std::chrono::steady_clock::now() + options_.sell_margin >= deadline) {
+            return BookingResult::error(BookingStatus::HoldExpired);
+        }
+        SeatMask seats;
+        r = parse(*it->second.layout, seat_labels, seats);
+        if (!r.success) return r;
+        const SeatMask taken = minus(seats, it->second.free);
+        if (!taken.empty()) return BookingResult::conflict(taken);
+
+        const BookingId sale_id = next_sale_ | kKioskSaleBit;
+        apply(JournalOp::Book, show_id, sale_id, seats);
+        lsn = journal_.append(JournalOp::Book, show_id, sale_id, seats);
+        r.id = sale_id;
+    }
+    await(lsn);
+    return r;
+}
+
+BookingResult OfflineKiosk::cancel_seats(ShowId show_id, const std::vector<std::string>& seat_labels,
+                                         BookingId sale_id) {
+    BookingResult r;
+    std::uint64_t lsn = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto lease = leases_.find(show_id);
+        if (lease == leases_.end() || !lease->second.layout) return BookingResult::error(BookingStatus::InvalidShow);
+        SeatMask seats;
+        r = parse(*lease->second.layout, seat_labels, seats);
+        if (!r.success) return r;
+        const auto sale = sales_.find(sale_id);
+        if (sale == sales_.end() || sale->second.show_id != show_id) return BookingResult::not_owner(seats);
+        const SeatMask foreign = minus(seats, sale->second.seats);
+        if (!foreign.empty()) return BookingResult::not_owner(foreign);
+
+        apply(JournalOp::Cancel, show_id, sale_id, seats);
+        lsn = journal_.append(JournalOp::Cancel, show_id, sale_id, seats);
+    }
+    await(lsn);
+    return r;
+}
+
+int OfflineKiosk::available_seats_mask(ShowId show_id, SeatMask& out_free) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = leases_.find(show_id);
+    out_free = it == leases_.end() ? SeatMask{} : it->second.free;
+    return it == leases_.end() ? -1 : out_free.count();
+}
+
+std::vector<std::string> OfflineKiosk::list_available_seats(ShowId show_id) const {
+    std::vector<std::string> out;
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = leases_.find(show_id);
+    if (it == leases_.end() || !it->second.layout) return out;
+    const SeatMask& free = it->second.free;
+    out.reserve(static_cast<std::size_t>(free.count()));
+    for (int w = free.first_word(); w < free.end_word(); ++w) {
+        for (std::uint64_t bits = free.word(w); bits != 0u; bits &= bits - 1u) {
+            out.emplace_back(it->second.layout->label_view(HallLayout::seat_index(w, ctz64(bits))));
+        }
+    }
+    return out;
+}
+
+std::size_t OfflineKiosk::pending_sales() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sales_.size();
+}
+
+KioskReconcile OfflineKiosk::reconcile(bool return_unsold) {
+    const std::lock_guard<std::mutex> talking(core_mutex_);
+    KioskReconcile out;
+
+    // The sales pending now, in sale order: later ones wait for the next call
+    std::vector<std::pair<BookingId, Sale>> sales;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sales.assign(sales_.begin(), sales_.end());
+    }
+    std::uint64_t lsn = 0;
+    for (const auto& [sale_id, sale] : sales) {
+        BookingId lease_id = 0;
+        SeatMask seats;
+        {
+            // Cancelled here since the copy: settle what is left
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto it = sales_.find(sale_id);
+            const auto lease = leases_.find(sale.show_id);
+            if (it == sales_.end() || lease == leases_.end()) continue;
+            lease_id = lease->second.lease_id;
+            seats = it->second.seats;
+        }
+        BookingResult r;
+        if (!settle_(sale.show_id, seats, lease_id, r)) {
+            out.complete = false;
+            break;
+        }
+        out.sales.push_back(KioskReconcile::Sale{sale.show_id, sale_id, r.success ? static_cast<BookingId>(r.id) : 0u,
+                                                 seats, r.status});
+        if (r.success) {
+            ++out.settled;
+        } else {
+            ++out.conflicts;
+        }
+
+        // Seats settled (or no longer the lease's in the core) leave the lease first, so
+        // ending the sale frees only the seats of a refused sale the lease still owns
+        const SeatMask lost = r.success || r.status != BookingStatus::NotOwner ? seats : r.conflicts;
+        std::lock_guard<std::mutex> lock(mutex_);
+        apply(JournalOp::Cancel, sale.show_id, lease_id, lost);
+        journal_.append(JournalOp::Cancel, sale.show_id, lease_id, lost);
+        apply(JournalOp::Cancel, sale.show_id, sale_id, seats);
+        lsn = journal_.append(JournalOp::Cancel, sale.show_id, sale_id, seats);
+    }
+
+    {
+        // Elapsed leases with no sale left to settle end here: the core takes their unsold
+        // seats back by itself
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::pair<ShowId, Leased>> ended;
+        for (const auto& [show_id, leased] : leases_) {
+            if (leased.deadline == std::chrono::steady_clock::time_point::min() || leased.deadline > now) continue;
+            const bool open = std::any_of(sales_.begin(), sales_.end(),
+                                          [&](const auto& sale) { return sale.second.show_id == show_id; });
+            if (!open) ended.emplace_back(show_id, leased);
+        }
+        for (const auto& [show_id, leased] : ended) {
+            apply(JournalOp::Cancel, show_id, leased.lease_id, leased.block);
+            lsn = journal_.append(JournalOp::Cancel, show_id, leased.lease_id, leased.block);
+        }
+    }
+
+    if (out.complete && return_unsold) {
+        std::vector<std::pair<ShowId, Leased>> leases;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            leases.assign(leases_.begin(), leases_.end());
+        }
+        for (const auto& [show_id, leased] : leases) {
+            // Under the lock: the kiosk must not sell a seat while it is being given back
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto it = leases_.find(show_id);
+            if (it == leases_.end() || it->second.lease_id != leased.lease_id) continue;
+            const SeatMask unsold = it->second.free;
+            if (unsold.empty()) continue;
+            BookingResult r;
+            if (!give_back_(show_id, unsold, leased.lease_id, r)) {
+                out.complete = false;
+                break;
+            }
+            apply(JournalOp::Cancel, show_id, leased.lease_id, unsold);
+            lsn = journal_.append(JournalOp::Cancel, show_id, leased.lease_id, unsold);
+            if (r.success) out.returned += static_cast<std::size_t>(unsold.count());
+        }
+    }
+
+    await(lsn);
+    if (out.complete) checkpoint();
+    return out;
+}
+
+void OfflineKiosk::checkpoint() {
+    // Restate the open leases, then the open sales, and drop everything before them
+    std::uint64_t first = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        first = journal_.next_lsn();
+        for (const auto& [show_id, leased] : leases_) {
+            journal_.append(JournalOp::Book, show_id, leased.lease_id, leased.block);
+        }
+        for (const auto& [sale_id, sale] : sales_) journal_.append(JournalOp::Book, sale.show_id, sale_id, sale.seats);
+    }
+    journal_.sync();
+    journal_.compact(first);
+}
+
+} // namespace booking
@@ -0,0 +1,227 @@
+#include "payment_workflow.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace booking {
+
+namespace {
+
+constexpr int kSpinPolls = 256; /**< Empty polls before a worker parks. */
+
+std::int64_t steady_ns(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+} // namespace
+
+const char* to_string(PaymentOutcome outcome) {
+    switch (outcome) {
+        case PaymentOutcome::Paid: return "paid";
+        case PaymentOutcome::Declined: return "declined";
+        case PaymentOutcome::TimedOut: return "timed out";
+    }
+    return "unknown";
+}
+
+PaymentWorkflow::PaymentWorkflow(BookingService& service, unsigned workers, std::size_t capacity,
+                                 std::chrono::milliseconds sweep_interval)
+    : service_(service),
+      capacity_(capacity),
+      sweep_interval_(std::max(sweep_interval, std::chrono::milliseconds(1))),
+      slots_(new Slot[capacity]) {
+    // Thread every slot onto the free list: slot i -> i + 1
+    for (std::size_t i = 0; i < capacity; ++i) {
+        slots_[i].next.store(i + 1 < capacity ? static_cast<std::uint32_t>(i + 1) : kNoSlot);
+    }
+    free_.store(capacity > 0 ? 0u : kNoSlot);
+
+    if (workers == 0u) workers = 1u;
+    workers_.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i) workers_.push_back(std::make_unique<Worker>());
+    for (unsigned i = 0; i < workers; ++i) workers_[i]->thread = std::thread([this, i] { worker_loop(i); });
+}
+
+PaymentWorkflow::~PaymentWorkflow() {
+    stopping_.store(true, std::memory_order_seq_cst);
+    for (auto& w : workers_) {
+        std::lock_guard<std::mutex> lock(w->park_mutex);
+        w->park_cv.notify_one();
+    }
+    for (auto& w : workers_) w->thread.join();
+
+    // Payments nobody answered: give their seats back
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        Slot& s = slots_[i];
+        std::uint64_t state = s.state.load(std::memory_order_acquire);
+        if ((state & 0xFFFFFFFFu) == kPending && settle(s, state, PaymentOutcome::TimedOut)) {
+            service_.release_hold(s.hold);
+        }
+    }
+}
+
+std::uint32_t PaymentWorkflow::pop_free() {
+    // Treiber stack pop; the tag in the high half defeats ABA when a slot is recycled
+    std::uint64_t head = free_.load(std::memory_order_acquire);
+    while (true) {
+        const auto slot = static_cast<std::uint32_t>(head);
+        if (slot == kNoSlot) return kNoSlot;
+        const std::uint32_t next = slots_[slot].next.load(std::memory_order_relaxed);
+        const std::uint64_t desired = (((head >> 32) + 1u) << 32) | next;
+        if (free_.compare_exchange_weak(head, desired, std::memory_order_acquire)) return slot;
+    }
+}
+
+void PaymentWorkflow::push_free(std::uint32_t slot) {
+    std::uint64_t head = free_.load(std::memory_order_relaxed);
+    while (true) {
+        slots_[slot].next.store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+        const std::uint64_t desired = (((head >> 32) + 1u) << 32) | slot;
+        if (free_.compare_exchange_weak(head, desired, std::memory_order_release)) return;
+    }
+}
+
+BookingResult PaymentWorkflow::begin(ShowId show_id, const std::vector<std::string>& seat_labels,
+                                     std::chrono::milliseconds ttl, Completion done) {
+    const std::uint32_t slot = pop_free();
+    if (slot == kNoSlot) return BookingResult::error(BookingStatus::Busy);
+    BookingResult res = service_.hold_seats(show_id, seat_labels, ttl);
+    if (!res.success) {
+        push_free(slot); // never published: reuse with the same generation
+        return res;
+    }
+
+    Slot& s = slots_[slot];
+    s.show_id = show_id;
+    s.hold = res.id;
+    s.done = std::move(done);
+    s.deadline_ns.store(steady_ns(std::chrono::steady_clock::now() + ttl), std::memory_order_relaxed);
+    pending_.fetch_add(1u, std::memory_order_relaxed);
+    started_.fetch_add(1u, std::memory_order_relaxed);
+    const std::uint64_t generation = s.state.load(std::memory_order_relaxed) >> 32;
+    s.state.store((generation << 32) | kPending, std::memory_order_release);
+    res.id = (generation << 32) | slot;
+    return res;
+}
+
+bool PaymentWorkflow::complete(PaymentTicket ticket, PaymentOutcome outcome) {
+    const std::uint64_t slot = ticket & 0xFFFFFFFFu;
+    if (slot >= capacity_) return false;
+    Slot& s = slots_[slot];
+    if (!settle(s, (ticket & ~std::uint64_t{0xFFFFFFFFu}) | kPending, outcome)) return false;
+
+    Worker& w = *workers_[static_cast<std::uint64_t>(s.show_id.value()) % workers_.size()];
+    w.queue.push(&s);
+    // Pairs with the fence in worker_loop: either the worker sees the ticket or we see it parked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (w.parked.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(w.park_mutex);
+        w.parked.store(false, std::memory_order_relaxed);
+        w.park_cv.notify_one();
+    }
+    return true;
+}
+
+bool PaymentWorkflow::settle(Slot& s, std::uint64_t expected, PaymentOutcome outcome) {
+    const std::uint64_t settling = (expected & ~std::uint64_t{0xFFFFFFFFu}) | kSettling;
+    if (!s.state.compare_exchange_strong(expected, settling, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+        return false;
+    }
+    s.outcome = outcome; // the winner owns the slot until it is recycled
+    return true;
+}
+
+void PaymentWorkflow::sweep(std::chrono::steady_clock::time_point now) {
+    const std::int64_t now_ns = steady_ns(now);
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        Slot& s = slots_[i];
+        const std::uint64_t state = s.state.load(std::memory_order_acquire);
+        if ((state & 0xFFFFFFFFu) != kPending || s.deadline_ns.load(std::memory_order_relaxed) > now_ns) continue;
+        complete((state & ~std::uint64_t{0xFFFFFFFFu}) | i, PaymentOutcome::TimedOut);
+    }
+}
+
+PaymentStats PaymentWorkflow::stats() const {
+    PaymentStats out;
+    out.started = started_.load(std::memory_order_relaxed);
+    out.paid = paid_.load(std::memory_order_relaxed);
+    out.declined = declined_.load(std::memory_order_relaxed);
+    out.timed_out = timed_out_.load(std::memory_order_relaxed);
+    out.pending = pending_.load(std::memory_order_relaxed);
+    return out;
+}
+
+std::size_t PaymentWorkflow::drain(Worker& w) {
+    std::size_t ran = 0;
+    while (MpscNode* node = w.queue.pop()) {
+        Slot& s = *static_cast<Slot*>(node);
+        const PaymentOutcome outcome = s.outcome;
+        BookingResult res;
+        switch (outcome) {
+            case PaymentOutcome::Paid:
+                res = service_.confirm_hold(s.hold);
+                paid_.fetch_add(1u, std::memory_order_relaxed);
+                break;
+            case PaymentOutcome::Declined:
+                res = service_.release_hold(s.hold);
+                declined_.fetch_add(1u, std::memory_order_relaxed);
+                break;
+            case PaymentOutcome::TimedOut:
+                service_.release_hold(s.hold); // UnknownHold once the reaper got there first
+                res = BookingResult::error(BookingStatus::HoldExpired);
+                timed_out_.fetch_add(1u, std::memory_order_relaxed);
+                break;
+        }
+        const std::uint64_t ticket = (s.state.load(std::memory_order_relaxed) & ~std::uint64_t{0xFFFFFFFFu})
+                                     | static_cast<std::uint64_t>(&s - slots_.get());
+        const Completion done = std::exchange(s.done, nullptr);
+        const std::uint64_t generation = ticket >> 32;
+        s.state.store(((generation + 1u) << 32) | kFree, std::memory_order_release);
+        push_free(static_cast<std::uint32_t>(ticket & 0xFFFFFFFFu));
+        pending_.fetch_sub(1u, std::memory_order_relaxed);
+        if (done) done(ticket, outcome, res); // the slot may already carry the next payment
+        ++ran;
+    }
+    return ran;
+}
+
+void PaymentWorkflow::worker_loop(unsigned index) {
+    Worker& w = *workers_[index];
+    auto next_sweep = std::chrono::steady_clock::now() + sweep_interval_;
+    int idle = 0;
+    while (true) {
+        if (index == 0u) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= next_sweep) {
+                sweep(now);
+                next_sweep = now + sweep_interval_;
+            }
+        }
+        if (drain(w) != 0u) {
+            idle = 0;
+            continue;
+        }
+        if (stopping_.load(std::memory_order_acquire)) {
+            if (drain(w) == 0u) break; // completed before the stop request
+            continue;
+        }
+        if (++idle < kSpinPolls) continue;
+
+        // Announce parking, then look once more (Dekker with complete)
+        w.parked.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (drain(w) != 0u) {
+            w.parked.store(false, std::memory_order_relaxed);
+            idle = 0;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(w.park_mutex);
+        w.park_cv.wait_for(lock, sweep_interval_, [&] {
+            return !w.parked.load(std::memory_order_relaxed) || stopping_.load(std::memory_order_acquire);
+        });
+        w.parked.store(false, std::memory_order_relaxed);
+        idle = 0;
+    }
+}
+
+} // namespace booking
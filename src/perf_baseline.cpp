@@ -0,0 +1,287 @@
+#include "perf_baseline.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <unordered_map>
+
+namespace booking {
+
+namespace {
+
+/** @brief Read position in a JSON document. */
+struct Cursor {
+    const char* p;
+    const char* end;
+};
+
+void skip_ws(Cursor& c) {
+    while (c.p != c.end && (*c.p == ' ' || *c.p == '\t' || *c.p == '\r' || *c.p == '\n')) ++c.p;
+}
+
+bool consume(Cursor& c, char ch) {
+    skip_ws(c);
+    if (c.p == c.end || *c.p != ch) return false;
+    ++c.p;
+    return true;
+}
+
+/** @brief Raw (still escaped) contents of a string. */
+bool parse_string(Cursor& c, std::string_view& out) {
+    if (!consume(c, '"')) return false;
+    const char* start = c.p;
+    while (c.p != c.end && *c.p != '"') {
+        if (*c.p == '\\' && c.p + 1 != c.end) ++c.p;
+        ++c.p;
+    }
+    if (c.p == c.end) return false;
+    out = std::string_view(start, static_cast<std::size_t>(c.p - start));
+    ++c.p;
+    return true;
+}
+
+bool parse_number(Cursor& c, double& out) {
+    skip_ws(c);
+    const std::from_chars_result r = std::from_chars(c.p, c.end, out);
+    if (r.ec != std::errc()) return false;
+    c.p = r.ptr;
+    return true;
+}
+
+/** @brief Skips any JSON value. */
+bool skip_value(Cursor& c) {
+    skip_ws(c);
+    if (c.p == c.end) return false;
+    std::string_view ignored;
+    if (*c.p == '"') return parse_string(c, ignored);
+    if (*c.p != '[' && *c.p != '{') {
+        const char* start = c.p;
+        while (c.p != c.end && *c.p != ',' && *c.p != '}' && *c.p != ']' && *c.p != ' ' && *c.p != '\n'
+               && *c.p != '\r' && *c.p != '\t') {
+            ++c.p;
+        }
+        return c.p != start;
+    }
+    int depth = 0;
+    while (c.p != c.end) {
+        const char ch = *c.p;
+        if (ch == '"') {
+            if (!parse_string(c, ignored)) return false;
+            continue;
+        }
+        ++c.p;
+        if (ch == '[' || ch == '{') ++depth;
+        if ((ch == ']' || ch == '}') && --depth == 0) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Walks the fields of an object; @p field(key, cursor) returns 1 if it consumed
+ *        the value, 0 to skip it and -1 on a bad value.
+ */
+template <typename F>
+bool for_each_field(Cursor& c, F&& field) {
+    if (!consume(c, '{')) return false;
+    if (consume(c, '}')) return true;
+    while (true) {
+        std::string_view key;
+        if (!parse_string(c, key) || !consume(c, ':')) return false;
+        const int r = field(key, c);
+        if (r < 0 || (r == 0 && !skip_value(c))) return false;
+        if (consume(c, ',')) continue;
+        return consume(c, '}');
+    }
+}
+
+double ns_per(std::string_view unit) {
+    if (unit == "us") return 1e3;
+    if (unit == "ms") return 1e6;
+    if (unit == "s") return 1e9;
+    return 1.0;
+}
+
+/** @brief True if @p name has a "/real_time" component (e.g. "BM_X/real_time/threads:4"). */
+bool real_time_run(std::string_view name) {
+    const std::string_view tag = "/real_time";
+    for (std::size_t at = name.find(tag); at != std::string_view::npos; at = name.find(tag, at + 1u)) {
+        const std::size_t end = at + tag.size();
+        if (end == name.size() || name[end] == '/') return true;
+    }
+    return false;
+}
+
+/** @brief One row of the "benchmarks" array. */
+bool parse_row(Cursor& c, std::unordered_map<std::string, std::size_t>& index, std::vector<PerfRun>& out) {
+    std::string_view name;
+    std::string_view run_name;
+    std::string_view run_type;
+    std::string_view unit = "ns";
+    double real_time = -1.0;
+    double cpu_time = -1.0;
+    const bool ok = for_each_field(c, [&](std::string_view key, Cursor& v) {
+        if (key == "name") return parse_string(v, name) ? 1 : -1;
+        if (key == "run_name") return parse_string(v, run_name) ? 1 : -1;
+        if (key == "run_type") return parse_string(v, run_type) ? 1 : -1;
+        if (key == "time_unit") return parse_string(v, unit) ? 1 : -1;
+        if (key == "real_time") return parse_number(v, real_time) ? 1 : -1;
+        if (key == "cpu_time") return parse_number(v, cpu_time) ? 1 : -1;
+        return 0;
+    });
+    if (!ok) return false;
+    if (run_type == "aggregate") return true;
+    if (run_name.empty()) run_name = name;
+    if (run_name.empty() || real_time < 0.0 || cpu_time < 0.0) return false;
+
+    const double t = real_time_run(run_name) ? real_time : cpu_time;
+    const auto [it, inserted] = index.emplace(std::string(run_name), out.size());
+    if (inserted) out.push_back(PerfRun{it->first, {}});
+    out[it->second].ns.push_back(t * ns_per(unit));
+    return true;
+}
+
+double median(std::vector<double> v) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    const std::size_t mid = v.size() / 2u;
+    return v.size() % 2u ? v[mid] : (v[mid - 1u] + v[mid]) / 2.0;
+}
+
+} // namespace
+
+bool parse_benchmark_json(std::string_view json, std::vector<PerfRun>& out) {
+    out.clear();
+    std::unordered_map<std::string, std::size_t> index;
+    Cursor c{json.data(), json.data() + json.size()};
+    bool found = false;
+    const bool ok = for_each_field(c, [&](std::string_view key, Cursor& v) {
+        if (key != "benchmarks") return 0;
+        found = true;
+        if (!consume(v, '[')) return -1;
+        if (consume(v, ']')) return 1;
+        while (true) {
+            if (!parse_row(v, index, out)) return -1;
+            if (consume(v, ',')) continue;
+            return consume(v, ']') ? 1 : -1;
+        }
+    });
+    return ok && found;
+}
+
+double mann_whitney_p(Span<const double> a, Span<const double> b) {
+    const std::size_t n1 = a.size();
+    const std::size_t n2 = b.size();
+    if (n1 == 0u || n2 == 0u) return 1.0;
+    std::vector<std::pair<double, bool>> all; // (value, from a)
+    all.reserve(n1 + n2);
+    for (const double x : a) all.emplace_back(x, true);
+    for (const double x : b) all.emplace_back(x, false);
+    std::sort(all.begin(), all.end(), [](const auto& x, const auto& y) { return x.first < y.first; });
+
+    // Rank sum of a with tied values sharing their average rank
+    double rank_sum = 0.0;
+    double tie_term = 0.0; // sum of t^3 - t over tie groups
+    for (std::size_t i = 0; i < all.size();) {
+        std::size_t j = i;
+        while (j < all.size() && all[j].first == all[i].first) ++j;
+        const double t = static_cast<double>(j - i);
+        const double rank = static_cast<double>(i + j + 1u) / 2.0; // ranks i+1 .. j
+        for (std::size_t k = i; k < j; ++k) rank_sum += all[k].second ? rank : 0.0;
+        tie_term += t * t * t - t;
+        i = j;
+    }
+    const double m = static_cast<double>(n1);
+    const double n = static_cast<double>(n1 + n2);
+    const double u = rank_sum - m * (m + 1.0) / 2.0;
+    const double mean = m * static_cast<double>(n2) / 2.0;
+    const double var = m * static_cast<double>(n2) / 12.0 * ((n + 1.0) - tie_term / (n * (n - 1.0)));
+    if (var <= 0.0) return 1.0;
+    const double z = (std::fabs(u - mean) - 0.5) / std::sqrt(var); // continuity correction
+    if (z <= 0.0) return 1.0;
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+const char* to_string(PerfVerdict verdict) {
+    switch (verdict) {
+        case PerfVerdict::Unchanged: return "unchanged";
+        case PerfVerdict::Faster: return "faster";
+        case PerfVerdict::Slower: return "slower";
+        case PerfVerdict::Regression: return "regression";
+        case PerfVerdict::Missing: return "missing";
+        case PerfVerdict::New: return "new";
+    }
+    return "unknown";
+}
+
+std::vector<PerfDelta> compare_perf(const std::vector<PerfRun>& baseline, const std::vector<PerfRun>& current,
+                                    const PerfThresholds& thresholds) {
+    std::unordered_map<std::string_view, const PerfRun*> measured;
+    for (const PerfRun& run : current) measured.emplace(run.name, &run);
+    std::vector<PerfDelta> out;
+    for (const PerfRun& base : baseline) {
+        PerfDelta d;
+        d.name = base.name;
+        d.baseline_ns = median(base.ns);
+        const auto it = measured.find(base.name);
+        if (it == measured.end()) {
+            d.verdict = PerfVerdict::Missing;
+            out.push_back(std::move(d));
+            continue;
+        }
+        const PerfRun& run = *it->second;
+        measured.erase(it);
+        d.current_ns = median(run.ns);
+        d.change = d.baseline_ns > 0.0 ? d.current_ns / d.baseline_ns - 1.0 : 0.0;
+        d.p_value = mann_whitney_p(Span<const double>(base.ns.data(), base.ns.size()),
+                                   Span<const double>(run.ns.data(), run.ns.size()));
+        if (d.p_value < thresholds.alpha) {
+            if (d.change > thresholds.max_slowdown) {
+                d.verdict = PerfVerdict::Regression;
+            } else if (d.change > 0.0) {
+                d.verdict = PerfVerdict::Slower;
+            } else if (d.change < 0.0) {
+                d.verdict = PerfVerdict::Faster;
+            }
+        }
+        out.push_back(std::move(d));
+    }
+    for (const PerfRun& run : current) {
+        if (measured.count(run.name) == 0u) continue;
+        PerfDelta d;
+        d.name = run.name;
+        d.current_ns = median(run.ns);
+        d.verdict = PerfVerdict::New;
+        out.push_back(std::move(d));
+    }
+    return out;
+}
+
+bool perf_failed(const std::vector<PerfDelta>& deltas) {
+    return std::any_of(deltas.begin(), deltas.end(), [](const PerfDelta& d) {
+        return d.verdict == PerfVerdict::Regression || d.verdict == PerfVerdict::Missing;
+    });
+}
+
+void write_perf_report(std::ostream& out, const std::vector<PerfDelta>& deltas) {
+    std::size_t width = 9;
+    for (const PerfDelta& d : deltas) width = std::max(width, d.name.size());
+    char line[512];
+    std::snprintf(line, sizeof(line), "%-*s %14s %14s %9s %8s  %s\n", static_cast<int>(width), "benchmark",
+                  "baseline_ns", "current_ns", "change", "p", "verdict");
+    out << line;
+    for (const PerfDelta& d : deltas) {
+        const bool both = d.verdict != PerfVerdict::Missing && d.verdict != PerfVerdict::New;
+        char change[16] = "-";
+        char p[16] = "-";
+        if (both) {
+            std::snprintf(change, sizeof(change), "%+.1f%%", 100.0 * d.change);
+            std::snprintf(p, sizeof(p), "%.4f", d.p_value);
+        }
+        std::snprintf(line, sizeof(line), "%-*s %14.1f %14.1f %9s %8s  %s\n", static_cast<int>(width), d.name.c_str(),
+                      d.baseline_ns, d.current_ns, change, p, to_string(d.verdict));
+        out << line;
+    }
+}
+
+} // namespace booking
@@ -0,0 +1,142 @@
+#include "perf_baseline.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Performance regression check (see perf_baseline.hpp): compares booking_bench results with
+// a stored baseline and exits 1 on a significant regression.
+//
+//   booking_perf_check --baseline=FILE (--current=FILE | --bench=BINARY)
+//                      [--repetitions=N] [--min-time=S] [--filter=REGEX] [--out=FILE]
+//                      [--max-slowdown=F] [--alpha=F] [--report=FILE]
+//
+// With --bench the benchmarks of the baseline (or --filter) are run with N repetitions and
+// their JSON is kept in --out (default booking_perf_current.json); copy that file over the
+// baseline to accept a change. The ctest test of label booking_perf runs exactly this.
+
+namespace {
+
+struct Options {
+    std::string baseline;
+    std::string current;
+    std::string bench;
+    std::string filter;
+    std::string out = "booking_perf_current.json";
+    std::string report;
+    int repetitions = 5;
+    double min_time = 0.2;
+    booking::PerfThresholds thresholds;
+};
+
+bool parse_option(const char* arg, Options& o) {
+    const char* eq = std::strchr(arg, '=');
+    if (std::strncmp(arg, "--", 2) != 0 || !eq) return false;
+    const std::string key(arg + 2, eq);
+    const char* v = eq + 1;
+    if (key == "baseline") o.baseline = v;
+    else if (key == "current") o.current = v;
+    else if (key == "bench") o.bench = v;
+    else if (key == "filter") o.filter = v;
+    else if (key == "out") o.out = v;
+    else if (key == "report") o.report = v;
+    else if (key == "repetitions") o.repetitions = std::atoi(v);
+    else if (key == "min-time") o.min_time = std::atof(v);
+    else if (key == "max-slowdown") o.thresholds.max_slowdown = std::atof(v);
+    else if (key == "alpha") o.thresholds.alpha = std::atof(v);
+    else return false;
+    return true;
+}
+
+bool read_file(const std::string& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream s;
+    s << in.rdbuf();
+    out = s.str();
+    return true;
+}
+
+bool read_runs(const std::string& path, std::vector<booking::PerfRun>& out) {
+    std::string json;
+    if (!read_file(path, json)) {
+        std::cerr << "cannot read " << path << "\n";
+        return false;
+    }
+    if (!booking::parse_benchmark_json(json, out)) {
+        std::cerr << path << ": not Google Benchmark JSON output\n";
+        return false;
+    }
+    return true;
+}
+
+std::string quoted(const std::string& s) {
+    std::string q = "'";
+    for (const char c : s) q += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    return q + "'";
+}
+
+/** @brief Filter selecting exactly the benchmarks of @p runs (run names are full names). */
+std::string filter_of(const std::vector<booking::PerfRun>& runs) {
+    std::string filter = "^(";
+    for (std::size_t i = 0; i < runs.size(); ++i) {
+        if (i) filter += '|';
+        filter += runs[i].name;
+    }
+    return filter + ")$";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    bool usage = argc < 2;
+    for (int i = 1; i < argc && !usage; ++i) {
+        if (!parse_option(argv[i], o)) {
+            std::cerr << "unknown option " << argv[i] << "\n";
+            usage = true;
+        }
+    }
+    if (usage || o.baseline.empty() || o.current.empty() == o.bench.empty() || o.repetitions < 2) {
+        std::cerr << "usage: booking_perf_check --baseline=FILE (--current=FILE | --bench=BINARY)\n"
+                  << "       [--repetitions=N] [--min-time=S] [--filter=REGEX] [--out=FILE]\n"
+                  << "       [--max-slowdown=F] [--alpha=F] [--report=FILE]\n";
+        return 2;
+    }
+
+    std::vector<booking::PerfRun> baseline;
+    if (!read_runs(o.baseline, baseline)) return 2;
+
+    std::string current_path = o.current;
+    if (!o.bench.empty()) {
+        char tail[128];
+        std::snprintf(tail, sizeof(tail), " --benchmark_repetitions=%d --benchmark_min_time=%g", o.repetitions,
+                      o.min_time);
+        const std::string filter = o.filter.empty() ? filter_of(baseline) : o.filter;
+        const std::string cmd = quoted(o.bench) + " --benchmark_filter=" + quoted(filter) + tail
+                                + " --benchmark_out_format=json --benchmark_out=" + quoted(o.out) + " > /dev/null";
+        if (std::system(cmd.c_str()) != 0) {
+            std::cerr << "benchmark run failed: " << cmd << "\n";
+            return 2;
+        }
+        current_path = o.out;
+    }
+    std::vector<booking::PerfRun> current;
+    if (!read_runs(current_path, current)) return 2;
+
+    const std::vector<booking::PerfDelta> deltas = booking::compare_perf(baseline, current, o.thresholds);
+    booking::write_perf_report(std::cout, deltas);
+    if (!o.report.empty()) {
+        std::ofstream report(o.report);
+        booking::write_perf_report(report, deltas);
+    }
+    const bool failed = booking::perf_failed(deltas);
+    std::printf("%s (max slowdown %.0f%%, alpha %.3f)\n", failed ? "FAILED" : "passed",
+                100.0 * o.thresholds.max_slowdown, o.thresholds.alpha);
+    return failed ? 1 : 0;
+}
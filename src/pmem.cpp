@@ -0,0 +1,89 @@
+#include "pmem.hpp"
+
+#include <atomic>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BOOKING_PMEM_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace booking {
+namespace pmem {
+
+const char* to_string(FlushKind kind) {
+    switch (kind) {
+        case FlushKind::None: return "none";
+        case FlushKind::Clflush: return "clflush";
+        case FlushKind::Clflushopt: return "clflushopt";
+        case FlushKind::Clwb: return "clwb";
+    }
+    return "unknown";
+}
+
+namespace {
+
+constexpr std::uintptr_t kLine = 64;
+
+#if BOOKING_PMEM_X86
+
+FlushKind detect() {
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        if ((ebx & (1u << 24)) != 0u) return FlushKind::Clwb;       // CPUID.(EAX=7,ECX=0):EBX.CLWB[bit 24]
+        if ((ebx & (1u << 23)) != 0u) return FlushKind::Clflushopt; // EBX.CLFLUSHOPT[bit 23]
+    }
+    return FlushKind::Clflush;
+}
+
+__attribute__((target("clwb"))) void flush_clwb(std::uintptr_t line, std::uintptr_t end) {
+    for (; line < end; line += kLine) _mm_clwb(reinterpret_cast<void*>(line));
+}
+
+__attribute__((target("clflushopt"))) void flush_clflushopt(std::uintptr_t line, std::uintptr_t end) {
+    for (; line < end; line += kLine) _mm_clflushopt(reinterpret_cast<void*>(line));
+}
+
+void flush_clflush(std::uintptr_t line, std::uintptr_t end) {
+    for (; line < end; line += kLine) _mm_clflush(reinterpret_cast<const void*>(line));
+}
+
+#endif
+
+} // namespace
+
+FlushKind flush_kind() {
+#if BOOKING_PMEM_X86
+    static const FlushKind kind = detect();
+    return kind;
+#else
+    return FlushKind::None;
+#endif
+}
+
+void flush(const void* addr, std::size_t bytes) {
+#if BOOKING_PMEM_X86
+    if (bytes == 0u) return;
+    const auto begin = reinterpret_cast<std::uintptr_t>(addr) & ~(kLine - 1u);
+    const auto end = reinterpret_cast<std::uintptr_t>(addr) + bytes;
+    switch (flush_kind()) {
+        case FlushKind::Clwb: flush_clwb(begin, end); break;
+        case FlushKind::Clflushopt: flush_clflushopt(begin, end); break;
+        default: flush_clflush(begin, end); break;
+    }
+#else
+    (void)addr;
+    (void)bytes;
+#endif
+}
+
+void drain() {
+#if BOOKING_PMEM_X86
+    _mm_sfence();
+#else
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+}
+
+} // namespace pmem
+} // namespace booking
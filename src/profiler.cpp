@@ -0,0 +1,125 @@
+#include "profiler.hpp"
+
+#include <signal.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+
+namespace booking {
+
+namespace {
+
+/** @brief One counted tag: key 0 = empty slot, claimed once with a CAS. */
+struct TagCount {
+    std::atomic<std::uint64_t> key{0};
+    std::atomic<std::uint64_t> samples{0};
+};
+
+TagCount g_tags[kProfileTags];
+std::atomic<std::uint64_t> g_dropped{0};
+std::atomic<bool> g_running{false};
+std::mutex g_control; // serialises start / stop
+struct sigaction g_previous {};
+
+constexpr std::uint64_t kKeyMark = std::uint64_t{1} << 63;
+constexpr std::uint64_t kShowBits = (std::uint64_t{1} << 48) - 1u;
+
+std::uint64_t key_of(std::uint8_t api, std::int64_t show) {
+    return kKeyMark | (std::uint64_t{api} << 48) | (static_cast<std::uint64_t>(show + 1) & kShowBits);
+}
+
+void on_sigprof(int) {
+    const ProfileTag& tag = profile_tag();
+    const std::uint64_t key = key_of(tag.api.load(std::memory_order_relaxed), tag.show.load(std::memory_order_relaxed));
+    std::size_t i = static_cast<std::size_t>((key * 0x9E3779B97F4A7C15u) >> 52) & (kProfileTags - 1u);
+    for (std::size_t probe = 0; probe < kProfileTags; ++probe, i = (i + 1u) & (kProfileTags - 1u)) {
+        std::uint64_t k = g_tags[i].key.load(std::memory_order_relaxed);
+        if (k == 0u && g_tags[i].key.compare_exchange_strong(k, key, std::memory_order_relaxed)) k = key;
+        if (k == key) {
+            g_tags[i].samples.fetch_add(1u, std::memory_order_relaxed);
+            return;
+        }
+    }
+    g_dropped.fetch_add(1u, std::memory_order_relaxed);
+}
+
+bool set_timer(long usec) {
+    itimerval timer{};
+    timer.it_interval.tv_usec = usec;
+    timer.it_value.tv_usec = usec;
+    return ::setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+}
+
+} // namespace
+
+bool profile_start(int hz) {
+    std::lock_guard<std::mutex> lock(g_control);
+    if (g_running.load(std::memory_order_relaxed) || hz <= 0) return false;
+    struct sigaction action {};
+    action.sa_handler = on_sigprof;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (::sigaction(SIGPROF, &action, &g_previous) != 0) return false;
+    if (!set_timer(std::max(1L, std::min(999999L, 1000000L / hz)))) {
+        ::sigaction(SIGPROF, &g_previous, nullptr);
+        return false;
+    }
+    g_running.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void profile_stop() {
+    std::lock_guard<std::mutex> lock(g_control);
+    if (!g_running.load(std::memory_order_relaxed)) return;
+    set_timer(0);
+    // A signal already pending runs the handler (still installed) before it is replaced
+    ::sigaction(SIGPROF, &g_previous, nullptr);
+    g_running.store(false, std::memory_order_relaxed);
+}
+
+bool profile_running() { return g_running.load(std::memory_order_relaxed); }
+
+std::vector<ProfileSample> profile_collect() {
+    std::vector<ProfileSample> out;
+    for (const TagCount& t : g_tags) {
+        const std::uint64_t key = t.key.load(std::memory_order_relaxed);
+        const std::uint64_t n = t.samples.load(std::memory_order_relaxed);
+        if (key == 0u || n == 0u) continue;
+        ProfileSample s;
+        s.api = static_cast<std::uint8_t>(key >> 48);
+        s.show = static_cast<std::int64_t>(key & kShowBits) - 1;
+        s.samples = n;
+        out.push_back(s);
+    }
+    std::sort(out.begin(), out.end(), [](const ProfileSample& a, const ProfileSample& b) {
+        if (a.samples != b.samples) return a.samples > b.samples;
+        return a.api != b.api ? a.api < b.api : a.show < b.show;
+    });
+    return out;
+}
+
+void profile_reset() {
+    for (TagCount& t : g_tags) {
+        t.samples.store(0u, std::memory_order_relaxed);
+        t.key.store(0u, std::memory_order_relaxed);
+    }
+    g_dropped.store(0u, std::memory_order_relaxed);
+}
+
+std::uint64_t profile_dropped() { return g_dropped.load(std::memory_order_relaxed); }
+
+void write_folded_profile(std::ostream& out, const std::vector<ProfileSample>& samples) {
+    for (const ProfileSample& s : samples) {
+        out << (s.api == kNoProfileApi ? "(none)" : to_string(static_cast<MetricsApi>(s.api))) << ';';
+        if (s.show.value() < 0) {
+            out << "(no show)";
+        } else {
+            out << "show " << s.show.value();
+        }
+        out << ' ' << s.samples << '\n';
+    }
+}
+
+} // namespace booking
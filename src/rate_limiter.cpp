@@ -0,0 +1,97 @@
+#include "rate_limiter.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace booking {
+
+namespace {
+
+std::uint64_t mix64(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+std::size_t table_size(std::size_t capacity) {
+    std::size_t n = ClientRateLimiter::kProbe;
+    while (n < capacity) n <<= 1;
+    return n;
+}
+
+} // namespace
+
+ClientRateLimiter::ClientRateLimiter(const RateLimit& limit, std::size_t capacity)
+    : slots_(new Slot[table_size(capacity)]), mask_(table_size(capacity) - 1u) {
+    set_limit(limit);
+}
+
+void ClientRateLimiter::set_limit(const RateLimit& limit) {
+    const std::int64_t interval =
+        limit.per_second > 0.0 ? std::max<std::int64_t>(1, static_cast<std::int64_t>(1e9 / limit.per_second)) : 0;
+    tolerance_ns_.store(interval * (std::max(limit.burst, 1) - 1), std::memory_order_relaxed);
+    interval_ns_.store(interval, std::memory_order_relaxed);
+}
+
+bool ClientRateLimiter::allow(std::uint64_t client) {
+    if (interval_ns_.load(std::memory_order_relaxed) == 0) return true;
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return allow(client, std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+bool ClientRateLimiter::allow(std::uint64_t client, std::int64_t now_ns) {
+    const std::int64_t interval = interval_ns_.load(std::memory_order_relaxed);
+    if (interval == 0) return true;
+    const std::int64_t tolerance = tolerance_ns_.load(std::memory_order_relaxed);
+    Slot& s = slot_for(client, now_ns);
+    std::int64_t tat = s.tat.load(std::memory_order_relaxed);
+    while (true) {
+        const std::int64_t start = std::max(tat, now_ns);
+        if (start - now_ns > tolerance) {
+            s.rejected.fetch_add(1u, std::memory_order_relaxed);
+            return false;
+        }
+        if (s.tat.compare_exchange_weak(tat, start + interval, std::memory_order_relaxed)) return true;
+    }
+}
+
+ClientRateLimiter::Slot& ClientRateLimiter::slot_for(std::uint64_t client, std::int64_t now_ns) {
+    const std::uint64_t key = client + 1u;
+    if (key != 0u) {
+        const std::size_t home = static_cast<std::size_t>(mix64(client));
+        Slot* idle = nullptr;
+        std::uint64_t idle_key = 0;
+        for (std::size_t i = 0; i < kProbe; ++i) {
+            Slot& s = slots_[(home + i) & mask_];
+            std::uint64_t k = s.key.load(std::memory_order_acquire);
+            if (k == key) return s;
+            // Slots are never freed, so a client lives before the first free slot of its window
+            if (k == 0u && s.key.compare_exchange_strong(k, key, std::memory_order_acq_rel)) return s;
+            if (k == key) return s; // claimed by a concurrent request of the same client
+            if (!idle && s.tat.load(std::memory_order_relaxed) <= now_ns) {
+                idle = &s;
+                idle_key = k;
+            }
+        }
+        // A full bucket carries no state: hand it to the newcomer
+        if (idle && idle->key.compare_exchange_strong(idle_key, key, std::memory_order_acq_rel)) return *idle;
+        if (idle_key == key) return *idle;
+    }
+    untracked_.fetch_add(1u, std::memory_order_relaxed);
+    return overflow_;
+}
+
+RateLimiterStats ClientRateLimiter::stats() const {
+    RateLimiterStats out;
+    for (std::size_t i = 0; i <= mask_; ++i) {
+        out.rejected += slots_[i].rejected.load(std::memory_order_relaxed);
+        if (slots_[i].key.load(std::memory_order_relaxed) != 0u) ++out.clients;
+    }
+    out.rejected += overflow_.rejected.load(std::memory_order_relaxed);
+    out.untracked = untracked_.load(std::memory_order_relaxed);
+    return out;
+}
+
+} // namespace booking
@@ -0,0 +1,304 @@
+#include "regional_cache.hpp"
+
+#include <utility>
+
+namespace booking {
+
+namespace {
+
+std::int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+/** @brief One mirrored show. */
+struct RegionalReadCache::Show {
+    std::mutex refresh_mutex;                                    /**< One round trip per show at a time. */
+    mutable std::mutex mutex;                                    /**< Guards the fields below. */
+    std::shared_ptr<const HallLayout> layout;                    /**< nullptr until fetched. */
+    std::array<std::uint64_t, HallLayout::kMaxRows> free{};      /**< Free seats at position. */
+    std::array<std::uint64_t, HallLayout::kMaxRows> booked_here{}; /**< Taken through this cache, not refreshed yet. */
+    std::uint64_t position = 0;                                  /**< Change feed position of free. */
+    std::int64_t requested_ns = -1;                              /**< When the refresh behind free was requested. */
+};
+
+const char* to_string(RegionalReadStatus status) {
+    switch (status) {
+        case RegionalReadStatus::Ok: return "Ok";
+        case RegionalReadStatus::Stale: return "Home region unreachable, answer older than the bound";
+        case RegionalReadStatus::UnknownShow: return "Unknown show";
+    }
+    return "Unknown status";
+}
+
+RegionalReadCache::RegionalReadCache(Snapshot snapshot, Diff diff, Book book, Cancel cancel,
+                                     RegionalCacheOptions options)
+    : snapshot_(std::move(snapshot)), diff_(std::move(diff)), book_(std::move(book)), cancel_(std::move(cancel)),
+      options_(options) {
+    if (options_.sync_interval.count() > 0) loop_ = std::thread([this] { run(); });
+}
+
+RegionalReadCache::RegionalReadCache(BookingService& home, RegionalCacheOptions options)
+    : RegionalReadCache(
+          [&home](ShowId show_id, SeatMapSnapshot& out) {
+              if (!home.change_feed()) return false;
+              if (home.availability_snapshot(show_id, out.free, out.position) < 0) return false;
+              const HallLayout* layout = home.layout_for_show(show_id);
+              if (!layout) return false; // removed since
+              out.layout = std::make_shared<const HallLayout>(*layout);
+              return true;
+          },
+          [&home](ShowId show_id, std::uint64_t since, AvailabilityDiff& out) {
+              out = home.availability_diff(show_id, since);
+              return true;
+          },
+          [&home](ShowId show_id, const std::vector<std::string>& seats) { return home.book_seats(show_id, seats); },
+          [&home](ShowId show_id, const std::vector<std::string>& seats, BookingId booking_id) {
+              return home.cancel_seats(show_id, seats, booking_id);
+          },
+          options) {}
+
+RegionalReadCache::~RegionalReadCache() {
+    if (!loop_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(loop_mutex_);
+        loop_stop_ = true;
+    }
+    loop_cv_.notify_all();
+    loop_.join();
+}
+
+std::shared_ptr<RegionalReadCache::Show> RegionalReadCache::show_of(ShowId show_id) {
+    {
+        std::shared_lock<std::shared_mutex> lock(shows_mutex_);
+        const auto it = shows_.find(show_id);
+        if (it != shows_.end()) return it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(shows_mutex_);
+    std::shared_ptr<Show>& show = shows_[show_id];
+    if (!show) show = std::make_shared<Show>();
+    return show;
+}
+
+bool RegionalReadCache::refresh(ShowId show_id, Show& show) {
+    // Everything the home region completed before this instant is in the answer
+    const std::int64_t requested = steady_ns();
+    std::array<std::uint64_t, HallLayout::kMaxRows> covered{};
+    bool mirrored = false;
+    std::uint64_t position = 0;
+    {
+        std::lock_guard<std::mutex> lock(show.mutex);
+        covered = show.booked_here;
+        mirrored = show.layout != nullptr;
+        position = show.position;
+    }
+    refreshes_.fetch_add(1u, std::memory_order_relaxed);
+
+    if (mirrored) {
+        AvailabilityDiff diff;
+        if (!diff_(show_id, position, diff)) return false;
+        if (diff.status == DiffStatus::Ok) {
+            std::lock_guard<std::mutex> lock(show.mutex);
+            for (int w = 0; w < show.layout->row_count(); ++w) {
+                const auto row = static_cast<std::size_t>(w);
+                show.free[row] ^= diff.taken.word(w) | diff.freed.word(w);
+                show.booked_here[row] &= ~covered[row];
+            }
+            show.position = diff.position;
+            show.requested_ns = requested;
+            return true;
+        }
+        if (diff.status != DiffStatus::Resync) {
+            // Removed in the home region (or its feed went away): nothing left to serve
+            std::lock_guard<std::mutex> lock(show.mutex);
+            show.layout.reset();
+            show.requested_ns = -1;
+            return false;
+        }
+        resyncs_.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    SeatMapSnapshot snapshot;
+    if (!snapshot_(show_id, snapshot)) return false;
+    std::lock_guard<std::mutex> lock(show.mutex);
+    show.layout = std::move(snapshot.layout);
+    show.free.fill(0u);
+    for (int w = 0; w < show.layout->row_count(); ++w) {
+        const auto row = static_cast<std::size_t>(w);
+        show.free[row] = snapshot.free.word(w);
+        show.booked_here[row] &= ~covered[row];
+    }
+    show.position = snapshot.position;
+    show.requested_ns = requested;
+    return true;
+}
+
+RegionalRead RegionalReadCache::fresh(ShowId show_id, Show& show, std::chrono::nanoseconds bound) {
+    const auto age_of = [&show](std::int64_t now) {
+        std::lock_guard<std::mutex> lock(show.mutex);
+        return show.requested_ns < 0 ? -1 : now - show.requested_ns;
+    };
+    std::int64_t age = age_of(steady_ns());
+    if (age >= 0 && age <= bound.count()) {
+        local_reads_.fetch_add(1u, std::memory_order_relaxed);
+        return RegionalRead{RegionalReadStatus::Ok, std::chrono::nanoseconds(age)};
+    }
+
+    // Past the bound: refresh, unless a reader that held the round trip meanwhile did. What
+    // a refresh returns is as fresh as an answer gets, even under a bound shorter than its trip
+    const std::lock_guard<std::mutex> refreshing(show.refresh_mutex);
+    age = age_of(steady_ns());
+    const bool refreshed = (age < 0 || age > bound.count()) && refresh(show_id, show);
+    age = age_of(steady_ns());
+    if (age < 0) return RegionalRead{RegionalReadStatus::UnknownShow, std::chrono::nanoseconds::max()};
+    if (!refreshed && age > bound.count()) {
+        stale_reads_.fetch_add(1u, std::memory_order_relaxed);
+        return RegionalRead{RegionalReadStatus::Stale, std::chrono::nanoseconds(age)};
+    }
+    refreshed_reads_.fetch_add(1u, std::memory_order_relaxed);
+    return RegionalRead{RegionalReadStatus::Ok, std::chrono::nanoseconds(age)};
+}
+
+RegionalRead RegionalReadCache::read(ShowId show_id, const std::shared_ptr<Show>& show,
+                                     std::chrono::nanoseconds bound) {
+    const RegionalRead r = fresh(show_id, *show, bound);
+    if (r.status == RegionalReadStatus::UnknownShow) {
+        // Do not keep entries for ids nobody has (a later read asks the home region again)
+        std::unique_lock<std::shared_mutex> lock(shows_mutex_);
+        const auto it = shows_.find(show_id);
+        if (it != shows_.end() && it->second == show) shows_.erase(it);
+    }
+    return r;
+}
+
+int RegionalReadCache::copy_free(const Show& show, SeatMask& out, std::shared_ptr<const HallLayout>* layout) {
+    out = SeatMask{};
+    std::lock_guard<std::mutex> lock(show.mutex);
+    if (layout) *layout = show.layout;
+    if (!show.layout) return 0;
+    int count = 0;
+    for (int w = 0; w < show.layout->row_count(); ++w) {
+        const auto row = static_cast<std::size_t>(w);
+        const std::uint64_t free = show.free[row] & ~show.booked_here[row];
+        out.or_word(w, free);
+        count += __builtin_popcountll(free);
+    }
+    return count;
+}
+
+RegionalRead RegionalReadCache::available_seats_mask(ShowId show_id, SeatMask& out_free,
+                                                     std::chrono::nanoseconds bound) {
+    const std::shared_ptr<Show> show = show_of(show_id);
+    const RegionalRead r = read(show_id, show, bound);
+    out_free = SeatMask{};
+    if (r.status != RegionalReadStatus::UnknownShow) copy_free(*show, out_free);
+    return r;
+}
+
+RegionalRead RegionalReadCache::available_count(ShowId show_id, int& out_count, std::chrono::nanoseconds bound) {
+    const std::shared_ptr<Show> show = show_of(show_id);
+    const RegionalRead r = read(show_id, show, bound);
+    SeatMask free;
+    out_count = r.status == RegionalReadStatus::UnknownShow ? 0 : copy_free(*show, free);
+    return r;
+}
+
+RegionalRead RegionalReadCache::list_available_seats(ShowId show_id, std::vector<std::string>& out,
+                                                     std::chrono::nanoseconds bound) {
+    out.clear();
+    const std::shared_ptr<Show> show = show_of(show_id);
+    const RegionalRead r = read(show_id, show, bound);
+    if (r.status == RegionalReadStatus::UnknownShow) return r;
+    SeatMask free;
+    std::shared_ptr<const HallLayout> layout;
+    out.reserve(static_cast<std::size_t>(copy_free(*show, free, &layout)));
+    if (!layout) return r;
+    for (int w = 0; w < layout->row_count(); ++w) {
+        for (std::uint64_t bits = free.word(w); bits != 0u; bits &= bits - 1u) {
+            out.emplace_back(layout->label_view(HallLayout::seat_index(w, __builtin_ctzll(bits))));
+        }
+    }
+    return r;
+}
+
+BookingResult RegionalReadCache::book_seats(ShowId show_id, const std::vector<std::string>& seats) {
+    forwarded_.fetch_add(1u, std::memory_order_relaxed);
+    const BookingResult r = book_(show_id, seats);
+    if (!r.success && r.status != BookingStatus::AlreadyBooked) return r;
+
+    std::shared_ptr<Show> show;
+    {
+        std::shared_lock<std::shared_mutex> lock(shows_mutex_);
+        const auto it = shows_.find(show_id);
+        if (it == shows_.end()) return r; // not read here: nothing to hide
+        show = it->second;
+    }
+    // The booked seats (or those the conflict names) are taken in the home region now
+    std::lock_guard<std::mutex> lock(show->mutex);
+    if (!show->layout) return r;
+    SeatMask taken = r.conflicts;
+    if (r.success) {
+        for (const std::string& label : seats) {
+            int seat = -1;
+            if (show->layout->try_parse_label(label, seat)) taken.set(seat);
+        }
+    }
+    for (int w = 0; w < show->layout->row_count(); ++w) {
+        show->booked_here[static_cast<std::size_t>(w)] |= taken.word(w);
+    }
+    return r;
+}
+
+BookingResult RegionalReadCache::cancel_seats(ShowId show_id, const std::vector<std::string>& seats,
+                                              BookingId booking_id) {
+    forwarded_.fetch_add(1u, std::memory_order_relaxed);
+    return cancel_(show_id, seats, booking_id);
+}
+
+std::size_t RegionalReadCache::refresh_all() {
+    std::vector<std::pair<ShowId, std::shared_ptr<Show>>> shows;
+    {
+        std::shared_lock<std::shared_mutex> lock(shows_mutex_);
+        shows.assign(shows_.begin(), shows_.end());
+    }
+    std::size_t failed = 0;
+    for (const auto& [show_id, show] : shows) {
+        const std::lock_guard<std::mutex> refreshing(show->refresh_mutex);
+        if (!refresh(show_id, *show)) ++failed;
+    }
+    return failed;
+}
+
+void RegionalReadCache::forget(ShowId show_id) {
+    std::unique_lock<std::shared_mutex> lock(shows_mutex_);
+    shows_.erase(show_id);
+}
+
+std::size_t RegionalReadCache::show_count() const {
+    std::shared_lock<std::shared_mutex> lock(shows_mutex_);
+    return shows_.size();
+}
+
+RegionalCacheStats RegionalReadCache::stats() const {
+    RegionalCacheStats s;
+    s.local_reads = local_reads_.load(std::memory_order_relaxed);
+    s.refreshed_reads = refreshed_reads_.load(std::memory_order_relaxed);
+    s.stale_reads = stale_reads_.load(std::memory_order_relaxed);
+    s.refreshes = refreshes_.load(std::memory_order_relaxed);
+    s.resyncs = resyncs_.load(std::memory_order_relaxed);
+    s.forwarded = forwarded_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void RegionalReadCache::run() {
+    std::unique_lock<std::mutex> lock(loop_mutex_);
+    while (!loop_cv_.wait_for(lock, options_.sync_interval, [this] { return loop_stop_; })) {
+        lock.unlock();
+        refresh_all();
+        lock.lock();
+    }
+}
+
+} // namespace booking
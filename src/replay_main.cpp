@@ -0,0 +1,103 @@
+#include "traffic_replay.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Replays a JSONL traffic capture (see traffic_replay.hpp) against a fresh service:
+//
+//   booking_replay [--workers=N] [--schedule=FILE] CAPTURE.jsonl
+//
+// The capture is memory-mapped; the final seat-state checksum is independent of --workers,
+// so two runs of the same capture can be compared.
+
+namespace {
+
+struct Options {
+    booking::ReplayOptions replay;
+    std::string schedule;   // schedule file to load into an empty catalog
+    std::string capture;
+};
+
+bool parse_option(const char* arg, Options& o) {
+    if (std::strncmp(arg, "--", 2) != 0) {
+        if (!o.capture.empty()) return false;
+        o.capture = arg;
+        return true;
+    }
+    const char* eq = std::strchr(arg, '=');
+    if (!eq) return false;
+    const std::string key(arg + 2, eq);
+    const char* v = eq + 1;
+    if (key == "workers") o.replay.workers = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+    else if (key == "schedule") o.schedule = v;
+    else return false;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        if (!parse_option(argv[i], o)) {
+            std::cerr << "unknown option " << argv[i] << "\n";
+            o.capture.clear();
+            break;
+        }
+    }
+    if (o.capture.empty()) {
+        std::cerr << "usage: booking_replay [--workers=N] [--schedule=FILE] CAPTURE.jsonl\n";
+        return 2;
+    }
+
+    std::unique_ptr<booking::BookingService> svc;
+    if (o.schedule.empty()) {
+        svc = std::make_unique<booking::BookingService>();
+    } else {
+        svc = std::make_unique<booking::BookingService>(booking::BookingService::EmptyCatalog{});
+        const booking::ScheduleError err = svc->load_schedule_file(o.schedule);
+        if (err.status != booking::ScheduleStatus::Ok) {
+            std::cerr << o.schedule << ":" << err.line << ": " << booking::to_string(err.status) << ": " << err.reason
+                      << "\n";
+            return 1;
+        }
+    }
+
+    const int fd = ::open(o.capture.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st {};
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+        std::perror(o.capture.c_str());
+        return 1;
+    }
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* map = size != 0u ? ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        std::perror("mmap");
+        return 1;
+    }
+    if (map) ::madvise(map, size, MADV_SEQUENTIAL);
+
+    const booking::ReplayStats s =
+        booking::replay_traffic(*svc, std::string_view(static_cast<const char*>(map), size), o.replay);
+    if (map) ::munmap(map, size);
+
+    std::printf("lines      %llu\n", static_cast<unsigned long long>(s.lines));
+    std::printf("ops        %llu (%.0f ops/s)\n", static_cast<unsigned long long>(s.ops),
+                s.seconds > 0.0 ? static_cast<double>(s.ops) / s.seconds : 0.0);
+    std::printf("failed     %llu\n", static_cast<unsigned long long>(s.failed));
+    std::printf("malformed  %llu\n", static_cast<unsigned long long>(s.malformed));
+    std::printf("unmapped   %llu\n", static_cast<unsigned long long>(s.unmapped));
+    std::printf("seconds    %.3f\n", s.seconds);
+    std::printf("checksum   %016llx\n", static_cast<unsigned long long>(s.checksum));
+    return s.malformed != 0u ? 3 : 0;
+}
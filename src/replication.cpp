@@ -0,0 +1,460 @@
+#include "replication.hpp"
+
+#include "journal.hpp"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+namespace booking {
+
+namespace {
+
+constexpr char kReplicationMagic[8] = {'B', 'K', 'R', 'E', 'P', 'L', '\r', '\n'};
+constexpr std::uint32_t kCaughtUp = 1u;
+
+/** @brief Journal bytes a shipper reads at a time (at least one record of 64 rows). */
+constexpr std::size_t kShipChunk = 256 * 1024;
+
+/** @brief Largest journal record: its 32-byte header and a seat word per row. */
+constexpr std::size_t kMaxRecordBytes = 32u + 8u * SeatMask::kWords;
+
+/** @brief Largest frame a replica accepts. */
+constexpr std::uint32_t kMaxFrameBytes = 16u << 20;
+
+struct Hello {
+    char magic[8];
+    std::uint64_t from_lsn;
+};
+
+struct FrameHeader {
+    std::uint32_t bytes;
+    std::uint32_t flags;
+    std::uint64_t next_lsn;
+};
+
+/** @brief Replica -> source: every record below next_lsn is applied (and durable in the mirror). */
+struct Ack {
+    std::uint64_t next_lsn;
+};
+
+static_assert(sizeof(Hello) == 16 && sizeof(FrameHeader) == 16 && sizeof(Ack) == 8, "replication stream layout");
+
+std::int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool send_all(int fd, const void* data, std::size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0u) {
+        const ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool recv_all(int fd, void* data, std::size_t size) {
+    char* p = static_cast<char*>(data);
+    while (size > 0u) {
+        const ssize_t n = ::recv(fd, p, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+const char* to_string(ReplicationStatus status) {
+    switch (status) {
+        case ReplicationStatus::Ok: return "replicating";
+        case ReplicationStatus::SocketError: return "cannot create socket";
+        case ReplicationStatus::BindError: return "cannot bind and listen on the address";
+        case ReplicationStatus::ConnectError: return "cannot connect to the primary";
+        case ReplicationStatus::IoError: return "cannot open the replica journal";
+    }
+    return "unknown status";
+}
+
+// ---------- Primary ----------
+
+struct ReplicationSource::Shipper {
+    int fd = -1;
+    int wake_fd = -1;                   /**< eventfd: a commit waiter wants the journal shipped now. */
+    std::atomic<std::uint64_t> acked{0}; /**< Replica's last acknowledged next LSN. */
+    std::atomic<bool> done{false};
+    std::thread thread;
+};
+
+ReplicationSource::ReplicationSource(std::string journal_path, ReplicationOptions options)
+    : path_(std::move(journal_path)), options_(std::move(options)) {}
+
+ReplicationSource::~ReplicationSource() {
+    stop();
+}
+
+ReplicationStatus ReplicationSource::listen() {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) return ReplicationStatus::SocketError;
+    const int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options_.port);
+    if (::inet_pton(AF_INET, options_.host.c_str(), &addr.sin_addr) != 1
+        || ::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0
+        || ::listen(listen_fd_, 64) != 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return ReplicationStatus::BindError;
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    acceptor_ = std::thread([this] { accept_loop(); });
+    return ReplicationStatus::Ok;
+}
+
+void ReplicationSource::stop() {
+    stop_.store(true, std::memory_order_release);
+    if (listen_fd_ >= 0) ::shutdown(listen_fd_, SHUT_RDWR); // wakes accept()
+    if (acceptor_.joinable()) acceptor_.join();
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+    }
+    std::vector<std::unique_ptr<Shipper>> shippers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shippers.swap(shippers_);
+        commit_cv_.notify_all(); // commit waiters give up
+    }
+    // Joined without the lock: shippers take it to publish acknowledgements
+    for (const auto& s : shippers) ::shutdown(s->fd, SHUT_RDWR); // wakes blocked sends
+    for (const auto& s : shippers) {
+        s->thread.join();
+        ::close(s->fd);
+        ::close(s->wake_fd);
+    }
+}
+
+bool ReplicationSource::wait_committed(std::uint64_t commit_lsn) {
+    if (options_.sync_replicas <= 0 || committed_.load(std::memory_order_acquire) >= commit_lsn) return true;
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!kicked_.exchange(true, std::memory_order_acq_rel)) {
+        // Cut the shippers' poll interval short: the record is in the file already
+        const std::uint64_t one = 1;
+        for (const auto& s : shippers_) {
+            if (::write(s->wake_fd, &one, sizeof(one)) < 0) break;
+        }
+    }
+    commit_cv_.wait(lock, [&] {
+        return committed_.load(std::memory_order_acquire) >= commit_lsn || stop_.load(std::memory_order_acquire);
+    });
+    return committed_.load(std::memory_order_acquire) >= commit_lsn;
+}
+
+void ReplicationSource::update_commit_locked() {
+    // The sync_replicas-th highest acknowledgement among the connected replicas
+    const auto k = static_cast<std::size_t>(options_.sync_replicas);
+    std::vector<std::uint64_t> acked;
+    for (const auto& s : shippers_) {
+        if (!s->done.load(std::memory_order_acquire)) acked.push_back(s->acked.load(std::memory_order_acquire));
+    }
+    if (k == 0u || acked.size() < k) return;
+    std::nth_element(acked.begin(), acked.begin() + static_cast<std::ptrdiff_t>(k - 1u), acked.end(),
+                     std::greater<std::uint64_t>());
+    if (acked[k - 1u] > committed_.load(std::memory_order_relaxed)) {
+        committed_.store(acked[k - 1u], std::memory_order_release);
+        commit_cv_.notify_all();
+    }
+}
+
+void ReplicationSource::accept_loop() {
+    while (!stop_.load(std::memory_order_acquire)) {
+        const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return; // shut down by stop()
+        }
+        const int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        std::lock_guard<std::mutex> lock(mutex_);
+        reap_locked();
+        if (stop_.load(std::memory_order_acquire)) {
+            ::close(fd);
+            return;
+        }
+        auto shipper = std::make_unique<Shipper>();
+        Shipper* s = shipper.get();
+        s->fd = fd;
+        s->wake_fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        replicas_.fetch_add(1u, std::memory_order_relaxed);
+        s->thread = std::thread([this, s] {
+            ship(*s);
+            replicas_.fetch_sub(1u, std::memory_order_relaxed);
+            s->done.store(true, std::memory_order_release);
+        });
+        shippers_.push_back(std::move(shipper));
+    }
+}
+
+void ReplicationSource::reap_locked() {
+    auto keep = shippers_.begin();
+    for (auto& s : shippers_) {
+        if (s->done.load(std::memory_order_acquire)) {
+            s->thread.join();
+            ::close(s->fd);
+            ::close(s->wake_fd);
+        } else {
+            *keep++ = std::move(s);
+        }
+    }
+    shippers_.erase(keep, shippers_.end());
+}
+
+void ReplicationSource::ship(Shipper& s) {
+    const int fd = s.fd;
+    Hello hello;
+    if (!recv_all(fd, &hello, sizeof(hello)) || std::memcmp(hello.magic, kReplicationMagic, sizeof(hello.magic)) != 0) {
+        return;
+    }
+    std::unique_ptr<char[]> buf(new char[kShipChunk]);
+    off_t file_pos = 0;         // journal offset just past buf's bytes
+    bool header_checked = false;
+    int file = -1;
+    std::uint64_t next_lsn = hello.from_lsn;
+    std::uint64_t resume_lsn = hello.from_lsn; // records below are not shipped
+    std::int64_t last_frame_ns = 0;
+    const std::int64_t heartbeat_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(options_.heartbeat_interval).count();
+    Ack ack{};
+    std::size_t ack_filled = 0; // bytes of a partially received acknowledgement
+
+    bool alive = true;
+    while (alive && !stop_.load(std::memory_order_acquire)) {
+        if (file < 0) file = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+        // Checked before the read: once a compacted journal has replaced the file, the old
+        // one no longer grows, so reading it to its end ships everything it holds
+        struct stat named{};
+        struct stat opened{};
+        const bool replaced = file >= 0 && ::stat(path_.c_str(), &named) == 0 && ::fstat(file, &opened) == 0
+                              && named.st_ino != opened.st_ino;
+        ssize_t got = 0;
+        if (file >= 0) {
+            got = ::pread(file, buf.get(), kShipChunk, file_pos);
+            if (got < 0) got = 0;
+        }
+        bool at_end = static_cast<std::size_t>(got) < kShipChunk; // read to the end of the file
+        const std::size_t filled = static_cast<std::size_t>(got);
+        file_pos += got;
+
+        std::size_t begin = 0;
+        if (!header_checked && filled >= kJournalHeaderSize) {
+            if (JournalReader(std::string_view(buf.get(), kJournalHeaderSize)).status() != JournalStatus::Ok) break;
+            header_checked = true;
+            begin = kJournalHeaderSize;
+        }
+        std::size_t skip = 0;
+        std::size_t used = 0;
+        if (header_checked) {
+            // Whole records only; records before the replica's resume point are skipped
+            JournalReader reader = JournalReader::records(std::string_view(buf.get() + begin, filled - begin));
+            JournalRecord r;
+            while (reader.next(r)) {
+                if (r.lsn < resume_lsn) {
+                    skip = reader.offset();
+                } else {
+                    next_lsn = std::max(next_lsn, r.end_lsn);
+                }
+            }
+            used = reader.offset();
+        }
+        // Bytes past the last whole record are read again next time. More of them than any
+        // record takes is not a record cut by the chunk but the zero-filled, preallocated end
+        // of a Mapped journal: the end of the journal for now
+        const std::size_t consumed = header_checked ? begin + used : 0u;
+        const std::size_t rest = filled - consumed;
+        at_end = at_end || (header_checked && rest >= kMaxRecordBytes);
+
+        const std::int64_t now = steady_ns();
+        const bool caught_up = at_end && !replaced; // a replaced file has newer records elsewhere
+        if (used > skip || (caught_up && now - last_frame_ns >= heartbeat_ns)) {
+            const FrameHeader h{static_cast<std::uint32_t>(used - skip), caught_up ? kCaughtUp : 0u, next_lsn};
+            alive = send_all(fd, &h, sizeof(h)) && send_all(fd, buf.get() + begin + skip, used - skip);
+            last_frame_ns = now;
+            if (used > skip) kicked_.store(false, std::memory_order_release);
+        }
+        file_pos -= static_cast<off_t>(rest);
+        if (replaced && at_end) {
+            // Continue in the compacted file after the last record shipped (Journal::compact)
+            ::close(file);
+            file = -1;
+            file_pos = 0;
+            header_checked = false;
+            resume_lsn = next_lsn;
+            continue;
+        }
+
+        // Idle: wait for the poll interval, an acknowledgement or a commit waiter's kick
+        pollfd fds[2] = {{fd, POLLIN, 0}, {s.wake_fd, POLLIN, 0}};
+        if (alive && at_end && ::poll(fds, 2, static_cast<int>(options_.poll_interval.count())) > 0
+            && (fds[1].revents & POLLIN) != 0) {
+            std::uint64_t kicks;
+            if (::read(s.wake_fd, &kicks, sizeof(kicks)) < 0) kicks = 0;
+        }
+        // Take every acknowledgement that arrived, without blocking
+        bool advanced = false;
+        while (alive) {
+            const ssize_t n =
+                ::recv(fd, reinterpret_cast<char*>(&ack) + ack_filled, sizeof(ack) - ack_filled, MSG_DONTWAIT);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) break; // EAGAIN: nothing more for now
+            alive = n > 0;
+            ack_filled += static_cast<std::size_t>(std::max<ssize_t>(n, 0));
+            if (ack_filled == sizeof(ack)) {
+                ack_filled = 0;
+                if (ack.next_lsn > s.acked.load(std::memory_order_relaxed)) {
+                    s.acked.store(ack.next_lsn, std::memory_order_release);
+                    advanced = true;
+                }
+            }
+        }
+        if (advanced && options_.sync_replicas > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            update_commit_locked();
+        }
+    }
+    if (file >= 0) ::close(file);
+}
+
+// ---------- Replica ----------
+
+ReplicaClient::ReplicaClient(BookingService& service, ReplicationOptions options)
+    : service_(service), options_(std::move(options)) {}
+
+ReplicaClient::~ReplicaClient() {
+    stop();
+}
+
+ReplicationStatus ReplicaClient::start(const std::string& host, std::uint16_t port, std::uint64_t from_lsn) {
+    stop();
+    stop_.store(false, std::memory_order_release);
+    host_ = host;
+    port_ = port;
+    if (!options_.journal_path.empty() && !mirror_) {
+        auto mirror = std::make_unique<JournalMirror>();
+        if (mirror->open(options_.journal_path) != JournalStatus::Ok) return ReplicationStatus::IoError;
+        mirror_ = std::move(mirror);
+    }
+    if (mirror_) from_lsn = std::max(from_lsn, mirror_->next_lsn());
+    next_lsn_.store(from_lsn, std::memory_order_release);
+    const int fd = dial();
+    if (fd < 0) return ReplicationStatus::ConnectError;
+    thread_ = std::thread([this, fd] { run(fd); });
+    return ReplicationStatus::Ok;
+}
+
+void ReplicaClient::stop() {
+    stop_.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(fd_mutex_);
+        if (fd_ >= 0) ::shutdown(fd_, SHUT_RDWR); // wakes the blocked recv
+    }
+    if (thread_.joinable()) thread_.join();
+}
+
+std::chrono::nanoseconds ReplicaClient::staleness() const {
+    const std::int64_t at = caught_up_ns_.load(std::memory_order_acquire);
+    if (at < 0) return std::chrono::nanoseconds::max();
+    return std::chrono::nanoseconds(std::max<std::int64_t>(0, steady_ns() - at));
+}
+
+int ReplicaClient::dial() const {
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port_);
+    Hello hello;
+    std::memcpy(hello.magic, kReplicationMagic, sizeof(hello.magic));
+    hello.from_lsn = next_lsn_.load(std::memory_order_acquire);
+    if (::inet_pton(AF_INET, host_.c_str(), &addr.sin_addr) != 1
+        || ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0
+        || !send_all(fd, &hello, sizeof(hello))) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void ReplicaClient::run(int fd) {
+    while (fd >= 0) {
+        {
+            std::lock_guard<std::mutex> lock(fd_mutex_);
+            fd_ = fd;
+        }
+        if (!stop_.load(std::memory_order_acquire)) {
+            connected_.store(true, std::memory_order_release);
+            receive(fd);
+            connected_.store(false, std::memory_order_release);
+        }
+        {
+            std::lock_guard<std::mutex> lock(fd_mutex_);
+            fd_ = -1;
+            ::close(fd);
+        }
+        fd = -1;
+        // Reconnect and resume where the stream stopped
+        while (fd < 0 && !stop_.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(options_.reconnect_interval);
+            if (!stop_.load(std::memory_order_acquire)) fd = dial();
+        }
+    }
+}
+
+void ReplicaClient::receive(int fd) {
+    std::string payload;
+    FrameHeader h;
+    while (recv_all(fd, &h, sizeof(h)) && h.bytes <= kMaxFrameBytes) {
+        payload.resize(h.bytes);
+        if (h.bytes != 0u && !recv_all(fd, &payload[0], h.bytes)) return;
+        if (mirror_ && !mirror_->append(payload)) return; // not durable: no acknowledgement
+        JournalReader reader = JournalReader::records(payload);
+        JournalRecord r;
+        while (reader.next(r)) {
+            if (service_.apply_journal_record(r)) {
+                applied_.fetch_add(1u, std::memory_order_relaxed);
+            } else {
+                skipped_.fetch_add(1u, std::memory_order_relaxed);
+            }
+        }
+        if (reader.offset() != payload.size()) return; // corrupt frame: reconnect
+        if (h.next_lsn > next_lsn_.load(std::memory_order_relaxed)) {
+            next_lsn_.store(h.next_lsn, std::memory_order_release);
+        }
+        if ((h.flags & kCaughtUp) != 0u) caught_up_ns_.store(steady_ns(), std::memory_order_release);
+        const Ack ack{next_lsn_.load(std::memory_order_relaxed)};
+        if (!send_all(fd, &ack, sizeof(ack))) return;
+    }
+}
+
+} // namespace booking
@@ -0,0 +1,13 @@
+#include "request_arena.hpp"
+
+namespace booking {
+
+RequestArena::RequestArena(std::size_t capacity, std::pmr::memory_resource* upstream)
+    : capacity_(capacity), buffer_(new std::byte[capacity]), resource_(buffer_.get(), capacity, upstream) {}
+
+RequestArena& RequestArena::local() {
+    thread_local RequestArena arena;
+    return arena;
+}
+
+} // namespace booking
@@ -0,0 +1,173 @@
+#include "request_dedupe.hpp"
+
+namespace booking {
+
+namespace {
+
+// Slot phases (low two bits of the state; 0 = key just claimed, state not written yet)
+constexpr std::uint64_t kPending = 1;
+constexpr std::uint64_t kDone = 2;
+constexpr std::uint64_t kLocked = 3;  /**< Being handed to another request id. */
+
+std::uint64_t mix64(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+std::size_t table_size(std::size_t capacity) {
+    std::size_t n = RequestDedupe::kProbe;
+    while (n < capacity) n <<= 1;
+    return n;
+}
+
+std::uint64_t make_state(std::int64_t expiry_ns, std::uint64_t phase) {
+    return (static_cast<std::uint64_t>(expiry_ns < 0 ? 0 : expiry_ns) << 2) | phase;
+}
+
+std::uint64_t phase_of(std::uint64_t state) {
+    return state & 3u;
+}
+
+/** @brief True if the slot in @p state may be given to another request. */
+bool reusable(std::uint64_t state, std::int64_t now_ns) {
+    const std::uint64_t phase = phase_of(state);
+    return (phase == kDone || phase == kPending) && static_cast<std::int64_t>(state >> 2) <= now_ns;
+}
+
+} // namespace
+
+RequestDedupe::RequestDedupe(std::chrono::nanoseconds ttl, std::size_t capacity)
+    : slots_(new Slot[table_size(capacity)]), mask_(table_size(capacity) - 1u), ttl_ns_(ttl.count()) {}
+
+std::int64_t RequestDedupe::now_ns() {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+RequestDedupe::Claim RequestDedupe::claim(std::uint64_t request_id, std::uint64_t fingerprint, std::int64_t now_ns,
+                                          Record& out, Ticket& out_ticket) {
+    const std::uint64_t key = request_id + 1u;
+    if (key == 0u) {
+        untracked_.fetch_add(1u, std::memory_order_relaxed);
+        return Claim::Untracked;
+    }
+    const std::size_t home = static_cast<std::size_t>(mix64(request_id));
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        std::size_t spare = 0;
+        std::uint64_t spare_state = 0;
+        bool have_spare = false;
+        bool again = false;
+        for (std::size_t i = 0; i < kProbe && !again; ++i) {
+            const std::size_t index = (home + i) & mask_;
+            Slot& s = slots_[index];
+            std::uint64_t k = s.key.load(std::memory_order_acquire);
+            if (k == 0u && s.key.compare_exchange_strong(k, key, std::memory_order_acq_rel)) {
+                s.fingerprint.store(fingerprint, std::memory_order_relaxed);
+                out_ticket = Ticket{index, make_state(now_ns + ttl_ns_, kPending)};
+                s.state.store(out_ticket.state, std::memory_order_release);
+                return Claim::Owner;
+            }
+            if (k == key) { // found, or claimed by a concurrent repeat
+                Claim result = Claim::Untracked;
+                if (match(index, key, fingerprint, now_ns, out, out_ticket, result)) return result;
+                again = true; // the slot moved on to another id meanwhile
+                continue;
+            }
+            // Keys are never cleared, so an id lives before the first never-used slot of its window
+            const std::uint64_t st = s.state.load(std::memory_order_acquire);
+            if (!have_spare && reusable(st, now_ns)) {
+                spare = index;
+                spare_state = st;
+                have_spare = true;
+            }
+        }
+        if (again) continue;
+        if (!have_spare) break;
+        // Concurrent newcomers pick the same first expired slot; the loser looks again
+        if (take_over(spare, spare_state, key, fingerprint, now_ns, out_ticket)) return Claim::Owner;
+    }
+    untracked_.fetch_add(1u, std::memory_order_relaxed);
+    return Claim::Untracked;
+}
+
+bool RequestDedupe::match(std::size_t index, std::uint64_t key, std::uint64_t fingerprint, std::int64_t now_ns,
+                          Record& out, Ticket& ticket, Claim& result) {
+    Slot& s = slots_[index];
+    while (true) {
+        const std::uint64_t st = s.state.load(std::memory_order_acquire);
+        if (s.key.load(std::memory_order_acquire) != key) return false;
+        if (reusable(st, now_ns)) {
+            // Expired (or abandoned): this request runs afresh in the same slot
+            if (!take_over(index, st, key, fingerprint, now_ns, ticket)) continue;
+            result = Claim::Owner;
+            return true;
+        }
+        if (phase_of(st) != kDone) {
+            result = Claim::InFlight;
+            return true;
+        }
+        const std::uint64_t fp = s.fingerprint.load(std::memory_order_relaxed);
+        const std::uint64_t id = s.id.load(std::memory_order_relaxed);
+        const std::uint64_t outcome = s.outcome.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s.state.load(std::memory_order_relaxed) != st || s.key.load(std::memory_order_relaxed) != key) continue;
+        if (fp != fingerprint) {
+            mismatches_.fetch_add(1u, std::memory_order_relaxed);
+            result = Claim::Mismatch;
+            return true;
+        }
+        out.id = id;
+        out.status = static_cast<std::uint32_t>(outcome >> 32);
+        out.detail = static_cast<std::int32_t>(static_cast<std::uint32_t>(outcome));
+        replays_.fetch_add(1u, std::memory_order_relaxed);
+        result = Claim::Replay;
+        return true;
+    }
+}
+
+bool RequestDedupe::take_over(std::size_t index, std::uint64_t seen, std::uint64_t key, std::uint64_t fingerprint,
+                              std::int64_t now_ns, Ticket& ticket) {
+    Slot& s = slots_[index];
+    if (!s.state.compare_exchange_strong(seen, make_state(now_ns, kLocked), std::memory_order_acq_rel)) return false;
+    std::atomic_thread_fence(std::memory_order_release); // seqlock writer: the lock before the fields
+    s.key.store(key, std::memory_order_relaxed);
+    s.fingerprint.store(fingerprint, std::memory_order_relaxed);
+    ticket = Ticket{index, make_state(now_ns + ttl_ns_, kPending)};
+    s.state.store(ticket.state, std::memory_order_release);
+    return true;
+}
+
+void RequestDedupe::complete(const Ticket& ticket, const Record& record, std::int64_t now_ns) {
+    Slot& s = slots_[ticket.slot];
+    std::uint64_t pending = ticket.state;
+    if (!s.state.compare_exchange_strong(pending, make_state(now_ns, kLocked), std::memory_order_acq_rel)) return;
+    std::atomic_thread_fence(std::memory_order_release);
+    s.id.store(record.id, std::memory_order_relaxed);
+    s.outcome.store((static_cast<std::uint64_t>(record.status) << 32) | static_cast<std::uint32_t>(record.detail),
+                    std::memory_order_relaxed);
+    s.state.store(make_state(now_ns + ttl_ns_, kDone), std::memory_order_release);
+}
+
+void RequestDedupe::abandon(const Ticket& ticket) {
+    std::uint64_t pending = ticket.state;
+    slots_[ticket.slot].state.compare_exchange_strong(pending, make_state(0, kDone), std::memory_order_acq_rel);
+}
+
+DedupeStats RequestDedupe::stats(std::int64_t now_ns) const {
+    DedupeStats out;
+    for (std::size_t i = 0; i <= mask_; ++i) {
+        const Slot& s = slots_[i];
+        if (s.key.load(std::memory_order_relaxed) != 0u && !reusable(s.state.load(std::memory_order_relaxed), now_ns)) {
+            ++out.entries;
+        }
+    }
+    out.replays = replays_.load(std::memory_order_relaxed);
+    out.mismatches = mismatches_.load(std::memory_order_relaxed);
+    out.untracked = untracked_.load(std::memory_order_relaxed);
+    return out;
+}
+
+} // namespace booking
@@ -0,0 +1,181 @@
+#include "sales_analytics.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace booking {
+
+namespace {
+
+bool power_of_two(std::size_t n) {
+    return n != 0u && (n & (n - 1u)) == 0u;
+}
+
+/** @brief splitmix64 finaliser: movie ids and customer ids are often small and sequential. */
+std::uint64_t mix(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+std::size_t slot_of(std::int64_t minute, std::size_t minutes) {
+    const std::int64_t n = static_cast<std::int64_t>(minutes);
+    return static_cast<std::size_t>(((minute % n) + n) % n);
+}
+
+} // namespace
+
+SalesAnalytics::SalesAnalytics(const SalesAnalyticsOptions& options) : options_(options) {
+    if (options.minutes == 0u || !power_of_two(options.width) || options.depth == 0u || options.depth > 16u
+        || options.hll_precision < 4 || options.hll_precision > 16 || !power_of_two(options.movies)) {
+        throw std::invalid_argument("SalesAnalytics: invalid options");
+    }
+}
+
+SalesAnalytics::~SalesAnalytics() = default;
+
+std::int64_t SalesAnalytics::current_minute() {
+    return std::chrono::duration_cast<std::chrono::minutes>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+std::unique_ptr<SalesAnalytics::Shard> SalesAnalytics::make_shard() const {
+    auto shard = std::make_unique<Shard>();
+    shard->minutes.reset(new MinuteTable[options_.minutes]);
+    for (std::size_t m = 0; m < options_.minutes; ++m) {
+        shard->minutes[m].cells.reset(new std::atomic<std::uint32_t>[options_.depth * options_.width]());
+    }
+    shard->movies.reset(new MovieRegisters[options_.movies]);
+    return shard;
+}
+
+std::size_t SalesAnalytics::cell_of(std::uint64_t hash, std::size_t row) const {
+    // Rows index with h1 + row * h2 (Kirsch-Mitzenmacher), h2 odd so the rows differ
+    const std::uint64_t h1 = hash & 0xFFFFFFFFu;
+    const std::uint64_t h2 = (hash >> 32) | 1u;
+    return row * options_.width + static_cast<std::size_t>((h1 + row * h2) & (options_.width - 1u));
+}
+
+void SalesAnalytics::record(MovieId movie, std::uint64_t customer, std::uint32_t tickets, std::int64_t minute) {
+    Shard& shard = shards_.local([this] { return make_shard(); });
+    const std::uint64_t hash = mix(static_cast<std::uint64_t>(movie.value()));
+
+    MinuteTable& table = shard.minutes[slot_of(minute, options_.minutes)];
+    const std::int64_t held = table.minute.load(std::memory_order_relaxed);
+    bool counted = tickets != 0u && held <= minute;
+    if (counted && held != minute) {
+        // Recycle the slot; readers seeing -1 or a changed minute around their reads drop them
+        table.minute.store(-1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t c = 0; c < options_.depth * options_.width; ++c) {
+            table.cells[c].store(0u, std::memory_order_relaxed);
+        }
+        table.minute.store(minute, std::memory_order_release);
+    }
+    for (std::size_t row = 0; counted && row < options_.depth; ++row) {
+        std::atomic<std::uint32_t>& cell = table.cells[cell_of(hash, row)];
+        cell.store(cell.load(std::memory_order_relaxed) + tickets, std::memory_order_relaxed);
+    }
+
+    if (customer == 0u) return;
+    const std::size_t mask = options_.movies - 1u;
+    for (std::size_t probe = 0; probe < options_.movies; ++probe) {
+        MovieRegisters& slot = shard.movies[(hash + probe) & mask];
+        const std::int64_t key = slot.movie.load(std::memory_order_relaxed);
+        if (key != movie.value() && key != -1) continue;
+        if (key == -1) {
+            slot.registers.reset(new std::atomic<std::uint8_t>[std::size_t{1} << options_.hll_precision]());
+            slot.movie.store(movie.value(), std::memory_order_release);
+        }
+        const int p = options_.hll_precision;
+        const std::uint64_t x = mix(customer);
+        const std::uint64_t rest = x << p;
+        const std::uint8_t rank =
+            static_cast<std::uint8_t>(rest == 0u ? 64 - p + 1 : __builtin_clzll(rest) + 1);
+        std::atomic<std::uint8_t>& reg = slot.registers[static_cast<std::size_t>(x >> (64 - p))];
+        if (rank > reg.load(std::memory_order_relaxed)) reg.store(rank, std::memory_order_relaxed);
+        return;
+    }
+    // Every slot holds another movie: this thread adds no customers for this one
+}
+
+void SalesAnalytics::set_show_movie(ShowId show, MovieId movie) {
+    if (ShowMovie* entry = show_movies_.find(show)) {
+        entry->movie.store(movie.value(), std::memory_order_relaxed);
+        return;
+    }
+    show_movies_.emplace(show, [&](ShowMovie& entry) { entry.movie.store(movie.value(), std::memory_order_relaxed); });
+}
+
+MovieId SalesAnalytics::movie_of(ShowId show) const {
+    const ShowMovie* entry = show_movies_.find(show);
+    return entry ? MovieId(entry->movie.load(std::memory_order_relaxed)) : MovieId();
+}
+
+std::uint64_t SalesAnalytics::tickets(MovieId movie, std::int64_t minute) const {
+    const std::uint64_t hash = mix(static_cast<std::uint64_t>(movie.value()));
+    std::uint64_t sums[16] = {};
+    std::uint32_t row_cells[16];
+    const std::size_t slot = slot_of(minute, options_.minutes);
+    shards_.for_each([&](const Shard& shard) {
+        const MinuteTable& table = shard.minutes[slot];
+        if (table.minute.load(std::memory_order_acquire) != minute) return;
+        for (std::size_t row = 0; row < options_.depth; ++row) {
+            row_cells[row] = table.cells[cell_of(hash, row)].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (table.minute.load(std::memory_order_relaxed) != minute) return; // recycled while read
+        for (std::size_t row = 0; row < options_.depth; ++row) sums[row] += row_cells[row];
+    });
+    // Count-min: cells only collect extra tickets of colliding movies, so the smallest is closest
+    return *std::min_element(sums, sums + options_.depth);
+}
+
+std::vector<std::uint64_t> SalesAnalytics::tickets_per_minute(MovieId movie, std::int64_t from_minute,
+                                                              std::int64_t to_minute) const {
+    std::vector<std::uint64_t> out;
+    if (to_minute <= from_minute) return out;
+    out.reserve(static_cast<std::size_t>(to_minute - from_minute));
+    for (std::int64_t m = from_minute; m < to_minute; ++m) out.push_back(tickets(movie, m));
+    return out;
+}
+
+double SalesAnalytics::distinct_customers(MovieId movie) const {
+    const std::size_t registers = std::size_t{1} << options_.hll_precision;
+    const std::uint64_t hash = mix(static_cast<std::uint64_t>(movie.value()));
+    std::vector<std::uint8_t> merged(registers, 0u);
+    bool seen = false;
+    shards_.for_each([&](const Shard& shard) {
+        const std::size_t mask = options_.movies - 1u;
+        for (std::size_t probe = 0; probe < options_.movies; ++probe) {
+            const MovieRegisters& slot = shard.movies[(hash + probe) & mask];
+            const std::int64_t key = slot.movie.load(std::memory_order_acquire);
+            if (key == -1) return;
+            if (key != movie.value()) continue;
+            for (std::size_t r = 0; r < registers; ++r) {
+                merged[r] = std::max(merged[r], slot.registers[r].load(std::memory_order_relaxed));
+            }
+            seen = true;
+            return;
+        }
+    });
+    if (!seen) return 0.0;
+
+    const double m = static_cast<double>(registers);
+    double inverse_sum = 0.0;
+    std::size_t zeros = 0;
+    for (const std::uint8_t reg : merged) {
+        inverse_sum += std::ldexp(1.0, -static_cast<int>(reg));
+        zeros += reg == 0u ? 1u : 0u;
+    }
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+    const double raw = alpha * m * m / inverse_sum;
+    // Small cardinalities: linear counting over the empty registers is more accurate
+    if (raw <= 2.5 * m && zeros != 0u) return m * std::log(m / static_cast<double>(zeros));
+    return raw;
+}
+
+} // namespace booking
@@ -0,0 +1,304 @@
+#include "schedule_loader.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+
+#include "thread_pool.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace booking {
+
+const char* to_string(ScheduleStatus status) {
+    switch (status) {
+        case ScheduleStatus::Ok: return "Schedule loaded";
+        case ScheduleStatus::IoError: return "Cannot read schedule file";
+        case ScheduleStatus::ParseError: return "Malformed schedule record";
+        case ScheduleStatus::CatalogError: return "Schedule conflicts with the catalog";
+    }
+    return "Unknown status";
+}
+
+namespace {
+
+// Splits one CSV line into fields; quoted fields are unescaped into `scratch`
+class FieldReader {
+public:
+    explicit FieldReader(std::string_view line) : rest_(line) {}
+
+    bool next(std::string_view& out, std::string& scratch) {
+        if (done_) return false;
+        if (!rest_.empty() && rest_.front() == '"') {
+            scratch.clear();
+            std::size_t i = 1;
+            while (true) {
+                if (i >= rest_.size()) return fail(); // unterminated quote
+                if (rest_[i] == '"') {
+                    if (i + 1 < rest_.size() && rest_[i + 1] == '"') {
+                        scratch += '"';
+                        i += 2;
+                        continue;
+                    }
+                    break;
+                }
+                scratch += rest_[i++];
+            }
+            out = scratch;
+            rest_.remove_prefix(i + 1);
+            if (rest_.empty()) {
+                done_ = true;
+            } else if (rest_.front() == ',') {
+                rest_.remove_prefix(1);
+            } else {
+                return fail(); // garbage after the closing quote
+            }
+            return true;
+        }
+        const std::size_t comma = rest_.find(',');
+        out = rest_.substr(0, comma);
+        if (comma == std::string_view::npos) {
+            done_ = true;
+        } else {
+            rest_.remove_prefix(comma + 1);
+        }
+        return true;
+    }
+
+    /** True if a quoted field was malformed. */
+    bool malformed() const { return malformed_; }
+
+private:
+    bool fail() {
+        malformed_ = true;
+        done_ = true;
+        return false;
+    }
+
+    std::string_view rest_;
+    bool done_ = false;
+    bool malformed_ = false;
+};
+
+template <typename Int>
+bool parse_int(std::string_view s, Int& out) {
+    if (s.empty()) return false;
+    const char* end = s.data() + s.size();
+    auto r = std::from_chars(s.data(), end, out);
+    return r.ec == std::errc() && r.ptr == end;
+}
+
+template <typename Tag>
+bool parse_id(std::string_view s, Id<Tag>& out) {
+    std::int64_t value = 0;
+    if (!parse_int(s, value)) return false;
+    out = Id<Tag>(value);
+    return true;
+}
+
+// Coordinate in [-limit, limit] degrees
+bool parse_degrees(std::string_view s, double limit, double& out) {
+    if (s.empty()) return false;
+    const char* end = s.data() + s.size();
+    auto r = std::from_chars(s.data(), end, out);
+    return r.ec == std::errc() && r.ptr == end && out >= -limit && out <= limit;
+}
+
+// "12x20" or "a:10|b:12"
+bool parse_layout(std::string_view spec, std::vector<RowSpec>& rows) {
+    const std::size_t x = spec.find('x');
+    if (x != std::string_view::npos && spec.find(':') == std::string_view::npos) {
+        int row_count = 0;
+        int seats = 0;
+        if (!parse_int(spec.substr(0, x), row_count) || !parse_int(spec.substr(x + 1), seats)) return false;
+        if (row_count < 1 || row_count > HallLayout::kMaxRows) return false;
+        for (int r = 0; r < row_count; ++r) rows.push_back(RowSpec{HallLayout::row_label_for(r), seats});
+        return true;
+    }
+    while (!spec.empty()) {
+        const std::size_t bar = spec.find('|');
+        const std::string_view row = spec.substr(0, bar);
+        const std::size_t colon = row.find(':');
+        int seats = 0;
+        if (colon == std::string_view::npos || !parse_int(row.substr(colon + 1), seats)) return false;
+        rows.push_back(RowSpec{std::string(row.substr(0, colon)), seats});
+        if (bar == std::string_view::npos) break;
+        spec.remove_prefix(bar + 1);
+    }
+    return !rows.empty();
+}
+
+struct ChunkResult {
+    Schedule schedule;
+    std::size_t lines = 0;     /**< Lines in the chunk. */
+    std::size_t bad_line = 0;  /**< 1-based within the chunk; 0 = no error. */
+    const char* reason = "";
+};
+
+const char* parse_line(std::string_view line, Schedule& out) {
+    std::string scratch;
+    std::string_view kind;
+    FieldReader fields(line);
+    if (!fields.next(kind, scratch)) return "empty record";
+
+    // Each field gets its own unescape buffer so the views stay valid
+    std::string_view f[6];
+    std::string unescaped[7];
+    int n = 0;
+    while (n < 6 && fields.next(f[n], unescaped[n])) ++n;
+    std::string_view extra;
+    if (fields.next(extra, unescaped[6])) return "too many fields";
+    if (fields.malformed()) return "malformed quoted field";
+
+    std::int64_t id = 0;
+    if (n < 1 || !parse_int(f[0], id)) return "missing or invalid id";
+
+    if (kind == "movie") {
+        if (n != 2) return "expected movie,<id>,<title>";
+        out.movies.push_back(ScheduleMovie{id, std::string(f[1])});
+        return nullptr;
+    }
+    if (kind == "theater") {
+        ScheduleTheater theater{id, std::string(n > 1 ? f[1] : std::string_view())};
+        if ((n != 2 && n != 4)
+            || (n == 4
+                && (!parse_degrees(f[2], 90.0, theater.latitude) || !parse_degrees(f[3], 180.0, theater.longitude)))) {
+            return "expected theater,<id>,<name>[,<latitude>,<longitude>]";
+        }
+        out.theaters.push_back(std::move(theater));
+        return nullptr;
+    }
+    if (kind == "layout") {
+        if (n != 2) return "expected layout,<id>,<spec>";
+        std::vector<RowSpec> rows;
+        if (!parse_layout(f[1], rows)) return "invalid layout spec";
+        if (id < std::numeric_limits<int>::min() || id > std::numeric_limits<int>::max()) return "layout id out of range";
+        try {
+            out.layouts.push_back(ScheduleLayout{static_cast<int>(id), HallLayout(std::move(rows))});
+        } catch (const std::invalid_argument&) {
+            return "invalid layout geometry";
+        }
+        return nullptr;
+    }
+    if (kind == "show") {
+        ScheduleShow show{id, MovieId(), TheaterId(), 0};
+        if (n < 4 || !parse_id(f[1], show.movie_id) || !parse_id(f[2], show.theater_id)
+            || !parse_int(f[3], show.layout_id) || (n > 4 && !parse_int(f[4], show.start_time))
+            || (n > 5 && !parse_int(f[5], show.hall))) {
+            return "expected show,<id>,<movie>,<theater>,<layout>[,<start>[,<hall>]]";
+        }
+        out.shows.push_back(show);
+        return nullptr;
+    }
+    return "unknown record kind";
+}
+
+void parse_chunk(std::string_view text, ChunkResult& out) {
+    while (!text.empty()) {
+        const std::size_t nl = text.find('\n');
+        std::string_view line = text.substr(0, nl);
+        text.remove_prefix(nl == std::string_view::npos ? text.size() : nl + 1);
+        ++out.lines;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty() || line.front() == '#') continue;
+        if (const char* reason = parse_line(line, out.schedule)) {
+            out.bad_line = out.lines;
+            out.reason = reason;
+            return;
+        }
+    }
+}
+
+template <typename T>
+void append(std::vector<T>& to, std::vector<T>& from) {
+    std::move(from.begin(), from.end(), std::back_inserter(to));
+}
+
+} // namespace
+
+ScheduleError parse_schedule(std::string_view text, unsigned threads, Schedule& out, ThreadPool* pool) {
+    ThreadPool& workers = pool ? *pool : ThreadPool::shared();
+    if (threads == 0) threads = workers.worker_count();
+    constexpr std::size_t kMinChunk = 1u << 16; // below this a thread costs more than it saves
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, text.size() / kMinChunk + 1));
+
+    // Chunk boundaries on line starts
+    std::vector<std::string_view> chunks;
+    std::size_t begin = 0;
+    for (unsigned t = 1; t <= threads && begin < text.size(); ++t) {
+        std::size_t end = t == threads ? text.size() : text.size() / threads * t;
+        if (end < begin) end = begin;
+        if (end < text.size()) {
+            const std::size_t nl = text.find('\n', end);
+            end = nl == std::string_view::npos ? text.size() : nl + 1;
+        }
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+
+    std::vector<ChunkResult> results(chunks.size());
+    workers.parallel_for(chunks.size(), 1u, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) parse_chunk(chunks[i], results[i]);
+    });
+
+    ScheduleError err;
+    std::size_t line_base = 0;
+    std::size_t movies = 0, theaters = 0, layouts = 0, shows = 0;
+    for (const ChunkResult& r : results) {
+        if (r.bad_line != 0) {
+            err.status = ScheduleStatus::ParseError;
+            err.line = line_base + r.bad_line;
+            err.reason = r.reason;
+            return err;
+        }
+        line_base += r.lines;
+        movies += r.schedule.movies.size();
+        theaters += r.schedule.theaters.size();
+        layouts += r.schedule.layouts.size();
+        shows += r.schedule.shows.size();
+    }
+
+    out.movies.reserve(out.movies.size() + movies);
+    out.theaters.reserve(out.theaters.size() + theaters);
+    out.layouts.reserve(out.layouts.size() + layouts);
+    out.shows.reserve(out.shows.size() + shows);
+    for (ChunkResult& r : results) {
+        append(out.movies, r.schedule.movies);
+        append(out.theaters, r.schedule.theaters);
+        append(out.layouts, r.schedule.layouts);
+        append(out.shows, r.schedule.shows);
+    }
+    return err;
+}
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat st;
+    if (::fstat(fd, &st) == 0) {
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ == 0) {
+            ok_ = true;
+        } else {
+            void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                ::madvise(p, size_, MADV_SEQUENTIAL);
+                data_ = static_cast<const char*>(p);
+                ok_ = true;
+            } else {
+                size_ = 0;
+            }
+        }
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+}
+
+} // namespace booking
@@ -0,0 +1,120 @@
+#include "seat_heatmap.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BOOKING_SEAT_HEATMAP_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace booking {
+namespace seat_heatmap {
+
+namespace {
+
+// ---- Scalar ----------------------------------------------------------------------------
+
+/** @brief Transposes the 64x64 bit matrix @p a in place: bit c of a[r] <-> bit r of a[c]. */
+void transpose64(std::uint64_t* a) {
+    std::uint64_t m = 0x00000000FFFFFFFFull;
+    for (int j = 32; j != 0; j >>= 1, m ^= m << j) {
+        // Swap the upper columns of row k with the lower columns of row k + j, per 2j block
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            const std::uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+
+/** @brief counts[c] += number of shows s in [0, n) with bit c of column[s * stride] set. */
+void add_column(const std::uint64_t* column, std::size_t n, std::size_t stride, std::uint32_t* counts) {
+    std::uint64_t block[64];
+    for (std::size_t base = 0; base < n; base += 64u) {
+        const std::size_t m = n - base < 64u ? n - base : 64u;
+        std::uint64_t any = 0;
+        for (std::size_t i = 0; i < m; ++i) any |= block[i] = column[(base + i) * stride];
+        if (any == 0u) continue; // nothing sold in this row by these shows
+        for (std::size_t i = m; i < 64u; ++i) block[i] = 0;
+        transpose64(block); // block[c] = the shows that sold seat c
+        for (int c = 0; c < 64; ++c) counts[c] += static_cast<std::uint32_t>(__builtin_popcountll(block[c]));
+    }
+}
+
+void add_columns_scalar(const std::uint64_t* words, std::size_t n, std::size_t stride, std::uint32_t* counts) {
+    for (std::size_t w = 0; w < stride; ++w) add_column(words + w, n, stride, counts + w * 64u);
+}
+
+const Kernels kScalar{Isa::Scalar, add_columns_scalar};
+
+// ---- AVX2 ------------------------------------------------------------------------------
+
+#if BOOKING_SEAT_HEATMAP_AVX2
+
+/** @brief Bit-sliced counter planes: up to 2^kPlanes - 1 shows before a flush. */
+constexpr int kPlanes = 8;
+constexpr std::size_t kFlushEvery = (1u << kPlanes) - 1u;
+
+/** @brief counts[q * 64 + c] += the count bit-sliced across @p planes for seat c of lane q. */
+__attribute__((target("avx2"))) void flush_planes(const __m256i* planes, std::uint32_t* counts) {
+    alignas(32) std::uint64_t lanes[kPlanes][4];
+    for (int k = 0; k < kPlanes; ++k) _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[k]), planes[k]);
+    for (int q = 0; q < 4; ++q) {
+        std::uint64_t any = 0;
+        for (int k = 0; k < kPlanes; ++k) any |= lanes[k][q];
+        if (any == 0u) continue;
+        for (int c = 0; c < 64; ++c) {
+            std::uint32_t count = 0;
+            for (int k = 0; k < kPlanes; ++k) count |= static_cast<std::uint32_t>((lanes[k][q] >> c) & 1u) << k;
+            counts[q * 64 + c] += count;
+        }
+    }
+}
+
+__attribute__((target("avx2"))) void add_columns_avx2(const std::uint64_t* words, std::size_t n, std::size_t stride,
+                                                      std::uint32_t* counts) {
+    std::size_t w = 0;
+    for (; w + 4u <= stride; w += 4u) {
+        for (std::size_t base = 0; base < n; base += kFlushEvery) {
+            const std::size_t end = n - base < kFlushEvery ? n : base + kFlushEvery;
+            __m256i planes[kPlanes];
+            for (__m256i& p : planes) p = _mm256_setzero_si256();
+            for (std::size_t s = base; s < end; ++s) {
+                // Add one show: a ripple-carry increment of every seat's counter at once
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + s * stride + w));
+                for (int k = 0; k < kPlanes && !_mm256_testz_si256(x, x); ++k) {
+                    const __m256i carry = _mm256_and_si256(planes[k], x);
+                    planes[k] = _mm256_xor_si256(planes[k], x);
+                    x = carry;
+                }
+            }
+            flush_planes(planes, counts + w * 64u);
+        }
+    }
+    for (; w < stride; ++w) add_column(words + w, n, stride, counts + w * 64u); // rows past the last group of four
+}
+
+const Kernels kAvx2{Isa::Avx2, add_columns_avx2};
+
+#endif // BOOKING_SEAT_HEATMAP_AVX2
+
+} // namespace
+
+const Kernels& scalar_kernels() {
+    return kScalar;
+}
+
+const Kernels* avx2_kernels() {
+#if BOOKING_SEAT_HEATMAP_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported ? &kAvx2 : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const Kernels& kernels() {
+    static const Kernels& selected = avx2_kernels() ? *avx2_kernels() : kScalar;
+    return selected;
+}
+
+} // namespace seat_heatmap
+} // namespace booking
@@ -0,0 +1,97 @@
+#include "seat_label.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#define BOOKING_SEAT_LABEL_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#define BOOKING_SEAT_LABEL_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace booking {
+namespace seat_label {
+
+namespace {
+
+#if BOOKING_SEAT_LABEL_SSE2
+
+// Unsigned range checks as signed compares: shift the range start to -128
+ByteClasses classify_block(const char* block) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i letter_base = _mm_set1_epi8(static_cast<char>('a' + 128));
+    const __m128i letter_limit = _mm_set1_epi8(static_cast<char>(-128 + 26));
+    const __m128i digit_base = _mm_set1_epi8(static_cast<char>('0' + 128));
+    const __m128i digit_limit = _mm_set1_epi8(static_cast<char>(-128 + 10));
+    ByteClasses c;
+    for (int i = 0; i < 4; ++i) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+        const __m128i sep = _mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab));
+        const __m128i letter =
+            _mm_cmplt_epi8(_mm_sub_epi8(_mm_or_si128(v, case_bit), letter_base), letter_limit);
+        const __m128i digit = _mm_cmplt_epi8(_mm_sub_epi8(v, digit_base), digit_limit);
+        const unsigned shift = 16u * static_cast<unsigned>(i);
+        c.separators |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(sep))) << shift;
+        c.letters |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(letter))) << shift;
+        c.digits |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(digit))) << shift;
+    }
+    return c;
+}
+
+#elif BOOKING_SEAT_LABEL_NEON
+
+// Bit i of the result = top bit of byte i (NEON has no movemask)
+std::uint64_t movemask_neon(uint8x16_t v) {
+    static const uint8_t kBits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t bits = vandq_u8(v, vld1q_u8(kBits));
+    const std::uint64_t lo = vaddv_u8(vget_low_u8(bits));
+    const std::uint64_t hi = vaddv_u8(vget_high_u8(bits));
+    return lo | (hi << 8);
+}
+
+ByteClasses classify_block(const char* block) {
+    ByteClasses c;
+    for (int i = 0; i < 4; ++i) {
+        const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(block + 16 * i));
+        const uint8x16_t sep = vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('\t')));
+        const uint8x16_t letter = vcltq_u8(vsubq_u8(vorrq_u8(v, vdupq_n_u8(0x20)), vdupq_n_u8('a')), vdupq_n_u8(26));
+        const uint8x16_t digit = vcltq_u8(vsubq_u8(v, vdupq_n_u8('0')), vdupq_n_u8(10));
+        const unsigned shift = 16u * static_cast<unsigned>(i);
+        c.separators |= movemask_neon(sep) << shift;
+        c.letters |= movemask_neon(letter) << shift;
+        c.digits |= movemask_neon(digit) << shift;
+    }
+    return c;
+}
+
+#else
+
+ByteClasses classify_block(const char* block) {
+    ByteClasses c;
+    for (unsigned i = 0; i < kBlock; ++i) {
+        const unsigned char b = static_cast<unsigned char>(block[i]);
+        const std::uint64_t bit = std::uint64_t{1} << i;
+        if (b == ' ' || b == '\t') c.separators |= bit;
+        if (static_cast<unsigned>((b | 0x20u) - 'a') < 26u) c.letters |= bit;
+        if (static_cast<unsigned>(b - '0') < 10u) c.digits |= bit;
+    }
+    return c;
+}
+
+#endif
+
+} // namespace
+
+ByteClasses classify(const char* p, std::size_t n) {
+    if (n >= kBlock) return classify_block(p);
+    // Short tail: zero bytes classify as nothing
+    char block[kBlock] = {};
+    std::memcpy(block, p, n);
+    return classify_block(block);
+}
+
+} // namespace seat_label
+} // namespace booking
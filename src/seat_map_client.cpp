@@ -0,0 +1,122 @@
+#include "seat_map_client.hpp"
+
+namespace booking {
+
+const char* to_string(SubscribeStatus status) {
+    switch (status) {
+        case SubscribeStatus::Ok: return "Subscribed";
+        case SubscribeStatus::UnknownShow: return "Unknown show";
+        case SubscribeStatus::NoFeed: return "Change feed not enabled";
+    }
+    return "Unknown status";
+}
+
+SeatMapClient::SeatMapClient(const BookingService& service)
+    : snapshot_([&service](ShowId show_id, SeatMapSnapshot& out) {
+          if (!service.change_feed()) return false;
+          if (service.availability_snapshot(show_id, out.free, out.position) < 0) return false;
+          const HallLayout* layout = service.layout_for_show(show_id);
+          if (!layout) return false; // removed since
+          out.layout = std::make_shared<const HallLayout>(*layout);
+          return true;
+      }),
+      diff_([&service](ShowId show_id, std::uint64_t since) { return service.availability_diff(show_id, since); }) {}
+
+bool SeatMapClient::refetch(ShowId show_id, Mirror& mirror) {
+    SeatMapSnapshot snapshot;
+    if (!snapshot_(show_id, snapshot)) return false;
+    mirror.layout = std::move(snapshot.layout);
+    mirror.free.fill(0u);
+    for (int w = 0; w < mirror.layout->row_count(); ++w) mirror.free[static_cast<std::size_t>(w)] = snapshot.free.word(w);
+    mirror.position = snapshot.position;
+    return true;
+}
+
+SubscribeStatus SeatMapClient::subscribe(ShowId show_id) {
+    if (shows_.count(show_id) != 0u) return SubscribeStatus::Ok;
+    Mirror mirror;
+    if (!refetch(show_id, mirror)) {
+        // Tell the two failures apart: a diff names the missing feed
+        return diff_(show_id, 0).status == DiffStatus::NoFeed ? SubscribeStatus::NoFeed : SubscribeStatus::UnknownShow;
+    }
+    shows_.emplace(show_id, std::move(mirror));
+    return SubscribeStatus::Ok;
+}
+
+std::size_t SeatMapClient::sync() {
+    std::size_t changed = 0;
+    for (auto it = shows_.begin(); it != shows_.end();) {
+        Mirror& mirror = it->second;
+        const AvailabilityDiff diff = diff_(it->first, mirror.position);
+        if (diff.status == DiffStatus::Ok) {
+            for (int w = 0; w < mirror.layout->row_count(); ++w) {
+                const std::uint64_t flipped = diff.taken.word(w) | diff.freed.word(w);
+                mirror.free[static_cast<std::size_t>(w)] ^= flipped;
+                changed += static_cast<std::size_t>(__builtin_popcountll(flipped));
+            }
+            mirror.position = diff.position;
+            ++it;
+            continue;
+        }
+        if (diff.status == DiffStatus::Resync) {
+            const std::array<std::uint64_t, HallLayout::kMaxRows> before = mirror.free;
+            if (refetch(it->first, mirror)) {
+                ++resyncs_;
+                for (int w = 0; w < mirror.layout->row_count(); ++w) {
+                    const auto row = static_cast<std::size_t>(w);
+                    changed += static_cast<std::size_t>(__builtin_popcountll(before[row] ^ mirror.free[row]));
+                }
+                ++it;
+                continue;
+            }
+        }
+        it = shows_.erase(it); // unknown to the server now (or its feed went away)
+    }
+    return changed;
+}
+
+int SeatMapClient::available_count(ShowId show_id) const {
+    const auto it = shows_.find(show_id);
+    if (it == shows_.end()) return -1;
+    int count = 0;
+    for (int w = 0; w < it->second.layout->row_count(); ++w) {
+        count += __builtin_popcountll(it->second.free[static_cast<std::size_t>(w)]);
+    }
+    return count;
+}
+
+int SeatMapClient::available_seats_mask(ShowId show_id, SeatMask& out_free) const {
+    out_free = SeatMask{};
+    const auto it = shows_.find(show_id);
+    if (it == shows_.end()) return -1;
+    int count = 0;
+    for (int w = 0; w < it->second.layout->row_count(); ++w) {
+        const std::uint64_t free = it->second.free[static_cast<std::size_t>(w)];
+        out_free.or_word(w, free);
+        count += __builtin_popcountll(free);
+    }
+    return count;
+}
+
+std::vector<std::string> SeatMapClient::list_available_seats(ShowId show_id) const {
+    std::vector<std::string> out;
+    const auto it = shows_.find(show_id);
+    if (it == shows_.end()) return out;
+    const HallLayout& layout = *it->second.layout;
+    for (int w = 0; w < layout.row_count(); ++w) {
+        std::uint64_t free_bits = it->second.free[static_cast<std::size_t>(w)];
+        while (free_bits != 0u) {
+            const int col = __builtin_ctzll(free_bits);
+            free_bits &= free_bits - 1u;
+            out.emplace_back(layout.label_view(HallLayout::seat_index(w, col)));
+        }
+    }
+    return out;
+}
+
+const HallLayout* SeatMapClient::layout_for_show(ShowId show_id) const {
+    const auto it = shows_.find(show_id);
+    return it == shows_.end() ? nullptr : it->second.layout.get();
+}
+
+} // namespace booking
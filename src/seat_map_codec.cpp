@@ -0,0 +1,153 @@
+#include "seat_map_codec.hpp"
+
+#include <array>
+
+namespace booking {
+
+namespace {
+
+enum RowKind : std::uint8_t { kEmpty = 0, kFull = 1, kListed = 2, kHoles = 3, kRaw = 4 };
+
+/** @brief Rows one Empty or Full tag covers at most. */
+constexpr int kMaxRun = 32;
+
+/** @brief Rows a seat map has at most (HallLayout::kMaxRows). */
+constexpr int kMaxRows = 64;
+
+/** @brief Columns a Listed or Holes tag lists at most (beyond that a Raw word is smaller). */
+constexpr int kMaxListed = 7;
+
+std::uint8_t tag(RowKind kind, int arg) { return static_cast<std::uint8_t>(kind << 5 | arg); }
+
+void put_columns(std::vector<std::uint8_t>& out, std::uint64_t bits) {
+    for (; bits != 0u; bits &= bits - 1u) out.push_back(static_cast<std::uint8_t>(__builtin_ctzll(bits)));
+}
+
+} // namespace
+
+void encode_seat_map(const std::uint64_t* words, const std::uint64_t* row_masks, int row_count,
+                     const BookingId* owners, std::vector<std::uint8_t>& out) {
+    for (int r = 0; r < row_count;) {
+        const std::uint64_t word = words[r];
+        const std::uint64_t mask = row_masks[r];
+        if (word == 0u || word == mask) {
+            // Empty or full rows in a row collapse into one tag
+            int run = 1;
+            while (run < kMaxRun && r + run < row_count && words[r + run] == (word == 0u ? 0u : row_masks[r + run])) {
+                ++run;
+            }
+            out.push_back(tag(word == 0u ? kEmpty : kFull, run - 1));
+            r += run;
+            continue;
+        }
+        const int set = __builtin_popcountll(word);
+        const int holes = __builtin_popcountll(mask & ~word);
+        if (set <= kMaxListed) {
+            out.push_back(tag(kListed, set));
+            put_columns(out, word);
+        } else if (holes <= kMaxListed) {
+            out.push_back(tag(kHoles, holes));
+            put_columns(out, mask & ~word);
+        } else {
+            out.push_back(tag(kRaw, 0));
+            for (int b = 0; b < 8; ++b) out.push_back(static_cast<std::uint8_t>(word >> (8 * b)));
+        }
+        ++r;
+    }
+
+    // Owners of the set seats, as runs of one booking id
+    BookingId run_id = 0;
+    BookingId last_id = 0;
+    std::uint64_t run = 0;
+    const auto flush = [&] {
+        if (run == 0u) return;
+        append_varint(out, run);
+        append_varint(out, zigzag(static_cast<std::int64_t>(run_id) - static_cast<std::int64_t>(last_id)));
+        last_id = run_id;
+    };
+    for (int r = 0; r < row_count; ++r) {
+        for (std::uint64_t bits = words[r]; bits != 0u; bits &= bits - 1u) {
+            const BookingId id = owners ? owners[static_cast<std::size_t>(r) * 64u + __builtin_ctzll(bits)] : 0u;
+            if (run != 0u && id == run_id) {
+                ++run;
+                continue;
+            }
+            flush();
+            run_id = id;
+            run = 1;
+        }
+    }
+    flush();
+}
+
+bool decode_seat_map(const std::uint8_t* data, std::size_t size, const std::uint64_t* row_masks, int row_count,
+                     std::uint64_t* words_out, BookingId* owners_out) {
+    const std::uint8_t* p = data;
+    const std::uint8_t* const end = data + size;
+    if (row_count < 0 || row_count > kMaxRows) return false;
+    std::array<std::uint64_t, kMaxRows> words{};
+    std::uint64_t seats = 0;
+    for (int r = 0; r < row_count;) {
+        if (p == end) return false;
+        const std::uint8_t t = *p++;
+        const int kind = t >> 5;
+        const int arg = t & 0x1F;
+        switch (kind) {
+            case kEmpty:
+            case kFull:
+                if (arg + 1 > row_count - r) return false;
+                for (int k = 0; k <= arg; ++k, ++r) words[static_cast<std::size_t>(r)] = kind == kFull ? row_masks[r] : 0u;
+                continue;
+            case kListed:
+            case kHoles: {
+                if (arg > end - p) return false;
+                std::uint64_t listed = 0;
+                for (int k = 0; k < arg; ++k) {
+                    const std::uint8_t col = *p++;
+                    if (col >= 64u) return false;
+                    listed |= std::uint64_t{1} << col;
+                }
+                if ((listed & ~row_masks[r]) != 0u) return false;
+                words[static_cast<std::size_t>(r)] = kind == kListed ? listed : row_masks[r] & ~listed;
+                break;
+            }
+            case kRaw: {
+                if (end - p < 8) return false;
+                std::uint64_t word = 0;
+                for (int b = 0; b < 8; ++b) word |= static_cast<std::uint64_t>(*p++) << (8 * b);
+                if ((word & ~row_masks[r]) != 0u) return false;
+                words[static_cast<std::size_t>(r)] = word;
+                break;
+            }
+            default: return false;
+        }
+        ++r;
+    }
+    for (std::uint64_t word : words) seats += static_cast<std::uint64_t>(__builtin_popcountll(word));
+
+    // Owner runs must cover exactly the set seats
+    int r = 0;
+    std::uint64_t bits = row_count > 0 ? words[0] : 0u;
+    std::int64_t id = 0;
+    while (seats > 0u) {
+        std::uint64_t run = 0;
+        std::uint64_t delta = 0;
+        if (!read_varint(p, end, run) || !read_varint(p, end, delta) || run == 0u || run > seats) return false;
+        if (delta > 2u * std::uint64_t{UINT32_MAX} + 1u) return false;
+        id += unzigzag(delta);
+        if (id < 0 || id > static_cast<std::int64_t>(UINT32_MAX)) return false;
+        seats -= run;
+        for (; run > 0u; --run) {
+            while (bits == 0u) bits = words[static_cast<std::size_t>(++r)];
+            if (owners_out) owners_out[static_cast<std::size_t>(r) * 64u + __builtin_ctzll(bits)] = static_cast<BookingId>(id);
+            bits &= bits - 1u;
+        }
+    }
+    if (p != end) return false;
+    if (words_out) {
+        for (int w = 0; w < row_count; ++w) words_out[w] = words[static_cast<std::size_t>(w)];
+    }
+    return true;
+}
+
+} // namespace booking
@@ -0,0 +1,96 @@
+#include "seat_run_summary.hpp"
+
+#include "column_scan.hpp"
+
+namespace booking {
+
+SeatRunSummary::SeatRunSummary(int max_positions)
+    : chunk_count_((static_cast<std::size_t>(max_positions > 0 ? max_positions : 0) + kChunkShows - 1u) / kChunkShows),
+      chunks_(new std::atomic<Chunk*>[chunk_count_]()) {}
+
+SeatRunSummary::~SeatRunSummary() {
+    for (std::size_t i = 0; i < chunk_count_; ++i) delete chunks_[i].load(std::memory_order_relaxed);
+}
+
+int SeatRunSummary::longest_run(std::uint64_t free_bits, std::uint64_t aisles) {
+    if (free_bits == 0u) return 0;
+    // Starts of runs of two: both seats free and no aisle between them; then one more each step
+    std::uint64_t runs = free_bits & (free_bits >> 1) & ~aisles;
+    int len = 1;
+    while (runs != 0u) {
+        ++len;
+        runs &= runs >> 1;
+    }
+    return len;
+}
+
+void SeatRunSummary::list(int position, bool listed) {
+    Chunk* c = chunk(position);
+    if (c == nullptr) return;
+    const std::uint64_t bit = std::uint64_t{1} << (position % kChunkShows);
+    if (listed) {
+        c->listed.fetch_or(bit, std::memory_order_release);
+    } else {
+        c->listed.fetch_and(~bit, std::memory_order_release);
+    }
+}
+
+void SeatRunSummary::trim(int position, int rows) {
+    Chunk* c = chunk(position);
+    if (c == nullptr) return;
+    const int slot = position % kChunkShows;
+    for (int r = rows < 0 ? 0 : rows; r < HallLayout::kMaxRows; ++r) {
+        __atomic_store_n(&c->rows[slot][r], std::uint8_t{0}, __ATOMIC_SEQ_CST);
+        set_count(*c, slot, r, 0u);
+    }
+}
+
+int SeatRunSummary::longest(int position) const {
+    const Chunk* c = find(position);
+    return c ? __atomic_load_n(&c->show[position % kChunkShows], __ATOMIC_SEQ_CST) : 0;
+}
+
+bool SeatRunSummary::listed(int position) const {
+    const Chunk* c = find(position);
+    return c && (c->listed.load(std::memory_order_acquire) >> (position % kChunkShows) & 1u) != 0u;
+}
+
+int SeatRunSummary::free_seats(int position) const {
+    const Chunk* c = find(position);
+    return c ? __atomic_load_n(&c->totals[position % kChunkShows], __ATOMIC_SEQ_CST) : 0;
+}
+
+std::uint64_t SeatRunSummary::rows_with_run(int position, int n) const {
+    const Chunk* c = find(position);
+    if (c == nullptr || n > 255) return 0u;
+    std::uint64_t bits = 0;
+    column_scan::kernels().match_ge_u8(c->rows[position % kChunkShows], HallLayout::kMaxRows,
+                                       static_cast<std::uint8_t>(n < 1 ? 1 : n), &bits);
+    return bits;
+}
+
+std::uint64_t SeatRunSummary::match(const Chunk& c, int n) {
+    std::uint64_t bits = 0;
+    column_scan::kernels().match_ge_u8(c.show, kChunkShows, static_cast<std::uint8_t>(n), &bits);
+    return bits & c.listed.load(std::memory_order_acquire);
+}
+
+SeatRunSummary::Chunk* SeatRunSummary::chunk(int position) {
+    const auto i = static_cast<std::size_t>(position / kChunkShows);
+    if (position < 0 || i >= chunk_count_) return nullptr;
+    Chunk* c = chunks_[i].load(std::memory_order_acquire);
+    if (c) return c;
+    Chunk* fresh = new Chunk();
+    if (!chunks_[i].compare_exchange_strong(c, fresh, std::memory_order_acq_rel)) {
+        delete fresh; // another writer installed it first
+        return c;
+    }
+    allocated_.fetch_add(1u, std::memory_order_relaxed);
+    int used = used_chunks_.load(std::memory_order_relaxed);
+    while (used <= static_cast<int>(i)
+           && !used_chunks_.compare_exchange_weak(used, static_cast<int>(i) + 1, std::memory_order_release)) {
+    }
+    return fresh;
+}
+
+} // namespace booking
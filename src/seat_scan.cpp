@@ -0,0 +1,216 @@
+#include "seat_scan.hpp"
+
+#include "seat_mask.hpp"
+#include "seat_runs.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BOOKING_SEAT_SCAN_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#define BOOKING_SEAT_SCAN_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace booking {
+namespace seat_scan {
+
+const char* to_string(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::Avx2: return "avx2";
+        case Isa::Neon: return "neon";
+    }
+    return "unknown";
+}
+
+namespace {
+
+// ---- Scalar ----------------------------------------------------------------------------
+
+int count_free_scalar(const std::uint64_t* words, std::size_t n) {
+    int total = 0;
+    for (std::size_t i = 0; i < n; ++i) total += popcount64(words[i]);
+    return total;
+}
+
+void row_free_counts_scalar(const std::uint64_t* words, std::size_t n, std::uint8_t* out) {
+    for (std::size_t i = 0; i < n; ++i) out[i] = static_cast<std::uint8_t>(popcount64(words[i]));
+}
+
+std::uint64_t find_runs_scalar(const std::uint64_t* words, std::size_t n, int run, std::uint64_t* out) {
+    std::uint64_t rows = 0u;
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = run_starts(words[i], run);
+        if (out[i] != 0u && i < 64u) rows |= std::uint64_t{1} << i;
+    }
+    return rows;
+}
+
+// Tail handling shared by the vector versions
+std::uint64_t rows_with_runs(const std::uint64_t* out, std::size_t n) {
+    std::uint64_t rows = 0u;
+    const std::size_t limit = n < 64u ? n : 64u;
+    for (std::size_t i = 0; i < limit; ++i) {
+        if (out[i] != 0u) rows |= std::uint64_t{1} << i;
+    }
+    return rows;
+}
+
+// ---- AVX2 ------------------------------------------------------------------------------
+
+#if BOOKING_SEAT_SCAN_AVX2
+
+// Per-64-bit-lane popcount: nibble lookup with vpshufb, then byte sums with vpsadbw
+__attribute__((target("avx2"))) inline __m256i popcount_lanes_avx2(__m256i v) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+    const __m256i lo = _mm256_and_si256(v, low_nibbles);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibbles);
+    const __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+    return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2"))) int count_free_avx2(const std::uint64_t* words, std::size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        acc = _mm256_add_epi64(acc, popcount_lanes_avx2(v));
+    }
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int total = static_cast<int>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    return total + count_free_scalar(words + i, n - i);
+}
+
+__attribute__((target("avx2"))) void row_free_counts_avx2(const std::uint64_t* words, std::size_t n,
+                                                          std::uint8_t* out) {
+    std::size_t i = 0;
+    alignas(32) std::uint64_t lanes[4];
+    for (; i + 4 <= n; i += 4) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), popcount_lanes_avx2(v));
+        for (int k = 0; k < 4; ++k) out[i + static_cast<std::size_t>(k)] = static_cast<std::uint8_t>(lanes[k]);
+    }
+    row_free_counts_scalar(words + i, n - i, out + i);
+}
+
+__attribute__((target("avx2"))) std::uint64_t find_runs_avx2(const std::uint64_t* words, std::size_t n,
+                                                            int run, std::uint64_t* out) {
+    if (run < 1 || run > 64) {
+        for (std::size_t i = 0; i < n; ++i) out[i] = 0u;
+        return 0u;
+    }
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i runs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        int len = 1;
+        while (len < run) {
+            const int step = len < run - len ? len : run - len;
+            runs = _mm256_and_si256(runs, _mm256_srl_epi64(runs, _mm_cvtsi32_si128(step)));
+            len += step;
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), runs);
+    }
+    find_runs_scalar(words + i, n - i, run, out + i);
+    return rows_with_runs(out, n);
+}
+
+const Kernels kAvx2{Isa::Avx2, count_free_avx2, row_free_counts_avx2, find_runs_avx2};
+
+#endif // BOOKING_SEAT_SCAN_AVX2
+
+// ---- NEON ------------------------------------------------------------------------------
+
+#if BOOKING_SEAT_SCAN_NEON
+
+// Per-64-bit-lane popcount: byte counts, then pairwise widening adds
+inline uint64x2_t popcount_lanes_neon(uint64x2_t v) {
+    return vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vcntq_u8(vreinterpretq_u8_u64(v)))));
+}
+
+int count_free_neon(const std::uint64_t* words, std::size_t n) {
+    uint64x2_t acc = vdupq_n_u64(0);
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) acc = vaddq_u64(acc, popcount_lanes_neon(vld1q_u64(words + i)));
+    return static_cast<int>(vaddvq_u64(acc)) + count_free_scalar(words + i, n - i);
+}
+
+void row_free_counts_neon(const std::uint64_t* words, std::size_t n, std::uint8_t* out) {
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const uint64x2_t counts = popcount_lanes_neon(vld1q_u64(words + i));
+        out[i] = static_cast<std::uint8_t>(vgetq_lane_u64(counts, 0));
+        out[i + 1] = static_cast<std::uint8_t>(vgetq_lane_u64(counts, 1));
+    }
+    row_free_counts_scalar(words + i, n - i, out + i);
+}
+
+std::uint64_t find_runs_neon(const std::uint64_t* words, std::size_t n, int run, std::uint64_t* out) {
+    if (run < 1 || run > 64) {
+        for (std::size_t i = 0; i < n; ++i) out[i] = 0u;
+        return 0u;
+    }
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        uint64x2_t runs = vld1q_u64(words + i);
+        int len = 1;
+        while (len < run) {
+            const int step = len < run - len ? len : run - len;
+            runs = vandq_u64(runs, vshlq_u64(runs, vdupq_n_s64(-step))); // negative shift = right
+            len += step;
+        }
+        vst1q_u64(out + i, runs);
+    }
+    find_runs_scalar(words + i, n - i, run, out + i);
+    return rows_with_runs(out, n);
+}
+
+const Kernels kNeon{Isa::Neon, count_free_neon, row_free_counts_neon, find_runs_neon};
+
+#endif // BOOKING_SEAT_SCAN_NEON
+
+const Kernels kScalar{Isa::Scalar, count_free_scalar, row_free_counts_scalar, find_runs_scalar};
+
+const Kernels& select_kernels() {
+#if BOOKING_SEAT_SCAN_NEON
+    return kNeon; // Advanced SIMD is mandatory on AArch64
+#else
+    const Kernels* avx2 = avx2_kernels();
+    return avx2 ? *avx2 : kScalar;
+#endif
+}
+
+} // namespace
+
+const Kernels& scalar_kernels() {
+    return kScalar;
+}
+
+const Kernels* avx2_kernels() {
+#if BOOKING_SEAT_SCAN_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported ? &kAvx2 : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const Kernels* neon_kernels() {
+#if BOOKING_SEAT_SCAN_NEON
+    return &kNeon;
+#else
+    return nullptr;
+#endif
+}
+
+const Kernels& kernels() {
+    static const Kernels& selected = select_kernels();
+    return selected;
+}
+
+} // namespace seat_scan
+} // namespace booking
@@ -0,0 +1,492 @@
+#include "audit_tap.hpp"
+#include "booking_server.hpp"
+#include "replication.hpp"
+#include "standby.hpp"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// TCP server for the text protocol (see text_protocol.hpp):
+//
+//   booking_server [--host=ADDR] [--port=N] [--schedule=FILE] [--owners=N]
+//                  [--backend=auto|epoll|io_uring] [--shared-seats=/NAME]
+//                  [--client-rate=PER_SECOND[:BURST]] [--journal=FILE]
+//                  [--journal-backend=auto|write|io_uring|mapped|direct]
+//                  [--replication-port=N [--sync-replicas=K]]
+//                  [--replica-of=HOST:PORT [--replica-journal=FILE]] [--cluster-node]
+//                  [--standby-of=JOURNAL [--standby-snapshot=FILE|DIR]]
+//                  [--pool-threads=N] [--pin-pool] [--huge-pages=off|thp|2m|1g]
+//                  [--numa=off|local|interleave]
+//                  [--hot-shows[=owner-threads|combining]] [--read-mirror=MICROSECONDS]
+//                  [--busy-poll=MICROSECONDS [--poll-cpu=N]]
+//                  [--checkpoints=DIR [--checkpoint-interval=SECONDS]]
+//                  [--occupancy=FILE [--occupancy-interval=MILLISECONDS]]
+//                  [--config=FILE [--config-admin]]
+//                  [--audit=FILE [--audit-spill=FILE]]
+//
+// Without --schedule it serves the sample catalog of booking_cli. With --shared-seats the
+// seat state lives in the named shared memory region, so several server processes loading
+// the same schedule sell the same seats. --journal replays FILE and then journals to it
+// (--journal-backend=mapped writes through preallocated, memory-mapped segments, direct
+// with O_DIRECT | O_DSYNC past the page cache);
+// with --replication-port the journal is also shipped to replicas (see replication.hpp),
+// and with --sync-replicas a booking is acknowledged only once K replicas have it.
+// A server started with --replica-of applies the primary's journal, answers reads from its
+// own copy and refuses bookings; --replica-journal keeps a durable copy of the stream that
+// is replayed at start-up and can be served with --journal after a failover. A server
+// started with --standby-of is a warm standby on the primary's host or storage (see
+// standby.hpp): it restores --standby-snapshot (a snapshot or the primary's --checkpoints
+// directory), tails the primary's journal into its own seat state and refuses bookings
+// until SIGUSR1 promotes it, which opens that journal and takes bookings without a replay.
+// --cluster-node lets a ClusterRouter move shows in and out
+// of this server (see cluster.hpp). --pool-threads sizes the work-stealing pool that
+// parses the schedule and books large batches (default: one worker per core) and
+// --pin-pool pins its workers to cores. --huge-pages places the seat state and catalog
+// columns on transparent, 2 MiB or 1 GiB huge pages (falling back to smaller pages when
+// none are reserved). --numa=local stripes the shows over the NUMA nodes, binding each
+// stripe's seat state to its node and (with --owners) owning it by threads pinned there;
+// --numa=interleave spreads the state pages over all nodes. --hot-shows hands shows whose
+// CAS operations keep failing to owner threads (or, with =combining, to a flat combiner)
+// until their load drops (without --owners). --read-mirror serves availability reads from
+// a copy of the seat state refreshed at that interval, away from the lines bookings CAS on.
+// --busy-poll makes the event loop spin instead of sleeping and asks the kernel to busy-poll
+// each socket for that long (SO_BUSY_POLL); --poll-cpu pins the loop to a dedicated core.
+// --checkpoints (with --journal) keeps an incremental snapshot in DIR, refreshed every
+// --checkpoint-interval seconds (default 60), and drops the journal records each new base
+// covers; a restart restores DIR's snapshot chain instead of the schedule, then replays the
+// journal written since.
+// --occupancy republishes the occupancy of every show as an Arrow IPC file every
+// --occupancy-interval milliseconds (default 1000); under /dev/shm analytics jobs map it
+// as shared memory instead of querying the server.
+// --config loads live tunables (backoff, hold TTL cap, client rate, admission rates; see
+// live_config.hpp) from FILE and reloads it whenever it changes; its client_rate replaces
+// --client-rate as the default. --config-admin also accepts new config text over HTTP
+// (PUT /admin/config).
+// --audit (with --journal) appends every committed journal record to FILE as compressed
+// batches (see audit_tap.hpp) from a thread of its own; while FILE cannot keep up, records
+// wait in --audit-spill (default FILE.spill) instead of holding up the journal.
+// SIGINT/SIGTERM stop it.
+
+namespace {
+
+struct Options {
+    booking::BookingServerOptions server;
+    std::string schedule;   // schedule file to load into an empty catalog
+    std::string shared;     // shared seat region name (requires --schedule)
+    int owners = -1;        // OwnerThreads execution mode with N owner threads (-1 = shared, 0 = per core)
+    std::string journal;    // journal file (replayed at start-up)
+    booking::JournalBackend journal_backend = booking::JournalBackend::Auto;
+    int replication_port = -1; // ship the journal to replicas on this port (0 = any)
+    std::string replica_of; // HOST:PORT of the primary's replication source
+    int sync_replicas = 0;  // replica acknowledgements a booking waits for
+    std::string replica_journal; // replica's durable copy of the stream
+    std::string standby_of; // primary's journal tailed by a warm standby
+    std::string standby_snapshot; // primary's snapshot file or checkpoint directory
+    booking::ThreadPoolOptions pool; // bulk work pool (see thread_pool.hpp)
+    bool own_pool = false;  // --pool-threads or --pin-pool given
+    booking::HugePages huge_pages = booking::HugePages::Off; // seat state and catalog pages
+    booking::NumaPlacement numa = booking::NumaPlacement::Off; // seat state and owner thread placement
+    bool hot_shows = false; // adaptive serialisation of contended shows
+    booking::HotShowStrategy hot_strategy = booking::HotShowStrategy::OwnerThreads;
+    long read_mirror_us = 0; // availability reads from a mirror refreshed this often (0 = live)
+    std::string checkpoints; // incremental snapshot directory that bounds the journal
+    long checkpoint_seconds = 60;
+    std::string occupancy;   // Arrow file of show occupancy, kept current
+    long occupancy_ms = 1000;
+    std::string config;      // live tunables, reloaded when the file changes
+    std::string audit;       // audit log of committed journal records
+    std::string audit_spill; // where they wait while the audit log falls behind
+};
+
+bool parse_option(const char* arg, Options& o) {
+    if (std::strcmp(arg, "--cluster-node") == 0) {
+        o.server.cluster_admin = true;
+        return true;
+    }
+    if (std::strcmp(arg, "--hot-shows") == 0) {
+        o.hot_shows = true;
+        return true;
+    }
+    if (std::strcmp(arg, "--config-admin") == 0) {
+        o.server.config_admin = true;
+        return true;
+    }
+    if (std::strcmp(arg, "--pin-pool") == 0) {
+        o.pool.pin_workers = true;
+        o.own_pool = true;
+        return true;
+    }
+    const char* eq = std::strchr(arg, '=');
+    if (std::strncmp(arg, "--", 2) != 0 || !eq) return false;
+    const std::string key(arg + 2, eq);
+    const char* v = eq + 1;
+    if (key == "host") o.server.host = v;
+    else if (key == "port") o.server.port = static_cast<std::uint16_t>(std::strtoul(v, nullptr, 10));
+    else if (key == "schedule") o.schedule = v;
+    else if (key == "owners") o.owners = std::atoi(v);
+    else if (key == "shared-seats") o.shared = v;
+    else if (key == "journal") o.journal = v;
+    else if (key == "journal-backend") {
+        bool known = false;
+        for (const auto backend : {booking::JournalBackend::Auto, booking::JournalBackend::Write,
+                                   booking::JournalBackend::IoUring, booking::JournalBackend::Mapped,
+                                   booking::JournalBackend::Direct}) {
+            if (std::strcmp(v, booking::to_string(backend)) == 0) {
+                o.journal_backend = backend;
+                known = true;
+            }
+        }
+        if (!known) return false;
+    }
+    else if (key == "replication-port") o.replication_port = std::atoi(v);
+    else if (key == "replica-of" && std::strchr(v, ':')) o.replica_of = v;
+    else if (key == "sync-replicas") o.sync_replicas = std::atoi(v);
+    else if (key == "replica-journal") o.replica_journal = v;
+    else if (key == "standby-of") o.standby_of = v;
+    else if (key == "standby-snapshot") o.standby_snapshot = v;
+    else if (key == "pool-threads") {
+        o.pool.workers = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+        o.own_pool = true;
+    }
+    else if (key == "huge-pages") return booking::parse_huge_pages(v, o.huge_pages);
+    else if (key == "numa") return booking::parse_numa_placement(v, o.numa);
+    else if (key == "read-mirror") o.read_mirror_us = std::atol(v);
+    else if (key == "busy-poll") o.server.busy_poll_us = std::atoi(v);
+    else if (key == "poll-cpu") o.server.poll_cpu = std::atoi(v);
+    else if (key == "checkpoints") o.checkpoints = v;
+    else if (key == "checkpoint-interval") o.checkpoint_seconds = std::atol(v);
+    else if (key == "occupancy") o.occupancy = v;
+    else if (key == "occupancy-interval") o.occupancy_ms = std::atol(v);
+    else if (key == "config") o.config = v;
+    else if (key == "audit") o.audit = v;
+    else if (key == "audit-spill") o.audit_spill = v;
+    else if (key == "hot-shows") {
+        o.hot_shows = true;
+        if (std::strcmp(v, booking::to_string(booking::HotShowStrategy::Combining)) == 0) {
+            o.hot_strategy = booking::HotShowStrategy::Combining;
+        } else if (std::strcmp(v, booking::to_string(booking::HotShowStrategy::OwnerThreads)) != 0) {
+            return false;
+        }
+    }
+    else if (key == "client-rate") {
+        char* end = nullptr;
+        o.server.client_rate.per_second = std::strtod(v, &end);
+        o.server.client_rate.burst = *end == ':' ? std::atoi(end + 1) : 1;
+    }
+    else if (key == "backend" && std::strcmp(v, "auto") == 0) o.server.backend = booking::ServerBackend::Auto;
+    else if (key == "backend" && std::strcmp(v, "epoll") == 0) o.server.backend = booking::ServerBackend::Epoll;
+    else if (key == "backend" && std::strcmp(v, "io_uring") == 0) o.server.backend = booking::ServerBackend::IoUring;
+    else return false;
+    return true;
+}
+
+booking::BookingServer* g_server = nullptr;
+int g_promote_fd = -1; // eventfd the standby's promotion thread waits on
+
+void on_signal(int) {
+    if (g_server) g_server->stop(); // an atomic store and an eventfd write: async-signal-safe
+}
+
+void on_promote(int) {
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const ssize_t n = ::write(g_promote_fd, &one, sizeof(one));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        if (!parse_option(argv[i], o)) {
+            std::cerr << "unknown option " << argv[i] << "\n"
+                      << "usage: booking_server [--host=ADDR] [--port=N] [--schedule=FILE] [--owners=N]\n"
+                      << "                      [--backend=auto|epoll|io_uring] [--shared-seats=/NAME]\n"
+                      << "                      [--client-rate=PER_SECOND[:BURST]] [--journal=FILE]\n"
+                      << "                      [--journal-backend=auto|write|io_uring|mapped|direct]\n"
+                      << "                      [--replication-port=N [--sync-replicas=K]]\n"
+                      << "                      [--replica-of=HOST:PORT [--replica-journal=FILE]] [--cluster-node]\n"
+                      << "                      [--standby-of=JOURNAL [--standby-snapshot=FILE|DIR]]\n"
+                      << "                      [--pool-threads=N] [--pin-pool] [--huge-pages=off|thp|2m|1g]\n"
+                      << "                      [--numa=off|local|interleave]\n"
+                      << "                      [--hot-shows[=owner-threads|combining]] [--read-mirror=MICROSECONDS]\n"
+                      << "                      [--busy-poll=MICROSECONDS [--poll-cpu=N]]\n"
+                      << "                      [--checkpoints=DIR [--checkpoint-interval=SECONDS]]\n"
+                      << "                      [--occupancy=FILE [--occupancy-interval=MILLISECONDS]]\n"
+                      << "                      [--config=FILE [--config-admin]]\n"
+                      << "                      [--audit=FILE [--audit-spill=FILE]]\n";
+            return 2;
+        }
+    }
+    if (!o.shared.empty() && o.schedule.empty()) {
+        std::cerr << "--shared-seats requires --schedule\n";
+        return 2;
+    }
+    if (o.replication_port >= 0 && o.journal.empty()) {
+        std::cerr << "--replication-port requires --journal\n";
+        return 2;
+    }
+    if (!o.replica_of.empty() && (!o.journal.empty() || o.replication_port >= 0)) {
+        std::cerr << "--replica-of cannot be combined with --journal or --replication-port\n";
+        return 2;
+    }
+    if (o.sync_replicas > 0 && o.replication_port < 0) {
+        std::cerr << "--sync-replicas requires --replication-port\n";
+        return 2;
+    }
+    if (!o.replica_journal.empty() && o.replica_of.empty()) {
+        std::cerr << "--replica-journal requires --replica-of\n";
+        return 2;
+    }
+    if (!o.standby_of.empty()
+        && (!o.journal.empty() || o.replication_port >= 0 || !o.replica_of.empty() || !o.shared.empty()
+            || !o.checkpoints.empty())) {
+        std::cerr << "--standby-of cannot be combined with --journal, --replication-port, --replica-of,"
+                     " --shared-seats or --checkpoints\n";
+        return 2;
+    }
+    if (!o.standby_snapshot.empty() && o.standby_of.empty()) {
+        std::cerr << "--standby-snapshot requires --standby-of\n";
+        return 2;
+    }
+    if (!o.audit.empty() && o.journal.empty()) {
+        std::cerr << "--audit requires --journal\n";
+        return 2;
+    }
+    if (!o.audit_spill.empty() && o.audit.empty()) {
+        std::cerr << "--audit-spill requires --audit\n";
+        return 2;
+    }
+    if (!o.checkpoints.empty() && (o.journal.empty() || !o.shared.empty())) {
+        std::cerr << "--checkpoints requires --journal and cannot be combined with --shared-seats\n";
+        return 2;
+    }
+
+    booking::set_huge_pages(o.huge_pages); // before any show state is created
+    booking::set_numa_placement(o.numa);
+    std::unique_ptr<booking::ThreadPool> pool; // outlives the service
+    if (o.own_pool) pool = std::make_unique<booking::ThreadPool>(o.pool);
+    std::unique_ptr<booking::LiveConfig> config; // outlives the service and the server
+    std::unique_ptr<booking::AuditTap> audit;    // outlives the service's journal
+    std::unique_ptr<booking::BookingService> svc;
+    const bool from_checkpoint =
+        !o.checkpoints.empty() && booking::MappedFile(o.checkpoints + "/base.snap").ok();
+    if (from_checkpoint) {
+        svc = std::make_unique<booking::BookingService>(booking::BookingService::EmptyCatalog{});
+        svc->set_thread_pool(pool.get());
+        const booking::SnapshotStatus restored = svc->restore_snapshot_chain(o.checkpoints);
+        if (restored != booking::SnapshotStatus::Ok) {
+            std::cerr << o.checkpoints << ": " << booking::to_string(restored) << "\n";
+            return 1;
+        }
+    } else if (!o.standby_snapshot.empty()) {
+        svc = std::make_unique<booking::BookingService>(booking::BookingService::EmptyCatalog{});
+        svc->set_thread_pool(pool.get());
+    } else if (o.schedule.empty()) {
+        svc = std::make_unique<booking::BookingService>();
+        svc->set_thread_pool(pool.get());
+    } else {
+        svc = std::make_unique<booking::BookingService>(booking::BookingService::EmptyCatalog{});
+        svc->set_thread_pool(pool.get());
+        if (!o.shared.empty()) {
+            const booking::SharedSeatsStatus shared = svc->attach_shared_seats(o.shared);
+            if (shared != booking::SharedSeatsStatus::Ok) {
+                std::cerr << o.shared << ": " << booking::to_string(shared) << "\n";
+                return 1;
+            }
+        }
+        const booking::ScheduleError err = svc->load_schedule_file(o.schedule);
+        if (err.status != booking::ScheduleStatus::Ok) {
+            std::cerr << o.schedule << ":" << err.line << ": " << booking::to_string(err.status) << ": " << err.reason
+                      << "\n";
+            return 1;
+        }
+    }
+    if (o.owners >= 0) svc->set_execution_mode(booking::ExecutionMode::OwnerThreads, static_cast<unsigned>(o.owners));
+    if (o.hot_shows) {
+        booking::HotShowPolicy policy;
+        policy.enabled = true;
+        policy.strategy = o.hot_strategy;
+        svc->set_hot_show_policy(policy);
+    }
+    if (o.read_mirror_us > 0) svc->set_read_mirror(std::chrono::microseconds(o.read_mirror_us));
+
+    if (!o.journal.empty()) {
+        const booking::JournalReplay replay = svc->replay_journal(o.journal);
+        booking::JournalStatus js = replay.status;
+        if (js == booking::JournalStatus::Ok) {
+            js = svc->open_journal(o.journal, booking::JournalMode::Sync, o.journal_backend);
+        }
+        if (js != booking::JournalStatus::Ok) {
+            std::cerr << o.journal << ": " << booking::to_string(js) << "\n";
+            return 1;
+        }
+        if (replay.applied != 0u) std::printf("replayed %zu journal records\n", replay.applied);
+        if (!o.audit.empty()) {
+            booking::AuditTapOptions ao;
+            ao.spill_path = o.audit_spill.empty() ? o.audit + ".spill" : o.audit_spill;
+            audit = std::make_unique<booking::AuditTap>(booking::audit_file_sink(o.audit), ao);
+            if (!audit->spill_open()) {
+                std::cerr << ao.spill_path << ": cannot open the audit spill file\n";
+                return 1;
+            }
+            svc->set_journal_tap(audit->journal_tap());
+        }
+    }
+    if (!o.checkpoints.empty()) {
+        booking::IncrementalSnapshotOptions checkpoints;
+        checkpoints.directory = o.checkpoints;
+        checkpoints.interval = std::chrono::seconds(std::max(o.checkpoint_seconds, 1L));
+        checkpoints.compact_journal = true;
+        const booking::SnapshotStatus started = svc->set_incremental_snapshots(checkpoints);
+        if (started != booking::SnapshotStatus::Ok) {
+            std::cerr << o.checkpoints << ": " << booking::to_string(started) << "\n";
+            return 1;
+        }
+    }
+    if (!o.occupancy.empty()) {
+        booking::OccupancyExportOptions occupancy;
+        occupancy.path = o.occupancy;
+        occupancy.interval = std::chrono::milliseconds(std::max(o.occupancy_ms, 1L));
+        const booking::SnapshotStatus started = svc->set_occupancy_export(occupancy);
+        if (started != booking::SnapshotStatus::Ok) {
+            std::cerr << o.occupancy << ": " << booking::to_string(started) << "\n";
+            return 1;
+        }
+    }
+    if (!o.config.empty()) {
+        booking::TuningConfig defaults;
+        defaults.backoff = svc->backoff_policy();
+        defaults.client_rate = o.server.client_rate;
+        config = std::make_unique<booking::LiveConfig>(defaults);
+        const booking::ConfigError loaded = config->watch(o.config);
+        if (loaded.status != booking::ConfigStatus::Ok) {
+            std::cerr << o.config << ":" << loaded.line << ": " << booking::to_string(loaded.status) << " ("
+                      << loaded.reason << ")\n";
+            return 1;
+        }
+        svc->use_live_config(config.get());
+        o.server.config = config.get();
+    }
+    std::unique_ptr<booking::ReplicationSource> source;
+    if (o.replication_port >= 0) {
+        booking::ReplicationOptions ro;
+        ro.host = o.server.host;
+        ro.port = static_cast<std::uint16_t>(o.replication_port);
+        ro.sync_replicas = o.sync_replicas;
+        source = std::make_unique<booking::ReplicationSource>(o.journal, ro);
+        const booking::ReplicationStatus rs = source->listen();
+        if (rs != booking::ReplicationStatus::Ok) {
+            std::cerr << o.server.host << ":" << o.replication_port << ": " << booking::to_string(rs) << "\n";
+            return 1;
+        }
+        if (o.sync_replicas > 0) {
+            booking::ReplicationSource* quorum = source.get();
+            svc->set_journal_commit_wait([quorum](std::uint64_t lsn) { return quorum->wait_committed(lsn); });
+        }
+        std::printf("shipping %s on port %u\n", o.journal.c_str(), static_cast<unsigned>(source->port()));
+    }
+    std::unique_ptr<booking::ReplicaClient> replica;
+    if (!o.replica_of.empty()) {
+        const std::size_t colon = o.replica_of.rfind(':');
+        const std::string host = o.replica_of.substr(0, colon);
+        const auto port = static_cast<std::uint16_t>(std::strtoul(o.replica_of.c_str() + colon + 1, nullptr, 10));
+        booking::ReplicationOptions ro;
+        ro.journal_path = o.replica_journal;
+        if (!o.replica_journal.empty()) {
+            const booking::JournalReplay replay = svc->replay_journal(o.replica_journal);
+            if (replay.status != booking::JournalStatus::Ok) {
+                std::cerr << o.replica_journal << ": " << booking::to_string(replay.status) << "\n";
+                return 1;
+            }
+        }
+        replica = std::make_unique<booking::ReplicaClient>(*svc, ro);
+        const booking::ReplicationStatus rs = replica->start(host, port);
+        if (rs != booking::ReplicationStatus::Ok) {
+            std::cerr << o.replica_of << ": " << booking::to_string(rs) << "\n";
+            return 1;
+        }
+        o.server.read_only = true;
+    }
+    std::unique_ptr<booking::WarmStandby> standby;
+    if (!o.standby_of.empty()) {
+        booking::StandbyOptions so;
+        so.journal_path = o.standby_of;
+        so.snapshot_path = o.standby_snapshot;
+        standby = std::make_unique<booking::WarmStandby>(*svc, so);
+        const booking::SnapshotStatus started = standby->start();
+        if (started != booking::SnapshotStatus::Ok) {
+            std::cerr << o.standby_snapshot << ": " << booking::to_string(started) << "\n";
+            return 1;
+        }
+        g_promote_fd = ::eventfd(0, EFD_CLOEXEC);
+        if (g_promote_fd < 0) {
+            std::cerr << "eventfd failed\n";
+            return 1;
+        }
+        o.server.read_only = true;
+        std::printf("standby of %s from LSN %llu\n", o.standby_of.c_str(),
+                    static_cast<unsigned long long>(standby->next_lsn()));
+    }
+
+    booking::BookingServer server(*svc, o.server);
+    const booking::ServerStatus status = server.listen();
+    if (status != booking::ServerStatus::Ok) {
+        std::cerr << o.server.host << ":" << o.server.port << ": " << booking::to_string(status) << "\n";
+        return 1;
+    }
+    g_server = &server;
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    std::printf("listening on %s:%u (%s)\n", o.server.host.c_str(), static_cast<unsigned>(server.port()),
+                booking::to_string(server.backend()));
+    std::fflush(stdout);
+
+    std::thread promoter;
+    std::atomic<bool> stopping{false};
+    if (standby) {
+        // Promotion runs here, not in the handler: it stops the tail and opens the journal
+        std::signal(SIGUSR1, on_promote);
+        promoter = std::thread([&] {
+            std::uint64_t count = 0;
+            while (::read(g_promote_fd, &count, sizeof(count)) == sizeof(count) && !stopping.load()) {
+                const booking::JournalStatus js = standby->promote(booking::JournalMode::Sync, o.journal_backend);
+                if (js != booking::JournalStatus::Ok) {
+                    std::fprintf(stderr, "%s: %s\n", o.standby_of.c_str(), booking::to_string(js));
+                    continue;
+                }
+                server.set_read_only(false);
+                std::printf("promoted at LSN %llu (%llu records applied as standby)\n",
+                            static_cast<unsigned long long>(standby->next_lsn()),
+                            static_cast<unsigned long long>(standby->applied_records()));
+                std::fflush(stdout);
+                return;
+            }
+        });
+    }
+
+    server.run();
+    g_server = nullptr;
+    if (promoter.joinable()) {
+        std::signal(SIGUSR1, SIG_IGN);
+        stopping.store(true);
+        on_promote(0); // wakes the promotion thread, which sees stopping and returns
+        promoter.join();
+    }
+    const booking::RateLimiterStats limited = server.rate_limit_stats();
+    if (limited.rejected != 0u) {
+        std::printf("rate limited %llu requests (%zu clients tracked)\n",
+                    static_cast<unsigned long long>(limited.rejected), limited.clients);
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "service_metrics.hpp"
+
+namespace booking {
+
+const char* to_string(MetricsApi api) {
+    switch (api) {
+        case MetricsApi::BookSeats: return "book_seats";
+        case MetricsApi::BookBestAvailable: return "book_best_available";
+        case MetricsApi::BookBatch: return "book_seats_batch";
+        case MetricsApi::CancelSeats: return "cancel_seats";
+        case MetricsApi::HoldSeats: return "hold_seats";
+        case MetricsApi::ConfirmHold: return "confirm_hold";
+        case MetricsApi::ReleaseHold: return "release_hold";
+        case MetricsApi::ListAvailableSeats: return "list_available_seats";
+        case MetricsApi::AvailableCount: return "available_count";
+        case MetricsApi::JoinWaitlist: return "join_waitlist";
+        case MetricsApi::BookBundle: return "book_bundle";
+        case MetricsApi::BookGroup: return "book_group";
+        case MetricsApi::BookBulk: return "book_bulk";
+    }
+    return "unknown";
+}
+
+namespace {
+
+std::atomic<std::uint64_t>& next_serial() {
+    static std::atomic<std::uint64_t> serial{1};
+    return serial;
+}
+
+} // namespace
+
+ServiceMetrics::ServiceMetrics() : serial_(next_serial().fetch_add(1, std::memory_order_relaxed)) {}
+
+ServiceMetrics::~ServiceMetrics() = default;
+
+ServiceMetrics::Shard& ServiceMetrics::local() {
+    // The serial tells instances apart, so a cache entry of a destroyed instance is never reused
+    struct Cache {
+        std::uint64_t serial = 0;
+        Shard* shard = nullptr;
+    };
+    thread_local Cache cache;
+    if (cache.serial != serial_) cache = Cache{serial_, attach()};
+    return *cache.shard;
+}
+
+ServiceMetrics::Shard* ServiceMetrics::attach() {
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    const std::thread::id self = std::this_thread::get_id();
+    for (auto& entry : shards_) {
+        if (entry.first == self) return entry.second.get(); // thread alternating between services
+    }
+    shards_.emplace_back(self, std::make_unique<Shard>());
+    return shards_.back().second.get();
+}
+
+void ServiceMetrics::record_latency(MetricsApi api, std::uint64_t ns) {
+    ApiShard& s = local().apis[static_cast<std::size_t>(api)];
+    std::size_t bucket = LatencyHistogram::bucket_of(ns);
+    if (bucket >= kLatencyBuckets) bucket = kLatencyBuckets - 1u;
+    bump(s.buckets[bucket], 1u);
+    bump(s.sum, ns);
+    if (ns > s.max.load(std::memory_order_relaxed)) s.max.store(ns, std::memory_order_relaxed);
+}
+
+void ServiceMetrics::count(MetricsApi api, std::uint8_t outcome) {
+    ApiShard& s = local().apis[static_cast<std::size_t>(api)];
+    bump(s.outcomes[outcome < kOutcomes ? outcome : kOutcomes - 1u], 1u);
+}
+
+void ServiceMetrics::collect(std::array<ApiTotals, kMetricsApis>& out) const {
+    out = {};
+    std::array<std::uint64_t, kLatencyBuckets> counts;
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    for (const auto& entry : shards_) {
+        for (std::size_t a = 0; a < kMetricsApis; ++a) {
+            const ApiShard& s = entry.second->apis[a];
+            for (std::size_t b = 0; b < kLatencyBuckets; ++b) counts[b] = s.buckets[b].load(std::memory_order_relaxed);
+            out[a].latency.merge_buckets(counts.data(), kLatencyBuckets, s.sum.load(std::memory_order_relaxed),
+                                         s.max.load(std::memory_order_relaxed));
+            for (std::size_t o = 0; o < kOutcomes; ++o) {
+                out[a].outcomes[o] += s.outcomes[o].load(std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+} // namespace booking
@@ -0,0 +1,676 @@
+#include "sharded_booking_service.hpp"
+
+#include "geo.hpp"
+#include "schedule_loader.hpp"
+#include "show_table.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#if defined(BOOKING_HAVE_NUMA)
+#include <numa.h>
+#endif
+
+namespace booking {
+
+namespace {
+
+constexpr int kSampleSeats = 20; // BookingService() default layout
+constexpr std::size_t kCountChunkShows = 1024; // available_counts shows per parallel chunk
+
+ScheduleError catalog_error(const char* reason) {
+    return ScheduleError{ScheduleStatus::CatalogError, 0, reason};
+}
+
+std::size_t resolve_shard_count(std::size_t requested) {
+    if (requested != 0u) return requested;
+    const unsigned hw = std::thread::hardware_concurrency();
+    return hw == 0u ? 1u : hw;
+}
+
+} // namespace
+
+ShardedBookingService::ShardedBookingService(std::size_t shard_count)
+    : ShardedBookingService(shard_count, BookingService::EmptyCatalog{}) {
+    // Same sample data as BookingService()
+    add_layout(HallLayout::single_row(kSampleSeats));
+
+    add_movie(Movie{1, "Inception"});
+    add_movie(Movie{2, "Interstellar"});
+    add_movie(Movie{3, "The Matrix"});
+
+    add_theater(Theater{1, "Central Cinema"});
+    add_theater(Theater{2, "Mall Theater"});
+
+    add_show(Show{1, 1, 1});
+    add_show(Show{2, 1, 2});
+    add_show(Show{3, 2, 1});
+    add_show(Show{4, 3, 2});
+}
+
+ShardedBookingService::ShardedBookingService(std::size_t shard_count, BookingService::EmptyCatalog) {
+    init_shards(resolve_shard_count(shard_count));
+}
+
+void ShardedBookingService::init_shards(std::size_t shard_count) {
+    nodes_.assign(shard_count, -1);
+#if defined(BOOKING_HAVE_NUMA)
+    if (numa_available() >= 0) {
+        const int node_count = numa_num_configured_nodes();
+        if (node_count > 1) {
+            for (std::size_t i = 0; i < shard_count; ++i) nodes_[i] = static_cast<int>(i % static_cast<std::size_t>(node_count));
+        }
+    }
+#endif
+    shards_.resize(shard_count);
+    for (std::size_t i = 0; i < shard_count; ++i) {
+        on_shard_node(i, [&] { shards_[i] = std::make_unique<BookingService>(BookingService::EmptyCatalog{}); });
+    }
+}
+
+void ShardedBookingService::on_shard_node(std::size_t index, const std::function<void()>& fn) const {
+#if defined(BOOKING_HAVE_NUMA)
+    const int node = nodes_[index];
+    if (node >= 0) {
+        // First-touch: whatever fn allocates is placed on the shard's node
+        std::thread worker([&] {
+            numa_run_on_node(node);
+            numa_set_preferred(node);
+            fn();
+        });
+        worker.join();
+        return;
+    }
+#else
+    (void)index;
+#endif
+    fn();
+}
+
+void ShardedBookingService::set_thread_pool(ThreadPool* pool) {
+    thread_pool_ = pool;
+    for (const auto& s : shards_) s->set_thread_pool(pool);
+}
+
+SnapshotStatus ShardedBookingService::write_snapshots(const std::vector<std::string>& paths) const {
+    if (paths.size() != shards_.size()) return SnapshotStatus::IoError;
+    std::vector<SnapshotStatus> results(shards_.size(), SnapshotStatus::Ok);
+    thread_pool().parallel_for(shards_.size(), 1u, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) results[i] = shards_[i]->write_snapshot(paths[i]);
+    });
+    for (SnapshotStatus r : results) {
+        if (r != SnapshotStatus::Ok) return r;
+    }
+    return SnapshotStatus::Ok;
+}
+
+std::vector<Movie> ShardedBookingService::list_movies() const {
+    return shards_.front()->list_movies(); // replicated
+}
+
+Page<Movie> ShardedBookingService::list_movies_page(std::uint64_t cursor, std::size_t limit) const {
+    return shards_.front()->list_movies_page(cursor, limit); // replicated
+}
+
+std::vector<Theater> ShardedBookingService::list_theaters_for_movie(MovieId movie_id) const {
+    std::vector<Theater> out;
+    for (const auto& s : shards_) {
+        std::vector<Theater> part = s->list_theaters_for_movie(movie_id);
+        out.insert(out.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+    }
+    std::sort(out.begin(), out.end(), [](const Theater& a, const Theater& b) { return a.id < b.id; });
+    out.erase(std::unique(out.begin(), out.end(), [](const Theater& a, const Theater& b) { return a.id == b.id; }),
+              out.end());
+    return out;
+}
+
+Page<Theater> ShardedBookingService::list_theaters_for_movie_page(MovieId movie_id, std::uint64_t cursor,
+                                                                 std::size_t limit) const {
+    Page<Theater> page;
+    // Below the smallest resume point of a shard with more, every shard returned all its theaters
+    std::uint64_t bound = std::numeric_limits<std::uint64_t>::max();
+    for (const auto& s : shards_) {
+        Page<Theater> part = s->list_theaters_for_movie_page(movie_id, cursor, limit);
+        page.items.insert(page.items.end(), part.items.begin(), part.items.end());
+        if (part.more) bound = std::min(bound, part.next_cursor);
+    }
+    const auto by_id = [](const Theater& a, const Theater& b) { return a.id < b.id; };
+    std::sort(page.items.begin(), page.items.end(), by_id);
+    page.items.erase(std::unique(page.items.begin(), page.items.end(),
+                                 [](const Theater& a, const Theater& b) { return a.id == b.id; }),
+                     page.items.end());
+    const auto past = std::find_if(page.items.begin(), page.items.end(),
+                                   [bound](const Theater& t) { return static_cast<std::uint64_t>(t.id.value()) >= bound; });
+    page.items.erase(past, page.items.end());
+    page.more = bound != std::numeric_limits<std::uint64_t>::max();
+    if (page.items.size() > limit) {
+        page.more = true;
+        page.next_cursor = static_cast<std::uint64_t>(page.items[limit].id.value());
+        page.items.resize(limit);
+    } else if (page.more) {
+        page.next_cursor = bound;
+    } else {
+        page.next_cursor = page.items.empty() ? cursor : static_cast<std::uint64_t>(page.items.back().id.value()) + 1u;
+    }
+    return page;
+}
+
+std::vector<Theater> ShardedBookingService::list_theaters_for_movie(MovieId movie_id, double latitude,
+                                                                  double longitude, double radius_km) const {
+    std::vector<std::pair<double, Theater>> hits;
+    for (const auto& s : shards_) {
+        for (Theater& t : s->list_theaters_for_movie(movie_id, latitude, longitude, radius_km)) {
+            const double d = distance_km(latitude, longitude, t.latitude, t.longitude);
+            hits.emplace_back(d, std::move(t));
+        }
+    }
+    std::sort(hits.begin(), hits.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first < b.first : a.second.id < b.second.id;
+    });
+    std::vector<Theater> out;
+    for (auto& h : hits) {
+        if (out.empty() || out.back().id != h.second.id) out.push_back(std::move(h.second));
+    }
+    return out;
+}
+
+ShowId ShardedBookingService::find_show(MovieId movie_id, TheaterId theater_id) const {
+    ShowId best = -1;
+    for (const auto& s : shards_) {
+        for (ShowId id : s->find_shows(movie_id, theater_id)) {
+            if (best < 0 || id < best) best = id;
+        }
+    }
+    return best;
+}
+
+std::vector<ShowId> ShardedBookingService::find_shows(MovieId movie_id, TheaterId theater_id) const {
+    std::vector<ShowId> out;
+    for (const auto& s : shards_) {
+        const std::vector<ShowId> part = s->find_shows(movie_id, theater_id);
+        out.insert(out.end(), part.begin(), part.end());
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+std::vector<Show> ShardedBookingService::find_shows_between(MovieId movie_id, TheaterId theater_id, ShowTime from,
+                                                           ShowTime to) const {
+    return find_shows_between(movie_id, Span<const TheaterId>(&theater_id, 1), from, to);
+}
+
+std::vector<Show> ShardedBookingService::find_shows_between(MovieId movie_id, Span<const TheaterId> theater_ids,
+                                                           ShowTime from, ShowTime to) const {
+    return merge_by_start([&](const BookingService& s) { return s.find_shows_between(movie_id, theater_ids, from, to); });
+}
+
+std::vector<Show> ShardedBookingService::find_movie_shows_between(MovieId movie_id, ShowTime from, ShowTime to) const {
+    return merge_by_start([&](const BookingService& s) { return s.find_movie_shows_between(movie_id, from, to); });
+}
+
+std::size_t ShardedBookingService::movie_showtimes(MovieId movie_id, ShowTime from, ShowTime to,
+                                                   std::vector<ShowAvailability>& out) const {
+    const std::size_t first = out.size();
+    for (const auto& s : shards_) s->movie_showtimes(movie_id, from, to, out);
+    std::sort(out.begin() + static_cast<std::ptrdiff_t>(first), out.end(),
+              [](const ShowAvailability& a, const ShowAvailability& b) {
+                  return a.start_time != b.start_time ? a.start_time < b.start_time : a.show_id < b.show_id;
+              });
+    return out.size() - first;
+}
+
+template <typename Query>
+std::vector<Show> ShardedBookingService::merge_by_start(Query&& query) const {
+    std::vector<Show> out;
+    for (const auto& s : shards_) {
+        const std::size_t mid = out.size();
+        const std::vector<Show> part = query(*s);
+        out.insert(out.end(), part.begin(), part.end());
+        std::inplace_merge(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(mid), out.end(),
+                           [](const Show& a, const Show& b) {
+                               return a.start_time != b.start_time ? a.start_time < b.start_time : a.id < b.id;
+                           });
+    }
+    return out;
+}
+
+const HallLayout* ShardedBookingService::layout_for_show(ShowId show_id) const {
+    return owner(show_id).layout_for_show(show_id);
+}
+
+CatalogStatus ShardedBookingService::add_movie(const Movie& movie) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    CatalogStatus status = CatalogStatus::Ok;
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        on_shard_node(i, [&] { status = shards_[i]->add_movie(movie); });
+        if (status != CatalogStatus::Ok) return status; // identical replicas: only the first can fail
+    }
+    movie_ids_.insert(movie.id);
+    return status;
+}
+
+CatalogStatus ShardedBookingService::add_theater(const Theater& theater) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    CatalogStatus status = CatalogStatus::Ok;
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        on_shard_node(i, [&] { status = shards_[i]->add_theater(theater); });
+        if (status != CatalogStatus::Ok) return status;
+    }
+    theater_ids_.insert(theater.id);
+    return status;
+}
+
+LayoutId ShardedBookingService::add_layout(HallLayout layout) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    // Every shard registers the same layouts in the same order, so they all agree on the id
+    LayoutId id = -1;
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        on_shard_node(i, [&] { id = shards_[i]->add_layout(layout); });
+    }
+    return id;
+}
+
+CatalogStatus ShardedBookingService::add_show(const Show& show) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    const std::size_t i = shard_of(show.id);
+    CatalogStatus status = CatalogStatus::Ok;
+    on_shard_node(i, [&] { status = shards_[i]->add_show(show); });
+    return status;
+}
+
+CatalogStatus ShardedBookingService::remove_show(ShowId show_id) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    return owner(show_id).remove_show(show_id);
+}
+
+ScheduleError ShardedBookingService::load_schedule_file(const std::string& path, unsigned threads) {
+    MappedFile file(path);
+    if (!file.ok()) {
+        return ScheduleError{ScheduleStatus::IoError, 0, "cannot open or map the file"};
+    }
+    Schedule schedule;
+    const ScheduleError parsed = parse_schedule(file.view(), threads, schedule, &thread_pool());
+    if (parsed.status != ScheduleStatus::Ok) return parsed;
+    return load_schedule(std::move(schedule));
+}
+
+ScheduleError ShardedBookingService::load_schedule(Schedule schedule) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+
+    // Validate against the replicated catalog first, so that no shard rejects its part
+    std::unordered_set<MovieId> movies = movie_ids_;
+    for (const ScheduleMovie& m : schedule.movies) {
+        if (!movies.insert(m.id).second) return catalog_error("duplicate movie id");
+    }
+    std::unordered_set<TheaterId> theaters = theater_ids_;
+    for (const ScheduleTheater& t : schedule.theaters) {
+        if (!theaters.insert(t.id).second) return catalog_error("duplicate theater id");
+    }
+    std::unordered_set<int> layouts;
+    for (const ScheduleLayout& l : schedule.layouts) {
+        if (!layouts.insert(l.id).second) return catalog_error("duplicate layout id");
+    }
+    std::unordered_set<ShowId> show_ids;
+    show_ids.reserve(schedule.shows.size());
+    for (const ScheduleShow& s : schedule.shows) {
+        if (!s.id.valid()) return catalog_error("show id out of range");
+        if (!show_ids.insert(s.id).second || owner(s.id).layout_for_show(s.id) != nullptr) {
+            return catalog_error("duplicate show id");
+        }
+        if (movies.count(s.movie_id) == 0u) return catalog_error("show references an unknown movie");
+        if (theaters.count(s.theater_id) == 0u) return catalog_error("show references an unknown theater");
+        if (layouts.count(s.layout_id) == 0u) return catalog_error("show references an unknown layout");
+    }
+
+    // Every shard gets the shared records and its own shows
+    std::vector<Schedule> parts(shards_.size());
+    for (Schedule& part : parts) {
+        part.movies = schedule.movies;
+        part.theaters = schedule.theaters;
+        part.layouts = schedule.layouts;
+    }
+    for (const ScheduleShow& s : schedule.shows) parts[shard_of(s.id)].shows.push_back(s);
+
+    std::vector<ScheduleError> results(shards_.size());
+    thread_pool().parallel_for(shards_.size(), 1u, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            on_shard_node(i, [&] { results[i] = shards_[i]->load_schedule(std::move(parts[i])); });
+        }
+    });
+
+    for (const ScheduleMovie& m : schedule.movies) movie_ids_.insert(m.id);
+    for (const ScheduleTheater& t : schedule.theaters) theater_ids_.insert(t.id);
+    for (const ScheduleError& r : results) {
+        if (r.status != ScheduleStatus::Ok) return r; // not expected after the validation above
+    }
+    return ScheduleError{};
+}
+
+std::vector<std::string> ShardedBookingService::list_available_seats(ShowId show_id) const {
+    return owner(show_id).list_available_seats(show_id);
+}
+
+int ShardedBookingService::available_seats_mask(ShowId show_id, SeatMask& out_free) const {
+    return owner(show_id).available_seats_mask(show_id, out_free);
+}
+
+AvailabilityStatus ShardedBookingService::availability_if_changed(ShowId show_id, std::uint64_t known_version,
+                                                                 SeatMask& out_free, std::uint64_t& out_version) const {
+    return owner(show_id).availability_if_changed(show_id, known_version, out_free, out_version);
+}
+
+int ShardedBookingService::available_count(ShowId show_id) const {
+    return owner(show_id).available_count(show_id);
+}
+
+std::size_t ShardedBookingService::available_counts(Span<const ShowId> show_ids, Span<int> out_counts) const {
+    const std::size_t n = std::min(show_ids.size(), out_counts.size());
+    std::atomic<std::size_t> found{0};
+    // Chunks of the list in parallel; every show is counted by its shard without metrics
+    thread_pool().parallel_for(n, kCountChunkShows, [&](std::size_t begin, std::size_t end) {
+        std::size_t known = 0;
+        for (std::size_t i = begin; i < end; ++i) {
+            known += owner(show_ids[i]).available_counts(Span<const ShowId>(&show_ids[i], 1u),
+                                                         Span<int>(&out_counts[i], 1u));
+        }
+        found.fetch_add(known, std::memory_order_relaxed);
+    });
+    return found.load(std::memory_order_relaxed);
+}
+
+BookingResult ShardedBookingService::book_seats(ShowId show_id, const std::vector<std::string>& seat_labels) {
+    return owner(show_id).book_seats(show_id, seat_labels);
+}
+
+BookingResult ShardedBookingService::book_seat_labels(ShowId show_id, Span<const std::string_view> seat_labels) {
+    return owner(show_id).book_seat_labels(show_id, seat_labels);
+}
+
+BookingResult ShardedBookingService::book_seat_indices(ShowId show_id, Span<const int> seats) {
+    return owner(show_id).book_seat_indices(show_id, seats);
+}
+
+BookingResult ShardedBookingService::book_seat_mask(ShowId show_id, const SeatMask& seats) {
+    return owner(show_id).book_seat_mask(show_id, seats);
+}
+
+BookingResult ShardedBookingService::book_seats_once(std::uint64_t request_id, ShowId show_id,
+                                                     const std::vector<std::string>& seat_labels) {
+    return owner(show_id).book_seats_once(request_id, show_id, seat_labels);
+}
+
+BookingResult ShardedBookingService::book_seat_mask_once(std::uint64_t request_id, ShowId show_id,
+                                                         const SeatMask& seats) {
+    return owner(show_id).book_seat_mask_once(request_id, show_id, seats);
+}
+
+BookingResult ShardedBookingService::book_any_seats(ShowId show_id, const std::vector<std::string>& seat_labels,
+                                                    SeatMask& out_seats) {
+    return owner(show_id).book_any_seats(show_id, seat_labels, out_seats);
+}
+
+BookingResult ShardedBookingService::book_any_seat_mask(ShowId show_id, const SeatMask& seats, SeatMask& out_seats) {
+    return owner(show_id).book_any_seat_mask(show_id, seats, out_seats);
+}
+
+BookingResult ShardedBookingService::book_best_available(ShowId show_id, int n, SeatMask& out_seats) {
+    return owner(show_id).book_best_available(show_id, n, out_seats);
+}
+
+BookingResult ShardedBookingService::book_best_under(ShowId show_id, int n, std::uint32_t max_price,
+                                                     SeatMask& out_seats) {
+    return owner(show_id).book_best_under(show_id, n, max_price, out_seats);
+}
+
+BookingResult ShardedBookingService::book_cheapest_available(ShowId show_id, int n, SeatMask& out_seats) {
+    return owner(show_id).book_cheapest_available(show_id, n, out_seats);
+}
+
+BookingResult ShardedBookingService::book_group(ShowId show_id, int n, SeatMask& out_seats) {
+    return owner(show_id).book_group(show_id, n, out_seats);
+}
+
+BookingResult ShardedBookingService::join_waitlist(ShowId show_id, int n, BookingService::WaitlistCallback on_booked,
+                                                   SeatMask& out_seats) {
+    return owner(show_id).join_waitlist(show_id, n, std::move(on_booked), out_seats);
+}
+
+std::size_t ShardedBookingService::waitlist_size(ShowId show_id) const {
+    return owner(show_id).waitlist_size(show_id);
+}
+
+CatalogStatus ShardedBookingService::set_admission_policy(ShowId show_id, const AdmissionPolicy& policy) {
+    return owner(show_id).set_admission_policy(show_id, policy);
+}
+
+std::chrono::nanoseconds ShardedBookingService::admission_retry_after(ShowId show_id) const {
+    return owner(show_id).admission_retry_after(show_id);
+}
+
+std::vector<BookingResult> ShardedBookingService::book_seats_batch(Span<const BookingRequest> requests) {
+    if (shards_.size() == 1u) return shards_.front()->book_seats_batch(requests);
+
+    // Group by shard (keeping request order within a shard), book, scatter back
+    std::vector<std::vector<BookingRequest>> parts(shards_.size());
+    std::vector<std::vector<std::size_t>> positions(shards_.size());
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        const std::size_t s = shard_of(requests[i].show_id);
+        parts[s].push_back(requests[i]);
+        positions[s].push_back(i);
+    }
+    std::vector<BookingResult> out(requests.size());
+    thread_pool().parallel_for(shards_.size(), 1u, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t s = begin; s < end; ++s) {
+            if (parts[s].empty()) continue;
+            std::vector<BookingResult> results =
+                shards_[s]->book_seats_batch(Span<const BookingRequest>(parts[s].data(), parts[s].size()));
+            for (std::size_t k = 0; k < results.size(); ++k) out[positions[s][k]] = std::move(results[k]);
+        }
+    });
+    return out;
+}
+
+BookingResult ShardedBookingService::book_bundle(Span<const BundleItem> items, Span<BookingId> out_ids) {
+    bool one_shard = true;
+    for (const BundleItem& item : items) one_shard = one_shard && shard_of(item.show_id) == shard_of(items[0].show_id);
+    if (one_shard || items.size() > out_ids.size()) {
+        return (items.empty() ? *shards_.front() : owner(items[0].show_id)).book_bundle(items, out_ids);
+    }
+
+    // Spans shards: book the parts in the same global order a single service uses
+    std::vector<std::size_t> order(items.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return items[a].show_id < items[b].show_id;
+    });
+    for (std::size_t i = 0; i < items.size(); ++i) out_ids[i] = 0u;
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        const std::size_t i = order[k];
+        BookingResult part = owner(items[i].show_id).book_bundle(Span<const BundleItem>(&items[i], 1u),
+                                                                 Span<BookingId>(&out_ids[i], 1u));
+        if (part.success) continue;
+        for (std::size_t prev = k; prev-- > 0;) {
+            const BundleItem& taken = items[order[prev]];
+            owner(taken.show_id).cancel_seat_mask(taken.show_id, taken.seats, out_ids[order[prev]]);
+            out_ids[order[prev]] = 0u;
+        }
+        part.label_index = static_cast<int>(i);
+        return part;
+    }
+    BookingResult res = BookingResult::ok();
+    res.id = out_ids[0];
+    return res;
+}
+
+BookingResult ShardedBookingService::book_bulk(Span<const BundleItem> items, Span<BookingId> out_ids,
+                                               const BulkProgress& progress) {
+    bool one_shard = true;
+    for (const BundleItem& item : items) one_shard = one_shard && shard_of(item.show_id) == shard_of(items[0].show_id);
+    if (one_shard || items.size() > out_ids.size()) {
+        return (items.empty() ? *shards_.front() : owner(items[0].show_id)).book_bulk(items, out_ids, progress);
+    }
+
+    // Split the plan by shard, each part in show id order
+    std::vector<std::size_t> order(items.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return items[a].show_id < items[b].show_id;
+    });
+    std::vector<std::vector<BundleItem>> parts(shards_.size());
+    std::vector<std::vector<std::size_t>> positions(shards_.size());
+    std::size_t show_count = 0;
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        const std::size_t i = order[k];
+        if (k == 0 || items[order[k - 1]].show_id != items[i].show_id) ++show_count;
+        const std::size_t s = shard_of(items[i].show_id);
+        parts[s].push_back(items[i]);
+        positions[s].push_back(i);
+    }
+
+    // Shard progress, summed: one Validated per shard (its shows), one event per show otherwise
+    std::mutex progress_mutex;
+    std::size_t done[4] = {};
+    const auto report = [&](BulkPhase phase, std::size_t shows) {
+        const std::lock_guard<std::mutex> lock(progress_mutex);
+        done[static_cast<std::size_t>(phase)] += shows;
+        progress(phase, done[static_cast<std::size_t>(phase)], show_count);
+    };
+    BulkProgress shard_progress;
+    if (progress) {
+        shard_progress = [&](BulkPhase phase, std::size_t, std::size_t total) {
+            if (phase == BulkPhase::Validated) report(phase, total);
+            else if (phase != BulkPhase::Committed) report(phase, 1u);
+        };
+    }
+
+    for (std::size_t i = 0; i < items.size(); ++i) out_ids[i] = 0u;
+    std::vector<std::vector<BookingId>> ids(shards_.size());
+    std::vector<BookingResult> results(shards_.size());
+    thread_pool().parallel_for(shards_.size(), 1u, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t s = begin; s < end; ++s) {
+            if (parts[s].empty()) continue;
+            ids[s].assign(parts[s].size(), 0u);
+            results[s] = shards_[s]->book_bulk(Span<const BundleItem>(parts[s].data(), parts[s].size()),
+                                               Span<BookingId>(ids[s].data(), ids[s].size()), shard_progress);
+        }
+    });
+
+    // The failure reported is that of the lowest show any shard failed on
+    int failed = -1;
+    for (std::size_t s = 0; s < shards_.size(); ++s) {
+        if (parts[s].empty() || results[s].success) continue;
+        const ShowId show = parts[s][static_cast<std::size_t>(results[s].label_index)].show_id;
+        if (failed < 0) {
+            failed = static_cast<int>(s);
+            continue;
+        }
+        const BookingResult& best = results[static_cast<std::size_t>(failed)];
+        if (show < parts[static_cast<std::size_t>(failed)][static_cast<std::size_t>(best.label_index)].show_id) {
+            failed = static_cast<int>(s);
+        }
+    }
+    if (failed >= 0) {
+        thread_pool().parallel_for(shards_.size(), 1u, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t s = begin; s < end; ++s) {
+                if (parts[s].empty() || !results[s].success) continue;
+                for (std::size_t k = 0; k < parts[s].size(); ++k) {
+                    shards_[s]->cancel_seat_mask(parts[s][k].show_id, parts[s][k].seats, ids[s][k]);
+                    const bool last_of_show = k + 1 == parts[s].size() || parts[s][k + 1].show_id != parts[s][k].show_id;
+                    if (progress && last_of_show) report(BulkPhase::RollingBack, 1u);
+                }
+            }
+        });
+        BookingResult res = results[static_cast<std::size_t>(failed)];
+        res.label_index = static_cast<int>(positions[static_cast<std::size_t>(failed)][static_cast<std::size_t>(res.label_index)]);
+        return res;
+    }
+
+    for (std::size_t s = 0; s < shards_.size(); ++s) {
+        for (std::size_t k = 0; k < ids[s].size(); ++k) out_ids[positions[s][k]] = ids[s][k];
+    }
+    if (progress) progress(BulkPhase::Committed, show_count, show_count);
+    BookingResult res = BookingResult::ok();
+    res.id = out_ids[0];
+    return res;
+}
+
+BookingResult ShardedBookingService::cancel_seats(ShowId show_id, const std::vector<std::string>& seat_labels,
+                                                  BookingId booking_id) {
+    return owner(show_id).cancel_seats(show_id, seat_labels, booking_id);
+}
+
+BookingResult ShardedBookingService::cancel_seat_mask(ShowId show_id, const SeatMask& seats, BookingId booking_id) {
+    return owner(show_id).cancel_seat_mask(show_id, seats, booking_id);
+}
+
+BookingId ShardedBookingService::seat_owner(ShowId show_id, int seat) const {
+    return owner(show_id).seat_owner(show_id, seat);
+}
+
+int ShardedBookingService::booking_seats(ShowId show_id, BookingId booking_id, SeatMask& out_seats) const {
+    return owner(show_id).booking_seats(show_id, booking_id, out_seats);
+}
+
+BookingResult ShardedBookingService::wrap_hold(std::size_t shard, BookingResult r) const {
+    // The shard goes into the slot half; the generation half is kept as is
+    if (r.success) r.id = (r.id & ~kSlotMask) | ((r.id & kSlotMask) * shards_.size() + shard);
+    return r;
+}
+
+std::size_t ShardedBookingService::hold_shard(HoldId hold_id) const {
+    return static_cast<std::size_t>((hold_id & kSlotMask) % shards_.size());
+}
+
+HoldId ShardedBookingService::unwrap_hold(HoldId hold_id) const {
+    return (hold_id & ~kSlotMask) | ((hold_id & kSlotMask) / shards_.size());
+}
+
+BookingResult ShardedBookingService::hold_seats(ShowId show_id, const std::vector<std::string>& seat_labels,
+                                                std::chrono::milliseconds ttl) {
+    return wrap_hold(shard_of(show_id), owner(show_id).hold_seats(show_id, seat_labels, ttl));
+}
+
+BookingResult ShardedBookingService::hold_seat_mask(ShowId show_id, const SeatMask& seats,
+                                                    std::chrono::milliseconds ttl) {
+    return wrap_hold(shard_of(show_id), owner(show_id).hold_seat_mask(show_id, seats, ttl));
+}
+
+BookingResult ShardedBookingService::confirm_hold(HoldId hold_id) {
+    return shards_[hold_shard(hold_id)]->confirm_hold(unwrap_hold(hold_id));
+}
+
+BookingResult ShardedBookingService::release_hold(HoldId hold_id) {
+    return shards_[hold_shard(hold_id)]->release_hold(unwrap_hold(hold_id));
+}
+
+std::size_t ShardedBookingService::expire_holds(std::chrono::steady_clock::time_point now) {
+    std::size_t expired = 0;
+    for (const auto& s : shards_) expired += s->expire_holds(now);
+    return expired;
+}
+
+void ShardedBookingService::set_hold_capacity(std::size_t capacity) {
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        on_shard_node(i, [&] { shards_[i]->set_hold_capacity(capacity); });
+    }
+}
+
+void ShardedBookingService::set_backoff_policy(const BackoffPolicy& policy) {
+    for (const auto& s : shards_) s->set_backoff_policy(policy);
+}
+
+void ShardedBookingService::enable_request_dedupe(std::chrono::milliseconds ttl, std::size_t capacity_per_shard) {
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        on_shard_node(i, [&] { shards_[i]->enable_request_dedupe(ttl, capacity_per_shard); });
+    }
+}
+
+bool ShardedBookingService::contention_stats(ShowId show_id, ContentionStats& out) const {
+    return owner(show_id).contention_stats(show_id, out);
+}
+
+} // namespace booking
@@ -0,0 +1,245 @@
+#include "shared_seats.hpp"
+
+#include "pmem.hpp"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <thread>
+
+namespace booking {
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+              "shared seat words must be address-free lock-free atomics");
+
+namespace {
+
+constexpr std::uint32_t kFresh = 0;
+constexpr std::uint32_t kInitialising = 1;
+constexpr std::uint32_t kReady = 2;
+
+constexpr std::uint64_t kBlockAlign = 64;
+
+std::uint64_t align_up(std::uint64_t v, std::uint64_t a) { return (v + a - 1u) & ~(a - 1u); }
+
+/** @brief Fibonacci hashing of a show id onto a power-of-two table. */
+std::uint32_t slot_of(std::int64_t show_id, std::uint32_t slot_count) {
+    return static_cast<std::uint32_t>((static_cast<std::uint64_t>(show_id) * 0x9E3779B97F4A7C15u) >> 32)
+           & (slot_count - 1u);
+}
+
+/** @brief Slot count and first block offset of a new region of @p slots slots; raises @p capacity to fit them. */
+std::uint64_t table_layout(std::size_t slots, std::size_t& capacity, std::uint32_t& slot_count) {
+    slot_count = 1;
+    while (slot_count < slots && slot_count < (1u << 30)) slot_count <<= 1;
+    const std::uint64_t first_block = align_up(sizeof(SharedSeatHeader) + sizeof(SharedSeatSlot) * slot_count, kBlockAlign);
+    if (capacity < first_block) capacity = static_cast<std::size_t>(first_block);
+    return first_block;
+}
+
+/** @brief Size of the object behind @p fd, sized to @p capacity if it is new; 0 on error. */
+std::size_t sized(int fd, std::size_t capacity) {
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || (st.st_size == 0 && ::ftruncate(fd, static_cast<off_t>(capacity)) != 0)
+        || ::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(SharedSeatHeader)) {
+        return 0;
+    }
+    return static_cast<std::size_t>(st.st_size);
+}
+
+} // namespace
+
+const char* to_string(SharedSeatsStatus status) {
+    switch (status) {
+        case SharedSeatsStatus::Ok: return "Shared seats ok";
+        case SharedSeatsStatus::IoError: return "Shared seats I/O error";
+        case SharedSeatsStatus::BadHeader: return "Not a shared seat region";
+        case SharedSeatsStatus::InUse: return "Service already has shows";
+        case SharedSeatsStatus::Locked: return "Seat region file in use by another process";
+    }
+    return "Unknown status";
+}
+
+SharedSeatRegion::~SharedSeatRegion() {
+    if (base_) ::munmap(base_, size_);
+    if (lock_fd_ >= 0) ::close(lock_fd_); // releases the lock
+}
+
+SharedSeatsStatus SharedSeatRegion::open(const std::string& name, std::size_t capacity, std::size_t slots) {
+    std::uint32_t slot_count = 0;
+    const std::uint64_t first_block = table_layout(slots, capacity, slot_count);
+    const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) return SharedSeatsStatus::IoError;
+    const std::size_t size = sized(fd, capacity);
+    const SharedSeatsStatus status = size == 0u ? SharedSeatsStatus::IoError
+                                                : map(fd, size, slot_count, first_block, MAP_SHARED);
+    ::close(fd); // the mapping keeps the object alive
+    return status;
+}
+
+SharedSeatsStatus SharedSeatRegion::open_file(const std::string& path, std::size_t capacity, std::size_t slots) {
+    std::uint32_t slot_count = 0;
+    const std::uint64_t first_block = table_layout(slots, capacity, slot_count);
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) return SharedSeatsStatus::IoError;
+    if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        const bool held = errno == EWOULDBLOCK;
+        ::close(fd);
+        return held ? SharedSeatsStatus::Locked : SharedSeatsStatus::IoError;
+    }
+    const std::size_t size = sized(fd, capacity);
+    SharedSeatsStatus status = SharedSeatsStatus::IoError;
+    if (size != 0u) {
+#if defined(MAP_SYNC) && defined(MAP_SHARED_VALIDATE)
+        dax_ = true; // refused (EOPNOTSUPP) unless the file is on a DAX filesystem
+        status = map(fd, size, slot_count, first_block, MAP_SHARED_VALIDATE | MAP_SYNC);
+        if (base_ == nullptr) dax_ = false;
+#endif
+        if (base_ == nullptr) status = map(fd, size, slot_count, first_block, MAP_SHARED);
+    }
+    if (status != SharedSeatsStatus::Ok) {
+        ::close(fd);
+        return status;
+    }
+    lock_fd_ = fd;
+    recover();
+    return SharedSeatsStatus::Ok;
+}
+
+bool SharedSeatRegion::sync() { return base_ != nullptr && ::msync(base_, size_, MS_SYNC) == 0; }
+
+void SharedSeatRegion::write_back(const void* addr, std::size_t bytes) const {
+    if (dax_) pmem::flush(addr, bytes);
+}
+
+SharedSeatsStatus SharedSeatRegion::map(int fd, std::size_t size, std::uint32_t slot_count, std::uint64_t first_block,
+                                        int flags) {
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+    if (p == MAP_FAILED) return SharedSeatsStatus::IoError;
+    base_ = static_cast<char*>(p);
+    size_ = size;
+    header_ = reinterpret_cast<SharedSeatHeader*>(base_);
+
+    // The first process to map a fresh (zero-filled) object sets up the header
+    std::uint32_t state = kFresh;
+    if (header_->state.compare_exchange_strong(state, kInitialising, std::memory_order_acquire)) {
+        header_->magic = kSharedSeatsMagic;
+        header_->slot_count = slot_count;
+        header_->capacity = size;
+        header_->next_block.store(first_block, std::memory_order_relaxed);
+        header_->booking_ids.store(0u, std::memory_order_relaxed);
+        header_->state.store(kReady, std::memory_order_release);
+        write_back(header_, sizeof(SharedSeatHeader));
+        if (dax_) pmem::drain();
+        state = kReady;
+    } else {
+        while (state == kInitialising) {
+            std::this_thread::yield();
+            state = header_->state.load(std::memory_order_acquire);
+        }
+    }
+    if (state != kReady) return SharedSeatsStatus::BadHeader;
+    if (header_->magic != kSharedSeatsMagic || header_->capacity > size_
+        || sizeof(SharedSeatHeader) + sizeof(SharedSeatSlot) * std::uint64_t{header_->slot_count} > size_) {
+        return SharedSeatsStatus::BadHeader;
+    }
+    return SharedSeatsStatus::Ok;
+}
+
+void SharedSeatRegion::recover() {
+    SharedSeatSlot* table = slots();
+    BookingId last_id = 0;
+    for (std::uint32_t i = 0; i < header_->slot_count; ++i) {
+        SharedSeatSlot& slot = table[i];
+        if (slot.key.load(std::memory_order_relaxed) == 0u) continue;
+        const std::uint64_t at = slot.block.load(std::memory_order_relaxed);
+        if (at == 0u) { // claimed by a run that stopped before publishing the block
+            slot.block.store(kSharedSeatsFailed, std::memory_order_relaxed);
+            write_back(&slot, sizeof(SharedSeatSlot));
+            continue;
+        }
+        if (at == kSharedSeatsFailed) continue;
+        const std::uint32_t words = slot.words;
+        const std::uint64_t words_bytes = align_up((std::uint64_t{words} + 2u) * 8u, kBlockAlign);
+        const Block block = block_at(at, words, words_bytes);
+        block.version[1].store(0u, std::memory_order_relaxed); // no group write survives its process
+        if (slot.owner_bytes == words * kOwnerRowSeats * sizeof(BookingId)) {
+            auto* owners = static_cast<std::atomic<BookingId>*>(block.owners);
+            for (std::uint32_t w = 0; w < words; ++w) {
+                std::uint64_t unowned = 0u;
+                for (std::uint64_t bits = block.words[w].load(std::memory_order_relaxed); bits != 0u; bits &= bits - 1u) {
+                    const int col = __builtin_ctzll(bits);
+                    const BookingId id = owners[std::size_t{w} * kOwnerRowSeats + static_cast<std::size_t>(col)].load(
+                        std::memory_order_relaxed);
+                    if (id == 0u) {
+                        unowned |= std::uint64_t{1} << col;
+                    } else {
+                        last_id = std::max(last_id, id);
+                    }
+                }
+                if (unowned != 0u) {
+                    block.words[w].fetch_and(~unowned, std::memory_order_relaxed);
+                    block.version[0].fetch_add(1u, std::memory_order_relaxed);
+                    recovered_seats_ += static_cast<std::uint64_t>(__builtin_popcountll(unowned));
+                }
+            }
+        }
+        write_back(block.words, words_bytes);
+    }
+    // The counter may not have been written back since its last blocks were handed out
+    const BookingId floor = (last_id / BookingIdGenerator::kBlockSize + 1u) * BookingIdGenerator::kBlockSize;
+    if (header_->booking_ids.load(std::memory_order_relaxed) < floor) {
+        header_->booking_ids.store(floor, std::memory_order_relaxed);
+    }
+    write_back(header_, sizeof(SharedSeatHeader));
+    if (dax_) pmem::drain();
+}
+
+bool SharedSeatRegion::remove(const std::string& name) { return ::shm_unlink(name.c_str()) == 0; }
+
+SharedSeatRegion::Block SharedSeatRegion::claim(std::int64_t show_id, std::uint32_t words, std::uint32_t owner_bytes) {
+    const std::uint64_t key = static_cast<std::uint64_t>(show_id) + 1u;
+    const std::uint32_t mask = header_->slot_count - 1u;
+    SharedSeatSlot* table = slots();
+    for (std::uint32_t probe = 0, i = slot_of(show_id, header_->slot_count); probe <= mask; ++probe, i = (i + 1u) & mask) {
+        SharedSeatSlot& slot = table[i];
+        std::uint64_t seen = slot.key.load(std::memory_order_acquire);
+        if (seen == 0u && slot.key.compare_exchange_strong(seen, key, std::memory_order_acq_rel)) {
+            // Ours: carve the block out of the zero-filled area and publish it
+            const std::uint64_t words_bytes = align_up((std::uint64_t{words} + 2u) * 8u, kBlockAlign); // + counters
+            const std::uint64_t bytes = words_bytes + align_up(owner_bytes, kBlockAlign);
+            const std::uint64_t at = header_->next_block.fetch_add(bytes, std::memory_order_relaxed);
+            slot.words = words;
+            slot.owner_bytes = owner_bytes;
+            if (at + bytes > header_->capacity) {
+                slot.block.store(kSharedSeatsFailed, std::memory_order_release);
+                return Block{};
+            }
+            slot.block.store(at, std::memory_order_release);
+            if (dax_) { // the show's block is durable before any booking in it
+                write_back(&slot, sizeof(SharedSeatSlot));
+                pmem::persist(&header_->next_block, sizeof(header_->next_block));
+            }
+            return block_at(at, words, words_bytes);
+        }
+        if (seen != key) continue; // another show (or lost the race to one)
+
+        // Claimed by someone else (maybe another process): wait until its block is published
+        std::uint64_t at = slot.block.load(std::memory_order_acquire);
+        while (at == 0u) {
+            std::this_thread::yield();
+            at = slot.block.load(std::memory_order_acquire);
+        }
+        if (at == kSharedSeatsFailed || slot.words != words || slot.owner_bytes != owner_bytes) return Block{};
+        const std::uint64_t words_bytes = align_up((std::uint64_t{words} + 2u) * 8u, kBlockAlign); // + counters
+        return block_at(at, words, words_bytes);
+    }
+    return Block{}; // table full
+}
+
+} // namespace booking
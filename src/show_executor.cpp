@@ -0,0 +1,208 @@
+#include "show_executor.hpp"
+
+#include "atomic_wait.hpp"
+
+#include <chrono>
+
+namespace booking {
+
+namespace {
+
+std::atomic<std::uint64_t>& next_serial() {
+    static std::atomic<std::uint64_t> serial{1};
+    return serial;
+}
+
+/** @brief Executor whose worker the current thread is (null for other threads). */
+thread_local const ShowExecutor* current_worker_of = nullptr;
+
+constexpr int kSpinPolls = 256;                       /**< Empty polls before a worker parks. */
+constexpr int kSpinWaits = 1024;                      /**< Completion checks before a caller yields. */
+constexpr auto kParkTimeout = std::chrono::milliseconds(1); /**< Safety net for a missed wake-up. */
+
+} // namespace
+
+const char* to_string(ExecutionMode mode) {
+    switch (mode) {
+        case ExecutionMode::Shared: return "shared";
+        case ExecutionMode::OwnerThreads: return "owner-threads";
+    }
+    return "unknown";
+}
+
+const char* to_string(RequestLane lane) {
+    switch (lane) {
+        case RequestLane::Confirm: return "confirm";
+        case RequestLane::Book: return "book";
+        case RequestLane::Hold: return "hold";
+        case RequestLane::Read: return "read";
+    }
+    return "unknown";
+}
+
+ShowExecutor::ShowExecutor(unsigned workers, std::size_t ring_capacity, NumaPlacement placement)
+    : serial_(next_serial().fetch_add(1, std::memory_order_relaxed)), ring_capacity_(ring_capacity) {
+    if (workers == 0u) workers = std::thread::hardware_concurrency();
+    if (workers == 0u) workers = 1u;
+    SpscQueue<Task*> probe(ring_capacity); // validates the capacity before threads start
+    (void)probe;
+
+    workers_.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i) workers_.push_back(std::make_unique<Worker>());
+    if (placement != NumaPlacement::Off) {
+        topology_ = &NumaTopology::system();
+        const std::size_t nodes = topology_->node_count();
+        if (placement == NumaPlacement::Local && workers >= nodes) {
+            node_workers_.resize(nodes);
+            for (unsigned i = 0; i < workers; ++i) node_workers_[i % nodes].push_back(i);
+        }
+    }
+    for (unsigned i = 0; i < workers; ++i) {
+        Worker& w = *workers_[i];
+        w.thread = std::thread([this, i] { worker_loop(i); });
+        if (topology_ && pin_to_node(w.thread, *topology_, i % topology_->node_count())) {
+            w.node = static_cast<int>(i % topology_->node_count());
+        }
+    }
+}
+
+ShowExecutor::~ShowExecutor() {
+    stopping_.store(true, std::memory_order_seq_cst);
+    for (auto& w : workers_) {
+        std::lock_guard<std::mutex> lock(w->park_mutex);
+        w->park_cv.notify_one();
+    }
+    for (auto& w : workers_) w->thread.join();
+}
+
+bool ShowExecutor::on_worker() const {
+    return current_worker_of == this;
+}
+
+ShowExecutor::Lanes* ShowExecutor::producer_lanes() {
+    if (on_worker()) return nullptr;
+
+    // The serial tells instances apart, so a cache entry of a destroyed executor is never reused
+    struct Cache {
+        std::uint64_t serial = 0;
+        Lanes* lanes = nullptr;
+    };
+    thread_local Cache cache;
+    if (cache.serial == serial_) return cache.lanes;
+
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    const std::thread::id self = std::this_thread::get_id();
+    const std::size_t count = lane_count_.load(std::memory_order_relaxed);
+    Lanes* found = nullptr;
+    for (std::size_t p = 0; p < count && !found; ++p) {
+        if (lanes_[p]->producer == self) found = lanes_[p].get(); // thread alternating between executors
+    }
+    if (!found && count < kMaxProducers) {
+        auto lanes = std::make_unique<Lanes>();
+        lanes->producer = self;
+        lanes->rings.reserve(workers_.size() * kRequestLanes);
+        for (std::size_t r = 0; r < workers_.size() * kRequestLanes; ++r) {
+            lanes->rings.push_back(std::make_unique<SpscQueue<Task*>>(ring_capacity_));
+        }
+        found = lanes.get();
+        lanes_[count] = std::move(lanes);
+        lane_count_.store(count + 1u, std::memory_order_release);
+    }
+    cache = Cache{serial_, found};
+    return found;
+}
+
+void ShowExecutor::submit(Lanes& lanes, unsigned worker, RequestLane lane, Task* task) {
+    Worker& w = *workers_[worker];
+    SpscQueue<Task*>& ring = *lanes.rings[worker * kRequestLanes + static_cast<std::size_t>(lane)];
+    while (!ring.push(task)) std::this_thread::yield(); // full: the owner is draining it
+
+    // Pairs with the fence in worker_loop: either the worker sees the task or we see it parked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (w.parked.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(w.park_mutex);
+        w.parked.store(false, std::memory_order_relaxed);
+        w.park_cv.notify_one();
+    }
+}
+
+void ShowExecutor::wait(const Task& task) {
+    for (int i = 0; i < kSpinWaits; ++i) {
+        if (task.done.load(std::memory_order_acquire)) return;
+    }
+    atomic_wait(task.done, 0u);
+}
+
+std::uint64_t ShowExecutor::expired_count() const {
+    std::uint64_t total = 0;
+    for (const auto& w : workers_) total += w->expired.load(std::memory_order_relaxed);
+    return total;
+}
+
+std::size_t ShowExecutor::drain(unsigned index) {
+    std::size_t ran = 0;
+    for (std::size_t lane = 0; lane < kRequestLanes; ++lane) {
+        const std::size_t lane_ran = drain_lane(index, lane);
+        ran += lane_ran;
+        // Higher lanes may have filled while this one ran: look at them again first
+        if (lane_ran != 0u && lane != 0u) lane = static_cast<std::size_t>(-1);
+    }
+    return ran;
+}
+
+std::size_t ShowExecutor::drain_lane(unsigned index, std::size_t lane) {
+    std::size_t ran = 0;
+    const std::size_t count = lane_count_.load(std::memory_order_acquire);
+    const std::size_t ring_index = index * kRequestLanes + lane;
+    Worker& w = *workers_[index];
+    for (std::size_t p = 0; p < count; ++p) {
+        SpscQueue<Task*>& ring = *lanes_[p]->rings[ring_index];
+        Task* task = nullptr;
+        while (ring.pop(task)) {
+            if (task->deadline != kNoDeadline && Clock::now() > task->deadline) {
+                task->expired = true;
+                w.expired.store(w.expired.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+            } else {
+                task->invoke(task);
+            }
+            task->done.store(1u, std::memory_order_release); // the caller may free it now
+            atomic_notify_all(task->done);                    // by address only: safe after the free
+            ++ran;
+        }
+    }
+    return ran;
+}
+
+void ShowExecutor::worker_loop(unsigned index) {
+    current_worker_of = this;
+    Worker& w = *workers_[index];
+    int idle = 0;
+    while (true) {
+        if (drain(index) != 0u) {
+            idle = 0;
+            continue;
+        }
+        if (stopping_.load(std::memory_order_acquire)) {
+            if (drain(index) == 0u) break; // submitted before the stop request
+            continue;
+        }
+        if (++idle < kSpinPolls) continue;
+
+        // Announce parking, then look once more (Dekker with submit)
+        w.parked.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (drain(index) != 0u) {
+            w.parked.store(false, std::memory_order_relaxed);
+            idle = 0;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(w.park_mutex);
+        w.park_cv.wait_for(lock, kParkTimeout, [&] {
+            return !w.parked.load(std::memory_order_relaxed) || stopping_.load(std::memory_order_acquire);
+        });
+        w.parked.store(false, std::memory_order_relaxed);
+        idle = 0;
+    }
+}
+
+} // namespace booking
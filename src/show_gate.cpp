@@ -0,0 +1,109 @@
+#include "show_gate.hpp"
+
+#include "atomic_wait.hpp"
+#include "epoch.hpp"
+
+#include <thread>
+
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace booking {
+
+namespace {
+
+long membarrier(int cmd) { return syscall(__NR_membarrier, cmd, 0u, 0); }
+
+/** @brief Registers the process for private expedited barriers once; false if the kernel has none. */
+bool register_membarrier() {
+    const long commands = membarrier(MEMBARRIER_CMD_QUERY);
+    return commands >= 0 && (commands & MEMBARRIER_CMD_PRIVATE_EXPEDITED) != 0
+           && membarrier(MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED) == 0;
+}
+
+/** @brief Overflow passes the calling thread holds (they wait for a thaw only when it holds no other pass). */
+thread_local int t_overflow_depth = 0;
+
+/** @brief Orders a pass's announcement before its load of the frozen show. */
+void light_barrier() {
+    if (ShowGate::asymmetric()) {
+        std::atomic_signal_fence(std::memory_order_seq_cst); // the freezing thread's membarrier does the rest
+    } else {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+} // namespace
+
+bool ShowGate::asymmetric() {
+    static const bool registered = register_membarrier();
+    return registered;
+}
+
+ShowGate::ShowGate() : slots_(new Slot[EpochManager::kMaxThreads]) {
+    for (std::size_t i = 0; i < EpochManager::kMaxThreads; ++i) {
+        for (std::atomic<std::int64_t>& show : slots_[i].shows) show.store(kNone, std::memory_order_relaxed);
+    }
+    asymmetric(); // registered before the first pass
+}
+
+ShowGate::~ShowGate() = default;
+
+ShowGate::Pass::Pass(const ShowGate& gate, std::int64_t show) : gate_(gate), slot_(EpochManager::thread_index()) {
+    Slot* slot = slot_ >= 0 ? &gate_.slots_[static_cast<std::size_t>(slot_)] : nullptr;
+    if (slot == nullptr || slot->depth == kDepth) {
+        slot_ = -1;
+        const bool nested = t_overflow_depth > 0 || (slot != nullptr && slot->depth > 0);
+        ++t_overflow_depth;
+        while (true) {
+            gate_.overflow_.fetch_add(1u);
+            if (nested || gate_.frozen_.load() != show) return;
+            gate_.overflow_.fetch_sub(1u, std::memory_order_release);
+            gate_.wait_thawed(show);
+        }
+    }
+    depth_ = slot->depth++;
+    bool held = t_overflow_depth > 0;
+    for (int d = 0; d < depth_ && !held; ++d) held = slot->shows[d].load(std::memory_order_relaxed) == show;
+    while (true) {
+        slot->shows[depth_].store(show, std::memory_order_relaxed);
+        light_barrier();
+        if (held || gate_.frozen_.load(std::memory_order_acquire) != show) return;
+        slot->shows[depth_].store(kNone, std::memory_order_release);
+        gate_.wait_thawed(show);
+    }
+}
+
+ShowGate::Pass::~Pass() {
+    if (slot_ < 0) {
+        --t_overflow_depth;
+        gate_.overflow_.fetch_sub(1u, std::memory_order_release);
+        return;
+    }
+    Slot& slot = gate_.slots_[static_cast<std::size_t>(slot_)];
+    slot.shows[depth_].store(kNone, std::memory_order_release);
+    --slot.depth;
+}
+
+void ShowGate::wait_thawed(std::int64_t show) const {
+    atomic_wait(frozen_, show);
+}
+
+void ShowGate::thaw() {
+    frozen_.store(kNone, std::memory_order_release);
+    atomic_notify_all(frozen_);
+}
+
+void ShowGate::freeze(std::int64_t show) {
+    frozen_.store(show);
+    if (asymmetric()) membarrier(MEMBARRIER_CMD_PRIVATE_EXPEDITED);
+    for (std::size_t i = 0; i < EpochManager::kMaxThreads; ++i) {
+        for (const std::atomic<std::int64_t>& entry : slots_[i].shows) {
+            while (entry.load(std::memory_order_acquire) == show) std::this_thread::yield();
+        }
+    }
+    while (overflow_.load(std::memory_order_acquire) != 0u) std::this_thread::yield();
+}
+
+} // namespace booking
@@ -0,0 +1,25 @@
+#include "show_routes.hpp"
+
+namespace booking {
+
+BookingService::ShowHandle* ShowRoutes::find(MovieId movie_id, TheaterId theater_id) {
+    // Version read before the lookup: a catalog update racing with it empties the table next time
+    const std::uint64_t version = service_.catalog_version();
+    if (version != version_) {
+        routes_.clear();
+        version_ = version;
+    }
+    const Pair key{movie_id, theater_id};
+    const auto it = routes_.find(key);
+    if (it != routes_.end()) {
+        ++hits_;
+        return &it->second;
+    }
+
+    ++misses_;
+    const ShowId show_id = service_.find_show(movie_id, theater_id);
+    if (!show_id.valid()) return nullptr;
+    return &routes_.emplace(key, service_.show_handle(show_id)).first->second;
+}
+
+} // namespace booking
@@ -0,0 +1,90 @@
+#include "sim_scheduler.hpp"
+
+namespace booking {
+
+namespace detail {
+
+thread_local SimScheduler* sim_current = nullptr;
+
+} // namespace detail
+
+namespace {
+
+/** @brief Index of the simulated task running on this thread. */
+thread_local std::size_t sim_task = 0;
+
+std::uint64_t splitmix64(std::uint64_t& state) {
+    std::uint64_t x = (state += 0x9e3779b97f4a7c15ull);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+} // namespace
+
+void SimScheduler::run(std::vector<Task> tasks) {
+    if (tasks.empty()) return;
+    std::unique_lock<std::mutex> lock(mutex_);
+    rng_ = seed_;
+    points_ = 0;
+    switches_ = 0;
+    hash_ = 0xcbf29ce484222325u;
+    slots_.clear();
+    for (std::size_t i = 0; i < tasks.size(); ++i) slots_.push_back(std::make_unique<Slot>());
+    remaining_ = tasks.size();
+    running_ = pick();
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        slots_[i]->thread = std::thread([this, i, &tasks] { task_main(i, tasks[i]); });
+    }
+    finished_.wait(lock, [&] { return remaining_ == 0u; });
+    lock.unlock();
+    for (auto& slot : slots_) slot->thread.join();
+}
+
+void SimScheduler::yield() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++points_;
+    const std::size_t next = pick();
+    if (next != sim_task) switch_to(next, sim_task, lock);
+}
+
+std::size_t SimScheduler::pick() {
+    std::size_t choice = static_cast<std::size_t>(splitmix64(rng_) % remaining_);
+    std::size_t next = 0;
+    for (;; ++next) {
+        if (slots_[next]->done) continue;
+        if (choice == 0u) break;
+        --choice;
+    }
+    hash_ = (hash_ ^ next) * 0x100000001b3u;
+    return next;
+}
+
+void SimScheduler::switch_to(std::size_t next, std::size_t self, std::unique_lock<std::mutex>& lock) {
+    ++switches_;
+    running_ = next;
+    slots_[next]->turn.notify_one();
+    slots_[self]->turn.wait(lock, [&] { return running_ == self; });
+}
+
+void SimScheduler::task_main(std::size_t self, const Task& task) {
+    detail::sim_current = this;
+    sim_task = self;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        slots_[self]->turn.wait(lock, [&] { return running_ == self; });
+    }
+    task();
+    detail::sim_current = nullptr;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    slots_[self]->done = true;
+    if (--remaining_ == 0u) {
+        finished_.notify_one();
+        return;
+    }
+    running_ = pick();
+    slots_[running_]->turn.notify_one();
+}
+
+} // namespace booking
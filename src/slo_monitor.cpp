@@ -0,0 +1,79 @@
+#include "slo_monitor.hpp"
+
+#include <utility>
+
+namespace booking {
+
+SloMonitor::SloMonitor(SloPolicy policy)
+    : policy_(std::move(policy)), points_(policy_.budgets.size()), status_(policy_.budgets.size()) {
+    for (std::size_t i = 0; i < status_.size(); ++i) status_[i].budget = policy_.budgets[i];
+}
+
+std::uint64_t SloMonitor::within(const LatencyHistogram& h, std::chrono::nanoseconds threshold) {
+    if (threshold.count() < 0) return 0;
+    const auto limit = static_cast<std::uint64_t>(threshold.count());
+    std::uint64_t n = 0;
+    for (std::size_t i = 0; i < LatencyHistogram::kBuckets && LatencyHistogram::bucket_upper(i) <= limit; ++i) {
+        n += h.bucket_count(i);
+    }
+    return n;
+}
+
+double SloMonitor::burn(const std::deque<Point>& points, Clock::time_point since, double objective,
+                        std::uint64_t* calls, std::uint64_t* within) const {
+    const Point& last = points.back();
+    const Point* first = &points.front();
+    for (const Point& p : points) {
+        if (p.at > since) break;
+        first = &p;
+    }
+    const std::uint64_t n = last.calls - first->calls;
+    const std::uint64_t good = last.within - first->within;
+    if (calls) *calls = n;
+    if (within) *within = good;
+    if (n == 0u) return 0.0;
+    const double allowed = objective < 1.0 ? 1.0 - objective : 1e-9;
+    return static_cast<double>(n - good) / static_cast<double>(n) / allowed;
+}
+
+void SloMonitor::sample(const std::array<ServiceMetrics::ApiTotals, kMetricsApis>& totals, Clock::time_point now) {
+    std::vector<SloAlert> transitions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t i = 0; i < policy_.budgets.size(); ++i) {
+            const SloBudget& budget = policy_.budgets[i];
+            const LatencyHistogram& h = totals[static_cast<std::size_t>(budget.api)].latency;
+            std::deque<Point>& points = points_[i];
+            points.push_back(Point{now, h.count(), within(h, budget.threshold)});
+            // Keep one point at or before the window start
+            while (points.size() > 2u && points[1].at <= now - policy_.window) points.pop_front();
+
+            SloStatus& s = status_[i];
+            s.burn_rate = burn(points, now - policy_.window, budget.objective, &s.calls, &s.within);
+            std::uint64_t short_calls = 0;
+            s.short_burn_rate = burn(points, now - policy_.short_window, budget.objective, &short_calls);
+            s.compliance = s.calls == 0u ? 1.0 : static_cast<double>(s.within) / static_cast<double>(s.calls);
+            s.budget_left = 1.0 - s.burn_rate;
+
+            const bool fire = s.burn_rate >= policy_.fast_burn && s.short_burn_rate >= policy_.fast_burn
+                              && short_calls >= policy_.min_calls;
+            if (!s.alerting && fire) {
+                s.alerting = true;
+                transitions.push_back(SloAlert{s, true});
+            } else if (s.alerting && s.short_burn_rate < policy_.fast_burn) {
+                s.alerting = false;
+                transitions.push_back(SloAlert{s, false});
+            }
+        }
+    }
+    if (policy_.on_alert) {
+        for (const SloAlert& alert : transitions) policy_.on_alert(alert);
+    }
+}
+
+std::vector<SloStatus> SloMonitor::status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return status_;
+}
+
+} // namespace booking
@@ -0,0 +1,152 @@
+#include "snapshot.hpp"
+
+#include "seat_map_codec.hpp"
+
+#include <array>
+#include <cstring>
+
+namespace booking {
+
+const char* to_string(SnapshotStatus status) {
+    switch (status) {
+        case SnapshotStatus::Ok: return "Snapshot ok";
+        case SnapshotStatus::IoError: return "Snapshot I/O error";
+        case SnapshotStatus::BadMagic: return "Not a snapshot file";
+        case SnapshotStatus::UnsupportedVersion: return "Unsupported snapshot version";
+        case SnapshotStatus::Corrupt: return "Corrupt snapshot";
+        case SnapshotStatus::CatalogError: return "Snapshot conflicts with the catalog";
+    }
+    return "Unknown status";
+}
+
+const char* to_string(SnapshotLoad load) {
+    switch (load) {
+        case SnapshotLoad::Eager: return "eager";
+        case SnapshotLoad::Lazy: return "lazy";
+    }
+    return "unknown";
+}
+
+std::uint64_t snapshot_checksum(const std::uint64_t* words, std::size_t count, std::uint64_t seed) {
+    // Multiply-rotate mixing per word (as in the xxHash64 round); an empty input keeps the seed
+    constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87u;
+    constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Fu;
+    std::uint64_t h = seed;
+    for (std::size_t i = 0; i < count; ++i) {
+        h ^= words[i] * kPrime2;
+        h = (h << 31) | (h >> 33);
+        h *= kPrime1;
+    }
+    return h;
+}
+
+namespace {
+
+bool section_fits(const SnapshotSection& s, std::size_t record_size, std::uint64_t file_size) {
+    if (s.offset % 8u != 0u || s.offset > file_size) return false;
+    if (s.count > (file_size - s.offset) / record_size) return false;
+    return true;
+}
+
+} // namespace
+
+SnapshotStatus SnapshotView::open(std::string_view bytes) {
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    return SnapshotStatus::UnsupportedVersion; // records are used in place
+#endif
+    if (bytes.size() < sizeof(SnapshotHeader)) return SnapshotStatus::Corrupt;
+    if (reinterpret_cast<std::uintptr_t>(bytes.data()) % 8u != 0u) return SnapshotStatus::Corrupt;
+    const auto* h = reinterpret_cast<const SnapshotHeader*>(bytes.data());
+    if (std::memcmp(h->magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) return SnapshotStatus::BadMagic;
+    if (h->version != kSnapshotVersion || h->header_size != sizeof(SnapshotHeader)) {
+        return SnapshotStatus::UnsupportedVersion;
+    }
+    if (h->file_size != bytes.size() || h->file_size % 8u != 0u) return SnapshotStatus::Corrupt;
+
+    const std::uint64_t size = h->file_size;
+    if (!section_fits(h->movies, sizeof(SnapshotName), size) || !section_fits(h->theaters, sizeof(SnapshotName), size)
+        || !section_fits(h->layouts, sizeof(SnapshotLayout), size) || !section_fits(h->rows, sizeof(SnapshotRow), size)
+        || !section_fits(h->shows, sizeof(SnapshotShow), size) || !section_fits(h->seat_maps, 1u, size)
+        || !section_fits(h->strings, 1u, size)) {
+        return SnapshotStatus::Corrupt;
+    }
+
+    const auto* payload = reinterpret_cast<const std::uint64_t*>(bytes.data() + sizeof(SnapshotHeader));
+    if (snapshot_checksum(payload, (size - sizeof(SnapshotHeader)) / 8u) != h->checksum) {
+        return SnapshotStatus::Corrupt;
+    }
+
+    base_ = bytes.data();
+    header_ = h;
+
+    // References between sections
+    auto string_ok = [&](std::uint32_t off, std::uint32_t len) {
+        return std::uint64_t{off} + len <= h->strings.count;
+    };
+    for (std::uint64_t i = 0; i < h->movies.count; ++i) {
+        if (!string_ok(movies()[i].name_offset, movies()[i].name_length)) return SnapshotStatus::Corrupt;
+    }
+    for (std::uint64_t i = 0; i < h->theaters.count; ++i) {
+        if (!string_ok(theaters()[i].name_offset, theaters()[i].name_length)) return SnapshotStatus::Corrupt;
+    }
+    for (std::uint64_t i = 0; i < h->layouts.count; ++i) {
+        if (std::uint64_t{layouts()[i].first_row} + layouts()[i].row_count > h->rows.count) return SnapshotStatus::Corrupt;
+    }
+    for (std::uint64_t i = 0; i < h->rows.count; ++i) {
+        if (!string_ok(rows()[i].label_offset, rows()[i].label_length)) return SnapshotStatus::Corrupt;
+    }
+    std::array<std::uint64_t, 64> row_masks{};
+    for (std::uint64_t i = 0; i < h->shows.count; ++i) {
+        const SnapshotShow& s = shows()[i];
+        if (s.layout_id < 0 || static_cast<std::uint64_t>(s.layout_id) >= h->layouts.count) return SnapshotStatus::Corrupt;
+        const SnapshotLayout& layout = layouts()[s.layout_id];
+        if (layout.row_count > row_masks.size()) return SnapshotStatus::Corrupt;
+        if (s.seat_map > h->seat_maps.count || s.seat_map_size > h->seat_maps.count - s.seat_map) {
+            return SnapshotStatus::Corrupt;
+        }
+        for (std::uint32_t r = 0; r < layout.row_count; ++r) {
+            const std::int32_t seats = rows()[layout.first_row + r].seats;
+            if (seats < 0 || seats > 64) return SnapshotStatus::Corrupt;
+            row_masks[r] = seats == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << seats) - 1u;
+        }
+        if (!decode_seat_map(seat_maps() + s.seat_map, s.seat_map_size, row_masks.data(),
+                             static_cast<int>(layout.row_count), nullptr, nullptr)) {
+            return SnapshotStatus::Corrupt;
+        }
+    }
+    return SnapshotStatus::Ok;
+}
+
+SnapshotStatus SnapshotDeltaView::open(std::string_view bytes) {
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    return SnapshotStatus::UnsupportedVersion; // records are used in place
+#endif
+    if (bytes.size() < sizeof(SnapshotDeltaHeader)) return SnapshotStatus::Corrupt;
+    if (reinterpret_cast<std::uintptr_t>(bytes.data()) % 8u != 0u) return SnapshotStatus::Corrupt;
+    const auto* h = reinterpret_cast<const SnapshotDeltaHeader*>(bytes.data());
+    if (std::memcmp(h->magic, kSnapshotDeltaMagic, sizeof(kSnapshotDeltaMagic)) != 0) return SnapshotStatus::BadMagic;
+    if (h->version != kSnapshotDeltaVersion || h->header_size != sizeof(SnapshotDeltaHeader)) {
+        return SnapshotStatus::UnsupportedVersion;
+    }
+    if (h->file_size != bytes.size() || h->file_size % 8u != 0u) return SnapshotStatus::Corrupt;
+    if (!section_fits(h->shows, sizeof(SnapshotDeltaShow), h->file_size)
+        || !section_fits(h->seat_maps, 1u, h->file_size)) {
+        return SnapshotStatus::Corrupt;
+    }
+    const auto* payload = reinterpret_cast<const std::uint64_t*>(bytes.data() + sizeof(SnapshotDeltaHeader));
+    if (snapshot_checksum(payload, (h->file_size - sizeof(SnapshotDeltaHeader)) / 8u) != h->checksum) {
+        return SnapshotStatus::Corrupt;
+    }
+
+    base_ = bytes.data();
+    header_ = h;
+    for (std::uint64_t i = 0; i < h->shows.count; ++i) {
+        const SnapshotDeltaShow& s = shows()[i];
+        if (s.seat_map > h->seat_maps.count || s.seat_map_size > h->seat_maps.count - s.seat_map) {
+            return SnapshotStatus::Corrupt;
+        }
+    }
+    return SnapshotStatus::Ok;
+}
+
+} // namespace booking
@@ -0,0 +1,68 @@
+#include "sparse_id_map.hpp"
+
+namespace booking {
+
+namespace {
+
+/** @brief Groups of the first table. */
+constexpr std::size_t kInitialGroups = 4;
+
+} // namespace
+
+std::unique_ptr<SparseIdMap::Table> SparseIdMap::make_table(std::size_t groups) {
+    auto t = std::make_unique<Table>();
+    t->group_mask = groups - 1u;
+    t->ctrl = std::make_unique<std::atomic<std::uint64_t>[]>(groups * 2u);
+    t->keys = std::make_unique<std::atomic<std::uint64_t>[]>(groups * kGroupSize);
+    t->slots = std::make_unique<std::atomic<std::uint32_t>[]>(groups * kGroupSize);
+    for (std::size_t w = 0; w < groups * 2u; ++w) t->ctrl[w].store(kEmptyWord, std::memory_order_relaxed);
+    return t;
+}
+
+void SparseIdMap::place(Table& t, std::uint64_t id, std::uint32_t slot) {
+    const std::uint64_t h = hash(id);
+    std::size_t group = static_cast<std::size_t>(h >> 7) & t.group_mask;
+    for (std::size_t step = 1;; ++step) {
+        std::atomic<std::uint64_t>* ctrl = &t.ctrl[group * 2u];
+        const std::uint32_t free =
+            empty(ctrl[0].load(std::memory_order_relaxed), ctrl[1].load(std::memory_order_relaxed));
+        if (free != 0u) {
+            const unsigned lane = static_cast<unsigned>(__builtin_ctz(free));
+            const std::size_t e = group * kGroupSize + lane;
+            t.keys[e].store(id, std::memory_order_relaxed);
+            t.slots[e].store(slot, std::memory_order_relaxed);
+            // Publishing the control byte makes the key and slot visible to find
+            std::atomic<std::uint64_t>& word = ctrl[lane / 8u];
+            const unsigned shift = (lane % 8u) * 8u;
+            const std::uint64_t tag = h & 0x7Fu;
+            const std::uint64_t next = (word.load(std::memory_order_relaxed) & ~(std::uint64_t{0xFF} << shift)) | tag << shift;
+            word.store(next, std::memory_order_release);
+            return;
+        }
+        group = (group + step) & t.group_mask;
+    }
+}
+
+bool SparseIdMap::insert(std::uint64_t id, std::uint32_t slot) {
+    if (find(id) != kNoSlot) return false;
+    Table* t = table_.load(std::memory_order_relaxed);
+    const std::size_t entries = t ? (t->group_mask + 1u) * kGroupSize : 0u;
+    if ((size_ + 1u) * 8u > entries * 7u) {
+        // Above 7/8 full: rehash into a table twice the size, then publish it
+        const std::size_t groups = t ? (t->group_mask + 1u) * 2u : kInitialGroups;
+        std::unique_ptr<Table> bigger = make_table(groups);
+        for (std::size_t e = 0; t && e < entries; ++e) {
+            const std::uint64_t word = t->ctrl[e / 8u].load(std::memory_order_relaxed);
+            if ((word >> ((e % 8u) * 8u) & kEmpty) != 0u) continue;
+            place(*bigger, t->keys[e].load(std::memory_order_relaxed), t->slots[e].load(std::memory_order_relaxed));
+        }
+        t = bigger.get();
+        table_.store(t, std::memory_order_release);
+        tables_.push_back(std::move(bigger)); // readers may still probe older ones
+    }
+    place(*t, id, slot);
+    ++size_;
+    return true;
+}
+
+} // namespace booking
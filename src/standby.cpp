@@ -0,0 +1,152 @@
+#include "standby.hpp"
+
+#include "journal.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
+namespace booking {
+
+namespace {
+
+/** @brief Journal bytes read at a time (at least one record of 64 rows). */
+constexpr std::size_t kTailChunk = 256 * 1024;
+
+/** @brief Largest journal record: its 32-byte header and a seat word per row. */
+constexpr std::size_t kMaxRecordBytes = 32u + 8u * SeatMask::kWords;
+
+std::int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+WarmStandby::WarmStandby(BookingService& service, StandbyOptions options)
+    : service_(service), options_(std::move(options)), buf_(new char[kTailChunk]) {}
+
+WarmStandby::~WarmStandby() {
+    stop();
+    close_file();
+}
+
+SnapshotStatus WarmStandby::start() {
+    if (thread_.joinable() || promoted()) return SnapshotStatus::Ok;
+    if (!options_.snapshot_path.empty()) {
+        struct stat info{};
+        const bool chain = ::stat(options_.snapshot_path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+        const SnapshotStatus restored = chain ? service_.restore_snapshot_chain(options_.snapshot_path, options_.load)
+                                              : service_.restore_snapshot(options_.snapshot_path, options_.load);
+        if (restored != SnapshotStatus::Ok) return restored;
+    }
+    next_lsn_.store(std::max(next_lsn_.load(std::memory_order_relaxed), service_.restored_journal_lsn()),
+                    std::memory_order_release);
+    stop_.store(false, std::memory_order_release);
+    thread_ = std::thread([this] { run(); });
+    return SnapshotStatus::Ok;
+}
+
+void WarmStandby::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_.store(true, std::memory_order_release);
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+JournalStatus WarmStandby::promote(JournalMode mode, JournalBackend backend) {
+    if (promoted()) return JournalStatus::Ok;
+    stop();
+    bool at_end = false;
+    while (!at_end) at_end = poll(); // the records written since the tail's last read
+    close_file();
+    const JournalStatus opened = service_.open_journal(options_.journal_path, mode, backend);
+    if (opened == JournalStatus::Ok) promoted_.store(true, std::memory_order_release);
+    return opened;
+}
+
+std::chrono::nanoseconds WarmStandby::staleness() const {
+    const std::int64_t at = caught_up_ns_.load(std::memory_order_acquire);
+    if (at < 0) return std::chrono::nanoseconds::max();
+    return std::chrono::nanoseconds(std::max<std::int64_t>(0, steady_ns() - at));
+}
+
+void WarmStandby::run() {
+    while (!stop_.load(std::memory_order_acquire)) {
+        if (!poll()) continue;
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, options_.poll_interval, [this] { return stop_.load(std::memory_order_acquire); });
+    }
+}
+
+void WarmStandby::close_file() {
+    if (file_ >= 0) ::close(file_);
+    file_ = -1;
+    file_pos_ = 0;
+    header_checked_ = false;
+}
+
+bool WarmStandby::poll() {
+    const std::int64_t read_at = steady_ns();
+    if (file_ < 0) {
+        file_ = ::open(options_.journal_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file_ < 0) return true; // the primary has not created it yet
+    }
+    // Checked before the read: once a compacted journal has replaced the file, the old one
+    // no longer grows, so reading it to its end applies everything it holds
+    struct stat named{};
+    struct stat opened{};
+    const bool replaced = ::stat(options_.journal_path.c_str(), &named) == 0 && ::fstat(file_, &opened) == 0
+                          && named.st_ino != opened.st_ino;
+    ssize_t got = ::pread(file_, buf_.get(), kTailChunk, static_cast<off_t>(file_pos_));
+    if (got < 0) got = 0;
+    const std::size_t filled = static_cast<std::size_t>(got);
+    bool at_end = filled < kTailChunk;
+
+    std::size_t begin = 0;
+    if (!header_checked_) {
+        // A header not fully written yet, or not a journal (still read as the end, retried)
+        if (filled < kJournalHeaderSize
+            || JournalReader(std::string_view(buf_.get(), kJournalHeaderSize)).status() != JournalStatus::Ok) {
+            if (replaced) close_file();
+            return !replaced;
+        }
+        header_checked_ = true;
+        begin = kJournalHeaderSize;
+    }
+
+    // Whole records only; those the snapshot or an older file covered are skipped
+    JournalReader reader = JournalReader::records(std::string_view(buf_.get() + begin, filled - begin));
+    JournalRecord r;
+    std::uint64_t next = next_lsn_.load(std::memory_order_relaxed);
+    while (reader.next(r)) {
+        if (r.lsn < next) continue;
+        if (service_.apply_journal_record(r)) {
+            applied_.fetch_add(1u, std::memory_order_relaxed);
+        } else {
+            skipped_.fetch_add(1u, std::memory_order_relaxed);
+        }
+        next = r.end_lsn;
+        next_lsn_.store(next, std::memory_order_release);
+    }
+    const std::size_t consumed = begin + reader.offset();
+    file_pos_ += static_cast<std::int64_t>(consumed);
+    // More unparsed bytes than any record takes are the zero-filled, preallocated end of a
+    // Mapped journal, not a record cut by the chunk: the end of the journal for now
+    at_end = at_end || filled - consumed >= kMaxRecordBytes;
+
+    if (replaced && at_end) {
+        close_file(); // continue in the compacted file after the last record applied
+        return false;
+    }
+    if (at_end) caught_up_ns_.store(read_at, std::memory_order_release);
+    return at_end;
+}
+
+} // namespace booking
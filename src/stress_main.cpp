@@ -0,0 +1,440 @@
+#include "booking_service.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Concurrency stress test: every thread books, cancels, holds, confirms, releases and reads
+// overlapping seats of a few small halls, checking the service against a shadow table of
+// who holds each seat, and reports throughput.
+//
+//   booking_stress [--threads=N] [--seconds=S] [--scale=1] [--shows=N] [--rows=R] [--seats=S]
+//                  [--check-ms=MS] [--seed=N]
+//
+// Threads default to one per core. --scale=1 runs 1, 2, 4, ... threads up to --threads for
+// --seconds each and prints a throughput table (all calls per second, then successful calls
+// per second of each operation). Checked while the threads run:
+//   - a successful booking or hold finds its seats unclaimed in the shadow table (no seat
+//     is ever double-owned), and seat_owner names the booking;
+//   - a free-seat mask never contains a seat the reading thread holds or booked, and the
+//     count returned with it is the mask's popcount;
+//   - the hold mask contains the reading thread's holds and none of its bookings;
+//   - cancelling or settling what a thread owns always succeeds.
+// Every --check-ms the threads are parked and each seat is compared with the shadow table:
+// free seats are free and unowned, booked seats are taken by their booking, held seats are
+// taken, in the hold mask and unowned, and available_count matches. The exit status is 1 if
+// any check failed.
+
+namespace {
+
+using booking::BookingId;
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::SeatMask;
+using booking::ShowId;
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    double seconds = 60.0;
+    bool scale = false;  // run 1, 2, 4, ... threads
+    int shows = 4;
+    int rows = 8;
+    int seats = 16;
+    int check_ms = 250;  // period of the parked full check
+    std::uint64_t seed = 7;
+};
+
+enum Op { kBook, kCancel, kHold, kConfirm, kRelease, kRead, kOps };
+const char* const kOpNames[kOps] = {"book", "cancel", "hold", "confirm", "release", "read"};
+
+// Shadow entry of a seat: (id << 2) | kind, 0 if free
+constexpr std::uint64_t kBooked = 1;
+constexpr std::uint64_t kHeld = 2;
+
+// Settled holds keep their slot until their deadline passes, so the table is sized for
+// kHoldTtl of holds; when it is full anyway, hold_seats fails with HoldCapacity
+constexpr std::chrono::milliseconds kHoldTtl{10000};
+constexpr std::size_t kHoldSlots = std::size_t{1} << 18;
+
+bool parse_option(const char* arg, Options& o) {
+    const char* eq = std::strchr(arg, '=');
+    if (std::strncmp(arg, "--", 2) != 0 || !eq) return false;
+    const std::string key(arg + 2, eq);
+    const char* v = eq + 1;
+    if (key == "threads") o.threads = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+    else if (key == "seconds") o.seconds = std::strtod(v, nullptr);
+    else if (key == "scale") o.scale = std::atoi(v) != 0;
+    else if (key == "shows") o.shows = std::atoi(v);
+    else if (key == "rows") o.rows = std::atoi(v);
+    else if (key == "seats") o.seats = std::atoi(v);
+    else if (key == "check-ms") o.check_ms = std::atoi(v);
+    else if (key == "seed") o.seed = std::strtoull(v, nullptr, 10);
+    else return false;
+    return true;
+}
+
+bool valid(const Options& o) {
+    return o.threads >= 1 && o.seconds > 0 && o.shows >= 1 && o.shows <= 1024 && o.rows >= 1
+           && o.rows <= HallLayout::kMaxRows && o.seats >= 1 && o.seats <= HallLayout::kMaxRowSeats && o.check_ms >= 1;
+}
+
+bool intersects(const SeatMask& a, const SeatMask& b) {
+    for (int w = b.first_word(); w < b.end_word(); ++w) {
+        if ((a.word(w) & b.word(w)) != 0u) return true;
+    }
+    return false;
+}
+
+/** @brief Seats a thread booked (kBooked) or holds (kHeld). */
+struct Owned {
+    ShowId show;
+    SeatMask seats;
+    std::uint64_t id;
+    std::uint64_t kind;
+};
+
+struct ThreadStats {
+    std::uint64_t ops[kOps] = {};
+    std::uint64_t ok[kOps] = {};
+};
+
+/** @brief State shared by the threads of one run. */
+class Run {
+public:
+    Run(const Options& o, unsigned threads)
+        : o_(o), threads_(threads), svc_{BookingService::EmptyCatalog{}},
+          shadow_(static_cast<std::size_t>(o.shows) * HallLayout::kMaxRows * HallLayout::kMaxRowSeats),
+          stats_(threads) {
+        booking::Schedule schedule;
+        schedule.movies.push_back(booking::ScheduleMovie{1, "Stress"});
+        schedule.theaters.push_back(booking::ScheduleTheater{1, "Stress"});
+        schedule.layouts.push_back(booking::ScheduleLayout{0, HallLayout::uniform(o.rows, o.seats)});
+        for (int s = 0; s < o.shows; ++s) schedule.shows.push_back(booking::ScheduleShow{s, 1, 1, 0});
+        svc_.load_schedule(std::move(schedule));
+        svc_.set_hold_capacity(kHoldSlots);
+    }
+
+    /** @brief Runs the threads for o.seconds; returns the elapsed seconds. */
+    double execute() {
+        std::vector<std::thread> threads;
+        const Clock::time_point start = Clock::now();
+        for (unsigned t = 0; t < threads_; ++t) threads.emplace_back([this, t] { worker(t); });
+        const Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(
+                                                  std::chrono::duration<double>(o_.seconds));
+        while (Clock::now() < end) {
+            std::this_thread::sleep_for(std::min<Clock::duration>(std::chrono::milliseconds(o_.check_ms),
+                                                                  std::max<Clock::duration>(end - Clock::now(), {})));
+            pause_.store(true, std::memory_order_seq_cst);
+            while (parked_.load(std::memory_order_seq_cst) != threads_) std::this_thread::yield();
+            check_all();
+            svc_.expire_holds(); // recycles the slots of settled holds
+            pause_.store(false, std::memory_order_seq_cst);
+        }
+        stop_.store(true);
+        for (std::thread& t : threads) t.join();
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        check_all();
+        return elapsed;
+    }
+
+    ThreadStats total() const {
+        ThreadStats sum;
+        for (const ThreadStats& s : stats_) {
+            for (int op = 0; op < kOps; ++op) {
+                sum.ops[op] += s.ops[op];
+                sum.ok[op] += s.ok[op];
+            }
+        }
+        return sum;
+    }
+
+    std::uint64_t violations() const { return violations_.load(); }
+    std::uint64_t full_checks() const { return full_checks_; }
+
+private:
+    std::atomic<std::uint64_t>& shadow(ShowId show, int seat) {
+        return shadow_[static_cast<std::size_t>(show.value()) * HallLayout::kMaxRows * HallLayout::kMaxRowSeats
+                       + static_cast<std::size_t>(seat)];
+    }
+
+    void fail(const char* what, ShowId show, int seat, std::uint64_t detail) {
+        if (violations_.fetch_add(1) < 20u) {
+            std::lock_guard<std::mutex> lock(report_mutex_);
+            std::fprintf(stderr, "VIOLATION %s: show %lld seat %d (%llu)\n", what, static_cast<long long>(show.value()),
+                         seat, static_cast<unsigned long long>(detail));
+        }
+    }
+
+    /** @brief Claims the seats of @p o in the shadow table; every seat must be unclaimed. */
+    void claim(const Owned& o) {
+        for_each_seat(o.seats, [&](int seat) {
+            std::uint64_t expected = 0;
+            if (!shadow(o.show, seat).compare_exchange_strong(expected, o.id << 2 | o.kind)) {
+                fail("seat double-owned", o.show, seat, expected);
+            }
+        });
+    }
+
+    /** @brief Unclaims @p seats; each must have been claimed by @p o. */
+    void unclaim(const Owned& o) {
+        for_each_seat(o.seats, [&](int seat) {
+            const std::uint64_t was = shadow(o.show, seat).exchange(0);
+            if (was != (o.id << 2 | o.kind)) fail("shadow entry changed under its owner", o.show, seat, was);
+        });
+    }
+
+    template <typename F>
+    static void for_each_seat(const SeatMask& seats, F&& f) {
+        for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+            for (std::uint64_t bits = seats.word(w); bits != 0u; bits &= bits - 1u) {
+                f(HallLayout::seat_index(w, booking::ctz64(bits)));
+            }
+        }
+    }
+
+    static bool conflict(BookingStatus s) {
+        return s == BookingStatus::AlreadyBooked || s == BookingStatus::Contended || s == BookingStatus::Busy
+               || s == BookingStatus::HoldCapacity;
+    }
+
+    /** @brief 1-4 adjacent seats at a random spot, on a second row one time in five. */
+    SeatMask pick(std::mt19937_64& rng) const {
+        std::uniform_int_distribution<int> size(1, std::min(4, o_.seats));
+        const int n = size(rng);
+        const int row = static_cast<int>(rng() % static_cast<std::uint64_t>(o_.rows));
+        const int col = static_cast<int>(rng() % static_cast<std::uint64_t>(o_.seats - n + 1));
+        const std::uint64_t bits = ((n >= 64 ? 0u : std::uint64_t{1} << n) - 1u) << col;
+        SeatMask m;
+        m.or_word(row, bits);
+        if (o_.rows > 1 && rng() % 5u == 0u) m.or_word((row + 1) % o_.rows, bits);
+        return m;
+    }
+
+    void worker(unsigned index) {
+        std::mt19937_64 rng(o_.seed * 1000003u + index);
+        ThreadStats& stats = stats_[index];
+        std::vector<Owned> mine;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            if (pause_.load(std::memory_order_seq_cst)) {
+                parked_.fetch_add(1, std::memory_order_seq_cst);
+                while (pause_.load(std::memory_order_seq_cst)) std::this_thread::yield();
+                parked_.fetch_sub(1, std::memory_order_seq_cst);
+                continue;
+            }
+            const ShowId show = static_cast<std::int64_t>(rng() % static_cast<std::uint64_t>(o_.shows));
+            const unsigned roll = static_cast<unsigned>(rng() % 100u);
+            const std::size_t held = static_cast<std::size_t>(
+                std::find_if(mine.begin(), mine.end(), [](const Owned& x) { return x.kind == kHeld; }) - mine.begin());
+            if (held < mine.size() && roll < 30) {
+                settle(mine, held, roll < 15, stats);
+            } else if (roll < 40) {
+                read(show, mine, stats);
+            } else if (roll < 65 || mine.size() > 64) {
+                if (!mine.empty() && (roll >= 60 || mine.size() > 64)) {
+                    cancel(mine, static_cast<std::size_t>(rng() % mine.size()), stats);
+                } else {
+                    take(show, pick(rng), kBooked, mine, stats);
+                }
+            } else if (roll < 80) {
+                take(show, pick(rng), kHeld, mine, stats);
+            } else if (!mine.empty()) {
+                cancel(mine, static_cast<std::size_t>(rng() % mine.size()), stats);
+            } else {
+                read(show, mine, stats);
+            }
+        }
+        // Leave the seats as they are: the final full check compares them with the shadow table
+    }
+
+    void take(ShowId show, const SeatMask& seats, std::uint64_t kind, std::vector<Owned>& mine, ThreadStats& stats) {
+        const Op op = kind == kBooked ? kBook : kHold;
+        const BookingResult r =
+            kind == kBooked ? svc_.book_seat_mask(show, seats) : svc_.hold_seat_mask(show, seats, kHoldTtl);
+        ++stats.ops[op];
+        if (!r.success) {
+            if (!conflict(r.status)) fail(booking::to_string(r.status), show, -1, static_cast<std::uint64_t>(op));
+            return;
+        }
+        ++stats.ok[op];
+        const Owned owned{show, seats, r.id, kind};
+        claim(owned);
+        if (kind == kBooked) {
+            const int seat = HallLayout::seat_index(seats.first_word(), booking::ctz64(seats.word(seats.first_word())));
+            const BookingId owner = svc_.seat_owner(show, seat);
+            if (owner != static_cast<BookingId>(r.id)) fail("booked seat has another owner", show, seat, owner);
+        }
+        mine.push_back(owned);
+    }
+
+    void cancel(std::vector<Owned>& mine, std::size_t i, ThreadStats& stats) {
+        if (mine[i].kind != kBooked) return;
+        std::swap(mine[i], mine.back());
+        const Owned o = mine.back();
+        mine.pop_back();
+        unclaim(o);
+        const BookingResult r = svc_.cancel_seat_mask(o.show, o.seats, static_cast<BookingId>(o.id));
+        ++stats.ops[kCancel];
+        if (r.success) {
+            ++stats.ok[kCancel];
+        } else {
+            fail("own booking failed to cancel", o.show, -1, static_cast<std::uint64_t>(r.status));
+        }
+    }
+
+    void settle(std::vector<Owned>& mine, std::size_t i, bool confirm, ThreadStats& stats) {
+        Owned o = mine[i];
+        mine.erase(mine.begin() + static_cast<std::ptrdiff_t>(i));
+        const Op op = confirm ? kConfirm : kRelease;
+        ++stats.ops[op];
+        if (confirm) {
+            const BookingResult r = svc_.confirm_hold(o.id);
+            if (!r.success) {
+                fail("own hold failed to confirm", o.show, -1, static_cast<std::uint64_t>(r.status));
+                unclaim(o);
+                return;
+            }
+            unclaim(o);
+            o.id = r.id;
+            o.kind = kBooked;
+            claim(o);
+            mine.push_back(o);
+        } else {
+            unclaim(o); // before the seats can be taken again
+            const BookingResult r = svc_.release_hold(o.id);
+            if (!r.success) {
+                fail("own hold failed to release", o.show, -1, static_cast<std::uint64_t>(r.status));
+                return;
+            }
+        }
+        ++stats.ok[op];
+    }
+
+    void read(ShowId show, const std::vector<Owned>& mine, ThreadStats& stats) {
+        ++stats.ops[kRead];
+        SeatMask free;
+        const int count = svc_.available_seats_mask(show, free);
+        if (count != free.count()) fail("count differs from its mask", show, -1, static_cast<std::uint64_t>(count));
+        SeatMask held;
+        svc_.held_seats_mask(show, held);
+        for (const Owned& o : mine) {
+            if (o.show != show) continue;
+            if (intersects(free, o.seats)) fail("owned seat read as free", show, -1, o.id);
+            const bool in_hold_mask = intersects(held, o.seats);
+            if (o.kind == kBooked && in_hold_mask) fail("booked seat in the hold mask", show, -1, o.id);
+            if (o.kind == kHeld) {
+                for_each_seat(o.seats, [&](int seat) {
+                    if (!held.test(seat)) fail("held seat missing from the hold mask", show, seat, o.id);
+                });
+            }
+        }
+        const int any = svc_.available_count(show);
+        if (any < 0 || any > o_.rows * o_.seats) fail("count out of range", show, -1, static_cast<std::uint64_t>(any));
+        ++stats.ok[kRead];
+    }
+
+    /** @brief Compares every seat with the shadow table; the threads are parked. */
+    void check_all() {
+        ++full_checks_;
+        for (int s = 0; s < o_.shows; ++s) {
+            const ShowId show = s;
+            SeatMask free;
+            SeatMask held;
+            const int count = svc_.available_seats_mask(show, free);
+            svc_.held_seats_mask(show, held);
+            int unclaimed = 0;
+            for (int r = 0; r < o_.rows; ++r) {
+                for (int c = 0; c < o_.seats; ++c) {
+                    const int seat = HallLayout::seat_index(r, c);
+                    const std::uint64_t v = shadow(show, seat).load();
+                    const BookingId owner = svc_.seat_owner(show, seat);
+                    if (v == 0u) {
+                        ++unclaimed;
+                        if (!free.test(seat) || held.test(seat) || owner != 0u) {
+                            fail("unclaimed seat taken", show, seat, owner);
+                        }
+                    } else if ((v & 3u) == kBooked) {
+                        if (free.test(seat) || held.test(seat) || owner != static_cast<BookingId>(v >> 2)) {
+                            fail("booked seat lost its booking", show, seat, owner);
+                        }
+                    } else if (free.test(seat) || !held.test(seat) || owner != 0u) {
+                        fail("held seat lost its hold", show, seat, owner);
+                    }
+                }
+            }
+            if (count != unclaimed || svc_.available_count(show) != unclaimed) {
+                fail("available count differs from the shadow table", show, -1, static_cast<std::uint64_t>(count));
+            }
+        }
+    }
+
+    const Options& o_;
+    const unsigned threads_;
+    BookingService svc_;
+    std::vector<std::atomic<std::uint64_t>> shadow_;
+    std::vector<ThreadStats> stats_;
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> pause_{false};
+    std::atomic<unsigned> parked_{0};
+    std::atomic<std::uint64_t> violations_{0};
+    std::uint64_t full_checks_ = 0;
+    std::mutex report_mutex_;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        if (!parse_option(argv[i], o)) {
+            std::cerr << "unknown option " << argv[i] << "\n"
+                      << "usage: booking_stress [--threads=N] [--seconds=S] [--scale=1] [--shows=N] [--rows=R]\n"
+                      << "       [--seats=S] [--check-ms=MS] [--seed=N]\n";
+            return 2;
+        }
+    }
+    if (!valid(o)) {
+        std::cerr << "invalid option value\n";
+        return 2;
+    }
+
+    std::vector<unsigned> counts;
+    if (o.scale) {
+        for (unsigned t = 1; t < o.threads; t *= 2) counts.push_back(t);
+    }
+    counts.push_back(o.threads);
+
+    std::printf("shows=%d hall=%dx%d seconds=%.1f check=%dms cores=%u\n", o.shows, o.rows, o.seats, o.seconds,
+                o.check_ms, std::thread::hardware_concurrency());
+    std::printf("%-8s %12s %10s %8s", "threads", "ops/s", "speedup", "checks");
+    for (int op = 0; op < kOps; ++op) std::printf(" %10s", kOpNames[op]);
+    std::printf(" %10s\n", "violations");
+    double base = 0.0;
+    std::uint64_t violations = 0;
+    for (const unsigned threads : counts) {
+        Run run(o, threads);
+        const double elapsed = run.execute();
+        const ThreadStats total = run.total();
+        std::uint64_t all = 0;
+        for (int op = 0; op < kOps; ++op) all += total.ops[op];
+        const double rate = static_cast<double>(all) / elapsed;
+        if (base == 0.0) base = rate;
+        std::printf("%-8u %12.0f %9.2fx %8llu", threads, rate, rate / base,
+                    static_cast<unsigned long long>(run.full_checks()));
+        for (int op = 0; op < kOps; ++op) std::printf(" %10.0f", static_cast<double>(total.ok[op]) / elapsed);
+        std::printf(" %10llu\n", static_cast<unsigned long long>(run.violations()));
+        violations += run.violations();
+    }
+    return violations == 0u ? 0 : 1;
+}
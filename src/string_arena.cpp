@@ -0,0 +1,33 @@
+#include "string_arena.hpp"
+
+#include <cstring>
+
+namespace booking {
+
+std::string_view StringArena::intern(std::string_view s) {
+    auto it = index_.find(s);
+    if (it != index_.end()) return *it;
+    if (s.empty()) return *index_.insert(std::string_view()).first;
+
+    char* dest;
+    if (s.size() > kChunkSize / 4) {
+        // Large strings get their own chunk so they do not waste the current one
+        chunks_.push_back(std::make_unique<char[]>(s.size()));
+        reserved_ += s.size();
+        dest = chunks_.back().get();
+    } else {
+        if (left_ < s.size()) {
+            chunks_.push_back(std::make_unique<char[]>(kChunkSize));
+            reserved_ += kChunkSize;
+            cursor_ = chunks_.back().get();
+            left_ = kChunkSize;
+        }
+        dest = cursor_;
+        cursor_ += s.size();
+        left_ -= s.size();
+    }
+    std::memcpy(dest, s.data(), s.size());
+    return *index_.insert(std::string_view(dest, s.size())).first;
+}
+
+} // namespace booking
@@ -0,0 +1,176 @@
+#include "tenant_registry.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace booking {
+
+namespace {
+
+std::int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void family(std::string& out, const char* name, const char* help, const char* type) {
+    out += std::string("# HELP ") + name + ' ' + help + "\n# TYPE " + name + ' ' + type + '\n';
+}
+
+} // namespace
+
+const char* to_string(TenantAdmission admission) {
+    switch (admission) {
+        case TenantAdmission::Admitted: return "admitted";
+        case TenantAdmission::RateLimited: return "rate_limited";
+        case TenantAdmission::Busy: return "busy";
+    }
+    return "unknown";
+}
+
+Tenant::Ticket& Tenant::Ticket::operator=(Ticket&& other) noexcept {
+    if (this != &other) {
+        release();
+        tenant_ = other.tenant_;
+        status_ = other.status_;
+        other.tenant_ = nullptr;
+    }
+    return *this;
+}
+
+void Tenant::Ticket::release() {
+    if (tenant_ == nullptr) return;
+    tenant_->in_flight_.fetch_sub(1u, std::memory_order_release);
+    tenant_ = nullptr;
+}
+
+Tenant::Tenant(std::string name, const TenantQuota& quota) : name_(std::move(name)) { set_quota(quota); }
+
+TenantQuota Tenant::quota() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return quota_;
+}
+
+void Tenant::set_quota(const TenantQuota& quota) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quota_ = quota;
+    gate_.configure(quota.requests);
+    max_in_flight_.store(quota.max_in_flight, std::memory_order_relaxed);
+}
+
+Tenant::Ticket Tenant::admit(std::int64_t now_ns) {
+    const std::uint32_t cap = max_in_flight_.load(std::memory_order_relaxed);
+    const std::uint32_t running = in_flight_.fetch_add(1u, std::memory_order_acquire);
+    if (cap != 0u && running >= cap) {
+        in_flight_.fetch_sub(1u, std::memory_order_relaxed);
+        busy_.fetch_add(1u, std::memory_order_relaxed);
+        return Ticket(nullptr, TenantAdmission::Busy);
+    }
+    if (!gate_.try_admit(now_ns)) {
+        in_flight_.fetch_sub(1u, std::memory_order_relaxed);
+        rate_limited_.fetch_add(1u, std::memory_order_relaxed);
+        return Ticket(nullptr, TenantAdmission::RateLimited);
+    }
+    admitted_.fetch_add(1u, std::memory_order_relaxed);
+    return Ticket(this, TenantAdmission::Admitted);
+}
+
+Tenant::Ticket Tenant::admit() { return admit(steady_now_ns()); }
+
+CatalogStatus Tenant::add_show(const Show& show) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (quota_.max_shows != 0u && service_.show_count() >= quota_.max_shows) return CatalogStatus::OverQuota;
+    return service_.add_show(show);
+}
+
+ScheduleError Tenant::load_schedule(Schedule schedule) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Counted as if every show were new: a schedule that would be refused anyway may be refused early
+    if (quota_.max_shows != 0u && service_.show_count() + schedule.shows.size() > quota_.max_shows) {
+        return ScheduleError{ScheduleStatus::CatalogError, 0, "Show quota exceeded"};
+    }
+    return service_.load_schedule(std::move(schedule));
+}
+
+TenantStats Tenant::stats() const {
+    TenantStats s;
+    s.admitted = admitted_.load(std::memory_order_relaxed);
+    s.rate_limited = rate_limited_.load(std::memory_order_relaxed);
+    s.busy = busy_.load(std::memory_order_relaxed);
+    s.in_flight = in_flight_.load(std::memory_order_relaxed);
+    s.shows = service_.show_count();
+    return s;
+}
+
+TenantRegistry::~TenantRegistry() = default;
+
+Tenant* TenantRegistry::add_tenant(std::string name, const TenantQuota& quota) {
+    if (name.empty()) return nullptr;
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Index* current = index_.load(std::memory_order_relaxed);
+    auto next = std::make_unique<Index>(current ? *current : Index{});
+    const auto at = std::lower_bound(next->begin(), next->end(), name,
+                                     [](const Tenant* t, const std::string& n) { return t->name() < n; });
+    if (at != next->end() && (*at)->name() == name) return nullptr;
+    owned_.push_back(std::make_unique<Tenant>(std::move(name), quota));
+    next->insert(at, owned_.back().get());
+    indexes_.push_back(std::move(next));
+    index_.store(indexes_.back().get(), std::memory_order_release);
+    return owned_.back().get();
+}
+
+Tenant* TenantRegistry::find(std::string_view name) const {
+    const Index* index = index_.load(std::memory_order_acquire);
+    if (index == nullptr) return nullptr;
+    const auto at = std::lower_bound(index->begin(), index->end(), name,
+                                     [](const Tenant* t, std::string_view n) { return t->name() < n; });
+    return at != index->end() && (*at)->name() == name ? *at : nullptr;
+}
+
+std::size_t TenantRegistry::size() const {
+    const Index* index = index_.load(std::memory_order_acquire);
+    return index ? index->size() : 0u;
+}
+
+std::vector<Tenant*> TenantRegistry::tenants() const {
+    const Index* index = index_.load(std::memory_order_acquire);
+    return index ? *index : Index{};
+}
+
+std::string TenantRegistry::metrics_prometheus() const {
+    const std::vector<Tenant*> all = tenants();
+    std::vector<TenantStats> stats;
+    std::vector<std::uint64_t> booked;
+    stats.reserve(all.size());
+    for (const Tenant* t : all) {
+        stats.push_back(t->stats());
+        booked.push_back(t->service().service_stats(0).booked);
+    }
+
+    // Samples of a family must be adjacent, so each family walks all tenants
+    std::string out;
+    family(out, "booking_tenant_requests_total", "Requests of a tenant by admission outcome.", "counter");
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        const std::string label = "{tenant=\"" + all[i]->name() + "\",outcome=\"";
+        out += "booking_tenant_requests_total" + label + "admitted\"} " + std::to_string(stats[i].admitted) + '\n';
+        out += "booking_tenant_requests_total" + label + "rate_limited\"} " + std::to_string(stats[i].rate_limited)
+               + '\n';
+        out += "booking_tenant_requests_total" + label + "busy\"} " + std::to_string(stats[i].busy) + '\n';
+    }
+    family(out, "booking_tenant_in_flight", "Requests of a tenant running now.", "gauge");
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        out += "booking_tenant_in_flight{tenant=\"" + all[i]->name() + "\"} " + std::to_string(stats[i].in_flight)
+               + '\n';
+    }
+    family(out, "booking_tenant_shows", "Shows in a tenant's catalog.", "gauge");
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        out += "booking_tenant_shows{tenant=\"" + all[i]->name() + "\"} " + std::to_string(stats[i].shows) + '\n';
+    }
+    family(out, "booking_tenant_seats_booked", "Seats of a tenant booked or held.", "gauge");
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        out += "booking_tenant_seats_booked{tenant=\"" + all[i]->name() + "\"} " + std::to_string(booked[i]) + '\n';
+    }
+    return out;
+}
+
+} // namespace booking
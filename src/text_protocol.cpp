@@ -0,0 +1,424 @@
+#include "text_protocol.hpp"
+
+#include <array>
+#include <charconv>
+
+namespace booking {
+
+namespace {
+
+void append_number(std::string& out, std::uint64_t v) {
+    char buf[24];
+    const auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+}
+
+void append_ok(std::string& out) {
+    out += "OK\n";
+}
+
+void append_ok(std::string& out, std::uint64_t v) {
+    out += "OK ";
+    append_number(out, v);
+    out += '\n';
+}
+
+/** @brief Appends a "<id> <name>" listing line. */
+void append_named(std::string& out, std::int64_t id, std::string_view name) {
+    append_number(out, static_cast<std::uint64_t>(id));
+    out += ' ';
+    out += name;
+    out += '\n';
+}
+
+/** @brief "OK <count>", plus " <next cursor>" when more entries follow the page. */
+template <typename T>
+void append_page_ok(std::string& out, const Page<T>& page) {
+    out += "OK ";
+    append_number(out, page.items.size());
+    if (page.more) {
+        out += ' ';
+        append_number(out, page.next_cursor);
+    }
+    out += '\n';
+}
+
+void append_error(std::string& out, const char* reason) {
+    out += "ERR 0 ";
+    out += reason;
+    out += '\n';
+}
+
+/** @brief Appends "<key>=<seat>.<seat>..." for the seats of @p seats. */
+void append_seat_list(std::string& out, const SeatMask& seats) {
+    char sep = '=';
+    for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+        for (std::uint64_t b = seats.word(w); b != 0u; b &= b - 1u) {
+            out += sep;
+            append_number(out, static_cast<std::uint64_t>(HallLayout::seat_index(w, ctz64(b))));
+            sep = '.';
+        }
+    }
+}
+
+/** @brief Parses the "<seat>.<seat>..." after '='; false on a malformed or out-of-range seat. */
+bool parse_seat_list(std::string_view list, SeatMask& out) {
+    while (!list.empty()) {
+        const std::size_t dot = list.find('.');
+        int seat = -1;
+        if (!parse_token(list.substr(0, dot), seat) || seat < 0
+            || seat >= HallLayout::kMaxRows * HallLayout::kMaxRowSeats) {
+            return false;
+        }
+        out.set(seat);
+        list = dot == std::string_view::npos ? std::string_view{} : list.substr(dot + 1u);
+    }
+    return !out.empty();
+}
+
+/** @brief Appends " <key>=<label>,<label>..." for the seats of @p seats. */
+void append_label_list(std::string& out, const char* key, const HallLayout& layout, const SeatMask& seats) {
+    out += ' ';
+    out += key;
+    char sep = '=';
+    for (int w = seats.first_word(); w < seats.end_word(); ++w) {
+        for (std::uint64_t b = seats.word(w); b != 0u; b &= b - 1u) {
+            out += sep;
+            out += layout.label_view(HallLayout::seat_index(w, ctz64(b)));
+            sep = ',';
+        }
+    }
+}
+
+void append_status(std::string& out, const BookingResult& r) {
+    out += "ERR ";
+    append_number(out, static_cast<std::uint64_t>(r.status));
+    out += ' ';
+    r.append_message(out);
+}
+
+void append_error(std::string& out, const BookingResult& r) {
+    append_status(out, r);
+    out += '\n';
+}
+
+/** @brief Slot of a command name in kCommandTable (the names are perfectly hashed into 32 slots). */
+constexpr unsigned command_slot(std::string_view name) {
+    return (static_cast<unsigned char>(name.front()) + static_cast<unsigned char>(name.back())
+            + static_cast<unsigned>(name.size())) & 31u;
+}
+
+struct CommandEntry {
+    std::string_view name;
+    TextCommand command = TextCommand::Unknown;
+};
+
+constexpr CommandEntry kCommands[] = {
+    {"movies", TextCommand::Movies}, {"search", TextCommand::Search}, {"theaters", TextCommand::Theaters},
+    {"seats", TextCommand::Seats},   {"book", TextCommand::Book},     {"cancel", TextCommand::Cancel},
+    {"export", TextCommand::Export}, {"import", TextCommand::Import}, {"help", TextCommand::Help},
+    {"quit", TextCommand::Quit},     {"exit", TextCommand::Quit},
+};
+
+constexpr std::array<CommandEntry, 32> build_command_table() {
+    std::array<CommandEntry, 32> table{};
+    for (const CommandEntry& e : kCommands) {
+        CommandEntry& slot = table[command_slot(e.name)];
+        if (!slot.name.empty()) throw "command names collide: change command_slot"; // fails the constexpr build
+        slot = e;
+    }
+    return table;
+}
+
+constexpr std::array<CommandEntry, 32> kCommandTable = build_command_table();
+
+} // namespace
+
+const char* to_string(TextCommand command) {
+    switch (command) {
+        case TextCommand::Unknown: return "unknown";
+        case TextCommand::Movies: return "movies";
+        case TextCommand::Search: return "search";
+        case TextCommand::Theaters: return "theaters";
+        case TextCommand::Seats: return "seats";
+        case TextCommand::Book: return "book";
+        case TextCommand::Cancel: return "cancel";
+        case TextCommand::Export: return "export";
+        case TextCommand::Import: return "import";
+        case TextCommand::Help: return "help";
+        case TextCommand::Quit: return "quit";
+    }
+    return "unknown";
+}
+
+TextCommand parse_command(std::string_view token) {
+    if (token.empty()) return TextCommand::Unknown;
+    const CommandEntry& e = kCommandTable[command_slot(token)];
+    return e.name == token ? e.command : TextCommand::Unknown;
+}
+
+void split_tokens(std::string_view line, std::vector<std::string_view>& out) {
+    out.clear();
+    std::size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) ++i;
+        const std::size_t start = i;
+        while (i < line.size() && line[i] != ' ' && line[i] != '\t') ++i;
+        if (i > start) out.push_back(line.substr(start, i - start));
+    }
+}
+
+CommandOutcome TextCommandHandler::execute(std::string_view line, std::string& out) {
+    if (limiter_ && !limiter_->allow(client_)) {
+        append_error(out, BookingResult::error(BookingStatus::Throttled));
+        return CommandOutcome::Continue;
+    }
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    split_tokens(line, tokens_);
+    if (tokens_.empty()) {
+        append_error(out, "empty request");
+        return CommandOutcome::Continue;
+    }
+
+    const TextCommand cmd = parse_command(tokens_[0]);
+    if (read_only_ && (cmd == TextCommand::Book || cmd == TextCommand::Cancel)) {
+        append_error(out, BookingResult::error(BookingStatus::ReadOnlyReplica));
+        return CommandOutcome::Continue;
+    }
+    if (!cluster_admin_ && (cmd == TextCommand::Export || cmd == TextCommand::Import)) {
+        append_error(out, "unknown command");
+        return CommandOutcome::Continue;
+    }
+    switch (cmd) {
+        case TextCommand::Book: book(out); break;
+        case TextCommand::Seats: seats(out); break;
+        case TextCommand::Cancel: cancel(out); break;
+        case TextCommand::Movies: movies(out); break;
+        case TextCommand::Search: search(out); break;
+        case TextCommand::Theaters: theaters(out); break;
+        case TextCommand::Export: export_show(out); break;
+        case TextCommand::Import: import_show(out); break;
+        case TextCommand::Help:
+            out += "movies [<cursor> <limit>]\n"
+                   "search <title words>\n"
+                   "theaters <movie_id> [<cursor> <limit>]\n"
+                   "seats <movie_id> <theater_id>\n"
+                   "book <movie_id> <theater_id> a1 a2 ...\n"
+                   "cancel <movie_id> <theater_id> <booking_id> a1 a2 ...\n"
+                   "quit\n";
+            append_ok(out);
+            break;
+        case TextCommand::Quit:
+            append_ok(out);
+            return CommandOutcome::Close;
+        case TextCommand::Unknown: append_error(out, "unknown command"); break;
+    }
+    return CommandOutcome::Continue;
+}
+
+void TextCommandHandler::movies(std::string& out) {
+    if (tokens_.size() == 3u) {
+        std::uint64_t cursor = 0;
+        std::size_t limit = 0;
+        if (!parse_token(tokens_[1], cursor) || !parse_token(tokens_[2], limit)) {
+            append_error(out, "usage: movies [<cursor> <limit>]");
+            return;
+        }
+        const Page<Movie> page = service_.list_movies_page(cursor, limit);
+        for (const Movie& m : page.items) append_named(out, m.id.value(), m.title);
+        append_page_ok(out, page);
+        return;
+    }
+    if (tokens_.size() != 1u) {
+        append_error(out, "usage: movies [<cursor> <limit>]");
+        return;
+    }
+    const BookingService::CatalogView view = service_.catalog_view();
+    const Span<const Movie> ms = view.movies();
+    for (const Movie& m : ms) append_named(out, m.id.value(), m.title);
+    append_ok(out, ms.size());
+}
+
+void TextCommandHandler::search(std::string& out) {
+    if (tokens_.size() < 2u) {
+        append_error(out, "usage: search <title words>");
+        return;
+    }
+    std::string query;
+    for (std::size_t i = 1; i < tokens_.size(); ++i) {
+        if (i > 1) query += ' ';
+        query += tokens_[i];
+    }
+    const std::vector<Movie> ms = service_.search_movies(query);
+    for (const Movie& m : ms) append_named(out, m.id.value(), m.title);
+    append_ok(out, ms.size());
+}
+
+void TextCommandHandler::theaters(std::string& out) {
+    MovieId movie_id = -1;
+    if ((tokens_.size() != 2u && tokens_.size() != 4u) || !parse_token(tokens_[1], movie_id)) {
+        append_error(out, "usage: theaters <movie_id> [<cursor> <limit>]");
+        return;
+    }
+    if (tokens_.size() == 4u) {
+        std::uint64_t cursor = 0;
+        std::size_t limit = 0;
+        if (!parse_token(tokens_[2], cursor) || !parse_token(tokens_[3], limit)) {
+            append_error(out, "usage: theaters <movie_id> [<cursor> <limit>]");
+            return;
+        }
+        const Page<Theater> page = service_.list_theaters_for_movie_page(movie_id, cursor, limit);
+        for (const Theater& t : page.items) append_named(out, t.id.value(), t.name);
+        append_page_ok(out, page);
+        return;
+    }
+    const BookingService::CatalogView view = service_.catalog_view();
+    const Span<const Theater> ts = view.theaters_for_movie(movie_id);
+    for (const Theater& t : ts) append_named(out, t.id.value(), t.name);
+    append_ok(out, ts.size());
+}
+
+BookingService::ShowHandle* TextCommandHandler::show_arg(std::string& out) {
+    MovieId movie_id = -1;
+    TheaterId theater_id = -1;
+    if (!parse_token(tokens_[1], movie_id) || !parse_token(tokens_[2], theater_id)) {
+        append_error(out, "movie and theater ids must be integers");
+        return nullptr;
+    }
+    BookingService::ShowHandle* show = routes_.find(movie_id, theater_id);
+    if (!show) {
+        append_error(out, "no show for that movie+theater");
+        return nullptr;
+    }
+    last_show_ = show->show_id();
+    return show;
+}
+
+void TextCommandHandler::seats(std::string& out) {
+    if (tokens_.size() != 3u) {
+        append_error(out, "usage: seats <movie_id> <theater_id>");
+        return;
+    }
+    BookingService::ShowHandle* show = show_arg(out);
+    if (!show) return;
+    const int free_seats = service_.append_cached_available_seats(*show, out);
+    out += '\n';
+    append_ok(out, static_cast<std::size_t>(free_seats < 0 ? 0 : free_seats));
+}
+
+void TextCommandHandler::book(std::string& out) {
+    if (tokens_.size() < 4u) {
+        append_error(out, "usage: book <movie_id> <theater_id> a1 a2 ...");
+        return;
+    }
+    BookingService::ShowHandle* show = show_arg(out);
+    if (!show) return;
+    const Span<const std::string_view> labels(tokens_.data() + 3, tokens_.size() - 3u);
+    // The labels as one list: parsed in a single pass over the line (book_label_list)
+    const char* const first = tokens_[3].data();
+    const std::string_view list(first, static_cast<std::size_t>(tokens_.back().data() + tokens_.back().size() - first));
+    const BookingResult r = service_.book_label_list(*show, list);
+    if (r.success) {
+        append_ok(out, r.id);
+        return;
+    }
+    const HallLayout* layout = service_.layout_for_show(show->show_id());
+    if (r.status != BookingStatus::AlreadyBooked || !layout) {
+        append_error(out, r);
+        return;
+    }
+    append_status(out, r);
+    append_label_list(out, "taken", *layout, r.conflicts);
+    if (r.suggested_row >= 0) {
+        // The labels all parsed, or the request would not have got as far as a conflict
+        SeatMask request;
+        for (const std::string_view label : labels) {
+            int seat = -1;
+            if (layout->try_parse_label(label, seat)) request.set(seat);
+        }
+        append_label_list(out, "try", *layout, r.alternative(request));
+    }
+    out += '\n';
+}
+
+void TextCommandHandler::cancel(std::string& out) {
+    BookingId booking_id = 0;
+    if (tokens_.size() < 5u || !parse_token(tokens_[3], booking_id)) {
+        append_error(out, "usage: cancel <movie_id> <theater_id> <booking_id> a1 a2 ...");
+        return;
+    }
+    const BookingService::ShowHandle* show = show_arg(out);
+    if (!show) return;
+    const BookingResult r = service_.cancel_seat_labels(
+        show->show_id(), Span<const std::string_view>(tokens_.data() + 4, tokens_.size() - 4u), booking_id);
+    if (r.success) {
+        append_ok(out);
+    } else {
+        append_error(out, r);
+    }
+}
+
+void TextCommandHandler::export_show(std::string& out) {
+    ShowId show_id = -1;
+    if (tokens_.size() != 2u || !parse_token(tokens_[1], show_id)) {
+        append_error(out, "usage: export <show_id>");
+        return;
+    }
+    ShowTransfer state;
+    const CatalogStatus status = service_.take_show_state(show_id, state);
+    if (status != CatalogStatus::Ok) {
+        append_error(out, to_string(status));
+        return;
+    }
+    const std::size_t start = out.size();
+    for (const ShowTransfer::Booking& b : state.bookings) {
+        if (out.size() != start) out += ' ';
+        append_number(out, b.id);
+        append_seat_list(out, b.seats);
+    }
+    for (const ShowTransfer::Hold& h : state.holds) {
+        if (out.size() != start) out += ' ';
+        out += 'h';
+        append_number(out, static_cast<std::uint64_t>(h.ttl.count()));
+        append_seat_list(out, h.seats);
+    }
+    out += '\n';
+    append_ok(out);
+}
+
+void TextCommandHandler::import_show(std::string& out) {
+    ShowTransfer state;
+    if (tokens_.size() < 2u || !parse_token(tokens_[1], state.show_id)) {
+        append_error(out, "usage: import <show_id> <state>");
+        return;
+    }
+    for (std::size_t i = 2; i < tokens_.size(); ++i) {
+        const std::string_view token = tokens_[i];
+        const std::size_t eq = token.find('=');
+        if (eq == std::string_view::npos) {
+            append_error(out, "malformed show state");
+            return;
+        }
+        SeatMask seats;
+        std::uint64_t key = 0;
+        const bool hold = token[0] == 'h';
+        if (!parse_token(token.substr(hold ? 1u : 0u, eq - (hold ? 1u : 0u)), key)
+            || !parse_seat_list(token.substr(eq + 1u), seats)) {
+            append_error(out, "malformed show state");
+            return;
+        }
+        if (hold) {
+            state.holds.push_back(ShowTransfer::Hold{seats, std::chrono::milliseconds(key)});
+        } else {
+            state.bookings.push_back(ShowTransfer::Booking{static_cast<BookingId>(key), seats});
+        }
+    }
+    const CatalogStatus status = service_.put_show_state(state);
+    if (status == CatalogStatus::Ok) {
+        append_ok(out);
+    } else {
+        append_error(out, to_string(status));
+    }
+}
+
+} // namespace booking
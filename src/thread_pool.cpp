@@ -0,0 +1,170 @@
+#include "thread_pool.hpp"
+
+#include <chrono>
+#include <functional>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace booking {
+
+namespace {
+
+/** @brief Pool whose worker the current thread is (null for other threads), and its index. */
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local unsigned current_index = 0;
+
+constexpr int kSpinPolls = 64;                              /**< Empty searches before a worker parks. */
+constexpr auto kParkTimeout = std::chrono::milliseconds(1); /**< Safety net for a missed wake-up. */
+
+/** @brief CPUs the process may run on, in id order. */
+std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) != 0) return cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+/** @brief Per-thread xorshift state for victim selection. */
+std::uint32_t next_random() {
+    thread_local std::uint32_t state =
+        static_cast<std::uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(const ThreadPoolOptions& options) {
+    unsigned workers = options.workers != 0u ? options.workers : std::thread::hardware_concurrency();
+    if (workers == 0u) workers = 1u;
+    workers_.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i) workers_.push_back(std::make_unique<Worker>(options.deque_capacity));
+
+    const std::vector<int> cpus = options.pin_workers ? allowed_cpus() : std::vector<int>{};
+    for (unsigned i = 0; i < workers; ++i) {
+        Worker& w = *workers_[i];
+        w.thread = std::thread([this, i] { worker_loop(i); });
+        if (cpus.empty()) continue;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        const int cpu = cpus[i % cpus.size()];
+        CPU_SET(cpu, &set);
+        if (::pthread_setaffinity_np(w.thread.native_handle(), sizeof(set), &set) == 0) w.cpu = cpu;
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    stopping_.store(true, std::memory_order_seq_cst);
+    {
+        std::lock_guard<std::mutex> lock(park_mutex_);
+        park_cv_.notify_all();
+    }
+    for (auto& w : workers_) w->thread.join();
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+bool ThreadPool::on_worker() const {
+    return current_pool == this;
+}
+
+void ThreadPool::submit(Job* job) {
+    if (on_worker()) {
+        if (!workers_[current_index]->deque.push(job)) {
+            job->run(job); // deque full: this worker has plenty queued already
+            return;
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        injected_.push_back(job);
+        injected_count_.fetch_add(1u, std::memory_order_release);
+    }
+
+    // Pairs with the fence in worker_loop: either the worker sees the job or we see it parking
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) != 0u) {
+        std::lock_guard<std::mutex> lock(park_mutex_);
+        park_cv_.notify_one();
+    }
+}
+
+ThreadPool::Job* ThreadPool::find_job() {
+    const bool worker = on_worker();
+    if (worker) {
+        if (Job* job = workers_[current_index]->deque.pop()) return job;
+    }
+    if (injected_count_.load(std::memory_order_acquire) != 0u) {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        if (!injected_.empty()) {
+            Job* job = injected_.front();
+            injected_.pop_front();
+            injected_count_.fetch_sub(1u, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    const std::size_t n = workers_.size();
+    const std::size_t start = next_random() % n;
+    for (std::size_t k = 0; k < n; ++k) {
+        const std::size_t victim = (start + k) % n;
+        if (worker && victim == current_index) continue;
+        if (Job* job = workers_[victim]->deque.steal()) {
+            steals_.fetch_add(1u, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+bool ThreadPool::has_work() const {
+    if (injected_count_.load(std::memory_order_acquire) != 0u) return true;
+    for (const auto& w : workers_) {
+        if (!w->deque.empty()) return true;
+    }
+    return false;
+}
+
+void ThreadPool::help_until_done(const std::atomic<std::size_t>& pending) {
+    while (pending.load(std::memory_order_acquire) != 0u) {
+        if (Job* job = find_job()) {
+            job->run(job);
+        } else {
+            std::this_thread::yield(); // the last chunks are running elsewhere
+        }
+    }
+}
+
+void ThreadPool::worker_loop(unsigned index) {
+    current_pool = this;
+    current_index = index;
+    int idle = 0;
+    while (!stopping_.load(std::memory_order_acquire)) {
+        if (Job* job = find_job()) {
+            job->run(job);
+            idle = 0;
+            continue;
+        }
+        if (++idle < kSpinPolls) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Announce parking under the lock, then look once more (Dekker with submit)
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        sleepers_.fetch_add(1u, std::memory_order_seq_cst);
+        if (!has_work() && !stopping_.load(std::memory_order_acquire)) park_cv_.wait_for(lock, kParkTimeout);
+        sleepers_.fetch_sub(1u, std::memory_order_relaxed);
+        idle = kSpinPolls - 1; // one more search, then straight back to sleep
+    }
+}
+
+} // namespace booking
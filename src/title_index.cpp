@@ -0,0 +1,185 @@
+#include "title_index.hpp"
+
+#include <algorithm>
+
+namespace booking {
+
+namespace {
+
+bool word_byte(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80u;
+}
+
+std::uint32_t pack(std::string_view text, std::size_t at) {
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(text[at])) << 16
+           | static_cast<std::uint32_t>(static_cast<unsigned char>(text[at + 1])) << 8
+           | static_cast<std::uint32_t>(static_cast<unsigned char>(text[at + 2]));
+}
+
+/** @brief Distinct trigrams of @p padded, ascending. */
+std::vector<std::uint32_t> trigrams_of(std::string_view padded) {
+    std::vector<std::uint32_t> grams;
+    if (padded.size() < 3u) return grams;
+    grams.reserve(padded.size() - 2u);
+    for (std::size_t i = 0; i + 3u <= padded.size(); ++i) grams.push_back(pack(padded, i));
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+/**
+ * @brief Fewest edits (insert, delete, substitute, swap adjacent) turning @p query into some
+ *        prefix of @p text; anything above @p budget is reported as budget + 1.
+ */
+std::uint32_t prefix_distance(std::string_view query, std::string_view text, std::uint32_t budget) {
+    const std::size_t n = std::min(text.size(), query.size() + budget);
+    std::vector<std::uint32_t> before(n + 1u), prev(n + 1u), cur(n + 1u);
+    for (std::size_t j = 0; j <= n; ++j) prev[j] = static_cast<std::uint32_t>(j);
+    for (std::size_t i = 1; i <= query.size(); ++i) {
+        cur[0] = static_cast<std::uint32_t>(i);
+        std::uint32_t row_min = cur[0];
+        for (std::size_t j = 1; j <= n; ++j) {
+            const std::uint32_t substitute = prev[j - 1] + (query[i - 1] == text[j - 1] ? 0u : 1u);
+            std::uint32_t d = std::min({prev[j] + 1u, cur[j - 1] + 1u, substitute});
+            if (i > 1 && j > 1 && query[i - 1] == text[j - 2] && query[i - 2] == text[j - 1]) {
+                d = std::min(d, before[j - 2] + 1u);
+            }
+            cur[j] = d;
+            row_min = std::min(row_min, d);
+        }
+        if (row_min > budget) return budget + 1u;
+        std::swap(before, prev);
+        std::swap(prev, cur);
+    }
+    // The query may stop anywhere in the text: the best column of the last row
+    return std::min(*std::min_element(prev.begin(), prev.end()), budget + 1u);
+}
+
+} // namespace
+
+const char* to_string(TitleIndex::MatchKind kind) {
+    switch (kind) {
+        case TitleIndex::MatchKind::Exact: return "exact";
+        case TitleIndex::MatchKind::TitlePrefix: return "title_prefix";
+        case TitleIndex::MatchKind::WordPrefix: return "word_prefix";
+        case TitleIndex::MatchKind::Fuzzy: return "fuzzy";
+    }
+    return "unknown";
+}
+
+std::uint32_t TitleIndex::typo_budget(std::size_t length) {
+    // Shorter queries would match too much of the catalog to be useful
+    return length < 5u ? 0u : length < 10u ? 1u : 2u;
+}
+
+std::string TitleIndex::normalize(std::string_view text) {
+    std::string out;
+    out.reserve(text.size());
+    bool gap = false;
+    for (const char ch : text) {
+        const auto c = static_cast<unsigned char>(ch);
+        if (!word_byte(c)) {
+            gap = true;
+            continue;
+        }
+        if (gap && !out.empty()) out.push_back(' ');
+        gap = false;
+        out.push_back(c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : ch);
+    }
+    return out;
+}
+
+void TitleIndex::add(std::string_view title) { add(Span<const std::string_view>(&title, 1)); }
+
+void TitleIndex::add(Span<const std::string_view> titles) {
+    std::vector<WordStart> fresh;
+    titles_.reserve(titles_.size() + titles.size());
+    for (const std::string_view title : titles) {
+        const auto slot = static_cast<std::int32_t>(titles_.size());
+        titles_.push_back(normalize(title));
+        const std::string& text = titles_.back();
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            if (i == 0 || text[i - 1] == ' ') fresh.push_back(WordStart{slot, static_cast<std::uint32_t>(i)});
+        }
+        // Slots only grow, so appending keeps every posting list ascending
+        for (const std::uint32_t gram : trigrams_of(" " + text + " ")) trigrams_[gram].push_back(slot);
+    }
+
+    const auto less = [this](const WordStart& a, const WordStart& b) {
+        const int order = suffix(a).compare(suffix(b));
+        return order != 0 ? order < 0 : a.slot < b.slot;
+    };
+    std::sort(fresh.begin(), fresh.end(), less);
+    const auto old_size = static_cast<std::ptrdiff_t>(words_.size());
+    words_.insert(words_.end(), fresh.begin(), fresh.end());
+    std::inplace_merge(words_.begin(), words_.begin() + old_size, words_.end(), less);
+}
+
+std::uint32_t TitleIndex::word_prefix_distance(std::string_view query, std::int32_t slot, std::uint32_t budget) const {
+    const std::string_view text = titles_[static_cast<std::size_t>(slot)];
+    std::uint32_t best = budget + 1u;
+    for (std::size_t i = 0; i < text.size() && best != 0u; ++i) {
+        if (i == 0 || text[i - 1] == ' ') best = std::min(best, prefix_distance(query, text.substr(i), budget));
+    }
+    return best;
+}
+
+std::vector<TitleIndex::Match> TitleIndex::search(std::string_view query, std::size_t limit) const {
+    std::vector<Match> out;
+    const std::string q = normalize(query);
+    if (q.empty() || limit == 0u) return out;
+
+    // Prefix matches: one contiguous range of the sorted word starts
+    std::unordered_map<std::int32_t, std::size_t> seen; // slot -> index in out
+    auto it = std::lower_bound(words_.begin(), words_.end(), std::string_view(q),
+                               [this](const WordStart& w, std::string_view key) { return suffix(w) < key; });
+    for (; it != words_.end(); ++it) {
+        const std::string_view text = suffix(*it);
+        if (text.compare(0, q.size(), q) != 0) break;
+        const MatchKind kind = it->offset != 0u ? MatchKind::WordPrefix
+                               : text.size() == q.size() ? MatchKind::Exact
+                                                         : MatchKind::TitlePrefix;
+        const auto entry = seen.emplace(it->slot, out.size());
+        if (entry.second) {
+            out.push_back(Match{it->slot, kind, 0u});
+        } else if (kind < out[entry.first->second].kind) {
+            out[entry.first->second].kind = kind; // a title also found under a later word first
+        }
+    }
+
+    const std::uint32_t budget = typo_budget(q.size());
+    if (out.size() < limit && budget != 0u) {
+        const std::vector<std::uint32_t> grams = trigrams_of(" " + q);
+        // An edit breaks at most 3 trigrams, a swap of neighbours 4; short queries (or repeated
+        // letters) can leave no bound beyond sharing one
+        const std::size_t needed = grams.size() > 4u * budget ? grams.size() - 4u * budget : 1u;
+        std::unordered_map<std::int32_t, std::uint32_t> shared;
+        for (const std::uint32_t gram : grams) {
+            const auto postings = trigrams_.find(gram);
+            if (postings == trigrams_.end()) continue;
+            for (const std::int32_t slot : postings->second) ++shared[slot];
+        }
+        for (const auto& [slot, count] : shared) {
+            if (count < needed || seen.count(slot) != 0u) continue;
+            const std::uint32_t distance = word_prefix_distance(q, slot, budget);
+            if (distance <= budget) out.push_back(Match{slot, MatchKind::Fuzzy, distance});
+        }
+    }
+
+    const auto better = [this](const Match& a, const Match& b) {
+        if (a.kind != b.kind) return a.kind < b.kind;
+        if (a.distance != b.distance) return a.distance < b.distance;
+        const std::size_t la = titles_[static_cast<std::size_t>(a.slot)].size();
+        const std::size_t lb = titles_[static_cast<std::size_t>(b.slot)].size();
+        return la != lb ? la < lb : a.slot < b.slot;
+    };
+    if (out.size() > limit) {
+        std::partial_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(limit), out.end(), better);
+        out.resize(limit);
+    } else {
+        std::sort(out.begin(), out.end(), better);
+    }
+    return out;
+}
+
+} // namespace booking
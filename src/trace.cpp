@@ -0,0 +1,179 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace booking {
+
+const char* to_string(TraceStage stage) {
+    switch (stage) {
+        case TraceStage::BookSeats: return "book_seats";
+        case TraceStage::ListSeats: return "list_available_seats";
+        case TraceStage::Lookup: return "lookup";
+        case TraceStage::Parse: return "parse";
+        case TraceStage::Acquire: return "acquire";
+        case TraceStage::CasRetry: return "cas_retry";
+        case TraceStage::Journal: return "journal";
+        case TraceStage::LoadSeats: return "load_seats";
+        case TraceStage::Render: return "render";
+    }
+    return "unknown";
+}
+
+namespace detail {
+
+std::atomic<bool> trace_on{false};
+
+} // namespace detail
+
+namespace {
+
+/** @brief Ring of one thread: written by it alone, read by trace_collect. */
+struct TraceRing {
+    std::unique_ptr<TraceEvent[]> events{new TraceEvent[kTraceRingEvents]};
+    std::atomic<std::uint64_t> head{0}; // events ever written
+    std::uint64_t collected = 0;        // events handed out (under the registry mutex)
+    std::uint32_t thread = 0;
+};
+
+/** @brief All rings ever created; a ring of an exited thread is reused by the next one. */
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TraceRing>> rings;
+    std::vector<TraceRing*> free;
+};
+
+TraceRegistry& registry() {
+    static TraceRegistry* r = new TraceRegistry; // outlives the thread_local handles of exiting threads
+    return *r;
+}
+
+/** @brief The calling thread's ring; handed back when the thread exits. */
+struct RingHandle {
+    TraceRing* ring = nullptr;
+
+    ~RingHandle() {
+        if (!ring) return;
+        TraceRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.free.push_back(ring);
+    }
+};
+
+TraceRing& local_ring() {
+    thread_local RingHandle handle;
+    if (!handle.ring) {
+        TraceRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.free.empty()) {
+            handle.ring = r.free.back();
+            r.free.pop_back();
+        } else {
+            r.rings.push_back(std::make_unique<TraceRing>());
+            handle.ring = r.rings.back().get();
+            handle.ring->thread = static_cast<std::uint32_t>(r.rings.size() - 1u);
+        }
+    }
+    return *handle.ring;
+}
+
+} // namespace
+
+namespace detail {
+
+void trace_write(TraceStage stage, std::uint64_t begin, std::uint64_t end, std::uint64_t arg) {
+    TraceRing& ring = local_ring();
+    const std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+    TraceEvent& e = ring.events[static_cast<std::size_t>(head & (kTraceRingEvents - 1u))];
+    e.begin = begin;
+    e.end = end;
+    e.arg = arg;
+    e.thread = ring.thread;
+    e.stage = stage;
+    ring.head.store(head + 1u, std::memory_order_release);
+}
+
+} // namespace detail
+
+double trace_ticks_per_us() {
+#if defined(__x86_64__) || defined(__i386__)
+    static const double ticks = [] {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point t0 = Clock::now();
+        const std::uint64_t c0 = trace_clock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const std::uint64_t c1 = trace_clock();
+        const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        return us > 0.0 ? static_cast<double>(c1 - c0) / us : 1000.0;
+    }();
+    return ticks;
+#else
+    return 1000.0;
+#endif
+}
+
+void trace_start() {
+    trace_ticks_per_us(); // calibrated before the first event, not while dumping
+    detail::trace_on.store(true, std::memory_order_relaxed);
+}
+
+void trace_stop() {
+    detail::trace_on.store(false, std::memory_order_relaxed);
+}
+
+std::vector<TraceEvent> trace_collect() {
+    std::vector<TraceEvent> out;
+    TraceRegistry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& ring : r.rings) {
+        const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+        const std::uint64_t from = std::max(ring->collected, head > kTraceRingEvents ? head - kTraceRingEvents : 0u);
+        const std::size_t begin = out.size();
+        for (std::uint64_t i = from; i < head; ++i) {
+            out.push_back(ring->events[static_cast<std::size_t>(i & (kTraceRingEvents - 1u))]);
+        }
+        // Whatever the writer lapped while we copied may be torn: drop it
+        const std::uint64_t after = ring->head.load(std::memory_order_acquire);
+        if (after > kTraceRingEvents && after - kTraceRingEvents > from) {
+            const std::uint64_t lapped = std::min(after - kTraceRingEvents, head) - from;
+            out.erase(out.begin() + static_cast<std::ptrdiff_t>(begin),
+                      out.begin() + static_cast<std::ptrdiff_t>(begin + lapped));
+        }
+        ring->collected = head;
+    }
+    std::sort(out.begin(), out.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.begin < b.begin; });
+    return out;
+}
+
+void write_chrome_trace(std::ostream& out, const std::vector<TraceEvent>& events) {
+    const double ticks_per_us = trace_ticks_per_us();
+    const std::uint64_t origin = events.empty() ? 0u : events.front().begin;
+    char line[192];
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const TraceEvent& e : events) {
+        const double ts = static_cast<double>(e.begin - std::min(origin, e.begin)) / ticks_per_us;
+        int n = 0;
+        if (e.end == e.begin) {
+            n = std::snprintf(line, sizeof(line),
+                              "%s\n{\"name\":\"%s\",\"cat\":\"booking\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,"
+                              "\"pid\":1,\"tid\":%" PRIu32 ",\"args\":{\"arg\":%" PRIu64 "}}",
+                              first ? "" : ",", to_string(e.stage), ts, e.thread, e.arg);
+        } else {
+            const double dur = static_cast<double>(e.end - e.begin) / ticks_per_us;
+            n = std::snprintf(line, sizeof(line),
+                              "%s\n{\"name\":\"%s\",\"cat\":\"booking\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                              "\"pid\":1,\"tid\":%" PRIu32 ",\"args\":{\"arg\":%" PRIu64 "}}",
+                              first ? "" : ",", to_string(e.stage), ts, dur, e.thread, e.arg);
+        }
+        out.write(line, std::min<std::streamsize>(n, static_cast<std::streamsize>(sizeof(line) - 1u)));
+        first = false;
+    }
+    out << "\n]}\n";
+}
+
+} // namespace booking
@@ -0,0 +1,334 @@
+#include "traffic_replay.hpp"
+
+#include "spsc_queue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace booking {
+
+namespace {
+
+/** @brief Read position inside one line. */
+struct Cursor {
+    const char* p;
+    const char* end;
+};
+
+void skip_ws(Cursor& c) {
+    while (c.p != c.end && (*c.p == ' ' || *c.p == '\t' || *c.p == '\r')) ++c.p;
+}
+
+bool consume(Cursor& c, char ch) {
+    skip_ws(c);
+    if (c.p == c.end || *c.p != ch) return false;
+    ++c.p;
+    return true;
+}
+
+/** @brief Raw (still escaped) contents of a string; the closing quote is found with memchr. */
+bool parse_string(Cursor& c, std::string_view& out) {
+    if (!consume(c, '"')) return false;
+    const char* start = c.p;
+    while (true) {
+        const void* q = std::memchr(c.p, '"', static_cast<std::size_t>(c.end - c.p));
+        if (!q) return false;
+        const char* quote = static_cast<const char*>(q);
+        std::size_t backslashes = 0;
+        while (quote - backslashes > start && quote[-1 - static_cast<std::ptrdiff_t>(backslashes)] == '\\') ++backslashes;
+        c.p = quote + 1;
+        if (backslashes % 2u == 0u) {
+            out = std::string_view(start, static_cast<std::size_t>(quote - start));
+            return true;
+        }
+    }
+}
+
+bool parse_uint(Cursor& c, std::uint64_t& out) {
+    skip_ws(c);
+    if (c.p == c.end || *c.p < '0' || *c.p > '9') return false;
+    std::uint64_t v = 0;
+    while (c.p != c.end && *c.p >= '0' && *c.p <= '9') v = v * 10u + static_cast<std::uint64_t>(*c.p++ - '0');
+    out = v;
+    return true;
+}
+
+/** @brief Skips any JSON value (nested containers by depth, strings with their escapes). */
+bool skip_value(Cursor& c) {
+    skip_ws(c);
+    if (c.p == c.end) return false;
+    std::string_view ignored;
+    if (*c.p == '"') return parse_string(c, ignored);
+    if (*c.p != '[' && *c.p != '{') {
+        const char* start = c.p;
+        while (c.p != c.end && *c.p != ',' && *c.p != '}' && *c.p != ']' && *c.p != ' ' && *c.p != '\t') ++c.p;
+        return c.p != start;
+    }
+    int depth = 0;
+    while (c.p != c.end) {
+        const char ch = *c.p;
+        if (ch == '"') {
+            if (!parse_string(c, ignored)) return false;
+            continue;
+        }
+        ++c.p;
+        if (ch == '[' || ch == '{') ++depth;
+        if ((ch == ']' || ch == '}') && --depth == 0) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Walks the fields of a flat object; @p field(key, cursor) returns 1 if it consumed
+ *        the value, 0 to skip it and -1 on a bad value.
+ */
+template <typename F>
+bool for_each_field(std::string_view line, F&& field) {
+    Cursor c{line.data(), line.data() + line.size()};
+    if (!consume(c, '{')) return false;
+    skip_ws(c);
+    if (c.p != c.end && *c.p == '}') return true;
+    while (true) {
+        std::string_view key;
+        if (!parse_string(c, key) || !consume(c, ':')) return false;
+        const int r = field(key, c);
+        if (r < 0 || (r == 0 && !skip_value(c))) return false;
+        if (consume(c, ',')) continue;
+        return consume(c, '}');
+    }
+}
+
+bool parse_show(Cursor& c, ShowId& out) {
+    std::uint64_t v = 0;
+    if (!parse_uint(c, v) || v > 0x7fffffffu) return false;
+    out = static_cast<ShowId>(v);
+    return true;
+}
+
+std::uint64_t mix64(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+struct CaptureKey {
+    ShowId show;
+    std::uint64_t id;
+    bool operator==(const CaptureKey& o) const { return show == o.show && id == o.id; }
+};
+
+struct CaptureKeyHash {
+    std::size_t operator()(const CaptureKey& k) const {
+        return static_cast<std::size_t>(mix64(k.id ^ (static_cast<std::uint64_t>(k.show.value()) << 40)));
+    }
+};
+
+/** @brief One replay thread: owns the shows routed to it and their id mapping. */
+struct Worker {
+    explicit Worker(std::size_t capacity) : queue(capacity) {}
+
+    void run(BookingService& service);
+    void execute(BookingService& service, const ReplayOp& op);
+
+    SpscQueue<std::string_view> queue;  /**< Lines; a null view ends the stream. */
+    std::unordered_map<CaptureKey, BookingId, CaptureKeyHash> ids;
+    std::unordered_set<ShowId> touched;
+    ReplayStats stats;
+    std::thread thread;
+};
+
+template <typename Ready>
+void wait_until(Ready&& ready) {
+    for (int spins = 0; !ready(); ++spins) {
+        if (spins >= 64) std::this_thread::yield();
+    }
+}
+
+void Worker::run(BookingService& service) {
+    ReplayOp op;
+    while (true) {
+        std::string_view line;
+        wait_until([&] { return queue.pop(line); });
+        if (line.data() == nullptr) return;
+        if (!parse_replay_op(line, op)) {
+            ++stats.malformed;
+            continue;
+        }
+        ++stats.ops;
+        touched.insert(op.show_id);
+        execute(service, op);
+    }
+}
+
+void Worker::execute(BookingService& service, const ReplayOp& op) {
+    switch (op.kind) {
+        case ReplayOpKind::Book:
+        case ReplayOpKind::BookBest: {
+            SeatMask seats;
+            const BookingResult r = op.kind == ReplayOpKind::Book
+                                        ? service.book_seat_labels(op.show_id, Span<const std::string_view>(op.seats))
+                                        : service.book_best_available(op.show_id, op.count, seats);
+            if (!r.success) {
+                ++stats.failed;
+            } else if (op.id != 0u) {
+                ids[CaptureKey{op.show_id, op.id}] = static_cast<BookingId>(r.id);
+            }
+            break;
+        }
+        case ReplayOpKind::Cancel: {
+            const auto it = ids.find(CaptureKey{op.show_id, op.booking});
+            if (it == ids.end()) {
+                ++stats.unmapped;
+                break;
+            }
+            BookingResult r;
+            if (op.seats.empty()) {
+                SeatMask seats;
+                service.booking_seats(op.show_id, it->second, seats);
+                r = service.cancel_seat_mask(op.show_id, seats, it->second);
+                ids.erase(it);
+            } else {
+                const std::vector<std::string> labels(op.seats.begin(), op.seats.end());
+                r = service.cancel_seats(op.show_id, labels, it->second);
+            }
+            if (!r.success) ++stats.failed;
+            break;
+        }
+        case ReplayOpKind::ListSeats:
+            service.list_available_seats(op.show_id);
+            break;
+        case ReplayOpKind::AvailableCount:
+            service.available_count(op.show_id);
+            break;
+    }
+}
+
+} // namespace
+
+bool parse_replay_op(std::string_view line, ReplayOp& out) {
+    out.show_id = -1;
+    out.count = 0;
+    out.id = 0;
+    out.booking = 0;
+    out.seats.clear();
+    bool has_op = false;
+    const bool ok = for_each_field(line, [&](std::string_view key, Cursor& c) -> int {
+        if (key == "op") {
+            std::string_view v;
+            if (!parse_string(c, v)) return -1;
+            has_op = true;
+            if (v == "book") out.kind = ReplayOpKind::Book;
+            else if (v == "best") out.kind = ReplayOpKind::BookBest;
+            else if (v == "cancel") out.kind = ReplayOpKind::Cancel;
+            else if (v == "seats") out.kind = ReplayOpKind::ListSeats;
+            else if (v == "count") out.kind = ReplayOpKind::AvailableCount;
+            else return -1;
+            return 1;
+        }
+        if (key == "show") return parse_show(c, out.show_id) ? 1 : -1;
+        if (key == "id") return parse_uint(c, out.id) ? 1 : -1;
+        if (key == "booking") return parse_uint(c, out.booking) ? 1 : -1;
+        if (key == "n") {
+            std::uint64_t n = 0;
+            if (!parse_uint(c, n) || n > 4096u) return -1;
+            out.count = static_cast<int>(n);
+            return 1;
+        }
+        if (key == "seats") {
+            if (!consume(c, '[')) return -1;
+            if (consume(c, ']')) return 1;
+            do {
+                std::string_view label;
+                if (!parse_string(c, label)) return -1;
+                out.seats.push_back(label);
+            } while (consume(c, ','));
+            return consume(c, ']') ? 1 : -1;
+        }
+        return 0;
+    });
+    if (!ok || !has_op || !out.show_id.valid()) return false;
+    if (out.kind == ReplayOpKind::Book && out.seats.empty()) return false;
+    if (out.kind == ReplayOpKind::BookBest && out.count <= 0) return false;
+    return out.kind != ReplayOpKind::Cancel || out.booking != 0u;
+}
+
+bool scan_replay_show(std::string_view line, ShowId& out) {
+    out = -1;
+    for_each_field(line, [&](std::string_view key, Cursor& c) -> int {
+        if (key != "show") return 0;
+        return parse_show(c, out) ? 1 : -1;
+    });
+    return out >= 0;
+}
+
+ReplayStats replay_traffic(BookingService& service, std::string_view capture, ReplayOptions options) {
+    unsigned n = options.workers != 0u ? options.workers : std::thread::hardware_concurrency();
+    if (n == 0u) n = 1u;
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    workers.reserve(n);
+    for (unsigned w = 0; w < n; ++w) {
+        workers.push_back(std::make_unique<Worker>(options.queue_capacity));
+        Worker& worker = *workers.back();
+        worker.thread = std::thread([&worker, &service] { worker.run(service); });
+    }
+
+    ReplayStats total;
+    const char* p = capture.data();
+    const char* const end = p + capture.size();
+    while (p != end) {
+        const void* nl = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+        const char* line_end = nl ? static_cast<const char*>(nl) : end;
+        const std::string_view line(p, static_cast<std::size_t>(line_end - p));
+        p = nl ? line_end + 1 : end;
+        if (line.find_first_not_of(" \t\r") == std::string_view::npos) continue;
+        ++total.lines;
+        ShowId show = -1;
+        if (!scan_replay_show(line, show)) {
+            ++total.malformed;
+            continue;
+        }
+        SpscQueue<std::string_view>& q = workers[static_cast<std::uint64_t>(show.value()) % n]->queue;
+        wait_until([&] { return q.push(line); });
+    }
+
+    std::vector<ShowId> shows;
+    for (auto& w : workers) {
+        wait_until([&] { return w->queue.push(std::string_view()); });
+        w->thread.join();
+        total.ops += w->stats.ops;
+        total.failed += w->stats.failed;
+        total.malformed += w->stats.malformed;
+        total.unmapped += w->stats.unmapped;
+        shows.insert(shows.end(), w->touched.begin(), w->touched.end());
+    }
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    total.checksum = seat_state_checksum(service, shows);
+    return total;
+}
+
+std::uint64_t seat_state_checksum(const BookingService& service, Span<const ShowId> shows) {
+    std::vector<ShowId> unique(shows.begin(), shows.end());
+    std::sort(unique.begin(), unique.end());
+    unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+    std::uint64_t sum = 0;
+    for (ShowId show : unique) {
+        SeatMask free;
+        const int count = service.available_seats_mask(show, free);
+        std::uint64_t h = mix64(static_cast<std::uint64_t>(show.value()) ^ (static_cast<std::uint64_t>(count) << 32));
+        for (int w = 0; w < SeatMask::kWords; ++w) h = mix64(h ^ free.word(w));
+        sum += h;
+    }
+    return sum;
+}
+
+} // namespace booking
@@ -0,0 +1,348 @@
+#include "wire_protocol.hpp"
+
+#include <cstring>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "wire_protocol.cpp assumes a little-endian host"
+#endif
+
+namespace booking {
+
+namespace {
+
+struct RequestHeader {
+    std::uint8_t magic;
+    std::uint8_t op;
+    std::uint16_t count;
+    std::uint32_t flags;
+    std::int64_t show_id;
+    std::uint64_t request_id;
+    std::uint64_t arg;
+};
+
+struct ResponseFrame {
+    std::uint8_t magic;
+    std::uint8_t op;
+    std::uint8_t status;
+    std::uint8_t reserved;
+    std::int32_t value;
+    std::uint64_t request_id;
+    std::uint64_t id;
+};
+
+static_assert(sizeof(RequestHeader) == kWireHeaderSize && sizeof(ResponseFrame) == kWireResponseSize,
+              "wire frame layout");
+
+/** @brief Largest BookIndices count (every seat of a 64 x 64 hall). */
+constexpr std::uint16_t kMaxIndices = HallLayout::kMaxRows * HallLayout::kMaxRowSeats;
+
+std::size_t pad8(std::size_t n) {
+    return (n + 7u) & ~std::size_t{7};
+}
+
+template <typename T>
+void append_raw(std::string& out, const T& v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+ResponseFrame response_frame(const WireResponse& r) {
+    return ResponseFrame{kWireMagic, static_cast<std::uint8_t>(r.op), static_cast<std::uint8_t>(r.status), 0,
+                         r.value, r.request_id, r.id};
+}
+
+} // namespace
+
+WireDecode decode_request(const void* data, std::size_t size, WireRequestView& out) {
+    if (size < kWireHeaderSize) {
+        return size != 0u && *static_cast<const unsigned char*>(data) != kWireMagic ? WireDecode::Malformed
+                                                                                     : WireDecode::Incomplete;
+    }
+    RequestHeader h;
+    std::memcpy(&h, data, sizeof(h));
+    if (h.magic != kWireMagic) return WireDecode::Malformed;
+
+    std::size_t payload = 0;
+    switch (static_cast<WireOp>(h.op)) {
+        case WireOp::BookMask:
+        case WireOp::CancelMask:
+            if (h.count == 0u || h.count > SeatMask::kWords) return WireDecode::Malformed;
+            payload = 8u + 8u * h.count;
+            break;
+        case WireOp::BookIndices:
+            if (h.count == 0u || h.count > kMaxIndices) return WireDecode::Malformed;
+            payload = pad8(2u * h.count);
+            break;
+        case WireOp::BookBest:
+        case WireOp::AvailableCount:
+            break;
+        case WireOp::AvailableSeats:
+            if (h.count >= kSeatEncodings) return WireDecode::Malformed;
+            break;
+        case WireOp::Batch:
+            // Every frame is a multiple of 8 bytes long, so a batch of them is too
+            if (h.count == 0u || h.count > kMaxWireBatch || h.arg > kMaxWireBatchBytes || h.arg % 8u != 0u) {
+                return WireDecode::Malformed;
+            }
+            payload = static_cast<std::size_t>(h.arg);
+            break;
+        default:
+            return WireDecode::Malformed;
+    }
+    if (size < kWireHeaderSize + payload) return WireDecode::Incomplete;
+
+    out.op = static_cast<WireOp>(h.op);
+    out.count = h.count;
+    out.flags = h.flags;
+    out.show_id = h.show_id;
+    out.request_id = h.request_id;
+    out.arg = h.arg;
+    out.payload = static_cast<const unsigned char*>(data) + kWireHeaderSize;
+    out.frame_size = kWireHeaderSize + payload;
+    return WireDecode::Ok;
+}
+
+bool decode_mask(const WireRequestView& req, SeatMask& out) {
+    std::uint64_t first = 0;
+    std::memcpy(&first, req.payload, 8);
+    if (first >= static_cast<std::uint64_t>(SeatMask::kWords) || first + req.count > SeatMask::kWords) return false;
+    for (int k = 0; k < req.count; ++k) {
+        std::uint64_t word;
+        std::memcpy(&word, req.payload + 8 + 8 * k, 8);
+        out.or_word(static_cast<int>(first) + k, word);
+    }
+    return true;
+}
+
+void encode_mask_request(std::string& out, WireOp op, ShowId show_id, std::uint64_t request_id, const SeatMask& seats,
+                         std::uint64_t arg, std::uint32_t flags) {
+    const int first = seats.empty() ? 0 : seats.first_word();
+    const int count = seats.empty() ? 1 : seats.end_word() - first;
+    append_raw(out, RequestHeader{kWireMagic, static_cast<std::uint8_t>(op), static_cast<std::uint16_t>(count), flags,
+                                  show_id.value(), request_id, arg});
+    append_raw(out, static_cast<std::uint64_t>(first));
+    for (int w = first; w < first + count; ++w) append_raw(out, seats.word(w));
+}
+
+void encode_request(std::string& out, WireOp op, ShowId show_id, std::uint64_t request_id, std::uint16_t count) {
+    append_raw(out, RequestHeader{kWireMagic, static_cast<std::uint8_t>(op), count, 0u, show_id.value(), request_id, 0});
+}
+
+void encode_indices_request(std::string& out, ShowId show_id, std::uint64_t request_id, Span<const int> seats) {
+    append_raw(out, RequestHeader{kWireMagic, static_cast<std::uint8_t>(WireOp::BookIndices),
+                                  static_cast<std::uint16_t>(seats.size()), 0u, show_id.value(), request_id, 0});
+    for (int seat : seats) append_raw(out, static_cast<std::uint16_t>(seat));
+    out.append(pad8(2u * seats.size()) - 2u * seats.size(), '\0');
+}
+
+void encode_batch_request(std::string& out, std::uint64_t request_id, std::string_view frames, std::uint16_t count) {
+    append_raw(out, RequestHeader{kWireMagic, static_cast<std::uint8_t>(WireOp::Batch), count, 0u, 0, request_id,
+                                  static_cast<std::uint64_t>(frames.size())});
+    out += frames;
+}
+
+void encode_response(std::string& out, const WireResponse& r) {
+    append_raw(out, response_frame(r));
+}
+
+bool decode_response(const void* data, std::size_t size, WireResponse& out) {
+    if (size < kWireResponseSize) return false;
+    ResponseFrame f;
+    std::memcpy(&f, data, sizeof(f));
+    if (f.magic != kWireMagic) return false;
+    out.op = static_cast<WireOp>(f.op);
+    out.status = static_cast<BookingStatus>(f.status);
+    out.value = f.value;
+    out.request_id = f.request_id;
+    out.id = f.id;
+    return true;
+}
+
+std::ptrdiff_t WireCommandHandler::execute(const void* data, std::size_t size, std::string& out,
+                                           std::size_t out_limit) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    std::size_t used = 0;
+    WireRequestView req;
+    while (out.size() < out_limit) {
+        const WireDecode d = decode_request(p + used, size - used, req);
+        if (d == WireDecode::Incomplete) break;
+        if (d == WireDecode::Malformed) return -1;
+        if (req.op != WireOp::Batch && limiter_ && !limiter_->allow(client_)) {
+            WireResponse shed;
+            shed.op = req.op;
+            shed.status = BookingStatus::Throttled;
+            shed.request_id = req.request_id;
+            encode_response(out, shed);
+        } else if (req.op == WireOp::AvailableSeats) {
+            available_seats(req, out);
+        } else if (req.op == WireOp::Batch) {
+            if (!batch(req, out)) return -1;
+        } else {
+            encode_response(out, run(req));
+        }
+        used += req.frame_size;
+    }
+    return static_cast<std::ptrdiff_t>(used);
+}
+
+void WireCommandHandler::available_seats(const WireRequestView& req, std::string& out) {
+    WireResponse r;
+    r.op = req.op;
+    r.request_id = req.request_id;
+    const std::size_t frame = out.size();
+    encode_response(out, r);
+    const int free_seats = service_.append_available_seats(req.show_id, static_cast<SeatEncoding>(req.count), out);
+    if (free_seats < 0) {
+        r.status = BookingStatus::InvalidShow;
+    } else {
+        r.value = static_cast<std::int32_t>(out.size() - frame - kWireResponseSize);
+        r.id = static_cast<std::uint64_t>(free_seats);
+    }
+    // The payload size is known only now: fill in the header written ahead of it
+    const ResponseFrame f = response_frame(r);
+    std::memcpy(&out[frame], &f, sizeof(f));
+}
+
+bool WireCommandHandler::batch(const WireRequestView& req, std::string& out) {
+    // Decode every request before running any, so a malformed batch has no effect
+    batch_requests_.clear();
+    std::size_t pos = 0;
+    const std::size_t size = static_cast<std::size_t>(req.arg);
+    for (int k = 0; k < req.count; ++k) {
+        WireRequestView sub;
+        if (decode_request(req.payload + pos, size - pos, sub) != WireDecode::Ok || sub.op == WireOp::Batch) {
+            return false;
+        }
+        batch_requests_.push_back(sub);
+        pos += sub.frame_size;
+    }
+    if (pos != size) return false;
+
+    const std::size_t n = batch_requests_.size();
+    batch_responses_.assign(n, WireResponse{});
+    batch_masks_.resize(n);
+    batch_bookings_.clear();
+    batch_positions_.clear();
+    for (std::size_t k = 0; k < n; ++k) {
+        const WireRequestView& sub = batch_requests_[k];
+        WireResponse& r = batch_responses_[k];
+        r.op = sub.op;
+        r.request_id = sub.request_id;
+        if (limiter_ && !limiter_->allow(client_)) {
+            r.status = BookingStatus::Throttled;
+            continue;
+        }
+        if (sub.op == WireOp::AvailableCount || sub.op == WireOp::AvailableSeats) continue;
+        if (sub.op == WireOp::BookMask && (sub.flags & kWireIdempotent) == 0u && !read_only_) {
+            batch_masks_[k] = SeatMask{};
+            if (!decode_mask(sub, batch_masks_[k])) {
+                r.status = BookingStatus::InvalidSeatIndex;
+                continue;
+            }
+            batch_bookings_.push_back(BookingRequest{sub.show_id, {}, &batch_masks_[k]});
+            batch_positions_.push_back(k);
+            continue;
+        }
+        r = run(sub);
+    }
+
+    if (!batch_bookings_.empty()) {
+        batch_results_.resize(batch_bookings_.size());
+        service_.book_seats_batch(Span<const BookingRequest>(batch_bookings_.data(), batch_bookings_.size()),
+                                  Span<BookingResult>(batch_results_.data(), batch_results_.size()));
+        for (std::size_t b = 0; b < batch_results_.size(); ++b) {
+            WireResponse& r = batch_responses_[batch_positions_[b]];
+            r.status = batch_results_[b].status;
+            r.id = batch_results_[b].success ? batch_results_[b].id : 0u;
+        }
+    }
+
+    batch_shows_.clear();
+    batch_positions_.clear();
+    for (std::size_t k = 0; k < n; ++k) {
+        if (batch_requests_[k].op == WireOp::AvailableCount && batch_responses_[k].status == BookingStatus::Ok) {
+            batch_shows_.push_back(batch_requests_[k].show_id);
+            batch_positions_.push_back(k);
+        }
+    }
+    if (!batch_shows_.empty()) {
+        batch_counts_.resize(batch_shows_.size());
+        service_.available_counts(Span<const ShowId>(batch_shows_.data(), batch_shows_.size()),
+                                  Span<int>(batch_counts_.data(), batch_counts_.size()));
+        for (std::size_t b = 0; b < batch_counts_.size(); ++b) {
+            WireResponse& r = batch_responses_[batch_positions_[b]];
+            r.value = batch_counts_[b];
+            r.status = r.value < 0 ? BookingStatus::InvalidShow : BookingStatus::Ok;
+        }
+    }
+
+    WireResponse head;
+    head.op = WireOp::Batch;
+    head.request_id = req.request_id;
+    head.value = static_cast<std::int32_t>(n);
+    encode_response(out, head);
+    for (std::size_t k = 0; k < n; ++k) {
+        if (batch_requests_[k].op == WireOp::AvailableSeats && batch_responses_[k].status == BookingStatus::Ok) {
+            available_seats(batch_requests_[k], out);
+        } else {
+            encode_response(out, batch_responses_[k]);
+        }
+    }
+    return true;
+}
+
+WireResponse WireCommandHandler::run(const WireRequestView& req) {
+    WireResponse r;
+    r.op = req.op;
+    r.request_id = req.request_id;
+    if (read_only_ && req.op != WireOp::AvailableCount) {
+        r.status = BookingStatus::ReadOnlyReplica;
+        return r;
+    }
+    BookingResult res;
+    switch (req.op) {
+        case WireOp::BookMask:
+        case WireOp::CancelMask: {
+            SeatMask seats;
+            if (!decode_mask(req, seats)) {
+                r.status = BookingStatus::InvalidSeatIndex;
+                return r;
+            }
+            if (req.op == WireOp::CancelMask) {
+                res = service_.cancel_seat_mask(req.show_id, seats, req.arg);
+            } else if ((req.flags & kWireIdempotent) != 0u) {
+                res = service_.book_seat_mask_once(req.request_id, req.show_id, seats);
+            } else {
+                res = service_.book_seat_mask(req.show_id, seats);
+            }
+            break;
+        }
+        case WireOp::BookIndices: {
+            int seats[kMaxIndices];
+            for (int k = 0; k < req.count; ++k) {
+                std::uint16_t seat;
+                std::memcpy(&seat, req.payload + 2 * k, 2);
+                seats[k] = seat;
+            }
+            res = service_.book_seat_indices(req.show_id, Span<const int>(seats, req.count));
+            break;
+        }
+        case WireOp::BookBest: {
+            SeatMask seats;
+            res = service_.book_best_available(req.show_id, req.count, seats);
+            if (res.success) r.value = HallLayout::seat_index(seats.first_word(), ctz64(seats.word(seats.first_word())));
+            break;
+        }
+        case WireOp::AvailableCount:
+            r.value = service_.available_count(req.show_id);
+            r.status = r.value < 0 ? BookingStatus::InvalidShow : BookingStatus::Ok;
+            return r;
+        case WireOp::AvailableSeats:
+        case WireOp::Batch:
+            break; // answered by available_seats and batch, with their payloads
+    }
+    r.status = res.status;
+    r.id = res.success ? res.id : 0u;
+    return r;
+}
+
+} // namespace booking
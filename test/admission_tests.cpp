@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include "admission.hpp"
+#include "booking_service.hpp"
+
+#include <chrono>
+
+using booking::AdmissionGate;
+using booking::AdmissionPolicy;
+using booking::BookingService;
+using booking::BookingStatus;
+
+TEST(Admission, GateAdmitsAtTheConfiguredRateWithABurst) {
+    AdmissionGate gate;
+    EXPECT_FALSE(gate.enabled());
+    EXPECT_TRUE(gate.try_admit(0)); // open gate
+
+    gate.configure(AdmissionPolicy{1000.0, 3}); // one slot per ms, three back to back
+    ASSERT_TRUE(gate.enabled());
+    const std::int64_t t0 = 1'000'000'000;
+    EXPECT_TRUE(gate.try_admit(t0));
+    EXPECT_TRUE(gate.try_admit(t0));
+    EXPECT_TRUE(gate.try_admit(t0));
+    EXPECT_FALSE(gate.try_admit(t0)); // burst used up
+    EXPECT_FALSE(gate.try_admit(t0 + 500'000));
+    EXPECT_EQ(gate.retry_after_ns(t0), 1'000'000);
+
+    // One slot per interval from then on, however many ask
+    int admitted = 0;
+    for (std::int64_t t = t0 + 1'000'000; t < t0 + 11'000'000; t += 100'000) admitted += gate.try_admit(t) ? 1 : 0;
+    EXPECT_EQ(admitted, 10);
+
+    // A quiet period refills the burst but never banks more
+    EXPECT_EQ(gate.retry_after_ns(t0 + 100'000'000), 0);
+    for (int i = 0; i < 3; ++i) EXPECT_TRUE(gate.try_admit(t0 + 100'000'000));
+    EXPECT_FALSE(gate.try_admit(t0 + 100'000'000));
+
+    gate.configure(AdmissionPolicy{});
+    EXPECT_TRUE(gate.try_admit(t0 + 100'000'000));
+}
+
+TEST(Admission, HotShowShedsBookersWithoutSlowingOtherShows) {
+    BookingService svc;
+    const booking::ShowId hot = svc.find_show(1, 1);
+    const booking::ShowId other = svc.find_show(1, 2);
+    ASSERT_EQ(svc.set_admission_policy(hot, AdmissionPolicy{0.001, 2}), booking::CatalogStatus::Ok); // two, then one per 1000 s
+    EXPECT_EQ(svc.set_admission_policy(999, AdmissionPolicy{1.0, 1}), booking::CatalogStatus::UnknownShow);
+
+    EXPECT_TRUE(svc.book_seats(hot, {"a1"}).success);
+    booking::SeatMask seats;
+    EXPECT_TRUE(svc.book_best_available(hot, 2, seats).success);
+    EXPECT_EQ(svc.book_seats(hot, {"a9"}).status, BookingStatus::Throttled);
+    EXPECT_EQ(svc.book_seats(hot, {"not-a-seat"}).status, BookingStatus::Throttled); // shed before parsing
+    EXPECT_EQ(svc.hold_seats(hot, {"a9"}, std::chrono::minutes(1)).status, BookingStatus::Throttled);
+    EXPECT_GT(svc.admission_retry_after(hot), std::chrono::seconds(100));
+    EXPECT_EQ(svc.available_count(hot), 17);
+
+    const std::string_view labels[] = {"a10"};
+    const booking::BookingRequest batch[] = {{hot, labels}, {other, labels}};
+    const auto results = svc.book_seats_batch(booking::Span<const booking::BookingRequest>(batch, 2));
+    EXPECT_EQ(results[0].status, BookingStatus::Throttled);
+    EXPECT_TRUE(results[1].success);
+
+    for (int i = 0; i < 5; ++i) EXPECT_TRUE(svc.book_seats(other, {"a" + std::to_string(i + 11)}).success << i);
+    EXPECT_EQ(svc.admission_retry_after(other), std::chrono::nanoseconds{0});
+
+    // Lifting the policy opens the gate again
+    ASSERT_EQ(svc.set_admission_policy(hot, AdmissionPolicy{}), booking::CatalogStatus::Ok);
+    EXPECT_TRUE(svc.book_seats(hot, {"a9"}).success);
+}
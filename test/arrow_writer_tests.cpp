@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+
+#include "arrow_writer.hpp"
+#include "booking_service.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::ArrowColumn;
+using booking::ArrowFileWriter;
+using booking::ArrowType;
+using booking::BookingService;
+using booking::SnapshotStatus;
+
+namespace {
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/** @brief Just enough of a flatbuffer reader to walk the Arrow metadata. */
+struct Flat {
+    const char* base;
+
+    template <typename T>
+    T get(std::size_t pos) const {
+        T v;
+        std::memcpy(&v, base + pos, sizeof(v));
+        return v;
+    }
+    std::size_t root() const { return deref(0); }
+    std::size_t deref(std::size_t pos) const { return pos + get<std::uint32_t>(pos); }
+    /** @brief Position of field @p slot of @p table, or 0 if absent. */
+    std::size_t field(std::size_t table, int slot) const {
+        const std::size_t vtable = table - static_cast<std::size_t>(get<std::int32_t>(table));
+        if (4u + 2u * static_cast<std::size_t>(slot) >= get<std::uint16_t>(vtable)) return 0;
+        const std::uint16_t at = get<std::uint16_t>(vtable + 4u + 2u * static_cast<std::size_t>(slot));
+        return at == 0u ? 0u : table + at;
+    }
+    std::string string(std::size_t pos) const { return std::string(base + pos + 4, get<std::uint32_t>(pos)); }
+};
+
+/** @brief An Arrow file read back: field names and, per batch, the buffers of each column. */
+struct ArrowFile {
+    std::vector<std::string> names;
+    std::vector<std::int64_t> batch_rows;
+    std::vector<std::vector<std::string>> buffers; // batch -> buffer (validity, values, ...) in order
+};
+
+ArrowFile read_arrow(const std::string& bytes) {
+    ArrowFile out;
+    EXPECT_EQ(bytes.compare(0, 8, std::string("ARROW1\0\0", 8)), 0);
+    EXPECT_EQ(bytes.compare(bytes.size() - 6u, 6, "ARROW1"), 0);
+    std::int32_t footer_size = 0;
+    std::memcpy(&footer_size, bytes.data() + bytes.size() - 10u, 4);
+    const Flat footer{bytes.data() + bytes.size() - 10u - static_cast<std::size_t>(footer_size)};
+    const std::size_t root = footer.root();
+    EXPECT_EQ(footer.get<std::int16_t>(footer.field(root, 0)), 4); // V5
+    const std::size_t schema = footer.deref(footer.field(root, 1));
+    const std::size_t fields = footer.deref(footer.field(schema, 1));
+    for (std::uint32_t i = 0; i < footer.get<std::uint32_t>(fields); ++i) {
+        const std::size_t field = footer.deref(fields + 4u + 4u * i);
+        out.names.push_back(footer.string(footer.deref(footer.field(field, 0))));
+        EXPECT_NE(footer.field(field, 5), 0u); // children, even if empty
+    }
+
+    const std::size_t blocks = footer.deref(footer.field(root, 3));
+    for (std::uint32_t b = 0; b < footer.get<std::uint32_t>(blocks); ++b) {
+        const std::size_t block = blocks + 4u + 24u * b;
+        const auto offset = static_cast<std::size_t>(footer.get<std::int64_t>(block));
+        const auto metadata_length = static_cast<std::size_t>(footer.get<std::int32_t>(block + 8u));
+        const std::int64_t body_length = footer.get<std::int64_t>(block + 16u);
+        EXPECT_EQ(offset % 8u, 0u);
+        EXPECT_EQ(metadata_length % 8u, 0u);
+        EXPECT_EQ(Flat{bytes.data()}.get<std::uint32_t>(offset), 0xFFFFFFFFu);
+
+        const Flat message{bytes.data() + offset + 8u};
+        const std::size_t m = message.root();
+        EXPECT_EQ(message.get<std::uint8_t>(message.field(m, 1)), 3u); // RecordBatch
+        EXPECT_EQ(message.get<std::int64_t>(message.field(m, 3)), body_length);
+        const std::size_t batch = message.deref(message.field(m, 2));
+        out.batch_rows.push_back(message.get<std::int64_t>(message.field(batch, 0)));
+        const std::size_t list = message.deref(message.field(batch, 2));
+        const char* body = bytes.data() + offset + metadata_length;
+        out.buffers.emplace_back();
+        for (std::uint32_t i = 0; i < message.get<std::uint32_t>(list); ++i) {
+            const auto at = static_cast<std::size_t>(message.get<std::int64_t>(list + 4u + 16u * i));
+            const auto size = static_cast<std::size_t>(message.get<std::int64_t>(list + 12u + 16u * i));
+            EXPECT_EQ(at % 8u, 0u);
+            out.buffers.back().emplace_back(body + at, size);
+        }
+    }
+    return out;
+}
+
+template <typename T>
+std::vector<T> values(const std::string& buffer) {
+    std::vector<T> v(buffer.size() / sizeof(T));
+    std::memcpy(v.data(), buffer.data(), buffer.size());
+    return v;
+}
+
+} // namespace
+
+TEST(ArrowWriter, WritesBatchesAFooterCanFind) {
+    const std::string path = ::testing::TempDir() + "arrow_writer.arrow";
+    ArrowFileWriter out({{"id", ArrowType::Int64}, {"name", ArrowType::Utf8}});
+    ASSERT_TRUE(out.open(path));
+    const std::int64_t ids[] = {7, 8, 9};
+    const std::int32_t offsets[] = {0, 3, 3, 8};
+    const ArrowColumn first[] = {{ids, nullptr}, {offsets, "onethree"}};
+    ASSERT_TRUE(out.write_batch(3, first));
+    const std::int32_t none[] = {0};
+    const ArrowColumn empty[] = {{ids, nullptr}, {none, ""}};
+    ASSERT_TRUE(out.write_batch(0, empty));
+    ASSERT_TRUE(out.finish());
+    EXPECT_EQ(out.batches(), 2u);
+    EXPECT_EQ(out.rows(), 3u);
+
+    const ArrowFile file = read_arrow(read_file(path));
+    EXPECT_EQ(file.names, (std::vector<std::string>{"id", "name"}));
+    ASSERT_EQ(file.batch_rows, (std::vector<std::int64_t>{3, 0}));
+    ASSERT_EQ(file.buffers[0].size(), 5u); // validity + values, validity + offsets + characters
+    EXPECT_TRUE(file.buffers[0][0].empty());
+    EXPECT_EQ(values<std::int64_t>(file.buffers[0][1]), (std::vector<std::int64_t>{7, 8, 9}));
+    EXPECT_EQ(values<std::int32_t>(file.buffers[0][3]), (std::vector<std::int32_t>{0, 3, 3, 8}));
+    EXPECT_EQ(file.buffers[0][4], "onethree");
+    std::remove(path.c_str());
+}
+
+TEST(ArrowWriter, ExportsShowsAndSeatOwners) {
+    BookingService svc;
+    const auto first = svc.book_seats(1, {"a1", "a2"});
+    const auto second = svc.book_seats(3, {"a20"});
+    ASSERT_TRUE(first.success && second.success);
+    ASSERT_TRUE(svc.hold_seats(2, {"a5"}, std::chrono::minutes(1)).success); // not an owner yet
+
+    ASSERT_EQ(svc.export_arrow(::testing::TempDir(), 2), SnapshotStatus::Ok);
+    const std::string shows_path = ::testing::TempDir() + "shows.arrow";
+    const std::string seats_path = ::testing::TempDir() + "seats.arrow";
+
+    const ArrowFile shows = read_arrow(read_file(shows_path));
+    EXPECT_EQ(shows.names, (std::vector<std::string>{"show_id", "movie_id", "movie_title", "theater_id",
+                                                     "theater_name", "start_time", "hall", "seats", "booked"}));
+    ASSERT_EQ(shows.batch_rows, (std::vector<std::int64_t>{2, 2}));
+    EXPECT_EQ(values<std::int64_t>(shows.buffers[0][1]), (std::vector<std::int64_t>{1, 2}));
+    EXPECT_EQ(values<std::int64_t>(shows.buffers[1][3]), (std::vector<std::int64_t>{2, 3})); // movie ids
+    EXPECT_EQ(shows.buffers[1][6], "InterstellarThe Matrix");
+    EXPECT_EQ(shows.buffers[0][11], "Central CinemaMall Theater");
+    EXPECT_EQ(values<std::int32_t>(shows.buffers[0][19]), (std::vector<std::int32_t>{2, 0})); // booked
+    EXPECT_EQ(values<std::int32_t>(shows.buffers[1][19]), (std::vector<std::int32_t>{1, 0}));
+    EXPECT_EQ(values<std::int32_t>(shows.buffers[1][17]), (std::vector<std::int32_t>{20, 20})); // capacity
+
+    const ArrowFile seats = read_arrow(read_file(seats_path));
+    ASSERT_EQ(seats.batch_rows, (std::vector<std::int64_t>{2, 1}));
+    EXPECT_EQ(values<std::int64_t>(seats.buffers[0][1]), (std::vector<std::int64_t>{1, 1}));
+    EXPECT_EQ(seats.buffers[0][6], "a1a2");
+    const auto first_id = static_cast<std::uint32_t>(first.id);
+    EXPECT_EQ(values<std::uint32_t>(seats.buffers[0][8]), (std::vector<std::uint32_t>{first_id, first_id}));
+    EXPECT_EQ(values<std::int32_t>(seats.buffers[1][3]), (std::vector<std::int32_t>{19}));
+    EXPECT_EQ(values<std::uint32_t>(seats.buffers[1][8]),
+              (std::vector<std::uint32_t>{static_cast<std::uint32_t>(second.id)}));
+    std::remove(shows_path.c_str());
+    std::remove(seats_path.c_str());
+}
+
+TEST(ArrowWriter, PublishesOccupancyFromTheStateArray) {
+    BookingService svc;
+    ASSERT_TRUE(svc.book_seats(2, {"a1", "a2", "a3"}).success);
+    ASSERT_TRUE(svc.hold_seats(4, {"a7"}, std::chrono::minutes(1)).success); // held seats are taken too
+    const std::string path = ::testing::TempDir() + "occupancy.arrow";
+    ASSERT_EQ(svc.publish_occupancy(path), SnapshotStatus::Ok);
+
+    const ArrowFile file = read_arrow(read_file(path));
+    EXPECT_EQ(file.names, (std::vector<std::string>{"show_id", "movie_id", "theater_id", "start_time", "seats",
+                                                    "taken", "changes"}));
+    ASSERT_EQ(file.batch_rows, (std::vector<std::int64_t>{4}));
+    EXPECT_EQ(values<std::int64_t>(file.buffers[0][1]), (std::vector<std::int64_t>{1, 2, 3, 4}));
+    EXPECT_EQ(values<std::int32_t>(file.buffers[0][11]), (std::vector<std::int32_t>{0, 3, 0, 1}));
+    const std::vector<std::int64_t> changes = values<std::int64_t>(file.buffers[0][13]);
+    EXPECT_EQ(changes[0], 0);
+    EXPECT_GT(changes[1], 0);
+
+    // Republished in the background; a reader of the old file keeps its copy
+    const std::string before = read_file(path);
+    booking::OccupancyExportOptions options;
+    options.path = path;
+    options.interval = std::chrono::milliseconds(1);
+    ASSERT_EQ(svc.set_occupancy_export(options), SnapshotStatus::Ok);
+    ASSERT_TRUE(svc.book_seats(1, {"a9"}).success);
+    const std::uint64_t published = svc.occupancy_publications();
+    while (svc.occupancy_publications() < published + 2u) std::this_thread::yield();
+    ASSERT_EQ(svc.set_occupancy_export(booking::OccupancyExportOptions{}), SnapshotStatus::Ok);
+    EXPECT_NE(read_file(path), before);
+    EXPECT_EQ(values<std::int32_t>(read_arrow(read_file(path)).buffers[0][11]),
+              (std::vector<std::int32_t>{1, 3, 0, 1}));
+    std::remove(path.c_str());
+}
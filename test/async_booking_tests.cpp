@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include "async_booking.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using booking::BookingResult;
+using booking::BookingService;
+using booking::CommitLoop;
+using booking::HallLayout;
+using booking::JournalMode;
+using booking::JournalStatus;
+using booking::SeatMask;
+using booking::ShowId;
+using booking::Task;
+
+namespace {
+
+std::string temp_path(const char* name) {
+    const std::string path = ::testing::TempDir() + name;
+    std::remove(path.c_str());
+    return path;
+}
+
+/** @brief Books @p seat and checks that it was durable when acknowledged. */
+Task<void> book_one(CommitLoop& loop, const BookingService& service, ShowId show, int seat, int& booked) {
+    SeatMask mask;
+    mask.set(seat);
+    CommitLoop::BookingAwaiter op = loop.book_seat_mask(show, mask);
+    const std::uint64_t lsn = op.lsn;
+    const BookingResult res = co_await op;
+    EXPECT_TRUE(res.success) << seat;
+    EXPECT_LE(lsn, service.journal_durable_lsn()) << seat;
+    if (res.success) ++booked;
+}
+
+/** @brief Holds @p labels, then confirms the hold; returns the confirmation. */
+Task<BookingResult> hold_then_confirm(CommitLoop& loop, ShowId show, std::vector<std::string> labels) {
+    const BookingResult hold = co_await loop.hold_seats(show, labels, std::chrono::minutes(1));
+    if (!hold.success) co_return hold;
+    co_return co_await loop.confirm_hold(hold.id);
+}
+
+Task<void> checkout(CommitLoop& loop, ShowId show, std::vector<std::string> labels, BookingResult& out) {
+    out = co_await hold_then_confirm(loop, show, std::move(labels));
+}
+
+} // namespace
+
+TEST(CommitLoop, ThousandsOfBookingsInFlightOnOneThread) {
+    const std::string path = temp_path("async_booking.log");
+    BookingService service(HallLayout::uniform(32, 64));
+    ASSERT_EQ(service.open_journal(path, JournalMode::Sync), JournalStatus::Ok);
+    const ShowId show = service.find_show(1, 1);
+
+    CommitLoop loop(service);
+    int booked = 0;
+    for (int seat = 0; seat < 32 * 64; ++seat) loop.spawn(book_one(loop, service, show, seat, booked));
+    EXPECT_EQ(loop.active(), loop.pending()); // every unfinished booking waits on its commit
+    EXPECT_EQ(service.available_count(show), 0); // the seats are taken before the first suspension
+    loop.run();
+    EXPECT_EQ(booked, 32 * 64);
+    EXPECT_EQ(loop.active(), 0u);
+    EXPECT_EQ(loop.pending(), 0u);
+
+    BookingService recovered(HallLayout::uniform(32, 64));
+    EXPECT_EQ(recovered.replay_journal(path).applied, static_cast<std::size_t>(32 * 64));
+    EXPECT_EQ(recovered.available_count(show), 0);
+    std::remove(path.c_str());
+}
+
+TEST(CommitLoop, NestedTasksHoldAndConfirm) {
+    const std::string path = temp_path("async_booking_hold.log");
+    BookingService service;
+    ASSERT_EQ(service.open_journal(path, JournalMode::Sync), JournalStatus::Ok);
+    const ShowId show = service.find_show(1, 1);
+
+    CommitLoop loop(service);
+    BookingResult first;
+    BookingResult second;
+    loop.spawn(checkout(loop, show, {"a1", "a2"}, first));
+    loop.spawn(checkout(loop, show, {"a2", "a3"}, second)); // a2 is held: fails without parking
+    EXPECT_FALSE(second.success);
+    loop.run();
+    EXPECT_TRUE(first.success);
+    EXPECT_EQ(service.seat_owner(show, 0), first.id);
+    EXPECT_EQ(service.available_count(show), 18);
+    std::remove(path.c_str());
+}
+
+TEST(CommitLoop, PollAcknowledgesOnlyUpToTheHorizon) {
+    const std::string path = temp_path("async_booking_horizon.log");
+    BookingService service;
+    ASSERT_EQ(service.open_journal(path, JournalMode::Sync), JournalStatus::Ok);
+    const ShowId show = service.find_show(1, 1);
+
+    CommitLoop loop(service);
+    loop.set_horizon([] { return std::uint64_t{0}; }); // e.g. no replica has acknowledged yet
+    int booked = 0;
+    for (int seat = 0; seat < 4; ++seat) loop.spawn(book_one(loop, service, show, seat, booked));
+    EXPECT_EQ(loop.pending(), 4u);
+    EXPECT_EQ(loop.poll(), 0u);
+    EXPECT_EQ(booked, 0);
+    loop.run(); // blocks on the journal itself
+    EXPECT_EQ(booked, 4);
+    std::remove(path.c_str());
+}
+
+TEST(CommitLoop, CompletesInlineWithoutASyncJournal) {
+    BookingService service;
+    const ShowId show = service.find_show(1, 1);
+    CommitLoop loop(service);
+    int booked = 0;
+    loop.spawn(book_one(loop, service, show, 5, booked));
+    EXPECT_EQ(booked, 1);
+    EXPECT_EQ(loop.active(), 0u);
+    bool committed = false;
+    loop.spawn([](CommitLoop& l, bool& done) -> Task<void> { done = co_await l.commit(0); }(loop, committed));
+    EXPECT_TRUE(committed);
+}
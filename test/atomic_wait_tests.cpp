@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include "atomic_wait.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using booking::atomic_notify_all;
+using booking::atomic_wait;
+using namespace std::chrono_literals;
+
+TEST(AtomicWait, ReturnsAtOnceWhenTheValueDiffers) {
+    std::atomic<std::uint32_t> word{3};
+    atomic_wait(word, 2u);
+    std::atomic<std::int64_t> wide{-1};
+    atomic_wait(wide, std::int64_t{0});
+    atomic_notify_all(word); // nobody waits: a load and no wakeup
+}
+
+TEST(AtomicWait, WakesFutexAndParkedWaiters) {
+    std::atomic<std::uint32_t> word{0}; // futex on Linux
+    std::atomic<std::int64_t> wide{0}; // parking lot
+    std::atomic<std::uint8_t> narrow{0}; // parking lot
+    std::atomic<int> woken{0};
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 2; ++i) {
+        waiters.emplace_back([&] { atomic_wait(word, 0u); ++woken; });
+        waiters.emplace_back([&] { atomic_wait(wide, std::int64_t{0}); ++woken; });
+        waiters.emplace_back([&] { atomic_wait(narrow, std::uint8_t{0}); ++woken; });
+    }
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(woken, 0);
+    word.store(1u, std::memory_order_release);
+    atomic_notify_all(word);
+    wide.store(7, std::memory_order_release);
+    atomic_notify_all(wide);
+    narrow.store(1u, std::memory_order_release);
+    atomic_notify_all(narrow);
+    for (std::thread& t : waiters) t.join();
+    EXPECT_EQ(woken, 6);
+}
+
+TEST(AtomicWait, WaiterMayFreeTheAtomicBeforeTheNotify) {
+    // The ShowExecutor pattern: the caller frees the word as soon as it sees the store
+    for (int round = 0; round < 200; ++round) {
+        auto done = std::make_unique<std::atomic<std::uint32_t>>(0u);
+        std::atomic<std::uint32_t>* raw = done.get();
+        std::thread worker([raw] {
+            raw->store(1u, std::memory_order_release);
+            atomic_notify_all(*raw);
+        });
+        atomic_wait(*done, 0u);
+        done.reset();
+        worker.join();
+    }
+}
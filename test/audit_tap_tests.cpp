@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include "audit_tap.hpp"
+#include "booking_service.hpp"
+
+#include <sys/stat.h>
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using booking::AuditBatch;
+using booking::AuditTap;
+using booking::AuditTapOptions;
+using booking::BookingService;
+using booking::Journal;
+using booking::JournalMode;
+using booking::JournalOp;
+using booking::JournalRecord;
+using booking::JournalStatus;
+using booking::SeatMask;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::string temp_path(const char* name) {
+    const std::string path = ::testing::TempDir() + name;
+    std::remove(path.c_str());
+    return path;
+}
+
+/** @brief Sink that decodes what it accepts, refusing batches while @ref open is false. */
+struct RecordingSink {
+    std::mutex mutex;
+    std::vector<JournalRecord> records;
+    std::atomic<bool> open{true};
+
+    booking::AuditSink sink() {
+        return [this](const AuditBatch& batch) {
+            if (!open.load()) return false;
+            std::lock_guard<std::mutex> lock(mutex);
+            EXPECT_TRUE(booking::decode_audit_batch(batch.payload.data(), batch.payload.size(), records));
+            return true;
+        };
+    }
+};
+
+SeatMask seat(int index) {
+    SeatMask m;
+    m.set(index);
+    return m;
+}
+
+/** @brief Expects bookings 1..n of seat (id % 64) in LSN order. */
+void expect_bookings(const std::vector<JournalRecord>& records, std::uint32_t n) {
+    ASSERT_EQ(records.size(), n);
+    for (std::uint32_t i = 0; i < n; ++i) {
+        EXPECT_EQ(records[i].booking_id, i + 1u);
+        EXPECT_EQ(records[i].seats.count(), 1);
+        EXPECT_TRUE(records[i].seats.test(static_cast<int>((i + 1u) % 64u)));
+        if (i != 0u) {
+            EXPECT_EQ(records[i].lsn, records[i - 1u].end_lsn);
+        }
+    }
+}
+
+} // namespace
+
+TEST(AuditTap, ShipsEveryCommittedRecordInOrderSmallerThanTheJournal) {
+    RecordingSink sink;
+    AuditTap tap(sink.sink());
+    BookingService svc;
+    ASSERT_EQ(svc.open_journal(temp_path("audit_service.journal"), JournalMode::None), JournalStatus::Ok);
+    ASSERT_TRUE(svc.set_journal_tap(tap.journal_tap()));
+
+    const booking::ShowId show = svc.find_show(1, 1);
+    const auto first = svc.book_seats(show, {"a1", "a2"});
+    const auto second = svc.book_seats(show, {"a3"});
+    ASSERT_TRUE(first.success && second.success);
+    ASSERT_TRUE(svc.cancel_seats(show, {"a1"}, first.id).success);
+    ASSERT_TRUE(svc.sync_journal());
+    ASSERT_TRUE(tap.flush(5s));
+
+    ASSERT_EQ(sink.records.size(), 3u);
+    EXPECT_EQ(sink.records[0].op, JournalOp::Book);
+    EXPECT_EQ(sink.records[0].show_id, show);
+    EXPECT_EQ(sink.records[0].booking_id, first.id);
+    EXPECT_EQ(sink.records[0].seats.count(), 2);
+    EXPECT_EQ(sink.records[1].booking_id, second.id);
+    EXPECT_EQ(sink.records[2].op, JournalOp::Cancel);
+    EXPECT_EQ(sink.records[2].seats.count(), 1);
+    EXPECT_EQ(sink.records[2].lsn, sink.records[1].end_lsn);
+
+    const booking::AuditStats stats = tap.stats();
+    EXPECT_EQ(stats.records, 3u);
+    EXPECT_EQ(stats.delivered_lsn, sink.records[2].end_lsn);
+    EXPECT_LT(stats.payload_bytes * 2u, stats.raw_bytes);
+    EXPECT_EQ(stats.spilled_bytes + stats.dropped_bytes, 0u);
+}
+
+TEST(AuditTap, SlowSinkSpillsWithoutBlockingTheJournalAndKeepsOrder) {
+    RecordingSink sink;
+    sink.open = false;
+    AuditTapOptions options;
+    options.ring_bytes = 1024; // a few dozen records
+    options.batch_bytes = 2048;
+    options.retry = 1ms;
+    options.spill_path = temp_path("audit_spill.bin");
+    AuditTap tap(sink.sink(), options);
+    ASSERT_TRUE(tap.spill_open());
+
+    Journal journal;
+    ASSERT_EQ(journal.open(temp_path("audit_spill.journal"), JournalMode::None), JournalStatus::Ok);
+    journal.set_commit_tap(tap.journal_tap());
+    for (std::uint32_t id = 1; id <= 500; ++id) {
+        journal.append(JournalOp::Book, booking::ShowId(7), id, seat(static_cast<int>(id % 64u)));
+        if (id % 50u == 0u) {
+            ASSERT_TRUE(journal.sync()); // commits while the sink is down
+        }
+    }
+    EXPECT_FALSE(tap.flush(20ms));
+    EXPECT_GT(tap.stats().spilled_bytes, 0u);
+    EXPECT_GT(tap.stats().sink_failures, 0u);
+
+    sink.open = true;
+    ASSERT_TRUE(tap.flush(10s));
+    expect_bookings(sink.records, 500);
+    EXPECT_EQ(tap.stats().dropped_bytes, 0u);
+
+    // Caught up: new records take the ring again
+    const std::uint64_t spilled = tap.stats().spilled_bytes;
+    journal.append(JournalOp::Book, booking::ShowId(7), 501, seat(501 % 64));
+    ASSERT_TRUE(journal.sync());
+    ASSERT_TRUE(tap.flush(5s));
+    expect_bookings(sink.records, 501);
+    EXPECT_EQ(tap.stats().spilled_bytes, spilled);
+}
+
+TEST(AuditTap, UndeliveredRecordsWaitInTheSpillFileForTheNextTap) {
+    AuditTapOptions options;
+    options.ring_bytes = 512;
+    options.spill_path = temp_path("audit_restart.bin");
+    const std::string log = temp_path("audit_restart.log");
+    {
+        RecordingSink down;
+        down.open = false;
+        AuditTap tap(down.sink(), options);
+        Journal journal;
+        ASSERT_EQ(journal.open(temp_path("audit_restart.journal"), JournalMode::None), JournalStatus::Ok);
+        journal.set_commit_tap(tap.journal_tap());
+        for (std::uint32_t id = 1; id <= 50; ++id) {
+            journal.append(JournalOp::Book, booking::ShowId(3), id, seat(static_cast<int>(id % 64u)));
+        }
+        ASSERT_TRUE(journal.sync());
+    } // the journal stops first, then the tap keeps what the sink refused
+
+    {
+        AuditTap tap(booking::audit_file_sink(log), options);
+        ASSERT_TRUE(tap.flush(5s));
+    }
+    std::vector<JournalRecord> records;
+    ASSERT_TRUE(booking::read_audit_file(log, records));
+    expect_bookings(records, 50);
+
+    struct stat st {};
+    ASSERT_EQ(::stat(options.spill_path.c_str(), &st), 0);
+    EXPECT_EQ(st.st_size, 0); // delivered: nothing left to resend
+}
+
+TEST(AuditTap, WithoutASpillFileAFullRingDropsAndCounts) {
+    RecordingSink sink;
+    sink.open = false;
+    AuditTapOptions options;
+    options.ring_bytes = 256;
+    AuditTap tap(sink.sink(), options);
+    EXPECT_FALSE(tap.spill_open());
+
+    Journal journal;
+    ASSERT_EQ(journal.open(temp_path("audit_drop.journal"), JournalMode::None), JournalStatus::Ok);
+    journal.set_commit_tap(tap.journal_tap());
+    for (std::uint32_t id = 1; id <= 100; ++id) {
+        journal.append(JournalOp::Book, booking::ShowId(1), id, seat(static_cast<int>(id % 64u)));
+        ASSERT_TRUE(journal.sync());
+    }
+    EXPECT_GT(tap.stats().dropped_bytes, 0u);
+    EXPECT_EQ(tap.stats().records, 0u);
+    sink.open = true;
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include "availability_codec.hpp"
+#include "booking_service.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::HallLayout;
+using booking::SeatEncoding;
+using booking::SeatMask;
+
+namespace {
+
+std::string encode(const HallLayout& layout, const std::vector<std::uint64_t>& words, SeatEncoding encoding) {
+    std::string out(booking::max_encoded_size(layout, encoding), '\0');
+    char* const end =
+        booking::encode_free_seats(layout, words.data(), static_cast<int>(words.size()), encoding, &out[0]);
+    out.resize(static_cast<std::size_t>(end - out.data()));
+    return out;
+}
+
+} // namespace
+
+TEST(AvailabilityCodec, EncodesBitmapsRunsAndLabels) {
+    const HallLayout layout = HallLayout::uniform(2, 10);
+    // Row a: seats 1-3 and 10 free; row b: all free (bits past the row are ignored)
+    const std::vector<std::uint64_t> words{0x207u, ~std::uint64_t{0}};
+
+    const std::string bitmap = encode(layout, words, SeatEncoding::Bitmap);
+    EXPECT_EQ(bitmap, std::string("\x07\x02\xff\x03", 4));
+    EXPECT_EQ(bitmap.size(), booking::max_encoded_size(layout, SeatEncoding::Bitmap));
+
+    const std::string runs = encode(layout, words, SeatEncoding::Runs);
+    EXPECT_EQ(runs, std::string("\x00\x00\x03\x00\x09\x01\x01\x00\x0a", 9));
+
+    EXPECT_EQ(encode(layout, words, SeatEncoding::Labels), "a1,a2,a3,a10,b1,b2,b3,b4,b5,b6,b7,b8,b9,b10");
+    EXPECT_EQ(encode(layout, {0u, 0u}, SeatEncoding::Runs), "");
+}
+
+TEST(AvailabilityCodec, RoundTripsAndBoundsEveryPattern) {
+    const HallLayout layout = HallLayout::uniform(3, 64);
+    const std::vector<std::vector<std::uint64_t>> patterns{
+        {0u, 0u, 0u},
+        {~std::uint64_t{0}, ~std::uint64_t{0}, ~std::uint64_t{0}},
+        {0x5555555555555555u, 0xAAAAAAAAAAAAAAAAu, 0x8000000000000001u},
+    };
+    for (const auto& words : patterns) {
+        for (const SeatEncoding encoding : {SeatEncoding::Bitmap, SeatEncoding::Runs}) {
+            const std::string payload = encode(layout, words, encoding);
+            EXPECT_LE(payload.size(), booking::max_encoded_size(layout, encoding)) << booking::to_string(encoding);
+            SeatMask back;
+            ASSERT_TRUE(booking::decode_free_seats(layout, encoding, payload.data(), payload.size(), back));
+            for (int r = 0; r < 3; ++r) EXPECT_EQ(back.word(r), words[static_cast<std::size_t>(r)]);
+        }
+        EXPECT_LE(encode(layout, words, SeatEncoding::Labels).size(),
+                  booking::max_encoded_size(layout, SeatEncoding::Labels));
+    }
+}
+
+TEST(AvailabilityCodec, RejectsMalformedPayloads) {
+    const HallLayout layout = HallLayout::uniform(2, 10);
+    SeatMask out;
+    EXPECT_FALSE(booking::decode_free_seats(layout, SeatEncoding::Runs, "\x00\x00", 2, out));
+    EXPECT_FALSE(booking::decode_free_seats(layout, SeatEncoding::Runs, "\x02\x00\x01", 3, out));     // no row c
+    EXPECT_FALSE(booking::decode_free_seats(layout, SeatEncoding::Runs, "\x00\x08\x03", 3, out));     // past a10
+    EXPECT_FALSE(booking::decode_free_seats(layout, SeatEncoding::Bitmap, "\x00\x04", 2, out));      // a11
+    EXPECT_FALSE(booking::decode_free_seats(layout, SeatEncoding::Bitmap, "\x00\x00\x00\x00\x00", 5, out));
+    EXPECT_FALSE(booking::decode_free_seats(layout, SeatEncoding::Labels, "a1", 2, out));
+}
+
+TEST(AvailabilityCodec, BlobIndexesEveryShowsPayload) {
+    booking::BookingService svc;
+    ASSERT_TRUE(svc.book_seats(2, {"a1", "a2", "a3"}).success);
+    ASSERT_TRUE(svc.hold_seats(4, {"a7"}, std::chrono::minutes(1)).success);
+
+    for (SeatEncoding encoding : {SeatEncoding::Bitmap, SeatEncoding::Runs}) {
+        std::string blob;
+        const std::uint64_t version = svc.encode_availability_blob(blob, encoding);
+        EXPECT_EQ(version, svc.availability_version());
+        booking::AvailabilityBlobIndex index;
+        ASSERT_TRUE(booking::read_availability_blob(blob.data(), blob.size(), index));
+        EXPECT_EQ(index.version, version);
+        EXPECT_EQ(index.encoding, encoding);
+        ASSERT_EQ(index.shows.size(), 4u);
+        for (std::size_t i = 0; i < index.shows.size(); ++i) {
+            const booking::AvailabilityBlobEntry& e = index.shows[i];
+            EXPECT_EQ(e.show_id, static_cast<std::int64_t>(i + 1u));
+            const HallLayout* layout = svc.layout_for_show(e.show_id);
+            SeatMask decoded;
+            ASSERT_TRUE(booking::decode_free_seats(*layout, encoding, blob.data() + e.offset, e.size, decoded));
+            SeatMask expected;
+            svc.available_seats_mask(e.show_id, expected);
+            EXPECT_EQ(decoded.word(0), expected.word(0)) << e.show_id;
+        }
+        EXPECT_EQ(index.shows[0].changes, 0u);
+        EXPECT_GT(index.shows[1].changes, 0u);
+    }
+
+    std::string blob;
+    svc.encode_availability_blob(blob);
+    booking::AvailabilityBlobIndex index;
+    blob.back() ^= 1; // a flipped payload bit fails the checksum
+    EXPECT_FALSE(booking::read_availability_blob(blob.data(), blob.size(), index));
+    EXPECT_FALSE(booking::read_availability_blob(blob.data(), 16, index));
+}
+
+TEST(AvailabilityCodec, ExportKeepsTheBlobCurrent) {
+    booking::BookingService svc;
+    const std::string path = ::testing::TempDir() + "availability.blob";
+    std::atomic<std::uint64_t> pushed{0};
+    booking::AvailabilityExportOptions options;
+    options.path = path;
+    options.push = [&](const std::string& blob, std::uint64_t version) {
+        booking::AvailabilityBlobIndex index;
+        EXPECT_TRUE(booking::read_availability_blob(blob.data(), blob.size(), index));
+        EXPECT_EQ(index.version, version);
+        pushed.store(version);
+    };
+    options.interval = std::chrono::milliseconds(1);
+    ASSERT_EQ(svc.set_availability_export(options), booking::SnapshotStatus::Ok);
+    ASSERT_TRUE(svc.book_seats(1, {"a9"}).success);
+    const std::uint64_t seen = pushed.load();
+    while (pushed.load() < seen + 2u) std::this_thread::yield();
+    ASSERT_EQ(svc.set_availability_export(booking::AvailabilityExportOptions{}), booking::SnapshotStatus::Ok);
+
+    std::ifstream in(path, std::ios::binary);
+    const std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    booking::AvailabilityBlobIndex index;
+    ASSERT_TRUE(booking::read_availability_blob(file.data(), file.size(), index));
+    EXPECT_EQ(index.version, pushed.load());
+    EXPECT_GT(index.shows[0].changes, 0u);
+
+    options.path = ::testing::TempDir() + "missing-dir/availability.blob";
+    options.push = nullptr;
+    EXPECT_EQ(svc.set_availability_export(options), booking::SnapshotStatus::IoError);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include "availability_views.hpp"
+#include "booking_service.hpp"
+
+#include <string>
+#include <vector>
+
+using booking::AvailabilityViews;
+using booking::BookingService;
+using booking::CatalogStatus;
+using booking::RankedShow;
+using booking::ShowId;
+
+namespace {
+
+std::vector<ShowId> ids(const std::vector<RankedShow>& shows) {
+    std::vector<ShowId> out;
+    for (const RankedShow& s : shows) out.push_back(s.show_id);
+    return out;
+}
+
+/** @brief 2 rows of 10: row a at 1000, row b at 3000. */
+booking::HallLayout two_price_hall() {
+    booking::HallLayout l = booking::HallLayout::uniform(2, 10);
+    booking::PriceTier front{"front", 1000, {}};
+    front.seats[0] = 0x3FFu;
+    booking::PriceTier back{"back", 3000, {}};
+    back.seats[1] = 0x3FFu;
+    l.set_price_tiers({front, back});
+    return l;
+}
+
+std::vector<std::string> row_labels(char row) {
+    std::vector<std::string> out;
+    for (int s = 1; s <= 10; ++s) out.push_back(std::string(1, row) + std::to_string(s));
+    return out;
+}
+
+} // namespace
+
+TEST(AvailabilityViews, KeepsBothOrderingsPerMovie) {
+    AvailabilityViews views;
+    views.add_show(1, 7, 10, 500);
+    views.add_show(2, 7, 30, 900);
+    views.add_show(3, 7, 30, RankedShow::kNoPrice);
+    views.add_show(4, 8, 99, 100);
+    EXPECT_EQ(views.size(), 4u);
+
+    EXPECT_EQ(ids(views.by_seats_left(7, 10)), (std::vector<ShowId>{2, 3, 1}));
+    EXPECT_EQ(ids(views.by_cheapest_seat(7, 10)), (std::vector<ShowId>{1, 2})); // show 3 sells nothing
+    EXPECT_EQ(ids(views.by_seats_left(7, 1)), (std::vector<ShowId>{2}));
+
+    EXPECT_TRUE(views.update(1, 40, 950));
+    EXPECT_EQ(ids(views.by_seats_left(7, 10)), (std::vector<ShowId>{1, 2, 3}));
+    EXPECT_EQ(ids(views.by_cheapest_seat(7, 10)), (std::vector<ShowId>{2, 1}));
+    EXPECT_EQ(views.by_seats_left(7, 1)[0].seats_left, 40);
+    EXPECT_FALSE(views.update(99, 1, 1));
+
+    EXPECT_TRUE(views.remove_show(2));
+    EXPECT_FALSE(views.remove_show(2));
+    EXPECT_FALSE(views.contains(2));
+    EXPECT_EQ(ids(views.by_cheapest_seat(7, 10)), (std::vector<ShowId>{1}));
+    EXPECT_TRUE(views.remove_show(4));
+    EXPECT_TRUE(views.by_seats_left(8, 10).empty());
+    EXPECT_TRUE(views.by_seats_left(9, 10).empty());
+}
+
+TEST(AvailabilityViews, ServiceFollowsBookingsThroughTheChangeFeed) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    EXPECT_TRUE(svc.shows_by_seats_left(1, 10).empty()); // not enabled
+    EXPECT_EQ(svc.refresh_availability_views(), 0u);
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), CatalogStatus::Ok);
+    const booking::LayoutId priced = svc.add_layout(two_price_hall());
+    const booking::LayoutId plain = svc.add_layout(booking::HallLayout::uniform(1, 12));
+    ASSERT_EQ(svc.add_show(booking::Show{10, 1, 1, priced}), CatalogStatus::Ok);
+    ASSERT_TRUE(svc.book_seats(10, {"b1", "b2"}).success); // before the views exist
+
+    svc.enable_availability_views();
+    ASSERT_NE(svc.change_feed(), nullptr);
+    ASSERT_NE(svc.availability_views(), nullptr);
+    ASSERT_EQ(svc.add_show(booking::Show{11, 1, 1, plain}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(booking::Show{12, 1, 1, priced}), CatalogStatus::Ok);
+
+    EXPECT_EQ(ids(svc.shows_by_seats_left(1, 10)), (std::vector<ShowId>{12, 10, 11}));
+    EXPECT_EQ(ids(svc.shows_by_cheapest_seat(1, 10)), (std::vector<ShowId>{11, 10, 12}));
+
+    // Sell out the front row of show 12 and most of show 11
+    ASSERT_TRUE(svc.book_seats(12, row_labels('a')).success);
+    for (int s = 1; s <= 11; ++s) ASSERT_TRUE(svc.book_seats(11, {"a" + std::to_string(s)}).success);
+    const auto by_seats = svc.shows_by_seats_left(1, 10);
+    EXPECT_EQ(ids(by_seats), (std::vector<ShowId>{10, 12, 11}));
+    EXPECT_EQ(by_seats[0].seats_left, 18);
+    EXPECT_EQ(by_seats[2].seats_left, 1);
+    const auto by_price = svc.shows_by_cheapest_seat(1, 10);
+    EXPECT_EQ(ids(by_price), (std::vector<ShowId>{11, 10, 12}));
+    EXPECT_EQ(by_price[1].cheapest_price, 1000u);
+    EXPECT_EQ(by_price[2].cheapest_price, 3000u);
+
+    // Sold out: no cheapest seat, still listed by seats left
+    ASSERT_TRUE(svc.book_seats(11, {"a12"}).success);
+    EXPECT_EQ(ids(svc.shows_by_cheapest_seat(1, 10)), (std::vector<ShowId>{10, 12}));
+    EXPECT_EQ(svc.shows_by_seats_left(1, 10).back().seats_left, 0);
+
+    ASSERT_EQ(svc.remove_show(10), CatalogStatus::Ok);
+    ASSERT_TRUE(svc.book_seats(10, {"a1"}).success); // the state outlives the catalog entry
+    EXPECT_EQ(ids(svc.shows_by_seats_left(1, 10)), (std::vector<ShowId>{12, 11}));
+    EXPECT_EQ(svc.refresh_availability_views(), 0u);
+}
+
+TEST(AvailabilityViews, GapInTheFeedResyncsEveryShow) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(4, 10));
+    for (int id = 1; id <= 3; ++id) ASSERT_EQ(svc.add_show(booking::Show{id, 1, 1, hall}), CatalogStatus::Ok);
+    svc.enable_availability_views(4); // a tiny ring: the bookings below overrun it
+
+    for (const char row : {'a', 'b', 'c'}) ASSERT_TRUE(svc.book_seats(2, row_labels(row)).success);
+    ASSERT_TRUE(svc.book_seats(3, row_labels('a')).success);
+    ASSERT_TRUE(svc.book_seats(1, {"d1"}).success);
+    for (int s = 2; s <= 9; ++s) ASSERT_TRUE(svc.book_seats(3, {"b" + std::to_string(s)}).success);
+
+    EXPECT_EQ(svc.refresh_availability_views(), 3u);
+    const auto shows = svc.shows_by_seats_left(1, 10);
+    EXPECT_EQ(ids(shows), (std::vector<ShowId>{1, 3, 2}));
+    EXPECT_EQ(shows[0].seats_left, 39);
+    EXPECT_EQ(shows[1].seats_left, 22);
+    EXPECT_EQ(shows[2].seats_left, 10);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using booking::ArchivedShow;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::CatalogStatus;
+using booking::Movie;
+using booking::Show;
+using booking::Theater;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr booking::ShowTime kHour = 3600;
+
+} // namespace
+
+TEST(Archive, MovesPlayedShowsToColdStorage) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{1, "Central"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{2, "Mall"}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(8, 10));
+    ASSERT_EQ(svc.add_show(Show{1, 1, 1, hall, 10 * kHour, 3}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{2, 1, 2, hall, 11 * kHour}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{3, 1, 1, hall, 20 * kHour}), CatalogStatus::Ok);
+
+    const auto first = svc.book_seats(1, {"a1", "a2"});
+    const auto second = svc.book_seats(1, {"h10"});
+    ASSERT_TRUE(first.success);
+    ASSERT_TRUE(second.success);
+    ASSERT_TRUE(svc.hold_seats(1, {"b1"}, 10s).success); // never confirmed: released, not archived
+    ASSERT_TRUE(svc.book_seats(3, {"a1"}).success);
+
+    EXPECT_EQ(svc.archive_shows_before(12 * kHour), 2u);
+    EXPECT_EQ(svc.archive_shows_before(12 * kHour), 0u);
+
+    // Gone from the catalog and from booking...
+    EXPECT_EQ(svc.find_show(1, 2), -1);
+    EXPECT_EQ(svc.find_show(1, 1), 3);
+    EXPECT_EQ(svc.list_theaters_for_movie(1).size(), 1u);
+    EXPECT_EQ(svc.book_seats(1, {"c1"}).status, BookingStatus::InvalidShow);
+    EXPECT_EQ(svc.available_count(1), -1);
+    EXPECT_EQ(svc.add_show(Show{1, 1, 1, hall}), CatalogStatus::DuplicateId);
+    EXPECT_EQ(svc.available_count(3), 79); // the later show is untouched
+
+    // ...and kept in cold storage with its final bookings
+    const booking::ColdShowStore& cold = svc.cold_shows();
+    EXPECT_EQ(cold.ids(), (std::vector<booking::ShowId>{1, 2}));
+    ArchivedShow played;
+    ASSERT_TRUE(cold.find(1, played));
+    EXPECT_EQ(played.show.theater_id, 1);
+    EXPECT_EQ(played.show.start_time, 10 * kHour);
+    EXPECT_EQ(played.show.hall, 3);
+    EXPECT_EQ(played.seat_count, 80);
+    ASSERT_EQ(played.bookings.size(), 2u);
+    EXPECT_EQ(played.bookings[0].id, first.id);
+    EXPECT_EQ(played.bookings[0].seats, (std::vector<int>{0, 1}));
+    EXPECT_EQ(played.bookings[1].id, second.id);
+    EXPECT_EQ(played.bookings[1].seats, (std::vector<int>{booking::HallLayout::seat_index(7, 9)}));
+    EXPECT_EQ(played.booked_seats(), 3);
+    ASSERT_TRUE(cold.find(2, played));
+    EXPECT_TRUE(played.bookings.empty());
+    EXPECT_FALSE(cold.find(3, played));
+}
+
+TEST(Archive, ColdStoreRoundTripsCompactly) {
+    booking::ColdShowStore store;
+    ArchivedShow show;
+    show.show = Show{42, 7, 3, 1, -5, 2};
+    show.seat_count = 200;
+    for (int b = 0; b < 50; ++b) {
+        show.bookings.push_back(booking::ArchivedBooking{1000000u + 3u * static_cast<unsigned>(b), {4 * b, 4 * b + 1}});
+    }
+    ASSERT_TRUE(store.add(show));
+    EXPECT_FALSE(store.add(show));
+    EXPECT_TRUE(store.contains(42));
+    EXPECT_EQ(store.size(), 1u);
+    // A few bytes per booking instead of an id and a seat mask
+    EXPECT_LT(store.bytes(), 50u * 6u + 16u);
+
+    ArchivedShow back;
+    ASSERT_TRUE(store.find(42, back));
+    EXPECT_EQ(back.show.start_time, -5);
+    EXPECT_EQ(back.show.movie_id, 7);
+    EXPECT_EQ(back.seat_count, 200);
+    ASSERT_EQ(back.bookings.size(), show.bookings.size());
+    for (std::size_t i = 0; i < show.bookings.size(); ++i) {
+        EXPECT_EQ(back.bookings[i].id, show.bookings[i].id);
+        EXPECT_EQ(back.bookings[i].seats, show.bookings[i].seats);
+    }
+    EXPECT_EQ(back.booked_seats(), 100);
+}
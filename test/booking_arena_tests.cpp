@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::SeatMask;
+using booking::ShowId;
+
+namespace {
+
+std::uint64_t bits(int rows) { return rows >= 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << rows) - 1u; }
+
+SeatMask whole_row(int row, int seats) {
+    SeatMask m;
+    m.or_word(row, bits(seats));
+    return m;
+}
+
+} // namespace
+
+TEST(ArenaRows, SummaryTracksFullRows) {
+    BookingService svc(HallLayout::uniform(40, 60)); // 2,400 seats
+    const ShowId show = svc.find_show(1, 1);
+    EXPECT_EQ(svc.rows_with_free_seats(show), bits(40));
+
+    // Fill every row but the last one
+    for (int r = 0; r < 39; ++r) ASSERT_TRUE(svc.book_seat_mask(show, whole_row(r, 60)).success) << r;
+    EXPECT_EQ(svc.rows_with_free_seats(show), std::uint64_t{1} << 39);
+
+    SeatMask got;
+    const BookingResult best = svc.book_best_available(show, 4, got);
+    ASSERT_TRUE(best.success);
+    EXPECT_EQ(got.first_word(), 39); // the only row the search loaded
+    EXPECT_EQ(svc.book_best_available(show, 57, got).status, BookingStatus::NoContiguousSeats);
+
+    EXPECT_EQ(svc.rows_with_free_seats(99999), 0u);
+}
+
+TEST(ArenaRows, CancellationsReopenRows) {
+    BookingService svc(HallLayout::uniform(8, 10));
+    const ShowId show = svc.find_show(1, 1);
+    std::vector<booking::BookingId> ids;
+    for (int r = 0; r < 8; ++r) {
+        const BookingResult res = svc.book_seat_mask(show, whole_row(r, 10));
+        ASSERT_TRUE(res.success);
+        ids.push_back(res.id);
+    }
+    EXPECT_EQ(svc.rows_with_free_seats(show), 0u);
+    ASSERT_TRUE(svc.cancel_seats(show, {"c5"}, ids[2]).success);
+    EXPECT_EQ(svc.rows_with_free_seats(show), std::uint64_t{1} << 2);
+    SeatMask got;
+    ASSERT_TRUE(svc.book_best_available(show, 1, got).success);
+    EXPECT_EQ(got.first_word(), 2);
+
+    // Small halls compute the rows from their words
+    BookingService small(HallLayout::uniform(3, 10));
+    const ShowId small_show = small.find_show(1, 1);
+    ASSERT_TRUE(small.book_seat_mask(small_show, whole_row(1, 10)).success);
+    EXPECT_EQ(small.rows_with_free_seats(small_show), 0b101u);
+}
+
+TEST(ArenaRows, SummaryConvergesUnderRacingBookings) {
+    BookingService svc(HallLayout::uniform(16, 8));
+    const ShowId show = svc.find_show(1, 1);
+    // Each thread repeatedly fills and frees its own seats of every row
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            SeatMask mine;
+            for (int r = 0; r < 16; ++r) mine.or_word(r, std::uint64_t{3} << (2 * t));
+            for (int i = 0; i < 500; ++i) {
+                const BookingResult res = svc.book_seat_mask(show, mine);
+                ASSERT_TRUE(res.success);
+                std::vector<std::string> labels;
+                for (int r = 0; r < 16; ++r) {
+                    for (int c = 2 * t; c < 2 * t + 2; ++c) {
+                        labels.push_back(std::string(1, static_cast<char>('a' + r)) + std::to_string(c + 1));
+                    }
+                }
+                ASSERT_TRUE(svc.cancel_seats(show, labels, res.id).success);
+            }
+            if (t % 2 == 0) {
+                ASSERT_TRUE(svc.book_seat_mask(show, mine).success); // threads 0 and 2 keep theirs
+            }
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    EXPECT_EQ(svc.rows_with_free_seats(show), bits(16));
+
+    SeatMask rest; // the seats of threads 1 and 3: every row full
+    for (int r = 0; r < 16; ++r) rest.or_word(r, 0xCCu);
+    ASSERT_TRUE(svc.book_seat_mask(show, rest).success);
+    EXPECT_EQ(svc.rows_with_free_seats(show), 0u);
+}
@@ -0,0 +1,265 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "sharded_booking_service.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using booking::BookingId;
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::BundleItem;
+using booking::SeatMask;
+using booking::ShardedBookingService;
+using booking::ShowId;
+
+namespace {
+
+/** @brief Seats @p bits of row 0. */
+SeatMask row0(std::uint64_t bits) {
+    SeatMask m;
+    m.or_word(0, bits);
+    return m;
+}
+
+} // namespace
+
+TEST(Bundle, BooksEveryShowOrNone) {
+    BookingService svc;
+    const ShowId s1 = svc.find_show(1, 1);
+    const ShowId s4 = svc.find_show(3, 2);
+    const int free1 = svc.available_count(s1);
+    const int free4 = svc.available_count(s4);
+
+    const BundleItem items[] = {{s4, row0(0x3u)}, {s1, row0(0xCu)}};
+    BookingId ids[2] = {};
+    const BookingResult r = svc.book_bundle(items, ids);
+    ASSERT_TRUE(r.success) << r.message();
+    EXPECT_NE(ids[0], 0u);
+    EXPECT_NE(ids[1], 0u);
+    EXPECT_NE(ids[0], ids[1]);
+    EXPECT_EQ(r.id, ids[0]);
+    EXPECT_EQ(svc.available_count(s4), free4 - 2);
+    EXPECT_EQ(svc.available_count(s1), free1 - 2);
+
+    // Each part is a booking of its own show
+    EXPECT_TRUE(svc.cancel_seat_mask(s1, items[1].seats, ids[1]).success);
+    EXPECT_EQ(svc.available_count(s1), free1);
+    EXPECT_EQ(svc.available_count(s4), free4 - 2);
+
+    // A taken seat in the second show releases what the first one took
+    ASSERT_TRUE(svc.book_seat_mask(s4, row0(0x10u)).success);
+    const BundleItem clash[] = {{s1, row0(0x1u)}, {s4, row0(0x30u)}};
+    BookingId clash_ids[2] = {};
+    const BookingResult lost = svc.book_bundle(clash, clash_ids);
+    EXPECT_EQ(lost.status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(lost.label_index, 1);
+    EXPECT_EQ(clash_ids[0], 0u);
+    EXPECT_EQ(svc.available_count(s1), free1);
+    EXPECT_EQ(svc.available_count(s4), free4 - 3);
+}
+
+TEST(Bundle, ValidatesEveryPartFirst) {
+    BookingService svc;
+    const ShowId s1 = svc.find_show(1, 1);
+    const int free1 = svc.available_count(s1);
+    BookingId ids[2] = {};
+
+    const BundleItem bad_show[] = {{s1, row0(0x1u)}, {999, row0(0x1u)}};
+    const BookingResult r1 = svc.book_bundle(bad_show, ids);
+    EXPECT_EQ(r1.status, BookingStatus::InvalidShow);
+    EXPECT_EQ(r1.label_index, 1);
+
+    SeatMask missing_row;
+    missing_row.or_word(booking::HallLayout::kMaxRows - 1, 1u); // a row the hall does not have
+    const BundleItem bad_seat[] = {{s1, row0(0x1u)}, {s1, missing_row}};
+    EXPECT_EQ(svc.book_bundle(bad_seat, ids).status, BookingStatus::InvalidSeatIndex);
+
+    const BundleItem empty_part[] = {{s1, SeatMask{}}};
+    EXPECT_EQ(svc.book_bundle(empty_part, ids).status, BookingStatus::NoSeats);
+    EXPECT_EQ(svc.book_bundle({}, ids).status, BookingStatus::NoSeats);
+    const BundleItem two[] = {{s1, row0(0x1u)}, {s1, row0(0x2u)}};
+    EXPECT_EQ(svc.book_bundle(two, booking::Span<BookingId>(ids, 1u)).status, BookingStatus::NoSeats);
+    EXPECT_EQ(svc.available_count(s1), free1);
+}
+
+TEST(Bundle, OverlappingBundlesNeverLeaveHalfBookings) {
+    BookingService svc;
+    const ShowId s1 = svc.find_show(1, 1);
+    const ShowId s4 = svc.find_show(3, 2);
+    const int free1 = svc.available_count(s1);
+    const int free4 = svc.available_count(s4);
+
+    // Both threads want the same two seats in both shows, listed in opposite orders
+    std::atomic<int> wins{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; ++t) {
+        threads.emplace_back([&, t] {
+            const BundleItem forward[] = {{s1, row0(0x3u)}, {s4, row0(0x3u)}};
+            const BundleItem backward[] = {{s4, row0(0x3u)}, {s1, row0(0x3u)}};
+            BookingId ids[2] = {};
+            const BookingResult r = svc.book_bundle(t == 0 ? forward : backward, ids);
+            if (r.success) wins.fetch_add(1);
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    EXPECT_LE(wins.load(), 1);
+    const int taken1 = free1 - svc.available_count(s1);
+    const int taken4 = free4 - svc.available_count(s4);
+    EXPECT_EQ(taken1, taken4);
+    EXPECT_EQ(taken1, 2 * wins.load());
+}
+
+TEST(Bundle, SpansShards) {
+    ShardedBookingService svc(3);
+    const ShowId s1 = 1;
+    const ShowId s2 = 2;
+    ASSERT_NE(svc.shard_of(s1), svc.shard_of(s2));
+    const int free1 = svc.available_count(s1);
+
+    const BundleItem items[] = {{s2, row0(0x1u)}, {s1, row0(0x1u)}};
+    BookingId ids[2] = {};
+    ASSERT_TRUE(svc.book_bundle(items, ids).success);
+    EXPECT_EQ(svc.available_count(s1), free1 - 1);
+
+    // The second show is now taken: the part booked in the first shard is cancelled again
+    const BundleItem again[] = {{s1, row0(0x2u)}, {s2, row0(0x1u)}};
+    BookingId again_ids[2] = {};
+    const BookingResult r = svc.book_bundle(again, again_ids);
+    EXPECT_EQ(r.status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(r.label_index, 1);
+    EXPECT_EQ(svc.available_count(s1), free1 - 1);
+}
+
+namespace {
+
+/** @brief A service with shows 1..@p shows of 4x10 halls; show @p companion_show (if any) has a wheelchair space at a1. */
+void add_bulk_shows(BookingService& svc, int shows, int companion_show = 0) {
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Gala"}), booking::CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Arena"}), booking::CatalogStatus::Ok);
+    const booking::LayoutId plain = svc.add_layout(booking::HallLayout::uniform(4, 10));
+    booking::HallLayout accessible = booking::HallLayout::uniform(4, 10);
+    booking::SeatCategories categories;
+    categories.wheelchair[0] = 0x1u;
+    categories.companion[0] = 0x2u;
+    accessible.set_seat_categories(categories);
+    const booking::LayoutId special = svc.add_layout(std::move(accessible));
+    for (int s = 1; s <= shows; ++s) {
+        const booking::Show show{s, 1, 1, s == companion_show ? special : plain, 3600 * s};
+        ASSERT_EQ(svc.add_show(show), booking::CatalogStatus::Ok);
+    }
+}
+
+} // namespace
+
+TEST(Bulk, BooksAPlanAcrossManyShows) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    add_bulk_shows(svc, 40);
+    // Two blocks per show (rows a and c), listed show-interleaved
+    std::vector<BundleItem> plan;
+    for (int s = 40; s >= 1; --s) plan.push_back({s, row0(0x3FFu)});
+    for (int s = 1; s <= 40; ++s) {
+        SeatMask c;
+        c.or_word(2, 0xFu);
+        plan.push_back({s, c});
+    }
+    std::vector<BookingId> ids(plan.size());
+    std::vector<std::pair<booking::BulkPhase, std::size_t>> events;
+    const BookingResult r = svc.book_bulk(plan, ids, [&](booking::BulkPhase phase, std::size_t done, std::size_t total) {
+        EXPECT_EQ(total, 40u);
+        events.emplace_back(phase, done);
+    });
+    ASSERT_TRUE(r.success) << r.message();
+    for (int s = 1; s <= 40; ++s) EXPECT_EQ(svc.available_count(s), 40 - 14) << s;
+    EXPECT_EQ(svc.seat_owner(7, booking::HallLayout::seat_index(2, 0)), ids[40 + 6]);
+    EXPECT_NE(ids[33], ids[40 + 6]); // one booking per part
+    EXPECT_TRUE(svc.cancel_seat_mask(7, plan[33].seats, ids[33]).success);
+
+    ASSERT_EQ(events.size(), 42u);
+    EXPECT_EQ(events.front(), std::make_pair(booking::BulkPhase::Validated, std::size_t{40}));
+    EXPECT_EQ(events[40], std::make_pair(booking::BulkPhase::Acquiring, std::size_t{40}));
+    EXPECT_EQ(events.back(), std::make_pair(booking::BulkPhase::Committed, std::size_t{40}));
+    EXPECT_STREQ(booking::to_string(booking::BulkPhase::RollingBack), "rolling-back");
+}
+
+TEST(Bulk, ValidatesThePlanBeforeWriting) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    add_bulk_shows(svc, 30);
+    ASSERT_TRUE(svc.book_seat_mask(20, row0(0x100u)).success);
+
+    std::vector<BundleItem> plan;
+    for (int s = 1; s <= 30; ++s) plan.push_back({s, row0(0x300u)});
+    std::vector<BookingId> ids(plan.size());
+    int calls = 0;
+    const auto count = [&](booking::BulkPhase, std::size_t, std::size_t) { ++calls; };
+    const BookingResult taken = svc.book_bulk(plan, ids, count);
+    EXPECT_EQ(taken.status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(taken.label_index, 19);
+    EXPECT_EQ(calls, 0); // failed in validation: nothing written, nothing to report
+
+    plan[19] = {20, row0(0x3u)};
+    plan.push_back({5, row0(0x201u)}); // overlaps the other part of show 5
+    ids.resize(plan.size());
+    EXPECT_EQ(svc.book_bulk(plan, ids).status, BookingStatus::DuplicateSeatLabel);
+    plan.back() = {99, row0(0x1u)};
+    EXPECT_EQ(svc.book_bulk(plan, ids).status, BookingStatus::InvalidShow);
+    EXPECT_EQ(svc.book_bulk({}, ids).status, BookingStatus::NoSeats);
+    for (int s = 1; s <= 30; ++s) EXPECT_EQ(svc.available_count(s), s == 20 ? 39 : 40);
+}
+
+TEST(Bulk, RollsBackEveryShowWhenOneFails) {
+    // Show 25's part books a companion seat without its wheelchair space: only the CAS sees it
+    BookingService svc{BookingService::EmptyCatalog{}};
+    add_bulk_shows(svc, 30, 25);
+    std::vector<BundleItem> plan;
+    for (int s = 1; s <= 30; ++s) plan.push_back({s, row0(0x6u)});
+    std::vector<BookingId> ids(plan.size());
+    std::size_t acquired = 0;
+    std::size_t released = 0;
+    const BookingResult r = svc.book_bulk(plan, ids, [&](booking::BulkPhase phase, std::size_t done, std::size_t) {
+        if (phase == booking::BulkPhase::Acquiring) acquired = done;
+        if (phase == booking::BulkPhase::RollingBack) released = done;
+    });
+    EXPECT_EQ(r.status, BookingStatus::CompanionSeatRule);
+    EXPECT_EQ(r.label_index, 24);
+    EXPECT_GE(acquired, 1u);
+    EXPECT_EQ(released + 1u, acquired); // every show taken was released
+    for (int s = 1; s <= 30; ++s) EXPECT_EQ(svc.available_count(s), 40) << s;
+    for (const BookingId id : ids) EXPECT_EQ(id, 0u);
+}
+
+TEST(Bulk, SpansShards) {
+    ShardedBookingService svc(3);
+    const ShowId s1 = 1;
+    const ShowId s2 = 2;
+    ASSERT_NE(svc.shard_of(s1), svc.shard_of(s2));
+    const int free1 = svc.available_count(s1);
+    const int free2 = svc.available_count(s2);
+
+    const BundleItem items[] = {{s2, row0(0x1u)}, {s1, row0(0x1u)}, {s1, row0(0x2u)}};
+    BookingId ids[3] = {};
+    std::size_t last_total = 0;
+    bool committed = false;
+    const BookingResult ok = svc.book_bulk(items, ids, [&](booking::BulkPhase phase, std::size_t, std::size_t total) {
+        last_total = total;
+        committed = committed || phase == booking::BulkPhase::Committed;
+    });
+    ASSERT_TRUE(ok.success) << ok.message();
+    EXPECT_TRUE(committed);
+    EXPECT_EQ(last_total, 2u);
+    EXPECT_EQ(svc.available_count(s1), free1 - 2);
+    EXPECT_TRUE(svc.cancel_seat_mask(s1, items[2].seats, ids[2]).success);
+
+    // Show 2's seat is taken now: show 1's part is cancelled again
+    const BundleItem again[] = {{s1, row0(0x4u)}, {s2, row0(0x1u)}};
+    BookingId again_ids[2] = {};
+    const BookingResult r = svc.book_bulk(again, again_ids);
+    EXPECT_EQ(r.status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(r.label_index, 1);
+    EXPECT_EQ(svc.available_count(s1), free1 - 1);
+    EXPECT_EQ(svc.available_count(s2), free2 - 1);
+}
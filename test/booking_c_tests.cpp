@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include "booking_c.h"
+#include "booking_service.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+
+using booking::BookingStatus;
+
+namespace {
+
+struct ServiceDeleter {
+    void operator()(booking_service* s) const { booking_service_destroy(s); }
+};
+using Service = std::unique_ptr<booking_service, ServiceDeleter>;
+
+int status(BookingStatus s) { return static_cast<int>(s); }
+
+} // namespace
+
+TEST(CAbi, BooksAndCancelsSeatMasks) {
+    Service svc(booking_service_create());
+    ASSERT_NE(svc, nullptr);
+    const int64_t show = booking_find_show(svc.get(), 1, 1);
+    ASSERT_GE(show, 0);
+    ASSERT_EQ(booking_show_rows(svc.get(), show), 1);
+    EXPECT_EQ(booking_available_count(svc.get(), show), 20);
+
+    const uint64_t a1_a2 = 0x3;
+    booking_result r;
+    ASSERT_EQ(booking_book_mask(svc.get(), show, &a1_a2, 1, &r), BOOKING_OK);
+    EXPECT_EQ(r.status, BOOKING_OK);
+    EXPECT_NE(r.id, 0u);
+    const auto id = static_cast<uint32_t>(r.id);
+
+    uint64_t free_words[1] = {};
+    EXPECT_EQ(booking_available_mask(svc.get(), show, free_words, 1), 18);
+    EXPECT_EQ(free_words[0], 0xFFFFCu);
+
+    // A conflict reports the taken seats in the caller's result
+    const uint64_t a2_a3 = 0x6;
+    EXPECT_EQ(booking_book_mask(svc.get(), show, &a2_a3, 1, &r), status(BookingStatus::AlreadyBooked));
+    EXPECT_EQ(r.conflicts[0], 0x2u);
+    EXPECT_EQ(r.conflicts[1], 0u);
+
+    EXPECT_EQ(booking_cancel_mask(svc.get(), show, &a1_a2, 1, id + 1, &r), status(BookingStatus::NotOwner));
+    EXPECT_EQ(booking_cancel_mask(svc.get(), show, &a1_a2, 1, id, nullptr), BOOKING_OK);
+    EXPECT_EQ(booking_available_count(svc.get(), show), 20);
+
+    // A bit past the layout's seats
+    const uint64_t a21 = uint64_t{1} << 20;
+    EXPECT_EQ(booking_book_mask(svc.get(), show, &a21, 1, &r), status(BookingStatus::InvalidSeatIndex));
+}
+
+TEST(CAbi, LabelsGoThroughCallerBuffers) {
+    Service svc(booking_service_create());
+    const int64_t show = booking_find_show(svc.get(), 1, 1);
+
+    const char request[] = "a1 a3 garbage-after-the-length";
+    booking_result r;
+    ASSERT_EQ(booking_book_labels(svc.get(), show, request, 5, &r), BOOKING_OK);
+
+    char small[8];
+    size_t length = 0;
+    EXPECT_EQ(booking_available_labels(svc.get(), show, small, sizeof(small), &length), BOOKING_E_BUFFER);
+    char text[128];
+    ASSERT_EQ(booking_available_labels(svc.get(), show, text, sizeof(text), &length), 18);
+    EXPECT_EQ(std::strlen(text), length);
+    EXPECT_EQ(std::string(text).rfind("a2 a4 a5", 0), 0u) << text;
+
+    ASSERT_EQ(booking_book_labels(svc.get(), show, "a1x", 3, &r), status(BookingStatus::InvalidSeatLabel));
+    EXPECT_EQ(r.label_index, 0);
+
+    char label[4];
+    EXPECT_EQ(booking_seat_label(svc.get(), show, 19, label, sizeof(label)), 3);
+    EXPECT_STREQ(label, "a20");
+    EXPECT_EQ(booking_seat_label(svc.get(), show, 19, label, 3), BOOKING_E_BUFFER);
+    EXPECT_EQ(booking_seat_label(svc.get(), show, 20, label, sizeof(label)), BOOKING_E_ARGUMENT);
+}
+
+TEST(CAbi, BestAvailableAndHolds) {
+    Service svc(booking_service_create());
+    const int64_t show = booking_find_show(svc.get(), 1, 1);
+
+    uint64_t seats[2] = {~uint64_t{0}, ~uint64_t{0}};
+    booking_result r;
+    ASSERT_EQ(booking_book_best_available(svc.get(), show, 3, seats, 2, &r), BOOKING_OK);
+    EXPECT_EQ(__builtin_popcountll(seats[0]), 3);
+    EXPECT_EQ(seats[1], 0u);
+
+    const uint64_t a20 = uint64_t{1} << 19;
+    ASSERT_EQ(booking_hold_mask(svc.get(), show, &a20, 1, 60000, &r), BOOKING_OK);
+    const uint64_t hold = r.id;
+    EXPECT_EQ(booking_available_count(svc.get(), show), 16);
+    ASSERT_EQ(booking_confirm_hold(svc.get(), hold, &r), BOOKING_OK);
+    EXPECT_NE(r.id, 0u);
+    EXPECT_EQ(booking_release_hold(svc.get(), hold, &r), status(BookingStatus::UnknownHold));
+    EXPECT_EQ(booking_available_count(svc.get(), show), 16);
+}
+
+TEST(CAbi, ReportsErrorsAsCodes) {
+    Service svc(booking_service_create());
+    const int64_t show = booking_find_show(svc.get(), 1, 1);
+    uint64_t words[BOOKING_MASK_WORDS + 1] = {1};
+
+    EXPECT_EQ(booking_available_count(nullptr, show), BOOKING_E_ARGUMENT);
+    EXPECT_EQ(booking_find_show(nullptr, 1, 1), -1);
+    EXPECT_EQ(booking_book_mask(svc.get(), show, words, BOOKING_MASK_WORDS + 1, nullptr), BOOKING_E_ARGUMENT);
+    EXPECT_EQ(booking_book_mask(svc.get(), show, nullptr, 1, nullptr), BOOKING_E_ARGUMENT);
+    EXPECT_EQ(booking_book_mask(svc.get(), show, nullptr, 0, nullptr), status(BookingStatus::NoSeats));
+
+    // Reads of an unknown show fail the call; bookings are rejected by the service
+    EXPECT_EQ(booking_available_mask(svc.get(), 424242, words, 1), BOOKING_E_UNKNOWN_SHOW);
+    EXPECT_EQ(booking_show_rows(svc.get(), 424242), BOOKING_E_UNKNOWN_SHOW);
+    EXPECT_EQ(booking_book_mask(svc.get(), 424242, words, 1, nullptr), status(BookingStatus::InvalidShow));
+
+    EXPECT_STREQ(booking_status_string(BOOKING_E_BUFFER), "Buffer too small");
+    EXPECT_STREQ(booking_status_string(status(BookingStatus::AlreadyBooked)),
+                 booking::to_string(BookingStatus::AlreadyBooked));
+    EXPECT_STREQ(booking_status_string(1000), "Unknown status");
+}
+
+TEST(CAbi, EmptyServiceLoadsSchedule) {
+    Service svc(booking_service_create_empty());
+    ASSERT_NE(svc, nullptr);
+    EXPECT_EQ(booking_find_show(svc.get(), 1, 20), -1);
+
+    const std::string path = ::testing::TempDir() + "c_abi_schedule.csv";
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "movie,1,Dune\ntheater,20,Roxy\nlayout,5,2x8\nshow,7,1,20,5\nbogus\n";
+    }
+    size_t line = 0;
+    EXPECT_EQ(booking_load_schedule_file(svc.get(), path.c_str(), &line),
+              static_cast<int>(booking::ScheduleStatus::ParseError));
+    EXPECT_EQ(line, 5u);
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "movie,1,Dune\ntheater,20,Roxy\nlayout,5,2x8\nshow,7,1,20,5\n";
+    }
+    ASSERT_EQ(booking_load_schedule_file(svc.get(), path.c_str(), &line), BOOKING_OK);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(booking_find_show(svc.get(), 1, 20), 7);
+    EXPECT_EQ(booking_show_rows(svc.get(), 7), 2);
+    const uint64_t rows[2] = {0x1, 0x80};
+    booking_result r;
+    ASSERT_EQ(booking_book_mask(svc.get(), 7, rows, 2, &r), BOOKING_OK);
+    uint64_t free_words[2] = {};
+    EXPECT_EQ(booking_available_mask(svc.get(), 7, free_words, 2), 14);
+    EXPECT_EQ(free_words[0], 0xFEu);
+    EXPECT_EQ(free_words[1], 0x7Fu);
+}
@@ -0,0 +1,451 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "geo.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::CatalogStatus;
+using booking::Movie;
+using booking::Show;
+using booking::Theater;
+
+TEST(Catalog, AddMovieTheaterAndShow) {
+    BookingService svc;
+    EXPECT_EQ(svc.add_movie(Movie{10, "Arrival"}), CatalogStatus::Ok);
+    EXPECT_EQ(svc.add_theater(Theater{5, "Riverside"}), CatalogStatus::Ok);
+    const booking::LayoutId big = svc.add_layout(booking::HallLayout::uniform(10, 20));
+
+    EXPECT_EQ(svc.add_show(Show{50, 10, 5, big}), CatalogStatus::Ok);
+    EXPECT_EQ(svc.find_show(10, 5), 50);
+    EXPECT_EQ(svc.list_movies().size(), 4u);
+    ASSERT_EQ(svc.list_theaters_for_movie(10).size(), 1u);
+    EXPECT_EQ(svc.list_theaters_for_movie(10)[0].name, "Riverside");
+
+    // The new show is bookable right away with its own layout
+    EXPECT_EQ(svc.available_count(50), 200);
+    EXPECT_TRUE(svc.book_seats(50, {"j20"}).success);
+}
+
+TEST(Catalog, FindsShowsByTimeRange) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(Movie{1, "Dune"}), CatalogStatus::Ok);
+    for (int t = 1; t <= 3; ++t) ASSERT_EQ(svc.add_theater(Theater{t, "T" + std::to_string(t)}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(2, 10));
+    constexpr booking::ShowTime kHour = 3600;
+    // Added out of time order; show 9 starts at the same time as show 3
+    ASSERT_EQ(svc.add_show(Show{3, 1, 1, hall, 20 * kHour, 1}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{1, 1, 1, hall, 14 * kHour, 2}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{2, 1, 1, hall, 18 * kHour, 1}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{9, 1, 1, hall, 20 * kHour, 2}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{4, 1, 2, hall, 19 * kHour}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{5, 1, 3, hall, 21 * kHour}), CatalogStatus::Ok);
+
+    const auto ids = [](const std::vector<Show>& shows) {
+        std::vector<booking::ShowId> out;
+        for (const Show& s : shows) out.push_back(s.id);
+        return out;
+    };
+    EXPECT_EQ(ids(svc.find_shows_between(1, 1, 18 * kHour, 22 * kHour)), (std::vector<booking::ShowId>{2, 3, 9}));
+    EXPECT_EQ(ids(svc.find_shows_between(1, 1, 18 * kHour, 20 * kHour)), (std::vector<booking::ShowId>{2}));
+    EXPECT_TRUE(svc.find_shows_between(1, 1, 22 * kHour, 23 * kHour).empty());
+    EXPECT_TRUE(svc.find_shows_between(2, 1, 0, 24 * kHour).empty());
+    EXPECT_EQ(svc.find_shows_between(1, 1, 14 * kHour, 15 * kHour)[0].hall, 2);
+
+    const booking::TheaterId near[] = {3, 1, 2, 1};
+    EXPECT_EQ(ids(svc.find_shows_between(1, near, 18 * kHour, 22 * kHour)),
+              (std::vector<booking::ShowId>{2, 4, 3, 9, 5}));
+
+    // Any theater: column scan over movie and start time
+    EXPECT_EQ(ids(svc.find_movie_shows_between(1, 18 * kHour, 22 * kHour)),
+              (std::vector<booking::ShowId>{2, 4, 3, 9, 5}));
+    EXPECT_TRUE(svc.find_movie_shows_between(2, 0, 24 * kHour).empty());
+    EXPECT_EQ(svc.find_movie_shows_between(1, 14 * kHour, 15 * kHour)[0].layout_id, hall);
+
+    ASSERT_EQ(svc.remove_show(3), CatalogStatus::Ok);
+    EXPECT_EQ(ids(svc.find_shows_between(1, 1, 18 * kHour, 22 * kHour)), (std::vector<booking::ShowId>{2, 9}));
+    EXPECT_EQ(ids(svc.find_movie_shows_between(1, 18 * kHour, 22 * kHour)), (std::vector<booking::ShowId>{2, 4, 9, 5}));
+
+    // Schedules are indexed too
+    booking::Schedule schedule;
+    schedule.layouts.push_back(booking::ScheduleLayout{0, booking::HallLayout::uniform(1, 5)});
+    schedule.shows.push_back(booking::ScheduleShow{11, 1, 2, 0, 23 * kHour, 0});
+    schedule.shows.push_back(booking::ScheduleShow{10, 1, 2, 0, 17 * kHour, 0});
+    ASSERT_EQ(svc.load_schedule(std::move(schedule)).status, booking::ScheduleStatus::Ok);
+    EXPECT_EQ(ids(svc.find_shows_between(1, 2, 0, 24 * kHour)), (std::vector<booking::ShowId>{10, 4, 11}));
+}
+
+TEST(Catalog, ViewReadsAPinnedSnapshotWithoutCopies) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{2, "Roxy"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{1, "Odeon"}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(2, 10));
+    ASSERT_EQ(svc.add_show(Show{1, 1, 2, hall, 100}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{2, 1, 1, hall, 300}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{3, 1, 1, hall, 200}), CatalogStatus::Ok);
+
+    {
+        const BookingService::CatalogView view = svc.catalog_view();
+        ASSERT_EQ(view.movies().size(), 1u);
+        EXPECT_EQ(view.movies()[0].title, "Dune");
+        EXPECT_EQ(view.movies().data(), svc.catalog_view().movies().data()); // same snapshot storage
+        ASSERT_EQ(view.theaters().size(), 2u);
+        const booking::Span<const Theater> ts = view.theaters_for_movie(1);
+        ASSERT_EQ(ts.size(), 2u);
+        EXPECT_EQ(ts[0].id, 1);
+        EXPECT_EQ(ts[1].name, "Roxy");
+        EXPECT_TRUE(view.theaters_for_movie(7).empty());
+
+        const booking::Span<const Show> evening = view.shows_between(1, 1, 150, 400);
+        ASSERT_EQ(evening.size(), 2u);
+        EXPECT_EQ(evening[0].id, 3);
+        EXPECT_EQ(evening[1].id, 2);
+        EXPECT_TRUE(view.shows_between(1, 1, 400, 500).empty());
+        EXPECT_TRUE(view.shows_between(2, 1, 0, 500).empty());
+
+        // Updates publish new snapshots; the pinned one (and its spans) stays as it was
+        ASSERT_EQ(svc.add_movie(Movie{2, "Arrival"}), CatalogStatus::Ok);
+        ASSERT_EQ(svc.remove_show(3), CatalogStatus::Ok);
+        EXPECT_EQ(view.movies().size(), 1u);
+        EXPECT_EQ(evening[0].id, 3);
+        EXPECT_EQ(svc.catalog_view().movies().size(), 2u);
+    }
+    EXPECT_EQ(svc.catalog_view().shows_between(1, 1, 0, 500).size(), 1u);
+}
+
+TEST(Catalog, RejectsInvalidUpdates) {
+    BookingService svc;
+    EXPECT_EQ(svc.add_movie(Movie{1, "Again"}), CatalogStatus::DuplicateId);
+    EXPECT_EQ(svc.add_theater(Theater{2, "Again"}), CatalogStatus::DuplicateId);
+    EXPECT_EQ(svc.add_show(Show{1, 1, 1}), CatalogStatus::DuplicateId);
+    EXPECT_EQ(svc.add_show(Show{-1, 1, 1}), CatalogStatus::InvalidId);
+    EXPECT_EQ(svc.add_show(Show{9, 99, 1}), CatalogStatus::UnknownMovie);
+    EXPECT_EQ(svc.add_show(Show{9, 1, 99}), CatalogStatus::UnknownTheater);
+    EXPECT_EQ(svc.add_show(Show{9, 1, 1, 7}), CatalogStatus::UnknownLayout);
+    EXPECT_EQ(svc.remove_show(99), CatalogStatus::UnknownShow);
+    EXPECT_EQ(svc.find_show(1, 1), 1); // failed updates leave the catalog unchanged
+}
+
+TEST(Catalog, RemoveShowUpdatesIndexes) {
+    BookingService svc;
+    ASSERT_EQ(svc.add_show(Show{7, 1, 1}), CatalogStatus::Ok); // second Inception show at Central
+    EXPECT_EQ(svc.find_shows(1, 1), (std::vector<booking::ShowId>{1, 7}));
+
+    EXPECT_EQ(svc.remove_show(1), CatalogStatus::Ok);
+    EXPECT_EQ(svc.find_show(1, 1), 7);
+    EXPECT_EQ(svc.list_theaters_for_movie(1).size(), 2u);
+
+    // Removing the last show of the pair drops the theater from the movie's list
+    EXPECT_EQ(svc.remove_show(7), CatalogStatus::Ok);
+    EXPECT_EQ(svc.find_show(1, 1), -1);
+    ASSERT_EQ(svc.list_theaters_for_movie(1).size(), 1u);
+    EXPECT_EQ(svc.list_theaters_for_movie(1)[0].id, 2);
+
+    EXPECT_EQ(svc.remove_show(4), CatalogStatus::Ok);
+    EXPECT_TRUE(svc.list_theaters_for_movie(3).empty());
+
+    // Removed ids are not reused
+    EXPECT_EQ(svc.add_show(Show{1, 1, 1}), CatalogStatus::DuplicateId);
+}
+
+TEST(Catalog, RemovedShowKeepsBookingsForRefunds) {
+    BookingService svc;
+    auto res = svc.book_seats(2, {"a1"});
+    ASSERT_TRUE(res.success);
+    ASSERT_EQ(svc.remove_show(2), CatalogStatus::Ok);
+    EXPECT_TRUE(svc.cancel_seats(2, {"a1"}, static_cast<booking::BookingId>(res.id)).success);
+}
+
+TEST(Catalog, ReadersRunDuringUpdates) {
+    BookingService svc;
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                EXPECT_GE(svc.list_movies().size(), 3u);
+                EXPECT_EQ(svc.find_show(1, 1), 1);
+                const booking::ShowId s = svc.find_show(2, 2);
+                if (s != -1) {
+                    EXPECT_GE(svc.available_count(s), 0);
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 300; ++i) {
+        ASSERT_EQ(svc.add_movie(Movie{100 + i, "Festival"}), CatalogStatus::Ok);
+        ASSERT_EQ(svc.add_show(Show{100 + i, 2, 2}), CatalogStatus::Ok);
+    }
+    done.store(true);
+    for (auto& r : readers) r.join();
+    EXPECT_EQ(svc.find_shows(2, 2).size(), 300u);
+}
+
+TEST(Catalog, LoadScheduleBuildsCatalogAndStates) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    EXPECT_TRUE(svc.list_movies().empty());
+
+    booking::Schedule schedule;
+    ASSERT_EQ(booking::parse_schedule("movie,1,Dune\nmovie,2,Heat\n"
+                                      "theater,20,Roxy\ntheater,10,Odeon\n"
+                                      "layout,5,2x8\n"
+                                      "show,1,1,20,5\nshow,2,1,10,5\nshow,3,2,10,5\n",
+                                      1, schedule).status,
+              booking::ScheduleStatus::Ok);
+    const auto err = svc.load_schedule(std::move(schedule));
+    ASSERT_EQ(err.status, booking::ScheduleStatus::Ok) << err.reason;
+
+    EXPECT_EQ(svc.list_movies().size(), 2u);
+    const auto theaters = svc.list_theaters_for_movie(1);
+    ASSERT_EQ(theaters.size(), 2u);
+    EXPECT_EQ(theaters[0].id, 10); // sorted by id
+    EXPECT_EQ(svc.find_show(2, 10), 3);
+    EXPECT_EQ(svc.available_count(1), 16);
+    EXPECT_TRUE(svc.book_seats(1, {"b8"}).success);
+}
+
+TEST(Catalog, LoadScheduleIsAllOrNothing) {
+    BookingService svc;
+    const char* conflicting[] = {
+        "movie,1,Duplicate\n",
+        "theater,3,X\ntheater,3,Y\n",
+        "layout,1,1x1\nlayout,1,1x2\n",
+        "layout,1,1x1\nshow,1,1,1,1\n",        // show id 1 exists already
+        "layout,1,1x1\nshow,9,1,1,2\n",        // unknown layout
+        "layout,1,1x1\nshow,9,42,1,1\n",       // unknown movie
+        "layout,1,1x1\nshow,9,1,42,1\n",       // unknown theater
+        "layout,1,1x1\nshow,9,1,1,1\nshow,9,1,1,1\n",
+    };
+    for (const char* text : conflicting) {
+        booking::Schedule schedule;
+        ASSERT_EQ(booking::parse_schedule(text, 1, schedule).status, booking::ScheduleStatus::Ok);
+        EXPECT_EQ(svc.load_schedule(std::move(schedule)).status, booking::ScheduleStatus::CatalogError) << text;
+    }
+    EXPECT_EQ(svc.list_movies().size(), 3u);
+    EXPECT_EQ(svc.find_show(1, 1), 1);
+    EXPECT_EQ(svc.layout_for_show(9), nullptr);
+
+    EXPECT_EQ(svc.load_schedule_file("/nonexistent/schedule.csv").status, booking::ScheduleStatus::IoError);
+}
+
+TEST(Catalog, ScheduleBatchSwapsShowsInOneSnapshot) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{1, "Roxy"}), CatalogStatus::Ok);
+    constexpr std::int64_t kShows = 8;
+    const auto batch = [](std::int64_t first) {
+        booking::Schedule schedule;
+        schedule.layouts.push_back(booking::ScheduleLayout{0, booking::HallLayout::uniform(1, 4)});
+        for (std::int64_t id = first; id < first + kShows; ++id) {
+            schedule.shows.push_back(booking::ScheduleShow{id, 1, 1, 0, id * 60});
+        }
+        return schedule;
+    };
+    ASSERT_EQ(svc.load_schedule(batch(1)).status, booking::ScheduleStatus::Ok);
+    ASSERT_TRUE(svc.book_seats(1, {"a1"}).success);
+
+    // Every batch replaces all shows: a reader never sees some of them gone and others not yet added
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 2; ++t) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                EXPECT_EQ(svc.show_count(), static_cast<std::size_t>(kShows));
+                EXPECT_EQ(svc.find_shows(1, 1).size(), static_cast<std::size_t>(kShows));
+            }
+        });
+    }
+    std::int64_t first = 1;
+    for (int round = 0; round < 100; ++round, first += kShows) {
+        std::vector<booking::ShowId> removals;
+        for (std::int64_t id = first; id < first + kShows; ++id) removals.push_back(id);
+        const auto err = svc.apply_schedule_batch(batch(first + kShows), removals);
+        ASSERT_EQ(err.status, booking::ScheduleStatus::Ok) << err.reason;
+    }
+    done.store(true);
+    for (auto& r : readers) r.join();
+    EXPECT_EQ(svc.find_show(1, 1), first);
+    EXPECT_EQ(svc.find_theater_shows_between(1, 0, first * 60).size(), 0u);
+    EXPECT_EQ(svc.find_theater_shows_between(1, first * 60, (first + kShows) * 60).size(),
+              static_cast<std::size_t>(kShows));
+    EXPECT_EQ(svc.available_count(1), 3); // removed shows keep their bookings
+
+    // Invalid batches change nothing
+    const std::vector<booking::ShowId> unknown{first, 1};
+    const std::vector<booking::ShowId> twice{first, first};
+    const std::vector<booking::ShowId> readded{first};
+    EXPECT_EQ(svc.apply_schedule_batch(batch(first + kShows), unknown).status, booking::ScheduleStatus::CatalogError);
+    EXPECT_EQ(svc.apply_schedule_batch(batch(first + kShows), twice).status, booking::ScheduleStatus::CatalogError);
+    EXPECT_EQ(svc.apply_schedule_batch(batch(first), readded).status, booking::ScheduleStatus::CatalogError);
+    EXPECT_EQ(svc.find_show(1, 1), first);
+    EXPECT_EQ(svc.show_count(), static_cast<std::size_t>(kShows));
+}
+
+TEST(Catalog, SparseShowIdsAreBookableAndRestored) {
+    BookingService svc;
+    constexpr std::int64_t kSparse = 1900000000;
+    ASSERT_EQ(svc.add_show(Show{kSparse, 1, 1}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{kSparse + 1, 1, 1}), CatalogStatus::Ok);
+    EXPECT_EQ(svc.add_show(Show{kSparse, 1, 1}), CatalogStatus::DuplicateId);
+    EXPECT_EQ(svc.find_shows(1, 1), (std::vector<booking::ShowId>{1, kSparse, kSparse + 1}));
+    const auto res = svc.book_seats(kSparse, {"a1", "a2"});
+    ASSERT_TRUE(res.success);
+    EXPECT_EQ(svc.available_count(kSparse), svc.available_count(kSparse + 1) - 2);
+    EXPECT_EQ(svc.available_count(kSparse + 2), -1);
+
+    booking::Schedule schedule;
+    ASSERT_EQ(booking::parse_schedule("layout,1,2x8\nshow,2000000000,1,1,1\n", 1, schedule).status, booking::ScheduleStatus::Ok);
+    ASSERT_EQ(svc.load_schedule(std::move(schedule)).status, booking::ScheduleStatus::Ok);
+    EXPECT_TRUE(svc.book_seats(2000000000, {"a1"}).success);
+
+    const std::string path = ::testing::TempDir() + "catalog_sparse.snap";
+    ASSERT_EQ(svc.write_snapshot(path), booking::SnapshotStatus::Ok);
+    for (booking::SnapshotLoad load : {booking::SnapshotLoad::Eager, booking::SnapshotLoad::Lazy}) {
+        BookingService restored{BookingService::EmptyCatalog{}};
+        ASSERT_EQ(restored.restore_snapshot(path, load), booking::SnapshotStatus::Ok);
+        EXPECT_EQ(restored.seat_owner(kSparse, 1), res.id) << to_string(load);
+        EXPECT_EQ(restored.available_count(kSparse), svc.available_count(kSparse));
+        EXPECT_EQ(restored.book_seats(2000000000, {"a1"}).status, booking::BookingStatus::AlreadyBooked);
+        EXPECT_EQ(restored.lazy_shows_pending(), 0u);
+    }
+}
+
+TEST(Catalog, ListsNearbyTheatersNearestFirst) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_movie(Movie{2, "Heat"}), CatalogStatus::Ok);
+    // Around Berlin (52.52, 13.40), one in Potsdam, one in Munich, one without location
+    ASSERT_EQ(svc.add_theater(Theater{1, "Mitte", 52.521, 13.410}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{2, "Kreuzberg", 52.499, 13.403}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{3, "Potsdam", 52.391, 13.064}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{4, "Munich", 48.137, 11.575}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{5, "Pop-up"}), CatalogStatus::Ok);
+    booking::Schedule schedule; // theaters can also come with a schedule
+    schedule.theaters.push_back(booking::ScheduleTheater{6, "Alex", 52.5219, 13.4132});
+    schedule.layouts.push_back(booking::ScheduleLayout{0, booking::HallLayout::uniform(1, 5)});
+    for (int t = 1; t <= 6; ++t) schedule.shows.push_back(booking::ScheduleShow{t, 1, t, 0});
+    for (int t = 100; t < 140; ++t) { // far away: small radii visit fewer cells than the movie has theaters
+        schedule.theaters.push_back(booking::ScheduleTheater{t, "Far", -30.0 - (t - 100) * 0.5, 100.0});
+        schedule.shows.push_back(booking::ScheduleShow{t, 1, t, 0});
+    }
+    schedule.shows.push_back(booking::ScheduleShow{7, 2, 4, 0});
+    ASSERT_EQ(svc.load_schedule(std::move(schedule)).status, booking::ScheduleStatus::Ok);
+
+    const auto ids = [](const std::vector<Theater>& ts) {
+        std::vector<booking::TheaterId> out;
+        for (const Theater& t : ts) out.push_back(t.id);
+        return out;
+    };
+    EXPECT_EQ(ids(svc.list_theaters_for_movie(1, 52.5200, 13.4050, 5.0)), (std::vector<booking::TheaterId>{1, 6, 2}));
+    EXPECT_EQ(ids(svc.list_theaters_for_movie(1, 52.5200, 13.4050, 40.0)),
+              (std::vector<booking::TheaterId>{1, 6, 2, 3}));
+    // A continent-sized radius visits more cells than the movie has theaters: list scan
+    EXPECT_EQ(ids(svc.list_theaters_for_movie(1, 52.5200, 13.4050, 1000.0)),
+              (std::vector<booking::TheaterId>{1, 6, 2, 3, 4}));
+    EXPECT_EQ(ids(svc.list_theaters_for_movie(2, 52.5200, 13.4050, 40.0)), std::vector<booking::TheaterId>{});
+    EXPECT_EQ(ids(svc.list_theaters_for_movie(2, 48.14, 11.58, 1.0)), (std::vector<booking::TheaterId>{4}));
+    EXPECT_TRUE(svc.list_theaters_for_movie(9, 52.52, 13.40, 100.0).empty());
+    EXPECT_TRUE(svc.list_theaters_for_movie(1, 52.52, 13.40, -1.0).empty());
+    EXPECT_NEAR(booking::distance_km(52.5200, 13.4050, 48.1372, 11.5756), 504.0, 2.0);
+
+    // Radius across the antimeridian
+    ASSERT_EQ(svc.add_theater(Theater{8, "Fiji", -17.8, 179.95}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{8, 1, 8}), CatalogStatus::Ok);
+    EXPECT_EQ(ids(svc.list_theaters_for_movie(1, -17.8, -179.95, 20.0)), (std::vector<booking::TheaterId>{8}));
+}
+
+TEST(Catalog, PagesThroughMoviesAndTheatersWithStableCursors) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    for (int m = 1; m <= 7; ++m) ASSERT_EQ(svc.add_movie(Movie{m * 10, "Movie"}), CatalogStatus::Ok);
+
+    std::vector<booking::MovieId> movies;
+    std::uint64_t cursor = 0;
+    for (int pages = 0;; ++pages) {
+        ASSERT_LT(pages, 10);
+        const booking::Page<Movie> page = svc.list_movies_page(cursor, 3);
+        for (const Movie& m : page.items) movies.push_back(m.id);
+        cursor = page.next_cursor;
+        if (!page.more) break;
+    }
+    EXPECT_EQ(movies, (std::vector<booking::MovieId>{10, 20, 30, 40, 50, 60, 70}));
+    // The last page's cursor resumes with movies added later
+    ASSERT_EQ(svc.add_movie(Movie{80, "Late"}), CatalogStatus::Ok);
+    const booking::Page<Movie> late = svc.list_movies_page(cursor, 3);
+    ASSERT_EQ(late.items.size(), 1u);
+    EXPECT_EQ(late.items[0].id, 80);
+    EXPECT_FALSE(late.more);
+    EXPECT_TRUE(svc.list_movies_page(100, 3).items.empty());
+
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(1, 5));
+    for (int t = 1; t <= 6; ++t) {
+        ASSERT_EQ(svc.add_theater(Theater{t * 2, "Hall"}), CatalogStatus::Ok);
+        ASSERT_EQ(svc.add_show(Show{t, 10, t * 2, hall}), CatalogStatus::Ok);
+    }
+    const auto ids = [](const booking::Page<Theater>& page) {
+        std::vector<booking::TheaterId> out;
+        for (const Theater& t : page.items) out.push_back(t.id);
+        return out;
+    };
+    const booking::Page<Theater> first = svc.list_theaters_for_movie_page(10, 0, 2);
+    EXPECT_EQ(ids(first), (std::vector<booking::TheaterId>{2, 4}));
+    ASSERT_TRUE(first.more);
+
+    // A theater added before the cursor and one removed after it shift nothing
+    ASSERT_EQ(svc.add_theater(Theater{1, "Early"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{7, 10, 1, hall}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.remove_show(3), CatalogStatus::Ok); // theater 6
+    const booking::Page<Theater> second = svc.list_theaters_for_movie_page(10, first.next_cursor, 2);
+    EXPECT_EQ(ids(second), (std::vector<booking::TheaterId>{8, 10}));
+    ASSERT_TRUE(second.more);
+    const booking::Page<Theater> third = svc.list_theaters_for_movie_page(10, second.next_cursor, 2);
+    EXPECT_EQ(ids(third), (std::vector<booking::TheaterId>{12}));
+    EXPECT_FALSE(third.more);
+    EXPECT_TRUE(svc.list_theaters_for_movie_page(99, 0, 2).items.empty());
+    EXPECT_FALSE(svc.list_theaters_for_movie_page(99, 0, 2).more);
+}
+
+TEST(Catalog, MovieShowtimesCarryTheatersAndFreeSeats) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_movie(Movie{2, "Heat"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{7, "Roxy"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{8, "Odeon"}), CatalogStatus::Ok);
+    const booking::LayoutId small = svc.add_layout(booking::HallLayout::uniform(1, 5));
+    const booking::LayoutId big = svc.add_layout(booking::HallLayout::uniform(2, 10));
+    ASSERT_EQ(svc.add_show(Show{30, 1, 7, small, 300, 1}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{10, 1, 8, big, 100, 2}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{20, 1, 7, big, 300, 3}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{40, 2, 7, small, 200, 1}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{50, 1, 8, small, 900, 1}), CatalogStatus::Ok);
+    ASSERT_TRUE(svc.book_seats(20, {"a1", "a2", "b3"}).success);
+
+    std::vector<booking::ShowAvailability> out;
+    out.push_back(booking::ShowAvailability{}); // appended after what the buffer holds
+    ASSERT_EQ(svc.movie_showtimes(1, 0, 500, out), 3u);
+    ASSERT_EQ(out.size(), 4u);
+    const booking::ShowAvailability& first = out[1];
+    EXPECT_EQ(first.show_id, 10);
+    EXPECT_EQ(first.theater_id, 8);
+    EXPECT_EQ(first.theater_name, "Odeon");
+    EXPECT_EQ(first.start_time, 100);
+    EXPECT_EQ(first.hall, 2);
+    EXPECT_EQ(first.free_seats, 20);
+    EXPECT_EQ(first.seat_count, 20);
+    EXPECT_EQ(out[2].show_id, 20); // same start as show 30: by show id
+    EXPECT_EQ(out[2].free_seats, 17);
+    EXPECT_EQ(out[3].show_id, 30);
+    EXPECT_EQ(out[3].free_seats, 5);
+    EXPECT_EQ(out[3].theater_name, "Roxy");
+
+    out.clear();
+    EXPECT_EQ(svc.movie_showtimes(1, 301, 1000, out), 1u);
+    EXPECT_EQ(svc.movie_showtimes(9, 0, 1000, out), 0u);
+    ASSERT_EQ(svc.remove_show(50), CatalogStatus::Ok);
+    out.clear();
+    EXPECT_EQ(svc.movie_showtimes(1, 0, 1000, out), 3u);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "sharded_booking_service.hpp"
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::SeatMask;
+using booking::ShowId;
+
+TEST(Group, FitsOneRowWhenARowHasRoom) {
+    BookingService svc(HallLayout::uniform(4, 12));
+    const ShowId show = svc.find_show(1, 1);
+    SeatMask seats;
+    const BookingResult r = svc.book_group(show, 8, seats);
+    ASSERT_TRUE(r.success) << r.message();
+    EXPECT_EQ(seats.count(), 8);
+    EXPECT_EQ(seats.first_word() + 1, seats.end_word()); // one row
+    EXPECT_EQ(svc.seat_owner(show, HallLayout::seat_index(seats.first_word(), 2)), r.id);
+}
+
+TEST(Group, SplitsOverTheMiddleRowPair) {
+    BookingService svc(HallLayout::uniform(4, 8));
+    const ShowId show = svc.find_show(1, 1);
+    SeatMask seats;
+    ASSERT_TRUE(svc.book_group(show, 10, seats).success);
+    EXPECT_EQ(seats.word(1), 0x3Eu); // b2-b6
+    EXPECT_EQ(seats.word(2), 0x3Eu); // c2-c6
+
+    EXPECT_EQ(svc.available_count(show), 32 - 10);
+
+    // Odd groups: the longer part's columns cover the shorter part's
+    BookingService odd(HallLayout::uniform(4, 8));
+    ASSERT_TRUE(odd.book_group(odd.find_show(1, 1), 11, seats).success);
+    EXPECT_EQ(seats.count(), 11);
+    ASSERT_EQ(seats.first_word(), 1);
+    ASSERT_EQ(seats.end_word(), 3);
+    std::uint64_t longer = seats.word(1);
+    std::uint64_t shorter = seats.word(2);
+    if (booking::popcount64(longer) < booking::popcount64(shorter)) std::swap(longer, shorter);
+    EXPECT_EQ(booking::popcount64(longer), 6);
+    EXPECT_EQ(shorter & ~longer, 0u);
+}
+
+TEST(Group, AvoidsTakenSeatsAislesAndCategorySeats) {
+    HallLayout layout = HallLayout::uniform(4, 10);
+    std::array<std::uint64_t, HallLayout::kMaxRows> aisles{};
+    aisles[2] = 1u << 4; // c1-c5 | c6-c10
+    layout.set_aisles(aisles);
+    booking::SeatCategories categories;
+    categories.wheelchair[3] = 0x3FFu; // row d is all wheelchair spaces
+    layout.set_seat_categories(categories);
+    BookingService svc(std::move(layout));
+    const ShowId show = svc.find_show(1, 1);
+    ASSERT_TRUE(svc.book_seats(show, {"b1", "b10"}).success);
+
+    // b2-b9 is 8 wide and c splits into blocks of 5: 6 + 6 over rows a and b beats 8 + 4 over b and c
+    SeatMask seats;
+    ASSERT_TRUE(svc.book_group(show, 12, seats).success);
+    ASSERT_EQ(seats.first_word(), 0);
+    EXPECT_EQ(seats.end_word(), 2);
+    EXPECT_EQ(seats.count(), 12);
+    EXPECT_EQ(seats.word(1) & 0x201u, 0u);
+
+    // A block of row c still seats five in one row; twelve no longer fit anywhere
+    ASSERT_TRUE(svc.book_group(show, 5, seats).success);
+    EXPECT_EQ(seats.first_word(), 2);
+    EXPECT_EQ(svc.book_group(show, 12, seats).status, BookingStatus::NoContiguousSeats);
+}
+
+TEST(Group, RejectsImpossibleRequests) {
+    BookingService svc(HallLayout::uniform(3, 8));
+    const ShowId show = svc.find_show(1, 1);
+    SeatMask seats;
+    EXPECT_EQ(svc.book_group(show, 0, seats).status, BookingStatus::NoSeats);
+    EXPECT_EQ(svc.book_group(show, 17, seats).status, BookingStatus::NoContiguousSeats);
+    EXPECT_EQ(svc.book_group(show, 129, seats).status, BookingStatus::NoContiguousSeats);
+    EXPECT_EQ(svc.book_group(999, 4, seats).status, BookingStatus::InvalidShow);
+    EXPECT_TRUE(seats.empty());
+    BookingService one_row(HallLayout::single_row(20));
+    EXPECT_EQ(one_row.book_group(one_row.find_show(1, 1), 21, seats).status, BookingStatus::NoContiguousSeats);
+
+    booking::ShardedBookingService sharded(2);
+    EXPECT_TRUE(sharded.book_group(sharded.find_show(1, 1), 2, seats).success);
+}
+
+TEST(Group, ConcurrentGroupsNeverOverlap) {
+    // 600-seat hall, groups of 10 that mostly need two rows
+    BookingService svc(HallLayout::uniform(24, 25));
+    const ShowId show = svc.find_show(1, 1);
+    std::atomic<int> booked{0};
+    std::vector<std::thread> threads;
+    std::vector<std::vector<SeatMask>> taken(4);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            SeatMask seats;
+            for (int i = 0; i < 40; ++i) {
+                const int n = i % 2 == 0 ? 10 : 30;
+                const BookingResult r = svc.book_group(show, n, seats);
+                if (!r.success) continue;
+                EXPECT_EQ(seats.count(), n);
+                booked.fetch_add(n);
+                taken[static_cast<std::size_t>(t)].push_back(seats);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(svc.available_count(show), 600 - booked.load());
+    SeatMask all;
+    int total = 0;
+    for (const auto& masks : taken) {
+        for (const SeatMask& m : masks) {
+            for (int w = m.first_word(); w < m.end_word(); ++w) {
+                EXPECT_EQ(all.word(w) & m.word(w), 0u);
+                all.or_word(w, m.word(w));
+            }
+            total += m.count();
+        }
+    }
+    EXPECT_EQ(total, booked.load());
+}
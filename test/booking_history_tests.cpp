@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include "booking_history.hpp"
+#include "sim_scheduler.hpp"
+
+#include <chrono>
+#include <initializer_list>
+#include <random>
+#include <thread>
+#include <vector>
+
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::History;
+using booking::HistoryEvent;
+using booking::HistoryOp;
+using booking::HistoryRecorder;
+using booking::LinearizabilityVerdict;
+using booking::SeatMask;
+using booking::ShowId;
+
+namespace {
+
+/** @brief Appends a hand-written event over seats of row 0. */
+void add(History& h, HistoryOp op, BookingStatus status, std::initializer_list<int> cols, std::uint64_t arg,
+         std::uint64_t id, std::uint64_t invoked, std::uint64_t completed) {
+    HistoryEvent e;
+    e.op = op;
+    e.status = status;
+    e.show_id = 1;
+    e.arg = arg;
+    e.id = id;
+    e.invoked = invoked;
+    e.completed = completed;
+    e.words = static_cast<std::uint32_t>(h.words.size());
+    std::uint64_t bits = 0;
+    for (const int c : cols) bits |= std::uint64_t{1} << c;
+    if (bits != 0u) {
+        e.end_word = 1;
+        h.words.push_back(bits);
+    }
+    h.events.push_back(e);
+}
+
+} // namespace
+
+TEST(Linearizability, AcceptsLegalHistories) {
+    History h;
+    // Two overlapping bookings race; the loser saw the winner's seat
+    add(h, HistoryOp::Book, BookingStatus::AlreadyBooked, {1, 2}, 0, 0, 1, 4);
+    add(h, HistoryOp::Book, BookingStatus::Ok, {2, 3}, 0, 7, 2, 3);
+    // Cancelled, then booked again by a hold that is confirmed
+    add(h, HistoryOp::Cancel, BookingStatus::Ok, {2, 3}, 7, 0, 5, 6);
+    add(h, HistoryOp::Hold, BookingStatus::Ok, {3}, 0, 9, 7, 8);
+    add(h, HistoryOp::Cancel, BookingStatus::NotOwner, {3}, 7, 0, 9, 12);
+    add(h, HistoryOp::ConfirmHold, BookingStatus::Ok, {}, 9, 11, 10, 11);
+    add(h, HistoryOp::Cancel, BookingStatus::Ok, {3}, 11, 0, 13, 14);
+    // Disjoint seats: a group of their own; Contended is not constrained
+    add(h, HistoryOp::Book, BookingStatus::Ok, {10}, 0, 12, 15, 18);
+    add(h, HistoryOp::Book, BookingStatus::Contended, {10}, 0, 0, 16, 17);
+
+    const booking::LinearizabilityReport report = booking::check_linearizable(h);
+    EXPECT_EQ(report.verdict, LinearizabilityVerdict::Linearizable) << booking::to_string(report.verdict);
+    EXPECT_EQ(report.checked, 8u);
+    EXPECT_GE(report.groups, 2u);
+}
+
+TEST(Linearizability, FindsViolations) {
+    {
+        // Both bookings got the seat although one started after the other finished
+        History h;
+        add(h, HistoryOp::Book, BookingStatus::Ok, {4}, 0, 1, 1, 2);
+        add(h, HistoryOp::Book, BookingStatus::Ok, {4, 5}, 0, 2, 3, 4);
+        const booking::LinearizabilityReport report = booking::check_linearizable(h);
+        EXPECT_EQ(report.verdict, LinearizabilityVerdict::Violation);
+        EXPECT_EQ(report.show_id, ShowId(1));
+        EXPECT_EQ(report.witness, (std::vector<std::size_t>{1})); // the segment after the quiescent point
+    }
+    {
+        // A conflict reported on seats nobody holds
+        History h;
+        add(h, HistoryOp::Book, BookingStatus::Ok, {1}, 0, 1, 1, 2);
+        add(h, HistoryOp::Cancel, BookingStatus::Ok, {1}, 1, 0, 3, 4);
+        add(h, HistoryOp::Book, BookingStatus::AlreadyBooked, {1}, 0, 0, 5, 6);
+        EXPECT_EQ(booking::check_linearizable(h).verdict, LinearizabilityVerdict::Violation);
+    }
+    {
+        // Concurrent, yet no order explains both successes
+        History h;
+        add(h, HistoryOp::Book, BookingStatus::Ok, {1, 2}, 0, 1, 1, 4);
+        add(h, HistoryOp::Book, BookingStatus::Ok, {2}, 0, 2, 2, 3);
+        EXPECT_EQ(booking::check_linearizable(h).verdict, LinearizabilityVerdict::Violation);
+        EXPECT_EQ(booking::check_linearizable(h, 1).verdict, LinearizabilityVerdict::Unknown);
+    }
+}
+
+TEST(Linearizability, RecordedConcurrentTrafficIsLinearizable) {
+    BookingService svc(HallLayout::uniform(2, 8));
+    const ShowId show = svc.find_show(1, 1);
+    constexpr unsigned kThreads = 4;
+    HistoryRecorder recorder(kThreads);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(t + 1);
+            std::vector<std::pair<booking::BookingId, SeatMask>> mine;
+            std::vector<std::pair<booking::HoldId, SeatMask>> holds;
+            for (int i = 0; i < 400; ++i) {
+                const unsigned dice = rng() % 10u;
+                if (dice < 2u && !mine.empty()) {
+                    const auto b = mine.back();
+                    mine.pop_back();
+                    const std::uint64_t t0 = recorder.now();
+                    recorder.record(t, HistoryOp::Cancel, show, b.second, b.first, t0,
+                                    svc.cancel_seat_mask(show, b.second, b.first));
+                    continue;
+                }
+                if (dice < 3u && !holds.empty()) {
+                    const auto h = holds.back();
+                    holds.pop_back();
+                    const bool confirm = (rng() & 1u) != 0u;
+                    const std::uint64_t t0 = recorder.now();
+                    const BookingResult r = confirm ? svc.confirm_hold(h.first) : svc.release_hold(h.first);
+                    recorder.record(t, confirm ? HistoryOp::ConfirmHold : HistoryOp::ReleaseHold, show, SeatMask{},
+                                    h.first, t0, r);
+                    if (confirm && r.success) mine.emplace_back(r.id, h.second);
+                    continue;
+                }
+                SeatMask seats;
+                const int row = static_cast<int>(rng() % 2u);
+                const int col = static_cast<int>(rng() % 7u);
+                seats.set(HallLayout::seat_index(row, col));
+                if ((rng() & 1u) != 0u) seats.set(HallLayout::seat_index(row, col + 1));
+                if (dice < 5u) seats.set(HallLayout::seat_index(1 - row, col)); // multi-row
+                const bool hold = dice == 9u;
+                const std::uint64_t t0 = recorder.now();
+                const BookingResult r = hold ? svc.hold_seat_mask(show, seats, std::chrono::minutes(10))
+                                             : svc.book_seat_mask(show, seats);
+                recorder.record(t, hold ? HistoryOp::Hold : HistoryOp::Book, show, seats, 0, t0, r);
+                if (!r.success) continue;
+                if (hold) {
+                    holds.emplace_back(static_cast<booking::HoldId>(r.id), seats);
+                } else {
+                    mine.emplace_back(r.id, seats);
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    EXPECT_EQ(recorder.size(), kThreads * 400u);
+
+    const History history = recorder.take();
+    EXPECT_EQ(history.events.size(), kThreads * 400u);
+    const booking::LinearizabilityReport report = booking::check_linearizable(history);
+    EXPECT_EQ(report.verdict, LinearizabilityVerdict::Linearizable) << "show " << report.show_id.value();
+    EXPECT_GT(report.checked, 0u);
+}
+
+TEST(Linearizability, SimulatedInterleavingsAreLinearizable) {
+    if (!BOOKING_SIMULATION) GTEST_SKIP() << "built without schedule points";
+    for (std::uint64_t seed = 0; seed < 50; ++seed) {
+        BookingService svc(HallLayout::uniform(2, 6));
+        const ShowId show = svc.find_show(1, 1);
+        HistoryRecorder recorder(3);
+        std::vector<booking::SimScheduler::Task> tasks;
+        for (unsigned t = 0; t < 3; ++t) {
+            tasks.push_back([&, t] {
+                for (int i = 0; i < 6; ++i) {
+                    SeatMask seats;
+                    seats.set(HallLayout::seat_index(0, (static_cast<int>(t) + i) % 4));
+                    seats.set(HallLayout::seat_index(1, (static_cast<int>(t) * 2 + i) % 4));
+                    const std::uint64_t t0 = recorder.now();
+                    const BookingResult r = svc.book_seat_mask(show, seats);
+                    recorder.record(t, HistoryOp::Book, show, seats, 0, t0, r);
+                    if (!r.success || i % 2 != 0) continue;
+                    const std::uint64_t t1 = recorder.now();
+                    recorder.record(t, HistoryOp::Cancel, show, seats, r.id, t1, svc.cancel_seat_mask(show, seats, r.id));
+                }
+            });
+        }
+        booking::SimScheduler sim(seed);
+        sim.run(std::move(tasks));
+        const booking::LinearizabilityReport report = booking::check_linearizable(recorder.take());
+        EXPECT_EQ(report.verdict, LinearizabilityVerdict::Linearizable) << "seed " << seed;
+    }
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::ShowId;
+using namespace std::chrono_literals;
+
+namespace {
+std::size_t free_seats(const BookingService& svc, ShowId show) {
+    return svc.list_available_seats(show).size();
+}
+} // namespace
+
+TEST(Holds, HoldMakesSeatsUnavailable) {
+    BookingService svc;
+    ShowId show = svc.find_show(1, 1);
+
+    auto hold = svc.hold_seats(show, {"a1", "a2"}, 60s);
+    ASSERT_TRUE(hold.success) << hold.message();
+    EXPECT_NE(hold.id, 0u);
+    EXPECT_EQ(free_seats(svc, show), 18u);
+
+    // Neither another hold nor a booking can take held seats
+    EXPECT_EQ(svc.hold_seats(show, {"a2"}, 60s).status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(svc.book_seats(show, {"a1"}).status, BookingStatus::AlreadyBooked);
+}
+
+TEST(Holds, ConfirmKeepsSeatsBooked) {
+    BookingService svc;
+    ShowId show = svc.find_show(1, 1);
+
+    auto hold = svc.hold_seats(show, {"a5"}, 60s);
+    ASSERT_TRUE(hold.success);
+    EXPECT_TRUE(svc.confirm_hold(hold.id).success);
+    EXPECT_EQ(svc.confirm_hold(hold.id).status, BookingStatus::UnknownHold);
+    EXPECT_EQ(svc.release_hold(hold.id).status, BookingStatus::UnknownHold);
+    EXPECT_EQ(free_seats(svc, show), 19u);
+
+    // Expiry of a confirmed hold does not free the seats
+    EXPECT_EQ(svc.expire_holds(std::chrono::steady_clock::now() + 120s), 0u);
+    EXPECT_EQ(free_seats(svc, show), 19u);
+}
+
+TEST(Holds, HoldMaskTellsHeldSeatsFromBookedOnes) {
+    BookingService svc(booking::HallLayout::uniform(3, 10));
+    ShowId show = svc.find_show(1, 1);
+    booking::SeatMask held;
+    EXPECT_EQ(svc.held_seats_mask(show, held), 0);
+    EXPECT_EQ(svc.held_seats_mask(ShowId{999}, held), -1);
+
+    ASSERT_TRUE(svc.book_seats(show, {"a3"}).success);
+    const auto first = svc.hold_seats(show, {"a1", "b2"}, 60s);
+    const auto second = svc.hold_seats(show, {"c4"}, 60s);
+    ASSERT_TRUE(first.success && second.success);
+    EXPECT_EQ(svc.held_seats_mask(show, held), 3);
+    EXPECT_TRUE(held.test(booking::HallLayout::seat_index(1, 1)));
+    EXPECT_FALSE(held.test(booking::HallLayout::seat_index(0, 2))); // booked, not held
+
+    // Confirmed seats stay taken but leave the hold mask; released ones leave both
+    ASSERT_TRUE(svc.confirm_hold(first.id).success);
+    EXPECT_EQ(svc.held_seats_mask(show, held), 1);
+    EXPECT_TRUE(held.test(booking::HallLayout::seat_index(2, 3)));
+    EXPECT_EQ(svc.expire_holds(std::chrono::steady_clock::now() + 120s), 1u);
+    EXPECT_EQ(svc.held_seats_mask(show, held), 0);
+    EXPECT_EQ(free_seats(svc, show), 27u);
+}
+
+TEST(Holds, ReleaseFreesSeatsImmediately) {
+    BookingService svc(booking::HallLayout::uniform(3, 10));
+    ShowId show = svc.find_show(1, 1);
+
+    auto hold = svc.hold_seats(show, {"a1", "b1", "c1"}, 60s);
+    ASSERT_TRUE(hold.success);
+    EXPECT_EQ(free_seats(svc, show), 27u);
+    EXPECT_TRUE(svc.release_hold(hold.id).success);
+    EXPECT_EQ(free_seats(svc, show), 30u);
+    EXPECT_EQ(svc.confirm_hold(hold.id).status, BookingStatus::UnknownHold);
+}
+
+TEST(Holds, ExpiryReleasesOnlyDueHolds) {
+    BookingService svc;
+    ShowId show = svc.find_show(1, 1);
+
+    auto short_hold = svc.hold_seats(show, {"a1"}, 100ms);
+    auto long_hold = svc.hold_seats(show, {"a2"}, 3600s);
+    ASSERT_TRUE(short_hold.success);
+    ASSERT_TRUE(long_hold.success);
+
+    const auto now = std::chrono::steady_clock::now();
+    EXPECT_EQ(svc.expire_holds(now + 10s), 1u);
+    EXPECT_EQ(free_seats(svc, show), 19u);
+    EXPECT_EQ(svc.confirm_hold(short_hold.id).status, BookingStatus::UnknownHold);
+    EXPECT_TRUE(svc.confirm_hold(long_hold.id).success);
+}
+
+TEST(Holds, ConfirmAfterTtlFailsEvenBeforeReaperRuns) {
+    BookingService svc;
+    ShowId show = svc.find_show(1, 1);
+
+    auto hold = svc.hold_seats(show, {"a3"}, 0ms);
+    ASSERT_TRUE(hold.success);
+    std::this_thread::sleep_for(5ms);
+    EXPECT_EQ(svc.confirm_hold(hold.id).status, BookingStatus::HoldExpired);
+    EXPECT_EQ(free_seats(svc, show), 20u);
+}
+
+TEST(Holds, CapacityAndRowLimits) {
+    BookingService svc(booking::HallLayout::uniform(6, 4));
+    svc.set_hold_capacity(2);
+    ShowId show = svc.find_show(1, 1);
+
+    EXPECT_EQ(svc.hold_seats(show, {"a1", "b1", "c1", "d1", "e1"}, 60s).status, BookingStatus::HoldTooLarge);
+    auto h1 = svc.hold_seats(show, {"a1"}, 10ms);
+    auto h2 = svc.hold_seats(show, {"a2"}, 10ms);
+    ASSERT_TRUE(h1.success);
+    ASSERT_TRUE(h2.success);
+    EXPECT_EQ(svc.hold_seats(show, {"a3"}, 10ms).status, BookingStatus::HoldCapacity);
+
+    // Failed booking attempt does not leak a slot
+    EXPECT_EQ(svc.hold_seats(show, {"a1"}, 10ms).status, BookingStatus::HoldCapacity);
+
+    // Slots come back once their timers fire
+    EXPECT_EQ(svc.expire_holds(std::chrono::steady_clock::now() + 1s), 2u);
+    auto h3 = svc.hold_seats(show, {"a3"}, 10ms);
+    ASSERT_TRUE(h3.success);
+    EXPECT_NE(h3.id, h1.id); // recycled slots get a new generation
+    EXPECT_EQ(svc.release_hold(h1.id).status, BookingStatus::UnknownHold);
+}
+
+TEST(Holds, ConcurrentHoldsNeverOverlap) {
+    BookingService svc;
+    ShowId show = svc.find_show(1, 1);
+
+    constexpr int kThreads = 8;
+    std::atomic<bool> start{false};
+    std::atomic<int> held{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            while (!start.load()) {
+            }
+            for (int i = 0; i < 20; ++i) {
+                auto r = svc.hold_seat_mask(show, [] {
+                    booking::SeatMask m;
+                    m.or_word(0, 0x3u); // a1 + a2
+                    return m;
+                }(), 60s);
+                if (r.success) {
+                    held.fetch_add(1);
+                    EXPECT_TRUE(svc.release_hold(r.id).success);
+                }
+            }
+        });
+    }
+    start.store(true);
+    for (auto& th : threads) th.join();
+
+    EXPECT_GT(held.load(), 0);
+    EXPECT_EQ(free_seats(svc, show), 20u);
+}
+
+TEST(Holds, ConfirmedHoldCanBeCancelledWithItsBookingId) {
+    BookingService svc;
+    ShowId show = svc.find_show(1, 1);
+
+    auto hold = svc.hold_seats(show, {"a7", "a8"}, 60s);
+    ASSERT_TRUE(hold.success);
+    EXPECT_EQ(svc.cancel_seats(show, {"a7"}, 1u).status, BookingStatus::NotOwner); // held, not booked
+
+    auto confirmed = svc.confirm_hold(hold.id);
+    ASSERT_TRUE(confirmed.success);
+    EXPECT_NE(confirmed.id, 0u);
+    EXPECT_TRUE(svc.cancel_seats(show, {"a7", "a8"}, static_cast<booking::BookingId>(confirmed.id)).success);
+    EXPECT_EQ(free_seats(svc, show), 20u);
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::ShowId;
+using namespace std::chrono_literals;
+
+TEST(HotShows, PromotedShowStillBooksCorrectly) {
+    BookingService svc(booking::HallLayout::single_row(64));
+    const ShowId show = svc.find_show(1, 1);
+    const ShowId other = svc.find_show(1, 2);
+    EXPECT_FALSE(svc.show_is_hot(show));
+    ASSERT_TRUE(svc.set_show_hot(show, true));
+    EXPECT_TRUE(svc.show_is_hot(show));
+    EXPECT_FALSE(svc.show_is_hot(other));
+    EXPECT_FALSE(svc.set_show_hot(999, true));
+
+    constexpr int kThreads = 4;
+    std::atomic<int> booked{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            for (int seat = 0; seat < 64; ++seat) {
+                if (svc.book_seat_indices(show, std::vector<int>{seat}).success) booked.fetch_add(1);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(booked.load(), 64); // each seat sold exactly once
+    EXPECT_EQ(svc.available_count(show), 0);
+    EXPECT_TRUE(svc.book_seats(other, {"a1"}).success);
+
+    const booking::HotShowStats stats = svc.hot_show_stats();
+    EXPECT_EQ(stats.promotions, 1u);
+    EXPECT_EQ(stats.hot, 1u);
+    svc.set_show_hot(show, false);
+    EXPECT_FALSE(svc.show_is_hot(show));
+    EXPECT_EQ(svc.hot_show_stats().demotions, 1u);
+    EXPECT_EQ(svc.hot_show_stats().hot, 0u);
+}
+
+TEST(HotShows, CombiningStrategyBooksEachSeatOnce) {
+    BookingService svc(booking::HallLayout::single_row(64));
+    const ShowId show = svc.find_show(1, 1);
+    booking::HotShowPolicy policy;
+    policy.strategy = booking::HotShowStrategy::Combining;
+    svc.set_hot_show_policy(policy);
+    ASSERT_TRUE(svc.set_show_hot(show, true));
+    EXPECT_TRUE(svc.show_is_hot(show));
+
+    constexpr int kThreads = 4;
+    std::atomic<int> booked{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            for (int seat = 0; seat < 64; ++seat) {
+                if (svc.book_seat_indices(show, std::vector<int>{seat}).success) booked.fetch_add(1);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(booked.load(), 64);
+    EXPECT_EQ(svc.available_count(show), 0);
+    const booking::HotShowStats stats = svc.hot_show_stats();
+    EXPECT_EQ(stats.combined_requests, std::uint64_t{kThreads} * 64u);
+    EXPECT_GE(stats.combining_passes, 1u);
+    EXPECT_STREQ(booking::to_string(booking::HotShowStrategy::Combining), "combining");
+}
+
+TEST(HotShows, IdleShowIsDemoted) {
+    BookingService svc;
+    const ShowId show = svc.find_show(1, 1);
+    booking::HotShowPolicy policy;
+    policy.enabled = true;
+    policy.window = 20ms;
+    policy.demote_requests_per_second = 1000.0;
+    svc.set_hot_show_policy(policy);
+    ASSERT_TRUE(svc.set_show_hot(show, true));
+
+    const auto id = svc.book_seats(show, {"a1"});
+    ASSERT_TRUE(id.success);
+    EXPECT_TRUE(svc.show_is_hot(show));
+    std::this_thread::sleep_for(50ms);
+    // The first request after a quiet window measures the low rate and demotes the show
+    EXPECT_TRUE(svc.cancel_seats(show, {"a1"}, id.id).success);
+    EXPECT_FALSE(svc.show_is_hot(show));
+    EXPECT_EQ(svc.hot_show_stats().demotions, 1u);
+    EXPECT_EQ(svc.available_count(show), 20);
+}
+
+TEST(HotShows, OwnerThreadsModeIgnoresPromotion) {
+    BookingService svc;
+    svc.set_execution_mode(booking::ExecutionMode::OwnerThreads, 2);
+    const ShowId show = svc.find_show(1, 1);
+    EXPECT_TRUE(svc.set_show_hot(show, true));
+    EXPECT_FALSE(svc.show_is_hot(show));
+    EXPECT_TRUE(svc.book_seats(show, {"a1"}).success);
+}
+
+TEST(HotShows, ContendedShowIsPromotedAutomatically) {
+    BookingService svc(booking::HallLayout::single_row(64));
+    const ShowId show = svc.find_show(1, 1);
+    booking::HotShowPolicy policy;
+    policy.enabled = true;
+    policy.window = 500ms; // long enough for a single core, where CAS failures are rare
+    policy.promote_min_failures = 1;
+    policy.promote_failure_ratio = 0.0;
+    policy.demote_requests_per_second = 0.0; // never demote during the test
+    svc.set_hot_show_policy(policy);
+
+    // Threads book and cancel seats of the same word until their CAS operations collide
+    constexpr int kThreads = 4;
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            const std::vector<std::string> seat{"a" + std::to_string(t + 1)};
+            while (!stop.load(std::memory_order_relaxed)) {
+                const auto res = svc.book_seats(show, seat);
+                if (res.success) svc.cancel_seats(show, seat, res.id);
+            }
+        });
+    }
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (!svc.show_is_hot(show) && std::chrono::steady_clock::now() < deadline) std::this_thread::sleep_for(1ms);
+    stop.store(true);
+    for (auto& th : threads) th.join();
+
+    booking::ContentionStats stats;
+    ASSERT_TRUE(svc.contention_stats(show, stats));
+    if (!svc.show_is_hot(show) && stats.cas_retries < 4u) GTEST_SKIP() << "no CAS failures on this machine";
+    EXPECT_TRUE(svc.show_is_hot(show));
+    EXPECT_EQ(svc.hot_show_stats().promotions, 1u);
+    EXPECT_EQ(svc.available_count(show), 64);
+}
+
+TEST(HotShows, ExpectedHotShowIsReadyBeforeTheDrop) {
+    BookingService svc;
+    const ShowId show = svc.find_show(1, 1);
+    booking::HotShowPolicy policy;
+    policy.enabled = true;
+    policy.window = 20ms;
+    policy.demote_requests_per_second = 1000.0;
+    svc.set_hot_show_policy(policy);
+    EXPECT_FALSE(svc.expect_hot(999));
+    ASSERT_TRUE(svc.expect_hot(show));
+    EXPECT_TRUE(svc.show_is_hot(show));
+    EXPECT_TRUE(svc.show_expected_hot(show));
+    EXPECT_EQ(svc.hot_show_stats().promotions, 1u);
+
+    // The payload is already rendered: the first read matches the uncached one
+    std::string cached;
+    std::string plain;
+    EXPECT_EQ(svc.append_cached_available_seats(show, cached), 20);
+    svc.append_available_seats(show, plain, ' ');
+    EXPECT_EQ(cached, plain);
+
+    // A quiet window before the sale opens does not demote it
+    const auto id = svc.book_seats(show, {"a1"});
+    ASSERT_TRUE(id.success);
+    std::this_thread::sleep_for(50ms);
+    EXPECT_TRUE(svc.cancel_seats(show, {"a1"}, id.id).success);
+    EXPECT_TRUE(svc.show_is_hot(show));
+
+    // Once the mark is cleared, load decides again
+    ASSERT_TRUE(svc.expect_hot(show, false));
+    EXPECT_FALSE(svc.show_expected_hot(show));
+    std::this_thread::sleep_for(50ms);
+    EXPECT_TRUE(svc.book_seats(show, {"a2"}).success);
+    EXPECT_FALSE(svc.show_is_hot(show));
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include "booking_id.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using booking::BookingId;
+using booking::BookingIdGenerator;
+
+TEST(BookingIdGenerator, IdsAreNonZeroAndUnique) {
+    BookingIdGenerator gen;
+    std::vector<BookingId> ids;
+    // 0 is skipped, so 3 blocks hold 3 * kBlockSize - 1 ids
+    for (BookingId i = 0; i + 1 < 3 * BookingIdGenerator::kBlockSize; ++i) ids.push_back(gen.next());
+
+    EXPECT_EQ(std::count(ids.begin(), ids.end(), 0u), 0);
+    std::sort(ids.begin(), ids.end());
+    EXPECT_EQ(std::adjacent_find(ids.begin(), ids.end()), ids.end());
+    EXPECT_EQ(gen.reserved(), 3u * BookingIdGenerator::kBlockSize);
+}
+
+TEST(BookingIdGenerator, ThreadsDrawFromSeparateBlocks) {
+    BookingIdGenerator gen;
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 5000;
+    std::vector<std::vector<BookingId>> per_thread(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kPerThread; ++i) per_thread[static_cast<std::size_t>(t)].push_back(gen.next());
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    std::vector<BookingId> all;
+    for (const auto& ids : per_thread) all.insert(all.end(), ids.begin(), ids.end());
+    std::sort(all.begin(), all.end());
+    EXPECT_EQ(std::adjacent_find(all.begin(), all.end()), all.end());
+    EXPECT_NE(all.front(), 0u);
+}
+
+TEST(BookingIdGenerator, GeneratorsDoNotShareCachedBlocks) {
+    // Interleaving two generators on one thread must not hand out ids of the other's block
+    BookingIdGenerator a;
+    BookingIdGenerator b;
+    const BookingId a1 = a.next();
+    const BookingId b1 = b.next();
+    const BookingId a2 = a.next();
+    EXPECT_EQ(a1, 1u);
+    EXPECT_EQ(b1, 1u);
+    EXPECT_EQ(a2, BookingIdGenerator::kBlockSize); // start of a's second block
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "sharded_booking_service.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::SeatMask;
+using booking::ShowId;
+
+TEST(PartialBooking, BooksTheFreeSubset) {
+    BookingService svc(HallLayout::uniform(2, 10));
+    const ShowId show = svc.find_show(1, 1);
+    ASSERT_TRUE(svc.book_seats(show, {"a2", "a4"}).success);
+
+    SeatMask got;
+    const BookingResult r = svc.book_any_seats(show, {"a1", "a2", "a3", "a4", "a5", "b1"}, got);
+    ASSERT_TRUE(r.success) << r.message();
+    EXPECT_EQ(got.word(0), 0x15u); // a1 a3 a5
+    EXPECT_EQ(got.word(1), 0x1u);  // b1
+    EXPECT_EQ(r.conflicts.word(0), 0xAu); // a2 a4 were not obtained
+    EXPECT_EQ(r.conflicts.count(), 2);
+    EXPECT_EQ(svc.seat_owner(show, HallLayout::seat_index(0, 2)), r.id);
+    EXPECT_EQ(svc.available_count(show), 20 - 6);
+    EXPECT_TRUE(svc.cancel_seats(show, {"a1", "a3", "a5", "b1"}, r.id).success);
+
+    // Nothing left to take: a conflict over every requested seat
+    ASSERT_TRUE(svc.book_seats(show, {"a1", "a3"}).success);
+    const BookingResult none = svc.book_any_seats(show, {"a1", "a2", "a3"}, got);
+    EXPECT_EQ(none.status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(none.conflicts.word(0), 0x7u);
+    EXPECT_TRUE(got.empty());
+}
+
+TEST(PartialBooking, ValidatesLikeBookSeats) {
+    BookingService svc(HallLayout::uniform(2, 10));
+    const ShowId show = svc.find_show(1, 1);
+    SeatMask got;
+    EXPECT_EQ(svc.book_any_seats(show, {}, got).status, BookingStatus::NoSeats);
+    EXPECT_EQ(svc.book_any_seats(show, {"a1", "z9"}, got).status, BookingStatus::InvalidSeatLabel);
+    EXPECT_EQ(svc.book_any_seats(999, {"a1"}, got).status, BookingStatus::InvalidShow);
+    SeatMask outside;
+    outside.set(HallLayout::seat_index(0, 10));
+    EXPECT_EQ(svc.book_any_seat_mask(show, outside, got).status, BookingStatus::InvalidSeatIndex);
+    EXPECT_EQ(svc.available_count(show), 20);
+
+    booking::ShardedBookingService sharded(2);
+    SeatMask seats;
+    seats.set(0);
+    EXPECT_TRUE(sharded.book_any_seat_mask(sharded.find_show(1, 1), seats, got).success);
+    EXPECT_EQ(got.count(), 1);
+}
+
+TEST(PartialBooking, SkipsRowsThatWouldBreakTheGapRule) {
+    HallLayout layout = HallLayout::uniform(2, 6);
+    layout.set_forbid_single_gaps(true);
+    BookingService svc(std::move(layout));
+    const ShowId show = svc.find_show(1, 1);
+    ASSERT_TRUE(svc.book_seats(show, {"a1"}).success);
+
+    // Row a's free part a2-a5 would strand a6; row b is taken as requested
+    SeatMask got;
+    const BookingResult r = svc.book_any_seats(show, {"a1", "a2", "a3", "a4", "a5", "b1", "b2"}, got);
+    ASSERT_TRUE(r.success) << r.message();
+    EXPECT_EQ(got.word(0), 0u);
+    EXPECT_EQ(got.word(1), 0x3u);
+    EXPECT_EQ(r.conflicts.word(0), 0x1Fu);
+
+    EXPECT_EQ(svc.book_any_seats(show, {"a1", "a2", "a3", "a4", "a5"}, got).status, BookingStatus::SingleSeatGap);
+    EXPECT_EQ(svc.available_count(show), 12 - 3);
+}
+
+TEST(PartialBooking, ConcurrentRequestsSplitTheHall) {
+    BookingService svc(HallLayout::uniform(3, 20));
+    const ShowId show = svc.find_show(1, 1);
+    SeatMask all;
+    for (int row = 0; row < 3; ++row) all.or_word(row, (std::uint64_t{1} << 20) - 1u);
+
+    // Everyone asks for the whole hall until nothing is left
+    std::vector<std::vector<SeatMask>> taken(4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            SeatMask got;
+            while (true) {
+                const BookingResult r = svc.book_any_seat_mask(show, all, got);
+                if (r.status == BookingStatus::AlreadyBooked) break;
+                if (r.success) taken[static_cast<std::size_t>(t)].push_back(got);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    SeatMask seen;
+    int total = 0;
+    for (const auto& masks : taken) {
+        for (const SeatMask& m : masks) {
+            for (int w = m.first_word(); w < m.end_word(); ++w) {
+                EXPECT_EQ(seen.word(w) & m.word(w), 0u);
+                seen.or_word(w, m.word(w));
+            }
+            total += m.count();
+        }
+    }
+    EXPECT_EQ(total, 60);
+    EXPECT_EQ(svc.available_count(show), 0);
+}
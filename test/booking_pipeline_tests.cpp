@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include "booking_pipeline.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using booking::BookingPipeline;
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::PipelineRequest;
+using booking::ShowId;
+
+namespace {
+
+/** @brief Request counting its completions. */
+struct CountedRequest : PipelineRequest {
+    std::atomic<int>* completed = nullptr;
+};
+
+void count_done(PipelineRequest& request) {
+    static_cast<CountedRequest&>(request).completed->fetch_add(1);
+}
+
+void wait_for(const std::atomic<int>& completed, int expected) {
+    while (completed.load() < expected) std::this_thread::yield();
+}
+
+std::atomic<bool> g_gate_entered{false};
+std::atomic<bool> g_gate_open{false};
+
+/** @brief Completion that holds its worker until the test opens the gate. */
+void gated_done(PipelineRequest& request) {
+    g_gate_entered.store(true);
+    while (!g_gate_open.load()) std::this_thread::yield();
+    count_done(request);
+}
+
+} // namespace
+
+TEST(BookingPipeline, ValidatesBeforeHandingOff) {
+    BookingService svc(HallLayout::uniform(2, 10));
+    const ShowId show = svc.find_show(1, 1);
+    BookingPipeline pipeline(svc, 2);
+    EXPECT_EQ(pipeline.worker_count(), 2u);
+
+    PipelineRequest req;
+    const std::string_view bad[] = {"a1", "z9"};
+    const BookingResult r = pipeline.prepare(req, show, bad);
+    EXPECT_EQ(r.status, BookingStatus::InvalidSeatLabel);
+    EXPECT_EQ(r.label_index, 1);
+    EXPECT_TRUE(req.seats.empty());
+    const std::string_view dup[] = {"a1", "a1"};
+    EXPECT_EQ(pipeline.prepare(req, show, dup).status, BookingStatus::DuplicateSeatLabel);
+    const std::string_view ok[] = {"a1", "b2"};
+    EXPECT_EQ(pipeline.prepare(req, 999, ok).status, BookingStatus::InvalidShow);
+    EXPECT_EQ(pipeline.prepare(req, show, booking::Span<const std::string_view>()).status, BookingStatus::NoSeats);
+
+    ASSERT_TRUE(pipeline.prepare(req, show, ok).success);
+    EXPECT_EQ(req.seats.count(), 2);
+    EXPECT_EQ(svc.available_count(show), 20); // validation touches no seat
+
+    const booking::PipelineStats stats = pipeline.stats();
+    EXPECT_EQ(stats.prepared, 1u);
+    EXPECT_EQ(stats.rejected, 4u);
+    EXPECT_EQ(stats.booked, 0u);
+}
+
+TEST(BookingPipeline, WorkersBookPreparedMasks) {
+    BookingService svc(HallLayout::uniform(4, 20));
+    const ShowId show = svc.find_show(1, 1);
+    BookingPipeline pipeline(svc, 2);
+
+    // Several I/O threads race for pairs of one hot show; each pair is booked exactly once
+    constexpr int kThreads = 4;
+    constexpr int kPairs = 40;
+    std::atomic<int> completed{0};
+    std::vector<std::unique_ptr<CountedRequest[]>> requests;
+    for (int t = 0; t < kThreads; ++t) requests.emplace_back(new CountedRequest[kPairs]);
+    std::vector<std::thread> io;
+    for (int t = 0; t < kThreads; ++t) {
+        io.emplace_back([&, t] {
+            for (int p = 0; p < kPairs; ++p) {
+                const std::string row(1, static_cast<char>('a' + p / 10));
+                const std::string first = row + std::to_string(2 * (p % 10) + 1);
+                const std::string second = row + std::to_string(2 * (p % 10) + 2);
+                const std::string_view labels[] = {first, second};
+                CountedRequest& req = requests[t][p];
+                req.completed = &completed;
+                req.done = count_done;
+                ASSERT_TRUE(pipeline.prepare(req, show, labels).success);
+                pipeline.submit(req);
+            }
+        });
+    }
+    for (std::thread& t : io) t.join();
+    wait_for(completed, kThreads * kPairs);
+
+    int won = 0;
+    for (const auto& per_thread : requests) {
+        for (int p = 0; p < kPairs; ++p) {
+            const CountedRequest& req = per_thread[p];
+            if (req.result.success) {
+                ++won;
+            } else {
+                EXPECT_EQ(req.result.status, BookingStatus::AlreadyBooked);
+            }
+        }
+    }
+    EXPECT_EQ(won, kPairs);
+    EXPECT_EQ(svc.available_count(show), 0);
+    EXPECT_EQ(pipeline.stats().booked, static_cast<std::uint64_t>(kThreads * kPairs));
+}
+
+TEST(BookingPipeline, FullQueuesAnswerBusy) {
+    BookingService svc(HallLayout::uniform(2, 10));
+    const ShowId show = svc.find_show(1, 1);
+    BookingPipeline pipeline(svc, 1, 3);
+    std::atomic<int> completed{0};
+    CountedRequest reqs[6];
+    for (int i = 0; i < 6; ++i) {
+        const std::string label = "a" + std::to_string(i + 1);
+        const std::string_view labels[] = {label};
+        ASSERT_TRUE(pipeline.prepare(reqs[i], show, labels).success);
+        reqs[i].completed = &completed;
+        reqs[i].done = count_done;
+    }
+
+    // Hold the worker inside the first completion, then fill its queue
+    g_gate_entered.store(false);
+    g_gate_open.store(false);
+    reqs[0].done = gated_done;
+    ASSERT_TRUE(pipeline.submit(reqs[0]));
+    while (!g_gate_entered.load()) std::this_thread::yield();
+    EXPECT_TRUE(pipeline.submit(reqs[1]));
+    EXPECT_TRUE(pipeline.submit(reqs[2]));
+    EXPECT_TRUE(pipeline.submit(reqs[3]));
+    EXPECT_EQ(pipeline.queue_depth(0), 3u);
+    EXPECT_FALSE(pipeline.submit(reqs[4]));
+    EXPECT_EQ(reqs[4].result.status, BookingStatus::Busy);
+    EXPECT_EQ(pipeline.stats().busy, 1u);
+    EXPECT_EQ(pipeline.stats().queued, 3u);
+
+    g_gate_open.store(true);
+    wait_for(completed, 4);
+    EXPECT_TRUE(pipeline.submit(reqs[5])); // room again once the queue drained
+    wait_for(completed, 5);
+    const booking::PipelineStats stats = pipeline.stats();
+    EXPECT_EQ(stats.booked, 5u);
+    EXPECT_EQ(stats.max_queued, 3u);
+    EXPECT_EQ(svc.available_count(show), 15);
+}
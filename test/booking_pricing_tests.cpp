@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::PricingPolicy;
+using booking::SeatMask;
+using booking::ShowId;
+
+namespace {
+
+/** @brief 2 rows of 10: row a at 1000, row b at 3000. */
+booking::HallLayout two_price_hall() {
+    booking::HallLayout l = booking::HallLayout::uniform(2, 10);
+    booking::PriceTier front{"front", 1000, {}};
+    front.seats[0] = 0x3FFu;
+    booking::PriceTier back{"back", 3000, {}};
+    back.seats[1] = 0x3FFu;
+    l.set_price_tiers({front, back});
+    return l;
+}
+
+SeatMask seat(int row, int col) {
+    SeatMask m;
+    m.or_word(row, std::uint64_t{1} << col);
+    return m;
+}
+
+/** @brief Discount below half full, list price up to 80 %, +10 % above. */
+PricingPolicy surge_policy(std::chrono::milliseconds interval) {
+    PricingPolicy policy;
+    policy.steps = {{0.8, 10}, {0.0, -10}, {0.5, 0}}; // sorted by the service
+    policy.interval = interval;
+    return policy;
+}
+
+std::vector<std::string> labels(char row, int from, int to) {
+    std::vector<std::string> out;
+    for (int s = from; s <= to; ++s) out.push_back(std::string(1, row) + std::to_string(s));
+    return out;
+}
+
+} // namespace
+
+TEST(DynamicPricing, StepsFollowOccupancy) {
+    BookingService svc(two_price_hall());
+    const ShowId show = svc.find_show(1, 1);
+    const ShowId other = svc.find_show(1, 2);
+    EXPECT_EQ(svc.price_quote(show, seat(0, 0)), 1000u); // no pricing: list price
+    EXPECT_EQ(svc.reprice(), 0u);
+
+    svc.set_dynamic_pricing(surge_policy(std::chrono::hours(1)));
+    EXPECT_EQ(svc.price_table_version(), 1u);
+    EXPECT_EQ(svc.price_adjustment(show), -10);
+    EXPECT_EQ(svc.price_quote(show, seat(0, 0)), 900u);
+
+    ASSERT_TRUE(svc.book_seats(show, labels('a', 1, 10)).success);
+    EXPECT_EQ(svc.price_adjustment(show), -10); // until the next pass
+    EXPECT_GT(svc.reprice(), 1u);
+    EXPECT_EQ(svc.price_adjustment(show), 0);
+    EXPECT_EQ(svc.price_quote(show, seat(1, 0)), 3000u);
+
+    const booking::BookingResult held = svc.hold_seats(show, labels('b', 1, 6), std::chrono::minutes(1));
+    ASSERT_TRUE(held.success);
+    svc.reprice();
+    EXPECT_EQ(svc.price_adjustment(show), 10); // held seats count as taken
+    EXPECT_EQ(svc.price_quote(show, seat(1, 9)), 3300u);
+    EXPECT_EQ(svc.price_adjustment(other), -10);
+    EXPECT_EQ(svc.price_adjustment(99999), 0);
+    EXPECT_EQ(svc.price_quote(99999, seat(0, 0)), 0u);
+    EXPECT_EQ(svc.price_table_version(), 3u);
+
+    svc.set_dynamic_pricing(PricingPolicy{});
+    EXPECT_EQ(svc.price_adjustment(show), 0);
+    EXPECT_EQ(svc.reprice(), 0u);
+}
+
+TEST(DynamicPricing, BackgroundPassesPublishWhileBookingsRun) {
+    BookingService svc(two_price_hall());
+    const ShowId show = svc.find_show(1, 1);
+    svc.set_dynamic_pricing(surge_policy(std::chrono::milliseconds(2)));
+
+    std::thread buyer([&] {
+        for (int s = 1; s <= 10; ++s) {
+            ASSERT_TRUE(svc.book_seats(show, {"a" + std::to_string(s)}).success);
+            ASSERT_TRUE(svc.book_seats(show, {"b" + std::to_string(s)}).success);
+        }
+    });
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (svc.price_adjustment(show) != 10 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield(); // readers never wait for a pass
+    }
+    buyer.join();
+    EXPECT_EQ(svc.price_adjustment(show), 10); // sold out
+    EXPECT_GT(svc.price_table_version(), 1u);
+}
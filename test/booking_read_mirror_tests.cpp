@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::ShowId;
+using namespace std::chrono_literals;
+
+TEST(ReadMirror, ReadsLagUntilRefreshWhileBookingsStayAuthoritative) {
+    BookingService svc;
+    const ShowId show = svc.find_show(1, 1);
+    svc.set_read_mirror(1h); // only the initial and the explicit refreshes below
+    EXPECT_EQ(svc.read_mirror(), std::chrono::microseconds(1h));
+
+    ASSERT_TRUE(svc.book_seats(show, {"a1"}).success);
+    EXPECT_EQ(svc.available_count(show), 20); // mirror still from before the booking
+    EXPECT_EQ(svc.list_available_seats(show).front(), "a1");
+    EXPECT_FALSE(svc.book_seats(show, {"a1"}).success); // the booking path is never stale
+
+    booking::SeatMask free;
+    std::uint64_t version = 0;
+    EXPECT_EQ(svc.availability_if_changed(show, BookingService::kNoVersion, free, version),
+              booking::AvailabilityStatus::Changed);
+    EXPECT_EQ(free.count(), 19);
+
+    EXPECT_GE(svc.refresh_read_mirrors(), 1u);
+    EXPECT_EQ(svc.available_count(show), 19);
+    EXPECT_EQ(svc.list_available_seats(show).front(), "a2");
+    EXPECT_EQ(svc.refresh_read_mirrors(), 0u); // nothing changed since
+
+    svc.set_read_mirror(std::chrono::microseconds::zero());
+    ASSERT_TRUE(svc.book_seats(show, {"a2"}).success);
+    EXPECT_EQ(svc.available_count(show), 18); // live again
+}
+
+TEST(ReadMirror, LargeHallsAreMirroredToo) {
+    BookingService svc(booking::HallLayout::uniform(16, 32));
+    const ShowId show = svc.find_show(1, 1);
+    svc.set_read_mirror(1h);
+    ASSERT_TRUE(svc.book_seats(show, {"p32"}).success);
+    EXPECT_EQ(svc.available_count(show), 512);
+    svc.refresh_read_mirrors();
+    EXPECT_EQ(svc.available_count(show), 511);
+    booking::SeatMask free;
+    EXPECT_EQ(svc.available_seats_mask(show, free), 511);
+}
+
+TEST(ReadMirror, RefresherCatchesUp) {
+    BookingService svc;
+    const ShowId show = svc.find_show(1, 1);
+    svc.set_read_mirror(1ms);
+    ASSERT_TRUE(svc.book_seats(show, {"a1", "a2"}).success);
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (svc.available_count(show) != 18 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_EQ(svc.available_count(show), 18);
+}
+
+TEST(ReadMirror, ConcurrentReadersSeeConsistentCounts) {
+    BookingService svc(booking::HallLayout::uniform(8, 8));
+    const ShowId show = svc.find_show(1, 1);
+    svc.set_read_mirror(100us);
+    std::atomic<bool> stop{false};
+    std::atomic<int> bad{0};
+    std::thread reader([&] {
+        while (!stop.load()) {
+            const int n = svc.available_count(show);
+            if (n < 0 || n > 64) bad.fetch_add(1);
+        }
+    });
+    for (int round = 0; round < 200; ++round) {
+        const std::vector<std::string> seat{"a" + std::to_string(round % 8 + 1)};
+        const auto res = svc.book_seats(show, seat);
+        if (res.success) svc.cancel_seats(show, seat, res.id);
+    }
+    stop.store(true);
+    reader.join();
+    EXPECT_EQ(bad.load(), 0);
+    svc.refresh_read_mirrors();
+    EXPECT_EQ(svc.available_count(show), 64);
+}
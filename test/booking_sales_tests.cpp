@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::CatalogStatus;
+using booking::Movie;
+using booking::SalesState;
+using booking::SeatMask;
+using booking::Show;
+using booking::ShowId;
+using booking::Theater;
+using namespace std::chrono_literals;
+
+TEST(SalesWindow, ClosedShowsRejectEveryBookingPath) {
+    BookingService svc(booking::HallLayout::uniform(4, 10));
+    const ShowId show = svc.find_show(1, 1);
+    EXPECT_EQ(svc.sales_state(show), SalesState::Open);
+    const booking::BookingResult held = svc.hold_seats(show, {"d1"}, 1min);
+    ASSERT_TRUE(held.success);
+    ASSERT_TRUE(svc.book_seats(show, {"a1"}).success);
+
+    ASSERT_TRUE(svc.set_sales_state(show, SalesState::NotOpen));
+    EXPECT_EQ(svc.sales_state(show), SalesState::NotOpen);
+    EXPECT_EQ(svc.book_seats(show, {"a2"}).status, BookingStatus::SalesClosed);
+    EXPECT_EQ(svc.book_seats(show, {"a2", "c2"}).status, BookingStatus::SalesClosed); // several rows
+    EXPECT_EQ(svc.hold_seats(show, {"b1"}, 1min).status, BookingStatus::SalesClosed);
+    SeatMask got;
+    EXPECT_EQ(svc.book_best_available(show, 2, got).status, BookingStatus::SalesClosed);
+    EXPECT_EQ(svc.book_any_seats(show, {"a1", "a3"}, got).status, BookingStatus::SalesClosed);
+    EXPECT_EQ(svc.available_count(show), 38);
+    EXPECT_TRUE(svc.confirm_hold(held.id).success); // taken before the close
+
+    ASSERT_TRUE(svc.set_sales_state(show, SalesState::Open));
+    EXPECT_TRUE(svc.book_seats(show, {"a2"}).success);
+    EXPECT_FALSE(svc.set_sales_state(99999, SalesState::Closed));
+    EXPECT_EQ(svc.sales_state(99999), SalesState::Closed);
+    EXPECT_STREQ(booking::to_string(SalesState::Blackout), "blackout");
+    EXPECT_STREQ(booking::to_string(BookingStatus::SalesClosed), "Show is not on sale");
+}
+
+TEST(SalesWindow, NoBookingLandsAfterTheCloseReturns) {
+    BookingService svc(booking::HallLayout::uniform(26, 40));
+    const ShowId show = svc.find_show(1, 1);
+    std::atomic<bool> closed{false};
+    std::atomic<bool> late{false}; // a booking that succeeded after the close returned
+    std::vector<std::thread> buyers;
+    for (int t = 0; t < 4; ++t) {
+        buyers.emplace_back([&, t] {
+            for (int i = t; i < 26 * 40; i += 4) {
+                const bool after = closed.load();
+                const std::string label = std::string(1, static_cast<char>('a' + i / 40)) + std::to_string(i % 40 + 1);
+                const booking::BookingResult r = svc.book_seats(show, {label});
+                if (after && r.success) late.store(true);
+                if (after) {
+                    EXPECT_EQ(r.status, BookingStatus::SalesClosed);
+                }
+            }
+        });
+    }
+    std::this_thread::sleep_for(1ms);
+    ASSERT_TRUE(svc.set_sales_state(show, SalesState::Closed));
+    closed.store(true);
+    const int left = svc.available_count(show);
+    for (std::thread& t : buyers) t.join();
+    EXPECT_FALSE(late.load());
+    EXPECT_EQ(svc.available_count(show), left);
+}
+
+TEST(SalesWindow, StartedShowsClose) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{1, "Central"}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(2, 10));
+    ASSERT_EQ(svc.add_show(Show{1, 1, 1, hall, 100}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{2, 1, 1, hall, 200}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{3, 1, 1, hall, 300}), CatalogStatus::Ok);
+    ASSERT_TRUE(svc.set_sales_state(3, SalesState::Blackout));
+
+    EXPECT_EQ(svc.close_started_shows(200), 2u);
+    EXPECT_EQ(svc.sales_state(1), SalesState::Closed);
+    EXPECT_EQ(svc.sales_state(2), SalesState::Closed);
+    EXPECT_EQ(svc.sales_state(3), SalesState::Blackout);
+    EXPECT_EQ(svc.close_started_shows(200), 0u);
+    EXPECT_EQ(svc.book_seats(2, {"a1"}).status, BookingStatus::SalesClosed);
+    EXPECT_EQ(svc.close_started_shows(1000), 0u); // blacked out shows stay as they are
+}
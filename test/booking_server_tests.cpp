@@ -0,0 +1,327 @@
+#include <gtest/gtest.h>
+
+#include "booking_server.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+using booking::BookingServer;
+using booking::BookingService;
+using booking::ServerStatus;
+
+namespace {
+
+int connect_to(std::uint16_t port) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void send_all(int fd, const std::string& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, 0);
+        ASSERT_GT(n, 0);
+        sent += static_cast<std::size_t>(n);
+    }
+}
+
+/** @brief Reads until @p status_lines lines starting with OK/ERR arrived (or EOF). */
+std::string read_responses(int fd, int status_lines) {
+    std::string in;
+    int seen = 0;
+    std::size_t scanned = 0;
+    char buf[4096];
+    while (seen < status_lines) {
+        const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        in.append(buf, static_cast<std::size_t>(n));
+        std::size_t nl;
+        while ((nl = in.find('\n', scanned)) != std::string::npos) {
+            if (in.compare(scanned, 2, "OK") == 0 || in.compare(scanned, 3, "ERR") == 0) ++seen;
+            scanned = nl + 1u;
+        }
+    }
+    return in;
+}
+
+booking::BookingServerOptions with_backend(booking::ServerBackend backend) {
+    booking::BookingServerOptions options;
+    options.backend = backend;
+    options.recv_buffer = 512; // several receives per pipelined batch
+    return options;
+}
+
+class ServerFixture : public ::testing::TestWithParam<booking::ServerBackend> {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(server_.listen(), ServerStatus::Ok);
+        if (GetParam() == booking::ServerBackend::Epoll) {
+            EXPECT_EQ(server_.backend(), booking::ServerBackend::Epoll);
+        }
+        ASSERT_NE(server_.port(), 0u);
+        thread_ = std::thread([this] { server_.run(); });
+    }
+    void TearDown() override {
+        server_.stop();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    BookingService svc_;
+    BookingServer server_{svc_, with_backend(GetParam())};
+    std::thread thread_;
+};
+
+} // namespace
+
+TEST_P(ServerFixture, AnswersPipelinedRequestsInOrder) {
+    const int fd = connect_to(server_.port());
+    ASSERT_GE(fd, 0);
+    // Three requests in one segment, the last one split across two writes
+    send_all(fd, "book 1 1 a1\nbook 1 1 a1\ntheat");
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    send_all(fd, "ers 1\n");
+    const std::string got = read_responses(fd, 3);
+    EXPECT_EQ(got.substr(got.find('\n') + 1),
+              "ERR 5 One or more seats already booked taken=a1 try=a2\n1 Central Cinema\n2 Mall Theater\nOK 2\n");
+    EXPECT_EQ(got.rfind("OK ", 0), 0u);
+
+    send_all(fd, "quit\n");
+    EXPECT_EQ(read_responses(fd, 1), "OK\n");
+    char c;
+    EXPECT_EQ(::recv(fd, &c, 1, 0), 0); // closed by the server
+    ::close(fd);
+}
+
+TEST_P(ServerFixture, ServesManyConnectionsAndDeepPipelines) {
+    constexpr int kClients = 8;
+    constexpr int kRequests = 2000;
+    std::thread clients[kClients];
+    int ok[kClients] = {};
+    for (int c = 0; c < kClients; ++c) {
+        clients[c] = std::thread([&, c] {
+            const int fd = connect_to(server_.port());
+            ASSERT_GE(fd, 0);
+            std::string batch;
+            for (int i = 0; i < kRequests; ++i) batch += "book 1 2 a" + std::to_string(1 + (i % 20)) + "\n";
+            send_all(fd, batch);
+            const std::string got = read_responses(fd, kRequests);
+            for (std::size_t pos = 0; (pos = got.find("OK ", pos)) != std::string::npos; ++pos) ++ok[c];
+            ::close(fd);
+        });
+    }
+    for (auto& t : clients) t.join();
+    int total = 0;
+    for (int n : ok) total += n;
+    EXPECT_EQ(total, 20); // every seat of show 2 sold exactly once
+    EXPECT_EQ(svc_.available_count(2), 0);
+}
+
+TEST_P(ServerFixture, SpeaksTheBinaryProtocol) {
+    const int fd = connect_to(server_.port());
+    ASSERT_GE(fd, 0);
+    booking::SeatMask seats;
+    seats.set(0);
+    seats.set(1);
+    std::string req;
+    booking::encode_mask_request(req, booking::WireOp::BookMask, 1, 10, seats);
+    booking::encode_mask_request(req, booking::WireOp::BookMask, 1, 11, seats);
+    booking::encode_request(req, booking::WireOp::AvailableCount, 1, 12);
+    // Sent in two pieces cut inside the second frame
+    send_all(fd, req.substr(0, 60));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    send_all(fd, req.substr(60));
+
+    std::string got;
+    char buf[256];
+    while (got.size() < 3 * booking::kWireResponseSize) {
+        const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        ASSERT_GT(n, 0);
+        got.append(buf, static_cast<std::size_t>(n));
+    }
+    booking::WireResponse r[3];
+    for (int i = 0; i < 3; ++i) ASSERT_TRUE(booking::decode_response(got.data() + booking::kWireResponseSize * i, booking::kWireResponseSize, r[i]));
+    EXPECT_EQ(r[0].request_id, 10u);
+    EXPECT_EQ(r[0].status, booking::BookingStatus::Ok);
+    EXPECT_NE(r[0].id, 0u);
+    EXPECT_EQ(r[1].status, booking::BookingStatus::AlreadyBooked);
+    EXPECT_EQ(r[2].value, 18);
+
+    send_all(fd, std::string(booking::kWireHeaderSize, '\xB1')); // bad op: the server hangs up
+    EXPECT_EQ(::recv(fd, buf, sizeof(buf), 0), 0);
+    ::close(fd);
+}
+
+TEST_P(ServerFixture, ClosesAfterAMalformedFrameWithoutFurtherInput) {
+    const int fd = connect_to(server_.port());
+    ASSERT_GE(fd, 0);
+    const timeval timeout{5, 0}; // a hang fails the test instead of blocking it
+    ASSERT_EQ(::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)), 0);
+    // Nothing answered before the bad frame: the close must not wait for more input
+    send_all(fd, std::string(booking::kWireHeaderSize, '\xB1'));
+    char buf[64];
+    EXPECT_EQ(::recv(fd, buf, sizeof(buf), 0), 0);
+    ::close(fd);
+}
+
+TEST_P(ServerFixture, SpeaksHttp) {
+    const int fd = connect_to(server_.port());
+    ASSERT_GE(fd, 0);
+    // Two pipelined keep-alive requests, then one that closes the connection
+    send_all(fd, "GET /movies/1/theaters HTTP/1.1\r\n\r\nPOST /shows/1/1/book HTTP/1.1\r\nContent-Length: 2\r\n\r\na1"
+                 "GET /movies/2/theaters HTTP/1.1\r\nConnection: close\r\n\r\n");
+    std::string got;
+    char buf[1024];
+    for (ssize_t n; (n = ::recv(fd, buf, sizeof(buf), 0)) > 0;) got.append(buf, static_cast<std::size_t>(n));
+    ::close(fd);
+
+    const std::size_t created = got.find("HTTP/1.1 201 Created\r\n");
+    const std::size_t last = got.rfind("HTTP/1.1 200 OK\r\n");
+    EXPECT_EQ(got.rfind("HTTP/1.1 200 OK\r\n", 0), 0u) << got;
+    EXPECT_NE(got.find(R"([{"id":1,"name":"Central Cinema"},{"id":2,"name":"Mall Theater"}])"), std::string::npos);
+    ASSERT_NE(created, std::string::npos);
+    EXPECT_GT(last, created);
+    EXPECT_NE(got.find("Connection: close\r\n", last), std::string::npos);
+    EXPECT_EQ(svc_.available_count(1), 19);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, ServerFixture,
+                         ::testing::Values(booking::ServerBackend::Epoll, booking::ServerBackend::IoUring),
+                         [](const ::testing::TestParamInfo<booking::ServerBackend>& info) {
+                             return std::string(info.param == booking::ServerBackend::Epoll ? "Epoll" : "IoUring");
+                         });
+
+TEST(BookingServer, BusyPollingServesWithoutSleeping) {
+    for (const auto backend : {booking::ServerBackend::Epoll, booking::ServerBackend::IoUring}) {
+        BookingService svc;
+        booking::BookingServerOptions options = with_backend(backend);
+        options.busy_poll_us = 50;
+        BookingServer server(svc, options);
+        ASSERT_EQ(server.listen(), ServerStatus::Ok);
+        std::thread loop([&] { server.run(); });
+
+        const int fd = connect_to(server.port());
+        ASSERT_GE(fd, 0);
+        send_all(fd, "book 1 1 a1\nseats 1 1\n");
+        const std::string got = read_responses(fd, 2);
+        EXPECT_EQ(got.rfind("OK ", 0), 0u) << got;
+        EXPECT_NE(got.find("OK 19\n"), std::string::npos) << got;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        EXPECT_GT(server.idle_polls(), 0u); // spun while the client was quiet
+
+        ::close(fd);
+        server.stop();
+        loop.join();
+    }
+}
+
+TEST(BookingServer, PinsSessionsToTheirShowsOwner) {
+    BookingService svc;
+    svc.set_execution_mode(booking::ExecutionMode::OwnerThreads, 2);
+    BookingServer server(svc, with_backend(booking::ServerBackend::Epoll));
+    ASSERT_EQ(server.listen(), ServerStatus::Ok);
+    std::thread loop([&] { server.run(); });
+
+    // The first batch names the show; the following ones run on its owner
+    const int fd = connect_to(server.port());
+    ASSERT_GE(fd, 0);
+    send_all(fd, "seats 1 1\n");
+    EXPECT_NE(read_responses(fd, 1).find("OK 20\n"), std::string::npos);
+    EXPECT_EQ(server.pinned_batches(), 0u);
+    send_all(fd, "book 1 1 a1 a2\nseats 1 1\n");
+    std::string got = read_responses(fd, 2);
+    EXPECT_EQ(got.rfind("OK ", 0), 0u) << got;
+    EXPECT_NE(got.find("OK 18\n"), std::string::npos) << got;
+    send_all(fd, "book 1 2 a1\nbook 1 1 a1\n"); // another show in the same batch still books
+    got = read_responses(fd, 2);
+    EXPECT_EQ(got.rfind("OK ", 0), 0u) << got;
+    EXPECT_NE(got.find("ERR 5"), std::string::npos) << got;
+    EXPECT_EQ(server.pinned_batches(), 2u);
+
+    // A second session has its own routes and starts unpinned
+    const int other = connect_to(server.port());
+    ASSERT_GE(other, 0);
+    send_all(other, "seats 1 2\n");
+    EXPECT_NE(read_responses(other, 1).find("OK 19\n"), std::string::npos);
+    EXPECT_EQ(server.pinned_batches(), 2u);
+
+    ::close(fd);
+    ::close(other);
+    server.stop();
+    loop.join();
+}
+
+TEST(BookingServer, ReadOnlyCanBeSwitchedOffWhileServing) {
+    BookingService svc;
+    booking::BookingServerOptions options = with_backend(booking::ServerBackend::Epoll);
+    options.read_only = true;
+    BookingServer server(svc, options);
+    ASSERT_EQ(server.listen(), ServerStatus::Ok);
+    std::thread loop([&] { server.run(); });
+
+    const int fd = connect_to(server.port());
+    ASSERT_GE(fd, 0);
+    send_all(fd, "book 1 1 a1\n");
+    EXPECT_EQ(read_responses(fd, 1).rfind("ERR", 0), 0u);
+    EXPECT_TRUE(server.read_only());
+    server.set_read_only(false); // e.g. a promoted standby: the open connection may book now
+    send_all(fd, "book 1 1 a1\n");
+    EXPECT_EQ(read_responses(fd, 1).rfind("OK ", 0), 0u);
+
+    ::close(fd);
+    server.stop();
+    loop.join();
+}
+
+TEST(BookingServer, ReportsBindErrors) {
+    BookingService svc;
+    booking::BookingServerOptions options;
+    options.host = "not-an-address";
+    BookingServer server(svc, options);
+    EXPECT_EQ(server.listen(), ServerStatus::BindError);
+}
+
+TEST(BookingServer, LimitsEachClientsRequestRate) {
+    BookingService svc;
+    booking::BookingServerOptions options;
+    options.backend = booking::ServerBackend::Epoll;
+    options.client_rate = booking::RateLimit{0.001, 3}; // three requests, then one per 1000 s
+    BookingServer server(svc, options);
+    ASSERT_EQ(server.listen(), ServerStatus::Ok);
+    std::thread loop([&] { server.run(); });
+
+    const int fd = connect_to(server.port());
+    ASSERT_GE(fd, 0);
+    send_all(fd, "book 1 1 a1\nbook 1 1 a2\nseats 1 1\nbook 1 1 a3\nbook 1 1 not-a-seat\n");
+    const std::string got = read_responses(fd, 5);
+    EXPECT_EQ(got.substr(got.find("OK 18\n")), "OK 18\nERR 15 Too many requests, retry later\n"
+                                                "ERR 15 Too many requests, retry later\n");
+    EXPECT_EQ(svc.available_count(1), 18);
+
+    // The budget belongs to the address, not the connection
+    const int again = connect_to(server.port());
+    ASSERT_GE(again, 0);
+    send_all(again, "movies\n");
+    EXPECT_EQ(read_responses(again, 1), "ERR 15 Too many requests, retry later\n");
+    EXPECT_EQ(server.rate_limit_stats().rejected, 3u);
+    EXPECT_EQ(server.rate_limit_stats().clients, 1u);
+
+    ::close(fd);
+    ::close(again);
+    server.stop();
+    loop.join();
+}
@@ -1,8 +1,10 @@
 #include <gtest/gtest.h>
 
 #include "booking_service.hpp"
+#include "seat_runs.hpp"
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <thread>
 #include <vector>
@@ -143,8 +145,8 @@ TEST(Booking, RejectDuplicateLabelsInSameRequest) {
 
     auto res = svc.book_seats(show, {"a1", "a1"});
     EXPECT_FALSE(res.success);
-    EXPECT_TRUE(res.message.find("Duplicate") != std::string::npos
-                || res.message.find("duplicate") != std::string::npos);
+    EXPECT_TRUE(res.message().find("Duplicate") != std::string::npos
+                || res.message().find("duplicate") != std::string::npos);
 }
 
 TEST(Booking, SuccessfulBookingMarksSeatsUnavailable) {
@@ -231,3 +233,979 @@ TEST(Concurrency, OnlyOneThreadCanBookSameSeat) {
     auto seats = svc.list_available_seats(show);
     EXPECT_FALSE(contains(seats, "a1"));
 }
+
+// ---------- Tests: multi-row layouts ----------
+TEST(MultiRow, AllSeatsOfLayoutAvailable) {
+    BookingService svc(booking::HallLayout::uniform(3, 40));
+    ShowId show = svc.find_show(1, 1);
+    ASSERT_NE(show, -1);
+
+    auto seats = svc.list_available_seats(show);
+    ASSERT_EQ(seats.size(), 120u);
+    EXPECT_EQ(seats.front(), "a1");
+    EXPECT_EQ(seats.back(), "c40");
+    ASSERT_NE(svc.layout_for_show(show), nullptr);
+    EXPECT_EQ(svc.layout_for_show(show)->seat_count(), 120);
+}
+
+TEST(MultiRow, AppendsFreeSeatLabelsToABuffer) {
+    BookingService svc(booking::HallLayout::uniform(2, 3));
+    ShowId show = svc.find_show(1, 1);
+    ASSERT_TRUE(svc.book_seats(show, {"a2", "b1", "b3"}).success);
+
+    std::string out = "seats: ";
+    EXPECT_EQ(svc.append_available_seats(show, out), 3);
+    EXPECT_EQ(out, "seats: a1 a3 b2");
+    out.clear();
+    EXPECT_EQ(svc.append_available_seats(show, out, ','), 3);
+    EXPECT_EQ(out, "a1,a3,b2");
+    EXPECT_EQ(svc.append_available_seats(999, out), -1);
+    EXPECT_EQ(out, "a1,a3,b2");
+}
+
+TEST(MultiRow, CachedAvailabilityFollowsEveryChange) {
+    BookingService svc(booking::HallLayout::uniform(2, 3));
+    ShowId show = svc.find_show(1, 1);
+    auto both = [&](std::string& cached) {
+        std::string fresh;
+        const int n = svc.append_available_seats(show, fresh);
+        cached.clear();
+        EXPECT_EQ(svc.append_cached_available_seats(show, cached), n);
+        EXPECT_EQ(cached, fresh);
+        return n;
+    };
+
+    std::string out;
+    EXPECT_EQ(both(out), 6);
+    EXPECT_EQ(both(out), 6); // served from the cache
+    const auto booked = svc.book_seats(show, {"a2", "b1"});
+    ASSERT_TRUE(booked.success);
+    EXPECT_EQ(both(out), 4);
+    EXPECT_EQ(out, "a1 a3 b2 b3");
+    ASSERT_TRUE(svc.cancel_seats(show, {"b1"}, static_cast<booking::BookingId>(booked.id)).success);
+    EXPECT_EQ(both(out), 5);
+
+    out = "x";
+    EXPECT_EQ(svc.append_cached_available_seats(999, out), -1);
+    EXPECT_EQ(out, "x");
+}
+
+TEST(MultiRow, CachedAvailabilityUnderConcurrentBookings) {
+    BookingService svc(booking::HallLayout::uniform(4, 16));
+    ShowId show = svc.find_show(1, 1);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&] {
+            std::string out;
+            while (!done.load()) {
+                out.clear();
+                const int n = svc.append_cached_available_seats(show, out);
+                // Every payload is a consistent rendering: n labels separated by n - 1 spaces
+                ASSERT_GE(n, 0);
+                EXPECT_EQ(std::count(out.begin(), out.end(), ' '), n == 0 ? 0 : n - 1);
+            }
+        });
+    }
+    booking::SeatMask seats;
+    for (int i = 0; i < 2000; ++i) {
+        const auto r = svc.book_best_available(show, 1 + i % 4, seats);
+        if (r.success && i % 3 != 0) svc.cancel_seat_mask(show, seats, static_cast<booking::BookingId>(r.id));
+    }
+    done.store(true);
+    for (auto& r : readers) r.join();
+
+    std::string cached;
+    std::string fresh;
+    EXPECT_EQ(svc.append_cached_available_seats(show, cached), svc.append_available_seats(show, fresh));
+    EXPECT_EQ(cached, fresh);
+}
+
+TEST(MultiRow, AvailabilityIfChangedSkipsUnchangedShows) {
+    BookingService svc(booking::HallLayout::uniform(2, 8));
+    ShowId show = svc.find_show(1, 1);
+    booking::SeatMask seats;
+    std::uint64_t version = 0;
+    ASSERT_EQ(svc.availability_if_changed(show, BookingService::kNoVersion, seats, version),
+              booking::AvailabilityStatus::Changed);
+    EXPECT_EQ(seats.count(), 16);
+
+    std::uint64_t unchanged = 12345;
+    EXPECT_EQ(svc.availability_if_changed(show, version, seats, unchanged), booking::AvailabilityStatus::Unchanged);
+    EXPECT_EQ(unchanged, 12345u); // untouched
+    EXPECT_EQ(svc.available_count(show), 16);
+    EXPECT_FALSE(svc.book_seats(show, {"a1", "z9"}).success); // nothing set: still unchanged
+    EXPECT_EQ(svc.availability_if_changed(show, version, seats, unchanged), booking::AvailabilityStatus::Unchanged);
+
+    // Every kind of update moves the version
+    const std::uint64_t before = version;
+    const auto booked = svc.book_seats(show, {"a1", "b2"});
+    ASSERT_TRUE(booked.success);
+    ASSERT_EQ(svc.availability_if_changed(show, version, seats, version), booking::AvailabilityStatus::Changed);
+    EXPECT_GT(version, before);
+    EXPECT_FALSE(seats.test(booking::HallLayout::seat_index(0, 0)));
+    EXPECT_EQ(seats.count(), 14);
+    const auto hold = svc.hold_seats(show, {"a5"}, std::chrono::minutes(1));
+    ASSERT_TRUE(hold.success);
+    EXPECT_EQ(svc.availability_if_changed(show, version, seats, version), booking::AvailabilityStatus::Changed);
+    ASSERT_TRUE(svc.release_hold(hold.id).success);
+    EXPECT_EQ(svc.availability_if_changed(show, version, seats, version), booking::AvailabilityStatus::Changed);
+    ASSERT_TRUE(svc.cancel_seats(show, {"b2"}, static_cast<booking::BookingId>(booked.id)).success);
+    EXPECT_EQ(svc.availability_if_changed(show, version, seats, version), booking::AvailabilityStatus::Changed);
+    EXPECT_EQ(seats.count(), 15);
+    EXPECT_EQ(svc.availability_if_changed(show, version, seats, version), booking::AvailabilityStatus::Unchanged);
+
+    EXPECT_EQ(svc.availability_if_changed(999, version, seats, version), booking::AvailabilityStatus::UnknownShow);
+    EXPECT_STREQ(booking::to_string(booking::AvailabilityStatus::Unchanged), "Seats unchanged");
+}
+
+TEST(MultiRow, ReadersNeverSeeHalfAGroupBooking) {
+    BookingService svc(booking::HallLayout::uniform(3, 10));
+    ShowId show = svc.find_show(1, 1);
+    const int group[] = {booking::HallLayout::seat_index(0, 0), booking::HallLayout::seat_index(1, 4),
+                         booking::HallLayout::seat_index(2, 9)}; // a1 b5 c10
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int i = 0; i < 3000; ++i) {
+            const auto r = svc.book_seat_indices(show, booking::Span<const int>(group, 3));
+            ASSERT_TRUE(r.success);
+            if (i % 2 == 0) {
+                ASSERT_TRUE(svc.cancel_seats(show, {"a1", "b5", "c10"}, static_cast<booking::BookingId>(r.id)).success);
+            } else {
+                booking::SeatMask seats;
+                for (int seat : group) seats.set(seat);
+                ASSERT_TRUE(svc.cancel_seat_mask(show, seats, static_cast<booking::BookingId>(r.id)).success);
+            }
+            const auto hold = svc.hold_seats(show, {"a1", "b5", "c10"}, std::chrono::minutes(1));
+            ASSERT_TRUE(hold.success);
+            ASSERT_TRUE(svc.release_hold(hold.id).success);
+        }
+        done.store(true);
+    });
+    int reads = 0;
+    while (!done.load() || reads == 0) {
+        booking::SeatMask free_seats;
+        const int n = svc.available_seats_mask(show, free_seats);
+        EXPECT_TRUE(n == 30 || n == 27) << n;
+        EXPECT_EQ(free_seats.test(group[0]), free_seats.test(group[1]));
+        EXPECT_EQ(free_seats.test(group[1]), free_seats.test(group[2]));
+        ++reads;
+    }
+    writer.join();
+}
+
+TEST(MultiRow, BookSeatsWithinOneRow) {
+    BookingService svc(booking::HallLayout::uniform(3, 40));
+    ShowId show = svc.find_show(1, 1);
+
+    auto res = svc.book_seats(show, {"c10", "C11", "c40"});
+    ASSERT_TRUE(res.success) << res.message();
+
+    auto seats = svc.list_available_seats(show);
+    EXPECT_EQ(seats.size(), 117u);
+    EXPECT_FALSE(contains(seats, "c10"));
+    EXPECT_FALSE(contains(seats, "c11"));
+    EXPECT_FALSE(contains(seats, "c40"));
+    EXPECT_TRUE(contains(seats, "b10"));
+
+    EXPECT_FALSE(svc.book_seats(show, {"c11"}).success);
+    EXPECT_FALSE(svc.book_seats(show, {"c41"}).success);
+    EXPECT_FALSE(svc.book_seats(show, {"d1"}).success);
+}
+
+TEST(MultiRow, RowsAreIndependentWords) {
+    BookingService svc(booking::HallLayout::uniform(2, 64));
+    ShowId show = svc.find_show(1, 1);
+
+    EXPECT_TRUE(svc.book_seats(show, {"a64"}).success);
+    EXPECT_TRUE(svc.book_seats(show, {"b1"}).success);
+    EXPECT_EQ(svc.list_available_seats(show).size(), 126u);
+}
+
+TEST(MultiRow, GroupBookingAcrossRows) {
+    BookingService svc(booking::HallLayout::uniform(4, 20));
+    ShowId show = svc.find_show(1, 1);
+
+    auto res = svc.book_seats(show, {"c10", "c11", "d10", "d11"});
+    ASSERT_TRUE(res.success) << res.message();
+
+    auto seats = svc.list_available_seats(show);
+    EXPECT_EQ(seats.size(), 76u);
+    EXPECT_FALSE(contains(seats, "c10"));
+    EXPECT_FALSE(contains(seats, "d11"));
+}
+
+TEST(MultiRow, GroupBookingAcrossRowsIsAllOrNothing) {
+    BookingService svc(booking::HallLayout::uniform(4, 20));
+    ShowId show = svc.find_show(1, 1);
+
+    ASSERT_TRUE(svc.book_seats(show, {"d11"}).success);
+
+    // Rows a..c are free, d11 is taken: nothing must be booked
+    auto res = svc.book_seats(show, {"a1", "b1", "c1", "d11"});
+    EXPECT_FALSE(res.success);
+
+    auto seats = svc.list_available_seats(show);
+    EXPECT_EQ(seats.size(), 79u);
+    EXPECT_TRUE(contains(seats, "a1"));
+    EXPECT_TRUE(contains(seats, "b1"));
+    EXPECT_TRUE(contains(seats, "c1"));
+}
+
+TEST(Concurrency, OverlappingGroupBookingsNeverDoubleBook) {
+    BookingService svc(booking::HallLayout::uniform(4, 8));
+    ShowId show = svc.find_show(1, 1);
+
+    // Thread t books column t+1 and t+2 in every row, so neighbours always overlap
+    constexpr int kThreads = 7;
+    std::atomic<bool> start{false};
+    std::atomic<int> booked_seats{0};
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            std::vector<std::string> req;
+            for (const char* row : {"a", "b", "c", "d"}) {
+                req.push_back(row + std::to_string(t + 1));
+                req.push_back(row + std::to_string(t + 2));
+            }
+            while (!start.load()) {
+            }
+            if (svc.book_seats(show, req).success) {
+                booked_seats.fetch_add(static_cast<int>(req.size()));
+            }
+        });
+    }
+    start.store(true);
+    for (auto& th : threads) th.join();
+
+    EXPECT_GT(booked_seats.load(), 0);
+    EXPECT_EQ(svc.list_available_seats(show).size(), 32u - static_cast<unsigned>(booked_seats.load()));
+}
+
+TEST(BookingServiceData, FindShowsForPair) {
+    BookingService svc;
+
+    auto shows = svc.find_shows(1, 2);
+    ASSERT_EQ(shows.size(), 1u);
+    EXPECT_EQ(shows[0], 2);
+
+    EXPECT_TRUE(svc.find_shows(2, 2).empty());
+    EXPECT_EQ(svc.find_show(-1, 1), -1);
+}
+
+TEST(Availability, BitmapSnapshotMatchesLabels) {
+    BookingService svc(booking::HallLayout::uniform(2, 10));
+    ShowId show = svc.find_show(1, 1);
+    ASSERT_TRUE(svc.book_seats(show, {"a1", "b10"}).success);
+
+    booking::SeatMask free;
+    EXPECT_EQ(svc.available_seats_mask(show, free), 18);
+    EXPECT_EQ(free.count(), 18);
+    EXPECT_FALSE(free.test(booking::HallLayout::seat_index(0, 0)));
+    EXPECT_TRUE(free.test(booking::HallLayout::seat_index(0, 1)));
+    EXPECT_FALSE(free.test(booking::HallLayout::seat_index(1, 9)));
+    EXPECT_EQ(free.word(1), 0x1FFu);
+
+    EXPECT_EQ(svc.available_seats_mask(999, free), -1);
+    EXPECT_TRUE(free.empty());
+}
+
+TEST(Booking, StatusCodesAndConflictMask) {
+    BookingService svc;
+    ShowId show = svc.find_show(1, 1);
+
+    EXPECT_EQ(svc.book_seats(999, {"a1"}).status, booking::BookingStatus::InvalidShow);
+    EXPECT_EQ(svc.book_seats(show, {}).status, booking::BookingStatus::NoSeats);
+
+    auto bad = svc.book_seats(show, {"a1", "a1x"});
+    EXPECT_EQ(bad.status, booking::BookingStatus::InvalidSeatLabel);
+    EXPECT_EQ(bad.label_index, 1);
+    EXPECT_EQ(bad.message(), "Invalid seat label: a1x");
+
+    auto ok = svc.book_seats(show, {"a1", "a2"});
+    EXPECT_TRUE(ok.success);
+    EXPECT_EQ(ok.status, booking::BookingStatus::Ok);
+    EXPECT_EQ(ok.message(), "Booked successfully");
+
+    auto taken = svc.book_seats(show, {"a2", "a3"});
+    EXPECT_EQ(taken.status, booking::BookingStatus::AlreadyBooked);
+    EXPECT_EQ(taken.conflicts.count(), 1);
+    EXPECT_TRUE(taken.conflicts.test(1));
+}
+
+TEST(MultiRow, ConflictMaskCoversAllRows) {
+    BookingService svc(booking::HallLayout::uniform(3, 10));
+    ShowId show = svc.find_show(1, 1);
+    ASSERT_TRUE(svc.book_seats(show, {"b2", "c3"}).success);
+
+    auto res = svc.book_seats(show, {"a1", "b2", "c3", "c4"});
+    ASSERT_EQ(res.status, booking::BookingStatus::AlreadyBooked);
+    EXPECT_EQ(res.conflicts.count(), 2);
+    EXPECT_TRUE(res.conflicts.test(booking::HallLayout::seat_index(1, 1)));
+    EXPECT_TRUE(res.conflicts.test(booking::HallLayout::seat_index(2, 2)));
+    EXPECT_EQ(svc.list_available_seats(show).size(), 28u);
+    EXPECT_EQ(res.suggested_row, -1); // conflicts in two rows: no suggestion
+}
+
+TEST(ConflictDiagnostics, SuggestsTheNearestFreeSeats) {
+    using booking::HallLayout;
+    using booking::SeatMask;
+    BookingService svc(HallLayout::uniform(3, 10));
+    ShowId show = svc.find_show(1, 1);
+    ASSERT_TRUE(svc.book_seats(show, {"a4", "a5"}).success);
+
+    // A run moves to the nearest run that is free: a1-a3 is closer than a6-a8
+    auto run = svc.book_seats(show, {"a3", "a4", "a5"});
+    ASSERT_EQ(run.status, booking::BookingStatus::AlreadyBooked);
+    EXPECT_EQ(run.conflicts.word(0), 0x18u);
+    EXPECT_EQ(run.suggested_row, 0);
+    EXPECT_EQ(run.suggested_seats, 0x7u);
+
+    // Single seats keep the free ones and replace each taken one; other rows are unchanged
+    SeatMask request;
+    request.set(HallLayout::seat_index(0, 4));
+    request.set(HallLayout::seat_index(0, 8));
+    request.set(HallLayout::seat_index(1, 0));
+    auto scattered = svc.book_seats(show, {"a5", "a9", "b1"});
+    ASSERT_EQ(scattered.status, booking::BookingStatus::AlreadyBooked);
+    const SeatMask retry = scattered.alternative(request);
+    EXPECT_EQ(retry.word(0), (1u << 5) | (1u << 8)); // a6 a9
+    EXPECT_EQ(retry.word(1), 1u);
+    EXPECT_TRUE(svc.book_seats(show, {"a6", "a9", "b1"}).success);
+
+    // No room left in the row: the conflict comes without a suggestion
+    BookingService full(HallLayout::uniform(1, 4));
+    ShowId small = full.find_show(1, 1);
+    ASSERT_TRUE(full.book_seats(small, {"a2", "a3"}).success);
+    auto none = full.book_seats(small, {"a2", "a3"});
+    EXPECT_EQ(none.status, booking::BookingStatus::AlreadyBooked);
+    EXPECT_EQ(none.suggested_row, -1);
+    EXPECT_TRUE(none.alternative(request).empty());
+}
+
+// ---------- Tests: zero-copy booking entry points ----------
+TEST(ZeroCopyBooking, StringViewLabels) {
+    BookingService svc(booking::HallLayout::uniform(2, 10));
+    ShowId show = svc.find_show(1, 1);
+
+    const char buffer[] = "a1 a2 b3";
+    const std::string_view labels[] = {std::string_view(buffer, 2), std::string_view(buffer + 3, 2),
+                                       std::string_view(buffer + 6, 2)};
+    auto res = svc.book_seat_labels(show, labels);
+    ASSERT_TRUE(res.success) << res.message();
+    EXPECT_EQ(svc.list_available_seats(show).size(), 17u);
+
+    const std::string_view bad[] = {"b4", "b11"};
+    res = svc.book_seat_labels(show, bad);
+    EXPECT_EQ(res.status, booking::BookingStatus::InvalidSeatLabel);
+    EXPECT_EQ(res.message(), "Invalid seat label: b11");
+}
+
+TEST(ZeroCopyBooking, SeatIndices) {
+    BookingService svc(booking::HallLayout::uniform(2, 10));
+    ShowId show = svc.find_show(1, 1);
+
+    const std::vector<int> seats = {booking::HallLayout::seat_index(0, 4), booking::HallLayout::seat_index(1, 4)};
+    ASSERT_TRUE(svc.book_seat_indices(show, seats).success);
+    EXPECT_EQ(svc.book_seat_indices(show, seats).status, booking::BookingStatus::AlreadyBooked);
+
+    const std::vector<int> outside = {0, booking::HallLayout::seat_index(0, 10)};
+    auto res = svc.book_seat_indices(show, outside);
+    EXPECT_EQ(res.status, booking::BookingStatus::InvalidSeatIndex);
+    EXPECT_EQ(res.label_index, 1);
+
+    const std::vector<int> dup = {1, 1};
+    EXPECT_EQ(svc.book_seat_indices(show, dup).status, booking::BookingStatus::DuplicateSeatLabel);
+}
+
+TEST(ZeroCopyBooking, LabelList) {
+    BookingService svc(booking::HallLayout::uniform(2, 10));
+    ShowId show = svc.find_show(1, 1);
+
+    ASSERT_TRUE(svc.book_label_list(show, "a1 a2\tb3  b4").success);
+    EXPECT_EQ(svc.available_count(show), 16);
+    EXPECT_EQ(svc.book_label_list(show, "a5 b4").status, booking::BookingStatus::AlreadyBooked);
+    EXPECT_EQ(svc.book_label_list(show, " ").status, booking::BookingStatus::NoSeats);
+
+    // The first bad label wins, whether it is malformed or a repeat
+    auto res = svc.book_label_list(show, "a5 a6 a5 b11 a7");
+    EXPECT_EQ(res.status, booking::BookingStatus::DuplicateSeatLabel);
+    EXPECT_EQ(res.label_index, 2);
+    res = svc.book_label_list(show, "a5 a6 b11 a5 a7");
+    EXPECT_EQ(res.status, booking::BookingStatus::InvalidSeatLabel);
+    EXPECT_EQ(res.label_index, 2);
+    EXPECT_EQ(res.message(), "Invalid seat label: b11");
+    EXPECT_EQ(svc.available_count(show), 16);
+}
+
+TEST(ZeroCopyBooking, LabelListInTheLayoutsGrammar) {
+    BookingService svc(booking::HallLayout::uniform(2, 10, booking::seat_label::LabelGrammar::RowDashSeat));
+    ShowId show = svc.find_show(1, 1);
+
+    ASSERT_TRUE(svc.book_label_list(show, "a-1 b-10").success);
+    ASSERT_TRUE(svc.book_seats(show, {"A-2"}).success);
+    EXPECT_EQ(svc.available_count(show), 17);
+    auto res = svc.book_label_list(show, "a-3 a4");
+    EXPECT_EQ(res.status, booking::BookingStatus::InvalidSeatLabel);
+    EXPECT_EQ(res.message(), "Invalid seat label: a4");
+    EXPECT_EQ(svc.list_available_seats(show).front(), "a-3");
+}
+
+TEST(ZeroCopyBooking, ReadyMask) {
+    BookingService svc(booking::HallLayout::uniform(2, 10));
+    ShowId show = svc.find_show(1, 1);
+
+    booking::SeatMask req;
+    req.or_word(0, 0x3u);
+    req.or_word(1, 0x3u);
+    ASSERT_TRUE(svc.book_seat_mask(show, req).success);
+    EXPECT_EQ(svc.list_available_seats(show).size(), 16u);
+
+    booking::SeatMask outside;
+    outside.or_word(0, std::uint64_t{1} << 10);
+    EXPECT_EQ(svc.book_seat_mask(show, outside).status, booking::BookingStatus::InvalidSeatIndex);
+    booking::SeatMask missing_row;
+    missing_row.or_word(2, 1u);
+    EXPECT_EQ(svc.book_seat_mask(show, missing_row).status, booking::BookingStatus::InvalidSeatIndex);
+    EXPECT_EQ(svc.book_seat_mask(show, booking::SeatMask{}).status, booking::BookingStatus::NoSeats);
+}
+
+// ---------- Tests: batched booking ----------
+TEST(BatchBooking, FirstComeFirstServedPerShow) {
+    BookingService svc;
+    const ShowId s1 = svc.find_show(1, 1);
+    const ShowId s4 = svc.find_show(3, 2);
+
+    const std::string_view r0[] = {"a1", "a2"};
+    const std::string_view r1[] = {"a5"};
+    const std::string_view r2[] = {"a2", "a3"}; // loses a2 to r0
+    const std::string_view r3[] = {"a3"};       // a3 still free because r2 failed
+    const std::string_view r4[] = {"a0"};
+    const std::string_view r5[] = {"a1"};
+    const std::vector<booking::BookingRequest> batch = {
+        {s1, r0}, {s4, r1}, {s1, r2}, {s1, r3}, {s1, r4}, {999, r5}, {s4, r5}};
+
+    auto results = svc.book_seats_batch(batch);
+    ASSERT_EQ(results.size(), batch.size());
+    EXPECT_TRUE(results[0].success);
+    EXPECT_TRUE(results[1].success);
+    EXPECT_EQ(results[2].status, booking::BookingStatus::AlreadyBooked);
+    EXPECT_TRUE(results[2].conflicts.test(1));
+    EXPECT_TRUE(results[3].success);
+    EXPECT_EQ(results[4].status, booking::BookingStatus::InvalidSeatLabel);
+    EXPECT_EQ(results[5].status, booking::BookingStatus::InvalidShow);
+    EXPECT_TRUE(results[6].success);
+
+    EXPECT_EQ(svc.list_available_seats(s1).size(), 17u);
+    EXPECT_EQ(svc.list_available_seats(s4).size(), 18u);
+}
+
+TEST(BatchBooking, RespectsSeatsBookedBeforeTheBatch) {
+    BookingService svc(booking::HallLayout::uniform(2, 10));
+    const ShowId show = svc.find_show(1, 1);
+    ASSERT_TRUE(svc.book_seats(show, {"b1"}).success);
+
+    const std::string_view r0[] = {"a1", "b1"};
+    const std::string_view r1[] = {"a1", "b2"};
+    const std::vector<booking::BookingRequest> batch = {{show, r0}, {show, r1}};
+    auto results = svc.book_seats_batch(batch);
+    EXPECT_FALSE(results[0].success);
+    EXPECT_TRUE(results[1].success);
+    EXPECT_EQ(svc.list_available_seats(show).size(), 17u);
+}
+
+TEST(BatchBooking, AcceptsSeatMasks) {
+    BookingService svc(booking::HallLayout::uniform(2, 10));
+    const ShowId show = svc.find_show(1, 1);
+    booking::SeatMask a1, outside, none;
+    a1.set(0);
+    outside.set(booking::HallLayout::seat_index(0, 12)); // row a has 10 seats
+    const std::string_view b1[] = {"b1"};
+    const std::vector<booking::BookingRequest> batch = {
+        {show, {}, &a1}, {show, b1}, {show, {}, &outside}, {show, {}, &none}, {show, {}, &a1}};
+    auto results = svc.book_seats_batch(batch);
+    EXPECT_TRUE(results[0].success);
+    EXPECT_TRUE(results[1].success);
+    EXPECT_EQ(results[2].status, booking::BookingStatus::InvalidSeatIndex);
+    EXPECT_EQ(results[3].status, booking::BookingStatus::NoSeats);
+    EXPECT_EQ(results[4].status, booking::BookingStatus::AlreadyBooked);
+    EXPECT_EQ(svc.available_count(show), 18);
+}
+
+// ---------- Tests: CAS backoff and contention statistics ----------
+TEST(Contention, StatsCountConflicts) {
+    BookingService svc;
+    ShowId show = svc.find_show(1, 1);
+
+    ASSERT_TRUE(svc.book_seats(show, {"a1"}).success);
+    EXPECT_FALSE(svc.book_seats(show, {"a1"}).success);
+    EXPECT_FALSE(svc.book_seats(show, {"a1", "a2"}).success);
+
+    booking::ContentionStats stats;
+    ASSERT_TRUE(svc.contention_stats(show, stats));
+    EXPECT_EQ(stats.conflicts, 2u);
+    EXPECT_EQ(stats.contended, 0u);
+    EXPECT_FALSE(svc.contention_stats(999, stats));
+}
+
+TEST(Contention, BoundedRetriesUnderContention) {
+    BookingService svc(booking::HallLayout::single_row(64));
+    ShowId show = svc.find_show(1, 1);
+    booking::BackoffPolicy policy;
+    policy.max_retries = 2;
+    svc.set_backoff_policy(policy);
+
+    // Every thread books distinct seats of the same word, so only CAS races can fail them
+    constexpr int kThreads = 8;
+    constexpr int kSeatsPerThread = 8;
+    std::atomic<bool> start{false};
+    std::atomic<int> booked{0};
+    std::atomic<int> contended{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            while (!start.load()) {
+            }
+            for (int k = 0; k < kSeatsPerThread; ++k) {
+                const int seat = t * kSeatsPerThread + k;
+                auto res = svc.book_seat_indices(show, std::vector<int>{seat});
+                if (res.success) booked.fetch_add(1);
+                if (res.status == booking::BookingStatus::Contended) contended.fetch_add(1);
+                EXPECT_TRUE(res.success || res.status == booking::BookingStatus::Contended);
+            }
+        });
+    }
+    start.store(true);
+    for (auto& th : threads) th.join();
+
+    booking::ContentionStats stats;
+    ASSERT_TRUE(svc.contention_stats(show, stats));
+    EXPECT_EQ(stats.contended, static_cast<std::uint64_t>(contended.load()));
+    EXPECT_EQ(booked.load() + contended.load(), kThreads * kSeatsPerThread);
+    EXPECT_EQ(svc.list_available_seats(show).size(), static_cast<std::size_t>(64 - booked.load()));
+}
+
+TEST(Cancellation, CancelFreesSeatsOfOwnBooking) {
+    BookingService svc(booking::HallLayout::uniform(2, 10));
+    ShowId show = svc.find_show(1, 1);
+
+    auto first = svc.book_seats(show, {"a1", "a2", "b1"});
+    auto second = svc.book_seats(show, {"a3"});
+    ASSERT_TRUE(first.success);
+    ASSERT_TRUE(second.success);
+    EXPECT_NE(first.id, 0u);
+    EXPECT_NE(first.id, second.id);
+
+    const auto first_id = static_cast<booking::BookingId>(first.id);
+    EXPECT_TRUE(svc.cancel_seats(show, {"a2", "b1"}, first_id).success);
+    EXPECT_EQ(svc.list_available_seats(show).size(), 18u);
+
+    // Cancelled seats can be booked again; the remaining seat still belongs to the booking
+    EXPECT_TRUE(svc.book_seats(show, {"b1"}).success);
+    EXPECT_TRUE(svc.cancel_seats(show, {"a1"}, first_id).success);
+    EXPECT_EQ(svc.cancel_seats(show, {"a1"}, first_id).status, booking::BookingStatus::NotOwner);
+}
+
+TEST(Cancellation, RejectsForeignSeatsAllOrNothing) {
+    BookingService svc;
+    ShowId show = svc.find_show(1, 1);
+
+    auto mine = svc.book_seats(show, {"a1", "a2"});
+    auto theirs = svc.book_seats(show, {"a3"});
+    ASSERT_TRUE(mine.success);
+    ASSERT_TRUE(theirs.success);
+
+    auto res = svc.cancel_seats(show, {"a1", "a3", "a4"}, static_cast<booking::BookingId>(mine.id));
+    EXPECT_EQ(res.status, booking::BookingStatus::NotOwner);
+    EXPECT_TRUE(res.conflicts.test(2));
+    EXPECT_EQ(svc.list_available_seats(show).size(), 17u);
+
+    // Nothing was released, so the full booking can still be cancelled
+    EXPECT_TRUE(svc.cancel_seats(show, {"a1", "a2"}, static_cast<booking::BookingId>(mine.id)).success);
+    EXPECT_EQ(svc.cancel_seats(show, {"a1"}, 0u).status, booking::BookingStatus::NotOwner);
+    EXPECT_EQ(svc.cancel_seats(show, {"a9x"}, 1u).status, booking::BookingStatus::InvalidSeatLabel);
+    EXPECT_EQ(svc.cancel_seats(999, {"a1"}, 1u).status, booking::BookingStatus::InvalidShow);
+}
+
+TEST(Cancellation, ConcurrentBookAndCancelKeepsStateConsistent) {
+    BookingService svc;
+    ShowId show = svc.find_show(1, 1);
+
+    constexpr int kThreads = 8;
+    std::atomic<bool> start{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            while (!start.load()) {
+            }
+            const std::vector<std::string> seats{booking::BookingService::seat_label_from_index0(t % 4)};
+            for (int i = 0; i < 200; ++i) {
+                auto res = svc.book_seats(show, seats);
+                if (res.success) {
+                    EXPECT_TRUE(svc.cancel_seats(show, seats, static_cast<booking::BookingId>(res.id)).success);
+                }
+            }
+        });
+    }
+    start.store(true);
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(svc.list_available_seats(show).size(), 20u);
+}
+
+TEST(Ownership, SeatOwnerAndBookingSeats) {
+    BookingService svc(booking::HallLayout::uniform(3, 8));
+    ShowId show = svc.find_show(1, 1);
+
+    auto res = svc.book_seats(show, {"a2", "c8"});
+    ASSERT_TRUE(res.success);
+    const auto id = static_cast<booking::BookingId>(res.id);
+    EXPECT_EQ(svc.seat_owner(show, booking::HallLayout::seat_index(0, 1)), id);
+    EXPECT_EQ(svc.seat_owner(show, booking::HallLayout::seat_index(2, 7)), id);
+    EXPECT_EQ(svc.seat_owner(show, 0), 0u);
+    EXPECT_EQ(svc.seat_owner(show, booking::HallLayout::seat_index(0, 8)), 0u); // not a seat
+    EXPECT_EQ(svc.seat_owner(999, 0), 0u);
+
+    booking::SeatMask seats;
+    EXPECT_EQ(svc.booking_seats(show, id, seats), 2);
+    EXPECT_TRUE(seats.test(booking::HallLayout::seat_index(0, 1)));
+    EXPECT_TRUE(seats.test(booking::HallLayout::seat_index(2, 7)));
+
+    // Cancellation clears ownership
+    ASSERT_TRUE(svc.cancel_seat_mask(show, seats, id).success);
+    EXPECT_EQ(svc.booking_seats(show, id, seats), 0);
+    EXPECT_EQ(svc.seat_owner(show, booking::HallLayout::seat_index(0, 1)), 0u);
+    EXPECT_EQ(svc.booking_seats(999, id, seats), -1);
+}
+
+TEST(Ownership, ConcurrentBookingsGetDistinctIds) {
+    BookingService svc(booking::HallLayout::single_row(64));
+    ShowId show = svc.find_show(1, 1);
+
+    constexpr int kThreads = 4;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int k = 0; k < 16; ++k) {
+                EXPECT_TRUE(svc.book_seat_indices(show, std::vector<int>{t * 16 + k}).success);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    std::vector<booking::BookingId> owners;
+    for (int seat = 0; seat < 64; ++seat) owners.push_back(svc.seat_owner(show, seat));
+    std::sort(owners.begin(), owners.end());
+    EXPECT_NE(owners.front(), 0u);
+    EXPECT_EQ(std::adjacent_find(owners.begin(), owners.end()), owners.end());
+}
+
+TEST(BestAvailable, PicksCentreOfMiddleRow) {
+    BookingService svc(booking::HallLayout::uniform(5, 10));
+    ShowId show = svc.find_show(1, 1);
+
+    booking::SeatMask seats;
+    auto res = svc.book_best_available(show, 2, seats);
+    ASSERT_TRUE(res.success) << res.message();
+    EXPECT_NE(res.id, 0u);
+    EXPECT_EQ(seats.count(), 2);
+    EXPECT_TRUE(seats.test(booking::HallLayout::seat_index(2, 4)));
+    EXPECT_TRUE(seats.test(booking::HallLayout::seat_index(2, 5)));
+
+    // Centre of the neighbouring rows (front one on ties) beats the side of the middle row
+    ASSERT_TRUE(svc.book_best_available(show, 2, seats).success);
+    EXPECT_TRUE(seats.test(booking::HallLayout::seat_index(1, 4)));
+    EXPECT_TRUE(seats.test(booking::HallLayout::seat_index(1, 5)));
+}
+
+TEST(BestAvailable, SkipsRowsWithoutLongEnoughRun) {
+    BookingService svc(booking::HallLayout::uniform(3, 6));
+    ShowId show = svc.find_show(1, 1);
+    ASSERT_TRUE(svc.book_seats(show, {"b3"}).success); // middle row split into 2 + 3
+
+    booking::SeatMask seats;
+    auto res = svc.book_best_available(show, 4, seats);
+    ASSERT_TRUE(res.success);
+    EXPECT_TRUE(seats.first_word() == 0 || seats.first_word() == 2);
+    EXPECT_EQ(svc.seat_owner(show, booking::HallLayout::seat_index(seats.first_word(), 1)),
+              static_cast<booking::BookingId>(res.id));
+
+    EXPECT_EQ(svc.book_best_available(show, 7, seats).status, booking::BookingStatus::NoContiguousSeats);
+    EXPECT_EQ(svc.book_best_available(show, 0, seats).status, booking::BookingStatus::NoSeats);
+    EXPECT_EQ(svc.book_best_available(999, 2, seats).status, booking::BookingStatus::InvalidShow);
+}
+
+TEST(BestAvailable, ConcurrentRequestsFillHallWithoutOverlap) {
+    BookingService svc(booking::HallLayout::uniform(4, 12));
+    ShowId show = svc.find_show(1, 1);
+
+    constexpr int kThreads = 4;
+    std::atomic<int> booked{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            booking::SeatMask seats;
+            while (true) {
+                auto res = svc.book_best_available(show, 3, seats);
+                if (res.status == booking::BookingStatus::NoContiguousSeats) break;
+                if (res.success) booked.fetch_add(seats.count());
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    // Every booked seat is accounted for exactly once, and no free run of 3 is left over
+    EXPECT_EQ(static_cast<std::size_t>(48 - booked.load()), svc.list_available_seats(show).size());
+    booking::SeatMask free_seats;
+    svc.available_seats_mask(show, free_seats);
+    for (int w = 0; w < 4; ++w) EXPECT_EQ(booking::run_starts(free_seats.word(w), 3), 0u);
+}
+
+namespace {
+
+/** @brief 4 rows of 10: rows a and d at 1000, row b at 2000, seats 4-7 of row c at 5000 (c1-c3, c8-c10 unpriced). */
+booking::HallLayout priced_hall() {
+    booking::HallLayout l = booking::HallLayout::uniform(4, 10);
+    booking::PriceTier cheap{"cheap", 1000, {}};
+    cheap.seats[0] = 0x3FFu;
+    cheap.seats[3] = 0x3FFu;
+    booking::PriceTier mid{"mid", 2000, {}};
+    mid.seats[1] = 0x3FFu;
+    booking::PriceTier box{"box", 5000, {}};
+    box.seats[2] = 0x78u;
+    l.set_price_tiers({box, mid, cheap});
+    return l;
+}
+
+} // namespace
+
+TEST(BestAvailable, StaysWithinThePriceBudget) {
+    BookingService svc(priced_hall());
+    ShowId show = svc.find_show(1, 1);
+    const booking::HallLayout& layout = *svc.layout_for_show(show);
+
+    booking::SeatMask seats;
+    auto res = svc.book_best_under(show, 4, 5000, seats);
+    ASSERT_TRUE(res.success) << res.message();
+    EXPECT_EQ(seats.first_word(), 1); // ties with the box: front row
+    EXPECT_EQ(layout.price_of(seats), 8000u);
+    ASSERT_TRUE(svc.book_best_under(show, 4, 5000, seats).success);
+    EXPECT_EQ(seats.first_word(), 2);
+    EXPECT_EQ(layout.price_of(seats), 20000u);
+    ASSERT_TRUE(svc.book_best_under(show, 4, 2500, seats).success);
+    EXPECT_EQ(seats.first_word(), 0);
+    EXPECT_EQ(layout.price_of(seats), 4000u);
+
+    EXPECT_EQ(svc.book_best_under(show, 4, 999, seats).status, booking::BookingStatus::NoContiguousSeats);
+    EXPECT_EQ(svc.book_best_under(show, 11, 99999, seats).status, booking::BookingStatus::NoContiguousSeats);
+    EXPECT_EQ(svc.book_best_under(show, 0, 1000, seats).status, booking::BookingStatus::NoSeats);
+    EXPECT_EQ(svc.book_best_under(999, 2, 1000, seats).status, booking::BookingStatus::InvalidShow);
+
+    // Unpriced seats are never sold by price, however high the budget
+    int runs = 0;
+    while (svc.book_best_under(show, 3, 100000, seats).success) ++runs;
+    EXPECT_EQ(runs, 7); // a1-a3, a8-a10, the same in row b, three in row d
+    ASSERT_TRUE(svc.book_best_available(show, 3, seats).success);
+    EXPECT_EQ(seats.first_word(), 2);
+    EXPECT_EQ(layout.price_of(seats), 0u);
+}
+
+TEST(BestAvailable, CheapestLevelWinsAndFallsBackToPricierSeats) {
+    BookingService svc(priced_hall());
+    ShowId show = svc.find_show(1, 1);
+    const booking::HallLayout& layout = *svc.layout_for_show(show);
+
+    booking::SeatMask seats;
+    ASSERT_TRUE(svc.book_cheapest_available(show, 5, seats).success);
+    EXPECT_EQ(seats.first_word(), 0);
+    EXPECT_EQ(layout.price_of(seats), 5000u);
+    ASSERT_TRUE(svc.book_cheapest_available(show, 5, seats).success);
+    EXPECT_EQ(seats.first_word(), 3);
+    ASSERT_TRUE(svc.book_cheapest_available(show, 5, seats).success); // the cheap rows are split now
+    EXPECT_EQ(seats.first_word(), 1);
+    EXPECT_EQ(layout.price_of(seats), 10000u);
+    EXPECT_EQ(svc.book_cheapest_available(show, 5, seats).status, booking::BookingStatus::NoContiguousSeats);
+    ASSERT_TRUE(svc.book_cheapest_available(show, 4, seats).success);
+    EXPECT_EQ(seats.first_word(), 2);
+    EXPECT_EQ(layout.price_of(seats), 20000u);
+    ASSERT_TRUE(svc.book_cheapest_available(show, 3, seats).success); // back to a cheap row
+    EXPECT_EQ(layout.price_of(seats), 3000u);
+    EXPECT_EQ(svc.available_count(show), 18);
+
+    // Without tiers it is book_best_available, and every seat is within any budget
+    BookingService plain(booking::HallLayout::uniform(5, 10));
+    ASSERT_TRUE(plain.book_cheapest_available(plain.find_show(1, 1), 2, seats).success);
+    EXPECT_TRUE(seats.test(booking::HallLayout::seat_index(2, 4)));
+    ASSERT_TRUE(plain.book_best_under(plain.find_show(1, 1), 2, 0, seats).success);
+}
+
+TEST(SeatCategories, CompanionSeatsNeedABookedWheelchairSpace) {
+    booking::HallLayout layout = booking::HallLayout::uniform(3, 6);
+    booking::SeatCategories categories;
+    categories.wheelchair[2] = 0x21u; // c1, c6
+    categories.companion[2] = 0x12u;  // c2, c5
+    layout.set_seat_categories(categories);
+    BookingService svc(std::move(layout));
+    ShowId show = svc.find_show(1, 1);
+
+    EXPECT_EQ(svc.book_seats(show, {"c2"}).status, booking::BookingStatus::CompanionSeatRule);
+    EXPECT_EQ(svc.book_seats(show, {"a1", "c5"}).status, booking::BookingStatus::CompanionSeatRule);
+    EXPECT_EQ(svc.available_count(show), 18); // the group was rolled back
+    EXPECT_EQ(svc.hold_seats(show, {"c2"}, std::chrono::minutes(1)).status,
+              booking::BookingStatus::CompanionSeatRule);
+
+    // With the space in the same request, or booked before
+    auto space = svc.book_seats(show, {"c1", "c2"});
+    ASSERT_TRUE(space.success) << space.message();
+    auto wheelchair = svc.book_seats(show, {"c6"});
+    ASSERT_TRUE(wheelchair.success);
+    EXPECT_TRUE(svc.book_seats(show, {"b1", "c5"}).success);
+
+    // The space can be cancelled afterwards; its companion stays booked
+    ASSERT_TRUE(svc.cancel_seats(show, {"c1", "c2"}, static_cast<booking::BookingId>(space.id)).success);
+    EXPECT_EQ(svc.book_seats(show, {"c2"}).status, booking::BookingStatus::CompanionSeatRule);
+}
+
+TEST(SeatCategories, AutomaticSearchesLeaveCategorySeatsAlone) {
+    booking::HallLayout layout = booking::HallLayout::uniform(1, 10);
+    booking::SeatCategories categories;
+    categories.wheelchair[0] = 0x010u; // a5
+    categories.companion[0] = 0x020u;  // a6
+    layout.set_seat_categories(categories);
+    BookingService svc(std::move(layout));
+    ShowId show = svc.find_show(1, 1);
+
+    booking::SeatMask seats;
+    EXPECT_EQ(svc.book_best_available(show, 5, seats).status, booking::BookingStatus::NoContiguousSeats);
+    int booked = 0;
+    while (svc.book_best_available(show, 1, seats).success) {
+        EXPECT_FALSE(seats.test(4));
+        EXPECT_FALSE(seats.test(5));
+        ++booked;
+    }
+    EXPECT_EQ(booked, 8);
+    EXPECT_EQ(svc.available_count(show), 2);
+    EXPECT_TRUE(svc.book_seats(show, {"a5", "a6"}).success);
+}
+
+TEST(SeatRules, BookingsMayNotLeaveASingleSeat) {
+    booking::HallLayout layout = booking::HallLayout::uniform(2, 8);
+    layout.set_forbid_single_gaps(true);
+    BookingService svc(std::move(layout));
+    ShowId show = svc.find_show(1, 1);
+
+    EXPECT_EQ(svc.book_seats(show, {"a2"}).status, booking::BookingStatus::SingleSeatGap); // a1 alone at the edge
+    EXPECT_EQ(svc.book_seats(show, {"a1", "a2", "a4"}).status, booking::BookingStatus::SingleSeatGap);
+    EXPECT_EQ(svc.book_seats(show, {"a3", "a4", "b2"}).status, booking::BookingStatus::SingleSeatGap); // b1 alone
+    EXPECT_EQ(svc.available_count(show), 16); // group rolled back
+    auto pair = svc.book_seats(show, {"a3", "a4"});
+    ASSERT_TRUE(pair.success) << pair.message();
+    EXPECT_TRUE(svc.book_seats(show, {"a1", "a2"}).success);
+    EXPECT_EQ(svc.book_seats(show, {"a5", "a6", "a7"}).status, booking::BookingStatus::SingleSeatGap);
+    EXPECT_TRUE(svc.book_seats(show, {"a5", "a6", "a7", "a8"}).success);
+
+    // A gap opened by a cancellation does not block the rest of the row
+    ASSERT_TRUE(svc.cancel_seats(show, {"a4"}, static_cast<booking::BookingId>(pair.id)).success);
+    EXPECT_TRUE(svc.book_seats(show, {"b1", "b2"}).success);
+    EXPECT_TRUE(svc.book_seats(show, {"a4"}).success);
+    EXPECT_EQ(svc.hold_seats(show, {"b4"}, std::chrono::minutes(1)).status, booking::BookingStatus::SingleSeatGap);
+}
+
+TEST(SeatRules, BestAvailableSkipsRunsThatLeaveASingleSeat) {
+    booking::HallLayout layout = booking::HallLayout::uniform(1, 7);
+    layout.set_forbid_single_gaps(true);
+    BookingService svc(std::move(layout));
+    ShowId show = svc.find_show(1, 1);
+
+    booking::SeatMask seats;
+    ASSERT_TRUE(svc.book_best_available(show, 2, seats).success);
+    EXPECT_EQ(seats.word(0), 0x0Cu); // a3-a4: two seats stay free on the left, three on the right
+    ASSERT_TRUE(svc.book_best_available(show, 2, seats).success);
+    EXPECT_EQ(seats.word(0), 0x03u); // a5-a6 or a6-a7 would strand a seat
+    EXPECT_EQ(svc.book_best_available(show, 2, seats).status, booking::BookingStatus::NoContiguousSeats);
+    ASSERT_TRUE(svc.book_best_available(show, 3, seats).success);
+    EXPECT_EQ(svc.available_count(show), 0);
+
+    BookingService odd([] {
+        booking::HallLayout l = booking::HallLayout::uniform(1, 3);
+        l.set_forbid_single_gaps(true);
+        return l;
+    }());
+    EXPECT_EQ(odd.book_best_available(odd.find_show(1, 1), 2, seats).status,
+              booking::BookingStatus::NoContiguousSeats);
+    EXPECT_TRUE(odd.book_best_available(odd.find_show(1, 1), 3, seats).success);
+}
+
+TEST(SeatRules, BestAvailableKeepsRunsOnOneSideOfAnAisle) {
+    // a1-a4 | a5-a10 | a11-a14: the middle block is widest
+    booking::HallLayout layout = booking::HallLayout::uniform(1, 14);
+    std::array<std::uint64_t, booking::HallLayout::kMaxRows> aisles{};
+    aisles[0] = (1u << 3) | (1u << 9);
+    layout.set_aisles(aisles);
+    BookingService svc(std::move(layout));
+    ShowId show = svc.find_show(1, 1);
+
+    booking::SeatMask seats;
+    ASSERT_TRUE(svc.book_best_available(show, 6, seats).success);
+    EXPECT_EQ(seats.word(0), 0x3F0u);
+    // Only the side blocks are left: five seats fit nowhere although eight are free
+    EXPECT_EQ(svc.book_best_available(show, 5, seats).status, booking::BookingStatus::NoContiguousSeats);
+    ASSERT_TRUE(svc.book_best_available(show, 4, seats).success);
+    EXPECT_TRUE(seats.word(0) == 0xFu || seats.word(0) == 0x3C00u) << seats.word(0);
+    EXPECT_EQ(svc.available_count(show), 4);
+}
+
+TEST(Availability, CountsTrackBookingsAndCancellations) {
+    BookingService svc(booking::HallLayout::uniform(3, 10));
+    ShowId show = svc.find_show(1, 1);
+    EXPECT_EQ(svc.available_count(show), 30);
+    EXPECT_EQ(svc.available_count(999), -1);
+
+    auto res = svc.book_seats(show, {"a1", "c10"});
+    ASSERT_TRUE(res.success);
+    EXPECT_EQ(svc.available_count(show), 28);
+    ASSERT_TRUE(svc.cancel_seats(show, {"c10"}, static_cast<booking::BookingId>(res.id)).success);
+    EXPECT_EQ(svc.available_count(show), 29);
+    EXPECT_EQ(static_cast<std::size_t>(svc.available_count(show)), svc.list_available_seats(show).size());
+}
+
+TEST(Availability, BulkCountsFillCallerArray) {
+    BookingService svc;
+    ASSERT_TRUE(svc.book_seats(2, {"a1", "a2", "a3"}).success);
+
+    const ShowId shows[] = {1, 2, 999, 4};
+    int counts[4] = {0, 0, 0, 0};
+    EXPECT_EQ(svc.available_counts(shows, counts), 3u);
+    EXPECT_EQ(counts[0], 20);
+    EXPECT_EQ(counts[1], 17);
+    EXPECT_EQ(counts[2], -1);
+    EXPECT_EQ(counts[3], 20);
+}
+
+TEST(Availability, LargePagesAreCountedInParallelChunks) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    booking::Schedule schedule;
+    schedule.movies.push_back(booking::ScheduleMovie{1, "City"});
+    schedule.theaters.push_back(booking::ScheduleTheater{1, "Everywhere"});
+    schedule.layouts.push_back(booking::ScheduleLayout{0, booking::HallLayout::uniform(4, 40)});
+    constexpr int kShows = 10000;
+    for (int s = 0; s < kShows; ++s) schedule.shows.push_back(booking::ScheduleShow{s, 1, 1, 0});
+    ASSERT_EQ(svc.load_schedule(std::move(schedule)).status, booking::ScheduleStatus::Ok);
+    booking::ThreadPoolOptions options;
+    options.workers = 3;
+    booking::ThreadPool pool(options);
+    svc.set_thread_pool(&pool);
+
+    std::vector<ShowId> ids;
+    for (int s = 0; s < kShows; ++s) {
+        if (s % 7 == 0) {
+            ASSERT_TRUE(svc.book_seats(s, {"a1", "d40"}).success);
+        }
+        ids.push_back(s % 1000 == 999 ? kShows + s : s); // some unknown ids
+    }
+    std::vector<int> counts(ids.size(), 0);
+    EXPECT_EQ(svc.available_counts(ids, counts), ids.size() - kShows / 1000);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        ASSERT_EQ(counts[i], svc.available_count(ids[i])) << i;
+    }
+}
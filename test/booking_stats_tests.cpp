@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+
+#include <string>
+#include <vector>
+
+using booking::BookingService;
+using booking::ShowId;
+
+TEST(ServiceStats, ShowStatsCountOccupancyAndConflicts) {
+    BookingService svc(booking::HallLayout::uniform(3, 10));
+    const ShowId show = svc.find_show(1, 1);
+    booking::ShowStats stats;
+    ASSERT_TRUE(svc.show_stats(show, stats));
+    EXPECT_EQ(stats.show_id, show);
+    EXPECT_EQ(stats.seats, 30);
+    EXPECT_EQ(stats.booked, 0);
+    EXPECT_EQ(stats.occupancy, 0.0);
+    EXPECT_EQ(stats.conflict_rate, 0.0);
+    EXPECT_FALSE(svc.show_stats(999, stats));
+
+    ASSERT_TRUE(svc.book_seats(show, {"a1", "a2", "b5"}).success);
+    ASSERT_TRUE(svc.book_seats(show, {"c1"}).success);
+    EXPECT_FALSE(svc.book_seats(show, {"a2", "a3"}).success); // conflict
+    ASSERT_TRUE(svc.show_stats(show, stats));
+    EXPECT_EQ(stats.booked, 4);
+    EXPECT_DOUBLE_EQ(stats.occupancy, 4.0 / 30.0);
+    EXPECT_EQ(stats.contention.conflicts, 1u);
+    EXPECT_GT(stats.changes, 0u);
+    EXPECT_DOUBLE_EQ(stats.conflict_rate, 1.0 / (1.0 + static_cast<double>(stats.changes)));
+
+    booking::ContentionStats contention;
+    ASSERT_TRUE(svc.contention_stats(show, contention));
+    EXPECT_EQ(contention.conflicts, stats.contention.conflicts);
+}
+
+TEST(ServiceStats, BulkShowStatsMatchSingleReads) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    booking::Schedule schedule;
+    schedule.movies.push_back(booking::ScheduleMovie{1, "City"});
+    schedule.theaters.push_back(booking::ScheduleTheater{1, "Everywhere"});
+    schedule.layouts.push_back(booking::ScheduleLayout{0, booking::HallLayout::uniform(4, 40)});
+    constexpr int kShows = 10000;
+    for (int s = 0; s < kShows; ++s) schedule.shows.push_back(booking::ScheduleShow{s, 1, 1, 0});
+    ASSERT_EQ(svc.load_schedule(std::move(schedule)).status, booking::ScheduleStatus::Ok);
+    booking::ThreadPoolOptions options;
+    options.workers = 3;
+    booking::ThreadPool pool(options);
+    svc.set_thread_pool(&pool);
+
+    std::vector<ShowId> ids;
+    for (int s = 0; s < kShows; ++s) {
+        if (s % 7 == 0) {
+            ASSERT_TRUE(svc.book_seats(s, {"a1", "d40"}).success);
+        }
+        ids.push_back(s % 1000 == 999 ? kShows + s : s); // some unknown ids
+    }
+    std::vector<booking::ShowStats> stats(ids.size());
+    EXPECT_EQ(svc.show_stats(ids, stats), ids.size() - kShows / 1000);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        booking::ShowStats one;
+        if (!svc.show_stats(ids[i], one)) {
+            ASSERT_FALSE(stats[i].show_id.valid()) << i;
+            continue;
+        }
+        ASSERT_EQ(stats[i].show_id, ids[i]);
+        ASSERT_EQ(stats[i].booked, one.booked) << i;
+        ASSERT_EQ(stats[i].changes, one.changes) << i;
+    }
+
+    // Catalog totals are summed in parallel chunks
+    const booking::ServiceStats total = svc.service_stats(0);
+    const std::uint64_t booked_shows = (kShows + 6) / 7;
+    EXPECT_EQ(total.shows, static_cast<std::size_t>(kShows));
+    EXPECT_EQ(total.seats, 160u * kShows);
+    EXPECT_EQ(total.booked, 2u * booked_shows);
+    EXPECT_DOUBLE_EQ(total.occupancy, static_cast<double>(2u * booked_shows) / (160.0 * kShows));
+    EXPECT_TRUE(total.hot.empty());
+}
+
+TEST(ServiceStats, HotShowsFollowBookingAttempts) {
+    if (!BOOKING_METRICS) GTEST_SKIP() << "built without metrics";
+    BookingService svc;
+    const ShowId busy = svc.find_show(1, 1);
+    const ShowId quiet = svc.find_show(1, 2);
+    for (int i = 0; i < 50; ++i) {
+        const booking::BookingResult r = svc.book_seats(busy, {"a1"});
+        ASSERT_TRUE(r.success);
+        ASSERT_TRUE(svc.cancel_seats(busy, {"a1"}, r.id).success);
+        EXPECT_FALSE(svc.book_seats(quiet, {"a1", "a1"}).success); // rejected before an attempt
+    }
+    ASSERT_TRUE(svc.book_seats(quiet, {"a1"}).success);
+    EXPECT_FALSE(svc.book_seats(quiet, {"a1"}).success);
+    booking::SeatMask seats;
+    ASSERT_TRUE(svc.book_best_available(quiet, 2, seats).success);
+
+    const std::vector<booking::HotShow> hot = svc.hot_shows(5);
+    ASSERT_EQ(hot.size(), 2u);
+    EXPECT_EQ(hot[0].show_id, busy);
+    EXPECT_EQ(hot[0].requests, 50u);
+    EXPECT_EQ(hot[0].error, 0u);
+    EXPECT_EQ(hot[0].stats.booked, 0);
+    EXPECT_EQ(hot[1].show_id, quiet);
+    EXPECT_EQ(hot[1].requests, 3u);
+    EXPECT_EQ(hot[1].stats.booked, 3);
+    EXPECT_EQ(hot[1].stats.contention.conflicts, 1u);
+
+    const booking::ServiceStats total = svc.service_stats(1);
+    ASSERT_EQ(total.hot.size(), 1u);
+    EXPECT_EQ(total.hot[0].show_id, busy);
+    EXPECT_EQ(total.booked, 3u);
+    EXPECT_EQ(total.contention.conflicts, 1u);
+    EXPECT_GT(total.conflict_rate, 0.0);
+
+    const std::string text = svc.metrics_prometheus();
+    EXPECT_NE(text.find("booking_hot_show_requests{show=\"" + booking::to_string(busy) + "\"} 50\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("booking_seats_booked 3\n"), std::string::npos);
+    EXPECT_NE(text.find("booking_seats " + std::to_string(total.seats) + "\n"), std::string::npos);
+}
+
+TEST(ServiceStats, NoDemandIsRecordedWithMetricsOff) {
+    BookingService svc;
+    svc.set_metrics_enabled(false);
+    ASSERT_TRUE(svc.book_seats(svc.find_show(1, 1), {"a1"}).success);
+    EXPECT_TRUE(svc.hot_shows(3).empty());
+    booking::ShowStats stats;
+    ASSERT_TRUE(svc.show_stats(svc.find_show(1, 1), stats));
+    EXPECT_EQ(stats.booked, 1); // the seat words are still read
+}
+
+TEST(ServiceStats, BatchBookingsCountAsDemand) {
+    if (!BOOKING_METRICS) GTEST_SKIP() << "built without metrics";
+    BookingService svc;
+    const ShowId bulk = svc.find_show(1, 1);
+    const ShowId single = svc.find_show(1, 2);
+    ASSERT_TRUE(svc.book_seats(single, {"a1"}).success);
+
+    std::vector<booking::SeatMask> masks(12);
+    std::vector<booking::BookingRequest> batch;
+    for (int i = 0; i < 12; ++i) {
+        masks[static_cast<std::size_t>(i)].set(i % 10); // the last two conflict with the first two
+        batch.push_back(booking::BookingRequest{bulk, {}, &masks[static_cast<std::size_t>(i)]});
+    }
+    booking::SeatMask out_of_hall;
+    out_of_hall.set(booking::HallLayout::kMaxRowSeats - 1);
+    batch.push_back(booking::BookingRequest{bulk, {}, &out_of_hall}); // rejected before an attempt
+    const std::vector<booking::BookingResult> results = svc.book_seats_batch(batch);
+    EXPECT_EQ(results[10].status, booking::BookingStatus::AlreadyBooked);
+    EXPECT_EQ(results[12].status, booking::BookingStatus::InvalidSeatIndex);
+
+    const std::vector<booking::HotShow> hot = svc.hot_shows(5);
+    ASSERT_EQ(hot.size(), 2u);
+    EXPECT_EQ(hot[0].show_id, bulk);
+    EXPECT_EQ(hot[0].requests, 12u);
+    EXPECT_EQ(hot[0].stats.booked, 10);
+    EXPECT_EQ(hot[1].show_id, single);
+    EXPECT_EQ(hot[1].requests, 1u);
+}
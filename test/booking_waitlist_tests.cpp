@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::SeatMask;
+using booking::ShowId;
+using namespace std::chrono_literals;
+
+namespace {
+
+/** @brief Records the bookings handed to waitlist callbacks. */
+struct Served {
+    std::vector<int> order;         // tag of each served entry
+    std::vector<SeatMask> seats;
+    std::vector<BookingResult> results;
+
+    BookingService::WaitlistCallback callback(int tag) {
+        return [this, tag](const BookingResult& r, const SeatMask& s) {
+            order.push_back(tag);
+            seats.push_back(s);
+            results.push_back(r);
+        };
+    }
+};
+
+} // namespace
+
+TEST(Waitlist, BooksRightAwayWhenSeatsAreFree) {
+    BookingService svc(HallLayout::uniform(1, 10));
+    const ShowId show = svc.find_show(1, 1);
+    Served served;
+    SeatMask seats;
+    const BookingResult r = svc.join_waitlist(show, 3, served.callback(1), seats);
+    ASSERT_TRUE(r.success) << r.message();
+    EXPECT_EQ(seats.count(), 3);
+    EXPECT_TRUE(served.order.empty());
+    EXPECT_EQ(svc.waitlist_size(show), 0u);
+
+    EXPECT_EQ(svc.join_waitlist(show, 11, served.callback(2), seats).status, BookingStatus::NoContiguousSeats);
+    EXPECT_EQ(svc.join_waitlist(show, 0, served.callback(3), seats).status, BookingStatus::NoSeats);
+    EXPECT_EQ(svc.join_waitlist(999, 1, served.callback(4), seats).status, BookingStatus::InvalidShow);
+    EXPECT_EQ(svc.waitlist_size(999), 0u);
+}
+
+TEST(Waitlist, CancellationsServeEntriesInOrder) {
+    BookingService svc(HallLayout::uniform(1, 6));
+    const ShowId show = svc.find_show(1, 1);
+    SeatMask all;
+    const BookingResult sold = svc.book_best_available(show, 6, all);
+    ASSERT_TRUE(sold.success);
+
+    Served served;
+    SeatMask seats;
+    EXPECT_EQ(svc.join_waitlist(show, 2, served.callback(1), seats).status, BookingStatus::Waitlisted);
+    EXPECT_EQ(svc.join_waitlist(show, 1, served.callback(2), seats).status, BookingStatus::Waitlisted);
+    EXPECT_EQ(svc.join_waitlist(show, 3, served.callback(3), seats).status, BookingStatus::Waitlisted);
+    EXPECT_EQ(svc.waitlist_size(show), 3u);
+
+    // One seat back: the head wants two, so nobody behind it may jump the queue
+    ASSERT_TRUE(svc.cancel_seats(show, {"a1"}, static_cast<booking::BookingId>(sold.id)).success);
+    EXPECT_TRUE(served.order.empty());
+    EXPECT_EQ(svc.join_waitlist(show, 1, served.callback(4), seats).status, BookingStatus::Waitlisted);
+
+    ASSERT_TRUE(svc.cancel_seats(show, {"a2", "a3"}, static_cast<booking::BookingId>(sold.id)).success);
+    ASSERT_EQ(served.order, (std::vector<int>{1, 2}));
+    EXPECT_TRUE(served.results[0].success);
+    EXPECT_EQ(served.seats[0].count(), 2);
+    EXPECT_EQ(served.seats[1].count(), 1);
+    EXPECT_EQ(svc.waitlist_size(show), 2u);
+    EXPECT_EQ(svc.available_count(show), 0);
+
+    // The entries own real bookings: cancelling one serves the next waiter
+    ASSERT_TRUE(svc.cancel_seat_mask(show, served.seats[0], static_cast<booking::BookingId>(served.results[0].id)).success);
+    EXPECT_EQ(served.order.size(), 2u); // needs three
+    ASSERT_TRUE(svc.cancel_seats(show, {"a4"}, static_cast<booking::BookingId>(sold.id)).success);
+    ASSERT_EQ(served.order, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(served.seats[2].count(), 3);
+    EXPECT_EQ(svc.waitlist_size(show), 1u); // the last single waits on
+}
+
+TEST(Waitlist, HoldReleasesAndExpiriesServeTheWaitlist) {
+    BookingService svc(HallLayout::uniform(2, 2));
+    const ShowId show = svc.find_show(1, 1);
+    const auto hold = svc.hold_seats(show, {"a1", "a2", "b1"}, 60s);
+    ASSERT_TRUE(hold.success);
+    const auto short_hold = svc.hold_seats(show, {"b2"}, 10ms);
+    ASSERT_TRUE(short_hold.success);
+
+    Served served;
+    SeatMask seats;
+    ASSERT_EQ(svc.join_waitlist(show, 1, served.callback(1), seats).status, BookingStatus::Waitlisted);
+    ASSERT_EQ(svc.join_waitlist(show, 2, served.callback(2), seats).status, BookingStatus::Waitlisted);
+    EXPECT_EQ(svc.expire_holds(std::chrono::steady_clock::now() + 1s), 1u);
+    ASSERT_EQ(served.order, (std::vector<int>{1}));
+    EXPECT_TRUE(served.seats[0].test(HallLayout::seat_index(1, 1)));
+
+    ASSERT_TRUE(svc.release_hold(hold.id).success);
+    ASSERT_EQ(served.order, (std::vector<int>{1, 2}));
+    EXPECT_EQ(served.seats[1].word(0), 0x3u); // a1 a2
+    EXPECT_EQ(svc.waitlist_size(show), 0u);
+}
+
+TEST(Waitlist, ConcurrentCancelsServeEveryWaiterOnce) {
+    BookingService svc(HallLayout::uniform(4, 16));
+    const ShowId show = svc.find_show(1, 1);
+    std::vector<SeatMask> booked(64);
+    std::vector<booking::BookingId> ids(64);
+    for (int i = 0; i < 64; ++i) {
+        const BookingResult r = svc.book_best_available(show, 1, booked[static_cast<std::size_t>(i)]);
+        ASSERT_TRUE(r.success);
+        ids[static_cast<std::size_t>(i)] = static_cast<booking::BookingId>(r.id);
+    }
+
+    std::atomic<int> served{0};
+    std::atomic<int> seats_served{0};
+    auto on_booked = [&](const BookingResult& r, const SeatMask& s) {
+        EXPECT_TRUE(r.success);
+        seats_served.fetch_add(s.count());
+        served.fetch_add(1);
+    };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = t * 16; i < t * 16 + 16; ++i) {
+                SeatMask seats;
+                const auto r = svc.join_waitlist(show, 1, on_booked, seats);
+                EXPECT_TRUE(r.status == BookingStatus::Waitlisted || r.success) << r.message();
+                if (r.success) {
+                    served.fetch_add(1);
+                    seats_served.fetch_add(1);
+                }
+                svc.cancel_seat_mask(show, booked[static_cast<std::size_t>(i)], ids[static_cast<std::size_t>(i)]);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(served.load(), 64);
+    EXPECT_EQ(seats_served.load(), 64);
+    EXPECT_EQ(svc.waitlist_size(show), 0u);
+    EXPECT_EQ(svc.available_count(show), 0);
+}
@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "change_feed.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::HallLayout;
+using booking::SeatChange;
+using booking::SeatChangeFeed;
+using booking::SeatChangeSubscriber;
+using booking::SeatMask;
+
+TEST(ChangeFeed, SubscribersReadInOrderFromTheirStart) {
+    SeatChangeFeed feed(16);
+    feed.publish(1, 0, 0u, 1u);
+    SeatChangeSubscriber late(feed); // starts after the first change
+    feed.publish(2, 3, 4u, 6u);
+    feed.publish(2, 3, 6u, 2u);
+
+    SeatChange out[8];
+    bool gap = true;
+    ASSERT_EQ(late.poll(out, 8, gap), 2u);
+    EXPECT_FALSE(gap);
+    EXPECT_EQ(out[0].seq, 1u);
+    EXPECT_EQ(out[0].show_id, 2);
+    EXPECT_EQ(out[0].word, 3);
+    EXPECT_EQ(out[0].old_bits, 4u);
+    EXPECT_EQ(out[1].new_bits, 2u);
+    EXPECT_EQ(late.poll(out, 8, gap), 0u); // caught up
+    EXPECT_EQ(late.position(), 3u);
+
+    SeatChange one;
+    EXPECT_EQ(feed.read(0, one), booking::FeedRead::Ok);
+    EXPECT_EQ(one.show_id, 1);
+    EXPECT_EQ(feed.read(3, one), booking::FeedRead::NotYet);
+    EXPECT_THROW(SeatChangeFeed(12), std::invalid_argument);
+}
+
+TEST(ChangeFeed, SlowSubscriberSeesAGap) {
+    SeatChangeFeed feed(8);
+    SeatChangeSubscriber sub(feed);
+    feed.publish(0, 0, 0u, 1u);
+    SeatChange out[16];
+    bool gap = false;
+    ASSERT_EQ(sub.poll(out, 16, gap), 1u);
+
+    for (int i = 0; i < 20; ++i) feed.publish(0, 0, 0u, static_cast<std::uint64_t>(i));
+    ASSERT_EQ(sub.poll(out, 16, gap), 8u); // only the last lap is left
+    EXPECT_TRUE(gap);
+    EXPECT_EQ(out[0].seq, 13u);
+    EXPECT_EQ(out[7].new_bits, 19u);
+    EXPECT_EQ(sub.poll(out, 16, gap), 0u);
+    EXPECT_FALSE(gap);
+}
+
+TEST(ChangeFeed, LanesInterleaveAndReadersSkipIdleOnes) {
+    EXPECT_THROW(SeatChangeFeed(16, 3), std::invalid_argument);
+    EXPECT_THROW(SeatChangeFeed(4, 8), std::invalid_argument);
+    SeatChangeFeed feed(64, 4);
+    EXPECT_EQ(feed.lanes(), 4u);
+    SeatChangeSubscriber sub(feed);
+    feed.publish(1, 0, 0u, 1u);
+    feed.publish(1, 0, 1u, 3u);
+    std::thread([&] { feed.publish(2, 1, 0u, 8u); }).join(); // another lane, or the same one again
+
+    // One thread's numbers are a lane apart; the unused numbers between are skipped as holes
+    SeatChange out[8];
+    bool gap = true;
+    ASSERT_EQ(sub.poll(out, 8, gap), 3u);
+    EXPECT_FALSE(gap);
+    std::vector<SeatChange> mine;
+    for (std::size_t i = 0; i < 3; ++i) {
+        if (out[i].show_id == 1) mine.push_back(out[i]);
+    }
+    ASSERT_EQ(mine.size(), 2u);
+    EXPECT_EQ(mine[1].seq, mine[0].seq + 4u);
+    EXPECT_EQ(mine[1].new_bits, 3u);
+    EXPECT_EQ(sub.position(), feed.head());
+    SeatChange one;
+    for (std::uint64_t seq = 0; seq < feed.head(); ++seq) {
+        const bool published = seq == out[0].seq || seq == out[1].seq || seq == out[2].seq;
+        EXPECT_EQ(feed.read(seq, one), published ? booking::FeedRead::Ok : booking::FeedRead::Hole) << seq;
+    }
+    EXPECT_EQ(feed.read(feed.head(), one), booking::FeedRead::NotYet);
+}
+
+TEST(ChangeFeed, CutKeepsLaterChangesAtOrAboveIt) {
+    SeatChangeFeed feed(64, 4);
+    std::thread([&] { feed.publish(1, 0, 0u, 1u); }).join();
+    std::thread([&] { feed.publish(1, 0, 1u, 3u); }).join();
+    const std::uint64_t cut = feed.cut();
+    EXPECT_EQ(cut, feed.head());
+
+    // Whichever lanes were idle, nothing published now is numbered below the cut
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) threads.emplace_back([&] { feed.publish(2, 0, 0u, 4u); });
+    for (auto& t : threads) t.join();
+    SeatChange one;
+    int before = 0;
+    for (std::uint64_t seq = 0; seq < feed.head(); ++seq) {
+        const booking::FeedRead r = feed.read(seq, one);
+        ASSERT_NE(r, booking::FeedRead::NotYet) << seq;
+        if (r == booking::FeedRead::Ok && one.show_id == 2) {
+            EXPECT_GE(seq, cut);
+        }
+        before += r == booking::FeedRead::Ok && seq < cut;
+    }
+    EXPECT_EQ(before, 2);
+}
+
+TEST(ChangeFeed, MirrorFollowsBookingsHoldsAndCancels) {
+    BookingService svc(HallLayout::uniform(3, 10));
+    svc.enable_change_feed(1u << 12);
+    ASSERT_NE(svc.change_feed(), nullptr);
+    SeatChangeSubscriber sub(*svc.change_feed());
+    const booking::ShowId show = svc.find_show(1, 1);
+
+    std::array<std::uint64_t, 3> mirror{}; // booked/held bits, all free at subscription time
+    auto catch_up = [&] {
+        SeatChange out[64];
+        bool gap = false;
+        std::size_t n;
+        while ((n = sub.poll(out, 64, gap)) != 0u) {
+            ASSERT_FALSE(gap);
+            for (std::size_t i = 0; i < n; ++i) {
+                if (out[i].show_id == show) mirror[static_cast<std::size_t>(out[i].word)] ^= out[i].old_bits ^ out[i].new_bits;
+            }
+        }
+    };
+    auto expect_matches = [&] {
+        catch_up();
+        SeatMask free_seats;
+        ASSERT_GE(svc.available_seats_mask(show, free_seats), 0);
+        for (int w = 0; w < 3; ++w) {
+            EXPECT_EQ(mirror[static_cast<std::size_t>(w)], ~free_seats.word(w) & svc.layout_for_show(show)->row_mask(w))
+                << "row " << w;
+        }
+    };
+
+    const auto a = svc.book_seats(show, {"a1", "a2", "c10"}); // two rows
+    ASSERT_TRUE(a.success);
+    expect_matches();
+    EXPECT_FALSE(svc.book_seats(show, {"b1", "c10"}).success); // b1 taken then rolled back
+    expect_matches();
+    const auto hold = svc.hold_seats(show, {"b5"}, std::chrono::minutes(1));
+    ASSERT_TRUE(hold.success);
+    expect_matches();
+    ASSERT_TRUE(svc.release_hold(hold.id).success);
+    ASSERT_TRUE(svc.cancel_seats(show, {"a2"}, static_cast<booking::BookingId>(a.id)).success);
+    SeatMask best;
+    ASSERT_TRUE(svc.book_best_available(show, 4, best).success);
+    expect_matches();
+}
+
+class ChangeFeedLanes : public ::testing::TestWithParam<std::size_t> {};
+
+TEST_P(ChangeFeedLanes, ConcurrentWritersConvergeInTheMirror) {
+    BookingService svc(HallLayout::uniform(4, 64));
+    svc.enable_change_feed(1u << 16, GetParam());
+    SeatChangeSubscriber sub(*svc.change_feed());
+    const booking::ShowId show = svc.find_show(1, 1);
+
+    std::array<std::uint64_t, 4> mirror{};
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        SeatChange out[256];
+        bool gap = false;
+        while (true) {
+            const bool finished = done.load();
+            const std::size_t n = sub.poll(out, 256, gap);
+            ASSERT_FALSE(gap);
+            for (std::size_t i = 0; i < n; ++i) {
+                if (out[i].show_id == show) mirror[static_cast<std::size_t>(out[i].word)] ^= out[i].old_bits ^ out[i].new_bits;
+            }
+            if (finished && n == 0u && sub.position() == svc.change_feed()->head()) break;
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 3; ++t) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < 2000; ++i) {
+                SeatMask seats;
+                const auto r = svc.book_best_available(show, 1 + (i + t) % 3, seats);
+                if (r.success && i % 2 == 0) svc.cancel_seat_mask(show, seats, static_cast<booking::BookingId>(r.id));
+            }
+        });
+    }
+    for (auto& w : writers) w.join();
+    done.store(true);
+    reader.join();
+
+    SeatMask free_seats;
+    svc.available_seats_mask(show, free_seats);
+    for (int w = 0; w < 4; ++w) EXPECT_EQ(mirror[static_cast<std::size_t>(w)], ~free_seats.word(w)) << "row " << w;
+}
+
+INSTANTIATE_TEST_SUITE_P(Lanes, ChangeFeedLanes, ::testing::Values(std::size_t{1}, std::size_t{4}));
+
+TEST(ChangeFeed, AvailabilityDiffFoldsTheShowsChanges) {
+    BookingService svc(HallLayout::uniform(3, 10));
+    const booking::ShowId show = svc.find_show(1, 1);
+    EXPECT_EQ(svc.availability_diff(show, 0).status, booking::DiffStatus::NoFeed);
+    svc.enable_change_feed(1u << 4);
+    EXPECT_EQ(svc.availability_diff(999, 0).status, booking::DiffStatus::UnknownShow);
+
+    std::uint64_t position = svc.change_feed()->head();
+    const auto a = svc.book_seats(show, {"a1", "a2", "c10"});
+    ASSERT_TRUE(a.success);
+    const auto b = svc.book_seats(show, {"b3"});
+    ASSERT_TRUE(b.success);
+    ASSERT_TRUE(svc.cancel_seats(show, {"b3"}, static_cast<booking::BookingId>(b.id)).success); // nets out
+    ASSERT_TRUE(svc.book_seats(2, {"a5"}).success);                                            // another show
+
+    booking::AvailabilityDiff diff = svc.availability_diff(show, position);
+    ASSERT_EQ(diff.status, booking::DiffStatus::Ok);
+    EXPECT_EQ(diff.taken.word(0), 0x3u);
+    EXPECT_EQ(diff.taken.word(1), 0u);
+    EXPECT_EQ(diff.taken.word(2), 1u << 9);
+    EXPECT_TRUE(diff.freed.empty());
+    EXPECT_EQ(diff.position, svc.change_feed()->head());
+    position = diff.position;
+
+    EXPECT_TRUE(svc.availability_diff(show, position).taken.empty());
+    ASSERT_TRUE(svc.cancel_seats(show, {"a2"}, static_cast<booking::BookingId>(a.id)).success);
+    diff = svc.availability_diff(show, position);
+    EXPECT_TRUE(diff.taken.empty());
+    EXPECT_EQ(diff.freed.word(0), 0x2u);
+    EXPECT_EQ(diff.freed.count(), 1);
+
+    // More changes than the ring holds: the caller rereads the seat map
+    for (int i = 0; i < 20; ++i) {
+        const auto r = svc.book_seats(show, {"b1"});
+        ASSERT_TRUE(svc.cancel_seats(show, {"b1"}, static_cast<booking::BookingId>(r.id)).success);
+    }
+    diff = svc.availability_diff(show, position);
+    EXPECT_EQ(diff.status, booking::DiffStatus::Resync);
+    EXPECT_EQ(diff.position, svc.change_feed()->head());
+    EXPECT_EQ(svc.availability_diff(show, diff.position + 1).status, booking::DiffStatus::Resync);
+}
@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include "booking_server.hpp"
+#include "cluster.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingId;
+using booking::BookingResult;
+using booking::BookingServer;
+using booking::BookingService;
+using booking::ClusterRouter;
+using booking::ClusterStatus;
+using booking::HallLayout;
+using booking::HashRing;
+using booking::NodeId;
+using booking::ShowId;
+using booking::ShowTransfer;
+using namespace std::chrono_literals;
+
+namespace {
+
+/** @brief A booking_server cluster node serving its own BookingService on a thread. */
+struct TestNode {
+    TestNode() {
+        booking::BookingServerOptions options;
+        options.cluster_admin = true;
+        server = std::make_unique<BookingServer>(service, options);
+        EXPECT_EQ(server->listen(), booking::ServerStatus::Ok);
+        thread = std::thread([this] { server->run(); });
+    }
+    ~TestNode() {
+        server->stop();
+        thread.join();
+    }
+
+    BookingService service;
+    std::unique_ptr<BookingServer> server;
+    std::thread thread;
+};
+
+/** @brief Booking id in an "OK <id>" response (0 otherwise). */
+BookingId booked_id(const std::string& response) {
+    return response.rfind("OK ", 0) == 0 ? std::stoull(response.substr(3)) : 0u;
+}
+
+} // namespace
+
+TEST(HashRing, SpreadsShowsEvenlyAndMovesFewOnAJoin) {
+    HashRing ring;
+    EXPECT_EQ(ring.owner(1), booking::kNoNode);
+    for (NodeId n = 0; n < 4; ++n) ring.add_node(n);
+    constexpr int kShows = 20000;
+    std::vector<NodeId> before(kShows);
+    int per_node[5] = {};
+    for (int s = 0; s < kShows; ++s) ++per_node[before[static_cast<std::size_t>(s)] = ring.owner(s)];
+    for (int n = 0; n < 4; ++n) {
+        EXPECT_GT(per_node[n], kShows / 4 * 7 / 10) << n;
+        EXPECT_LT(per_node[n], kShows / 4 * 13 / 10) << n;
+    }
+
+    // A fifth node only takes shows, about a fifth of them, from the others
+    ring.add_node(4);
+    EXPECT_TRUE(ring.contains(4));
+    int moved = 0;
+    for (int s = 0; s < kShows; ++s) {
+        const NodeId now = ring.owner(s);
+        if (now != before[static_cast<std::size_t>(s)]) {
+            EXPECT_EQ(now, 4u);
+            ++moved;
+        }
+    }
+    EXPECT_GT(moved, kShows / 5 * 7 / 10);
+    EXPECT_LT(moved, kShows / 5 * 13 / 10);
+
+    ring.remove_node(4);
+    for (int s = 0; s < kShows; ++s) EXPECT_EQ(ring.owner(s), before[static_cast<std::size_t>(s)]);
+}
+
+TEST(ShowTransfer, MovesBookingsAndHoldsBetweenServices) {
+    BookingService from(HallLayout::uniform(4, 10));
+    BookingService to(HallLayout::uniform(4, 10));
+    const ShowId show = from.find_show(1, 1);
+    const BookingResult pair = from.book_seats(show, {"a1", "a2"});
+    const BookingResult group = from.book_seats(show, {"b3", "c3", "d3"});
+    ASSERT_TRUE(pair.success && group.success);
+    ASSERT_TRUE(from.hold_seats(show, {"d9"}, 10s).success);
+
+    ShowTransfer state;
+    ASSERT_EQ(from.take_show_state(show, state), booking::CatalogStatus::Ok);
+    EXPECT_EQ(from.available_count(show), 40);
+    ASSERT_EQ(state.bookings.size(), 2u);
+    ASSERT_EQ(state.holds.size(), 1u);
+    EXPECT_GT(state.holds[0].ttl, 9s);
+
+    ASSERT_EQ(to.put_show_state(state), booking::CatalogStatus::Ok);
+    EXPECT_EQ(to.available_count(show), 34);
+    EXPECT_EQ(to.seat_owner(show, HallLayout::seat_index(2, 2)), group.id);
+    EXPECT_TRUE(to.cancel_seats(show, {"a1", "a2"}, static_cast<BookingId>(pair.id)).success);
+    EXPECT_GT(to.book_seats(show, {"a5"}).id, group.id); // new ids never collide with moved ones
+
+    // Seats already taken on the target refuse the whole state
+    ShowTransfer twice = state;
+    EXPECT_EQ(to.put_show_state(twice), booking::CatalogStatus::DuplicateId);
+    EXPECT_EQ(to.put_show_state(ShowTransfer{}), booking::CatalogStatus::UnknownShow);
+}
+
+TEST(ShowTransfer, ExportAndImportOverTheTextProtocol) {
+    BookingService from;
+    BookingService to;
+    booking::TextCommandHandler source(from);
+    booking::TextCommandHandler target(to);
+    std::string out;
+    source.execute("export 1", out);
+    EXPECT_EQ(out, "ERR 0 unknown command\n"); // only on cluster nodes
+    source.set_cluster_admin(true);
+    target.set_cluster_admin(true);
+
+    out.clear();
+    source.execute("book 1 1 a1 a2", out);
+    const BookingId id = booked_id(out);
+    ASSERT_NE(id, 0u);
+    out.clear();
+    source.execute("export " + booking::to_string(from.find_show(1, 1)), out);
+    EXPECT_EQ(out, std::to_string(id) + "=0.1\nOK\n");
+
+    std::string answer;
+    target.execute("import " + booking::to_string(to.find_show(1, 1)) + " " + out.substr(0, out.find('\n')), answer);
+    EXPECT_EQ(answer, "OK\n");
+    EXPECT_EQ(to.seat_owner(to.find_show(1, 1), 1), id);
+    answer.clear();
+    target.execute("import 1 7=x", answer);
+    EXPECT_EQ(answer, "ERR 0 malformed show state\n");
+}
+
+TEST(ClusterRouter, RoutesShowsAndMovesThemWhenMembershipChanges) {
+    TestNode nodes[3];
+    BookingService catalog;
+    ClusterRouter router(catalog);
+    std::string out;
+    router.execute("seats 1 1", out);
+    EXPECT_EQ(out, "ERR 0 cluster node unavailable\n");
+    ASSERT_EQ(router.add_node(0, "127.0.0.1", nodes[0].server->port()), ClusterStatus::Ok);
+    EXPECT_EQ(router.add_node(0, "127.0.0.1", nodes[0].server->port()), ClusterStatus::InvalidNode);
+    EXPECT_EQ(router.add_node(7, "127.0.0.1", 1), ClusterStatus::ConnectError);
+
+    // One booking per show, all on the only node
+    const ShowId shows[] = {1, 2, 3, 4};
+    const char* requests[] = {"1 1", "1 2", "2 1", "3 2"};
+    BookingId ids[4] = {};
+    for (int i = 0; i < 4; ++i) {
+        out.clear();
+        router.execute(std::string("book ") + requests[i] + " a1", out);
+        ids[i] = booked_id(out);
+        ASSERT_NE(ids[i], 0u) << out;
+        EXPECT_EQ(router.owner(shows[i]), 0u);
+    }
+    EXPECT_EQ(router.shows_moved(), 0u);
+
+    // After every change each booking lives on its show's current node only
+    const auto placed = [&] {
+        for (int i = 0; i < 4; ++i) {
+            const NodeId owner = router.owner(shows[i]);
+            for (NodeId n = 0; n < 3; ++n) {
+                EXPECT_EQ(nodes[n].service.seat_owner(shows[i], 0), n == owner ? ids[i] : 0u) << i << " " << n;
+            }
+        }
+    };
+    NodeId before[4];
+    for (int i = 0; i < 4; ++i) before[i] = router.owner(shows[i]);
+    ASSERT_EQ(router.add_node(1, "127.0.0.1", nodes[1].server->port()), ClusterStatus::Ok);
+    ASSERT_EQ(router.add_node(2, "127.0.0.1", nodes[2].server->port()), ClusterStatus::Ok);
+    placed();
+    std::size_t changed = 0;
+    for (int i = 0; i < 4; ++i) changed += router.owner(shows[i]) != before[i] ? 1u : 0u;
+    EXPECT_GT(changed, 0u);
+    EXPECT_GE(router.shows_moved(), changed);
+
+    // Nodes leave: every show still answers, and booking ids issued before a move still cancel
+    for (int i = 0; i < 4; ++i) before[i] = router.owner(shows[i]);
+    const NodeId leaving = before[0];
+    ASSERT_EQ(router.remove_node(leaving), ClusterStatus::Ok);
+    EXPECT_EQ(router.remove_node(leaving), ClusterStatus::InvalidNode);
+    placed();
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_NE(router.owner(shows[i]), leaving);
+        if (before[i] != leaving) {
+            EXPECT_EQ(router.owner(shows[i]), before[i]); // only the leaver's shows move
+        }
+        out.clear();
+        router.execute(std::string("cancel ") + requests[i] + " " + std::to_string(ids[i]) + " a1", out);
+        EXPECT_EQ(out, "OK\n");
+        out.clear();
+        router.execute(std::string("book ") + requests[i] + " a1", out);
+        EXPECT_GT(booked_id(out), ids[i]);
+    }
+    out.clear();
+    router.execute("theaters 1", out);
+    EXPECT_EQ(out, "1 Central Cinema\n2 Mall Theater\nOK 2\n");
+    out.clear();
+    router.execute("export 1", out);
+    EXPECT_EQ(out, "ERR 0 unknown command\n");
+    out.clear();
+    EXPECT_EQ(router.execute("quit", out), booking::CommandOutcome::Close);
+
+    NodeId remaining[2];
+    int r = 0;
+    for (NodeId n = 0; n < 3; ++n) {
+        if (n != leaving) remaining[r++] = n;
+    }
+    ASSERT_EQ(router.remove_node(remaining[0]), ClusterStatus::Ok);
+    EXPECT_EQ(router.remove_node(remaining[1]), ClusterStatus::LastNode);
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "column_scan.hpp"
+
+#include <vector>
+
+namespace scan = booking::column_scan;
+
+namespace {
+
+std::vector<const scan::Kernels*> available_kernels() {
+    std::vector<const scan::Kernels*> out{&scan::scalar_kernels()};
+    if (scan::avx2_kernels()) out.push_back(scan::avx2_kernels());
+    return out;
+}
+
+} // namespace
+
+TEST(ColumnScan, MatchesAndFiltersLikeAPlainLoop) {
+    for (std::size_t n : {0u, 1u, 7u, 63u, 64u, 65u, 200u, 1000u}) {
+        std::vector<std::int32_t> movies(n);
+        std::vector<std::int64_t> times(n);
+        std::vector<std::uint8_t> runs(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            movies[i] = static_cast<std::int32_t>((i * 7u) % 5u);
+            times[i] = static_cast<std::int64_t>((i * 37u) % 100u) - 50;
+            runs[i] = static_cast<std::uint8_t>((i * 53u) % 256u); // covers bytes above 127
+        }
+        for (const scan::Kernels* k : available_kernels()) {
+            std::vector<std::uint64_t> bits(scan::bitmap_words(n), ~std::uint64_t{0});
+            k->match_eq(movies.data(), n, 3, bits.data());
+            k->and_range(times.data(), n, -10, 20, bits.data());
+            for (std::size_t i = 0; i < bits.size() * 64u; ++i) {
+                const bool expected = i < n && movies[i] == 3 && times[i] >= -10 && times[i] < 20;
+                ASSERT_EQ((bits[i / 64u] >> (i % 64u)) & 1u, expected ? 1u : 0u)
+                    << booking::seat_scan::to_string(k->isa) << " n=" << n << " row " << i;
+            }
+            EXPECT_EQ(k->find_eq(movies.data(), n, 4), n > 2u ? 2u : n);
+            EXPECT_EQ(k->find_eq(movies.data(), n, 9), n);
+
+            std::vector<std::uint64_t> ge(scan::bitmap_words(n), ~std::uint64_t{0});
+            k->match_ge_u8(runs.data(), n, 200, ge.data());
+            for (std::size_t i = 0; i < ge.size() * 64u; ++i) {
+                ASSERT_EQ((ge[i / 64u] >> (i % 64u)) & 1u, i < n && runs[i] >= 200 ? 1u : 0u)
+                    << booking::seat_scan::to_string(k->isa) << " n=" << n << " row " << i;
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include "concurrency_policy.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using booking::SeatMask;
+
+namespace {
+
+SeatMask seats(std::initializer_list<int> indexes) {
+    SeatMask m;
+    for (int i : indexes) m.set(i);
+    return m;
+}
+
+template <typename Policy>
+class PolicyShowsTest : public ::testing::Test {};
+
+using Policies = ::testing::Types<booking::AtomicCasPolicy, booking::ShowMutexPolicy, booking::ShowSpinlockPolicy,
+                                  booking::ShowRwLockPolicy, booking::FlatCombiningPolicy>;
+TYPED_TEST_SUITE(PolicyShowsTest, Policies);
+
+} // namespace
+
+TYPED_TEST(PolicyShowsTest, BooksAllOrNothing) {
+    booking::PolicyShows<TypeParam> shows(2, 4);
+    const int row = booking::HallLayout::seat_index(1, 0);
+    EXPECT_TRUE(shows.book(0, seats({0, 1, row})));
+    EXPECT_FALSE(shows.book(0, seats({2, row + 1, 1}))); // seat 1 is taken: nothing of it is booked
+    EXPECT_EQ(shows.booked(0), 3);
+    EXPECT_TRUE(shows.book(0, seats({2, row + 1})));
+    EXPECT_TRUE(shows.book(1, seats({0, 1, row})));    // shows are independent
+    shows.cancel(0, seats({0, 1}));
+    EXPECT_EQ(shows.booked(0), 3);
+    EXPECT_TRUE(shows.book(0, seats({1})));
+    EXPECT_EQ(shows.booked(1), 3);
+}
+
+TYPED_TEST(PolicyShowsTest, EachSeatIsBookedOnceUnderContention) {
+    booking::PolicyShows<TypeParam> shows(1, 2);
+    constexpr int kThreads = 4;
+    std::atomic<int> won{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            for (int seat = 0; seat < 64; ++seat) {
+                // Two-row requests overlap their neighbours, so the rollback path runs too
+                const SeatMask m = seats({seat, booking::HallLayout::seat_index(1, seat)});
+                if (shows.book(0, m)) won.fetch_add(1);
+            }
+        });
+    }
+    for (std::thread& th : threads) th.join();
+    EXPECT_EQ(won.load(), 64);
+    EXPECT_EQ(shows.booked(0), 128);
+}
+
+TEST(ConcurrencyPolicy, Names) {
+    EXPECT_STREQ(to_string(booking::ConcurrencyPolicy::AtomicCas), "atomic_cas");
+    EXPECT_STREQ(to_string(booking::FlatCombiningPolicy::kPolicy), "flat_combining");
+    EXPECT_STREQ(to_string(static_cast<booking::ConcurrencyPolicy>(99)), "unknown");
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include "epoch.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using booking::EpochManager;
+
+namespace {
+struct Tracked {
+    explicit Tracked(std::atomic<int>& live) : live_(live) { live_.fetch_add(1); }
+    ~Tracked() { live_.fetch_sub(1); }
+    std::atomic<int>& live_;
+    int value = 42;
+};
+} // namespace
+
+TEST(Epoch, RetiredObjectsAreFreedWithoutReaders) {
+    std::atomic<int> live{0};
+    EpochManager epochs;
+    epochs.retire(new Tracked(live));
+    EXPECT_EQ(live.load(), 0);
+    EXPECT_EQ(epochs.pending(), 0u);
+}
+
+TEST(Epoch, ActiveReaderDelaysReclamation) {
+    std::atomic<int> live{0};
+    EpochManager epochs;
+    {
+        EpochManager::Guard guard(epochs);
+        EpochManager::Guard nested(epochs);
+        epochs.retire(new Tracked(live));
+        EXPECT_EQ(live.load(), 1);
+        EXPECT_EQ(epochs.pending(), 1u);
+    }
+    EXPECT_EQ(epochs.reclaim(), 1u);
+    EXPECT_EQ(live.load(), 0);
+}
+
+TEST(Epoch, ReaderStartingAfterRetireDoesNotBlock) {
+    std::atomic<int> live{0};
+    EpochManager epochs;
+    EpochManager::Guard early(epochs);
+    epochs.retire(new Tracked(live)); // pinned by the early reader
+
+    std::thread late([&] {
+        EpochManager::Guard guard(epochs);
+        epochs.retire(new Tracked(live));
+    });
+    late.join();
+    EXPECT_EQ(live.load(), 2); // both retired while `early` was reading
+}
+
+TEST(Epoch, DestructorFreesPending) {
+    std::atomic<int> live{0};
+    {
+        EpochManager epochs;
+        EpochManager::Guard guard(epochs);
+        epochs.retire(new Tracked(live));
+        EXPECT_EQ(live.load(), 1);
+    }
+    EXPECT_EQ(live.load(), 0);
+}
+
+TEST(Epoch, ConcurrentPublishAndRead) {
+    std::atomic<int> live{0};
+    EpochManager epochs;
+    std::atomic<Tracked*> current{new Tracked(live)};
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                EpochManager::Guard guard(epochs);
+                EXPECT_EQ(current.load()->value, 42); // would read freed memory without the guard
+            }
+        });
+    }
+    for (int i = 0; i < 2000; ++i) {
+        Tracked* old = current.exchange(new Tracked(live));
+        epochs.retire(old);
+    }
+    done.store(true);
+    for (auto& r : readers) r.join();
+
+    epochs.reclaim();
+    EXPECT_EQ(live.load(), 1);
+    delete current.load();
+}
+
+TEST(Epoch, BatchedRetireesWaitForTheirBatch) {
+    std::atomic<int> live{0};
+    EpochManager epochs(4);
+    EXPECT_EQ(epochs.batch(), 4u);
+    for (int i = 0; i < 3; ++i) epochs.retire(new Tracked(live));
+    EXPECT_EQ(live.load(), 3); // deferred in this thread's list
+    EXPECT_EQ(epochs.pending(), 3u);
+    epochs.retire(new Tracked(live));
+    EXPECT_EQ(live.load(), 0); // the full batch was handed over and freed
+    EXPECT_EQ(epochs.pending(), 0u);
+
+    {
+        EpochManager::Guard guard(epochs);
+        epochs.retire(new Tracked(live));
+        EXPECT_EQ(epochs.reclaim(), 0u); // handed over, but pinned by the guard
+        EXPECT_EQ(epochs.pending(), 1u);
+    }
+    std::thread other([&] { epochs.retire(new Tracked(live)); }); // deferred in the other thread's list
+    other.join();
+    EXPECT_EQ(epochs.reclaim(), 1u);
+    EXPECT_EQ(live.load(), 1);
+    EXPECT_EQ(epochs.pending(), 1u);
+}
+
+TEST(Epoch, BatchedConcurrentPublishAndRead) {
+    std::atomic<int> live{0};
+    EpochManager epochs(16);
+    std::atomic<Tracked*> current{new Tracked(live)};
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                EpochManager::Guard guard(epochs);
+                EXPECT_EQ(current.load()->value, 42);
+            }
+        });
+    }
+    for (int i = 0; i < 2000; ++i) epochs.retire(current.exchange(new Tracked(live)));
+    done.store(true);
+    for (auto& r : readers) r.join();
+
+    epochs.reclaim();
+    EXPECT_EQ(live.load(), 1);
+    delete current.load();
+}
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include "flat_combiner.hpp"
+
+#include <thread>
+#include <vector>
+
+using booking::FlatCombiner;
+
+TEST(FlatCombiner, SerialisesCallsOfAllThreads) {
+    FlatCombiner combiner;
+    std::uint64_t counter = 0; // plain: only the combiner touches it
+    constexpr int kThreads = 4;
+    constexpr int kCalls = 5000;
+    std::vector<std::thread> threads;
+    std::vector<bool> ordered(kThreads, true);
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            std::uint64_t last = 0;
+            for (int i = 0; i < kCalls; ++i) {
+                const std::uint64_t ticket = combiner.run([&] { return ++counter; });
+                if (ticket <= last) ordered[t] = false; // a thread's calls apply in its order
+                last = ticket;
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(counter, std::uint64_t{kThreads} * kCalls);
+    for (bool ok : ordered) EXPECT_TRUE(ok);
+    EXPECT_EQ(combiner.requests(), std::uint64_t{kThreads} * kCalls);
+    EXPECT_GE(combiner.passes(), 1u);
+    EXPECT_LE(combiner.passes(), combiner.requests());
+}
+
+TEST(FlatCombiner, NestedCallRunsInline) {
+    FlatCombiner combiner;
+    const int v = combiner.run([&] { return combiner.run([] { return 20; }) + 1; });
+    EXPECT_EQ(v, 21);
+    EXPECT_EQ(combiner.requests(), 1u);
+}
@@ -0,0 +1,268 @@
+#include <gtest/gtest.h>
+
+#include "hall_layout.hpp"
+#include "seat_mask.hpp"
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using booking::HallLayout;
+using booking::RowSpec;
+
+TEST(HallLayout, SingleRowMatchesDefaultLabels) {
+    const HallLayout l = HallLayout::single_row(20);
+    EXPECT_EQ(l.row_count(), 1);
+    EXPECT_EQ(l.seat_count(), 20);
+    EXPECT_EQ(l.row_mask(0), 0xFFFFFu);
+
+    int seat = -1;
+    EXPECT_TRUE(l.try_parse_label("a1", seat));
+    EXPECT_EQ(seat, 0);
+    EXPECT_TRUE(l.try_parse_label("A20", seat));
+    EXPECT_EQ(seat, 19);
+    EXPECT_EQ(l.label(19), "a20");
+}
+
+TEST(HallLayout, RowLabelsAreBijectiveBase26) {
+    EXPECT_EQ(HallLayout::row_label_for(0), "a");
+    EXPECT_EQ(HallLayout::row_label_for(25), "z");
+    EXPECT_EQ(HallLayout::row_label_for(26), "aa");
+    EXPECT_EQ(HallLayout::row_label_for(27), "ab");
+    EXPECT_EQ(HallLayout::row_label_for(63), "bl");
+}
+
+TEST(HallLayout, SeatIndexMapsRowsToWords) {
+    const HallLayout l = HallLayout::uniform(30, 64);
+    EXPECT_EQ(l.seat_count(), 30 * 64);
+    EXPECT_EQ(l.row_mask(0), ~std::uint64_t{0});
+
+    int seat = -1;
+    ASSERT_TRUE(l.try_parse_label("ab64", seat));
+    EXPECT_EQ(HallLayout::row_of(seat), 27);
+    EXPECT_EQ(HallLayout::col_of(seat), 63);
+    EXPECT_EQ(l.label(seat), "ab64");
+}
+
+TEST(HallLayout, RejectsInvalidLabels) {
+    const HallLayout l({RowSpec{"a", 10}, RowSpec{"B", 12}});
+    int seat = -1;
+    EXPECT_TRUE(l.try_parse_label("b12", seat));
+    EXPECT_FALSE(l.try_parse_label("a11", seat));
+    EXPECT_FALSE(l.try_parse_label("c1", seat));
+    EXPECT_FALSE(l.try_parse_label("b", seat));
+    EXPECT_FALSE(l.try_parse_label("12", seat));
+    EXPECT_FALSE(l.try_parse_label("b1x", seat));
+    EXPECT_FALSE(l.try_parse_label("b+1", seat));
+    EXPECT_FALSE(l.contains(booking::HallLayout::seat_index(0, 10)));
+    EXPECT_TRUE(l.contains(booking::HallLayout::seat_index(1, 11)));
+}
+
+TEST(HallLayout, RejectsInvalidGeometry) {
+    EXPECT_THROW(HallLayout(std::vector<RowSpec>{}), std::invalid_argument);
+    EXPECT_THROW(HallLayout::single_row(0), std::invalid_argument);
+    EXPECT_THROW(HallLayout::single_row(65), std::invalid_argument);
+    EXPECT_THROW(HallLayout::uniform(65, 10), std::invalid_argument);
+    EXPECT_THROW(HallLayout({RowSpec{"a", 1}, RowSpec{"A", 1}}), std::invalid_argument);
+    EXPECT_THROW(HallLayout({RowSpec{"a1", 1}}), std::invalid_argument);
+}
+
+TEST(HallLayout, RunCostPrefersCentreOfHall) {
+    const HallLayout l = HallLayout::uniform(5, 10);
+    EXPECT_EQ(l.run_cost(2, 4, 2), 0);
+    EXPECT_LT(l.run_cost(2, 3, 2), l.run_cost(2, 0, 2));
+    EXPECT_LT(l.run_cost(1, 4, 2), l.run_cost(0, 4, 2));
+    EXPECT_EQ(l.run_cost(1, 4, 2), l.run_cost(3, 4, 2));
+}
+
+TEST(HallLayout, LabelTableMatchesFormattedLabels) {
+    const HallLayout l({RowSpec{"A", 12}, RowSpec{"bb", 64}, RowSpec{"zzzzzz", 3}});
+    EXPECT_EQ(l.label_view(0), "a1");
+    EXPECT_EQ(l.label_view(11), "a12");
+    EXPECT_EQ(l.label_view(HallLayout::seat_index(1, 63)), "bb64");
+    EXPECT_EQ(l.label(HallLayout::seat_index(2, 2)), "zzzzzz3");
+    for (int r = 0; r < l.row_count(); ++r) {
+        for (int c = 0; c < l.row_seats(r); ++c) {
+            const int seat = HallLayout::seat_index(r, c);
+            ASSERT_EQ(l.label_view(seat), l.row_label(r) + std::to_string(c + 1));
+            int parsed = -1;
+            ASSERT_TRUE(l.try_parse_label(l.label_view(seat), parsed));
+            ASSERT_EQ(parsed, seat);
+        }
+    }
+    // Views point into the layout's table, not temporaries
+    EXPECT_EQ(l.label_view(5).data(), l.label_view(5).data());
+}
+
+TEST(HallLayout, RendersSeatSetsIntoABuffer) {
+    const HallLayout l = HallLayout::uniform(3, 10);
+    const std::uint64_t words[] = {0b1000000101u, 0u, ~std::uint64_t{0}}; // row c: only 10 seats exist
+    std::vector<char> buf(l.max_rendered_size());
+    char* end = l.render_labels(words, 3, ' ', buf.data());
+    EXPECT_EQ(std::string(buf.data(), end), "a1 a3 a10 c1 c2 c3 c4 c5 c6 c7 c8 c9 c10");
+    EXPECT_EQ(l.render_labels(words, 1, ',', buf.data()) - buf.data(), 9);
+    EXPECT_EQ(std::string(buf.data(), 9), "a1,a3,a10");
+
+    const std::uint64_t none[] = {0u, 0u, 0u};
+    EXPECT_EQ(l.render_labels(none, 3, ' ', buf.data()), buf.data());
+
+    // Every seat fits the advertised bound
+    const std::uint64_t all[] = {~std::uint64_t{0}, ~std::uint64_t{0}, ~std::uint64_t{0}};
+    EXPECT_LE(static_cast<std::size_t>(l.render_labels(all, 3, ' ', buf.data()) - buf.data()), l.max_rendered_size());
+}
+
+TEST(HallLayout, PriceTiersFormCumulativeLevels) {
+    HallLayout l = HallLayout::uniform(3, 8);
+    EXPECT_EQ(l.price_levels(), 0);
+    EXPECT_EQ(l.level_at_most(1000), -1);
+
+    booking::PriceTier premium{"premium", 2500, {}};
+    premium.seats[1] = 0x3Cu; // b3..b6
+    booking::PriceTier standard{"standard", 1200, {}};
+    standard.seats[0] = 0xFFu;
+    standard.seats[1] = 0xC3u;
+    booking::PriceTier front{"front", 1200, {}};
+    front.seats[2] = 0x0Fu;
+    l.set_price_tiers({premium, standard, front});
+
+    ASSERT_EQ(l.price_tiers().size(), 3u);
+    EXPECT_EQ(l.price_tiers()[0].name, "standard");
+    EXPECT_EQ(l.price_tiers()[2].name, "premium");
+    ASSERT_EQ(l.price_levels(), 2);
+    EXPECT_EQ(l.level_price(0), 1200u);
+    EXPECT_EQ(l.level_price(1), 2500u);
+    EXPECT_EQ(l.level_seats(0)[0], 0xFFu);
+    EXPECT_EQ(l.level_seats(0)[1], 0xC3u);
+    EXPECT_EQ(l.level_seats(0)[2], 0x0Fu);
+    EXPECT_EQ(l.level_seats(1)[1], 0xFFu);
+    EXPECT_EQ(l.level_seats(1)[2], 0x0Fu); // c5..c8 are in no tier
+
+    EXPECT_EQ(l.level_at_most(1199), -1);
+    EXPECT_EQ(l.level_at_most(1200), 0);
+    EXPECT_EQ(l.level_at_most(2499), 0);
+    EXPECT_EQ(l.level_at_most(99999), 1);
+
+    booking::SeatMask seats;
+    seats.set(HallLayout::seat_index(1, 2)); // premium
+    seats.set(HallLayout::seat_index(1, 7)); // standard
+    seats.set(HallLayout::seat_index(2, 6)); // unpriced
+    EXPECT_EQ(l.price_of(seats), 3700u);
+}
+
+TEST(HallLayout, RejectsInvalidPriceTiers) {
+    HallLayout l = HallLayout::uniform(2, 4);
+    booking::PriceTier outside{"outside", 100, {}};
+    outside.seats[0] = 0x10u; // a5 does not exist
+    EXPECT_THROW(l.set_price_tiers({outside}), std::invalid_argument);
+    outside.seats[0] = 0;
+    outside.seats[2] = 1u; // no row c
+    EXPECT_THROW(l.set_price_tiers({outside}), std::invalid_argument);
+
+    booking::PriceTier a{"a", 100, {}};
+    a.seats[1] = 0x3u;
+    booking::PriceTier b{"b", 200, {}};
+    b.seats[1] = 0x6u;
+    EXPECT_THROW(l.set_price_tiers({a, b}), std::invalid_argument);
+    EXPECT_EQ(l.price_levels(), 0); // unchanged by a rejected call
+}
+
+TEST(HallLayout, SeatCategoriesOverlayTheRowMasks) {
+    HallLayout l = HallLayout::uniform(2, 8);
+    EXPECT_FALSE(l.has_seat_categories());
+    EXPECT_EQ(l.open_row_masks()[1], 0xFFu);
+
+    booking::SeatCategories c;
+    c.wheelchair[1] = 0x11u; // b1, b5
+    c.companion[1] = 0x22u;  // b2, b6
+    l.set_seat_categories(c);
+    EXPECT_TRUE(l.has_seat_categories());
+    EXPECT_EQ(l.open_row_masks()[0], 0xFFu);
+    EXPECT_EQ(l.open_row_masks()[1], 0xCCu);
+
+    EXPECT_TRUE(l.companion_rule_ok(1, 0x04u, 0x04u));  // no companion seat requested
+    EXPECT_FALSE(l.companion_rule_ok(1, 0x02u, 0x02u)); // b2 alone
+    EXPECT_TRUE(l.companion_rule_ok(1, 0x02u, 0x03u));  // b2 with b1
+    EXPECT_FALSE(l.companion_rule_ok(1, 0x22u, 0x23u)); // b6 has no booked space next to it
+    EXPECT_TRUE(l.companion_rule_ok(1, 0x20u, 0x31u));
+
+    booking::SeatCategories bad;
+    bad.companion[0] = 0x1u;
+    EXPECT_THROW(l.set_seat_categories(bad), std::invalid_argument); // no wheelchair space next to a1
+    bad.wheelchair[0] = 0x1u;
+    EXPECT_THROW(l.set_seat_categories(bad), std::invalid_argument); // both categories
+    bad = booking::SeatCategories{};
+    bad.wheelchair[2] = 0x1u;
+    EXPECT_THROW(l.set_seat_categories(bad), std::invalid_argument); // no row c
+    EXPECT_EQ(l.open_row_masks()[1], 0xCCu);                         // unchanged
+
+    l.set_seat_categories(booking::SeatCategories{});
+    EXPECT_FALSE(l.has_seat_categories());
+    EXPECT_EQ(l.open_row_masks()[1], 0xFFu);
+}
+
+TEST(HallLayout, AislesSplitRowsIntoBlocks) {
+    HallLayout l = HallLayout::uniform(2, 10);
+    EXPECT_FALSE(l.has_aisles());
+    EXPECT_EQ(l.adjacent(0), 0x1FFu);
+    EXPECT_EQ(l.block_starts(0, 3), 0xFFu);
+
+    // Row a: 3 | 4 | 3 seats; row b without aisles
+    std::array<std::uint64_t, HallLayout::kMaxRows> aisles{};
+    aisles[0] = (1u << 2) | (1u << 6);
+    l.set_aisles(aisles);
+    EXPECT_TRUE(l.has_aisles());
+    EXPECT_EQ(l.adjacent(0), 0x1BBu);
+    EXPECT_EQ(l.block_starts(0, 1), 0x3FFu);
+    EXPECT_EQ(l.block_starts(0, 3), (1u << 0) | (1u << 3) | (1u << 4) | (1u << 7));
+    EXPECT_EQ(l.block_starts(0, 4), 1u << 3);
+    EXPECT_EQ(l.block_starts(0, 5), 0u);
+    EXPECT_EQ(l.block_starts(1, 5), 0x3Fu);
+    EXPECT_EQ(l.block_starts(0, 65), 0u);
+    EXPECT_EQ(l.neighbours(0, 1u << 2), 1u << 1); // a4 is across the aisle
+    EXPECT_EQ(l.neighbours(1, 1u << 2), 0xAu);
+
+    std::array<std::uint64_t, HallLayout::kMaxRows> bad{};
+    bad[0] = 1u << 9; // no seat after a10
+    EXPECT_THROW(l.set_aisles(bad), std::invalid_argument);
+    bad = {};
+    bad[2] = 1u; // no row c
+    EXPECT_THROW(l.set_aisles(bad), std::invalid_argument);
+    EXPECT_EQ(l.aisles()[0], aisles[0]); // unchanged
+
+    // A companion seat must be next to its wheelchair space on the same side of the aisle
+    booking::SeatCategories c;
+    c.wheelchair[0] = 1u << 2; // a3
+    c.companion[0] = 1u << 3;  // a4
+    EXPECT_THROW(l.set_seat_categories(c), std::invalid_argument);
+    c.companion[0] = 1u << 1; // a2
+    l.set_seat_categories(c);
+    EXPECT_TRUE(l.companion_rule_ok(0, 0x2u, 0x6u));
+
+    l.set_aisles({});
+    EXPECT_FALSE(l.has_aisles());
+    EXPECT_EQ(l.block_starts(0, 4), 0x7Fu);
+}
+
+TEST(HallLayout, LabelGrammarsParseAndRenderTheirLabels) {
+    using booking::seat_label::LabelGrammar;
+    const HallLayout back = HallLayout::uniform(3, 12, LabelGrammar::SeatRow);
+    EXPECT_EQ(back.label_grammar(), LabelGrammar::SeatRow);
+    EXPECT_EQ(back.label(HallLayout::seat_index(2, 11)), "12c");
+    int seat = -1;
+    ASSERT_TRUE(back.try_parse_label("12C", seat));
+    EXPECT_EQ(seat, HallLayout::seat_index(2, 11));
+    EXPECT_FALSE(back.try_parse_label("c12", seat));
+
+    const HallLayout balcony({RowSpec{"balc", 4}, RowSpec{"stalls", 64}}, LabelGrammar::RowDashSeat);
+    EXPECT_EQ(balcony.label(HallLayout::seat_index(1, 63)), "stalls-64");
+    ASSERT_TRUE(balcony.try_parse_label("BALC-3", seat));
+    EXPECT_EQ(seat, HallLayout::seat_index(0, 2));
+    EXPECT_FALSE(balcony.try_parse_label("balc-5", seat)); // no such seat
+
+    // Same rows, other grammar: the labels differ, so a move translates no seat
+    const HallLayout front = HallLayout::uniform(3, 12);
+    const std::vector<int> table = back.translate_to(front);
+    EXPECT_EQ(table[static_cast<std::size_t>(HallLayout::seat_index(0, 0))], -1);
+}
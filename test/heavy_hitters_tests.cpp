@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include "heavy_hitters.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+using booking::HeavyHitters;
+
+TEST(HeavyHitters, FewKeysAreCountedExactly) {
+    HeavyHitters sketch;
+    EXPECT_TRUE(sketch.top(5).empty());
+    for (int i = 0; i < 30; ++i) sketch.add(3);
+    for (int i = 0; i < 10; ++i) sketch.add(1);
+    sketch.add(2, 20);
+
+    const std::vector<HeavyHitters::Item> top = sketch.top(5);
+    ASSERT_EQ(top.size(), 3u);
+    EXPECT_EQ(top[0].key, 3);
+    EXPECT_EQ(top[0].count, 30u);
+    EXPECT_EQ(top[1].key, 2);
+    EXPECT_EQ(top[1].count, 20u);
+    EXPECT_EQ(top[2].key, 1);
+    EXPECT_EQ(top[2].count, 10u);
+    for (const HeavyHitters::Item& item : top) EXPECT_EQ(item.error, 0u);
+
+    const std::vector<HeavyHitters::Item> first = sketch.top(1);
+    ASSERT_EQ(first.size(), 1u);
+    EXPECT_EQ(first[0].key, 3);
+}
+
+TEST(HeavyHitters, HeavyKeysSurviveALongTail) {
+    HeavyHitters sketch;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<std::int64_t> tail(100, 100099);
+    std::map<std::int64_t, std::uint64_t> truth;
+    for (int i = 0; i < 200000; ++i) {
+        // 30% of the stream goes to three keys, the rest to 100k rarely repeated ones
+        const int r = i % 10;
+        const std::int64_t key = r == 0 ? 10 : r == 1 ? 20 : r == 2 ? 30 : tail(rng);
+        sketch.add(key);
+        ++truth[key];
+    }
+    const std::vector<HeavyHitters::Item> top = sketch.top(3);
+    ASSERT_EQ(top.size(), 3u);
+    std::vector<std::int64_t> keys;
+    for (const HeavyHitters::Item& item : top) {
+        keys.push_back(item.key);
+        EXPECT_GE(item.count, truth[item.key]);
+        EXPECT_LE(item.count - item.error, truth[item.key]);
+    }
+    std::sort(keys.begin(), keys.end());
+    EXPECT_EQ(keys, (std::vector<std::int64_t>{10, 20, 30}));
+}
+
+TEST(HeavyHitters, MergesThreadShards) {
+    HeavyHitters sketch;
+    constexpr int kThreads = 4;
+    constexpr int kAdds = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&sketch, t] {
+            for (int i = 0; i < kAdds; ++i) {
+                sketch.add(42);
+                sketch.add(1000 + t * kAdds + i); // unique per thread
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    const std::vector<HeavyHitters::Item> top = sketch.top(1);
+    ASSERT_EQ(top.size(), 1u);
+    EXPECT_EQ(top[0].key, 42);
+    EXPECT_GE(top[0].count, static_cast<std::uint64_t>(kThreads * kAdds));
+    EXPECT_LE(top[0].count - top[0].error, static_cast<std::uint64_t>(kThreads * kAdds));
+}
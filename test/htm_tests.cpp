@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "htm.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace htm = booking::htm;
+
+TEST(Htm, TransactionSetsAllRowsOrNone) {
+    std::atomic<std::uint64_t> words[3] = {};
+    booking::SeatMask req;
+    req.or_word(0, 0x3u);
+    req.or_word(2, 0x10u);
+    std::uint64_t old[3] = {};
+    const htm::Outcome first = htm::or_words(words, req, old);
+    if (!htm::supported()) {
+        EXPECT_EQ(first, htm::Outcome::Unsupported);
+        EXPECT_EQ(words[0].load(), 0u);
+        GTEST_SKIP() << "no RTM on this CPU";
+    }
+    // A transaction may abort spuriously: retry until it commits or sees the conflict
+    htm::Outcome outcome = first;
+    while (outcome == htm::Outcome::Aborted) outcome = htm::or_words(words, req, old);
+    ASSERT_EQ(outcome, htm::Outcome::Committed);
+    EXPECT_EQ(words[0].load(), 0x3u);
+    EXPECT_EQ(words[2].load(), 0x10u);
+
+    booking::SeatMask overlap;
+    overlap.or_word(1, 0x1u);
+    overlap.or_word(2, 0x10u);
+    do outcome = htm::or_words(words, overlap, old); while (outcome == htm::Outcome::Aborted);
+    EXPECT_EQ(outcome, htm::Outcome::Conflict);
+    EXPECT_EQ(words[1].load(), 0u);
+}
+
+TEST(Htm, OutcomeNames) {
+    EXPECT_STREQ(htm::to_string(htm::Outcome::Committed), "committed");
+    EXPECT_STREQ(htm::to_string(htm::Outcome::Unsupported), "unsupported");
+}
+
+TEST(Htm, ServiceBookingsMatchTheSoftwarePath) {
+    booking::BookingService svc{booking::BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), booking::CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), booking::CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(4, 16));
+    ASSERT_EQ(svc.add_show(booking::Show{1, 1, 1, hall}), booking::CatalogStatus::Ok);
+    EXPECT_EQ(svc.enable_hardware_transactions(), htm::supported());
+    svc.enable_change_feed(1024);
+    booking::SeatChangeSubscriber changes(*svc.change_feed());
+
+    // Threads race for two-row pairs; every pair is won exactly once on either path
+    constexpr int kThreads = 4;
+    std::atomic<int> won{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            for (int seat = 1; seat <= 16; ++seat) {
+                const std::string n = std::to_string(seat);
+                if (svc.book_seats(1, {"a" + n, "c" + n}).success) won.fetch_add(1);
+            }
+        });
+    }
+    for (std::thread& th : threads) th.join();
+    EXPECT_EQ(won.load(), 16);
+    EXPECT_EQ(svc.available_count(1), 32);
+
+    const auto conflict = svc.book_seats(1, {"b1", "c1"});
+    EXPECT_EQ(conflict.status, booking::BookingStatus::AlreadyBooked);
+    EXPECT_TRUE(conflict.conflicts.test(booking::HallLayout::seat_index(2, 0))); // reported by the fallback
+    EXPECT_EQ(svc.available_count(1), 32);
+
+    // Both rows of a booking reach the change feed
+    std::vector<booking::SeatChange> out(1024);
+    bool gap = false;
+    changes.poll(out.data(), out.size(), gap);
+    ASSERT_TRUE(svc.book_seats(1, {"b2", "d2"}).success);
+    ASSERT_EQ(changes.poll(out.data(), out.size(), gap), 2u);
+    EXPECT_EQ(out[0].word, 1);
+    EXPECT_EQ(out[1].word, 3);
+
+    const booking::BookingService::HtmStats stats = svc.htm_stats();
+    if (!htm::supported()) {
+        EXPECT_EQ(stats.commits + stats.aborts + stats.fallbacks, 0u);
+    } else {
+        EXPECT_EQ(stats.commits + stats.fallbacks, 16u * kThreads + 2u);
+    }
+}
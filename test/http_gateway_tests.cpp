@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include "http_gateway.hpp"
+#include "live_config.hpp"
+
+#include <string>
+
+using booking::BookingService;
+using booking::CommandOutcome;
+using booking::HttpCommandHandler;
+
+namespace {
+
+std::string get(const char* path, const char* headers = "") {
+    return std::string("GET ") + path + " HTTP/1.1\r\nHost: x\r\n" + headers + "\r\n";
+}
+
+std::string post(const char* path, const std::string& body, const char* method = "POST") {
+    return std::string(method) + " " + path + " HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n"
+           + body;
+}
+
+/** @brief Runs @p in through @p h; the whole input must be consumed. */
+std::string run(HttpCommandHandler& h, const std::string& in, CommandOutcome* outcome = nullptr) {
+    std::string out;
+    CommandOutcome o = CommandOutcome::Continue;
+    const std::ptrdiff_t used = h.execute(in.data(), in.size(), out, o);
+    EXPECT_EQ(used, static_cast<std::ptrdiff_t>(in.size()));
+    if (outcome) *outcome = o;
+    return out;
+}
+
+std::string response(const char* status, const std::string& body, const char* connection = "") {
+    return std::string("HTTP/1.1 ") + status + "\r\nContent-Type: application/json\r\nContent-Length: "
+           + std::to_string(body.size()) + "\r\n" + connection + "\r\n" + body;
+}
+
+} // namespace
+
+TEST(HttpGateway, ServesTheCatalogAndBookings) {
+    BookingService svc;
+    HttpCommandHandler h(svc);
+
+    EXPECT_EQ(run(h, get("/movies")),
+              response("200 OK", R"([{"id":1,"title":"Inception"},{"id":2,"title":"Interstellar"},{"id":3,"title":"The Matrix"}])"));
+    EXPECT_EQ(run(h, get("/movies/1/theaters")),
+              response("200 OK", R"([{"id":1,"name":"Central Cinema"},{"id":2,"name":"Mall Theater"}])"));
+    EXPECT_EQ(run(h, get("/movies/33/theaters")), response("200 OK", "[]"));
+    EXPECT_EQ(run(h, get("/shows/22/1/seats")), response("404 Not Found", R"({"error":"no show for that movie+theater"})"));
+    EXPECT_EQ(run(h, get("/nowhere")), response("404 Not Found", R"({"error":"no such resource"})"));
+    EXPECT_EQ(run(h, get("/shows/1/1/book")), response("405 Method Not Allowed", R"({"error":"use POST"})"));
+
+    const std::string booked = run(h, post("/shows/1/1/book", "a1 a2\r\n"));
+    EXPECT_EQ(booked.rfind("HTTP/1.1 201 Created\r\n", 0), 0u) << booked;
+    EXPECT_NE(booked.find("{\"booking_id\":"), std::string::npos);
+    EXPECT_EQ(run(h, post("/shows/1/1/book", "a2")),
+              response("409 Conflict", R"({"status":5,"error":"One or more seats already booked"})"));
+    EXPECT_EQ(run(h, post("/shows/1/1/book", "a99")).rfind("HTTP/1.1 400 Bad Request\r\n", 0), 0u);
+
+    const std::string seats = run(h, get("/shows/1/1/seats"));
+    EXPECT_NE(seats.find(R"({"free":18,"seats":"a3 a4 )"), std::string::npos) << seats;
+}
+
+TEST(HttpGateway, CachesCatalogResponsesPerCatalogVersion) {
+    BookingService svc;
+    HttpCommandHandler h(svc);
+
+    const std::string first = run(h, get("/movies"));
+    EXPECT_EQ(run(h, get("/movies")), first);
+    EXPECT_EQ(run(h, get("/movies")), first);
+    EXPECT_EQ(h.cache_hits(), 2u);
+    EXPECT_EQ(h.cache_misses(), 1u);
+
+    // Seat maps are never cached
+    run(h, get("/shows/1/1/seats"));
+    EXPECT_EQ(h.cache_hits() + h.cache_misses(), 3u);
+
+    ASSERT_EQ(svc.add_movie(booking::Movie{4, "Tenet"}), booking::CatalogStatus::Ok);
+    const std::string updated = run(h, get("/movies"));
+    EXPECT_NE(updated.find(R"({"id":4,"title":"Tenet"})"), std::string::npos);
+    EXPECT_EQ(h.cache_misses(), 2u);
+}
+
+TEST(HttpGateway, PipelinesAndHonoursKeepAlive) {
+    BookingService svc;
+    HttpCommandHandler h(svc);
+
+    // Two pipelined requests, then a third one cut short: only the complete ones run
+    const std::string two = get("/movies/2/theaters") + get("/movies/2/theaters");
+    const std::string partial = two + "GET /movies HTT";
+    std::string out;
+    CommandOutcome outcome = CommandOutcome::Continue;
+    EXPECT_EQ(h.execute(partial.data(), partial.size(), out, outcome), static_cast<std::ptrdiff_t>(two.size()));
+    const std::string one = response("200 OK", R"([{"id":1,"name":"Central Cinema"}])");
+    EXPECT_EQ(out, one + one);
+    EXPECT_EQ(outcome, CommandOutcome::Continue);
+
+    // A body that has not fully arrived waits too
+    const std::string book = post("/shows/1/1/book", "a1");
+    EXPECT_EQ(h.execute(book.data(), book.size() - 1u, out, outcome), 0);
+
+    EXPECT_EQ(run(h, get("/movies/2/theaters", "Connection: close\r\n"), &outcome),
+              response("200 OK", R"([{"id":1,"name":"Central Cinema"}])", "Connection: close\r\n"));
+    EXPECT_EQ(outcome, CommandOutcome::Close);
+
+    // HTTP/1.0 closes unless asked to keep the connection
+    EXPECT_NE(run(h, "GET /movies HTTP/1.0\r\n\r\n", &outcome).find("Connection: close\r\n"), std::string::npos);
+    EXPECT_EQ(outcome, CommandOutcome::Close);
+    EXPECT_NE(run(h, "GET /movies HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n", &outcome).find("Connection: keep-alive\r\n"),
+              std::string::npos);
+    EXPECT_EQ(outcome, CommandOutcome::Continue);
+}
+
+TEST(HttpGateway, RejectsWhatItDoesNotSpeak) {
+    BookingService svc;
+    HttpCommandHandler h(svc);
+    h.set_max_request(256);
+
+    const auto fails = [&](const std::string& in, const char* status) {
+        std::string out;
+        CommandOutcome outcome = CommandOutcome::Continue;
+        EXPECT_EQ(h.execute(in.data(), in.size(), out, outcome), -1) << in;
+        EXPECT_EQ(outcome, CommandOutcome::Close);
+        EXPECT_EQ(out.rfind(std::string("HTTP/1.1 ") + status, 0), 0u) << out;
+        EXPECT_NE(out.find("Connection: close\r\n"), std::string::npos);
+    };
+    fails("PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n", "505");
+    fails("GET /movies HTTP/3\r\n\r\n", "505");
+    fails("GET\r\n\r\n", "400");
+    fails("POST /shows/1/1/book HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", "501");
+    fails("POST /shows/1/1/book HTTP/1.1\r\nContent-Length: 1000\r\n\r\n", "413");
+    fails("GET /" + std::string(300, 'x'), "431");
+
+    h.set_read_only(true);
+    EXPECT_EQ(run(h, post("/shows/1/1/book", "a1")).rfind("HTTP/1.1 403 Forbidden\r\n", 0), 0u);
+}
+
+TEST(HttpGateway, AdminEndpointReloadsTheLiveConfig) {
+    BookingService svc;
+    HttpCommandHandler h(svc);
+    EXPECT_EQ(run(h, get("/admin/config")), response("404 Not Found", R"({"error":"no such resource"})"));
+
+    booking::LiveConfig config;
+    h.set_live_config(&config);
+    EXPECT_EQ(run(h, post("/admin/config", "client_rate = 40:5\nhold.max_ttl_ms = 90000\n", "PUT")),
+              response("200 OK", R"({"version":2})"));
+    EXPECT_DOUBLE_EQ(config.current().client_rate.per_second, 40.0);
+    EXPECT_EQ(run(h, get("/admin/config")),
+              response("200 OK",
+                       R"({"version":2,"backoff_max_retries":256,"max_hold_ttl_ms":90000,"client_rate":40,)"
+                       R"("admission_shows":0})"));
+    EXPECT_EQ(run(h, post("/admin/config", "client_rate = 1\nwhat = 2", "PUT")),
+              response("400 Bad Request", R"({"error":"line 2: unknown key"})"));
+    EXPECT_EQ(config.version(), 2u);
+    EXPECT_EQ(run(h, post("/admin/config", "")), response("405 Method Not Allowed", R"({"error":"use GET or PUT"})"));
+}
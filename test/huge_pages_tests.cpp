@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "huge_pages.hpp"
+#include "show_table.hpp"
+
+#include <cstring>
+
+using booking::HugePages;
+using booking::HugeRegion;
+
+namespace {
+
+/** @brief Restores the process-wide setting when a test ends. */
+struct HugePagesSetting {
+    explicit HugePagesSetting(HugePages pages) { booking::set_huge_pages(pages); }
+    ~HugePagesSetting() { booking::set_huge_pages(HugePages::Off); }
+};
+
+} // namespace
+
+TEST(HugePages, NamesRoundTrip) {
+    for (HugePages p : {HugePages::Off, HugePages::Transparent, HugePages::Explicit2M, HugePages::Explicit1G}) {
+        HugePages parsed = HugePages::Off;
+        EXPECT_TRUE(booking::parse_huge_pages(booking::to_string(p), parsed));
+        EXPECT_EQ(parsed, p);
+    }
+    HugePages unchanged = HugePages::Transparent;
+    EXPECT_FALSE(booking::parse_huge_pages("4m", unchanged));
+    EXPECT_EQ(unchanged, HugePages::Transparent);
+    EXPECT_EQ(booking::huge_page_bytes(HugePages::Explicit2M), std::size_t{2} << 20);
+}
+
+TEST(HugePages, ExplicitPagesFallBackInsteadOfFailing) {
+    // Whether or not the machine has reserved huge pages, a mapping is always obtained
+    const HugeRegion region = booking::map_huge(3u << 20, HugePages::Explicit1G);
+    ASSERT_NE(region.data, nullptr);
+    EXPECT_NE(region.backing, HugePages::Off);
+    EXPECT_GE(region.bytes, std::size_t{3} << 20);
+    EXPECT_EQ(region.bytes % booking::huge_page_bytes(region.backing), 0u);
+    unsigned char* bytes = static_cast<unsigned char*>(region.data);
+    EXPECT_EQ(bytes[0], 0u); // zeroed
+    std::memset(bytes, 0xab, 3u << 20);
+    EXPECT_EQ(bytes[(3u << 20) - 1u], 0xabu);
+    const std::uint64_t before = booking::huge_page_stats().transparent_bytes + booking::huge_page_stats().huge_2m_bytes
+                                 + booking::huge_page_stats().huge_1g_bytes;
+    booking::unmap_huge(region);
+    const std::uint64_t after = booking::huge_page_stats().transparent_bytes + booking::huge_page_stats().huge_2m_bytes
+                                + booking::huge_page_stats().huge_1g_bytes;
+    EXPECT_EQ(before - after, region.bytes);
+}
+
+TEST(HugePages, LargeColumnsAreMappedWithTheCurrentSetting) {
+    const HugePagesSetting setting(HugePages::Transparent);
+    const std::uint64_t before = booking::huge_page_stats().transparent_bytes;
+    {
+        booking::HugeVector<std::int32_t> column(1u << 20, 7); // 4 MiB
+        EXPECT_GT(booking::huge_page_stats().transparent_bytes, before);
+        booking::set_huge_pages(HugePages::Off); // freeing follows the header, not the setting
+        EXPECT_EQ(column[12345], 7);
+    }
+    EXPECT_EQ(booking::huge_page_stats().transparent_bytes, before);
+    booking::HugeVector<std::int32_t> small(16, 1); // below kHugeAllocMin: plain operator new
+    EXPECT_EQ(booking::huge_page_stats().transparent_bytes, before);
+}
+
+TEST(HugePages, ShowStateComesFromHugePageSlabs) {
+    const HugePagesSetting setting(HugePages::Transparent);
+    struct alignas(64) State {
+        std::uint64_t word = 0;
+    };
+    booking::ShowTable<State> table(true);
+    for (int id = 0; id < 5000; ++id) table.emplace(id, [id](State& s) { s.word = static_cast<std::uint64_t>(id); });
+    EXPECT_EQ(table.backing(0), HugePages::Transparent);
+    EXPECT_EQ(table.backing(4999), HugePages::Transparent);
+    EXPECT_EQ(table.find(4321)->word, 4321u);
+
+    booking::ShowTable<State> plain;
+    plain.emplace(0, [](State&) {});
+    EXPECT_EQ(plain.backing(0), HugePages::Off);
+
+    booking::BookingService svc;
+    const booking::ShowId show = svc.find_show(1, 1);
+    EXPECT_EQ(svc.seat_state_pages(show), HugePages::Transparent);
+    EXPECT_TRUE(svc.book_seats(show, {"a1", "a2"}).success);
+    EXPECT_EQ(svc.available_count(show), 18);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "ids.hpp"
+#include "schedule_loader.hpp"
+
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+using booking::BookingService;
+using booking::CatalogStatus;
+using booking::MovieId;
+using booking::Show;
+using booking::ShowId;
+using booking::TheaterId;
+
+namespace {
+
+std::string temp_path(const char* name) {
+    const std::string path = ::testing::TempDir() + name;
+    std::remove(path.c_str());
+    return path;
+}
+
+// Ids beyond 32 bits, of an upstream system that numbers shows globally
+constexpr std::int64_t kMovie = 7000000000001;
+constexpr std::int64_t kTheater = 9000000000002;
+constexpr std::int64_t kShow = 5000000000003;
+
+void add_wide_show(BookingService& svc) {
+    ASSERT_EQ(svc.add_movie(booking::Movie{kMovie, "Wide"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{kTheater, "Far"}), CatalogStatus::Ok);
+    const booking::LayoutId layout = svc.add_layout(booking::HallLayout::uniform(2, 8));
+    ASSERT_EQ(svc.add_show(Show{kShow, kMovie, kTheater, layout}), CatalogStatus::Ok);
+}
+
+} // namespace
+
+TEST(Ids, AreDistinctTypesWithAnInvalidState) {
+    static_assert(!std::is_convertible<MovieId, ShowId>::value, "a movie id is not a show id");
+    static_assert(!std::is_convertible<ShowId, std::int64_t>::value, "the raw value is read explicitly");
+    static_assert(std::is_trivially_copyable<ShowId>::value, "ids are plain words");
+    EXPECT_FALSE(ShowId().valid());
+    EXPECT_EQ(ShowId(), ShowId::invalid());
+    EXPECT_FALSE(ShowId(-5).valid());
+    EXPECT_TRUE(ShowId(0).valid());
+    EXPECT_EQ(ShowId(kShow).value(), kShow);
+    EXPECT_LT(ShowId(1), ShowId(kShow));
+    EXPECT_EQ(booking::to_string(ShowId(kShow)), "5000000000003");
+
+    std::unordered_set<ShowId> seen = {ShowId(1), ShowId(kShow), ShowId(kShow)};
+    EXPECT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen.count(ShowId(kShow)), 1u);
+}
+
+TEST(Ids, LookupsMissReturnTheInvalidId) {
+    BookingService svc;
+    EXPECT_FALSE(svc.find_show(kMovie, kTheater).valid());
+    EXPECT_TRUE(svc.find_shows(kMovie, kTheater).empty());
+    EXPECT_TRUE(svc.list_theaters_for_movie(kMovie).empty());
+    EXPECT_EQ(svc.available_count(kShow), -1);
+}
+
+TEST(Ids, WideIdsAreBookableAndIndexed) {
+    BookingService svc;
+    add_wide_show(svc);
+    EXPECT_EQ(svc.find_show(kMovie, kTheater), kShow);
+    ASSERT_EQ(svc.list_theaters_for_movie(kMovie).size(), 1u);
+    EXPECT_EQ(svc.list_theaters_for_movie(kMovie)[0].id, kTheater);
+    // Only the low 32 bits of the id differ: still a different show
+    EXPECT_EQ(svc.available_count(kShow & 0xFFFFFFFF), -1);
+    EXPECT_TRUE(svc.book_seats(kShow, {"a1", "b8"}).success);
+    EXPECT_EQ(svc.available_count(kShow), 14);
+    EXPECT_EQ(svc.add_show(Show{kShow, kMovie, kTheater}), CatalogStatus::DuplicateId);
+    EXPECT_EQ(svc.remove_show(kShow), CatalogStatus::Ok);
+    EXPECT_FALSE(svc.find_show(kMovie, kTheater).valid());
+}
+
+TEST(Ids, WideIdsSurviveSnapshotsJournalsAndSchedules) {
+    const std::string snapshot = temp_path("ids_wide.snap");
+    const std::string journal = temp_path("ids_wide.log");
+    BookingService live{BookingService::EmptyCatalog{}};
+    add_wide_show(live);
+    ASSERT_EQ(live.write_snapshot(snapshot), booking::SnapshotStatus::Ok);
+    ASSERT_EQ(live.open_journal(journal, booking::JournalMode::Sync), booking::JournalStatus::Ok);
+    const auto res = live.book_seats(kShow, {"a3"});
+    ASSERT_TRUE(res.success);
+
+    for (booking::SnapshotLoad load : {booking::SnapshotLoad::Eager, booking::SnapshotLoad::Lazy}) {
+        BookingService restored{BookingService::EmptyCatalog{}};
+        ASSERT_EQ(restored.restore_snapshot(snapshot, load), booking::SnapshotStatus::Ok);
+        EXPECT_EQ(restored.find_show(kMovie, kTheater), kShow);
+        const booking::JournalReplay replay = restored.replay_journal(journal);
+        EXPECT_EQ(replay.status, booking::JournalStatus::Ok);
+        EXPECT_EQ(replay.applied, 1u);
+        EXPECT_EQ(restored.seat_owner(kShow, 2), res.id) << to_string(load);
+    }
+
+    booking::Schedule schedule;
+    const std::string text = "movie," + std::to_string(kMovie) + ",Wide\ntheater," + std::to_string(kTheater) +
+                             ",Far\nlayout,1,2x8\nshow," + std::to_string(kShow) + "," + std::to_string(kMovie) +
+                             "," + std::to_string(kTheater) + ",1\n";
+    ASSERT_EQ(booking::parse_schedule(text, 1, schedule).status, booking::ScheduleStatus::Ok);
+    ASSERT_EQ(schedule.shows.size(), 1u);
+    EXPECT_EQ(schedule.shows[0].id, kShow);
+    EXPECT_EQ(schedule.shows[0].movie_id, kMovie);
+    BookingService loaded{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(loaded.load_schedule(std::move(schedule)).status, booking::ScheduleStatus::Ok);
+    EXPECT_EQ(loaded.find_show(kMovie, kTheater), kShow);
+    EXPECT_EQ(loaded.available_count(kShow), 16);
+    std::remove(snapshot.c_str());
+    std::remove(journal.c_str());
+}
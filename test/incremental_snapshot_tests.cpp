@@ -0,0 +1,292 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "journal.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+using booking::BookingService;
+using booking::HallLayout;
+using booking::IncrementalSnapshotOptions;
+using booking::SnapshotStatus;
+
+namespace {
+
+/** @brief Empty directory under the test temp dir. */
+std::string snapshot_dir(const char* name) {
+    const std::string dir = ::testing::TempDir() + name;
+    ::mkdir(dir.c_str(), 0755);
+    std::remove((dir + "/base.snap").c_str());
+    for (int n = 1; n < 10; ++n) {
+        char file[32];
+        std::snprintf(file, sizeof(file), "/delta-%06d.snap", n);
+        std::remove((dir + file).c_str());
+    }
+    return dir;
+}
+
+bool exists(const std::string& path) {
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0;
+}
+
+IncrementalSnapshotOptions manual(const std::string& dir) {
+    IncrementalSnapshotOptions options;
+    options.directory = dir;
+    options.interval = std::chrono::hours(1); // passes run from the test only
+    return options;
+}
+
+/** @brief Catalog of 20 shows in one 10x20 hall. */
+void add_catalog(BookingService& svc) {
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), booking::CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), booking::CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(HallLayout::uniform(10, 20));
+    for (int id = 1; id <= 20; ++id) {
+        ASSERT_EQ(svc.add_show(booking::Show{id, 1, 1, hall}), booking::CatalogStatus::Ok);
+    }
+}
+
+} // namespace
+
+TEST(IncrementalSnapshot, DeltasCarryOnlyChangedShows) {
+    const std::string dir = snapshot_dir("incremental_deltas");
+    BookingService svc{BookingService::EmptyCatalog{}};
+    add_catalog(svc);
+    ASSERT_TRUE(svc.book_seats(1, {"a1", "a2"}).success);
+
+    ASSERT_EQ(svc.set_incremental_snapshots(manual(dir)), SnapshotStatus::Ok);
+    EXPECT_TRUE(exists(dir + "/base.snap"));
+    EXPECT_EQ(svc.incremental_snapshot_stats().bases, 1u);
+
+    // Nothing changed: no delta
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok);
+    EXPECT_EQ(svc.incremental_snapshot_stats().deltas, 0u);
+    EXPECT_FALSE(exists(dir + "/delta-000001.snap"));
+
+    ASSERT_TRUE(svc.book_seats(3, {"b1"}).success);
+    ASSERT_TRUE(svc.book_seats(3, {"b2"}).success);
+    ASSERT_TRUE(svc.book_seats(7, {"j20"}).success);
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok);
+    EXPECT_TRUE(exists(dir + "/delta-000001.snap"));
+    booking::IncrementalSnapshotStats stats = svc.incremental_snapshot_stats();
+    EXPECT_EQ(stats.deltas, 1u);
+    EXPECT_EQ(stats.delta_shows, 2u);
+
+    ASSERT_TRUE(svc.book_seats(7, {"j19"}).success);
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok);
+    stats = svc.incremental_snapshot_stats();
+    EXPECT_EQ(stats.deltas, 2u);
+    EXPECT_EQ(stats.delta_shows, 3u);
+    EXPECT_EQ(stats.bases, 1u);
+    EXPECT_EQ(stats.failures, 0u);
+    EXPECT_EQ(svc.set_incremental_snapshots(IncrementalSnapshotOptions{}), SnapshotStatus::Ok);
+}
+
+TEST(IncrementalSnapshot, RestoresBasePlusDeltas) {
+    const std::string dir = snapshot_dir("incremental_restore");
+    BookingService svc{BookingService::EmptyCatalog{}};
+    add_catalog(svc);
+    const auto kept = svc.book_seats(2, {"a1", "a2", "a3"});
+    const auto cancelled = svc.book_seats(2, {"c5"});
+    ASSERT_TRUE(kept.success && cancelled.success);
+    ASSERT_EQ(svc.set_incremental_snapshots(manual(dir)), SnapshotStatus::Ok);
+
+    const auto later = svc.book_seats(5, {"d4", "d5"});
+    ASSERT_TRUE(later.success);
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok);
+    ASSERT_TRUE(svc.cancel_seats(2, {"c5"}, static_cast<booking::BookingId>(cancelled.id)).success);
+    const auto last = svc.book_seats(5, {"e1"});
+    ASSERT_TRUE(last.success);
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok);
+    ASSERT_EQ(svc.incremental_snapshot_stats().deltas, 2u);
+
+    BookingService restored{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(restored.restore_snapshot_chain(dir), SnapshotStatus::Ok);
+    for (int id = 1; id <= 20; ++id) EXPECT_EQ(restored.available_count(id), svc.available_count(id)) << id;
+    EXPECT_EQ(restored.seat_owner(2, HallLayout::seat_index(0, 1)), kept.id);
+    EXPECT_EQ(restored.seat_owner(2, HallLayout::seat_index(2, 4)), 0u);
+    EXPECT_EQ(restored.seat_owner(5, HallLayout::seat_index(3, 4)), later.id);
+    EXPECT_EQ(restored.seat_owner(5, HallLayout::seat_index(4, 0)), last.id);
+    EXPECT_TRUE(restored.book_seats(2, {"c5"}).success);
+    const auto fresh = restored.book_seats(9, {"a1"});
+    ASSERT_TRUE(fresh.success);
+    EXPECT_GT(fresh.id, last.id);
+}
+
+TEST(IncrementalSnapshot, DeltasCarrySparseShowIds) {
+    const std::string dir = snapshot_dir("incremental_sparse");
+    BookingService svc{BookingService::EmptyCatalog{}};
+    add_catalog(svc);
+    const booking::LayoutId hall = svc.add_layout(HallLayout::uniform(4, 4));
+    ASSERT_EQ(svc.add_show(booking::Show{1500000000, 1, 1, hall}), booking::CatalogStatus::Ok);
+    ASSERT_EQ(svc.set_incremental_snapshots(manual(dir)), SnapshotStatus::Ok);
+
+    const auto sparse = svc.book_seats(1500000000, {"d4"});
+    ASSERT_TRUE(sparse.success);
+    ASSERT_TRUE(svc.book_seats(4, {"a1"}).success);
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok);
+    EXPECT_EQ(svc.incremental_snapshot_stats().delta_shows, 2u);
+
+    BookingService restored{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(restored.restore_snapshot_chain(dir), SnapshotStatus::Ok);
+    EXPECT_EQ(restored.seat_owner(1500000000, HallLayout::seat_index(3, 3)), sparse.id);
+    EXPECT_EQ(restored.available_count(1500000000), 15);
+    EXPECT_EQ(restored.available_count(4), svc.available_count(4));
+    EXPECT_EQ(svc.set_incremental_snapshots(IncrementalSnapshotOptions{}), SnapshotStatus::Ok);
+}
+
+TEST(IncrementalSnapshot, CatalogChangeWritesNewBase) {
+    const std::string dir = snapshot_dir("incremental_catalog");
+    BookingService svc{BookingService::EmptyCatalog{}};
+    add_catalog(svc);
+    ASSERT_EQ(svc.set_incremental_snapshots(manual(dir)), SnapshotStatus::Ok);
+    ASSERT_TRUE(svc.book_seats(1, {"a1"}).success);
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok);
+    ASSERT_TRUE(exists(dir + "/delta-000001.snap"));
+
+    ASSERT_EQ(svc.add_show(booking::Show{21, 1, 1, 0}), booking::CatalogStatus::Ok);
+    ASSERT_TRUE(svc.book_seats(21, {"a1"}).success);
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok);
+    const booking::IncrementalSnapshotStats stats = svc.incremental_snapshot_stats();
+    EXPECT_EQ(stats.bases, 2u);
+    EXPECT_EQ(stats.deltas, 1u);
+    EXPECT_FALSE(exists(dir + "/delta-000001.snap")); // the old base's deltas are gone
+
+    BookingService restored{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(restored.restore_snapshot_chain(dir), SnapshotStatus::Ok);
+    EXPECT_EQ(restored.available_count(21), svc.available_count(21));
+    EXPECT_EQ(restored.available_count(1), svc.available_count(1));
+}
+
+TEST(IncrementalSnapshot, FullEveryBoundsTheChain) {
+    const std::string dir = snapshot_dir("incremental_full_every");
+    BookingService svc{BookingService::EmptyCatalog{}};
+    add_catalog(svc);
+    IncrementalSnapshotOptions options = manual(dir);
+    options.full_every = 2;
+    ASSERT_EQ(svc.set_incremental_snapshots(options), SnapshotStatus::Ok);
+    const char* seats[] = {"a1", "a2", "a3"};
+    for (const char* seat : seats) {
+        ASSERT_TRUE(svc.book_seats(4, {seat}).success);
+        ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok);
+    }
+    const booking::IncrementalSnapshotStats stats = svc.incremental_snapshot_stats();
+    EXPECT_EQ(stats.deltas, 2u);
+    EXPECT_EQ(stats.bases, 2u);
+    EXPECT_FALSE(exists(dir + "/delta-000001.snap"));
+}
+
+TEST(IncrementalSnapshot, CheckpointsCompactTheJournal) {
+    const std::string dir = snapshot_dir("incremental_checkpoint");
+    const std::string journal = dir + "/journal.log";
+    std::remove(journal.c_str());
+    BookingService svc{BookingService::EmptyCatalog{}};
+    add_catalog(svc);
+    ASSERT_EQ(svc.open_journal(journal, booking::JournalMode::Sync), booking::JournalStatus::Ok);
+    for (int id = 1; id <= 20; ++id) ASSERT_TRUE(svc.book_seats(id, {"a1", "a2"}).success);
+    const auto size_of = [](const std::string& path) {
+        struct stat st;
+        return ::stat(path.c_str(), &st) == 0 ? static_cast<std::size_t>(st.st_size) : 0u;
+    };
+    const std::size_t full = size_of(journal);
+
+    IncrementalSnapshotOptions options = manual(dir);
+    options.full_every = 1;
+    options.compact_journal = true;
+    ASSERT_EQ(svc.set_incremental_snapshots(options), SnapshotStatus::Ok); // base: the journal so far is covered
+    EXPECT_EQ(svc.incremental_snapshot_stats().compactions, 1u);
+    EXPECT_LT(size_of(journal), full / 10u);
+
+    ASSERT_TRUE(svc.book_seats(3, {"b1"}).success);
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok); // delta
+    const auto last = svc.book_seats(4, {"b2"});
+    ASSERT_TRUE(last.success);
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok); // base again
+    const auto after = svc.book_seats(5, {"c3"}); // only in the journal
+    ASSERT_TRUE(after.success);
+    EXPECT_EQ(svc.incremental_snapshot_stats().compactions, 2u);
+    svc.set_incremental_snapshots(IncrementalSnapshotOptions{});
+
+    BookingService recovered{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(recovered.restore_snapshot_chain(dir), SnapshotStatus::Ok);
+    const booking::JournalReplay replay = recovered.replay_journal(journal);
+    EXPECT_EQ(replay.status, booking::JournalStatus::Ok);
+    EXPECT_EQ(replay.applied, 1u);
+    for (int id = 1; id <= 20; ++id) EXPECT_EQ(recovered.available_count(id), svc.available_count(id)) << id;
+    EXPECT_EQ(recovered.seat_owner(4, HallLayout::seat_index(1, 1)), last.id);
+    EXPECT_EQ(recovered.seat_owner(5, HallLayout::seat_index(2, 2)), after.id);
+    std::remove(journal.c_str());
+}
+
+TEST(IncrementalSnapshot, BackgroundPassesRunBesideBookings) {
+    const std::string dir = snapshot_dir("incremental_background");
+    BookingService svc{BookingService::EmptyCatalog{}};
+    add_catalog(svc);
+    IncrementalSnapshotOptions options = manual(dir);
+    options.interval = std::chrono::milliseconds(1);
+    ASSERT_EQ(svc.set_incremental_snapshots(options), SnapshotStatus::Ok);
+    std::thread writer([&] {
+        for (int seat = 0; seat < 200; ++seat) {
+            const std::string label = std::string(1, static_cast<char>('a' + seat / 20)) + std::to_string(seat % 20 + 1);
+            for (int show = 1; show <= 20; show += 3) svc.book_seats(show, {label});
+        }
+    });
+    writer.join();
+    // One more pass catches whatever the last background pass missed
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok);
+    ASSERT_EQ(svc.set_incremental_snapshots(IncrementalSnapshotOptions{}), SnapshotStatus::Ok);
+    EXPECT_EQ(svc.incremental_snapshot_stats().failures, 0u);
+
+    BookingService restored{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(restored.restore_snapshot_chain(dir), SnapshotStatus::Ok);
+    for (int id = 1; id <= 20; ++id) EXPECT_EQ(restored.available_count(id), svc.available_count(id)) << id;
+    EXPECT_EQ(restored.available_count(1), 0);
+}
+
+TEST(IncrementalSnapshot, DamagedDeltaEndsTheChain) {
+    const std::string dir = snapshot_dir("incremental_damaged");
+    BookingService svc{BookingService::EmptyCatalog{}};
+    add_catalog(svc);
+    ASSERT_EQ(svc.set_incremental_snapshots(manual(dir)), SnapshotStatus::Ok);
+    ASSERT_TRUE(svc.book_seats(1, {"a1"}).success);
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok);
+    ASSERT_TRUE(svc.book_seats(2, {"a1"}).success);
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok);
+    ASSERT_TRUE(svc.book_seats(3, {"a1"}).success);
+    ASSERT_EQ(svc.write_incremental_snapshot(), SnapshotStatus::Ok);
+    ASSERT_EQ(svc.set_incremental_snapshots(IncrementalSnapshotOptions{}), SnapshotStatus::Ok);
+
+    // Flip a byte of the second delta: the first still applies, the third no longer does
+    const std::string second = dir + "/delta-000002.snap";
+    std::string bytes;
+    {
+        std::ifstream in(second, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    ASSERT_FALSE(bytes.empty());
+    bytes.back() = static_cast<char>(bytes.back() ^ 0x5A);
+    {
+        std::ofstream out(second, std::ios::binary | std::ios::trunc);
+        out << bytes;
+    }
+
+    BookingService restored{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(restored.restore_snapshot_chain(dir), SnapshotStatus::Ok);
+    const int seats = restored.layout_for_show(1)->seat_count();
+    EXPECT_EQ(restored.available_count(1), seats - 1);
+    EXPECT_EQ(restored.available_count(2), seats);
+    EXPECT_EQ(restored.available_count(3), seats);
+
+    // A missing base is an error
+    BookingService none{BookingService::EmptyCatalog{}};
+    EXPECT_EQ(none.restore_snapshot_chain(snapshot_dir("incremental_missing")), SnapshotStatus::IoError);
+}
@@ -0,0 +1,436 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "crc32c.hpp"
+#include "journal.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::HallLayout;
+using booking::Journal;
+using booking::JournalMode;
+using booking::JournalOp;
+using booking::JournalReader;
+using booking::JournalRecord;
+using booking::JournalStatus;
+using booking::SeatMask;
+
+namespace {
+
+std::string temp_path(const char* name) {
+    const std::string path = ::testing::TempDir() + name;
+    std::remove(path.c_str());
+    return path;
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+std::vector<JournalRecord> read_records(const std::string& path) {
+    const std::string bytes = read_file(path);
+    JournalReader reader(bytes);
+    EXPECT_EQ(reader.status(), JournalStatus::Ok);
+    std::vector<JournalRecord> out;
+    JournalRecord r;
+    while (reader.next(r)) out.push_back(r);
+    return out;
+}
+
+/** @brief Service with one movie/theater and @p shows 8x64 shows. */
+void add_halls(BookingService& svc, int shows) {
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), booking::CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), booking::CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(HallLayout::uniform(8, 64));
+    for (int s = 0; s < shows; ++s) ASSERT_EQ(svc.add_show(booking::Show{s, 1, 1, hall}), booking::CatalogStatus::Ok);
+}
+
+void expect_same_seats(const BookingService& a, const BookingService& b, int shows) {
+    for (int s = 0; s < shows; ++s) {
+        for (int seat = 0; seat < 8 * 64; ++seat) {
+            ASSERT_EQ(a.seat_owner(s, seat), b.seat_owner(s, seat)) << "show " << s << " seat " << seat;
+        }
+        ASSERT_EQ(a.available_count(s), b.available_count(s)) << "show " << s;
+    }
+}
+
+} // namespace
+
+TEST(Journal, WritesRecordsInOrderAndContinuesLsns) {
+    const std::string path = temp_path("journal_records.log");
+    SeatMask small;
+    small.set(3);
+    SeatMask wide; // 12 rows: spans several ring slots
+    for (int r = 2; r < 14; ++r) wide.set(HallLayout::seat_index(r, r));
+    {
+        Journal j;
+        ASSERT_EQ(j.open(path, JournalMode::Async, 16), JournalStatus::Ok);
+        for (int i = 0; i < 40; ++i) j.append(JournalOp::Book, i, static_cast<std::uint32_t>(i + 1), i % 3 ? small : wide);
+        j.append(JournalOp::Cancel, 7, 99, small);
+        EXPECT_TRUE(j.sync());
+        EXPECT_EQ(j.durable_lsn(), j.next_lsn());
+    }
+    std::vector<JournalRecord> records = read_records(path);
+    ASSERT_EQ(records.size(), 41u);
+    for (int i = 0; i < 40; ++i) {
+        EXPECT_EQ(records[static_cast<std::size_t>(i)].show_id, i);
+        EXPECT_EQ(records[static_cast<std::size_t>(i)].seats.count(), i % 3 ? 1 : 12);
+        if (i > 0) {
+            EXPECT_GT(records[static_cast<std::size_t>(i)].lsn, records[static_cast<std::size_t>(i - 1)].lsn);
+        }
+    }
+    EXPECT_EQ(records.back().op, JournalOp::Cancel);
+    EXPECT_TRUE(records[0].seats.test(HallLayout::seat_index(13, 13)));
+
+    // A torn tail is ignored by readers and cut off on reopen; LSNs continue
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out << std::string(20, '\x7f');
+    }
+    EXPECT_EQ(read_records(path).size(), 41u);
+    {
+        Journal j;
+        ASSERT_EQ(j.open(path, JournalMode::Sync), JournalStatus::Ok);
+        EXPECT_GT(j.next_lsn(), records.back().lsn);
+        j.wait_durable(j.append(JournalOp::Book, 1, 5, small));
+    }
+    records = read_records(path);
+    ASSERT_EQ(records.size(), 42u);
+    EXPECT_GT(records[41].lsn, records[40].lsn);
+
+    const std::string bogus = temp_path("journal_bogus.log");
+    {
+        std::ofstream out(bogus, std::ios::binary);
+        out << "definitely not a journal";
+    }
+    Journal j;
+    EXPECT_EQ(j.open(bogus, JournalMode::Sync), JournalStatus::BadHeader);
+    std::remove(bogus.c_str());
+    std::remove(path.c_str());
+}
+
+TEST(Journal, BackendsWriteIdenticalFiles) {
+    const std::string by_write = temp_path("journal_write.log");
+    const std::string by_uring = temp_path("journal_uring.log");
+    const std::string by_mapping = temp_path("journal_mapped.log");
+    const std::string by_direct = temp_path("journal_direct.log");
+    for (const auto& [path, backend] : {std::make_pair(by_write, booking::JournalBackend::Write),
+                                        std::make_pair(by_uring, booking::JournalBackend::IoUring),
+                                        std::make_pair(by_mapping, booking::JournalBackend::Mapped),
+                                        std::make_pair(by_direct, booking::JournalBackend::Direct)}) {
+        for (JournalMode mode : {JournalMode::Sync, JournalMode::None}) {
+            Journal j; // reopened: the second round appends after the first
+            ASSERT_EQ(j.open(path, mode, 16, backend, 4096), JournalStatus::Ok); // Mapped: several segments
+            if (backend == booking::JournalBackend::Write) {
+                EXPECT_EQ(j.backend(), booking::JournalBackend::Write);
+            }
+            for (int i = 0; i < 100; ++i) {
+                SeatMask seats;
+                for (int r = 0; r <= i % 9; ++r) seats.set(HallLayout::seat_index(r, i % 64));
+                j.append(JournalOp::Book, i, static_cast<std::uint32_t>(i + 1), seats);
+            }
+            EXPECT_TRUE(j.sync());
+            EXPECT_FALSE(j.failed());
+        }
+    }
+    EXPECT_EQ(read_records(by_uring).size(), 200u);
+    EXPECT_EQ(read_file(by_write), read_file(by_uring));
+    EXPECT_EQ(read_file(by_write), read_file(by_mapping));
+    EXPECT_EQ(read_file(by_write), read_file(by_direct));
+    std::remove(by_write.c_str());
+    std::remove(by_uring.c_str());
+    std::remove(by_mapping.c_str());
+    std::remove(by_direct.c_str());
+}
+
+TEST(Journal, DirectWritesRewriteTheirLastBlock) {
+    const std::string path = temp_path("journal_direct_blocks.log");
+    SeatMask seats;
+    seats.set(3);
+    Journal j;
+    ASSERT_EQ(j.open(path, JournalMode::Sync, 16, booking::JournalBackend::Direct), JournalStatus::Ok);
+    if (j.backend() != booking::JournalBackend::Direct) GTEST_SKIP() << "no O_DIRECT on this file system";
+
+    // One record per commit: each write repeats the records already in its block
+    for (int i = 0; i < 120; ++i) {
+        ASSERT_TRUE(j.wait_durable(j.append(JournalOp::Book, i, static_cast<std::uint32_t>(i + 1), seats)));
+    }
+    const std::string bytes = read_file(path);
+    EXPECT_EQ(bytes.size() % Journal::kDirectBlock, 0u);
+    EXPECT_EQ(bytes.size(), 2u * Journal::kDirectBlock); // 16 + 120 * 40 bytes, zero padded
+    const std::vector<JournalRecord> records = read_records(path);
+    ASSERT_EQ(records.size(), 120u);
+    EXPECT_EQ(records[119].booking_id, 120u);
+
+    ASSERT_EQ(j.compact(records[100].lsn), JournalStatus::Ok); // continues inside the copied block
+    ASSERT_TRUE(j.wait_durable(j.append(JournalOp::Cancel, 7, 8, seats)));
+    EXPECT_EQ(read_records(path).size(), 21u);
+    std::remove(path.c_str());
+}
+
+TEST(Journal, MappedSegmentsAreEndedByTheirZeroTail) {
+    const std::string path = temp_path("journal_segments.log");
+    const std::string crashed = temp_path("journal_segments_crashed.log");
+    SeatMask seats;
+    seats.set(9);
+    Journal j;
+    ASSERT_EQ(j.open(path, JournalMode::Sync, 16, booking::JournalBackend::Mapped, 4096), JournalStatus::Ok);
+    EXPECT_EQ(j.backend(), booking::JournalBackend::Mapped);
+    for (int i = 0; i < 150; ++i) j.append(JournalOp::Book, i, static_cast<std::uint32_t>(i + 1), seats);
+    ASSERT_TRUE(j.sync());
+
+    // While open the file is whole segments; the records end at the first zero header
+    const std::string bytes = read_file(path);
+    EXPECT_EQ(bytes.size() % 4096u, 0u);
+    EXPECT_GT(bytes.size(), booking::kJournalHeaderSize + 150u * 40u);
+    EXPECT_EQ(read_records(path).size(), 150u);
+
+    // A copy taken now is what a crash leaves: reopening cuts the tail and continues
+    {
+        std::ofstream out(crashed, std::ios::binary);
+        out << bytes;
+    }
+    Journal recovered;
+    ASSERT_EQ(recovered.open(crashed, JournalMode::Sync), JournalStatus::Ok);
+    EXPECT_EQ(recovered.next_lsn(), j.next_lsn());
+    recovered.wait_durable(recovered.append(JournalOp::Cancel, 3, 4, seats));
+    EXPECT_EQ(read_records(crashed).size(), 151u);
+    std::remove(path.c_str());
+    std::remove(crashed.c_str());
+}
+
+TEST(Journal, UpgradesVersion2FilesOnOpen) {
+    const std::string path = temp_path("journal_v2.log");
+    {
+        // One version 2 record: show 7, booking 3, row 0 seat 5, checksummed with snapshot_checksum
+        std::uint64_t file[7] = {};
+        std::memcpy(file, "BKJRNL\r\n", 8);
+        file[1] = 2u;
+        file[2] = 11u;                                               // lsn
+        file[3] = 7u;                                                // show
+        file[4] = 3u | (std::uint64_t{1} << 40) | (std::uint64_t{1} << 48); // booking, 1 word, Book
+        file[6] = std::uint64_t{1} << 5;
+        file[5] = booking::snapshot_checksum(&file[6], 1, booking::snapshot_checksum(&file[2], 3));
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(file), sizeof(file));
+    }
+    std::vector<JournalRecord> records = read_records(path);
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(JournalReader(read_file(path)).version(), 2u);
+
+    {
+        Journal j;
+        ASSERT_EQ(j.open(path, JournalMode::Sync), JournalStatus::Ok);
+        EXPECT_EQ(j.next_lsn(), 12u);
+        SeatMask seats;
+        seats.set(6);
+        j.wait_durable(j.append(JournalOp::Book, 7, 4, seats));
+    }
+    EXPECT_EQ(JournalReader(read_file(path)).version(), booking::kJournalVersion);
+    records = read_records(path);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].lsn, 11u);
+    EXPECT_EQ(records[0].booking_id, 3u);
+    EXPECT_TRUE(records[0].seats.test(5));
+    std::remove(path.c_str());
+}
+
+TEST(Crc32c, MatchesTheCheckValueInPieces) {
+    const char* check = "123456789";
+    EXPECT_EQ(booking::crc32c(check, 9), 0xE3069283u);
+    EXPECT_EQ(booking::crc32c(check + 4, 5, booking::crc32c(check, 4)), 0xE3069283u);
+    EXPECT_EQ(booking::crc32c(check, 0), 0u);
+    const std::string zeros(32, '\0');
+    EXPECT_EQ(booking::crc32c(zeros.data(), zeros.size()), 0x8A9136AAu);
+}
+
+TEST(Journal, CompactionDropsCoveredRecordsAndKeepsLsns) {
+    for (const auto backend :
+         {booking::JournalBackend::Write, booking::JournalBackend::IoUring, booking::JournalBackend::Mapped,
+          booking::JournalBackend::Direct}) {
+        const std::string path = temp_path("journal_compact.log");
+        SeatMask seats;
+        seats.set(1);
+        std::uint64_t cut = 0;
+        {
+            Journal j;
+            ASSERT_EQ(j.open(path, JournalMode::Sync, 16, backend), JournalStatus::Ok);
+            for (int i = 0; i < 10; ++i) {
+                const std::uint64_t lsn = j.append(JournalOp::Book, i, static_cast<std::uint32_t>(i + 1), seats);
+                if (i == 5) cut = lsn; // records 0..5 are "in the snapshot"
+            }
+            ASSERT_TRUE(j.sync());
+            const std::size_t before = read_file(path).size();
+            ASSERT_EQ(j.compact(cut), JournalStatus::Ok);
+            const bool padded = backend == booking::JournalBackend::Mapped || backend == booking::JournalBackend::Direct;
+            if (!padded) { // Mapped and Direct files end in zeros: whole segments, whole blocks
+                EXPECT_EQ(j.compacted_bytes() + read_file(path).size(), before);
+            }
+            EXPECT_EQ(j.compacted_bytes(), 6u * 40u);
+
+            // Appends continue in the new file
+            j.wait_durable(j.append(JournalOp::Cancel, 9, 10, seats));
+            std::vector<JournalRecord> records = read_records(path);
+            ASSERT_EQ(records.size(), 5u);
+            EXPECT_EQ(records.front().show_id, 6);
+            EXPECT_EQ(records.front().lsn, cut);
+            EXPECT_EQ(records.back().op, JournalOp::Cancel);
+
+            // Compacting past everything keeps the newest record
+            ASSERT_EQ(j.compact(j.next_lsn()), JournalStatus::Ok);
+            records = read_records(path);
+            ASSERT_EQ(records.size(), 1u);
+            EXPECT_EQ(records[0].op, JournalOp::Cancel);
+        }
+        Journal reopened;
+        ASSERT_EQ(reopened.open(path, JournalMode::Sync), JournalStatus::Ok);
+        EXPECT_EQ(reopened.next_lsn(), cut + 5u); // LSNs continue after the compaction
+        std::remove(path.c_str());
+    }
+}
+
+TEST(Journal, RecoversBookingsAndCancellations) {
+    const std::string path = temp_path("journal_recover.log");
+    BookingService live{BookingService::EmptyCatalog{}};
+    add_halls(live, 2);
+    ASSERT_EQ(live.open_journal(path, JournalMode::Sync), JournalStatus::Ok);
+
+    const auto a = live.book_seats(0, {"a1", "a2", "h64"});
+    const auto b = live.book_seats(1, {"c5"});
+    ASSERT_TRUE(a.success && b.success);
+    ASSERT_TRUE(live.cancel_seats(0, {"a2"}, static_cast<booking::BookingId>(a.id)).success);
+    const auto c = live.book_seats(0, {"a2"}); // rebooks the freed seat
+    SeatMask best;
+    ASSERT_TRUE(live.book_best_available(1, 4, best).success);
+    const auto hold = live.hold_seats(1, {"b1"}, std::chrono::minutes(1));
+    ASSERT_TRUE(c.success && hold.success);
+    const std::vector<std::string_view> r0 = {"d1"};
+    const std::vector<std::string_view> r1 = {"d2", "d3"};
+    const std::vector<booking::BookingRequest> batch = {{0, r0}, {0, r1}};
+    for (const auto& r : live.book_seats_batch(batch)) ASSERT_TRUE(r.success);
+    ASSERT_TRUE(live.confirm_hold(hold.id).success);
+
+    BookingService recovered{BookingService::EmptyCatalog{}};
+    add_halls(recovered, 2);
+    const booking::JournalReplay replay = recovered.replay_journal(path);
+    EXPECT_EQ(replay.status, JournalStatus::Ok);
+    EXPECT_EQ(replay.applied, 8u);
+    EXPECT_EQ(replay.skipped, 0u);
+    expect_same_seats(live, recovered, 2);
+    EXPECT_GT(recovered.book_seats(0, {"e1"}).id, c.id);
+    std::remove(path.c_str());
+}
+
+TEST(Journal, ReplaysOnTopOfAFuzzySnapshot) {
+    const std::string journal = temp_path("journal_fuzzy.log");
+    const std::string snapshot = temp_path("journal_fuzzy.snap");
+    constexpr int kShows = 6;
+    BookingService live{BookingService::EmptyCatalog{}};
+    add_halls(live, kShows);
+    ASSERT_EQ(live.open_journal(journal, JournalMode::Async), JournalStatus::Ok);
+
+    // Bookers and cancellers run while the snapshot is written
+    std::atomic<bool> snapshot_done{false};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 3; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < 3000; ++i) {
+                SeatMask seats;
+                const int show = (i + t) % kShows;
+                const auto r = live.book_best_available(show, 1 + (i + t) % 3, seats);
+                if (r.success && i % 4 == 0) live.cancel_seat_mask(show, seats, static_cast<booking::BookingId>(r.id));
+                if (i == 1500) while (!snapshot_done.load()) std::this_thread::yield();
+            }
+        });
+    }
+    ASSERT_EQ(live.write_snapshot(snapshot), booking::SnapshotStatus::Ok);
+    snapshot_done.store(true);
+    for (auto& w : workers) w.join();
+    ASSERT_TRUE(live.sync_journal());
+
+    BookingService recovered{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(recovered.restore_snapshot(snapshot), booking::SnapshotStatus::Ok);
+    const booking::JournalReplay replay = recovered.replay_journal(journal);
+    EXPECT_EQ(replay.status, JournalStatus::Ok);
+    EXPECT_GT(replay.applied, 0u);
+    expect_same_seats(live, recovered, kShows);
+    std::remove(journal.c_str());
+    std::remove(snapshot.c_str());
+}
+
+TEST(Journal, ReplaysShowsInParallelInJournalOrder) {
+    const std::string journal = temp_path("journal_parallel.log");
+    constexpr int kShows = 24;
+    BookingService live{BookingService::EmptyCatalog{}};
+    add_halls(live, kShows);
+    ASSERT_EQ(live.open_journal(journal, JournalMode::None), JournalStatus::Ok);
+    // The same seats are booked, cancelled and rebooked over and over: only journal order
+    // per show gives the final owners
+    for (int i = 0; i < 12000; ++i) {
+        const int show = i % kShows;
+        SeatMask seats;
+        seats.set(HallLayout::seat_index((i / kShows) % 8, (i / 7) % 64));
+        const auto r = live.book_seat_mask(show, seats);
+        if (r.success && i % 3 != 0) live.cancel_seat_mask(show, seats, static_cast<booking::BookingId>(r.id));
+    }
+    ASSERT_TRUE(live.sync_journal());
+
+    booking::ThreadPoolOptions four;
+    four.workers = 4;
+    booking::ThreadPool pool(four);
+    BookingService recovered{BookingService::EmptyCatalog{}};
+    recovered.set_thread_pool(&pool);
+    add_halls(recovered, kShows);
+    const booking::JournalReplay replay = recovered.replay_journal(journal);
+    EXPECT_EQ(replay.status, JournalStatus::Ok);
+    EXPECT_EQ(replay.skipped, 0u);
+    const std::size_t records = read_records(journal).size();
+    EXPECT_EQ(replay.applied, records);
+    expect_same_seats(live, recovered, kShows);
+
+    // A damaged record ends the journal for every show, even those replayed elsewhere
+    std::string bytes = read_file(journal);
+    bytes[booking::kJournalHeaderSize + 40u * (records / 2u) + 32u] ^= 0x5a; // a one-row record's seat word
+    {
+        std::ofstream out(journal, std::ios::binary | std::ios::trunc);
+        out << bytes;
+    }
+    BookingService partial{BookingService::EmptyCatalog{}};
+    partial.set_thread_pool(&pool);
+    add_halls(partial, kShows);
+    EXPECT_EQ(partial.replay_journal(journal).applied, read_records(journal).size());
+    EXPECT_LT(read_records(journal).size(), records);
+    std::remove(journal.c_str());
+}
+
+TEST(Journal, SyncModeGroupCommitsConcurrentBookings) {
+    const std::string path = temp_path("journal_group.log");
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 200;
+    {
+        BookingService live{BookingService::EmptyCatalog{}};
+        add_halls(live, kThreads);
+        ASSERT_EQ(live.open_journal(path, JournalMode::Sync), JournalStatus::Ok);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < kThreads; ++t) {
+            workers.emplace_back([&, t] {
+                for (int i = 0; i < kPerThread; ++i) {
+                    SeatMask seats;
+                    ASSERT_TRUE(live.book_best_available(t, 1, seats).success);
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+    }
+    EXPECT_EQ(read_records(path).size(), static_cast<std::size_t>(kThreads * kPerThread));
+    std::remove(path.c_str());
+}
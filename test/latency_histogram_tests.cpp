@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include "latency_histogram.hpp"
+
+#include <cstdint>
+
+using booking::LatencyHistogram;
+
+TEST(LatencyHistogram, BucketsAreContiguousAndTight) {
+    EXPECT_EQ(LatencyHistogram::bucket_of(0), 0u);
+    EXPECT_EQ(LatencyHistogram::bucket_of(31), 31u);
+    EXPECT_EQ(LatencyHistogram::bucket_of(32), 32u);
+    EXPECT_EQ(LatencyHistogram::bucket_of(~std::uint64_t{0}), LatencyHistogram::kBuckets - 1u);
+
+    // Every value lies in its bucket, below its upper bound and above the previous one
+    for (std::uint64_t v : {1ull, 33ull, 64ull, 100ull, 1000ull, 123456789ull, 1ull << 40, (1ull << 63) + 5}) {
+        const std::size_t b = LatencyHistogram::bucket_of(v);
+        EXPECT_LE(v, LatencyHistogram::bucket_upper(b)) << v;
+        EXPECT_GT(v, LatencyHistogram::bucket_upper(b - 1u)) << v;
+        EXPECT_LE(LatencyHistogram::bucket_upper(b) - LatencyHistogram::bucket_upper(b - 1u), v / 32u + 1u) << v;
+    }
+}
+
+TEST(LatencyHistogram, PercentilesAndMerge) {
+    LatencyHistogram a;
+    LatencyHistogram b;
+    EXPECT_EQ(a.percentile(0.99), 0u);
+    for (std::uint64_t v = 1; v <= 1000; ++v) (v % 2 ? a : b).record(v * 1000u);
+    a.merge(b);
+
+    EXPECT_EQ(a.count(), 1000u);
+    EXPECT_EQ(a.max(), 1000000u);
+    EXPECT_DOUBLE_EQ(a.mean(), 500500.0);
+    // Within the bucket resolution (1/32) of the exact rank
+    EXPECT_NEAR(static_cast<double>(a.percentile(0.5)), 500000.0, 500000.0 / 32);
+    EXPECT_NEAR(static_cast<double>(a.percentile(0.99)), 990000.0, 990000.0 / 32);
+    EXPECT_EQ(a.percentile(1.0), 1000000u);
+}
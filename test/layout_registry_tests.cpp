@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "layout_registry.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+using booking::BookingService;
+using booking::HallLayout;
+using booking::LayoutRegistry;
+
+TEST(LayoutRegistry, StoresEqualLayoutsOnce) {
+    LayoutRegistry registry;
+    const booking::LayoutId a = registry.intern(HallLayout::uniform(10, 20));
+    const HallLayout* stored = &registry.at(a);
+    EXPECT_EQ(registry.intern(HallLayout({{"A", 20}, {"b", 20}, {"c", 20}, {"d", 20}, {"e", 20},
+                                          {"f", 20}, {"g", 20}, {"h", 20}, {"i", 20}, {"j", 20}})),
+              a); // row labels compare case-insensitively
+    EXPECT_EQ(registry.find(HallLayout::uniform(10, 20)), a);
+    EXPECT_EQ(registry.find(HallLayout::uniform(10, 21)), -1);
+
+    // Anything that changes bookings makes a different layout
+    const booking::LayoutId wider = registry.intern(HallLayout::uniform(10, 21));
+    HallLayout relabelled({{"x", 20}});
+    HallLayout gaps = HallLayout::uniform(10, 20);
+    gaps.set_forbid_single_gaps(true);
+    HallLayout priced = HallLayout::uniform(10, 20);
+    booking::PriceTier premium{"premium", 1500, {}};
+    premium.seats[0] = 0xFu;
+    priced.set_price_tiers({premium});
+    HallLayout accessible = HallLayout::uniform(10, 20);
+    booking::SeatCategories categories;
+    categories.wheelchair[0] = 1u;
+    accessible.set_seat_categories(categories);
+    const booking::LayoutId ids[] = {wider, registry.intern(std::move(relabelled)), registry.intern(gaps),
+                                     registry.intern(priced), registry.intern(accessible)};
+    for (std::size_t i = 0; i < 5; ++i) {
+        EXPECT_NE(ids[i], a) << i;
+        for (std::size_t j = 0; j < i; ++j) EXPECT_NE(ids[i], ids[j]) << i << ' ' << j;
+    }
+    EXPECT_EQ(registry.intern(priced), ids[3]);
+    HallLayout aisle = HallLayout::uniform(10, 20);
+    std::array<std::uint64_t, HallLayout::kMaxRows> after{};
+    after[0] = 1u << 9;
+    aisle.set_aisles(after);
+    EXPECT_EQ(registry.find(aisle), -1);
+    EXPECT_EQ(registry.size(), 6u);
+
+    // Growing the registry does not move stored layouts
+    for (int seats = 1; seats <= 64; ++seats) registry.intern(HallLayout::single_row(seats));
+    EXPECT_EQ(&registry.at(a), stored);
+    EXPECT_TRUE(registry.contains(a));
+    EXPECT_FALSE(registry.contains(-1));
+    EXPECT_FALSE(registry.contains(static_cast<booking::LayoutId>(registry.size())));
+}
+
+TEST(LayoutRegistry, ShowsOfEqualHallsShareOneLayout) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    const booking::LayoutId hall = svc.add_layout(HallLayout::uniform(4, 10));
+    EXPECT_EQ(svc.add_layout(HallLayout::uniform(4, 10)), hall);
+
+    // Every theater exports its own copy of the layout; all copies resolve to one
+    std::string text = "movie,1,Dune\n";
+    for (int t = 1; t <= 3; ++t) {
+        text += "theater," + std::to_string(t) + ",T" + std::to_string(t) + "\n";
+        text += "layout," + std::to_string(t) + ",4x10\n";
+        text += "show," + std::to_string(10 + t) + ",1," + std::to_string(t) + "," + std::to_string(t) + "\n";
+    }
+    text += "layout,9,2x5\nshow,20,1,1,9\n";
+    booking::Schedule schedule;
+    ASSERT_EQ(booking::parse_schedule(text, 1, schedule).status, booking::ScheduleStatus::Ok);
+    ASSERT_EQ(svc.load_schedule(std::move(schedule)).status, booking::ScheduleStatus::Ok);
+    ASSERT_NE(svc.layout_for_show(11), nullptr);
+    EXPECT_EQ(svc.layout_for_show(12), svc.layout_for_show(11));
+    EXPECT_EQ(svc.layout_for_show(13), svc.layout_for_show(11));
+    EXPECT_NE(svc.layout_for_show(20), svc.layout_for_show(11));
+    EXPECT_EQ(svc.find_shows(1, 2).size(), 1u);
+
+    // Each show still has its own seats
+    EXPECT_TRUE(svc.book_seats(11, {"a1"}).success);
+    EXPECT_TRUE(svc.book_seats(12, {"a1"}).success);
+    EXPECT_EQ(svc.available_count(13), 40);
+
+    const std::string path = ::testing::TempDir() + "layout_registry.snap";
+    ASSERT_EQ(svc.write_snapshot(path), booking::SnapshotStatus::Ok);
+    BookingService restored{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(restored.restore_snapshot(path), booking::SnapshotStatus::Ok);
+    EXPECT_EQ(restored.layout_for_show(13), restored.layout_for_show(11));
+    EXPECT_EQ(restored.available_count(11), 39);
+}
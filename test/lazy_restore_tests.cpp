@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::HallLayout;
+using booking::SnapshotLoad;
+using booking::SnapshotStatus;
+
+namespace {
+
+/** @brief Service of @p shows 8x10 shows; every third one has bookings. Writes it to @p path. */
+std::vector<booking::BookingResult> write_source(const std::string& path, int shows) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    EXPECT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), booking::CatalogStatus::Ok);
+    EXPECT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), booking::CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(HallLayout::uniform(8, 10));
+    std::vector<booking::BookingResult> bookings;
+    for (int id = 1; id <= shows; ++id) {
+        EXPECT_EQ(svc.add_show(booking::Show{id, 1, 1, hall}), booking::CatalogStatus::Ok);
+        if (id % 3 == 0) bookings.push_back(svc.book_seats(id, {"a1", "a2", "h10"}));
+    }
+    EXPECT_EQ(svc.write_snapshot(path), SnapshotStatus::Ok);
+    return bookings;
+}
+
+} // namespace
+
+TEST(LazyRestore, DecodesShowsOnFirstAccess) {
+    const std::string path = ::testing::TempDir() + "lazy_restore.snap";
+    const std::vector<booking::BookingResult> bookings = write_source(path, 30);
+
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.restore_snapshot(path, SnapshotLoad::Lazy), SnapshotStatus::Ok);
+    EXPECT_EQ(svc.lazy_shows_pending(), 10u); // only the shows with bookings
+    EXPECT_EQ(svc.find_shows(1, 1).size(), 30u);
+
+    // Reads and bookings see the restored seats
+    EXPECT_EQ(svc.available_count(3), 77);
+    EXPECT_EQ(svc.lazy_shows_pending(), 9u);
+    EXPECT_EQ(svc.seat_owner(6, HallLayout::seat_index(7, 9)), bookings[1].id);
+    EXPECT_EQ(svc.book_seats(9, {"a1"}).status, booking::BookingStatus::AlreadyBooked);
+    EXPECT_TRUE(svc.cancel_seats(12, {"a1", "a2", "h10"}, static_cast<booking::BookingId>(bookings[3].id)).success);
+    EXPECT_EQ(svc.available_count(12), 80);
+    EXPECT_EQ(svc.available_count(1), 80); // never pending
+    EXPECT_EQ(svc.lazy_shows_pending(), 6u);
+
+    // New ids stay above every restored one, loaded or not
+    const auto fresh = svc.book_seats(1, {"a1"});
+    ASSERT_TRUE(fresh.success);
+    for (const booking::BookingResult& b : bookings) EXPECT_GT(fresh.id, b.id);
+
+    EXPECT_EQ(svc.load_lazy_shows(), 6u);
+    EXPECT_EQ(svc.lazy_shows_pending(), 0u);
+    EXPECT_EQ(svc.load_lazy_shows(), 0u);
+    for (int id = 3; id <= 30; id += 3) {
+        EXPECT_EQ(svc.available_count(id), id == 12 ? 80 : 77) << id;
+    }
+}
+
+TEST(LazyRestore, MatchesEagerRestore) {
+    const std::string path = ::testing::TempDir() + "lazy_restore_eager.snap";
+    write_source(path, 12);
+    BookingService eager{BookingService::EmptyCatalog{}};
+    BookingService lazy{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(eager.restore_snapshot(path), SnapshotStatus::Ok);
+    ASSERT_EQ(lazy.restore_snapshot(path, SnapshotLoad::Lazy), SnapshotStatus::Ok);
+    EXPECT_EQ(eager.lazy_shows_pending(), 0u);
+
+    // A snapshot of the lazy service decodes every show it writes
+    const std::string again = ::testing::TempDir() + "lazy_restore_again.snap";
+    ASSERT_EQ(lazy.write_snapshot(again), SnapshotStatus::Ok);
+    EXPECT_EQ(lazy.lazy_shows_pending(), 0u);
+    for (int id = 1; id <= 12; ++id) {
+        EXPECT_EQ(lazy.available_count(id), eager.available_count(id)) << id;
+        for (int seat : {0, 1, HallLayout::seat_index(7, 9)}) {
+            EXPECT_EQ(lazy.seat_owner(id, seat), eager.seat_owner(id, seat)) << id;
+        }
+    }
+}
+
+TEST(LazyRestore, ConcurrentFirstAccessDecodesOnce) {
+    const std::string path = ::testing::TempDir() + "lazy_restore_race.snap";
+    write_source(path, 300);
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.restore_snapshot(path, SnapshotLoad::Lazy), SnapshotStatus::Ok);
+    ASSERT_EQ(svc.lazy_shows_pending(), 100u);
+
+    // Readers race the first access of every show; each sees the whole restored state
+    std::atomic<int> wrong{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 300; ++i) {
+                const int id = (i + 75 * t) % 300 + 1;
+                if (svc.available_count(id) != (id % 3 == 0 ? 77 : 80)) wrong.fetch_add(1);
+            }
+        });
+    }
+    for (std::thread& th : threads) th.join();
+    EXPECT_EQ(wrong.load(), 0);
+    EXPECT_EQ(svc.lazy_shows_pending(), 0u);
+}
+
+TEST(LazyRestore, CatalogClashRestoresNothing) {
+    const std::string path = ::testing::TempDir() + "lazy_restore_clash.snap";
+    write_source(path, 6);
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.restore_snapshot(path, SnapshotLoad::Lazy), SnapshotStatus::Ok);
+    EXPECT_EQ(svc.available_count(3), 77);
+    EXPECT_EQ(svc.lazy_shows_pending(), 1u);
+    // A second lazy restore first decodes what the first left pending
+    EXPECT_EQ(svc.restore_snapshot(path, SnapshotLoad::Lazy), SnapshotStatus::CatalogError);
+    EXPECT_EQ(svc.lazy_shows_pending(), 0u);
+    EXPECT_EQ(svc.available_count(6), 77);
+    EXPECT_EQ(svc.find_shows(1, 1).size(), 6u);
+    EXPECT_EQ(to_string(SnapshotLoad::Lazy), std::string("lazy"));
+    EXPECT_EQ(to_string(SnapshotLoad::Eager), std::string("eager"));
+}
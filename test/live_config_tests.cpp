@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "live_config.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::ConfigError;
+using booking::ConfigStatus;
+using booking::LiveConfig;
+using booking::ShowId;
+using booking::TuningConfig;
+using namespace std::chrono_literals;
+
+TEST(LiveConfig, ParsesKnownKeysAndReportsTheFirstBadLine) {
+    TuningConfig config;
+    const ConfigError ok = booking::parse_tuning("# premiere tuning\n"
+                                                 "backoff.max_retries = 32\n"
+                                                 "  hold.max_ttl_ms=120000   # two minutes\r\n"
+                                                 "\n"
+                                                 "client_rate = 50:10\n"
+                                                 "admission.7 = 200\n"
+                                                 "admission.7 = 300:30\n",
+                                                 config);
+    ASSERT_EQ(ok.status, ConfigStatus::Ok) << ok.reason;
+    EXPECT_EQ(config.backoff.max_retries, 32u);
+    EXPECT_EQ(config.backoff.yield_after, booking::BackoffPolicy{}.yield_after); // left alone
+    EXPECT_EQ(config.max_hold_ttl, 120s);
+    EXPECT_DOUBLE_EQ(config.client_rate.per_second, 50.0);
+    EXPECT_EQ(config.client_rate.burst, 10);
+    ASSERT_EQ(config.admission.size(), 1u);
+    EXPECT_EQ(config.admission[0].first, ShowId(7));
+    EXPECT_DOUBLE_EQ(config.admission[0].second.per_second, 300.0);
+    EXPECT_EQ(config.admission[0].second.burst, 30);
+
+    for (const char* bad : {"client_rate = fast", "backoff.max_retries = -1", "admission.x = 5", "hold.ttl = 5",
+                            "hold.max_ttl_ms"}) {
+        TuningConfig scratch;
+        const ConfigError error = booking::parse_tuning(std::string("\n# ok\n") + bad, scratch);
+        EXPECT_EQ(error.status, ConfigStatus::ParseError) << bad;
+        EXPECT_EQ(error.line, 3u) << bad;
+    }
+}
+
+TEST(LiveConfig, ReloadPublishesANewSnapshotAndKeepsTheOldOne) {
+    TuningConfig defaults;
+    defaults.client_rate.per_second = 5.0;
+    LiveConfig config(defaults);
+    const TuningConfig& first = config.current();
+    EXPECT_EQ(config.version(), 1u);
+
+    int calls = 0;
+    double seen_before = 0.0;
+    const std::uint64_t listener = config.subscribe([&](const TuningConfig& previous, const TuningConfig& current) {
+        ++calls;
+        seen_before = previous.client_rate.per_second;
+        EXPECT_EQ(&current, &config.current()); // visible to readers before listeners run
+    });
+    ASSERT_EQ(config.reload("client_rate = 80").status, ConfigStatus::Ok);
+    EXPECT_EQ(config.version(), 2u);
+    EXPECT_DOUBLE_EQ(config.current().client_rate.per_second, 80.0);
+    EXPECT_DOUBLE_EQ(first.client_rate.per_second, 5.0); // readers of the old snapshot are unaffected
+    EXPECT_EQ(calls, 1);
+    EXPECT_DOUBLE_EQ(seen_before, 5.0);
+
+    // A bad text changes nothing; an empty one restores the defaults
+    EXPECT_EQ(config.reload("client_rate = 80\nbogus = 1").line, 2u);
+    EXPECT_EQ(config.version(), 2u);
+    ASSERT_EQ(config.reload("").status, ConfigStatus::Ok);
+    EXPECT_DOUBLE_EQ(config.current().client_rate.per_second, 5.0);
+    EXPECT_EQ(calls, 2);
+
+    config.unsubscribe(listener);
+    ASSERT_EQ(config.reload("client_rate = 1").status, ConfigStatus::Ok);
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(config.reload_file(::testing::TempDir() + "missing.conf").status, ConfigStatus::IoError);
+}
+
+TEST(LiveConfig, WatchReloadsTheFileWhenItChanges) {
+    const std::string path = ::testing::TempDir() + "live_tuning.conf";
+    std::ofstream(path) << "client_rate = 10\n";
+    LiveConfig config;
+    ASSERT_EQ(config.watch(path, 5ms).status, ConfigStatus::Ok);
+    EXPECT_DOUBLE_EQ(config.current().client_rate.per_second, 10.0);
+
+    std::this_thread::sleep_for(20ms); // a new modification time, even on coarse clocks
+    std::ofstream(path) << "client_rate = 20\n";
+    for (int i = 0; i < 400 && config.current().client_rate.per_second != 20.0; ++i) std::this_thread::sleep_for(5ms);
+    EXPECT_DOUBLE_EQ(config.current().client_rate.per_second, 20.0);
+    config.stop_watching();
+    std::remove(path.c_str());
+}
+
+TEST(LiveConfig, ServiceFollowsBackoffHoldCapAndAdmissionLive) {
+    BookingService svc;
+    const ShowId show = svc.find_show(1, 1);
+    LiveConfig config;
+    svc.use_live_config(&config);
+
+    ASSERT_EQ(config.reload("backoff.max_retries = 7\n"
+                            "hold.max_ttl_ms = 50\n"
+                            "admission." + std::to_string(show.value()) + " = 0.001:1\n")
+                  .status,
+              ConfigStatus::Ok);
+    EXPECT_EQ(svc.backoff_policy().max_retries, 7u);
+
+    // The hour asked for is capped at 50 ms
+    const auto hold = svc.hold_seats(show, {"a1"}, 1h);
+    ASSERT_TRUE(hold.success);
+    EXPECT_EQ(svc.expire_holds(std::chrono::steady_clock::now() + 1s), 1u);
+
+    // The hold took the gate's only slot; dropping the line opens it again
+    EXPECT_EQ(svc.book_seats(show, {"a2"}).status, BookingStatus::Throttled);
+    ASSERT_EQ(config.reload("").status, ConfigStatus::Ok);
+    EXPECT_TRUE(svc.book_seats(show, {"a2"}).success);
+    EXPECT_EQ(svc.backoff_policy().max_retries, booking::BackoffPolicy{}.max_retries);
+
+    svc.use_live_config(nullptr);
+    ASSERT_EQ(config.reload("backoff.max_retries = 3").status, ConfigStatus::Ok);
+    EXPECT_EQ(svc.backoff_policy().max_retries, booking::BackoffPolicy{}.max_retries);
+}
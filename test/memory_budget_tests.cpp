@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "memory_budget.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::ArchivedShow;
+using booking::BookingService;
+using booking::CatalogStatus;
+using booking::MemoryAccounts;
+using booking::MemorySubsystem;
+using booking::Movie;
+using booking::Show;
+using booking::Theater;
+
+namespace {
+
+constexpr booking::ShowTime kHour = 3600;
+
+} // namespace
+
+TEST(MemoryBudget, AccountsChargeReleaseAndPeak) {
+    MemoryAccounts accounts;
+    accounts.charge(MemorySubsystem::Caches, 100);
+    accounts.charge(MemorySubsystem::Caches, 50);
+    accounts.release(MemorySubsystem::Caches, 120);
+    EXPECT_EQ(accounts.live(MemorySubsystem::Caches), 30u);
+
+    accounts.set_budget(MemorySubsystem::Caches, 100);
+    EXPECT_TRUE(accounts.try_charge(MemorySubsystem::Caches, 70));
+    EXPECT_FALSE(accounts.try_charge(MemorySubsystem::Caches, 1));
+    EXPECT_EQ(accounts.live(MemorySubsystem::Caches), 100u);
+
+    accounts.set(MemorySubsystem::States, 40);
+    accounts.set_total_budget(120);
+    const booking::MemoryUsage usage = accounts.usage();
+    EXPECT_EQ(usage.of(MemorySubsystem::Caches), 100u);
+    EXPECT_EQ(usage.peak[static_cast<int>(MemorySubsystem::Caches)], 150u);
+    EXPECT_EQ(usage.of(MemorySubsystem::States), 40u);
+    EXPECT_EQ(usage.total, 140u);
+    EXPECT_EQ(usage.total_budget, 120u);
+    EXPECT_FALSE(usage.over(MemorySubsystem::Caches));
+    EXPECT_FALSE(usage.over(MemorySubsystem::States)); // no budget
+    EXPECT_STREQ(booking::to_string(MemorySubsystem::Buffers), "buffers");
+}
+
+TEST(MemoryBudget, ServiceReportsSubsystemsAndChargesCaches) {
+    BookingService svc;
+    const booking::MemoryUsage before = svc.memory_usage();
+    EXPECT_GT(before.of(MemorySubsystem::Catalog), 0u);
+    EXPECT_GT(before.of(MemorySubsystem::States), 0u);
+    EXPECT_GT(before.of(MemorySubsystem::Holds), 0u);
+    EXPECT_EQ(before.of(MemorySubsystem::Caches), 0u);
+
+    const booking::ShowId show = svc.find_show(1, 1);
+    std::string out;
+    ASSERT_EQ(svc.append_cached_available_seats(show, out), 20);
+    EXPECT_GT(svc.memory_usage().of(MemorySubsystem::Caches), 0u);
+
+    // A new rendering replaces the old one; the charge follows the live one only
+    const std::size_t one = svc.memory_usage().of(MemorySubsystem::Caches);
+    ASSERT_TRUE(svc.book_seats(show, {"a1"}).success);
+    out.clear();
+    ASSERT_EQ(svc.append_cached_available_seats(show, out), 19);
+    EXPECT_LE(svc.memory_usage().of(MemorySubsystem::Caches), one);
+
+    EXPECT_EQ(svc.evict_cached_availability(), 1u);
+    EXPECT_EQ(svc.evict_cached_availability(), 0u);
+    EXPECT_EQ(svc.memory_usage().of(MemorySubsystem::Caches), 0u);
+}
+
+TEST(MemoryBudget, CacheBudgetServesUncached) {
+    BookingService svc;
+    const booking::ShowId show = svc.find_show(1, 1);
+    std::string plain;
+    ASSERT_EQ(svc.append_available_seats(show, plain), 20);
+
+    svc.set_memory_budget(MemorySubsystem::Caches, 1);
+    std::string cached;
+    EXPECT_EQ(svc.append_cached_available_seats(show, cached), 20);
+    EXPECT_EQ(cached, plain);
+    EXPECT_EQ(svc.memory_usage().of(MemorySubsystem::Caches), 0u);
+    EXPECT_EQ(svc.evict_cached_availability(), 0u);
+}
+
+TEST(MemoryBudget, EnforcingArchivesStartedShowsFirst) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{1, "Central"}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(8, 10));
+    for (std::int64_t id = 1; id <= 16; ++id) {
+        ASSERT_EQ(svc.add_show(Show{id, 1, 1, hall, id * kHour}), CatalogStatus::Ok);
+    }
+    ASSERT_TRUE(svc.book_seats(2, {"a1", "b2"}).success);
+    // Within budget: nothing evicted
+    EXPECT_EQ(svc.enforce_memory_budgets(100 * kHour).shows_archived, 0u);
+
+    // A budget no show table can meet: every started show goes, the earliest first
+    svc.set_memory_budget(MemorySubsystem::States, 1);
+    const booking::MemoryEviction evicted = svc.enforce_memory_budgets(8 * kHour + 1);
+    EXPECT_EQ(evicted.renderings, 0u); // the caches are within theirs
+    EXPECT_EQ(evicted.shows_archived, 8u);
+    EXPECT_EQ(svc.cold_shows().size(), 8u);
+
+    ArchivedShow record;
+    ASSERT_TRUE(svc.cold_shows().find(2, record));
+    EXPECT_EQ(svc.find_show(1, 1), 9); // the earliest show still bookable
+    EXPECT_FALSE(svc.cold_shows().find(9, record));
+}
+
+TEST(MemoryBudget, ColdShowsCostNoWordsUntilTheirFirstBooking) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{1, "Central"}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(8, 10));
+    for (std::int64_t id = 1; id <= 64; ++id) {
+        ASSERT_EQ(svc.add_show(Show{id, 1, 1, hall, id * kHour}), CatalogStatus::Ok);
+    }
+    const std::size_t cold = svc.memory_usage().of(MemorySubsystem::States);
+    std::string out;
+    EXPECT_EQ(svc.append_available_seats(2, out), 80); // reads see every seat free
+    EXPECT_EQ(svc.memory_usage().of(MemorySubsystem::States), cold);
+
+    // Concurrent first bookings of a cold show: one install, every seat kept
+    std::vector<std::thread> threads;
+    std::atomic<int> booked{0};
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t] {
+            if (svc.book_seats(2, {std::string(1, static_cast<char>('a' + t)) + "1"}).success) ++booked;
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    EXPECT_EQ(booked.load(), 8);
+    out.clear();
+    EXPECT_EQ(svc.append_available_seats(2, out), 72);
+    EXPECT_GE(svc.memory_usage().of(MemorySubsystem::States), cold + 8 * sizeof(std::uint64_t));
+
+    // A cancellation on a cold show promotes nothing; other shows stay free
+    EXPECT_FALSE(svc.cancel_seats(3, {"a1"}, 12345).success);
+    out.clear();
+    EXPECT_EQ(svc.append_available_seats(3, out), 80);
+}
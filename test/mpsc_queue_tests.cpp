@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include "mpsc_queue.hpp"
+
+#include <thread>
+#include <vector>
+
+using booking::MpscNode;
+using booking::MpscQueue;
+
+namespace {
+
+struct Item : MpscNode {
+    int producer = 0;
+    int value = 0;
+};
+
+} // namespace
+
+TEST(MpscQueue, KeepsFifoOrderAcrossEmptyStates) {
+    MpscQueue q;
+    EXPECT_EQ(q.pop(), nullptr);
+
+    Item items[5];
+    for (int i = 0; i < 3; ++i) {
+        items[i].value = i;
+        q.push(&items[i]);
+    }
+    for (int i = 0; i < 3; ++i) {
+        MpscNode* n = q.pop();
+        ASSERT_NE(n, nullptr);
+        EXPECT_EQ(static_cast<Item*>(n)->value, i);
+    }
+    EXPECT_EQ(q.pop(), nullptr);
+
+    // Drained to the last node and refilled: the stub is recycled in between
+    items[3].value = 3;
+    q.push(&items[3]);
+    ASSERT_EQ(q.pop(), &items[3]);
+    EXPECT_EQ(q.pop(), nullptr);
+    items[4].value = 4;
+    q.push(&items[4]);
+    items[0].value = 5;
+    q.push(&items[0]); // a node may be queued again once popped
+    EXPECT_EQ(q.pop(), &items[4]);
+    EXPECT_EQ(q.pop(), &items[0]);
+    EXPECT_EQ(q.pop(), nullptr);
+}
+
+TEST(MpscQueue, ConcurrentProducersLoseNothing) {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 5000;
+    std::vector<Item> items(static_cast<std::size_t>(kProducers * kPerProducer));
+    MpscQueue q;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                Item& item = items[static_cast<std::size_t>(p * kPerProducer + i)];
+                item.producer = p;
+                item.value = i;
+                q.push(&item);
+            }
+        });
+    }
+
+    // Each producer's items come out in its push order
+    std::vector<int> next(kProducers, 0);
+    int received = 0;
+    while (received < kProducers * kPerProducer) {
+        MpscNode* n = q.pop();
+        if (!n) {
+            std::this_thread::yield();
+            continue;
+        }
+        const Item* item = static_cast<Item*>(n);
+        EXPECT_EQ(item->value, next[static_cast<std::size_t>(item->producer)]++);
+        ++received;
+    }
+    for (auto& t : producers) t.join();
+    EXPECT_EQ(q.pop(), nullptr);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "numa.hpp"
+#include "show_executor.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+using booking::NumaPlacement;
+using booking::NumaTopology;
+
+namespace {
+
+void write_file(const std::string& path, const std::string& text) {
+    std::ofstream(path) << text;
+}
+
+} // namespace
+
+TEST(Numa, ParsesCpuLists) {
+    std::vector<int> cpus;
+    EXPECT_TRUE(booking::parse_cpu_list("0-3,8,10-11\n", cpus));
+    EXPECT_EQ(cpus, (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    std::vector<int> empty;
+    EXPECT_TRUE(booking::parse_cpu_list("", empty));
+    EXPECT_TRUE(empty.empty());
+    std::vector<int> bad;
+    EXPECT_FALSE(booking::parse_cpu_list("3-1", bad));
+    EXPECT_FALSE(booking::parse_cpu_list("0,,1", bad));
+    EXPECT_FALSE(booking::parse_cpu_list("x", bad));
+    EXPECT_TRUE(bad.empty());
+
+    NumaPlacement p = NumaPlacement::Off;
+    EXPECT_TRUE(booking::parse_numa_placement("interleave", p));
+    EXPECT_EQ(p, NumaPlacement::Interleaved);
+    EXPECT_FALSE(booking::parse_numa_placement("remote", p));
+}
+
+TEST(Numa, DiscoversNodesFromSysfs) {
+    const std::string root = ::testing::TempDir() + "numa_nodes";
+    ::mkdir(root.c_str(), 0755);
+    ::mkdir((root + "/node0").c_str(), 0755);
+    ::mkdir((root + "/node1").c_str(), 0755);
+    ::mkdir((root + "/node2").c_str(), 0755);
+    write_file(root + "/online", "0-2\n");
+    write_file(root + "/node0/cpulist", "0-3,8-11\n");
+    write_file(root + "/node1/cpulist", "4-7,12-15\n");
+    write_file(root + "/node2/cpulist", "\n"); // memory-only node: skipped
+
+    const NumaTopology topo = NumaTopology::discover(root);
+    ASSERT_EQ(topo.node_count(), 2u);
+    EXPECT_EQ(topo.node(1).id, 1);
+    EXPECT_EQ(topo.node(1).cpus.size(), 8u);
+    EXPECT_EQ(topo.node_of_cpu(9), 0);
+    EXPECT_EQ(topo.node_of_cpu(13), 1);
+    EXPECT_EQ(topo.node_of_cpu(99), -1);
+    // Shows are striped over the nodes in runs of kNumaStripeShows
+    EXPECT_EQ(topo.node_of_show(0), 0u);
+    EXPECT_EQ(topo.node_of_show(booking::kNumaStripeShows - 1), 0u);
+    EXPECT_EQ(topo.node_of_show(booking::kNumaStripeShows), 1u);
+    EXPECT_EQ(topo.node_of_show(2 * booking::kNumaStripeShows + 5), 0u);
+
+    const NumaTopology fallback = NumaTopology::discover(root + "/missing");
+    ASSERT_EQ(fallback.node_count(), 1u);
+    EXPECT_FALSE(fallback.node(0).cpus.empty());
+    alignas(64) char page[64];
+    EXPECT_FALSE(booking::bind_memory(page, sizeof(page), fallback, NumaPlacement::Local, 0)); // single node: no-op
+}
+
+TEST(Numa, LocalOwnersRunOnTheirShowsNode) {
+    const NumaTopology& topo = NumaTopology::system();
+    const auto workers = static_cast<unsigned>(2u * topo.node_count());
+    booking::ShowExecutor executor(workers, booking::ShowExecutor::kDefaultRingCapacity, NumaPlacement::Local);
+    for (std::int64_t show = 0; show < 16 * booking::kNumaStripeShows; show += 7) {
+        const unsigned owner = executor.owner_of(show);
+        ASSERT_LT(owner, workers);
+        const int node = executor.worker_node(owner);
+        if (node >= 0) {
+            EXPECT_EQ(static_cast<std::size_t>(node), topo.node_of_show(show)) << show;
+        }
+    }
+    const unsigned here = executor.run(3, [] { return static_cast<unsigned>(::sched_getcpu()); });
+    const int pinned = executor.worker_node(executor.owner_of(3));
+    if (pinned >= 0) {
+        EXPECT_EQ(topo.node_of_cpu(static_cast<int>(here)), pinned);
+    }
+}
+
+TEST(Numa, PlacedServiceStillBooks) {
+    booking::set_numa_placement(NumaPlacement::Local);
+    booking::BookingService svc;
+    svc.set_execution_mode(booking::ExecutionMode::OwnerThreads, 2);
+    const booking::ShowId show = svc.find_show(1, 1);
+    EXPECT_TRUE(svc.book_seats(show, {"a1", "a2"}).success);
+    EXPECT_EQ(svc.available_count(show), 18);
+    const int node = svc.seat_state_node(show); // -1 on a single-node host
+    if (NumaTopology::system().node_count() < 2u) {
+        EXPECT_EQ(node, -1);
+    }
+    booking::set_numa_placement(NumaPlacement::Off);
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include "object_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::ObjectPool;
+
+namespace {
+
+struct Tracked {
+    static inline std::atomic<int> live{0};
+    explicit Tracked(int v) : value(v) { live.fetch_add(1); }
+    ~Tracked() { live.fetch_sub(1); }
+    int value;
+    std::string payload = "recycled";
+};
+
+} // namespace
+
+TEST(ObjectPool, RecyclesStorageOnTheSameThread) {
+    ObjectPool<Tracked> pool;
+    Tracked* a = pool.acquire(1);
+    EXPECT_EQ(a->value, 1);
+    EXPECT_EQ(Tracked::live.load(), 1);
+    pool.release(a);
+    EXPECT_EQ(Tracked::live.load(), 0);
+    Tracked* b = pool.acquire(2);
+    EXPECT_EQ(b, a); // newest free storage first
+    EXPECT_EQ(b->value, 2);
+    pool.release(b);
+
+    std::vector<ObjectPool<Tracked>::Ptr> many;
+    for (int i = 0; i < 3 * static_cast<int>(ObjectPool<Tracked>::kBlockObjects); ++i) many.push_back(pool.make(i));
+    EXPECT_EQ(pool.blocks(), 3u);
+    many.clear();
+    for (int i = 0; i < 3 * static_cast<int>(ObjectPool<Tracked>::kBlockObjects); ++i) many.push_back(pool.make(i));
+    EXPECT_EQ(pool.blocks(), 3u); // steady state: no new blocks
+    many.clear();
+    EXPECT_EQ(Tracked::live.load(), 0);
+}
+
+TEST(ObjectPool, ObjectsReleasedElsewhereGoBackToTheirHomeThread) {
+    ObjectPool<Tracked> pool;
+    std::vector<Tracked*> objects;
+    for (int i = 0; i < 8; ++i) objects.push_back(pool.acquire(i));
+    std::thread([&] {
+        for (Tracked* t : objects) pool.release(t);
+    }).join();
+    EXPECT_EQ(Tracked::live.load(), 0);
+
+    // The first acquire after the free list ran dry adopts the returned objects
+    std::vector<Tracked*> rest;
+    for (std::size_t k = 0; k < ObjectPool<Tracked>::kBlockObjects - 8u; ++k) rest.push_back(pool.acquire(0));
+    std::vector<Tracked*> again;
+    for (int i = 0; i < 8; ++i) again.push_back(pool.acquire(i));
+    for (Tracked* t : again) {
+        EXPECT_NE(std::find(objects.begin(), objects.end(), t), objects.end());
+    }
+    EXPECT_EQ(pool.blocks(), 1u);
+    for (Tracked* t : again) pool.release(t);
+    for (Tracked* t : rest) pool.release(t);
+}
+
+TEST(ObjectPool, ProducerConsumerThreadsShareOnePool) {
+    ObjectPool<Tracked> pool;
+    constexpr int kObjects = 20000;
+    std::atomic<Tracked*> mailbox{nullptr};
+    std::thread consumer([&] {
+        for (int received = 0; received < kObjects;) {
+            Tracked* t = mailbox.exchange(nullptr, std::memory_order_acquire);
+            if (!t) {
+                std::this_thread::yield();
+                continue;
+            }
+            EXPECT_EQ(t->value, received);
+            ++received;
+            pool.release(t);
+        }
+    });
+    for (int i = 0; i < kObjects; ++i) {
+        Tracked* t = pool.acquire(i);
+        while (mailbox.load(std::memory_order_relaxed) != nullptr) std::this_thread::yield();
+        mailbox.store(t, std::memory_order_release);
+    }
+    consumer.join();
+    EXPECT_EQ(Tracked::live.load(), 0);
+    EXPECT_LE(pool.blocks(), 2u); // returned objects are reused, not replaced by new blocks
+}
@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+
+#include "offline_kiosk.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingId;
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::JournalMode;
+using booking::JournalStatus;
+using booking::KioskOptions;
+using booking::KioskReconcile;
+using booking::OfflineKiosk;
+using booking::SeatMask;
+using booking::ShowId;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::string temp_path(const char* name) {
+    const std::string path = ::testing::TempDir() + name;
+    std::remove(path.c_str());
+    return path;
+}
+
+/** @brief Row @p row, seats 1..@p seats, of a hall. */
+SeatMask row_block(int row, int seats) {
+    SeatMask block;
+    block.or_word(row, (std::uint64_t{1} << seats) - 1u);
+    return block;
+}
+
+/** @brief Kiosk of @p core that only reaches it while @p online is set. */
+std::unique_ptr<OfflineKiosk> kiosk_of(BookingService& core, const std::atomic<bool>& online, std::string path,
+                                       std::chrono::milliseconds lease_ttl = std::chrono::milliseconds::zero(),
+                                       std::chrono::milliseconds sell_margin = std::chrono::milliseconds::zero()) {
+    const auto settle = [&core, &online](ShowId id, const SeatMask& seats, BookingId lease, BookingResult& out) {
+        if (!online) return false;
+        out = core.settle_lease(id, seats, lease);
+        return true;
+    };
+    const auto give_back = [&core, &online](ShowId id, const SeatMask& seats, BookingId lease, BookingResult& out) {
+        if (!online) return false;
+        out = core.cancel_seat_mask(id, seats, lease);
+        return true;
+    };
+    return std::make_unique<OfflineKiosk>(
+        [&core, &online](ShowId id, const SeatMask& block, std::chrono::milliseconds ttl, BookingResult& out) {
+            if (!online) return false;
+            out = core.lease_seat_mask(id, block, ttl);
+            return true;
+        },
+        [&core, &online](ShowId id, BookingId lease, std::chrono::milliseconds ttl, BookingResult& out) {
+            if (!online) return false;
+            out = core.renew_lease(id, lease, ttl);
+            return true;
+        },
+        settle, give_back, [&core](ShowId id) { return core.layout_for_show(id); },
+        KioskOptions{std::move(path), JournalMode::Sync, lease_ttl, sell_margin});
+}
+
+} // namespace
+
+TEST(OfflineKiosk, SellsLeasedSeatsOfflineAndSettlesThemLater) {
+    const std::string core_journal = temp_path("kiosk_core.jrnl");
+    BookingService core(HallLayout::uniform(4, 10));
+    ASSERT_EQ(core.open_journal(core_journal, JournalMode::Sync), JournalStatus::Ok);
+    const ShowId show = core.find_show(1, 1);
+    std::atomic<bool> online{true};
+    const auto kiosk = kiosk_of(core, online, temp_path("kiosk_sales.jrnl"));
+    ASSERT_EQ(kiosk->open(), JournalStatus::Ok);
+
+    const BookingResult lease = kiosk->lease(show, row_block(0, 10));
+    ASSERT_TRUE(lease.success);
+    EXPECT_EQ(core.available_count(show), 30);
+    EXPECT_EQ(core.book_seats(show, {"a1"}).status, BookingStatus::AlreadyBooked); // nobody else sells the block
+    EXPECT_EQ(kiosk->lease(show, row_block(1, 10)).status, BookingStatus::AlreadyBooked);
+
+    online = false;
+    const BookingResult pair = kiosk->book_seats(show, {"a1", "a2"});
+    ASSERT_TRUE(pair.success);
+    EXPECT_NE(pair.id & booking::kKioskSaleBit, 0u);
+    EXPECT_EQ(kiosk->book_seats(show, {"a2"}).status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(kiosk->book_seats(show, {"b1"}).status, BookingStatus::AlreadyBooked); // not leased
+    const BookingResult single = kiosk->book_seats(show, {"a3"});
+    ASSERT_TRUE(single.success);
+    EXPECT_EQ(kiosk->cancel_seats(show, {"a3"}, static_cast<BookingId>(pair.id)).status, BookingStatus::NotOwner);
+    EXPECT_TRUE(kiosk->cancel_seats(show, {"a3"}, static_cast<BookingId>(single.id)).success);
+    EXPECT_EQ(kiosk->list_available_seats(show).size(), 8u);
+
+    const KioskReconcile offline = kiosk->reconcile();
+    EXPECT_FALSE(offline.complete);
+    EXPECT_EQ(kiosk->pending_sales(), 1u);
+
+    online = true;
+    const KioskReconcile done = kiosk->reconcile(true);
+    EXPECT_TRUE(done.complete);
+    ASSERT_EQ(done.sales.size(), 1u);
+    EXPECT_EQ(done.settled, 1u);
+    EXPECT_EQ(done.sales[0].sale_id, pair.id);
+    EXPECT_EQ(done.returned, 8u);
+    const BookingId booked = done.sales[0].booking_id;
+    EXPECT_NE(booked, lease.id);
+    EXPECT_EQ(core.seat_owner(show, HallLayout::seat_index(0, 0)), booked);
+    EXPECT_EQ(core.seat_owner(show, HallLayout::seat_index(0, 1)), booked);
+    EXPECT_EQ(core.available_count(show), 38);
+    EXPECT_EQ(kiosk->pending_sales(), 0u);
+    EXPECT_EQ(kiosk->list_available_seats(show).size(), 0u);
+
+    // The core's journal holds the settled booking under its own id
+    BookingService replayed(HallLayout::uniform(4, 10));
+    ASSERT_EQ(replayed.replay_journal(core_journal).status, JournalStatus::Ok);
+    EXPECT_EQ(replayed.seat_owner(show, HallLayout::seat_index(0, 1)), booked);
+    EXPECT_EQ(replayed.available_count(show), 38);
+}
+
+TEST(OfflineKiosk, RestartKeepsTheLeaseAndUnreconciledSales) {
+    BookingService core(HallLayout::uniform(4, 10));
+    const ShowId show = core.find_show(1, 1);
+    std::atomic<bool> online{true};
+    const std::string path = temp_path("kiosk_restart.jrnl");
+    BookingId first_sale = 0;
+    {
+        const auto kiosk = kiosk_of(core, online, path);
+        ASSERT_EQ(kiosk->open(), JournalStatus::Ok);
+        ASSERT_TRUE(kiosk->lease(show, row_block(2, 6)).success);
+        online = false;
+        const BookingResult sold = kiosk->book_seats(show, {"c1", "c2"});
+        ASSERT_TRUE(sold.success);
+        first_sale = static_cast<BookingId>(sold.id);
+    }
+
+    const auto kiosk = kiosk_of(core, online, path);
+    ASSERT_EQ(kiosk->open(), JournalStatus::Ok);
+    EXPECT_EQ(kiosk->pending_sales(), 1u);
+    EXPECT_EQ(kiosk->list_available_seats(show), (std::vector<std::string>{"c3", "c4", "c5", "c6"}));
+    const BookingResult next = kiosk->book_seats(show, {"c3"});
+    ASSERT_TRUE(next.success);
+    EXPECT_NE(next.id, first_sale);
+
+    online = true;
+    const KioskReconcile done = kiosk->reconcile();
+    EXPECT_EQ(done.settled, 2u);
+    EXPECT_EQ(core.available_count(show), 34); // the rest of the lease stays leased
+
+    // Compacted to the open lease: a second restart has it and nothing to settle
+    const auto again = kiosk_of(core, online, path);
+    ASSERT_EQ(again->open(), JournalStatus::Ok);
+    EXPECT_EQ(again->pending_sales(), 0u);
+    EXPECT_EQ(again->list_available_seats(show), (std::vector<std::string>{"c4", "c5", "c6"}));
+}
+
+TEST(OfflineKiosk, ReportsSalesOfSeatsTheLeaseLost) {
+    BookingService core(HallLayout::uniform(4, 10));
+    const ShowId show = core.find_show(1, 1);
+    std::atomic<bool> online{true};
+    const auto kiosk = kiosk_of(core, online, temp_path("kiosk_lost.jrnl"));
+    ASSERT_EQ(kiosk->open(), JournalStatus::Ok);
+    const BookingResult lease = kiosk->lease(show, row_block(3, 4));
+    ASSERT_TRUE(lease.success);
+
+    const BookingResult sold = kiosk->book_seats(show, {"d1", "d2"});
+    ASSERT_TRUE(sold.success);
+    SeatMask revoked;
+    revoked.set(HallLayout::seat_index(3, 0));
+    ASSERT_TRUE(core.cancel_seat_mask(show, revoked, static_cast<BookingId>(lease.id)).success); // by the box office
+
+    const KioskReconcile done = kiosk->reconcile();
+    EXPECT_TRUE(done.complete);
+    EXPECT_EQ(done.conflicts, 1u);
+    ASSERT_EQ(done.sales.size(), 1u);
+    EXPECT_EQ(done.sales[0].status, BookingStatus::NotOwner);
+    EXPECT_EQ(done.sales[0].booking_id, 0u);
+    EXPECT_EQ(core.seat_owner(show, HallLayout::seat_index(3, 1)), lease.id); // unchanged
+    EXPECT_EQ(kiosk->list_available_seats(show), (std::vector<std::string>{"d2", "d3", "d4"}));
+}
+
+TEST(OfflineKiosk, ExpiredLeasesReturnTheirUnsoldSeats) {
+    BookingService core(HallLayout::uniform(4, 10));
+    const ShowId show = core.find_show(1, 1);
+    const BookingResult lease = core.lease_seat_mask(show, row_block(0, 6), 1h);
+    ASSERT_TRUE(lease.success);
+    const auto lease_id = static_cast<BookingId>(lease.id);
+    SeatMask sold;
+    sold.set(HallLayout::seat_index(0, 0));
+    const BookingResult settled = core.settle_lease(show, sold, lease_id);
+    ASSERT_TRUE(settled.success);
+
+    const auto now = std::chrono::steady_clock::now();
+    EXPECT_EQ(core.expire_leases(now), 0u); // not due yet
+    EXPECT_EQ(core.available_count(show), 34);
+    EXPECT_EQ(core.expire_leases(now + 2h), 5u);
+    EXPECT_EQ(core.available_count(show), 39);
+    EXPECT_EQ(core.seat_owner(show, HallLayout::seat_index(0, 0)), settled.id); // sold seats stay booked
+    EXPECT_EQ(core.renew_lease(show, lease_id, 1h).status, BookingStatus::UnknownHold);
+
+    // Elapsed but not reaped yet: no more settlements or renewals
+    const BookingResult brief = core.lease_seat_mask(show, row_block(1, 4), 1ms);
+    ASSERT_TRUE(brief.success);
+    std::this_thread::sleep_for(5ms);
+    SeatMask late;
+    late.set(HallLayout::seat_index(1, 0));
+    EXPECT_EQ(core.settle_lease(show, late, static_cast<BookingId>(brief.id)).status, BookingStatus::HoldExpired);
+    EXPECT_EQ(core.renew_lease(show, static_cast<BookingId>(brief.id), 1h).status, BookingStatus::HoldExpired);
+    EXPECT_EQ(core.expire_leases(), 4u);
+    EXPECT_EQ(core.available_count(show), 39);
+}
+
+TEST(OfflineKiosk, StopsSellingBeforeTheLeaseElapses) {
+    BookingService core(HallLayout::uniform(4, 10));
+    const ShowId show = core.find_show(1, 1);
+    std::atomic<bool> online{true};
+    const std::string path = temp_path("kiosk_ttl.jrnl");
+    {
+        const auto kiosk = kiosk_of(core, online, path, 1h, 10min);
+        ASSERT_EQ(kiosk->open(), JournalStatus::Ok);
+        ASSERT_TRUE(kiosk->lease(show, row_block(0, 4)).success);
+        ASSERT_TRUE(kiosk->book_seats(show, {"a1"}).success);
+    }
+
+    // Restarted with a margin longer than the TTL: its deadline is unknown until renewed,
+    // and renewing gives less time than the margin, so it sells nothing
+    const auto kiosk = kiosk_of(core, online, path, 30min, 45min);
+    ASSERT_EQ(kiosk->open(), JournalStatus::Ok);
+    EXPECT_EQ(kiosk->book_seats(show, {"a2"}).status, BookingStatus::HoldExpired);
+    ASSERT_TRUE(kiosk->renew(show).success);
+    EXPECT_EQ(kiosk->book_seats(show, {"a2"}).status, BookingStatus::HoldExpired);
+
+    // The partner never comes back: the core reaps the whole lease (a1 was never settled)
+    EXPECT_EQ(core.expire_leases(std::chrono::steady_clock::now() + 1h), 4u);
+    EXPECT_EQ(kiosk->renew(show).status, BookingStatus::UnknownHold);
+    const KioskReconcile done = kiosk->reconcile();
+    EXPECT_EQ(done.conflicts, 1u);
+    EXPECT_EQ(done.sales[0].status, BookingStatus::NotOwner);
+    EXPECT_EQ(kiosk->list_available_seats(show).size(), 0u);
+    SeatMask leased;
+    EXPECT_EQ(kiosk->available_seats_mask(show, leased), -1); // the lease ended here too
+    EXPECT_EQ(core.available_count(show), 40);
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include "payment_workflow.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::PaymentOutcome;
+using booking::PaymentTicket;
+using booking::PaymentWorkflow;
+using booking::ShowId;
+
+namespace {
+
+void wait_for(const std::atomic<int>& settled, int expected) {
+    while (settled.load() < expected) std::this_thread::yield();
+}
+
+} // namespace
+
+TEST(PaymentWorkflow, PaidConfirmsAndDeclinedReleases) {
+    BookingService svc(HallLayout::uniform(2, 10));
+    const ShowId show = svc.find_show(1, 1);
+    PaymentWorkflow payments(svc);
+
+    std::atomic<int> settled{0};
+    std::mutex mutex;
+    std::vector<std::pair<PaymentOutcome, BookingResult>> results;
+    const auto done = [&](PaymentTicket, PaymentOutcome outcome, const BookingResult& result) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.emplace_back(outcome, result);
+        }
+        settled.fetch_add(1);
+    };
+
+    const BookingResult paid = payments.begin(show, {"a1", "a2"}, std::chrono::minutes(1), done);
+    ASSERT_TRUE(paid.success);
+    EXPECT_NE(paid.id, 0u);
+    const BookingResult declined = payments.begin(show, {"b1"}, std::chrono::minutes(1), done);
+    ASSERT_TRUE(declined.success);
+    EXPECT_EQ(svc.available_count(show), 17); // held while the payments run
+    EXPECT_EQ(payments.begin(show, {"a2"}, std::chrono::minutes(1), done).status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(payments.pending(), 2u);
+
+    ASSERT_TRUE(payments.complete(paid.id, PaymentOutcome::Paid));
+    EXPECT_FALSE(payments.complete(paid.id, PaymentOutcome::Declined)); // a repeated callback
+    wait_for(settled, 1);
+    ASSERT_TRUE(payments.complete(declined.id, PaymentOutcome::Declined));
+    wait_for(settled, 2);
+    EXPECT_FALSE(payments.complete(declined.id, PaymentOutcome::Paid));
+    EXPECT_FALSE(payments.complete(12345, PaymentOutcome::Paid));
+
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].first, PaymentOutcome::Paid);
+    EXPECT_TRUE(results[0].second.success);
+    EXPECT_TRUE(svc.cancel_seats(show, {"a1"}, results[0].second.id).success); // a real booking
+    EXPECT_EQ(results[1].first, PaymentOutcome::Declined);
+    EXPECT_TRUE(results[1].second.success);
+    EXPECT_EQ(svc.available_count(show), 19); // b1 released, a2 still booked
+    EXPECT_EQ(payments.pending(), 0u);
+    EXPECT_STREQ(booking::to_string(PaymentOutcome::TimedOut), "timed out");
+}
+
+TEST(PaymentWorkflow, UnansweredPaymentsTimeOut) {
+    BookingService svc(HallLayout::uniform(2, 10));
+    const ShowId show = svc.find_show(1, 1);
+    PaymentWorkflow payments(svc, 1, 64, std::chrono::milliseconds(5));
+
+    std::atomic<int> settled{0};
+    PaymentOutcome seen = PaymentOutcome::Paid;
+    BookingStatus status = BookingStatus::Ok;
+    const BookingResult r = payments.begin(
+        show, {"a1"}, std::chrono::milliseconds(20), [&](PaymentTicket, PaymentOutcome outcome, const BookingResult& res) {
+            seen = outcome;
+            status = res.status;
+            settled.fetch_add(1);
+        });
+    ASSERT_TRUE(r.success);
+    wait_for(settled, 1);
+    EXPECT_EQ(seen, PaymentOutcome::TimedOut);
+    EXPECT_EQ(status, BookingStatus::HoldExpired);
+    EXPECT_EQ(svc.available_count(show), 20);
+    EXPECT_FALSE(payments.complete(r.id, PaymentOutcome::Paid)); // the provider answered too late
+    EXPECT_EQ(payments.stats().timed_out, 1u);
+}
+
+TEST(PaymentWorkflow, ThousandsPendingSettleFromCallbackThreads) {
+    BookingService svc(HallLayout::uniform(26, 40));
+    const ShowId show = svc.find_show(1, 1);
+    constexpr int kTickets = 1000;
+    PaymentWorkflow payments(svc, 2, kTickets);
+
+    std::atomic<int> settled{0};
+    std::atomic<int> booked{0};
+    const auto done = [&](PaymentTicket, PaymentOutcome outcome, const BookingResult& res) {
+        if (outcome == PaymentOutcome::Paid && res.success) booked.fetch_add(1);
+        settled.fetch_add(1);
+    };
+    std::vector<PaymentTicket> tickets;
+    for (int i = 0; i < kTickets; ++i) {
+        const std::string label = std::string(1, static_cast<char>('a' + i / 40)) + std::to_string(i % 40 + 1);
+        const BookingResult r = payments.begin(show, {label}, std::chrono::minutes(1), done);
+        ASSERT_TRUE(r.success) << label;
+        tickets.push_back(r.id);
+    }
+    EXPECT_EQ(payments.pending(), static_cast<std::size_t>(kTickets));
+    EXPECT_EQ(payments.begin(show, {"z1"}, std::chrono::minutes(1), done).status, BookingStatus::Busy);
+
+    // The provider answers on its own threads: even tickets paid, odd ones declined
+    std::vector<std::thread> callbacks;
+    for (int t = 0; t < 4; ++t) {
+        callbacks.emplace_back([&, t] {
+            for (int i = t; i < kTickets; i += 4) {
+                EXPECT_TRUE(payments.complete(tickets[i], i % 2 == 0 ? PaymentOutcome::Paid : PaymentOutcome::Declined));
+            }
+        });
+    }
+    for (std::thread& t : callbacks) t.join();
+    wait_for(settled, kTickets);
+
+    EXPECT_EQ(booked.load(), kTickets / 2);
+    EXPECT_EQ(svc.available_count(show), 26 * 40 - kTickets / 2);
+    const booking::PaymentStats stats = payments.stats();
+    EXPECT_EQ(stats.started, static_cast<std::uint64_t>(kTickets));
+    EXPECT_EQ(stats.paid, static_cast<std::uint64_t>(kTickets / 2));
+    EXPECT_EQ(stats.declined, static_cast<std::uint64_t>(kTickets / 2));
+    EXPECT_EQ(stats.pending, 0u);
+    EXPECT_TRUE(payments.begin(show, {"z1"}, std::chrono::minutes(1), done).success); // slots recycled
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include "perf_baseline.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using booking::PerfDelta;
+using booking::PerfRun;
+using booking::PerfVerdict;
+
+namespace {
+
+/** @brief Benchmark output in the layout booking_bench writes with --benchmark_out. */
+const char* const kJson = R"({
+  "context": {
+    "date": "2026-10-14T18:06:20+00:00",
+    "caches": [{"type": "Data", "level": 1, "size": 49152}],
+    "load_avg": [0.18,0.39,0.49],
+    "library_build_type": "release"
+  },
+  "benchmarks": [
+    {
+      "name": "BM_BookCancel",
+      "run_name": "BM_BookCancel",
+      "run_type": "iteration",
+      "repetition_index": 0,
+      "real_time": 2.5e+03,
+      "cpu_time": 2.0e+03,
+      "time_unit": "ns",
+      "items_per_second": 1.0e+06
+    },
+    {
+      "name": "BM_BookCancel",
+      "run_name": "BM_BookCancel",
+      "run_type": "iteration",
+      "repetition_index": 1,
+      "real_time": 2.6e+03,
+      "cpu_time": 2.2e+03,
+      "time_unit": "ns"
+    },
+    {
+      "name": "BM_BookCancel_mean",
+      "run_name": "BM_BookCancel",
+      "run_type": "aggregate",
+      "aggregate_name": "mean",
+      "real_time": 2.55e+03,
+      "cpu_time": 2.1e+03,
+      "time_unit": "ns"
+    },
+    {
+      "name": "BM_AvailableCount/real_time/threads:1",
+      "run_name": "BM_AvailableCount/real_time/threads:1",
+      "run_type": "iteration",
+      "real_time": 1.5,
+      "cpu_time": 1.0,
+      "time_unit": "us",
+      "label": "quoted \"label\", with [brackets]"
+    }
+  ]
+})";
+
+PerfRun run(const std::string& name, std::vector<double> ns) {
+    return PerfRun{name, std::move(ns)};
+}
+
+const PerfDelta& find(const std::vector<PerfDelta>& deltas, const std::string& name) {
+    for (const PerfDelta& d : deltas) {
+        if (d.name == name) return d;
+    }
+    ADD_FAILURE() << name;
+    return deltas.front();
+}
+
+} // namespace
+
+TEST(PerfBaseline, ParsesBenchmarkJson) {
+    std::vector<PerfRun> runs;
+    ASSERT_TRUE(booking::parse_benchmark_json(kJson, runs));
+    ASSERT_EQ(runs.size(), 2u);
+    EXPECT_EQ(runs[0].name, "BM_BookCancel");
+    EXPECT_EQ(runs[0].ns, (std::vector<double>{2000.0, 2200.0})); // cpu time; the aggregate is skipped
+    EXPECT_EQ(runs[1].name, "BM_AvailableCount/real_time/threads:1");
+    EXPECT_EQ(runs[1].ns, (std::vector<double>{1500.0})); // real time, in ns
+
+    EXPECT_FALSE(booking::parse_benchmark_json("{\"context\": {}}", runs));
+    EXPECT_FALSE(booking::parse_benchmark_json("{\"benchmarks\": [{\"name\": \"x\"}]}", runs));
+    EXPECT_FALSE(booking::parse_benchmark_json("not json", runs));
+    EXPECT_TRUE(booking::parse_benchmark_json("{\"benchmarks\": []}", runs));
+    EXPECT_TRUE(runs.empty());
+}
+
+TEST(PerfBaseline, MannWhitneyP) {
+    const std::vector<double> low = {1, 2, 3, 4, 5};
+    const std::vector<double> high = {6, 7, 8, 9, 10};
+    const std::vector<double> interleaved = {1.5, 2.5, 3.5, 4.5, 5.5};
+    // Complete separation of 5 vs 5: z = 12 / sqrt(275 / 12)
+    EXPECT_NEAR(booking::mann_whitney_p(low, high), 0.01219, 1e-4);
+    EXPECT_NEAR(booking::mann_whitney_p(high, low), 0.01219, 1e-4);
+    EXPECT_GT(booking::mann_whitney_p(low, interleaved), 0.5);
+    EXPECT_DOUBLE_EQ(booking::mann_whitney_p(low, low), 1.0);
+    EXPECT_DOUBLE_EQ(booking::mann_whitney_p(low, {}), 1.0);
+    const std::vector<double> same = {4, 4, 4};
+    EXPECT_DOUBLE_EQ(booking::mann_whitney_p(same, same), 1.0); // all tied
+}
+
+TEST(PerfBaseline, ComparesAgainstTheBaseline) {
+    const std::vector<PerfRun> baseline = {
+        run("BM_Same", {100, 102, 98, 101, 99}),
+        run("BM_Regressed", {100, 102, 98, 101, 99}),
+        run("BM_SlightlySlower", {100, 102, 98, 101, 99}),
+        run("BM_Faster", {100, 102, 98, 101, 99}),
+        run("BM_Noisy", {100, 102, 98, 101, 99}),
+        run("BM_Gone", {100, 100}),
+    };
+    const std::vector<PerfRun> current = {
+        run("BM_Same", {101, 99, 100, 103, 97}),
+        run("BM_Regressed", {130, 128, 131, 135, 129}),
+        run("BM_SlightlySlower", {105, 106, 104, 107, 105}),
+        run("BM_Faster", {80, 81, 79, 82, 80}),
+        run("BM_Noisy", {90, 300, 95, 400, 97}), // lower median, but no consistent shift
+        run("BM_Added", {50, 50}),
+    };
+    const std::vector<PerfDelta> deltas = booking::compare_perf(baseline, current);
+    ASSERT_EQ(deltas.size(), 7u);
+    EXPECT_EQ(deltas.back().name, "BM_Added");
+    EXPECT_EQ(find(deltas, "BM_Same").verdict, PerfVerdict::Unchanged);
+    EXPECT_EQ(find(deltas, "BM_Regressed").verdict, PerfVerdict::Regression);
+    EXPECT_NEAR(find(deltas, "BM_Regressed").change, 0.30, 1e-9);
+    EXPECT_EQ(find(deltas, "BM_SlightlySlower").verdict, PerfVerdict::Slower);
+    EXPECT_EQ(find(deltas, "BM_Faster").verdict, PerfVerdict::Faster);
+    EXPECT_EQ(find(deltas, "BM_Noisy").verdict, PerfVerdict::Unchanged);
+    EXPECT_EQ(find(deltas, "BM_Gone").verdict, PerfVerdict::Missing);
+    EXPECT_EQ(find(deltas, "BM_Added").verdict, PerfVerdict::New);
+    EXPECT_TRUE(booking::perf_failed(deltas));
+
+    // A looser threshold accepts the regression; the missing benchmark still fails the run
+    booking::PerfThresholds loose;
+    loose.max_slowdown = 0.5;
+    std::vector<PerfDelta> relaxed = booking::compare_perf(baseline, current, loose);
+    EXPECT_EQ(find(relaxed, "BM_Regressed").verdict, PerfVerdict::Slower);
+    EXPECT_TRUE(booking::perf_failed(relaxed));
+    relaxed.erase(relaxed.begin() + 5);
+    EXPECT_FALSE(booking::perf_failed(relaxed));
+}
+
+TEST(PerfBaseline, WritesAReport) {
+    const std::vector<PerfDelta> deltas = booking::compare_perf(
+        {run("BM_BookCancel", {100, 101, 99, 100, 102}), run("BM_Gone", {5})},
+        {run("BM_BookCancel", {150, 151, 149, 150, 152})});
+    std::ostringstream out;
+    booking::write_perf_report(out, deltas);
+    const std::string report = out.str();
+    EXPECT_NE(report.find("benchmark"), std::string::npos);
+    EXPECT_NE(report.find("BM_BookCancel"), std::string::npos);
+    EXPECT_NE(report.find("+50.0%"), std::string::npos);
+    EXPECT_NE(report.find("regression"), std::string::npos);
+    EXPECT_NE(report.find("missing"), std::string::npos);
+    EXPECT_STREQ(booking::to_string(PerfVerdict::Faster), "faster");
+    EXPECT_STREQ(booking::to_string(static_cast<PerfVerdict>(99)), "unknown");
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "pmem.hpp"
+
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using booking::BookingId;
+using booking::BookingService;
+using booking::HallLayout;
+using booking::SharedSeatRegion;
+using booking::SharedSeatsStatus;
+using namespace std::chrono_literals;
+
+namespace {
+
+/** @brief Unique seat file path, removed on destruction. */
+struct SeatFile {
+    explicit SeatFile(const char* tag)
+        : path(::testing::TempDir() + "booking-seats-" + tag + "-" + std::to_string(::getpid())) {
+        std::remove(path.c_str());
+    }
+    ~SeatFile() { std::remove(path.c_str()); }
+    std::string path;
+};
+
+/** @brief Empty service on the seat file @p path with @p shows 6x20 shows. */
+void attach_and_load(BookingService& svc, const std::string& path, int shows) {
+    ASSERT_EQ(svc.attach_persistent_seats(path, std::size_t{4} << 20, 64), SharedSeatsStatus::Ok);
+    booking::Schedule schedule;
+    schedule.movies.push_back(booking::ScheduleMovie{1, "Dune"});
+    schedule.theaters.push_back(booking::ScheduleTheater{1, "Roxy"});
+    schedule.layouts.push_back(booking::ScheduleLayout{0, HallLayout::uniform(6, 20)});
+    for (int s = 0; s < shows; ++s) schedule.shows.push_back(booking::ScheduleShow{s, 1, 1, 0});
+    ASSERT_EQ(svc.load_schedule(std::move(schedule)).status, booking::ScheduleStatus::Ok);
+}
+
+} // namespace
+
+TEST(PersistentSeats, BookingsSurviveARestart) {
+    const SeatFile file("restart");
+    BookingId kept = 0;
+    BookingId cancelled = 0;
+    {
+        BookingService svc{BookingService::EmptyCatalog{}};
+        attach_and_load(svc, file.path, 2);
+        const auto a = svc.book_seats(0, {"a1", "a2", "f20"});
+        const auto b = svc.book_seats(1, {"c5"});
+        ASSERT_TRUE(a.success && b.success);
+        kept = a.id;
+        cancelled = b.id;
+        ASSERT_TRUE(svc.cancel_seats(1, {"c5"}, cancelled).success);
+        ASSERT_TRUE(svc.hold_seats(1, {"d1", "d2"}, 1min).success); // holds are not kept
+        EXPECT_TRUE(svc.sync_persistent_seats());
+    }
+
+    BookingService svc{BookingService::EmptyCatalog{}};
+    attach_and_load(svc, file.path, 2);
+    EXPECT_EQ(svc.available_count(0), 6 * 20 - 3);
+    EXPECT_EQ(svc.available_count(1), 6 * 20);
+    EXPECT_EQ(svc.seat_owner(0, HallLayout::seat_index(5, 19)), kept);
+    EXPECT_EQ(svc.book_seats(0, {"a2"}).status, booking::BookingStatus::AlreadyBooked);
+
+    const auto next = svc.book_seats(1, {"d1"});
+    ASSERT_TRUE(next.success);
+    EXPECT_GT(next.id, kept); // ids continue past the ones in the file
+    EXPECT_GT(next.id, cancelled);
+    EXPECT_TRUE(svc.cancel_seats(0, {"a1", "a2", "f20"}, kept).success);
+    EXPECT_EQ(svc.available_count(0), 6 * 20);
+}
+
+TEST(PersistentSeats, OpenRecoversUnownedSeats) {
+    const SeatFile file("recover");
+    constexpr std::uint32_t kOwnerBytes = 2 * SharedSeatRegion::kOwnerRowSeats * sizeof(BookingId);
+    {
+        SharedSeatRegion region;
+        ASSERT_EQ(region.open_file(file.path, std::size_t{1} << 20, 16), SharedSeatsStatus::Ok);
+        EXPECT_TRUE(region.persistent());
+        EXPECT_EQ(region.recovered_seats(), 0u);
+        const SharedSeatRegion::Block block = region.claim(7, 2, kOwnerBytes);
+        ASSERT_NE(block.words, nullptr);
+        block.words[0].store(0b1011u); // seats 0, 1, 3 taken; only seat 1 has an owner
+        block.words[1].store(0b1u);
+        static_cast<std::atomic<BookingId>*>(block.owners)[1].store(5000u);
+        block.version[1].store(1u); // a group write that never finished
+    }
+    SharedSeatRegion region;
+    ASSERT_EQ(region.open_file(file.path), SharedSeatsStatus::Ok);
+    EXPECT_EQ(region.recovered_seats(), 3u);
+    const SharedSeatRegion::Block block = region.claim(7, 2, kOwnerBytes);
+    ASSERT_NE(block.words, nullptr);
+    EXPECT_EQ(block.words[0].load(), 0b10u);
+    EXPECT_EQ(block.words[1].load(), 0u);
+    EXPECT_EQ(block.version[1].load(), 0u);
+    EXPECT_GE(region.booking_ids().load(), 5120u); // past the id block of owner 5000
+}
+
+TEST(PersistentSeats, FileIsLockedToOneService) {
+    const SeatFile file("lock");
+    BookingService a{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(a.attach_persistent_seats(file.path, std::size_t{1} << 20, 16), SharedSeatsStatus::Ok);
+    BookingService b{BookingService::EmptyCatalog{}};
+    EXPECT_EQ(b.attach_persistent_seats(file.path), SharedSeatsStatus::Locked);
+    EXPECT_EQ(a.attach_persistent_seats(file.path), SharedSeatsStatus::InUse);
+    EXPECT_FALSE(b.sync_persistent_seats());
+    EXPECT_STREQ(booking::to_string(SharedSeatsStatus::Locked), "Seat region file in use by another process");
+}
+
+TEST(PersistentSeats, FlushAndDrain) {
+    alignas(64) std::array<std::uint64_t, 24> lines{};
+    lines[0] = 1;
+    lines[23] = 2;
+    booking::pmem::persist(lines.data() + 3, sizeof(lines) - 3 * sizeof(std::uint64_t)); // spans line boundaries
+    booking::pmem::persist(lines.data(), 0);
+    EXPECT_EQ(lines[23], 2u);
+    EXPECT_STRNE(booking::pmem::to_string(booking::pmem::flush_kind()), "unknown");
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "profiler.hpp"
+
+#include <chrono>
+#include <sstream>
+#include <string>
+
+using booking::BookingService;
+using booking::MetricsApi;
+using booking::ProfileSample;
+using booking::ProfileScope;
+using booking::ShowId;
+
+TEST(Profiler, ScopesTagAndRestore) {
+    if (!BOOKING_PROFILE_TAGS) GTEST_SKIP() << "built without profile tags";
+    booking::ProfileTag& tag = booking::profile_tag();
+    EXPECT_EQ(tag.api.load(), booking::kNoProfileApi);
+    booking::profile_tag_show(7);
+    {
+        const ProfileScope outer(MetricsApi::BookSeats);
+        EXPECT_EQ(tag.api.load(), static_cast<std::uint8_t>(MetricsApi::BookSeats));
+        booking::profile_tag_show(42);
+        {
+            const ProfileScope inner(MetricsApi::AvailableCount);
+            EXPECT_EQ(tag.api.load(), static_cast<std::uint8_t>(MetricsApi::AvailableCount));
+            booking::profile_tag_show(43);
+        }
+        EXPECT_EQ(tag.api.load(), static_cast<std::uint8_t>(MetricsApi::BookSeats));
+        EXPECT_EQ(tag.show.load(), 42);
+    }
+    EXPECT_EQ(tag.api.load(), booking::kNoProfileApi);
+    EXPECT_EQ(tag.show.load(), 7);
+    booking::profile_tag_show(-1);
+
+    std::ostringstream folded;
+    booking::write_folded_profile(folded, {ProfileSample{static_cast<std::uint8_t>(MetricsApi::BookSeats), 42, 17},
+                                           ProfileSample{booking::kNoProfileApi, -1, 3}});
+    EXPECT_EQ(folded.str(), "book_seats;show 42 17\n(none);(no show) 3\n");
+}
+
+TEST(Profiler, SamplesAreAttributedToShowsAndCalls) {
+    if (!BOOKING_PROFILE_TAGS) GTEST_SKIP() << "built without profile tags";
+    BookingService svc(booking::HallLayout::uniform(20, 40));
+    const ShowId show = svc.find_show(1, 1);
+    booking::profile_reset();
+    ASSERT_TRUE(booking::profile_start(1000));
+    EXPECT_FALSE(booking::profile_start(1000)); // one sampler per process
+    EXPECT_TRUE(booking::profile_running());
+
+    // Spin on one show until enough CPU samples arrived (or 5 s of wall time passed)
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    std::uint64_t tagged = 0;
+    while (tagged < 20u && std::chrono::steady_clock::now() < deadline) {
+        for (int i = 0; i < 2000; ++i) svc.list_available_seats(show);
+        tagged = 0;
+        for (const ProfileSample& s : booking::profile_collect()) {
+            if (s.show == show && s.api == static_cast<std::uint8_t>(MetricsApi::ListAvailableSeats)) tagged += s.samples;
+        }
+    }
+    booking::profile_stop();
+    EXPECT_FALSE(booking::profile_running());
+    EXPECT_GE(tagged, 20u);
+    EXPECT_EQ(booking::profile_dropped(), 0u);
+
+    const std::vector<ProfileSample> samples = booking::profile_collect();
+    ASSERT_FALSE(samples.empty());
+    EXPECT_EQ(samples.front().show, show); // the spin dominates the profile
+    std::ostringstream folded;
+    booking::write_folded_profile(folded, samples);
+    EXPECT_NE(folded.str().find("list_available_seats;show " + std::to_string(show.value())), std::string::npos);
+    booking::profile_reset();
+    EXPECT_TRUE(booking::profile_collect().empty());
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include "rate_limiter.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using booking::ClientRateLimiter;
+using booking::RateLimit;
+
+TEST(RateLimiter, RefillsEachClientsBucketAtTheConfiguredRate) {
+    ClientRateLimiter limiter(RateLimit{1000.0, 4}); // a token per ms, four banked at most
+    ASSERT_TRUE(limiter.enabled());
+    const std::int64_t t0 = 5'000'000'000;
+    for (int i = 0; i < 4; ++i) EXPECT_TRUE(limiter.allow(7, t0)) << i;
+    EXPECT_FALSE(limiter.allow(7, t0));
+    EXPECT_FALSE(limiter.allow(7, t0 + 999'999));
+    EXPECT_TRUE(limiter.allow(7, t0 + 1'000'000));
+    EXPECT_FALSE(limiter.allow(7, t0 + 1'000'000));
+
+    // Other clients have buckets of their own
+    EXPECT_TRUE(limiter.allow(8, t0));
+    EXPECT_TRUE(limiter.allow(0, t0));
+
+    // After a long pause the bucket is full again, and no fuller
+    int granted = 0;
+    for (int i = 0; i < 10; ++i) granted += limiter.allow(7, t0 + 1'000'000'000) ? 1 : 0;
+    EXPECT_EQ(granted, 4);
+
+    const booking::RateLimiterStats stats = limiter.stats();
+    EXPECT_EQ(stats.rejected, 9u);
+    EXPECT_EQ(stats.clients, 3u);
+    EXPECT_EQ(stats.untracked, 0u);
+
+    ClientRateLimiter unlimited(RateLimit{});
+    EXPECT_FALSE(unlimited.enabled());
+    for (int i = 0; i < 100; ++i) EXPECT_TRUE(unlimited.allow(1, t0));
+}
+
+TEST(RateLimiter, NewLimitsApplyToClientsAlreadyTracked) {
+    ClientRateLimiter limiter(RateLimit{});
+    const std::int64_t t0 = 5'000'000'000;
+    for (int i = 0; i < 10; ++i) EXPECT_TRUE(limiter.allow(7, t0));
+
+    limiter.set_limit(RateLimit{1000.0, 2});
+    EXPECT_TRUE(limiter.enabled());
+    EXPECT_TRUE(limiter.allow(7, t0));
+    EXPECT_TRUE(limiter.allow(7, t0));
+    EXPECT_FALSE(limiter.allow(7, t0));
+
+    limiter.set_limit(RateLimit{});
+    EXPECT_FALSE(limiter.enabled());
+    EXPECT_TRUE(limiter.allow(7, t0));
+}
+
+TEST(RateLimiter, RecyclesRefilledSlotsAndSharesOverflowWhenFull) {
+    ClientRateLimiter limiter(RateLimit{1.0, 1}, ClientRateLimiter::kProbe); // one probe window in all
+    const std::int64_t t0 = 1'000'000'000;
+    for (std::uint64_t c = 0; c < ClientRateLimiter::kProbe; ++c) EXPECT_TRUE(limiter.allow(c, t0));
+    EXPECT_EQ(limiter.stats().clients, ClientRateLimiter::kProbe);
+
+    // Every bucket is drained, so the newcomers share the overflow bucket
+    EXPECT_TRUE(limiter.allow(100, t0));
+    EXPECT_FALSE(limiter.allow(101, t0));
+    EXPECT_EQ(limiter.stats().untracked, 2u);
+    EXPECT_FALSE(limiter.allow(3, t0)); // tracked clients keep their buckets
+
+    // Two seconds later the old buckets are full: a newcomer takes one over
+    EXPECT_TRUE(limiter.allow(102, t0 + 2'000'000'000));
+    EXPECT_FALSE(limiter.allow(102, t0 + 2'000'000'000));
+    EXPECT_EQ(limiter.stats().untracked, 2u);
+    EXPECT_EQ(limiter.stats().clients, ClientRateLimiter::kProbe);
+}
+
+TEST(RateLimiter, ConcurrentRequestsNeverExceedTheBurst) {
+    ClientRateLimiter limiter(RateLimit{0.001, 50}, 256);
+    constexpr int kThreads = 4;
+    constexpr int kClients = 16;
+    std::atomic<int> granted[kClients] = {};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 2000; ++i) {
+                const int c = i % kClients;
+                if (limiter.allow(static_cast<std::uint64_t>(c) << 32, 1'000'000'000)) granted[c].fetch_add(1);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    for (int c = 0; c < kClients; ++c) EXPECT_EQ(granted[c].load(), 50) << c;
+    EXPECT_EQ(limiter.stats().rejected, static_cast<std::uint64_t>(kThreads * 2000 - kClients * 50));
+}
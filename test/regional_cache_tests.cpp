@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include "regional_cache.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingId;
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::RegionalCacheOptions;
+using booking::RegionalRead;
+using booking::RegionalReadCache;
+using booking::RegionalReadStatus;
+using booking::ShowId;
+using namespace std::chrono_literals;
+
+namespace {
+
+RegionalCacheOptions by_hand() {
+    RegionalCacheOptions o;
+    o.max_staleness = std::chrono::hours(1);
+    o.sync_interval = 0ms;
+    return o;
+}
+
+int count_of(RegionalReadCache& cache, ShowId show, std::chrono::nanoseconds bound) {
+    int count = -1;
+    EXPECT_EQ(cache.available_count(show, count, bound).status, RegionalReadStatus::Ok);
+    return count;
+}
+
+} // namespace
+
+TEST(RegionalReadCache, ServesReadsLocallyWithinTheirBound) {
+    BookingService home(HallLayout::uniform(4, 10));
+    home.enable_change_feed(1u << 10);
+    const ShowId show = home.find_show(1, 1);
+    RegionalReadCache cache(home, by_hand());
+
+    EXPECT_EQ(count_of(cache, show, 1h), 40); // first read fetches the snapshot
+    ASSERT_TRUE(home.book_seats(show, {"a1", "a2"}).success);
+    std::this_thread::sleep_for(2ms);
+
+    // Within the bound the mirror answers, and says how old it is
+    int count = 0;
+    const RegionalRead local = cache.available_count(show, count, 1h);
+    EXPECT_EQ(local.status, RegionalReadStatus::Ok);
+    EXPECT_EQ(count, 40);
+    EXPECT_GE(local.staleness, 2ms);
+
+    // A tighter bound costs one round trip (a diff) and sees the booking
+    EXPECT_EQ(count_of(cache, show, 1ms), 38);
+    std::vector<std::string> seats;
+    ASSERT_EQ(cache.list_available_seats(show, seats, 1h).status, RegionalReadStatus::Ok);
+    EXPECT_EQ(seats, home.list_available_seats(show));
+
+    const booking::RegionalCacheStats s = cache.stats();
+    EXPECT_EQ(s.refreshes, 2u);
+    EXPECT_EQ(s.refreshed_reads, 2u);
+    EXPECT_EQ(s.local_reads, 2u);
+    EXPECT_EQ(cache.show_count(), 1u);
+
+    // Unknown shows are not mirrored
+    EXPECT_EQ(cache.available_count(999, count).status, RegionalReadStatus::UnknownShow);
+    EXPECT_EQ(cache.show_count(), 1u);
+}
+
+TEST(RegionalReadCache, ForwardsBookingsAndHidesTheirSeatsAtOnce) {
+    BookingService home(HallLayout::uniform(4, 10));
+    home.enable_change_feed(1u << 10);
+    const ShowId show = home.find_show(1, 1);
+    RegionalReadCache cache(home, by_hand());
+    EXPECT_EQ(count_of(cache, show, 1h), 40);
+
+    const BookingResult mine = cache.book_seats(show, {"b1", "b2"});
+    ASSERT_TRUE(mine.success);
+    EXPECT_EQ(home.available_count(show), 38);
+    EXPECT_EQ(count_of(cache, show, 1h), 38); // hidden before any refresh
+
+    // A conflict names seats taken in the home region: hidden too
+    ASSERT_TRUE(home.book_seats(show, {"c1"}).success);
+    EXPECT_EQ(cache.book_seats(show, {"c1", "c2"}).status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(count_of(cache, show, 1h), 37);
+    EXPECT_EQ(cache.stats().refreshes, 1u);
+
+    EXPECT_EQ(cache.refresh_all(), 0u);
+    EXPECT_EQ(count_of(cache, show, 1h), 37);
+    ASSERT_TRUE(cache.cancel_seats(show, {"b1"}, static_cast<BookingId>(mine.id)).success);
+    EXPECT_EQ(count_of(cache, show, 0ns), 38);
+    EXPECT_EQ(cache.stats().forwarded, 3u);
+}
+
+TEST(RegionalReadCache, ReportsStaleAnswersWhenTheHomeRegionIsUnreachable) {
+    BookingService home(HallLayout::uniform(4, 10));
+    home.enable_change_feed(1u << 4); // small ring: a long outage needs a resync
+    const ShowId show = home.find_show(1, 1);
+    std::atomic<bool> reachable{true};
+    RegionalReadCache cache(
+        [&](ShowId id, booking::SeatMapSnapshot& out) {
+            if (!reachable) return false;
+            out.layout = std::make_shared<const HallLayout>(*home.layout_for_show(id));
+            return home.availability_snapshot(id, out.free, out.position) >= 0;
+        },
+        [&](ShowId id, std::uint64_t since, booking::AvailabilityDiff& out) {
+            if (!reachable) return false;
+            out = home.availability_diff(id, since);
+            return true;
+        },
+        [&](ShowId id, const std::vector<std::string>& seats) { return home.book_seats(id, seats); },
+        [&](ShowId id, const std::vector<std::string>& seats, BookingId booking) {
+            return home.cancel_seats(id, seats, booking);
+        },
+        by_hand());
+    EXPECT_EQ(count_of(cache, show, 0ns), 40);
+
+    reachable = false;
+    for (int seat = 1; seat <= 10; ++seat) {
+        ASSERT_TRUE(home.book_seats(show, {"c" + std::to_string(seat)}).success);
+        ASSERT_TRUE(home.book_seats(show, {"d" + std::to_string(seat)}).success);
+    }
+    int count = 0;
+    const RegionalRead stale = cache.available_count(show, count, 0ns);
+    EXPECT_EQ(stale.status, RegionalReadStatus::Stale);
+    EXPECT_EQ(count, 40); // the last answer it had, flagged
+    EXPECT_EQ(cache.refresh_all(), 1u);
+
+    reachable = true;
+    EXPECT_EQ(count_of(cache, show, 0ns), 20);
+    EXPECT_EQ(cache.stats().resyncs, 1u);
+    EXPECT_EQ(cache.stats().stale_reads, 1u);
+}
+
+TEST(RegionalReadCache, BackgroundRefreshKeepsReadsWithinTheInterval) {
+    BookingService home(HallLayout::uniform(4, 10));
+    home.enable_change_feed(1u << 10);
+    const ShowId show = home.find_show(1, 1);
+    RegionalCacheOptions options;
+    options.sync_interval = 2ms;
+    options.max_staleness = std::chrono::hours(1);
+    RegionalReadCache cache(home, options);
+    EXPECT_EQ(count_of(cache, show, 1h), 40);
+    ASSERT_TRUE(home.book_seats(show, {"a5"}).success);
+
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (count_of(cache, show, 1h) != 39 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_EQ(count_of(cache, show, 1h), 39);
+    EXPECT_EQ(cache.stats().refreshed_reads, 1u); // only the first read waited for the home region
+}
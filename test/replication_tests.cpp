@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+
+#include "replication.hpp"
+#include "text_protocol.hpp"
+#include "wire_protocol.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+using booking::BookingId;
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::JournalMode;
+using booking::JournalStatus;
+using booking::ReplicaClient;
+using booking::ReplicationOptions;
+using booking::ReplicationSource;
+using booking::ReplicationStatus;
+using booking::ShowId;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::string temp_path(const char* name) {
+    const std::string path = ::testing::TempDir() + name;
+    std::remove(path.c_str());
+    return path;
+}
+
+ReplicationOptions fast_options() {
+    ReplicationOptions o;
+    o.heartbeat_interval = 5ms;
+    o.reconnect_interval = 10ms;
+    return o;
+}
+
+/** @brief True once every seat of @p show has the same owner on both services (waits up to 5 s). */
+bool converges(const BookingService& primary, const BookingService& replica, ShowId show) {
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (std::chrono::steady_clock::now() < deadline) {
+        bool same = primary.available_count(show) == replica.available_count(show);
+        for (int seat = 0; same && seat < HallLayout::kMaxRows * HallLayout::kMaxRowSeats; ++seat) {
+            same = primary.seat_owner(show, seat) == replica.seat_owner(show, seat);
+        }
+        if (same) return true;
+        std::this_thread::sleep_for(1ms);
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(Replication, ReplicaAppliesThePrimarysJournal) {
+    const std::string path = temp_path("replication_primary.jrnl");
+    BookingService primary(HallLayout::uniform(4, 10));
+    ASSERT_EQ(primary.open_journal(path, JournalMode::Sync), JournalStatus::Ok);
+    const ShowId show = primary.find_show(1, 1);
+    const BookingResult early = primary.book_seats(show, {"a1", "a2"});
+    ASSERT_TRUE(early.success);
+
+    ReplicationSource source(path, fast_options());
+    ASSERT_EQ(source.listen(), ReplicationStatus::Ok);
+    BookingService replica(HallLayout::uniform(4, 10));
+    ReplicaClient client(replica, fast_options());
+    ASSERT_EQ(client.start("127.0.0.1", source.port()), ReplicationStatus::Ok);
+
+    // History first, then live bookings, group bookings and cancellations
+    ASSERT_TRUE(converges(primary, replica, show));
+    const BookingResult group = primary.book_seats(show, {"b3", "c3", "d3"});
+    ASSERT_TRUE(group.success);
+    ASSERT_TRUE(primary.cancel_seats(show, {"a1"}, static_cast<BookingId>(early.id)).success);
+    ASSERT_TRUE(converges(primary, replica, show));
+    EXPECT_EQ(replica.seat_owner(show, HallLayout::seat_index(3, 2)), group.id);
+    EXPECT_EQ(replica.available_count(show), 36);
+    EXPECT_TRUE(client.connected());
+    EXPECT_EQ(source.replica_count(), 1u);
+    EXPECT_EQ(client.applied_records(), 3u);
+
+    // Heartbeats keep an idle replica fresh
+    std::this_thread::sleep_for(20ms);
+    EXPECT_TRUE(client.fresh(1s));
+    EXPECT_GT(client.next_lsn(), 0u);
+}
+
+TEST(Replication, ResumesFromItsLastRecordAfterAReconnect) {
+    const std::string path = temp_path("replication_resume.jrnl");
+    BookingService primary(HallLayout::uniform(2, 10));
+    ASSERT_EQ(primary.open_journal(path, JournalMode::Sync), JournalStatus::Ok);
+    const ShowId show = primary.find_show(1, 1);
+
+    ReplicationSource source(path, fast_options());
+    ASSERT_EQ(source.listen(), ReplicationStatus::Ok);
+    BookingService replica(HallLayout::uniform(2, 10));
+    ReplicaClient client(replica, fast_options());
+    EXPECT_EQ(client.staleness(), std::chrono::nanoseconds::max());
+    ASSERT_EQ(client.start("127.0.0.1", source.port()), ReplicationStatus::Ok);
+    ASSERT_TRUE(primary.book_seats(show, {"a1"}).success);
+    ASSERT_TRUE(converges(primary, replica, show));
+    client.stop();
+    EXPECT_FALSE(client.connected());
+
+    ASSERT_TRUE(primary.book_seats(show, {"b1", "b2"}).success);
+    ASSERT_EQ(client.start("127.0.0.1", source.port(), client.next_lsn()), ReplicationStatus::Ok);
+    ASSERT_TRUE(converges(primary, replica, show));
+    EXPECT_EQ(client.applied_records(), 2u); // a1 was not shipped again
+
+    // A replica without a primary to talk to fails to start
+    ReplicaClient orphan(replica, fast_options());
+    source.stop();
+    EXPECT_EQ(orphan.start("127.0.0.1", source.port()), ReplicationStatus::ConnectError);
+}
+
+TEST(Replication, ShipperFollowsACompactedJournal) {
+    const std::string path = temp_path("replication_compact.jrnl");
+    BookingService primary(HallLayout::uniform(2, 10));
+    // Mapped: the shipper also has to stop at the zero-filled end of the preallocated file
+    ASSERT_EQ(primary.open_journal(path, JournalMode::Sync, booking::JournalBackend::Mapped), JournalStatus::Ok);
+    const ShowId show = primary.find_show(1, 1);
+
+    ReplicationSource source(path, fast_options());
+    ASSERT_EQ(source.listen(), ReplicationStatus::Ok);
+    BookingService replica(HallLayout::uniform(2, 10));
+    ReplicaClient client(replica, fast_options());
+    ASSERT_EQ(client.start("127.0.0.1", source.port()), ReplicationStatus::Ok);
+    ASSERT_TRUE(primary.book_seats(show, {"a1"}).success);
+    ASSERT_TRUE(primary.book_seats(show, {"a2"}).success);
+    ASSERT_TRUE(converges(primary, replica, show));
+
+    ASSERT_EQ(primary.compact_journal(client.next_lsn()), JournalStatus::Ok);
+    ASSERT_TRUE(primary.book_seats(show, {"b1", "b2"}).success);
+    ASSERT_TRUE(converges(primary, replica, show));
+    EXPECT_EQ(client.applied_records(), 3u); // the kept newest record was not shipped again
+}
+
+TEST(Replication, ReadOnlyHandlersRefuseBookings) {
+    BookingService svc;
+    booking::TextCommandHandler text(svc);
+    text.set_read_only(true);
+    std::string out;
+    text.execute("book 1 1 a1", out);
+    EXPECT_EQ(out, "ERR 18 Read-only replica, book on the primary\n");
+    out.clear();
+    text.execute("seats 1 1", out);
+    EXPECT_EQ(out.substr(out.size() - 6), "OK 20\n");
+
+    booking::WireCommandHandler wire(svc);
+    wire.set_read_only(true);
+    std::string frames;
+    booking::encode_request(frames, booking::WireOp::BookBest, svc.find_show(1, 1), 7, 2);
+    booking::encode_request(frames, booking::WireOp::AvailableCount, svc.find_show(1, 1), 8);
+    std::string responses;
+    ASSERT_EQ(wire.execute(frames.data(), frames.size(), responses), static_cast<std::ptrdiff_t>(frames.size()));
+    booking::WireResponse r;
+    ASSERT_TRUE(booking::decode_response(responses.data(), responses.size(), r));
+    EXPECT_EQ(r.status, BookingStatus::ReadOnlyReplica);
+    ASSERT_TRUE(booking::decode_response(responses.data() + booking::kWireResponseSize,
+                                         responses.size() - booking::kWireResponseSize, r));
+    EXPECT_EQ(r.value, 20);
+}
+
+TEST(Replication, QuorumCommitWaitsForAReplicaAcknowledgement) {
+    const std::string path = temp_path("replication_quorum.jrnl");
+    const std::string mirror = temp_path("replication_quorum_mirror.jrnl");
+    BookingService primary(HallLayout::uniform(4, 10));
+    ASSERT_EQ(primary.open_journal(path, JournalMode::Sync), JournalStatus::Ok);
+    ReplicationOptions quorum = fast_options();
+    quorum.sync_replicas = 1;
+    ReplicationSource source(path, quorum);
+    ASSERT_EQ(source.listen(), ReplicationStatus::Ok);
+    ASSERT_TRUE(primary.set_journal_commit_wait([&](std::uint64_t lsn) { return source.wait_committed(lsn); }));
+    const ShowId show = primary.find_show(1, 1);
+
+    // No replica yet: the booking took effect but is not acknowledged
+    std::atomic<bool> done{false};
+    BookingResult first;
+    std::thread booker([&] {
+        first = primary.book_seats(show, {"a1", "a2"});
+        done.store(true);
+    });
+    std::this_thread::sleep_for(30ms);
+    EXPECT_FALSE(done.load());
+
+    BookingService replica(HallLayout::uniform(4, 10));
+    ReplicationOptions durable = fast_options();
+    durable.journal_path = mirror;
+    ReplicaClient client(replica, durable);
+    ASSERT_EQ(client.start("127.0.0.1", source.port()), ReplicationStatus::Ok);
+    booker.join();
+    ASSERT_TRUE(first.success);
+    EXPECT_GT(source.committed_lsn(), 0u);
+
+    // Concurrent bookings share frames and replica syncs; each is durable on the replica once acknowledged
+    std::thread bookers[4];
+    for (int t = 0; t < 4; ++t) {
+        bookers[t] = std::thread([&, t] {
+            for (int i = 0; i < 8; ++i) {
+                const std::string seat = std::string(1, static_cast<char>('a' + t)) + std::to_string(3 + i);
+                EXPECT_TRUE(primary.book_seats(show, {seat}).success) << seat;
+            }
+        });
+    }
+    for (std::thread& t : bookers) t.join();
+    BookingService restored(HallLayout::uniform(4, 10));
+    const booking::JournalReplay replay = restored.replay_journal(mirror);
+    EXPECT_EQ(replay.applied, 33u);
+    EXPECT_EQ(restored.seat_owner(show, 1), first.id);
+    EXPECT_EQ(restored.available_count(show), primary.available_count(show));
+}
+
+TEST(Replication, PromotedReplicaKeepsEveryAcknowledgedBooking) {
+    const std::string path = temp_path("replication_failover.jrnl");
+    const std::string mirror = temp_path("replication_failover_mirror.jrnl");
+    BookingService replica(HallLayout::uniform(2, 10));
+    ReplicationOptions durable = fast_options();
+    durable.journal_path = mirror;
+    ReplicaClient client(replica, durable);
+    const ShowId show = replica.find_show(1, 1);
+    BookingId acknowledged[3] = {};
+    {
+        BookingService primary(HallLayout::uniform(2, 10));
+        ASSERT_EQ(primary.open_journal(path, JournalMode::Sync), JournalStatus::Ok);
+        ReplicationOptions quorum = fast_options();
+        quorum.sync_replicas = 1;
+        ReplicationSource source(path, quorum);
+        ASSERT_EQ(source.listen(), ReplicationStatus::Ok);
+        primary.set_journal_commit_wait([&](std::uint64_t lsn) { return source.wait_committed(lsn); });
+        ASSERT_EQ(client.start("127.0.0.1", source.port()), ReplicationStatus::Ok);
+        const char* seats[] = {"a1", "a2", "b5"};
+        for (int i = 0; i < 3; ++i) acknowledged[i] = primary.book_seats(show, {seats[i]}).id;
+    } // the primary is lost
+    client.stop();
+
+    // The replica's mirror is a journal: the promoted server replays it and continues
+    BookingService promoted(HallLayout::uniform(2, 10));
+    EXPECT_EQ(promoted.replay_journal(mirror).applied, 3u);
+    ASSERT_EQ(promoted.open_journal(mirror, JournalMode::Sync), JournalStatus::Ok);
+    EXPECT_EQ(promoted.seat_owner(show, 0), acknowledged[0]);
+    EXPECT_EQ(promoted.seat_owner(show, HallLayout::seat_index(1, 4)), acknowledged[2]);
+    const BookingResult next = promoted.book_seats(show, {"a3"});
+    ASSERT_TRUE(next.success);
+    EXPECT_GT(next.id, acknowledged[2]);
+}
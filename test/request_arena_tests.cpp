@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "request_arena.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string_view>
+#include <vector>
+
+using booking::BookingRequest;
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::RequestArena;
+using booking::ShowId;
+using booking::Span;
+
+namespace {
+
+/** @brief Global operator new calls made by this thread while counting is on. */
+thread_local bool counting = false;
+thread_local std::size_t heap_allocations = 0;
+
+/** @brief Upstream resource that counts the blocks an arena spills. */
+class CountingResource : public std::pmr::memory_resource {
+public:
+    std::size_t allocations = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (counting) ++heap_allocations;
+    if (void* p = std::malloc(size != 0u ? size : 1u)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+TEST(RequestArena, OutermostScopeRewindsTheBuffer) {
+    CountingResource upstream;
+    RequestArena arena(1024, &upstream);
+    void* first = nullptr;
+    {
+        RequestArena::Scope outer(arena);
+        first = outer.resource()->allocate(64);
+        {
+            RequestArena::Scope inner(arena); // nested: must not free the outer allocation
+            void* second = inner.resource()->allocate(64); // used: allocate is [[nodiscard]]
+            EXPECT_GE(static_cast<char*>(second) - static_cast<char*>(first), 64);
+        }
+        void* third = outer.resource()->allocate(64);
+        EXPECT_NE(third, first);
+        EXPECT_GE(static_cast<char*>(third) - static_cast<char*>(first), 128);
+    }
+    RequestArena::Scope next(arena);
+    EXPECT_EQ(next.resource()->allocate(64), first); // rewound to the start of the buffer
+    EXPECT_EQ(upstream.allocations, 0u);
+}
+
+TEST(RequestArena, LargeRequestsSpillAndAreReturnedAtRewind) {
+    CountingResource upstream;
+    RequestArena arena(256, &upstream);
+    for (int request = 0; request < 3; ++request) {
+        RequestArena::Scope scope(arena);
+        std::pmr::vector<int> big(1000, 0, scope.resource());
+        EXPECT_EQ(big.size(), 1000u);
+    }
+    EXPECT_EQ(upstream.allocations, 3u); // one spill per request; nothing kept between them
+}
+
+TEST(RequestArena, SteadyStateBatchesDoNotTouchTheHeap) {
+    BookingService svc;
+    const ShowId show = svc.find_show(1, 1);
+    const std::array<std::string_view, 2> first{"a1", "a2"};
+    const std::array<std::string_view, 1> taken{"a2"};
+    const std::array<std::string_view, 1> bad{"z99"};
+    const std::array<BookingRequest, 3> requests{
+        {{show, Span<const std::string_view>(first)},
+         {show, Span<const std::string_view>(taken)},
+         {show, Span<const std::string_view>(bad)}}};
+    std::array<BookingResult, 3> results;
+
+    EXPECT_EQ(svc.book_seats_batch(requests, results), 1u); // warm-up: creates the thread's arena
+    EXPECT_TRUE(results[0].success);
+    EXPECT_EQ(results[1].status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(results[2].status, BookingStatus::InvalidSeatLabel);
+    EXPECT_TRUE(svc.cancel_seat_labels(show, Span<const std::string_view>(first), results[0].id).success);
+
+    heap_allocations = 0;
+    counting = true;
+    const std::size_t booked = svc.book_seats_batch(requests, results);
+    const bool cancelled = svc.cancel_seat_labels(show, Span<const std::string_view>(first), results[0].id).success;
+    counting = false;
+    EXPECT_EQ(booked, 1u);
+    EXPECT_TRUE(cancelled);
+    EXPECT_EQ(heap_allocations, 0u);
+}
+
+TEST(RequestArena, CancelByLabelViewsChecksOwnership) {
+    BookingService svc;
+    const ShowId show = svc.find_show(1, 1);
+    const BookingResult booked = svc.book_seats(show, {"a5", "a6"});
+    ASSERT_TRUE(booked.success);
+    const std::array<std::string_view, 2> labels{"a5", "a6"};
+    const std::array<std::string_view, 1> bad{"a5x"};
+    EXPECT_EQ(svc.cancel_seat_labels(show, Span<const std::string_view>(labels), booked.id + 1u).status,
+              BookingStatus::NotOwner);
+    const BookingResult invalid = svc.cancel_seat_labels(show, Span<const std::string_view>(bad), booked.id);
+    EXPECT_EQ(invalid.status, BookingStatus::InvalidSeatLabel);
+    EXPECT_EQ(invalid.message(), "Invalid seat label: a5x");
+    EXPECT_EQ(svc.cancel_seat_labels(show, {}, booked.id).status, BookingStatus::NoSeats);
+    EXPECT_TRUE(svc.cancel_seat_labels(show, Span<const std::string_view>(labels), booked.id).success);
+    EXPECT_EQ(svc.available_count(show), 20);
+}
+
+TEST(RequestArena, ListingsCanLiveInTheArena) {
+    BookingService svc;
+    const ShowId show = svc.find_show(1, 1);
+    ASSERT_TRUE(svc.book_seats(show, {"a1"}).success);
+    CountingResource upstream;
+    RequestArena arena(RequestArena::kDefaultCapacity, &upstream);
+    RequestArena::Scope scope(arena);
+    const std::pmr::vector<std::pmr::string> free = svc.list_available_seats(show, scope.resource());
+    const std::vector<std::string> expected = svc.list_available_seats(show);
+    ASSERT_EQ(free.size(), expected.size());
+    for (std::size_t i = 0; i < free.size(); ++i) EXPECT_EQ(std::string_view(free[i]), expected[i]);
+    EXPECT_EQ(free.get_allocator().resource(), scope.resource());
+    EXPECT_EQ(upstream.allocations, 0u);
+}
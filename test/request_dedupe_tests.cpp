@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "request_dedupe.hpp"
+#include "sharded_booking_service.hpp"
+#include "wire_protocol.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::RequestDedupe;
+using booking::SeatMask;
+using booking::ShowId;
+
+TEST(RequestDedupe, ReplaysCompletedRequests) {
+    RequestDedupe table(std::chrono::nanoseconds(1000), 64);
+    RequestDedupe::Record record;
+    RequestDedupe::Ticket ticket;
+    ASSERT_EQ(table.claim(5, 11, 100, record, ticket), RequestDedupe::Claim::Owner);
+    RequestDedupe::Ticket other;
+    EXPECT_EQ(table.claim(5, 11, 150, record, other), RequestDedupe::Claim::InFlight);
+
+    table.complete(ticket, RequestDedupe::Record{77, 3, 2}, 200);
+    ASSERT_EQ(table.claim(5, 11, 300, record, other), RequestDedupe::Claim::Replay);
+    EXPECT_EQ(record.id, 77u);
+    EXPECT_EQ(record.status, 3u);
+    EXPECT_EQ(record.detail, 2);
+    EXPECT_EQ(table.claim(5, 12, 300, record, other), RequestDedupe::Claim::Mismatch);
+    EXPECT_EQ(table.claim(6, 11, 300, record, other), RequestDedupe::Claim::Owner);
+
+    const booking::DedupeStats stats = table.stats(300);
+    EXPECT_EQ(stats.replays, 1u);
+    EXPECT_EQ(stats.mismatches, 1u);
+    EXPECT_EQ(stats.entries, 2u);
+
+    // Past the TTL the id is forgotten and runs afresh
+    EXPECT_EQ(table.claim(5, 12, 1201, record, other), RequestDedupe::Claim::Owner);
+}
+
+TEST(RequestDedupe, AbandonedAndExpiredSlotsAreReused) {
+    RequestDedupe table(std::chrono::nanoseconds(1000), RequestDedupe::kProbe);
+    RequestDedupe::Record record;
+    RequestDedupe::Ticket ticket;
+    ASSERT_EQ(table.claim(1, 1, 0, record, ticket), RequestDedupe::Claim::Owner);
+    table.abandon(ticket);
+    EXPECT_EQ(table.claim(1, 1, 10, record, ticket), RequestDedupe::Claim::Owner);
+
+    // The table holds kProbe live ids; one more runs untracked until an entry expires
+    for (std::uint64_t id = 2; id <= RequestDedupe::kProbe; ++id) {
+        ASSERT_EQ(table.claim(id, 1, 20, record, ticket), RequestDedupe::Claim::Owner) << id;
+        table.complete(ticket, RequestDedupe::Record{id, 0, -1}, 20);
+    }
+    EXPECT_EQ(table.claim(100, 1, 30, record, ticket), RequestDedupe::Claim::Untracked);
+    EXPECT_EQ(table.stats(30).untracked, 1u);
+    EXPECT_EQ(table.claim(100, 1, 1021, record, ticket), RequestDedupe::Claim::Owner);
+    EXPECT_EQ(table.claim(~std::uint64_t{0}, 1, 1021, record, ticket), RequestDedupe::Claim::Untracked);
+}
+
+TEST(RequestDedupe, RetriedBookingGetsTheOriginalOutcome) {
+    BookingService svc(HallLayout::uniform(2, 10));
+    const ShowId show = svc.find_show(1, 1);
+    EXPECT_EQ(svc.request_dedupe(), nullptr);
+    svc.enable_request_dedupe();
+    ASSERT_NE(svc.request_dedupe(), nullptr);
+
+    const BookingResult first = svc.book_seats_once(42, show, {"a1", "a2"});
+    ASSERT_TRUE(first.success) << first.message();
+    const BookingResult retry = svc.book_seats_once(42, show, {"a1", "a2"});
+    EXPECT_TRUE(retry.success);
+    EXPECT_EQ(retry.id, first.id);
+    EXPECT_EQ(svc.available_count(show), 18);
+    EXPECT_EQ(svc.book_seats_once(42, show, {"a3"}).status, BookingStatus::RequestIdReused);
+
+    // Failures are remembered too, even once the seats come free
+    ASSERT_TRUE(svc.book_seats(show, {"b1"}).success);
+    EXPECT_EQ(svc.book_seats_once(43, show, {"b1"}).status, BookingStatus::AlreadyBooked);
+    ASSERT_TRUE(svc.cancel_seats(show, {"a1", "a2"}, first.id).success);
+    EXPECT_EQ(svc.book_seats_once(43, show, {"b1"}).status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(svc.request_dedupe()->stats(RequestDedupe::now_ns()).replays, 2u);
+
+    // Without a table the calls are plain bookings
+    BookingService plain(HallLayout::uniform(2, 10));
+    const ShowId plain_show = plain.find_show(1, 1);
+    EXPECT_TRUE(plain.book_seats_once(42, plain_show, {"a1"}).success);
+    EXPECT_EQ(plain.book_seats_once(42, plain_show, {"a1"}).status, BookingStatus::AlreadyBooked);
+}
+
+TEST(RequestDedupe, ConcurrentRepeatsBookOnce) {
+    booking::ShardedBookingService svc(2);
+    svc.enable_request_dedupe();
+    const ShowId show = svc.find_show(1, 1);
+    const int before = svc.available_count(show);
+    SeatMask seats;
+    seats.set(3);
+    seats.set(4);
+
+    std::vector<std::uint64_t> ids(4, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < ids.size(); ++t) {
+        threads.emplace_back([&, t] {
+            BookingResult r = svc.book_seat_mask_once(9, show, seats);
+            while (r.status == BookingStatus::RequestInFlight) {
+                std::this_thread::yield();
+                r = svc.book_seat_mask_once(9, show, seats);
+            }
+            EXPECT_TRUE(r.success) << r.message();
+            ids[t] = r.id;
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    for (const std::uint64_t id : ids) EXPECT_EQ(id, ids[0]);
+    EXPECT_EQ(svc.available_count(show), before - 2);
+}
+
+TEST(RequestDedupe, WireFlagMakesBookMaskIdempotent) {
+    BookingService svc;
+    svc.enable_request_dedupe();
+    booking::WireCommandHandler handler(svc);
+    SeatMask pair;
+    pair.set(4);
+    pair.set(5);
+    std::string in;
+    booking::encode_mask_request(in, booking::WireOp::BookMask, 1, 7, pair, 0, booking::kWireIdempotent);
+    booking::encode_mask_request(in, booking::WireOp::BookMask, 1, 7, pair, 0, booking::kWireIdempotent);
+    booking::encode_mask_request(in, booking::WireOp::BookMask, 1, 7, pair);
+
+    std::string out;
+    ASSERT_EQ(handler.execute(in.data(), in.size(), out), static_cast<std::ptrdiff_t>(in.size()));
+    ASSERT_EQ(out.size(), 3 * booking::kWireResponseSize);
+    booking::WireResponse rs[3];
+    for (std::size_t i = 0; i < 3; ++i) {
+        ASSERT_TRUE(booking::decode_response(out.data() + i * booking::kWireResponseSize, booking::kWireResponseSize,
+                                             rs[i]));
+    }
+    EXPECT_EQ(rs[0].status, BookingStatus::Ok);
+    EXPECT_EQ(rs[1].status, BookingStatus::Ok);
+    EXPECT_EQ(rs[1].id, rs[0].id);
+    EXPECT_EQ(rs[2].status, BookingStatus::AlreadyBooked); // no flag: a plain booking
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "sales_analytics.hpp"
+
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using booking::MovieId;
+using booking::SalesAnalytics;
+using booking::SalesAnalyticsOptions;
+
+TEST(SalesAnalytics, CountsTicketsPerMoviePerMinute) {
+    SalesAnalytics sales;
+    sales.record(1, 0, 2, 1000);
+    sales.record(1, 0, 3, 1000);
+    sales.record(2, 0, 4, 1000);
+    sales.record(1, 0, 1, 1001);
+
+    EXPECT_EQ(sales.tickets(1, 1000), 5u);
+    EXPECT_EQ(sales.tickets(2, 1000), 4u);
+    EXPECT_EQ(sales.tickets(1, 1001), 1u);
+    EXPECT_EQ(sales.tickets(2, 1001), 0u);
+    EXPECT_EQ(sales.tickets(3, 1000), 0u);
+    EXPECT_EQ(sales.tickets(1, 999), 0u);
+    EXPECT_EQ(sales.tickets_per_minute(1, 999, 1003), (std::vector<std::uint64_t>{0, 5, 1, 0}));
+    EXPECT_TRUE(sales.tickets_per_minute(1, 1003, 1003).empty());
+}
+
+TEST(SalesAnalytics, SlidingWindowRecyclesOldMinutes) {
+    SalesAnalyticsOptions options;
+    options.minutes = 4;
+    SalesAnalytics sales(options);
+    sales.record(1, 0, 2, 100);
+    sales.record(1, 0, 3, 103);
+    EXPECT_EQ(sales.tickets(1, 100), 2u);
+    sales.record(1, 0, 6, 104); // same slot as minute 100
+    EXPECT_EQ(sales.tickets(1, 100), 0u);
+    EXPECT_EQ(sales.tickets(1, 104), 6u);
+    sales.record(1, 0, 1, 100); // late sale of a minute already recycled: dropped
+    EXPECT_EQ(sales.tickets(1, 104), 6u);
+    EXPECT_EQ(sales.tickets(1, 103), 3u);
+}
+
+TEST(SalesAnalytics, CountMinNeverUndercounts) {
+    SalesAnalyticsOptions options;
+    options.width = 64;
+    SalesAnalytics sales(options);
+    std::mt19937 rng(11);
+    std::map<std::int64_t, std::uint64_t> truth;
+    std::uint64_t total = 0;
+    for (int i = 0; i < 5000; ++i) {
+        const std::int64_t movie = static_cast<std::int64_t>(rng() % 500u);
+        const std::uint32_t tickets = 1u + rng() % 4u;
+        sales.record(movie, 0, tickets, 7);
+        truth[movie] += tickets;
+        total += tickets;
+    }
+    std::uint64_t over = 0;
+    for (const auto& [movie, count] : truth) {
+        const std::uint64_t estimate = sales.tickets(movie, 7);
+        ASSERT_GE(estimate, count) << movie;
+        over += estimate - count;
+    }
+    // Expected overcount per movie is at most total / width
+    EXPECT_LT(over / truth.size(), total / options.width);
+}
+
+TEST(SalesAnalytics, DistinctCustomersMergeAcrossThreads) {
+    SalesAnalytics sales;
+    EXPECT_EQ(sales.distinct_customers(1), 0.0);
+    for (std::uint64_t c = 1; c <= 5; ++c) sales.record(1, c, 1, 50);
+    sales.record(1, 3, 1, 50); // repeat buyer
+    sales.record(1, 0, 1, 50); // anonymous sale
+    EXPECT_NEAR(sales.distinct_customers(1), 5.0, 0.5);
+
+    // Four threads selling to overlapping customer ranges: 1..20000 in total
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&sales, t] {
+            for (std::uint64_t c = 1; c <= 10000; ++c) sales.record(2, c + static_cast<std::uint64_t>(t) * 3333u, 2, 51);
+        });
+    }
+    for (auto& th : threads) th.join();
+    const double expected = 10000.0 + 3.0 * 3333.0;
+    EXPECT_NEAR(sales.distinct_customers(2), expected, 0.1 * expected);
+    EXPECT_EQ(sales.tickets(2, 51), 80000u);
+    EXPECT_NEAR(sales.distinct_customers(1), 5.0, 0.5);
+}
+
+TEST(SalesAnalytics, RejectsInvalidOptions) {
+    SalesAnalyticsOptions width;
+    width.width = 100;
+    EXPECT_THROW(SalesAnalytics{width}, std::invalid_argument);
+    SalesAnalyticsOptions precision;
+    precision.hll_precision = 3;
+    EXPECT_THROW(SalesAnalytics{precision}, std::invalid_argument);
+    SalesAnalyticsOptions minutes;
+    minutes.minutes = 0;
+    EXPECT_THROW(SalesAnalytics{minutes}, std::invalid_argument);
+}
+
+TEST(SalesAnalytics, ServiceTapsSuccessfulBookings) {
+    booking::BookingService svc;
+    EXPECT_EQ(svc.sales_analytics(), nullptr);
+    svc.enable_sales_analytics();
+    const SalesAnalytics* sales = svc.sales_analytics();
+    ASSERT_NE(sales, nullptr);
+
+    const std::int64_t from = SalesAnalytics::current_minute();
+    const booking::ShowId show = svc.find_show(1, 1);
+    {
+        const SalesAnalytics::CustomerScope customer(7);
+        ASSERT_TRUE(svc.book_seats(show, {"a1", "a2"}).success);
+        EXPECT_FALSE(svc.book_seats(show, {"a2"}).success); // not a sale
+    }
+    {
+        const SalesAnalytics::CustomerScope customer(8);
+        booking::SeatMask seats;
+        ASSERT_TRUE(svc.book_best_available(svc.find_show(1, 2), 3, seats).success);
+    }
+    ASSERT_TRUE(svc.book_seats(show, {"a5"}).success); // no customer
+
+    // A show added after the analytics were enabled
+    ASSERT_EQ(svc.add_show(booking::Show{500, 2, 1, 0, 0, 1}), booking::CatalogStatus::Ok);
+    ASSERT_TRUE(svc.book_seats(500, {"a1"}).success);
+    const std::int64_t to = SalesAnalytics::current_minute() + 1;
+
+    std::uint64_t movie1 = 0;
+    std::uint64_t movie2 = 0;
+    for (const std::uint64_t n : sales->tickets_per_minute(1, from, to)) movie1 += n;
+    for (const std::uint64_t n : sales->tickets_per_minute(2, from, to)) movie2 += n;
+    EXPECT_EQ(movie1, 6u);
+    EXPECT_EQ(movie2, 1u);
+    EXPECT_NEAR(sales->distinct_customers(1), 2.0, 0.5);
+    EXPECT_EQ(sales->distinct_customers(2), 0.0);
+    EXPECT_EQ(sales->movie_of(500), MovieId(2));
+    EXPECT_FALSE(sales->movie_of(999).valid());
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include "schedule_loader.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using booking::Schedule;
+using booking::ScheduleStatus;
+using booking::parse_schedule;
+
+TEST(ScheduleLoader, ParsesAllRecordKinds) {
+    const std::string text =
+        "# nightly export\n"
+        "movie,1,Inception\n"
+        "movie,2,\"Crouching Tiger, Hidden Dragon\"\n"
+        "theater,7,\"The \"\"Grand\"\"\"\r\n"
+        "\n"
+        "layout,1,3x12\n"
+        "layout,2,a:10|bb:12\n"
+        "show,100,1,7,2\n"
+        "show,101,1,7,1,1760464800,3";
+    Schedule s;
+    const auto err = parse_schedule(text, 1, s);
+    ASSERT_EQ(err.status, ScheduleStatus::Ok) << err.reason;
+
+    ASSERT_EQ(s.movies.size(), 2u);
+    EXPECT_EQ(s.movies[1].title, "Crouching Tiger, Hidden Dragon");
+    ASSERT_EQ(s.theaters.size(), 1u);
+    EXPECT_EQ(s.theaters[0].name, "The \"Grand\"");
+    ASSERT_EQ(s.layouts.size(), 2u);
+    EXPECT_EQ(s.layouts[0].layout.seat_count(), 36);
+    EXPECT_EQ(s.layouts[1].layout.row_label(1), "bb");
+    ASSERT_EQ(s.shows.size(), 2u);
+    EXPECT_EQ(s.shows[0].layout_id, 2);
+    EXPECT_EQ(s.shows[0].start_time, 0);
+    EXPECT_EQ(s.shows[1].start_time, 1760464800);
+    EXPECT_EQ(s.shows[1].hall, 3);
+}
+
+TEST(ScheduleLoader, ReportsFirstMalformedLine) {
+    const char* bad[] = {
+        "movie,x,Title",          // id
+        "movie,1",                // missing field
+        "movie,1,a,b",            // extra field
+        "show,1,2,3",             // missing layout
+        "layout,1,0x5",           // geometry
+        "layout,1,a:65",          // row too wide
+        "screening,1,2",          // kind
+        "movie,1,\"unterminated", // quote
+    };
+    for (const char* line : bad) {
+        Schedule s;
+        const auto err = parse_schedule(std::string("movie,9,Ok\n") + line + "\n", 1, s);
+        EXPECT_EQ(err.status, ScheduleStatus::ParseError) << line;
+        EXPECT_EQ(err.line, 2u) << line;
+    }
+}
+
+TEST(ScheduleLoader, ParallelChunksKeepOrderAndLineNumbers) {
+    std::string text;
+    constexpr int kShows = 40000; // well above the per-thread minimum chunk
+    for (int i = 0; i < kShows; ++i) text += "show," + std::to_string(i) + ",1,1,1\n";
+
+    Schedule s;
+    ASSERT_EQ(parse_schedule(text, 4, s).status, ScheduleStatus::Ok);
+    ASSERT_EQ(s.shows.size(), static_cast<std::size_t>(kShows));
+    for (int i = 0; i < kShows; ++i) ASSERT_EQ(s.shows[static_cast<std::size_t>(i)].id, i);
+
+    text += "show,bad\n";
+    for (int i = 0; i < 100; ++i) text += "show,1,1,1,1\n";
+    Schedule again;
+    const auto err = parse_schedule(text, 4, again);
+    EXPECT_EQ(err.status, ScheduleStatus::ParseError);
+    EXPECT_EQ(err.line, static_cast<std::size_t>(kShows + 1));
+}
+
+TEST(ScheduleLoader, MapsFiles) {
+    const std::string path = ::testing::TempDir() + "schedule_loader_test.csv";
+    {
+        std::ofstream out(path);
+        out << "movie,1,Dune\n";
+    }
+    booking::MappedFile file(path);
+    ASSERT_TRUE(file.ok());
+    EXPECT_EQ(file.view(), "movie,1,Dune\n");
+    std::remove(path.c_str());
+
+    booking::MappedFile missing(path);
+    EXPECT_FALSE(missing.ok());
+}
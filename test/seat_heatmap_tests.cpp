@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "seat_heatmap.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace heatmap = booking::seat_heatmap;
+
+namespace {
+
+std::vector<const heatmap::Kernels*> available_kernels() {
+    std::vector<const heatmap::Kernels*> out{&heatmap::scalar_kernels()};
+    if (heatmap::avx2_kernels()) out.push_back(heatmap::avx2_kernels());
+    return out;
+}
+
+constexpr booking::ShowTime kHour = 3600;
+
+} // namespace
+
+TEST(SeatHeatmap, KernelsCountColumnsLikeAPlainLoop) {
+    std::uint64_t x = 0x9E3779B97F4A7C15u;
+    for (std::size_t stride : {1u, 3u, 4u, 9u}) {
+        for (std::size_t n : {0u, 1u, 63u, 64u, 65u, 300u, 600u}) {
+            std::vector<std::uint64_t> words(n * stride);
+            for (std::size_t i = 0; i < words.size(); ++i) {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+                words[i] = i % 5u == 0u ? ~std::uint64_t{0} : x & (x >> 3); // full rows carry past plane 0
+            }
+            std::vector<std::uint32_t> expected(stride * 64u, 0u);
+            for (std::size_t s = 0; s < n; ++s) {
+                for (std::size_t w = 0; w < stride; ++w) {
+                    for (int c = 0; c < 64; ++c) expected[w * 64u + c] += (words[s * stride + w] >> c) & 1u;
+                }
+            }
+            for (const heatmap::Kernels* k : available_kernels()) {
+                std::vector<std::uint32_t> counts(stride * 64u, 1u); // added to, not overwritten
+                k->add_columns(words.data(), n, stride, counts.data());
+                for (std::size_t i = 0; i < counts.size(); ++i) {
+                    ASSERT_EQ(counts[i], expected[i] + 1u)
+                        << booking::seat_scan::to_string(k->isa) << " stride=" << stride << " n=" << n << " seat " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST(SeatHeatmap, SumsArchivedShowsOfTheLayout) {
+    booking::BookingService svc{booking::BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), booking::CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), booking::CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(3, 10));
+    const booking::LayoutId other = svc.add_layout(booking::HallLayout::uniform(2, 8));
+    for (std::int64_t id = 1; id <= 10; ++id) {
+        ASSERT_EQ(svc.add_show(booking::Show{id, 1, 1, id <= 8 ? hall : other, id * kHour}), booking::CatalogStatus::Ok);
+        ASSERT_TRUE(svc.book_seats(id, {"a1"}).success);
+        if (id % 2 == 0 && id <= 8) {
+            ASSERT_TRUE(svc.book_seats(id, {"c10", "b5"}).success);
+        }
+    }
+    EXPECT_EQ(svc.seat_heatmap(hall).shows, 0u); // nothing has played yet
+    ASSERT_EQ(svc.archive_shows_before(11 * kHour), 10u);
+
+    const booking::SeatHeatmap map = svc.seat_heatmap(hall);
+    ASSERT_EQ(map.shows, 8u);
+    ASSERT_EQ(map.counts.size(), 3u * booking::HallLayout::kMaxRowSeats);
+    EXPECT_EQ(map.counts[static_cast<std::size_t>(booking::HallLayout::seat_index(0, 0))], 8u);
+    EXPECT_EQ(map.counts[static_cast<std::size_t>(booking::HallLayout::seat_index(2, 9))], 4u);
+    EXPECT_EQ(map.counts[static_cast<std::size_t>(booking::HallLayout::seat_index(1, 4))], 4u);
+    EXPECT_EQ(map.counts[static_cast<std::size_t>(booking::HallLayout::seat_index(1, 5))], 0u);
+    EXPECT_DOUBLE_EQ(map.frequency(booking::HallLayout::seat_index(2, 9)), 0.5);
+
+    // A time window, and the other hall's shows
+    EXPECT_EQ(svc.seat_heatmap(hall, 1 * kHour, 4 * kHour).shows, 3u);
+    EXPECT_EQ(svc.seat_heatmap(other).shows, 2u);
+    EXPECT_TRUE(svc.seat_heatmap(99).counts.empty());
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include "seat_label.hpp"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace seat_label = booking::seat_label;
+
+TEST(SeatLabelTokenizer, RowCodes) {
+    EXPECT_EQ(seat_label::row_code("a"), 1u);
+    EXPECT_EQ(seat_label::row_code("Z"), 26u);
+    EXPECT_EQ(seat_label::row_code("aa"), 27u);
+    EXPECT_EQ(seat_label::row_code("aB"), 28u);
+    EXPECT_EQ(seat_label::row_code(""), 0u);
+    EXPECT_EQ(seat_label::row_code("a1"), 0u);
+    EXPECT_EQ(seat_label::row_code("abcdefg"), 0u);
+}
+
+TEST(SeatLabelTokenizer, SplitsRowAndNumber) {
+    std::uint32_t code = 0;
+    int num = 0;
+    ASSERT_TRUE(seat_label::split("ab12", code, num));
+    EXPECT_EQ(code, seat_label::row_code("ab"));
+    EXPECT_EQ(num, 12);
+
+    ASSERT_TRUE(seat_label::split("C007", code, num));
+    EXPECT_EQ(num, 7);
+}
+
+TEST(SeatLabelTokenizer, RejectsMalformedInput) {
+    std::uint32_t code = 0;
+    int num = 0;
+    for (const char* bad : {"", "a", "12", "a-1", "a+1", "a 1", " a1", "a1 ", "a1x", "a\xc3\xa9" "1",
+                            "a99999999999999999999", "abcdefg1"}) {
+        EXPECT_FALSE(seat_label::split(bad, code, num)) << bad;
+    }
+    // Embedded NUL is part of the view and must not terminate parsing early
+    EXPECT_FALSE(seat_label::split(std::string_view("a1\0", 3), code, num));
+}
+
+namespace {
+
+struct Scanned {
+    std::string label;
+    std::uint32_t code;
+    int number;
+};
+
+std::vector<Scanned> scan(std::string_view list) {
+    std::vector<Scanned> out;
+    seat_label::scan_list(list, [&](std::string_view label, std::uint32_t code, int number) {
+        out.push_back(Scanned{std::string(label), code, code != 0u ? number : 0});
+        return true;
+    });
+    return out;
+}
+
+} // namespace
+
+TEST(SeatLabelTokenizer, ScansListsLikeSplit) {
+    // Labels straddling the 64-byte blocks, long and malformed ones, runs of separators
+    std::string list = " \ta1  ";
+    for (int i = 0; i < 40; ++i) list += "ab" + std::to_string(i) + (i % 3 == 0 ? "\t" : " ");
+    list += "a-1 C007 a99999999999999999999 a0000000000012 x " + std::string(70, 'b') + "1 abcdefg1 z9";
+
+    std::vector<std::string> expected;
+    std::vector<std::string_view> tokens;
+    std::size_t pos = 0;
+    while (pos < list.size()) {
+        const std::size_t start = list.find_first_not_of(" \t", pos);
+        if (start == std::string::npos) break;
+        const std::size_t end = std::min(list.find_first_of(" \t", start), list.size());
+        expected.push_back(list.substr(start, end - start));
+        pos = end;
+    }
+
+    const std::vector<Scanned> got = scan(list);
+    ASSERT_EQ(got.size(), expected.size());
+    for (std::size_t i = 0; i < got.size(); ++i) {
+        std::uint32_t code = 0;
+        int number = 0;
+        const bool ok = seat_label::split(expected[i], code, number);
+        EXPECT_EQ(got[i].label, expected[i]);
+        EXPECT_EQ(got[i].code, ok ? code : 0u) << expected[i];
+        if (ok) {
+            EXPECT_EQ(got[i].number, number) << expected[i];
+        }
+    }
+    EXPECT_EQ(got.back().label, "z9");
+    EXPECT_EQ(got.back().number, 9);
+}
+
+TEST(SeatLabelTokenizer, ScanStopsWhenAsked) {
+    int seen = 0;
+    seat_label::scan_list("a1 a2 a3", [&](std::string_view, std::uint32_t, int) { return ++seen < 2; });
+    EXPECT_EQ(seen, 2);
+    EXPECT_TRUE(scan("").empty());
+    EXPECT_TRUE(scan(" \t ").empty());
+}
+
+namespace {
+
+constexpr int number_of(std::string_view label) {
+    std::uint32_t code = 0;
+    int number = 0;
+    return seat_label::split_as<seat_label::SeatRow>(label, code, number) ? number : -1;
+}
+
+// The grammar parsers are constexpr: a label grammar is checked at compile time
+static_assert(number_of("12c") == 12, "SeatRow parses number then row");
+static_assert(number_of("c12") == -1, "SeatRow rejects row-first labels");
+
+} // namespace
+
+TEST(SeatLabelTokenizer, GrammarsSplitAndFormatTheirOwnLabels) {
+    std::uint32_t code = 0;
+    int num = 0;
+    ASSERT_TRUE(seat_label::split_as<seat_label::SeatRow>("7AB", code, num));
+    EXPECT_EQ(code, seat_label::row_code("ab"));
+    EXPECT_EQ(num, 7);
+    ASSERT_TRUE(seat_label::split_as<seat_label::RowDashSeat>("balc-3", code, num));
+    EXPECT_EQ(code, seat_label::row_code("balc"));
+    EXPECT_EQ(num, 3);
+    for (const char* bad : {"balc3", "balc-", "-3", "balc--3", "3-balc", "balc-3x"}) {
+        EXPECT_FALSE(seat_label::split_as<seat_label::RowDashSeat>(bad, code, num)) << bad;
+    }
+    for (const char* bad : {"12", "c", "c12", "12c3", "1 2c"}) {
+        EXPECT_FALSE(seat_label::split_as<seat_label::SeatRow>(bad, code, num)) << bad;
+    }
+
+    char out[16];
+    EXPECT_EQ(std::string(out, seat_label::format_as<seat_label::RowSeat>("c", 12, out)), "c12");
+    EXPECT_EQ(std::string(out, seat_label::format_as<seat_label::SeatRow>("ab", 7, out)), "7ab");
+    EXPECT_EQ(std::string(out, seat_label::format_as<seat_label::RowDashSeat>("balc", 64, out)), "balc-64");
+    EXPECT_EQ(seat_label::splitter(seat_label::LabelGrammar::SeatRow), &seat_label::split_as<seat_label::SeatRow>);
+}
+
+TEST(SeatLabelTokenizer, ScansListsInOtherGrammars) {
+    std::vector<std::pair<std::uint32_t, int>> got;
+    seat_label::scan_list<seat_label::RowDashSeat>("c-1 balc-12\tc1", [&](std::string_view, std::uint32_t code,
+                                                                          int number) {
+        got.emplace_back(code, code != 0u ? number : 0);
+        return true;
+    });
+    ASSERT_EQ(got.size(), 3u);
+    EXPECT_EQ(got[0], std::make_pair(seat_label::row_code("c"), 1));
+    EXPECT_EQ(got[1], std::make_pair(seat_label::row_code("balc"), 12));
+    EXPECT_EQ(got[2].first, 0u); // row-first without the dash is malformed here
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "seat_map_client.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::HallLayout;
+using booking::SeatMapClient;
+using booking::SeatMask;
+using booking::SubscribeStatus;
+
+TEST(SeatMapClient, MirrorsReadsAndAppliesDiffs) {
+    BookingService svc(HallLayout::uniform(3, 10));
+    const booking::ShowId show = svc.find_show(1, 1);
+    SeatMapClient client(svc);
+    EXPECT_EQ(client.subscribe(show), SubscribeStatus::NoFeed);
+    svc.enable_change_feed(1u << 6);
+    ASSERT_TRUE(svc.book_seats(show, {"a1"}).success); // before the snapshot
+    EXPECT_EQ(client.subscribe(999), SubscribeStatus::UnknownShow);
+    ASSERT_EQ(client.subscribe(show), SubscribeStatus::Ok);
+    EXPECT_EQ(client.available_count(show), 29);
+    EXPECT_EQ(client.layout_for_show(show)->row_count(), 3);
+
+    const auto a = svc.book_seats(show, {"b2", "c10"});
+    ASSERT_TRUE(a.success);
+    const auto b = svc.book_seats(show, {"a3"});
+    ASSERT_TRUE(svc.cancel_seats(show, {"a3"}, static_cast<booking::BookingId>(b.id)).success);
+    EXPECT_EQ(client.available_count(show), 29); // not synced yet
+    EXPECT_EQ(client.sync(), 2u);
+    EXPECT_EQ(client.available_count(show), svc.available_count(show));
+    EXPECT_EQ(client.list_available_seats(show), svc.list_available_seats(show));
+    EXPECT_EQ(client.sync(), 0u);
+
+    // More changes than the ring holds: the show is fetched again
+    for (int i = 0; i < 40; ++i) {
+        const auto r = svc.book_seats(show, {"b5"});
+        ASSERT_TRUE(svc.cancel_seats(show, {"b5"}, static_cast<booking::BookingId>(r.id)).success);
+    }
+    ASSERT_TRUE(svc.cancel_seats(show, {"b2"}, static_cast<booking::BookingId>(a.id)).success);
+    EXPECT_EQ(client.sync(), 1u);
+    EXPECT_EQ(client.resyncs(), 1u);
+    SeatMask mirrored;
+    SeatMask server;
+    EXPECT_EQ(client.available_seats_mask(show, mirrored), svc.available_seats_mask(show, server));
+    for (int w = 0; w < 3; ++w) EXPECT_EQ(mirrored.word(w), server.word(w)) << "row " << w;
+
+    client.unsubscribe(show);
+    EXPECT_FALSE(client.subscribed(show));
+    EXPECT_EQ(client.available_count(show), -1);
+    EXPECT_TRUE(client.list_available_seats(show).empty());
+}
+
+TEST(SeatMapClient, ReachesTheServerOnlyThroughItsTwoCalls) {
+    BookingService svc(HallLayout::uniform(2, 8));
+    svc.enable_change_feed(1u << 6);
+    int snapshots = 0;
+    int diffs = 0;
+    SeatMapClient client(
+        [&](booking::ShowId show_id, booking::SeatMapSnapshot& out) {
+            ++snapshots;
+            if (svc.availability_snapshot(show_id, out.free, out.position) < 0) return false;
+            out.layout = std::make_shared<const HallLayout>(*svc.layout_for_show(show_id));
+            return true;
+        },
+        [&](booking::ShowId show_id, std::uint64_t since) {
+            ++diffs;
+            return svc.availability_diff(show_id, since);
+        });
+    ASSERT_EQ(client.subscribe(1), SubscribeStatus::Ok);
+    ASSERT_EQ(client.subscribe(1), SubscribeStatus::Ok); // already mirrored
+    ASSERT_TRUE(svc.book_seats(1, {"b8"}).success);
+    client.sync();
+    client.sync();
+    EXPECT_EQ(snapshots, 1);
+    EXPECT_EQ(diffs, 2);
+    EXPECT_EQ(client.list_available_seats(1).size(), 15u);
+    EXPECT_STREQ(booking::to_string(SubscribeStatus::NoFeed), "Change feed not enabled");
+}
+
+class SeatMapClientLanes : public ::testing::TestWithParam<std::size_t> {};
+
+TEST_P(SeatMapClientLanes, ConvergesWhileWritersRace) {
+    BookingService svc(HallLayout::uniform(4, 64));
+    svc.enable_change_feed(1u << 16, GetParam());
+    const booking::ShowId show = svc.find_show(1, 1);
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 3; ++t) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < 2000; ++i) {
+                SeatMask seats;
+                const auto r = svc.book_best_available(show, 1 + (i + t) % 3, seats);
+                if (r.success && i % 2 == 0) svc.cancel_seat_mask(show, seats, static_cast<booking::BookingId>(r.id));
+            }
+        });
+    }
+    // Subscribing mid-stream: the snapshot may already hold changes the first diffs repeat
+    SeatMapClient client(svc);
+    ASSERT_EQ(client.subscribe(show), SubscribeStatus::Ok);
+    std::thread reader([&] {
+        while (!done.load()) client.sync();
+    });
+    for (auto& w : writers) w.join();
+    done.store(true);
+    reader.join();
+    client.sync();
+
+    SeatMask mirrored;
+    SeatMask server;
+    EXPECT_EQ(client.available_seats_mask(show, mirrored), svc.available_seats_mask(show, server));
+    for (int w = 0; w < 4; ++w) EXPECT_EQ(mirrored.word(w), server.word(w)) << "row " << w;
+    EXPECT_EQ(client.resyncs(), 0u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Lanes, SeatMapClientLanes, ::testing::Values(std::size_t{1}, std::size_t{4}));
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include "seat_map_codec.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using booking::BookingId;
+using booking::decode_seat_map;
+using booking::encode_seat_map;
+
+namespace {
+
+constexpr int kRows = 20;
+constexpr std::uint64_t kRowMask = (std::uint64_t{1} << 30) - 1u; // 30 seats per row
+
+struct SeatMap {
+    std::array<std::uint64_t, kRows> words{};
+    std::array<std::uint64_t, kRows> masks{};
+    std::vector<BookingId> owners = std::vector<BookingId>(64u * kRows);
+
+    SeatMap() { masks.fill(kRowMask); }
+
+    void book(int row, int col, BookingId id) {
+        words[static_cast<std::size_t>(row)] |= std::uint64_t{1} << col;
+        owners[static_cast<std::size_t>(row) * 64u + static_cast<std::size_t>(col)] = id;
+    }
+
+    std::vector<std::uint8_t> encode() const {
+        std::vector<std::uint8_t> out;
+        encode_seat_map(words.data(), masks.data(), kRows, owners.data(), out);
+        return out;
+    }
+
+    /** @brief Decodes @p bytes and checks it reproduces this map exactly. */
+    void expect_round_trip(const std::vector<std::uint8_t>& bytes) const {
+        std::array<std::uint64_t, kRows> back{};
+        std::vector<BookingId> back_owners(64u * kRows);
+        ASSERT_TRUE(decode_seat_map(bytes.data(), bytes.size(), masks.data(), kRows, back.data(), back_owners.data()));
+        EXPECT_EQ(back, words);
+        for (int r = 0; r < kRows; ++r) {
+            for (std::uint64_t b = words[static_cast<std::size_t>(r)]; b != 0u; b &= b - 1u) {
+                const std::size_t at = static_cast<std::size_t>(r) * 64u + static_cast<std::size_t>(__builtin_ctzll(b));
+                EXPECT_EQ(back_owners[at], owners[at]);
+            }
+        }
+    }
+};
+
+/** @brief Bytes of the raw words and a 64-entry owner row per row. */
+constexpr std::size_t kRawBytes = kRows * (8u + 64u * sizeof(BookingId));
+
+} // namespace
+
+TEST(SeatMapCodec, EmptyHallTakesOneByte) {
+    const SeatMap map;
+    const std::vector<std::uint8_t> bytes = map.encode();
+    EXPECT_EQ(bytes.size(), 1u);
+    map.expect_round_trip(bytes);
+}
+
+TEST(SeatMapCodec, SoldOutHallEncodesRowsAndBookingRuns) {
+    SeatMap map;
+    // Groups of 5 adjacent seats, booked in id order
+    BookingId id = 1000;
+    for (int r = 0; r < kRows; ++r) {
+        for (int c = 0; c < 30; ++c) map.book(r, c, id + static_cast<BookingId>(c / 5));
+        id += 6;
+    }
+    const std::vector<std::uint8_t> bytes = map.encode();
+    map.expect_round_trip(bytes);
+    // One tag for the rows, about two bytes per booking for the owners
+    EXPECT_LT(bytes.size(), 3u * 120u);
+    EXPECT_LT(bytes.size() * 10u, kRawBytes);
+}
+
+TEST(SeatMapCodec, PicksAContainerPerRow) {
+    SeatMap map;
+    map.book(0, 3, 7);               // sparse: listed seats
+    map.book(0, 29, 8);
+    for (int c = 0; c < 30; ++c) {   // nearly full: holes
+        if (c != 12) map.book(1, c, 9);
+    }
+    for (int c = 0; c < 30; c += 2) map.book(2, c, 10 + static_cast<BookingId>(c)); // half full: raw word
+    for (int c = 0; c < 30; ++c) map.book(5, c, 1);                                 // full, alone
+    const std::vector<std::uint8_t> bytes = map.encode();
+    map.expect_round_trip(bytes);
+    EXPECT_LT(bytes.size(), kRawBytes / 10u);
+}
+
+TEST(SeatMapCodec, MasksWithFewerSeatsPerRow) {
+    SeatMap map;
+    map.masks[3] = 0x3Fu; // a 6-seat row
+    for (int c = 0; c < 6; ++c) map.book(3, c, 42);
+    const std::vector<std::uint8_t> bytes = map.encode();
+    map.expect_round_trip(bytes);
+    // Full means full for the row masks it was written with; others fail the owner check
+    std::array<std::uint64_t, kRows> wider = map.masks;
+    wider[3] = 0xFFu;
+    EXPECT_FALSE(decode_seat_map(bytes.data(), bytes.size(), wider.data(), kRows, nullptr, nullptr));
+}
+
+TEST(SeatMapCodec, RejectsMalformedInput) {
+    SeatMap map;
+    map.book(4, 1, 5);
+    map.book(4, 2, 6);
+    std::vector<std::uint8_t> bytes = map.encode();
+    ASSERT_TRUE(decode_seat_map(bytes.data(), bytes.size(), map.masks.data(), kRows, nullptr, nullptr));
+
+    // Truncated, trailing bytes, too many rows, a seat outside its row
+    EXPECT_FALSE(decode_seat_map(bytes.data(), bytes.size() - 1u, map.masks.data(), kRows, nullptr, nullptr));
+    std::vector<std::uint8_t> longer = bytes;
+    longer.push_back(0);
+    EXPECT_FALSE(decode_seat_map(longer.data(), longer.size(), map.masks.data(), kRows, nullptr, nullptr));
+    EXPECT_FALSE(decode_seat_map(bytes.data(), bytes.size(), map.masks.data(), kRows - 1, nullptr, nullptr));
+    std::array<std::uint64_t, kRows> narrow = map.masks;
+    narrow[4] = 0x1u;
+    EXPECT_FALSE(decode_seat_map(bytes.data(), bytes.size(), narrow.data(), kRows, nullptr, nullptr));
+    EXPECT_FALSE(decode_seat_map(nullptr, 0u, map.masks.data(), kRows, nullptr, nullptr));
+}
+
+TEST(SeatMapCodec, VarintsAndZigzag) {
+    std::vector<std::uint8_t> out;
+    const std::uint64_t values[] = {0u, 1u, 127u, 128u, 300u, ~std::uint64_t{0}};
+    for (std::uint64_t v : values) booking::append_varint(out, v);
+    EXPECT_EQ(out.size(), 1u + 1u + 1u + 2u + 2u + 10u);
+    const std::uint8_t* p = out.data();
+    for (std::uint64_t v : values) {
+        std::uint64_t back = 0;
+        ASSERT_TRUE(booking::read_varint(p, out.data() + out.size(), back));
+        EXPECT_EQ(back, v);
+    }
+    std::uint64_t none = 0;
+    EXPECT_FALSE(booking::read_varint(p, out.data() + out.size(), none));
+    for (std::int64_t v : {0, -1, 1, -2, 1 << 20, -(1 << 20)}) EXPECT_EQ(booking::unzigzag(booking::zigzag(v)), v);
+    EXPECT_EQ(booking::zigzag(-1), 1u);
+    EXPECT_EQ(booking::zigzag(1), 2u);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "seat_run_summary.hpp"
+
+#include <string>
+#include <vector>
+
+using booking::BookingService;
+using booking::CatalogStatus;
+using booking::HallLayout;
+using booking::SeatRunSummary;
+using booking::Show;
+using booking::ShowId;
+
+TEST(SeatRunSummary, LongestRunStopsAtAisles) {
+    EXPECT_EQ(SeatRunSummary::longest_run(0u, 0u), 0);
+    EXPECT_EQ(SeatRunSummary::longest_run(0b1u, 0u), 1);
+    EXPECT_EQ(SeatRunSummary::longest_run(0b11101111u, 0u), 4);
+    EXPECT_EQ(SeatRunSummary::longest_run(0b11111111u, 0b00001000u), 4); // aisle after seat 3
+    EXPECT_EQ(SeatRunSummary::longest_run(0b11111111u, 0b00000101u), 5);
+    EXPECT_EQ(SeatRunSummary::longest_run(~std::uint64_t{0}, 0u), 64);
+}
+
+TEST(SeatRunSummary, ScreensListedPositionsByTheirLongestRow) {
+    SeatRunSummary runs(200);
+    const std::uint64_t free[] = {0b111u, 0b1111111u, 0b11u}; // runs of 3, 7 and 2
+    runs.refresh(5, 0, 2, 0u, [] { return std::uint64_t{0b1111}; });
+    runs.refresh(5, 1, 2, 0u, [] { return std::uint64_t{0b1110111111}; });
+    runs.refresh(130, 0, 1, 0u, [&] { return free[1]; });
+    runs.refresh(131, 0, 1, 0u, [&] { return free[2]; });
+    for (int p : {5, 130, 131}) runs.list(p);
+    EXPECT_EQ(runs.longest(5), 6);
+    EXPECT_EQ(runs.free_seats(5), 13);
+    EXPECT_EQ(runs.rows_with_run(5, 5), 0b10u); // the row hierarchy below the show
+    EXPECT_EQ(runs.rows_with_run(5, 4), 0b11u);
+    EXPECT_TRUE(runs.listed(5));
+    EXPECT_FALSE(runs.listed(6));
+
+    std::vector<int> found;
+    runs.for_each_at_least(5, [&](int p) { found.push_back(p); });
+    EXPECT_EQ(found, (std::vector<int>{5, 130}));
+
+    runs.list(5, false);
+    runs.refresh(130, 0, 1, 0u, [] { return std::uint64_t{0b100}; }); // the row filled up
+    EXPECT_EQ(runs.free_seats(130), 1);
+    runs.trim(5, 1); // a move left the show one row
+    EXPECT_EQ(runs.free_seats(5), 4);
+    found.clear();
+    runs.for_each_at_least(2, [&](int p) { found.push_back(p); });
+    EXPECT_EQ(found, (std::vector<int>{131}));
+    EXPECT_EQ(runs.longest(999), 0);
+}
+
+TEST(SeatRunSummary, ServiceFiltersShowsByAdjacentSeats) {
+    for (bool enabled : {false, true}) {
+        BookingService svc{BookingService::EmptyCatalog{}};
+        ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), CatalogStatus::Ok);
+        ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), CatalogStatus::Ok);
+        HallLayout aisled = HallLayout::uniform(1, 8);
+        std::array<std::uint64_t, HallLayout::kMaxRows> after{};
+        after[0] = 0b1000u; // a1-a4 | a5-a8
+        aisled.set_aisles(after);
+        const auto small = svc.add_layout(HallLayout::uniform(1, 6));
+        const auto split = svc.add_layout(aisled);
+        ASSERT_EQ(svc.add_show(Show{1, 1, 1, small, 100, 1}), CatalogStatus::Ok);
+        ASSERT_EQ(svc.add_show(Show{2, 1, 1, split, 200, 2}), CatalogStatus::Ok);
+        ASSERT_TRUE(svc.book_seats(1, {"a3"}).success);
+        if (enabled) svc.enable_seat_run_summary(); // backfills the booking above
+        EXPECT_EQ(svc.seat_run_summary_enabled(), enabled);
+
+        EXPECT_EQ(svc.shows_with_adjacent_seats(3), (std::vector<ShowId>{1, 2}));
+        EXPECT_EQ(svc.shows_with_adjacent_seats(4), (std::vector<ShowId>{2}));
+        EXPECT_TRUE(svc.shows_with_adjacent_seats(5).empty()); // the aisle splits show 2
+
+        const auto booked = svc.book_seats(2, {"a2", "a6"});
+        ASSERT_TRUE(booked.success);
+        EXPECT_EQ(svc.shows_with_adjacent_seats(3), (std::vector<ShowId>{1}));
+        std::vector<Show> shows = svc.find_movie_shows_between(1, 0, 1000);
+        svc.filter_adjacent_seats(shows, 2);
+        ASSERT_EQ(shows.size(), 2u);
+        svc.filter_adjacent_seats(shows, 3);
+        ASSERT_EQ(shows.size(), 1u);
+        EXPECT_EQ(shows[0].id, 1);
+
+        ASSERT_TRUE(svc.cancel_seats(2, {"a6"}, booked.id).success);
+        EXPECT_EQ(svc.shows_with_adjacent_seats(3), (std::vector<ShowId>{1, 2}));
+        ASSERT_EQ(svc.remove_show(1), CatalogStatus::Ok);
+        EXPECT_EQ(svc.shows_with_adjacent_seats(3), (std::vector<ShowId>{2}));
+    }
+}
+
+TEST(SeatRunSummary, BestSeatsAndCountsDescendTheSummary) {
+    BookingService svc(HallLayout::uniform(40, 50)); // 2,000 seats
+    svc.enable_seat_run_summary();
+    const ShowId show = svc.find_show(1, 1);
+    // Leave runs of at most 3 everywhere except row 25 (index 24)
+    for (int r = 0; r < 40; ++r) {
+        if (r == 24) continue;
+        booking::SeatMask every_fourth;
+        every_fourth.or_word(r, 0x8888888888888888u & ((std::uint64_t{1} << 50) - 1u));
+        ASSERT_TRUE(svc.book_seat_mask(show, every_fourth).success);
+    }
+    EXPECT_EQ(svc.available_count(show), 2000 - 39 * 12);
+
+    booking::SeatMask got;
+    ASSERT_TRUE(svc.book_best_available(show, 4, got).success);
+    EXPECT_EQ(got.first_word(), 24); // the only row with a run of 4
+    EXPECT_EQ(svc.available_count(show), 2000 - 39 * 12 - 4);
+    EXPECT_TRUE(svc.book_best_available(show, 3, got).success);
+    EXPECT_EQ(svc.book_best_available(show, 47, got).status, booking::BookingStatus::NoContiguousSeats);
+}
+
+TEST(SeatRunSummary, RenderingListsLabelsWhileCountsReadTheSummary) {
+    BookingService svc(HallLayout::uniform(8, 10));
+    const ShowId show = svc.find_show(1, 1);
+    std::string plain;
+    ASSERT_EQ(svc.append_available_seats(show, plain, ' '), 80);
+    ASSERT_TRUE(svc.book_seats(show, {"a1", "c5"}).success);
+    plain.clear();
+    ASSERT_EQ(svc.append_available_seats(show, plain, ' '), 78);
+
+    svc.enable_seat_run_summary();
+    std::string summarised;
+    EXPECT_EQ(svc.append_available_seats(show, summarised, ' '), 78);
+    EXPECT_EQ(summarised, plain); // the labels are still rendered
+    EXPECT_EQ(svc.available_count(show), 78);
+    ASSERT_TRUE(svc.book_seats(show, {"h10"}).success);
+    EXPECT_EQ(svc.available_count(show), 77);
+}
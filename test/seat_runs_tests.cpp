@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include "seat_runs.hpp"
+
+using booking::gap_leaving_starts;
+using booking::isolated_seats;
+using booking::nearest_bit;
+using booking::run_starts;
+
+TEST(SeatRuns, RunStartsMarksEveryFittingPosition) {
+    // free seats: 0..3 and 6..7
+    const std::uint64_t free_bits = 0b11001111u;
+    EXPECT_EQ(run_starts(free_bits, 1), free_bits);
+    EXPECT_EQ(run_starts(free_bits, 2), 0b01000111u);
+    EXPECT_EQ(run_starts(free_bits, 3), 0b00000011u);
+    EXPECT_EQ(run_starts(free_bits, 4), 0b00000001u);
+    EXPECT_EQ(run_starts(free_bits, 5), 0u);
+}
+
+TEST(SeatRuns, RunStartsHandlesFullWordAndBadLengths) {
+    const std::uint64_t all = ~std::uint64_t{0};
+    EXPECT_EQ(run_starts(all, 64), 1u);
+    EXPECT_EQ(run_starts(all, 63), 3u);
+    EXPECT_EQ(run_starts(all & ~(std::uint64_t{1} << 63), 64), 0u);
+    EXPECT_EQ(run_starts(all, 0), 0u);
+    EXPECT_EQ(run_starts(all, 65), 0u);
+}
+
+TEST(SeatRuns, RunStartsMatchesNaiveScan) {
+    std::uint64_t x = 0x9E3779B97F4A7C15u;
+    for (int iter = 0; iter < 200; ++iter) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        const std::uint64_t free_bits = x | (x >> 1); // denser runs
+        for (int n = 1; n <= 12; ++n) {
+            std::uint64_t expected = 0u;
+            for (int c = 0; c + n <= 64; ++c) {
+                const std::uint64_t run = (n == 64 ? ~std::uint64_t{0} : ((std::uint64_t{1} << n) - 1u)) << c;
+                if ((free_bits & run) == run) expected |= std::uint64_t{1} << c;
+            }
+            EXPECT_EQ(run_starts(free_bits, n), expected) << "n=" << n;
+        }
+    }
+}
+
+TEST(SeatRuns, NearestBitPrefersClosestThenLower) {
+    EXPECT_EQ(nearest_bit(0b1000001u, 3), 0);  // 0 and 6 equally close: lower wins
+    EXPECT_EQ(nearest_bit(0b1000001u, 4), 6);
+    EXPECT_EQ(nearest_bit(0b0010000u, 0), 4);
+    EXPECT_EQ(nearest_bit(0b0000010u, 63), 1);
+    EXPECT_EQ(nearest_bit(std::uint64_t{1} << 63, 5), 63);
+}
+
+TEST(SeatRuns, IsolatedSeatsAreFreeBitsWithoutFreeNeighbours) {
+    EXPECT_EQ(isolated_seats(0b1011010001u), 0b1000010001u);
+    EXPECT_EQ(isolated_seats(0u), 0u);
+    EXPECT_EQ(isolated_seats(~std::uint64_t{0}), 0u);
+    EXPECT_EQ(isolated_seats(std::uint64_t{1} << 63), std::uint64_t{1} << 63);
+}
+
+TEST(SeatRuns, GapLeavingStartsMatchesNaiveCheck) {
+    std::uint64_t x = 0x243F6A8885A308D3u;
+    for (int iter = 0; iter < 200; ++iter) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        const std::uint64_t free_bits = x | (x >> 1);
+        for (int n = 1; n <= 12; ++n) {
+            const std::uint64_t starts = run_starts(free_bits, n);
+            const std::uint64_t run = (std::uint64_t{1} << n) - 1u;
+            std::uint64_t expected = 0u;
+            for (int c = 0; c + n <= 64; ++c) {
+                if (!((starts >> c) & 1u)) continue;
+                const std::uint64_t after = free_bits & ~(run << c);
+                if ((isolated_seats(after) & ~isolated_seats(free_bits)) != 0u) expected |= std::uint64_t{1} << c;
+            }
+            EXPECT_EQ(gap_leaving_starts(free_bits, n) & starts, expected) << "n=" << n;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "seat_runs.hpp"
+#include "seat_scan.hpp"
+
+#include <vector>
+
+namespace scan = booking::seat_scan;
+
+namespace {
+
+std::vector<const scan::Kernels*> available_kernels() {
+    std::vector<const scan::Kernels*> out{&scan::scalar_kernels()};
+    if (scan::avx2_kernels()) out.push_back(scan::avx2_kernels());
+    if (scan::neon_kernels()) out.push_back(scan::neon_kernels());
+    return out;
+}
+
+std::vector<std::uint64_t> random_words(std::size_t n, std::uint64_t seed) {
+    std::vector<std::uint64_t> words(n);
+    for (auto& w : words) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        w = seed | (seed >> 3); // denser runs than uniform bits
+    }
+    return words;
+}
+
+} // namespace
+
+TEST(SeatScan, DispatchPicksAnAvailableIsa) {
+    const scan::Kernels& k = scan::kernels();
+    bool found = false;
+    for (const scan::Kernels* candidate : available_kernels()) found = found || candidate == &k;
+    EXPECT_TRUE(found) << scan::to_string(k.isa);
+}
+
+TEST(SeatScan, AllIsasAgreeWithScalar) {
+    const scan::Kernels& ref = scan::scalar_kernels();
+    for (std::size_t n : {0u, 1u, 3u, 4u, 7u, 10u, 64u}) {
+        const std::vector<std::uint64_t> words = random_words(n, 0x9E3779B97F4A7C15u + n);
+        for (const scan::Kernels* k : available_kernels()) {
+            SCOPED_TRACE(scan::to_string(k->isa));
+            EXPECT_EQ(k->count_free(words.data(), n), ref.count_free(words.data(), n));
+
+            std::vector<std::uint8_t> counts(n), ref_counts(n);
+            k->row_free_counts(words.data(), n, counts.data());
+            ref.row_free_counts(words.data(), n, ref_counts.data());
+            EXPECT_EQ(counts, ref_counts);
+
+            for (int run : {0, 1, 2, 3, 5, 8, 13, 64, 65}) {
+                std::vector<std::uint64_t> starts(n), ref_starts(n);
+                const std::uint64_t rows = k->find_runs(words.data(), n, run, starts.data());
+                EXPECT_EQ(rows, ref.find_runs(words.data(), n, run, ref_starts.data())) << "run=" << run;
+                EXPECT_EQ(starts, ref_starts) << "run=" << run;
+            }
+        }
+    }
+}
+
+TEST(SeatScan, ScalarKernelsMatchDefinitions) {
+    const std::uint64_t words[] = {0u, ~std::uint64_t{0}, 0b11001111u};
+    const scan::Kernels& k = scan::scalar_kernels();
+    EXPECT_EQ(k.count_free(words, 3), 0 + 64 + 6);
+
+    std::uint8_t counts[3];
+    k.row_free_counts(words, 3, counts);
+    EXPECT_EQ(counts[1], 64);
+    EXPECT_EQ(counts[2], 6);
+
+    std::uint64_t starts[3];
+    EXPECT_EQ(k.find_runs(words, 3, 4, starts), 0b110u);
+    EXPECT_EQ(starts[2], booking::run_starts(words[2], 4));
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "seat_states.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using booking::SeatState;
+using booking::SeatStateRows;
+namespace seat_states = booking::seat_states;
+
+TEST(SeatStates, SpreadAndGatherAreInverse) {
+    EXPECT_EQ(seat_states::spread(0b1011u), 0b01000101u);
+    EXPECT_EQ(seat_states::spread(0xFFFFFFFFu), seat_states::kLowBits);
+    for (std::uint32_t x : {0u, 1u, 0x80000000u, 0xDEADBEEFu, 0x12345678u}) {
+        EXPECT_EQ(seat_states::gather(seat_states::spread(x)), x);
+    }
+}
+
+TEST(SeatStates, WordTestsEverySlotAtOnce) {
+    // Seats 0, 1: held; 2: booked; 3: blocked; the rest free
+    const std::uint64_t word = seat_states::pack(0b0011u, 0b0100u, 0b1000u);
+    EXPECT_EQ(seat_states::get(word, 1), SeatState::Held);
+    EXPECT_EQ(seat_states::get(word, 2), SeatState::Booked);
+    EXPECT_EQ(seat_states::get(word, 3), SeatState::Blocked);
+    EXPECT_EQ(seat_states::get(word, 31), SeatState::Free);
+    EXPECT_EQ(seat_states::gather(seat_states::slots_in(word, SeatState::Held)), 0b0011u);
+    EXPECT_EQ(seat_states::gather(seat_states::slots_in(word, SeatState::Free)), 0xFFFFFFF0u);
+    EXPECT_TRUE(seat_states::all_in(word, seat_states::spread(0xF0u), SeatState::Free));
+    EXPECT_FALSE(seat_states::all_in(word, seat_states::spread(0x18u), SeatState::Free));
+
+    const std::uint64_t booked = seat_states::with(word, seat_states::spread(0b0011u), SeatState::Booked);
+    EXPECT_EQ(seat_states::gather(seat_states::slots_in(booked, SeatState::Booked)), 0b0111u);
+    EXPECT_EQ(seat_states::get(booked, 3), SeatState::Blocked);
+    EXPECT_STREQ(booking::to_string(SeatState::Held), "held");
+}
+
+TEST(SeatStates, RowTransitionsAreAllOrNothing) {
+    SeatStateRows rows(2, 64);
+    EXPECT_EQ(rows.word_count(), 4u);
+    const std::uint64_t seats = (std::uint64_t{1} << 63) | 0b11u; // spans both words of the row
+    ASSERT_TRUE(rows.transition(1, seats, SeatState::Free, SeatState::Held));
+    EXPECT_EQ(rows.seats_in(1, SeatState::Held), seats);
+    EXPECT_TRUE(rows.all_in(0, ~std::uint64_t{0}, SeatState::Free));
+
+    // Seat 63 is held: the low word is rolled back
+    ASSERT_TRUE(rows.transition(1, 0b11u, SeatState::Held, SeatState::Booked));
+    EXPECT_FALSE(rows.transition(1, (std::uint64_t{1} << 63) | 0b100u, SeatState::Free, SeatState::Booked));
+    EXPECT_EQ(rows.get(1, 2), SeatState::Free);
+    EXPECT_EQ(rows.get(1, 63), SeatState::Held);
+    EXPECT_EQ(rows.get(1, 0), SeatState::Booked);
+
+    SeatStateRows narrow(1, 20);
+    EXPECT_EQ(narrow.word_count(), 1u);
+    EXPECT_FALSE(narrow.transition(0, std::uint64_t{1} << 40, SeatState::Free, SeatState::Held));
+}
+
+TEST(SeatStates, RacingTransitionsTakeEachSeatOnce) {
+    SeatStateRows rows(1, 32);
+    std::atomic<int> won{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int s = 0; s < 31; ++s) {
+                const std::uint64_t pair = std::uint64_t{3} << s; // neighbours overlap
+                if (rows.transition(0, pair, SeatState::Free, t % 2 ? SeatState::Held : SeatState::Booked)) {
+                    won.fetch_add(2);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    const std::uint64_t taken = rows.seats_in(0, SeatState::Held) | rows.seats_in(0, SeatState::Booked);
+    EXPECT_EQ(__builtin_popcountll(taken), won.load());
+    EXPECT_EQ(taken & rows.seats_in(0, SeatState::Free), 0u);
+}
+
+TEST(SeatStates, ServicePacksBookedHeldAndMissingSeats) {
+    using namespace std::chrono_literals;
+    booking::BookingService svc;
+    const booking::ShowId show = svc.find_show(1, 1);
+    ASSERT_TRUE(svc.book_seats(show, {"a1"}).success);
+    const booking::BookingResult hold = svc.hold_seats(show, {"a2", "a5"}, 60s);
+    ASSERT_TRUE(hold.success) << hold.message();
+
+    std::vector<std::uint64_t> words;
+    const int seats = svc.seat_states(show, words);
+    ASSERT_GT(seats, 0);
+    const booking::HallLayout* layout = svc.layout_for_show(show);
+    ASSERT_EQ(words.size(), static_cast<std::size_t>(layout->row_count() * SeatStateRows::kWordsPerRow));
+    EXPECT_EQ(seat_states::get(words[0], 0), SeatState::Booked);
+    EXPECT_EQ(seat_states::get(words[0], 1), SeatState::Held);
+    EXPECT_EQ(seat_states::get(words[0], 2), SeatState::Free);
+    EXPECT_EQ(seat_states::get(words[0], 4), SeatState::Held);
+    EXPECT_EQ(seat_states::get(words[0], layout->row_seats(0)), SeatState::Blocked); // past the row
+    EXPECT_EQ(words[1], ~std::uint64_t{0});
+
+    int free = 0;
+    for (const std::uint64_t w : words) free += __builtin_popcountll(seat_states::slots_in(w, SeatState::Free));
+    EXPECT_EQ(free, svc.available_count(show));
+    EXPECT_EQ(svc.seat_states(999, words), -1);
+    EXPECT_TRUE(words.empty());
+}
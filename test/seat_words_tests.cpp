@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+
+#include "hall_layout.hpp"
+#include "seat_words.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+using booking::HallLayout;
+
+TEST(SeatWords, LoadFreeMatchesScalarLoopForEveryRowCount) {
+    std::vector<std::atomic<std::uint64_t>> words(HallLayout::kMaxRows);
+    for (int w = 0; w < HallLayout::kMaxRows; ++w) {
+        words[static_cast<std::size_t>(w)].store(0x9E3779B97F4A7C15u * static_cast<std::uint64_t>(w + 1));
+    }
+    for (int rows = 1; rows <= HallLayout::kMaxRows; ++rows) {
+        const HallLayout l = HallLayout::uniform(rows, 1 + rows % 64);
+        std::vector<std::uint64_t> out(HallLayout::kMaxRows + 1u, 0xDEADu);
+        booking::seat_words::load_free(words.data(), l.row_masks(), out.data(), rows);
+        for (int w = 0; w < rows; ++w) {
+            ASSERT_EQ(out[static_cast<std::size_t>(w)], ~words[static_cast<std::size_t>(w)].load() & l.row_mask(w))
+                << rows << " rows, word " << w;
+        }
+        EXPECT_EQ(out[static_cast<std::size_t>(rows)], 0xDEADu) << "wrote past " << rows << " rows";
+    }
+}
+
+TEST(SeatWords, RowMasksCoverExistingSeats) {
+    const HallLayout l({booking::RowSpec{"a", 1}, booking::RowSpec{"b", 63}, booking::RowSpec{"c", 64}});
+    EXPECT_EQ(l.row_masks()[0], 1u);
+    EXPECT_EQ(l.row_masks()[1], ~std::uint64_t{0} >> 1);
+    EXPECT_EQ(l.row_masks()[2], ~std::uint64_t{0});
+}
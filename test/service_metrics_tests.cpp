@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "service_metrics.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::MetricsApi;
+using booking::ServiceMetrics;
+
+namespace {
+
+std::size_t api(MetricsApi a) {
+    return static_cast<std::size_t>(a);
+}
+
+std::size_t status(BookingStatus s) {
+    return static_cast<std::size_t>(s);
+}
+
+} // namespace
+
+TEST(ServiceMetrics, AggregatesPerThreadShards) {
+    ServiceMetrics m;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 1000; ++i) {
+                m.record_latency(MetricsApi::BookSeats, static_cast<std::uint64_t>(100 * (t + 1)));
+                m.count(MetricsApi::BookSeats, static_cast<std::uint8_t>(i % 2));
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    m.record_latency(MetricsApi::BookSeats, ~std::uint64_t{0}); // clamped into the last bucket
+
+    std::array<ServiceMetrics::ApiTotals, booking::kMetricsApis> totals;
+    m.collect(totals);
+    const ServiceMetrics::ApiTotals& book = totals[api(MetricsApi::BookSeats)];
+    EXPECT_EQ(book.latency.count(), 4001u);
+    EXPECT_EQ(book.outcomes[0], 2000u);
+    EXPECT_EQ(book.outcomes[1], 2000u);
+    EXPECT_NEAR(static_cast<double>(book.latency.percentile(0.5)), 250.0, 60.0);
+    EXPECT_EQ(book.latency.max(), ~std::uint64_t{0});
+    EXPECT_EQ(totals[api(MetricsApi::CancelSeats)].latency.count(), 0u);
+}
+
+TEST(ServiceMetrics, CountsServiceOutcomes) {
+    if (!BOOKING_METRICS) GTEST_SKIP() << "built without metrics";
+    BookingService svc;
+    ASSERT_TRUE(svc.book_seats(1, {"a1"}).success);
+    EXPECT_EQ(svc.book_seats(1, {"a1"}).status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(svc.book_seats(1, {"zz9"}).status, BookingStatus::InvalidSeatLabel);
+    EXPECT_EQ(svc.book_seats(999, {"a1"}).status, BookingStatus::InvalidShow);
+    const auto b = svc.book_seats(1, {"a2", "a3"});
+    ASSERT_TRUE(b.success);
+    ASSERT_TRUE(svc.cancel_seats(1, {"a2"}, static_cast<booking::BookingId>(b.id)).success); // nested call counted once
+    EXPECT_EQ(svc.available_count(1), 18);
+    EXPECT_EQ(svc.available_count(999), -1);
+
+    std::array<ServiceMetrics::ApiTotals, booking::kMetricsApis> totals;
+    svc.collect_metrics(totals);
+    const auto& book = totals[api(MetricsApi::BookSeats)];
+    EXPECT_EQ(book.latency.count(), 5u);
+    EXPECT_EQ(book.outcomes[status(BookingStatus::Ok)], 2u);
+    EXPECT_EQ(book.outcomes[status(BookingStatus::AlreadyBooked)], 1u);
+    EXPECT_EQ(book.outcomes[status(BookingStatus::InvalidSeatLabel)], 1u);
+    EXPECT_EQ(book.outcomes[status(BookingStatus::InvalidShow)], 1u);
+    EXPECT_EQ(totals[api(MetricsApi::CancelSeats)].latency.count(), 1u);
+    EXPECT_EQ(totals[api(MetricsApi::AvailableCount)].outcomes[status(BookingStatus::InvalidShow)], 1u);
+
+    svc.set_metrics_enabled(false);
+    svc.book_seats(1, {"a9"});
+    svc.collect_metrics(totals);
+    EXPECT_EQ(totals[api(MetricsApi::BookSeats)].latency.count(), 5u);
+}
+
+TEST(ServiceMetrics, ExportsPrometheusText) {
+    if (!BOOKING_METRICS) GTEST_SKIP() << "built without metrics";
+    BookingService svc;
+    ASSERT_TRUE(svc.book_seats(1, {"a1"}).success);
+    EXPECT_FALSE(svc.book_seats(1, {"a1"}).success);
+    booking::SeatMask seats;
+    ASSERT_TRUE(svc.book_best_available(2, 3, seats).success);
+
+    const std::string text = svc.metrics_prometheus();
+    EXPECT_NE(text.find("# TYPE booking_requests_total counter\n"), std::string::npos);
+    EXPECT_NE(text.find("booking_requests_total{api=\"book_seats\",status=\"ok\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("booking_requests_total{api=\"book_seats\",status=\"already_booked\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("booking_requests_total{api=\"book_best_available\",status=\"ok\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("booking_request_duration_seconds{api=\"book_seats\",quantile=\"0.99\"} "), std::string::npos);
+    EXPECT_NE(text.find("booking_request_duration_seconds_count{api=\"book_seats\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("booking_conflicts_total 1\n"), std::string::npos);
+    EXPECT_NE(text.find("booking_shows 4\n"), std::string::npos);
+    EXPECT_EQ(text.find("cancel_seats"), std::string::npos); // APIs never called are omitted
+}
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include "sharded_booking_service.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using booking::BookingRequest;
+using booking::BookingResult;
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::CatalogStatus;
+using booking::Schedule;
+using booking::ScheduleStatus;
+using booking::ShardedBookingService;
+using booking::ShowId;
+using namespace std::chrono_literals;
+
+TEST(ShardedBookingService, RoutesShowsAndKeepsTheSampleCatalog) {
+    ShardedBookingService svc(3);
+    ASSERT_EQ(svc.shard_count(), 3u);
+    EXPECT_EQ(svc.list_movies().size(), 3u);
+
+    // Show 2 (Inception @ Mall) lives in shard 2 only
+    EXPECT_NE(svc.shard(2).layout_for_show(2), nullptr);
+    EXPECT_EQ(svc.shard(0).layout_for_show(2), nullptr);
+
+    // Theaters of shows on different shards are merged and sorted
+    const auto theaters = svc.list_theaters_for_movie(1);
+    ASSERT_EQ(theaters.size(), 2u);
+    EXPECT_EQ(theaters[0].id, 1);
+    EXPECT_EQ(theaters[1].id, 2);
+
+    const ShowId show = svc.find_show(1, 2);
+    ASSERT_EQ(show, 2);
+    ASSERT_TRUE(svc.book_seats(show, {"a1", "a2"}).success);
+    EXPECT_EQ(svc.book_seats(show, {"a2"}).status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(svc.available_count(show), 18);
+    EXPECT_EQ(svc.available_count(1), 20);
+    EXPECT_EQ(svc.available_count(99), -1);
+}
+
+TEST(ShardedBookingService, FindShowsMergesAcrossShards) {
+    ShardedBookingService svc(4, BookingService::EmptyCatalog{});
+    const auto layout = svc.add_layout(booking::HallLayout::uniform(2, 8));
+    EXPECT_EQ(svc.add_movie({1, "Dune"}), CatalogStatus::Ok);
+    EXPECT_EQ(svc.add_theater({7, "Roxy"}), CatalogStatus::Ok);
+    for (ShowId id : {13, 6, 8, 3}) EXPECT_EQ(svc.add_show({id, 1, 7, layout}), CatalogStatus::Ok);
+    EXPECT_EQ(svc.add_show({6, 1, 7, layout}), CatalogStatus::DuplicateId);
+
+    EXPECT_EQ(svc.find_shows(1, 7), (std::vector<ShowId>{3, 6, 8, 13}));
+    EXPECT_EQ(svc.find_show(1, 7), 3);
+    EXPECT_EQ(svc.remove_show(3), CatalogStatus::Ok);
+    EXPECT_EQ(svc.find_show(1, 7), 6);
+    EXPECT_EQ(svc.layout_for_show(13)->seat_count(), 16);
+
+    // Time-range queries merge the shards by start time
+    EXPECT_EQ(svc.add_theater({8, "Odeon"}), CatalogStatus::Ok);
+    EXPECT_EQ(svc.add_show({21, 1, 8, layout, 300}), CatalogStatus::Ok);
+    EXPECT_EQ(svc.add_show({22, 1, 7, layout, 200}), CatalogStatus::Ok);
+    const booking::TheaterId near[] = {7, 8};
+    std::vector<ShowId> ids;
+    for (const booking::Show& s : svc.find_shows_between(1, near, 100, 400)) ids.push_back(s.id);
+    EXPECT_EQ(ids, (std::vector<ShowId>{22, 21}));
+
+    ASSERT_TRUE(svc.book_seats(21, {"a1"}).success);
+    std::vector<booking::ShowAvailability> showtimes;
+    ASSERT_EQ(svc.movie_showtimes(1, 100, 400, showtimes), 2u);
+    EXPECT_EQ(showtimes[0].show_id, 22);
+    EXPECT_EQ(showtimes[1].show_id, 21);
+    EXPECT_EQ(showtimes[1].theater_name, "Odeon");
+    EXPECT_EQ(showtimes[1].free_seats, 15);
+}
+
+TEST(ShardedBookingService, LoadsSchedulesAllOrNothing) {
+    ShardedBookingService svc(3, BookingService::EmptyCatalog{});
+    Schedule s;
+    s.movies.push_back({1, "Dune"});
+    s.theaters.push_back({1, "Roxy"});
+    s.layouts.push_back({5, booking::HallLayout::uniform(1, 10)});
+    for (int id = 0; id < 30; ++id) s.shows.push_back({id, 1, 1, 5});
+    ASSERT_EQ(svc.load_schedule(s).status, ScheduleStatus::Ok);
+    for (int id = 0; id < 30; ++id) ASSERT_EQ(svc.available_count(id), 10) << id;
+    EXPECT_EQ(svc.find_shows(1, 1).size(), 30u);
+
+    // A show that already exists on some shard rejects the whole schedule
+    Schedule again;
+    again.movies.push_back({2, "Alien"});
+    again.layouts.push_back({1, booking::HallLayout::single_row(4)});
+    again.shows.push_back({100, 2, 1, 1});
+    again.shows.push_back({29, 2, 1, 1});
+    const auto err = svc.load_schedule(again);
+    EXPECT_EQ(err.status, ScheduleStatus::CatalogError);
+    EXPECT_EQ(svc.list_movies().size(), 1u);
+    EXPECT_EQ(svc.available_count(100), -1);
+}
+
+TEST(ShardedBookingService, BatchesAndHoldsSpanShards) {
+    ShardedBookingService svc(2);
+    const std::vector<std::string_view> a1{"a1"};
+    const std::vector<std::string_view> a2{"a2"};
+    const std::vector<BookingRequest> batch{{1, a1}, {2, a1}, {1, a1}, {3, a2}, {77, a1}};
+    const std::vector<BookingResult> results = svc.book_seats_batch(batch);
+    ASSERT_EQ(results.size(), 5u);
+    EXPECT_TRUE(results[0].success);
+    EXPECT_TRUE(results[1].success);
+    EXPECT_EQ(results[2].status, BookingStatus::AlreadyBooked);
+    EXPECT_TRUE(results[3].success);
+    EXPECT_EQ(results[4].status, BookingStatus::InvalidShow);
+    EXPECT_EQ(svc.seat_owner(1, 0), results[0].id);
+
+    // Hold ids route back to the shard that issued them
+    const auto h1 = svc.hold_seats(1, {"a5"}, 60s);
+    const auto h2 = svc.hold_seats(2, {"a5"}, 60s);
+    ASSERT_TRUE(h1.success && h2.success);
+    EXPECT_NE(h1.id, h2.id);
+    EXPECT_TRUE(svc.confirm_hold(h2.id).success);
+    EXPECT_TRUE(svc.release_hold(h1.id).success);
+    EXPECT_EQ(svc.release_hold(h1.id).status, BookingStatus::UnknownHold);
+    EXPECT_EQ(svc.available_count(1), 19);
+    EXPECT_EQ(svc.available_count(2), 18);
+
+    ASSERT_TRUE(svc.hold_seats(3, {"a9"}, 10ms).success);
+    ASSERT_TRUE(svc.hold_seats(4, {"a9"}, 10ms).success);
+    EXPECT_EQ(svc.expire_holds(std::chrono::steady_clock::now() + 1s), 2u);
+}
+
+TEST(ShardedBookingService, ConcurrentBookingsNeverOverbook) {
+    ShardedBookingService svc(4);
+    constexpr int kThreads = 8;
+    std::atomic<int> booked{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int seat = 1; seat <= 20; ++seat) {
+                const ShowId show = 1 + (seat + t) % 4;
+                if (svc.book_seats(show, {"a" + std::to_string(seat)}).success) booked.fetch_add(1);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    int free_total = 0;
+    for (int show = 1; show <= 4; ++show) free_total += svc.available_count(show);
+    EXPECT_EQ(booked.load() + free_total, 80);
+}
+
+TEST(ShardedBookingService, PagesTheatersMergedAcrossShards) {
+    ShardedBookingService svc(3, BookingService::EmptyCatalog{});
+    const auto layout = svc.add_layout(booking::HallLayout::uniform(1, 4));
+    ASSERT_EQ(svc.add_movie({1, "Dune"}), CatalogStatus::Ok);
+    std::vector<booking::TheaterId> expected;
+    for (int t = 1; t <= 20; ++t) {
+        ASSERT_EQ(svc.add_theater({t, "Hall"}), CatalogStatus::Ok);
+        // Uneven spread: a shard may hold several consecutive theaters and two shows of one
+        ASSERT_EQ(svc.add_show({t * t, 1, t, layout}), CatalogStatus::Ok);
+        if (t % 4 == 0) {
+            ASSERT_EQ(svc.add_show({1000 + t, 1, t, layout}), CatalogStatus::Ok);
+        }
+        expected.push_back(t);
+    }
+    for (const std::size_t limit : {1u, 3u, 7u, 50u}) {
+        std::vector<booking::TheaterId> seen;
+        std::uint64_t cursor = 0;
+        for (int pages = 0;; ++pages) {
+            ASSERT_LT(pages, 30);
+            const booking::Page<booking::Theater> page = svc.list_theaters_for_movie_page(1, cursor, limit);
+            ASSERT_LE(page.items.size(), limit);
+            for (const booking::Theater& t : page.items) seen.push_back(t.id);
+            cursor = page.next_cursor;
+            if (!page.more) break;
+        }
+        EXPECT_EQ(seen, expected) << limit;
+    }
+    EXPECT_EQ(svc.list_movies_page(0, 5).items.size(), 1u);
+}
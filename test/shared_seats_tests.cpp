@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "shared_seats.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <set>
+#include <string>
+
+using booking::BookingService;
+using booking::CatalogStatus;
+using booking::HallLayout;
+using booking::SeatMask;
+using booking::SharedSeatRegion;
+using booking::SharedSeatsStatus;
+
+namespace {
+
+/** @brief Unique shared memory name, removed on destruction. */
+struct RegionName {
+    explicit RegionName(const char* tag) : name("/booking-test-" + std::string(tag) + "-" + std::to_string(::getpid())) {
+        SharedSeatRegion::remove(name);
+    }
+    ~RegionName() { SharedSeatRegion::remove(name); }
+    std::string name;
+};
+
+/** @brief Empty service attached to @p name with one movie, one theater and @p shows 8x32 shows. */
+void attach_and_load(BookingService& svc, const std::string& name, int shows, int rows = 8) {
+    ASSERT_EQ(svc.attach_shared_seats(name, std::size_t{8} << 20, 256), SharedSeatsStatus::Ok);
+    booking::Schedule schedule;
+    schedule.movies.push_back(booking::ScheduleMovie{1, "Dune"});
+    schedule.theaters.push_back(booking::ScheduleTheater{1, "Roxy"});
+    schedule.layouts.push_back(booking::ScheduleLayout{0, HallLayout::uniform(rows, 32)});
+    for (int s = 0; s < shows; ++s) schedule.shows.push_back(booking::ScheduleShow{s, 1, 1, 0});
+    ASSERT_EQ(svc.load_schedule(std::move(schedule)).status, booking::ScheduleStatus::Ok);
+}
+
+} // namespace
+
+TEST(SharedSeats, ServicesShareSeatsOwnersAndIds) {
+    const RegionName region("share");
+    BookingService a{BookingService::EmptyCatalog{}};
+    BookingService b{BookingService::EmptyCatalog{}}; // maps the region at another address
+    attach_and_load(a, region.name, 3);
+    attach_and_load(b, region.name, 3);
+
+    const auto booked = a.book_seats(1, {"a1", "h32"});
+    ASSERT_TRUE(booked.success);
+    EXPECT_EQ(b.available_count(1), 8 * 32 - 2);
+    EXPECT_EQ(b.seat_owner(1, HallLayout::seat_index(7, 31)), static_cast<booking::BookingId>(booked.id));
+    EXPECT_EQ(b.book_seats(1, {"a1"}).status, booking::BookingStatus::AlreadyBooked);
+    EXPECT_EQ(b.available_count(0), 8 * 32); // other shows untouched
+
+    // Versions live in the region: b's cached map goes stale when a books
+    SeatMask map;
+    std::uint64_t version = 0;
+    ASSERT_EQ(b.availability_if_changed(1, BookingService::kNoVersion, map, version), booking::AvailabilityStatus::Changed);
+    EXPECT_EQ(b.availability_if_changed(1, version, map, version), booking::AvailabilityStatus::Unchanged);
+    ASSERT_TRUE(a.book_seats(1, {"c3"}).success);
+    EXPECT_EQ(b.availability_if_changed(1, version, map, version), booking::AvailabilityStatus::Changed);
+    EXPECT_FALSE(map.test(HallLayout::seat_index(2, 2)));
+
+    // Cancelled by the other service with the booking id handed out by the first
+    ASSERT_TRUE(b.cancel_seats(1, {"a1", "h32"}, static_cast<booking::BookingId>(booked.id)).success);
+    EXPECT_EQ(a.available_count(1), 8 * 32 - 1);
+
+    std::set<std::uint64_t> ids;
+    for (int i = 0; i < 50; ++i) {
+        SeatMask seats;
+        const auto ra = a.book_best_available(2, 1, seats);
+        const auto rb = b.book_best_available(2, 1, seats);
+        ASSERT_TRUE(ra.success && rb.success);
+        EXPECT_TRUE(ids.insert(ra.id).second);
+        EXPECT_TRUE(ids.insert(rb.id).second);
+    }
+    EXPECT_EQ(a.available_count(2), 8 * 32 - 100);
+}
+
+TEST(SharedSeats, ProcessesNeverOverbook) {
+    const RegionName region("fork");
+    int pipe_fds[2];
+    ASSERT_EQ(::pipe(pipe_fds), 0);
+    const pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+
+    // Both processes grab single seats until the show is sold out
+    auto grab_all = [&](BookingService& svc) {
+        int mine = 0;
+        SeatMask seats;
+        while (svc.book_best_available(0, 1, seats).success) ++mine;
+        return mine;
+    };
+    if (child == 0) {
+        BookingService svc{BookingService::EmptyCatalog{}};
+        if (svc.attach_shared_seats(region.name, std::size_t{8} << 20, 256) != SharedSeatsStatus::Ok) ::_exit(2);
+        booking::Schedule schedule;
+        schedule.movies.push_back(booking::ScheduleMovie{1, "Dune"});
+        schedule.theaters.push_back(booking::ScheduleTheater{1, "Roxy"});
+        schedule.layouts.push_back(booking::ScheduleLayout{0, HallLayout::uniform(8, 32)});
+        schedule.shows.push_back(booking::ScheduleShow{0, 1, 1, 0});
+        if (svc.load_schedule(std::move(schedule)).status != booking::ScheduleStatus::Ok) ::_exit(3);
+        const int mine = grab_all(svc);
+        const bool sent = ::write(pipe_fds[1], &mine, sizeof(mine)) == static_cast<ssize_t>(sizeof(mine));
+        ::_exit(sent ? 0 : 4);
+    }
+
+    BookingService svc{BookingService::EmptyCatalog{}};
+    attach_and_load(svc, region.name, 1);
+    const int mine = grab_all(svc);
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    int theirs = -1;
+    ASSERT_EQ(::read(pipe_fds[0], &theirs, sizeof(theirs)), static_cast<ssize_t>(sizeof(theirs)));
+    ::close(pipe_fds[0]);
+    ::close(pipe_fds[1]);
+
+    EXPECT_EQ(mine + theirs, 8 * 32);
+    EXPECT_EQ(svc.available_count(0), 0);
+}
+
+TEST(SharedSeats, RejectsMismatchesAndLateAttach) {
+    const RegionName region("reject");
+    BookingService a{BookingService::EmptyCatalog{}};
+    attach_and_load(a, region.name, 2);
+    EXPECT_EQ(a.attach_shared_seats(region.name), SharedSeatsStatus::InUse);
+
+    BookingService sample; // has shows already
+    EXPECT_EQ(sample.attach_shared_seats(region.name), SharedSeatsStatus::InUse);
+
+    // Same show ids with a different hall size
+    BookingService b{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(b.attach_shared_seats(region.name), SharedSeatsStatus::Ok);
+    ASSERT_EQ(b.add_movie(booking::Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(b.add_theater(booking::Theater{1, "Roxy"}), CatalogStatus::Ok);
+    const booking::LayoutId small = b.add_layout(HallLayout::uniform(2, 10));
+    EXPECT_EQ(b.add_show(booking::Show{0, 1, 1, small}), CatalogStatus::NoSharedRoom);
+    EXPECT_EQ(b.add_show(booking::Show{5, 1, 1, small}), CatalogStatus::Ok); // a new show id is fine
+    EXPECT_TRUE(b.book_seats(5, {"b10"}).success);
+    EXPECT_EQ(a.available_count(0), 8 * 32);
+
+    // A full region
+    const RegionName tiny("tiny");
+    BookingService c{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(c.attach_shared_seats(tiny.name, 4096, 4), SharedSeatsStatus::Ok);
+    ASSERT_EQ(c.add_movie(booking::Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(c.add_theater(booking::Theater{1, "Roxy"}), CatalogStatus::Ok);
+    const booking::LayoutId big = c.add_layout(HallLayout::uniform(64, 64));
+    EXPECT_EQ(c.add_show(booking::Show{0, 1, 1, big}), CatalogStatus::NoSharedRoom);
+
+    SharedSeatRegion bogus;
+    EXPECT_EQ(bogus.open("no-leading-slash/x"), SharedSeatsStatus::IoError);
+}
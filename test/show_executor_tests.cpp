@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "show_executor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::ExecutionMode;
+using booking::SeatMask;
+using booking::ShowExecutor;
+using booking::ShowId;
+using namespace std::chrono_literals;
+
+TEST(ShowExecutor, RunsEveryShowOnItsOwnerThread) {
+    ShowExecutor ex(3, 8);
+    ASSERT_EQ(ex.worker_count(), 3u);
+    EXPECT_FALSE(ex.on_worker());
+
+    std::vector<std::thread::id> owners(6);
+    for (int show = 0; show < 6; ++show) {
+        owners[static_cast<std::size_t>(show)] = ex.run(show, [&] {
+            EXPECT_TRUE(ex.on_worker());
+            // Nested calls from a worker run inline instead of deadlocking
+            return ex.run(show + 1, [] { return std::this_thread::get_id(); });
+        });
+    }
+    EXPECT_EQ(owners[0], owners[3]);
+    EXPECT_EQ(owners[1], owners[4]);
+    EXPECT_NE(owners[0], owners[1]);
+    EXPECT_NE(owners[0], std::this_thread::get_id());
+}
+
+TEST(ShowExecutor, SerialisesRequestsOfOneShow) {
+    ShowExecutor ex(2, 4); // small rings: producers wait for space
+    long counter = 0;      // plain integer: only the owner of show 7 touches it
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 2000; ++i) ex.run(7, [&] { return ++counter; });
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(ex.run(7, [&] { return counter; }), 8000);
+}
+
+TEST(ShowExecutor, WakesParkedWorkers) {
+    ShowExecutor ex(1);
+    EXPECT_EQ(ex.run(1, [] { return 1; }), 1);
+    std::this_thread::sleep_for(20ms); // let the worker park
+    EXPECT_EQ(ex.run(1, [] { return 2; }), 2);
+}
+
+TEST(ShowExecutor, OwnerThreadsModeKeepsBookingSemantics) {
+    BookingService svc(booking::HallLayout::uniform(4, 10));
+    EXPECT_EQ(svc.execution_mode(), ExecutionMode::Shared);
+    svc.set_execution_mode(ExecutionMode::OwnerThreads, 2);
+    EXPECT_EQ(svc.execution_mode(), ExecutionMode::OwnerThreads);
+
+    const ShowId show = svc.find_show(1, 1);
+    auto first = svc.book_seats(show, {"a1", "b1"});
+    ASSERT_TRUE(first.success) << first.message();
+    EXPECT_EQ(svc.book_seats(show, {"b1"}).status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(svc.book_seats(show, {"z1"}).status, BookingStatus::InvalidSeatLabel);
+
+    SeatMask best;
+    ASSERT_TRUE(svc.book_best_available(show, 4, best).success);
+    EXPECT_EQ(best.count(), 4);
+
+    EXPECT_EQ(svc.cancel_seats(show, {"a1", "b1"}, first.id + 1000).status, BookingStatus::NotOwner);
+    EXPECT_TRUE(svc.cancel_seats(show, {"a1", "b1"}, first.id).success);
+
+    auto hold = svc.hold_seats(show, {"d1"}, 60s);
+    ASSERT_TRUE(hold.success);
+    EXPECT_TRUE(svc.confirm_hold(hold.id).success);
+    EXPECT_EQ(svc.available_count(show), 40 - 4 - 1);
+
+    svc.set_execution_mode(ExecutionMode::Shared);
+    EXPECT_TRUE(svc.book_seats(show, {"a1"}).success);
+}
+
+TEST(ShowExecutor, OwnerThreadsModeNeverOverbooksAHotShow) {
+    BookingService svc(booking::HallLayout::uniform(2, 32));
+    svc.set_execution_mode(ExecutionMode::OwnerThreads, 2);
+    const ShowId show = svc.find_show(1, 1);
+
+    constexpr int kThreads = 6;
+    std::atomic<int> booked{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            for (int s = 1; s <= 32; ++s) {
+                if (svc.book_seats(show, {"a" + std::to_string(s)}).success) booked.fetch_add(1);
+                SeatMask out;
+                if (svc.book_best_available(show, 1, out).success) booked.fetch_add(1);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(booked.load(), 64);
+    EXPECT_EQ(svc.available_count(show), 0);
+
+    booking::ContentionStats stats;
+    ASSERT_TRUE(svc.contention_stats(show, stats));
+    EXPECT_EQ(stats.cas_retries, 0u); // one writer: no CAS ever fails
+}
+
+TEST(ShowExecutor, HigherLanesRunFirstAndLateRequestsAreDropped) {
+    ShowExecutor ex(1, 8);
+    std::atomic<bool> entered{false};
+    std::atomic<bool> release{false};
+    std::thread blocker([&] {
+        ex.run(0, [&] {
+            entered.store(true);
+            while (!release.load()) std::this_thread::yield();
+            return 0;
+        });
+    });
+    while (!entered.load()) std::this_thread::yield();
+
+    // Queued behind the blocker in the order read, hold, confirm; one of them expires
+    std::vector<std::string> order;
+    std::thread read([&] { ex.run(1, booking::RequestLane::Read, [&] { order.push_back("read"); return 0; }); });
+    std::this_thread::sleep_for(10ms);
+    bool expired = false;
+    std::thread late([&] {
+        ex.run_until(2, booking::RequestLane::Hold, ShowExecutor::Clock::now() + 1ms,
+                     [&] { order.push_back("hold"); return 0; }, expired);
+    });
+    std::this_thread::sleep_for(10ms);
+    std::thread confirm([&] { ex.run(3, booking::RequestLane::Confirm, [&] { order.push_back("confirm"); return 0; }); });
+    std::this_thread::sleep_for(10ms);
+
+    release.store(true);
+    for (std::thread* t : {&blocker, &read, &late, &confirm}) t->join();
+    EXPECT_EQ(order, (std::vector<std::string>{"confirm", "read"}));
+    EXPECT_TRUE(expired);
+    EXPECT_EQ(ex.expired_count(), 1u);
+    EXPECT_STREQ(booking::to_string(booking::RequestLane::Confirm), "confirm");
+}
+
+TEST(ShowExecutor, DeadlinesFailLateBookingsWithoutTouchingSeats) {
+    for (const ExecutionMode mode : {ExecutionMode::Shared, ExecutionMode::OwnerThreads}) {
+        BookingService svc;
+        svc.set_execution_mode(mode, 2);
+        const ShowId show = svc.find_show(1, 1);
+        {
+            BookingService::DeadlineScope scope(std::chrono::steady_clock::now() - 1ms);
+            EXPECT_EQ(svc.book_seats(show, {"a1"}).status, BookingStatus::DeadlineExceeded);
+            SeatMask seats;
+            seats.set(1);
+            EXPECT_EQ(svc.hold_seat_mask(show, seats, 1s).status, BookingStatus::DeadlineExceeded);
+            {
+                BookingService::DeadlineScope relaxed(std::chrono::steady_clock::now() + 1h);
+                EXPECT_TRUE(svc.book_seats(show, {"a1"}).success);
+            }
+            EXPECT_EQ(svc.book_seats(show, {"a3"}).status, BookingStatus::DeadlineExceeded);
+        }
+        EXPECT_TRUE(svc.book_seats(show, {"a2"}).success);
+        EXPECT_EQ(svc.available_count(show), 18);
+    }
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::CatalogStatus;
+using booking::Show;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr booking::ShowTime kHour = 3600;
+
+bool lists(const std::vector<std::string>& labels, const std::string& label) {
+    return std::find(labels.begin(), labels.end(), label) != labels.end();
+}
+
+} // namespace
+
+TEST(ShowHandle, BooksListsAndHoldsThroughOneLookup) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(2, 10));
+    ASSERT_EQ(svc.add_show(Show{1, 1, 1, hall}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{2, 1, 1, hall}), CatalogStatus::Ok);
+
+    BookingService::ShowHandle show = svc.show_handle(1);
+    ASSERT_TRUE(show.valid());
+    EXPECT_EQ(show.show_id(), 1);
+    EXPECT_TRUE(svc.book_seats(show, {"a1", "b2"}).success);
+    EXPECT_EQ(svc.book_seats(show, {"a1"}).status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(svc.book_seats(show, {"z9"}).status, BookingStatus::InvalidSeatLabel);
+    const auto hold = svc.hold_seats(show, {"a3"}, 10s);
+    ASSERT_TRUE(hold.success);
+
+    // The handle sees the same seats as the id-based calls, and only its own show's
+    const std::vector<std::string> free = svc.list_available_seats(show);
+    EXPECT_EQ(free, svc.list_available_seats(1));
+    EXPECT_EQ(free.size(), 17u);
+    EXPECT_FALSE(lists(free, "a3"));
+    EXPECT_EQ(svc.available_count(2), 20);
+    ASSERT_TRUE(svc.confirm_hold(hold.id).success);
+    EXPECT_EQ(svc.book_seats(1, {"a3"}).status, BookingStatus::AlreadyBooked);
+}
+
+TEST(ShowHandle, GoesStaleWhenTheShowIsArchived) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(2, 10));
+    ASSERT_EQ(svc.add_show(Show{1, 1, 1, hall, 10 * kHour}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{2, 1, 1, hall, 20 * kHour}), CatalogStatus::Ok);
+
+    BookingService::ShowHandle played = svc.show_handle(1);
+    BookingService::ShowHandle later = svc.show_handle(2);
+    ASSERT_TRUE(svc.book_seats(played, {"a1"}).success);
+    ASSERT_EQ(svc.archive_shows_before(12 * kHour), 1u);
+
+    // The erase bumped the epoch: both handles look their show up again
+    EXPECT_EQ(svc.book_seats(played, {"a2"}).status, BookingStatus::InvalidShow);
+    EXPECT_FALSE(played.valid());
+    EXPECT_TRUE(svc.list_available_seats(played).empty());
+    EXPECT_EQ(svc.hold_seats(played, {"a3"}, 10s).status, BookingStatus::InvalidShow);
+    EXPECT_TRUE(svc.book_seats(later, {"a1"}).success);
+    EXPECT_TRUE(later.valid());
+}
+
+TEST(ShowHandle, PicksUpAShowAddedAfterTheHandle) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    BookingService::ShowHandle show = svc.show_handle(7);
+    EXPECT_FALSE(show.valid());
+    EXPECT_EQ(svc.book_seats(show, {"a1"}).status, BookingStatus::InvalidShow);
+
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{7, 1, 1, svc.add_layout(booking::HallLayout::uniform(1, 10))}), CatalogStatus::Ok);
+    EXPECT_TRUE(svc.book_seats(show, {"a1"}).success);
+    EXPECT_TRUE(show.valid());
+    EXPECT_EQ(svc.available_count(7), 9);
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "show_gate.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::CatalogStatus;
+using booking::HallLayout;
+using booking::MoveStatus;
+using booking::Show;
+using booking::ShowGate;
+using namespace std::chrono_literals;
+
+namespace {
+
+struct Cinema {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    booking::LayoutId small = 0;
+    booking::LayoutId large = 0;
+
+    Cinema() {
+        EXPECT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), CatalogStatus::Ok);
+        EXPECT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), CatalogStatus::Ok);
+        small = svc.add_layout(HallLayout::uniform(2, 10));
+        large = svc.add_layout(HallLayout::uniform(8, 20));
+        EXPECT_EQ(svc.add_show(Show{1, 1, 1, small, 100, 1}), CatalogStatus::Ok);
+        EXPECT_EQ(svc.add_show(Show{2, 1, 1, small, 200, 1}), CatalogStatus::Ok);
+    }
+};
+
+} // namespace
+
+TEST(ShowGate, FreezeWaitsForPassesAndHoldsNewOnes) {
+    ShowGate gate;
+    std::atomic<bool> entered{false};
+    std::atomic<bool> release{false};
+    std::thread writer([&] {
+        const ShowGate::Pass pass(gate, 7);
+        const ShowGate::Pass nested(gate, 7); // re-entering its own show never waits
+        entered = true;
+        while (!release) std::this_thread::yield();
+    });
+    while (!entered) std::this_thread::yield();
+
+    std::atomic<bool> frozen{false};
+    std::thread mover([&] {
+        gate.freeze(7);
+        frozen = true;
+    });
+    std::this_thread::sleep_for(20ms);
+    EXPECT_FALSE(frozen); // still draining the writer
+    { const ShowGate::Pass other(gate, 8); } // other shows are not affected
+    release = true;
+    writer.join();
+    mover.join();
+    EXPECT_TRUE(gate.frozen(7));
+
+    std::atomic<bool> passed{false};
+    std::thread late([&] {
+        const ShowGate::Pass pass(gate, 7);
+        passed = true;
+    });
+    std::this_thread::sleep_for(20ms);
+    EXPECT_FALSE(passed);
+    gate.thaw();
+    late.join();
+    EXPECT_TRUE(passed);
+}
+
+TEST(ShowMove, RemapsBookingsAndHoldsByLabel) {
+    Cinema c;
+    const auto booked = c.svc.book_seats(1, {"a1", "b10"});
+    ASSERT_TRUE(booked.success);
+    const auto hold = c.svc.hold_seats(1, {"a2", "b3"}, 10s);
+    ASSERT_TRUE(hold.success);
+
+    ASSERT_EQ(c.svc.move_show(1, c.large, 4), MoveStatus::Ok);
+    EXPECT_EQ(c.svc.available_count(1), 160 - 4);
+    EXPECT_EQ(c.svc.book_seats(1, {"b10"}).status, BookingStatus::AlreadyBooked);
+    EXPECT_TRUE(c.svc.book_seats(1, {"h20"}).success); // a seat only the new hall has
+    EXPECT_EQ(c.svc.seat_owner(1, HallLayout::seat_index(1, 9)), booked.id);
+    EXPECT_EQ(c.svc.available_count(2), 20); // the other show stayed in its hall
+
+    // The hold survived the move with its seats translated
+    booking::SeatMask held;
+    EXPECT_EQ(c.svc.held_seats_mask(1, held), 2);
+    EXPECT_TRUE(held.test(HallLayout::seat_index(1, 2)));
+    ASSERT_TRUE(c.svc.confirm_hold(hold.id).success);
+    EXPECT_EQ(c.svc.book_seats(1, {"b3"}).status, BookingStatus::AlreadyBooked);
+    EXPECT_TRUE(c.svc.cancel_seats(1, {"a1", "b10"}, booked.id).success);
+
+    const std::vector<Show> shows = c.svc.find_shows_between(1, 1, 0, 1000);
+    ASSERT_EQ(shows.size(), 2u);
+    EXPECT_EQ(shows[0].layout_id, c.large);
+    EXPECT_EQ(shows[0].hall, 4);
+    EXPECT_EQ(c.svc.find_movie_shows_between(1, 0, 150)[0].hall, 4);
+}
+
+TEST(ShowMove, RefusesMovesThatWouldLoseSeats) {
+    Cinema c;
+    ASSERT_TRUE(c.svc.book_seats(1, {"a1"}).success);
+    ASSERT_EQ(c.svc.move_show(1, c.large, 2), MoveStatus::Ok);
+    ASSERT_TRUE(c.svc.book_seats(1, {"c5"}).success);
+
+    // c5 has no seat in the small hall: nothing changes
+    EXPECT_EQ(c.svc.move_show(1, c.small, 1), MoveStatus::SeatLost);
+    EXPECT_EQ(c.svc.available_count(1), 158);
+    EXPECT_EQ(c.svc.move_show(9, c.small, 1), MoveStatus::UnknownShow);
+    EXPECT_EQ(c.svc.move_show(1, 99, 1), MoveStatus::UnknownLayout);
+
+    // An explicit table: every seat of the large hall to a1, so two taken seats clash
+    std::vector<int> table(static_cast<std::size_t>(8 * HallLayout::kMaxRowSeats), 0);
+    EXPECT_EQ(c.svc.move_show(1, c.small, 1, table), MoveStatus::SeatClash);
+    ASSERT_TRUE(c.svc.cancel_seats(1, {"c5"}, c.svc.seat_owner(1, HallLayout::seat_index(2, 4))).success);
+    EXPECT_EQ(c.svc.move_show(1, c.small, 1), MoveStatus::Ok);
+    EXPECT_EQ(c.svc.available_count(1), 19);
+}
+
+TEST(ShowMove, OtherShowsKeepBookingDuringMoves) {
+    Cinema c;
+    std::atomic<bool> stop{false};
+    std::atomic<int> booked{0};
+    std::thread booker([&] {
+        for (int i = 0; i < 20 && !stop; ++i) {
+            const std::string label = std::string(1, static_cast<char>('a' + i / 10)) + std::to_string(i % 10 + 1);
+            if (c.svc.book_seats(2, {label}).success) ++booked;
+        }
+    });
+    std::thread show1([&] {
+        for (int i = 0; i < 50; ++i) {
+            const auto res = c.svc.book_seats(1, {"a1"});
+            if (!res.success) continue;
+            // A request that raced a move is answered Contended and retried
+            booking::BookingResult cancelled;
+            do {
+                cancelled = c.svc.cancel_seats(1, {"a1"}, res.id);
+            } while (cancelled.status == BookingStatus::Contended);
+            EXPECT_TRUE(cancelled.success);
+        }
+    });
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(c.svc.move_show(1, i % 2 == 0 ? c.large : c.small, 1 + i % 2), MoveStatus::Ok);
+    }
+    stop = true;
+    booker.join();
+    show1.join();
+    EXPECT_EQ(c.svc.available_count(2), 20 - booked);
+    EXPECT_EQ(c.svc.available_count(1), 20);
+}
+
+TEST(ShowMove, BatchBookingsSurviveConcurrentMoves) {
+    Cinema c;
+    const int seats[] = {HallLayout::seat_index(0, 2), HallLayout::seat_index(1, 4)}; // a3, b5 in both halls
+    const char* labels[] = {"a3", "b5"};
+    booking::SeatMask masks[2];
+    for (int k = 0; k < 2; ++k) masks[k].set(seats[k]);
+    const booking::BookingRequest batch[] = {{1, {}, &masks[0]}, {1, {}, &masks[1]}};
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> rounds{0};
+    std::thread batcher([&] {
+        while (!stop) {
+            const auto results = c.svc.book_seats_batch(booking::Span<const booking::BookingRequest>(batch, 2));
+            for (int k = 0; k < 2; ++k) {
+                const booking::BookingResult& r = results[static_cast<std::size_t>(k)];
+                if (!r.success) {
+                    // Raced a move (or a cancel still retrying): never a lost seat
+                    EXPECT_TRUE(r.status == BookingStatus::Contended) << booking::to_string(r.status);
+                    continue;
+                }
+                // A booking that succeeded holds its seat across every later move
+                booking::BookingResult cancelled;
+                do {
+                    cancelled = c.svc.cancel_seats(1, {labels[k]}, r.id);
+                } while (cancelled.status == BookingStatus::Contended);
+                EXPECT_TRUE(cancelled.success) << labels[k] << ": " << booking::to_string(cancelled.status);
+            }
+            ++rounds;
+        }
+    });
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_EQ(c.svc.move_show(1, i % 2 == 0 ? c.large : c.small, 1 + i % 2), MoveStatus::Ok);
+        if (i % 20 == 0) std::this_thread::yield();
+    }
+    stop = true;
+    batcher.join();
+    EXPECT_GT(rounds.load(), 0);
+    EXPECT_EQ(c.svc.available_count(1), 20);
+}
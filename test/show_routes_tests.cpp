@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "show_routes.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using booking::BookingService;
+using booking::CatalogStatus;
+using booking::Show;
+using booking::ShowRoutes;
+
+namespace {
+
+constexpr booking::ShowTime kHour = 3600;
+
+} // namespace
+
+TEST(ShowRoutes, RepeatedLookupsSkipTheCatalog) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{2, "Rex"}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(2, 10));
+    ASSERT_EQ(svc.add_show(Show{5, 1, 1, hall}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{6, 1, 2, hall}), CatalogStatus::Ok);
+
+    ShowRoutes routes(svc);
+    BookingService::ShowHandle* show = routes.find(1, 1);
+    ASSERT_NE(show, nullptr);
+    EXPECT_EQ(show->show_id(), 5);
+    EXPECT_EQ(routes.find(1, 1), show);
+    EXPECT_EQ(routes.find(1, 2)->show_id(), 6);
+    EXPECT_EQ(routes.hits(), 1u);
+    EXPECT_EQ(routes.misses(), 2u);
+    EXPECT_EQ(routes.size(), 2u);
+
+    // Pairs without a show are answered by the catalog every time
+    EXPECT_EQ(routes.find(2, 1), nullptr);
+    EXPECT_EQ(routes.find(2, 1), nullptr);
+    EXPECT_EQ(routes.misses(), 4u);
+    EXPECT_EQ(routes.size(), 2u);
+
+    const std::vector<std::string_view> labels{"a1", "b2"};
+    EXPECT_TRUE(svc.book_seat_labels(*show, booking::Span<const std::string_view>(labels.data(), labels.size())).success);
+    std::string out;
+    EXPECT_EQ(svc.append_cached_available_seats(*show, out), 18);
+    EXPECT_EQ(out.find("a1 "), std::string::npos);
+}
+
+TEST(ShowRoutes, CatalogUpdatesDropTheCachedRoutes) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(2, 10));
+    ASSERT_EQ(svc.add_show(Show{5, 1, 1, hall, 10 * kHour}), CatalogStatus::Ok);
+
+    ShowRoutes routes(svc);
+    ASSERT_EQ(routes.find(1, 1)->show_id(), 5);
+    const std::uint64_t version = svc.catalog_version();
+
+    // Archiving the show changes what find_show returns for the pair
+    ASSERT_EQ(svc.add_show(Show{6, 1, 1, hall, 20 * kHour}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.archive_shows_before(12 * kHour), 1u);
+    EXPECT_GT(svc.catalog_version(), version);
+    BookingService::ShowHandle* show = routes.find(1, 1);
+    ASSERT_NE(show, nullptr);
+    EXPECT_EQ(show->show_id(), 6);
+    EXPECT_EQ(routes.hits(), 0u);
+    EXPECT_EQ(routes.size(), 1u);
+
+    ASSERT_EQ(svc.remove_show(6), CatalogStatus::Ok);
+    EXPECT_EQ(routes.find(1, 1), nullptr);
+    EXPECT_EQ(routes.size(), 0u);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include "show_table.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+
+using booking::ShowTable;
+
+namespace {
+struct alignas(64) Item {
+    std::atomic<std::uint64_t> value{0};
+};
+} // namespace
+
+TEST(ShowTable, FindsOnlyEmplacedIds) {
+    ShowTable<Item> table;
+    EXPECT_EQ(table.find(0), nullptr);
+    EXPECT_EQ(table.find(-1), nullptr);
+
+    table.emplace(3, [](Item& it) { it.value.store(30); });
+    table.emplace(200, [](Item& it) { it.value.store(2000); });
+    EXPECT_EQ(table.size(), 2u);
+    ASSERT_NE(table.find(3), nullptr);
+    EXPECT_EQ(table.find(3)->value.load(), 30u);
+    EXPECT_EQ(table.find(200)->value.load(), 2000u);
+    EXPECT_EQ(table.find(4), nullptr);   // same chunk, not emplaced
+    EXPECT_EQ(table.find(100), nullptr); // chunk never allocated
+    EXPECT_EQ(table.find(1 << 21), nullptr);
+}
+
+TEST(ShowTable, ObjectsAreContiguousAlignedAndStable) {
+    ShowTable<Item> table;
+    Item* first = &table.emplace(0, [](Item&) {});
+    Item* second = &table.emplace(1, [](Item&) {});
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(first) % 64u, 0u);
+    EXPECT_EQ(second, first + 1);
+
+    // Growing the directory does not move existing objects
+    table.emplace(ShowTable<Item>::kMaxId - 1, [](Item&) {});
+    EXPECT_EQ(table.find(0), first);
+}
+
+TEST(ShowTable, RejectsBadAndDuplicateIds) {
+    ShowTable<Item> table;
+    table.emplace(7, [](Item&) {});
+    EXPECT_THROW(table.emplace(7, [](Item&) {}), std::invalid_argument);
+    EXPECT_THROW(table.emplace(-1, [](Item&) {}), std::invalid_argument);
+    table.emplace(ShowTable<Item>::kMaxId, [](Item&) {}); // the first sparse id
+    EXPECT_THROW(table.emplace(ShowTable<Item>::kMaxId, [](Item&) {}), std::invalid_argument);
+    EXPECT_FALSE(table.available(-1));
+}
+
+TEST(ShowTable, SparseIdsGetPositionsAfterTheDenseRange) {
+    ShowTable<Item> table;
+    constexpr int kDense = ShowTable<Item>::kMaxId;
+    table.emplace(5, [](Item& it) { it.value.store(5); });
+    table.emplace(2000000000, [](Item& it) { it.value.store(1); });
+    table.emplace(kDense + 12345, [](Item& it) { it.value.store(2); });
+    EXPECT_EQ(table.size(), 3u);
+    EXPECT_EQ(table.sparse_count(), 2u);
+    EXPECT_EQ(table.position(5), 5);
+    EXPECT_EQ(table.position(2000000000), kDense);
+    EXPECT_EQ(table.position(kDense + 12345), kDense + 1);
+    EXPECT_EQ(table.position(kDense + 1), -1);
+    EXPECT_EQ(table.find(2000000000)->value.load(), 1u);
+    EXPECT_EQ(table.at_position(kDense + 1), table.find(kDense + 12345));
+    EXPECT_EQ(table.find(kDense + 1), nullptr);
+    EXPECT_EQ(table.find(2000000001), nullptr);
+
+    // Erased sparse ids keep their position: emplacing again re-initialises the same object
+    Item* first = table.find(2000000000);
+    EXPECT_TRUE(table.erase(2000000000));
+    EXPECT_EQ(table.find(2000000000), nullptr);
+    EXPECT_TRUE(table.available(2000000000));
+    EXPECT_EQ(&table.emplace(2000000000, [](Item& it) { it.value.store(3); }), first);
+    EXPECT_EQ(table.sparse_count(), 2u);
+}
+
+TEST(ShowTable, ConcurrentFindDuringSparseEmplace) {
+    ShowTable<Item> table;
+    constexpr int kStride = 1 << 20;
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        while (!done.load()) {
+            for (int i = 0; i < 2000; i += 3) {
+                const Item* it = table.find(ShowTable<Item>::kMaxId + i * kStride / 1024);
+                if (it) {
+                    EXPECT_EQ(it->value.load(), static_cast<std::uint64_t>(i) + 1u);
+                }
+            }
+        }
+    });
+    for (int i = 0; i < 2000; ++i) {
+        table.emplace(ShowTable<Item>::kMaxId + i * kStride / 1024,
+                      [&](Item& it) { it.value.store(static_cast<std::uint64_t>(i) + 1u); });
+    }
+    done.store(true);
+    reader.join();
+    EXPECT_EQ(table.size(), 2000u);
+    for (int i = 0; i < 2000; ++i) EXPECT_NE(table.find(ShowTable<Item>::kMaxId + i * kStride / 1024), nullptr);
+}
+
+TEST(ShowTable, ConcurrentFindDuringEmplace) {
+    ShowTable<Item> table;
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        while (!done.load()) {
+            for (int id = 0; id < 4096; id += 7) {
+                const Item* it = table.find(id);
+                if (it) {
+                    EXPECT_EQ(it->value.load(), static_cast<std::uint64_t>(id) + 1u);
+                }
+            }
+        }
+    });
+    for (int id = 0; id < 4096; ++id) {
+        table.emplace(id, [&](Item& it) { it.value.store(static_cast<std::uint64_t>(id) + 1u); });
+    }
+    done.store(true);
+    reader.join();
+    EXPECT_EQ(table.size(), 4096u);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "show_time_index.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::CatalogStatus;
+using booking::EpochManager;
+using booking::Movie;
+using booking::Show;
+using booking::ShowTimeIndex;
+using booking::Theater;
+
+namespace {
+
+constexpr booking::ShowTime kHour = 3600;
+
+std::vector<std::int64_t> ids_of(const std::vector<Show>& shows) {
+    std::vector<std::int64_t> ids;
+    for (const Show& s : shows) ids.push_back(s.id.value());
+    return ids;
+}
+
+} // namespace
+
+TEST(ShowTimeIndex, ScansOneTheaterInStartOrder) {
+    EpochManager epochs;
+    ShowTimeIndex<Show> index(epochs);
+    EXPECT_TRUE(index.insert(Show{3, 1, 7, 0, 20 * kHour}));
+    EXPECT_TRUE(index.insert(Show{1, 2, 7, 0, 18 * kHour}));
+    EXPECT_TRUE(index.insert(Show{2, 1, 7, 0, 18 * kHour})); // same start: by id
+    EXPECT_TRUE(index.insert(Show{4, 1, 8, 0, 19 * kHour})); // another theater
+    EXPECT_FALSE(index.insert(Show{2, 1, 7, 0, 18 * kHour}));
+    EXPECT_EQ(index.size(), 4u);
+
+    std::vector<std::int64_t> seen;
+    EpochManager::Guard guard(epochs);
+    index.scan(booking::TheaterId(7), 0, 24 * kHour, [&](const Show& s) { seen.push_back(s.id.value()); });
+    EXPECT_EQ(seen, (std::vector<std::int64_t>{1, 2, 3}));
+    seen.clear();
+    index.scan(booking::TheaterId(7), 18 * kHour + 1, 20 * kHour, [&](const Show& s) { seen.push_back(s.id.value()); });
+    EXPECT_TRUE(seen.empty()); // [from, to): the 20:00 show is past the end
+
+    EXPECT_TRUE(index.erase(Show{2, 1, 7, 0, 18 * kHour}));
+    EXPECT_FALSE(index.erase(Show{2, 1, 7, 0, 18 * kHour}));
+    index.scan(booking::TheaterId(7), 0, 24 * kHour, [&](const Show& s) { seen.push_back(s.id.value()); });
+    EXPECT_EQ(seen, (std::vector<std::int64_t>{1, 3}));
+}
+
+TEST(ShowTimeIndex, ReadersScanWhileTheWriterInsertsAndErases) {
+    EpochManager epochs;
+    ShowTimeIndex<Show> index(epochs);
+    for (std::int64_t id = 0; id < 200; id += 2) index.insert(Show{id, 1, 1, 0, id * 60});
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                EpochManager::Guard guard(epochs);
+                booking::ShowTime last = -1;
+                std::size_t evens = 0;
+                index.scan(booking::TheaterId(1), 0, 1000 * 60, [&](const Show& s) {
+                    EXPECT_GT(s.start_time, last); // ordered, never a torn node
+                    last = s.start_time;
+                    if (s.id.value() % 2 == 0) ++evens;
+                });
+                EXPECT_EQ(evens, 100u); // the stable entries are always all there
+            }
+        });
+    }
+    for (int round = 0; round < 200; ++round) {
+        for (std::int64_t id = 1; id < 200; id += 2) index.insert(Show{id, 1, 1, 0, id * 60});
+        for (std::int64_t id = 1; id < 200; id += 2) index.erase(Show{id, 1, 1, 0, id * 60});
+    }
+    done.store(true);
+    for (auto& r : readers) r.join();
+    EXPECT_EQ(index.size(), 100u);
+}
+
+TEST(ShowTimeIndex, ServiceKeepsItInStepWithTheCatalog) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_movie(Movie{2, "Heat"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{1, "Central"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(Theater{2, "Mall"}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(4, 10));
+    ASSERT_EQ(svc.add_show(Show{1, 1, 1, hall, 21 * kHour}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{2, 2, 1, hall, 18 * kHour}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{3, 1, 2, hall, 19 * kHour}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(Show{4, 1, 1, hall, 10 * kHour}), CatalogStatus::Ok);
+
+    EXPECT_EQ(ids_of(svc.find_theater_shows_between(1, 12 * kHour, 24 * kHour)), (std::vector<std::int64_t>{2, 1}));
+    const std::vector<Show> central = svc.find_theater_shows_between(1, 0, 24 * kHour);
+    ASSERT_EQ(central.size(), 3u);
+    EXPECT_EQ(central[0].movie_id, 1);
+    EXPECT_EQ(central[0].layout_id, hall);
+
+    ASSERT_EQ(svc.remove_show(2), CatalogStatus::Ok);
+    EXPECT_EQ(ids_of(svc.find_theater_shows_between(1, 0, 24 * kHour)), (std::vector<std::int64_t>{4, 1}));
+    EXPECT_EQ(svc.archive_shows_before(12 * kHour), 1u);
+    EXPECT_EQ(ids_of(svc.find_theater_shows_between(1, 0, 24 * kHour)), (std::vector<std::int64_t>{1}));
+    EXPECT_EQ(ids_of(svc.find_theater_shows_between(2, 0, 24 * kHour)), (std::vector<std::int64_t>{3}));
+    EXPECT_TRUE(svc.find_theater_shows_between(3, 0, 24 * kHour).empty());
+
+    const booking::LayoutId bigger = svc.add_layout(booking::HallLayout::uniform(6, 10));
+    ASSERT_EQ(svc.move_show(1, bigger, 5), booking::MoveStatus::Ok);
+    const std::vector<Show> moved = svc.find_theater_shows_between(1, 0, 24 * kHour);
+    ASSERT_EQ(moved.size(), 1u);
+    EXPECT_EQ(moved[0].layout_id, bigger);
+    EXPECT_EQ(moved[0].hall, 5);
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "sim_scheduler.hpp"
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+using booking::BookingResult;
+using booking::BookingService;
+using booking::HallLayout;
+using booking::SeatMask;
+using booking::ShowId;
+using booking::SimScheduler;
+
+namespace {
+
+/** @brief Outcome of one simulated run of four overlapping multi-row requests. */
+struct SimRun {
+    std::vector<BookingResult> results;
+    std::vector<SeatMask> seats;
+    int available = 0;
+    std::uint64_t hash = 0;
+    std::uint64_t switches = 0;
+};
+
+SimRun simulate(std::uint64_t seed) {
+    BookingService svc(HallLayout::uniform(3, 10));
+    const ShowId show = svc.find_show(1, 1);
+    const std::vector<std::vector<std::string>> requests = {
+        {"a1", "a2", "b1", "c3"},
+        {"b1", "b2", "c1"},
+        {"a2", "c1", "c3"},
+        {"a5", "b5"},
+    };
+    SimRun run;
+    run.results.resize(requests.size());
+    std::vector<SimScheduler::Task> tasks;
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        tasks.push_back([&, i] {
+            run.results[i] = svc.book_seats(show, requests[i]);
+            if (i == 3 && run.results[i].success) {
+                // Cancels while the others may still be mid-request
+                run.results[i].success = !svc.cancel_seats(show, requests[i], run.results[i].id).success;
+            }
+        });
+    }
+    SimScheduler sim(seed);
+    sim.run(std::move(tasks));
+    const HallLayout& layout = *svc.layout_for_show(show);
+    for (const std::vector<std::string>& labels : requests) {
+        SeatMask mask;
+        for (const std::string& label : labels) {
+            int seat = -1;
+            EXPECT_TRUE(layout.try_parse_label(label, seat));
+            mask.set(seat);
+        }
+        run.seats.push_back(mask);
+    }
+    run.available = svc.available_count(show);
+    run.hash = sim.schedule_hash();
+    run.switches = sim.switches();
+    return run;
+}
+
+} // namespace
+
+TEST(SimScheduler, SameSeedSameInterleaving) {
+    if (!BOOKING_SIMULATION) GTEST_SKIP() << "built without schedule points";
+    for (std::uint64_t seed = 1; seed <= 20; ++seed) {
+        const SimRun a = simulate(seed);
+        const SimRun b = simulate(seed);
+        EXPECT_EQ(a.hash, b.hash) << seed;
+        EXPECT_EQ(a.switches, b.switches) << seed;
+        EXPECT_EQ(a.available, b.available) << seed;
+        for (std::size_t i = 0; i < a.results.size(); ++i) {
+            EXPECT_EQ(a.results[i].status, b.results[i].status) << seed;
+            EXPECT_EQ(a.results[i].success, b.results[i].success) << seed;
+        }
+    }
+}
+
+TEST(SimScheduler, SweepKeepsBookingsConsistent) {
+    if (!BOOKING_SIMULATION) GTEST_SKIP() << "built without schedule points";
+    std::set<std::uint64_t> schedules;
+    std::set<int> winners_seen;
+    for (std::uint64_t seed = 0; seed < 300; ++seed) {
+        const SimRun run = simulate(seed);
+        schedules.insert(run.hash);
+
+        // Successful requests never overlap, and exactly their seats are taken
+        int taken = 0;
+        int winners = 0;
+        for (std::size_t i = 0; i < run.results.size(); ++i) {
+            if (!run.results[i].success) continue;
+            winners |= 1 << static_cast<int>(i);
+            taken += run.seats[i].count();
+            for (std::size_t j = i + 1; j < run.results.size(); ++j) {
+                if (!run.results[j].success) continue;
+                for (int w = 0; w < 3; ++w) {
+                    EXPECT_EQ(run.seats[i].word(w) & run.seats[j].word(w), 0u) << "seed " << seed;
+                }
+            }
+        }
+        EXPECT_EQ(run.available, 30 - taken) << "seed " << seed;
+        winners_seen.insert(winners);
+    }
+    // The seeds explore more than one interleaving and more than one set of winners
+    EXPECT_GT(schedules.size(), 10u);
+    EXPECT_GT(winners_seen.size(), 1u);
+}
+
+TEST(SimScheduler, FindsAndReplaysARace) {
+    if (!BOOKING_SIMULATION) GTEST_SKIP() << "built without schedule points";
+    // A read-modify-write that is not atomic: some interleaving loses an update
+    const auto racy_total = [](std::uint64_t seed) {
+        int counter = 0;
+        std::vector<SimScheduler::Task> tasks;
+        for (int t = 0; t < 3; ++t) {
+            tasks.push_back([&] {
+                for (int i = 0; i < 4; ++i) {
+                    const int seen = counter;
+                    booking::sim_point();
+                    counter = seen + 1;
+                }
+            });
+        }
+        SimScheduler sim(seed);
+        sim.run(std::move(tasks));
+        return counter;
+    };
+    std::uint64_t failing = 0;
+    bool found = false;
+    for (std::uint64_t seed = 0; seed < 100 && !found; ++seed) {
+        if (racy_total(seed) != 12) {
+            failing = seed;
+            found = true;
+        }
+    }
+    ASSERT_TRUE(found);
+    const int lost = racy_total(failing);
+    for (int replay = 0; replay < 5; ++replay) EXPECT_EQ(racy_total(failing), lost);
+}
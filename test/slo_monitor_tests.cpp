@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "slo_monitor.hpp"
+
+#include <string>
+#include <vector>
+
+using booking::BookingService;
+using booking::LatencyHistogram;
+using booking::MetricsApi;
+using booking::ServiceMetrics;
+using booking::SloAlert;
+using booking::SloBudget;
+using booking::SloMonitor;
+using booking::SloPolicy;
+using booking::SloStatus;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Totals = std::array<ServiceMetrics::ApiTotals, booking::kMetricsApis>;
+
+/** @brief Adds @p fast calls of 100 us and @p slow calls of 10 ms to book_seats. */
+void add_calls(Totals& totals, int fast, int slow) {
+    LatencyHistogram& h = totals[static_cast<std::size_t>(MetricsApi::BookSeats)].latency;
+    for (int i = 0; i < fast; ++i) h.record(100'000u);
+    for (int i = 0; i < slow; ++i) h.record(10'000'000u);
+}
+
+SloPolicy book_policy(std::vector<SloAlert>& alerts) {
+    SloPolicy policy;
+    policy.budgets.push_back(SloBudget{MetricsApi::BookSeats, 2ms, 0.99});
+    policy.window = 3600s;
+    policy.short_window = 300s;
+    policy.min_calls = 100;
+    policy.on_alert = [&alerts](const SloAlert& a) { alerts.push_back(a); };
+    return policy;
+}
+
+} // namespace
+
+TEST(SloMonitor, ComplianceOverTheWindow) {
+    std::vector<SloAlert> alerts;
+    SloMonitor monitor(book_policy(alerts));
+    Totals totals{};
+    const SloMonitor::Clock::time_point t0{};
+    add_calls(totals, 5000, 50); // before the first sample: not in any window
+    monitor.sample(totals, t0);
+    add_calls(totals, 9950, 50);
+    monitor.sample(totals, t0 + 600s);
+
+    const std::vector<SloStatus> s = monitor.status();
+    ASSERT_EQ(s.size(), 1u);
+    EXPECT_EQ(s[0].calls, 10000u);
+    EXPECT_EQ(s[0].within, 9950u);
+    EXPECT_DOUBLE_EQ(s[0].compliance, 0.995);
+    EXPECT_NEAR(s[0].burn_rate, 0.5, 1e-9); // half the allowed 1%
+    EXPECT_NEAR(s[0].budget_left, 0.5, 1e-9);
+    EXPECT_FALSE(s[0].alerting);
+    EXPECT_TRUE(alerts.empty());
+
+    // Points older than the window drop out
+    monitor.sample(totals, t0 + 600s + 3600s);
+    EXPECT_EQ(monitor.status()[0].calls, 0u);
+    EXPECT_DOUBLE_EQ(monitor.status()[0].compliance, 1.0);
+
+    // Whole buckets only: a threshold inside a bucket does not count that bucket
+    LatencyHistogram h;
+    h.record(2'000'000u);
+    EXPECT_EQ(SloMonitor::within(h, 2ms), 0u);
+    EXPECT_EQ(SloMonitor::within(h, 3ms), 1u);
+}
+
+TEST(SloMonitor, FastBurnFiresAndResolves) {
+    std::vector<SloAlert> alerts;
+    SloMonitor monitor(book_policy(alerts));
+    Totals totals{};
+    const SloMonitor::Clock::time_point t0{};
+    monitor.sample(totals, t0);
+    add_calls(totals, 1000, 0);
+    monitor.sample(totals, t0 + 60s);
+    add_calls(totals, 30, 1); // 1 slow call: far too few to fire
+    monitor.sample(totals, t0 + 120s);
+    EXPECT_TRUE(alerts.empty());
+
+    // A premiere: 30% of calls slow for a few minutes
+    for (int m = 3; m <= 6; ++m) {
+        add_calls(totals, 700, 300);
+        monitor.sample(totals, t0 + std::chrono::minutes(m));
+    }
+    ASSERT_EQ(alerts.size(), 1u);
+    EXPECT_TRUE(alerts[0].firing);
+    EXPECT_EQ(alerts[0].status.budget.api, MetricsApi::BookSeats);
+    EXPECT_GE(alerts[0].status.short_burn_rate, 14.4);
+    EXPECT_TRUE(monitor.status()[0].alerting);
+
+    // Recovered: the short window clears first and resolves the alert
+    for (int m = 7; m <= 20; ++m) {
+        add_calls(totals, 2000, 0);
+        monitor.sample(totals, t0 + std::chrono::minutes(m));
+    }
+    ASSERT_EQ(alerts.size(), 2u);
+    EXPECT_FALSE(alerts[1].firing);
+    EXPECT_FALSE(monitor.status()[0].alerting);
+    EXPECT_GT(monitor.status()[0].burn_rate, 1.0); // the long window still remembers
+}
+
+TEST(SloMonitor, ServiceTracksItsOwnCalls) {
+    if (!BOOKING_METRICS) GTEST_SKIP() << "built without metrics";
+    BookingService svc;
+    const booking::ShowId show = svc.find_show(1, 1);
+    EXPECT_FALSE(svc.evaluate_slos());
+    EXPECT_TRUE(svc.slo_status().empty());
+
+    std::vector<SloAlert> alerts;
+    SloPolicy policy = book_policy(alerts);
+    policy.budgets[0].threshold = 0ns; // every call misses it
+    policy.budgets.push_back(SloBudget{MetricsApi::AvailableCount, 10s, 0.999});
+    policy.min_calls = 10;
+    policy.interval = std::chrono::hours(1); // samples are taken by hand below
+    svc.set_slos(policy);
+
+    for (int i = 1; i <= 20; ++i) svc.book_seats(show, {"a" + std::to_string(i)});
+    for (int i = 0; i < 20; ++i) svc.available_count(show);
+    ASSERT_TRUE(svc.evaluate_slos(std::chrono::steady_clock::now() + 1s));
+
+    const std::vector<SloStatus> s = svc.slo_status();
+    ASSERT_EQ(s.size(), 2u);
+    EXPECT_EQ(s[0].calls, 20u);
+    EXPECT_DOUBLE_EQ(s[0].compliance, 0.0);
+    EXPECT_TRUE(s[0].alerting);
+    EXPECT_EQ(s[1].calls, 20u);
+    EXPECT_DOUBLE_EQ(s[1].compliance, 1.0);
+    ASSERT_EQ(alerts.size(), 1u);
+
+    const std::string text = svc.metrics_prometheus();
+    EXPECT_NE(text.find("booking_slo_compliance{api=\"book_seats\"} 0.000000"), std::string::npos);
+    EXPECT_NE(text.find("booking_slo_burn_rate{api=\"available_count\",window=\"short\"} 0.000000"),
+              std::string::npos);
+
+    svc.set_slos(SloPolicy{});
+    EXPECT_TRUE(svc.slo_status().empty());
+    EXPECT_EQ(svc.metrics_prometheus().find("booking_slo_"), std::string::npos);
+}
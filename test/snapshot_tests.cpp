@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::SeatMask;
+using booking::SnapshotStatus;
+
+namespace {
+
+std::string snapshot_path(const char* name) {
+    return ::testing::TempDir() + name;
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string& path, const std::string& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << bytes;
+}
+
+} // namespace
+
+TEST(Snapshot, RoundTripsCatalogBookingsAndOwners) {
+    const std::string path = snapshot_path("snapshot_roundtrip.bin");
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), booking::CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{7, "Roxy"}), booking::CatalogStatus::Ok);
+    const booking::LayoutId wide = svc.add_layout(HallLayout({{"a", 10}, {"bb", 12}, {"c", 64}, {"d", 5}, {"e", 5}}));
+    ASSERT_EQ(svc.add_show(booking::Show{10, 1, 7, wide}), booking::CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_show(booking::Show{11, 1, 7, wide, 72000, 2}), booking::CatalogStatus::Ok); // never booked
+
+    const auto first = svc.book_seats(10, {"a1", "bb12"});
+    const auto second = svc.book_seats(10, {"c64", "e5"});
+    ASSERT_TRUE(first.success && second.success);
+    const auto hold = svc.hold_seats(10, {"d1"}, std::chrono::minutes(5));
+    ASSERT_TRUE(hold.success);
+
+    ASSERT_EQ(svc.write_snapshot(path), SnapshotStatus::Ok);
+
+    BookingService restored{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(restored.restore_snapshot(path), SnapshotStatus::Ok);
+    ASSERT_EQ(restored.list_movies().size(), 1u);
+    EXPECT_EQ(restored.list_movies()[0].title, "Dune");
+    ASSERT_EQ(restored.list_theaters_for_movie(1).size(), 1u);
+    EXPECT_EQ(restored.list_theaters_for_movie(1)[0].name, "Roxy");
+    EXPECT_EQ(restored.find_shows(1, 7), (std::vector<booking::ShowId>{10, 11}));
+    const std::vector<booking::Show> evening = restored.find_shows_between(1, 7, 72000, 72001);
+    ASSERT_EQ(evening.size(), 1u);
+    EXPECT_EQ(evening[0].id, 11);
+    EXPECT_EQ(evening[0].hall, 2);
+    EXPECT_EQ(restored.layout_for_show(10)->row_label(1), "bb");
+
+    // Held seats are not persisted
+    EXPECT_EQ(restored.available_count(10), svc.available_count(10) + 1);
+    EXPECT_EQ(restored.available_count(11), restored.layout_for_show(11)->seat_count());
+
+    const HallLayout& layout = *restored.layout_for_show(10);
+    EXPECT_EQ(restored.seat_owner(10, HallLayout::seat_index(2, 63)), second.id);
+    SeatMask seats;
+    EXPECT_EQ(restored.booking_seats(10, static_cast<booking::BookingId>(first.id), seats), 2);
+    EXPECT_EQ(restored.book_seats(10, {"a1"}).status, BookingStatus::AlreadyBooked);
+    EXPECT_TRUE(restored.book_seats(10, {"d1"}).success);
+
+    // Restored bookings can be cancelled, and new ids never collide with them
+    EXPECT_TRUE(restored.cancel_seats(10, {"a1", "bb12"}, static_cast<booking::BookingId>(first.id)).success);
+    const auto fresh = restored.book_seats(10, {"a2"});
+    ASSERT_TRUE(fresh.success);
+    EXPECT_GT(fresh.id, std::max(first.id, second.id));
+    EXPECT_TRUE(layout.contains(HallLayout::seat_index(1, 11)));
+    std::remove(path.c_str());
+}
+
+TEST(Snapshot, KeepsLayoutLabelGrammars) {
+    const std::string path = snapshot_path("snapshot_grammar.bin");
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), booking::CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{7, "Roxy"}), booking::CatalogStatus::Ok);
+    const auto grammar = booking::seat_label::LabelGrammar::SeatRow;
+    ASSERT_EQ(svc.add_show(booking::Show{10, 1, 7, svc.add_layout(HallLayout::uniform(2, 8, grammar))}),
+              booking::CatalogStatus::Ok);
+    ASSERT_TRUE(svc.book_seats(10, {"8b"}).success);
+    ASSERT_EQ(svc.write_snapshot(path), SnapshotStatus::Ok);
+
+    BookingService restored{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(restored.restore_snapshot(path), SnapshotStatus::Ok);
+    EXPECT_EQ(restored.layout_for_show(10)->label_grammar(), grammar);
+    EXPECT_EQ(restored.book_seats(10, {"8b"}).status, BookingStatus::AlreadyBooked);
+    EXPECT_TRUE(restored.book_seats(10, {"1a"}).success);
+    std::remove(path.c_str());
+}
+
+TEST(Snapshot, RejectsDamagedFiles) {
+    const std::string path = snapshot_path("snapshot_damaged.bin");
+    BookingService svc;
+    ASSERT_TRUE(svc.book_seats(1, {"a3"}).success);
+    ASSERT_EQ(svc.write_snapshot(path), SnapshotStatus::Ok);
+    const std::string good = read_file(path);
+    ASSERT_EQ(good.size() % 8u, 0u);
+
+    std::string flipped = good;
+    flipped[good.size() - 1] ^= 0x20; // a row label byte
+    write_file(path, flipped);
+    EXPECT_EQ(BookingService{BookingService::EmptyCatalog{}}.restore_snapshot(path), SnapshotStatus::Corrupt);
+
+    write_file(path, good.substr(0, good.size() - 8));
+    EXPECT_EQ(BookingService{BookingService::EmptyCatalog{}}.restore_snapshot(path), SnapshotStatus::Corrupt);
+
+    std::string magic = good;
+    magic[0] = 'X';
+    write_file(path, magic);
+    EXPECT_EQ(BookingService{BookingService::EmptyCatalog{}}.restore_snapshot(path), SnapshotStatus::BadMagic);
+
+    std::string version = good;
+    version[8] = 99;
+    write_file(path, version);
+    EXPECT_EQ(BookingService{BookingService::EmptyCatalog{}}.restore_snapshot(path),
+              SnapshotStatus::UnsupportedVersion);
+
+    // Ids clash with the sample catalog: nothing is restored
+    write_file(path, good);
+    BookingService sample;
+    EXPECT_EQ(sample.restore_snapshot(path), SnapshotStatus::CatalogError);
+    EXPECT_EQ(sample.available_count(1), 20);
+
+    std::remove(path.c_str());
+    EXPECT_EQ(BookingService{BookingService::EmptyCatalog{}}.restore_snapshot(path), SnapshotStatus::IoError);
+}
+
+TEST(Snapshot, WritesWhileBookingsRun) {
+    const std::string path = snapshot_path("snapshot_concurrent.bin");
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), booking::CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), booking::CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(HallLayout::uniform(8, 64));
+    for (int s = 0; s < 16; ++s) ASSERT_EQ(svc.add_show(booking::Show{s, 1, 1, hall}), booking::CatalogStatus::Ok);
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 3; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+                SeatMask seats;
+                if (!svc.book_best_available((i * 3 + t) % 16, 1 + i % 4, seats).success && i > 4096) break;
+            }
+        });
+    }
+    for (int i = 0; i < 5; ++i) ASSERT_EQ(svc.write_snapshot(path), SnapshotStatus::Ok);
+    stop.store(true);
+    for (auto& w : workers) w.join();
+
+    // Every restored booked seat is owned by the booking that owns it live
+    BookingService restored{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(restored.restore_snapshot(path), SnapshotStatus::Ok);
+    for (int s = 0; s < 16; ++s) {
+        const auto* layout = restored.layout_for_show(s);
+        ASSERT_NE(layout, nullptr);
+        int booked = 0;
+        for (int r = 0; r < layout->row_count(); ++r) {
+            for (int c = 0; c < layout->row_seats(r); ++c) {
+                const int seat = HallLayout::seat_index(r, c);
+                const booking::BookingId owner = restored.seat_owner(s, seat);
+                if (owner == 0u) continue;
+                ++booked;
+                EXPECT_EQ(owner, svc.seat_owner(s, seat));
+            }
+        }
+        EXPECT_EQ(booked, layout->seat_count() - restored.available_count(s));
+    }
+    std::remove(path.c_str());
+}
+
+TEST(Snapshot, EncodesSeatMapsCompactly) {
+    const std::string path = snapshot_path("snapshot_compact.bin");
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), booking::CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), booking::CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(HallLayout::uniform(30, 40));
+    constexpr int kShows = 20;
+    for (int s = 0; s < kShows; ++s) ASSERT_EQ(svc.add_show(booking::Show{s, 1, 1, hall}), booking::CatalogStatus::Ok);
+    // Half the shows sell out in groups of four, the others stay empty
+    for (int s = 0; s < kShows; s += 2) {
+        for (int r = 0; r < 30; ++r) {
+            for (int c = 0; c < 40; c += 4) {
+                SeatMask group;
+                for (int k = 0; k < 4; ++k) group.set(HallLayout::seat_index(r, c + k));
+                ASSERT_TRUE(svc.book_seat_mask(s, group).success);
+            }
+        }
+    }
+    ASSERT_EQ(svc.write_snapshot(path), SnapshotStatus::Ok);
+    // Raw words and owner tables alone would take 30 * (8 + 256) bytes per sold-out show
+    EXPECT_LT(read_file(path).size() * 8u, kShows / 2u * 30u * (8u + 256u));
+
+    BookingService restored{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(restored.restore_snapshot(path), SnapshotStatus::Ok);
+    for (int s = 0; s < kShows; ++s) {
+        EXPECT_EQ(restored.available_count(s), s % 2 == 0 ? 0 : 1200);
+    }
+    EXPECT_EQ(restored.seat_owner(0, HallLayout::seat_index(3, 5)), svc.seat_owner(0, HallLayout::seat_index(3, 5)));
+    EXPECT_NE(restored.seat_owner(0, HallLayout::seat_index(3, 5)), restored.seat_owner(0, HallLayout::seat_index(3, 3)));
+    std::remove(path.c_str());
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "sparse_id_map.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using booking::SparseIdMap;
+
+TEST(SparseIdMap, InsertsAndFinds) {
+    SparseIdMap map;
+    EXPECT_EQ(map.find(42), SparseIdMap::kNoSlot);
+    EXPECT_EQ(map.capacity(), 0u);
+    EXPECT_TRUE(map.insert(42, 7));
+    EXPECT_TRUE(map.insert(~std::uint64_t{0}, 8));
+    EXPECT_TRUE(map.insert(0, 9));
+    EXPECT_FALSE(map.insert(42, 10));
+    EXPECT_EQ(map.size(), 3u);
+    EXPECT_EQ(map.find(42), 7u);
+    EXPECT_EQ(map.find(~std::uint64_t{0}), 8u);
+    EXPECT_EQ(map.find(0), 9u);
+    EXPECT_EQ(map.find(43), SparseIdMap::kNoSlot);
+}
+
+TEST(SparseIdMap, GrowsKeepingEveryEntry) {
+    SparseIdMap map;
+    // Sparse 64-bit ids with a common stride, as a scheduling system might hand out
+    constexpr std::uint64_t kStride = std::uint64_t{1} << 32;
+    for (std::uint32_t i = 0; i < 100000; ++i) ASSERT_TRUE(map.insert(i * kStride + 17u, i));
+    EXPECT_EQ(map.size(), 100000u);
+    // At most 7/8 full
+    EXPECT_GE(map.capacity() * 7u, map.size() * 8u);
+    for (std::uint32_t i = 0; i < 100000; ++i) ASSERT_EQ(map.find(i * kStride + 17u), i);
+    for (std::uint32_t i = 0; i < 1000; ++i) EXPECT_EQ(map.find(i * kStride + 18u), SparseIdMap::kNoSlot);
+}
+
+TEST(SparseIdMap, FullGroupsProbeOnward) {
+    // Ids chosen to share their home group: lookups must probe past full groups
+    SparseIdMap map;
+    ASSERT_TRUE(map.insert(1, 0));
+    const std::uint64_t groups = map.capacity() / SparseIdMap::kGroupSize;
+    const auto home = [&](std::uint64_t id) { return (SparseIdMap::hash(id) >> 7) & (groups - 1u); };
+    std::vector<std::uint64_t> same;
+    for (std::uint64_t id = 2; same.size() < 40u; ++id) {
+        if (home(id) == home(1)) same.push_back(id);
+    }
+    std::uint32_t slot = 1;
+    for (std::uint64_t id : same) ASSERT_TRUE(map.insert(id, slot++));
+    slot = 1;
+    for (std::uint64_t id : same) EXPECT_EQ(map.find(id), slot++);
+    EXPECT_EQ(map.find(1), 0u);
+}
+
+TEST(SparseIdMap, ConcurrentFindDuringInsert) {
+    SparseIdMap map;
+    constexpr std::uint32_t kIds = 50000;
+    std::atomic<bool> done{false};
+    std::atomic<int> wrong{0};
+    std::thread reader([&] {
+        while (!done.load()) {
+            for (std::uint32_t i = 0; i < kIds; i += 97) {
+                const std::uint32_t slot = map.find(std::uint64_t{i} * 1000003u);
+                if (slot != SparseIdMap::kNoSlot && slot != i) wrong.fetch_add(1);
+            }
+        }
+    });
+    for (std::uint32_t i = 0; i < kIds; ++i) map.insert(std::uint64_t{i} * 1000003u, i);
+    done.store(true);
+    reader.join();
+    EXPECT_EQ(wrong.load(), 0);
+    for (std::uint32_t i = 0; i < kIds; i += 13) EXPECT_EQ(map.find(std::uint64_t{i} * 1000003u), i);
+}
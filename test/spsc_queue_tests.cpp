@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "spsc_queue.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+
+using booking::SpscQueue;
+
+TEST(SpscQueue, KeepsFifoOrderAndReportsFullAndEmpty) {
+    SpscQueue<int> q(4);
+    EXPECT_EQ(q.capacity(), 4u);
+    int out = 0;
+    EXPECT_FALSE(q.pop(out));
+    EXPECT_TRUE(q.empty());
+
+    for (int i = 0; i < 4; ++i) EXPECT_TRUE(q.push(i));
+    EXPECT_FALSE(q.push(99));
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(q.pop(out));
+        EXPECT_EQ(out, i);
+    }
+    EXPECT_FALSE(q.pop(out));
+
+    // Wraps around the ring
+    for (int round = 0; round < 10; ++round) {
+        EXPECT_TRUE(q.push(round));
+        EXPECT_TRUE(q.push(round + 100));
+        ASSERT_TRUE(q.pop(out));
+        EXPECT_EQ(out, round);
+        ASSERT_TRUE(q.pop(out));
+        EXPECT_EQ(out, round + 100);
+    }
+}
+
+TEST(SpscQueue, RejectsCapacitiesThatAreNotPowersOfTwo) {
+    EXPECT_THROW(SpscQueue<int>(0), std::invalid_argument);
+    EXPECT_THROW(SpscQueue<int>(1), std::invalid_argument);
+    EXPECT_THROW(SpscQueue<int>(12), std::invalid_argument);
+}
+
+TEST(SpscQueue, TransfersEveryValueBetweenTwoThreads) {
+    constexpr std::uint64_t kValues = 200000;
+    SpscQueue<std::uint64_t> q(64);
+    std::thread producer([&] {
+        for (std::uint64_t v = 1; v <= kValues; ++v) {
+            while (!q.push(v)) std::this_thread::yield();
+        }
+    });
+
+    std::uint64_t expected = 1;
+    std::uint64_t sum = 0;
+    while (expected <= kValues) {
+        std::uint64_t v = 0;
+        if (!q.pop(v)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(v, expected);
+        sum += v;
+        ++expected;
+    }
+    producer.join();
+    EXPECT_EQ(sum, kValues * (kValues + 1) / 2);
+}
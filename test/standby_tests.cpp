@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "standby.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+using booking::BookingId;
+using booking::BookingResult;
+using booking::BookingService;
+using booking::HallLayout;
+using booking::JournalMode;
+using booking::JournalStatus;
+using booking::ShowId;
+using booking::SnapshotStatus;
+using booking::StandbyOptions;
+using booking::WarmStandby;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::string temp_path(const char* name) {
+    const std::string path = ::testing::TempDir() + name;
+    std::remove(path.c_str());
+    return path;
+}
+
+bool same_seats(const BookingService& a, const BookingService& b, ShowId show) {
+    if (a.available_count(show) != b.available_count(show)) return false;
+    for (int seat = 0; seat < HallLayout::kMaxRows * HallLayout::kMaxRowSeats; ++seat) {
+        if (a.seat_owner(show, seat) != b.seat_owner(show, seat)) return false;
+    }
+    return true;
+}
+
+/** @brief True once @p standby has applied the journal up to @p lsn (waits up to 5 s). */
+bool catches_up(const WarmStandby& standby, std::uint64_t lsn) {
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (standby.next_lsn() < lsn) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(WarmStandby, TailsThePrimaryAndIsPromotedWithoutReplay) {
+    const std::string journal = temp_path("standby_primary.jrnl");
+    const std::string snapshot = temp_path("standby_primary.snap");
+    auto primary = std::make_unique<BookingService>(HallLayout::uniform(4, 10));
+    ASSERT_EQ(primary->open_journal(journal, JournalMode::Sync), JournalStatus::Ok);
+    const ShowId show = primary->find_show(1, 1);
+    const BookingResult early = primary->book_seats(show, {"a1", "a2"});
+    ASSERT_TRUE(early.success);
+    ASSERT_EQ(primary->write_snapshot(snapshot), SnapshotStatus::Ok);
+    const BookingResult group = primary->book_seats(show, {"b3", "c3", "d3"});
+    ASSERT_TRUE(group.success);
+
+    BookingService standby_svc{BookingService::EmptyCatalog{}};
+    StandbyOptions options;
+    options.snapshot_path = snapshot;
+    options.journal_path = journal;
+    WarmStandby standby(standby_svc, options);
+    ASSERT_EQ(standby.start(), SnapshotStatus::Ok);
+    ASSERT_TRUE(catches_up(standby, primary->journal_durable_lsn()));
+    EXPECT_EQ(standby.applied_records(), 1u); // the early booking came from the snapshot
+    EXPECT_TRUE(same_seats(*primary, standby_svc, show));
+
+    // Live bookings and cancellations follow within the poll interval
+    ASSERT_TRUE(primary->cancel_seats(show, {"a1"}, static_cast<BookingId>(early.id)).success);
+    const BookingResult late = primary->book_seats(show, {"a1", "a3"});
+    ASSERT_TRUE(late.success);
+    ASSERT_TRUE(catches_up(standby, primary->journal_durable_lsn()));
+    EXPECT_TRUE(same_seats(*primary, standby_svc, show));
+    EXPECT_LT(standby.staleness(), 5s);
+
+    // The primary fails; the standby takes over its journal
+    const std::uint64_t failed_at = primary->journal_durable_lsn();
+    primary.reset();
+    ASSERT_EQ(standby.promote(), JournalStatus::Ok);
+    EXPECT_TRUE(standby.promoted());
+    EXPECT_EQ(standby.next_lsn(), failed_at);
+    const BookingResult after = standby_svc.book_seats(show, {"a4"});
+    ASSERT_TRUE(after.success);
+    EXPECT_GT(after.id, late.id); // ids continue past every applied booking
+    EXPECT_FALSE(standby_svc.book_seats(show, {"a3"}).success);
+
+    // The journal continues where the primary's ended: snapshot + journal rebuild the state
+    ASSERT_TRUE(standby_svc.sync_journal());
+    BookingService rebuilt{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(rebuilt.restore_snapshot(snapshot), SnapshotStatus::Ok);
+    EXPECT_EQ(rebuilt.replay_journal(journal).applied, 4u);
+    EXPECT_TRUE(same_seats(standby_svc, rebuilt, show));
+}
+
+TEST(WarmStandby, WaitsForTheJournalAndFollowsCompaction) {
+    const std::string journal = temp_path("standby_compacted.jrnl");
+    BookingService standby_svc(HallLayout::uniform(4, 10)); // same schedule, no snapshot
+    StandbyOptions options;
+    options.journal_path = journal;
+    WarmStandby standby(standby_svc, options);
+    ASSERT_EQ(standby.start(), SnapshotStatus::Ok); // the primary has not started yet
+    std::this_thread::sleep_for(5ms);
+    EXPECT_EQ(standby.next_lsn(), 0u);
+
+    BookingService primary(HallLayout::uniform(4, 10));
+    ASSERT_EQ(primary.open_journal(journal, JournalMode::Sync), JournalStatus::Ok);
+    const ShowId show = primary.find_show(1, 1);
+    for (const char* seat : {"a1", "a2", "a3"}) ASSERT_TRUE(primary.book_seats(show, {seat}).success);
+    ASSERT_TRUE(catches_up(standby, primary.journal_durable_lsn()));
+
+    // Compaction replaces the file: the standby finishes the old one and goes on in the new one
+    ASSERT_EQ(primary.compact_journal(primary.journal_durable_lsn()), JournalStatus::Ok);
+    for (const char* seat : {"b1", "b2"}) ASSERT_TRUE(primary.book_seats(show, {seat}).success);
+    ASSERT_TRUE(catches_up(standby, primary.journal_durable_lsn()));
+    EXPECT_TRUE(same_seats(primary, standby_svc, show));
+    EXPECT_EQ(standby.applied_records(), 5u);
+}
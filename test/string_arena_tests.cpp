@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "string_arena.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using booking::StringArena;
+
+TEST(StringArena, StoresEqualStringsOnce) {
+    StringArena arena;
+    std::string title = "Arrival";
+    const std::string_view a = arena.intern(title);
+    title = "overwritten"; // the arena owns its copy
+    const std::string_view b = arena.intern("Arrival");
+    EXPECT_EQ(a, "Arrival");
+    EXPECT_EQ(a.data(), b.data());
+    EXPECT_NE(arena.intern("Arrival 2").data(), a.data());
+    EXPECT_EQ(arena.size(), 2u);
+    EXPECT_TRUE(arena.intern("").empty());
+    EXPECT_EQ(arena.size(), 3u);
+}
+
+TEST(StringArena, ViewsSurviveChunkGrowth) {
+    StringArena arena;
+    std::vector<std::string_view> views;
+    for (int i = 0; i < 20000; ++i) views.push_back(arena.intern("theater #" + std::to_string(i)));
+    const std::string big(StringArena::kChunkSize, 'x'); // gets a chunk of its own
+    const std::string_view big_view = arena.intern(big);
+    EXPECT_GT(arena.capacity_bytes(), StringArena::kChunkSize * 3);
+    for (int i = 0; i < 20000; ++i) ASSERT_EQ(views[static_cast<std::size_t>(i)], "theater #" + std::to_string(i));
+    EXPECT_EQ(big_view, big);
+    EXPECT_EQ(arena.intern("theater #7").data(), views[7].data());
+}
+
+TEST(StringArena, CatalogListingsShareInternedStrings) {
+    booking::BookingService svc{booking::BookingService::EmptyCatalog{}};
+    std::string title = "Dune";
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, title}), booking::CatalogStatus::Ok);
+    title.assign("Blade Runner"); // caller's buffer may change after add_movie
+    ASSERT_EQ(svc.add_movie(booking::Movie{2, "Dune"}), booking::CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), booking::CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(2, 10));
+    ASSERT_EQ(svc.add_show(booking::Show{1, 1, 1, hall}), booking::CatalogStatus::Ok);
+
+    const std::vector<booking::Movie> first = svc.list_movies();
+    ASSERT_EQ(first.size(), 2u);
+    EXPECT_EQ(first[0].title, "Dune");
+    EXPECT_EQ(first[0].title.data(), first[1].title.data()); // stored once
+    EXPECT_EQ(svc.list_movies()[0].title.data(), first[0].title.data());
+
+    // Views stay valid across later catalog updates (snapshots are replaced)
+    const std::string_view name = svc.list_theaters_for_movie(1).at(0).name;
+    for (int i = 2; i < 50; ++i) {
+        ASSERT_EQ(svc.add_theater(booking::Theater{i, "Hall " + std::to_string(i)}), booking::CatalogStatus::Ok);
+    }
+    EXPECT_EQ(name, "Roxy");
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include "schedule_loader.hpp"
+#include "tenant_registry.hpp"
+
+#include <string>
+#include <utility>
+
+using booking::CatalogStatus;
+using booking::Schedule;
+using booking::ScheduleStatus;
+using booking::Tenant;
+using booking::TenantAdmission;
+using booking::TenantQuota;
+using booking::TenantRegistry;
+
+namespace {
+
+Schedule schedule(const std::string& text) {
+    Schedule s;
+    EXPECT_EQ(booking::parse_schedule(text, 1, s).status, ScheduleStatus::Ok);
+    return s;
+}
+
+} // namespace
+
+TEST(TenantRegistry, TenantsHaveTheirOwnCatalogsAndSeats) {
+    TenantRegistry registry;
+    Tenant* roxy = registry.add_tenant("roxy");
+    Tenant* odeon = registry.add_tenant("odeon");
+    ASSERT_NE(roxy, nullptr);
+    ASSERT_NE(odeon, nullptr);
+    EXPECT_EQ(registry.add_tenant("roxy"), nullptr);
+    EXPECT_EQ(registry.add_tenant(""), nullptr);
+    EXPECT_EQ(registry.size(), 2u);
+    EXPECT_EQ(registry.find("odeon"), odeon);
+    EXPECT_EQ(registry.find("rialto"), nullptr);
+    ASSERT_EQ(registry.tenants().size(), 2u);
+    EXPECT_EQ(registry.tenants()[0], odeon); // name order
+
+    // The same show id in two chains is two shows
+    const std::string text = "movie,1,Dune\ntheater,1,Main\nlayout,1,2x10\nshow,5,1,1,1\n";
+    ASSERT_EQ(roxy->load_schedule(schedule(text)).status, ScheduleStatus::Ok);
+    ASSERT_EQ(odeon->load_schedule(schedule(text)).status, ScheduleStatus::Ok);
+    EXPECT_TRUE(roxy->service().book_seats(5, {"a1"}).success);
+    EXPECT_TRUE(odeon->service().book_seats(5, {"a1"}).success);
+    EXPECT_EQ(roxy->service().available_count(5), 19);
+    EXPECT_EQ(roxy->stats().shows, 1u);
+}
+
+TEST(TenantRegistry, QuotasContainANoisyTenant) {
+    TenantRegistry registry;
+    TenantQuota quota;
+    quota.max_shows = 2;
+    quota.requests = booking::AdmissionPolicy{1000.0, 2};
+    quota.max_in_flight = 1;
+    Tenant* noisy = registry.add_tenant("noisy", quota);
+    Tenant* quiet = registry.add_tenant("quiet");
+
+    // In-flight cap first: a busy tenant does not spend its rate
+    const std::int64_t t0 = 1'000'000'000;
+    {
+        Tenant::Ticket first = noisy->admit(t0);
+        ASSERT_TRUE(first);
+        EXPECT_EQ(noisy->admit(t0).status(), TenantAdmission::Busy);
+        EXPECT_EQ(noisy->stats().in_flight, 1u);
+    }
+    EXPECT_TRUE(noisy->admit(t0));
+    EXPECT_EQ(noisy->admit(t0).status(), TenantAdmission::RateLimited); // burst of two used up
+    EXPECT_TRUE(noisy->admit(t0 + 1'000'000));
+    for (int i = 0; i < 100; ++i) EXPECT_TRUE(quiet->admit(t0)); // unaffected
+
+    const booking::TenantStats stats = noisy->stats();
+    EXPECT_EQ(stats.admitted, 3u);
+    EXPECT_EQ(stats.rate_limited, 1u);
+    EXPECT_EQ(stats.busy, 1u);
+    EXPECT_EQ(stats.in_flight, 0u);
+
+    // Catalog quota
+    const std::string text = "movie,1,Dune\ntheater,1,Main\nlayout,1,2x10\nshow,1,1,1,1\n";
+    ASSERT_EQ(noisy->load_schedule(schedule(text)).status, ScheduleStatus::Ok);
+    EXPECT_EQ(noisy->load_schedule(schedule("show,2,1,1,1\nshow,3,1,1,1\nlayout,1,2x10\n")).status,
+              ScheduleStatus::CatalogError);
+    const booking::LayoutId layout = noisy->service().add_layout(booking::HallLayout::uniform(2, 10));
+    EXPECT_EQ(noisy->add_show(booking::Show{2, 1, 1, layout}), CatalogStatus::Ok);
+    EXPECT_EQ(noisy->add_show(booking::Show{3, 1, 1, layout}), CatalogStatus::OverQuota);
+
+    // Lifting the quota applies to the next request
+    noisy->set_quota(TenantQuota{});
+    for (int i = 0; i < 10; ++i) EXPECT_TRUE(noisy->admit(t0 + 1'000'000));
+    EXPECT_EQ(noisy->add_show(booking::Show{3, 1, 1, layout}), CatalogStatus::Ok);
+}
+
+TEST(TenantRegistry, ExportsMetricsPerTenant) {
+    TenantRegistry registry;
+    Tenant* roxy = registry.add_tenant("roxy");
+    registry.add_tenant("odeon");
+    ASSERT_EQ(roxy->load_schedule(schedule("movie,1,Dune\ntheater,1,Main\nlayout,1,2x10\nshow,1,1,1,1\n")).status,
+              ScheduleStatus::Ok);
+    ASSERT_TRUE(roxy->admit());
+    ASSERT_TRUE(roxy->service().book_seats(1, {"a1", "a2"}).success);
+
+    const std::string text = registry.metrics_prometheus();
+    EXPECT_NE(text.find("booking_tenant_requests_total{tenant=\"roxy\",outcome=\"admitted\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("booking_tenant_shows{tenant=\"odeon\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.find("booking_tenant_seats_booked{tenant=\"roxy\"} 2\n"), std::string::npos);
+    EXPECT_EQ(text.find("# TYPE booking_tenant_shows gauge"), text.rfind("# TYPE booking_tenant_shows gauge"));
+}
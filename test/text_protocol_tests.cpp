@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include "text_protocol.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using booking::BookingService;
+using booking::CommandOutcome;
+using booking::TextCommandHandler;
+
+namespace {
+std::string run(TextCommandHandler& h, const char* line) {
+    std::string out;
+    h.execute(line, out);
+    return out;
+}
+} // namespace
+
+TEST(TextProtocol, MirrorsTheCliCommands) {
+    BookingService svc;
+    TextCommandHandler h(svc);
+
+    EXPECT_EQ(run(h, "movies"), "1 Inception\n2 Interstellar\n3 The Matrix\nOK 3\n");
+    EXPECT_EQ(run(h, "theaters 1"), "1 Central Cinema\n2 Mall Theater\nOK 2\n");
+    EXPECT_EQ(run(h, "theaters 33"), "OK 0\n");
+    EXPECT_EQ(run(h, "movies 0 2"), "1 Inception\n2 Interstellar\nOK 2 2\n");
+    EXPECT_EQ(run(h, "movies 2 2"), "3 The Matrix\nOK 1\n");
+    EXPECT_EQ(run(h, "movies 2"), "ERR 0 usage: movies [<cursor> <limit>]\n");
+    EXPECT_EQ(run(h, "theaters 1 0 1"), "1 Central Cinema\nOK 1 2\n");
+    EXPECT_EQ(run(h, "theaters 1 2 1"), "2 Mall Theater\nOK 1\n");
+    EXPECT_EQ(run(h, "theaters 1 0 x"), "ERR 0 usage: theaters <movie_id> [<cursor> <limit>]\n");
+    EXPECT_EQ(run(h, "search The  MATRX"), "3 The Matrix\nOK 1\n");
+    EXPECT_EQ(run(h, "search in"), "1 Inception\n2 Interstellar\nOK 2\n");
+    EXPECT_EQ(run(h, "search"), "ERR 0 usage: search <title words>\n");
+    EXPECT_EQ(run(h, "seats 22 1"), "ERR 0 no show for that movie+theater\n");
+
+    const std::string booked = run(h, "book 1 1 a1 a2\r");
+    ASSERT_EQ(booked.rfind("OK ", 0), 0u) << booked;
+    const std::string id = booked.substr(3, booked.size() - 4);
+    EXPECT_EQ(run(h, "  book\t1 1 a2 "), "ERR 5 One or more seats already booked taken=a2 try=a3\n");
+    EXPECT_EQ(run(h, "book 1 1 a99"), "ERR 3 Invalid seat label: a99\n");
+
+    const std::string seats = run(h, "seats 1 1");
+    EXPECT_EQ(seats.substr(0, 7), "a3 a4 a");
+    EXPECT_EQ(seats.substr(seats.size() - 7), "\nOK 18\n");
+
+    EXPECT_EQ(run(h, ("cancel 1 1 " + id + " a1").c_str()), "OK\n");
+    EXPECT_EQ(run(h, ("cancel 1 1 " + id + " a1").c_str()), "ERR 12 Seats not owned by this booking\n");
+}
+
+TEST(TextProtocol, RejectsMalformedRequests) {
+    BookingService svc;
+    TextCommandHandler h(svc);
+    EXPECT_EQ(run(h, ""), "ERR 0 empty request\n");
+    EXPECT_EQ(run(h, "seaats"), "ERR 0 unknown command\n");
+    EXPECT_EQ(run(h, "theaters x"), "ERR 0 usage: theaters <movie_id> [<cursor> <limit>]\n");
+    EXPECT_EQ(run(h, "book 1 1"), "ERR 0 usage: book <movie_id> <theater_id> a1 a2 ...\n");
+    EXPECT_EQ(run(h, "book 1x 1 a1"), "ERR 0 movie and theater ids must be integers\n");
+    EXPECT_EQ(run(h, "cancel 1 1 abc a1"), "ERR 0 usage: cancel <movie_id> <theater_id> <booking_id> a1 a2 ...\n");
+
+    std::string out;
+    EXPECT_EQ(h.execute("quit", out), CommandOutcome::Close);
+    EXPECT_EQ(out, "OK\n");
+    out.clear();
+    EXPECT_EQ(h.execute("help", out), CommandOutcome::Continue);
+    EXPECT_EQ(out.substr(out.size() - 3), "OK\n");
+}
+
+TEST(TextProtocol, ParsesCommandsAndTokens) {
+    using booking::TextCommand;
+    for (const TextCommand c : {TextCommand::Movies, TextCommand::Search, TextCommand::Theaters, TextCommand::Seats,
+                                TextCommand::Book, TextCommand::Cancel, TextCommand::Export, TextCommand::Import,
+                                TextCommand::Help, TextCommand::Quit}) {
+        EXPECT_EQ(booking::parse_command(to_string(c)), c) << to_string(c);
+    }
+    EXPECT_EQ(booking::parse_command("exit"), TextCommand::Quit);
+    // Same slot or length as a command, but not one
+    EXPECT_EQ(booking::parse_command("boof"), TextCommand::Unknown);
+    EXPECT_EQ(booking::parse_command("Book"), TextCommand::Unknown);
+    EXPECT_EQ(booking::parse_command("books"), TextCommand::Unknown);
+    EXPECT_EQ(booking::parse_command(""), TextCommand::Unknown);
+    EXPECT_STREQ(to_string(TextCommand::Unknown), "unknown");
+
+    std::vector<std::string_view> tokens;
+    booking::split_tokens(" book\t1  2 a1 ", tokens);
+    EXPECT_EQ(tokens, (std::vector<std::string_view>{"book", "1", "2", "a1"}));
+    booking::MovieId movie = -1;
+    EXPECT_TRUE(booking::parse_token(tokens[1], movie));
+    EXPECT_EQ(movie, 1);
+    int n = 0;
+    EXPECT_FALSE(booking::parse_token("12x", n));
+    EXPECT_FALSE(booking::parse_token("", n));
+}
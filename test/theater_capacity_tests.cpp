@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "theater_capacity.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::CapacityCounter;
+using booking::CatalogStatus;
+
+namespace {
+
+constexpr booking::ShowTime kDay = 86400;
+constexpr booking::ShowTime kMonday = 20000 * kDay; // a UTC midnight
+
+/** @brief Service with movie 1 and theaters 1, 2; shows 1-2 run in theater 1 on one day, 3 the day after, 4 in theater 2. */
+std::unique_ptr<BookingService> capped_service() {
+    auto owned = std::make_unique<BookingService>(BookingService::EmptyCatalog{});
+    BookingService& svc = *owned;
+    EXPECT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), CatalogStatus::Ok);
+    EXPECT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), CatalogStatus::Ok);
+    EXPECT_EQ(svc.add_theater(booking::Theater{2, "Rialto"}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(2, 10));
+    EXPECT_EQ(svc.add_show(booking::Show{1, 1, 1, hall, kMonday + 3600, 1}), CatalogStatus::Ok);
+    EXPECT_EQ(svc.add_show(booking::Show{2, 1, 1, hall, kMonday + 80000, 2}), CatalogStatus::Ok);
+    EXPECT_EQ(svc.add_show(booking::Show{3, 1, 1, hall, kMonday + kDay + 3600, 1}), CatalogStatus::Ok);
+    EXPECT_EQ(svc.add_show(booking::Show{4, 1, 2, hall, kMonday + 3600, 1}), CatalogStatus::Ok);
+    return owned;
+}
+
+std::vector<std::string> labels(char row, int first, int last) {
+    std::vector<std::string> out;
+    for (int s = first; s <= last; ++s) out.push_back(std::string(1, row) + std::to_string(s));
+    return out;
+}
+
+} // namespace
+
+TEST(CapacityCounter, ReservesUpToTheCap) {
+    CapacityCounter counter(5);
+    EXPECT_TRUE(counter.try_reserve(3));
+    EXPECT_FALSE(counter.try_reserve(3));
+    EXPECT_TRUE(counter.try_reserve(2));
+    EXPECT_FALSE(counter.try_reserve(1));
+    counter.release(2);
+    EXPECT_EQ(counter.taken(), 3);
+    counter.add(4); // already taken elsewhere: counted past the cap
+    EXPECT_EQ(counter.taken(), 7);
+    EXPECT_FALSE(counter.try_reserve(1));
+    counter.set_cap(CapacityCounter::kUncapped);
+    EXPECT_TRUE(counter.try_reserve(1000));
+}
+
+TEST(TheaterCapacity, CapSpansTheTheatersHallsForOneDay) {
+    const auto owned = capped_service();
+    BookingService& svc = *owned;
+    ASSERT_TRUE(svc.book_seats(1, labels('a', 1, 4)).success); // before the cap: counted when it is set
+    EXPECT_EQ(svc.set_theater_daily_cap(9, 10), CatalogStatus::UnknownTheater);
+    ASSERT_EQ(svc.set_theater_daily_cap(1, 10), CatalogStatus::Ok);
+    EXPECT_EQ(svc.theater_attendance(1, kMonday).seats_taken, 4);
+    EXPECT_EQ(svc.theater_attendance(1, kMonday).cap, 10);
+
+    ASSERT_TRUE(svc.book_seats(2, labels('a', 1, 5)).success);
+    const auto over = svc.book_seats(2, labels('b', 1, 2));
+    EXPECT_EQ(over.status, BookingStatus::TheaterCapReached);
+    EXPECT_STREQ(to_string(over.status), "Theater attendance cap reached for the day");
+    ASSERT_TRUE(svc.book_seats(1, {"b10"}).success); // the last seat, from the other hall
+    EXPECT_EQ(svc.theater_attendance(1, kMonday + 7200).seats_taken, 10);
+    const auto free_seats = svc.list_available_seats(2);
+    EXPECT_NE(std::find(free_seats.begin(), free_seats.end(), "b1"), free_seats.end()); // refused seats stay free
+
+    // Other days and other theaters are not affected
+    EXPECT_TRUE(svc.book_seats(3, labels('a', 1, 10)).success);
+    EXPECT_TRUE(svc.book_seats(4, labels('a', 1, 10)).success);
+    EXPECT_EQ(svc.theater_attendance(1, kMonday + kDay).seats_taken, 10);
+    EXPECT_EQ(svc.theater_attendance(2, kMonday).cap, -1);
+
+    // Cancels give seats back; the other booking paths reserve too
+    EXPECT_EQ(svc.book_seats(2, {"b5"}).status, BookingStatus::TheaterCapReached);
+    booking::SeatMask best;
+    EXPECT_EQ(svc.book_best_available(2, 2, best).status, BookingStatus::TheaterCapReached);
+    EXPECT_EQ(svc.book_any_seats(2, {"b1", "b2"}, best).status, BookingStatus::TheaterCapReached);
+    EXPECT_EQ(svc.hold_seats(2, {"b1"}, std::chrono::seconds(30)).status, BookingStatus::TheaterCapReached);
+    const booking::SeatMask mine = [&] {
+        booking::SeatMask m;
+        EXPECT_EQ(svc.booking_seats(1, svc.seat_owner(1, 0), m), 4);
+        return m;
+    }();
+    ASSERT_TRUE(svc.cancel_seat_mask(1, mine, svc.seat_owner(1, 0)).success);
+    EXPECT_EQ(svc.theater_attendance(1, kMonday).seats_taken, 6);
+    ASSERT_EQ(svc.book_best_available(2, 3, best).status, BookingStatus::Ok);
+    const auto hold = svc.hold_seats(1, {"b1"}, std::chrono::seconds(30));
+    ASSERT_TRUE(hold.success);
+    EXPECT_FALSE(svc.book_seats(1, {"b2"}).success);
+    ASSERT_TRUE(svc.release_hold(hold.id).success);
+    EXPECT_TRUE(svc.book_seats(1, {"b2"}).success);
+
+    // A later show of the same day joins the counter; lifting the cap admits everything
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(1, 10));
+    ASSERT_EQ(svc.add_show(booking::Show{5, 1, 1, hall, kMonday + 1, 3}), CatalogStatus::Ok);
+    EXPECT_EQ(svc.book_seats(5, {"a1"}).status, BookingStatus::TheaterCapReached);
+    ASSERT_EQ(svc.set_theater_daily_cap(1, 12), CatalogStatus::Ok);
+    EXPECT_TRUE(svc.book_seats(5, {"a1", "a2"}).success);
+    ASSERT_EQ(svc.set_theater_daily_cap(1, -1), CatalogStatus::Ok);
+    EXPECT_TRUE(svc.book_seats(5, labels('a', 3, 10)).success);
+    EXPECT_EQ(svc.theater_attendance(1, kMonday).seats_taken, 20);
+    EXPECT_EQ(svc.theater_attendance(1, kMonday).cap, -1);
+}
+
+TEST(TheaterCapacity, ConcurrentBookersNeverExceedTheCap) {
+    BookingService svc{BookingService::EmptyCatalog{}};
+    ASSERT_EQ(svc.add_movie(booking::Movie{1, "Dune"}), CatalogStatus::Ok);
+    ASSERT_EQ(svc.add_theater(booking::Theater{1, "Roxy"}), CatalogStatus::Ok);
+    const booking::LayoutId hall = svc.add_layout(booking::HallLayout::uniform(8, 20));
+    for (int id = 1; id <= 4; ++id) {
+        ASSERT_EQ(svc.add_show(booking::Show{id, 1, 1, hall, kMonday + id * 3600, id}), CatalogStatus::Ok);
+    }
+    constexpr int kCap = 150;
+    ASSERT_EQ(svc.set_theater_daily_cap(1, kCap), CatalogStatus::Ok);
+
+    std::atomic<int> booked{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 160; ++i) {
+                const int show = 1 + (t + i) % 4;
+                const std::string seat = std::string(1, static_cast<char>('a' + i / 20)) + std::to_string(1 + i % 20);
+                if (svc.book_seats(show, {seat}).success) booked.fetch_add(1);
+            }
+        });
+    }
+    for (std::thread& th : threads) th.join();
+    EXPECT_EQ(booked.load(), kCap);
+    EXPECT_EQ(svc.theater_attendance(1, kMonday).seats_taken, kCap);
+}
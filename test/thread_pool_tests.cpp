@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "sharded_booking_service.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using booking::BookingRequest;
+using booking::BookingResult;
+using booking::BookingService;
+using booking::ShowId;
+using booking::Span;
+using booking::ThreadPool;
+using booking::ThreadPoolOptions;
+
+TEST(ThreadPool, RunsEveryChunkOnceAcrossWorkersAndCaller) {
+    ThreadPoolOptions options;
+    options.workers = 4;
+    ThreadPool pool(options);
+    EXPECT_EQ(pool.worker_count(), 4u);
+    EXPECT_FALSE(pool.on_worker());
+
+    constexpr std::size_t kItems = 100000;
+    std::vector<std::atomic<int>> hits(kItems);
+    std::atomic<std::size_t> calls{0};
+    pool.parallel_for(kItems, 100, [&](std::size_t begin, std::size_t end) {
+        EXPECT_LE(end - begin, 100u);
+        for (std::size_t i = begin; i < end; ++i) hits[i].fetch_add(1, std::memory_order_relaxed);
+        // Give the other workers time to steal
+        std::this_thread::yield();
+        calls.fetch_add(1, std::memory_order_relaxed);
+    });
+    for (std::size_t i = 0; i < kItems; ++i) ASSERT_EQ(hits[i].load(), 1) << i;
+    EXPECT_EQ(calls.load(), kItems / 100);
+    EXPECT_GT(pool.steals(), 0u);
+
+    // Trivial loops run inline
+    std::size_t ran = 0;
+    pool.parallel_for(0, 1, [&](std::size_t, std::size_t) { ++ran; });
+    pool.parallel_for(7, 10, [&](std::size_t begin, std::size_t end) { ran += end - begin; });
+    EXPECT_EQ(ran, 7u);
+}
+
+TEST(ThreadPool, NestedLoopsAndConcurrentCallersFinish) {
+    ThreadPoolOptions options;
+    options.workers = 2;
+    options.deque_capacity = 4; // full deques run work inline
+    ThreadPool pool(options);
+
+    std::atomic<std::uint64_t> sum{0};
+    std::vector<std::thread> callers;
+    for (int c = 0; c < 3; ++c) {
+        callers.emplace_back([&] {
+            pool.parallel_for(16, 1, [&](std::size_t, std::size_t) {
+                pool.parallel_for(64, 4, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) sum.fetch_add(i, std::memory_order_relaxed);
+                });
+            });
+        });
+    }
+    for (std::thread& t : callers) t.join();
+    EXPECT_EQ(sum.load(), 3u * 16u * (64u * 63u / 2u));
+}
+
+TEST(ThreadPool, PinsWorkersToAllowedCpus) {
+    ThreadPoolOptions options;
+    options.workers = 3;
+    options.pin_workers = true;
+    ThreadPool pinned(options);
+    for (unsigned i = 0; i < pinned.worker_count(); ++i) EXPECT_GE(pinned.worker_cpu(i), 0) << i;
+
+    ThreadPool unpinned(ThreadPoolOptions{2, false, 64});
+    EXPECT_EQ(unpinned.worker_cpu(0), -1);
+}
+
+TEST(ThreadPool, BooksLargeBatchesAcrossShowsInParallel) {
+    ThreadPoolOptions options;
+    options.workers = 3;
+    ThreadPool pool(options);
+    BookingService service(booking::HallLayout::uniform(8, 64));
+    service.set_thread_pool(&pool);
+    EXPECT_EQ(&service.thread_pool(), &pool);
+
+    // Two requests per seat of the four sample shows: the first of each pair wins
+    std::vector<std::string> labels;
+    for (int s = 0; s < 8 * 64; ++s) labels.push_back(service.layout_for_show(1)->label(s));
+    std::vector<std::vector<std::string_view>> seats;
+    std::vector<BookingRequest> batch;
+    seats.reserve(labels.size());
+    for (const std::string& l : labels) seats.push_back({l});
+    for (int round = 0; round < 2; ++round) {
+        for (int show = 1; show <= 4; ++show) {
+            for (const auto& s : seats) batch.push_back(BookingRequest{show, Span<const std::string_view>(s.data(), 1)});
+        }
+    }
+    ASSERT_GE(batch.size(), 1024u);
+    const std::vector<BookingResult> results = service.book_seats_batch(batch);
+    ASSERT_EQ(results.size(), batch.size());
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(results[i].success, i < batch.size() / 2) << i;
+        if (i >= batch.size() / 2) {
+            EXPECT_EQ(results[i].status, booking::BookingStatus::AlreadyBooked) << i;
+        }
+    }
+    for (int show = 1; show <= 4; ++show) EXPECT_EQ(service.available_count(show), 0);
+
+    booking::ShardedBookingService sharded(4);
+    sharded.set_thread_pool(&pool);
+    EXPECT_EQ(&sharded.shard(2).thread_pool(), &pool);
+    const std::string dir = ::testing::TempDir();
+    EXPECT_EQ(sharded.write_snapshots({dir + "snap0", dir + "snap1", dir + "snap2", dir + "snap3"}),
+              booking::SnapshotStatus::Ok);
+    EXPECT_EQ(sharded.write_snapshots({dir + "snap0"}), booking::SnapshotStatus::IoError);
+    for (int i = 0; i < 4; ++i) std::remove((dir + "snap" + std::to_string(i)).c_str());
+}
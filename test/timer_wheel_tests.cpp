@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include "timer_wheel.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using booking::TimerWheel;
+
+TEST(TimerWheel, FiresAtDeadline) {
+    TimerWheel wheel(0);
+    wheel.schedule(1, 5);
+    wheel.schedule(2, 5);
+    wheel.schedule(3, 300);   // level 1
+    wheel.schedule(4, 20000); // level 2
+
+    std::vector<std::uint32_t> fired;
+    auto collect = [&](std::uint32_t id) { fired.push_back(id); };
+
+    EXPECT_EQ(wheel.advance(4, collect), 0u);
+    EXPECT_EQ(wheel.advance(5, collect), 2u);
+    EXPECT_EQ(wheel.advance(299, collect), 0u);
+    EXPECT_EQ(wheel.advance(300, collect), 1u);
+    EXPECT_EQ(wheel.advance(19999, collect), 0u);
+    EXPECT_EQ(wheel.advance(20000, collect), 1u);
+    EXPECT_EQ(fired, (std::vector<std::uint32_t>{1, 2, 3, 4}));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheel, PastDeadlinesFireOnNextAdvance) {
+    TimerWheel wheel(100);
+    wheel.schedule(7, 10);
+    int fired = 0;
+    EXPECT_EQ(wheel.advance(101, [&](std::uint32_t) { ++fired; }), 1u);
+    EXPECT_EQ(fired, 1);
+}
+
+TEST(TimerWheel, ClampedDeadlinesBeyondTopLevel) {
+    TimerWheel wheel(0);
+    const std::uint64_t far = (std::uint64_t{1} << 26) + 12345;
+    wheel.schedule(9, far);
+    int fired = 0;
+    wheel.advance(far - 1, [&](std::uint32_t) { ++fired; });
+    EXPECT_EQ(fired, 0);
+    wheel.advance(far, [&](std::uint32_t) { ++fired; });
+    EXPECT_EQ(fired, 1);
+}
+
+TEST(TimerWheel, RandomDeadlinesFireExactlyOnTime) {
+    TimerWheel wheel(1000);
+    std::mt19937 rng(42);
+    std::vector<std::uint64_t> deadline(5000);
+    for (std::uint32_t id = 0; id < deadline.size(); ++id) {
+        deadline[id] = 1000 + 1 + rng() % 70000;
+        wheel.schedule(id, deadline[id]);
+    }
+
+    std::uint64_t t = 1000;
+    std::size_t total = 0;
+    while (wheel.size() > 0) {
+        t += 1 + rng() % 50;
+        total += wheel.advance(t, [&](std::uint32_t id) {
+            EXPECT_LE(deadline[id], t);
+            EXPECT_GT(deadline[id] + 50, t); // fired during the advance that reached it
+        });
+    }
+    EXPECT_EQ(total, deadline.size());
+}
+
+namespace {
+
+/** @brief Links of a test slab: link word and deadline per id. */
+struct TestLinks {
+    std::vector<std::uint32_t>* links;
+    std::vector<std::uint64_t>* deadlines;
+    std::uint32_t& next(std::uint32_t id) const { return (*links)[id]; }
+    std::uint64_t deadline(std::uint32_t id) const { return (*deadlines)[id]; }
+};
+
+} // namespace
+
+TEST(IntrusiveTimerWheel, FiresAtDeadlineAndReusesRecords) {
+    std::vector<std::uint32_t> next(4, 0);
+    std::vector<std::uint64_t> deadline{5, 5, 300, 20000};
+    booking::IntrusiveTimerWheel<TestLinks> wheel(TestLinks{&next, &deadline}, 0);
+    for (std::uint32_t id = 0; id < 4; ++id) wheel.schedule(id);
+
+    std::vector<std::uint32_t> fired;
+    auto collect = [&](std::uint32_t id) {
+        fired.push_back(id);
+        if (id == 0 && deadline[0] == 5) { // reschedule from the callback: the link was read already
+            deadline[0] = 400;
+            wheel.schedule(0);
+        }
+    };
+    EXPECT_EQ(wheel.advance(4, collect), 0u);
+    EXPECT_EQ(wheel.advance(5, collect), 2u);
+    EXPECT_EQ(wheel.advance(300, collect), 1u);
+    EXPECT_EQ(wheel.advance(400, collect), 1u);
+    EXPECT_EQ(wheel.size(), 1u);
+    EXPECT_EQ(wheel.advance(20000, collect), 1u);
+    std::sort(fired.begin(), fired.begin() + 2);
+    EXPECT_EQ(fired, (std::vector<std::uint32_t>{0, 1, 2, 0, 3}));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(IntrusiveTimerWheel, RandomAndClampedDeadlinesFireExactlyOnTime) {
+    std::mt19937 rng(7);
+    std::vector<std::uint64_t> deadline(5000);
+    std::vector<std::uint32_t> next(deadline.size());
+    booking::IntrusiveTimerWheel<TestLinks> wheel(TestLinks{&next, &deadline}, 1000);
+    for (std::uint32_t id = 0; id < deadline.size(); ++id) {
+        deadline[id] = 1000 + 1 + rng() % 70000;
+        wheel.schedule(id);
+    }
+    deadline.push_back((std::uint64_t{1} << 26) + 12345); // beyond the top level
+    next.push_back(0);
+    wheel.schedule(static_cast<std::uint32_t>(deadline.size() - 1));
+
+    std::uint64_t t = 1000;
+    std::size_t total = 0;
+    while (wheel.size() > 0) {
+        const std::uint64_t step = t < 80000 ? 1 + rng() % 50 : std::uint64_t{1} << 16;
+        t = std::min(t + step, deadline.back());
+        total += wheel.advance(t, [&](std::uint32_t id) {
+            EXPECT_LE(deadline[id], t);
+            EXPECT_GT(deadline[id] + step, t); // fired during the advance that reached it
+        });
+    }
+    EXPECT_EQ(total, deadline.size());
+}
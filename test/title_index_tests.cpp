@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "title_index.hpp"
+
+#include <string>
+#include <vector>
+
+using booking::TitleIndex;
+
+namespace {
+
+std::vector<std::int32_t> slots(const std::vector<TitleIndex::Match>& matches) {
+    std::vector<std::int32_t> out;
+    for (const TitleIndex::Match& m : matches) out.push_back(m.slot);
+    return out;
+}
+
+} // namespace
+
+TEST(TitleIndex, NormalizesCaseAndPunctuation) {
+    EXPECT_EQ(TitleIndex::normalize("  Star Wars: Episode IV -- A New Hope! "), "star wars episode iv a new hope");
+    EXPECT_EQ(TitleIndex::normalize("WALL\xC2\xB7" "E"), "wall\xC2\xB7" "e");
+    EXPECT_EQ(TitleIndex::normalize("?!"), "");
+}
+
+TEST(TitleIndex, RanksExactThenTitlePrefixThenWordPrefix) {
+    TitleIndex index;
+    const std::vector<std::string_view> titles = {"The Matrix Reloaded", "Matrix", "The Matrix", "Matrix Resurrections",
+                                                  "Inception"};
+    index.add(titles);
+    ASSERT_EQ(index.size(), 5u);
+
+    const auto matches = index.search("matrix", 10);
+    EXPECT_EQ(slots(matches), (std::vector<std::int32_t>{1, 3, 2, 0}));
+    EXPECT_EQ(matches[0].kind, TitleIndex::MatchKind::Exact);
+    EXPECT_EQ(matches[1].kind, TitleIndex::MatchKind::TitlePrefix);
+    EXPECT_EQ(matches[2].kind, TitleIndex::MatchKind::WordPrefix);
+    EXPECT_EQ(slots(index.search("  THE ma", 10)), (std::vector<std::int32_t>{2, 0}));
+    EXPECT_EQ(slots(index.search("matrix", 2)), (std::vector<std::int32_t>{1, 3}));
+    EXPECT_TRUE(index.search("", 10).empty());
+    EXPECT_TRUE(index.search("matrix", 0).empty());
+    EXPECT_TRUE(index.search("zzz", 10).empty());
+    EXPECT_STREQ(to_string(TitleIndex::MatchKind::WordPrefix), "word_prefix");
+}
+
+TEST(TitleIndex, RepeatedWordCountsOnce) {
+    TitleIndex index;
+    index.add("New York, New York");
+    index.add("Newsies");
+    const auto matches = index.search("new", 10);
+    ASSERT_EQ(matches.size(), 2u);
+    EXPECT_EQ(matches[0].slot, 1); // shorter title, same kind
+    EXPECT_EQ(matches[1].kind, TitleIndex::MatchKind::TitlePrefix);
+}
+
+TEST(TitleIndex, ToleratesTypos) {
+    TitleIndex index;
+    index.add("The Godfather Part II");
+    index.add("Interstellar");
+    index.add("Goodfellas");
+    index.add("Gladiator");
+
+    const auto swapped = index.search("godfahter", 10); // adjacent letters swapped
+    ASSERT_EQ(swapped.size(), 1u);
+    EXPECT_EQ(swapped[0].slot, 0);
+    EXPECT_EQ(swapped[0].kind, TitleIndex::MatchKind::Fuzzy);
+    EXPECT_EQ(swapped[0].distance, 1u);
+
+    EXPECT_EQ(slots(index.search("intrstellar", 10)), (std::vector<std::int32_t>{1}));
+    EXPECT_EQ(slots(index.search("interstelalr", 10)), (std::vector<std::int32_t>{1}));
+    EXPECT_EQ(slots(index.search("intersxxllar", 10)), (std::vector<std::int32_t>{1})); // two edits, long query
+    EXPECT_TRUE(index.search("gldtr", 10).empty()); // too far
+    EXPECT_EQ(slots(index.search("glad1", 10)), (std::vector<std::int32_t>{3}));
+    EXPECT_TRUE(index.search("glxd", 10).empty()); // short queries get no typo budget
+}
+
+TEST(TitleIndex, IncrementalAddsMatchOneBatch) {
+    std::vector<std::string> titles;
+    for (int i = 0; i < 300; ++i) titles.push_back("Movie " + std::to_string(i * 7919 % 1000) + " story");
+    std::vector<std::string_view> views(titles.begin(), titles.end());
+
+    TitleIndex batch;
+    batch.add(views);
+    TitleIndex incremental;
+    incremental.add(booking::Span<const std::string_view>(views.data(), 100));
+    for (std::size_t i = 100; i < views.size(); ++i) incremental.add(views[i]);
+
+    for (const char* query : {"movie 1", "story", "9", "movie 42 story", "stroy"}) {
+        const auto a = batch.search(query, 20);
+        const auto b = incremental.search(query, 20);
+        EXPECT_EQ(slots(a), slots(b)) << query;
+    }
+    std::size_t ones = 0;
+    for (const std::string& t : titles) ones += t.compare(0, 7, "Movie 1") == 0 ? 1u : 0u;
+    std::size_t prefixed = 0;
+    for (const TitleIndex::Match& m : batch.search("movie 1", 1000)) {
+        prefixed += m.kind == TitleIndex::MatchKind::Fuzzy ? 0u : 1u; // the rest are one digit off
+    }
+    EXPECT_EQ(prefixed, ones);
+}
+
+TEST(TitleIndex, ServiceSearchesItsCatalog) {
+    booking::BookingService svc;
+    const auto inter = svc.search_movies("inter");
+    ASSERT_EQ(inter.size(), 1u);
+    EXPECT_EQ(inter[0].title, "Interstellar");
+    EXPECT_EQ(svc.search_movies("in").size(), 2u);
+    EXPECT_EQ(svc.search_movies("in", 1).size(), 1u);
+
+    ASSERT_EQ(svc.add_movie(booking::Movie{9, "The Matrix Reloaded"}), booking::CatalogStatus::Ok);
+    const auto view = svc.catalog_view(); // pins the snapshot before the schedule below
+    booking::Schedule schedule;
+    schedule.movies.push_back(booking::ScheduleMovie{10, "Matrix Revolutions"});
+    ASSERT_EQ(svc.load_schedule(std::move(schedule)).status, booking::ScheduleStatus::Ok);
+
+    EXPECT_EQ(view.movies().size(), 4u);
+    EXPECT_EQ(svc.search_movies("revolutions").size(), 1u);
+
+    const auto matrix = svc.search_movies("matrix");
+    ASSERT_EQ(matrix.size(), 3u);
+    EXPECT_EQ(matrix[0].id, booking::MovieId(10));
+    EXPECT_EQ(matrix[1].id, booking::MovieId(3));
+    EXPECT_EQ(matrix[2].id, booking::MovieId(9));
+    EXPECT_EQ(svc.search_movies("matirx revolutions").front().id, booking::MovieId(10));
+    EXPECT_EQ(svc.add_movie(booking::Movie{9, "Duplicate"}), booking::CatalogStatus::DuplicateId);
+    EXPECT_TRUE(svc.search_movies("duplicate").empty());
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "booking_service.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using booking::BookingService;
+using booking::HallLayout;
+using booking::ShowId;
+using booking::TraceEvent;
+using booking::TraceStage;
+
+namespace {
+
+const TraceEvent* find_stage(const std::vector<TraceEvent>& events, TraceStage stage) {
+    const auto it = std::find_if(events.begin(), events.end(), [&](const TraceEvent& e) { return e.stage == stage; });
+    return it == events.end() ? nullptr : &*it;
+}
+
+bool inside(const TraceEvent& inner, const TraceEvent& outer) {
+    return inner.thread == outer.thread && inner.begin >= outer.begin && inner.end <= outer.end;
+}
+
+} // namespace
+
+TEST(Trace, StageNames) {
+    EXPECT_STREQ(booking::to_string(TraceStage::BookSeats), "book_seats");
+    EXPECT_STREQ(booking::to_string(TraceStage::CasRetry), "cas_retry");
+    EXPECT_STREQ(booking::to_string(TraceStage::Render), "render");
+    EXPECT_STREQ(booking::to_string(static_cast<TraceStage>(200)), "unknown");
+}
+
+TEST(Trace, RecordsTheStagesOfARequest) {
+    if (!BOOKING_TRACING) GTEST_SKIP() << "built without trace points";
+    BookingService svc(HallLayout::uniform(3, 10));
+    const ShowId show = svc.find_show(1, 1);
+    booking::trace_collect(); // drop what earlier tests left
+
+    booking::trace_start();
+    EXPECT_TRUE(booking::trace_running());
+    EXPECT_TRUE(svc.book_seats(show, {"a1", "a2", "b1"}).success);
+    EXPECT_EQ(svc.list_available_seats(show).size(), 27u);
+    booking::trace_stop();
+    const std::vector<TraceEvent> events = booking::trace_collect();
+
+    const TraceEvent* book = find_stage(events, TraceStage::BookSeats);
+    const TraceEvent* list = find_stage(events, TraceStage::ListSeats);
+    ASSERT_NE(book, nullptr);
+    ASSERT_NE(list, nullptr);
+    EXPECT_EQ(book->arg, static_cast<std::uint64_t>(show.value()));
+    EXPECT_LE(book->end, list->begin);
+    for (const TraceStage stage : {TraceStage::Parse, TraceStage::Acquire}) {
+        const TraceEvent* e = find_stage(events, stage);
+        ASSERT_NE(e, nullptr) << booking::to_string(stage);
+        EXPECT_TRUE(inside(*e, *book)) << booking::to_string(stage);
+    }
+    EXPECT_EQ(find_stage(events, TraceStage::Parse)->arg, 3u);
+    for (const TraceStage stage : {TraceStage::LoadSeats, TraceStage::Render}) {
+        const TraceEvent* e = find_stage(events, stage);
+        ASSERT_NE(e, nullptr) << booking::to_string(stage);
+        EXPECT_TRUE(inside(*e, *list)) << booking::to_string(stage);
+    }
+    EXPECT_TRUE(std::is_sorted(events.begin(), events.end(),
+                               [](const TraceEvent& a, const TraceEvent& b) { return a.begin < b.begin; }));
+
+    // Stopped: nothing more is recorded, and collected events are not handed out twice
+    EXPECT_TRUE(svc.book_seats(show, {"c1"}).success);
+    EXPECT_TRUE(booking::trace_collect().empty());
+}
+
+TEST(Trace, RingKeepsTheNewestEvents) {
+    if (!BOOKING_TRACING) GTEST_SKIP() << "built without trace points";
+    booking::trace_collect();
+    booking::trace_start();
+    const std::size_t total = booking::kTraceRingEvents + 100u;
+    for (std::size_t i = 0; i < total; ++i) booking::trace_instant(TraceStage::CasRetry, i);
+    booking::trace_stop();
+    const std::vector<TraceEvent> events = booking::trace_collect();
+    ASSERT_EQ(events.size(), booking::kTraceRingEvents);
+    EXPECT_EQ(events.front().arg, 100u);
+    EXPECT_EQ(events.back().arg, total - 1u);
+}
+
+TEST(Trace, ThreadsGetTheirOwnTracks) {
+    if (!BOOKING_TRACING) GTEST_SKIP() << "built without trace points";
+    booking::trace_collect();
+    booking::trace_start();
+    booking::trace_instant(TraceStage::CasRetry, 1);
+    std::thread other([] { booking::trace_instant(TraceStage::CasRetry, 2); });
+    other.join();
+    booking::trace_stop();
+    const std::vector<TraceEvent> events = booking::trace_collect();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_NE(events[0].thread, events[1].thread);
+}
+
+TEST(Trace, WritesChromeTraceJson) {
+    std::vector<TraceEvent> events(2);
+    events[0].begin = 1000;
+    events[0].end = 5000;
+    events[0].arg = 7;
+    events[0].stage = TraceStage::BookSeats;
+    events[1].begin = events[1].end = 3000;
+    events[1].thread = 1;
+    events[1].stage = TraceStage::CasRetry;
+
+    std::ostringstream out;
+    booking::write_chrome_trace(out, events);
+    const std::string json = out.str();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(json.find("\"name\":\"book_seats\",\"cat\":\"booking\",\"ph\":\"X\",\"ts\":0.000,"), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"arg\":7}"), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"cas_retry\",\"cat\":\"booking\",\"ph\":\"i\""), std::string::npos);
+    EXPECT_NE(json.find("\"tid\":1"), std::string::npos);
+    EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+    EXPECT_EQ(std::count(json.begin(), json.end(), '{'), std::count(json.begin(), json.end(), '}'));
+}
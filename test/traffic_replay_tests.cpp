@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include "traffic_replay.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using booking::BookingService;
+using booking::ReplayOp;
+using booking::ReplayOpKind;
+using booking::ReplayOptions;
+using booking::ReplayStats;
+
+namespace {
+
+/** @brief Capture over the four sample shows: bookings, best-available, cancellations, reads. */
+std::string sample_capture(int rounds) {
+    std::string out;
+    std::uint64_t id = 0;
+    for (int r = 0; r < rounds; ++r) {
+        for (int show = 1; show <= 4; ++show) {
+            const std::string s = std::to_string(show);
+            const std::string seat = "a" + std::to_string(1 + r % 20);
+            out += "{\"op\":\"book\",\"show\":" + s + ",\"seats\":[\"" + seat + "\"],\"id\":" + std::to_string(++id) + "}\n";
+            if (r % 3 == 0) out += "{\"op\":\"cancel\",\"show\":" + s + ",\"booking\":" + std::to_string(id) + "}\n";
+            out += "{ \"show\" : " + s + " , \"op\" : \"best\", \"n\": 2, \"id\": " + std::to_string(++id) + " }\n";
+            if (r % 5 == 0) out += "{\"op\":\"cancel\",\"show\":" + s + ",\"booking\":" + std::to_string(id) + "}\n";
+            out += "{\"op\":\"count\",\"show\":" + s + ",\"note\":{\"x\":[1,\"]\"]}}\n";
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(TrafficReplay, ParsesRecords) {
+    ReplayOp op;
+    ASSERT_TRUE(booking::parse_replay_op(R"({"op":"book","show":12,"seats":["a1","b2"],"id":7,"ts":"x\"y"})", op));
+    EXPECT_EQ(op.kind, ReplayOpKind::Book);
+    EXPECT_EQ(op.show_id, 12);
+    EXPECT_EQ(op.id, 7u);
+    ASSERT_EQ(op.seats.size(), 2u);
+    EXPECT_EQ(op.seats[1], "b2");
+
+    ASSERT_TRUE(booking::parse_replay_op(R"({"booking":7,"op":"cancel","show":3})", op));
+    EXPECT_EQ(op.kind, ReplayOpKind::Cancel);
+    EXPECT_TRUE(op.seats.empty());
+    EXPECT_EQ(op.booking, 7u);
+
+    EXPECT_FALSE(booking::parse_replay_op(R"({"op":"book","show":1,"seats":[]})", op));
+    EXPECT_FALSE(booking::parse_replay_op(R"({"op":"teleport","show":1})", op));
+    EXPECT_FALSE(booking::parse_replay_op(R"({"op":"count"})", op));
+    EXPECT_FALSE(booking::parse_replay_op(R"({"op":"count","show":1)", op));
+    EXPECT_FALSE(booking::parse_replay_op("not json", op));
+
+    booking::ShowId show = -1;
+    EXPECT_TRUE(booking::scan_replay_show(R"({"op":"seats","show":42})", show));
+    EXPECT_EQ(show, 42);
+    EXPECT_FALSE(booking::scan_replay_show(R"({"op":"seats"})", show));
+}
+
+TEST(TrafficReplay, FinalStateDoesNotDependOnWorkerCount) {
+    const std::string capture = sample_capture(40) + "garbage\n\n";
+    ReplayStats first;
+    for (unsigned workers : {1u, 2u, 3u}) {
+        BookingService svc;
+        ReplayOptions options;
+        options.workers = workers;
+        options.queue_capacity = 8; // producer blocks on full rings
+        const ReplayStats s = booking::replay_traffic(svc, capture, options);
+        EXPECT_EQ(s.lines, static_cast<std::uint64_t>(std::count(capture.begin(), capture.end(), '\n') - 1));
+        EXPECT_EQ(s.malformed, 1u);
+        EXPECT_EQ(s.ops, s.lines - 1u);
+        if (workers == 1u) {
+            first = s;
+            EXPECT_GT(s.failed, 0u);   // the hall fills up
+            EXPECT_GT(s.unmapped, 0u); // cancellations of those failed bookings
+            EXPECT_NE(s.checksum, booking::seat_state_checksum(BookingService{}, std::vector<booking::ShowId>{1, 2, 3, 4}));
+        } else {
+            EXPECT_EQ(s.checksum, first.checksum) << workers << " workers";
+            EXPECT_EQ(s.failed, first.failed);
+            EXPECT_EQ(s.unmapped, first.unmapped);
+        }
+    }
+}
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+
+#include "wire_protocol.hpp"
+
+#include <string>
+#include <vector>
+
+using booking::BookingService;
+using booking::BookingStatus;
+using booking::HallLayout;
+using booking::SeatMask;
+using booking::WireCommandHandler;
+using booking::WireDecode;
+using booking::WireOp;
+using booking::WireRequestView;
+using booking::WireResponse;
+
+namespace {
+
+std::vector<WireResponse> responses(const std::string& out) {
+    std::vector<WireResponse> rs;
+    for (std::size_t pos = 0; pos + booking::kWireResponseSize <= out.size(); pos += booking::kWireResponseSize) {
+        WireResponse r;
+        EXPECT_TRUE(booking::decode_response(out.data() + pos, out.size() - pos, r));
+        rs.push_back(r);
+    }
+    EXPECT_EQ(out.size() % booking::kWireResponseSize, 0u);
+    return rs;
+}
+
+} // namespace
+
+TEST(WireProtocol, DecodesFramesInPlace) {
+    SeatMask seats;
+    seats.set(HallLayout::seat_index(3, 5));
+    seats.set(HallLayout::seat_index(4, 63));
+    std::string buf;
+    booking::encode_mask_request(buf, WireOp::CancelMask, 7, 42, seats, 99);
+    EXPECT_EQ(buf.size(), 32u + 8u + 16u);
+
+    WireRequestView req;
+    for (std::size_t n = 0; n < buf.size(); ++n) EXPECT_EQ(booking::decode_request(buf.data(), n, req), WireDecode::Incomplete);
+    ASSERT_EQ(booking::decode_request(buf.data(), buf.size(), req), WireDecode::Ok);
+    EXPECT_EQ(req.op, WireOp::CancelMask);
+    EXPECT_EQ(req.show_id, 7);
+    EXPECT_EQ(req.request_id, 42u);
+    EXPECT_EQ(req.arg, 99u);
+    EXPECT_EQ(req.frame_size, buf.size());
+    EXPECT_EQ(req.payload, reinterpret_cast<const unsigned char*>(buf.data()) + 32);
+    SeatMask back;
+    ASSERT_TRUE(booking::decode_mask(req, back));
+    EXPECT_EQ(back.count(), 2);
+    EXPECT_TRUE(back.test(HallLayout::seat_index(4, 63)));
+
+    const int idx[] = {1, 2, 3};
+    std::string ind;
+    booking::encode_indices_request(ind, 1, 5, idx);
+    EXPECT_EQ(ind.size(), 32u + 8u);
+    ASSERT_EQ(booking::decode_request(ind.data(), ind.size(), req), WireDecode::Ok);
+    EXPECT_EQ(req.count, 3u);
+
+    std::string bad = buf;
+    bad[0] = 'b'; // a text request
+    EXPECT_EQ(booking::decode_request(bad.data(), 1, req), WireDecode::Malformed);
+    bad = buf;
+    bad[1] = 9; // unknown op
+    EXPECT_EQ(booking::decode_request(bad.data(), bad.size(), req), WireDecode::Malformed);
+    bad = buf;
+    bad[2] = 65; // more words than a mask has
+    EXPECT_EQ(booking::decode_request(bad.data(), bad.size(), req), WireDecode::Malformed);
+}
+
+TEST(WireProtocol, ExecutesPipelinedRequests) {
+    BookingService svc;
+    WireCommandHandler handler(svc);
+    SeatMask pair;
+    pair.set(4);
+    pair.set(5);
+    const int idx[] = {0, 1};
+    std::string in;
+    booking::encode_mask_request(in, WireOp::BookMask, 1, 1, pair);
+    booking::encode_indices_request(in, 1, 2, idx);
+    booking::encode_indices_request(in, 1, 3, idx);
+    booking::encode_request(in, WireOp::BookBest, 1, 4, 3);
+    booking::encode_request(in, WireOp::AvailableCount, 1, 5);
+    booking::encode_request(in, WireOp::AvailableCount, 999, 6);
+    const std::size_t complete = in.size();
+    booking::encode_request(in, WireOp::AvailableCount, 1, 7);
+    in.resize(in.size() - 1); // last frame still in flight
+
+    std::string out;
+    ASSERT_EQ(handler.execute(in.data(), in.size(), out), static_cast<std::ptrdiff_t>(complete));
+    const std::vector<WireResponse> rs = responses(out);
+    ASSERT_EQ(rs.size(), 6u);
+    for (std::size_t i = 0; i < rs.size(); ++i) EXPECT_EQ(rs[i].request_id, i + 1);
+    EXPECT_EQ(rs[0].status, BookingStatus::Ok);
+    EXPECT_EQ(rs[1].status, BookingStatus::Ok);
+    EXPECT_NE(rs[0].id, rs[1].id);
+    EXPECT_EQ(rs[2].status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(rs[2].id, 0u);
+    EXPECT_EQ(rs[3].status, BookingStatus::Ok);
+    EXPECT_GE(rs[3].value, 0);
+    EXPECT_EQ(rs[4].value, 20 - 7);
+    EXPECT_EQ(rs[5].status, BookingStatus::InvalidShow);
+
+    // The booking id from the response cancels the seats
+    std::string cancel;
+    booking::encode_mask_request(cancel, WireOp::CancelMask, 1, 8, pair, rs[0].id);
+    booking::encode_mask_request(cancel, WireOp::CancelMask, 1, 9, pair, rs[0].id);
+    out.clear();
+    ASSERT_EQ(handler.execute(cancel.data(), cancel.size(), out), static_cast<std::ptrdiff_t>(cancel.size()));
+    const std::vector<WireResponse> cs = responses(out);
+    ASSERT_EQ(cs.size(), 2u);
+    EXPECT_EQ(cs[0].status, BookingStatus::Ok);
+    EXPECT_EQ(cs[1].status, BookingStatus::NotOwner);
+    EXPECT_EQ(svc.available_count(1), 20 - 5);
+
+    // Output limit: stops after the first response
+    out.clear();
+    EXPECT_EQ(handler.execute(in.data(), complete, out, 1), 32 + 8 + 8);
+    EXPECT_EQ(out.size(), 24u);
+    out.clear();
+    const std::string garbage(32, '\x01');
+    EXPECT_EQ(handler.execute(garbage.data(), garbage.size(), out), -1);
+}
+
+TEST(WireProtocol, AvailableSeatsCarryTheirPayload) {
+    BookingService svc;
+    WireCommandHandler handler(svc);
+    ASSERT_TRUE(svc.book_seats(1, {"a1", "a2", "a7"}).success);
+    const HallLayout* layout = svc.layout_for_show(1);
+    ASSERT_NE(layout, nullptr);
+
+    std::string in;
+    booking::encode_request(in, WireOp::AvailableSeats, 1, 1, static_cast<std::uint16_t>(booking::SeatEncoding::Runs));
+    booking::encode_request(in, WireOp::AvailableSeats, 999, 2, static_cast<std::uint16_t>(booking::SeatEncoding::Bitmap));
+    booking::encode_request(in, WireOp::AvailableSeats, 1, 3, static_cast<std::uint16_t>(booking::SeatEncoding::Labels));
+    std::string out;
+    ASSERT_EQ(handler.execute(in.data(), in.size(), out), static_cast<std::ptrdiff_t>(in.size()));
+
+    std::size_t pos = 0;
+    WireResponse r;
+    ASSERT_TRUE(booking::decode_response(out.data(), out.size(), r));
+    EXPECT_EQ(r.status, BookingStatus::Ok);
+    EXPECT_EQ(r.id, 17u);
+    EXPECT_EQ(r.value, 6); // runs a3-a6 and a8-a20
+    SeatMask free_seats;
+    pos += booking::kWireResponseSize;
+    ASSERT_TRUE(booking::decode_free_seats(*layout, booking::SeatEncoding::Runs, out.data() + pos, 6u, free_seats));
+    EXPECT_EQ(free_seats.count(), 17);
+    EXPECT_FALSE(free_seats.test(6));
+    pos += 6u;
+
+    ASSERT_TRUE(booking::decode_response(out.data() + pos, out.size() - pos, r));
+    EXPECT_EQ(r.request_id, 2u);
+    EXPECT_EQ(r.status, BookingStatus::InvalidShow);
+    EXPECT_EQ(r.value, 0);
+    pos += booking::kWireResponseSize;
+
+    ASSERT_TRUE(booking::decode_response(out.data() + pos, out.size() - pos, r));
+    EXPECT_EQ(r.request_id, 3u);
+    pos += booking::kWireResponseSize;
+    EXPECT_EQ(out.substr(pos), "a3,a4,a5,a6,a8,a9,a10,a11,a12,a13,a14,a15,a16,a17,a18,a19,a20");
+    EXPECT_EQ(static_cast<std::size_t>(r.value), out.size() - pos);
+
+    // An encoding the protocol does not know is a malformed frame
+    std::string bad;
+    booking::encode_request(bad, WireOp::AvailableSeats, 1, 4, booking::kSeatEncodings);
+    WireRequestView req;
+    EXPECT_EQ(booking::decode_request(bad.data(), bad.size(), req), WireDecode::Malformed);
+}
+
+TEST(WireProtocol, BatchesRunAsOneUnit) {
+    BookingService svc;
+    WireCommandHandler handler(svc);
+    SeatMask pair;
+    pair.set(0);
+    pair.set(1);
+    const int idx[] = {2};
+
+    // Book two shows, collide on the first, then re-read both: one frame, one response write
+    std::string frames;
+    booking::encode_request(frames, WireOp::AvailableCount, 1, 1);
+    booking::encode_mask_request(frames, WireOp::BookMask, 1, 2, pair);
+    booking::encode_mask_request(frames, WireOp::BookMask, 2, 3, pair);
+    booking::encode_mask_request(frames, WireOp::BookMask, 1, 4, pair);
+    booking::encode_indices_request(frames, 1, 5, idx);
+    booking::encode_request(frames, WireOp::AvailableCount, 999, 6);
+    booking::encode_request(frames, WireOp::AvailableSeats, 2, 7, static_cast<std::uint16_t>(booking::SeatEncoding::Labels));
+    std::string in;
+    booking::encode_batch_request(in, 77, frames, 7);
+
+    std::string out;
+    ASSERT_EQ(handler.execute(in.data(), in.size(), out), static_cast<std::ptrdiff_t>(in.size()));
+    WireResponse head;
+    ASSERT_TRUE(booking::decode_response(out.data(), out.size(), head));
+    EXPECT_EQ(head.op, WireOp::Batch);
+    EXPECT_EQ(head.request_id, 77u);
+    EXPECT_EQ(head.value, 7);
+
+    std::size_t pos = booking::kWireResponseSize;
+    WireResponse rs[7];
+    for (int k = 0; k < 7; ++k) {
+        ASSERT_TRUE(booking::decode_response(out.data() + pos, out.size() - pos, rs[k]));
+        EXPECT_EQ(rs[k].request_id, static_cast<std::uint64_t>(k + 1));
+        pos += booking::kWireResponseSize;
+    }
+    EXPECT_EQ(rs[0].value, 20 - 3); // reads see the batch's bookings
+    EXPECT_EQ(rs[1].status, BookingStatus::Ok);
+    EXPECT_EQ(rs[2].status, BookingStatus::Ok);
+    EXPECT_NE(rs[1].id, rs[2].id);
+    EXPECT_EQ(rs[3].status, BookingStatus::AlreadyBooked);
+    EXPECT_EQ(rs[4].status, BookingStatus::Ok);
+    EXPECT_EQ(rs[5].status, BookingStatus::InvalidShow);
+    EXPECT_EQ(rs[6].status, BookingStatus::Ok);
+    EXPECT_EQ(rs[6].id, 18u);
+    EXPECT_EQ(out.substr(pos, static_cast<std::size_t>(rs[6].value)).substr(0, 6), "a3,a4,");
+    EXPECT_EQ(pos + static_cast<std::size_t>(rs[6].value), out.size());
+
+    // A batch whose requests do not fill its payload exactly, or that nests a batch, is malformed
+    std::string nested;
+    booking::encode_batch_request(nested, 78, in, 1);
+    out.clear();
+    EXPECT_EQ(handler.execute(nested.data(), nested.size(), out), -1);
+    std::string short_count;
+    booking::encode_batch_request(short_count, 79, frames, 6);
+    EXPECT_EQ(handler.execute(short_count.data(), short_count.size(), out), -1);
+    EXPECT_TRUE(out.empty());
+    EXPECT_EQ(svc.available_count(1), 17);
+}
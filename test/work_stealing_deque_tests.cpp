@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "work_stealing_deque.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using booking::WorkStealingDeque;
+
+TEST(WorkStealingDeque, OwnerPopsNewestAndThievesStealOldest) {
+    WorkStealingDeque<int> d(4);
+    EXPECT_EQ(d.capacity(), 4u);
+    int items[5] = {0, 1, 2, 3, 4};
+    EXPECT_EQ(d.pop(), nullptr);
+    EXPECT_EQ(d.steal(), nullptr);
+    EXPECT_TRUE(d.empty());
+
+    for (int i = 0; i < 4; ++i) EXPECT_TRUE(d.push(&items[i]));
+    EXPECT_FALSE(d.push(&items[4])); // full
+    EXPECT_EQ(d.steal(), &items[0]);
+    EXPECT_EQ(d.pop(), &items[3]);
+    EXPECT_TRUE(d.push(&items[4]));  // the stolen slot is free again
+    EXPECT_EQ(d.steal(), &items[1]);
+    EXPECT_EQ(d.pop(), &items[4]);
+    EXPECT_EQ(d.pop(), &items[2]);
+    EXPECT_EQ(d.pop(), nullptr);
+    EXPECT_TRUE(d.empty());
+    EXPECT_THROW(WorkStealingDeque<int>(6), std::invalid_argument);
+}
+
+TEST(WorkStealingDeque, EveryItemIsTakenExactlyOnce) {
+    constexpr int kItems = 100000;
+    constexpr int kThieves = 3;
+    WorkStealingDeque<int> d(256);
+    std::vector<int> items(kItems);
+    std::vector<std::atomic<int>> taken(kItems);
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < kThieves; ++t) {
+        thieves.emplace_back([&] {
+            while (!done.load(std::memory_order_acquire) || !d.empty()) {
+                if (int* item = d.steal()) {
+                    taken[static_cast<std::size_t>(item - items.data())].fetch_add(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int i = 0; i < kItems; ++i) {
+        while (!d.push(&items[static_cast<std::size_t>(i)])) {
+            if (int* item = d.pop()) taken[static_cast<std::size_t>(item - items.data())].fetch_add(1);
+        }
+        if (i % 3 == 0) {
+            if (int* item = d.pop()) taken[static_cast<std::size_t>(item - items.data())].fetch_add(1);
+        }
+    }
+    while (int* item = d.pop()) taken[static_cast<std::size_t>(item - items.data())].fetch_add(1);
+    done.store(true, std::memory_order_release);
+    for (std::thread& t : thieves) t.join();
+
+    for (int i = 0; i < kItems; ++i) ASSERT_EQ(taken[static_cast<std::size_t>(i)].load(), 1) << i;
+}